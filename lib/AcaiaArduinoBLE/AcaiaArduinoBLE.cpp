@@ -10,177 +10,806 @@
 #include "AcaiaArduinoBLE.h"
 #include <ArduinoBLE.h>
 #include "../../src/debug_config.h"  // For thread-safe LOG_*() macros with serialMutex
-#include "esp_task_wdt.h"             // For watchdog reset during blocking BLE operations
+#include "utility/HCIVirtualTransport.h"  // For waking the BLE task on incoming HCI data
+#include "utility/HCI.h"                  // ACL TX queue statistics
+#include <limits.h>
+#include "esp_timer.h"                // Notification arrival timestamps
+#include "GattCache.h"                // Remembered GATT handles per scale MAC
+#include "FrameParser.h"              // 0xEF 0xDD stream reassembly (framed drivers)
+#include "../../src/metrics.h"        // Link quality metrics (see pollLinkStats())
+#include "../../src/crash_ring.h"     // State transitions in the post-mortem ring
+#include "../../src/watchdog.h"       // BLE host deadline around the blocking ArduinoBLE calls
+#include "../../src/gpio_probe.h"     // Notification arrivals on a probe pin (GS_GPIO_PROBE)
+#include "../../src/iram_placement.h" // Notification path in IRAM (GS_HOT_IRAM)
 
-#define HEADER1 0xef
-#define HEADER2 0xdd
-
-byte IDENTIFY[20] = {0xef, 0xdd, 0x0b, 0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x30, 0x31, 0x32, 0x33, 0x34, 0x9a, 0x6d};
-byte HEARTBEAT[7] = {0xef, 0xdd, 0x00, 0x02, 0x00, 0x02, 0x00};
-byte NOTIFICATION_REQUEST[14] = {0xef, 0xdd, 0x0c, 0x09, 0x00, 0x01, 0x01, 0x02, 0x02, 0x05, 0x03, 0x04, 0x15, 0x06};
-byte START_TIMER[7] = {0xef, 0xdd, 0x0d, 0x00, 0x00, 0x00, 0x00};
-byte STOP_TIMER[7] = {0xef, 0xdd, 0x0d, 0x00, 0x02, 0x00, 0x02};
-byte RESET_TIMER[7] = {0xef, 0xdd, 0x0d, 0x00, 0x01, 0x00, 0x01};
-byte TARE_ACAIA[6] = {0xef, 0xdd, 0x04, 0x00, 0x00, 0x00};
-byte TARE_GENERIC[1] = {0x54};
+// Command frames and weight decoding live in the per-protocol drivers (ScaleDriver.cpp)
 
 int count = 0;
 
 const int lvUpdateInterval = 16;
 unsigned long lastLvUpdate = 0;
-extern void LVGLTimerHandlerRoutine();
+extern uint32_t LVGLTimerHandlerRoutine();
+
+// Task woken (eSetBits) when a weight notification lands in _read - see setEventTask()
+static volatile TaskHandle_t eventTask = NULL;
+static volatile uint32_t notifyEventBits = 0;
+
+// SPSC notification ring - head written by onReadUpdated() only, tail by the consumer only
+static ScalePacket packetRing[PACKET_RING_SIZE];
+static volatile uint32_t packetHead = 0;
+static volatile uint32_t packetTail = 0;
+static volatile uint32_t packetsDropped = 0;
+
+static FrameParser frameParser;
+static uint8_t packetOffset = 0;    // Bytes of the ring's oldest packet already fed to frameParser
+
+static portMUX_TYPE candidateMux = portMUX_INITIALIZER_UNLOCKED;  // _candidates: BLE task writes, UI reads
+static int64_t lastNotifyUs = 0;    // Previous onReadUpdated() arrival, 0 = first on this link
+
+static MetricGauge bleRssiDbm("ble_rssi_dbm", "RSSI of the scale connection");
+static MetricHistogram bleNotifyIntervalMs("ble_notify_interval_ms", "Scale notification inter-arrival time (all packets)", METRIC_BUCKETS_MS);
+static MetricCounter blePacketsLostEst("ble_packets_lost_est_total", "Weight packets missing from the nominal rate");
+static MetricHistogram bleAttWriteUs("ble_att_write_us", "ATT write with response, call to confirmation", METRIC_BUCKETS_US);
+static MetricHistogram bleAttWriteCmdUs("ble_att_write_cmd_us", "ATT write without response, time to queue", METRIC_BUCKETS_US);
+static MetricCounter bleAttWriteFailures("ble_att_write_failures_total", "ATT writes that returned an error");
+static MetricCounter bleConnections("ble_connections_total", "Connections that reached CONNECTED");
+static MetricCounter bleScanReports("ble_scan_reports_total", "Advertising reports received while scanning");
+static MetricCounter bleScanDropped("ble_scan_reports_dropped_total", "Advertising reports of other devices, dropped before allocation");
+static MetricCounterRef bleTxQueued("ble_hci_tx_queued_total", "ACL packets that waited for a controller buffer", &HCI.txStats().queued);
+static MetricCounterRef bleTxStalls("ble_hci_tx_stalls_total", "ACL sends that waited for a free TX queue slot", &HCI.txStats().stalls);
+static MetricCounterRef bleTxStallUs("ble_hci_tx_stall_us_total", "Time spent waiting for a free TX queue slot", &HCI.txStats().stallUsTotal);
+static MetricCounterRef bleTxDropped("ble_hci_tx_dropped_total", "Queued ACL packets of links that closed", &HCI.txStats().dropped);
+static MetricGauge bleTxDepthMax("ble_hci_tx_queue_depth_max", "Most ACL packets queued for the controller at once");
+static MetricGauge scaleBatteryPct("scale_battery_pct", "Scale battery from the last settings reply");
+static MetricCounterRef blePacketsDropped("ble_packets_dropped_total", "Notifications lost to a full packet ring", &packetsDropped);
+static MetricCounterRef bleFrames("ble_frames_total", "0xEF 0xDD frames extracted from notifications", &frameParser.frames);
+static MetricCounterRef bleFramesSplit("ble_frames_split_total", "Frames reassembled across notifications", &frameParser.splitFrames);
+static MetricCounterRef bleFramesMerged("ble_frames_merged_total", "Frames sharing a notification with an earlier one", &frameParser.mergedFrames);
+static MetricCounterRef bleFrameChecksumErrors("ble_frame_checksum_errors_total", "Frames dropped for a bad checksum", &frameParser.checksumErrors);
+static MetricCounterRef bleFrameSkippedBytes("ble_frame_skipped_bytes_total", "Notification bytes outside any valid frame", &frameParser.skippedBytes);
+
+// Scale names only: ArduinoBLE drops every other advertiser's report before allocating for it
+static const BLEScanFilter *scaleScanFilter()
+{
+    static BLEScanFilter filter = {NULL, 0, NULL, 0, -1};
+    if (filter.namePrefixes == NULL)
+    {
+        size_t count;
+        filter.namePrefixes = scaleNamePrefixes(&count);
+        filter.namePrefixCount = count;
+    }
+    return &filter;
+}
+
+static void stopScaleScan()
+{
+    BLE.stopScan();
+
+    uint32_t reports, dropped;
+    BLE.scanFilterStats(&reports, &dropped);
+    bleScanReports.add(reports);
+    bleScanDropped.add(dropped);
+    LOG_DEBUG(LOG_TAG_BLE, "📡 Scan ended: %lu advertising reports, %lu from other devices dropped",
+              (unsigned long)reports, (unsigned long)dropped);
+}
+
+static const ScalePacket *packetPeek()
+{
+    uint32_t tail = packetTail;
+    if (tail == packetHead)
+    {
+        return NULL;
+    }
+    __sync_synchronize();  // Read the packet only after seeing the new head
+    return &packetRing[tail & (PACKET_RING_SIZE - 1)];
+}
+
+static void packetPop()
+{
+    packetTail = packetTail + 1;
+}
+
+
+// BLEUpdated handler for _read: runs inside HCI.poll() while ATTClass::handleNotify()
+// stores the value, so every notification is captured even if several arrive per poll
+static void GS_HOT_IRAM onReadUpdated(BLEDevice device, BLECharacteristic characteristic)
+{
+    uint32_t head = packetHead;
+    if (head - packetTail >= PACKET_RING_SIZE)
+    {
+        packetsDropped = packetsDropped + 1;
+        return;
+    }
+
+    ScalePacket &slot = packetRing[head & (PACKET_RING_SIZE - 1)];
+    int length = characteristic.valueLength();
+    slot.timestampUs = esp_timer_get_time();
+    GS_PROBE_TOGGLE(PROBE_PACKET);
+    if (lastNotifyUs)
+    {
+        bleNotifyIntervalMs.record((uint32_t)((slot.timestampUs - lastNotifyUs) / 1000));
+    }
+    lastNotifyUs = slot.timestampUs;
+    slot.length = (length > PACKET_MAX_LEN) ? PACKET_MAX_LEN : length;
+    memcpy(slot.data, characteristic.value(), slot.length);
+    __sync_synchronize();  // Packet contents visible before the index moves
+    packetHead = head + 1;
+
+    TaskHandle_t task = eventTask;
+    if (task != NULL)
+    {
+        xTaskNotify(task, notifyEventBits, eSetBits);
+    }
+}
 
 
 AcaiaArduinoBLE::AcaiaArduinoBLE()
 {
-    _currentWeight = 999;
+    _currentWeightCg = 99900;  // 999 g = "no reading yet"
     _connected = false;
+    _driver = NULL;
+    _connState = CONN_IDLE;
+    _connStateStart = 0;
+    _scanStart = 0;
+    _stateCallback = NULL;
+    _commandCallback = NULL;
+    _gattCacheUsed = false;
+    _lastScaleLoaded = false;
+    memset(_writesInFlight, 0, sizeof(_writesInFlight));
+    _targetedScan = false;
+    _targetedNext = true;
+    _fastScanUntil = 0;
+    _lowLatency = false;
+    _writeNoResponse = false;
+    _shotStartUs = 0;
+    _shotStartTare = true;
+    _acks = 0;
+    memset(_ackUs, 0, sizeof(_ackUs));
+    _currentBattery = -1;
+    _scaleTimerMs = 0;
+    _lastHeartBeat = 0;
+    _lastSettingsRequest = 0;
+    _link = LinkStats();
+    _link.rssi = _link.rssiMin = LINK_RSSI_UNKNOWN;
+    _lastRssiPoll = 0;
     _packetPeriod = 0;
+    _lastPacket = 0;
+    _packetTimeUs = 0;
+    _candidateCount = 0;
+    _candidateGeneration = 0;
+    _candidateIndex = -1;
+    _collectUntil = 0;
+    _failover = false;
 }
 
+// Blocking connect for simple sketches: runs the state machine to completion
 bool AcaiaArduinoBLE::init(String mac)
 {
+    if (!beginConnect(mac))
+    {
+        return false;
+    }
+
+    while (isConnecting())
+    {
+        poll();
+        watchdogCheckIn(WATCHDOG_BLE_HOST);
+        delay(1);
+    }
+    return _connState == CONN_CONNECTED;
+}
+
+// Start a connection attempt and return immediately; drive it with poll()
+bool AcaiaArduinoBLE::beginConnect(String mac)
+{
+    if (isConnecting())
+    {
+        LOG_WARN(LOG_TAG_BLE, "⚠️  Connection already in progress (%s)", connectionStateName(_connState));
+        return false;
+    }
+
+    // Boot or a lost connection: the scale is probably being switched on right now
+    if (_fastScanUntil == 0 || _connState == CONN_CONNECTED)
+    {
+        _fastScanUntil = millis() + SCAN_FAST_PERIOD_MS;
+    }
+
+    if (!_lastScaleLoaded)
+    {
+        _lastScale = gattCacheLastScale();
+        _lastScaleLoaded = true;
+    }
+
     // CRITICAL FIX: Ensure clean BLE state before reconnection
     // ArduinoBLE can retain stale connection state after disconnect,
     // causing subscription to fail on reconnect. Force cleanup here.
-    BLE.disconnect();  // Close any existing connection
-    delay(500);        // Give BLE stack and scale time to reset (tested: 500ms minimum)
+    BLE.disconnectPeripherals();  // Close any existing scale link (broadcast clients stay)
 
-    unsigned long start = millis();
+    _connected = false;
+    _mac = mac;
     _lastPacket = 0;
+    _packetTimeUs = 0;
+    _currentBattery = -1;
+    _lastSettingsRequest = 0;  // Ask the new scale right after it connects
+    packetTail = packetHead;  // Discard packets left over from the previous connection
+    packetOffset = 0;
+    frameParser.reset();
 
-    if (mac == "")
+    _gattCacheUsed = false;
+    _candidateIndex = -1;
+    portENTER_CRITICAL(&candidateMux);
+    for (int i = 0; i < _candidateCount; i++)
     {
-        BLE.scan();
-    }
-    else if (!BLE.scanForAddress(mac))
-    {
-        LOG_ERROR("BLE", "❌ Failed to find scale MAC: %s", mac.c_str());
-        return false;
+        _candidates[i].connected = false;
     }
+    portEXIT_CRITICAL(&candidateMux);
+    setState(CONN_SETTLING);  // Scan starts once CONNECT_SETTLE_MS has passed
+    return true;
+}
 
-    do
+// Advance the connection attempt by one step. Scanning and settling never block;
+// connect() and discoverAttributes() still wait on ArduinoBLE for their own reply
+ConnectionState AcaiaArduinoBLE::poll()
+{
+    switch (_connState)
     {
-        BLEDevice peripheral = BLE.available();
-        if (peripheral && isScaleName(peripheral.localName()))
+        case CONN_IDLE:
+        case CONN_CONNECTED:
+        case CONN_FAILED:
+            break;
+
+        case CONN_SETTLING:
         {
-            BLE.stopScan();
+            if (millis() - _connStateStart < CONNECT_SETTLE_MS)
+            {
+                break;
+            }
 
-            LOG_INFO("BLE", "🔗 Connecting to scale...");
-            if (peripheral.connect())
+            // Last attempt failed (or a scale was picked): the next candidate is still in range
+            if (_failover && _mac == "")
             {
-                LOG_INFO("BLE", "✅ Connected to scale");
+                _failover = false;
+                int next = bestCandidate(true);
+                if (next >= 0)
+                {
+                    LOG_INFO(LOG_TAG_BLE, "🔁 Trying %s without a new scan", _candidates[next].address);
+                    connectCandidate(next);
+                    break;
+                }
+            }
+
+            bool fast = (long)(_fastScanUntil - millis()) > 0;
+            if (fast)
+            {
+                BLE.setScanParameters(SCAN_FAST_INTERVAL, SCAN_FAST_WINDOW);
             }
             else
             {
-                LOG_ERROR("BLE", "❌ Failed to connect to scale");
-                return false;
+                BLE.setScanParameters(SCAN_SLOW_INTERVAL, SCAN_SLOW_WINDOW);
             }
 
-            LOG_INFO("BLE", "🔍 Discovering BLE characteristics...");
+            // No explicit MAC: the remembered scale first, every other attempt open (new scale)
+            String target = _mac;
+            _targetedScan = false;
+            if (target == "" && _lastScale != "")
+            {
+                _targetedScan = _targetedNext;
+                _targetedNext = !_targetedNext;
+                if (_targetedScan)
+                {
+                    target = _lastScale;
+                }
+            }
 
-            // CRITICAL: discoverAttributes() is BLOCKING and can take 1-10+ seconds
-            // This causes watchdog timeout if it takes too long. Feed watchdog before/after.
-            esp_task_wdt_reset();  // Reset watchdog before blocking call
+            BLE.setScanFilter(scaleScanFilter());
+            if (target == "")
+            {
+                clearCandidates();  // Open scan: the settings list shows what it finds
+                BLE.scan();
+            }
+            else if (!BLE.scanForAddress(target))
+            {
+                LOG_ERROR(LOG_TAG_BLE, "❌ Failed to find scale MAC: %s", target.c_str());
+                connectFailed();
+                break;
+            }
+            LOG_DEBUG(LOG_TAG_BLE, "📡 Scanning %s (%s duty cycle)",
+                      target == "" ? "for any scale" : target.c_str(), fast ? "fast" : "low");
+            _scanStart = millis();
+            setState(CONN_SCANNING);
+            break;
+        }
 
-            unsigned long discovery_start = millis();
-            bool discovery_success = peripheral.discoverAttributes();
-            unsigned long discovery_time = millis() - discovery_start;
+        case CONN_SCANNING:
+        {
+            BLEDevice peripheral = BLE.available();
+            if (peripheral && isScaleName(peripheral.localName()))
+            {
+                int index = addCandidate(peripheral);
+                // Targeted scan or the remembered scale: nothing better will turn up
+                if (index >= 0 && (_targetedScan || _mac != "" || _candidates[index].lastUsed))
+                {
+                    stopScaleScan();
+                    connectCandidate(index);
+                    break;
+                }
+                if (_collectUntil == 0)
+                {
+                    _collectUntil = millis() + SCAN_COLLECT_MS;
+                }
+            }
 
-            esp_task_wdt_reset();  // Reset watchdog after blocking call
+            if (_collectUntil != 0 && ((long)(millis() - _collectUntil) >= 0 || _candidateCount == SCAN_MAX_CANDIDATES))
+            {
+                stopScaleScan();
+                connectCandidate(bestCandidate(false));
+            }
+            else if (millis() - _scanStart >= SCAN_TIMEOUT_MS)
+            {
+                stopScaleScan();
+                LOG_WARN(LOG_TAG_BLE, "⏱️  Scan timeout - scale not found");
+                connectFailed();
+            }
+            break;
+        }
 
-            if (discovery_success)
+        case CONN_CONNECTING:
+            LOG_INFO(LOG_TAG_BLE, "🔗 Connecting to scale...");
+            watchdogExpect(WATCHDOG_BLE_HOST, BLOCKING_CALL_WATCHDOG_MS);
+            if (_pendingPeripheral.connect())
             {
-                LOG_INFO("BLE", "✅ Characteristics discovered (took %lums)", discovery_time);
+                LOG_INFO(LOG_TAG_BLE, "✅ Connected to scale");
+                setState(CONN_DISCOVERING);
             }
             else
             {
-                LOG_ERROR("BLE", "❌ Characteristic discovery failed (took %lums)", discovery_time);
-                LOG_ERROR("BLE", "    This usually means scale BLE stack is still resetting");
-                LOG_ERROR("BLE", "    Will retry on next init() call");
-                peripheral.disconnect();
-                return false;
+                LOG_ERROR(LOG_TAG_BLE, "❌ Failed to connect to scale");
+                connectFailed();
             }
+            break;
 
-            // Determine type of scale
-            if (peripheral.characteristic(READ_CHAR_OLD_VERSION).canSubscribe())
+        case CONN_DISCOVERING:
+        {
+            String address = _pendingPeripheral.address();
+            BLEAttributeCache cache;
+            unsigned long discovery_start = millis();
+
+            negotiateLink();  // Before discovery so its responses already use the larger MTU
+
+            // Known scale: restore its handles (one verification request each) instead of discovery
+            _gattCacheUsed = gattCacheLoad(address, &cache) && _pendingPeripheral.restoreAttributes(&cache);
+            if (_gattCacheUsed)
             {
-                LOG_INFO("BLE", "📊 Old version Acaia detected");
-                _type = OLD;
-                _write = peripheral.characteristic(WRITE_CHAR_OLD_VERSION);
-                _read = peripheral.characteristic(READ_CHAR_OLD_VERSION);
+                LOG_INFO(LOG_TAG_BLE, "✅ Cached GATT handles verified (took %lums)", millis() - discovery_start);
+                if (!selectDriver())
+                {
+                    connectFailed();
+                    break;
+                }
+                setState(CONN_SUBSCRIBING);
+                break;
             }
-            else if (peripheral.characteristic(READ_CHAR_NEW_VERSION).canSubscribe())
+
+            LOG_INFO(LOG_TAG_BLE, "🔍 Discovering BLE characteristics...");
+
+            // Only the READ/WRITE characteristics some driver uses - the full walk of every
+            // service and descriptor took 1-10 s. Still BLOCKING: feed watchdog before/after.
+            size_t driverCount;
+            const ScaleDriver *const *drivers = scaleDrivers(&driverCount);
+            const char *discoverUuids[2 * driverCount];
+            int uuidCount = 0;
+            for (size_t i = 0; i < driverCount; i++)
             {
-                LOG_INFO("BLE", "📊 New version Acaia detected");
-                _type = NEW;
-                _write = peripheral.characteristic(WRITE_CHAR_NEW_VERSION);
-                _read = peripheral.characteristic(READ_CHAR_NEW_VERSION);
+                discoverUuids[uuidCount++] = drivers[i]->readUuid();
+                if (strcasecmp(drivers[i]->writeUuid(), drivers[i]->readUuid()) != 0)
+                {
+                    discoverUuids[uuidCount++] = drivers[i]->writeUuid();
+                }
             }
-            else if (peripheral.characteristic(READ_CHAR_GENERIC).canSubscribe())
+
+            watchdogExpect(WATCHDOG_BLE_HOST, BLOCKING_CALL_WATCHDOG_MS);  // Blocks on ArduinoBLE
+
+            bool discovery_success = _pendingPeripheral.discoverAttributes(discoverUuids, uuidCount);
+            unsigned long discovery_time = millis() - discovery_start;
+
+            watchdogCheckIn(WATCHDOG_BLE_HOST);
+
+            if (discovery_success)
             {
-                LOG_INFO("BLE", "📊 Generic scale detected");
-                _type = GENERIC;
-                _write = peripheral.characteristic(WRITE_CHAR_GENERIC);
-                _read = peripheral.characteristic(READ_CHAR_GENERIC);
+                LOG_INFO(LOG_TAG_BLE, "✅ Characteristics discovered (took %lums)", discovery_time);
             }
             else
             {
-                LOG_ERROR("BLE", "❌ Unable to determine scale type");
-                return false;
+                LOG_ERROR(LOG_TAG_BLE, "❌ Characteristic discovery failed (took %lums)", discovery_time);
+                LOG_ERROR(LOG_TAG_BLE, "    This usually means scale BLE stack is still resetting");
+                LOG_ERROR(LOG_TAG_BLE, "    Will retry on next connection attempt");
+                _pendingPeripheral.disconnect();
+                connectFailed();
+                break;
+            }
+
+            if (!selectDriver())
+            {
+                connectFailed();
+                break;
             }
 
+            const char *const uuids[] = {_driver->readUuid(), _driver->writeUuid()};
+            if (_pendingPeripheral.exportAttributes(uuids, 2, &cache))
+            {
+                gattCacheStore(address, cache);
+            }
+            setState(CONN_SUBSCRIBING);
+            break;
+        }
+
+        case CONN_SUBSCRIBING:
             if (!_read.canSubscribe())
             {
-                LOG_ERROR("BLE", "❌ Unable to subscribe to READ characteristic");
-                return false;
+                LOG_ERROR(LOG_TAG_BLE, "❌ Unable to subscribe to READ characteristic");
+                connectFailed();
             }
             else if (!_read.subscribe())
             {
-                LOG_ERROR("BLE", "❌ Subscription to READ characteristic failed");
-                return false;
+                LOG_ERROR(LOG_TAG_BLE, "❌ Subscription to READ characteristic failed");
+                connectFailed();
             }
             else
             {
-                LOG_INFO("BLE", "✅ Subscribed to weight notifications");
+                LOG_INFO(LOG_TAG_BLE, "✅ Subscribed to weight notifications");
+                _read.setEventHandler(BLEUpdated, onReadUpdated);
+                setState(CONN_IDENTIFYING);
             }
+            break;
 
-            if (_write.writeValue(IDENTIFY, 20))
+        case CONN_IDENTIFYING:
+            if (sendCommand(SCALE_CMD_IDENTIFY))
             {
-                LOG_DEBUG("BLE", "✅ IDENTIFY command sent");
+                LOG_DEBUG(LOG_TAG_BLE, "✅ IDENTIFY command sent");
+                setState(CONN_NOTIFICATIONS);
             }
             else
             {
-                LOG_ERROR("BLE", "❌ IDENTIFY command failed");
-                return false;
+                LOG_ERROR(LOG_TAG_BLE, "❌ IDENTIFY command failed");
+                connectFailed();
             }
-            if (_write.writeValue(NOTIFICATION_REQUEST, 14))
+            break;
+
+        case CONN_NOTIFICATIONS:
+            if (sendCommand(SCALE_CMD_NOTIFICATION_IDLE))  // Idle rate until a shot asks for more
             {
-                LOG_DEBUG("BLE", "✅ NOTIFICATION_REQUEST sent");
+                LOG_DEBUG(LOG_TAG_BLE, "✅ NOTIFICATION_REQUEST sent (idle rate)");
+                _connected = true;
+                _packetPeriod = 0;
+                _link = LinkStats();
+                _link.connectedAtMs = millis();
+                _link.rssi = _link.rssiMin = LINK_RSSI_UNKNOWN;
+                _link.attMtu = _pendingPeripheral.mtu();
+                _pendingPeripheral.dataLength(&_link.txOctets, &_link.rxOctets);
+                _lastRssiPoll = 0;
+                lastNotifyUs = 0;
+                bleConnections.add();
+                _targetedNext = true;  // Reconnects go straight for this scale
+                _lastScale = _pendingPeripheral.address();
+                gattCacheRememberScale(_lastScale);
+                portENTER_CRITICAL(&candidateMux);
+                for (int i = 0; i < _candidateCount; i++)
+                {
+                    _candidates[i].connected = (i == _candidateIndex);
+                    _candidates[i].lastUsed = (i == _candidateIndex);
+                }
+                portEXIT_CRITICAL(&candidateMux);
+                requestLinkProfile(false);  // Relaxed until a shot asks for low latency
+                setState(CONN_CONNECTED);
             }
             else
             {
-                LOG_ERROR("BLE", "❌ NOTIFICATION_REQUEST failed");
-                return false;
+                LOG_ERROR(LOG_TAG_BLE, "❌ NOTIFICATION_REQUEST failed");
+                connectFailed();
             }
-            _connected = true;
-            _packetPeriod = 0;
-            return true;
+            break;
+    }
+
+    return _connState;
+}
+
+ConnectionState AcaiaArduinoBLE::connectionState()
+{
+    return _connState;
+}
+
+// True while an attempt started by beginConnect() is still running
+bool AcaiaArduinoBLE::isConnecting()
+{
+    return _connState != CONN_IDLE && _connState != CONN_CONNECTED && _connState != CONN_FAILED;
+}
+
+// Called from poll() (the polling task) on every state change
+// Protocol of the connected scale (NULL until one was detected)
+const ScaleDriver *AcaiaArduinoBLE::driver()
+{
+    return _driver;
+}
+
+void AcaiaArduinoBLE::setStateCallback(ConnectionStateCallback callback)
+{
+    _stateCallback = callback;
+}
+
+void AcaiaArduinoBLE::setCommandCallback(CommandTraceCallback callback)
+{
+    _commandCallback = callback;
+}
+
+void AcaiaArduinoBLE::setState(ConnectionState state)
+{
+    if (_connState == CONN_CONNECTED && state != CONN_CONNECTED)
+    {
+        logLinkStats();
+    }
+    _connState = state;
+    _connStateStart = millis();
+    crashRingRecord(CRASH_EV_BLE_STATE, (uint16_t)state);
+    if (_stateCallback)
+    {
+        _stateCallback(state);
+    }
+}
+
+// Determine type of scale: first driver whose READ characteristic can subscribe
+bool AcaiaArduinoBLE::selectDriver()
+{
+    size_t driverCount;
+    const ScaleDriver *const *drivers = scaleDrivers(&driverCount);
+    _driver = NULL;
+    for (size_t i = 0; i < driverCount; i++)
+    {
+        if (_pendingPeripheral.characteristic(drivers[i]->readUuid()).canSubscribe())
+        {
+            _driver = drivers[i];
+            break;
         }
-        // CRITICAL FIX: LVGL calls REMOVED for dual-core ESP32-S3
-        // On single-core systems, LVGLTimerHandlerRoutine() kept UI responsive during 10s scan
-        // On dual-core ESP32-S3: Core 0 (BLE) + Core 1 (UI) both calling LVGL → race condition → crashes
-        // Core 1 handles all LVGL operations - Core 0 BLE task must NOT touch LVGL
-        // Watchdog is fed in bleTaskFunction() every 10ms - no timeout risk
+    }
+
+    if (_driver == NULL)
+    {
+        LOG_ERROR(LOG_TAG_BLE, "❌ Unable to determine scale type");
+        return false;
+    }
+    LOG_INFO(LOG_TAG_BLE, "📊 %s scale detected", _driver->name());
+    _write = _pendingPeripheral.characteristic(_driver->writeUuid());
+    _read = _pendingPeripheral.characteristic(_driver->readUuid());
+    _writeNoResponse = (_write.properties() & BLEWriteWithoutResponse) != 0;
+    return true;
+}
 
-        // Feed watchdog to prevent interrupt watchdog timeout during 10s scan
-        // BLE scan takes 10s but interrupt watchdog timeout is 3s
-        esp_task_wdt_reset();
+void AcaiaArduinoBLE::connectFailed()
+{
+    // Handles restored from NVS got us this far but not further: rediscover next time
+    if (_gattCacheUsed && _pendingPeripheral)
+    {
+        LOG_WARN(LOG_TAG_BLE, "⚠️  Dropping cached GATT handles for %s", _pendingPeripheral.address().c_str());
+        gattCacheForget(_pendingPeripheral.address());
+    }
+    _gattCacheUsed = false;
+    _connected = false;
+    _pendingPeripheral = BLEDevice();
 
-    } while (millis() - start < 10000);  // 10s timeout (matches upstream - tested for reconnection)
+    // Fast failover: the next attempt connects to the next candidate still in range
+    if (_candidateIndex >= 0)
+    {
+        portENTER_CRITICAL(&candidateMux);
+        _candidates[_candidateIndex].failed = true;
+        _candidates[_candidateIndex].connected = false;
+        portEXIT_CRITICAL(&candidateMux);
+        _candidateIndex = -1;
+        _failover = bestCandidate(true) >= 0;
+    }
+    setState(CONN_FAILED);
+}
 
-    LOG_WARN("BLE", "⏱️  Scan timeout - scale not found");
-    return false;
+void AcaiaArduinoBLE::clearCandidates()
+{
+    portENTER_CRITICAL(&candidateMux);
+    _candidateCount = 0;
+    _candidateGeneration++;
+    portEXIT_CRITICAL(&candidateMux);
+    _candidateIndex = -1;
+    _collectUntil = 0;
+}
+
+// Add or refresh a scale seen while scanning; a full table keeps the strongest ones
+int AcaiaArduinoBLE::addCandidate(BLEDevice &peripheral)
+{
+    String address = peripheral.address();
+    String name = peripheral.localName();
+    int rssi = peripheral.rssi();
+
+    int index = -1;
+    for (int i = 0; i < _candidateCount; i++)
+    {
+        if (address.equalsIgnoreCase(_candidates[i].address))
+        {
+            index = i;
+            break;
+        }
+    }
+    if (index < 0 && _candidateCount < SCAN_MAX_CANDIDATES)
+    {
+        index = _candidateCount;
+    }
+    else if (index < 0)
+    {
+        int weakest = 0;
+        for (int i = 1; i < _candidateCount; i++)
+        {
+            if (_candidates[i].rssi < _candidates[weakest].rssi)
+            {
+                weakest = i;
+            }
+        }
+        if (rssi <= _candidates[weakest].rssi)
+        {
+            return -1;
+        }
+        index = weakest;
+    }
+
+    _candidateDevices[index] = peripheral;
+    ScaleCandidate entry = {};
+    snprintf(entry.address, sizeof(entry.address), "%s", address.c_str());
+    snprintf(entry.name, sizeof(entry.name), "%s", name.c_str());
+    entry.rssi = (int8_t)constrain(rssi, -127, 0);
+    entry.seenMs = millis();
+    entry.lastUsed = _lastScale != "" && address.equalsIgnoreCase(_lastScale);
+
+    portENTER_CRITICAL(&candidateMux);
+    _candidates[index] = entry;
+    if (index == _candidateCount)
+    {
+        _candidateCount++;
+    }
+    portEXIT_CRITICAL(&candidateMux);
+
+    LOG_DEBUG(LOG_TAG_BLE, "📡 Scale candidate %s \"%s\" %d dBm%s", entry.address, entry.name, rssi,
+              entry.lastUsed ? " (last used)" : "");
+    return index;
+}
+
+// Ranking: not failed, then the remembered scale, then the strongest RSSI; -1 if none
+int AcaiaArduinoBLE::bestCandidate(bool freshOnly)
+{
+    int best = -1;
+    for (int i = 0; i < _candidateCount; i++)
+    {
+        const ScaleCandidate &c = _candidates[i];
+        if (c.failed || (freshOnly && millis() - c.seenMs > CANDIDATE_FRESH_MS))
+        {
+            continue;
+        }
+        if (best < 0 || (c.lastUsed && !_candidates[best].lastUsed) ||
+            (c.lastUsed == _candidates[best].lastUsed && c.rssi > _candidates[best].rssi))
+        {
+            best = i;
+        }
+    }
+    return best;
+}
+
+void AcaiaArduinoBLE::connectCandidate(int index)
+{
+    _collectUntil = 0;
+    if (index < 0)
+    {
+        LOG_WARN(LOG_TAG_BLE, "⚠️  No usable scale among %d candidates", _candidateCount);
+        connectFailed();
+        return;
+    }
+    if (_candidateCount > 1)
+    {
+        LOG_INFO(LOG_TAG_BLE, "🎯 Picked %s (%d dBm%s) of %d scales", _candidates[index].address,
+                 _candidates[index].rssi, _candidates[index].lastUsed ? ", last used" : "", _candidateCount);
+    }
+    _candidateIndex = index;
+    _pendingPeripheral = _candidateDevices[index];
+    setState(CONN_CONNECTING);
+}
+
+// Snapshot for the settings screen (any task); `generation` identifies the table for selectScale()
+int AcaiaArduinoBLE::scaleCandidates(ScaleCandidate *out, int maxCount, uint8_t *generation)
+{
+    portENTER_CRITICAL(&candidateMux);
+    int count = min((int)_candidateCount, maxCount);
+    for (int i = 0; i < count; i++)
+    {
+        out[i] = _candidates[i];
+    }
+    *generation = _candidateGeneration;
+    portEXIT_CRITICAL(&candidateMux);
+    return count;
+}
+
+// BLE task: make candidate `index` the preferred scale and switch to it (-1 = no preference,
+// the next open scan ranks by RSSI). False if the table changed since the snapshot
+bool AcaiaArduinoBLE::selectScale(uint8_t generation, int index)
+{
+    if (generation != _candidateGeneration || index >= (int)_candidateCount)
+    {
+        return false;
+    }
+
+    if (index < 0)
+    {
+        LOG_INFO(LOG_TAG_BLE, "🎯 No preferred scale - strongest signal wins");
+        _lastScale = "";
+        gattCacheRememberScale(_lastScale);
+        portENTER_CRITICAL(&candidateMux);
+        for (int i = 0; i < _candidateCount; i++)
+        {
+            _candidates[i].lastUsed = false;
+        }
+        portEXIT_CRITICAL(&candidateMux);
+        return true;
+    }
+
+    String address = _candidates[index].address;
+    _lastScale = address;
+    gattCacheRememberScale(_lastScale);
+    _targetedNext = true;
+    portENTER_CRITICAL(&candidateMux);
+    for (int i = 0; i < _candidateCount; i++)
+    {
+        _candidates[i].lastUsed = (i == index);
+        _candidates[i].failed = false;  // A deliberate choice gets a fresh try
+    }
+    portEXIT_CRITICAL(&candidateMux);
+
+    if (_connected && _candidateIndex == index)
+    {
+        return true;
+    }
+
+    LOG_INFO(LOG_TAG_BLE, "🎯 Switching to scale %s", address.c_str());
+    if (_connState == CONN_SCANNING)
+    {
+        stopScaleScan();
+    }
+    _collectUntil = 0;
+    setState(CONN_IDLE);  // Abandon the running attempt or connection; beginConnect() closes the link
+    _failover = true;     // Connect straight away if it was seen recently
+    return beginConnect("");
+}
+
+// BLE task: drop the scale link (or the running attempt) and connect again, same preference
+bool AcaiaArduinoBLE::reconnect()
+{
+    LOG_INFO(LOG_TAG_BLE, "🔄 Reconnect requested (%s)", connectionStateName(_connState));
+    if (_connState == CONN_SCANNING)
+    {
+        stopScaleScan();
+    }
+    _collectUntil = 0;
+    setState(CONN_IDLE);  // beginConnect() closes the link
+    _failover = true;     // Straight back to the scale just dropped, if it was seen recently
+    return beginConnect("");
+}
+
+const char *connectionStateName(ConnectionState state)
+{
+    switch (state)
+    {
+        case CONN_IDLE:          return "IDLE";
+        case CONN_SETTLING:      return "SETTLING";
+        case CONN_SCANNING:      return "SCANNING";
+        case CONN_CONNECTING:    return "CONNECTING";
+        case CONN_DISCOVERING:   return "DISCOVERING";
+        case CONN_SUBSCRIBING:   return "SUBSCRIBING";
+        case CONN_IDENTIFYING:   return "IDENTIFYING";
+        case CONN_NOTIFICATIONS: return "NOTIFICATIONS";
+        case CONN_CONNECTED:     return "CONNECTED";
+        case CONN_FAILED:        return "FAILED";
+    }
+    return "UNKNOWN";
 }
 
 bool AcaiaArduinoBLE::tare()
@@ -188,20 +817,20 @@ bool AcaiaArduinoBLE::tare()
     // CRITICAL: Check if characteristic is still valid
     if (!_write)
     {
-        LOG_ERROR("BLE", "❌ Tare failed: write characteristic is NULL");
+        LOG_ERROR(LOG_TAG_BLE, "❌ Tare failed: write characteristic is NULL");
         _connected = false;
         return false;
     }
 
-    if (_write.writeValue((_type == GENERIC ? TARE_GENERIC : TARE_ACAIA), 20))
+    if (sendCommand(SCALE_CMD_TARE))
     {
-        LOG_INFO("BLE", "⚖️  Tare command sent");
+        LOG_INFO(LOG_TAG_BLE, "⚖️  Tare command sent");
         return true;
     }
     else
     {
         _connected = false;
-        LOG_ERROR("BLE", "❌ Tare command failed");
+        LOG_ERROR(LOG_TAG_BLE, "❌ Tare command failed");
         return false;
     }
 }
@@ -211,20 +840,20 @@ bool AcaiaArduinoBLE::startTimer()
     // CRITICAL: Check if characteristic is still valid
     if (!_write)
     {
-        LOG_ERROR("BLE", "❌ Start timer failed: write characteristic is NULL");
+        LOG_ERROR(LOG_TAG_BLE, "❌ Start timer failed: write characteristic is NULL");
         _connected = false;
         return false;
     }
 
-    if (_write.writeValue(START_TIMER, 7))
+    if (sendCommand(SCALE_CMD_START_TIMER))
     {
-        LOG_DEBUG("BLE", "▶️  Start timer command sent");
+        LOG_DEBUG(LOG_TAG_BLE, "▶️  Start timer command sent");
         return true;
     }
     else
     {
         _connected = false;
-        LOG_ERROR("BLE", "❌ Start timer command failed");
+        LOG_ERROR(LOG_TAG_BLE, "❌ Start timer command failed");
         return false;
     }
 }
@@ -234,20 +863,20 @@ bool AcaiaArduinoBLE::stopTimer()
     // CRITICAL: Check if characteristic is still valid
     if (!_write)
     {
-        LOG_ERROR("BLE", "❌ Stop timer failed: write characteristic is NULL");
+        LOG_ERROR(LOG_TAG_BLE, "❌ Stop timer failed: write characteristic is NULL");
         _connected = false;
         return false;
     }
 
-    if (_write.writeValue(STOP_TIMER, 7))
+    if (sendCommand(SCALE_CMD_STOP_TIMER))
     {
-        LOG_DEBUG("BLE", "⏸️  Stop timer command sent");
+        LOG_DEBUG(LOG_TAG_BLE, "⏸️  Stop timer command sent");
         return true;
     }
     else
     {
         _connected = false;
-        LOG_ERROR("BLE", "❌ Stop timer command failed");
+        LOG_ERROR(LOG_TAG_BLE, "❌ Stop timer command failed");
         return false;
     }
 }
@@ -257,22 +886,82 @@ bool AcaiaArduinoBLE::resetTimer()
     // CRITICAL: Check if characteristic is still valid
     if (!_write)
     {
-        LOG_ERROR("BLE", "❌ Reset timer failed: write characteristic is NULL");
+        LOG_ERROR(LOG_TAG_BLE, "❌ Reset timer failed: write characteristic is NULL");
         _connected = false;
         return false;
     }
 
-    if (_write.writeValue(RESET_TIMER, 7))
+    if (sendCommand(SCALE_CMD_RESET_TIMER))
     {
-        LOG_DEBUG("BLE", "🔄 Reset timer command sent");
+        LOG_DEBUG(LOG_TAG_BLE, "🔄 Reset timer command sent");
         return true;
     }
     else
     {
         _connected = false;
-        LOG_ERROR("BLE", "❌ Reset timer command failed");
+        LOG_ERROR(LOG_TAG_BLE, "❌ Reset timer command failed");
+        return false;
+    }
+}
+
+// Reset, tare and start timer back to back (write without response where supported).
+// The scale executes them in order; poll shotStartConfirmed() instead of waiting fixed delays.
+// tare = false leaves the tare out (the cup on the scale was tared already).
+bool AcaiaArduinoBLE::sendShotStart(bool tare)
+{
+    if (!_write)
+    {
+        LOG_ERROR(LOG_TAG_BLE, "❌ Shot start failed: write characteristic is NULL");
+        _connected = false;
         return false;
     }
+
+    _acks = 0;
+    memset(_ackUs, 0, sizeof(_ackUs));
+    _shotStartUs = esp_timer_get_time();
+    _shotStartTare = tare;
+    if (!sendCommand(SCALE_CMD_RESET_TIMER, false) ||
+        (tare && !sendCommand(SCALE_CMD_TARE, false)) ||
+        !sendCommand(SCALE_CMD_START_TIMER, false))
+    {
+        _shotStartUs = 0;
+        _connected = false;
+        LOG_ERROR(LOG_TAG_BLE, "❌ Shot start commands failed");
+        return false;
+    }
+
+    LOG_INFO(LOG_TAG_BLE, "⚡ Shot start batch sent (%s%s)", _writeNoResponse ? "without response" : "acknowledged",
+             tare ? "" : ", no tare");
+    return true;
+}
+
+// True once the scale has reported (or the weight shows) the tare from sendShotStart(); at once without one
+bool AcaiaArduinoBLE::shotStartConfirmed()
+{
+    return _shotStartUs && (!_shotStartTare || (_acks & SCALE_ACK(SCALE_CMD_TARE)));
+}
+
+// Arrival time (esp_timer us) of the scale's ack for one command of the batch, 0 = not (yet) seen
+int64_t AcaiaArduinoBLE::shotStartAckUs(ScaleCommand command)
+{
+    return (_shotStartUs && command <= SCALE_CMD_GET_SETTINGS) ? _ackUs[command] : 0;
+}
+
+void AcaiaArduinoBLE::noteAcks(uint32_t acks, int64_t timestampUs)
+{
+    uint32_t fresh = acks & ~_acks;
+    _acks |= acks;
+    for (int c = 0; c <= SCALE_CMD_GET_SETTINGS; c++)
+    {
+        if (fresh & SCALE_ACK(c))
+        {
+            _ackUs[c] = timestampUs;
+        }
+        if ((acks & SCALE_ACK(c)) && _commandCallback)
+        {
+            _commandCallback((ScaleCommand)c, true, true, timestampUs);
+        }
+    }
 }
 
 bool AcaiaArduinoBLE::heartbeat()
@@ -282,14 +971,15 @@ bool AcaiaArduinoBLE::heartbeat()
     // Accessing NULL characteristic causes LoadProhibited crash
     if (!_write)
     {
-        LOG_ERROR("BLE", "❌ Heartbeat failed: write characteristic is NULL");
+        LOG_ERROR(LOG_TAG_BLE, "❌ Heartbeat failed: write characteristic is NULL");
         _connected = false;
         return false;
     }
 
-    if (_write.writeValue(HEARTBEAT, 7))
+    // Without response where the characteristic allows it: a lost link shows up as the
+    // disconnect event or the packet watchdog, not as a blocking ATT round trip
+    if (sendCommand(SCALE_CMD_HEARTBEAT, false))
     {
-        _lastHeartBeat = millis();
         return true;
     }
     else
@@ -299,14 +989,20 @@ bool AcaiaArduinoBLE::heartbeat()
     }
 }
 
+// Float grams for display/model code - the packet path stays in integer centigrams
 float AcaiaArduinoBLE::getWeight()
 {
-    return _currentWeight;
+    return _currentWeightCg / 100.0f;
+}
+
+int32_t AcaiaArduinoBLE::getWeightCg()
+{
+    return _currentWeightCg;
 }
 
 bool AcaiaArduinoBLE::heartbeatRequired()
 {
-    if (_type == OLD || _type == NEW)
+    if (_driver && _driver->needsHeartbeat())
     {
         return (millis() - _lastHeartBeat) > HEARTBEAT_PERIOD_MS;
     }
@@ -316,6 +1012,18 @@ bool AcaiaArduinoBLE::heartbeatRequired()
     }
 }
 
+// Milliseconds until heartbeatRequired() turns true (0 = due now, ULONG_MAX = never)
+unsigned long AcaiaArduinoBLE::heartbeatDueIn()
+{
+    if (!_driver || !_driver->needsHeartbeat())
+    {
+        return ULONG_MAX;
+    }
+
+    unsigned long elapsed = millis() - _lastHeartBeat;
+    return (elapsed > HEARTBEAT_PERIOD_MS) ? 0 : (HEARTBEAT_PERIOD_MS - elapsed + 1);
+}
+
 bool AcaiaArduinoBLE::isConnected()
 {
     // First check our connection flag
@@ -329,7 +1037,7 @@ bool AcaiaArduinoBLE::isConnected()
     // characteristic handles, leading to NULL pointer crashes
     if (!_write || !_read)
     {
-        LOG_WARN("BLE", "⚠️  Characteristics became invalid (write=%p, read=%p)",
+        LOG_WARN(LOG_TAG_BLE, "⚠️  Characteristics became invalid (write=%p, read=%p)",
                  (void*)&_write, (void*)&_read);
         _connected = false;
         return false;
@@ -338,134 +1046,514 @@ bool AcaiaArduinoBLE::isConnected()
     return true;
 }
 
-bool AcaiaArduinoBLE::newWeightAvailable()
+bool GS_HOT_IRAM AcaiaArduinoBLE::newWeightAvailable()
 {
     // Check for connection timeout
     if (_lastPacket && millis() - _lastPacket > MAX_PACKET_PERIOD_MS)
     {
-        LOG_ERROR("BLE", "⏱️  Connection timeout - no weight packets for %lums", millis() - _lastPacket);
+        LOG_ERROR(LOG_TAG_BLE, "⏱️  Connection timeout - no weight packets for %lums", millis() - _lastPacket);
         _connected = false;
-        BLE.disconnect();
+        BLE.disconnectPeripherals();
         return false;
     }
 
-    byte input[] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
-    // input[2] == 12 weight message type && input[4] == 5 is to confirm got weight package
-    if (NEW == _type && _read.valueUpdated() && _read.readValue(input, 13) && input[2] == 0x0C && input[4] == 0x05)
+    if (packetPeek() == NULL)
     {
-        // Grab weight bytes (5 and 6)
-        //  apply scaling based on the unit byte (9)
-        //  get sign byte (10)
-        _currentWeight = (((input[6] & 0xff) << 8) + (input[5] & 0xff)) / pow(10, input[9]) * ((input[10] & 0x02) ? -1 : 1);
+        BLE.poll();  // Nothing buffered - let HCI deliver pending notifications
+    }
 
-        // Track packet timing
-        if (_lastPacket)
+    // One call per sample: other messages are handled on the way, stop at the oldest weight.
+    // Framed protocols go through frameParser; a packet is popped once all its bytes are fed
+    bool framed = _driver && _driver->framed();
+    const ScalePacket *packet;
+    while ((packet = packetPeek()) != NULL)
+    {
+        bool weight = false;
+        if (framed)
         {
-            _packetPeriod = millis() - _lastPacket;
+            ScalePacket frame;
+            while (!weight && frameParser.feed(*packet, &packetOffset, &frame))
+            {
+                weight = dispatchPacket(frame);
+            }
+            if (packetOffset < packet->length)
+            {
+                return true;  // More frames in this packet - next call continues at packetOffset
+            }
+            packetOffset = 0;
+        }
+        else
+        {
+            weight = dispatchPacket(*packet);
+        }
+        packetPop();
+        if (weight)
+        {
+            return true;
         }
-        _lastPacket = millis();
+    }
+    return false;
+}
 
-        return true;
+// Parse one notification (once) and hand it to the handler of its message type;
+// true if it was a weight sample
+bool GS_HOT_IRAM AcaiaArduinoBLE::dispatchPacket(const ScalePacket &packet)
+{
+    ScaleMessage message;
+    if (!_driver)
+    {
+        return false;
     }
-    else if (OLD == _type && _read.valueUpdated() && _read.valueLength() == 10 && _read.readValue(input, 10))
+
+    switch (_driver->parse(packet, &message))
     {
-        // Grab weight bytes (2 and 3),
-        //  apply scaling based on the unit byte (6)
-        //  get sign byte (7)
-        _currentWeight = (((input[3] & 0xff) << 8) + (input[2] & 0xff)) / pow(10, input[6]) * ((input[7] & 0x02) ? -1 : 1);
+        case SCALE_MSG_WEIGHT:
+            onWeight(packet, message.weightCg);
+            return true;
+
+        case SCALE_MSG_ACK:
+            if (_shotStartUs && packet.timestampUs > _shotStartUs)
+            {
+                noteAcks(message.acks, packet.timestampUs);
+            }
+            break;
+
+        case SCALE_MSG_SETTINGS:
+            if (message.batteryPct != _currentBattery)
+            {
+                LOG_INFO(LOG_TAG_BLE, "🔋 Scale battery %u%%", message.batteryPct);
+                scaleBatteryPct.set(message.batteryPct);
+            }
+            _currentBattery = message.batteryPct;
+            break;
+
+        case SCALE_MSG_TIMER:
+            _scaleTimerMs = message.timerMs;
+            break;
+
+        case SCALE_MSG_NONE:
+            break;
+    }
+    return false;
+}
+
+// Weight handler: new _currentWeightCg, packet timing, tare confirmation
+void GS_HOT_IRAM AcaiaArduinoBLE::onWeight(const ScalePacket &packet, int32_t weightCg)
+{
+    _currentWeightCg = weightCg;
 
-        // Track packet timing
-        if (_lastPacket)
+    // Track packet timing from arrival timestamps (not from when the consumer got to it)
+    if (_packetTimeUs)
+    {
+        _packetPeriod = (long)((packet.timestampUs - _packetTimeUs) / 1000);
+        if (_link.notifications > 0)
         {
-            _packetPeriod = millis() - _lastPacket;
+            noteWeightInterval(_packetPeriod);  // Not the gap across a reconnect
         }
-        _lastPacket = millis();
-
-        return true;
     }
-    else if (GENERIC == _type && _read.valueUpdated() && _read.readValue(input, 13))
+    _link.notifications++;
+    _packetTimeUs = packet.timestampUs;
+    _lastPacket = millis();
+
+    // Scales without command feedback: a zero reading after the batch means the tare landed
+    if (_shotStartUs && packet.timestampUs > _shotStartUs && abs(_currentWeightCg) <= TARE_CONFIRM_CG)
     {
-        // Grab weight bytes (3-8),
-        //  get sign byte (2)
-        _currentWeight = (input[2] == 0x2B ? 1 : -1) * ((input[3] - 0x30) * 1000 + (input[4] - 0x30) * 100 + (input[5] - 0x30) * 10 + (input[6] - 0x30) * 1 + (input[7] - 0x30) * 0.1 + (input[8] - 0x30) * 0.01);
+        noteAcks(SCALE_ACK(SCALE_CMD_TARE), packet.timestampUs);
+    }
+}
 
-        // Track packet timing
-        if (_lastPacket)
+bool AcaiaArduinoBLE::isScaleName(String name)
+{
+    size_t driverCount;
+    const ScaleDriver *const *drivers = scaleDrivers(&driverCount);
+    for (size_t i = 0; i < driverCount; i++)
+    {
+        if (drivers[i]->matchesName(name.c_str()))
         {
-            _packetPeriod = millis() - _lastPacket;
+            return true;
         }
-        _lastPacket = millis();
+    }
+    return false;
+}
 
+// Write the connected driver's frame for `command` (unsupported commands are a no-op)
+// withResponse = false uses write without response when the scale supports it
+// (returns once the frame is queued on the link, no ATT round trip)
+bool AcaiaArduinoBLE::sendCommand(ScaleCommand command, bool withResponse)
+{
+    ScaleFrame frame = _driver->encode(command);
+    if (frame.length == 0)
+    {
         return true;
     }
-    else
+    bool ok = timedWrite(frame.data, frame.length, withResponse || !_writeNoResponse);
+    if (_commandCallback)
     {
-        return false;
+        _commandCallback(command, false, ok, esp_timer_get_time());
     }
+    return ok;
 }
 
-bool AcaiaArduinoBLE::isScaleName(String name)
+// Write with latency accounting. With response it is queued in ATT and returns at once
+// (behind any request in flight, one per link); onWriteComplete() accounts the round trip
+// and drops the connection on a failure. Without, writeValue() returns once the frame is queued.
+// Every write restarts the heartbeat deadline: commands (tare, the shot start batch) stand in
+// for the next heartbeat, and heartbeatDueIn() moves the BLE task's wake-up with it.
+bool AcaiaArduinoBLE::timedWrite(const uint8_t *data, int length, bool withResponse)
 {
-    String nameShort = name.substring(0, 5);
+    int64_t start = esp_timer_get_time();
+    _link.writes++;
+    if (withResponse)
+    {
+        int id = _write.writeValueAsync(data, length, onWriteComplete, this);
+        if (id)
+        {
+            int slot = 0;
+            for (int i = 0; i < WRITES_IN_FLIGHT; i++)
+            {
+                if (_writesInFlight[i].id == 0)
+                {
+                    slot = i;
+                    break;
+                }
+            }
+            _writesInFlight[slot].id = id;
+            _writesInFlight[slot].startUs = start;
+            _lastHeartBeat = millis();  // A failed write drops the link in onWriteComplete()
+            return true;
+        }
+        // Queue full: the blocking write waits for the requests ahead of it
+    }
 
-    return nameShort == "CINCO" || nameShort == "ACAIA" || nameShort == "PYXIS" || nameShort == "LUNAR" || nameShort == "PROCH" || nameShort == "FELIC";
+    bool ok = _write.writeValue(data, length, withResponse);
+    noteWrite(withResponse, (uint32_t)(esp_timer_get_time() - start), ok);
+    if (ok)
+    {
+        _lastHeartBeat = millis();
+    }
+    return ok;
 }
 
-// Function to create request payload (setting payload byte [2] = 6)
-bool AcaiaArduinoBLE::getBattery()
+void AcaiaArduinoBLE::noteWrite(bool withResponse, uint32_t us, bool ok)
 {
-    byte payload[16] = {0};
-    byte bytes[5 + sizeof(payload)];
-    bytes[0] = HEADER1;
-    bytes[1] = HEADER2;
-    bytes[2] = 6; // get setting
-    int cksum1 = 0;
-    int cksum2 = 0;
+    (withResponse ? bleAttWriteUs : bleAttWriteCmdUs).record(us);
+    if (us > _link.writeMaxUs)
+    {
+        _link.writeMaxUs = us;
+    }
+    if (!ok)
+    {
+        _link.writeFailures++;
+        bleAttWriteFailures.add();
+    }
+}
 
-    for (int i = 0; i < sizeof(payload); i++)
+// Inside BLE.poll() (BLE task): write response, ATT error, timeout or disconnect
+void AcaiaArduinoBLE::onWriteComplete(int id, int status, const uint8_t * /*response*/, int /*length*/, void *context)
+{
+    AcaiaArduinoBLE *self = static_cast<AcaiaArduinoBLE *>(context);
+    int64_t start = 0;
+    for (int i = 0; i < WRITES_IN_FLIGHT; i++)
     {
-        byte val = payload[i] & 0xFF;
-        bytes[3 + i] = val;
-        if (i % 2 == 0)
-        {
-            cksum1 += val;
-        }
-        else
+        if (self->_writesInFlight[i].id == id)
         {
-            cksum2 += val;
+            start = self->_writesInFlight[i].startUs;
+            self->_writesInFlight[i].id = 0;
+            break;
         }
     }
 
-    bytes[sizeof(payload) + 3] = (cksum1 & 0xFF);
-    bytes[sizeof(payload) + 4] = (cksum2 & 0xFF);
+    self->noteWrite(true, start ? (uint32_t)(esp_timer_get_time() - start) : 0, status == 0);
+    if (status != 0)
+    {
+        LOG_WARN(LOG_TAG_BLE, "⚠️  Scale write failed (%s)",
+                 status == BLE_REQUEST_TIMEOUT ? "timeout" : status == BLE_REQUEST_DISCONNECTED ? "link lost" : "ATT error");
+        self->_connected = false;  // As the blocking write did: the main loop reconnects
+    }
+}
+
+// Settings (battery) request due: every SETTINGS_POLL_MS, never while the brewing
+// link profile is active - the reply arrives with the notifications (dispatchPacket())
+bool AcaiaArduinoBLE::settingsRequired()
+{
+    return settingsDueIn() == 0;
+}
+
+// Milliseconds until settingsRequired() turns true (ULONG_MAX = not while brewing / unsupported)
+unsigned long AcaiaArduinoBLE::settingsDueIn()
+{
+    if (!_driver || _lowLatency || _driver->encode(SCALE_CMD_GET_SETTINGS).length == 0)
+    {
+        return ULONG_MAX;
+    }
+    if (_lastSettingsRequest == 0)
+    {
+        return 0;
+    }
+
+    unsigned long elapsed = millis() - _lastSettingsRequest;
+    return (elapsed >= SETTINGS_POLL_MS) ? 0 : (SETTINGS_POLL_MS - elapsed);
+}
 
-    if (_write.writeValue(bytes, 21))
+// Ask for the scale settings without waiting for the ATT round trip where possible
+bool AcaiaArduinoBLE::requestSettings()
+{
+    _lastSettingsRequest = millis();
+    return sendCommand(SCALE_CMD_GET_SETTINGS, false);
+}
+
+// Battery percentage from the last settings reply, -1 until one arrived
+int AcaiaArduinoBLE::batteryValue()
+{
+    return _currentBattery;
+}
+
+// Shot timer as last reported by the scale (ms), 0 for scales without timer events
+uint32_t AcaiaArduinoBLE::scaleTimerMs()
+{
+    return _scaleTimerMs;
+}
+
+// Interval between the two most recent weight packets in ms (0 until two arrived)
+long AcaiaArduinoBLE::packetPeriod()
+{
+    return _packetPeriod;
+}
+
+// Arrival time (esp_timer_get_time) of the sample returned by getWeight()
+int64_t AcaiaArduinoBLE::packetTimeUs()
+{
+    return _packetTimeUs;
+}
+
+// Copy out up to maxPackets raw notifications, oldest first (consumer side of the ring).
+// Packets drained here are no longer seen by newWeightAvailable().
+size_t AcaiaArduinoBLE::drainPackets(ScalePacket *out, size_t maxPackets)
+{
+    size_t count = 0;
+    const ScalePacket *packet;
+    while (count < maxPackets && (packet = packetPeek()) != NULL)
     {
-        return true;
+        out[count++] = *packet;
+        packetPop();
     }
-    else
+    return count;
+}
+
+// Switch the link between the brewing (LINK_BREW_*) and idle (LINK_IDLE_*) parameters,
+// and the scale's notifications between the full and the idle weight rate with it.
+// Only sends requests when the profile changes; the scale may take a few
+// connection events to switch over - see connectionIntervalMs().
+bool AcaiaArduinoBLE::setLowLatency(bool lowLatency)
+{
+    if (!_connected || lowLatency == _lowLatency)
     {
         return false;
     }
+    bool ok = requestLinkProfile(lowLatency);
+    requestNotificationRate(lowLatency);
+    return ok;
 }
-// Function to get battery value
-bool AcaiaArduinoBLE::updateBattery()
+
+// Brewing: weight at the scale's full rate, for the stop decision. Idle: a fraction of
+// it - fewer packets to move and parse, and less radio time on the scale's battery.
+// Without response where the scale takes it, so it does not queue ahead of the shot
+// start batch; with the old rate the gap detector would count every new interval as loss.
+void AcaiaArduinoBLE::requestNotificationRate(bool brewing)
 {
-    byte input[] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+    ScaleCommand command = brewing ? SCALE_CMD_NOTIFICATION_REQUEST : SCALE_CMD_NOTIFICATION_IDLE;
+    if (_driver->encode(command).length == 0)
+    {
+        return;
+    }
+    _link.nominalPeriodMs = 0;  // Learn the new period
+    if (sendCommand(command, false))
+    {
+        LOG_DEBUG(LOG_TAG_BLE, "📶 Requested %s notification rate", brewing ? "full" : "idle");
+    }
+    else
+    {
+        LOG_WARN(LOG_TAG_BLE, "⚠️  Notification rate request failed (%s)", brewing ? "full" : "idle");
+    }
+}
 
-    // value length checked to be 14 for fw 1.0.0.16 lunar
-    if (_read.valueUpdated() && _read.readValue(input, 13) && input[2] == 8)
+bool AcaiaArduinoBLE::isLowLatency()
+{
+    return _lowLatency;
+}
+
+bool AcaiaArduinoBLE::requestLinkProfile(bool lowLatency)
+{
+    // Marked as applied even on failure - a retry per BLE task pass would only spam
+    // the controller; the next profile change or reconnect tries again
+    _lowLatency = lowLatency;
+
+    bool ok;
+    if (lowLatency)
     {
-        _currentBattery = input[4] & 0x7f;
-        return true;
+        // Also refuse the scale's own L2CAP update requests outside the brew range mid-shot
+        BLE.setConnectionInterval(LINK_BREW_MIN_INTERVAL, LINK_BREW_MAX_INTERVAL);
+        ok = _pendingPeripheral.requestConnectionParameters(LINK_BREW_MIN_INTERVAL, LINK_BREW_MAX_INTERVAL,
+                                                            LINK_BREW_LATENCY, LINK_SUPERVISION_TIMEOUT);
     }
     else
     {
-        return false;
+        BLE.setConnectionInterval(0, 0);
+        ok = _pendingPeripheral.requestConnectionParameters(LINK_IDLE_MIN_INTERVAL, LINK_IDLE_MAX_INTERVAL,
+                                                            LINK_IDLE_LATENCY, LINK_SUPERVISION_TIMEOUT);
+    }
+
+    if (ok)
+    {
+        LOG_DEBUG(LOG_TAG_BLE, "📶 Requested %s link parameters", lowLatency ? "low latency" : "idle");
+    }
+    else
+    {
+        LOG_WARN(LOG_TAG_BLE, "⚠️  Connection parameter update rejected (%s)", lowLatency ? "low latency" : "idle");
     }
+    return ok;
 }
 
-int AcaiaArduinoBLE::batteryValue()
+// ATT MTU exchange and LE Set Data Length - one round trip plus one HCI command. Failures
+// only leave the 23-byte MTU / 27-octet defaults, so the connection continues either way
+void AcaiaArduinoBLE::negotiateLink()
 {
-    return _currentBattery;
+    unsigned long start = millis();
+    bool mtuOk = _pendingPeripheral.exchangeMtu(LINK_ATT_MTU);
+    bool dleOk = _pendingPeripheral.requestDataLength(LINK_DATA_OCTETS, LINK_DATA_TIME_US);
+
+    if (mtuOk && dleOk)
+    {
+        LOG_DEBUG(LOG_TAG_BLE, "📶 MTU %u, data length requested (took %lums)", _pendingPeripheral.mtu(),
+                  millis() - start);
+    }
+    else
+    {
+        LOG_WARN(LOG_TAG_BLE, "⚠️  Link setup: MTU exchange %s, data length %s - using defaults",
+                 mtuOk ? "ok" : "failed", dleOk ? "ok" : "rejected");
+    }
+}
+
+// Negotiated connection interval in ms (0 when not connected)
+float AcaiaArduinoBLE::connectionIntervalMs()
+{
+    uint16_t interval, latency, timeout;
+    if (!_connected || !_pendingPeripheral.connectionParameters(&interval, &latency, &timeout))
+    {
+        return 0.0f;
+    }
+    return interval * 1.25f;
+}
+
+// Negotiated peripheral latency in connection events (0 when not connected)
+uint16_t AcaiaArduinoBLE::connectionLatency()
+{
+    uint16_t interval, latency, timeout;
+    if (!_connected || !_pendingPeripheral.connectionParameters(&interval, &latency, &timeout))
+    {
+        return 0;
+    }
+    return latency;
+}
+
+// Negotiated supervision timeout in ms (0 when not connected)
+uint16_t AcaiaArduinoBLE::supervisionTimeoutMs()
+{
+    uint16_t interval, latency, timeout;
+    if (!_connected || !_pendingPeripheral.connectionParameters(&interval, &latency, &timeout))
+    {
+        return 0;
+    }
+    return timeout * 10;
+}
+
+// Loss estimate from one weight-packet interval. Scales send at a fixed rate, so the
+// nominal period is learned from ordinary intervals and a gap of N periods means N - 1
+// packets never arrived (over the air - the ring has its own droppedPackets() count).
+void AcaiaArduinoBLE::noteWeightInterval(long periodMs)
+{
+    if (periodMs <= 0)
+    {
+        return;  // Two packets in one connection event
+    }
+    uint32_t period = (uint32_t)periodMs;
+    if (period > _link.maxGapMs)
+    {
+        _link.maxGapMs = period;
+    }
+
+    uint32_t nominal = _link.nominalPeriodMs;
+    if (nominal == 0)
+    {
+        _link.nominalPeriodMs = period;
+        return;
+    }
+    if (period * 100 > nominal * LINK_GAP_PCT)
+    {
+        uint32_t lost = (period + nominal / 2) / nominal - 1;
+        _link.lostEstimate += lost;
+        blePacketsLostEst.add(lost);
+        return;
+    }
+    _link.nominalPeriodMs = (nominal * 7 + period) / 8;
+}
+
+// Rate-limited RSSI read for the current connection; call once per BLE task pass
+void AcaiaArduinoBLE::pollLinkStats()
+{
+    if (!_connected || millis() - _lastRssiPoll < LINK_RSSI_POLL_MS)
+    {
+        return;
+    }
+    _lastRssiPoll = millis();
+    bleTxDepthMax.set(HCI.txStats().depthMax);
+    _pendingPeripheral.dataLength(&_link.txOctets, &_link.rxOctets);  // LE Data Length Change may follow late
+
+    int rssi = _pendingPeripheral.rssi();  // HCI Read RSSI while connected
+    if (rssi == LINK_RSSI_UNKNOWN)
+    {
+        return;
+    }
+    _link.rssi = (int8_t)rssi;
+    if (_link.rssiMin == LINK_RSSI_UNKNOWN || rssi < _link.rssiMin)
+    {
+        _link.rssiMin = (int8_t)rssi;
+    }
+    bleRssiDbm.set(rssi);
+}
+
+const LinkStats &AcaiaArduinoBLE::linkStats()
+{
+    return _link;
+}
+
+// One-line summary when a connection ends - correlate with the disconnect reason above it
+void AcaiaArduinoBLE::logLinkStats()
+{
+    unsigned long upS = (millis() - _link.connectedAtMs) / 1000;
+    uint32_t expected = _link.notifications + _link.lostEstimate;
+    float lossPct = expected ? 100.0f * _link.lostEstimate / expected : 0.0f;
+    LOG_INFO(LOG_TAG_BLE, "📶 Link summary: up %lus, %lu packets, ~%lu lost (%.1f%%), period %lums, max gap %lums, "
+             "RSSI %d dBm (min %d), %lu writes (%lu failed, max %luus), MTU %u, LL %u/%u octets, "
+             "TX queue max %u (%lu stalls, max %luus)",
+             upS, (unsigned long)_link.notifications, (unsigned long)_link.lostEstimate, lossPct,
+             (unsigned long)_link.nominalPeriodMs, (unsigned long)_link.maxGapMs, _link.rssi, _link.rssiMin,
+             (unsigned long)_link.writes, (unsigned long)_link.writeFailures, (unsigned long)_link.writeMaxUs,
+             _link.attMtu, _link.txOctets, _link.rxOctets, HCI.txStats().depthMax,
+             (unsigned long)HCI.txStats().stalls, (unsigned long)HCI.txStats().stallUsMax);
+}
+
+// Notifications lost because the ring was full (consumer fell PACKET_RING_SIZE behind)
+uint32_t AcaiaArduinoBLE::droppedPackets()
+{
+    return packetsDropped;
+}
+
+// Wake `task` instead of making it poll: rxBits on any HCI data from the controller,
+// notifyBits once a weight notification has been stored in the READ characteristic
+void AcaiaArduinoBLE::setEventTask(TaskHandle_t task, uint32_t rxBits, uint32_t notifyBits)
+{
+    notifyEventBits = notifyBits;
+    eventTask = task;
+    HCIVirtualTransport.setRxNotify(task, rxBits);
 }
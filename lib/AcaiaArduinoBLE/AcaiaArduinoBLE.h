@@ -13,53 +13,213 @@
 #define AcaiaArduinoBLE_h
 
 #define LIBRARY_VERSION        "2.1.2+custom"
-#define WRITE_CHAR_OLD_VERSION "2a80"
-#define READ_CHAR_OLD_VERSION  "2a80"
-#define WRITE_CHAR_NEW_VERSION "49535343-8841-43f4-a8d4-ecbe34729bb3"
-#define READ_CHAR_NEW_VERSION  "49535343-1e4d-4bd9-ba61-23c647249616"
-#define WRITE_CHAR_GENERIC     "ffe1"
-#define READ_CHAR_GENERIC      "ffe1"
-#define HEARTBEAT_PERIOD_MS     2750
+#define HEARTBEAT_PERIOD_MS     2750    // Keep-alive deadline after the last write of any command
+#define SETTINGS_POLL_MS        60000   // Battery / settings request rate (skipped while brewing)
 #define MAX_PACKET_PERIOD_MS    5000
+#define PACKET_RING_SIZE        16      // Notifications buffered until the consumer drains them (power of 2)
+#define CONNECT_SETTLE_MS       500     // After BLE.disconnect(), before scanning (tested: 500ms minimum)
+#define SCAN_TIMEOUT_MS         10000   // Give up if no scale advertises within this time
+#define BLOCKING_CALL_WATCHDOG_MS 15000 // connect() / discoverAttributes() budget (discovery seen at 1-10+ s)
+// Scan duty cycle (units of 0.625 ms): fast right after boot or a disconnect, when a
+// scale is most likely being switched on, then backed off to spare the radio/Wi-Fi
+#define SCAN_FAST_INTERVAL      0x0030  // 30 ms
+#define SCAN_FAST_WINDOW        0x0030  // 30 ms (100%)
+#define SCAN_SLOW_INTERVAL      0x0640  // 1 s
+#define SCAN_SLOW_WINDOW        0x0050  // 50 ms (5%)
+#define SCAN_FAST_PERIOD_MS     60000   // Fast scanning lasts this long after boot/disconnect
+// Several scales in range: an open scan keeps listening SCAN_COLLECT_MS after the first one,
+// then connects to the best (remembered scale, else strongest RSSI). A failed attempt goes
+// straight to the next candidate seen within CANDIDATE_FRESH_MS instead of scanning again
+#define SCAN_MAX_CANDIDATES     4
+#define SCAN_COLLECT_MS         1500
+#define CANDIDATE_FRESH_MS      10000
+// Connection parameters (interval units of 1.25 ms, timeout units of 10 ms). The stop
+// decision is only as fresh as the last notification, so brewing gets the shortest interval
+#define LINK_BREW_MIN_INTERVAL  0x0006  // 7.5 ms
+#define LINK_BREW_MAX_INTERVAL  0x000C  // 15 ms
+#define LINK_BREW_LATENCY       0
+#define LINK_IDLE_MIN_INTERVAL  0x0018  // 30 ms
+#define LINK_IDLE_MAX_INTERVAL  0x0028  // 50 ms
+#define LINK_IDLE_LATENCY       2       // Scale may sleep through 2 events (commands wait <= 150 ms)
+#define LINK_SUPERVISION_TIMEOUT 0x0190 // 4 s - must exceed (1 + latency) * interval * 2
+// Asked for right after connecting, before discovery (see negotiateLink()). The ATT MTU is
+// capped by the controller ACL buffer; scales that refuse either keep 23 / 27 octets
+#define LINK_ATT_MTU            247     // 244-byte notifications/writes in one PDU
+#define LINK_DATA_OCTETS        251     // LE Data Length Extension maximum
+#define LINK_DATA_TIME_US       2120    // Air time for 251 octets on the 1M PHY
+#define TARE_CONFIRM_CG         30      // |weight| <= 0.3 g after sendShotStart() counts as tared
+#define WRITES_IN_FLIGHT        4       // Writes with response awaiting confirmation (ATT_ASYNC_MAX_REQUESTS)
+// Link quality (see pollLinkStats()). RSSI is a blocking HCI command, so it is read at this
+// rate only; a weight-packet interval over LINK_GAP_PCT % of the nominal period counts as loss
+#define LINK_RSSI_POLL_MS       2000
+#define LINK_GAP_PCT            150
+#define LINK_RSSI_UNKNOWN       127     // HCIClass::readRssi() failure value
 
 #include "Arduino.h"
 #include <ArduinoBLE.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "ScaleDriver.h"
 
-enum scale_type{
-    OLD,    // Lunar (pre-2021)
-    NEW,    // Lunar (2021), Pyxis
-    GENERIC // Felicita Arc, etc
+// Connection state machine - beginConnect() starts it, poll() advances it one step
+enum ConnectionState{
+    CONN_IDLE,           // Not connected, no attempt running
+    CONN_SETTLING,       // Old connection closed, letting the stack and scale reset
+    CONN_SCANNING,       // BLE scan in progress
+    CONN_CONNECTING,     // Found scale, connecting
+    CONN_DISCOVERING,    // Discovering BLE attributes, picking the driver
+    CONN_SUBSCRIBING,    // Subscribing to weight notifications
+    CONN_IDENTIFYING,    // Sending identify command
+    CONN_NOTIFICATIONS,  // Enabling weight notifications
+    CONN_CONNECTED,      // Fully connected
+    CONN_FAILED          // Attempt failed - beginConnect() again to retry
 };
 
+typedef void (*ConnectionStateCallback)(ConnectionState state);
+
+// A command frame was written (ack = false, ok = write result) or the scale acked one
+// (ack = true) - from the task that calls into the library, for the shot event trace
+typedef void (*CommandTraceCallback)(ScaleCommand command, bool ack, bool ok, int64_t timestampUs);
+
+// Per-connection link quality, reset when a connection reaches CONN_CONNECTED
+struct LinkStats{
+    unsigned long connectedAtMs;    // millis() at CONN_CONNECTED
+    uint32_t notifications;         // Weight packets decoded
+    uint32_t lostEstimate;          // Weight packets missing from gaps in the nominal rate
+    uint32_t nominalPeriodMs;       // Learned packet period (EWMA of non-gap intervals), 0 = unknown
+    uint32_t maxGapMs;              // Longest weight-packet interval
+    int8_t   rssi;                  // Last RSSI in dBm, LINK_RSSI_UNKNOWN until read
+    int8_t   rssiMin;               // Weakest RSSI seen
+    uint32_t writes;                // ATT writes (commands and heartbeats)
+    uint32_t writeFailures;
+    uint32_t writeMaxUs;            // Slowest write (with response: call to confirmation)
+    uint16_t attMtu;                // Negotiated ATT MTU (23 = no exchange)
+    uint16_t txOctets;              // Link layer payload in use (27 = no data length extension)
+    uint16_t rxOctets;
+};
+
+// A scale seen by the last open scan (see scaleCandidates())
+struct ScaleCandidate{
+    char address[18];               // "aa:bb:cc:dd:ee:ff"
+    char name[24];
+    int8_t rssi;                    // dBm when advertising
+    unsigned long seenMs;           // millis() of the advertisement
+    bool lastUsed;                  // Remembered scale (GattCache), preferred by the ranking
+    bool failed;                    // An attempt on it failed since it was seen
+    bool connected;                 // The scale of the current connection
+};
+
+const char *connectionStateName(ConnectionState state);
+
 class AcaiaArduinoBLE{
     public:
         AcaiaArduinoBLE();
         bool init(String = "");
+        bool beginConnect(String = "");
+        ConnectionState poll();
+        ConnectionState connectionState();
+        bool isConnecting();
+        const ScaleDriver *driver();
+        void setStateCallback(ConnectionStateCallback callback);
+        void setCommandCallback(CommandTraceCallback callback);
         bool tare();
         bool startTimer();
         bool stopTimer();
         bool resetTimer();
+        bool sendShotStart(bool tare = true);
+        bool shotStartConfirmed();
+        int64_t shotStartAckUs(ScaleCommand command);
         bool heartbeat();
         float getWeight();
+        int32_t getWeightCg();
         bool heartbeatRequired();
+        unsigned long heartbeatDueIn();
         bool isConnected();
         bool newWeightAvailable();
-        bool getBattery();
-        bool updateBattery();
+        bool settingsRequired();
+        unsigned long settingsDueIn();
+        bool requestSettings();
         int batteryValue();
+        uint32_t scaleTimerMs();
+        long packetPeriod();
+        int64_t packetTimeUs();
+        size_t drainPackets(ScalePacket *out, size_t maxPackets);
+        uint32_t droppedPackets();
+        void setEventTask(TaskHandle_t task, uint32_t rxBits, uint32_t notifyBits);
+        bool setLowLatency(bool lowLatency);
+        bool isLowLatency();
+        float connectionIntervalMs();
+        uint16_t connectionLatency();
+        uint16_t supervisionTimeoutMs();
+        void pollLinkStats();
+        const LinkStats &linkStats();
+        int scaleCandidates(ScaleCandidate *out, int maxCount, uint8_t *generation);
+        bool selectScale(uint8_t generation, int index);
+        bool reconnect();
 
 
     private:
         bool isScaleName(String);
-        float               _currentWeight;
+        bool dispatchPacket(const ScalePacket &packet);
+        void onWeight(const ScalePacket &packet, int32_t weightCg);
+        void noteAcks(uint32_t acks, int64_t timestampUs);
+        bool sendCommand(ScaleCommand command, bool withResponse = true);
+        void setState(ConnectionState state);
+        void connectFailed();
+        bool selectDriver();
+        bool requestLinkProfile(bool lowLatency);
+        void requestNotificationRate(bool brewing);
+        void negotiateLink();
+        void clearCandidates();
+        int addCandidate(BLEDevice &peripheral);
+        int bestCandidate(bool freshOnly);
+        void connectCandidate(int index);
+        bool timedWrite(const uint8_t *data, int length, bool withResponse);
+        void noteWrite(bool withResponse, uint32_t us, bool ok);
+        static void onWriteComplete(int id, int status, const uint8_t *response, int length, void *context);
+        void noteWeightInterval(long periodMs);
+        void logLinkStats();
+        int32_t             _currentWeightCg;   // Centigrams (0.01 g)
         BLECharacteristic   _write;
         BLECharacteristic   _read;
-        long                _lastHeartBeat;
+        long                _lastHeartBeat;     // Last successful write (any command restarts the deadline)
         bool                _connected;
-        scale_type          _type;
-        int                 _currentBattery;
+        const ScaleDriver  *_driver;            // Protocol of the connected scale (set in init())
+        int                 _currentBattery;    // %, -1 = no settings reply yet
+        uint32_t            _scaleTimerMs;      // Last timer event
+        unsigned long       _lastSettingsRequest;   // millis(), 0 = none on this connection
         long                _packetPeriod;
         long                _lastPacket;
+        int64_t             _packetTimeUs;
+        ConnectionState     _connState;
+        unsigned long       _connStateStart;    // millis() when _connState was entered
+        unsigned long       _scanStart;
+        String              _mac;
+        BLEDevice           _pendingPeripheral;
+        ConnectionStateCallback _stateCallback;
+        CommandTraceCallback _commandCallback;
+        bool                _gattCacheUsed;     // Current attempt restored handles from GattCache
+        String              _lastScale;         // Remembered MAC (GattCache), "" = none
+        bool                _lastScaleLoaded;
+        bool                _targetedScan;      // Current attempt scans for _lastScale only
+        bool                _targetedNext;      // Alternate targeted/open scans while a MAC is remembered
+        unsigned long       _fastScanUntil;     // millis() deadline of the fast duty cycle, 0 = not started
+        bool                _lowLatency;        // Brewing link profile requested (see LINK_*)
+        bool                _writeNoResponse;   // WRITE characteristic accepts write without response
+        int64_t             _shotStartUs;       // esp_timer_get_time() of the last sendShotStart(), 0 = none
+        bool                _shotStartTare;     // ... and whether it included the tare
+        uint32_t            _acks;              // SCALE_ACK bits seen since _shotStartUs
+        int64_t             _ackUs[SCALE_CMD_GET_SETTINGS + 1];  // Arrival of each ack since _shotStartUs, 0 = none
+        LinkStats           _link;
+        struct { int id; int64_t startUs; } _writesInFlight[WRITES_IN_FLIGHT];  // id 0 = free
+        unsigned long       _lastRssiPoll;
+        ScaleCandidate      _candidates[SCAN_MAX_CANDIDATES];   // Shared with scaleCandidates() (candidateMux)
+        BLEDevice           _candidateDevices[SCAN_MAX_CANDIDATES];
+        uint8_t             _candidateCount;
+        uint8_t             _candidateGeneration;   // Bumped when the table is rebuilt (selectScale() check)
+        int                 _candidateIndex;        // Candidate of _pendingPeripheral, -1 = none
+        unsigned long       _collectUntil;          // millis() end of candidate collection, 0 = not collecting
+        bool                _failover;              // Next attempt may skip the scan (failed attempt / selection)
 };
 
 #endif
@@ -0,0 +1,152 @@
+/*
+  FrameParser.h - 0xEF 0xDD frame stream reassembly for AcaiaArduinoBLE.
+
+  Framed protocols (ScaleDriver::framed()) send frames that may be split
+  across notifications or merged into one: 0xEF 0xDD, type, length L, L - 1
+  more payload bytes, then the even / odd byte sums of the payload (length
+  byte included) - L + 5 bytes in total. FrameParser turns the notification
+  stream back into one checksum-verified frame at a time; each byte is looked
+  at exactly once and the checksum runs along as bytes arrive.
+
+  No BLE or FreeRTOS in here, so the host builds (tools/core_bench) run the
+  same parser as the firmware.
+*/
+#ifndef FrameParser_h
+#define FrameParser_h
+
+#include "ScaleDriver.h"
+
+#define FRAME_HEADER1           0xef
+#define FRAME_HEADER2           0xdd
+
+class FrameParser
+{
+    public:
+        volatile uint32_t frames = 0;
+        volatile uint32_t splitFrames = 0;      // Completed in a later notification than they started
+        volatile uint32_t mergedFrames = 0;     // Not the first frame of their notification
+        volatile uint32_t checksumErrors = 0;
+        volatile uint32_t skippedBytes = 0;     // Outside any frame (noise, resync, oversized frames)
+
+        void reset()
+        {
+            _state = HUNT_HEADER1;
+        }
+
+        // Consume `packet` from *offset until a valid frame completes (copied to *frame,
+        // stamped with this packet's arrival) or the packet ends. True = frame ready,
+        // *offset points past it; call again for the rest of the packet
+        bool feed(const ScalePacket &packet, uint8_t *offset, ScalePacket *frame)
+        {
+            bool first = (*offset == 0);
+            if (first)
+            {
+                _framesInPacket = 0;
+                if (_state != HUNT_HEADER1)
+                {
+                    _spansPackets = true;
+                }
+            }
+
+            while (*offset < packet.length)
+            {
+                uint8_t b = packet.data[(*offset)++];
+                switch (_state)
+                {
+                    case HUNT_HEADER1:
+                        if (b == FRAME_HEADER1)
+                        {
+                            _frame.data[0] = b;
+                            _spansPackets = false;
+                            _state = HUNT_HEADER2;
+                        }
+                        else
+                        {
+                            skippedBytes = skippedBytes + 1;
+                        }
+                        break;
+
+                    case HUNT_HEADER2:
+                        if (b == FRAME_HEADER2)
+                        {
+                            _frame.data[1] = b;
+                            _state = TYPE;
+                        }
+                        else if (b == FRAME_HEADER1)
+                        {
+                            skippedBytes = skippedBytes + 1;  // Lone 0xEF - this one may start the frame
+                        }
+                        else
+                        {
+                            skippedBytes = skippedBytes + 2;
+                            _state = HUNT_HEADER1;
+                        }
+                        break;
+
+                    case TYPE:
+                        _frame.data[2] = b;
+                        _state = LENGTH;
+                        break;
+
+                    case LENGTH:
+                        if (b + 5 > PACKET_MAX_LEN)
+                        {
+                            skippedBytes = skippedBytes + 4;
+                            _state = HUNT_HEADER1;
+                            break;
+                        }
+                        _frame.data[3] = b;
+                        _frame.length = b + 5;
+                        _pos = 4;
+                        _sum[0] = b;    // Payload byte 0
+                        _sum[1] = 0;
+                        _state = BODY;
+                        break;
+
+                    case BODY:
+                        _frame.data[_pos] = b;
+                        if (_pos < _frame.length - 2)
+                        {
+                            _sum[(_pos - 3) & 1] += b;
+                        }
+                        if (++_pos < _frame.length)
+                        {
+                            break;
+                        }
+
+                        _state = HUNT_HEADER1;
+                        if (_frame.data[_frame.length - 2] != _sum[0] || _frame.data[_frame.length - 1] != _sum[1])
+                        {
+                            checksumErrors = checksumErrors + 1;
+                            skippedBytes = skippedBytes + _frame.length;
+                            break;
+                        }
+                        frames = frames + 1;
+                        if (_spansPackets)
+                        {
+                            splitFrames = splitFrames + 1;
+                        }
+                        if (_framesInPacket++ > 0)
+                        {
+                            mergedFrames = mergedFrames + 1;
+                        }
+                        _frame.timestampUs = packet.timestampUs;
+                        *frame = _frame;
+                        return true;
+                }
+            }
+            return false;
+        }
+
+    private:
+        enum State : uint8_t { HUNT_HEADER1, HUNT_HEADER2, TYPE, LENGTH, BODY };
+
+        State _state = HUNT_HEADER1;
+        ScalePacket _frame = {};
+        uint8_t _pos = 0;
+        uint8_t _sum[2] = {0, 0};
+        uint8_t _framesInPacket = 0;
+        bool _spansPackets = false;
+};
+
+#endif
@@ -0,0 +1,97 @@
+/*
+  GattCache.cpp - Per-scale GATT handle cache in NVS.
+  See GattCache.h.
+*/
+#include "GattCache.h"
+#include <Preferences.h>
+#include "../../src/debug_config.h"
+
+struct __attribute__ ((packed)) GattCacheRecord{
+    uint8_t version;
+    BLEAttributeCache cache;
+};
+
+// NVS keys are limited to 15 chars: "aa:bb:cc:dd:ee:ff" → "aabbccddeeff"
+static String cacheKey(const String &address)
+{
+    String key = address;
+    key.replace(":", "");
+    return key;
+}
+
+bool gattCacheLoad(const String &address, BLEAttributeCache *cache)
+{
+    Preferences prefs;
+    if (!prefs.begin(GATT_CACHE_NAMESPACE, true))
+    {
+        return false;
+    }
+
+    GattCacheRecord record;
+    String key = cacheKey(address);
+    bool valid = prefs.getBytesLength(key.c_str()) == sizeof(record) &&
+                 prefs.getBytes(key.c_str(), &record, sizeof(record)) == sizeof(record) &&
+                 record.version == GATT_CACHE_VERSION;
+    prefs.end();
+
+    if (valid)
+    {
+        *cache = record.cache;
+    }
+    return valid;
+}
+
+void gattCacheStore(const String &address, const BLEAttributeCache &cache)
+{
+    Preferences prefs;
+    if (!prefs.begin(GATT_CACHE_NAMESPACE, false))
+    {
+        LOG_WARN(LOG_TAG_BLE, "⚠️  GATT cache: NVS namespace unavailable");
+        return;
+    }
+
+    GattCacheRecord record;
+    record.version = GATT_CACHE_VERSION;
+    record.cache = cache;
+    if (prefs.putBytes(cacheKey(address).c_str(), &record, sizeof(record)) == sizeof(record))
+    {
+        LOG_DEBUG(LOG_TAG_BLE, "💾 GATT handles cached for %s", address.c_str());
+    }
+    prefs.end();
+}
+
+String gattCacheLastScale()
+{
+    Preferences prefs;
+    if (!prefs.begin(GATT_CACHE_NAMESPACE, true))
+    {
+        return "";
+    }
+    String address = prefs.getString(GATT_CACHE_LAST_SCALE, "");
+    prefs.end();
+    return address;
+}
+
+void gattCacheRememberScale(const String &address)
+{
+    Preferences prefs;
+    if (!prefs.begin(GATT_CACHE_NAMESPACE, false))
+    {
+        return;
+    }
+    if (prefs.getString(GATT_CACHE_LAST_SCALE, "") != address)  // Spare the flash on every reconnect
+    {
+        prefs.putString(GATT_CACHE_LAST_SCALE, address);
+    }
+    prefs.end();
+}
+
+void gattCacheForget(const String &address)
+{
+    Preferences prefs;
+    if (prefs.begin(GATT_CACHE_NAMESPACE, false))
+    {
+        prefs.remove(cacheKey(address).c_str());
+        prefs.end();
+    }
+}
@@ -0,0 +1,30 @@
+/*
+  GattCache.h - Per-scale GATT handle cache in NVS for AcaiaArduinoBLE.
+
+  Full attribute discovery is the slowest step of a reconnect. After the first
+  successful discovery the READ/WRITE characteristic handles (plus CCCD) are
+  stored under the scale's MAC; later connections restore them with
+  BLEDevice::restoreAttributes(), which verifies each one with a single ATT
+  request and falls back to discoverAttributes() on any mismatch.
+
+  The same namespace remembers the last scale that connected, so the next
+  attempt can scan for that address first.
+*/
+#ifndef GattCache_h
+#define GattCache_h
+
+#include "Arduino.h"
+#include <ArduinoBLE.h>
+
+#define GATT_CACHE_NAMESPACE    "gattcache"
+#define GATT_CACHE_VERSION      1       // Bump when BLEAttributeCache layout changes
+#define GATT_CACHE_LAST_SCALE   "last"   // Key of the last connected scale's MAC
+
+bool gattCacheLoad(const String &address, BLEAttributeCache *cache);
+void gattCacheStore(const String &address, const BLEAttributeCache &cache);
+void gattCacheForget(const String &address);
+
+String gattCacheLastScale();                     // "" if no scale has connected yet
+void gattCacheRememberScale(const String &address);
+
+#endif
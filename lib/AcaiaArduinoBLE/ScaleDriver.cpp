@@ -0,0 +1,318 @@
+/*
+  ScaleDriver.cpp - Protocol implementations for AcaiaArduinoBLE.
+  See ScaleDriver.h for the driver model.
+*/
+#include "ScaleDriver.h"
+#include "../../src/iram_placement.h"  // parse() in IRAM (GS_HOT_IRAM)
+#include <string.h>
+
+// Acaia frame: 0xEF 0xDD, message type, payload, then the byte sums of the payload's even and odd
+// positions. Built at compile time - AcaiaFrame<type, padded length, payload...>::data is a
+// constexpr array (flash), its length comes from the type, no checksum is ever computed at run time.
+static constexpr uint8_t acaiaSum(size_t, size_t)
+{
+    return 0;
+}
+
+template <typename... Rest>
+static constexpr uint8_t acaiaSum(size_t parity, size_t index, uint8_t first, Rest... rest)
+{
+    return (uint8_t)(((index & 1) == parity ? first : 0) + acaiaSum(parity, index + 1, rest...));
+}
+
+template <uint8_t Type, size_t Padded, uint8_t... Payload>
+struct AcaiaFrame
+{
+    static constexpr size_t LENGTH = (sizeof...(Payload) + 5 > Padded) ? sizeof...(Payload) + 5 : Padded;
+    static constexpr uint8_t data[LENGTH] = {0xef, 0xdd, Type, Payload...,
+                                             acaiaSum(0, 0, Payload...), acaiaSum(1, 0, Payload...)};   // Zeros pad the rest
+};
+
+template <uint8_t Type, size_t Padded, uint8_t... Payload>
+constexpr uint8_t AcaiaFrame<Type, Padded, Payload...>::data[];
+
+typedef AcaiaFrame<0x0b, 0, '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', '0', '1', '2', '3', '4'> IDENTIFY;
+typedef AcaiaFrame<0x00, 0, 0x02, 0x00> HEARTBEAT;
+// Events wanted, as the app sends them: payload length 0x09, then (event, interval) pairs -
+// (0 weight, every 1), (1 battery, every 2), (2 timer, every 5), (3 key, every 4)
+typedef AcaiaFrame<0x0c, 0, 0x09, 0x00, 0x01, 0x01, 0x02, 0x02, 0x05, 0x03, 0x04> NOTIFICATION_REQUEST;
+// Idle: the same pairs but (0 weight, every 4) - enough for the display and cup detection
+typedef AcaiaFrame<0x0c, 0, 0x09, 0x00, 0x04, 0x01, 0x02, 0x02, 0x05, 0x03, 0x04> NOTIFICATION_IDLE;
+typedef AcaiaFrame<0x0d, 0, 0x00, 0x00> START_TIMER;
+typedef AcaiaFrame<0x0d, 0, 0x00, 0x02> STOP_TIMER;
+typedef AcaiaFrame<0x0d, 0, 0x00, 0x01> RESET_TIMER;
+typedef AcaiaFrame<0x04, 20, 0x00> TARE_ACAIA;   // Zero padded to the 20 bytes Acaia expects
+// Get settings: 16 zero payload bytes, so both checksum bytes are 0 too
+typedef AcaiaFrame<0x06, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0> GET_SETTINGS;
+static const uint8_t TARE_GENERIC[1] = {0x54};
+
+// The checksums the scales were shown to accept before frames were built
+static_assert(IDENTIFY::LENGTH == 20 && IDENTIFY::data[18] == 0x9a && IDENTIFY::data[19] == 0x6d, "IDENTIFY frame");
+static_assert(NOTIFICATION_REQUEST::LENGTH == 14 && NOTIFICATION_REQUEST::data[12] == 0x15 &&
+              NOTIFICATION_REQUEST::data[13] == 0x06, "NOTIFICATION_REQUEST frame");
+static_assert(HEARTBEAT::LENGTH == 7 && HEARTBEAT::data[5] == 0x02 && HEARTBEAT::data[6] == 0x00, "HEARTBEAT frame");
+static_assert(STOP_TIMER::data[5] == 0x00 && STOP_TIMER::data[6] == 0x02, "STOP_TIMER frame");
+static_assert(TARE_ACAIA::LENGTH == 20 && GET_SETTINGS::LENGTH == 21, "Padded frames");
+
+// Powers of ten for the Acaia unit byte (decimal places, 0-4)
+static constexpr int32_t POW10[] = {1, 10, 100, 1000, 10000};
+static constexpr uint8_t POW10_COUNT = sizeof(POW10) / sizeof(POW10[0]);
+
+template <size_t N>
+static constexpr ScaleFrame frame(const uint8_t (&bytes)[N])
+{
+    return ScaleFrame{bytes, N};
+}
+
+template <typename Frame>
+static constexpr ScaleFrame frame()
+{
+    return ScaleFrame{Frame::data, Frame::LENGTH};
+}
+
+// Advertised local name prefixes per family; the scan filter takes all of them
+#define ACAIA_NAME_PREFIXES     "CINCO", "ACAIA", "PYXIS", "LUNAR", "PROCH"
+#define FELICITA_NAME_PREFIXES  "FELIC"
+
+static const char *const ACAIA_NAMES[] = {ACAIA_NAME_PREFIXES};
+static const char *const FELICITA_NAMES[] = {FELICITA_NAME_PREFIXES};
+static const char *const SCAN_NAMES[] = {ACAIA_NAME_PREFIXES, FELICITA_NAME_PREFIXES};
+
+template <size_t N>
+static bool hasAnyPrefix(const char *name, const char *const (&prefixes)[N])
+{
+    for (size_t i = 0; i < N; i++)
+    {
+        if (strncmp(name, prefixes[i], strlen(prefixes[i])) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Raw 16-bit reading with `decimals` decimal places → centigrams (rounded)
+// The per-protocol parse() stays a call: inlined into ScaleDriverFor<>::parse() it would run
+// from flash, as GCC drops section attributes on template instantiations
+#define PARSE_NOINLINE __attribute__((noinline))
+
+static bool GS_HOT_IRAM rawToCentigrams(uint32_t raw, uint8_t decimals, bool negative, int32_t *cg)
+{
+    if (decimals >= POW10_COUNT)
+    {
+        return false;
+    }
+
+    int32_t value;
+    if (decimals <= 2)
+    {
+        value = (int32_t)raw * POW10[2 - decimals];
+    }
+    else
+    {
+        int32_t divisor = POW10[decimals - 2];
+        value = ((int32_t)raw + divisor / 2) / divisor;
+    }
+    *cg = negative ? -value : value;
+    return true;
+}
+
+// Shared Acaia framing (both generations speak the same command set)
+struct AcaiaCommands{
+    static bool matchesName(const char *name)
+    {
+        return hasAnyPrefix(name, ACAIA_NAMES);
+    }
+
+    static ScaleFrame encode(ScaleCommand command)
+    {
+        switch (command)
+        {
+            case SCALE_CMD_IDENTIFY:             return frame<IDENTIFY>();
+            case SCALE_CMD_NOTIFICATION_REQUEST: return frame<NOTIFICATION_REQUEST>();
+            case SCALE_CMD_NOTIFICATION_IDLE:    return frame<NOTIFICATION_IDLE>();
+            case SCALE_CMD_HEARTBEAT:            return frame<HEARTBEAT>();
+            case SCALE_CMD_TARE:                 return frame<TARE_ACAIA>();
+            case SCALE_CMD_START_TIMER:          return frame<START_TIMER>();
+            case SCALE_CMD_STOP_TIMER:           return frame<STOP_TIMER>();
+            case SCALE_CMD_RESET_TIMER:          return frame<RESET_TIMER>();
+            case SCALE_CMD_GET_SETTINGS:         return frame<GET_SETTINGS>();
+        }
+        return ScaleFrame{NULL, 0};
+    }
+
+    // Settings reply (message type 8): battery in byte 4, bit 7 is a flag
+    static ScaleMessageType parseSettings(const ScalePacket &packet, ScaleMessage *message)
+    {
+        if (packet.length < 5 || packet.data[2] != 0x08)
+        {
+            return SCALE_MSG_NONE;
+        }
+        message->batteryPct = packet.data[4] & 0x7f;
+        return SCALE_MSG_SETTINGS;
+    }
+};
+
+// Lunar (pre-2021)
+struct AcaiaOldProtocol : AcaiaCommands{
+    static constexpr const char *NAME = "Old version Acaia";
+    static constexpr const char *READ_UUID = "2a80";
+    static constexpr const char *WRITE_UUID = "2a80";
+    static constexpr bool NEEDS_HEARTBEAT = true;
+    static constexpr bool FRAMED = false;              // One 10-byte weight packet per notification
+    static constexpr float PROCESS_NOISE = 1.0f;
+    static constexpr float MEASUREMENT_NOISE = 0.01f;   // ~0.1 g
+
+    static ScaleMessageType GS_HOT_IRAM PARSE_NOINLINE parse(const ScalePacket &packet, ScaleMessage *message)
+    {
+        const uint8_t *input = packet.data;
+        if (packet.length != 10)
+        {
+            return parseSettings(packet, message);
+        }
+
+        // Grab weight bytes (2 and 3),
+        //  apply scaling based on the unit byte (6)
+        //  get sign byte (7)
+        bool ok = rawToCentigrams(((input[3] & 0xff) << 8) + (input[2] & 0xff), input[6], input[7] & 0x02,
+                                  &message->weightCg);
+        return ok ? SCALE_MSG_WEIGHT : SCALE_MSG_NONE;
+    }
+};
+
+// Lunar (2021), Pyxis
+struct AcaiaNewProtocol : AcaiaCommands{
+    static constexpr const char *NAME = "New version Acaia";
+    static constexpr const char *READ_UUID = "49535343-1e4d-4bd9-ba61-23c647249616";
+    static constexpr const char *WRITE_UUID = "49535343-8841-43f4-a8d4-ecbe34729bb3";
+    static constexpr bool NEEDS_HEARTBEAT = true;
+    static constexpr bool FRAMED = true;
+    static constexpr float PROCESS_NOISE = 1.0f;
+    static constexpr float MEASUREMENT_NOISE = 0.0025f; // ~0.05 g (Lunar/Pyxis report 0.01 g)
+
+    static ScaleMessageType GS_HOT_IRAM PARSE_NOINLINE parse(const ScalePacket &packet, ScaleMessage *message)
+    {
+        const uint8_t *input = packet.data;
+        if (packet.length < 5)
+        {
+            return SCALE_MSG_NONE;
+        }
+        if (input[2] != 0x0C)
+        {
+            return parseSettings(packet, message);
+        }
+
+        // input[2] == 12 event message, input[4] the event type
+        switch (input[4])
+        {
+            case 0x05:  // Weight
+                if (packet.length < 11)
+                {
+                    return SCALE_MSG_NONE;
+                }
+                // Grab weight bytes (5 and 6)
+                //  apply scaling based on the unit byte (9)
+                //  get sign byte (10)
+                return rawToCentigrams(((input[6] & 0xff) << 8) + (input[5] & 0xff), input[9], input[10] & 0x02,
+                                       &message->weightCg) ? SCALE_MSG_WEIGHT : SCALE_MSG_NONE;
+
+            case 0x07:  // Timer: minutes (5), seconds (6), tenths (7)
+                if (packet.length < 8)
+                {
+                    return SCALE_MSG_NONE;
+                }
+                message->timerMs = (input[5] * 60u + input[6]) * 1000u + input[7] * 100u;
+                return SCALE_MSG_TIMER;
+
+            case 0x08:  // Key event, also sent for remote commands
+                if (packet.length < 8)
+                {
+                    return SCALE_MSG_NONE;
+                }
+                message->acks = keyAcks(input[5], input[7]);
+                return message->acks ? SCALE_MSG_ACK : SCALE_MSG_NONE;
+        }
+        return SCALE_MSG_NONE;
+    }
+
+    // Key (5) and the action it triggered (7)
+    static uint32_t keyAcks(uint8_t key, uint8_t action)
+    {
+        if (key == 0x00 && action == 0x05) return SCALE_ACK(SCALE_CMD_TARE);
+        if (key == 0x08 && action == 0x05) return SCALE_ACK(SCALE_CMD_START_TIMER);
+        if (key == 0x0A && action == 0x07) return SCALE_ACK(SCALE_CMD_STOP_TIMER);
+        if (key == 0x09 && action == 0x07) return SCALE_ACK(SCALE_CMD_RESET_TIMER);
+        return 0;
+    }
+};
+
+// Felicita Arc, etc
+struct FelicitaProtocol{
+    static constexpr const char *NAME = "Generic";
+    static constexpr const char *READ_UUID = "ffe1";
+    static constexpr const char *WRITE_UUID = "ffe1";
+    static constexpr bool NEEDS_HEARTBEAT = false;
+    static constexpr bool FRAMED = false;
+    static constexpr float PROCESS_NOISE = 1.0f;
+    static constexpr float MEASUREMENT_NOISE = 0.02f;   // ~0.15 g, noisier load cell filtering
+
+    static bool matchesName(const char *name)
+    {
+        return hasAnyPrefix(name, FELICITA_NAMES);
+    }
+
+    static ScaleFrame encode(ScaleCommand command)
+    {
+        if (command == SCALE_CMD_TARE)
+        {
+            return frame(TARE_GENERIC);
+        }
+        if (command == SCALE_CMD_GET_SETTINGS)
+        {
+            return ScaleFrame{NULL, 0};  // No settings reply to parse
+        }
+        // Everything else goes out in Acaia framing, as it always has
+        return AcaiaCommands::encode(command);
+    }
+
+    static ScaleMessageType GS_HOT_IRAM PARSE_NOINLINE parse(const ScalePacket &packet, ScaleMessage *message)
+    {
+        const uint8_t *input = packet.data;
+        if (packet.length < 9)
+        {
+            return SCALE_MSG_NONE;
+        }
+
+        // Grab weight bytes (3-8): ASCII digits "gggg" "cc" = centigrams as written,
+        //  get sign byte (2)
+        int32_t value = 0;
+        for (int i = 3; i <= 8; i++)
+        {
+            value = value * 10 + (input[i] - 0x30);
+        }
+        message->weightCg = (input[2] == 0x2B) ? value : -value;
+        return SCALE_MSG_WEIGHT;  // No command feedback - tare is confirmed from the weight instead
+    }
+};
+
+static const ScaleDriverFor<AcaiaOldProtocol> acaiaOldDriver;
+static const ScaleDriverFor<AcaiaNewProtocol> acaiaNewDriver;
+static const ScaleDriverFor<FelicitaProtocol> felicitaDriver;
+
+static const ScaleDriver *const DRIVERS[] = {
+    &acaiaOldDriver,
+    &acaiaNewDriver,
+    &felicitaDriver,
+};
+
+const ScaleDriver *const *scaleDrivers(size_t *count)
+{
+    *count = sizeof(DRIVERS) / sizeof(DRIVERS[0]);
+    return DRIVERS;
+}
+
+const char *const *scaleNamePrefixes(size_t *count)
+{
+    *count = sizeof(SCAN_NAMES) / sizeof(SCAN_NAMES[0]);
+    return SCAN_NAMES;
+}
@@ -0,0 +1,114 @@
+/*
+  ScaleDriver.h - Per-protocol scale drivers for AcaiaArduinoBLE.
+
+  AcaiaArduinoBLE owns the BLE connection (scan, connect, subscribe,
+  notification ring). Everything protocol specific lives behind ScaleDriver:
+  name matching, characteristic UUIDs, command frames and message parsing.
+
+  Each protocol is a plain struct of static functions wrapped by
+  ScaleDriverFor<Protocol>. The decode/encode bodies are resolved at compile
+  time per protocol; the connection picks its driver once in init() and the
+  hot notification path is a single virtual call with no branching on scale
+  type: parse() classifies the packet (weight, settings, timer, command
+  acknowledgement) and AcaiaArduinoBLE dispatches on the result.
+
+  Adding a scale (Decent, Bookoo, ...): write a protocol struct in
+  ScaleDriver.cpp and append it to the driver table there - no changes to
+  AcaiaArduinoBLE itself.
+*/
+#ifndef ScaleDriver_h
+#define ScaleDriver_h
+
+#include "Arduino.h"
+
+#define PACKET_MAX_LEN          64      // Notification bytes kept (several frames fit at the negotiated MTU)
+
+// Raw READ characteristic notification, captured as it arrives in the ATT notify path
+struct ScalePacket{
+    int64_t timestampUs;            // esp_timer_get_time() at arrival
+    uint8_t length;
+    uint8_t data[PACKET_MAX_LEN];
+};
+
+enum ScaleCommand{
+    SCALE_CMD_IDENTIFY,
+    SCALE_CMD_NOTIFICATION_REQUEST, // Brewing event set: weight at the scale's full rate
+    SCALE_CMD_NOTIFICATION_IDLE,    // Idle event set: weight at a fraction of it
+    SCALE_CMD_HEARTBEAT,
+    SCALE_CMD_TARE,
+    SCALE_CMD_START_TIMER,
+    SCALE_CMD_STOP_TIMER,
+    SCALE_CMD_RESET_TIMER,
+    SCALE_CMD_GET_SETTINGS          // Answered by a SCALE_MSG_SETTINGS packet (battery)
+};
+
+enum ScaleMessageType{
+    SCALE_MSG_NONE,                 // Not understood (or carries nothing we use)
+    SCALE_MSG_WEIGHT,
+    SCALE_MSG_SETTINGS,
+    SCALE_MSG_TIMER,
+    SCALE_MSG_ACK                   // Scale executed a command (key event)
+};
+
+// One notification, parsed once - only the fields of `type` are set
+struct ScaleMessage{
+    ScaleMessageType type;
+    int32_t weightCg;               // SCALE_MSG_WEIGHT: centigrams
+    uint32_t acks;                  // SCALE_MSG_ACK: SCALE_ACK bits
+    uint32_t timerMs;               // SCALE_MSG_TIMER: scale's shot timer
+    uint8_t batteryPct;             // SCALE_MSG_SETTINGS
+};
+
+// Bit for `command` in ScaleMessage::acks
+#define SCALE_ACK(command)      (1u << (command))
+
+// Command bytes for the WRITE characteristic (static storage, length 0 = not supported)
+struct ScaleFrame{
+    const uint8_t *data;
+    size_t length;
+};
+
+class ScaleDriver{
+    public:
+        virtual const char *name() const = 0;
+        virtual bool matchesName(const char *localName) const = 0;
+        virtual const char *readUuid() const = 0;
+        virtual const char *writeUuid() const = 0;
+        virtual bool needsHeartbeat() const = 0;
+        // Notifications are a 0xEF 0xDD frame stream (frames may be split or merged):
+        // parse() then sees one reassembled, checksum-verified frame at a time
+        virtual bool framed() const = 0;
+        virtual ScaleFrame encode(ScaleCommand command) const = 0;
+        // Classify and decode one notification; returns message->type
+        virtual ScaleMessageType parse(const ScalePacket &packet, ScaleMessage *message) const = 0;
+        // Weight filter tuning: how fast flow may change (g^2/s^3), reading noise (g^2)
+        virtual float processNoise() const = 0;
+        virtual float measurementNoise() const = 0;
+};
+
+template <typename Protocol>
+class ScaleDriverFor : public ScaleDriver{
+    public:
+        const char *name() const override { return Protocol::NAME; }
+        bool matchesName(const char *localName) const override { return Protocol::matchesName(localName); }
+        const char *readUuid() const override { return Protocol::READ_UUID; }
+        const char *writeUuid() const override { return Protocol::WRITE_UUID; }
+        bool needsHeartbeat() const override { return Protocol::NEEDS_HEARTBEAT; }
+        bool framed() const override { return Protocol::FRAMED; }
+        ScaleFrame encode(ScaleCommand command) const override { return Protocol::encode(command); }
+        ScaleMessageType parse(const ScalePacket &packet, ScaleMessage *message) const override
+        {
+            message->type = Protocol::parse(packet, message);
+            return message->type;
+        }
+        float processNoise() const override { return Protocol::PROCESS_NOISE; }
+        float measurementNoise() const override { return Protocol::MEASUREMENT_NOISE; }
+};
+
+// Drivers in detection order (first whose READ characteristic can subscribe wins)
+const ScaleDriver *const *scaleDrivers(size_t *count);
+
+// Every name prefix some driver's matchesName() accepts (the BLE scan filter)
+const char *const *scaleNamePrefixes(size_t *count);
+
+#endif
@@ -247,6 +247,15 @@ int BLECharacteristic::writeValue(const uint8_t value[], int length, bool withRe
   return 0;
 }
 
+int BLECharacteristic::writeValueAsync(const uint8_t value[], int length, BLERequestHandler handler, void* context)
+{
+  if (_remote) {
+    return _remote->writeValueAsync(value, length, handler, context);
+  }
+
+  return 0;
+}
+
 int BLECharacteristic::writeValue(const void* value, int length, bool withResponse)
 {
   return writeValue((const uint8_t*)value, length, withResponse);
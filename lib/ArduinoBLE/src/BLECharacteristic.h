@@ -39,6 +39,14 @@ class BLEDevice;
 
 typedef void (*BLECharacteristicEventHandler)(BLEDevice device, BLECharacteristic characteristic);
 
+// Completion of an asynchronous request (writeValueAsync(), utility/ATT.h): status
+// 0, the peer's ATT error code, BLE_REQUEST_TIMEOUT or BLE_REQUEST_DISCONNECTED.
+// Called inside BLE.poll(), on the task that polls; response excludes the opcode.
+#define BLE_REQUEST_TIMEOUT       0x100
+#define BLE_REQUEST_DISCONNECTED  0x101
+
+typedef void (*BLERequestHandler)(int id, int status, const uint8_t* response, int length, void* context);
+
 class BLELocalCharacteristic;
 class BLERemoteCharacteristic;
 
@@ -77,6 +85,9 @@ public:
   int writeValue(int16_t value, bool withResponse = true);
   int writeValue(uint32_t value, bool withResponse = true);
   int writeValue(int32_t value, bool withResponse = true);
+  // Write with response, without waiting for it: request id (> 0) or 0 if it
+  // could not be queued. handler (may be NULL) gets the outcome
+  int writeValueAsync(const uint8_t value[], int length, BLERequestHandler handler, void* context);
 
   // deprecated, use writeValue(...)
   int setValue(const uint8_t value[], int length) { return writeValue(value, length); }
@@ -274,6 +274,56 @@ bool BLEDevice::discoverService(const char* serviceUuid)
   return ATT.discoverAttributes(_addressType, _address, serviceUuid);
 }
 
+bool BLEDevice::discoverAttributes(const char* const characteristicUuids[], int count)
+{
+  return ATT.discoverAttributes(_addressType, _address, characteristicUuids, count);
+}
+
+bool BLEDevice::exportAttributes(const char* const characteristicUuids[], int count, BLEAttributeCache* cache)
+{
+  return ATT.exportAttributes(_addressType, _address, characteristicUuids, count, cache);
+}
+
+bool BLEDevice::restoreAttributes(const BLEAttributeCache* cache)
+{
+  return ATT.restoreAttributes(_addressType, _address, cache);
+}
+
+bool BLEDevice::requestConnectionParameters(uint16_t minInterval, uint16_t maxInterval, uint16_t latency, uint16_t supervisionTimeout)
+{
+  return ATT.requestConnectionParameters(_addressType, _address, minInterval, maxInterval, latency, supervisionTimeout);
+}
+
+bool BLEDevice::connectionParameters(uint16_t* interval, uint16_t* latency, uint16_t* supervisionTimeout) const
+{
+  return ATT.connectionParameters(_addressType, _address, interval, latency, supervisionTimeout);
+}
+
+bool BLEDevice::exchangeMtu(uint16_t mtu)
+{
+  return ATT.requestMtu(_addressType, _address, mtu);
+}
+
+uint16_t BLEDevice::mtu() const
+{
+  return ATT.mtu(ATT.connectionHandle(_addressType, _address));
+}
+
+bool BLEDevice::requestDataLength(uint16_t txOctets, uint16_t txTime)
+{
+  return ATT.requestDataLength(_addressType, _address, txOctets, txTime);
+}
+
+bool BLEDevice::dataLength(uint16_t* txOctets, uint16_t* rxOctets) const
+{
+  return ATT.dataLength(_addressType, _address, txOctets, rxOctets);
+}
+
+bool BLEDevice::encrypted() const
+{
+  return ATT.paired(ATT.connectionHandle(_addressType, _address));
+}
+
 BLEDevice::operator bool() const
 {
   uint8_t zeros[6] = { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,};
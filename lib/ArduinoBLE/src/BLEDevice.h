@@ -36,6 +36,41 @@ class BLEDevice;
 
 typedef void (*BLEDeviceEventHandler)(BLEDevice device);
 
+#define BLE_ATTRIBUTE_CACHE_MAX_CHARACTERISTICS 2
+
+// Handles of a few characteristics (all in one service), so a reconnect can
+// skip discoverAttributes() - see BLEDevice::exportAttributes()/restoreAttributes()
+struct __attribute__ ((packed)) BLECachedCharacteristic {
+  uint8_t uuid[16];
+  uint8_t uuidLength;
+  uint8_t properties;
+  uint16_t startHandle;   // Characteristic declaration
+  uint16_t valueHandle;
+  uint16_t cccdHandle;    // 0 = no CCCD discovered
+};
+
+struct __attribute__ ((packed)) BLEAttributeCache {
+  uint8_t serviceUuid[16];
+  uint8_t serviceUuidLength;
+  uint16_t serviceStartHandle;
+  uint16_t serviceEndHandle;
+  uint8_t characteristicCount;
+  BLECachedCharacteristic characteristics[BLE_ATTRIBUTE_CACHE_MAX_CHARACTERISTICS];
+};
+
+// Advertising report filter (BLE.setScanFilter(), utility/GAP.cpp), matched
+// on the raw AD structures before a BLEDevice is allocated: a report passes
+// if any set criterion matches (none set: everything passes). A scannable
+// advertiser that matches only in its scan response is held in a small fixed
+// table until the response arrives. The fields must outlive the scan.
+struct BLEScanFilter {
+  const char* const* namePrefixes;  // complete or shortened local name starts with one of them
+  uint8_t namePrefixCount;
+  const uint8_t* serviceUuid;       // advertised service UUID, little-endian as on air
+  uint8_t serviceUuidLength;        // 2, 4 or 16; 0 = not filtered by service
+  int32_t companyId;                // manufacturer data company identifier; -1 = not filtered
+};
+
 class BLEDevice {
 public:
   BLEDevice();
@@ -72,6 +107,26 @@ public:
   bool connect();
   bool discoverAttributes();
   bool discoverService(const char* serviceUuid);
+  // Only the characteristics with these UUIDs (in any service), plus their descriptors
+  bool discoverAttributes(const char* const characteristicUuids[], int count);
+  bool exportAttributes(const char* const characteristicUuids[], int count, BLEAttributeCache* cache);
+  bool restoreAttributes(const BLEAttributeCache* cache);
+
+  // Central side: ask the controller for new parameters (interval 1.25 ms units,
+  // timeout 10 ms units). The current values update once the link has switched.
+  bool requestConnectionParameters(uint16_t minInterval, uint16_t maxInterval, uint16_t latency, uint16_t supervisionTimeout);
+  bool connectionParameters(uint16_t* interval, uint16_t* latency, uint16_t* supervisionTimeout) const;
+
+  // Central side: one ATT MTU exchange per connection (later calls return true
+  // without a request), and the link layer payload (27..251 octets, 328..2120 us).
+  // dataLength() reports the lengths in use once the controller has switched.
+  bool exchangeMtu(uint16_t mtu);
+  uint16_t mtu() const;
+  bool requestDataLength(uint16_t txOctets, uint16_t txTime);
+  bool dataLength(uint16_t* txOctets, uint16_t* rxOctets) const;
+
+  // Link encrypted: paired on this connection, or a bonded peer whose LTK was found
+  bool encrypted() const;
 
   virtual operator bool() const;
   virtual bool operator==(const BLEDevice& rhs) const;
@@ -227,11 +227,13 @@ void BLELocalDevice::end()
 void BLELocalDevice::poll()
 {
   HCI.poll();
+  ATT.pollRequests();
 }
 
 void BLELocalDevice::poll(unsigned long timeout)
 {
   HCI.poll(timeout);
+  ATT.pollRequests();
 }
 
 bool BLELocalDevice::connected() const
@@ -256,6 +258,11 @@ bool BLELocalDevice::disconnect()
   return ATT.disconnect();
 }
 
+bool BLELocalDevice::disconnectPeripherals()
+{
+  return ATT.disconnect(0x00);
+}
+
 String BLELocalDevice::address() const
 {
   uint8_t addr[6] = { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
@@ -432,6 +439,21 @@ void BLELocalDevice::setTimeout(unsigned long timeout)
   ATT.setTimeout(timeout);
 }
 
+void BLELocalDevice::setScanParameters(uint16_t scanInterval, uint16_t scanWindow)
+{
+  GAP.setScanParameters(scanInterval, scanWindow);
+}
+
+void BLELocalDevice::setScanFilter(const BLEScanFilter* filter)
+{
+  GAP.setScanFilter(filter);
+}
+
+void BLELocalDevice::scanFilterStats(uint32_t* reports, uint32_t* dropped)
+{
+  GAP.scanFilterStats(reports, dropped);
+}
+
 /*
  * Control whether pairing is allowed or rejected
  * Use true/false or the Pairable enum
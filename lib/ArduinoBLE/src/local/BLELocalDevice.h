@@ -43,6 +43,7 @@ public:
 
   virtual bool connected() const;
   virtual bool disconnect();
+  virtual bool disconnectPeripherals();  // Only links opened as central (scan + connect)
 
   virtual String address() const;
 
@@ -83,6 +84,10 @@ public:
   virtual void setEventHandler(BLEDeviceEvent event, BLEDeviceEventHandler eventHandler);
 
   virtual void setTimeout(unsigned long timeout);
+  virtual void setScanParameters(uint16_t scanInterval, uint16_t scanWindow);
+  // Drop other devices' advertising reports before they are allocated (utility/GAP.h)
+  virtual void setScanFilter(const BLEScanFilter* filter);
+  virtual void scanFilterStats(uint32_t* reports, uint32_t* dropped);
 
   virtual void debug(Stream& stream);
   virtual void noDebug();
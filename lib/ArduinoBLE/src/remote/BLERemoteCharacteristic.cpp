@@ -31,8 +31,9 @@ BLERemoteCharacteristic::BLERemoteCharacteristic(const uint8_t uuid[], uint8_t u
   _properties((uint8_t)(permissions & 0x00FF)),
   _permissions((uint8_t)((permissions & 0xFF00)>>8)),
   _valueHandle(valueHandle),
-  _value(NULL),
+  _value(_inlineValue),
   _valueLength(0),
+  _valueCapacity(sizeof(_inlineValue)),
   _valueUpdated(false),
   _updatedValueRead(true),
   _valueUpdatedEventHandler(NULL)
@@ -51,10 +52,10 @@ BLERemoteCharacteristic::~BLERemoteCharacteristic()
 
   _descriptors.clear();
 
-  if (_value) {
+  if (_value != _inlineValue) {
     free(_value);
-    _value = NULL;
   }
+  _value = NULL;
 }
 
 uint16_t BLERemoteCharacteristic::startHandle() const
@@ -99,9 +100,7 @@ int BLERemoteCharacteristic::writeValue(const uint8_t value[], int length, bool
     length = maxLength;
   }
 
-  _value = (uint8_t*)realloc(_value, length);
-  if (_value == NULL) {
-    // realloc failed
+  if (!reserveValue(length)) {
     return 0;
   }
 
@@ -134,6 +133,34 @@ int BLERemoteCharacteristic::writeValue(const uint8_t value[], int length, bool
   return 0;
 }
 
+// Queued in ATT (one request in flight per link); the value is kept as written
+int BLERemoteCharacteristic::writeValueAsync(const uint8_t value[], int length, BLERequestHandler handler, void* context)
+{
+  if (!ATT.connected(_connectionHandle) || !(_properties & BLEWrite)) {
+    return 0;
+  }
+
+  uint16_t maxLength = ATT.mtu(_connectionHandle) - 3;
+
+  if (length > (int)maxLength) {
+    // cap to MTU max length
+    length = maxLength;
+  }
+
+  if (!reserveValue(length)) {
+    return 0;
+  }
+
+  int id = ATT.writeReqAsync(_connectionHandle, _valueHandle, value, length, handler, context);
+
+  if (id) {
+    memcpy(_value, value, length);
+    _valueLength = length;
+  }
+
+  return id;
+}
+
 int BLERemoteCharacteristic::writeValue(const char* value, bool withResponse)
 {
   return writeValue((uint8_t*)value, strlen(value), withResponse);
@@ -180,15 +207,13 @@ bool BLERemoteCharacteristic::read()
     return false;
   }
 
-  _valueLength = respLength - 1;
-  _value = (uint8_t*)realloc(_value, _valueLength);
-
-  if (_value == NULL) {
+  if (!reserveValue(respLength - 1)) {
     _valueLength = 0;
     return false;
   }
 
-  memcpy(_value, &resp[1], _valueLength); 
+  _valueLength = respLength - 1;
+  memcpy(_value, &resp[1], _valueLength);
 
   return true;
 }
@@ -246,14 +271,13 @@ void BLERemoteCharacteristic::addDescriptor(BLERemoteDescriptor* descriptor)
 
 void BLERemoteCharacteristic::writeValue(BLEDevice device, const uint8_t value[], int length)
 {
-  _valueLength = length;
-  _value = (uint8_t*)realloc(_value, _valueLength);
-
-  if (_value == NULL) {
+  // Notification / indication path: no heap traffic once the buffer fits
+  if (!reserveValue(length)) {
     _valueLength = 0;
     return;
   }
 
+  _valueLength = length;
   _valueUpdated = true;
   _updatedValueRead = false;
   memcpy(_value, value, _valueLength);
@@ -262,3 +286,30 @@ void BLERemoteCharacteristic::writeValue(BLEDevice device, const uint8_t value[]
     _valueUpdatedEventHandler(device, BLECharacteristic(this));
   }
 }
+
+bool BLERemoteCharacteristic::reserveValue(int length)
+{
+  if (length <= _valueCapacity) {
+    return true;
+  }
+
+  // Grow to at least the connection's MTU payload so later values fit too
+  int capacity = ATT.mtu(_connectionHandle) - 3;
+  if (capacity < length) {
+    capacity = length;
+  }
+
+  uint8_t* value = (uint8_t*)malloc(capacity);
+  if (value == NULL) {
+    return false;
+  }
+
+  memcpy(value, _value, _valueLength);
+  if (_value != _inlineValue) {
+    free(_value);
+  }
+  _value = value;
+  _valueCapacity = capacity;
+
+  return true;
+}
@@ -27,6 +27,11 @@
 
 #include "utility/BLELinkedList.h"
 
+// Values up to the default ATT MTU payload (23 - 3) live inside the object;
+// longer ones spill to a heap buffer that only grows, so notifications and
+// writes stop allocating once the buffer fits.
+#define BLE_REMOTE_INLINE_VALUE_SIZE 20
+
 class BLERemoteCharacteristic : public BLERemoteAttribute {
 public:
   BLERemoteCharacteristic(const uint8_t uuid[], uint8_t uuidLen, uint16_t connectionHandle, uint16_t startHandle, uint16_t permissions, uint16_t valueHandle);
@@ -41,6 +46,7 @@ public:
 
   int writeValue(const uint8_t value[], int length, bool withResponse = true);
   int writeValue(const char* value, bool withResponse = true);
+  int writeValueAsync(const uint8_t value[], int length, BLERequestHandler handler, void* context);
 
   bool valueUpdated();
   bool updatedValueRead();
@@ -55,6 +61,7 @@ public:
 
 protected:
   friend class ATTClass;
+  friend class BLERemoteDevice;
 
   uint16_t startHandle() const;
   uint16_t valueHandle() const;
@@ -64,6 +71,8 @@ protected:
   void writeValue(BLEDevice device, const uint8_t value[], int length);
 
 private:
+  bool reserveValue(int length);
+
   uint16_t _connectionHandle;
   uint16_t _startHandle;
   uint8_t _properties;
@@ -72,6 +81,8 @@ private:
 
   uint8_t* _value;
   int _valueLength;
+  int _valueCapacity;
+  uint8_t _inlineValue[BLE_REMOTE_INLINE_VALUE_SIZE];
 
   bool _valueUpdated;
   bool _updatedValueRead;
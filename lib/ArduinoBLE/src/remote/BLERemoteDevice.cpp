@@ -17,15 +17,24 @@
   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 */
 
+#include "utility/HCITransport.h"
+
 #include "BLERemoteDevice.h"
 
-BLERemoteDevice::BLERemoteDevice()
+uint32_t BLERemoteDevice::_generation = 1;
+
+BLERemoteDevice::BLERemoteDevice() :
+  _handleIndex(NULL),
+  _handleIndexSize(0),
+  _handleIndexGeneration(0)
 {
 }
 
 BLERemoteDevice::~BLERemoteDevice()
 {
   clearServices();
+
+  delete[] _handleIndex;
 }
 
 void BLERemoteDevice::addService(BLERemoteService* service)
@@ -33,6 +42,7 @@ void BLERemoteDevice::addService(BLERemoteService* service)
   service->retain();
 
   _services.add(service);
+  attributesChanged();
 }
 
 unsigned int BLERemoteDevice::serviceCount() const
@@ -56,4 +66,83 @@ void BLERemoteDevice::clearServices()
   }
 
   _services.clear();
+  attributesChanged();
+}
+
+// Runs for every notification from the peer
+BLERemoteCharacteristic* HCI_RX_ATTR BLERemoteDevice::characteristicForHandle(uint16_t valueHandle)
+{
+  if (_handleIndexGeneration != _generation) {
+    buildHandleIndex();
+  }
+
+  if (valueHandle < _handleIndexSize) {
+    return _handleIndex[valueHandle];
+  }
+
+  // Handles above the index cap: walk the services
+  return (valueHandle >= BLE_REMOTE_HANDLE_INDEX_MAX) ? findCharacteristic(valueHandle) : NULL;
+}
+
+void BLERemoteDevice::attributesChanged()
+{
+  _generation++;
+}
+
+void BLERemoteDevice::buildHandleIndex()
+{
+  uint16_t size = 0;
+
+  for (unsigned int i = 0; i < serviceCount(); i++) {
+    BLERemoteService* s = service(i);
+
+    for (unsigned int j = 0; j < s->characteristicCount(); j++) {
+      uint16_t handle = s->characteristic(j)->valueHandle();
+
+      if (handle < BLE_REMOTE_HANDLE_INDEX_MAX && handle >= size) {
+        size = handle + 1;
+      }
+    }
+  }
+
+  if (size > _handleIndexSize) {
+    delete[] _handleIndex;
+    _handleIndex = new BLERemoteCharacteristic*[size];
+  }
+  _handleIndexSize = size;
+
+  for (uint16_t h = 0; h < size; h++) {
+    _handleIndex[h] = NULL;
+  }
+
+  for (unsigned int i = 0; i < serviceCount(); i++) {
+    BLERemoteService* s = service(i);
+
+    for (unsigned int j = 0; j < s->characteristicCount(); j++) {
+      BLERemoteCharacteristic* c = s->characteristic(j);
+
+      if (c->valueHandle() < size) {
+        _handleIndex[c->valueHandle()] = c;
+      }
+    }
+  }
+
+  _handleIndexGeneration = _generation;
+}
+
+BLERemoteCharacteristic* BLERemoteDevice::findCharacteristic(uint16_t valueHandle) const
+{
+  for (unsigned int i = 0; i < serviceCount(); i++) {
+    BLERemoteService* s = service(i);
+
+    for (unsigned int j = 0; j < s->characteristicCount(); j++) {
+      BLERemoteCharacteristic* c = s->characteristic(j);
+
+      if (c->valueHandle() == valueHandle) {
+        return c;
+      }
+    }
+  }
+
+  return NULL;
 }
@@ -24,6 +24,12 @@
 
 #include "BLERemoteService.h"
 
+// Value handles below this are dispatched through a direct index
+// (characteristicForHandle()); higher ones fall back to walking the services
+#ifndef BLE_REMOTE_HANDLE_INDEX_MAX
+#define BLE_REMOTE_HANDLE_INDEX_MAX 256
+#endif
+
 class BLERemoteDevice /*: public BLEDevice*/ {
 public:
   BLERemoteDevice();
@@ -36,8 +42,23 @@ public:
 
   void clearServices();
 
+  // Characteristic with this value handle, or NULL - O(1) for handles in the index
+  BLERemoteCharacteristic* characteristicForHandle(uint16_t valueHandle);
+
+  // A service or characteristic was added: indexes are rebuilt on their next lookup
+  static void attributesChanged();
+
 private:
+  void buildHandleIndex();
+  BLERemoteCharacteristic* findCharacteristic(uint16_t valueHandle) const;
+
   BLELinkedList<BLERemoteService*> _services;
+
+  BLERemoteCharacteristic** _handleIndex;
+  uint16_t _handleIndexSize;
+  uint32_t _handleIndexGeneration;
+
+  static uint32_t _generation;
 };
 
 #endif
@@ -17,6 +17,7 @@
   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 */
 
+#include "BLERemoteDevice.h"
 #include "BLERemoteService.h"
 
 BLERemoteService::BLERemoteService(const uint8_t uuid[], uint8_t uuidLen, uint16_t startHandle, uint16_t endHandle) :
@@ -64,4 +65,5 @@ void BLERemoteService::addCharacteristic(BLERemoteCharacteristic* characteristic
   characteristic-> retain();
 
   _characteristics.add(characteristic);
+  BLERemoteDevice::attributesChanged();
 }
@@ -20,6 +20,7 @@
 #include <Arduino.h>
 
 #include "HCI.h"
+#include "HCITransport.h"
 #include "GATT.h"
 
 #include "local/BLELocalAttribute.h"
@@ -88,7 +89,8 @@ ATTClass::ATTClass() :
   _timeout(5000),
   _longWriteHandle(0x0000),
   _longWriteValue(NULL),
-  _longWriteValueLength(0)
+  _longWriteValueLength(0),
+  _nextRequestId(1)
 {
   for (int i = 0; i < ATT_MAX_PEERS; i++) {
     _peers[i].connectionHandle = 0xffff;
@@ -96,10 +98,19 @@ ATTClass::ATTClass() :
     _peers[i].addressType = 0x00;
     memset(_peers[i].address, 0x00, sizeof(_peers[i].address));
     _peers[i].mtu = 23;
+    _peers[i].mtuExchanged = false;
+    _peers[i].txOctets = 27;
+    _peers[i].rxOctets = 27;
     _peers[i].device = NULL;
     _peers[i].encryption = 0x0;
   }
 
+  _pendingResp.connectionHandle = 0xffff;
+
+  for (int i = 0; i < ATT_ASYNC_MAX_REQUESTS; i++) {
+    _requests[i].connectionHandle = 0xffff;
+  }
+
   memset(_eventHandlers, 0x00, sizeof(_eventHandlers));
 }
 
@@ -120,7 +131,7 @@ bool ATTClass::connect(uint8_t peerBdaddrType, uint8_t peerBdaddr[6])
   bool isConnected = false;
 
   for (unsigned long start = millis(); (millis() - start) < _timeout;) {
-    HCI.poll();
+    HCI.poll(1);  // Sleeps until data arrives instead of spinning
 
     isConnected = connected(peerBdaddrType, peerBdaddr);
 
@@ -146,7 +157,7 @@ bool ATTClass::disconnect(uint8_t peerBdaddrType, uint8_t peerBdaddr[6])
   HCI.disconnect(connHandle);
 
   for (unsigned long start = millis(); (millis() - start) < _timeout;) {
-    HCI.poll();
+    HCI.poll(1);  // Sleeps until data arrives instead of spinning
 
     if (!connected(connHandle)) {
       return true;
@@ -221,6 +232,370 @@ bool ATTClass::discoverAttributes(uint8_t peerBdaddrType, uint8_t peerBdaddr[6],
   return true;
 }
 
+// Discover only the characteristics with the given UUIDs: all services (needed for the
+// service objects), then one Read By Type over the whole handle range instead of one per
+// service, and descriptors only where a kept characteristic can notify or indicate.
+// ATT allows a single outstanding request per bearer, so round trips are saved by asking
+// for less, not by overlapping them.
+bool ATTClass::discoverAttributes(uint8_t peerBdaddrType, uint8_t peerBdaddr[6], const char* const characteristicUuids[], int count)
+{
+  uint16_t connHandle = connectionHandle(peerBdaddrType, peerBdaddr);
+  if (connHandle == 0xffff || count <= 0) {
+    return false;
+  }
+
+  // send MTU request
+  if (!exchangeMtu(connHandle)) {
+    return false;
+  }
+
+  BLERemoteDevice* device = NULL;
+
+  for (int i = 0; i < ATT_MAX_PEERS; i++) {
+    if (_peers[i].connectionHandle == connHandle) {
+      if (_peers[i].device == NULL) {
+        _peers[i].device = new BLERemoteDevice();
+      }
+
+      device = _peers[i].device;
+
+      break;
+    }
+  }
+
+  if (device == NULL) {
+    return false;
+  }
+
+  device->clearServices();
+
+  if (!discoverServices(connHandle, device, NULL) || device->serviceCount() == 0) {
+    return false;
+  }
+
+  uint8_t responseBuffer[_maxMtu];
+
+  BLERemoteCharacteristic* kept[ATT_DISCOVER_MAX_CHARACTERISTICS];
+  uint16_t keptEndHandle[ATT_DISCOVER_MAX_CHARACTERISTICS];
+  int keptCount = 0;
+  bool lastKeptOpen = false;  // End handle of kept[keptCount - 1] still unknown
+
+  uint16_t reqStartHandle = device->service(0)->startHandle();
+
+  while (reqStartHandle != 0x0000) {
+    int respLength = readByTypeReq(connHandle, reqStartHandle, 0xffff, BLETypeCharacteristic, responseBuffer);
+
+    if (respLength == 0) {
+      return false;
+    }
+
+    if (responseBuffer[0] != ATT_OP_READ_BY_TYPE_RESP) {
+      break;
+    }
+
+    uint16_t lengthPerCharacteristic = responseBuffer[1];
+    uint8_t uuidLen = lengthPerCharacteristic - 5;
+
+    for (int i = 2; i + lengthPerCharacteristic <= respLength; i += lengthPerCharacteristic) {
+      struct __attribute__ ((packed)) RawCharacteristic {
+        uint16_t startHandle;
+        uint8_t properties;
+        uint16_t valueHandle;
+        uint8_t uuid[16];
+      } *rawCharacteristic = (RawCharacteristic*)&responseBuffer[i];
+
+      BLERemoteService* service = NULL;
+
+      for (unsigned int s = 0; s < device->serviceCount(); s++) {
+        BLERemoteService* candidate = device->service(s);
+
+        if (rawCharacteristic->startHandle >= candidate->startHandle() &&
+            rawCharacteristic->startHandle <= candidate->endHandle()) {
+          service = candidate;
+          break;
+        }
+      }
+
+      // any declaration ends the previous characteristic's descriptors
+      if (lastKeptOpen && rawCharacteristic->startHandle - 1 < keptEndHandle[keptCount - 1]) {
+        keptEndHandle[keptCount - 1] = rawCharacteristic->startHandle - 1;
+      }
+      lastKeptOpen = false;
+
+      reqStartHandle = rawCharacteristic->valueHandle + 1;
+
+      if (service == NULL || keptCount == ATT_DISCOVER_MAX_CHARACTERISTICS) {
+        continue;
+      }
+
+      bool wanted = false;
+
+      for (int n = 0; n < count && !wanted; n++) {
+        BLEUuid uuid(characteristicUuids[n]);
+
+        wanted = (uuidLen == uuid.length() && memcmp(rawCharacteristic->uuid, uuid.data(), uuidLen) == 0);
+      }
+
+      if (!wanted) {
+        continue;
+      }
+
+      BLERemoteCharacteristic* characteristic = new BLERemoteCharacteristic(rawCharacteristic->uuid, uuidLen,
+                                                                            connHandle,
+                                                                            rawCharacteristic->startHandle,
+                                                                            rawCharacteristic->properties,
+                                                                            rawCharacteristic->valueHandle);
+
+      if (characteristic == NULL) {
+        return false;
+      }
+
+      service->addCharacteristic(characteristic);
+
+      kept[keptCount] = characteristic;
+      keptEndHandle[keptCount] = service->endHandle();
+      keptCount++;
+      lastKeptOpen = true;
+    }
+  }
+
+  if (keptCount == 0) {
+    return false;
+  }
+
+  for (int n = 0; n < keptCount; n++) {
+    BLERemoteCharacteristic* characteristic = kept[n];
+
+    if ((characteristic->properties() & (BLENotify | BLEIndicate)) == 0) {
+      continue;
+    }
+
+    uint16_t descStartHandle = characteristic->valueHandle() + 1;
+
+    while (descStartHandle != 0x0000 && descStartHandle <= keptEndHandle[n]) {
+      int respLength = findInfoReq(connHandle, descStartHandle, keptEndHandle[n], responseBuffer);
+
+      if (respLength == 0) {
+        return false;
+      }
+
+      if (responseBuffer[0] != ATT_OP_FIND_INFO_RESP) {
+        break;
+      }
+
+      uint16_t lengthPerDescriptor = (responseBuffer[1] == 0x01) ? 4 : 18;
+
+      for (int i = 2; i + lengthPerDescriptor <= respLength; i += lengthPerDescriptor) {
+        struct __attribute__ ((packed)) RawDescriptor {
+          uint16_t handle;
+          uint8_t uuid[16];
+        } *rawDescriptor = (RawDescriptor*)&responseBuffer[i];
+
+        BLERemoteDescriptor* descriptor = new BLERemoteDescriptor(rawDescriptor->uuid, lengthPerDescriptor - 2,
+                                                                  connHandle,
+                                                                  rawDescriptor->handle);
+
+        if (descriptor == NULL) {
+          return false;
+        }
+
+        characteristic->addDescriptor(descriptor);
+
+        descStartHandle = rawDescriptor->handle + 1;
+      }
+    }
+  }
+
+  return true;
+}
+
+// Record the handles of the given (already discovered) characteristics, which must share one service
+bool ATTClass::exportAttributes(uint8_t peerBdaddrType, uint8_t peerBdaddr[6], const char* const characteristicUuids[], int count, BLEAttributeCache* cache)
+{
+  BLERemoteDevice* device = this->device(peerBdaddrType, peerBdaddr);
+
+  if (device == NULL || count <= 0 || count > BLE_ATTRIBUTE_CACHE_MAX_CHARACTERISTICS) {
+    return false;
+  }
+
+  memset(cache, 0x00, sizeof(*cache));
+
+  BLERemoteService* cachedService = NULL;
+
+  for (int n = 0; n < count; n++) {
+    BLERemoteService* foundService = NULL;
+    BLERemoteCharacteristic* found = NULL;
+
+    for (unsigned int i = 0; i < device->serviceCount() && found == NULL; i++) {
+      BLERemoteService* service = device->service(i);
+
+      for (unsigned int j = 0; j < service->characteristicCount(); j++) {
+        BLERemoteCharacteristic* characteristic = service->characteristic(j);
+
+        if (strcasecmp(characteristic->uuid(), characteristicUuids[n]) == 0) {
+          foundService = service;
+          found = characteristic;
+          break;
+        }
+      }
+    }
+
+    if (found == NULL || (cachedService != NULL && foundService != cachedService)) {
+      return false;
+    }
+
+    if (cachedService == NULL) {
+      BLEUuid serviceUuid(foundService->uuid());
+
+      cachedService = foundService;
+      memcpy(cache->serviceUuid, serviceUuid.data(), serviceUuid.length());
+      cache->serviceUuidLength = serviceUuid.length();
+      cache->serviceStartHandle = foundService->startHandle();
+      cache->serviceEndHandle = foundService->endHandle();
+    }
+
+    // the same characteristic can back several roles (e.g. read + write)
+    bool duplicate = false;
+    for (int k = 0; k < cache->characteristicCount; k++) {
+      if (cache->characteristics[k].valueHandle == found->valueHandle()) {
+        duplicate = true;
+      }
+    }
+
+    if (duplicate) {
+      continue;
+    }
+
+    BLECachedCharacteristic* entry = &cache->characteristics[cache->characteristicCount++];
+    BLEUuid uuid(found->uuid());
+
+    memcpy(entry->uuid, uuid.data(), uuid.length());
+    entry->uuidLength = uuid.length();
+    entry->properties = found->properties();
+    entry->startHandle = found->startHandle();
+    entry->valueHandle = found->valueHandle();
+
+    for (unsigned int d = 0; d < found->descriptorCount(); d++) {
+      BLERemoteDescriptor* descriptor = found->descriptor(d);
+
+      if (strcmp(descriptor->uuid(), "2902") == 0) {
+        entry->cccdHandle = descriptor->handle();
+      }
+    }
+  }
+
+  return true;
+}
+
+// Rebuild the peer's attribute tree from a cache instead of discovering it. Each cached
+// characteristic is verified with one Read By Type request on its declaration handle;
+// any mismatch (firmware update, different device) returns false so the caller can
+// fall back to discoverAttributes()
+bool ATTClass::restoreAttributes(uint8_t peerBdaddrType, uint8_t peerBdaddr[6], const BLEAttributeCache* cache)
+{
+  uint16_t connHandle = connectionHandle(peerBdaddrType, peerBdaddr);
+  if (connHandle == 0xffff || cache->characteristicCount == 0 ||
+      cache->characteristicCount > BLE_ATTRIBUTE_CACHE_MAX_CHARACTERISTICS) {
+    return false;
+  }
+
+  // send MTU request
+  if (!exchangeMtu(connHandle)) {
+    return false;
+  }
+
+  uint8_t responseBuffer[_maxMtu];
+
+  for (int n = 0; n < cache->characteristicCount; n++) {
+    const BLECachedCharacteristic* entry = &cache->characteristics[n];
+
+    int respLength = readByTypeReq(connHandle, entry->startHandle, entry->startHandle, BLETypeCharacteristic, responseBuffer);
+
+    if (respLength < 2 || responseBuffer[0] != ATT_OP_READ_BY_TYPE_RESP) {
+      return false;
+    }
+
+    struct __attribute__ ((packed)) RawCharacteristic {
+      uint16_t startHandle;
+      uint8_t properties;
+      uint16_t valueHandle;
+      uint8_t uuid[16];
+    } *rawCharacteristic = (RawCharacteristic*)&responseBuffer[2];
+
+    uint8_t uuidLen = responseBuffer[1] - 5;
+
+    if (rawCharacteristic->startHandle != entry->startHandle ||
+        rawCharacteristic->properties != entry->properties ||
+        rawCharacteristic->valueHandle != entry->valueHandle ||
+        uuidLen != entry->uuidLength ||
+        memcmp(rawCharacteristic->uuid, entry->uuid, uuidLen) != 0) {
+      return false;
+    }
+  }
+
+  BLERemoteDevice* device = NULL;
+
+  for (int i = 0; i < ATT_MAX_PEERS; i++) {
+    if (_peers[i].connectionHandle == connHandle) {
+      if (_peers[i].device == NULL) {
+        _peers[i].device = new BLERemoteDevice();
+      }
+
+      device = _peers[i].device;
+
+      break;
+    }
+  }
+
+  if (device == NULL) {
+    return false;
+  }
+
+  device->clearServices();
+
+  BLERemoteService* service = new BLERemoteService(cache->serviceUuid, cache->serviceUuidLength,
+                                                    cache->serviceStartHandle,
+                                                    cache->serviceEndHandle);
+
+  if (service == NULL) {
+    return false;
+  }
+
+  device->addService(service);
+
+  for (int n = 0; n < cache->characteristicCount; n++) {
+    const BLECachedCharacteristic* entry = &cache->characteristics[n];
+
+    BLERemoteCharacteristic* characteristic = new BLERemoteCharacteristic(entry->uuid, entry->uuidLength,
+                                                                          connHandle,
+                                                                          entry->startHandle,
+                                                                          entry->properties,
+                                                                          entry->valueHandle);
+
+    if (characteristic == NULL) {
+      return false;
+    }
+
+    service->addCharacteristic(characteristic);
+
+    if (entry->cccdHandle != 0) {
+      static const uint8_t cccdUuid[2] = { 0x02, 0x29 };
+
+      BLERemoteDescriptor* descriptor = new BLERemoteDescriptor(cccdUuid, sizeof(cccdUuid),
+                                                                connHandle,
+                                                                entry->cccdHandle);
+
+      if (descriptor == NULL) {
+        return false;
+      }
+
+      characteristic->addDescriptor(descriptor);
+    }
+  }
+
+  return true;
+}
+
 void ATTClass::setMaxMtu(uint16_t maxMtu)
 {
   _maxMtu = maxMtu;
@@ -232,8 +607,8 @@ void ATTClass::setTimeout(unsigned long timeout)
 }
 
 void ATTClass::addConnection(uint16_t handle, uint8_t role, uint8_t peerBdaddrType,
-                              uint8_t peerBdaddr[6], uint16_t /*interval*/,
-                              uint16_t /*latency*/, uint16_t /*supervisionTimeout*/,
+                              uint8_t peerBdaddr[6], uint16_t interval,
+                              uint16_t latency, uint16_t supervisionTimeout,
                               uint8_t /*masterClockAccuracy*/)
 {
   int peerIndex = -1;
@@ -253,6 +628,12 @@ void ATTClass::addConnection(uint16_t handle, uint8_t role, uint8_t peerBdaddrTy
   _peers[peerIndex].connectionHandle = handle;
   _peers[peerIndex].role = role;
   _peers[peerIndex].mtu = 23;
+  _peers[peerIndex].mtuExchanged = false;
+  _peers[peerIndex].txOctets = 27;  // LL default until LE Data Length Change
+  _peers[peerIndex].rxOctets = 27;
+  _peers[peerIndex].interval = interval;
+  _peers[peerIndex].latency = latency;
+  _peers[peerIndex].supervisionTimeout = supervisionTimeout;
   _peers[peerIndex].addressType = peerBdaddrType;
   memcpy(_peers[peerIndex].address, peerBdaddr, sizeof(_peers[peerIndex].address));
   uint8_t BDADDr[6];
@@ -273,7 +654,31 @@ void ATTClass::addConnection(uint16_t handle, uint8_t role, uint8_t peerBdaddrTy
   }
 }
 
-void ATTClass::handleData(uint16_t connectionHandle, uint8_t dlen, uint8_t data[])
+void ATTClass::updateConnection(uint16_t handle, uint16_t interval,
+                                uint16_t latency, uint16_t supervisionTimeout)
+{
+  for (int i = 0; i < ATT_MAX_PEERS; i++) {
+    if (_peers[i].connectionHandle == handle) {
+      _peers[i].interval = interval;
+      _peers[i].latency = latency;
+      _peers[i].supervisionTimeout = supervisionTimeout;
+      return;
+    }
+  }
+}
+
+void ATTClass::updateDataLength(uint16_t handle, uint16_t txOctets, uint16_t rxOctets)
+{
+  for (int i = 0; i < ATT_MAX_PEERS; i++) {
+    if (_peers[i].connectionHandle == handle) {
+      _peers[i].txOctets = txOctets;
+      _peers[i].rxOctets = rxOctets;
+      return;
+    }
+  }
+}
+
+void HCI_RX_ATTR ATTClass::handleData(uint16_t connectionHandle, uint8_t dlen, uint8_t data[])
 {
   uint8_t opcode = data[0];
 
@@ -392,8 +797,11 @@ void ATTClass::handleData(uint16_t connectionHandle, uint8_t dlen, uint8_t data[
 
 void ATTClass::removeConnection(uint16_t handle, uint8_t /*reason*/)
 {
+  failRequests(handle, BLE_REQUEST_DISCONNECTED);
+
   int peerIndex = -1;
   int peerCount = 0;
+  int clientCount = 0;  // Peers connected to us (role 0x01), the GATT server's clients
 
   for (int i = 0; i < ATT_MAX_PEERS; i++) {
     if (_peers[i].connectionHandle == handle) {
@@ -402,6 +810,10 @@ void ATTClass::removeConnection(uint16_t handle, uint8_t /*reason*/)
 
     if (_peers[i].connectionHandle != 0xffff) {
       peerCount++;
+
+      if (_peers[i].role == 0x01) {
+        clientCount++;
+      }
     }
   }
 
@@ -412,7 +824,9 @@ void ATTClass::removeConnection(uint16_t handle, uint8_t /*reason*/)
 
   BLEDevice bleDevice(_peers[peerIndex].addressType, _peers[peerIndex].address);
 
-  if (peerCount == 1) {
+  // Subscriptions belong to the server's clients - a central link to a peripheral
+  // staying up must not keep them alive for the next client
+  if (peerCount == 1 || (_peers[peerIndex].role == 0x01 && clientCount == 1)) {
     // clear CCCD values on disconnect
     for (uint16_t i = 0; i < GATT.attributeCount(); i++) {
       BLELocalAttribute* attribute = GATT.attribute(i);
@@ -423,6 +837,9 @@ void ATTClass::removeConnection(uint16_t handle, uint8_t /*reason*/)
         characteristic->writeCccdValue(bleDevice, 0x0000);
       }
     }
+  }
+
+  if (peerCount == 1) {
 
     _longWriteHandle = 0x0000;
     _longWriteValueLength = 0;
@@ -437,6 +854,9 @@ void ATTClass::removeConnection(uint16_t handle, uint8_t /*reason*/)
   _peers[peerIndex].addressType = 0x00;
   memset(_peers[peerIndex].address, 0x00, sizeof(_peers[peerIndex].address));
   _peers[peerIndex].mtu = 23;
+  _peers[peerIndex].mtuExchanged = false;
+  _peers[peerIndex].txOctets = 27;
+  _peers[peerIndex].rxOctets = 27;
   _peers[peerIndex].encryption = PEER_ENCRYPTION::NO_ENCRYPTION;
   _peers[peerIndex].IOCap[0] = 0;
   _peers[peerIndex].IOCap[1] = 0;
@@ -536,12 +956,83 @@ uint16_t ATTClass::mtu(uint16_t handle) const
   return 23;
 }
 
+bool ATTClass::connectionParameters(uint8_t addressType, const uint8_t address[6], uint16_t* interval,
+                                    uint16_t* latency, uint16_t* supervisionTimeout) const
+{
+  for (int i = 0; i < ATT_MAX_PEERS; i++) {
+    if (_peers[i].connectionHandle != 0xffff && _peers[i].addressType == addressType &&
+        memcmp(_peers[i].address, address, 6) == 0) {
+      *interval = _peers[i].interval;
+      *latency = _peers[i].latency;
+      *supervisionTimeout = _peers[i].supervisionTimeout;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool ATTClass::requestConnectionParameters(uint8_t addressType, const uint8_t address[6], uint16_t minInterval,
+                                           uint16_t maxInterval, uint16_t latency, uint16_t supervisionTimeout)
+{
+  uint16_t handle = connectionHandle(addressType, address);
+
+  if (handle == 0xffff) {
+    return false;
+  }
+
+  // Only the command status is awaited; the new values arrive with LE Connection Update Complete
+  return HCI.leConnUpdate(handle, minInterval, maxInterval, latency, supervisionTimeout) == 0;
+}
+
+bool ATTClass::requestMtu(uint8_t addressType, const uint8_t address[6], uint16_t mtu)
+{
+  uint16_t handle = connectionHandle(addressType, address);
+
+  if (handle == 0xffff) {
+    return false;
+  }
+
+  return exchangeMtu(handle, mtu);
+}
+
+bool ATTClass::requestDataLength(uint8_t addressType, const uint8_t address[6], uint16_t txOctets, uint16_t txTime)
+{
+  uint16_t handle = connectionHandle(addressType, address);
+
+  if (handle == 0xffff) {
+    return false;
+  }
+
+  // The controller answers with Command Complete; the lengths in use arrive with LE Data Length Change
+  return HCI.leSetDataLength(handle, txOctets, txTime) == 0;
+}
+
+bool ATTClass::dataLength(uint8_t addressType, const uint8_t address[6], uint16_t* txOctets, uint16_t* rxOctets) const
+{
+  for (int i = 0; i < ATT_MAX_PEERS; i++) {
+    if (_peers[i].connectionHandle != 0xffff && _peers[i].addressType == addressType &&
+        memcmp(_peers[i].address, address, 6) == 0) {
+      *txOctets = _peers[i].txOctets;
+      *rxOctets = _peers[i].rxOctets;
+      return true;
+    }
+  }
+
+  return false;
+}
+
 bool ATTClass::disconnect()
+{
+  return disconnect(0xff);
+}
+
+bool ATTClass::disconnect(uint8_t role)
 {
   int numDisconnects = 0;
 
   for (int i = 0; i < ATT_MAX_PEERS; i++) {
-    if (_peers[i].connectionHandle == 0xffff) {
+    if (_peers[i].connectionHandle == 0xffff || (role != 0xff && _peers[i].role != role)) {
       continue;
     }
 
@@ -557,6 +1048,9 @@ bool ATTClass::disconnect()
     memset(_peers[i].address, 0x00, sizeof(_peers[i].address));
     memset(_peers[i].resolvedAddress, 0x00, sizeof(_peers[i].resolvedAddress));
     _peers[i].mtu = 23;
+    _peers[i].mtuExchanged = false;
+    _peers[i].txOctets = 27;
+    _peers[i].rxOctets = 27;
 
     if (_peers[i].device) {
       delete _peers[i].device;
@@ -585,25 +1079,20 @@ bool ATTClass::handleNotify(uint16_t handle, const uint8_t* value, int length)
   int numNotifications = 0;
 
   for (int i = 0; i < ATT_MAX_PEERS; i++) {
-    if (_peers[i].connectionHandle == 0xffff) {
+    // Local values go to our clients only, not to peripherals we are connected to as central
+    if (_peers[i].connectionHandle == 0xffff || _peers[i].role != 0x01) {
       continue;
     }
 
-    uint8_t notification[_peers[i].mtu];
-    uint16_t notificationLength = 0;
-
+    // Opcode + handle, value appended by HCI straight into its TX queue
+    uint8_t notification[3];
     notification[0] = ATT_OP_HANDLE_NOTIFY;
-    notificationLength++;
-
     memcpy(&notification[1], &handle, sizeof(handle));
-    notificationLength += sizeof(handle);
 
-    length = min((uint16_t)(_peers[i].mtu - notificationLength), (uint16_t)length);
-    memcpy(&notification[notificationLength], value, length);
-    notificationLength += length;
+    uint16_t valueLength = min((uint16_t)(_peers[i].mtu - sizeof(notification)), (uint16_t)length);
 
     /// TODO: Set encryption requirement on notify.
-    HCI.sendAclPkt(_peers[i].connectionHandle, ATT_CID, notificationLength, notification);
+    HCI.sendAclPkt(_peers[i].connectionHandle, ATT_CID, sizeof(notification), notification, valueLength, value);
 
     numNotifications++;
   }
@@ -616,29 +1105,22 @@ bool ATTClass::handleInd(uint16_t handle, const uint8_t* value, int length)
   int numIndications = 0;
 
   for (int i = 0; i < ATT_MAX_PEERS; i++) {
-    if (_peers[i].connectionHandle == 0xffff) {
+    if (_peers[i].connectionHandle == 0xffff || _peers[i].role != 0x01) {
       continue;
     }
 
-    uint8_t indication[_peers[i].mtu];
-    uint16_t indicationLength = 0;
-
+    uint8_t indication[3];
     indication[0] = ATT_OP_HANDLE_IND;
-    indicationLength++;
-
     memcpy(&indication[1], &handle, sizeof(handle));
-    indicationLength += sizeof(handle);
 
-    length = min((uint16_t)(_peers[i].mtu - indicationLength), (uint16_t)length);
-    memcpy(&indication[indicationLength], value, length);
-    indicationLength += length;
+    uint16_t valueLength = min((uint16_t)(_peers[i].mtu - sizeof(indication)), (uint16_t)length);
 
     _cnf = false;
 
-    HCI.sendAclPkt(_peers[i].connectionHandle, ATT_CID, indicationLength, indication);
+    HCI.sendAclPkt(_peers[i].connectionHandle, ATT_CID, sizeof(indication), indication, valueLength, value);
 
     while (!_cnf) {
-      HCI.poll();
+      HCI.poll(1);
 
       if (!connected(_peers[i].addressType, _peers[i].address)) {
         break;
@@ -668,6 +1150,8 @@ void ATTClass::error(uint16_t connectionHandle, uint8_t dlen, uint8_t data[])
     _pendingResp.buffer[0] = ATT_OP_ERROR;
     memcpy(&_pendingResp.buffer[1], data, dlen);
     _pendingResp.length = dlen + 1;
+  } else {
+    completeRequest(connectionHandle, attError->opcode, attError->code, data, dlen);
   }
 }
 
@@ -711,19 +1195,11 @@ int ATTClass::mtuReq(uint16_t connectionHandle, uint16_t mtu, uint8_t responseBu
 
 void ATTClass::mtuResp(uint16_t connectionHandle, uint8_t dlen, uint8_t data[])
 {
-  uint16_t mtu = *(uint16_t*)data;
-
   if (dlen != 2) {
     return;
   }
 
-  for (int i = 0; i < ATT_MAX_PEERS; i++) {
-    if (_peers[i].connectionHandle == connectionHandle) {
-      _peers[i].mtu = mtu;
-      break;
-    }
-  }
-
+  // exchangeMtu() applies min(server, client) once the response is handed over
   if (connectionHandle == _pendingResp.connectionHandle && _pendingResp.op == ATT_OP_MTU_RESP) {
     _pendingResp.buffer[0] = ATT_OP_MTU_RESP;
     memcpy(&_pendingResp.buffer[1], data, dlen);
@@ -1099,6 +1575,8 @@ void ATTClass::readResp(uint16_t connectionHandle, uint8_t dlen, uint8_t data[])
     _pendingResp.buffer[0] = ATT_OP_READ_RESP;
     memcpy(&_pendingResp.buffer[1], data, dlen);
     _pendingResp.length = dlen + 1;
+  } else {
+    completeRequest(connectionHandle, ATT_OP_READ_REQ, 0, data, dlen);
   }
 }
 
@@ -1388,6 +1866,8 @@ void ATTClass::writeResp(uint16_t connectionHandle, uint8_t dlen, uint8_t data[]
     _pendingResp.buffer[0] = ATT_OP_WRITE_RESP;
     memcpy(&_pendingResp.buffer[1], data, dlen);
     _pendingResp.length = dlen + 1;
+  } else {
+    completeRequest(connectionHandle, ATT_OP_WRITE_REQ, 0, data, dlen);
   }
 }
 
@@ -1496,7 +1976,7 @@ void ATTClass::execWriteReq(uint16_t connectionHandle, uint16_t mtu, uint8_t dle
   HCI.sendAclPkt(connectionHandle, ATT_CID, responseLength, response);
 }
 
-void ATTClass::handleNotifyOrInd(uint16_t connectionHandle, uint8_t opcode, uint8_t dlen, uint8_t data[])
+void HCI_RX_ATTR ATTClass::handleNotifyOrInd(uint16_t connectionHandle, uint8_t opcode, uint8_t dlen, uint8_t data[])
 {
   if (dlen < 2) {
     return; // drop
@@ -1519,25 +1999,13 @@ void ATTClass::handleNotifyOrInd(uint16_t connectionHandle, uint8_t opcode, uint
       break;
     }
 
-    int serviceCount = device->serviceCount();
-
-    for (int i = 0; i < serviceCount; i++) {
-      BLERemoteService* s = device->service(i);
-
-      if (s->startHandle() < handle && s->endHandle() >= handle) {
-        int characteristicCount = s->characteristicCount();
+    BLERemoteCharacteristic* c = device->characteristicForHandle(handle);
 
-        for (int j = 0; j < characteristicCount; j++) {
-          BLERemoteCharacteristic* c = s->characteristic(j);
-
-          if (c->valueHandle() == handle) {
-            c->writeValue(BLEDevice(_peers[peer].addressType, _peers[peer].address), &data[2], dlen - 2);
-          }
-        }
-
-        break;
-      }
+    if (c) {
+      c->writeValue(BLEDevice(_peers[peer].addressType, _peers[peer].address), &data[2], dlen - 2);
     }
+
+    break;
   }
 
   if (opcode == ATT_OP_HANDLE_IND) {
@@ -1567,14 +2035,48 @@ void ATTClass::sendError(uint16_t connectionHandle, uint8_t opcode, uint16_t han
 }
 
 
-bool ATTClass::exchangeMtu(uint16_t connectionHandle)
+bool ATTClass::exchangeMtu(uint16_t connectionHandle, uint16_t mtu)
 {
+  int peerIndex = -1;
+
+  for (int i = 0; i < ATT_MAX_PEERS; i++) {
+    if (_peers[i].connectionHandle == connectionHandle) {
+      peerIndex = i;
+      break;
+    }
+  }
+
+  if (peerIndex == -1) {
+    return false;
+  }
+
+  // A client may exchange the MTU only once per connection
+  if (_peers[peerIndex].mtuExchanged) {
+    return true;
+  }
+
+  if (mtu == 0 || mtu > _maxMtu) {
+    mtu = _maxMtu;
+  }
+  if (mtu < 23) {
+    mtu = 23;
+  }
+
   uint8_t responseBuffer[_maxMtu];
+  int respLength = mtuReq(connectionHandle, mtu, responseBuffer);
 
-  if (!mtuReq(connectionHandle, _maxMtu, responseBuffer)) {
+  if (!respLength) {
     return false;
   }
 
+  _peers[peerIndex].mtuExchanged = true;
+
+  if (respLength == 3 && responseBuffer[0] == ATT_OP_MTU_RESP) {
+    uint16_t serverMtu = responseBuffer[1] | (responseBuffer[2] << 8);
+
+    _peers[peerIndex].mtu = max((uint16_t)23, min(serverMtu, mtu));
+  }
+
   return true;
 }
 
@@ -1759,6 +2261,14 @@ bool ATTClass::discoverDescriptors(uint16_t connectionHandle, BLERemoteDevice* d
 
 int ATTClass::sendReq(uint16_t connectionHandle, void* requestBuffer, int requestLength, uint8_t responseBuffer[])
 {
+  if (responseBuffer != NULL) {
+    // One request in flight per link: an asynchronous one goes first
+    for (unsigned long start = millis(); requestInFlight(connectionHandle) && (millis() - start) < _timeout;) {
+      HCI.poll(1);
+      pollRequests();
+    }
+  }
+
   _pendingResp.connectionHandle = connectionHandle;
   _pendingResp.op = ((uint8_t*)requestBuffer)[0] + 1;
   _pendingResp.buffer = responseBuffer;
@@ -1772,7 +2282,7 @@ int ATTClass::sendReq(uint16_t connectionHandle, void* requestBuffer, int reques
   } 
 
   for (unsigned long start = millis(); (millis() - start) < _timeout;) {
-    HCI.poll();
+    HCI.poll(1);  // Sleeps until data arrives instead of spinning
 
     if (!connected(connectionHandle)) {
       break;
@@ -1780,14 +2290,193 @@ int ATTClass::sendReq(uint16_t connectionHandle, void* requestBuffer, int reques
 
     if (_pendingResp.length != 0) {
       _pendingResp.connectionHandle = 0xffff;
+      sendNextRequest(connectionHandle);
       return _pendingResp.length;
     }
   }
 
   _pendingResp.connectionHandle = 0xffff;
+  sendNextRequest(connectionHandle);
   return 0;
 }
 
+int ATTClass::writeReqAsync(uint16_t connectionHandle, uint16_t handle, const uint8_t* data, uint8_t dataLen,
+                            BLERequestHandler handler, void* context)
+{
+  struct __attribute__ ((packed)) {
+    uint8_t op;
+    uint16_t handle;
+    uint8_t data[ATT_ASYNC_MAX_PDU - 3];
+  } writeReq;
+
+  if (dataLen > sizeof(writeReq.data)) {
+    return 0;
+  }
+
+  writeReq.op = ATT_OP_WRITE_REQ;
+  writeReq.handle = handle;
+  memcpy(writeReq.data, data, dataLen);
+
+  return queueRequest(connectionHandle, &writeReq, 3 + dataLen, handler, context);
+}
+
+int ATTClass::readReqAsync(uint16_t connectionHandle, uint16_t handle, BLERequestHandler handler, void* context)
+{
+  struct __attribute__ ((packed)) {
+    uint8_t op;
+    uint16_t handle;
+  } readReq = { ATT_OP_READ_REQ, handle };
+
+  return queueRequest(connectionHandle, &readReq, sizeof(readReq), handler, context);
+}
+
+int ATTClass::requestsPending(uint16_t connectionHandle) const
+{
+  int count = 0;
+
+  for (int i = 0; i < ATT_ASYNC_MAX_REQUESTS; i++) {
+    if (_requests[i].connectionHandle == connectionHandle) {
+      count++;
+    }
+  }
+
+  return count;
+}
+
+void ATTClass::pollRequests()
+{
+  for (int i = 0; i < ATT_ASYNC_MAX_REQUESTS; i++) {
+    AsyncRequest& request = _requests[i];
+
+    if (request.connectionHandle != 0xffff && request.sent && (millis() - request.sentAt) >= _timeout) {
+      // No further requests after a transaction timeout: the link's queue goes too
+      failRequests(request.connectionHandle, BLE_REQUEST_TIMEOUT);
+    }
+  }
+}
+
+int ATTClass::queueRequest(uint16_t connectionHandle, const void* pdu, int length, BLERequestHandler handler, void* context)
+{
+  if (!connected(connectionHandle) || length > ATT_ASYNC_MAX_PDU) {
+    return 0;
+  }
+
+  for (int i = 0; i < ATT_ASYNC_MAX_REQUESTS; i++) {
+    AsyncRequest& request = _requests[i];
+
+    if (request.connectionHandle != 0xffff) {
+      continue;
+    }
+
+    request.connectionHandle = connectionHandle;
+    request.sent = false;
+    request.length = length;
+    request.id = _nextRequestId;
+    request.handler = handler;
+    request.context = context;
+    memcpy(request.pdu, pdu, length);
+
+    _nextRequestId = (_nextRequestId == 0x7fffffff) ? 1 : (_nextRequestId + 1);
+
+    sendNextRequest(connectionHandle);
+
+    return request.id;
+  }
+
+  return 0;
+}
+
+bool ATTClass::requestInFlight(uint16_t connectionHandle) const
+{
+  for (int i = 0; i < ATT_ASYNC_MAX_REQUESTS; i++) {
+    if (_requests[i].connectionHandle == connectionHandle && _requests[i].sent) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+// Oldest queued request of the link, once nothing (asynchronous or sendReq()) is in flight
+void ATTClass::sendNextRequest(uint16_t connectionHandle)
+{
+  if (_pendingResp.connectionHandle == connectionHandle || requestInFlight(connectionHandle)) {
+    return;
+  }
+
+  AsyncRequest* next = NULL;
+
+  for (int i = 0; i < ATT_ASYNC_MAX_REQUESTS; i++) {
+    AsyncRequest& request = _requests[i];
+
+    if (request.connectionHandle == connectionHandle && (next == NULL || request.id < next->id)) {
+      next = &request;
+    }
+  }
+
+  if (next != NULL) {
+    next->sent = true;
+    next->sentAt = millis();
+
+    HCI.sendAclPkt(connectionHandle, ATT_CID, next->length, next->pdu);
+  }
+}
+
+// Response (or error) to the link's request in flight: free it, send the next, call the handler
+bool ATTClass::completeRequest(uint16_t connectionHandle, uint8_t requestOp, int status, const uint8_t* data, uint8_t dlen)
+{
+  for (int i = 0; i < ATT_ASYNC_MAX_REQUESTS; i++) {
+    AsyncRequest& request = _requests[i];
+
+    if (request.connectionHandle != connectionHandle || !request.sent || request.pdu[0] != requestOp) {
+      continue;
+    }
+
+    int id = request.id;
+    BLERequestHandler handler = request.handler;
+    void* context = request.context;
+
+    request.connectionHandle = 0xffff;
+    sendNextRequest(connectionHandle);
+
+    if (handler) {
+      handler(id, status, data, dlen, context);
+    }
+    return true;
+  }
+
+  return false;
+}
+
+void ATTClass::failRequests(uint16_t connectionHandle, int status)
+{
+  struct {
+    int id;
+    BLERequestHandler handler;
+    void* context;
+  } failed[ATT_ASYNC_MAX_REQUESTS];
+  int count = 0;
+
+  // Out of the table first: a handler may queue new requests
+  for (int i = 0; i < ATT_ASYNC_MAX_REQUESTS; i++) {
+    AsyncRequest& request = _requests[i];
+
+    if (request.connectionHandle == connectionHandle) {
+      failed[count].id = request.id;
+      failed[count].handler = request.handler;
+      failed[count].context = request.context;
+      count++;
+      request.connectionHandle = 0xffff;
+    }
+  }
+
+  for (int i = 0; i < count; i++) {
+    if (failed[i].handler) {
+      failed[i].handler(failed[i].id, status, NULL, 0, failed[i].context);
+    }
+  }
+}
+
 void ATTClass::setEventHandler(BLEDeviceEvent event, BLEDeviceEventHandler eventHandler)
 {
   if (event < (sizeof(_eventHandlers) / (sizeof(_eventHandlers[0])))) {
@@ -36,6 +36,16 @@
 #define ATT_MAX_PEERS 8
 #endif
 
+// Characteristics kept by one targeted discoverAttributes() call
+#define ATT_DISCOVER_MAX_CHARACTERISTICS 8
+
+// Asynchronous client requests (writeReqAsync() / readReqAsync()): the caller
+// does not wait, the handler runs from handleData() inside HCI.poll(). ATT
+// allows one request in flight per link, so each link's requests queue and go
+// out in order as the responses arrive. Queued + in flight, all links:
+#define ATT_ASYNC_MAX_REQUESTS 4
+#define ATT_ASYNC_MAX_PDU      64  // opcode + handle + value
+
 enum PEER_ENCRYPTION {
   NO_ENCRYPTION         = 0,
   PAIRING_REQUEST       = 1 << 0,
@@ -60,12 +70,19 @@ public:
   virtual bool connect(uint8_t peerBdaddrType, uint8_t peerBdaddr[6]);
   virtual bool disconnect(uint8_t peerBdaddrType, uint8_t peerBdaddr[6]);
   virtual bool discoverAttributes(uint8_t peerBdaddrType, uint8_t peerBdaddr[6], const char* serviceUuidFilter);
+  virtual bool discoverAttributes(uint8_t peerBdaddrType, uint8_t peerBdaddr[6], const char* const characteristicUuids[], int count);
+  virtual bool exportAttributes(uint8_t peerBdaddrType, uint8_t peerBdaddr[6], const char* const characteristicUuids[], int count, BLEAttributeCache* cache);
+  virtual bool restoreAttributes(uint8_t peerBdaddrType, uint8_t peerBdaddr[6], const BLEAttributeCache* cache);
 
   virtual void addConnection(uint16_t handle, uint8_t role, uint8_t peerBdaddrType,
                     uint8_t peerBdaddr[6], uint16_t interval,
                     uint16_t latency, uint16_t supervisionTimeout,
                     uint8_t masterClockAccuracy);
 
+  virtual void updateConnection(uint16_t handle, uint16_t interval,
+                    uint16_t latency, uint16_t supervisionTimeout);
+  virtual void updateDataLength(uint16_t handle, uint16_t txOctets, uint16_t rxOctets);
+
   virtual void handleData(uint16_t connectionHandle, uint8_t dlen, uint8_t data[]);
 
   virtual void removeConnection(uint16_t handle, uint8_t reason);
@@ -78,8 +95,16 @@ public:
   virtual bool paired() const;
   virtual bool paired(uint16_t handle) const;
   virtual uint16_t mtu(uint16_t handle) const;
+  virtual bool connectionParameters(uint8_t addressType, const uint8_t address[6], uint16_t* interval,
+                    uint16_t* latency, uint16_t* supervisionTimeout) const;
+  virtual bool requestConnectionParameters(uint8_t addressType, const uint8_t address[6], uint16_t minInterval,
+                    uint16_t maxInterval, uint16_t latency, uint16_t supervisionTimeout);
+  virtual bool requestMtu(uint8_t addressType, const uint8_t address[6], uint16_t mtu);
+  virtual bool requestDataLength(uint8_t addressType, const uint8_t address[6], uint16_t txOctets, uint16_t txTime);
+  virtual bool dataLength(uint8_t addressType, const uint8_t address[6], uint16_t* txOctets, uint16_t* rxOctets) const;
 
   virtual bool disconnect();
+  virtual bool disconnect(uint8_t role);  // 0x00: links we opened as central, 0x01: our clients, 0xff: all
 
   virtual BLEDevice central();
 
@@ -91,6 +116,12 @@ public:
   virtual int readReq(uint16_t connectionHandle, uint16_t handle, uint8_t responseBuffer[]);
   virtual int writeReq(uint16_t connectionHandle, uint16_t handle, const uint8_t* data, uint8_t dataLen, uint8_t responseBuffer[]);
   virtual void writeCmd(uint16_t connectionHandle, uint16_t handle, const uint8_t* data, uint8_t dataLen);
+  // Request id (> 0), or 0 when the queue is full, the PDU does not fit or the link is down
+  virtual int writeReqAsync(uint16_t connectionHandle, uint16_t handle, const uint8_t* data, uint8_t dataLen,
+                            BLERequestHandler handler, void* context);
+  virtual int readReqAsync(uint16_t connectionHandle, uint16_t handle, BLERequestHandler handler, void* context);
+  virtual int requestsPending(uint16_t connectionHandle) const;  // Queued + in flight
+  virtual void pollRequests();  // Fails requests unanswered for setTimeout() (BLE.poll())
   virtual int setPeerEncryption(uint16_t connectionHandle, uint8_t encryption);
   uint8_t getPeerEncryption(uint16_t connectionHandle);
   uint16_t getPeerEncrptingConnectionHandle();
@@ -134,13 +165,19 @@ private:
   virtual void handleCnf(uint16_t connectionHandle, uint8_t dlen, uint8_t data[]);
   virtual void sendError(uint16_t connectionHandle, uint8_t opcode, uint16_t handle, uint8_t code);
 
-  virtual bool exchangeMtu(uint16_t connectionHandle);
+  virtual bool exchangeMtu(uint16_t connectionHandle, uint16_t mtu = 0);
   virtual bool discoverServices(uint16_t connectionHandle, BLERemoteDevice* device, const char* serviceUuidFilter);
   virtual bool discoverCharacteristics(uint16_t connectionHandle, BLERemoteDevice* device);
   virtual bool discoverDescriptors(uint16_t connectionHandle, BLERemoteDevice* device);
 
   virtual int sendReq(uint16_t connectionHandle, void* requestBuffer, int requestLength, uint8_t responseBuffer[]);
 
+  int queueRequest(uint16_t connectionHandle, const void* pdu, int length, BLERequestHandler handler, void* context);
+  bool requestInFlight(uint16_t connectionHandle) const;
+  void sendNextRequest(uint16_t connectionHandle);
+  bool completeRequest(uint16_t connectionHandle, uint8_t requestOp, int status, const uint8_t* data, uint8_t dlen);
+  void failRequests(uint16_t connectionHandle, int status);
+
 private:
   uint16_t _maxMtu;
   unsigned long _timeout;
@@ -151,6 +188,12 @@ private:
     uint8_t address[6];
     uint8_t resolvedAddress[6];
     uint16_t mtu;
+    bool mtuExchanged;            // Client side: ATT_OP_MTU_REQ already sent on this link
+    uint16_t txOctets;            // Link layer payload, LE Data Length Change
+    uint16_t rxOctets;
+    uint16_t interval;            // 1.25 ms units, as reported by the controller
+    uint16_t latency;
+    uint16_t supervisionTimeout;  // 10 ms units
     BLERemoteDevice* device;
     uint8_t encryption;
     uint8_t IOCap[3];
@@ -169,6 +212,18 @@ private:
     uint8_t length;
   } _pendingResp;
 
+  struct AsyncRequest {
+    uint16_t connectionHandle;    // 0xffff = free
+    bool sent;
+    uint8_t length;
+    int id;                       // Increasing: the oldest queued request goes next
+    unsigned long sentAt;
+    BLERequestHandler handler;
+    void* context;
+    uint8_t pdu[ATT_ASYNC_MAX_PDU];
+  } _requests[ATT_ASYNC_MAX_REQUESTS];
+  int _nextRequestId;
+
   BLEDeviceEventHandler _eventHandlers[2];
 };
 
@@ -28,6 +28,8 @@ template<class T> struct BLELinkedListNode
   BLELinkedListNode<T>* next;
 };
 
+// get() remembers the node it returned: the usual for (i = 0; i < size(); i++)
+// get(i) walk costs one step per call instead of restarting from the root
 template <typename T> class BLELinkedList {
 public:
   BLELinkedList();
@@ -44,12 +46,17 @@ private:
   unsigned int _size;
   BLELinkedListNode<T>* _root;
   BLELinkedListNode<T>* _last;
+
+  mutable unsigned int _cursorIndex;
+  mutable BLELinkedListNode<T>* _cursor;
 };
 
 template <typename T> BLELinkedList<T>::BLELinkedList() :
   _size(0),
   _root(NULL),
-  _last(NULL)
+  _last(NULL),
+  _cursorIndex(0),
+  _cursor(NULL)
 {
 }
 
@@ -81,12 +88,25 @@ template <typename T> T BLELinkedList<T>::get(unsigned int index) const
     return T();
   }
 
+  if (index == _size - 1) {
+    return _last->data;
+  }
+
   BLELinkedListNode<T>* itemNode = _root;
+  unsigned int i = 0;
 
-  for (unsigned int i = 0; i < index; i++) {
+  if (_cursor != NULL && index >= _cursorIndex) {
+    itemNode = _cursor;
+    i = _cursorIndex;
+  }
+
+  for (; i < index; i++) {
     itemNode = itemNode->next;
   }
 
+  _cursor = itemNode;
+  _cursorIndex = index;
+
   return itemNode->data;
 }
 
@@ -105,6 +125,7 @@ template <typename T> void BLELinkedList<T>::clear()
   _size = 0;
   _root = NULL;
   _last = NULL;
+  _cursor = NULL;
 }
 
 template <typename T> unsigned int BLELinkedList<T>::size() const
@@ -128,6 +149,8 @@ template <typename T> T BLELinkedList<T>::remove(unsigned int index)
 
   T result = itemNode->data;
 
+  _cursor = NULL;
+
   if (previousItemNode == NULL) {
     _root = itemNode->next;
   } else {
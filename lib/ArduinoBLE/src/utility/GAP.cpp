@@ -32,9 +32,17 @@ GAPClass::GAPClass() :
   _advertising(false),
   _scanning(false),
   _advertisingInterval(160),
+  _scanInterval(0x0020),
+  _scanWindow(0x0020),
   _connectable(true),
-  _discoverEventHandler(NULL)
+  _discoverEventHandler(NULL),
+  _scanFilter(NULL),
+  _scanAddressSet(false),
+  _pendingNext(0),
+  _scanReports(0),
+  _scanDropped(0)
 {
+  clearPendingReports();
 }
 
 GAPClass::~GAPClass()
@@ -82,22 +90,38 @@ void GAPClass::stopAdvertise()
   HCI.leSetAdvertiseEnable(0x00);
 }
 
+// Open scan: no name / UUID / address filter left over from a scanFor*() call
+// (the BLEScanFilter stays)
 int GAPClass::scan(bool withDuplicates)
+{
+  _scanNameFilter    = "";
+  _scanUuidFilter    = "";
+  _scanAddressFilter = "";
+  _scanAddressSet    = false;
+
+  return startScan(withDuplicates);
+}
+
+int GAPClass::startScan(bool withDuplicates)
 {
   HCI.leSetScanEnable(false, true);
 
-  // active scan, 20 ms scan interval (N * 0.625), 20 ms scan window (N * 0.625), public own address type, no filter
+  // active scan, scan interval and window in N * 0.625 ms (default 20 ms / 20 ms, see setScanParameters()),
+  // public own address type, no filter
   /*
     Warning (from BLUETOOTH SPECIFICATION 5.x):
     - scan interval: mandatory range from 0x0012 to 0x1000; only even values are valid
     - scan window: mandatory range from 0x0011 to 0x1000
     - The scan window can only be less than or equal to the scan interval
   */
-  if (HCI.leSetScanParameters(0x01, 0x0020, 0x0020, 0x00, 0x00) != 0) {
+  if (HCI.leSetScanParameters(0x01, _scanInterval, _scanWindow, 0x00, 0x00) != 0) {
     return false;
   }
 
   _scanning = true;
+  _scanReports = 0;
+  _scanDropped = 0;
+  clearPendingReports();
 
   if (HCI.leSetScanEnable(true, !withDuplicates) != 0) {
     return 0;
@@ -106,13 +130,35 @@ int GAPClass::scan(bool withDuplicates)
   return 1;
 }
 
+// "aa:bb:cc:dd:ee:ff" as BLEDevice::address() prints it, into report byte order
+static bool parseAddress(const String& text, uint8_t address[6])
+{
+  if (text.length() != 17) {
+    return false;
+  }
+
+  for (int i = 0; i < 6; i++) {
+    const char* start = text.c_str() + i * 3;
+    char* end;
+    unsigned long value = strtoul(start, &end, 16);
+
+    if (end != start + 2 || (i < 5 && *end != ':')) {
+      return false;
+    }
+    address[5 - i] = value;
+  }
+
+  return true;
+}
+
 int GAPClass::scanForName(String name, bool withDuplicates)
 {
   _scanNameFilter    = name;
   _scanUuidFilter    = "";
   _scanAddressFilter = "";
+  _scanAddressSet    = false;
 
-  return scan(withDuplicates);
+  return startScan(withDuplicates);
 }
 
 int GAPClass::scanForUuid(String uuid, bool withDuplicates)
@@ -120,8 +166,9 @@ int GAPClass::scanForUuid(String uuid, bool withDuplicates)
   _scanNameFilter    = "";
   _scanUuidFilter    = uuid;
   _scanAddressFilter = "";
+  _scanAddressSet    = false;
 
-  return scan(withDuplicates);
+  return startScan(withDuplicates);
 }
 
 int GAPClass::scanForAddress(String address, bool withDuplicates)
@@ -129,8 +176,16 @@ int GAPClass::scanForAddress(String address, bool withDuplicates)
   _scanNameFilter    = "";
   _scanUuidFilter    = "";
   _scanAddressFilter = address;
+  _scanAddressSet    = parseAddress(address, _scanAddress);
 
-  return scan(withDuplicates);
+  return startScan(withDuplicates);
+}
+
+// Applied by the next scan*() call. Callers keep window <= interval and both in 0x0012-0x1000
+void GAPClass::setScanParameters(uint16_t scanInterval, uint16_t scanWindow)
+{
+  _scanInterval = scanInterval;
+  _scanWindow = scanWindow;
 }
 
 void GAPClass::stopScan()
@@ -187,6 +242,19 @@ void GAPClass::setEventHandler(BLEDeviceEvent event, BLEDeviceEventHandler event
   }
 }
 
+void GAPClass::setScanFilter(const BLEScanFilter* filter)
+{
+  _scanFilter = filter;
+
+  clearPendingReports();
+}
+
+void GAPClass::scanFilterStats(uint32_t* reports, uint32_t* dropped) const
+{
+  *reports = _scanReports;
+  *dropped = _scanDropped;
+}
+
 void GAPClass::handleLeAdvertisingReport(uint8_t type, uint8_t addressType, uint8_t address[6],
                                           uint8_t eirLength, uint8_t eirData[], int8_t rssi)
 {
@@ -194,6 +262,15 @@ void GAPClass::handleLeAdvertisingReport(uint8_t type, uint8_t addressType, uint
     return;
   }
 
+  _scanReports++;
+
+  // Most reports in a crowded room are someone else's: drop them before allocating
+  int held = -1;
+  if (!passesEarlyFilter(type, addressType, address, eirLength, eirData, rssi, &held)) {
+    _scanDropped++;
+    return;
+  }
+
   if (_discoverEventHandler && type == 0x03) {
     // call event handler and skip adding to discover list
     BLEDevice device(addressType, address);
@@ -232,6 +309,17 @@ void GAPClass::handleLeAdvertisingReport(uint8_t type, uint8_t addressType, uint
 
     _discoveredDevices.add(discoveredDevice);
     discoveredIndex = _discoveredDevices.size() - 1;
+
+    if (held >= 0) {
+      // Advertisement held until its scan response matched
+      PendingReport& report = _pendingReports[held];
+
+      discoveredDevice->setAdvertisementData(report.type, report.eirLength, report.eirData, report.rssi);
+    }
+  }
+
+  if (held >= 0) {
+    _pendingReports[held].used = false;
   }
 
   if (type != 0x04) {
@@ -253,6 +341,137 @@ void GAPClass::handleLeAdvertisingReport(uint8_t type, uint8_t addressType, uint
   }
 }
 
+// False drops the report. A scan response that matched with its advertisement
+// held sets *held to that entry of _pendingReports
+bool GAPClass::passesEarlyFilter(uint8_t type, uint8_t addressType, uint8_t address[6],
+                                 uint8_t eirLength, uint8_t eirData[], int8_t rssi, int* held)
+{
+  if (_scanAddressSet && memcmp(address, _scanAddress, sizeof(_scanAddress)) != 0) {
+    return false;
+  }
+
+  if (_scanFilter == NULL) {
+    return true;
+  }
+
+  int pending = -1;
+
+  for (int i = 0; i < GAP_PENDING_REPORTS; i++) {
+    PendingReport& report = _pendingReports[i];
+
+    if (report.used && report.addressType == addressType && memcmp(report.address, address, 6) == 0) {
+      pending = i;
+      break;
+    }
+  }
+
+  if (matchesAdvertisingData(eirData, eirLength)) {
+    if (type == 0x04) {
+      *held = pending;
+    } else if (pending >= 0) {
+      _pendingReports[pending].used = false;
+    }
+    return true;
+  }
+
+  if (type == 0x04) {
+    if (pending >= 0) {
+      _pendingReports[pending].used = false;
+      return false;
+    }
+
+    // The advertisement matched: the device waits in the list for this response
+    for (unsigned int i = 0; i < _discoveredDevices.size(); i++) {
+      if (_discoveredDevices.get(i)->hasAddress(addressType, address)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  if ((type == GAP_ADV_IND || type == GAP_ADV_SCAN_IND) && eirLength <= sizeof(_pendingReports[0].eirData)) {
+    // The name may come in the scan response: hold the advertisement until then
+    // (oldest entry overwritten)
+    if (pending < 0) {
+      pending = _pendingNext;
+      _pendingNext = (_pendingNext + 1) % GAP_PENDING_REPORTS;
+    }
+
+    PendingReport& report = _pendingReports[pending];
+
+    report.used = true;
+    report.type = type;
+    report.addressType = addressType;
+    memcpy(report.address, address, sizeof(report.address));
+    report.eirLength = eirLength;
+    memcpy(report.eirData, eirData, eirLength);
+    report.rssi = rssi;
+  }
+
+  return false;
+}
+
+bool GAPClass::matchesAdvertisingData(const uint8_t eirData[], uint8_t eirLength) const
+{
+  const BLEScanFilter* filter = _scanFilter;
+
+  if (filter->namePrefixCount == 0 && filter->serviceUuidLength == 0 && filter->companyId < 0) {
+    return true;
+  }
+
+  // AD structures: length (type + value), type, value
+  for (int i = 0; i + 1 < eirLength; ) {
+    uint8_t length = eirData[i];
+
+    if (length == 0 || i + 1 + length > eirLength) {
+      break;
+    }
+
+    uint8_t adType = eirData[i + 1];
+    const uint8_t* value = &eirData[i + 2];
+    uint8_t valueLength = length - 1;
+
+    if (adType == 0x08 || adType == 0x09) {
+      // Shortened / complete local name
+      for (int p = 0; p < filter->namePrefixCount; p++) {
+        size_t prefixLength = strlen(filter->namePrefixes[p]);
+
+        if (prefixLength <= valueLength && memcmp(value, filter->namePrefixes[p], prefixLength) == 0) {
+          return true;
+        }
+      }
+    } else if (adType >= 0x02 && adType <= 0x07 && filter->serviceUuidLength != 0) {
+      // Incomplete / complete lists of 16-, 32- and 128-bit service UUIDs
+      uint8_t uuidLength = (adType <= 0x03) ? 2 : ((adType <= 0x05) ? 4 : 16);
+
+      if (uuidLength == filter->serviceUuidLength) {
+        for (int u = 0; u + uuidLength <= valueLength; u += uuidLength) {
+          if (memcmp(&value[u], filter->serviceUuid, uuidLength) == 0) {
+            return true;
+          }
+        }
+      }
+    } else if (adType == 0xff && filter->companyId >= 0 && valueLength >= 2) {
+      // Manufacturer specific data: company identifier first, little-endian
+      if ((value[0] | (value[1] << 8)) == filter->companyId) {
+        return true;
+      }
+    }
+
+    i += 1 + length;
+  }
+
+  return false;
+}
+
+void GAPClass::clearPendingReports()
+{
+  for (int i = 0; i < GAP_PENDING_REPORTS; i++) {
+    _pendingReports[i].used = false;
+  }
+  _pendingNext = 0;
+}
+
 bool GAPClass::matchesScanFilter(const BLEDevice& device)
 {
   if (_scanAddressFilter.length() > 0 && !(_scanAddressFilter.equalsIgnoreCase(device.address()))) {
@@ -24,6 +24,8 @@
 
 #include "BLEDevice.h"
 
+#define GAP_PENDING_REPORTS 8  // Advertisements held for their scan response (BLEScanFilter)
+
 class GAPClass {
 public:
   GAPClass();
@@ -41,10 +43,18 @@ public:
   virtual BLEDevice available();
 
   virtual void setAdvertisingInterval(uint16_t advertisingInterval);
+  virtual void setScanParameters(uint16_t scanInterval, uint16_t scanWindow);
   virtual void setConnectable(bool connectable);
 
   virtual void setEventHandler(BLEDeviceEvent event, BLEDeviceEventHandler eventHandler);
 
+  // NULL clears it. Stays in effect across scans; scanForAddress() also drops
+  // other addresses before allocation
+  virtual void setScanFilter(const BLEScanFilter* filter);
+  // Advertising reports since the last scan*() call, and how many of them the
+  // filters dropped before allocating a BLEDevice
+  virtual void scanFilterStats(uint32_t* reports, uint32_t* dropped) const;
+
 protected:
   friend class HCIClass;
 
@@ -53,12 +63,29 @@ protected:
 
 private:
   virtual bool matchesScanFilter(const BLEDevice& device);
+  int startScan(bool withDuplicates);
+  bool passesEarlyFilter(uint8_t type, uint8_t addressType, uint8_t address[6], uint8_t eirLength, uint8_t eirData[],
+                         int8_t rssi, int* held);
+  bool matchesAdvertisingData(const uint8_t eirData[], uint8_t eirLength) const;
+  void clearPendingReports();
+
+  struct PendingReport {
+    bool used;
+    uint8_t type;
+    uint8_t addressType;
+    uint8_t address[6];
+    uint8_t eirLength;
+    uint8_t eirData[31];
+    int8_t rssi;
+  };
 
 private:
   bool _advertising;
   bool _scanning;
 
   uint16_t _advertisingInterval;
+  uint16_t _scanInterval;
+  uint16_t _scanWindow;
   bool _connectable;
 
   BLEDeviceEventHandler _discoverEventHandler;
@@ -67,6 +94,14 @@ private:
   String _scanNameFilter;
   String _scanUuidFilter;
   String _scanAddressFilter;
+
+  const BLEScanFilter* _scanFilter;
+  bool _scanAddressSet;
+  uint8_t _scanAddress[6];           // _scanAddressFilter parsed, little-endian as in reports
+  PendingReport _pendingReports[GAP_PENDING_REPORTS];
+  uint8_t _pendingNext;
+  uint32_t _scanReports;
+  uint32_t _scanDropped;
 };
 
 extern GAPClass& GAP;
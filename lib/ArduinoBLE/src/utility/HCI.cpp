@@ -71,6 +71,7 @@
 #define OCF_LE_CREATE_CONN                0x000d
 #define OCF_LE_CANCEL_CONN                0x000e
 #define OCF_LE_CONN_UPDATE                0x0013
+#define OCF_LE_SET_DATA_LENGTH            0x0022
 
 #define HCI_OE_USER_ENDED_CONNECTION 0x13
 
@@ -79,6 +80,8 @@ String metaEventToString(LE_META_EVENT event)
   switch(event){
     case CONN_COMPLETE: return F("CONN_COMPLETE");
     case ADVERTISING_REPORT: return F("ADVERTISING_REPORT");
+    case CONN_UPDATE_COMPLETE: return F("CONN_UPDATE_COMPLETE");
+    case DATA_LENGTH_CHANGE: return F("DATA_LENGTH_CHANGE");
     case LONG_TERM_KEY_REQUEST: return F("LE_LONG_TERM_KEY_REQUEST");
     case READ_LOCAL_P256_COMPLETE: return F("READ_LOCAL_P256_COMPLETE");
     case GENERATE_DH_KEY_COMPLETE: return F("GENERATE_DH_KEY_COMPLETE");
@@ -100,8 +103,16 @@ String commandToString(LE_COMMAND command){
 HCIClass::HCIClass() :
   _debug(NULL),
   _recvIndex(0),
-  _pendingPkt(0)
+  _maxPkt(0),
+  _pendingPkt(0),
+  _txHead(0),
+  _txCount(0)
 {
+  memset(&_txStats, 0x00, sizeof(_txStats));
+  for (int i = 0; i < HCI_TX_LINKS; i++) {
+    _txLinks[i].handle = 0xffff;
+    _txLinks[i].inController = 0;
+  }
 }
 
 HCIClass::~HCIClass()
@@ -120,13 +131,17 @@ void HCIClass::end()
   HCITransport.end();
 }
 
-void HCIClass::poll()
+void HCI_RX_ATTR HCIClass::poll()
 {
   poll(0);
 }
 
-void HCIClass::poll(unsigned long timeout)
+void HCI_RX_ATTR HCIClass::poll(unsigned long timeout)
 {
+  if (!HCITransport.hostContext()) {
+    return;  // Another task is the HCI host and parses everything received
+  }
+
 #ifdef ARDUINO_AVR_UNO_WIFI_REV2
   digitalWrite(NINA_RTS, LOW);
 #endif
@@ -136,19 +151,36 @@ void HCIClass::poll(unsigned long timeout)
   }
 
   while (HCITransport.available()) {
-    byte b = HCITransport.read();
-	
-    if (_recvIndex >= sizeof(_recvBuffer)) {
-        _recvIndex = 0;
-        if (_debug) {
-            _debug->println("_recvBuffer overflow");
+    // Ask the transport for exactly what the current packet still needs:
+    // type byte, then header, then payload - framing is checked per copy, not per byte
+    size_t need = 1;
+    if (_recvIndex > 0) {
+      if (_recvBuffer[0] == HCI_ACLDATA_PKT) {
+        need = (_recvIndex < 5) ? 5 - _recvIndex : (5 + (_recvBuffer[3] + (_recvBuffer[4] << 8))) - _recvIndex;
+      } else {
+        need = (_recvIndex < 3) ? 3 - _recvIndex : (3 + _recvBuffer[2]) - _recvIndex;
+      }
+    }
+
+    if (_recvIndex + need > sizeof(_recvBuffer)) {
+        need = sizeof(_recvBuffer) - _recvIndex;
+        if (need == 0) {
+          _recvIndex = 0;
+          if (_debug) {
+              _debug->println("_recvBuffer overflow");
+          }
+          continue;
         }
     }
 
-    _recvBuffer[_recvIndex++] = b;
+    int received = HCITransport.readPacket(&_recvBuffer[_recvIndex], need);
+    if (received <= 0) {
+      break;
+    }
+    _recvIndex += received;
 
     if (_recvBuffer[0] == HCI_ACLDATA_PKT) {
-      if (_recvIndex > 5 && _recvIndex >= (5 + (_recvBuffer[3] + (_recvBuffer[4] << 8)))) {
+      if (_recvIndex >= 5 && _recvIndex >= (5 + (_recvBuffer[3] + (_recvBuffer[4] << 8)))) {
         if (_debug) {
           dumpPkt("HCI ACLDATA RX <- ", _recvIndex, _recvBuffer);
         }
@@ -165,7 +197,7 @@ void HCIClass::poll(unsigned long timeout)
 #endif
       }
     } else if (_recvBuffer[0] == HCI_EVENT_PKT) {
-      if (_recvIndex > 3 && _recvIndex >= (3 + _recvBuffer[2])) {
+      if (_recvIndex >= 3 && _recvIndex >= (3 + _recvBuffer[2])) {
         if (_debug) {
           dumpPkt("HCI EVENT RX <- ", _recvIndex, _recvBuffer);
         }
@@ -186,7 +218,7 @@ void HCIClass::poll(unsigned long timeout)
       _recvIndex = 0;
 
       if (_debug) {
-        _debug->println(b, HEX);
+        _debug->println(_recvBuffer[0], HEX);
       }
     }
   }
@@ -460,6 +492,21 @@ int HCIClass::leConnUpdate(uint16_t handle, uint16_t minInterval, uint16_t maxIn
 
   return sendCommand(OGF_LE_CTL << 10 | OCF_LE_CONN_UPDATE, sizeof(leConnUpdateData), &leConnUpdateData);
 }
+
+int HCIClass::leSetDataLength(uint16_t handle, uint16_t txOctets, uint16_t txTime)
+{
+  struct __attribute__ ((packed)) HCILeSetDataLengthData {
+    uint16_t handle;
+    uint16_t txOctets;  // 27..251
+    uint16_t txTime;    // 328..2120 us
+  } leSetDataLengthData;
+
+  leSetDataLengthData.handle = handle;
+  leSetDataLengthData.txOctets = txOctets;
+  leSetDataLengthData.txTime = txTime;
+
+  return sendCommand(OGF_LE_CTL << 10 | OCF_LE_SET_DATA_LENGTH, sizeof(leSetDataLengthData), &leSetDataLengthData);
+}
 void HCIClass::saveNewAddress(uint8_t addressType, uint8_t* address, uint8_t* peerIrk, uint8_t* localIrk){
   if(_storeIRK!=0){
     _storeIRK(address, peerIrk);
@@ -614,8 +661,32 @@ int HCIClass::tryResolveAddress(uint8_t* BDAddr, uint8_t* address){
 
 int HCIClass::sendAclPkt(uint16_t handle, uint8_t cid, uint8_t plen, void* data)
 {
-  while (_pendingPkt >= _maxPkt) {
-    poll();
+  return sendAclPkt(handle, cid, 0, NULL, plen, data);
+}
+
+int HCIClass::sendAclPkt(uint16_t handle, uint8_t cid, uint8_t hlen, const void* header, uint16_t plen, const void* data)
+{
+  uint16_t length = hlen + plen;
+
+  if (length > HCI_ACL_MAX_PAYLOAD) {
+    return -1;
+  }
+
+  drainAcl();
+
+  if (_txCount == HCI_TX_QUEUE_SLOTS) {
+    // Pool full: wait for credits, still dispatching what the controller sends us
+    unsigned long start = micros();
+    while (_txCount == HCI_TX_QUEUE_SLOTS) {
+      poll(1);
+      drainAcl();
+    }
+    uint32_t waited = micros() - start;
+    _txStats.stalls++;
+    _txStats.stallUsTotal += waited;
+    if (waited > _txStats.stallUsMax) {
+      _txStats.stallUsMax = waited;
+    }
   }
 
   struct __attribute__ ((packed)) HCIACLHdr {
@@ -624,28 +695,106 @@ int HCIClass::sendAclPkt(uint16_t handle, uint8_t cid, uint8_t plen, void* data)
     uint16_t dlen;
     uint16_t plen;
     uint16_t cid;
-  } aclHdr = { HCI_ACLDATA_PKT, handle, uint8_t(plen + 4), plen, cid };
+  } aclHdr = { HCI_ACLDATA_PKT, handle, uint16_t(length + 4), length, cid };
+
+  TxPacket& pkt = _txPool[(_txHead + _txCount) % HCI_TX_QUEUE_SLOTS];
+  pkt.handle = handle;
+  pkt.length = sizeof(aclHdr) + length;
+  memcpy(pkt.data, &aclHdr, sizeof(aclHdr));
+  if (hlen) {
+    memcpy(&pkt.data[sizeof(aclHdr)], header, hlen);
+  }
+  memcpy(&pkt.data[sizeof(aclHdr) + hlen], data, plen);
+  _txCount++;
 
-  uint8_t txBuffer[sizeof(aclHdr) + plen];
-  memcpy(txBuffer, &aclHdr, sizeof(aclHdr));
-  memcpy(&txBuffer[sizeof(aclHdr)], data, plen);
+  if (_pendingPkt >= _maxPkt) {
+    _txStats.queued++;
+  }
+  drainAcl();
 
-  if (_debug) {
-    dumpPkt("HCI ACLDATA TX -> ", sizeof(aclHdr) + plen, txBuffer);
+  _txStats.depth = _txCount;
+  if (_txCount > _txStats.depthMax) {
+    _txStats.depthMax = _txCount;
   }
+
+  return 0;
+}
+
+// Hand queued packets to the controller while it has buffers for them
+void HCIClass::drainAcl()
+{
+  while (_txCount && _pendingPkt < _maxPkt) {
+    TxPacket& pkt = _txPool[_txHead];
+
+    if (_debug) {
+      dumpPkt("HCI ACLDATA TX -> ", pkt.length, pkt.data);
+    }
 #ifdef _BLE_TRACE_
-  Serial.print("Data tx -> ");
-  for(int i=0; i< sizeof(aclHdr) + plen;i++){
-    Serial.print(" 0x");
-    Serial.print(txBuffer[i],HEX);
-  }
-  Serial.println(".");
+    Serial.print("Data tx -> ");
+    for(int i=0; i< pkt.length;i++){
+      Serial.print(" 0x");
+      Serial.print(pkt.data[i],HEX);
+    }
+    Serial.println(".");
 #endif
 
-  _pendingPkt++;
-  HCITransport.write(txBuffer, sizeof(aclHdr) + plen);
+    _pendingPkt++;
+    int spare = -1;
+    int i = 0;
+    for (; i < HCI_TX_LINKS; i++) {
+      if (_txLinks[i].handle == pkt.handle) {
+        break;
+      }
+      if (spare < 0 && _txLinks[i].handle == 0xffff) {
+        spare = i;
+      }
+    }
+    if (i == HCI_TX_LINKS && spare >= 0) {
+      i = spare;
+      _txLinks[i].handle = pkt.handle;
+      _txLinks[i].inController = 0;
+    }
+    if (i < HCI_TX_LINKS) {
+      _txLinks[i].inController++;
+    }
+
+    HCITransport.write(pkt.data, pkt.length);
 
-  return 0;
+    _txHead = (_txHead + 1) % HCI_TX_QUEUE_SLOTS;
+    _txCount--;
+  }
+  _txStats.depth = _txCount;
+}
+
+// The controller flushes a closed link's packets without completing them:
+// return their credits and drop what is still queued for it
+void HCIClass::releaseLink(uint16_t handle)
+{
+  for (int i = 0; i < HCI_TX_LINKS; i++) {
+    if (_txLinks[i].handle == handle) {
+      uint8_t held = _txLinks[i].inController;
+      _pendingPkt = (_pendingPkt > held) ? _pendingPkt - held : 0;
+      _txLinks[i].handle = 0xffff;
+      _txLinks[i].inController = 0;
+    }
+  }
+
+  uint8_t kept = 0;
+  for (uint8_t n = 0; n < _txCount; n++) {
+    TxPacket& pkt = _txPool[(_txHead + n) % HCI_TX_QUEUE_SLOTS];
+    if (pkt.handle == handle) {
+      _txStats.dropped++;
+      continue;
+    }
+    if (kept != n) {
+      _txPool[(_txHead + kept) % HCI_TX_QUEUE_SLOTS] = pkt;
+    }
+    kept++;
+  }
+  _txCount = kept;
+  _txStats.depth = _txCount;
+
+  drainAcl();
 }
 
 int HCIClass::disconnect(uint16_t handle)
@@ -698,13 +847,13 @@ int HCIClass::sendCommand(uint16_t opcode, uint8_t plen, void* parameters)
   _cmdCompleteStatus = -1;
 
   for (unsigned long start = millis(); _cmdCompleteOpcode != opcode && millis() < (start + 1000);) {
-    poll();
+    poll(1);  // Sleeps until the controller answers instead of spinning
   }
 
   return _cmdCompleteStatus;
 }
 
-void HCIClass::handleAclDataPkt(uint8_t /*plen*/, uint8_t pdata[])
+void HCI_RX_ATTR HCIClass::handleAclDataPkt(uint8_t /*plen*/, uint8_t pdata[])
 {
   struct __attribute__ ((packed)) HCIACLHdr {
     uint16_t handle;
@@ -790,13 +939,22 @@ void HCIClass::handleAclDataPkt(uint8_t /*plen*/, uint8_t pdata[])
   }
 }
 
-void HCIClass::handleNumCompPkts(uint16_t /*handle*/, uint16_t numPkts)
+void HCIClass::handleNumCompPkts(uint16_t handle, uint16_t numPkts)
 {
   if (numPkts && _pendingPkt > numPkts) {
     _pendingPkt -= numPkts;
   } else {
     _pendingPkt = 0;
   }
+
+  for (int i = 0; i < HCI_TX_LINKS; i++) {
+    if (_txLinks[i].handle == handle) {
+      _txLinks[i].inController = (_txLinks[i].inController > numPkts) ? _txLinks[i].inController - numPkts : 0;
+      break;
+    }
+  }
+
+  drainAcl();
 }
 
 void HCIClass::handleEventPkt(uint8_t /*plen*/, uint8_t pdata[])
@@ -818,6 +976,7 @@ void HCIClass::handleEventPkt(uint8_t /*plen*/, uint8_t pdata[])
       uint8_t reason;
     } *disconnComplete = (DisconnComplete*)&pdata[sizeof(HCIEventHdr)];
 
+    releaseLink(disconnComplete->handle);
     ATT.removeConnection(disconnComplete->handle, disconnComplete->reason);
     L2CAPSignaling.removeConnection(disconnComplete->handle, disconnComplete->reason);
 
@@ -1105,6 +1264,37 @@ void HCIClass::handleEventPkt(uint8_t /*plen*/, uint8_t pdata[])
         }
         break;
       }
+      case CONN_UPDATE_COMPLETE:{
+        struct __attribute__ ((packed)) EvtLeConnectionUpdateComplete {
+          uint8_t status;
+          uint16_t handle;
+          uint16_t interval;
+          uint16_t latency;
+          uint16_t supervisionTimeout;
+        } *leConnectionUpdateComplete = (EvtLeConnectionUpdateComplete*)&pdata[sizeof(HCIEventHdr) + sizeof(LeMetaEventHeader)];
+
+        if (leConnectionUpdateComplete->status == 0x00) {
+          ATT.updateConnection(leConnectionUpdateComplete->handle,
+                               leConnectionUpdateComplete->interval,
+                               leConnectionUpdateComplete->latency,
+                               leConnectionUpdateComplete->supervisionTimeout);
+        }
+        break;
+      }
+      case DATA_LENGTH_CHANGE:{
+        struct __attribute__ ((packed)) EvtLeDataLengthChange {
+          uint16_t handle;
+          uint16_t maxTxOctets;
+          uint16_t maxTxTime;
+          uint16_t maxRxOctets;
+          uint16_t maxRxTime;
+        } *leDataLengthChange = (EvtLeDataLengthChange*)&pdata[sizeof(HCIEventHdr) + sizeof(LeMetaEventHeader)];
+
+        ATT.updateDataLength(leDataLengthChange->handle,
+                             leDataLengthChange->maxTxOctets,
+                             leDataLengthChange->maxRxOctets);
+        break;
+      }
       case LONG_TERM_KEY_REQUEST:{
         struct __attribute__ ((packed)) LTKRequest
         {
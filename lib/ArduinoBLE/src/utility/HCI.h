@@ -43,14 +43,43 @@ enum LE_COMMAND {
 enum LE_META_EVENT {
   CONN_COMPLETE             = 0x01,
   ADVERTISING_REPORT        = 0x02,
+  CONN_UPDATE_COMPLETE      = 0x03,
   LONG_TERM_KEY_REQUEST     = 0x05,
   REMOTE_CONN_PARAM_REQ     = 0x06,
+  DATA_LENGTH_CHANGE        = 0x07,
   READ_LOCAL_P256_COMPLETE  = 0x08,
   GENERATE_DH_KEY_COMPLETE  = 0x09
 };
 String metaEventToString(LE_META_EVENT event);
 String commandToString(LE_COMMAND command);
 
+// ACL packets waiting for a controller buffer. sendAclPkt() copies into this
+// pool and returns; the packets go out as Number Of Completed Packets events
+// return credits. It only waits (polling, so the receive path keeps running)
+// when the pool itself is full.
+#ifndef HCI_TX_QUEUE_SLOTS
+#define HCI_TX_QUEUE_SLOTS 8
+#endif
+
+// Links whose controller credits are tracked, so a disconnect returns the
+// credits of packets the controller flushed without completing
+#ifndef HCI_TX_LINKS
+#define HCI_TX_LINKS 8
+#endif
+
+#define HCI_ACL_HDR_SIZE   9    // packet type, handle, length, L2CAP length, CID
+#define HCI_ACL_MAX_PAYLOAD 255
+
+struct HCITxStats {
+  volatile uint32_t queued;       // Packets that waited for a controller credit
+  volatile uint32_t stalls;       // sendAclPkt() calls that found the pool full
+  volatile uint32_t stallUsTotal; // Time spent waiting in those calls
+  volatile uint32_t stallUsMax;
+  volatile uint32_t dropped;      // Queued packets of links that closed
+  volatile uint8_t depth;         // Packets in the pool now
+  volatile uint8_t depthMax;
+};
+
 class HCIClass {
 public:
   HCIClass();
@@ -93,6 +122,7 @@ public:
   virtual int leConnUpdate(uint16_t handle, uint16_t minInterval, uint16_t maxInterval, 
                   uint16_t latency, uint16_t supervisionTimeout);
   virtual int leCancelConn();
+  virtual int leSetDataLength(uint16_t handle, uint16_t txOctets, uint16_t txTime);
   virtual int leEncrypt(uint8_t* Key, uint8_t* plaintext, uint8_t* status, uint8_t* ciphertext);
   // Generate a 64 bit random number
   virtual int leRand(uint8_t rand[]);
@@ -111,6 +141,9 @@ public:
   virtual int tryResolveAddress(uint8_t* BDAddr, uint8_t* address);
 
   virtual int sendAclPkt(uint16_t handle, uint8_t cid, uint8_t plen, void* data);
+  // L2CAP payload from two parts (e.g. ATT opcode + handle, then the value), copied straight into the queue
+  virtual int sendAclPkt(uint16_t handle, uint8_t cid, uint8_t hlen, const void* header, uint16_t plen, const void* data);
+  const HCITxStats& txStats() const { return _txStats; }
 
   virtual int disconnect(uint16_t handle);
 
@@ -142,6 +175,8 @@ private:
   virtual void handleAclDataPkt(uint8_t plen, uint8_t pdata[]);
   virtual void handleNumCompPkts(uint16_t handle, uint16_t numPkts);
   virtual void handleEventPkt(uint8_t plen, uint8_t pdata[]);
+  void drainAcl();
+  void releaseLink(uint16_t handle);
 
   virtual void dumpPkt(const char* prefix, uint8_t plen, uint8_t pdata[]);
 
@@ -159,6 +194,22 @@ private:
   uint8_t _pendingPkt;
 
   uint8_t _aclPktBuffer[255];
+
+  struct TxPacket {
+    uint16_t handle;
+    uint16_t length;
+    uint8_t data[HCI_ACL_HDR_SIZE + HCI_ACL_MAX_PAYLOAD];
+  };
+  TxPacket _txPool[HCI_TX_QUEUE_SLOTS];
+  uint8_t _txHead;
+  uint8_t _txCount;
+  HCITxStats _txStats;
+
+  struct TxLink {
+    uint16_t handle;
+    uint8_t inController;
+  };
+  TxLink _txLinks[HCI_TX_LINKS];
 };
 
 extern HCIClass& HCI;
@@ -22,6 +22,15 @@
 
 #include <Arduino.h>
 
+// Receive path of a notification (transport -> HCI -> L2CAP -> ATT) runs from
+// IRAM on ESP32: no flash cache misses while the notification is parsed
+#if defined(ESP32)
+#include <esp_attr.h>
+#define HCI_RX_ATTR IRAM_ATTR
+#else
+#define HCI_RX_ATTR
+#endif
+
 class HCITransportInterface {
 public:
   virtual int begin() = 0;
@@ -33,7 +42,31 @@ public:
   virtual int peek() = 0;
   virtual int read() = 0;
 
+  // Copy up to `length` already received bytes without blocking, returns the
+  // count (0 when nothing is buffered). Transports that receive whole HCI
+  // packets override it so the host can take a packet in a few copies
+  // instead of one read() per byte.
+  virtual int readPacket(uint8_t* buffer, size_t length)
+  {
+    size_t count = 0;
+    while (count < length && available()) {
+      int c = read();
+      if (c < 0) {
+        break;
+      }
+      buffer[count++] = (uint8_t)c;
+    }
+    return count;
+  }
+
   virtual size_t write(const uint8_t* data, size_t length) = 0;
+
+  // False when the calling task must not parse received data (another task
+  // is the HCI host). HCIClass::poll() then returns without touching it.
+  virtual bool hostContext()
+  {
+    return true;
+  }
 };
 
 extern HCITransportInterface& HCITransport;
@@ -21,18 +21,32 @@
 
 #include "HCIVirtualTransport.h"
 
+// Room for a burst of advertising reports / notifications while the host task
+// is busy; the VHCI callback blocks the controller when this fills up
+#define HCI_VHCI_RX_BUFFER_SIZE 1024
+
 StreamBufferHandle_t rec_buffer;
 StreamBufferHandle_t send_buffer;
 TaskHandle_t bleHandle;
+static volatile TaskHandle_t rx_notify_task = NULL;
+static volatile uint32_t rx_notify_bits = 0;
+
+// wait() blocks in the stream buffer for the first byte; it is held here until read
+static uint8_t rx_lookahead;
+static bool rx_lookahead_valid = false;
 
 
 static void notify_host_send_available(void)
 {
 }
 
-static int notify_host_recv(uint8_t *data, uint16_t length)
+static int HCI_RX_ATTR notify_host_recv(uint8_t *data, uint16_t length)
 {
   xStreamBufferSend(rec_buffer,data,length,portMAX_DELAY);  // !!!potentially waiting forever
+  TaskHandle_t task = rx_notify_task;
+  if (task != NULL) {
+    xTaskNotify(task, rx_notify_bits, eSetBits);
+  }
   return 0;
 }
 
@@ -67,7 +81,7 @@ int HCIVirtualTransportClass::begin()
 {
   btStarted(); // this somehow stops the arduino ide from initializing bluedroid
 
-  rec_buffer = xStreamBufferCreate(258, 1);
+  rec_buffer = xStreamBufferCreate(HCI_VHCI_RX_BUFFER_SIZE, 1);
   send_buffer = xStreamBufferCreate(258, 1);
 
   // Initialize NVS only if not already initialized (WiFi+BLE coexistence fix)
@@ -105,27 +119,36 @@ void HCIVirtualTransportClass::end()
 
 void HCIVirtualTransportClass::wait(unsigned long timeout)
 {
-  for (unsigned long start = (esp_timer_get_time() / 1000ULL); ((esp_timer_get_time() / 1000ULL) - start) < timeout;) {
-    if (available()) {
-      break;
-    }
+  // Sleep in the stream buffer until data arrives (was a busy loop on available())
+  if (rx_lookahead_valid || !hostContext()) {
+    return;
+  }
+  TickType_t ticks = pdMS_TO_TICKS(timeout);
+  if (ticks == 0 && timeout > 0) {
+    ticks = 1;
+  }
+  if (xStreamBufferReceive(rec_buffer, &rx_lookahead, 1, ticks) == 1) {
+    rx_lookahead_valid = true;
   }
 }
 
-int HCIVirtualTransportClass::available()
+int HCI_RX_ATTR HCIVirtualTransportClass::available()
 {
   size_t bytes	= xStreamBufferBytesAvailable(rec_buffer);
-  return bytes;
+  return bytes + (rx_lookahead_valid ? 1 : 0);
 }
 
-// never called
 int HCIVirtualTransportClass::peek()
 {
-  return -1;
+  return rx_lookahead_valid ? rx_lookahead : -1;
 }
 
 int HCIVirtualTransportClass::read()
 {
+  if (rx_lookahead_valid) {
+    rx_lookahead_valid = false;
+    return rx_lookahead;
+  }
   uint8_t c;
   if(xStreamBufferReceive(rec_buffer, &c, 1, portMAX_DELAY)) {
     return c;
@@ -133,12 +156,35 @@ int HCIVirtualTransportClass::read()
   return -1;
 }
 
+int HCI_RX_ATTR HCIVirtualTransportClass::readPacket(uint8_t* buffer, size_t length)
+{
+  size_t count = 0;
+  if (rx_lookahead_valid && length > 0) {
+    buffer[count++] = rx_lookahead;
+    rx_lookahead_valid = false;
+  }
+  // VHCI hands over whole packets; take as much of one as asked in a single copy
+  return count + xStreamBufferReceive(rec_buffer, buffer + count, length - count, 0);
+}
+
 size_t HCIVirtualTransportClass::write(const uint8_t* data, size_t length)
 {
   size_t result = xStreamBufferSend(send_buffer,data,length,portMAX_DELAY);
   return result;
 }
 
+bool HCIVirtualTransportClass::hostContext()
+{
+  TaskHandle_t host = rx_notify_task;
+  return host == NULL || host == xTaskGetCurrentTaskHandle();
+}
+
+void HCIVirtualTransportClass::setRxNotify(TaskHandle_t task, uint32_t bits)
+{
+  rx_notify_bits = bits;
+  rx_notify_task = task;
+}
+
 HCIVirtualTransportClass HCIVirtualTransport;
 
 HCITransportInterface& HCITransport = HCIVirtualTransport;
@@ -45,6 +45,18 @@ public:
   virtual int available();
   virtual int peek();
   virtual int read();
+  virtual int readPacket(uint8_t* buffer, size_t length);
 
   virtual size_t write(const uint8_t* data, size_t length);
-};
\ No newline at end of file
+
+  virtual bool hostContext();
+
+  // Wake a task (xTaskNotify eSetBits) whenever the controller delivers HCI data,
+  // so the host can block instead of polling available(). NULL task disables it.
+  // The task also becomes the HCI host: HCI.poll() from any other task (the
+  // implicit pumps in connected(), valueUpdated(), ...) returns without reading,
+  // so received packets are parsed on one task only.
+  void setRxNotify(TaskHandle_t task, uint32_t bits);
+};
+
+extern HCIVirtualTransportClass HCIVirtualTransport;
\ No newline at end of file
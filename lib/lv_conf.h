@@ -18,6 +18,7 @@
 #define LV_CONF_H
 
 #include <stdint.h>
+#include <stddef.h>
 
 /*====================
    COLOR SETTINGS
@@ -46,17 +47,25 @@
  *=========================*/
 
 /*1: use custom malloc/free, 0: use the built-in `lv_mem_alloc()` and `lv_mem_free()`*/
-#define LV_MEM_CUSTOM 1
+#define LV_MEM_CUSTOM 0
 #if LV_MEM_CUSTOM == 0
     /*Size of the memory available for `lv_mem_alloc()` in bytes (>= 2kB)*/
-    #define LV_MEM_SIZE (48U * 1024U)          /*[bytes]*/
+    #define LV_MEM_SIZE (128U * 1024U)          /*[bytes]*/
 
     /*Set an address for the memory pool instead of allocating it as a normal array. Can be in external SRAM too.*/
     #define LV_MEM_ADR 0     /*0: unused*/
     /*Instead of an address give a memory allocator that will be called to get a memory pool for LVGL. E.g. my_malloc*/
     #if LV_MEM_ADR == 0
-        //#define LV_MEM_POOL_INCLUDE your_alloc_library  /* Uncomment if using an external allocator*/
-        //#define LV_MEM_POOL_ALLOC   your_alloc          /* Uncomment if using an external allocator*/
+        /*Dedicated pool outside the BLE / system heap - src/lvgl_heap.h*/
+        #define LV_MEM_POOL_INCLUDE <stddef.h>
+        #define LV_MEM_POOL_ALLOC   lvglHeapPool
+        #ifdef __cplusplus
+        extern "C" {
+        #endif
+        void * lvglHeapPool(size_t size);
+        #ifdef __cplusplus
+        }
+        #endif
     #endif
 
 #else       /*LV_MEM_CUSTOM*/
@@ -70,8 +79,9 @@
  *You will see an error log message if there wasn't enough buffers. */
 #define LV_MEM_BUF_MAX_NUM 16
 
-/*Use the standard `memcpy` and `memset` instead of LVGL's own functions. (Might or might not be faster).*/
-#define LV_MEMCPY_MEMSET_STD 0
+/*Use the standard `memcpy` and `memset` instead of LVGL's own functions. (Might or might not be faster).
+ *newlib's word-wide routines beat LVGL's byte loops on PSRAM buffers - "membench" (src/mem_fast.h)*/
+#define LV_MEMCPY_MEMSET_STD 1
 
 /*====================
    HAL SETTINGS
@@ -111,7 +121,11 @@
     /*Allow buffering some shadow calculation.
     *LV_SHADOW_CACHE_SIZE is the max. shadow size to buffer, where shadow size is `shadow_width + radius`
     *Caching has LV_SHADOW_CACHE_SIZE^2 RAM cost*/
+    /*0: neither the dark default theme nor the SquareLine screens draw a shadow - "render" on the
+     *serial console reports the size needed after a UI change; override with -D to A/B*/
+    #ifndef LV_SHADOW_CACHE_SIZE
     #define LV_SHADOW_CACHE_SIZE 0
+    #endif
 
     /* Set number of maximally cached circle data.
     * The circumference of 1/4 circle are saved for anti-aliasing
@@ -125,7 +139,9 @@
  *With complex image decoders (e.g. PNG or JPG) caching can save the continuous open/decode of images.
  *However the opened images might consume additional RAM.
  *0: to disable caching*/
-#define LV_IMG_CACHE_DEF_SIZE   0
+// One entry per SquareLine icon (11) + spare: the icon decoder (src/ui_assets.h) sits in front of the
+// built-in one, and a hit skips both. Entries are ~40 B of LVGL heap; the pixels stay in flash.
+#define LV_IMG_CACHE_DEF_SIZE   12
 
 /*Number of stops allowed per gradient. Increase this to allow more stops.
  *This adds (sizeof(lv_color_t) + 1) bytes per additional stop*/
@@ -136,7 +152,10 @@
  *LV_GRAD_CACHE_DEF_SIZE sets the size of this cache in bytes.
  *If the cache is too small the map will be allocated only while it's required for the drawing.
  *0 mean no caching.*/
+// 0: no gradient is drawn by the theme or the SquareLine screens ("render" reports the bytes needed)
+#ifndef LV_GRAD_CACHE_DEF_SIZE
 #define LV_GRAD_CACHE_DEF_SIZE      0
+#endif
 
 /*Allow dithering the gradients (to achieve visual smooth color gradients on limited color depth display)
  *LV_DITHER_GRADIENT implies allocating one or two more lines of the object's rendering surface
@@ -298,7 +317,8 @@
 #define LV_ATTRIBUTE_TIMER_HANDLER
 
 /*Define a custom attribute to `lv_disp_flush_ready` function*/
-#define LV_ATTRIBUTE_FLUSH_READY
+/*Called from the SPI DMA post-callback (ISR), so it must live in IRAM*/
+#define LV_ATTRIBUTE_FLUSH_READY __attribute__((section(".iram1.lv_disp_flush_ready")))
 
 /*Required alignment size for buffers*/
 #define LV_ATTRIBUTE_MEM_ALIGN_SIZE 1
@@ -378,7 +398,10 @@
 #define LV_FONT_FMT_TXT_LARGE 0
 
 /*Enables/disables support for compressed fonts.*/
+// Set to 1 by tools/fonts/subset_fonts.py for custom_font_compress = yes builds
+#ifndef LV_USE_FONT_COMPRESSED
 #define LV_USE_FONT_COMPRESSED 0
+#endif
 
 /*Enable subpixel rendering*/
 #define LV_USE_FONT_SUBPX 0
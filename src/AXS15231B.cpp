@@ -3,17 +3,59 @@
 #include "Arduino.h"
 #include "driver/spi_master.h"
 #include "esp_log.h"  // For ESP_LOGI, ESP_LOGD, ESP_LOGW
+#include "esp_timer.h"  // For bounce buffer latency statistics
 #include "debug_config.h"  // For LOG_*() macros with serialMutex protection
+#include "trace.h"         // Bounce fill / DMA window spans (GS_TRACE)
+#include "metrics.h"       // DMA window histogram
+#include "crash_ring.h"    // Flush completions in the post-mortem ring
+#include "watchdog.h"      // DMA window deadline ends at flush_ready
+#include "task_layout.h"   // Bounce task core / priority / stack
+#include "gpio_probe.h"    // DMA window on a probe pin (GS_GPIO_PROBE)
+#include "iram_placement.h" // DMA path in IRAM (GS_HOT_IRAM)
+#include "static_alloc.h"   // TE semaphore storage
 
 static volatile bool lcd_spi_dma_write = false;
 extern void my_print(const char *buf);
-uint32_t transfer_num = 0;
-size_t lcd_PushColors_len = 0;
+volatile uint32_t transfer_num = 0;
+volatile size_t lcd_PushColors_len = 0;
+static lv_disp_drv_t *flush_disp_drv = NULL;  // Driver released from spi_dma_cd when a window completes
+static TaskHandle_t flush_notify_task = NULL;  // Render task woken when a window completes
+
+#if LCD_BOUNCE_BUF_COUNT > 0
+// Bounce buffer pool - see lcd_bounce_task(). Transactions sent through the pool
+// carry BOUNCE_TRANS_TAG in .user so spi_dma_cd can tell them apart.
+#define BOUNCE_EVT_START (1UL << 0)  // lcd_PushColors handed over a new window
+#define BOUNCE_EVT_DONE  (1UL << 1)  // spi_dma_cd: a bounce transaction completed
+#define BOUNCE_TRANS_TAG ((void *)0xB0B0CE)
+
+typedef struct
+{
+    uint16_t *buf[LCD_BOUNCE_BUF_COUNT];
+    spi_transaction_ext_t trans[LCD_BOUNCE_BUF_COUNT];
+    uint16_t x, y, w, h;           // Native window handed over by lcd_PushColors
+    const uint16_t *src;           // Next PSRAM pixel to copy (rotate: landscape buffer base)
+    size_t remaining;              // Pixels not yet copied into a bounce buffer
+    bool rotate;                   // Source is a landscape buffer, rotate while copying
+    uint16_t src_w, src_h;         // Landscape source size (rotate only)
+    uint16_t row;                  // Next native row to emit (rotate only)
+    uint32_t in_flight;            // Bounce transactions queued and not yet reaped
+    bool first_send;
+    int64_t window_start_us;
+    lcd_bounce_stats_t stats;
+} lcd_bounce_pool_t;
+
+static lcd_bounce_pool_t bounce_pool;
+static TaskHandle_t bounce_task = NULL;
+static MetricHistogram lcdDmaWindowUs("lcd_dma_window_us", "First bounce chunk queued to last chunk done", METRIC_BUCKETS_US);
+#endif
 
 const static lcd_cmd_t axs15231b_qspi_init[] = {
     {0x28, {0x00}, 0x40},  // DISPOFF - Display OFF + 20ms delay
     // {0x10, {0x00}, 0x20},  // SLPIN - Removed: redundant after hardware reset, enables auto-sleep timer
     {0x11, {0x00}, 0x80},  // SLPOUT - Exit sleep mode + 200ms delay (triggers register loading)
+#if LCD_TE_PIN >= 0
+    {0x35, {0x00}, 0x01},  // TEON - TE output, V-blank only
+#endif
     {0x29, {0x00}, 0x00},  // DISPON - Display ON
 };
 
@@ -47,6 +89,9 @@ const static lcd_cmd_t axs15231b_qspi_init_new[] = {
     {0x28, {0x00}, 0x40},
     {0x10, {0x00}, 0x80},
     {0x11, {0x00}, 0x80},
+#if LCD_TE_PIN >= 0
+    {0x35, {0x00}, 0x01},
+#endif
     {0x29, {0x00}, 0x00}, 
 };
 
@@ -55,7 +100,47 @@ bool get_lcd_spi_dma_write(void)
     return lcd_spi_dma_write;
 }
 
+void lcd_attach_disp_drv(lv_disp_drv_t *drv)
+{
+    flush_disp_drv = drv;
+}
+
+void lcd_set_flush_notify_task(TaskHandle_t task)
+{
+    flush_notify_task = task;
+}
+
 static spi_device_handle_t spi;
+static spi_device_interface_config_t spi_devcfg;  // As added, for lcd_set_spi_clock()
+
+#if LCD_TE_PIN >= 0
+static SemaphoreHandle_t te_sem = NULL;  // Given on every TE rising edge
+static StaticBinarySemaphore te_sem_store;
+static MetricCounter lcdTeTimeouts("lcd_te_timeouts_total", "Windows sent without a TE edge (LCD_TE_TIMEOUT_MS)");
+static MetricHistogram lcdTeWaitUs("lcd_te_wait_us", "Window start held for the next TE edge", METRIC_BUCKETS_US);
+
+static void IRAM_ATTR lcd_te_isr()
+{
+    BaseType_t woken = pdFALSE;
+    xSemaphoreGiveFromISR(te_sem, &woken);
+    if (woken)
+        portYIELD_FROM_ISR();
+}
+#endif
+
+// Hold the start of a window until the panel's next V-blank (no-op without LCD_TE_PIN)
+static void lcd_te_wait(void)
+{
+#if LCD_TE_PIN >= 0
+    if (te_sem == NULL)
+        return;
+    int64_t start = esp_timer_get_time();
+    xSemaphoreTake(te_sem, 0);  // An edge from before this window says nothing about the scan now
+    if (xSemaphoreTake(te_sem, pdMS_TO_TICKS(LCD_TE_TIMEOUT_MS)) != pdTRUE)
+        lcdTeTimeouts.add();
+    lcdTeWaitUs.record((uint32_t)(esp_timer_get_time() - start));
+#endif
+}
 
 static void WriteComm(uint8_t data)
 {
@@ -89,19 +174,19 @@ static void lcd_send_cmd(uint32_t cmd, uint8_t *dat, uint32_t len)
     switch(cmd) {
         case 0x28:  // DISPOFF - Display OFF (part of sleep sequence)
             dispoff_count++;
-            LOG_ERROR("LCD_DMA", "🚨 DISPOFF (0x28) command #%lu - Display turning OFF!", dispoff_count);
+            LOG_ERROR(LOG_TAG_LCD_DMA, "🚨 DISPOFF (0x28) command #%lu - Display turning OFF!", dispoff_count);
             break;
         case 0x29:  // DISPON - Display ON (part of wake sequence)
             dispon_count++;
-            LOG_INFO("LCD_DMA", "✅ DISPON (0x29) command #%lu - Display turning ON", dispon_count);
+            LOG_INFO(LOG_TAG_LCD_DMA, "✅ DISPON (0x29) command #%lu - Display turning ON", dispon_count);
             break;
         case 0x10:  // SLPIN - Enter sleep mode (critical!)
             slpin_count++;
-            LOG_ERROR("LCD_DMA", "💤 SLPIN (0x10) command #%lu - Entering SLEEP mode!", slpin_count);
+            LOG_ERROR(LOG_TAG_LCD_DMA, "💤 SLPIN (0x10) command #%lu - Entering SLEEP mode!", slpin_count);
             break;
         case 0x11:  // SLPOUT - Exit sleep mode
             slpout_count++;
-            LOG_INFO("LCD_DMA", "🌟 SLPOUT (0x11) command #%lu - Exiting SLEEP mode", slpout_count);
+            LOG_INFO(LOG_TAG_LCD_DMA, "🌟 SLPOUT (0x11) command #%lu - Exiting SLEEP mode", slpout_count);
             break;
         // Don't log other commands (0x2A/0x2B/0x2C are pixel writes - too noisy)
     }
@@ -159,8 +244,40 @@ static void lcd_send_cmd(uint32_t cmd, uint8_t *dat, uint32_t len)
 #endif
 }
 
+// Window commands (CASET / RASET) queued ahead of a window's pixel chunks carry
+// LCD_CMD_TRANS_TAG: the SPI ISR sends them back to back with the pixels, and
+// spi_dma_pre / spi_dma_cd frame each one with CS as lcd_send_cmd() does.
+#define LCD_CMD_TRANS_TAG ((void *)0xC0DE2A)
+#define LCD_WINDOW_CMD_TRANS 2
+
+// A transaction with a command phase starts a CS frame: queued window commands
+// and the RAMWR chunk of a window (continuation chunks have none). Polling
+// commands pull CS low themselves, so the repeat is harmless for them.
+static void IRAM_ATTR spi_dma_pre(spi_transaction_t *trans)
+{
+    if (!(trans->flags & SPI_TRANS_VARIABLE_CMD))
+        TFT_CS_L;
+}
+
 static void IRAM_ATTR spi_dma_cd(spi_transaction_t *trans)
 {
+    if(trans->user == LCD_CMD_TRANS_TAG)
+    {
+        TFT_CS_H;  // Command done; the next transaction opens its own frame
+        return;
+    }
+#if LCD_BOUNCE_BUF_COUNT > 0
+    if(trans->user == BOUNCE_TRANS_TAG)
+    {
+        // Refill happens in lcd_bounce_task - PSRAM copies don't belong in an ISR
+        BaseType_t woken = pdFALSE;
+        xTaskNotifyFromISR(bounce_task, BOUNCE_EVT_DONE, eSetBits, &woken);
+        if(woken)
+            portYIELD_FROM_ISR();
+        return;
+    }
+#endif
+
     if(transfer_num > 0)
     {
         transfer_num--;
@@ -170,16 +287,52 @@ static void IRAM_ATTR spi_dma_cd(spi_transaction_t *trans)
     {
         if(lcd_spi_dma_write) {
             lcd_spi_dma_write = false;
-            lv_disp_t * disp = _lv_refr_get_disp_refreshing();
-            if(disp != NULL)
-                lv_disp_flush_ready(disp->driver);
+            // The refresh may already have returned (double buffering), so use the
+            // attached driver rather than _lv_refr_get_disp_refreshing()
+            if(flush_disp_drv != NULL)
+                lv_disp_flush_ready(flush_disp_drv);
+            crashRingRecord(CRASH_EV_FLUSH_END);
+            watchdogIdle(WATCHDOG_DMA);
+            GS_PROBE_SET(PROBE_DMA, false);
 
             TFT_CS_H;
+
+            if(flush_notify_task != NULL) {
+                BaseType_t woken = pdFALSE;
+                vTaskNotifyGiveFromISR(flush_notify_task, &woken);
+                if(woken)
+                    portYIELD_FROM_ISR();
+            }
         }
     }
 }
 
 
+static spi_transaction_t window_cmd_trans[LCD_WINDOW_CMD_TRANS];
+
+// Queue CASET / RASET for a window instead of two polling transmits. The
+// results are collected with the pixel chunks' (tag skipped).
+static void GS_HOT_IRAM lcd_queue_window(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2)
+{
+    const uint8_t cmd[LCD_WINDOW_CMD_TRANS] = {0x2a, 0x2b};
+    const uint16_t from[LCD_WINDOW_CMD_TRANS] = {x1, y1};
+    const uint16_t to[LCD_WINDOW_CMD_TRANS] = {x2, y2};
+    for (uint32_t i = 0; i < LCD_WINDOW_CMD_TRANS; i++) {
+        spi_transaction_t *t = &window_cmd_trans[i];
+        memset(t, 0, sizeof(*t));
+        t->flags = SPI_TRANS_MULTILINE_CMD | SPI_TRANS_MULTILINE_ADDR | SPI_TRANS_USE_TXDATA;
+        t->cmd = 0x02;
+        t->addr = (uint32_t)cmd[i] << 8;
+        t->tx_data[0] = (uint8_t)(from[i] >> 8);
+        t->tx_data[1] = (uint8_t)from[i];
+        t->tx_data[2] = (uint8_t)(to[i] >> 8);
+        t->tx_data[3] = (uint8_t)to[i];
+        t->length = 32;
+        t->user = LCD_CMD_TRANS_TAG;
+        ESP_ERROR_CHECK(spi_device_queue_trans(spi, t, portMAX_DELAY));
+    }
+}
+
 void lcd_send_data8(uint8_t dat) {
 	unsigned char i;
 	for (i = 0; i < 8; i++) {
@@ -194,6 +347,208 @@ void lcd_send_data8(uint8_t dat) {
 	}
 }
 
+// Emit native rows [row, row + rows) of a landscape (LVGL rotation 270 layout)
+// src_w x src_h buffer. Native row r is landscape column r read bottom-to-top.
+static void GS_HOT_IRAM lcd_rotate270_rows(uint16_t *dst, const uint16_t *src, uint16_t src_w, uint16_t src_h,
+                               uint16_t row, uint16_t rows)
+{
+    for (uint16_t r = row; r < row + rows; r++) {
+        const uint16_t *col = src + (size_t)(src_h - 1) * src_w + r;
+        for (uint16_t c = 0; c < src_h; c++) {
+            *dst++ = *col;
+            col -= src_w;
+        }
+    }
+}
+
+#if LCD_BOUNCE_BUF_COUNT > 0
+// Copy the next chunk of the window into bounce buffer idx and queue it
+static void GS_HOT_IRAM bounce_fill_and_queue(uint32_t idx)
+{
+    lcd_bounce_pool_t *bp = &bounce_pool;
+    size_t chunk_size = bp->remaining;
+    if (chunk_size > LCD_BOUNCE_BUF_PIXELS) {
+        chunk_size = LCD_BOUNCE_BUF_PIXELS;
+    }
+
+    int64_t fill_start = esp_timer_get_time();
+    if (bp->rotate) {
+        // Native row r is landscape column r read bottom-to-top. Whole rows only,
+        // and neighbouring columns share cache lines, so PSRAM reads stay cached.
+        uint16_t rows = (uint16_t)(LCD_BOUNCE_BUF_PIXELS / bp->w);
+        if (rows > bp->h - bp->row) {
+            rows = bp->h - bp->row;
+        }
+        chunk_size = (size_t)rows * bp->w;
+        lcd_rotate270_rows(bp->buf[idx], bp->src, bp->src_w, bp->src_h, bp->row, rows);
+        bp->row += rows;
+    } else {
+        memcpy(bp->buf[idx], bp->src, chunk_size * sizeof(uint16_t));
+        bp->src += chunk_size;
+    }
+    uint32_t fill_us = (uint32_t)(esp_timer_get_time() - fill_start);
+    GS_TRACE_SPAN("bounce_fill", (uint32_t)fill_start, fill_us);
+
+    bp->stats.fills++;
+    bp->stats.bytes += chunk_size * sizeof(uint16_t);
+    bp->stats.fill_us_total += fill_us;
+    if (fill_us > bp->stats.fill_us_max) {
+        bp->stats.fill_us_max = fill_us;
+    }
+
+    spi_transaction_ext_t *t = &bp->trans[idx];
+    memset(t, 0, sizeof(*t));
+    if (bp->first_send) {
+        t->base.flags = SPI_TRANS_MODE_QIO;
+        t->base.cmd = 0x32;
+        t->base.addr = 0x002C00;
+        bp->first_send = false;
+    } else {
+        t->base.flags = SPI_TRANS_MODE_QIO | SPI_TRANS_VARIABLE_CMD |
+                        SPI_TRANS_VARIABLE_ADDR | SPI_TRANS_VARIABLE_DUMMY;
+        t->command_bits = 0;
+        t->address_bits = 0;
+        t->dummy_bits = 0;
+    }
+    t->base.tx_buffer = bp->buf[idx];
+    t->base.length = chunk_size * 16;
+    t->base.user = BOUNCE_TRANS_TAG;
+
+    bp->remaining -= chunk_size;
+    lcd_PushColors_len = bp->remaining;
+    bp->in_flight++;
+    transfer_num = bp->in_flight;
+
+    ESP_ERROR_CHECK(spi_device_queue_trans(spi, (spi_transaction_t *)t, portMAX_DELAY));
+}
+
+// Owns the SPI queue while a window streams through the bounce pool: starts the
+// window, then refills each buffer as soon as its transaction completes so the
+// next chunk is ready before the one on the wire finishes.
+static void lcd_bounce_task(void *arg)
+{
+    lcd_bounce_pool_t *bp = &bounce_pool;
+
+    for (;;) {
+        uint32_t events = 0;
+        xTaskNotifyWait(0, UINT32_MAX, &events, portMAX_DELAY);
+
+        if (events & BOUNCE_EVT_START) {
+            lcd_te_wait();
+            lcd_queue_window(bp->x, bp->y, bp->x + bp->w - 1, bp->y + bp->h - 1);
+            for (uint32_t i = 0; i < LCD_BOUNCE_BUF_COUNT && bp->remaining > 0; i++) {
+                bounce_fill_and_queue(i);
+            }
+        }
+
+        if (events & BOUNCE_EVT_DONE) {
+            // Several completions may have coalesced into one notification
+            spi_transaction_t *rtrans;
+            while (bp->in_flight > 0 && spi_device_get_trans_result(spi, &rtrans, 0) == ESP_OK) {
+                if (rtrans->user == LCD_CMD_TRANS_TAG) {
+                    continue;  // This window's CASET / RASET, done before its pixels
+                }
+                bp->in_flight--;
+                transfer_num = bp->in_flight;
+
+                if (bp->remaining > 0) {
+                    if (bp->in_flight == 0) {
+                        bp->stats.starved++;  // Bus sat idle waiting for this refill
+                    }
+                    uint32_t idx = (uint32_t)(((spi_transaction_ext_t *)rtrans) - bp->trans);
+                    bounce_fill_and_queue(idx);
+                } else if (bp->in_flight == 0) {
+                    TFT_CS_H;
+                    uint32_t window_us = (uint32_t)(esp_timer_get_time() - bp->window_start_us);
+                    GS_TRACE_SPAN("dma_window", (uint32_t)bp->window_start_us, window_us);
+                    lcdDmaWindowUs.record(window_us);
+                    bp->stats.window_us_last = window_us;
+                    if (window_us > bp->stats.window_us_max) {
+                        bp->stats.window_us_max = window_us;
+                    }
+                    lcd_spi_dma_write = false;
+                    if (flush_disp_drv != NULL)
+                        lv_disp_flush_ready(flush_disp_drv);
+                    crashRingRecord(CRASH_EV_FLUSH_END);
+                    watchdogIdle(WATCHDOG_DMA);
+                    GS_PROBE_SET(PROBE_DMA, false);
+                    if (flush_notify_task != NULL)
+                        xTaskNotifyGive(flush_notify_task);
+                }
+            }
+        }
+    }
+}
+
+// Hand a native window to lcd_bounce_task; it owns the SPI queue until the
+// last chunk is out and then calls lv_disp_flush_ready()
+static void GS_HOT_IRAM bounce_start(uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint16_t *data,
+                         bool rotate, uint16_t src_w, uint16_t src_h)
+{
+    lcd_bounce_pool_t *bp = &bounce_pool;
+    bp->x = x;
+    bp->y = y;
+    bp->w = w;
+    bp->h = h;
+    bp->src = data;
+    bp->remaining = (size_t)w * h;
+    bp->rotate = rotate;
+    bp->src_w = src_w;
+    bp->src_h = src_h;
+    bp->row = 0;
+    bp->first_send = true;
+    bp->window_start_us = esp_timer_get_time();
+    bp->stats.windows++;
+    lcd_PushColors_len = bp->remaining;
+    lcd_spi_dma_write = true;
+    GS_PROBE_SET(PROBE_DMA, true);
+    xTaskNotify(bounce_task, BOUNCE_EVT_START, eSetBits);
+}
+
+static void lcd_bounce_init(void)
+{
+    lcd_bounce_pool_t *bp = &bounce_pool;
+    memset(bp, 0, sizeof(*bp));
+
+    for (uint32_t i = 0; i < LCD_BOUNCE_BUF_COUNT; i++) {
+        bp->buf[i] = (uint16_t *)heap_caps_malloc(LCD_BOUNCE_BUF_PIXELS * sizeof(uint16_t),
+                                                  MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+        if (bp->buf[i] == NULL) {
+            LOG_ERROR(LOG_TAG_LCD_DMA, "❌ Bounce buffer %lu allocation failed - streaming from PSRAM", i);
+            for (uint32_t j = 0; j < i; j++) {
+                heap_caps_free(bp->buf[j]);
+                bp->buf[j] = NULL;
+            }
+            return;
+        }
+    }
+
+    // Same core as the SPI ISR and LVGL, above the UI task so refills pre-empt rendering (task_layout.cpp)
+    if (taskLayoutSpawn(TASK_ROLE_LCD_BOUNCE, lcd_bounce_task, NULL, &bounce_task) != pdPASS) {
+        LOG_ERROR(LOG_TAG_LCD_DMA, "❌ Bounce task creation failed - streaming from PSRAM");
+        for (uint32_t i = 0; i < LCD_BOUNCE_BUF_COUNT; i++) {
+            heap_caps_free(bp->buf[i]);
+            bp->buf[i] = NULL;
+        }
+        bounce_task = NULL;
+        return;
+    }
+
+    bp->stats.active = true;
+    LOG_INFO(LOG_TAG_LCD_DMA, "✅ Bounce buffers: %d x %d px in internal SRAM",
+             LCD_BOUNCE_BUF_COUNT, LCD_BOUNCE_BUF_PIXELS);
+}
+#endif
+
+void lcd_get_bounce_stats(lcd_bounce_stats_t *out)
+{
+#if LCD_BOUNCE_BUF_COUNT > 0
+    *out = bounce_pool.stats;
+#else
+    memset(out, 0, sizeof(*out));
+#endif
+}
+
 void axs15231_init(void)
 {
     pinMode(TFT_QSPI_CS, OUTPUT);
@@ -228,13 +583,24 @@ void axs15231_init(void)
         .spics_io_num = -1,
         // .spics_io_num = TFT_QSPI_CS,
         .flags = SPI_DEVICE_HALFDUPLEX,
-        .queue_size = 17,
+        .queue_size = LCD_SPI_QUEUE_SIZE,
+        .pre_cb = spi_dma_pre,
         .post_cb = spi_dma_cd,
     };
     ret = spi_bus_initialize(TFT_SPI_HOST, &buscfg, SPI_DMA_CH_AUTO);
     ESP_ERROR_CHECK(ret);
     ret = spi_bus_add_device(TFT_SPI_HOST, &devcfg, &spi);
     ESP_ERROR_CHECK(ret);
+    spi_devcfg = devcfg;
+#if LCD_BOUNCE_BUF_COUNT > 0
+    lcd_bounce_init();
+#endif
+#if LCD_TE_PIN >= 0
+    te_sem = te_sem_store.create();
+    pinMode(LCD_TE_PIN, INPUT);
+    attachInterrupt(digitalPinToInterrupt(LCD_TE_PIN), lcd_te_isr, RISING);
+    LOG_INFO(LOG_TAG_LCD_DMA, "✅ Tearing effect sync on GPIO%d", LCD_TE_PIN);
+#endif
 
 #else
     SPI.begin(TFT_SCK, -1, TFT_MOSI, TFT_CS);
@@ -297,6 +663,30 @@ void lcd_address_set(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2)
     }
 }
 
+void lcd_round_window(uint16_t *x1, uint16_t *y1, uint16_t *x2, uint16_t *y2)
+{
+    *x1 &= ~(uint16_t)(LCD_COL_ALIGN - 1);
+    *x2 |= (uint16_t)(LCD_COL_ALIGN - 1);
+    if (*x2 >= EXAMPLE_LCD_H_RES)
+        *x2 = EXAMPLE_LCD_H_RES - 1;
+
+#if LCD_ROW_FULL_SPAN
+    *y1 = 0;
+    *y2 = EXAMPLE_LCD_V_RES - 1;
+#else
+    *y1 &= ~(uint16_t)(LCD_ROW_ALIGN - 1);
+    *y2 |= (uint16_t)(LCD_ROW_ALIGN - 1);
+    if (*y2 >= EXAMPLE_LCD_V_RES)
+        *y2 = EXAMPLE_LCD_V_RES - 1;
+#endif
+}
+
+// Per-window diagnostics are counters only: nothing in the submission path logs,
+// allocates or walks the heap (the bounce buffers are the transport's whole budget)
+static MetricCounter lcdPushSkipped("lcd_push_skipped_total", "Pushes dropped: no data, zero size or no fill buffer");
+static MetricCounter lcdMisaligned("lcd_misaligned_windows_total", "Windows that escaped the rounder (would smear)");
+static MetricCounter lcdDmaChunks("lcd_dma_chunks_total", "Descriptors queued straight from the draw buffer");
+
 void lcd_fill(uint16_t xsta,
               uint16_t ysta,
               uint16_t xend,
@@ -307,6 +697,10 @@ void lcd_fill(uint16_t xsta,
     uint16_t w = xend - xsta;
     uint16_t h = yend - ysta;
     uint16_t *color_p = (uint16_t *)heap_caps_malloc(w * h * 2, MALLOC_CAP_INTERNAL);
+    if (color_p == NULL) {
+        lcdPushSkipped.add();
+        return;
+    }
     int i = 0;
     for(i = 0; i < w * h ; i+=1)
     {
@@ -329,102 +723,112 @@ void spi_device_queue_trans_fun(spi_device_handle_t handle, spi_transaction_t *t
 }
 
 #ifdef LCD_SPI_DMA 
-spi_transaction_ext_t t = {0};
-void lcd_PushColors(uint16_t x,
+// One descriptor per chunk: the SPI driver keeps a pointer to every queued
+// descriptor until it has been sent, so a whole window is queued up front
+// without reusing a descriptor that is still in flight.
+#define LCD_DMA_MAX_TRANS ((LVGL_LCD_BUF_SIZE + SEND_BUF_SIZE - 1) / SEND_BUF_SIZE)
+static_assert(LCD_DMA_MAX_TRANS + LCD_WINDOW_CMD_TRANS <= LCD_SPI_QUEUE_SIZE,
+              "a full frame of chunks and its window commands must fit the SPI queue");
+static_assert(LCD_BOUNCE_BUF_COUNT + LCD_WINDOW_CMD_TRANS <= LCD_SPI_QUEUE_SIZE,
+              "every bounce buffer and the window commands must be queueable");
+static spi_transaction_ext_t trans_pool[LCD_DMA_MAX_TRANS];
+static uint32_t trans_unreaped = 0;  // Queued descriptors whose result was not collected yet
+
+// Collect results of the previous window before touching the bus again.
+// LVGL only calls flush_cb after lv_disp_flush_ready() (issued from
+// spi_dma_cd once the last chunk is out), so these are already complete.
+static void GS_HOT_IRAM lcd_reap_window(void)
+{
+    while (trans_unreaped > 0) {
+        spi_transaction_t *rtrans;
+        esp_err_t ret = spi_device_get_trans_result(spi, &rtrans, portMAX_DELAY);
+        assert(ret == ESP_OK);
+        trans_unreaped--;
+    }
+}
+
+void GS_HOT_IRAM lcd_PushColors(uint16_t x,
                         uint16_t y,
                         uint16_t width,
                         uint16_t high,
                         uint16_t *data)
     {
-        // DIAGNOSTIC: Track every call to lcd_PushColors (DMA version)
-        static uint32_t dma_push_count = 0;
-        dma_push_count++;
-
-        static bool first_send = 1;
-        static uint16_t *p = (uint16_t *)data;
-        static uint32_t transfer_num_old = 0;
-
-        if(data != NULL && (width != 0) && (high != 0))
+        if(data == NULL || (width == 0) || (high == 0))
         {
-            // DIAGNOSTIC: Log only first 10 DMA pushes for initial debugging
-            // (Disabled to reduce log spam - uncomment if debugging display issues)
-            // LOG_DEBUG("LCD_DMA", "🖼️  Push #%lu: (%d,%d) %dx%d = %d pixels",
-            //          dma_push_count, x, y, width, high, width*high);
-            if (dma_push_count <= 10) {  // Only log pixel data for first 10 pushes
-                LOG_DEBUG("LCD_DMA", "   First 4 pixels: [0]=0x%04X [1]=0x%04X [2]=0x%04X [3]=0x%04X",
-                          data[0], data[1], data[2], data[3]);
-            }
-
-            lcd_PushColors_len = width * high;
-            p = (uint16_t *)data;
-            first_send = 1;
-
-            transfer_num = 0;
-            lcd_address_set(x, y, x + width - 1, y + high - 1);
-            TFT_CS_L;
-        }
-        else
-        {
-            // DIAGNOSTIC: Log NULL or invalid calls
-            ESP_LOGW("LCD_DMA", "⚠️  Push #%lu SKIPPED: data=%p, w=%d, h=%d",
-                     dma_push_count, data, width, high);
+            lcdPushSkipped.add();
             return;  // Don't process invalid calls
         }
 
-        for (int x = 0; x < (transfer_num_old - (transfer_num_old-(transfer_num_old-transfer_num))); x++) {
-            spi_transaction_t *rtrans;
-            esp_err_t ret = spi_device_get_trans_result(spi, &rtrans, portMAX_DELAY);
-            if (ret != ESP_OK) {
-            // ESP_LOGW(TAG, "1. transfer_num = %d", transfer_num_old);
+        // Partial refresh: a window that escaped the rounder would be written
+        // at the wrong RAM position and smear ("metrics"; the first one is logged)
+        if ((x % LCD_COL_ALIGN) != 0 || (width % LCD_COL_ALIGN) != 0
+#if LCD_ROW_FULL_SPAN
+            || y != 0 || high != EXAMPLE_LCD_V_RES
+#endif
+        ) {
+            if (lcdMisaligned.value() == 0) {
+                LOG_WARN(LOG_TAG_LCD_DMA, "⚠️  Misaligned window: (%d,%d) %dx%d", x, y, width, high);
             }
-            assert(ret == ESP_OK);
+            lcdMisaligned.add();
+        }
+
+#if LCD_BOUNCE_BUF_COUNT > 0
+        if (bounce_task != NULL) {
+            bounce_start(x, y, width, high, data, false, 0, 0);
+            return;
         }
-        transfer_num_old -= (transfer_num_old - (transfer_num_old-(transfer_num_old-transfer_num)));
+#endif
+
+        lcd_reap_window();
+
+        uint16_t *p = (uint16_t *)data;
+        bool first_send = 1;
+        uint32_t trans_idx = 0;
 
+        lcd_PushColors_len = width * high;
+        transfer_num = 0;
+        lcd_te_wait();
+        lcd_queue_window(x, y, x + width - 1, y + high - 1);
+        trans_unreaped += LCD_WINDOW_CMD_TRANS;
+
+        // Queue the whole window and return - the transfer runs in the background
+        // while LVGL renders the next area into the other draw buffer
+        lcd_spi_dma_write = true;
+        GS_PROBE_SET(PROBE_DMA, true);
         do {
-            if(transfer_num >= 3 || ESP.getFreeHeap() <= 70000)
-            {
-                break;
-            }
             size_t chunk_size = lcd_PushColors_len;
+            spi_transaction_ext_t *t = &trans_pool[trans_idx++];
 
-            memset(&t, 0, sizeof(t));
+            memset(t, 0, sizeof(*t));
             if (first_send) {
-                t.base.flags =
+                t->base.flags =
                     SPI_TRANS_MODE_QIO ;// | SPI_TRANS_MODE_DIOQIO_ADDR 
-                t.base.cmd = 0x32 ;// 0x12 
-                t.base.addr = 0x002C00;
+                t->base.cmd = 0x32 ;// 0x12 
+                t->base.addr = 0x002C00;
                 first_send = 0;
             } else {
-                t.base.flags = SPI_TRANS_MODE_QIO | SPI_TRANS_VARIABLE_CMD |
+                t->base.flags = SPI_TRANS_MODE_QIO | SPI_TRANS_VARIABLE_CMD |
                             SPI_TRANS_VARIABLE_ADDR | SPI_TRANS_VARIABLE_DUMMY;
-                t.command_bits = 0;
-                t.address_bits = 0;
-                t.dummy_bits = 0;
+                t->command_bits = 0;
+                t->address_bits = 0;
+                t->dummy_bits = 0;
             }
             if (chunk_size > SEND_BUF_SIZE) {
                 chunk_size = SEND_BUF_SIZE;
             }
-            t.base.tx_buffer = p;
-            t.base.length = chunk_size * 16;
-
-            lcd_spi_dma_write = true;
+            t->base.tx_buffer = p;
+            t->base.length = chunk_size * 16;
 
+            // Order matters: spi_dma_cd signals completion when both reach zero
             transfer_num++;
-            transfer_num_old++;
+            trans_unreaped++;
             lcd_PushColors_len -= chunk_size;
+            lcdDmaChunks.add();
 
-            // DIAGNOSTIC: Log DMA transaction queuing
-            ESP_LOGD("LCD_DMA", "   DMA transaction #%lu: chunk=%zu pixels, remaining=%lu",
-                     (uint32_t)transfer_num, chunk_size, (uint32_t)lcd_PushColors_len);
-
-            esp_err_t ret;
-
-            ESP_ERROR_CHECK(spi_device_queue_trans(spi, (spi_transaction_t *)&t, portMAX_DELAY));
-            assert(ret == ESP_OK);
+            ESP_ERROR_CHECK(spi_device_queue_trans(spi, (spi_transaction_t *)t, portMAX_DELAY));
 
             p += chunk_size;
-        } while (lcd_PushColors_len > 0);
+        } while (lcd_PushColors_len > 0 && trans_idx < LCD_DMA_MAX_TRANS);
     }
 #if 0
     void lcd_PushColors(uint16_t x,
@@ -491,16 +895,9 @@ void lcd_PushColors(uint16_t x,
                         uint16_t high,
                         uint16_t *data)
     {
-        // DIAGNOSTIC: Log EVERY lcd_PushColors call with full details
-        static uint32_t pushCallCount = 0;
-        pushCallCount++;
-
-        if (data != NULL && width > 0 && high > 0) {
-            ESP_LOGI("LCD", "PushColors #%lu: (%d,%d) %dx%d = %d pixels, first_pixel=0x%04X",
-                     pushCallCount, x, y, width, high, width*high, data[0]);
-        } else {
-            ESP_LOGI("LCD", "PushColors #%lu: NULL or zero size (x=%d,y=%d,w=%d,h=%d,data=%p)",
-                     pushCallCount, x, y, width, high, data);
+        if (data == NULL || width == 0 || high == 0) {
+            lcdPushSkipped.add();
+            return;
         }
 
     #if LCD_USB_QSPI_DREVER == 1
@@ -508,7 +905,6 @@ void lcd_PushColors(uint16_t x,
         size_t len = width * high;
         uint16_t *p = (uint16_t *)data;
 
-        ESP_LOGD("LCD", "  Setting display window: (%d,%d)-(%d,%d)", x, y, x+width-1, y+high-1);
         lcd_address_set(x, y, x + width - 1, y + high - 1);
         
         do {
@@ -618,31 +1014,177 @@ void lcd_PushColors(uint16_t *data, uint32_t len)
 #endif
 }
 
+void GS_HOT_IRAM lcd_PushColorsLandscape(uint16_t x,
+                                        uint16_t y,
+                                        uint16_t width,
+                                        uint16_t high,
+                                        uint16_t *data)
+{
+    // Landscape (x, y) maps to native (H_RES - 1 - y, x)
+    uint16_t nx = EXAMPLE_LCD_H_RES - y - high;
+    uint16_t ny = x;
+
+#if LCD_BOUNCE_BUF_COUNT > 0
+    if (bounce_task != NULL) {
+        bounce_start(nx, ny, high, width, data, true, width, high);
+        return;
+    }
+#endif
+
+    // No bounce pool: rotate into a PSRAM scratch frame, then stream that
+    static uint16_t *rotate_scratch = NULL;
+    if (rotate_scratch == NULL) {
+        rotate_scratch = (uint16_t *)ps_malloc(LVGL_LCD_BUF_SIZE * sizeof(uint16_t));
+        if (rotate_scratch == NULL) {
+            LOG_ERROR(LOG_TAG_LCD_DMA, "❌ Rotation scratch allocation failed - dropping frame");
+            if (flush_disp_drv != NULL)
+                lv_disp_flush_ready(flush_disp_drv);
+            watchdogIdle(WATCHDOG_DMA);
+            return;
+        }
+    }
+    lcd_rotate270_rows(rotate_scratch, data, width, high, 0, width);
+    lcd_PushColors(nx, ny, high, width, rotate_scratch);
+}
+
+void lcd_PushColorsLandscapeSync(uint16_t x,
+                                 uint16_t y,
+                                 uint16_t width,
+                                 uint16_t high,
+                                 const uint16_t *data)
+{
+#if LCD_USB_QSPI_DREVER == 1
+    // One SEND_BUF_SIZE chunk of rotated native rows, reused for every window
+    static uint16_t *rows_buf = NULL;
+    if (rows_buf == NULL) {
+        rows_buf = (uint16_t *)heap_caps_malloc(SEND_BUF_SIZE * sizeof(uint16_t),
+                                                 MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+    }
+    if (data == NULL || width == 0 || high == 0 || rows_buf == NULL) {
+        lcdPushSkipped.add();
+        return;
+    }
+
+    // Native window: `high` columns, `width` rows (see lcd_PushColorsLandscape)
+    uint16_t nx = EXAMPLE_LCD_H_RES - y - high;
+    uint16_t ny = x;
+    uint16_t rows_per_chunk = (uint16_t)(SEND_BUF_SIZE / high);
+    bool first_send = true;
+
+#ifdef LCD_SPI_DMA
+    lcd_reap_window();
+#endif
+    lcd_te_wait();
+    lcd_address_set(nx, ny, nx + high - 1, ny + width - 1);
+    TFT_CS_L;
+    for (uint16_t row = 0; row < width; row += rows_per_chunk) {
+        uint16_t rows = (width - row < rows_per_chunk) ? (uint16_t)(width - row) : rows_per_chunk;
+        lcd_rotate270_rows(rows_buf, data, width, high, row, rows);
+
+        spi_transaction_ext_t t;
+        memset(&t, 0, sizeof(t));
+        if (first_send) {
+            t.base.flags = SPI_TRANS_MODE_QIO;
+            t.base.cmd = 0x32;
+            t.base.addr = 0x002C00;
+            first_send = false;
+        } else {
+            t.base.flags = SPI_TRANS_MODE_QIO | SPI_TRANS_VARIABLE_CMD |
+                           SPI_TRANS_VARIABLE_ADDR | SPI_TRANS_VARIABLE_DUMMY;
+            t.command_bits = 0;
+            t.address_bits = 0;
+            t.dummy_bits = 0;
+        }
+        t.base.tx_buffer = rows_buf;
+        t.base.length = (size_t)rows * high * 16;
+        spi_device_polling_transmit(spi, (spi_transaction_t *)&t);
+    }
+    TFT_CS_H;
+#else
+    (void)x;
+    (void)y;
+    (void)width;
+    (void)high;
+    (void)data;
+#endif
+}
+
+uint32_t lcd_get_spi_clock(void)
+{
+    return (uint32_t)spi_devcfg.clock_speed_hz;
+}
+
+bool lcd_set_spi_clock(uint32_t hz)
+{
+#if LCD_USB_QSPI_DREVER == 1
+    if (spi == NULL || lcd_spi_dma_write)
+        return false;
+#ifdef LCD_SPI_DMA
+    lcd_reap_window();  // The driver refuses to remove a device with results pending
+#endif
+    spi_device_interface_config_t cfg = spi_devcfg;
+    cfg.clock_speed_hz = (int)hz;
+    if (spi_bus_remove_device(spi) != ESP_OK)
+        return false;
+    if (spi_bus_add_device(TFT_SPI_HOST, &cfg, &spi) != ESP_OK) {
+        ESP_ERROR_CHECK(spi_bus_add_device(TFT_SPI_HOST, &spi_devcfg, &spi));
+        return false;
+    }
+    spi_devcfg = cfg;
+    return true;
+#else
+    (void)hz;
+    return false;
+#endif
+}
+
+bool lcd_read_cmd(uint8_t cmd, uint8_t *out, size_t len)
+{
+#if LCD_USB_QSPI_DREVER == 1
+    if (spi == NULL || lcd_spi_dma_write || len > 4)
+        return false;
+    spi_transaction_t t;
+    memset(&t, 0, sizeof(t));
+    t.flags = SPI_TRANS_USE_RXDATA;
+    t.cmd = LCD_QSPI_READ_CMD;
+    t.addr = (uint32_t)cmd << 8;
+    t.rxlength = 8 * len;
+    TFT_CS_L;
+    esp_err_t err = spi_device_polling_transmit(spi, &t);
+    TFT_CS_H;
+    memcpy(out, t.rx_data, len);
+    return err == ESP_OK;
+#else
+    (void)cmd;
+    (void)out;
+    (void)len;
+    return false;
+#endif
+}
+
 void lcd_sleep()
 {
-    // DIAGNOSTIC: Log function entry - this should NEVER be called in production!
-    // Display sleep is commented out in main loop, so if this appears, something is wrong!
-    LOG_ERROR("LCD_DMA", "⚠️⚠️⚠️ lcd_sleep() FUNCTION CALLED! ⚠️⚠️⚠️");
-    LOG_ERROR("LCD_DMA", "   This function should NOT be called (sleep is disabled)!");
-    LOG_ERROR("LCD_DMA", "   Check for rogue code calling lcd_sleep()");
+    // Called by the display power state machine (display_power.h) once the
+    // backlight is off and LVGL has been paused - no DMA window is in flight
+    LOG_INFO(LOG_TAG_LCD_DMA, "💤 lcd_sleep() - panel entering sleep mode");
 
     lcd_send_cmd(0x28, NULL, 0);  // DISPOFF - Turn display OFF first
     delay(20);   // Wait for display off command to complete
     lcd_send_cmd(0x10, NULL, 0);  // SLPIN - Enter sleep mode
     delay(120);  // Required delay after sleep in (per datasheet)
 
-    LOG_ERROR("LCD_DMA", "💤 Display is now in SLEEP mode");
+    LOG_INFO(LOG_TAG_LCD_DMA, "💤 Display is now in SLEEP mode");
 }
 
 void lcd_wake()
 {
     // DIAGNOSTIC: Log wake sequence
-    LOG_INFO("LCD_DMA", "🌟 lcd_wake() FUNCTION CALLED - Waking display");
+    LOG_INFO(LOG_TAG_LCD_DMA, "🌟 lcd_wake() FUNCTION CALLED - Waking display");
 
     lcd_send_cmd(0x11, NULL, 0);  // SLPOUT - Exit sleep mode
     delay(120);  // Required delay after sleep out (per datasheet)
     lcd_send_cmd(0x29, NULL, 0);  // DISPON - Turn display ON
     delay(10);   // Small delay for display to stabilize
 
-    LOG_INFO("LCD_DMA", "✅ Display wake sequence complete");
-}
\ No newline at end of file
+    LOG_INFO(LOG_TAG_LCD_DMA, "✅ Display wake sequence complete");
+}
\ No newline at end of file
@@ -3,6 +3,8 @@
 #include "stdint.h"
 #include "pins_config.h"
 #include "lvgl.h"/* https://github.com/lvgl/lvgl.git */
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"  // TaskHandle_t for lcd_set_flush_notify_task()
 
 #define LCD_SPI_DMA 
 #define AX15231B
@@ -31,6 +33,66 @@
 #define TFT_CS_H digitalWrite(TFT_QSPI_CS, 1);
 #define TFT_CS_L digitalWrite(TFT_QSPI_CS, 0);
 
+// RAM write window granularity (native 180x640 orientation).
+// CASET is honoured by the controller, so a window may start on any even
+// column and span an even number of columns. RASET is not reliably honoured
+// by RAMWR over QSPI (this is what smeared partial refreshes), so windows
+// are widened to cover every row while LCD_ROW_FULL_SPAN is set.
+// Vertical scrolling (VSCRDEF 0x33 / VSCSAD 0x37) moves whole native rows,
+// i.e. landscape columns over the full screen height, so it cannot scroll a
+// region that is not full height (see shot_chart.h).
+#define LCD_COL_ALIGN 2
+#define LCD_ROW_ALIGN 2
+#define LCD_ROW_FULL_SPAN 1
+
+// SPI device transaction queue. A window opens with its CASET / RASET queued
+// as two transactions ahead of the pixels, so setting it never waits on the
+// bus. Without bounce buffers the window is then queued whole, one descriptor
+// per SEND_BUF_SIZE chunk (a full frame is 8), and completes with no CPU
+// involvement - the queue must hold all of them.
+#define LCD_SPI_QUEUE_SIZE 17
+
+// Tearing effect sync. With the controller's TE output wired to a GPIO,
+// TEON (0x35, V-blank only) goes out with the init table and every window
+// waits for the next TE rising edge before RAMWR starts: a full frame is on
+// the wire in less than one scan, so the write stays behind the scan line.
+// The bounce task does the waiting; without bounce buffers flush_cb blocks.
+// No edge within LCD_TE_TIMEOUT_MS (pin not wired, panel asleep) sends
+// anyway. -1 (default): the T-Display-S3 Long routes no TE line to the
+// ESP32, so boards with one set -DLCD_TE_PIN=<gpio>.
+#ifndef LCD_TE_PIN
+#define LCD_TE_PIN -1
+#endif
+#define LCD_TE_TIMEOUT_MS 20  // > one 60 Hz scan
+
+// Register reads (lcd_read_cmd): single-line QSPI read instruction, the
+// register in the address phase as for writes, data on D1
+#define LCD_QSPI_READ_CMD 0x03
+
+// Internal-SRAM DMA bounce buffers. LVGL draw buffers live in PSRAM; instead of
+// letting the SPI DMA fetch pixels from PSRAM, each chunk is first copied (CPU
+// memcpy) into one of these DMA-capable internal buffers while the previous one
+// is on the wire. Set LCD_BOUNCE_BUF_COUNT to 0 to stream straight from PSRAM.
+#ifndef LCD_BOUNCE_BUF_COUNT
+#define LCD_BOUNCE_BUF_COUNT 2
+#endif
+#ifndef LCD_BOUNCE_BUF_PIXELS
+#define LCD_BOUNCE_BUF_PIXELS (SEND_BUF_SIZE / 2)  // 7200 px = 14.4 KB each
+#endif
+
+typedef struct
+{
+    bool active;              // false: pool allocation failed, streaming from PSRAM
+    uint32_t windows;         // Windows streamed through the pool
+    uint32_t fills;           // Bounce buffer refills (one per chunk)
+    uint32_t bytes;           // Bytes copied PSRAM -> SRAM
+    uint32_t starved;         // DMA ran dry waiting for a refill mid-window
+    uint32_t fill_us_max;     // Longest single refill
+    uint32_t fill_us_total;   // Sum of refill times (avg = total / fills)
+    uint32_t window_us_max;   // Worst window latency: flush_cb -> last chunk out
+    uint32_t window_us_last;  // Latency of the most recent window
+} lcd_bounce_stats_t;
+
 typedef struct
 {
     uint8_t cmd;
@@ -43,6 +105,9 @@ void axs15231_init(void);
 // Set the display window size
 void lcd_address_set(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2);
 void lcd_setRotation(uint8_t r);
+// Expand a native-orientation window (inclusive corners) to the controller's
+// RAM write granularity. Used by the LVGL rounder before areas are rendered.
+void lcd_round_window(uint16_t *x1, uint16_t *y1, uint16_t *x2, uint16_t *y2);
 void lcd_DrawPoint(uint16_t x, uint16_t y, uint16_t color);
 void lcd_fill(uint16_t xsta,
               uint16_t ysta,
@@ -55,7 +120,35 @@ void lcd_PushColors(uint16_t x,
                     uint16_t high,
                     uint16_t *data);
 void lcd_PushColors(uint16_t *data, uint32_t len);
+// Push a window rendered in landscape (UI_HOR_RES x UI_VER_RES, the layout LVGL
+// used with LV_DISP_ROT_270). Rotated to the native portrait scan while the
+// pixels are copied into the DMA bounce buffers, so there is no extra pass.
+void lcd_PushColorsLandscape(uint16_t x,
+                             uint16_t y,
+                             uint16_t width,
+                             uint16_t high,
+                             uint16_t *data);
+// The same window with polling transmits: rotated one SEND_BUF_SIZE chunk at a
+// time and on the glass when this returns (no DMA completion involved)
+void lcd_PushColorsLandscapeSync(uint16_t x,
+                                 uint16_t y,
+                                 uint16_t width,
+                                 uint16_t high,
+                                 const uint16_t *data);
 void lcd_sleep();
 void lcd_wake();
 
 bool get_lcd_spi_dma_write(void);
+// Register the LVGL driver whose flush is completed from the DMA post-callback
+void lcd_attach_disp_drv(lv_disp_drv_t *drv);
+// Task notified (xTaskNotifyGive) each time a flush completes, NULL = none
+void lcd_set_flush_notify_task(TaskHandle_t task);
+// Snapshot of the bounce buffer pool statistics
+void lcd_get_bounce_stats(lcd_bounce_stats_t *out);
+// QSPI clock in use (requested Hz; the SPI divider may round it down)
+uint32_t lcd_get_spi_clock(void);
+// Re-add the panel device at another clock. Only between windows: false while
+// one is in flight, or when the driver rejects the clock (old one kept)
+bool lcd_set_spi_clock(uint32_t hz);
+// Read up to 4 bytes of register `cmd` (RDDID 0x04, ...); false on a bus error
+bool lcd_read_cmd(uint8_t cmd, uint8_t *out, size_t len);
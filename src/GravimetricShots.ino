@@ -26,85 +26,150 @@
 #include "debug_config.h"  // Wireless debug configuration (must be first for macros)
 #include "lvgl.h" /* https://github.com/lvgl/lvgl.git */
 #include "AXS15231B.h"
+#include "display_diag.h"      // Flush counters + low-priority reporter (GS_DISPLAY_DIAG)
+#include "frame_pacer.h"       // Adaptive LVGL refresh period
+#include "touch_input.h"       // INT-driven touch reads (touch task + sample ring)
+#include "touch_pipeline.h"    // Touch frame → landscape point stages (run on the touch task)
+#include "touch_gesture.h"     // Swipe / long press / two-finger gestures from the pipeline
+#include "touch_calib.h"       // Compile-time touch rotation + per-unit correction
+#include "ui_intent.h"         // Button press judgement → typed intents
+#include "start_latency.h"     // Start press → relay / first brewing frame breakdown
+#include "shot_stream.h"       // Live shot WebSocket frames (WIRELESS_DEBUG builds)
+#include "fb_mirror.h"         // Remote screen mirror, changed rows over WebSocket (GS_FB_MIRROR)
+#include "shot_publish.h"      // Shot summaries to MQTT, queued in the shot log (WIRELESS_DEBUG builds)
+#include "seqlock.h"           // Lock-free BLE → UI shared state
+#include "shot_state.h"        // Brewing / flushing / sequence flags: one atomic, versioned word
+#include "command_script.h"    // Scale command sequences as step tables (shot start, timer start)
+#include "ui_channel.h"        // Typed, coalescing UI update slots
+#include "shot_predictor.h"    // Filter + trend line + stop time (shared with tools/shot_replay)
+#include "sample_clock.h"      // Sample times on the scale's own grid instead of arrival jitter
+#include "mono_time.h"         // esp_timer time points, shot-relative offsets
+#include "shot_samples.h"      // Compact ring of the running shot's weight curve
+#include "stop_model.h"        // Learned stop latency (packet age, drip) per machine
+#include "offset_model.h"      // Per-goal offset history with outlier rejection
+#include "shot_profile.h"      // Staged recipes (pre-infusion, bloom, pulsing)
+#include "shot_stats.h"        // Shot-to-shot yield error / ratio / time per profile and build ("stats")
+#include "cup_detect.h"        // Cup placed → tare ahead of Start, optional hands-free start ("cup")
+#include "relay_control.h"     // Cached relay state + esp_timer scheduled cut-off
+#include "shot_group.h"        // Brew groups: relay pin per group (GS_GROUP_COUNT)
+#include "clean_program.h"     // Flush / backflush pulse programs on timer edges ("clean")
+#include "pump_output.h"       // Pump power: relay time-proportioning, PWM or phase angle ("pump")
+#include "flow_control.h"      // Feed-forward + PI flow controller for flow-target stages
+#include "ble_commands.h"      // Two-lane UI → BLE command channel (STOP first, TARE coalesced)
+#include "shot_chart.h"        // Live weight/flow chart on the main screen
+#include "label_gate.h"        // Skip unchanged label text, rate-limit redraws per label
+#include "status_line.h"       // Status line scheduler: message IDs, priorities, hold times
+#include "label_bind.h"        // Weight / timer labels bound to fixed-point values
+#include "weight_projector.h"  // Shot weight projected to each frame between scale packets
+#include "ui_model.h"          // Status line / Bluetooth icon copies: only the shown screen is written
+#include "trace.h"             // Scoped trace events, Chrome trace JSON dump (GS_TRACE)
+#include "gpio_probe.h"        // Packet / decision / relay / DMA edges for a logic analyser (GS_GPIO_PROBE)
+#include "iram_placement.h"    // Real-time paths in IRAM (GS_HOT_IRAM)
+#include "build_profile.h"     // Release / profile build flags, size and speed summary ("build")
+#include "metrics.h"           // Counters + latency histograms ("metrics" command, /metrics)
+#include "task_stats.h"        // Per-core load + per-task CPU ("tasks" command, GS_CPU_OVERLAY)
+#include "task_layout.h"       // Core / priority / stack / stack placement per task, stack use report
+#include "static_alloc.h"      // Queues, mutexes and buffers over link-time storage
+#include "periodic_jobs.h"     // Heartbeat / report / health jobs per task: one deadline check a pass
+#include "health_monitor.h"    // Heap/PSRAM/stack watermarks + threshold events ("health" command)
+#include "settings_store.h"    // Debounced, versioned settings blob in NVS
+#include "settings_journal.h"  // Settings / offsets appended to two alternating flash sectors ("journal")
+#include "shot_log.h"          // Finished shots on the "shotlog" LittleFS partition ("shots" command)
+#include "shot_history.h"      // History screen (list + curve) reached from the settings screen
+#include "scale_picker.h"      // Scale list (RSSI, last used) reached from the settings screen
+#include "wifi_coex.h"         // Wi-Fi held back during shots / scale connection (WIRELESS_DEBUG)
+#include "power_manager.h"     // CPU clock by activity (esp_pm locks or manual switching)
+#include "power_telemetry.h"   // SY6970 battery / input power samples between touches
+#include "i2c_bus.h"           // Touch + PMU on one bus, queued jobs between touches ("i2c" command)
+#include "watchdog.h"          // Per-subsystem deadlines, only the supervisor feeds the TWDT ("watchdog" command)
+#include "ota_update.h"        // A/B firmware updates over HTTP / BLE, rollback of an image on trial ("ota" command)
+#include "display_power.h"     // Active / dim / off / panel sleep, LEDC backlight fades ("display")
+#include "boot_splash.h"       // Splash + progress bar on the panel before LVGL exists
+#include "display_transport.h" // Panel behind the LVGL flush: init, round, submit, power (GS_DISPLAY_TRANSPORT)
+#include "display_bench.h"     // Boot-time display pipeline benchmark (GS_DISPLAY_BENCH)
+#include "lcd_clock.h"         // QSPI clock calibration (GS_LCD_CLOCK_CAL)
+#include "draw_s3.h"           // ESP32-S3 LVGL blend backend (PIE fill / copy)
+#include "mem_fast.h"          // PIE / word copy + fill primitives, "bench mem"
+#include "mem_caps.h"          // PSRAM / internal / DMA buffer placement per owner ("heap")
+#include "alloc_trace.h"       // malloc / free per subsystem in profile builds ("alloc")
+#include "micro_bench.h"       // Cycle counts of single hot-path kernels ("bench kernels")
+#include "screen_nav.h"        // Resident screens, instant swaps instead of SquareLine slides
+#include "lvgl_heap.h"         // LVGL's own TLSF pool outside the BLE heap ("lvgl")
+#include "render_audit.h"      // Per-object redraw cost + shadow / gradient cache sizing ("bench render")
+#include "layer_cache.h"       // Pre-rendered main screen background, dynamic widgets drawn on top
+#include "flush_coalesce.h"    // Dirty areas merged under a per-window cost model before each refresh
+#include "glyph_tiles.h"       // Pre-blended digit tiles for the value labels (installed by draw_s3)
+#include "crash_ring.h"        // Last events before a reset, kept in RTC memory ("crash" command)
+#include "core_dump.h"         // Panic core dump summary + /coredump.bin ("coredump" command)
+#include "ui_assets.h"         // UI icons mmap'd from the "assets" partition (GS_UI_ASSETS)
+#include "boot_timing.h"       // Boot stages + time-to-first-frame / first-weight ("boot" command)
+#include "touch_clock.h"       // Touch I2C clock kept in NVS, probed only after errors
+#include "weight_broadcast.h"  // Weight/flow/shot state GATT service for phone apps (GS_WEIGHT_BROADCAST)
+#include "ble_maint.h"         // Firmware updates + settings over BLE, no Wi-Fi needed (GS_BLE_MAINT, "blemaint")
+#include "console.h"           // Command registry + tokenizer shared by USB serial and WebSerial ("help")
+#include "web_log.h"           // Batched, sampled WebSerial log sink ("log" command)
+#include "config_json.h"       // Profiles + settings as one JSON document (/config.json, "config import")
+#include "load_cell.h"         // Wired HX711 / ADS1232 drip-tray cell as the weight source (GS_LOAD_CELL, "loadcell")
+#include "sample_capture.h"    // Every weight sample + filter state as binary records on USB ("capture")
+#include "peer_link.h"         // ESP-NOW shot state frames to other units / a remote display (GS_PEER_LINK, "peers")
+#include "shot_events.h"       // Per-shot event trace in PSRAM, kept with the shot log for tools/shot_replay ("shottrace")
 #include <Arduino.h>
 #include <Wire.h>
 #include <ui.h>
 #include <AcaiaArduinoBLE.h>  // ArduinoBLE-based scale connection
-#include "esp_task_wdt.h"      // Task watchdog for auto-recovery from hangs
 #include "nvs_flash.h"         // NVS initialization (needed for BLE storage)
 #include <Preferences.h>
 #include <cstring>
 
-// Power Management for LED control
-#define XPOWERS_CHIP_SY6970
-#include <XPowersLib.h>
-XPowersPPM PMU;
-
 // Logging tags for different subsystems
-static const char* TAG_SYS   = "System";  // System messages (setup, init, memory)
-static const char* TAG_SCALE = "Scale";   // Scale connection and weight updates
-static const char* TAG_SHOT  = "Shot";    // Shot brewing process
-static const char* TAG_UI    = "UI";      // UI events (touch, display)
-static const char* TAG_RELAY = "Relay";   // Relay control
-static const char* TAG_TASK  = "Task";    // FreeRTOS task messages
+static constexpr LogTag TAG_SYS   = LOG_TAG_SYSTEM;  // System messages (setup, init, memory)
+static constexpr LogTag TAG_SCALE = LOG_TAG_SCALE;   // Scale connection and weight updates
+static constexpr LogTag TAG_SHOT  = LOG_TAG_SHOT;    // Shot brewing process
+static constexpr LogTag TAG_UI    = LOG_TAG_UI;      // UI events (touch, display)
+static constexpr LogTag TAG_TASK  = LOG_TAG_TASK;    // FreeRTOS task messages
 
 // -----------------------------------------------------------------------------
 // Display and Touch Configuration
 // -----------------------------------------------------------------------------
 
 static lv_disp_draw_buf_t draw_buf;
+static lv_indev_t *touchIndev = NULL;  // Touch input device (read timer paused while idle)
 static lv_color_t *buf;
 static lv_color_t *buf1;
 
-// DIAGNOSTIC: Store initial buffer addresses to detect corruption
-static lv_color_t *buf_initial = NULL;
-static lv_color_t *buf1_initial = NULL;
+// Draw buffers reserved at link time (static_alloc.h): two stripes in internal
+// DRAM, or two full frames - in PSRAM .bss where the sdkconfig allows it,
+// ps_malloc()'d at boot where it does not
+#if GS_DRAW_STRIPE_ROWS > 0
+static lv_color_t drawStripes[2][UI_HOR_RES * GS_DRAW_STRIPE_ROWS] __attribute__((aligned(16)));
+#elif GS_PSRAM_BSS_AVAILABLE
+static lv_color_t drawFrames[2][EXAMPLE_LCD_H_RES * EXAMPLE_LCD_V_RES] GS_PSRAM_BSS __attribute__((aligned(16)));
+#endif
 
 constexpr int TOUCH_IICSCL = 10;
 constexpr int TOUCH_IICSDA = 15;
 constexpr int TOUCH_RES    = 16;
 
-constexpr int AXS_TOUCH_ONE_POINT_LEN = 6;
-constexpr int AXS_TOUCH_BUF_HEAD_LEN  = 2;
-
-constexpr int AXS_TOUCH_GESTURE_POS = 0;
-constexpr int AXS_TOUCH_POINT_NUM   = 1;
-constexpr int AXS_TOUCH_EVENT_POS   = 2;
-constexpr int AXS_TOUCH_X_H_POS     = 2;
-constexpr int AXS_TOUCH_X_L_POS     = 3;
-constexpr int AXS_TOUCH_ID_POS      = 4;
-constexpr int AXS_TOUCH_Y_H_POS     = 4;
-constexpr int AXS_TOUCH_Y_L_POS     = 5;
-constexpr int AXS_TOUCH_WEIGHT_POS  = 6;
-constexpr int AXS_TOUCH_AREA_POS    = 7;
-
-#define AXS_GET_POINT_NUM(buf) buf[AXS_TOUCH_POINT_NUM]
-#define AXS_GET_GESTURE_TYPE(buf) buf[AXS_TOUCH_GESTURE_POS]
-#define AXS_GET_POINT_X(buf, point_index) (((uint16_t)(buf[AXS_TOUCH_ONE_POINT_LEN * point_index + AXS_TOUCH_X_H_POS] & 0x0F) << 8) + (uint16_t)buf[AXS_TOUCH_ONE_POINT_LEN * point_index + AXS_TOUCH_X_L_POS])
-#define AXS_GET_POINT_Y(buf, point_index) (((uint16_t)(buf[AXS_TOUCH_ONE_POINT_LEN * point_index + AXS_TOUCH_Y_H_POS] & 0x0F) << 8) + (uint16_t)buf[AXS_TOUCH_ONE_POINT_LEN * point_index + AXS_TOUCH_Y_L_POS])
-#define AXS_GET_POINT_EVENT(buf, point_index) (buf[AXS_TOUCH_ONE_POINT_LEN * point_index + AXS_TOUCH_EVENT_POS] >> 6)
+// Touch controller report layout (AXS_*) lives in touch_input.h
 
 // -----------------------------------------------------------------------------
 // Brew & Application Configuration
 // -----------------------------------------------------------------------------
 
 constexpr int MAX_OFFSET          = 5;
-constexpr int MIN_SHOT_DURATION_S = 5;
-constexpr int MAX_SHOT_DURATION_S = 50;
-constexpr int DRIP_DELAY_S        = 3;
-constexpr int N                   = 10; // Samples used for trend line
+constexpr int DRIP_DELAY_S        = 3;  // MIN/MAX_SHOT_DURATION_S live in shot_predictor.h
 
-constexpr int RELAY1           = 48;
-constexpr int SHOT_HISTORY_CAP = 2000;  // Increased from 1000 to reduce buffer wrapping frequency
+constexpr int SHOT_HISTORY_CAP = 2000;  // Samples kept per shot (4 bytes each, oldest overwritten)
 
 // -----------------------------------------------------------------------------
 // Global State
 // -----------------------------------------------------------------------------
 
 AcaiaArduinoBLE scale;
-float currentWeight       = 0.0f;
+AtomicValue<float> currentWeight(0.0f);  // Control task (samples), BLE task (scale lost); read everywhere
 uint8_t goalWeight        = 0;
-float weightOffset        = 0.0f;
+float weightOffset        = 0.0f;  // offsetModelGet(goalWeight) cache, refreshed on the BLE task
+uint8_t offsetGoal        = 0;     // Goal weightOffset was last fetched for
 bool firstBoot            = true;
 int brightness            = 0;
 float previousTimerValue  = 0.0f;
@@ -113,39 +178,51 @@ float previousTimerValue  = 0.0f;
 unsigned long lastTimerUpdate = 0;
 const unsigned long TIMER_UPDATE_INTERVAL_MS = 100;  // 100ms = 0.1 second
 
-// Display sleep tracking and auto-wake
-bool displayAsleep = false;
+// Display sleep tracking and auto-wake (state machine: display_power.h)
+bool displayAsleep = false;   // displayPowerPaused() - LVGL stopped, UI task in deep idle
 unsigned long lastTouchTime = 0;
 unsigned long lastWakeTime = 0;  // Timestamp when display woke up (to prevent phantom touches)
-const unsigned long DISPLAY_SLEEP_TIMEOUT_MS = 300000;  // 5 minutes idle = sleep
 const unsigned long WAKE_GUARD_MS = 1000;  // Ignore touches for 1 second after wake
+const unsigned long TOUCH_READ_TAIL_MS = 1000;  // Keep LVGL reading touch this long after release
 const unsigned long TOUCH_CONTROLLER_RECOVERY_MS = 500;  // Wait 500ms for touch controller to power up after wake
 
-// Watchdog debugging - track reset counts and timing
-static unsigned long mainLoopWDTResets = 0;
-static unsigned long bleTaskWDTResets = 0;
-static unsigned long lastMainWDTLog = 0;
-static unsigned long lastBLEWDTLog = 0;
-const unsigned long WDT_LOG_INTERVAL_MS = 5000;  // Log watchdog stats every 5 seconds
+// Runtime metrics (see metrics.h) - the periodic log lines below are derived views
+static MetricHistogram flushCbUs("lcd_flush_cb_us", "Time inside flush_cb (window queued for DMA)", METRIC_BUCKETS_US);
+static MetricCounterRef flushCount("lcd_flushes_total", "flush_cb invocations", &displayDiag.flushes);
+static MetricCounterRef flushRejected("lcd_flush_rejected_total", "Out-of-bounds flush areas dropped", &displayDiag.rejectedAreas);
+static MetricCounter touchIndevReads("touch_indev_reads_total", "LVGL touch read_cb calls (read timer running)");
+static MetricCounter scalePackets("scale_packets_total", "Weight packets received");
+static MetricHistogram scalePacketPeriodMs("scale_packet_period_ms", "Scale packet inter-arrival time", METRIC_BUCKETS_MS);
+static MetricHistogram stopStalenessMs("shot_stop_staleness_ms", "Age of the newest sample at the stop decision", METRIC_BUCKETS_MS);
+static MetricHistogram controlPassUs("control_pass_us", "Shot control task pass (samples + decisions)", METRIC_BUCKETS_US);
+static MetricHistogram uiApplyUs("ui_apply_us", "processUIUpdates(): one channel take into the widgets", METRIC_BUCKETS_US);
+static MetricHistogram controlSampleLagUs("control_sample_lag_us", "Weight packet arrival → processed by the control task", METRIC_BUCKETS_US);
+static MetricHistogram sampleArrivalDelayUs("sample_arrival_delay_us", "Weight packet arrival after its sample clock time", METRIC_BUCKETS_US);
+static MetricCounter controlSamplesDropped("control_samples_dropped_total", "Weight samples lost to a full control queue");
+static MetricHistogram flowControlLatencyUs("flow_control_latency_us", "Weight packet arrival → pump power applied", METRIC_BUCKETS_US);
+static MetricCounter flowControlOverruns("flow_control_overruns_total", "Flow control steps over GS_FLOW_LATENCY_BUDGET_US");
 
 // LVGL initialization tracking (prevent crashes from calling lv_timer_handler before init)
 static bool lvglInitialized = false;
 
 // Persistent string buffers for LVGL labels (prevent realloc bugs in LVGL v8.3.0-dev)
-// These buffers persist for the lifetime of the program, allowing lv_label_set_text_static()
-// to reference them safely without triggering LVGL's buggy dynamic realloc system
-static char weightDisplayBuffer[48] = "  0.0";
-static char timerDisplayBuffer[48] = "  0.0";
-static char statusDisplayBuffer[64] = "";
-
-// Thermal noise detection for touch controller
-static uint32_t edgeTouchCount = 0;
-static uint32_t lastEdgeTouchTime = 0;
-static bool thermalSuppressionActive = false;
-static uint32_t thermalSuppressionStart = 0;
-static const uint32_t EDGE_TOUCH_WINDOW_MS = 5000;  // 5-second window for counting edge touches
-static const uint32_t EDGE_TOUCH_THRESHOLD = 10;     // >10 edge touches = thermal noise
-static const uint32_t THERMAL_SUPPRESSION_DURATION_MS = 10000;  // Suppress for 10 seconds
+// Each gate's shown() buffer persists for the lifetime of the program, allowing
+// lv_label_set_text_static() to reference it safely without LVGL's buggy dynamic realloc.
+// The gates only let a redraw through when the visible text changes, at most once per interval.
+// Main screen labels hold their values while settings is shown and catch up when it is back.
+static NumericLabel weightLabel(&ui_ScaleLabel, 5, 1, 50, &ui_MainScreen);   // 0.1 g steps, 20 Hz max (projected during shots)
+static NumericLabel timerLabel(&ui_TimerLabel, 5, 1, 100, &ui_MainScreen);   // 0.1 s steps, 10 Hz max
+static WeightProjector weightTrack;                      // Filter weight + flow between packets (weight_projector.h)
+static lv_timer_t *shotClockTimer = NULL;                // Runs timerLabel during a shot (shotClockTick)
+static int64_t shotClockStartUs = 0;
+static StatusScheduler statusLine;                       // Text line: priorities, hold times, 4 Hz max (status_line.h)
+
+// Widgets with a copy on both SquareLine screens (ui_model.h)
+static const ScreenView STATUS_VIEWS[] = {{&ui_MainScreen, &ui_SerialLabel}, {&ui_SettingScreen, &ui_SerialLabel1}};
+static const ScreenView BLUETOOTH_VIEWS[] = {{&ui_MainScreen, &ui_BluetoothImage1}, {&ui_SettingScreen, &ui_BluetoothImage2}};
+static ScreenMirror statusMirror(STATUS_VIEWS, 2);
+static ScreenMirror bluetoothMirror(BLUETOOTH_VIEWS, 2);
+static bool bluetoothShown = false;  // Scale link state the icons should show
 
 // -----------------------------------------------------------------------------
 // FreeRTOS Task Architecture - Professional Separation of BLE and UI
@@ -154,7 +231,47 @@ static const uint32_t THERMAL_SUPPRESSION_DURATION_MS = 10000;  // Suppress for
 // BLE Task Handle
 TaskHandle_t bleTaskHandle = NULL;
 
-// Shared Data Structure - Protected by Mutex
+// BLE task wake-up events (task notification bits, xTaskNotify eSetBits)
+// Deadlines (heartbeat, sequencer steps, reconnect) are the wait timeout
+constexpr uint32_t BLE_EVT_HCI_RX    = 1u << 0;  // Controller delivered HCI data (VHCI callback)
+constexpr uint32_t BLE_EVT_NOTIFY    = 1u << 1;  // Weight notification stored (BLEUpdated handler)
+constexpr uint32_t BLE_EVT_COMMAND   = 1u << 2;  // Command submitted (ble_commands.h)
+constexpr uint32_t BLE_EVT_SEQUENCER = 1u << 3;  // Shot start sequence triggered
+constexpr uint32_t BLE_EVT_MAINT     = 1u << 4;  // Update buffer on flash / verified (ble_maint.h)
+constexpr uint32_t BLE_TASK_MAX_WAIT_MS = 1000;  // Housekeeping logs when nothing else is due
+constexpr uint32_t BLE_TASK_WATCHDOG_MS = 3000;  // One loop pass (watchdog.h); blocking calls extend it
+constexpr uint32_t BLE_TASK_CONNECT_POLL_MS = 20;  // Connection state machine step interval
+
+// Shot control task (Core 0, above BLE): the BLE task only moves samples and
+// scale commands, every shot decision - stop prediction, relay, timer,
+// watchdogs, drip / offset learning - runs here, so a blocking ArduinoBLE
+// call or a reconnect cannot delay the cut-off
+TaskHandle_t controlTaskHandle = NULL;
+constexpr uint32_t CONTROL_EVT_SAMPLE    = 1u << 0;  // Weight sample queued by the BLE task
+constexpr uint32_t CONTROL_EVT_RELAY_CUT = 1u << 1;  // Scheduled relay cut-off fired (esp_timer task)
+constexpr uint32_t CONTROL_EVT_SHOT      = 1u << 2;  // Shot or flush started / stopped
+constexpr uint32_t CONTROL_EVT_SETTINGS  = 1u << 3;  // Offset / profile written over BLE (ble_maint.h)
+constexpr uint32_t CONTROL_TASK_MAX_WAIT_MS = 500;   // Idle: goal / offset changes between shots
+constexpr uint32_t CONTROL_WATCHDOG_MS      = 1000;  // One control pass (watchdog.h)
+constexpr UBaseType_t CONTROL_SAMPLE_QUEUE_LEN = 16; // Several seconds of packets at the slowest scale
+
+struct ControlSample {
+    float weight;
+    int64_t arrivalUs;   // esp_timer time the notification arrived
+};
+static QueueHandle_t controlSamples = NULL;
+static StaticQueue<ControlSample, CONTROL_SAMPLE_QUEUE_LEN> controlSampleStore;
+static volatile bool shotArmPending = false;  // Scale confirmed the start, control task arms the shot
+
+// UI Task Handle + configuration (LVGL owner, Core 1)
+TaskHandle_t uiTaskHandle = NULL;
+constexpr uint32_t UI_TASK_MAX_WAIT_MS   = 50;     // updateUIWithBLEData() poll interval
+constexpr uint32_t UI_TASK_DEEP_IDLE_WAIT_MS = 5000;  // Display asleep: housekeeping only
+constexpr uint32_t UI_TASK_HEADLESS_WAIT_MS = 500;    // Display asleep, shot / flush running: flush end, chart points
+constexpr uint32_t RENDER_WATCHDOG_MS    = 3000;   // One UI task pass, LVGL refresh included (watchdog.h)
+constexpr uint32_t DMA_WATCHDOG_MS       = 1000;   // One flush window, queued → flush_ready
+
+// Shared Data Structure - Published by the BLE task through a SeqLock
 struct BLESharedData {
     // Connection status
     bool isConnected;
@@ -180,78 +297,36 @@ struct BLESharedData {
     unsigned long lastPacketTime;
 };
 
-BLESharedData bleData = {
+// Written ONLY by the BLE task (Core 0), read lock-free from any task - see seqlock.h
+SeqLock<BLESharedData> bleData(BLESharedData{
     false,  // isConnected
     false,  // isConnecting
     "Not Connected",  // statusMessage
     0.0f,   // currentWeight
     0.0f,   // lastStableWeight
     0,      // lastWeightUpdate
-    0,      // batteryLevel
+    -1,     // batteryLevel (unknown)
     "",     // scaleModel
     false,  // isBrewing
     0,      // brewStartTime
     0,      // connectionUptime
     0,      // totalPacketsReceived
     0       // lastPacketTime
-};
-
-SemaphoreHandle_t bleDataMutex = NULL;
+});
 
 // Serial Print Mutex - Protect Serial.print() from thread collisions
 SemaphoreHandle_t serialMutex = NULL;
+static StaticMutex serialMutexStore;
 
-// Command Queue - Main Loop to BLE Task
-enum BLECommand {
-    BLE_CMD_TARE,
-    BLE_CMD_START_TIMER,
-    BLE_CMD_STOP_TIMER,
-    BLE_CMD_RESET_TIMER,
-    BLE_CMD_DISCONNECT,
-    BLE_CMD_FORCE_RECONNECT
-};
-
-struct BLECommandMessage {
-    BLECommand command;
-    uint32_t param;  // Optional parameter
-};
-
-QueueHandle_t bleCommandQueue = NULL;
-
-// UI Update Queue - BLE Task to Main Loop (Professional Thread-Safe Pattern)
-// Follows same pattern as bleCommandQueue for consistency
-enum UIUpdateType {
-    UI_UPDATE_WEIGHT,
-    UI_UPDATE_TIMER,
-    UI_UPDATE_STATUS,
-    UI_UPDATE_CONNECTION
-};
-
-struct UIUpdateMessage {
-    UIUpdateType type;
-    char text[48];      // Large enough for any label text
-    bool boolValue;     // For connection status updates
-};
-
-QueueHandle_t uiUpdateQueue = NULL;
-
-// BLE command sequencer state machine (non-blocking)
-enum BLESequenceState {
-  BLE_IDLE,
-  BLE_SEND_RESET,
-  BLE_WAIT_AFTER_RESET,
-  BLE_SEND_TARE,
-  BLE_WAIT_AFTER_TARE,
-  BLE_SEND_START,
-  BLE_START_SHOT
-};
+// Commands - UI task to BLE task: two lanes, STOP first, see ble_commands.h
 
-BLESequenceState bleSequenceState = BLE_IDLE;
-unsigned long bleSequenceTimestamp = 0;
-const unsigned long BLE_COMMAND_DELAY_MS = 100;
-bool bleSequenceInProgress = false;
+// UI updates - BLE Task / event handlers to UI Task: typed slots, see ui_channel.h
 
-// Battery request now handled during scale init (in AcaiaArduinoBLE library)
+// BLE command sequences (non-blocking): scripts in command_script.h, run by the BLE task
+static CommandScriptRunner bleSequencer;                        // BLE task only
+AtomicValue<const CommandScript *> bleScriptRequest(NULL);      // Any task → BLE task, taken by handleBLESequence()
+const unsigned long BLE_CONFIRM_TIMEOUT_MS = 300;  // Start anyway if the scale never confirms the tare
+ShotStateRef<SHOT_STATE_SEQUENCE> bleSequenceInProgress;
 
 // Shot end reason tracking for debugging and user feedback
 enum ShotEndReason {
@@ -260,46 +335,83 @@ enum ShotEndReason {
   BUTTON_PRESSED,     // User manually stopped shot
   SCALE_DISCONNECTED, // Lost connection to scale
   USER_STOPPED,       // Generic user stop
-  UNDEFINED           // Not yet determined
+  UNDEFINED,          // Not yet determined
+  FLOW_ANOMALY        // Channeling / choked (-DGS_ANOMALY_STOP=1)
 };
 
 struct Shot
 {
-  float start_timestamp_s = 0.0f;
+  MonoUs start_us         = 0;  // esp_timer at pump-on, all shot times are taken against it; 0 = nothing to finish
   float shotTimer         = 0.0f;
   float end_s             = 0.0f;
   float expected_end_s    = 0.0f;
-  float weight[SHOT_HISTORY_CAP] = {};
-  float time_s[SHOT_HISTORY_CAP] = {};
-  int   datapoints = 0;
-  bool  brewing    = false;
+  ShotSampleStore samples;      // Weight curve, allocated in setup()
+  ShotPredictor predictor;      // Filtered weight/flow and trend line → expected end
+  ShotStateRef<SHOT_STATE_BREWING> brewing;  // shot_state.h - any task, any core
+  uint8_t profile  = 0;          // shotProfileActiveIndex() when the shot armed
   ShotEndReason endReason = UNDEFINED;
 };
 
 Shot shot;
+static SampleClock sampleClock;   // Weight packet arrivals → scale sample times (control task)
+ShotProfileRunner profileRunner;  // Stages of the running shot (control task)
+FlowController flowController;    // Pump power for flow-target stages (control task)
+
+#ifndef GS_FLOW_LATENCY_BUDGET_US
+#define GS_FLOW_LATENCY_BUDGET_US 5000  // Packet arrival → pump power, counted as an overrun above this
+#endif
+static bool shotLogDue = false;   // A started shot still has to go to the shot log (control task)
+
+// Hand the finished shot to the shot log writer (it waits while a shot brews)
+static void logFinishedShot()
+{
+  shotLogDue = false;
+  ShotLogHeader header = {};
+  header.endReason = (uint8_t)shot.endReason | (uint8_t)(shot.predictor.anomaly.flags() << SHOT_LOG_ANOMALY_SHIFT);
+  header.goalDg = (uint16_t)(goalWeight * 10);
+  header.offsetCg = (int16_t)lroundf(weightOffset * 100.0f);
+  header.finalCg = (int16_t)lroundf(constrain(currentWeight, -327.0f, 327.0f) * 100.0f);
+  header.durationDs = (uint16_t)lroundf(shot.end_s * 10.0f);
+  shotEventsShotEnded((uint8_t)shot.endReason, currentWeight);
+  if (!shotLogSubmit(header, shot.samples))
+    LOG_WARN(TAG_SHOT, "⚠️  Shot not logged - previous shot still being written");
+  else
+    shotPublishNotify();
+  shotStatsRecord(shot.profile, (uint8_t)shot.endReason, shot.predictor.anomaly.flags(), goalWeight, currentWeight,
+                  shot.end_s);
+  peerLinkNoteShot(currentWeight, shot.end_s, (uint8_t)shot.endReason);
+  cleanProgramNoteShot();
+}
 
-// NimBLE Server objects (for advertising weight to external devices - optional)
-// DISABLED: Removed NimBLE server functionality (reverted to ArduinoBLE for stability)
-// NimBLEServer* pServer = nullptr;
-// NimBLEService* pWeightService = nullptr;
-// NimBLECharacteristic* pWeightCharacteristic = nullptr;
+// Fresh curve, filter and trend for the next shot
+static void resetShotModel()
+{
+  shot.samples.clear();
+  shot.predictor.reset();
+  stopModelCancel();
+
+  const ScaleDriver *driver = scale.driver();
+  if (loadCellActive())
+    shot.predictor.filter.setNoise(LOAD_CELL_PROCESS_NOISE, LOAD_CELL_MEASUREMENT_NOISE);
+  else if (driver != NULL)
+    shot.predictor.filter.setNoise(driver->processNoise(), driver->measurementNoise());
+}
 
 bool firstConnectionNotificationPending = true;
 bool BatteryLow                         = false;
 
-// Flushing sequence state
-unsigned long startTimeFlushing     = 0;
-unsigned long lastPrintTimeFlushing = 0;
-const unsigned long flushDuration   = 5000; // ms
-bool isFlushing                     = false;
+// Flush / backflush running - set and cleared by clean_program.h only
+ShotStateRef<SHOT_STATE_FLUSHING> isFlushing;
 
-constexpr uint32_t HUMAN_TOUCH_MIN_MS = 100; // Debounce time - prevents accidental double-clicks
-constexpr uint32_t FLUSH_BUTTON_MIN_PRESS_MS = 300; // Flush requires longer press to prevent thermal phantom triggers
+// Command buttons: press judgement in ui_intent.h, actions in handleUiIntent()
+static constexpr UiIntentPolicy FLUSH_POLICY       = {UI_INTENT_FLUSH, UI_INTENT_HOLD_MIN_MS, "Flush button"};
+static constexpr UiIntentPolicy START_POLICY       = {UI_INTENT_START, UI_INTENT_TAP_MIN_MS, "Start button"};
+static constexpr UiIntentPolicy STOP_POLICY        = {UI_INTENT_STOP, UI_INTENT_TAP_MIN_MS, "Stop button"};
+static constexpr UiIntentPolicy TARE_POLICY        = {UI_INTENT_TARE, UI_INTENT_TAP_MIN_MS, "Tare button"};
+static constexpr UiIntentPolicy TIMER_RESET_POLICY = {UI_INTENT_TIMER_RESET, UI_INTENT_TAP_MIN_MS, "Timer reset button"};
 
 Preferences preferences;
-const char *WEIGHT_KEY     = "weight";
-const char *OFFSET_KEY     = "offset";
-const char *BRIGHTNESS_KEY = "brightness";
+const char *OFFSET_KEY     = "offset";  // Legacy single offset (brightness/goal weight: settings_store.h)
 
 // DEBUG_PRINT and DEBUG_PRINTLN are now defined in debug_config.h
 // - Production builds: Output to Serial only
@@ -310,222 +422,487 @@ bool hasEverConnectedToScale = false;
 bool hasShownNoScaleMessage  = false;
 // CRITICAL: Must be >= BLE scan timeout (1s ArduinoBLE) + margin to prevent overlapping scans
 constexpr uint32_t SCALE_INIT_RETRY_MS = 2000;  // 1s scan timeout + 1s cleanup margin
-constexpr uint32_t FLUSH_STATUS_HOLD_MS = 2000;
+constexpr uint32_t SCALE_INIT_RETRY_BATTERY_MS = 6000;  // Scan duty on battery (power saver)
+// Scale lost mid-shot: keep brewing on the cut timer armed at the last sample's predicted
+// end for at most this long after the last packet, reconnecting straight to the same scale
+constexpr uint32_t SCALE_RIDE_THROUGH_MS = 4000;
 uint32_t lastScaleInitAttempt          = 0;
-char pendingScaleStatus[64] = {0};  // Fixed buffer - eliminates heap fragmentation
-bool hasPendingScaleStatus = false;
-char currentStatusText[64] = {0};   // Fixed buffer - eliminates heap fragmentation
-bool flushMessageActive    = false;
-uint32_t flushMessageHoldUntil = 0;
-bool relayState = false;
+static uint32_t rideThroughUntil       = 0;  // millis() deadline, 0 = not riding through
+
+// Pause between scan attempts while no scale is connected - longer on battery
+static inline uint32_t scaleInitRetryMs()
+{
+  return powerOnBattery() ? SCALE_INIT_RETRY_BATTERY_MS : SCALE_INIT_RETRY_MS;
+}
+
+// BLE task, scale just lost while brewing: ride through if the stop is already scheduled
+// (predictor at the goal stage) and the last packet is recent. The cut timer then stops the
+// pump at the extrapolated end, or packets resume and the shot carries on from them.
+static bool rideThroughStart(uint32_t now)
+{
+  int64_t cutUs = 0;
+  int64_t lastPacketUs = scale.packetTimeUs();  // Before reconnect() clears it
+  if (!relayControlCutPending(&cutUs) || lastPacketUs == 0)
+    return false;
+
+  int64_t nowUs = esp_timer_get_time();
+  int64_t leftUs = lastPacketUs + SCALE_RIDE_THROUGH_MS * 1000LL - nowUs;
+  if (leftUs <= 0)
+    return false;  // Silent too long already (packet watchdog)
+
+  rideThroughUntil = (now + (uint32_t)(leftUs / 1000)) | 1;  // Never 0 (= off)
+  LOG_WARN(TAG_SCALE, "📡 Scale lost mid-shot - riding through %lums, predicted end in %ldms",
+           (unsigned long)(leftUs / 1000), (long)((cutUs - nowUs) / 1000));
+  if (!scale.isConnecting())
+    scale.reconnect();  // Last scale's address and cached GATT handles
+  lastScaleInitAttempt = now;
+  return true;
+}
 
+// Cached in relay_control - unchanged state costs no GPIO access
 static inline void setRelayState(bool high)
 {
-  int desired = high ? HIGH : LOW;
-  if (relayState == high && digitalRead(RELAY1) == desired)
+  relayControlSet(high);
+}
+
+// Candidates of the last open scan, best first ("scales")
+static void printScaleCandidates(Print &out)
+{
+  ScaleCandidate candidates[SCAN_MAX_CANDIDATES];
+  uint8_t generation;
+  int count = scale.scaleCandidates(candidates, SCAN_MAX_CANDIDATES, &generation);
+  out.printf("[Scales] %d seen (generation %u)\n", count, generation);
+  for (int i = 0; i < count; i++) {
+    const ScaleCandidate &c = candidates[i];
+    out.printf("  %c %-18s %s %4d dBm %5lus ago%s%s\n", c.connected ? '*' : ' ', c.name, c.address, c.rssi,
+               (millis() - c.seenMs) / 1000, c.lastUsed ? " last-used" : "", c.failed ? " failed" : "");
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Console commands (console.h) - USB serial and WebSerial, run on the log drain task
+// -----------------------------------------------------------------------------
+
+static void cmdTrace(ConsoleArgs &args)
+{
+  if (args.source == CONSOLE_WEB) {  // Far too big for WebSocket messages - download it instead
+    debugPrintUrl(args.out, "Trace JSON", "/trace.json", " (open in ui.perfetto.dev)");
+    return;
+  }
+  size_t events = traceDump(args.out);
+  args.out.printf("[Trace] %u events\n", (unsigned)events);
+}
+
+static void cmdMetrics(ConsoleArgs &args)
+{
+  metricsDump(args.out, args.arg(1));
+  debugPrintUrl(args.out, "Metrics", "/metrics", " (Prometheus text format)");
+}
+
+static void cmdTasks(ConsoleArgs &args)
+{
+  taskStatsDump(args.out);
+  taskLayoutDump(args.out);
+}
+
+static void cmdShots(ConsoleArgs &args)
+{
+  shotLogDump(args.out, 20);
+  debugPrintUrl(args.out, "Export", "/shots.csv", " (?samples=1), /shots.json (?last=N)");
+}
+
+static void cmdCoreDump(ConsoleArgs &args)
+{
+  if (args.is(1, "erase"))
+    args.out.println(coreDumpErase() ? "Core dump erased" : "Core dump: erase failed");
+  else
+    coreDumpDump(args.out);
+}
+
+static void cmdPower(ConsoleArgs &args)
+{
+  powerManagerDump(args.out);
+  powerTelemetryDump(args.out);
+}
+
+static void cmdTouch(ConsoleArgs &args)
+{
+  touchPipelineDump(args.out);
+  uiIntentDump(args.out);
+}
+
+static void cmdDisplay(ConsoleArgs &args)
+{
+  long pct;
+  if (args.is(1, "ambient")) {
+    if (!args.number(2, &pct)) {
+      args.out.println("Usage: display ambient <pct>");
+      return;
+    }
+    displayPowerSetAmbient((uint8_t)constrain(pct, 0, 100));
+  }
+  displayPowerDump(args.out);
+  drawS3Dump(args.out);
+  glyphTilesDump(args.out);
+  layerCacheDump(args.out);
+  flushCoalesceDump(args.out);
+}
+
+static void cmdLcdClock(ConsoleArgs &args)
+{
+  if (args.is(1, "reset")) {
+    lcdClockReset();
+    args.out.println("QSPI clock calibration cleared, runs on next boot (GS_LCD_CLOCK_CAL builds)");
+    return;
+  }
+  lcdClockDump(args.out);
+}
+
+static void cmdTouchCal(ConsoleArgs &args)
+{
+  if (args.is(1, "reset")) {
+    touchCalibReset();
+  } else if (args.is(1, "jump")) {
+    long v[6];
+    for (uint8_t i = 0; i < 6; i++) {
+      if (!args.number(2 + i, &v[i])) {
+        args.out.println("Usage: touchcal jump <edge x> <edge jump x> <edge y> <edge jump y> <max jump x> <max jump y>");
+        return;
+      }
+    }
+    touchCalibSetJump({(int16_t)v[0], (int16_t)v[1], (int16_t)v[2], (int16_t)v[3], (int16_t)v[4], (int16_t)v[5]});
+  } else if (args.argc > 1) {
+    float sx, dx, sy, dy;
+    if (!args.decimal(1, &sx) || !args.decimal(2, &dx) || !args.decimal(3, &sy) || !args.decimal(4, &dy) ||
+        !touchCalibSetCorrection(sx, dx, sy, dy)) {
+      args.out.println("Usage: touchcal <scale x> <offset x> <scale y> <offset y> (panel px, scales 0.5 - 2)");
+      return;
+    }
+  }
+  touchCalibDump(args.out);
+}
+
+static void cmdHeap(ConsoleArgs &args)
+{
+  args.out.printf("Free heap: %lu bytes, min free: %lu bytes, largest block: %lu bytes\n",
+                  (unsigned long)ESP.getFreeHeap(), (unsigned long)ESP.getMinFreeHeap(),
+                  (unsigned long)ESP.getMaxAllocHeap());
+  memCapsDump(args.out);
+}
+
+static void cmdLog(ConsoleArgs &args)
+{
+  LogRingStats stats;
+  logRingGetStats(&stats);
+  for (int core = 0; core < 2; core++) {
+    args.out.printf("Log core %d: %lu lines, %lu dropped, max %lu/%lu slots used\n", core,
+                    (unsigned long)stats.written[core], (unsigned long)stats.dropped[core],
+                    (unsigned long)stats.highWater[core], (unsigned long)LOG_RING_SLOTS);
+  }
+  webLogDump(args.out);
+}
+
+static void cmdRestart(ConsoleArgs &args)
+{
+  args.out.println("Restarting ESP32...");
+  LOG_INFO(TAG_SYS, "🔄 Restart requested from the console");
+  settingsStoreFlush();  // Pending slider changes
+  logRingFlush(500);     // Let queued log lines out first
+  delay(100);
+  crashRingRecord(CRASH_EV_RESTART);
+  ESP.restart();
+}
+
+static void bleReconnectDone(BLECommand, bool ok, uint32_t)
+{
+  if (ok)
+    LOG_INFO(TAG_SCALE, "🔄 Scale link dropped, reconnecting");
+  else
+    LOG_WARN(TAG_SCALE, "⚠️  Scale reconnect not done (shot running?)");
+}
+
+static void cmdBle(ConsoleArgs &args)
+{
+  if (args.is(1, "reconnect")) {
+    args.out.println(bleCommandSubmit(BLE_CMD_FORCE_RECONNECT, 0, bleReconnectDone)
+                         ? "Scale reconnect queued"
+                         : "BLE command lane full - try again");
+    return;
+  }
+  if (args.argc > 1) {
+    args.out.println("Usage: ble [reconnect]");
     return;
-  relayState = high;
-  digitalWrite(RELAY1, desired);
-  LOG_DEBUG(TAG_RELAY, "Relay1 -> %s", high ? "HIGH" : "LOW");
+  }
+  args.out.printf("[BLE] scale %s (%s)\n", connectionStateName(scale.connectionState()),
+                  scale.isConnected() ? "connected" : "not connected");
+  printScaleCandidates(args.out);
+}
+
+static void cmdBench(ConsoleArgs &args)
+{
+  if (args.is(1, "mem")) {
+    memFastBench(args.out);
+  } else if (args.is(1, "render")) {
+    renderAuditRequest(args.stream);  // Printed later, by the UI task
+  } else if (args.is(1, "console")) {
+    consoleBench(args.out);
+  } else if (args.is(1, "kernels")) {
+    // bench kernels [<name>|all] [<n>] [masked]
+    long n = 0;
+    const char *name = NULL;
+    bool masked = args.is(args.argc - 1, "masked");
+    if (args.argc > 2 && !args.number(2, &n) && !args.is(2, "masked")) {
+      name = args.is(2, "all") ? NULL : args.arg(2);
+      args.number(3, &n);
+    }
+    microBenchPrint(args.out, name, n > 0 ? (uint32_t)n : 0, masked);
+  } else if (args.is(1, "metrics")) {
+    MetricsCursor cursor;
+    uint8_t chunk[128];
+    size_t bytes = 0, n;
+    int64_t start = esp_timer_get_time();
+    while ((n = cursor.read(chunk, sizeof(chunk))) > 0)
+      bytes += n;
+    args.out.printf("[Bench] metrics: %u bytes in %lu us (one /metrics scrape, transport excluded)\n",
+                    (unsigned)bytes, (unsigned long)(esp_timer_get_time() - start));
+  } else {
+    args.out.println("Usage: bench <mem|render|metrics|console|kernels [<name>|all] [<n>] [masked]>");
+  }
+}
+
+static ConsoleCommand traceCommand("trace", "", "Chrome trace JSON of the last events (GS_TRACE builds)", cmdTrace);
+static ConsoleCommand metricsCommand("metrics", "[prefix]", "Counters + histograms, or those starting with prefix", cmdMetrics);
+static ConsoleCommand tasksCommand("tasks", "", "CPU load per core / task, task layout + stack use", cmdTasks);
+static ConsoleCommand healthCommand("health", "Heap + stack watermarks and events", healthMonitorDump);
+static ConsoleCommand shotsCommand("shots", "", "Last 20 logged shots", cmdShots);
+static ConsoleCommand crashCommand("crash", "Events before the last reset", crashRingDump);
+static ConsoleCommand coreDumpCommand("coredump", "[erase]", "Last panic summary (or clear it)", cmdCoreDump);
+static ConsoleCommand startCommand("start", "Last Start presses: touch → relay / first brewing frame per hop", startLatencyDump);
+static ConsoleCommand bootCommand("boot", "Time to first frame / first weight", bootTimingDump);
+static ConsoleCommand scalesCommand("scales", "Scales seen by the last scan", printScaleCandidates);
+static ConsoleCommand powerCommand("power", "", "CPU clock, power locks, battery / input power", cmdPower);
+static ConsoleCommand displayCommand("display", "[ambient <pct>]", "Display power state (scale the backlight), blend paths, glyph tiles, layer cache, flush coalescing", cmdDisplay);
+static ConsoleCommand lcdClockCommand("lcdclock", "[reset]", "QSPI clock in use, last calibration (recalibrate next boot)", cmdLcdClock);
+static ConsoleCommand i2cCommand("i2c", "Bus transactions / errors / queue wait per device", i2cBusDump);
+static void cmdPump(ConsoleArgs &args)
+{
+  pumpOutputDump(args.out);
+  HistogramSnapshot lat;
+  flowControlLatencyUs.snapshot(&lat);
+  args.out.printf("  flow control %s: power %.0f%%, error %.2f g/s, integral %.2f; full power = %.1f g/s\n",
+                  flowController.active() ? "running" : "idle", flowController.power() * 100.0f,
+                  flowController.error(), flowController.integralTerm(), GS_FLOW_FULL_POWER_GS);
+  args.out.printf("  packet → power p50 %lu us, p99 %lu us, max %lu us, %lu over %u us\n",
+                  (unsigned long)flowControlLatencyUs.percentile(lat, 0.50f),
+                  (unsigned long)flowControlLatencyUs.percentile(lat, 0.99f), (unsigned long)lat.max,
+                  (unsigned long)flowControlOverruns.value(), (unsigned)GS_FLOW_LATENCY_BUDGET_US);
 }
 
-lv_obj_t *ui_cartext = nullptr;
+static ConsoleCommand pumpCommand("pump", "", "Pump output stage, flow controller, packet → power latency", cmdPump);
+static ConsoleCommand touchCommand("touch", "", "Touch frames, noise model heatmap, button / gesture intents", cmdTouch);
+static ConsoleCommand touchCalCommand("touchcal", "[reset | <sx> <dx> <sy> <dy> | jump <6 px>]", "Touch transform, per-unit correction", cmdTouchCal);
+static ConsoleCommand lvglCommand("lvgl", "LVGL pool use / fragmentation", lvglHeapDump);
+static ConsoleCommand watchdogCommand("watchdog", "Subsystem deadlines, closest calls, misses", watchdogDump);
+static ConsoleCommand otaCommand("ota", "App slots, image on trial, last update", otaDump);
+static ConsoleCommand bleMaintCommand("blemaint", "BLE update / settings channel: client, progress, NACKs", bleMaintDump);
+static ConsoleCommand heapCommand("heap", "", "Free / minimum free heap, largest block, buffers per owner", cmdHeap);
+static ConsoleCommand logCommand("log", "", "Log ring counters (+ WebSerial sampling in debug builds)", cmdLog);
+static ConsoleCommand restartCommand("restart", "", "Flush settings + log, reboot", cmdRestart);
+static ConsoleCommand bleCommand("ble", "[reconnect]", "Scale link state and candidates; drop the link and connect again", cmdBle);
+static ConsoleCommand benchCommand("bench", "<mem|render|metrics|console|kernels>", "Copy / fill MB/s, per-object redraw cost, metrics render, command parse, kernel cycles", cmdBench);
+
+// USB serial console - runs in the log drain task (see logRingSetCommandHandler)
+static void handleSerialCommand(const char *line)
+{
+  if (configImportSerialLine(line, Serial))   // Document lines after "config import"
+    return;
+  consoleExecute(CONSOLE_SERIAL, line, strlen(line), Serial);
+}
 
 // -----------------------------------------------------------------------------
 // Helper Utilities
 // -----------------------------------------------------------------------------
 
 // UI Update Queue Functions (Professional Thread-Safe Pattern)
-// BLE task (Core 0) enqueues UI updates, Main loop (Core 1) dequeues and updates LVGL
+// BLE task (Core 0) enqueues UI updates, UI task (Core 1) dequeues and updates LVGL
 
 /**
- * @brief Enqueue a UI update message (thread-safe, non-blocking)
- * @param type Type of UI update (weight, timer, status, connection)
- * @param text Text to display (for weight, timer, status updates)
- * @note Called from BLE task (Core 0) - never touches LVGL directly!
+ * @brief Set the status label of the screen being shown (Core 1 only)
+ * @param changed statusLine.shown() has new text
+ *
+ * Only the visible label is written; the other one catches up when its
+ * screen is loaded (syncShownScreen()). History / picker screens have no
+ * status line.
  */
-static inline void queueUIUpdate(UIUpdateType type, const char* text) {
-    UIUpdateMessage msg;
-    msg.type = type;
-    msg.boolValue = false;
-
-    if (text) {
-        strncpy(msg.text, text, sizeof(msg.text) - 1);
-        msg.text[sizeof(msg.text) - 1] = '\0';  // Ensure null termination
-    } else {
-        msg.text[0] = '\0';
-    }
-
-    // Non-blocking send - if queue is full, drop the message (UI updates are non-critical)
-    xQueueSend(uiUpdateQueue, &msg, 0);
+static void renderStatusLine(bool changed) {
+    if (changed)
+        statusMirror.changed();
+    lv_obj_t *label = statusMirror.target();
+    if (label != NULL)
+        lv_label_set_text_static(label, statusLine.shown());
 }
 
 /**
- * @brief Enqueue a connection status update (thread-safe, non-blocking)
- * @param connected true if scale is connected, false otherwise
- * @note Called from BLE task (Core 0) - never touches LVGL directly!
+ * @brief Enable / grey out the Bluetooth icon of the screen being shown (Core 1 only)
  */
-static inline void queueConnectionUpdate(bool connected) {
-    UIUpdateMessage msg;
-    msg.type = UI_UPDATE_CONNECTION;
-    msg.boolValue = connected;
-    msg.text[0] = '\0';
+static void renderBluetoothIcon() {
+    lv_obj_t *icon = bluetoothMirror.target();
+    if (icon != NULL)
+        _ui_state_modify(icon, LV_STATE_DISABLED, bluetoothShown ? _UI_MODIFY_STATE_REMOVE : _UI_MODIFY_STATE_ADD);
+}
 
-    xQueueSend(uiUpdateQueue, &msg, 0);
+/**
+ * @brief One-shot sync of the screen just loaded (screen_nav.h load handler)
+ * @note Runs before the first frame of `screen`: no stale status text, icon or values
+ */
+static void syncShownScreen(lv_obj_t *screen) {
+    (void)screen;  // The mirrors and bindings look at lv_scr_act()
+    uint32_t now = millis();
+    renderStatusLine(false);
+    renderBluetoothIcon();
+    weightLabel.service(now);
+    timerLabel.service(now);
 }
 
 /**
- * @brief Process pending UI updates from the queue (LVGL-safe, Core 1 only)
- * @note Called from main loop (Core 1) - ONLY place that updates LVGL!
- * @note CRITICAL: Limits processing to prevent watchdog timeout
+ * @brief Apply dirty UI channel fields to LVGL (LVGL-safe, Core 1 only)
+ * @note Called from the UI task (Core 1) - ONLY place that updates LVGL!
+ * @note Weight / timer text is formatted by their bindings, once per visible change, never on the BLE core
  */
 static void processUIUpdates() {
-    UIUpdateMessage msg;
-
-    // CRITICAL FIX: Limit messages processed per loop iteration to prevent watchdog timeout
-    // At 10Hz weight updates, we get ~10 messages/sec. Main loop runs at ~100Hz (10ms).
-    // Process max 5 messages per iteration = 50ms worst case (well under 10s watchdog)
-    const int MAX_MESSAGES_PER_ITERATION = 5;
-    int processedCount = 0;
-
-    // Process pending messages (non-blocking, with limit)
-    while (processedCount < MAX_MESSAGES_PER_ITERATION &&
-           xQueueReceive(uiUpdateQueue, &msg, 0) == pdTRUE) {
-        switch (msg.type) {
-            case UI_UPDATE_WEIGHT:
-                if (ui_ScaleLabel) {
-                    // CRITICAL FIX: Use lv_label_set_text_static() to prevent LVGL realloc bug
-                    // Copy to persistent buffer first, then reference that buffer (never goes out of scope)
-                    strncpy(weightDisplayBuffer, msg.text, sizeof(weightDisplayBuffer) - 1);
-                    weightDisplayBuffer[sizeof(weightDisplayBuffer) - 1] = '\0';
-                    lv_label_set_text_static(ui_ScaleLabel, weightDisplayBuffer);
-                } else {
-                    LOG_WARN(TAG_UI, "ui_ScaleLabel is NULL, cannot update weight");
-                }
-                break;
-
-            case UI_UPDATE_TIMER:
-                if (ui_TimerLabel) {
-                    // CRITICAL FIX: Use lv_label_set_text_static() to prevent LVGL realloc bug
-                    strncpy(timerDisplayBuffer, msg.text, sizeof(timerDisplayBuffer) - 1);
-                    timerDisplayBuffer[sizeof(timerDisplayBuffer) - 1] = '\0';
-                    lv_label_set_text_static(ui_TimerLabel, timerDisplayBuffer);
-                } else {
-                    LOG_WARN(TAG_UI, "ui_TimerLabel is NULL, cannot update timer");
-                }
-                break;
-
-            case UI_UPDATE_STATUS:
-                if (ui_SerialLabel && ui_SerialLabel1) {
-                    // CRITICAL FIX: Use lv_label_set_text_static() to prevent LVGL realloc bug
-                    strncpy(statusDisplayBuffer, msg.text, sizeof(statusDisplayBuffer) - 1);
-                    statusDisplayBuffer[sizeof(statusDisplayBuffer) - 1] = '\0';
-                    lv_label_set_text_static(ui_SerialLabel, statusDisplayBuffer);
-                    lv_label_set_text_static(ui_SerialLabel1, statusDisplayBuffer);
-
-                    // Also update local status text for consistency
-                    strncpy(currentStatusText, msg.text, sizeof(currentStatusText) - 1);
-                    currentStatusText[sizeof(currentStatusText) - 1] = '\0';
-                } else {
-                    LOG_WARN(TAG_UI, "ui_SerialLabel is NULL, cannot update status");
-                }
-                break;
-
-            case UI_UPDATE_CONNECTION:
-                if (ui_BluetoothImage1 && ui_BluetoothImage2) {
-                    if (msg.boolValue) {  // Connected
-                        _ui_state_modify(ui_BluetoothImage1, LV_STATE_DISABLED, _UI_MODIFY_STATE_REMOVE);
-                        _ui_state_modify(ui_BluetoothImage2, LV_STATE_DISABLED, _UI_MODIFY_STATE_REMOVE);
-                    } else {  // Disconnected
-                        _ui_state_modify(ui_BluetoothImage1, LV_STATE_DISABLED, _UI_MODIFY_STATE_ADD);
-                        _ui_state_modify(ui_BluetoothImage2, LV_STATE_DISABLED, _UI_MODIFY_STATE_ADD);
-                    }
-                }
-                break;
+    UIChannelSnapshot state;
+    if (!uiChannelTake(&state))
+        return;
+
+    uint32_t startUs = micros();
+    uint32_t now = millis();
+    char text[UI_STATUS_TEXT_LEN];
+
+    if (state.dirty & UI_DIRTY_WEIGHT) {
+        if (ui_ScaleLabel) {
+            // CRITICAL FIX: The binding sets its own persistent text (lv_label_set_text_static) to prevent LVGL realloc bug
+            weightTrack.note(state.weight, state.weightFlow, state.weightSampleUs);
+            weightLabel.set(weightTrack.at(esp_timer_get_time()), now);
+        } else {
+            LOG_WARN(TAG_UI, "ui_ScaleLabel is NULL, cannot update weight");
         }
-        processedCount++;
     }
-}
 
-static inline void setStatusLabels(const char *text)
-{
-  if (strcmp(currentStatusText, text) == 0)  // Fixed: proper string comparison
-    return;
+    if (state.dirty & UI_DIRTY_TIMER) {
+        if (ui_TimerLabel && shotClockTimer) {
+            if (state.timerRunning) {
+                shotClockStartUs = state.timerStartUs;
+                lv_timer_resume(shotClockTimer);
+                lv_timer_ready(shotClockTimer);  // "0.0" on the next frame
+            } else {
+                lv_timer_pause(shotClockTimer);
+                timerLabel.set(state.timer, now);
+            }
+        } else {
+            LOG_WARN(TAG_UI, "ui_TimerLabel is NULL, cannot update timer");
+        }
+    }
 
-  // PROFESSIONAL FIX: Use message queue for thread-safe UI updates
-  // BLE task (Core 0) enqueues message, main loop (Core 1) dequeues and updates LVGL
-  // This is the industry-standard pattern for LVGL multi-threading
-  queueUIUpdate(UI_UPDATE_STATUS, text);
+    if (state.dirty & UI_DIRTY_STATUS) {
+        // Highest priority first: what it displaces or holds back is the scheduler's call
+        bool changed = false;
+        for (int p = STATUS_PRIORITY_COUNT - 1; p >= 0; p--) {
+            if (!(state.dirty & uiDirtyStatus((StatusPriority)p)))
+                continue;
+            const UIStatusSlot &slot = state.status[p];
+            if (slot.format != NULL) {
+                snprintf(text, sizeof(text), slot.format, slot.value, slot.value2);
+            } else {
+                strncpy(text, slot.text, sizeof(text) - 1);
+                text[sizeof(text) - 1] = '\0';
+            }
+            changed |= statusLine.offer(slot.id, text, now);
+        }
+        renderStatusLine(changed);
+    }
 
-  // Keep local copy for comparison (prevents duplicate queue messages)
-  strncpy(currentStatusText, text, sizeof(currentStatusText) - 1);
-  currentStatusText[sizeof(currentStatusText) - 1] = '\0';
+    if (state.dirty & UI_DIRTY_CONNECTION) {
+        bluetoothShown = state.connected;
+        bluetoothMirror.changed();
+        renderBluetoothIcon();
+    }
+    uiApplyUs.record(micros() - startUs);
 }
 
-static inline void queueScaleStatus(const char *text)
-{
-  if (isFlushing)
-  {
-    strncpy(pendingScaleStatus, text, sizeof(pendingScaleStatus) - 1);  // Fixed: safe string copy
-    pendingScaleStatus[sizeof(pendingScaleStatus) - 1] = '\0';  // Ensure null termination
-    hasPendingScaleStatus = true;
-  }
-  else
-  {
-    setStatusLabels(text);
-    hasPendingScaleStatus = false;
-  }
+/**
+ * @brief Shot clock on the UI core (LVGL timer, Core 1)
+ *
+ * Counts from the start time the control task posted once, so the timer
+ * label needs no cross-core traffic while it runs. Its period follows the
+ * frame pacer, and being younger than the display refresh timer it runs
+ * just before the refresh in the same lv_timer_handler() pass: the label
+ * changes on frame boundaries instead of whenever a message arrived.
+ */
+static void shotClockTick(lv_timer_t *timer) {
+    timerLabel.set(monoElapsedS(shotClockStartUs), millis());
+    uint32_t period = framePacerPeriodMs();
+    if (period != 0 && timer->period != period)
+        lv_timer_set_period(timer, period);
+}
+
+/**
+ * @brief Apply label values the gates held back for rate limiting (Core 1 only)
+ * @return Milliseconds until the next held value is due (UINT32_MAX = none held)
+ */
+static uint32_t serviceLabelGates() {
+    uint32_t now = millis();
+    int64_t nowUs = esp_timer_get_time();
+
+    // Between packets of a shot: the projected weight, redrawn when its tenth changes
+    bool projecting = weightTrack.projecting(nowUs);
+    if (projecting)
+        weightLabel.set(weightTrack.at(nowUs), now);
+    weightLabel.service(now);
+    timerLabel.service(now);
+    renderStatusLine(statusLine.service(now));
+
+    uint32_t dueMs = weightLabel.dueInMs(now);
+    if (projecting)
+        dueMs = min(dueMs, framePacerPeriodMs());  // Next frame
+    dueMs = min(dueMs, timerLabel.dueInMs(now));
+    dueMs = min(dueMs, statusLine.dueInMs(now));
+    return dueMs;
 }
 
-static float seconds_f()
+/**
+ * @brief Post a status message (any task); the UI task schedules it by its ID's policy
+ */
+static inline void setStatusLabels(StatusId id, const char *text)
 {
-  return millis() / 1000.0f;
+  uiChannelSetStatus(id, text);
 }
 
 /**
- * @brief Update display refresh rate based on activity level
- * @param active_shot true during espresso shots, false when idle
- *
- * Dynamically adjusts LVGL refresh timer to optimize performance and power:
- * - Fast mode (60Hz = 16ms): During shots for smooth weight updates
- * - Slow mode (30Hz = 33ms): When idle for power savings
+ * @brief Status message with numeric arguments, formatted on the UI task
+ * @param format String literal with one float conversion (two with value2)
  */
-static void updateDisplayRefreshRate(bool active_shot)
+static inline void setStatusLabelsValue(StatusId id, const char *format, float value, float value2 = 0.0f)
 {
-  // SAFETY: Validate LVGL is initialized before accessing display
-  // If called before lv_init() completes, lv_disp_get_default() returns NULL
-  lv_disp_t *display = lv_disp_get_default();
-  if (!display) {
-    LOG_WARN(TAG_UI, "updateDisplayRefreshRate() called before LVGL init - skipping");
-    return;
-  }
+  uiChannelSetStatusValues(id, format, value, value2);
+}
 
-  lv_timer_t *refresh_timer = _lv_disp_get_refr_timer(display);
-  if (!refresh_timer) {
-    LOG_WARN(TAG_UI, "Display refresh timer not available - skipping");
-    return;
-  }
+// Seconds into the running shot - exact at any uptime (mono_time.h)
+static float shotSeconds(MonoUs at)
+{
+  return monoElapsedS(shot.start_us, at);
+}
 
-  if (active_shot)
-  {
-    // Fast refresh during shot (16ms = 60Hz) for smooth weight updates
-    lv_timer_set_period(refresh_timer, 16);
-    LOG_DEBUG(TAG_UI, "Display: 60Hz (fast mode)");
-  }
-  else
-  {
-    // Normal refresh when idle (33ms = 30Hz) to save CPU/power
-    lv_timer_set_period(refresh_timer, 33);
-    LOG_DEBUG(TAG_UI, "Display: 30Hz (normal mode)");
-  }
+static float shotSeconds()
+{
+  return shotSeconds(monoNowUs());
 }
 
 /**
- * @brief Update shot timer display independently every 0.1 second
+ * @brief Advance shot.shotTimer every 0.1 second for the watchdogs
  *
- * This function runs on its own millis-based schedule, independent of scale
- * BLE notifications. Ensures smooth timer progression even when scale sends
- * infrequent weight updates.
+ * Runs on its own millis-based schedule, independent of scale BLE
+ * notifications. The timer label is not fed from here: the UI task runs its
+ * own shot clock from the start time (shotClockTick()).
  */
 static void updateShotTimer()
 {
@@ -537,165 +914,156 @@ static void updateShotTimer()
   // Update timer display every 100ms (0.1 second)
   if (now - lastTimerUpdate >= TIMER_UPDATE_INTERVAL_MS)
   {
-    shot.shotTimer = seconds_f() - shot.start_timestamp_s;
-
-    // PROFESSIONAL FIX: Use message queue for thread-safe UI updates
-    // BLE task (Core 0) enqueues timer text, main loop (Core 1) updates LVGL
-    char buffer[10];
-    dtostrf(shot.shotTimer, 5, 1, buffer);
-    queueUIUpdate(UI_UPDATE_TIMER, buffer);
-
+    shot.shotTimer = shotSeconds();
     lastTimerUpdate = now;
   }
 }
 
-/**
- * @brief Non-blocking BLE command sequencer for shot start
- *
- * Sequence: resetTimer → [100ms] → tare → [100ms] → startTimer → pump ON
- * Runs in loop() without blocking. Uses millis-based timing like handleFlushingCycle().
- */
-static void handleBLESequence()
+// Shot start: [resetTimer, tare, startTimer] → tare confirmed (or 300ms) → pump ON
+// The three commands go out back to back; the scale's own notifications
+// (key event or zeroed weight) confirm the tare instead of fixed delays.
+// A cup that cup_detect.h already tared skips the tare and the wait:
+// [resetTimer, startTimer] → pump ON.
+static bool bleSequencePreTared = false;
+
+static CommandStepResult bleStepSendBatch(uint32_t)
 {
-  unsigned long now = millis();
+  bleSequencePreTared = cupDetectTakePrimed();
+  LOG_DEBUG(TAG_SHOT, "BLE: Sending RESET + %sSTART", bleSequencePreTared ? "" : "TARE + ");
+  startLatencyMark(START_HOP_DISPATCH);
+  if (!scale.sendShotStart(!bleSequencePreTared))
+    return SCRIPT_FAIL;
+  if (bleSequencePreTared)
+    LOG_INFO(TAG_SHOT, "☕ Cup already tared - no tare wait");
+  return SCRIPT_NEXT;
+}
 
-  switch (bleSequenceState)
+static CommandStepResult bleStepAwaitTare(uint32_t stepMs)
+{
+  // Notifications wake the BLE task; updateScaleReadings() feeds the confirmation
+  if (bleSequencePreTared)
+    return SCRIPT_NEXT;
+  if (scale.shotStartConfirmed())
   {
-    case BLE_IDLE:
-      // Nothing to do - waiting for shot start trigger
-      break;
-
-    case BLE_SEND_RESET:
-      LOG_DEBUG(TAG_SHOT, "BLE: Sending RESET");
-      if (!scale.resetTimer())
-      {
-        queueScaleStatus("Scale reset failed");
-        bleSequenceState = BLE_IDLE;
-        bleSequenceInProgress = false;
-        shot.brewing = false;
-        // scale.setIsBrewing(false);  // ArduinoBLE doesn't have this method
-        isFlushing = false;
-        return;
-      }
-      bleSequenceTimestamp = now;
-      bleSequenceState = BLE_WAIT_AFTER_RESET;
-      break;
-
-    case BLE_WAIT_AFTER_RESET:
-      // Non-blocking wait for 100ms
-      if (now - bleSequenceTimestamp >= BLE_COMMAND_DELAY_MS)
-      {
-        bleSequenceState = BLE_SEND_TARE;
-      }
-      break;
+    LOG_DEBUG(TAG_SHOT, "BLE: Tare confirmed after %lums", (unsigned long)stepMs);
+    return SCRIPT_NEXT;
+  }
+  if (stepMs >= BLE_CONFIRM_TIMEOUT_MS)
+    LOG_WARN(TAG_SHOT, "BLE: No tare confirmation after %lums - starting anyway", (unsigned long)stepMs);
+  return SCRIPT_WAIT;
+}
 
-    case BLE_SEND_TARE:
-      LOG_DEBUG(TAG_SHOT, "BLE: Sending TARE");
-      if (!scale.tare())
-      {
-        queueScaleStatus("Scale tare failed");
-        if (scale.isConnected())
-        {
-          scale.stopTimer();
-        }
-        setRelayState(false);
-        bleSequenceState = BLE_IDLE;
-        bleSequenceInProgress = false;
-        shot.brewing = false;
-        // scale.setIsBrewing(false);  // ArduinoBLE doesn't have this method
-        isFlushing = false;
-        return;
-      }
-      bleSequenceTimestamp = now;
-      bleSequenceState = BLE_WAIT_AFTER_TARE;
-      break;
+static CommandStepResult bleStepStartTimer(uint32_t)
+{
+  LOG_DEBUG(TAG_SHOT, "BLE: Sending START");
+  return scale.startTimer() ? SCRIPT_NEXT : SCRIPT_FAIL;
+}
 
-    case BLE_WAIT_AFTER_TARE:
-      // Non-blocking wait for 100ms
-      if (now - bleSequenceTimestamp >= BLE_COMMAND_DELAY_MS)
-      {
-        bleSequenceState = BLE_SEND_START;
-      }
-      break;
+static CommandStepResult bleStepArmShot(uint32_t)
+{
+  startLatencyMarkAt(START_HOP_ACK_RESET, scale.shotStartAckUs(SCALE_CMD_RESET_TIMER));
+  startLatencyMarkAt(START_HOP_ACK_TARE, scale.shotStartAckUs(SCALE_CMD_TARE));
+  startLatencyMarkAt(START_HOP_ACK_START, scale.shotStartAckUs(SCALE_CMD_START_TIMER));
+  // Timer is now running - the control task (higher priority, same core) runs
+  // armShot() before this task continues: timestamp, shot model, pump on
+  shotArmPending = true;
+  controlTaskNotify(CONTROL_EVT_SHOT);
+  LOG_INFO(TAG_SHOT, "Shot started successfully!");
+  return SCRIPT_NEXT;
+}
 
-    case BLE_SEND_START:
-      LOG_DEBUG(TAG_SHOT, "BLE: Sending START");
-      if (!scale.startTimer())
-      {
-        queueScaleStatus("Scale timer failed");
-        bleSequenceState = BLE_IDLE;
-        bleSequenceInProgress = false;
-        shot.brewing = false;
-        // scale.setIsBrewing(false);  // ArduinoBLE doesn't have this method
-        isFlushing = false;
-        return;
-      }
-      bleSequenceState = BLE_START_SHOT;
-      break;
+/**
+ * @brief The one failure path of every sequence: nothing half-started stays on
+ */
+static void bleSequenceFailed(const CommandScript &script, const CommandStep &step)
+{
+  LOG_WARN(TAG_SHOT, "BLE: %s failed at \"%s\"", script.name, step.name);
+  startLatencyAbort();
+  if (step.failStatus != NULL)
+    setStatusLabels(STATUS_COMMAND, step.failStatus);
+  setRelayState(false);
+  bleSequenceInProgress = false;
+  shot.brewing = false;
+  cleanProgramStop();
+}
 
-    case BLE_START_SHOT:
-      // Timer is now running - capture timestamp and turn on pump
-      shot.start_timestamp_s = seconds_f();
-      shot.shotTimer = 0.0f;
-      shot.datapoints = 0;
-      lastTimerUpdate = millis();
+static void bleSequenceDone(const CommandScript &)
+{
+  bleSequenceInProgress = false;
+}
 
-      // NOW set shot.brewing to true after all BLE commands succeeded
-      shot.brewing = true;
-      bleSequenceInProgress = false;
+static const CommandStep BLE_SHOT_START_STEPS[] = {
+  { "send",    bleStepSendBatch, 0,                      SCRIPT_FAIL, "Scale tare failed" },
+  { "confirm", bleStepAwaitTare, BLE_CONFIRM_TIMEOUT_MS, SCRIPT_NEXT, NULL },
+  { "arm",     bleStepArmShot,   0,                      SCRIPT_FAIL, NULL },
+};
+static const CommandScript BLE_SHOT_START_SCRIPT = {
+  "shot start", BLE_SHOT_START_STEPS, 3, bleSequenceFailed, bleSequenceDone
+};
 
-      LOG_INFO(TAG_SHOT, "BLE: Starting shot - turning ON pump");
-      setRelayState(true);              // Turn ON pump (relay)
-      // REMOVED: updateDisplayRefreshRate() - LVGL call unsafe from Core 0
-      // Now handled by Core 1 main loop polling shot.brewing state
+// Start timer only (BLE_CMD_START_TIMER): the scale is already zeroed
+static const CommandStep BLE_TIMER_START_STEPS[] = {
+  { "start", bleStepStartTimer, 0, SCRIPT_FAIL, "Scale timer failed" },
+  { "arm",   bleStepArmShot,    0, SCRIPT_FAIL, NULL },
+};
+static const CommandScript BLE_TIMER_START_SCRIPT = {
+  "timer start", BLE_TIMER_START_STEPS, 2, bleSequenceFailed, bleSequenceDone
+};
 
-      // Enable weight logging during shots
-      // scale.setIsBrewing(true);  // ArduinoBLE doesn't have this method
+/**
+ * @brief Hand a sequence to the BLE task (any task); replaces one in flight
+ */
+static void bleSequenceRequest(const CommandScript *script)
+{
+  bleSequenceInProgress = true;
+  bleScriptRequest = script;
+  bleTaskNotify(BLE_EVT_SEQUENCER);
+}
 
-      bleSequenceState = BLE_IDLE;
-      LOG_INFO(TAG_SHOT, "Shot started successfully!");
-      break;
-  }
+/**
+ * @brief Start a requested sequence and run it as far as it goes (BLE task)
+ */
+static void handleBLESequence()
+{
+  uint32_t now = millis();
+  const CommandScript *requested = bleScriptRequest.exchange(NULL);
+  if (requested != NULL)
+    bleSequencer.start(requested, now);
+  bleSequencer.poll(now);
 }
 
 static void setBrewingState(bool brewing)
 {
   if (brewing)
   {
-    if (isFlushing)
-    {
+    if (cleanProgramStop())
       LOG_INFO(TAG_SHOT, "Flushing cancelled due to brew start");
-      setRelayState(false);
-      isFlushing = false;
-    }
 
     if (!scale.isConnected())
     {
-      queueScaleStatus("Scale not connected");
+      setStatusLabels(STATUS_COMMAND, "Scale not connected");
       shot.brewing = false;
       // scale.setIsBrewing(false);  // ArduinoBLE doesn't have this method
-      isFlushing   = false;
+      cleanProgramStop();
       return;
     }
 
     LOG_INFO(TAG_SHOT, "Shot start requested - triggering BLE sequence");
 
     // Trigger non-blocking BLE command sequence
-    // Sequence: reset → tare → start → pump ON (handled by handleBLESequence)
-    bleSequenceInProgress = true;
-    bleSequenceState = BLE_SEND_RESET;
-    // Note: shot.brewing will be set to true in BLE_START_SHOT state after commands complete
+    // Sequence: reset + tare + start → confirmed → pump ON (BLE_SHOT_START_SCRIPT)
+    bleSequenceRequest(&BLE_SHOT_START_SCRIPT);
   }
   else
   {
     LOG_INFO(TAG_SHOT, "ShotEnded");
-    shot.end_s = seconds_f() - shot.start_timestamp_s;
+    shot.end_s = shotSeconds();
     if (scale.isConnected())
     {
       scale.stopTimer();
     }
+    profileRunner.stop();
     setRelayState(false);
-    updateDisplayRefreshRate(false);  // Switch back to normal refresh (30Hz) when idle
   }
 }
 
@@ -704,12 +1072,16 @@ static void stopBrew(bool setDefaultStatus, ShotEndReason reason = USER_STOPPED)
   bool wasBrewing = shot.brewing;
 
   shot.brewing = false;
-  isFlushing   = false;
+  cleanProgramStop();
   shot.endReason = reason;
   lastTimerUpdate = 0;  // Reset timer update tracking
+  if (wasBrewing)
+  {
+    crashRingRecord(CRASH_EV_SHOT_END, (uint16_t)reason);
+    uiChannelSetTimer(shotSeconds());  // UI shot clock stops here
+  }
 
   setBrewingState(false);
-  updateDisplayRefreshRate(false);  // Switch back to normal refresh (30Hz) when stopped
 
   // Disable weight logging (return to silent idle mode)
   // scale.setIsBrewing(false);  // ArduinoBLE doesn't have this method
@@ -719,21 +1091,24 @@ static void stopBrew(bool setDefaultStatus, ShotEndReason reason = USER_STOPPED)
     // Display appropriate message based on end reason
     switch(reason) {
       case WEIGHT_ACHIEVED:
-        setStatusLabels("Shot ended - Weight achieved");
+        setStatusLabels(STATUS_SHOT_END, "Shot ended - Weight achieved");
         break;
       case TIME_EXCEEDED:
-        setStatusLabels("Shot ended - Max time");
+        setStatusLabels(STATUS_SHOT_END, "Shot ended - Max time");
         break;
       case BUTTON_PRESSED:
-        setStatusLabels("Shot ended - Button pressed");
+        setStatusLabels(STATUS_SHOT_END, "Shot ended - Button pressed");
         break;
       case SCALE_DISCONNECTED:
-        setStatusLabels("Shot ended - Scale disconnected");
+        setStatusLabels(STATUS_SHOT_END, "Shot ended - Scale disconnected");
+        break;
+      case FLOW_ANOMALY:
+        setStatusLabels(STATUS_SHOT_END, "Shot ended - Flow anomaly");
         break;
       case USER_STOPPED:
       case UNDEFINED:
       default:
-        setStatusLabels("Shot ended");
+        setStatusLabels(STATUS_SHOT_END, "Shot ended");
         break;
     }
   }
@@ -746,199 +1121,189 @@ static void startBrew()
     return;
   }
 
-  isFlushing = false;
+  cleanProgramStop();
 
   // CRITICAL FIX: Reset shotTimer BEFORE setting brewing=true
   // Otherwise old timer value from previous shot triggers "Max brew duration" immediately
   // during the BLE command sequence (reset→tare→start takes ~300ms)
   shot.shotTimer = 0.0f;
-  shot.datapoints = 0;
+  if (shotLogDue)
+    logFinishedShot();  // Restarted within the drip delay - log what we have
+  resetShotModel();
+  shotLogDue = true;
 
   shot.brewing = true;
+  controlTaskNotify(CONTROL_EVT_SHOT);
   setBrewingState(true);
+  crashRingRecord(CRASH_EV_SHOT_START);
 }
 
 static void calculateEndTime(Shot *s)
 {
-  if ((s->datapoints < N) || (s->weight[s->datapoints - 1] < 10))
-  {
-    s->expected_end_s = MAX_SHOT_DURATION_S;
-    return;
-  }
-
-  float sumXY = 0.0f;
-  float sumX  = 0.0f;
-  float sumY  = 0.0f;
-  float sumSquaredX = 0.0f;
-
-  for (int i = s->datapoints - N; i < s->datapoints; i++)
-  {
-    sumXY += s->time_s[i] * s->weight[i];
-    sumX  += s->time_s[i];
-    sumY  += s->weight[i];
-    sumSquaredX += s->time_s[i] * s->time_s[i];
-  }
+  s->expected_end_s = s->predictor.expectedEnd(goalWeight, weightOffset, stopModelLatencyS());
+}
 
-  float m = (N * sumXY - sumX * sumY) / (N * sumSquaredX - (sumX * sumX));
-  float meanX = sumX / N;
-  float meanY = sumY / N;
-  float b = meanY - m * meanX;
+// Pump wanted by the running shot's profile stage (a flush / backflush drives the relay itself);
+// a relay-only output time-proportions reduced power on the relay
+static bool relayWanted()
+{
+  return shot.brewing && profileRunner.relayOn() && pumpOutputGate(monoNowUs());
+}
 
-  // Handle negative or near-zero slope - prevents infinite/absurd predictions
-  if (m < 0.001f)
+/**
+ * @brief One flow controller step for the sample that arrived at arrivalUs (control task)
+ *
+ * Stages with a target flow get the power that holds it; anywhere else the
+ * pump runs at full power. Arrival → applied is the control latency.
+ */
+static void GS_HOT_IRAM flowControlStep(int64_t arrivalUs)
+{
+  float target = (shot.brewing && profileRunner.running()) ? profileRunner.targetFlowGs() : 0.0f;
+  if (target <= 0.0f)
   {
-    s->expected_end_s = MAX_SHOT_DURATION_S;
+    if (flowController.active())
+    {
+      flowController.reset();
+      pumpOutputSetPower(1.0f);
+    }
     return;
   }
 
-  // Calculate expected end time
-  float expected = (goalWeight - weightOffset - b) / m;
-
-  // Clamp to reasonable bounds (prevents UI showing nonsensical predictions)
-  if (expected < MIN_SHOT_DURATION_S) expected = MIN_SHOT_DURATION_S;
-  if (expected > MAX_SHOT_DURATION_S) expected = MAX_SHOT_DURATION_S;
-
-  s->expected_end_s = expected;
+  const ShotPredictor &p = shot.predictor;
+  pumpOutputSetPower(flowController.update(target, p.filter.flow(), shot.shotTimer, p.onset.dripped()));
+  uint32_t latencyUs = (uint32_t)(esp_timer_get_time() - arrivalUs);
+  flowControlLatencyUs.record(latencyUs);
+  if (latencyUs > GS_FLOW_LATENCY_BUDGET_US)
+    flowControlOverruns.add();
 }
 
+// Pin read-back at RELAY_VERIFY_MS; the wanted state itself is applied by setRelayState()
 static void enforceRelayState()
 {
-  bool shouldBeHigh = shot.brewing || isFlushing;
-  int  actualState   = digitalRead(RELAY1);
-
-  if (shouldBeHigh && actualState == LOW)
-  {
-    LOG_WARN(TAG_RELAY, "Relay corrected to HIGH");
-    setRelayState(true);
-  }
-  else if (!shouldBeHigh && actualState == HIGH)
-  {
-    LOG_WARN(TAG_RELAY, "Relay was HIGH unexpectedly, forcing LOW");
-    setRelayState(false);
-  }
-}
+  for (uint8_t g = 0; g < GS_GROUP_COUNT; g++)
+    relayControlVerify(g);
+}
 
 // -----------------------------------------------------------------------------
 // FreeRTOS Helper Functions - Safe Data Access
 // -----------------------------------------------------------------------------
 
-// Safe read from shared BLE data
+// Lock-free reads of shared BLE data (consistent snapshot, never blocks)
 float readCurrentWeight() {
-    float weight = 0;
-    if (xSemaphoreTake(bleDataMutex, pdMS_TO_TICKS(10))) {
-        weight = bleData.currentWeight;
-        xSemaphoreGive(bleDataMutex);
-    }
-    return weight;
+    return bleData.load().currentWeight;
 }
 
 bool readConnectionStatus() {
-    bool connected = false;
-    if (xSemaphoreTake(bleDataMutex, pdMS_TO_TICKS(10))) {
-        connected = bleData.isConnected;
-        xSemaphoreGive(bleDataMutex);
-    }
-    return connected;
+    return bleData.load().isConnected;
 }
 
 bool readConnectingStatus() {
-    bool connecting = false;
-    if (xSemaphoreTake(bleDataMutex, pdMS_TO_TICKS(10))) {
-        connecting = bleData.isConnecting;
-        xSemaphoreGive(bleDataMutex);
-    }
-    return connecting;
+    return bleData.load().isConnecting;
 }
 
-// Safe write to shared BLE data
+// Writes - BLE task (Core 0) only, never block
 void updateSharedWeight(float weight) {
-    if (xSemaphoreTake(bleDataMutex, pdMS_TO_TICKS(10))) {
-        bleData.currentWeight = weight;
-        bleData.lastWeightUpdate = millis();
-        xSemaphoreGive(bleDataMutex);
-    }
+    unsigned long now = millis();
+    bleData.update([&](BLESharedData &d) {
+        d.currentWeight = weight;
+        d.lastWeightUpdate = now;
+    });
+}
+
+void updateSharedPacketReceived() {
+    unsigned long now = millis();
+    bleData.update([&](BLESharedData &d) {
+        d.totalPacketsReceived++;
+        d.lastPacketTime = now;
+    });
 }
 
 void updateSharedConnectionStatus(bool connected, bool connecting) {
-    if (xSemaphoreTake(bleDataMutex, pdMS_TO_TICKS(10))) {
-        bleData.isConnected = connected;
-        bleData.isConnecting = connecting;
-        xSemaphoreGive(bleDataMutex);
-    }
+    bleData.update([&](BLESharedData &d) {
+        d.isConnected = connected;
+        d.isConnecting = connecting;
+    });
+}
+
+void updateSharedBattery(int percent) {
+    bleData.update([&](BLESharedData &d) {
+        d.batteryLevel = percent;
+    });
 }
 
 void updateSharedStatusMessage(const char* message) {
-    if (xSemaphoreTake(bleDataMutex, pdMS_TO_TICKS(10))) {
-        strncpy(bleData.statusMessage, message, sizeof(bleData.statusMessage) - 1);
-        bleData.statusMessage[sizeof(bleData.statusMessage) - 1] = '\0';
-        xSemaphoreGive(bleDataMutex);
-    }
+    bleData.update([&](BLESharedData &d) {
+        strncpy(d.statusMessage, message, sizeof(d.statusMessage) - 1);
+        d.statusMessage[sizeof(d.statusMessage) - 1] = '\0';
+    });
 }
 
-// Send command to BLE task
-bool sendBLECommand(BLECommand cmd, uint32_t param = 0) {
-    BLECommandMessage msg = {cmd, param};
-    return xQueueSend(bleCommandQueue, &msg, pdMS_TO_TICKS(100)) == pdTRUE;
+// Wake the BLE task (any core, never blocks)
+static void bleTaskNotify(uint32_t events) {
+    if (bleTaskHandle != NULL)
+        xTaskNotify(bleTaskHandle, events, eSetBits);
+}
+
+// Wake the shot control task (any task, never blocks)
+static void controlTaskNotify(uint32_t events) {
+    if (controlTaskHandle != NULL)
+        xTaskNotify(controlTaskHandle, events, eSetBits);
+}
+
+// Scale picker row tapped (UI task) - the switch runs on the BLE task
+static void onScalePicked(uint32_t param) {
+    if (!bleCommandSubmit(BLE_CMD_SELECT_SCALE, param))
+        LOG_WARN(TAG_UI, "⚠️  Scale selection dropped - command queue full");
 }
 
 // -----------------------------------------------------------------------------
 // Display & Touch Callbacks
 // -----------------------------------------------------------------------------
 
-// Display flush callback monitoring - tracks flush frequency for diagnostics
+// Display flush callback monitoring - counters live in displayDiag (display_diag.h)
 // NOTE: Flush only happens when UI changes (not continuous during idle - this is normal!)
 // Real freeze detection is done via lv_timer_handler() monitoring (see LVGLTimerHandlerRoutine)
-static unsigned long flushCallCount = 0;
-static unsigned long lastFlushTimestamp = 0;  // Track last flush time for UI health monitoring
+static unsigned long lastFlushTimestamp = 0;  // Last time the UI health check saw displayDiag.flushes move
 unsigned long lastTouchEvent = 0;  // Track last touch event for UI health monitoring (non-static for extern access)
 
-void my_disp_flush(lv_disp_drv_t *disp, const lv_area_t *area, lv_color_t *color_p)
+// Partial refresh: LVGL invalidates areas in landscape (UI_HOR_RES x UI_VER_RES)
+// coordinates; the transport widens them to its panel's window granularity.
+// Only the rounded areas are rendered and flushed.
+static void my_disp_rounder(lv_disp_drv_t *disp, lv_area_t *area)
 {
-  unsigned long now = millis();
-
-  flushCallCount++;
-
-  // Track last flush time for UI health monitoring
-  lastFlushTimestamp = now;
-
-  // ===== DIAGNOSTIC: PSRAM Buffer Integrity Check =====
-  // Check every 100 flushes to avoid performance impact
-  static uint32_t bufferIntegrityCheckCount = 0;
-  if (flushCallCount % 100 == 0) {
-    bufferIntegrityCheckCount++;
-
-    // Verify LVGL draw buffer pointers haven't been corrupted
-    if (disp != NULL && disp->draw_buf != NULL) {
-      lv_color_t* current_buf1 = (lv_color_t*)disp->draw_buf->buf1;
-      lv_color_t* current_buf2 = (lv_color_t*)disp->draw_buf->buf2;
-
-      // Check if buffers moved (indicates memory corruption)
-      if (buf_initial != NULL && current_buf1 != buf_initial) {
-        LOG_ERROR(TAG_UI, "🚨 BUFFER CORRUPTION! buf1 moved: %p → %p",
-                 buf_initial, current_buf1);
-      }
-      if (buf1_initial != NULL && current_buf2 != buf1_initial) {
-        LOG_ERROR(TAG_UI, "🚨 BUFFER CORRUPTION! buf2 moved: %p → %p",
-                 buf1_initial, current_buf2);
-      }
+  (void)disp;
+  displayTransport().round(area);
+}
 
-      // Log buffer status periodically
-      if (bufferIntegrityCheckCount % 10 == 0) {  // Every 1000 flushes
-        LOG_DEBUG(TAG_UI, "💾 Buffer Check #%lu: buf1=%p buf2=%p (OK)",
-                 bufferIntegrityCheckCount, current_buf1, current_buf2);
-      }
-    } else {
-      LOG_ERROR(TAG_UI, "🚨 Display driver structure is NULL!");
-    }
+/**
+ * @brief LVGL wait_cb - sleep until the DMA flush completes instead of spinning
+ * @note lcd_set_flush_notify_task() makes the driver notify the UI task when a
+ *       window is done. The 1-tick timeout is a safety net for flush_ready
+ *       paths that don't notify (dropped frames, setup() before the task exists).
+ */
+static void my_disp_wait(lv_disp_drv_t *disp)
+{
+  (void)disp;
+  ulTaskNotifyTake(pdTRUE, 1);
+}
 
-    // Verify color_p parameter isn't NULL
-    if (color_p == NULL) {
-      LOG_ERROR(TAG_UI, "🚨 color_p parameter is NULL in my_disp_flush!");
-      lv_disp_flush_ready(disp);
-      return;
-    }
+void my_disp_flush(lv_disp_drv_t *disp, const lv_area_t *area, lv_color_t *color_p)
+{
+  // HOT PATH: bounds checking + lcd_PushColorsLandscape() only. Counters go into
+  // displayDiag (lock-free, single writer); the DisplayDiag task does all reporting.
+  GS_TRACE_SCOPE("flush");
+  displayDiag.flushes++;
+  crashRingRecord(CRASH_EV_FLUSH_START, (uint16_t)(area->y2 - area->y1 + 1));
+  if (lvglInitialized && lv_disp_flush_is_last(disp)) {
+    bootMark(BOOT_FIRST_FRAME);  // UI frames only (not display_bench); a single load once recorded
+    startLatencyFrameFlushed();
+  }
+
+  if (color_p == NULL) {
+    displayDiag.rejectedAreas++;
+    lv_disp_flush_ready(disp);
+    return;
   }
-  // ===== END BUFFER INTEGRITY CHECK =====
 
   uint32_t w = (area->x2 - area->x1 + 1);
   uint32_t h = (area->y2 - area->y1 + 1);
@@ -947,544 +1312,172 @@ void my_disp_flush(lv_disp_drv_t *disp, const lv_area_t *area, lv_color_t *color
   // CRITICAL: Catch corrupted LVGL state BEFORE buffer overrun
   // If LVGL dirty area tracking is corrupted (from UI modification during render),
   // it may request flush of areas outside screen bounds → buffer overrun → heap corruption
-  if (area->x1 < 0 || area->x2 >= EXAMPLE_LCD_H_RES ||
-      area->y1 < 0 || area->y2 >= EXAMPLE_LCD_V_RES) {
+  if (area->x1 < 0 || area->x2 >= UI_HOR_RES ||
+      area->y1 < 0 || area->y2 >= UI_VER_RES) {
     LOG_ERROR(TAG_UI, "🚨 INVALID FLUSH AREA DETECTED - CORRUPTED LVGL STATE!");
     LOG_ERROR(TAG_UI, "   Requested: (%ld,%ld)-(%ld,%ld), Screen: (%d,%d)-(%d,%d)",
               area->x1, area->y1, area->x2, area->y2,
-              0, 0, EXAMPLE_LCD_H_RES-1, EXAMPLE_LCD_V_RES-1);
+              0, 0, UI_HOR_RES-1, UI_VER_RES-1);
     LOG_ERROR(TAG_UI, "   Aborting flush to prevent buffer overrun and heap corruption");
+    displayDiag.rejectedAreas++;
     lv_disp_flush_ready(disp);
     return;  // Abort this flush - prevent buffer overrun
   }
   // ===== END FLUSH BOUNDS VALIDATION =====
 
-  // ===== DIAGNOSTIC: Track Flush Duration =====
-  // Interrupt watchdog timeout is 3000ms - if flush takes >100ms, log warning
-  static unsigned long maxFlushDuration = 0;
-  unsigned long flushStartTime = millis();
-  // ===== END FLUSH DURATION TRACKING (START) =====
-
-  // ===== DIAGNOSTIC: Pixel Data Validation =====
-  // Log detailed flush information for first 5 flushes to diagnose blank display
-  static uint8_t flushDetailCount = 0;
-  if (flushDetailCount < 5) {
-    LOG_INFO(TAG_UI, "🔬 FLUSH #%d: area=(%ld,%ld)-(%ld,%ld) size=%lux%lu pixels=%lu",
-             flushDetailCount + 1,
-             area->x1, area->y1, area->x2, area->y2,
-             w, h, w * h);
-
-    // Sample first few pixels to verify data isn't all zeros
-    uint16_t* pixels = (uint16_t *)&color_p->full;
-    LOG_INFO(TAG_UI, "   First pixels: [0]=%04X [1]=%04X [2]=%04X [3]=%04X",
-             pixels[0], pixels[1], pixels[2], pixels[3]);
-
-    // Check if buffer contains any non-zero pixels
-    uint32_t totalPixels = w * h;
-    uint32_t nonZeroCount = 0;
-    for (uint32_t i = 0; i < totalPixels; i++) {
-      if (pixels[i] != 0) nonZeroCount++;
-    }
-    LOG_INFO(TAG_UI, "   Non-zero pixels: %lu of %lu (%.1f%%)",
-             nonZeroCount, totalPixels, (nonZeroCount * 100.0) / totalPixels);
-
-    flushDetailCount++;
-  }
-  // ===== END DIAGNOSTIC =====
-
-  // Log flush activity every 10 seconds for diagnostic purposes
-  // NOTE: Flush rate varies with UI activity (0 Hz when idle is normal)
-  static unsigned long lastFlushLog = 0;
-  if (now - lastFlushLog > 10000) {
-    LOG_DEBUG(TAG_UI, "🖼️  Display Flush: %lu calls in last 10s (~%lu Hz)",
-              flushCallCount, flushCallCount / 10);
-    flushCallCount = 0;
-    lastFlushLog = now;
-  }
-
-#ifdef LCD_SPI_DMA
-  char i = 0;
-  while (get_lcd_spi_dma_write())
-  {
-    i = i >> 1;
-    lcd_PushColors(0, 0, 0, 0, NULL);
-  }
+  int64_t flushStartUs = esp_timer_get_time();
+#if GS_DISPLAY_DIAG >= 2
+  displayDiagInspectFrame(area, (const uint16_t *)&color_p->full, w, h);
+#endif
+#if GS_DISPLAY_DIAG >= 1
+  displayDiag.pixels += w * h;
 #endif
-  lcd_PushColors(area->x1, area->y1, w, h, (uint16_t *)&color_p->full);
-
-  // ===== DIAGNOSTIC: Black Screen Detection =====
-  // Monitor pixel content to detect when screen goes black unexpectedly
-  static bool blackScreenDetected = false;
-  uint16_t* pixels = (uint16_t *)&color_p->full;
-
-  // Sample 100 pixels to check if buffer is predominantly black
-  uint32_t totalSamples = min(100u, w * h);
-  uint32_t blackCount = 0;
-  for (uint32_t i = 0; i < totalSamples; i++) {
-    if (pixels[i] == 0x0000) blackCount++;
-  }
-
-  // If >90% black pixels, log detailed diagnostic (once per black screen event)
-  if (blackCount > totalSamples * 0.9) {
-    if (!blackScreenDetected) {
-      blackScreenDetected = true;
-      LOG_ERROR(TAG_UI, "🚨 BLACK SCREEN DETECTED!");
-      LOG_ERROR(TAG_UI, "   Flush area: (%ld,%ld)-(%ld,%ld) = %lux%lu px",
-                area->x1, area->y1, area->x2, area->y2, w, h);
-      LOG_ERROR(TAG_UI, "   Sample: %lu/%lu pixels are black (%.1f%%)",
-                blackCount, totalSamples, (blackCount * 100.0) / totalSamples);
-      LOG_ERROR(TAG_UI, "   First 10 pixels: %04X %04X %04X %04X %04X %04X %04X %04X %04X %04X",
-                pixels[0], pixels[1], pixels[2], pixels[3], pixels[4],
-                pixels[5], pixels[6], pixels[7], pixels[8], pixels[9]);
-      LOG_ERROR(TAG_UI, "   Buffer pointer: %p (initial=%p %s)",
-                color_p, buf_initial, (color_p == buf_initial) ? "SAME" : "MOVED!");
-    }
-  } else {
-    blackScreenDetected = false;  // Reset when normal content resumes
-  }
-  // ===== END BLACK SCREEN DETECTION =====
-
-  // ===== DIAGNOSTIC: Track Flush Duration (END) =====
-  unsigned long flushDuration = millis() - flushStartTime;
-  if (flushDuration > maxFlushDuration) {
-    maxFlushDuration = flushDuration;
-    if (flushDuration > 100) {
-      LOG_WARN(TAG_UI, "⚠️  Display flush took %lums (max so far: %lums) - potential watchdog risk!",
-               flushDuration, maxFlushDuration);
-    }
-  }
-
-  // Log periodic stats every 100 flushes
-  static uint32_t flushCount = 0;
-  static unsigned long totalFlushTime = 0;
-  flushCount++;
-  totalFlushTime += flushDuration;
 
-  if (flushCount % 100 == 0) {
-    LOG_DEBUG(TAG_UI, "📊 Display flush stats: %lu flushes, avg=%lums, max=%lums",
-              flushCount, totalFlushTime / flushCount, maxFlushDuration);
+  // Non-blocking with the DMA transport: the window is queued and lv_disp_flush_ready()
+  // is issued from the SPI post-callback after the last chunk. LVGL never calls
+  // flush_cb while a flush is pending, so no busy-wait is needed here - it renders
+  // into the other draw buffer while this one streams out.
+  fbMirrorCapture(area, color_p, lv_disp_flush_is_last(disp));  // Remote screen mirror, while a client watches
+  watchdogCheckIn(WATCHDOG_DMA);  // Until flush_ready (watchdogIdle in the transport)
+  displayTransport().submit(area, color_p);
+
+  uint32_t flushUs = (uint32_t)(esp_timer_get_time() - flushStartUs);
+  flushCbUs.record(flushUs);
+#if GS_DISPLAY_DIAG >= 2
+  displayDiag.flushUsTotal += flushUs;
+  if (flushUs > displayDiag.flushUsMax) {
+    displayDiag.flushUsMax = flushUs;
   }
-  // ===== END FLUSH DURATION TRACKING (END) =====
-
-#ifdef LCD_SPI_DMA
-
-#else
-  lv_disp_flush_ready(disp);
 #endif
 }
 
-uint8_t read_touchpad_cmd[11] = {0xb5, 0xab, 0xa5, 0x5a, 0x0, 0x0, 0x0, 0x8};
-void my_touchpad_read(lv_indev_drv_t *indev_driver, lv_indev_data_t *data)
+/**
+ * @brief Apply one finished touch sample to LVGL input data
+ * @note Decoding and filtering already ran on the touch task (touch_pipeline.h);
+ *       what stays here needs UI task state - the wake and its guard time.
+ */
+static void touchpadApplySample(lv_indev_data_t *data, const TouchSample &sample)
 {
-  // CRITICAL: Special handling when display is asleep
+  data->point.x = 0;
+  data->point.y = 0;
+  data->state = LV_INDEV_STATE_REL;
+
   // Touch controller (CUSTOM PROTOCOL @ 0x3B, NOT standard CST816) has hardware interrupt pin
-  // that wakes us up. We need to detect the wake event and restore display, but NOT access I2C yet
+  // that wakes us up. Any sample while asleep means the touch INT fired - wake, report no touch
   if (displayAsleep)
   {
-    // Check if touch interrupt pin is active (indicates user touched screen)
-    // Touch controller INT pin pulls low on touch event
-    // For now, we'll wake on ANY call to this function during sleep
-    // (LVGL still polls even during sleep)
     LOG_INFO(TAG_UI, "=== WAKE EVENT: Touch detected during sleep ===");
-    LOG_INFO(TAG_UI, "Waking display and restoring backlight...");
-    lcd_wake();
-
-    // Note: Display controller and touch controller need time to stabilize
-    // We don't use delay() here (blocks main loop → watchdog timeout)
-    // Instead, the TOUCH_CONTROLLER_RECOVERY_MS check below handles this
-
-    // Restore backlight to saved brightness level
-    int LCDBrightness = map(brightness, 0, 100, 70, 256);
-    analogWrite(TFT_BL, LCDBrightness);
-    LOG_INFO(TAG_UI, "Display awake! Backlight=%d (brightness=%d%%)", LCDBrightness, brightness);
+    // Panel out of sleep if it was, one full refresh, backlight fades in after it
+    if (displayPowerWake())
+      touchInputHoldOff(TOUCH_CONTROLLER_RECOVERY_MS);  // Touch task stays off the bus meanwhile
 
     displayAsleep = false;
     lastWakeTime = millis();  // Record wake time to guard against phantom touches
     lastTouchTime = millis(); // Update touch time to prevent immediate re-sleep
-
-    // Return no-touch for this cycle (prevent phantom touch during wake)
-    data->point.x = 0;
-    data->point.y = 0;
-    data->state = LV_INDEV_STATE_REL;  // Released (no touch)
-    return;  // Skip I2C access this cycle - let controller stabilize
-  }
-
-  // CRITICAL: Skip I2C access during touch controller recovery period after wake
-  // CST816 touch controller powers down with display and needs 500ms to recover
-  if (lastWakeTime > 0 && (millis() - lastWakeTime) < TOUCH_CONTROLLER_RECOVERY_MS)
-  {
-    // Still in recovery period - don't access I2C yet
-    data->point.x = 0;
-    data->point.y = 0;
-    data->state = LV_INDEV_STATE_REL;  // Released (no touch)
-    return;  // Skip I2C access - prevents Error -1 spam during recovery
-  }
-
-  uint8_t buff[20] = {0};
-  static bool haveLastPoint        = false;
-  static lv_coord_t lastPointX     = 0;
-  static lv_coord_t lastPointY     = 0;
-  static constexpr uint8_t filterDepth = 2;
-  static lv_coord_t historyX[filterDepth] = {0};
-  static lv_coord_t historyY[filterDepth] = {0};
-  static uint8_t historyCount      = 0;
-  static uint8_t historyWriteIndex = 0;
-
-  // ===== I2C ERROR STATISTICS TRACKING =====
-  // Track I2C error statistics for health monitoring
-  static uint32_t touchReadCount = 0;
-  static uint32_t totalReads = 0;
-  static uint32_t corruptedReads = 0;
-  static uint32_t timeoutReads = 0;
-  static uint32_t edgeGlitchReads = 0;
-  static unsigned long lastStatsLog = 0;
-
-  touchReadCount++;
-  totalReads++;
-  // ===== END I2C ERROR STATISTICS TRACKING =====
-
-  // CRITICAL: Match LilyGO lvgl_demo.ino I2C sequence (no error checking on Wire calls)
-  // Touch controller I2C state machine gets confused by timing delays from error checks
-  // BUT: Add timeout to prevent infinite blocking when touch returns [00 00 00...] data
-  // See: https://github.com/Xinyuan-LilyGO/T-Display-S3-Long/blob/main/examples/lvgl_demo/lvgl_demo.ino#L70-L75
-  Wire.beginTransmission(0x3B);
-  Wire.write(read_touchpad_cmd, 8);
-  Wire.endTransmission();
-  Wire.requestFrom(0x3B, 8);
-
-  // CRITICAL: Prevent infinite blocking when touch controller returns [00 00 00...]
-  // Simple 50ms timeout - short enough to not confuse controller timing
-  unsigned long timeout_start = millis();
-  while (!Wire.available()) {
-    esp_task_wdt_reset();  // CRITICAL: Feed watchdog during I2C wait (prevents watchdog timeout crash)
-    if (millis() - timeout_start > 50) {
-      break;  // Timeout - read whatever's available (might be zeros)
-    }
-  }
-
-  // ===== DIAGNOSTIC: I2C Timeout Logging =====
-  // Log when I2C wait times out (indicates bus degradation or controller issues)
-  unsigned long wait_duration = millis() - timeout_start;
-  if (wait_duration >= 50) {
-    timeoutReads++;  // Track timeout statistics
-    static unsigned long lastI2CTimeoutLog = 0;
-    // Log at most once per second to avoid spam
-    if (millis() - lastI2CTimeoutLog > 1000) {
-      LOG_WARN(TAG_UI, "⚠️  I2C timeout: Wire.available() waited %lums (max 50ms)", wait_duration);
-      lastI2CTimeoutLog = millis();
-    }
-  }
-  // ===== END I2C TIMEOUT LOGGING =====
-
-  Wire.readBytes(buff, 8);
-
-  // ===== DIAGNOSTIC: Touch I2C Data Logging =====
-  // Log raw I2C data from touch controller every 100 reads (to avoid spam)
-  if (touchReadCount % 100 == 0) {
-    LOG_DEBUG(TAG_UI, "Touch I2C #%lu: [%02X %02X %02X %02X %02X %02X %02X %02X]",
-             touchReadCount, buff[0], buff[1], buff[2], buff[3], buff[4], buff[5], buff[6], buff[7]);
-  }
-  // NOTE: Periodic ChipID polling was REMOVED - it's not supported by this touch controller
-  // and caused crashes (see LilyGO lvgl_demo.ino for reference implementation)
-  // ===== END TOUCH I2C DATA LOGGING =====
-
-  uint16_t rawX = AXS_GET_POINT_X(buff, 0);
-  uint16_t rawY = AXS_GET_POINT_Y(buff, 0);
-  uint16_t type = AXS_GET_GESTURE_TYPE(buff);
-
-  // ===== EDGE GLITCH DETECTION =====
-  // Detect touches that jump to screen edges (0 or max coordinates)
-  // These are usually I2C read errors or electrical noise
-  if (!type && (rawX || rawY)) {
-    if ((rawX == 0 || rawX >= EXAMPLE_LCD_V_RES - 1) ||
-        (rawY == 0 || rawY >= EXAMPLE_LCD_H_RES - 1)) {
-      edgeGlitchReads++;
-    }
-  }
-  // ===== END EDGE GLITCH DETECTION =====
-
-  // CRITICAL: Distinguish TRUE I2C corruption from normal idle state
-  // [00 00 00...]: TRUE corruption - I2C bus error, invalid data (RARE)
-  // [AF AF AF...]: NORMAL idle state - controller signals "no touch detected" (65% of reads)
-  //
-  // IMPORTANT: This custom CST816 variant (address 0x3B) returns [AF AF...] when idle.
-  // This is NOT an error - it's how this specific controller communicates "no finger detected".
-  // See: LilyGO T-Display-S3-Long reference implementation
-  bool isTrueCorruption = (buff[0] == 0x00 && buff[1] == 0x00);  // Real I2C bus error
-  bool isIdleState = (buff[0] == 0xAF && buff[1] == 0xAF);       // Normal "no touch" signal
-
-  // Handle TRUE corruption (I2C bus errors) - log and track
-  if (isTrueCorruption) {
-    corruptedReads++;  // Track REAL corruption statistics
-
-    // Log TRUE corruption (throttled to once per second)
-    static unsigned long lastCorruptLog = 0;
-    if (millis() - lastCorruptLog > 1000) {
-      LOG_WARN(TAG_UI, "🚨 TRUE I2C bus corruption: [00 00 00 00 00 00 00 00]");
-      lastCorruptLog = millis();
-    }
-
-    // Force touch release
-    data->point.x = 0;
-    data->point.y = 0;
-    data->state = LV_INDEV_STATE_REL;
     return;
   }
 
-  // Handle normal idle state [AF AF...] - silently return "no touch"
-  if (isIdleState) {
-    // This is NORMAL behavior - don't log, don't count as error
-    // Just return touch release state
-    data->point.x = 0;
-    data->point.y = 0;
-    data->state = LV_INDEV_STATE_REL;
+  // GUARD: Ignore touches within WAKE_GUARD_MS after wake - covers the controller's
+  // TOUCH_CONTROLLER_RECOVERY_MS and samples read before the hold-off took effect
+  if (lastWakeTime > 0 && (millis() - lastWakeTime) < WAKE_GUARD_MS)
     return;
-  }
-
-  // DIAGNOSTIC: Touch position logging DISABLED for production use
-  // if (!type && (rawX || rawY)) {
-  //   LOG_INFO(TAG_UI, "Touch RAW data #%lu: rawX=%d, rawY=%d, type=%d, buff0=0x%02X",
-  //            touchReadCount, rawX, rawY, type, buff[0]);
-  // }
 
-  if (!type && (rawX || rawY))
-  {
-    // ===== THERMAL NOISE PROTECTION =====
-    // Track edge touches to detect thermal drift patterns
-    uint32_t now = millis();
+  uiIntentTouch(sample.pressed, sample.ms);  // Press / release time for the button policies
+  if (!sample.pressed)
+    return;
 
-    // Check if touch is near left edge (flush button area - thermal sensitive zone)
-    if (rawY < 50)  // Left edge in portrait mode (Y=0 is left edge)
-    {
-      // Reset counter if window expired
-      if (now - lastEdgeTouchTime > EDGE_TOUCH_WINDOW_MS) {
-        edgeTouchCount = 0;
-      }
+  data->state = LV_INDEV_STATE_PR;
+  data->point.x = sample.x;
+  data->point.y = sample.y;
 
-      edgeTouchCount++;
-      lastEdgeTouchTime = now;
+  // Sleep timeout and UI health monitoring
+  lastTouchTime = millis();
+  lastTouchEvent = lastTouchTime;
+}
 
-      // If too many edge touches in short time, activate thermal suppression
-      if (edgeTouchCount > EDGE_TOUCH_THRESHOLD) {
-        if (!thermalSuppressionActive) {
-          thermalSuppressionActive = true;
-          thermalSuppressionStart = now;
-          LOG_WARN(TAG_UI, "THERMAL NOISE DETECTED - Suppressing left edge touches for 10s");
-        }
-        edgeTouchCount = 0;  // Reset counter
-      }
-    }
+/**
+ * @brief LVGL touch read_cb - consumes samples published by the touch task
+ * @note No I2C here. The read timer is paused once the finger is up and the
+ *       release tail has passed; uiTaskRunOnce() resumes it when
+ *       touchInputPending(). While paused nothing polls. The touch task only
+ *       publishes touch activity (INT-driven or TOUCH_USE_INT=0 polling), so
+ *       this holds in both modes.
+ */
+void my_touchpad_read(lv_indev_drv_t *indev_driver, lv_indev_data_t *data)
+{
+  static lv_indev_state_t lastState = LV_INDEV_STATE_REL;
+  static unsigned long lastFrameMs = 0;
+  touchIndevReads.add();
 
-    // Check if thermal suppression is active
-    if (thermalSuppressionActive)
-    {
-      // End suppression after timeout
-      if (now - thermalSuppressionStart > THERMAL_SUPPRESSION_DURATION_MS) {
-        thermalSuppressionActive = false;
-        LOG_INFO(TAG_UI, "Thermal suppression ended");
-      }
-      // Suppress left edge touches during thermal event
-      else if (rawY < 50)
-      {
-        LOG_VERBOSE(TAG_UI, "Left edge touch suppressed (thermal mode)");
-        data->state = LV_INDEV_STATE_REL;
-        return;
-      }
-    }
-    // ===== END THERMAL PROTECTION =====
+  TouchSample sample;
+  if (!touchInputPop(&sample)) {
+    // Nothing new - LVGL already restored the last point, keep the last state
+    data->state = lastState;
 
-    // GUARD: Ignore touch events within 1 second after wake (prevents phantom touches from I2C glitches)
-    // Wake logic now happens at the top of this function (line 860) before I2C access
-    if (lastWakeTime > 0 && (millis() - lastWakeTime) < WAKE_GUARD_MS)
-    {
-      // Still in wake guard period - reject this touch
-      data->point.x = 0;
-      data->point.y = 0;
-      data->state = LV_INDEV_STATE_REL;
-      return;
+    // Keep reading through the release tail (scroll throw, long-press timing)
+    if (lastState == LV_INDEV_STATE_REL && millis() - lastFrameMs > TOUCH_READ_TAIL_MS &&
+        indev_driver->read_timer != NULL) {
+      lv_timer_pause(indev_driver->read_timer);
     }
+    return;
+  }
 
-    // Update last touch time for sleep timeout tracking
-    lastTouchTime = millis();
-
-
-    int32_t rotatedX = static_cast<int32_t>(EXAMPLE_LCD_V_RES - 1) - static_cast<int32_t>(rawX);
-    if (rotatedX < 0)
-      rotatedX = 0;
-    if (rotatedX >= EXAMPLE_LCD_V_RES)
-      rotatedX = EXAMPLE_LCD_V_RES - 1;
-
-    if (rawY >= EXAMPLE_LCD_H_RES)
-      rawY = EXAMPLE_LCD_H_RES - 1;
-
-    lv_coord_t finalX = static_cast<lv_coord_t>(rawY);
-    lv_coord_t finalY = static_cast<lv_coord_t>(rotatedX);
-    const lv_coord_t maxX = EXAMPLE_LCD_H_RES - 1;
-    const lv_coord_t maxY = EXAMPLE_LCD_V_RES - 1;
-
-    // ===== TOUCH FILTERING: Edge Jump Prevention + 2-Sample Averaging =====
-    if (haveLastPoint)
-    {
-      lv_coord_t deltaX = finalX - lastPointX;
-      if (deltaX < 0)
-        deltaX = -deltaX;
-      if ((finalX <= 1 || finalX >= maxX) && deltaX > 6)
-      {
-        finalX = lastPointX;
-      }
-
-      lv_coord_t deltaY = finalY - lastPointY;
-      if (deltaY < 0)
-        deltaY = -deltaY;
-      if ((finalY <= 5 || finalY >= maxY - 5) && deltaY > 20)
-      {
-        finalY = lastPointY;
-      }
-
-      if (deltaX > 300)  // Optimized threshold for slider responsiveness
-      {
-        finalX = lastPointX;
-      }
+  lastFrameMs = millis();
+  touchpadApplySample(data, sample);
+  lastState = data->state;
 
-      if (deltaY > 60)  // Increased from 32 for slider responsiveness
-      {
-        finalY = lastPointY;
-      }
-    }
-
-    // 2-sample averaging filter DISABLED for maximum responsiveness
-    // Use edge jump prevention only, no averaging
-    lastPointX    = finalX;
-    lastPointY    = finalY;
-    haveLastPoint = true;
-    // ===== END TOUCH FILTERING =====
-
-    data->state   = LV_INDEV_STATE_PR;
-    data->point.x = lastPointX;
-    data->point.y = lastPointY;
-
-    // Track last touch event time for UI health monitoring
-    extern unsigned long lastTouchEvent;
-    lastTouchEvent = millis();
-
-    // Log valid touches (DISABLED for production use)
-    // static unsigned long lastTouchLog = 0;
-    // if (millis() - lastTouchLog > 2000) {  // Log every 2 seconds max
-    //   LOG_DEBUG(TAG_UI, "Touch detected: (%d, %d)", data->point.x, data->point.y);
-    //   lastTouchLog = millis();
-    // }
-
-    // CRITICAL FIX: Use lv_label_set_text_static() to prevent heap corruption
-    // my_touchpad_read() is called BY LVGL DURING RENDER - NEVER use realloc here!
-    static char touchCoordBuffer[20];  // Persistent buffer for lv_label_set_text_static
-    sprintf(touchCoordBuffer, "(%d, %d)", data->point.x, data->point.y);
-    if (ui_cartext != nullptr)
-      lv_label_set_text_static(ui_cartext, touchCoordBuffer);
-  }
-  else
-  {
-    // DIAGNOSTIC: Touch release logging DISABLED for production use
-    // static bool wasPressed = false;
-    // if (wasPressed) {
-    //   LOG_INFO(TAG_UI, "Touch RELEASED (no touch detected, type=%d, rawX=%d, rawY=%d)", type, rawX, rawY);
-    //   wasPressed = false;
-    // }
-
-    data->state = LV_INDEV_STATE_REL;
-    haveLastPoint     = false;
-    historyCount      = 0;
-    historyWriteIndex = 0;
-
-    // Track if we were just pressed (DISABLED - for touch logging only)
-    // if (data->state == LV_INDEV_STATE_PR) {
-    //   wasPressed = true;
-    // }
-  }
-
-  // ===== I2C HEALTH STATISTICS LOGGING =====
-  // Log I2C touch controller health statistics every 10 seconds
-  // NOTE: "Corrupted" = TRUE I2C bus errors [00 00...] ONLY
-  //       [AF AF...] idle state is NOT counted (that's normal operation)
-  if (millis() - lastStatsLog > 10000 && totalReads > 0) {
-    float corruptRate = (corruptedReads * 100.0f) / totalReads;
-    float timeoutRate = (timeoutReads * 100.0f) / totalReads;
-    float glitchRate = (edgeGlitchReads * 100.0f) / totalReads;
-
-    LOG_INFO(TAG_UI, "📊 I2C Touch Health (last 10s):");
-    LOG_INFO(TAG_UI, "  Total reads: %lu", totalReads);
-    LOG_INFO(TAG_UI, "  TRUE Corruptions [00 00...]: %lu (%.1f%%) (Note: [AF AF...] idle NOT counted)", corruptedReads, corruptRate);
-    LOG_INFO(TAG_UI, "  Timeouts: %lu (%.1f%%)", timeoutReads, timeoutRate);
-    LOG_INFO(TAG_UI, "  Edge glitches: %lu (%.1f%%)", edgeGlitchReads, glitchRate);
-
-    // Reset counters for next window
-    totalReads = 0;
-    corruptedReads = 0;
-    timeoutReads = 0;
-    edgeGlitchReads = 0;
-    lastStatsLog = millis();
-  }
-  // ===== END I2C HEALTH STATISTICS LOGGING =====
+  // Drain bursts in one LVGL pass
+  data->continue_reading = touchInputPending();
 }
 
 // =============================================================================
-// LAYER 3: BLE COMMAND INTERFACE (Core 1 → Core 0 Queue)
-// Non-blocking command queue - all BLE operations happen on Core 0
+// LAYER 3: BLE COMMAND INTERFACE (Core 1 → Core 0 command channel)
+// Non-blocking two-lane channel - all BLE operations happen on Core 0
 // =============================================================================
 
+// Completions (BLE task) - results go to the status line
+static void onTareDone(BLECommand command, bool ok, uint32_t param)
+{
+    setStatusLabels(STATUS_COMMAND, !scale.isConnected() ? "Scale not connected" : ok ? "Scale tared" : "Tare failed");
+}
+
+static void onStopDone(BLECommand command, bool ok, uint32_t param)
+{
+    setStatusLabels(STATUS_COMMAND, !scale.isConnected() ? "Scale not connected" : ok ? "Timer stopped" : "Stop timer failed");
+}
+
 /**
  * @brief Queue TARE command to BLE task (non-blocking)
  * Called from Layer 2 brew functions (Core 1)
- * Executed on Core 0 by processBLECommand()
+ * Executed on Core 0 by processBLECommand(); repeated taps merge into one
  */
 void bleCommand_Tare()
 {
-    BLECommandMessage cmd;
-    cmd.command = BLE_CMD_TARE;
-    cmd.param = 0;
-
-    if (xQueueSend(bleCommandQueue, &cmd, 0) == pdTRUE) {
+    if (bleCommandSubmit(BLE_CMD_TARE, 0, onTareDone)) {
         LOG_DEBUG(TAG_TASK, "TARE command queued");
     } else {
         LOG_ERROR(TAG_TASK, "Failed to queue TARE command (queue full)");
-        queueScaleStatus("Command queue full");
+        setStatusLabels(STATUS_COMMAND, "Command queue full");
     }
 }
 
 /**
- * @brief Queue STOP_TIMER command to BLE task (PRIORITY - flushes queue)
- * Called from Layer 2 brew functions (Core 1)
+ * @brief Queue STOP_TIMER command to BLE task (priority lane)
+ * Called from Layer 2 brew functions (Core 1) or the shot watchdogs (Core 0)
  * Executed on Core 0 by processBLECommand()
  *
  * STOP is a priority/safety command:
- * - Flushes all pending commands from queue
- * - Ensures STOP executes immediately
- * - Prevents stale commands (TARE/START) from executing after STOP
+ * - Runs before anything waiting in the normal lane
+ * - START / RESET queued before it are dropped as stale, other commands are kept
  */
 void bleCommand_StopTimer()
 {
-    // STOP is emergency - flush all pending commands from queue!
-    BLECommandMessage discarded;
-    uint8_t flushedCount = 0;
-    while (xQueueReceive(bleCommandQueue, &discarded, 0) == pdTRUE) {
-        LOG_WARN(TAG_TASK, "STOP: Flushed pending command %d from queue", discarded.command);
-        flushedCount++;
-    }
-
-    if (flushedCount > 0) {
-        LOG_INFO(TAG_TASK, "STOP: Flushed %d pending commands", flushedCount);
-    }
-
-    // Now queue the STOP command (queue should be empty)
-    BLECommandMessage cmd;
-    cmd.command = BLE_CMD_STOP_TIMER;
-    cmd.param = 0;
-
-    if (xQueueSend(bleCommandQueue, &cmd, 0) == pdTRUE) {
+    if (bleCommandSubmit(BLE_CMD_STOP_TIMER, 0, onStopDone)) {
         LOG_DEBUG(TAG_TASK, "STOP_TIMER command queued (priority)");
     } else {
-        // Should never happen since we just flushed the queue
-        LOG_ERROR(TAG_TASK, "Failed to queue STOP after flush - critical error!");
-        queueScaleStatus("STOP failed - retry");
+        // Priority lane full of STOPs - the scale is already being stopped
+        LOG_ERROR(TAG_TASK, "Failed to queue STOP (priority lane full)");
+        setStatusLabels(STATUS_COMMAND, "STOP failed - retry");
     }
 }
 
@@ -1495,9 +1488,8 @@ void bleCommand_StopTimer()
  */
 void bleCommand_StartShotSequence()
 {
-    bleSequenceInProgress = true;
-    bleSequenceState = BLE_SEND_RESET;
-    bleSequenceTimestamp = millis();
+    startLatencyMark(START_HOP_COMMAND);
+    bleSequenceRequest(&BLE_SHOT_START_SCRIPT);
     LOG_DEBUG(TAG_TASK, "Shot sequence triggered");
 }
 
@@ -1509,41 +1501,55 @@ void bleCommand_StartShotSequence()
 
 /**
  * @brief Start brewing shot (Layer 2 business logic)
- * Called from UI Layer 1 (ui_event_StartButton)
+ * Called on the UI task only: from UI Layer 1 (ui_event_StartButton) and,
+ * for an auto start (cup_detect.h), from applyCupStartUi() - the control
+ * task posts that as a request instead of starting from Core 0, so the
+ * brewing check and the start below never race a Start tap
  * Validates state, queues BLE commands, controls relay
  */
 void brewFunction_Start()
 {
     // Validate state
     if (shot.brewing) {
-        queueScaleStatus("Already brewing");
+        setStatusLabels(STATUS_COMMAND, "Already brewing");
+        startLatencyAbort();
         return;
     }
 
-    if (isFlushing) {
+    if (cleanProgramStop())
         LOG_INFO(TAG_SHOT, "Flushing cancelled - brew start requested");
-        setRelayState(false);
-        isFlushing = false;
-    }
 
-    // Check connection (non-blocking read)
-    if (!scale.isConnected()) {
-        queueScaleStatus("Scale not connected");
+    // Check connection (non-blocking read) - a wired load cell stands in for the scale
+    bool wired = loadCellActive();
+    if (!scale.isConnected() && !wired) {
+        setStatusLabels(STATUS_COMMAND, "Scale not connected");
         shot.brewing = false;
-        isFlushing = false;
+        cleanProgramStop();
+        startLatencyAbort();
         return;
     }
 
-    LOG_INFO(TAG_SHOT, "Shot start requested - triggering BLE sequence");
-
-    // Update state
+    // Update state (the shot model is reset by the control task when the shot arms)
     shot.shotTimer = 0.0f;
-    shot.datapoints = 0;
+    shotEventsShotRequested();  // The trace starts before the scale commands
+
+    if (wired) {
+        loadCellTare(false);  // Zero at the recent mean - no wait for new conversions
+        if (!scale.isConnected()) {
+            LOG_INFO(TAG_SHOT, "Shot start requested - load cell, no scale commands");
+            startLatencyMark(START_HOP_COMMAND);
+            shotArmPending = true;
+            controlTaskNotify(CONTROL_EVT_SHOT);
+            return;
+        }
+    }
+
+    LOG_INFO(TAG_SHOT, "Shot start requested - triggering BLE sequence");
 
     // Queue BLE commands (non-blocking!)
     bleCommand_StartShotSequence();  // ← Layer 3
 
-    // Note: shot.brewing will be set to true in BLE_START_SHOT state after commands complete
+    // Note: shot.brewing will be set to true by the sequence's "arm" step after commands complete
     // Feedback happens via BLE task callbacks
 }
 
@@ -1557,8 +1563,9 @@ void brewFunction_Stop(ShotEndReason reason)
     bool wasBrewing = shot.brewing;
 
     // Update state immediately
+    shotArmPending = false;  // Stopped before the control task armed it
     shot.brewing = false;
-    isFlushing = false;
+    cleanProgramStop();
     shot.endReason = reason;
     lastTimerUpdate = 0;  // Reset timer update tracking
 
@@ -1566,7 +1573,8 @@ void brewFunction_Stop(ShotEndReason reason)
 
     // Calculate shot duration if we were brewing
     if (wasBrewing) {
-        shot.end_s = seconds_f() - shot.start_timestamp_s;
+        shot.end_s = shotSeconds();
+        uiChannelSetTimer(shot.end_s);  // UI shot clock stops here
     }
 
     // Queue BLE command (non-blocking!) - REMOVED blocking scale.stopTimer() call
@@ -1576,12 +1584,22 @@ void brewFunction_Stop(ShotEndReason reason)
 
     // Control relay (immediate hardware response - critical for safety!)
     setRelayState(false);
+    controlTaskNotify(CONTROL_EVT_SHOT);  // Drip tracking / offset learning from here
     // REMOVED: updateDisplayRefreshRate() - LVGL call unsafe from Core 0
     // Now handled by Core 1 main loop polling shot.brewing state
 
-    // Feedback
-    if (wasBrewing) {
-        queueScaleStatus("Shot stopped");
+    // Feedback: contact time runs from pump-on, extraction from the first drip
+    if (wasBrewing && shot.predictor.onset.dripped()) {
+        float extractionS = shot.end_s - shot.predictor.onset.dripS();
+        uint8_t flagged = shot.predictor.anomaly.flags();
+        char text[64];
+        snprintf(text, sizeof(text), "Stopped%s%s%s - contact %.1f s, extraction %.1f s", flagged ? " (" : "",
+                 FlowAnomaly::name(flagged), flagged ? ")" : "", shot.end_s, extractionS);
+        LOG_INFO(TAG_SHOT, "⏱️ Contact %.1f s, extraction %.1f s (steady flow from %.1f s)", shot.end_s, extractionS,
+                 shot.predictor.onset.onsetS());
+        setStatusLabels(STATUS_SHOT_END, text);
+    } else if (wasBrewing) {
+        setStatusLabels(STATUS_SHOT_END, "Shot stopped");
     }
 }
 
@@ -1592,9 +1610,15 @@ void brewFunction_Stop(ShotEndReason reason)
  */
 void brewFunction_TareScale()
 {
+    if (loadCellActive()) {
+        setStatusLabels(STATUS_COMMAND, loadCellTare(false) ? "Load cell tared" : "Tare failed");
+        if (!scale.isConnected())
+            return;
+    }
+
     // Validate connection (non-blocking read)
     if (!scale.isConnected()) {
-        queueScaleStatus("Scale not connected");
+        setStatusLabels(STATUS_COMMAND, "Scale not connected");
         return;
     }
 
@@ -1602,7 +1626,7 @@ void brewFunction_TareScale()
     bleCommand_Tare();  // ← Layer 3 (non-blocking!)
 
     // Immediate feedback
-    queueScaleStatus("Tare requested...");
+    setStatusLabels(STATUS_COMMAND, "Tare requested...");
 }
 
 /**
@@ -1614,20 +1638,20 @@ void brewFunction_StartFlush()
 {
     // Validate
     if (shot.brewing) {
-        queueScaleStatus("Cannot flush while brewing");
+        setStatusLabels(STATUS_COMMAND, "Cannot flush while brewing");
         return;
     }
 
-    // Control relay (no BLE needed!)
-    flushMessageActive = false;
-    setRelayState(true);          // Turn on pump
-    startTimeFlushing = millis(); // Record start time
-    isFlushing = true;            // Set flushing flag
+    // Relay edges run on their own timer (no BLE needed!)
+    if (!cleanProgramStart(CLEAN_FLUSH)) {
+        setStatusLabels(STATUS_COMMAND, "Cannot flush now");
+        return;
+    }
+    controlTaskNotify(CONTROL_EVT_SHOT);
 
-    // Feedback
-    queueScaleStatus("Flushing...");
+    // Feedback - the countdown follows from handleFlushingCycle()
+    setStatusLabels(STATUS_FLUSH, "Flushing...");
     LOG_INFO(TAG_UI, "Flushing started");
-    enforceRelayState();
 }
 
 /**
@@ -1638,14 +1662,18 @@ void brewFunction_StartFlush()
  */
 void brewFunction_ResetTimer()
 {
+    // A running shot's clock counts from its start (shotClockTick()); updateShotTimer() overrode a reset here anyway
+    if (shot.brewing) {
+        LOG_DEBUG(TAG_UI, "Timer reset ignored during a shot");
+        return;
+    }
+
     // Reset timer state
     shot.shotTimer = 0.0f;
 
-    // CRITICAL FIX: Queue UI update instead of direct lv_label_set_text()
+    // CRITICAL FIX: Publish through the UI channel instead of direct lv_label_set_text()
     // This prevents realloc() during LVGL render phase (heap corruption bug fix)
-    char buffer[10];
-    dtostrf(shot.shotTimer, 5, 1, buffer);
-    queueUIUpdate(UI_UPDATE_TIMER, buffer);
+    uiChannelSetTimer(shot.shotTimer);
 
     LOG_DEBUG(TAG_UI, "Timer reset to 0.0");
 }
@@ -1654,106 +1682,62 @@ void brewFunction_ResetTimer()
 // LVGL Event Handlers (Layer 1: UI Touch)
 // -----------------------------------------------------------------------------
 
-void ui_event_FlushButton(lv_event_t *e)
+/**
+ * @brief Command layer for accepted button presses and gestures (ui_intent.h)
+ */
+static void handleUiIntent(UiIntent intent, UiIntentSource source)
 {
-  static uint32_t pressedAt = 0;
-  static lv_coord_t pressX = 0;
-  static lv_coord_t pressY = 0;
-
-  lv_event_code_t event_code = lv_event_get_code(e);
-
-  if (event_code == LV_EVENT_PRESSED)
-  {
-    pressedAt = millis();
-
-    // Record press coordinates for edge rejection (thermal protection)
-    lv_indev_t* indev = lv_indev_get_act();
-    if (indev) {
-      lv_point_t point;
-      lv_indev_get_point(indev, &point);
-      pressX = point.x;
-      pressY = point.y;
-
-      // Reject touches too close to left edge (thermal drift zone)
-      if (pressX < 5) {
-        LOG_DEBUG(TAG_UI, "Flush: Rejected edge touch (X < 5px)");
-        pressedAt = 0;  // Invalidate press
-        return;
+  switch (intent) {
+    case UI_INTENT_FLUSH:
+      if (!isFlushing)
+      {
+        LOG_INFO(TAG_UI, "Flush activated");
+        brewFunction_StartFlush();  // Layer 2: Non-blocking brew function
       }
-    }
-
-    LOG_DEBUG(TAG_UI, "Flush button PRESSED");
-    return;
+      break;
+    case UI_INTENT_START:
+      startLatencyBegin(uiIntentTouchMs());
+      setStatusLabels(STATUS_BUTTON, "Start Button Pressed");
+      brewFunction_Start();
+      break;
+    case UI_INTENT_STOP:
+      setStatusLabels(STATUS_BUTTON, "Stop Button Pressed");
+      brewFunction_Stop(BUTTON_PRESSED);
+      break;
+    case UI_INTENT_TARE:
+      if (source == UI_INTENT_FROM_GESTURE)
+        LOG_INFO(TAG_UI, "Long press on the weight - tare");
+      brewFunction_TareScale();
+      break;
+    case UI_INTENT_TIMER_RESET:
+      if (source == UI_INTENT_FROM_GESTURE)
+        LOG_INFO(TAG_UI, "Two-finger tap - timer reset");
+      brewFunction_ResetTimer();
+      break;
+    default:
+      break;
   }
+}
 
-  if (event_code == LV_EVENT_CLICKED && pressedAt > 0 &&
-      (millis() - pressedAt) >= FLUSH_BUTTON_MIN_PRESS_MS)
-  {
-    if (!isFlushing)
-    {
-      LOG_INFO(TAG_UI, "Flush activated (%lums press)", millis() - pressedAt);
-      brewFunction_StartFlush();  // Layer 2: Non-blocking brew function
-    }
-    pressedAt = 0;  // Reset
-  }
-  else if (event_code == LV_EVENT_CLICKED && pressedAt > 0)
-  {
-    LOG_DEBUG(TAG_UI, "Flush REJECTED - press too short (%lums)", millis() - pressedAt);
-    pressedAt = 0;
-  }
+void ui_event_FlushButton(lv_event_t *e)
+{
+  // Edge noise is held back per cell before it gets here (touch_pipeline.h)
+  uiIntentEvent(e, FLUSH_POLICY);
 }
 
 void ui_event_StartButton(lv_event_t *e)
 {
-  static uint32_t pressedAt = 0;
-  lv_event_code_t event_code = lv_event_get_code(e);
-
-  if (event_code == LV_EVENT_PRESSED)
-  {
-    pressedAt = millis();
-    return;
-  }
-
-  if (event_code == LV_EVENT_CLICKED && (millis() - pressedAt) >= HUMAN_TOUCH_MIN_MS)
-  {
-    setStatusLabels("Start Button Pressed");
-    brewFunction_Start();  // Layer 2: Non-blocking brew function
-  }
+  uiIntentEvent(e, START_POLICY);
 }
 
 void ui_event_StopButton(lv_event_t *e)
 {
-  static uint32_t pressedAt = 0;
-  lv_event_code_t event_code = lv_event_get_code(e);
-
-  if (event_code == LV_EVENT_PRESSED)
-  {
-    pressedAt = millis();
-    return;
-  }
-
-  if (event_code == LV_EVENT_CLICKED && (millis() - pressedAt) >= HUMAN_TOUCH_MIN_MS)
-  {
-    setStatusLabels("Stop Button Pressed");
-    brewFunction_Stop(BUTTON_PRESSED);  // Layer 2: Non-blocking brew function
-  }
+  uiIntentEvent(e, STOP_POLICY);
 }
 
 void ui_event_ScaleResetButton(lv_event_t *e)
 {
-  static uint32_t pressedAt = 0;
-  lv_event_code_t event_code = lv_event_get_code(e);
-
-  if (event_code == LV_EVENT_PRESSED)
-  {
-    pressedAt = millis();
-    return;
-  }
-
-  if (event_code == LV_EVENT_CLICKED && (millis() - pressedAt) >= HUMAN_TOUCH_MIN_MS)
-  {
-    brewFunction_TareScale();  // Layer 2: Non-blocking brew function
-  }
+  uiIntentEvent(e, TARE_POLICY);
 }
 
 void ui_event_PresetWeightSlight(lv_event_t *e)
@@ -1765,8 +1749,8 @@ void ui_event_PresetWeightSlight(lv_event_t *e)
     _ui_slider_set_text_value(ui_PresetWeightLabel, target, "", " g");
     int PresetWeightValue = lv_slider_get_value(target);
     goalWeight = PresetWeightValue;  // Update RAM variable for immediate effect
-    saveWeight(PresetWeightValue);   // Save to Flash for persistence across reboots
-    _ui_slider_set_text_value(ui_SerialLabel1, target, "Preset Weight Value Set @ ", " g");
+    settingsSetGoalWeight(PresetWeightValue);  // Saved to flash once the slider settles
+    setStatusLabelsValue(STATUS_SETTING, "Preset Weight Value Set @ %.0f g", PresetWeightValue);
   }
 }
 
@@ -1777,30 +1761,88 @@ void ui_event_BacklightSlider(lv_event_t *e)
   if (event_code == LV_EVENT_VALUE_CHANGED)
   {
     _ui_slider_set_text_value(ui_BacklightLabel, target, "", " %");
-    _ui_slider_set_text_value(ui_SerialLabel1, target, "Backlight Value Set @ ", " %");
     int brightnessValue = lv_slider_get_value(target);
-    brightness = map(brightnessValue, 0, 100, 70, 255);
-    saveBrightness(brightnessValue); // Save 0-100% brightness value
-    LOG_DEBUG(TAG_UI, "Brightness value saved @ %d", brightnessValue);
-    analogWrite(TFT_BL, brightness); // PWM based on 0-255
+    setStatusLabelsValue(STATUS_SETTING, "Backlight Value Set @ %.0f %%", brightnessValue);
+    brightness = brightnessValue;
+    settingsSetBrightness(brightnessValue); // 0-100%, saved to flash once the slider settles
+    LOG_DEBUG(TAG_UI, "Brightness value set @ %d", brightnessValue);
+    displayPowerSetBrightness(brightnessValue);
   }
 }
 
-void ui_event_TimerResetButton(lv_event_t *e)
+// Goal / brightness written over BLE (ble_maint.h): moved like a touch, the slider handlers do the rest
+static void applyBleSettingsUi()
 {
-  static uint32_t pressedAt = 0;
-  lv_event_code_t event_code = lv_event_get_code(e);
+  BleMaintSettings written;
+  if (shot.brewing || !bleMaintTakeSettings(BLE_MAINT_SET_GOAL | BLE_MAINT_SET_BRIGHTNESS, &written))
+    return;
 
-  if (event_code == LV_EVENT_PRESSED)
+  if (written.fields & BLE_MAINT_SET_GOAL)
   {
-    pressedAt = millis();
-    return;
+    lv_slider_set_value(ui_PresetWeightSlight, written.goalDg / 10, LV_ANIM_OFF);
+    lv_event_send(ui_PresetWeightSlight, LV_EVENT_VALUE_CHANGED, NULL);
   }
+  if (written.fields & BLE_MAINT_SET_BRIGHTNESS)
+  {
+    lv_slider_set_value(ui_BacklightSlider, written.brightnessPct, LV_ANIM_OFF);
+    lv_event_send(ui_BacklightSlider, LV_EVENT_VALUE_CHANGED, NULL);
+  }
+}
 
-  if (event_code == LV_EVENT_CLICKED && (millis() - pressedAt) >= HUMAN_TOUCH_MIN_MS)
+// Auto start from the cup detector: control task → UI task, taken by applyCupStartUi()
+static AtomicValue<bool> cupStartRequest(false);
+
+// Auto start posted by handleCupSample(): run here, where Start taps run, so one start wins
+static void applyCupStartUi()
+{
+  if (cupStartRequest.exchange(false))
+    brewFunction_Start();
+}
+
+// Settings from an imported document (config_json.h): goal / brightness like a touch, the rest direct
+static void applyConfigImportUi()
+{
+  ConfigImportSettings imported;
+  if (shot.brewing || !configImportTakeSettings(&imported))
+    return;
+
+  if (imported.fields & CONFIG_SET_GOAL)
+  {
+    lv_slider_set_value(ui_PresetWeightSlight, imported.goalG, LV_ANIM_OFF);
+    lv_event_send(ui_PresetWeightSlight, LV_EVENT_VALUE_CHANGED, NULL);
+  }
+  if (imported.fields & CONFIG_SET_BRIGHTNESS)
+  {
+    lv_slider_set_value(ui_BacklightSlider, imported.brightnessPct, LV_ANIM_OFF);
+    lv_event_send(ui_BacklightSlider, LV_EVENT_VALUE_CHANGED, NULL);
+  }
+  if (imported.fields & CONFIG_SET_CUP_MODE)
   {
-    brewFunction_ResetTimer();  // Layer 2: Non-blocking brew function
+    cupDetectSetMode(imported.cupMode);
+    settingsSetCupMode(imported.cupMode);
   }
+  if (imported.fields & CONFIG_SET_FLUSH)
+    cleanProgramConfigure(CLEAN_FLUSH, CleanProgram{1, (uint16_t)imported.flushS, 0});
+  if (imported.fields & CONFIG_SET_BACKFLUSH)
+  {
+    // Members left out of the document keep the program's current value
+    CleanProgram backflush = cleanProgramGet(CLEAN_BACKFLUSH);
+    if (imported.backflushPulses >= 0)
+      backflush.pulses = imported.backflushPulses;
+    if (imported.backflushOnS >= 0)
+      backflush.onS = imported.backflushOnS;
+    if (imported.backflushOffS >= 0)
+      backflush.offS = imported.backflushOffS;
+    cleanProgramConfigure(CLEAN_BACKFLUSH, backflush);
+  }
+  if (imported.fields & CONFIG_SET_REMINDER)
+    cleanProgramSetReminder(imported.backflushEvery);
+  setStatusLabels(STATUS_SETTING, "Settings imported");
+}
+
+void ui_event_TimerResetButton(lv_event_t *e)
+{
+  uiIntentEvent(e, TIMER_RESET_POLICY);
 }
 
 // -----------------------------------------------------------------------------
@@ -1811,37 +1853,14 @@ void flushingFeature()
 {
   if (shot.brewing)
   {
-    queueScaleStatus("Cannot flush during shot");
+    setStatusLabels(STATUS_COMMAND, "Cannot flush during shot");
     return;
   }
 
-  flushMessageActive = false;
-  setRelayState(true);          // Turn on the output pin
-  startTimeFlushing = millis(); // Record the current time
-  isFlushing = true;            // Set the flushing flag
+  if (!cleanProgramStart(CLEAN_FLUSH))
+    return;
+  controlTaskNotify(CONTROL_EVT_SHOT);
   LOG_INFO(TAG_UI, "Flushing started");
-  enforceRelayState();
-}
-
-void saveBrightness(int brightness)
-{
-  preferences.begin("myApp", false);              // Open the preferences with a namespace and read-only flag
-  preferences.putInt(BRIGHTNESS_KEY, brightness); // Write the brightness value to preferences
-  preferences.end();                              // Close the preferences
-}
-
-void saveOffset(int offset)
-{
-  preferences.begin("myApp", false);      // Open the preferences with a namespace and read-only flag
-  preferences.putInt(OFFSET_KEY, offset); // Write the brightness value to preferences
-  preferences.end();                      // Close the preferences
-}
-
-void saveWeight(int weight)
-{
-  preferences.begin("myApp", false);      // Open the preferences with a namespace and read-only flag
-  preferences.putInt(WEIGHT_KEY, weight); // Write the brightness value to preferences
-  preferences.end();                      // Close the preferences
 }
 
 // -----------------------------------------------------------------------------
@@ -1858,14 +1877,30 @@ void checkHeartBreat()
   {
     scale.heartbeat();
   }
-}
 
-// Battery request now handled during scale init in AcaiaArduinoBLE library
+  // Battery: requested at SETTINGS_POLL_MS (not while brewing), the reply is
+  // parsed with the other notifications
+  if (scale.settingsRequired())
+  {
+    scale.requestSettings();
+  }
+  int battery = scale.batteryValue();
+  if (battery != bleData.load().batteryLevel)
+    updateSharedBattery(battery);
+}
 
 void checkScaleStatus()
 {
+  uint32_t now = millis();
+
+  // Drive a running connection attempt one step (non-blocking between steps)
+  if (scale.isConnecting())
+  {
+    scale.poll();
+    lastScaleInitAttempt = now;  // Retry interval counts from the end of an attempt
+  }
+
   bool connected = scale.isConnected();
-  uint32_t now   = millis();
 
   // CRITICAL: This function runs in BLE task (Core 0)
   // CANNOT access LVGL UI elements - they're not thread-safe!
@@ -1879,25 +1914,44 @@ void checkScaleStatus()
     {
       if (!hasShownNoScaleMessage)
       {
-        queueScaleStatus("Scale Not Connected");
+        setStatusLabels(STATUS_SCALE_LINK, "Scale Not Connected");
         hasShownNoScaleMessage = true;
       }
     }
     else if (lastScaleConnected)
     {
-      queueScaleStatus("Scale disconnected");
+      setStatusLabels(STATUS_SCALE_LINK, "Scale disconnected");
     }
 
     lastScaleConnected = false;
 
-    // ArduinoBLE: init() is blocking (with LVGL keepalive inside), safe on Core 0
+    if (!shot.brewing)
+    {
+      rideThroughUntil = 0;  // Ended meanwhile (cut at the predicted end, stop button)
+    }
+    else if (rideThroughUntil == 0)
+    {
+      if (!rideThroughStart(now))
+        brewFunction_Stop(SCALE_DISCONNECTED);  // Layer 2: Non-blocking (safe from Core 0)
+    }
+    else if ((int32_t)(now - rideThroughUntil) >= 0)
+    {
+      LOG_WARN(TAG_SCALE, "⚠️  Scale not back within %lums - stopping", (unsigned long)SCALE_RIDE_THROUGH_MS);
+      rideThroughUntil = 0;
+      brewFunction_Stop(SCALE_DISCONNECTED);
+    }
+
+    // Connection state machine: beginConnect() returns immediately, poll() above
+    // advances it, so heartbeats, commands and watchdogs keep running meanwhile
     // Retry logic ensures we don't spam connection attempts
-    if (!scale.isConnected())
+    if (!scale.isConnecting())
     {
-      // Not currently connected, can start new attempt
-      if (!isFlushing && ((now - lastScaleInitAttempt) >= SCALE_INIT_RETRY_MS || lastScaleInitAttempt == 0))
+      // Not currently connecting, can start new attempt
+      // Riding through a shot: retry at once, the window is short
+      if (!isFlushing && ((now - lastScaleInitAttempt) >= scaleInitRetryMs() || lastScaleInitAttempt == 0 ||
+                          rideThroughUntil))
       {
-        scale.init();  // Blocking call (1s timeout), but runs on Core 0 so UI on Core 1 is unaffected
+        scale.beginConnect();
         lastScaleInitAttempt = now;
       }
     }
@@ -1906,21 +1960,23 @@ void checkScaleStatus()
 
     currentWeight = 0;
     firstConnectionNotificationPending = true;
-
-    if (shot.brewing)
-    {
-      brewFunction_Stop(SCALE_DISCONNECTED);  // Layer 2: Non-blocking (safe from Core 0)
-    }
   }
   else
   {
     // UI updates removed - handled by updateUIWithBLEData() on Core 1
 
-    // ArduinoBLE: isConnected() already means fully connected (init() succeeded)
-    // No need to check connection state - if init() returned true, we're fully connected
+    // isConnected() already means fully connected (state machine reached CONN_CONNECTED)
+    // No need to check connection state - the handshake completed before _connected was set
     if (!lastScaleConnected)
     {
-      queueScaleStatus("Scale Connected");
+      setStatusLabels(STATUS_SCALE_LINK, "Scale Connected");
+    }
+    if (rideThroughUntil)
+    {
+      // Samples resume on the same shot clock (packet arrival times); the filter bridges the gap
+      LOG_INFO(TAG_SCALE, "📡 Scale back mid-shot, %lums before the ride-through limit",
+               (unsigned long)(rideThroughUntil - now));
+      rideThroughUntil = 0;
     }
 
     firstConnectionNotificationPending = false;
@@ -1929,16 +1985,6 @@ void checkScaleStatus()
     hasShownNoScaleMessage             = false;
     lastScaleInitAttempt               = now;
   }
-
-  if (!isFlushing && hasPendingScaleStatus)
-  {
-    if (!flushMessageActive || millis() >= flushMessageHoldUntil)
-    {
-      setStatusLabels(pendingScaleStatus);  // Fixed: already char array, no .c_str() needed
-      hasPendingScaleStatus = false;
-      flushMessageActive    = false;
-    }
-  }
 }
 
 // ============================================================================
@@ -1946,65 +1992,48 @@ void checkScaleStatus()
 // ============================================================================
 static void handleFlushingCycle()
 {
-  if (!isFlushing)
-    return;
-
-  const unsigned long now       = millis();
-  const unsigned long elapsed   = now - startTimeFlushing;
-  const unsigned long remaining = (flushDuration > elapsed) ? (flushDuration - elapsed) : 0;
-
-  if (now - lastPrintTimeFlushing >= 1000)
+  // Edges run on clean_program's timer; this only words the phase and countdown
+  char line[STATUS_LINE_TEXT_LEN];
+  if (cleanProgramStatus(line, sizeof(line)))
   {
-    lastPrintTimeFlushing = now;
-
-    if (!hasPendingScaleStatus && strlen(currentStatusText) > 0)  // Fixed: use strlen() for char array
-    {
-      strncpy(pendingScaleStatus, currentStatusText, sizeof(pendingScaleStatus) - 1);  // Fixed: safe string copy
-      pendingScaleStatus[sizeof(pendingScaleStatus) - 1] = '\0';  // Ensure null termination
-      hasPendingScaleStatus = true;
-    }
-
-    LOG_DEBUG(TAG_UI, "Flushing... %lu seconds remaining", remaining / 1000);
-
-    char labelBuf[48];
-    snprintf(labelBuf, sizeof(labelBuf), "Flushing... %lu seconds remaining", remaining / 1000);
-    setStatusLabels(labelBuf);
+    LOG_DEBUG(TAG_UI, "%s", line);
+    setStatusLabels(STATUS_FLUSH, line);  // Holds scale messages back until the program has ended
   }
-
-  if (elapsed >= flushDuration)
+  else if (!isFlushing && !shot.brewing && !bleSequenceInProgress && cleanProgramTakeReminder(line, sizeof(line)))
   {
-    setRelayState(false);
-    isFlushing = false;
-    LOG_INFO(TAG_UI, "Flushing ended");
-    setStatusLabels("Flushing ended");
-
-    flushMessageActive    = true;
-    flushMessageHoldUntil = now + FLUSH_STATUS_HOLD_MS;
+    LOG_INFO(TAG_UI, "🧽 %s", line);
+    setStatusLabels(STATUS_CLEAN, line);
   }
 }
 
-static void processPendingStatusQueue()
+/**
+ * @brief Idle reading with a cup mode set (cup_detect.h): tare a placed cup, start by itself in auto mode
+ * @note Control task: the start is posted to the UI task (applyCupStartUi()), which owns brew starts
+ */
+static void handleCupSample(float weight, unsigned long now)
 {
-  if (isFlushing || !hasPendingScaleStatus)
-    return;
-
-  if (!flushMessageActive || millis() >= flushMessageHoldUntil)
+  switch (cupDetectSample(weight, now))
   {
-    setStatusLabels(pendingScaleStatus);  // Fixed: already char array, no .c_str() needed
-    hasPendingScaleStatus = false;
-    flushMessageActive    = false;
+    case CUP_ACTION_TARE:
+      if (bleCommandSubmit(BLE_CMD_TARE, 0, onTareDone))
+        setStatusLabels(STATUS_CUP, "Cup detected - taring");
+      break;
+    case CUP_ACTION_START:
+      cupStartRequest = true;  // Before the status post: its wake finds the request
+      setStatusLabels(STATUS_CUP, "Cup ready - starting");
+      break;
+    case CUP_ACTION_NONE:
+      break;
   }
 }
 
-static void updateScaleReadings()
+/**
+ * @brief Feed one scale sample (weight + arrival time) into the UI and the shot model
+ */
+static void processWeightSample(float weight, int64_t sampleUs)
 {
-  // CRITICAL: Check isConnected FIRST to prevent reading uninitialized BLE characteristics
-  // C++ short-circuit evaluation: if isConnected() is false, newWeightAvailable() won't be called
-  // Bug fix: Calling newWeightAvailable() when disconnected causes LoadProhibited crash
-  if (!scale.isConnected() || !scale.newWeightAvailable())
-    return;
-
-  currentWeight = scale.getWeight();
+  GS_TRACE_SCOPE("weight_sample");
+  currentWeight = weight;  // Everything below uses the parameter, not the shared copy
 
   // CRITICAL FIX: Throttle UI updates to prevent watchdog timeout and LVGL realloc bugs
   // Rate limit weight updates to 5Hz (200ms) to reduce LVGL memory allocator stress
@@ -2015,17 +2044,15 @@ static void updateScaleReadings()
   const unsigned long WEIGHT_UI_UPDATE_INTERVAL = 200;  // 200ms = 5Hz max UI updates (was 100ms = 10Hz)
 
   unsigned long now = millis();
-  bool weightChanged = fabs(currentWeight - lastUIWeight) > 0.1;  // >0.1g change
+  bool weightChanged = fabs(weight - lastUIWeight) > 0.1;  // >0.1g change
   bool intervalElapsed = (now - lastWeightUIUpdate) >= WEIGHT_UI_UPDATE_INTERVAL;
 
-  if (weightChanged || intervalElapsed) {
-    // PROFESSIONAL FIX: Use message queue for thread-safe UI updates
-    // BLE task (Core 0) enqueues weight text, main loop (Core 1) updates LVGL
-    char buffer[10];
-    dtostrf(currentWeight, 5, 1, buffer);
-    queueUIUpdate(UI_UPDATE_WEIGHT, buffer);
+  if (!shot.brewing && (weightChanged || intervalElapsed)) {
+    // Thread-safe UI update: control task (Core 0) stores the value, UI task (Core 1) formats it
+    // During a shot the filter state is posted below instead, projected by the UI task
+    uiChannelSetWeight(weight);
     lastWeightUIUpdate = now;
-    lastUIWeight = currentWeight;
+    lastUIWeight = weight;
   }
 
   // Rate limit weight printing to prevent WebSocket overflow
@@ -2038,59 +2065,198 @@ static void updateScaleReadings()
 
   if (now - lastWeightPrint >= WEIGHT_PRINT_INTERVAL) {
     shouldPrint = true;  // Time-based: print every 100ms
-  } else if (abs(currentWeight - lastPrintedWeight) > 0.1) {
+  } else if (abs(weight - lastPrintedWeight) > 0.1) {
     shouldPrint = true;  // Change-based: significant weight change (>0.1g)
   }
 
   if (shouldPrint) {
-    LOG_VERBOSE(TAG_SHOT, "%.2fg", currentWeight);
+    LOG_VERBOSE(TAG_SHOT, "%.2fg", weight);
     lastWeightPrint = now;
-    lastPrintedWeight = currentWeight;
+    lastPrintedWeight = weight;
   }
 
   if (!shot.brewing)
   {
+    // Drips after a stop: keep the filter running so the stop model sees the flow die out
+    if (stopModelPending() && shot.start_us)
+    {
+      float sinceStart = shotSeconds(sampleUs);
+      shot.predictor.filter.update(sinceStart, weight);
+      stopModelNoteSample(sinceStart - shot.end_s, shot.predictor.filter.flow());
+    }
+    else if (!bleSequenceInProgress && !shotArmPending && !isFlushing)
+    {
+      handleCupSample(weight, now);
+    }
     return;
   }
 
-  if (shot.datapoints >= SHOT_HISTORY_CAP)
-  {
-    // Clamp FIRST to prevent out-of-bounds access if datapoints > SHOT_HISTORY_CAP
-    shot.datapoints = SHOT_HISTORY_CAP - 1;
+  const ShotOffsetUs sampleOffset = monoOffsetUs(shot.start_us, sampleUs);
+  const float nowSeconds = shotOffsetS(sampleOffset);
+  if (sampleOffset < 0)
+    return;  // Buffered before the shot started - not part of this shot's curve
 
-    // Now safe to shift array (discard oldest datapoint)
-    std::memmove(shot.time_s,   shot.time_s + 1,   shot.datapoints * sizeof(float));
-    std::memmove(shot.weight,   shot.weight + 1,   shot.datapoints * sizeof(float));
+  shot.samples.push(nowSeconds, weight);  // Full store overwrites the oldest sample
+  shot.shotTimer = nowSeconds;
 
-    LOG_DEBUG(TAG_SHOT, "Shot history buffer full, oldest datapoint discarded");  // Changed to DEBUG - this is normal operation
-  }
+#ifdef GS_SHOT_TRACE
+  LOG_INFO(TAG_SHOT, "TRACE,%.3f,%.2f", nowSeconds, weight);  // Replayable by tools/shot_replay
+#endif
 
-  const float nowSeconds = seconds_f() - shot.start_timestamp_s;
-  shot.time_s[shot.datapoints] = nowSeconds;
-  shot.weight[shot.datapoints] = currentWeight;
-  shot.shotTimer                = nowSeconds;
-  shot.datapoints++;
+  // Pipeline: raw reading → filter (noise, impacts) → flow onset → trend line → prediction
+  FlowOnset &onset = shot.predictor.onset;
+  bool dripped = onset.dripped();
+  bool flowing = onset.flowing();
+  uint8_t anomalies = shot.predictor.anomaly.flags();
+  shot.predictor.add(nowSeconds, weight);
+  if (!dripped && onset.dripped())
+    LOG_INFO(TAG_SHOT, "💧 First drip at %.1f s (baseline %.1f g)", onset.dripS(), onset.baselineG());
+  if (!flowing && onset.flowing())
+    LOG_INFO(TAG_SHOT, "🚿 Steady flow from %.1f s - trend line starts", onset.onsetS());
+  anomalies = shot.predictor.anomaly.flags() & ~anomalies;
+  if (anomalies)
+  {
+    LOG_WARN(TAG_SHOT, "⚠️  Flow anomaly at %.1f s: %s (%.1f g @ %.2f g/s)%s", nowSeconds,
+             FlowAnomaly::name(anomalies), shot.predictor.filter.weight(), shot.predictor.filter.flow(),
+             GS_ANOMALY_STOP ? " - stopping" : "");  // handleShotWatchdogs() in this pass
+  }
+  shotChartAdd(nowSeconds, shot.predictor.filter.weight(), shot.predictor.filter.flow());  // Decimated, ~2 points/s
+  uiChannelSetWeightTrend(shot.predictor.filter.weight(), shot.predictor.filter.flow(), sampleUs);
 
-  // Timer display now updated independently by updateShotTimer() function
+  // Timer display runs on the UI core from shot.start_us (shotClockTick())
 
   calculateEndTime(&shot);
 
+  // Cut the pump on a hardware timer at the predicted end, re-armed with every sample
+  if (profileRunner.atGoalStage() && shot.expected_end_s < MAX_SHOT_DURATION_S)
+  {
+    relayControlScheduleOff(monoAfterS(shot.start_us, max(shot.expected_end_s, (float)MIN_SHOT_DURATION_S)));
+  }
+  else
+    relayControlCancel();
+  GS_PROBE_TOGGLE(PROBE_DECIDE);   // This sample's stop decision is in place
+
   if (shouldPrint) {
-    LOG_VERBOSE(TAG_SHOT, "Timer: %.1fs, Expected end: %.1fs", shot.shotTimer, shot.expected_end_s);
+    WeightFilterState est = shot.predictor.filter.state();
+    LOG_VERBOSE(TAG_SHOT, "Timer: %.1fs, Expected end: %.1fs, filtered %.2fg @ %.2fg/s (sd %.2fg)",
+                shot.shotTimer, shot.expected_end_s, est.weight, est.flow, sqrtf(est.weightVar));
+  }
+
+  uint8_t flagged = shot.predictor.anomaly.flags();
+  if (flagged & FLOW_ANOMALY_CHANNELING)
+    setStatusLabelsValue(STATUS_SHOT_PROGRESS, "Channeling! End @ %.1f s, extracting %.1f s", shot.expected_end_s, nowSeconds - onset.dripS());
+  else if (flagged & FLOW_ANOMALY_CHOKED)
+    setStatusLabelsValue(STATUS_SHOT_PROGRESS, "Choked! Flow %.2f g/s at %.1f s", shot.predictor.filter.flow(), nowSeconds);
+  else if (onset.dripped())
+    setStatusLabelsValue(STATUS_SHOT_PROGRESS, "End @ %.1f s, extracting %.1f s", shot.expected_end_s, nowSeconds - onset.dripS());
+  else
+    setStatusLabelsValue(STATUS_SHOT_PROGRESS, "Expected end time @ %.1f s", shot.expected_end_s);
+}
+
+static void updateScaleReadings()
+{
+  // CRITICAL: Check isConnected FIRST to prevent reading uninitialized BLE characteristics
+  // Bug fix: Calling newWeightAvailable() when disconnected causes LoadProhibited crash
+  if (!scale.isConnected()) {
+    watchdogIdle(WATCHDOG_SCALE_LINK);
+    return;
   }
 
-  char labelBuf[40];
-  snprintf(labelBuf, sizeof(labelBuf), "Expected end time @ %.1f s", shot.expected_end_s);
-  setStatusLabels(labelBuf);
+  // Every buffered notification is a sample - several can arrive between passes.
+  // Transport bookkeeping stays here; the sample itself goes to the control task.
+  bool queued = false;
+  while (scale.newWeightAvailable())
+  {
+    watchdogCheckIn(WATCHDOG_SCALE_LINK);
+    bootMark(BOOT_FIRST_WEIGHT);
+    uint32_t periodMs = static_cast<uint32_t>(scale.packetPeriod());
+    framePacerNotePacketPeriod(periodMs);
+    scalePacketPeriodMs.record(periodMs);
+    scalePackets.add();
+    updateSharedPacketReceived();
+    wifiCoexNoteSample((uint32_t)(scale.packetTimeUs() / 1000));
+    if (loadCellActive())
+      continue;  // The wired cell feeds the control task (onLoadCellSample)
+
+    ControlSample sample = {scale.getWeight(), scale.packetTimeUs()};
+    if (xQueueSend(controlSamples, &sample, 0) == pdTRUE)
+      queued = true;
+    else
+      controlSamplesDropped.add();
+  }
+  if (queued)
+    controlTaskNotify(CONTROL_EVT_SAMPLE);
 }
 
-static void handleShotWatchdogs()
+// Wired load cell conversion (reader task) - queued like a scale notification
+static void onLoadCellSample(float grams, int64_t sampleUs)
 {
-  if (shot.brewing || isFlushing)
-    setRelayState(true);
+  bootMark(BOOT_FIRST_WEIGHT);
+  ControlSample sample = {grams, sampleUs};
+  if (xQueueSend(controlSamples, &sample, 0) == pdTRUE)
+    controlTaskNotify(CONTROL_EVT_SAMPLE);
+  else
+    controlSamplesDropped.add();
+}
+
+// Offset of the selected goal's profile, with its confidence on the status line
+static void showOffset(const char *prefix)
+{
+  OffsetConfidence confidence;
+  weightOffset = offsetModelGet(goalWeight, &confidence);
+  offsetGoal = goalWeight;
+
+  char text[64];
+  if (confidence.shots == 0)
+    snprintf(text, sizeof(text), "%sOffset %.1f g (new)", prefix, weightOffset);
   else
+    snprintf(text, sizeof(text), "%sOffset %.1f g +/-%.1f (%u shots)", prefix, weightOffset,
+             confidence.spreadG, confidence.shots);
+  LOG_INFO(TAG_SHOT, "%ug: %s", goalWeight, text);
+  setStatusLabels(STATUS_OFFSET, text);
+}
+
+// Offset / profile written over BLE (ble_maint.h) - between shots, here where both are owned
+static void applyBleSettings()
+{
+  BleMaintSettings written;
+  if (shot.brewing || isFlushing ||
+      !bleMaintTakeSettings(BLE_MAINT_SET_OFFSET | BLE_MAINT_SET_PROFILE, &written))
+    return;
+
+  if (written.fields & BLE_MAINT_SET_PROFILE)
+    shotProfileSelect(written.profile);
+  if (written.fields & BLE_MAINT_SET_OFFSET)
+  {
+    // For the goal of the same write, even if the UI task has not moved the slider yet
+    offsetModelSet(written.goalDg / 10, written.offsetCg / 100.0f);
+    showOffset("BLE: ");
+  }
+}
+
+// Profiles from an imported document (config_json.h) - between shots, like the BLE profile write
+static void applyConfigImport()
+{
+  if (shot.brewing || isFlushing)
+    return;
+  uint8_t stored = configImportApplyProfiles();
+  if (stored > 0)
+    LOG_INFO(TAG_SHOT, "Imported %u profile(s), active %s", stored, shotProfileActive()->name);
+}
+
+static void handleShotWatchdogs()
+{
+  // The slider only changes goalWeight (UI task); the profile switch happens here, between shots
+  if (goalWeight != offsetGoal && !shot.brewing)
+    showOffset("");
+
+  if (shot.brewing && profileRunner.running())
+    profileRunner.tick(shotSeconds(), shot.predictor.filter.weight());
+
+  if (!isFlushing)
+    setRelayState(relayWanted());
+  if (!shot.brewing && !isFlushing)
   {
-    setRelayState(false);
     previousTimerValue = 0.0f;
     lastTimerUpdate = 0;
   }
@@ -2100,53 +2266,249 @@ static void handleShotWatchdogs()
   if (shot.brewing && shot.shotTimer > MAX_SHOT_DURATION_S)
   {
     LOG_WARN(TAG_SHOT, "Max brew duration reached");
-    setStatusLabels("Max brew duration reached");
+    setStatusLabels(STATUS_SHOT_END, "Max brew duration reached");
     brewFunction_Stop(TIME_EXCEEDED);  // Layer 2: Non-blocking (safe from Core 0)
   }
 
-  if (shot.brewing && shot.shotTimer >= shot.expected_end_s && shot.shotTimer > MIN_SHOT_DURATION_S)
+#if GS_ANOMALY_STOP
+  if (shot.brewing && shot.predictor.anomaly.flags())
   {
+    LOG_WARN(TAG_SHOT, "Flow anomaly - stopping shot");
+    brewFunction_Stop(FLOW_ANOMALY);
+  }
+#endif
+
+  // Decide on the exact time, not the 100ms shotTimer tick (controlTaskNextWaitMs wakes us for it).
+  // If the scheduled cut already fired, the decision happened then - the relay is already off.
+  int64_t cutUs = 0;
+  bool cutFired = relayControlCutFired(&cutUs);
+  float shotNowS = cutFired ? shotSeconds(cutUs) : shotSeconds();
+  if (shot.brewing && profileRunner.atGoalStage() &&
+      (cutFired || ShotPredictor::stopDue(shotNowS, shot.expected_end_s)))
+  {
+    // Where the cup is right now: newest filtered estimate carried forward by its age
+    float packetAge = shot.samples.size() ? shotNowS - shot.samples.back().seconds() : 0.0f;
+    stopStalenessMs.record(packetAge > 0.0f ? (uint32_t)(packetAge * 1000.0f) : 0);
+    stopModelNoteDecision(packetAge, shot.predictor.filter.flow(), shot.predictor.filter.weight() + shot.predictor.filter.flow() * packetAge);
+
     LOG_INFO(TAG_SHOT, "Weight achieved");
-    setStatusLabels("Weight achieved");
+    setStatusLabels(STATUS_SHOT_END, "Weight achieved");
     brewFunction_Stop(WEIGHT_ACHIEVED);  // Layer 2: Non-blocking (safe from Core 0)
   }
 
-  if (shot.start_timestamp_s && shot.end_s && currentWeight >= (goalWeight - weightOffset) &&
-      seconds_f() > shot.start_timestamp_s + shot.end_s + DRIP_DELAY_S)
+  if (stopModelPending() && shot.start_us && shot.end_s &&
+      shotSeconds() > shot.end_s + DRIP_DELAY_S)
   {
-    shot.start_timestamp_s = 0;
-    shot.end_s             = 0;
-
-    if (abs(currentWeight - goalWeight + weightOffset) > MAX_OFFSET)
+    float handover = stopModelFinish(currentWeight);
+    if (handover != 0.0f)
     {
-      LOG_INFO(TAG_SHOT, "Final weight: %.2fg, Goal: %dg, Offset: %.2fg - Error assumed. Offset unchanged.",
-               currentWeight, goalWeight, weightOffset);
-      setStatusLabels("Error assumed. Offset unchanged.");
+      offsetModelShift(-handover);
+      weightOffset -= handover;
+      LOG_DEBUG(TAG_SHOT, "Offset %.2fg after handing %.2fg to the stop model", weightOffset, handover);
     }
+  }
+
+  // After the drip delay the curve and final weight are complete, whatever ended the shot
+  if (shotLogDue && !shot.brewing && shot.start_us && shot.end_s &&
+      shotSeconds() > shot.end_s + DRIP_DELAY_S)
+    logFinishedShot();
+
+  // weightOffset carries what the stop model does not explain (scale bias, residual drip)
+  if (shot.start_us && shot.end_s && currentWeight >= (goalWeight - weightOffset) &&
+      shotSeconds() > shot.end_s + DRIP_DELAY_S)
+  {
+    shot.start_us          = 0;
+    shot.end_s             = 0;
+
+    LOG_INFO(TAG_SHOT, "Final weight: %.2fg, Goal: %dg, Offset: %.2fg", (float)currentWeight, goalWeight, weightOffset);
+    if (offsetModelRecord(goalWeight, weightOffset, currentWeight))
+      showOffset("");
     else
+      showOffset("Outlier ignored. ");
+  }
+}
+
+// Scale confirmed the start (sequencer on the BLE task): pump on as the first stage wants it
+static void armShot()
+{
+  shotArmPending = false;
+  if (shotLogDue)
+    logFinishedShot();  // Restarted within the drip delay - log what we have
+  shotLogDue = true;
+  cupDetectReset();  // The full cup must not read as a new one after the shot
+  shot.start_us = monoNowUs();
+  shot.shotTimer = 0.0f;
+  resetShotModel();
+  shotChartBegin(goalWeight);
+  lastTimerUpdate = millis();
+  shot.brewing = true;
+  uiChannelStartTimer(shot.start_us);
+
+  LOG_INFO(TAG_SHOT, "Control: Starting shot - turning ON pump");
+  const ShotProfile *profile = shotProfileActive();
+  shot.profile = shotProfileActiveIndex();
+  shot.predictor.select(profile->estimator);
+  ShotTraceModel model = {(float)goalWeight, weightOffset, stopModelLatencyS(),
+                          shot.predictor.filter.processNoise(), shot.predictor.filter.measurementNoise(),
+                          shot.predictor.selected(), shot.profile};
+  shotEventsShotArmed(shot.start_us, model);
+  profileRunner.begin(profile);
+  flowController.reset();
+  pumpOutputSetPower(profileRunner.targetFlowGs() > 0.0f ? profileRunner.targetFlowGs() / GS_FLOW_FULL_POWER_GS : 1.0f);
+  setRelayState(profileRunner.tick(0.0f, 0.0f));
+  startLatencyMark(START_HOP_RELAY);
+}
+
+/**
+ * @brief How long the control task may sleep before a decision is due
+ *
+ * Samples, relay cut-offs and shot start / stop wake it on their own
+ * (CONTROL_EVT_*); this covers the clock: shot timer, predicted stop,
+ * profile stage changes, flush status and the drip delay.
+ */
+static uint32_t controlTaskNextWaitMs()
+{
+  unsigned long now = millis();
+  uint32_t waitMs = CONTROL_TASK_MAX_WAIT_MS;
+
+  auto dueIn = [&](unsigned long since, unsigned long period) {
+    unsigned long elapsed = now - since;
+    uint32_t remaining = (elapsed >= period) ? 0 : (uint32_t)(period - elapsed);
+    if (remaining < waitMs)
+      waitMs = remaining;
+  };
+
+  // Shot timer, watchdogs, drip-delay offset learning, relay and flush status
+  // all run on TIMER_UPDATE_INTERVAL_MS resolution while a shot or flush is live
+  if (shot.brewing)
+  {
+    dueIn(lastTimerUpdate, TIMER_UPDATE_INTERVAL_MS);
+
+    // Wake right at the predicted stop instead of on the next timer tick
+    float stopAtS = max(shot.expected_end_s, (float)MIN_SHOT_DURATION_S);
+    float untilStopS = stopAtS - shotSeconds();
+    if (untilStopS > 0.0f && untilStopS * 1000.0f < waitMs)
+      waitMs = (uint32_t)(untilStopS * 1000.0f) + 1;
+
+    // Same for the profile's next stage change or pulse edge
+    float changeAtS = profileRunner.nextChangeS();
+    float untilChangeS = changeAtS - shotSeconds();
+    if (changeAtS >= 0.0f && untilChangeS * 1000.0f < waitMs)
+      waitMs = (untilChangeS > 0.0f) ? (uint32_t)(untilChangeS * 1000.0f) + 1 : 0;
+  }
+  else if (isFlushing || (shot.start_us && shot.end_s))
+    dueIn(now, TIMER_UPDATE_INTERVAL_MS);
+
+  return waitMs;
+}
+
+/**
+ * @brief Shot control loop (Core 0, above the BLE task)
+ *
+ * Owns the shot model: samples from updateScaleReadings(), the stop decision
+ * and scheduled cut, relay enforcement, MAX_SHOT_DURATION_S, timer and the
+ * drip / offset learning. Never calls into ArduinoBLE - scale commands go
+ * back through the BLE command lanes.
+ */
+// Raw sample + the filter state it left, for "capture on" (control task)
+static void captureSample(const ControlSample &sample, int64_t sampleUs)
+{
+  if (!sampleCaptureActive())
+    return;
+  WeightFilterState est = shot.predictor.filter.state();
+  bool brewing = shot.brewing;
+  CaptureSample record = {};
+  record.arrivalUs = sample.arrivalUs;
+  record.clockOffsetUs = (int32_t)(sampleUs - sample.arrivalUs);
+  record.rawG = sample.weight;
+  record.shotS = (brewing && shot.start_us) ? shotSeconds(sampleUs) : NAN;
+  record.filteredG = est.weight;
+  record.flowGs = est.flow;
+  record.weightSdG = sqrtf(est.weightVar);
+  record.expectedEndS = brewing ? shot.expected_end_s : 0.0f;
+  record.flags = (brewing ? CAPTURE_FLAG_BREWING : 0) | (shot.predictor.onset.dripped() ? CAPTURE_FLAG_DRIPPED : 0) |
+                 (shot.predictor.onset.flowing() ? CAPTURE_FLAG_FLOWING : 0) |
+                 (loadCellActive() ? CAPTURE_FLAG_LOAD_CELL : 0) |
+                 (uint8_t)(shot.predictor.anomaly.flags() << CAPTURE_FLAG_ANOMALY_SHIFT);
+  sampleCaptureRecord(record);
+}
+
+// This unit's state for the peer link; sent when due (control task)
+static void offerPeerFrame(bool bleSample)
+{
+  PeerFrame frame = {};
+  frame.flags = (shot.brewing ? PEER_FLAG_BREWING : 0) | (isFlushing ? PEER_FLAG_FLUSHING : 0) |
+                (scale.isConnected() ? PEER_FLAG_SCALE : 0) | (loadCellActive() ? PEER_FLAG_LOAD_CELL : 0);
+  frame.weightDg = (int16_t)lroundf(constrain(currentWeight, -3276.0f, 3276.0f) * 10.0f);
+  frame.flowCgs = (int16_t)lroundf(constrain(shot.predictor.filter.flow(), -327.0f, 327.0f) * 100.0f);
+  frame.timerDs = (uint16_t)lroundf(constrain(shot.shotTimer, 0.0f, 6553.0f) * 10.0f);
+  frame.expectedEndDs = (uint16_t)lroundf(constrain(shot.expected_end_s, 0.0f, 6553.0f) * 10.0f);
+  frame.goalG = goalWeight;
+  frame.profile = shotProfileActiveIndex();
+  peerLinkOffer(frame, bleSample);
+}
+
+void controlTaskFunction(void *parameter)
+{
+  watchdogRegister(WATCHDOG_CONTROL, CONTROL_WATCHDOG_MS, true);
+  relayControlNotify(xTaskGetCurrentTaskHandle(), CONTROL_EVT_RELAY_CUT);
+
+  while (true)
+  {
+    uint32_t waitMs = controlTaskNextWaitMs();
+    watchdogExpect(WATCHDOG_CONTROL, waitMs);
+    xTaskNotifyWait(0, UINT32_MAX, NULL, pdMS_TO_TICKS(waitMs));
+    watchdogCheckIn(WATCHDOG_CONTROL);
+
+    GS_TRACE_SCOPE("shot_control");
+    int64_t passStartUs = esp_timer_get_time();
+
+    if (shotArmPending)
+      armShot();
+
+    ControlSample sample;
+    bool sampled = false;
+    while (xQueueReceive(controlSamples, &sample, 0) == pdTRUE)
     {
-      weightOffset += currentWeight - goalWeight;
-      LOG_INFO(TAG_SHOT, "Final weight: %.2fg, Goal: %dg, New offset: %.2fg",
-               currentWeight, goalWeight, weightOffset);
-      saveOffset(static_cast<int>(weightOffset * 10.0f));
+      sampled = true;
+      controlSampleLagUs.record((uint32_t)(esp_timer_get_time() - sample.arrivalUs));
+      // Dated on the scale's sample grid, in esp_timer time (shares its base with millis())
+      int64_t sampleUs = sampleClock.update(sample.arrivalUs);
+      sampleArrivalDelayUs.record((uint32_t)(sample.arrivalUs - sampleUs));
+      shotEventsWeight(sample.weight, sampleUs, sample.arrivalUs);
+      processWeightSample(sample.weight, sampleUs);
+      captureSample(sample, sampleUs);
+      flowControlStep(sample.arrivalUs);
     }
+
+    updateShotTimer();
+    applyBleSettings();
+    applyConfigImport();
+    handleShotWatchdogs();
+    offerPeerFrame(sampled && !loadCellActive());
+
+    controlPassUs.record((uint32_t)(esp_timer_get_time() - passStartUs));
   }
 }
 
-extern uint32_t transfer_num;
-extern size_t lcd_PushColors_len;
+extern volatile uint32_t transfer_num;
+extern volatile size_t lcd_PushColors_len;
 
 // LVGL Freeze Detection - track when lv_timer_handler() was last called successfully
 static unsigned long lastLVGLTimerCall = 0;
 static unsigned long lvglTimerCallCount = 0;
 static bool lvglFreezeWarned = false;
 
-void LVGLTimerHandlerRoutine()
+/**
+ * @brief Run LVGL timers with freeze detection
+ * @return ms until the next LVGL timer is due (LV_NO_TIMER_READY if none)
+ */
+uint32_t LVGLTimerHandlerRoutine()
 {
   // CRITICAL: Don't call lv_timer_handler() before LVGL is initialized
   // This prevents crashes when BLE library calls this during early boot
   if (!lvglInitialized)
-    return;
+    return LV_NO_TIMER_READY;
 
   unsigned long now = millis();
 
@@ -2160,40 +2522,25 @@ void LVGLTimerHandlerRoutine()
       lvglFreezeWarned = true;
     }
   } else if (lvglFreezeWarned && (now - lastLVGLTimerCall) <= 3000) {
-    LOG_ERROR(TAG_UI, "✅ LVGL RECOVERED from freeze");
-    lvglFreezeWarned = false;
-  }
-
-  if (transfer_num <= 0 && lcd_PushColors_len <= 0)
-  {
-    // ===== DIAGNOSTIC: LVGL Timer Heartbeat =====
-    // Log BEFORE calling lv_timer_handler() to prove we reached this point
-    static unsigned long lastLvglHeartbeat = 0;
-    if (now - lastLvglHeartbeat > 1000) {  // Every 1 second
-      LOG_DEBUG(TAG_UI, "❤️  LVGL Timer alive: about to call lv_timer_handler()");
-      lastLvglHeartbeat = now;
-    }
-    // ===== END LVGL TIMER HEARTBEAT =====
-
-    lv_timer_handler();
-    lastLVGLTimerCall = now;
-    lvglTimerCallCount++;
-
-    // Log LVGL activity every 10 seconds for diagnostic purposes
-    // NOTE: This should always run at ~500-700 Hz - if it drops, there's a real freeze
-    static unsigned long lastActivityLog = 0;
-    if (now - lastActivityLog > 10000) {
-      LOG_DEBUG(TAG_UI, "📊 LVGL Activity: %lu timer calls in last 10s (~%lu Hz)",
-                lvglTimerCallCount, lvglTimerCallCount / 10);
-      lvglTimerCallCount = 0;
-      lastActivityLog = now;
-    }
+    LOG_ERROR(TAG_UI, "✅ LVGL RECOVERED from freeze");
+    lvglFreezeWarned = false;
   }
 
-  if (transfer_num <= 1 && lcd_PushColors_len > 0)
+  // No gating on transfer_num: rendering overlaps the DMA transfer. LVGL only waits
+  // (inside lv_timer_handler) when both draw buffers are busy.
+
+  uint32_t nextTimerMs;
   {
-    lcd_PushColors(0, 0, 0, 0, NULL);
+    GS_TRACE_SCOPE("lv_timer_handler");
+    GS_ALLOC_SCOPE(ALLOC_SCOPE_LVGL);
+    powerLockSet(POWER_LOCK_DISPLAY, true);  // Render + DMA queueing at full clock
+    nextTimerMs = lv_timer_handler();
+    powerLockSet(POWER_LOCK_DISPLAY, false);
   }
+  lastLVGLTimerCall = now;
+  lvglTimerCallCount++;
+
+  return nextTimerMs;
 }
 
 // -----------------------------------------------------------------------------
@@ -2207,16 +2554,17 @@ void setup()
   // =============================================================================
   // 0. NVS init - MUST be first (prevents double-init crash)
   // 1. Serial.begin() - For early boot messages
-  // 2. Create serialMutex - Required before any LOG_*() calls
+  // 2. Create serialMutex + log drain task - Required before any LOG_*() calls
   // 3. NimBLE init - Must claim radio BEFORE WiFi
   // 4. DEBUG_INIT() - WiFi setup (debug builds only), re-calls Serial.begin() safely
+  // 5. BLE task - scale scan/connect on Core 0 while display + UI init continue here
+  // Stages and milestones: boot_timing.h. Bring-up diagnostics only with GS_BOOT_DIAG.
   // =============================================================================
 
   unsigned long setupStartTime = millis();  // Track total setup duration
 
-  // Reduce CPU frequency for lower power consumption and heat generation
-  // 160 MHz = 33% less power than 240 MHz, still fast enough for LVGL @ 60 Hz + BLE
-  setCpuFrequencyMhz(160);
+  // Before anything records: keep what the previous run left in the crash ring
+  crashRingBegin();
 
   // Step 0: Initialize NVS (Non-Volatile Storage) FIRST - before WiFi or BLE
   // This prevents both radios from trying to initialize NVS independently
@@ -2230,27 +2578,31 @@ void setup()
 
   // Step 1: Initialize Serial (production builds need this, debug builds will re-init)
   Serial.begin(115200);
+#if GS_BOOT_DIAG
   delay(500);  // Delay for Serial to stabilize (increased for reliability)
+#endif
 
   // DIAGNOSTIC: Log NVS + Serial init duration (early boot, before mutex)
   Serial.printf("⏱️  SETUP[%04lums]: NVS + Serial initialized\n", millis() - setupStartTime);
 
   // Step 2: Create serial mutex BEFORE any LOG_*() calls
   // This prevents output fragmentation when multiple tasks print simultaneously
-  serialMutex = xSemaphoreCreateMutex();
-  if (serialMutex == NULL) {
-    // CRITICAL: Can't use LOG_*() here - mutex creation failed!
-    // This is the ONLY place where raw Serial.println() is acceptable
-    Serial.println("\n\n=== BOOT FAILURE ===");
-    Serial.println("[FATAL] Failed to create serialMutex!");
-    Serial.println("System halted - restart required");
-    while(1) delay(1000);  // Halt - critical failure
-  }
+  serialMutex = serialMutexStore.create();  // Static storage - cannot fail
 
   // Mutex created successfully - can now use LOG_*() macros safely
+  // From here on LOG_*() only queues the line; the drain task does the I/O
+  logRingBegin();
+  logRingSetCommandHandler(handleSerialCommand);
+  traceBegin();
+  GS_PROBE_BEGIN();
+  taskStatsBegin();
+  healthMonitorBegin();
+  // CPU clock follows activity: GS_PM_MAX_MHZ for shots, frames and BLE connection
+  // setup, GS_PM_MIN_MHZ otherwise (power_manager.h)
+  powerManagerBegin();
   LOG_INFO(TAG_SYS, "");
   LOG_INFO(TAG_SYS, "=== BOOT START ===");
-  LOG_INFO(TAG_SYS, "CPU frequency: %d MHz (reduced from 240 MHz for power savings)", getCpuFrequencyMhz());
+  LOG_INFO(TAG_SYS, "CPU frequency: %d MHz (%d-%d MHz by activity)", getCpuFrequencyMhz(), GS_PM_MIN_MHZ, GS_PM_MAX_MHZ);
   LOG_INFO(TAG_SYS, "Serial initialized @ 115200 baud");
   LOG_INFO(TAG_SYS, "FreeRTOS mutex created successfully");
   LOG_INFO(TAG_SYS, "⏱️  SETUP[%04lums]: Mutex created", millis() - setupStartTime);
@@ -2272,9 +2624,12 @@ void setup()
     default:                reason_str = "Unknown reset"; break;
   }
 
+#if GS_BOOT_DIAG
   // CRITICAL: Wait for USB CDC to reconnect BEFORE printing
   // Serial monitor drops connection during reset, needs time to reconnect
+  // (without the wait the LOG_ERROR copy below still reaches the log ring)
   delay(500);
+#endif
 
   // FORCE output with raw Serial (bypasses all log filtering - GUARANTEED to show)
   Serial.println("\n\n╔═══════════════════════════════════════════╗");
@@ -2324,48 +2679,48 @@ void setup()
   // BACKUP: Log reset reason again via LOG_ERROR (in case raw Serial was missed)
   // This provides redundancy if USB CDC wasn't connected during early boot
   LOG_ERROR(TAG_SYS, "🔄 RESET REASON: %s", reason_str);
+  crashRingReport();
+  coreDumpBegin();
+  otaBegin();  // A fresh update that never validated falls back here
 
   // Step 4: Initialize WiFi (debug builds only) via DEBUG_INIT()
   // NimBLE is already running, WiFi will coexist properly
   // Note: DEBUG_INIT() calls Serial.begin() again - this is safe (no-op on already-initialized serial)
   phaseStartTime = millis();
   DEBUG_INIT();  // Production: no-op, Debug builds: WiFi+WebSerial setup
+#if GS_BOOT_DIAG
   delay(500);    // Brief delay for WiFi connection (if enabled)
+#endif
   LOG_INFO(TAG_SYS, "⏱️  SETUP[%04lums]: WiFi/Debug init took %lums", millis() - setupStartTime, millis() - phaseStartTime);
 
   LOG_INFO(TAG_SYS, "=== Gravimetric Shots Initializing ===");
 
-  // Initialize PMU (Power Management Unit) for LED control
+  // Initialize PMU (Power Management Unit): status LED off, telemetry sampler
   // T-Display-S3-Long uses SY6970 on I2C pins: SDA=15, SCL=10 (same as touch)
   phaseStartTime = millis();
   Wire.begin(TOUCH_IICSDA, TOUCH_IICSCL);  // Touch controller pins (also used for PMU)
   Wire.setClock(100000);  // 100kHz for reliability under thermal stress
-  if (PMU.init(Wire, TOUCH_IICSDA, TOUCH_IICSCL, SY6970_SLAVE_ADDRESS))
-  {
-    PMU.disableStatLed();  // Turn off green charging indicator LED
-    LOG_INFO(TAG_SYS, "PMU initialized, status LED disabled");
-  }
-  else
-  {
-    LOG_WARN(TAG_SYS, "PMU init failed (LED control unavailable)");
-  }
+  i2cBusBegin();          // Job queues; the touch task takes ownership in touchInputBegin()
+  powerTelemetryBegin(TOUCH_IICSDA, TOUCH_IICSCL);  // Samples run on the touch task, between touches
   LOG_INFO(TAG_SYS, "⏱️  SETUP[%04lums]: PMU init took %lums", millis() - setupStartTime, millis() - phaseStartTime);
 
-  // Initialize task watchdog (20 second timeout) - auto-reboot on hang
-  // CRITICAL: Increased from 10s to 20s to accommodate BLE discovery delays
-  // peripheral.discoverAttributes() can take 1-10+ seconds during reconnection
-  // 20s provides safety margin while still catching real freezes
+  // Watchdog supervisor: the only TWDT subscriber. BLE, render, DMA and touch
+  // register their own deadlines when they start; long blocking calls (BLE
+  // discovery) declare their budget instead of feeding the TWDT from inside.
   phaseStartTime = millis();
-  esp_task_wdt_init(20, true);  // 20s timeout, panic & reboot on trigger
-  esp_task_wdt_add(NULL);       // Add current task to watchdog
-  LOG_INFO(TAG_SYS, "Task watchdog enabled (20s timeout)");
+  watchdogBegin();
   LOG_INFO(TAG_SYS, "⏱️  SETUP[%04lums]: Watchdog init took %lums", millis() - setupStartTime, millis() - phaseStartTime);
 
-  preferences.begin("myApp", false);                       // Open the preferences with a namespace and read-only flag
-  brightness = preferences.getInt(BRIGHTNESS_KEY, 0);      // Read the brightness value from preferences
-  goalWeight = preferences.getInt(WEIGHT_KEY, 0);          // Read the target weight value from preferences
-  weightOffset = preferences.getInt(OFFSET_KEY, 0) / 10.0; // Read the offset value from preferences
+  journalBegin();                                          // Settings + offsets journal, replayed in one pass
+  settingsStoreBegin();                                    // Brightness + goal weight (one blob)
+  brightness = settingsGet().brightnessPct;
+  goalWeight = settingsGet().goalWeightG;
+  cupDetectSetMode(settingsGet().cupMode);
+  preferences.begin("myApp", true);                        // Open the preferences read-only
+  weightOffset = preferences.getInt(OFFSET_KEY, 0) / 10.0; // Legacy single offset, seeds the first profile
   preferences.end();                                       // Close the preferences
+  stopModelBegin();                                        // Learned stop latency (own namespace)
+  shotStatsBegin();                                        // Per-profile accuracy, this build and the last (own namespace)
 
   LOG_DEBUG(TAG_SYS, "Brightness read from preferences: %d", brightness);
   LOG_DEBUG(TAG_SYS, "Goal Weight retrieved: %d", goalWeight);
@@ -2383,6 +2738,11 @@ void setup()
     LOG_INFO(TAG_SYS, "Offset set to: %.1f g", weightOffset);
   }
 
+  offsetModelBegin(goalWeight, weightOffset);             // Per-goal offset profiles (journal)
+  weightOffset = offsetModelGet(goalWeight, NULL);
+  offsetGoal = goalWeight;
+  shotProfilesBegin();                                     // Staged recipes (own namespace)
+
   if ((brightness < 0) || (brightness > 100)) // If preferences isn't initialized set brightness to 50%
   {
     brightness = 50;
@@ -2391,33 +2751,49 @@ void setup()
 
   // initialize the GPIO hardware
   // To add in progress
-  pinMode(RELAY1, OUTPUT); // RELAY 1 Output
-  relayState = true; // force update on first set
-  setRelayState(false);
+  for (uint8_t g = 0; g < GS_GROUP_COUNT; g++)
+    relayControlBegin(shotGroupConfig(g).relayPin, g);  // Relay outputs, start LOW
+  pumpOutputBegin();         // Pump power stage (GS_PUMP_OUTPUT), full power
+  cleanProgramBegin();       // Flush / backflush programs + reminder from the settings blob
+
+  // ===== SCALE STAGE: BLE task first =====
+  // Scanning + connecting take seconds; they run on Core 0 while touch, display
+  // and UI init continue here. The BLE task never touches LVGL - status and
+  // weight go through the UI channel, which holds them until the UI task exists.
+  char crashText[UI_STATUS_TEXT_LEN];
+  if (coreDumpStatusText(crashText, sizeof(crashText)))
+    setStatusLabels(STATUS_BOOT, crashText);  // Until the scale link reports (events wait its hold)
+
+  // Shot weight curve (PSRAM when available) - before the BLE task can record into it
+  shot.samples.allocate(SHOT_HISTORY_CAP);
+  shotEventsBegin();
+  shotLogBegin();
+  shotPublishBegin();
+
+  // Create FreeRTOS command queue
+  bleCommandsBegin();
+
+  // Shot control first: the BLE task hands it samples from its first packet
+  controlSamples = controlSampleStore.create();
+  if (taskLayoutSpawn(TASK_ROLE_CONTROL, controlTaskFunction, NULL, &controlTaskHandle) != pdPASS) {
+    LOG_ERROR(TAG_TASK, "Failed to create the shot control task!");
+    while(1) delay(1000);  // Halt - critical failure
+  }
+  loadCellBegin(onLoadCellSample);  // Wired cell → the same sample queue (GS_LOAD_CELL builds)
+  peerLinkBegin();                  // ESP-NOW after BLE and the debug Wi-Fi (GS_PEER_LINK builds)
+
+  // Create BLE task on Core 0 (BLE/WiFi core)
+  LOG_INFO(TAG_TASK, "Creating BLE task on Core 0...");
+
+  BaseType_t bleTaskResult = taskLayoutSpawn(TASK_ROLE_BLE_HOST, bleTaskFunction, NULL, &bleTaskHandle);
+  if (bleTaskResult != pdPASS) {
+    LOG_ERROR(TAG_TASK, "Failed to create BLE task!");
+    while(1) delay(1000);  // Halt - critical failure
+  }
+  LOG_INFO(TAG_TASK, "⏱️  SETUP[%04lums]: BLE task created, display init runs in parallel", millis() - setupStartTime);
 
-  // NimBLE server functionality DISABLED (reverted to ArduinoBLE for stability)
-  // Weight advertising to external devices is optional - not essential for core functionality
-  LOG_DEBUG(TAG_SYS, "NimBLE server disabled (ArduinoBLE mode)");
-  // COMMENTED OUT: NimBLE server code removed for ArduinoBLE compatibility
-  // pServer = NimBLEDevice::createServer();
-  // if (pServer) {
-  //   pWeightService = pServer->createService("00002a98-0000-1000-8000-00805f9b34fb");
-  //   if (pWeightService) {
-  //     pWeightCharacteristic = pWeightService->createCharacteristic(
-  //       "0x2A98",
-  //       NIMBLE_PROPERTY::READ | NIMBLE_PROPERTY::WRITE
-  //     );
-  //     if (pWeightCharacteristic) {
-  //       uint8_t initialValue = 36;
-  //       pWeightCharacteristic->setValue(&initialValue, 1);
-  //     }
-  //     pWeightService->start();
-  //   }
-  //   NimBLEAdvertising* pAdvertising = NimBLEDevice::getAdvertising();
-  //   pAdvertising->addServiceUUID("00002a98-0000-1000-8000-00805f9b34fb");
-  //   pAdvertising->start();
-  //   LOG_INFO(TAG_SYS, "NimBLE server ready");
-  // }
+  // ===== DISPLAY STAGE =====
+  // (Weight re-broadcast to phone apps starts in the BLE task: weight_broadcast.h)
 
   pinMode(TOUCH_RES, OUTPUT);
   digitalWrite(TOUCH_RES, HIGH);
@@ -2430,76 +2806,47 @@ void setup()
   Wire.begin(TOUCH_IICSDA, TOUCH_IICSCL);
   Wire.setClock(100000);  // 100kHz for reliability under thermal stress
 
+  delay(50);  // Give touch controller time to boot after reset
+
+#if GS_BOOT_DIAG
   // DIAGNOSTIC: Test touch controller I2C communication after reset
   LOG_INFO(TAG_UI, "═══════════════════════════════════════════════");
   LOG_INFO(TAG_UI, "  🔬 TOUCH CONTROLLER (CST816) INITIALIZATION TEST");
   LOG_INFO(TAG_UI, "═══════════════════════════════════════════════");
   LOG_INFO(TAG_UI, "Touch reset: GPIO %d (toggled LOW 10ms, now HIGH)", TOUCH_RES);
   LOG_INFO(TAG_UI, "I2C pins: SDA=GPIO %d, SCL=GPIO %d", TOUCH_IICSDA, TOUCH_IICSCL);
-
-  delay(50);  // Give touch controller time to boot after reset
-
-  // ===== I2C BUS SPEED TESTING =====
-  // Test different I2C clock speeds to find optimal reliability
-  LOG_INFO(TAG_UI, "Testing I2C bus speeds...");
-
-  // Test 100 kHz (current default)
-  Wire.setClock(100000);
-  delay(100);
-  Wire.beginTransmission(0x3B);
-  uint8_t err_100k = Wire.endTransmission();
-  LOG_INFO(TAG_UI, "  100 kHz: %s (error=%d)", err_100k == 0 ? "✅ ACK" : "❌ NACK", err_100k);
-
-  // Test 50 kHz (slower = more reliable in noisy environment)
-  Wire.setClock(50000);
-  delay(100);
-  Wire.beginTransmission(0x3B);
-  uint8_t err_50k = Wire.endTransmission();
-  LOG_INFO(TAG_UI, "  50 kHz: %s (error=%d)", err_50k == 0 ? "✅ ACK" : "❌ NACK", err_50k);
-
-  // Test 20 kHz (very slow but maximum reliability)
-  Wire.setClock(20000);
-  delay(100);
-  Wire.beginTransmission(0x3B);
-  uint8_t err_20k = Wire.endTransmission();
-  LOG_INFO(TAG_UI, "  20 kHz: %s (error=%d)", err_20k == 0 ? "✅ ACK" : "❌ NACK", err_20k);
-
-  // Use 100 kHz as default (standard I2C speed)
-  Wire.setClock(100000);
-  LOG_INFO(TAG_UI, "Using 100 kHz I2C clock (standard speed)");
-  LOG_INFO(TAG_UI, "");
   LOG_INFO(TAG_UI, "ℹ️  IMPORTANT: This custom CST816 variant returns [AF AF AF...] when idle.");
   LOG_INFO(TAG_UI, "   This is NORMAL behavior - NOT an error. Controller signals 'no touch'.");
   LOG_INFO(TAG_UI, "   Only [00 00 00...] patterns indicate true I2C bus corruption.");
-  // ===== END I2C BUS SPEED TESTING =====
+  LOG_INFO(TAG_UI, "═══════════════════════════════════════════════");
+#endif // GS_BOOT_DIAG
 
-  // Final ACK test at chosen speed
-  Wire.beginTransmission(0x3B);
-  uint8_t i2c_test_error = Wire.endTransmission();
-  if (i2c_test_error == 0) {
-    LOG_INFO(TAG_UI, "✅ Touch controller ACK at address 0x3B (100 kHz)");
-  } else {
-    LOG_ERROR(TAG_UI, "❌ Touch controller NO ACK at 0x3B (error=%d)", i2c_test_error);
-    LOG_ERROR(TAG_UI, "   Error codes: 1=too long, 2=NACK addr, 3=NACK data, 4=other");
-  }
+  // Last boot's working clock + one ACK check; speed probes only after errors or a NACK
+  touchClockBegin();
+  touchCalibBegin();  // Panel → landscape transform + jump thresholds (NVS correction if stored)
 
   // NOTE: Touch controller uses CUSTOM protocol (not standard CST816)
   // ChipID register 0xA7 is NOT supported - reading it causes controller confusion and crashes
   // LilyGO lvgl_demo.ino does NOT send ANY I2C commands to touch controller during setup()!
-  // First touch I2C transaction happens naturally in my_touchpad_read() during loop()
+  // First touch I2C transaction happens in the touch task on the first INT edge
   // Sending test commands (like 0xD0) can put controller into undefined state
-  LOG_INFO(TAG_UI, "═══════════════════════════════════════════════");
 
-  pinMode(TFT_BL, OUTPUT);    // initialized TFT Backlight Pin as output
-  digitalWrite(TFT_BL, LOW);  // Keep backlight OFF during initialization to prevent noise/garbage display
+  // From here on the touch task owns Wire (PMU telemetry runs on it between touches)
+  touchInputBegin();
+
+  displayPowerBegin();  // Backlight on LEDC, OFF during initialization to prevent noise/garbage display
 
   phaseStartTime = millis();
-  axs15231_init(); // initialized Screen
+  displayTransport().init();  // Panel up (GS_DISPLAY_TRANSPORT)
+  lcdClockBegin();  // Stored / calibrated QSPI clock, backlight still off
+  bootSplashBegin(brightness);  // Lit from here; LVGL and the screens are built behind it
   LOG_INFO(TAG_SYS, "⏱️  SETUP[%04lums]: Display init took %lums", millis() - setupStartTime, millis() - phaseStartTime);
 
   phaseStartTime = millis();
   lv_init(); // initialized LVGL
+  uiAssetsBegin(); // Icon decoder over the mapped "assets" partition, before any screen exists
   LOG_INFO(TAG_SYS, "⏱️  SETUP[%04lums]: LVGL init took %lums", millis() - setupStartTime, millis() - phaseStartTime);
+  bootSplashProgress(20);
 
   // ===== DIAGNOSTIC: Register LVGL log callback =====
   // Route LVGL internal logs through our logging system
@@ -2513,7 +2860,7 @@ void setup()
       if (len > 0 && clean_msg[len - 1] == '\n') {
         clean_msg[len - 1] = '\0';
       }
-      LOG_WARN("LVGL", "%s", clean_msg);
+      LOG_WARN(LOG_TAG_LVGL, "%s", clean_msg);
     });
     LOG_INFO(TAG_SYS, "✅ LVGL logging enabled (callback registered)");
   #endif
@@ -2521,7 +2868,23 @@ void setup()
 
   // Display init code
   {
-    size_t buffer_pixels = EXAMPLE_LCD_H_RES * EXAMPLE_LCD_V_RES;
+    size_t buffer_pixels = 0;
+#if GS_DRAW_STRIPE_ROWS > 0
+    // Two stripes in internal DRAM: LVGL renders there instead of into PSRAM, and the
+    // bounce task rotates out of one while the next is drawn into the other
+    static_assert(GS_DRAW_STRIPE_ROWS % LCD_COL_ALIGN == 0, "Stripes must keep the panel's column granularity");
+    buf = drawStripes[0];
+    buf1 = drawStripes[1];
+    buffer_pixels = (size_t)UI_HOR_RES * GS_DRAW_STRIPE_ROWS;
+    LOG_INFO(TAG_SYS, "💾 Draw stripes in DRAM at %p / %p (%d rows, %zu bytes each)", buf, buf1,
+             GS_DRAW_STRIPE_ROWS, sizeof(drawStripes[0]));
+#elif GS_PSRAM_BSS_AVAILABLE
+    buf = drawFrames[0];
+    buf1 = drawFrames[1];
+    buffer_pixels = EXAMPLE_LCD_H_RES * EXAMPLE_LCD_V_RES;
+    LOG_INFO(TAG_SYS, "💾 Draw frames in PSRAM .bss at %p / %p (%zu bytes each)", buf, buf1, sizeof(drawFrames[0]));
+#else
+    buffer_pixels = EXAMPLE_LCD_H_RES * EXAMPLE_LCD_V_RES;
     size_t buffer_size = sizeof(lv_color_t) * buffer_pixels;
     buf = (lv_color_t *)ps_malloc(buffer_size);
     if (buf == NULL)
@@ -2532,8 +2895,6 @@ void setup()
         delay(500);
       }
     }
-    // DIAGNOSTIC: Save initial buffer address for integrity checks
-    buf_initial = buf;
     LOG_INFO(TAG_SYS, "💾 PSRAM buf allocated at %p (%zu bytes)", buf, buffer_size);
 
     buf1 = (lv_color_t *)ps_malloc(buffer_size);
@@ -2545,39 +2906,50 @@ void setup()
         delay(500);
       }
     }
-    // DIAGNOSTIC: Save initial buffer address for integrity checks
-    buf1_initial = buf1;
     LOG_INFO(TAG_SYS, "💾 PSRAM buf1 allocated at %p (%zu bytes)", buf1, buffer_size);
+#endif
 
     lv_disp_draw_buf_init(&draw_buf, buf, buf1, buffer_pixels);
     /*Initialize the display*/
     static lv_disp_drv_t disp_drv;
     lv_disp_drv_init(&disp_drv);
+    drawS3Begin(&disp_drv);  // PIE fill / copy, SWAR opacity blend (draw_s3.h)
     /*Change the following line to your display resolution*/
-    disp_drv.hor_res = EXAMPLE_LCD_H_RES;
-    disp_drv.ver_res = EXAMPLE_LCD_V_RES;
+    // Render directly in landscape - no LVGL sw_rotate pass. The driver rotates
+    // to the panel's portrait scan while filling its DMA bounce buffers.
+    disp_drv.hor_res = UI_HOR_RES;
+    disp_drv.ver_res = UI_VER_RES;
     disp_drv.flush_cb = my_disp_flush;
     disp_drv.draw_buf = &draw_buf;
-    disp_drv.sw_rotate = 1; // If you turn on software rotation, Do not update or replace LVGL
-    disp_drv.rotated = LV_DISP_ROT_270;
-    disp_drv.full_refresh = 1; // full_refresh must be 1 (partial refresh causes smearing)
-    lv_disp_drv_register(&disp_drv);
+    disp_drv.full_refresh = 0; // Partial refresh - my_disp_rounder keeps areas on the panel's window granularity
+    disp_drv.rounder_cb = my_disp_rounder;
+    disp_drv.wait_cb = my_disp_wait;  // Block on DMA completion instead of spinning
+    flushCoalesceBegin(lv_disp_drv_register(&disp_drv));  // Merge scattered dirty areas into fewer windows
+    displayTransport().attach(&disp_drv);  // The transport completes flushes on this driver
+    displayDiagBegin(&disp_drv);      // Flush statistics reporter (GS_DISPLAY_DIAG)
+    framePacerBegin(&disp_drv);       // Adaptive refresh period (monitor_cb measures refresh cost)
 
     static lv_indev_drv_t indev_drv;
     lv_indev_drv_init(&indev_drv);
     indev_drv.type = LV_INDEV_TYPE_POINTER;
     indev_drv.read_cb = my_touchpad_read;
-    lv_indev_drv_register(&indev_drv);
+    touchIndev = lv_indev_drv_register(&indev_drv);
   }
+  bootSplashProgress(35);
 
+#if GS_BOOT_DIAG
   // ===== CRITICAL: Turn on backlight BEFORE hardware test =====
   // The test pattern must be visible when backlight is ON
-  // Previously, backlight was turned on AFTER UI rendering, making test pattern invisible
-  int LCDBrightness = map(brightness, 0, 100, 70, 256);
-  analogWrite(TFT_BL, LCDBrightness);
-  LOG_INFO(TAG_UI, "🔆 Backlight ON EARLY for hardware test: PWM=%d (brightness=%d%%)", LCDBrightness, brightness);
+  // Production builds switch it on after the first frame instead (no test pattern)
+  displayPowerBacklightOn(brightness);
+  LOG_INFO(TAG_UI, "🔆 Backlight ON EARLY for hardware test (brightness=%d%%)", brightness);
   delay(100);  // Allow backlight to stabilize
+#endif
+
+  // Reproducible push / render numbers before the real UI exists (GS_DISPLAY_BENCH builds)
+  displayBenchRun(lv_disp_get_default()->driver);
 
+#if GS_BOOT_DIAG
   // ===== DIAGNOSTIC: Display Hardware Test =====
   // Test if display hardware is working BEFORE initializing UI
   // This helps determine if the problem is display hardware or LVGL rendering
@@ -2587,12 +2959,10 @@ void setup()
   LOG_INFO(TAG_UI, "  🔆 BACKLIGHT IS NOW ON - SQUARES SHOULD BE VISIBLE");
   LOG_INFO(TAG_UI, "═══════════════════════════════════════════════");
 
-  // Allocate buffer on HEAP (not stack!) to avoid heap corruption
+  // Static buffer (not stack, not heap) - only in GS_BOOT_DIAG builds
   #define TEST_SIZE 40
-  uint16_t* testPixels = (uint16_t*)malloc(TEST_SIZE * TEST_SIZE * sizeof(uint16_t));
-  if (testPixels == NULL) {
-    LOG_ERROR(TAG_UI, "❌ Failed to allocate test buffer - skipping hardware test");
-  } else {
+  static uint16_t testPixels[TEST_SIZE * TEST_SIZE];
+  {
     // Test RED
     for (int i = 0; i < TEST_SIZE * TEST_SIZE; i++) {
       testPixels[i] = 0xF800;  // RGB565 red
@@ -2617,8 +2987,6 @@ void setup()
     lcd_PushColors(10, 60, TEST_SIZE, TEST_SIZE, testPixels);
     delay(50);
 
-    free(testPixels);  // Free heap memory
-
     LOG_INFO(TAG_UI, "✅ Hardware test complete - check for colored squares on display");
     LOG_INFO(TAG_UI, "   Expected: RED at (10,10), GREEN at (60,10), BLUE at (10,60)");
     LOG_INFO(TAG_UI, "═══════════════════════════════════════════════");
@@ -2626,11 +2994,39 @@ void setup()
     delay(2000);  // Hold test pattern for 2 seconds before UI init
   }
   // ===== END DIAGNOSTIC =====
+#endif // GS_BOOT_DIAG
 
   phaseStartTime = millis();
   ui_init(); // initialized LVGL UI intereface
+  uiIntentSetHandler(handleUiIntent);
+  weightLabel.attach();  // "  0.0" instead of the SquareLine placeholders until the first change
+  timerLabel.attach();
+  shotClockTimer = lv_timer_create(shotClockTick, FRAME_PERIOD_SHOT_MAX_MS, NULL);
+  lv_timer_pause(shotClockTimer);  // Until a shot starts
+  shotChartCreate(ui_Container2); // Extraction chart joins the button row (flex layout places it)
+  shotHistoryCreate(ui_SettingScreen); // History button; the screen is built on first use
+  scalePickerCreate(ui_SettingScreen, &scale, onScalePicked);
+  shotStatsCreate(ui_SettingScreen); // Stats button; the screen is built on first use
+  screenNavBegin();  // After the history / picker buttons joined the settings layout
+  screenNavSetLoadHandler(syncShownScreen);
+  uiAssetsInstrument(ui_MainScreen);   // Icon draws → image cache lookups in "metrics"
+  uiAssetsInstrument(ui_SettingScreen);
+  {
+    // Never changed after ui_init(): containers, prefix labels, icons. Value labels, buttons,
+    // the Bluetooth icon and the shot chart stay live on top of the cached background.
+    lv_obj_t *const mainStatics[] = {
+      ui_Container9, ui_Container2, ui_Panel1, ui_Container11, ui_TimerImage, ui_TimerPrefixLabel,
+      ui_Container8, ui_Container12, ui_ScaleImage, ui_ScalePrefixLabel, ui_Container15, ui_Container3,
+      ui_Container4, ui_SerialImage, ui_SerialPrefixLabel, ui_Container1,
+    };
+    layerCacheBegin(ui_MainScreen, mainStatics, sizeof(mainStatics) / sizeof(mainStatics[0]));
+  }
   LOG_INFO(TAG_SYS, "⏱️  SETUP[%04lums]: UI init took %lums", millis() - setupStartTime, millis() - phaseStartTime);
+  bootSplashProgress(80);
+
+  lv_disp_t* disp = lv_disp_get_default();
 
+#if GS_BOOT_DIAG
   // ===== DIAGNOSTIC: LVGL Widget Tree Validation =====
   LOG_INFO(TAG_UI, "═══════════════════════════════════════════════");
   LOG_INFO(TAG_UI, "  🔬 LVGL WIDGET TREE VALIDATION");
@@ -2665,7 +3061,6 @@ void setup()
   }
 
   // Check display driver
-  lv_disp_t* disp = lv_disp_get_default();
   if (disp && disp->driver) {
     LOG_INFO(TAG_UI, "✅ Display driver registered: %dx%d",
              disp->driver->hor_res, disp->driver->ver_res);
@@ -2677,23 +3072,31 @@ void setup()
 
   LOG_INFO(TAG_UI, "═══════════════════════════════════════════════");
   // ===== END DIAGNOSTIC =====
+#endif // GS_BOOT_DIAG
 
   // CRITICAL: Mark LVGL as initialized - safe to call lv_timer_handler() now
   // This prevents crashes when BLE library tries to keep UI responsive during connection
   lvglInitialized = true;
+  taskStatsOverlayBegin();  // CPU load label on the system layer (GS_CPU_OVERLAY builds)
 
   // Force LVGL to render the first frame before turning on backlight
   // This prevents showing uninitialized frame buffer (noise/garbage)
   LOG_INFO(TAG_UI, "Rendering initial UI frame before backlight ON...");
 
-  // CRITICAL FIX: Use lv_timer_handler() for LVGL v8 (lv_task_handler() was deprecated in v7)
-  for (int i = 0; i < 10; i++) {
-    lv_timer_handler();  // LVGL v8.x API (correct)
-    delay(5);            // Small delay to allow rendering to complete
-  }
+  // Render + flush the whole screen now instead of waiting for the refresh timer
+  // (the last area may still be in DMA on return; my_disp_flush marks BOOT_FIRST_FRAME)
+  phaseStartTime = millis();
+  bootSplashProgress(100);
+  lv_refr_now(disp);
+  bootSplashEnd();  // The whole first frame replaced it
+  LOG_INFO(TAG_SYS, "⏱️  SETUP[%04lums]: First frame took %lums", millis() - setupStartTime, millis() - phaseStartTime);
+
+#if !GS_BOOT_DIAG
+  displayPowerBacklightOn(brightness);  // Backlight on a finished frame - no garbage (on with the splash already)
+  LOG_INFO(TAG_UI, "🔆 Backlight ON (brightness=%d%%)", brightness);
+#endif
 
   // Verify LVGL display is properly initialized
-  disp = lv_disp_get_default();  // Reuse disp variable from widget validation above
   if (disp && disp->driver) {
     LOG_INFO(TAG_UI, "✅ LVGL display still valid after rendering: %dx%d",
              disp->driver->hor_res, disp->driver->ver_res);
@@ -2701,8 +3104,7 @@ void setup()
     LOG_ERROR(TAG_UI, "❌ LVGL display NOT initialized - display will be blank!");
   }
 
-  // NOTE: Backlight already turned ON earlier (before hardware test) - no need to turn on again
-  LOG_INFO(TAG_UI, "UI rendering complete - backlight already ON from hardware test phase");
+  LOG_INFO(TAG_UI, "UI rendering complete");
 
   // initialized the Backlight Slider and Label Value
   lv_slider_set_value(ui_BacklightSlider, brightness, LV_ANIM_OFF);
@@ -2718,58 +3120,43 @@ void setup()
   lv_label_set_text_static(ui_BacklightLabel, backlightLabelBuffer);
 
   // Initialized PresetWeight Slider and Label Value.
+  lv_slider_set_value(ui_PresetWeightSlight, goalWeight, LV_ANIM_OFF);
   dtostrf(goalWeight, 3, 0, buffer);
   snprintf(presetWeightLabelBuffer, sizeof(presetWeightLabelBuffer), "%s g", buffer);
   lv_label_set_text_static(ui_PresetWeightLabel, presetWeightLabelBuffer);
 
 
   LOG_INFO(TAG_SYS, "Flash size: %u bytes", ESP.getFlashChipSize());
-  LOG_INFO(TAG_SYS, "App partition: %u used / %u bytes total", ESP.getSketchSize(), ESP.getSketchSize() + ESP.getFreeSketchSpace());
-  LOG_INFO(TAG_SYS, "Heap total: %u bytes, free: %u bytes", ESP.getHeapSize(), ESP.getFreeHeap());
-  LOG_INFO(TAG_SYS, "PSRAM total: %u bytes, free: %u bytes", ESP.getPsramSize(), ESP.getFreePsram());
+  buildProfileLog();  // Profile, app / heap / PSRAM sizes ("build" for the speed summary)
   LOG_INFO(TAG_SYS, "Setup Completed");
 
   // Initialize touch time tracking
   lastTouchTime = millis();
 
-  // Create FreeRTOS mutex and queue
-  bleDataMutex = xSemaphoreCreateMutex();
-  if (bleDataMutex == NULL) {
-    LOG_ERROR(TAG_TASK, "Failed to create bleDataMutex!");
-    while(1) delay(1000);  // Halt - critical failure
-  }
-
-  bleCommandQueue = xQueueCreate(10, sizeof(BLECommandMessage));
-  if (bleCommandQueue == NULL) {
-    LOG_ERROR(TAG_TASK, "Failed to create bleCommandQueue!");
-    while(1) delay(1000);  // Halt - critical failure
-  }
+  // Create UI task on Core 1 - from here on it is the ONLY caller of LVGL,
+  // setup() must not touch LVGL objects after this point
+  LOG_INFO(TAG_TASK, "Creating UI task on Core 1...");
 
-  uiUpdateQueue = xQueueCreate(20, sizeof(UIUpdateMessage));
-  if (uiUpdateQueue == NULL) {
-    LOG_ERROR(TAG_TASK, "Failed to create uiUpdateQueue!");
+  BaseType_t uiTaskResult = taskLayoutSpawn(TASK_ROLE_RENDER, uiTaskFunction, NULL, &uiTaskHandle);
+  if (uiTaskResult != pdPASS) {
+    LOG_ERROR(TAG_TASK, "Failed to create UI task!");
     while(1) delay(1000);  // Halt - critical failure
   }
 
-  // Create BLE task on Core 0 (BLE/WiFi core)
-  LOG_INFO(TAG_TASK, "Creating BLE task on Core 0...");
+  // DMA flush completion wakes the UI task (my_disp_wait / next refresh)
+  lcd_set_flush_notify_task(uiTaskHandle);
+  // Published touch frames wake the UI task (resumes the indev read timer)
+  touchInputSetConsumer(uiTaskHandle);
 
-  xTaskCreatePinnedToCore(
-      bleTaskFunction,       // Task function
-      "BLE_Task",            // Task name
-      20480,                 // Stack size (20KB - increased from 16KB)
-      NULL,                  // Parameters
-      2,                     // Priority (higher than main loop = 1)
-      &bleTaskHandle,        // Task handle
-      0                      // Core 0 (BLE/WiFi core)
-  );
+  // UI channel updates wake the UI task (BLE weight/timer/status/connection)
+  uiChannelSetConsumer(uiTaskHandle);
+  shotStateSetConsumer(uiTaskHandle);  // Shot start / stop / flush wake it, even from deep idle
 
-  // Wait for BLE task to print its startup message (avoid serial collision)
-  vTaskDelay(pdMS_TO_TICKS(500));
-
-  LOG_INFO(TAG_TASK, "BLE task created successfully, main loop on Core %d", xPortGetCoreID());
+  // Settings written over BLE: goal / brightness to the UI task, offset / profile to shot control
+  bleMaintSetConsumers(uiTaskHandle, controlTaskHandle, CONTROL_EVT_SETTINGS);
 
   // ===== SETUP COMPLETE =====
+  bootMark(BOOT_SETUP_DONE);
   LOG_INFO(TAG_SYS, "");
   LOG_INFO(TAG_SYS, "╔═══════════════════════════════════════════╗");
   LOG_INFO(TAG_SYS, "║  ✅ SETUP COMPLETE                        ║");
@@ -2782,183 +3169,309 @@ void setup()
 // BLE Task - Runs on Core 0 (BLE/WiFi Core)
 // -----------------------------------------------------------------------------
 
-// Process commands from main loop
-void processBLECommand(BLECommandMessage& cmd)
+// Run one command from the command channel - the result goes to its completion callback
+bool processBLECommand(BLECommandMessage& cmd)
 {
     // ===== DIAGNOSTIC: Track BLE Command Duration =====
     unsigned long cmdStartTime = millis();
-    const char* cmdName = "UNKNOWN";
+    bool ok = false;
+    LOG_DEBUG(TAG_TASK, "Command: %s 0x%04lx", bleCommandName(cmd.command), (unsigned long)cmd.param);
     // ===== END BLE COMMAND DURATION TRACKING (START) =====
 
     switch (cmd.command)
     {
         case BLE_CMD_TARE:
-            cmdName = "TARE";
-            LOG_DEBUG(TAG_TASK, "Command: TARE");
             // Direct BLE call (runs on Core 0, safe to block)
             // This handles standalone tare (Tare button), not shot sequence tare
             if (scale.isConnected()) {
+                GS_TRACE_SCOPE("tare");
                 unsigned long tareStartTime = millis();
-                if (scale.tare()) {
-                    LOG_DEBUG(TAG_TASK, "⏱️  BLE tare() took %lums", millis() - tareStartTime);
-                    queueScaleStatus("Scale tared");
-                } else {
-                    LOG_WARN(TAG_TASK, "⏱️  BLE tare() FAILED after %lums", millis() - tareStartTime);
-                    queueScaleStatus("Tare failed");
-                }
-            } else {
-                queueScaleStatus("Scale not connected");
+                ok = scale.tare();
+                LOG_DEBUG(TAG_TASK, "⏱️  BLE tare() %s after %lums", ok ? "done" : "FAILED", millis() - tareStartTime);
             }
             break;
 
         case BLE_CMD_START_TIMER:
-            cmdName = "START_TIMER";
-            LOG_DEBUG(TAG_TASK, "Command: START_TIMER");
-            bleSequenceState = BLE_SEND_START;
-            bleSequenceInProgress = true;
+            bleSequenceRequest(&BLE_TIMER_START_SCRIPT);
+            ok = true;
             break;
 
         case BLE_CMD_STOP_TIMER:
-            cmdName = "STOP_TIMER";
-            LOG_DEBUG(TAG_TASK, "Command: STOP_TIMER");
             // Direct BLE call (runs on Core 0, safe to block)
             if (scale.isConnected()) {
                 unsigned long stopStartTime = millis();
-                if (scale.stopTimer()) {
-                    LOG_DEBUG(TAG_TASK, "⏱️  BLE stopTimer() took %lums", millis() - stopStartTime);
-                    queueScaleStatus("Timer stopped");
-                } else {
-                    LOG_WARN(TAG_TASK, "⏱️  BLE stopTimer() FAILED after %lums", millis() - stopStartTime);
-                    queueScaleStatus("Stop timer failed");
-                }
-            } else {
-                queueScaleStatus("Scale not connected");
+                ok = scale.stopTimer();
+                LOG_DEBUG(TAG_TASK, "⏱️  BLE stopTimer() %s after %lums", ok ? "done" : "FAILED", millis() - stopStartTime);
             }
             break;
 
         case BLE_CMD_RESET_TIMER:
-            cmdName = "RESET_TIMER";
-            LOG_DEBUG(TAG_TASK, "Command: RESET_TIMER");
-            bleSequenceState = BLE_SEND_RESET;
-            bleSequenceInProgress = true;
+            bleSequenceRequest(&BLE_SHOT_START_SCRIPT);
+            ok = true;
             break;
 
         case BLE_CMD_DISCONNECT:
-            cmdName = "DISCONNECT";
-            LOG_DEBUG(TAG_TASK, "Command: DISCONNECT");
             // scale.disconnect();  // Implement if needed
             break;
 
         case BLE_CMD_FORCE_RECONNECT:
-            cmdName = "FORCE_RECONNECT";
-            LOG_DEBUG(TAG_TASK, "Command: FORCE_RECONNECT");
-            // Force reconnection logic
+            if (shot.brewing) {
+                LOG_WARN(TAG_TASK, "⚠️  Scale reconnect ignored during a shot");
+            } else {
+                ok = scale.reconnect();
+            }
+            break;
+
+        case BLE_CMD_SELECT_SCALE:
+            if (shot.brewing) {
+                LOG_WARN(TAG_TASK, "⚠️  Scale selection ignored during a shot");
+                setStatusLabels(STATUS_COMMAND, "Busy - finish the shot");
+            } else if (!scale.selectScale((uint8_t)(cmd.param >> 8), (int8_t)(cmd.param & 0xFF))) {
+                setStatusLabels(STATUS_COMMAND, "Scale list changed - try again");
+            } else {
+                ok = true;
+            }
+            break;
+
+        case BLE_CMD_COUNT:
             break;
     }
 
     // ===== DIAGNOSTIC: Track BLE Command Duration (END) =====
     unsigned long cmdDuration = millis() - cmdStartTime;
     if (cmdDuration > 1000) {
-        LOG_WARN(TAG_TASK, "⚠️  BLE command %s took %lums (>1s) - potential watchdog risk!", cmdName, cmdDuration);
+        LOG_WARN(TAG_TASK, "⚠️  BLE command %s took %lums (>1s) - potential watchdog risk!", bleCommandName(cmd.command), cmdDuration);
     }
     // ===== END BLE COMMAND DURATION TRACKING (END) =====
+    return ok;
 }
 
 // BLE Task Function - Runs continuously on Core 0
+// Connection state machine progress (called from scale.poll() on the BLE task)
+static void onScaleConnectionState(ConnectionState state)
+{
+  LOG_DEBUG(TAG_TASK, "Scale connection: %s", connectionStateName(state));
+  bool settingUp = state >= CONN_CONNECTING && state <= CONN_NOTIFICATIONS;
+  wifiCoexSetConnecting(settingUp);
+  peerLinkSetConnecting(settingUp);
+  powerLockSet(POWER_LOCK_BLE_CONNECT, settingUp);
+  if (state == CONN_CONNECTED)
+    watchdogCheckIn(WATCHDOG_SCALE_LINK);  // First packet due within MAX_PACKET_PERIOD_MS
+}
+
+// Scale commands written and acks received, into the shot event trace (BLE task)
+static void onScaleCommand(ScaleCommand command, bool ack, bool ok, int64_t timestampUs)
+{
+  shotEventsRecord(ack ? SHOT_EVENT_ACK : SHOT_EVENT_COMMAND, (uint8_t)command, ok ? 1 : 0, 0, 0, timestampUs);
+}
+
+// Housekeeping on the BLE task's clock (bleTaskJobs)
+constexpr uint32_t BLE_HEARTBEAT_LOG_MS = 1000;
+constexpr uint32_t BLE_LINK_LOG_MS      = 10000;
+
+static PeriodicJobs<2> bleTaskJobs;
+
+// Log Core 0 alive every second to detect freezes
+static void logCore0Heartbeat(uint32_t nowMs)
+{
+  LOG_DEBUG(TAG_TASK, "💓 Core 0 BLE task alive @ %lums", (unsigned long)nowMs);
+}
+
+// BLE link parameters while connected
+static void logBleLink(uint32_t)
+{
+  if (!scale.isConnected())
+    return;
+  const LinkStats &link = scale.linkStats();
+  LOG_INFO(TAG_SCALE, "📶 BLE link: interval=%.2fms, latency=%u, timeout=%ums (%s), RSSI %d dBm, ~%lu lost, "
+           "MTU %u, LL %u/%u",
+           scale.connectionIntervalMs(), scale.connectionLatency(),
+           scale.supervisionTimeoutMs(), scale.isLowLatency() ? "brewing" : "idle",
+           link.rssi, (unsigned long)link.lostEstimate, link.attMtu, link.txOctets, link.rxOctets);
+}
+
+/**
+ * @brief How long the BLE task may sleep before a deadline needs servicing
+ *
+ * Incoming data, queued commands and sequence triggers wake the task on their
+ * own (BLE_EVT_*); this only covers work that is due by the clock.
+ */
+static uint32_t bleTaskNextWaitMs()
+{
+  unsigned long now = millis();
+  uint32_t waitMs = BLE_TASK_MAX_WAIT_MS;
+
+  auto dueIn = [&](unsigned long since, unsigned long period) {
+    unsigned long elapsed = now - since;
+    uint32_t remaining = (elapsed >= period) ? 0 : (uint32_t)(period - elapsed);
+    if (remaining < waitMs)
+      waitMs = remaining;
+  };
+
+  if (scale.isConnected())
+  {
+    unsigned long heartbeatMs = min(scale.heartbeatDueIn(), scale.settingsDueIn());
+    if (heartbeatMs < waitMs)
+      waitMs = heartbeatMs;
+  }
+  else if (scale.isConnecting())
+  {
+    // Scan results wake the task via BLE_EVT_HCI_RX; this covers settle/scan timeouts
+    if (BLE_TASK_CONNECT_POLL_MS < waitMs)
+      waitMs = BLE_TASK_CONNECT_POLL_MS;
+  }
+  else if (!isFlushing)
+  {
+    dueIn(lastScaleInitAttempt, scaleInitRetryMs());
+  }
+
+  // A waiting step's timeout; its ack itself arrives as BLE_EVT_NOTIFY
+  if (bleScriptRequest.load() != NULL)
+    waitMs = 0;  // Not started yet
+  else if (bleSequencer.dueInMs(now) < waitMs)
+    waitMs = bleSequencer.dueInMs(now);
+
+  if (rideThroughUntil)  // Ride-through limit (checkScaleStatus() stops the shot there)
+  {
+    int32_t leftMs = (int32_t)(rideThroughUntil - now);
+    if (leftMs < (int32_t)waitMs)
+      waitMs = leftMs > 0 ? (uint32_t)leftMs : 0;
+  }
+
+  // Shot decisions are the control task's (controlTaskNextWaitMs)
+
+  uint32_t broadcastMs = weightBroadcastDueInMs();  // Coalesced sample waiting for its notify slot
+  if (broadcastMs < waitMs)
+    waitMs = broadcastMs;
+
+  uint32_t jobsMs = bleTaskJobs.dueInMs(now);  // Heartbeat / link report
+  if (jobsMs < waitMs)
+    waitMs = jobsMs;
+
+  return waitMs;
+}
+
+// Newest weight/flow/shot state for the broadcast service (coalesced until its notify slot)
+static void publishWeightBroadcast()
+{
+  WeightBroadcastState state;
+  if (!scale.isConnected())
+    state = WB_STATE_NO_SCALE;
+  else if (shot.brewing)
+    state = WB_STATE_BREWING;
+  else if (isFlushing)
+    state = WB_STATE_FLUSHING;
+  else if (shot.start_us && shot.end_s)
+    state = WB_STATE_DRIPPING;
+  else
+    state = WB_STATE_IDLE;
+
+  float flow = shot.brewing ? shot.predictor.filter.flow() : 0.0f;
+  weightBroadcastUpdate(currentWeight, flow, shot.shotTimer, goalWeight, state);
+  weightBroadcastPoll();
+  shotStreamPush(currentWeight, flow, shot.shotTimer, shot.brewing ? shot.expected_end_s : 0.0f, state);
+}
+
+// Live values for the maintenance service's settings read (plain loads of the owners' values)
+static void serviceBleMaint()
+{
+  BleMaintSettings settings = {BLE_MAINT_SETTINGS_VERSION, BLE_MAINT_SET_ALL, (uint16_t)(goalWeight * 10),
+                               (int16_t)lroundf(weightOffset * 100.0f), (uint8_t)brightness,
+                               shotProfileActiveIndex()};
+  bleMaintPoll(settings);
+}
+
+/**
+ * @brief Block until an event or the deadline, then pump HCI if data arrived
+ * @return BLE_EVT_* bits that woke the task (0 = deadline)
+ */
+static uint32_t bleTaskWaitForEvents(uint32_t waitMs)
+{
+  uint32_t events = 0;
+  xTaskNotifyWait(0, UINT32_MAX, &events, pdMS_TO_TICKS(waitMs));
+
+  // Drain the transport; the BLEUpdated handler fires inside BLE.poll() and sets
+  // BLE_EVT_NOTIFY on this task - collect it here instead of taking another pass
+  uint32_t pending = events;
+  while (pending & BLE_EVT_HCI_RX)
+  {
+    {
+      GS_ALLOC_SCOPE(ALLOC_SCOPE_BLE_POLL);
+      BLE.poll();
+    }
+    pending = 0;
+    xTaskNotifyWait(0, UINT32_MAX, &pending, 0);
+    events |= pending;
+  }
+
+  return events;
+}
+
 void bleTaskFunction(void* parameter)
 {
     // Get core ID and verify correct assignment
     uint8_t coreID = xPortGetCoreID();
 
-    // Wait to avoid serial collision with setup()
-    vTaskDelay(pdMS_TO_TICKS(200));
+    // No startup delay: LOG_*() only queues, setup() keeps initialising the display meanwhile
+    bootMark(BOOT_BLE_TASK);
 
     LOG_INFO(TAG_TASK, "=================================");
     LOG_INFO(TAG_TASK, "Running on Core: %d", coreID);
 
-    if (coreID != 0) {
-        LOG_WARN(TAG_TASK, "WARNING: Should be on Core 0, but running on Core 1!");
+    const TaskSpec &layout = taskLayoutSpec(TASK_ROLE_BLE_HOST);
+    if (coreID != layout.core) {
+        LOG_WARN(TAG_TASK, "WARNING: Should be on Core %d, but running on Core %d!", (int)layout.core, coreID);
         LOG_WARN(TAG_TASK, "Task pinning may have failed!");
     } else {
         LOG_INFO(TAG_TASK, "Core assignment correct!");
     }
 
-    // Check initial stack size
+    // Check initial stack size ("tasks" reports the peak use later)
     UBaseType_t stackSize = uxTaskGetStackHighWaterMark(NULL);
-    LOG_INFO(TAG_TASK, "Stack allocated: 20KB, available: %u bytes", stackSize);
+    LOG_INFO(TAG_TASK, "Stack allocated: %lu bytes, available: %u bytes", (unsigned long)layout.stackBytes, stackSize);
     LOG_INFO(TAG_TASK, "=================================");
 
-    // CRITICAL: Add this BLE task to the watchdog
-    // This task MUST call esp_task_wdt_reset() regularly or system will reboot
-    esp_task_wdt_add(NULL);  // Add current task (BLE task) to watchdog
-    LOG_INFO(TAG_TASK, "BLE task added to watchdog monitor");
+    // Supervised: every pass checks in, each sleep declares its timeout (watchdog.h)
+    watchdogRegister(WATCHDOG_BLE_HOST, BLE_TASK_WATCHDOG_MS, true);
+    watchdogRegister(WATCHDOG_SCALE_LINK, MAX_PACKET_PERIOD_MS, false);  // Link layer reconnects itself
 
-    // Track stack usage and heap monitoring
-    unsigned long lastStackCheck = 0;
-    unsigned long lastHeapLog = 0;
-    const unsigned long HEAP_LOG_INTERVAL_MS = 30000;  // Log heap every 30 seconds
+    // Event-driven: HCI data, weight notifications and queued commands wake this task
+    scale.setEventTask(xTaskGetCurrentTaskHandle(), BLE_EVT_HCI_RX, BLE_EVT_NOTIFY);
+    bleCommandsSetConsumer(xTaskGetCurrentTaskHandle(), BLE_EVT_COMMAND);
+    scale.setStateCallback(onScaleConnectionState);
+    scale.setCommandCallback(onScaleCommand);
+    bleMaintBegin(xTaskGetCurrentTaskHandle(), BLE_EVT_MAINT);  // Before advertising starts
+    weightBroadcastBegin();  // Advertising runs alongside the scale scan/link
 
-    // ===== DIAGNOSTIC: Core 0 Heartbeat Logging =====
-    unsigned long lastCore0Heartbeat = 0;
-    // ===== END CORE 0 HEARTBEAT LOGGING (SETUP) =====
+    // Heap and stack watermarks are sampled by the health monitor task (health_monitor.h)
+    bleTaskJobs.add(logCore0Heartbeat, BLE_HEARTBEAT_LOG_MS, millis());
+    bleTaskJobs.add(logBleLink, BLE_LINK_LOG_MS, millis());
 
     while (true)
     {
-        // Reset watchdog and track timing
-        esp_task_wdt_reset();
-        bleTaskWDTResets++;
+        // Sleep until notified or the nearest deadline (replaces the 10ms polling delay)
+        uint32_t waitMs = bleTaskNextWaitMs();
+        watchdogExpect(WATCHDOG_BLE_HOST, waitMs);
+        bleTaskWaitForEvents(waitMs);
+        watchdogCheckIn(WATCHDOG_BLE_HOST);
 
-        // Log watchdog reset statistics every 5 seconds
         unsigned long now = millis();
-        if (now - lastBLEWDTLog > WDT_LOG_INTERVAL_MS) {
-            LOG_DEBUG(TAG_TASK, "BLE Task WDT: %lu resets, last reset %lums ago",
-                      bleTaskWDTResets, now - lastBLEWDTLog);
-            lastBLEWDTLog = now;
-        }
-
-        // ===== DIAGNOSTIC: Core 0 Heartbeat Logging =====
-        // Log Core 0 alive every 1 second to detect freezes
-        if (now - lastCore0Heartbeat > 1000) {
-            LOG_DEBUG(TAG_TASK, "💓 Core 0 BLE task alive @ %lums", now);
-            lastCore0Heartbeat = now;
-        }
-        // ===== END CORE 0 HEARTBEAT LOGGING =====
-
-        // Log heap status every 30 seconds (detects memory leaks from BLE scanning)
-        if (now - lastHeapLog > HEAP_LOG_INTERVAL_MS) {
-            // Get INTERNAL DRAM heap (not PSRAM) - this is what gets exhausted during BLE scanning
-            size_t free_internal = heap_caps_get_free_size(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
-            size_t min_free_internal = heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
-            size_t largest_block = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
-
-            // Always log heap status (changed from DEBUG to WARN for visibility)
-            LOG_WARN(TAG_TASK, "💾 Internal DRAM: free=%u, min_ever=%u, largest=%u bytes",
-                     free_internal, min_free_internal, largest_block);
-
-            // Progressive warning levels
-            if (free_internal < 100000) {
-                LOG_ERROR(TAG_TASK, "🔴 CRITICAL: Internal heap = %u bytes (< 100KB!)", free_internal);
-            }
-            if (free_internal < 50000) {
-                LOG_ERROR(TAG_TASK, "💀 FATAL: Internal heap = %u bytes (< 50KB! CRASH IMMINENT!)", free_internal);
-            }
-            if (largest_block < 20000) {
-                LOG_ERROR(TAG_TASK, "⚠️  Heap fragmentation severe! Largest block = %u bytes", largest_block);
-            }
 
-            lastHeapLog = now;
-        }
+        bleTaskJobs.service(now);  // Core 0 heartbeat, BLE link report
 
         // ===== DIAGNOSTIC: Track Critical Section Durations =====
         unsigned long sectionStartTime;
         unsigned long sectionDuration;
         // ===== END CRITICAL SECTION DURATION TRACKING (SETUP) =====
 
-        // Process commands from main loop (non-blocking check)
+        // Process commands from the UI task (drain - one BLE_EVT_COMMAND may cover several;
+        // STOP comes out of its lane first)
         BLECommandMessage cmd;
-        if (xQueueReceive(bleCommandQueue, &cmd, 0) == pdTRUE) {
+        while (bleCommandReceive(&cmd)) {
+            GS_TRACE_SCOPE("ble_command");
+            GS_ALLOC_SCOPE(ALLOC_SCOPE_SCALE_COMMANDS);
             sectionStartTime = millis();
-            processBLECommand(cmd);
+            bleCommandComplete(cmd, processBLECommand(cmd));
             sectionDuration = millis() - sectionStartTime;
             if (sectionDuration > 1000) {
                 LOG_WARN(TAG_TASK, "⚠️  processBLECommand() took %lums (>1s)", sectionDuration);
@@ -2971,7 +3484,11 @@ void bleTaskFunction(void* parameter)
 
         // Check scale status and manage connection
         sectionStartTime = millis();
-        checkScaleStatus();
+        {
+            GS_TRACE_SCOPE("scale_status");
+            GS_ALLOC_SCOPE(ALLOC_SCOPE_SCALE_LINK);
+            checkScaleStatus();
+        }
         sectionDuration = millis() - sectionStartTime;
         if (sectionDuration > 1000) {
             LOG_WARN(TAG_TASK, "⚠️  checkScaleStatus() took %lums (>1s)", sectionDuration);
@@ -2979,54 +3496,41 @@ void bleTaskFunction(void* parameter)
 
         // Send heartbeat to keep connection alive
         sectionStartTime = millis();
-        checkHeartBreat();
+        {
+            GS_TRACE_SCOPE("heartbeat");
+            checkHeartBreat();
+        }
         sectionDuration = millis() - sectionStartTime;
         if (sectionDuration > 1000) {
             LOG_WARN(TAG_TASK, "⚠️  checkHeartBreat() took %lums (>1s)", sectionDuration);
         }
 
+        // Short connection interval whenever a shot is starting or running, relaxed otherwise
+        scale.setLowLatency(shot.brewing || bleSequenceInProgress);
+
         // Handle BLE command sequence (tare, start timer, etc.)
         sectionStartTime = millis();
-        handleBLESequence();
+        {
+            GS_TRACE_SCOPE("ble_sequence");
+            handleBLESequence();
+        }
         sectionDuration = millis() - sectionStartTime;
         if (sectionDuration > 1000) {
             LOG_WARN(TAG_TASK, "⚠️  handleBLESequence() took %lums (>1s)", sectionDuration);
         }
 
-        // Update weight readings
-        updateScaleReadings();
-
-        // Update shot timer (independent 0.1s updates)
-        updateShotTimer();
-
-        // Handle shot watchdogs
-        handleShotWatchdogs();
+        // Hand new weight samples to the control task (it pre-empts this one to process them)
+        {
+            GS_TRACE_SCOPE("scale_readings");
+            updateScaleReadings();
+        }
 
         // Update shared data for main loop
-        // ArduinoBLE doesn't have isConnecting() - always false (blocking connection)
-        updateSharedConnectionStatus(scale.isConnected(), false);
+        updateSharedConnectionStatus(scale.isConnected(), scale.isConnecting());
         updateSharedWeight(currentWeight);
-
-        // Monitor BLE task stack usage every 10 seconds (detect stack overflow)
-        if (millis() - lastStackCheck > 10000) {
-            UBaseType_t stackLeft = uxTaskGetStackHighWaterMark(NULL);
-
-            // Always log stack status (changed from VERBOSE to WARN for visibility)
-            LOG_WARN(TAG_TASK, "📚 BLE Task Stack: %u bytes remaining (of 20480 total)", stackLeft);
-
-            // Progressive stack overflow warnings
-            if (stackLeft < 5000) {
-                LOG_ERROR(TAG_TASK, "🔴 LOW STACK WARNING! Only %u bytes remaining!", stackLeft);
-            }
-            if (stackLeft < 2000) {
-                LOG_ERROR(TAG_TASK, "🚨 STACK OVERFLOW IMMINENT! Only %u bytes left!", stackLeft);
-            }
-
-            lastStackCheck = millis();
-        }
-
-        // Small delay to prevent task starvation (10ms)
-        vTaskDelay(pdMS_TO_TICKS(10));
+        scale.pollLinkStats();  // RSSI every LINK_RSSI_POLL_MS
+        publishWeightBroadcast();
+        serviceBleMaint();  // Update acks / status, settings read value
     }
 }
 
@@ -3040,52 +3544,267 @@ void updateUIWithBLEData()
 
     if (millis() - lastUIUpdate < 50) return;  // Update UI every 50ms max
 
-    // Read shared data from BLE task
-    if (xSemaphoreTake(bleDataMutex, pdMS_TO_TICKS(5))) {
-        // CRITICAL: Update currentWeight for shot logic and touch handlers
-        currentWeight = bleData.currentWeight;
+    // Read shared data from BLE task (one consistent snapshot, no lock)
+    BLESharedData snapshot = bleData.load();
 
-        bool connected = bleData.isConnected;
-        xSemaphoreGive(bleDataMutex);
-
-        // Only queue connection update if state changed (avoid flooding queue)
-        if (connected != lastKnownConnectionState) {
-            queueConnectionUpdate(connected);
-            lastKnownConnectionState = connected;
-        }
+    // Only queue connection update if state changed (avoid flooding queue)
+    if (snapshot.isConnected != lastKnownConnectionState) {
+        uiChannelSetConnection(snapshot.isConnected);
+        lastKnownConnectionState = snapshot.isConnected;
     }
 
     lastUIUpdate = millis();
 }
 
-// Main Loop - UI Operations Only (Core 1)
-void loop()
+// -----------------------------------------------------------------------------
+// UI Task - Runs on Core 1 (LVGL Core)
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief Enter / leave deep idle: display asleep, nothing for LVGL to do
+ *
+ * LVGL timers simply stop (lv_timer_handler() is not called), touch INT becomes
+ * a GPIO wake source and light sleep is allowed (power_manager.h). The BLE task
+ * already blocks on radio events and its own deadlines.
+ */
+static void setUiDeepIdle(bool on)
+{
+  static bool deepIdle = false;
+  if (on == deepIdle)
+    return;
+  deepIdle = on;
+
+  touchInputSetWakeSource(on);
+  powerManagerSetDeepIdle(on);
+  if (!on) {
+    // The stall was deliberate - don't let the freeze / flush checks report it
+    lastLVGLTimerCall = millis();
+    lastFlushTimestamp = millis();
+  }
+  LOG_INFO(TAG_UI, on ? "💤 Deep idle: LVGL stopped, touch armed as wake source"
+                      : "⏰ Deep idle ended");
+}
+
+// True if the landscape point is on an object LVGL handles itself (buttons, sliders)
+static bool gestureStartsOnControl(int16_t x, int16_t y)
 {
-  // Reset watchdog and track timing
-  esp_task_wdt_reset();
-  mainLoopWDTResets++;
+  lv_point_t point = {x, y};
+  lv_obj_t *obj = lv_indev_search_obj(lv_scr_act(), &point);
+  for (; obj != NULL; obj = lv_obj_get_parent(obj)) {
+    if (lv_obj_check_type(obj, &lv_btn_class) || lv_obj_check_type(obj, &lv_slider_class))
+      return true;
+  }
+  return false;
+}
 
-  // Log watchdog reset statistics every 5 seconds
-  unsigned long now = millis();
-  if (now - lastMainWDTLog > WDT_LOG_INTERVAL_MS) {
-    LOG_DEBUG(TAG_TASK, "Main Loop WDT: %lu resets, last reset %lums ago",
-              mainLoopWDTResets, now - lastMainWDTLog);
-    lastMainWDTLog = now;
+/**
+ * @brief Act on the newest touch gesture (touch_gesture.h) - after lv_timer_handler(), never inside it
+ * @note Main screen: swipe left → settings, long press on the weight → tare, two fingers → timer reset.
+ *       Settings: swipe right → main. Swipes that start on a button or slider are LVGL's.
+ */
+static void handleTouchGesture()
+{
+  TouchGestureEvent g;
+  if (!touchGestureTake(&g) || displayAsleep)
+    return;
+  lv_obj_t *screen = lv_scr_act();
+
+  switch (g.gesture) {
+    case TOUCH_GESTURE_SWIPE_LEFT:
+      if (screen == ui_MainScreen && !gestureStartsOnControl(g.x, g.y))
+        screenNavGo(ui_SettingScreen, LV_SCR_LOAD_ANIM_MOVE_LEFT);
+      break;
+    case TOUCH_GESTURE_SWIPE_RIGHT:
+      if (screen == ui_SettingScreen && !gestureStartsOnControl(g.x, g.y))
+        screenNavGo(ui_MainScreen, LV_SCR_LOAD_ANIM_MOVE_RIGHT);
+      break;
+    case TOUCH_GESTURE_LONG_PRESS: {
+      if (screen != ui_MainScreen || ui_ScaleLabel == NULL)
+        break;
+      lv_area_t weight;
+      lv_obj_get_coords(ui_ScaleLabel, &weight);
+      lv_area_increase(&weight, TOUCH_TAP_SLOP_PX * 2, TOUCH_TAP_SLOP_PX * 2);
+      lv_point_t point = {g.x, g.y};
+      if (_lv_area_is_point_on(&weight, &point, 0))
+        uiIntentSubmit(UI_INTENT_TARE, UI_INTENT_FROM_GESTURE);
+      break;
+    }
+    case TOUCH_GESTURE_TWO_FINGER:
+      if (screen == ui_MainScreen && !shot.brewing)
+        uiIntentSubmit(UI_INTENT_TIMER_RESET, UI_INTENT_FROM_GESTURE);
+      break;
+    default:
+      break;
+  }
+}
+
+// Housekeeping on the UI task's clock: uiTaskJobs every pass, uiRenderJobs
+// only on passes that run LVGL (the health checks would misread deep idle)
+constexpr uint32_t UI_HEARTBEAT_LOG_MS   = 5000;
+constexpr uint32_t LVGL_HEARTBEAT_LOG_MS = 1000;
+constexpr uint32_t LVGL_ACTIVITY_LOG_MS  = 10000;
+constexpr uint32_t UI_HEALTH_CHECK_MS    = 30000;
+
+static PeriodicJobs<1> uiTaskJobs;
+static PeriodicJobs<3> uiRenderJobs;
+static uint32_t uiWakeups = 0;
+
+// Wakeup rate to detect a freezing Core 1
+// NOTE: The task sleeps between LVGL timers, so a low rate when idle is normal
+static void logUiTaskHeartbeat(uint32_t)
+{
+  LOG_DEBUG(TAG_TASK, "💓 Core 1 UI task alive: %lu wakeups in 5s (~%lu Hz)",
+            (unsigned long)uiWakeups, (unsigned long)(uiWakeups * 1000 / UI_HEARTBEAT_LOG_MS));
+  uiWakeups = 0;
+}
+
+static void logLvglHeartbeat(uint32_t)
+{
+  LOG_DEBUG(TAG_UI, "❤️  LVGL Timer alive (asleep=%d)", displayAsleep);
+}
+
+// NOTE: Rate follows the LVGL timers (~60 Hz touch polling, 20 Hz minimum) -
+// only a rate near zero means a real freeze
+static void logLvglActivity(uint32_t)
+{
+  LOG_DEBUG(TAG_UI, "📊 LVGL Activity: %lu timer calls in last 10s (~%lu Hz)",
+            lvglTimerCallCount, lvglTimerCallCount * 1000 / LVGL_ACTIVITY_LOG_MS);
+  lvglTimerCallCount = 0;
+}
+
+// UI Health Monitor - Detects blank display and unresponsive touch issues
+// This catches the problems that standard logging misses
+static void checkUiHealth(uint32_t now)
+{
+  static bool uiHealthWarningShown = false;
+  bool displayProblem = false;
+
+  // Check 1: Display flush happening? (even idle should flush occasionally)
+  // Flush counter is sampled here (30s resolution) to keep millis() out of my_disp_flush()
+  static uint32_t lastFlushCountSeen = 0;
+  if (displayDiag.flushes != lastFlushCountSeen) {
+    lastFlushCountSeen = displayDiag.flushes;
+    lastFlushTimestamp = now;
+  }
+  if (lastFlushTimestamp > 0 && (now - lastFlushTimestamp) > 120000) {  // No flush for 2 minutes
+    LOG_ERROR(TAG_UI, "🚨 UI HEALTH: No display flush in 120s!");
+    displayProblem = true;
+  }
+
+  // Check 2: LVGL timer handler running?
+  if ((now - lastLVGLTimerCall) > 5000) {
+    LOG_ERROR(TAG_UI, "🚨 UI HEALTH: LVGL timer handler stopped for 5s!");
+    displayProblem = true;
   }
 
-  // ===== DIAGNOSTIC: Core 1 Loop Heartbeat =====
-  // Track loop iteration frequency to detect if Core 1 is freezing
-  static unsigned long lastLoopLog = 0;
-  static uint32_t loopIterationCount = 0;
-  loopIterationCount++;
+  // Check 3: Display driver still registered?
+  lv_disp_t* disp = lv_disp_get_default();
+  if (!disp || !disp->driver) {
+    LOG_ERROR(TAG_UI, "🚨 UI HEALTH: LVGL display driver MISSING!");
+    displayProblem = true;
+  }
+
+  // Check 4: Touch responsiveness (only warn if touch is expected but not working)
+  // NOTE: We don't warn about no touch - user may simply not be touching screen
+  // This is just for logging/debugging purposes
+
+  // ===== DIAGNOSTIC: LVGL Object Tree Validation =====
+  // Check if screen object and UI widgets still exist
+  if (disp != NULL) {
+    lv_obj_t* screen = lv_disp_get_scr_act(disp);
+    if (screen != NULL) {
+      uint32_t child_count = lv_obj_get_child_cnt(screen);
+      static uint32_t last_child_count = 0;
+
+      // Detect if widgets disappeared (object count dropped)
+      if (last_child_count > 0 && child_count < last_child_count) {
+        LOG_ERROR(TAG_UI, "🚨 WIDGETS DISAPPEARED! Count: %lu → %lu (lost %lu objects)",
+                 last_child_count, child_count, last_child_count - child_count);
+        displayProblem = true;
+      }
+
+      // Log object count every 5 checks (every 150 seconds)
+      static uint8_t object_check_counter = 0;
+      object_check_counter++;
+      if (object_check_counter >= 5) {
+        LOG_INFO(TAG_UI, "📊 LVGL Object Tree: %lu child objects on screen", child_count);
+        object_check_counter = 0;
+      }
+
+      last_child_count = child_count;
+    } else {
+      LOG_ERROR(TAG_UI, "🚨 Screen object is NULL!");
+      displayProblem = true;
+    }
+  }
+  // ===== END LVGL OBJECT TREE VALIDATION =====
+
+  // Periodic status logging
+  LOG_DEBUG(TAG_UI, "UI Health: Flush=%lums ago, Timer=%lums ago, Touch=%lums ago",
+            (lastFlushTimestamp > 0) ? (now - lastFlushTimestamp) : 999999,
+            now - lastLVGLTimerCall,
+            (lastTouchEvent > 0) ? (now - lastTouchEvent) : 999999);
+
+  if (displayProblem && !uiHealthWarningShown) {
+    LOG_ERROR(TAG_UI, "═════════════════════════════════════════════");
+    LOG_ERROR(TAG_UI, "  🚨 UI SYSTEM FAILURE DETECTED!");
+    LOG_ERROR(TAG_UI, "  Display may be blank or frozen");
+    LOG_ERROR(TAG_UI, "  Possible causes:");
+    LOG_ERROR(TAG_UI, "  - LVGL not initialized (check lv_timer_handler)");
+    LOG_ERROR(TAG_UI, "  - Display driver failed");
+    LOG_ERROR(TAG_UI, "  - SPI communication issue");
+    LOG_ERROR(TAG_UI, "  Check serial logs from setup() for errors");
+    LOG_ERROR(TAG_UI, "═════════════════════════════════════════════");
+    uiHealthWarningShown = true;
+  } else if (!displayProblem && uiHealthWarningShown) {
+    LOG_INFO(TAG_UI, "✅ UI health recovered");
+    uiHealthWarningShown = false;
+  }
+}
+
+/**
+ * @brief One pass of UI work: queued updates, LVGL, relay timing, health checks
+ * @return Longest time (ms) the UI task may sleep before the next pass
+ */
+static uint32_t uiTaskRunOnce()
+{
+  watchdogCheckIn(WATCHDOG_RENDER);
+  unsigned long now = millis();
 
-  if (millis() - lastLoopLog > 5000) {  // Every 5 seconds
-    LOG_DEBUG(TAG_TASK, "💓 Core 1 loop() alive: %lu iterations in 5s (~%lu Hz)",
-              loopIterationCount, loopIterationCount / 5);
-    loopIterationCount = 0;
-    lastLoopLog = millis();
+  uiWakeups++;
+  uint32_t jobsDueMs = uiTaskJobs.service(now);  // Core 1 heartbeat
+
+  // Active → dim → off → panel sleep on idle time; a shot or flush keeps it lit, or headless if it was off
+  displayAsleep = displayPowerUpdate(shot.brewing || isFlushing, lastTouchTime);
+
+  // Display asleep: skip LVGL and the health checks entirely. A pending touch
+  // frame ends it - LVGL's read callback performs the wake.
+  bool deepIdle = displayAsleep && !touchInputPending();
+  bool headless = deepIdle && displayPowerHeadless();
+  setUiDeepIdle(deepIdle);
+  uiChannelSetHeadless(headless);
+  if (deepIdle) {
+    // Idle: keep the channel drained, widgets stay current for the wake frame.
+    // Headless shot or flush: the channel holds the values instead (no
+    // formatting, no wakes per sample); the wake pass takes them all at once.
+    if (!headless)
+      processUIUpdates();
+    applyBleSettingsUi();
+    applyConfigImportUi();
+    applyCupStartUi();
+    updateUIWithBLEData();
+    uint32_t dueMs = min(min(settingsStorePoll(), shotStreamPoll(millis())), jobsDueMs);
+    uint32_t maxWaitMs = UI_TASK_DEEP_IDLE_WAIT_MS;
+    if (headless) {
+      shotChartService();      // Points only (ring holds ~8 s); drawn by the wake frame
+      handleFlushingCycle();   // The relay itself is cut by its esp_timer
+      wifiCoexUpdate(shot.brewing);
+      powerLockSet(POWER_LOCK_SHOT, true);
+      powerManagerPoll();
+      maxWaitMs = UI_TASK_HEADLESS_WAIT_MS;
+    }
+    return (dueMs < maxWaitMs) ? dueMs : maxWaitMs;
   }
-  // ===== END CORE 1 LOOP HEARTBEAT =====
 
   // ========================================================================
   // UI OPERATIONS ONLY - All BLE operations moved to BLE task on Core 0!
@@ -3096,162 +3815,116 @@ void loop()
   // while LVGL timers are still accessing them → NULL pointer crash in lv_timer.c:107
   // See crash at 101s runtime: LoadProhibited at EXCVADDR 0x00000014 (NULL+offset)
   processUIUpdates();
-
-  // CRITICAL: Manage display refresh rate based on shot state (Core 1 only - safe)
+  applyBleSettingsUi();
+  applyConfigImportUi();
+  applyCupStartUi();
+  uint32_t labelDueMs = serviceLabelGates();
+  shotChartService();
+  lvglHeapService();
+  renderAuditService(lv_disp_get_default()->driver);
+  layerCacheService();
+
+  // CRITICAL: Manage display refresh rate (Core 1 only - safe)
   // Previously called from Core 0 (BLE task) → LVGL race condition → crashes
-  // Now polled by Core 1 at 242 Hz → state change detected within 4ms
-  // SAFETY: Initialize to match shot.brewing to prevent spurious call on first loop
-  static bool lastBrewingState = shot.brewing;
-  if (shot.brewing != lastBrewingState) {
-    updateDisplayRefreshRate(shot.brewing);
-    lastBrewingState = shot.brewing;
-  }
+  // Adaptive pacing: touch, shot state, packet rate and measured refresh cost
+  framePacerUpdate(shot.brewing, lastTouchEvent);
+  touchPipelineReport(millis());
+  wifiCoexUpdate(shot.brewing);  // Wi-Fi quiet during shots / scale connection (debug builds)
+  powerLockSet(POWER_LOCK_SHOT, shot.brewing || isFlushing);
+  powerManagerPoll();
 
-  // LVGL UI updates (CRITICAL - must run frequently)
-  LVGLTimerHandlerRoutine();
+  // Touch frames waiting: make sure LVGL's (paused while idle) read timer runs
+  if (touchIndev != NULL && touchInputPending())
+    lv_timer_resume(touchIndev->driver->read_timer);
 
-  // DIAGNOSTIC: LVGL heartbeat to detect display freezes
-  static unsigned long lastLVGLLog = 0;
-  if (millis() - lastLVGLLog > 5000) {  // Every 5 seconds
-    LOG_DEBUG(TAG_UI, "LVGL heartbeat - display active (asleep=%d) | WDT: Main=%lu BLE=%lu",
-              displayAsleep, mainLoopWDTResets, bleTaskWDTResets);
-    lastLVGLLog = millis();
-  }
+  startLatencyUiPass(shot.brewing);  // This pass renders the shot: its frame closes the Start trace
+
+  // LVGL UI updates - returns how long until its next timer is due
+  uint32_t waitMs = LVGLTimerHandlerRoutine();
+  handleTouchGesture();
+
+  // After the timers ran: heartbeat, activity rate and the health checks
+  uint32_t renderJobsDueMs = uiRenderJobs.service(millis());
+  if (renderJobsDueMs < jobsDueMs)
+    jobsDueMs = renderJobsDueMs;
 
   // Update connection status from BLE task (polls shared memory)
   updateUIWithBLEData();
 
-  // Display sleep/wake management (UI operation) - Disabled for production
-  // Sleep mode can be re-enabled by uncommenting the block below
-  // if (!displayAsleep && (millis() - lastTouchTime) > DISPLAY_SLEEP_TIMEOUT_MS)
-  // {
-  //   LOG_INFO(TAG_UI, "Display sleep timeout (5 min idle) - putting display to sleep");
-  //   LOG_INFO(TAG_UI, "Touch screen to wake");
-  //   lcd_sleep();
-  //   displayAsleep = true;
-  // }
-
   // Handle flushing cycle (relay control - UI related)
   handleFlushingCycle();
 
-  // Process status message queue (UI updates)
-  processPendingStatusQueue();
-
   // All BLE operations now run in bleTaskFunction() on Core 0:
   //   - scale.update()
   //   - checkScaleStatus()
   //   - checkHeartBreat()
   //   - handleBLESequence()
   //   - updateScaleReadings()
+  // Shot decisions run in controlTaskFunction() (Core 0, above BLE):
+  //   - processWeightSample()
   //   - updateShotTimer()
   //   - handleShotWatchdogs()
 
-  // UI Health Monitor - Detects blank display and unresponsive touch issues
-  // This catches the problems that standard logging misses
-  static unsigned long lastUIHealthCheck = 0;
-  static unsigned long lastFlushDetected = 0;
-  static unsigned long lastTouchEventRecorded = 0;  // Will be updated from my_touchpad_read()
-  static bool uiHealthWarningShown = false;
-
-  if (millis() - lastUIHealthCheck > 30000) {  // Check every 30 seconds
-    unsigned long now = millis();
-    bool displayProblem = false;
-
-    // Check 1: Display flush happening? (even idle should flush occasionally)
-    // lastFlushTimestamp is updated in my_disp_flush() callback
-    if (lastFlushTimestamp > 0 && (now - lastFlushTimestamp) > 120000) {  // No flush for 2 minutes
-      LOG_ERROR(TAG_UI, "🚨 UI HEALTH: No display flush in 120s!");
-      displayProblem = true;
-    }
+  // Polled duties (BLE shared data, relay timing) bound how long we may sleep
+  uint32_t maxWaitMs = UI_TASK_MAX_WAIT_MS;
+  uint32_t cleanDueMs = cleanProgramStatusDueMs();
+  if (cleanDueMs < maxWaitMs)
+    maxWaitMs = cleanDueMs;  // Next countdown second or phase of a flush / backflush
+  if (labelDueMs < maxWaitMs)
+    maxWaitMs = labelDueMs;  // A held label value becomes due
+  // No NVS commit while brewing: the flash write stops both cores' caches and the cut has to land
+  uint32_t settingsDueMs = shot.brewing ? UINT32_MAX : settingsStorePoll();
+  if (settingsDueMs < maxWaitMs)
+    maxWaitMs = settingsDueMs;  // Debounced settings commit
+  uint32_t streamDueMs = shotStreamPoll(millis());
+  if (streamDueMs < maxWaitMs)
+    maxWaitMs = streamDueMs;  // Next live shot frame
+  uint32_t mirrorDueMs = fbMirrorPoll(millis());
+  if (mirrorDueMs < maxWaitMs)
+    maxWaitMs = mirrorDueMs;  // Next screen mirror message
+  if (jobsDueMs < maxWaitMs)
+    maxWaitMs = jobsDueMs;  // Heartbeat / health check
+  return (waitMs < maxWaitMs) ? waitMs : maxWaitMs;
+}
 
-    // Check 2: LVGL timer handler running?
-    if ((now - lastLVGLTimerCall) > 5000) {
-      LOG_ERROR(TAG_UI, "🚨 UI HEALTH: LVGL timer handler stopped for 5s!");
-      displayProblem = true;
-    }
+/**
+ * @brief UI task - owns LVGL, sleeps until a timer is due or something wakes it
+ * @note Woken by UI channel updates (uiChannelSetConsumer), DMA flush completion
+ *       (lcd_set_flush_notify_task) and published touch frames
+ *       (touchInputSetConsumer).
+ */
+void uiTaskFunction(void *parameter)
+{
+  LOG_INFO(TAG_TASK, "UI task started on Core %d", xPortGetCoreID());
 
-    // Check 3: Display driver still registered?
-    lv_disp_t* disp = lv_disp_get_default();
-    if (!disp || !disp->driver) {
-      LOG_ERROR(TAG_UI, "🚨 UI HEALTH: LVGL display driver MISSING!");
-      displayProblem = true;
-    }
+  // Supervised: each pass checks in, each sleep declares its timeout (watchdog.h)
+  watchdogRegister(WATCHDOG_RENDER, RENDER_WATCHDOG_MS, true);
+  watchdogRegister(WATCHDOG_DMA, DMA_WATCHDOG_MS, true);
 
-    // Check 4: Touch responsiveness (only warn if touch is expected but not working)
-    // NOTE: We don't warn about no touch - user may simply not be touching screen
-    // This is just for logging/debugging purposes
-
-    // ===== DIAGNOSTIC: LVGL Object Tree Validation =====
-    // Check if screen object and UI widgets still exist
-    if (disp != NULL) {
-      lv_obj_t* screen = lv_disp_get_scr_act(disp);
-      if (screen != NULL) {
-        uint32_t child_count = lv_obj_get_child_cnt(screen);
-        static uint32_t last_child_count = 0;
-
-        // Detect if widgets disappeared (object count dropped)
-        if (last_child_count > 0 && child_count < last_child_count) {
-          LOG_ERROR(TAG_UI, "🚨 WIDGETS DISAPPEARED! Count: %lu → %lu (lost %lu objects)",
-                   last_child_count, child_count, last_child_count - child_count);
-          displayProblem = true;
-        }
+  uint32_t now = millis();
+  uiTaskJobs.add(logUiTaskHeartbeat, UI_HEARTBEAT_LOG_MS, now);
+  uiRenderJobs.add(logLvglHeartbeat, LVGL_HEARTBEAT_LOG_MS, now);
+  uiRenderJobs.add(logLvglActivity, LVGL_ACTIVITY_LOG_MS, now);
+  uiRenderJobs.add(checkUiHealth, UI_HEALTH_CHECK_MS, now);
 
-        // Log object count every 5 checks (every 150 seconds)
-        static uint8_t object_check_counter = 0;
-        object_check_counter++;
-        if (object_check_counter >= 5) {
-          LOG_INFO(TAG_UI, "📊 LVGL Object Tree: %lu child objects on screen", child_count);
-          object_check_counter = 0;
-        }
+  for (;;) {
+    uint32_t waitMs = uiTaskRunOnce();
 
-        last_child_count = child_count;
-      } else {
-        LOG_ERROR(TAG_UI, "🚨 Screen object is NULL!");
-        displayProblem = true;
-      }
-    }
-    // ===== END LVGL OBJECT TREE VALIDATION =====
-
-    // ===== DIAGNOSTIC: PSRAM Heap Monitoring =====
-    // Monitor PSRAM free space (icons/images stored in PSRAM buffers)
-    size_t psram_free = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
-    size_t psram_min = heap_caps_get_minimum_free_size(MALLOC_CAP_SPIRAM);
-    static uint8_t psram_check_counter = 0;
-    psram_check_counter++;
-    if (psram_check_counter >= 3) {  // Every 90 seconds
-      LOG_INFO(TAG_UI, "💾 PSRAM Heap: free=%zu KB, min_ever=%zu KB",
-               psram_free / 1024, psram_min / 1024);
-      psram_check_counter = 0;
-    }
-    // ===== END PSRAM MONITORING =====
-
-    // Periodic status logging
-    LOG_DEBUG(TAG_UI, "UI Health: Flush=%lums ago, Timer=%lums ago, Touch=%lums ago",
-              (lastFlushTimestamp > 0) ? (now - lastFlushTimestamp) : 999999,
-              now - lastLVGLTimerCall,
-              (lastTouchEvent > 0) ? (now - lastTouchEvent) : 999999);
-
-    if (displayProblem && !uiHealthWarningShown) {
-      LOG_ERROR(TAG_UI, "═════════════════════════════════════════════");
-      LOG_ERROR(TAG_UI, "  🚨 UI SYSTEM FAILURE DETECTED!");
-      LOG_ERROR(TAG_UI, "  Display may be blank or frozen");
-      LOG_ERROR(TAG_UI, "  Possible causes:");
-      LOG_ERROR(TAG_UI, "  - LVGL not initialized (check lv_timer_handler)");
-      LOG_ERROR(TAG_UI, "  - Display driver failed");
-      LOG_ERROR(TAG_UI, "  - SPI communication issue");
-      LOG_ERROR(TAG_UI, "  Check serial logs from setup() for errors");
-      LOG_ERROR(TAG_UI, "═════════════════════════════════════════════");
-      uiHealthWarningShown = true;
-    } else if (!displayProblem && uiHealthWarningShown) {
-      LOG_INFO(TAG_UI, "✅ UI health recovered");
-      uiHealthWarningShown = false;
-    }
+    // A channel notification may have been consumed by my_disp_wait() during the
+    // refresh - don't sleep on updates that are already waiting
+    if (uiChannelPending())
+      continue;
 
-    lastUIHealthCheck = now;
+    TickType_t waitTicks = pdMS_TO_TICKS(waitMs);
+    if (waitTicks == 0)
+      waitTicks = 1;  // Always yield - IDLE1 must get to run
+    watchdogExpect(WATCHDOG_RENDER, waitMs);
+    ulTaskNotifyTake(pdTRUE, waitTicks);
   }
+}
 
-  // CRITICAL: Yield CPU to prevent main loop from starving BLE task
-  // Without this, main loop runs at 56,000 Hz and blocks BLE task
-  // This allows FreeRTOS scheduler to balance workload between cores
-  delay(1);  // 1ms delay = ~1000 Hz max loop rate (plenty fast for UI)
+// Arduino loop task - all UI work lives in uiTaskFunction()
+void loop()
+{
+  vTaskDelete(NULL);
 }
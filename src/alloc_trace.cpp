@@ -0,0 +1,275 @@
+// =============================================================================
+// Heap Allocation Tracing Implementation
+// =============================================================================
+
+#include "alloc_trace.h"
+#include "console.h"
+#include "task_layout.h"
+
+static const char *const SCOPE_NAMES[ALLOC_SCOPE_COUNT] = {"", "scale link", "ble poll", "scale commands", "lvgl"};
+
+#if GS_ALLOC_TRACE
+
+// Rows: explicit scopes, then one per task role, then everything else
+constexpr uint8_t ROW_FIRST_ROLE = ALLOC_SCOPE_COUNT - 1;
+constexpr uint8_t ROW_OTHER      = ROW_FIRST_ROLE + TASK_ROLE_COUNT;
+constexpr uint8_t ROW_COUNT      = ROW_OTHER + 1;
+constexpr uint8_t SCOPE_TASKS    = 8;   // Tasks with a scope open at the same time
+
+struct Row {
+  uint32_t allocs;
+  uint32_t frees;
+  uint32_t bytes;       // Allocated since the reset (wraps)
+  uint32_t live;
+  uint32_t peak;
+};
+
+struct Slot {
+  void *ptr;            // NULL = empty, TOMBSTONE = freed
+  uint32_t size : 24;
+  uint32_t row : 8;
+};
+
+struct TaskScope {
+  TaskHandle_t task;
+  AllocScope scope;
+};
+
+static void *const TOMBSTONE = (void *)1;
+
+static portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+static Row rows[ROW_COUNT];
+static Slot slots[ALLOC_TRACE_SLOTS];
+static TaskScope scopes[SCOPE_TASKS];
+static uint32_t untrackedFrees = 0;
+static uint32_t tableFull = 0;
+
+static inline uint32_t slotOf(const void *ptr)
+{
+  return ((uint32_t)ptr >> 3) * 2654435761u & (ALLOC_TRACE_SLOTS - 1);
+}
+
+// Row the calling task is charged to
+static uint8_t callerRow()
+{
+  TaskHandle_t self = xTaskGetCurrentTaskHandle();
+  AllocScope scope = ALLOC_SCOPE_NONE;
+  portENTER_CRITICAL(&lock);
+  for (uint8_t i = 0; i < SCOPE_TASKS; i++) {
+    if (scopes[i].task == self) {
+      scope = scopes[i].scope;
+      break;
+    }
+  }
+  portEXIT_CRITICAL(&lock);
+  if (scope != ALLOC_SCOPE_NONE)
+    return scope - 1;
+  return ROW_FIRST_ROLE + taskLayoutRoleOf(self);   // TASK_ROLE_COUNT lands on ROW_OTHER
+}
+
+static void noteAlloc(void *ptr, size_t size, uint8_t row)
+{
+  if (ptr == NULL)
+    return;
+  portENTER_CRITICAL(&lock);
+  Row &r = rows[row];
+  r.allocs++;
+  r.bytes += size;
+  r.live += size;
+  if (r.live > r.peak)
+    r.peak = r.live;
+  uint32_t i = slotOf(ptr);
+  uint32_t probes = 0;
+  while (slots[i].ptr != NULL && slots[i].ptr != TOMBSTONE && probes < ALLOC_TRACE_SLOTS) {
+    i = (i + 1) & (ALLOC_TRACE_SLOTS - 1);
+    probes++;
+  }
+  if (probes < ALLOC_TRACE_SLOTS) {
+    slots[i].ptr = ptr;
+    slots[i].size = size > 0xFFFFFF ? 0xFFFFFF : size;
+    slots[i].row = row;
+  } else {
+    tableFull++;
+  }
+  portEXIT_CRITICAL(&lock);
+}
+
+static void noteFree(void *ptr)
+{
+  if (ptr == NULL)
+    return;
+  portENTER_CRITICAL(&lock);
+  uint32_t i = slotOf(ptr);
+  for (uint32_t probes = 0; probes < ALLOC_TRACE_SLOTS && slots[i].ptr != NULL; probes++) {
+    if (slots[i].ptr == ptr) {
+      Row &r = rows[slots[i].row];
+      r.frees++;
+      r.live = r.live > slots[i].size ? r.live - slots[i].size : 0;
+      slots[i].ptr = TOMBSTONE;
+      portEXIT_CRITICAL(&lock);
+      return;
+    }
+    i = (i + 1) & (ALLOC_TRACE_SLOTS - 1);
+  }
+  untrackedFrees++;
+  portEXIT_CRITICAL(&lock);
+}
+
+extern "C" {
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t n, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void __real_free(void *ptr);
+
+void *__wrap_malloc(size_t size)
+{
+  void *ptr = __real_malloc(size);
+  noteAlloc(ptr, size, callerRow());
+  return ptr;
+}
+
+void *__wrap_calloc(size_t n, size_t size)
+{
+  void *ptr = __real_calloc(n, size);
+  noteAlloc(ptr, n * size, callerRow());
+  return ptr;
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+  void *moved = __real_realloc(ptr, size);
+  if (moved != NULL || size == 0) {   // Failed realloc() keeps the old block
+    noteFree(ptr);
+    noteAlloc(moved, size, callerRow());
+  }
+  return moved;
+}
+
+void __wrap_free(void *ptr)
+{
+  noteFree(ptr);
+  __real_free(ptr);
+}
+}
+
+AllocTraceScope::AllocTraceScope(AllocScope scope) : previous(ALLOC_SCOPE_NONE)
+{
+  TaskHandle_t self = xTaskGetCurrentTaskHandle();
+  portENTER_CRITICAL(&lock);
+  int8_t freeSlot = -1;
+  for (uint8_t i = 0; i < SCOPE_TASKS; i++) {
+    if (scopes[i].task == self) {
+      previous = scopes[i].scope;
+      scopes[i].scope = scope;
+      portEXIT_CRITICAL(&lock);
+      return;
+    }
+    if (scopes[i].task == NULL && freeSlot < 0)
+      freeSlot = i;
+  }
+  if (freeSlot >= 0) {   // No slot left: the task stays charged to itself
+    scopes[freeSlot].task = self;
+    scopes[freeSlot].scope = scope;
+  }
+  portEXIT_CRITICAL(&lock);
+}
+
+AllocTraceScope::~AllocTraceScope()
+{
+  TaskHandle_t self = xTaskGetCurrentTaskHandle();
+  portENTER_CRITICAL(&lock);
+  for (uint8_t i = 0; i < SCOPE_TASKS; i++) {
+    if (scopes[i].task == self) {
+      scopes[i].scope = previous;
+      if (previous == ALLOC_SCOPE_NONE)
+        scopes[i].task = NULL;
+      break;
+    }
+  }
+  portEXIT_CRITICAL(&lock);
+}
+
+void allocTraceReset()
+{
+  portENTER_CRITICAL(&lock);
+  for (uint8_t i = 0; i < ROW_COUNT; i++) {
+    rows[i].allocs = 0;
+    rows[i].frees = 0;
+    rows[i].bytes = 0;
+    rows[i].peak = rows[i].live;
+  }
+  untrackedFrees = 0;
+  tableFull = 0;
+  portEXIT_CRITICAL(&lock);
+}
+
+static const char *rowName(uint8_t row)
+{
+  if (row < ROW_FIRST_ROLE)
+    return SCOPE_NAMES[row + 1];
+  if (row < ROW_OTHER)
+    return taskLayoutSpec((TaskRole)(row - ROW_FIRST_ROLE)).name;
+  return "other tasks";
+}
+
+void allocTraceDump(Print &out)
+{
+  Row copy[ROW_COUNT];
+  uint32_t untracked, full;
+  portENTER_CRITICAL(&lock);
+  memcpy(copy, rows, sizeof(copy));
+  untracked = untrackedFrees;
+  full = tableFull;
+  portEXIT_CRITICAL(&lock);
+
+  // Busiest first (a dozen rows - selection order is plenty)
+  uint8_t order[ROW_COUNT];
+  for (uint8_t i = 0; i < ROW_COUNT; i++)
+    order[i] = i;
+  for (uint8_t i = 0; i < ROW_COUNT; i++) {
+    for (uint8_t j = i + 1; j < ROW_COUNT; j++) {
+      if (copy[order[j]].allocs > copy[order[i]].allocs) {
+        uint8_t t = order[i];
+        order[i] = order[j];
+        order[j] = t;
+      }
+    }
+  }
+
+  out.printf("[Alloc] %-16s %8s %8s %10s %9s %9s\n", "subsystem", "allocs", "frees", "bytes", "live", "peak");
+  for (uint8_t n = 0; n < ROW_COUNT; n++) {
+    const Row &r = copy[order[n]];
+    if (r.allocs == 0 && r.frees == 0 && r.live == 0)
+      continue;
+    out.printf("        %-16s %8lu %8lu %10lu %9lu %9lu\n", rowName(order[n]), (unsigned long)r.allocs,
+               (unsigned long)r.frees, (unsigned long)r.bytes, (unsigned long)r.live, (unsigned long)r.peak);
+  }
+  out.printf("  untracked frees %lu, table full %lu (%lu slots)\n", (unsigned long)untracked, (unsigned long)full,
+             (unsigned long)ALLOC_TRACE_SLOTS);
+}
+
+#else
+
+AllocTraceScope::AllocTraceScope(AllocScope scope) : previous(scope) {}
+AllocTraceScope::~AllocTraceScope() {}
+
+void allocTraceReset() {}
+
+void allocTraceDump(Print &out)
+{
+  out.println("[Alloc] Not built in (GS_ALLOC_TRACE=0) - use env:gravimetric_shots_profile");
+}
+
+#endif // GS_ALLOC_TRACE
+
+static void cmdAlloc(ConsoleArgs &args)
+{
+  if (args.is(1, "reset")) {
+    allocTraceReset();
+    args.out.println("[Alloc] Counters reset");
+    return;
+  }
+  allocTraceDump(args.out);
+}
+
+static ConsoleCommand allocCommand("alloc", "[reset]", "Heap allocations per subsystem: count, bytes, live, peak (GS_ALLOC_TRACE builds)", cmdAlloc);
@@ -0,0 +1,91 @@
+#ifndef ALLOC_TRACE_H
+#define ALLOC_TRACE_H
+
+// =============================================================================
+// Heap Allocation Tracing (who allocates, how much, how often)
+// =============================================================================
+// health_monitor.h sees the heap shrink or fragment, but not who did it. In
+// GS_ALLOC_TRACE builds every malloc / calloc / realloc / free - the
+// firmware's, ArduinoBLE's, newlib's and the IDF's, `new` and String included -
+// goes through a linker wrapper (-Wl,--wrap=malloc, ...) that charges it to
+// a subsystem:
+//
+//   explicit scope   GS_ALLOC_SCOPE(ALLOC_SCOPE_SCALE_LINK) around a call
+//                    (scan / connect: new BLEDevice, String in init() and
+//                    isScaleName(); BLE.poll(): characteristic value
+//                    realloc()s; lv_timer_handler(); scale commands)
+//   task role        otherwise the task_layout.h role of the calling task
+//   other            library and IDF tasks (AsyncTCP, BLE controller, ipc)
+//
+// Per subsystem: allocations, frees, bytes allocated, bytes live and the
+// live peak. A free is charged to whoever made the allocation - live blocks
+// are kept in an open-addressed table of ALLOC_TRACE_SLOTS (pointer, size,
+// subsystem). Blocks from before tracing started, or that did not fit the
+// table, show up as "untracked" frees.
+//
+// Measuring a shot cycle: "alloc reset" on the console, run a shot (by hand,
+// or tools/scale_emulator + tools/hil_timing for a scripted one), then
+// "alloc". Everything still allocating in steady state shows in the "allocs"
+// column; "live" that keeps growing between cycles is a leak. heap_caps_*
+// buffers are not wrapped - mem_caps.h counts those ("heap"), and LVGL has
+// its own pool ("lvgl").
+//
+// Scopes are per task: a scope only claims allocations of the task that
+// opened it, so a pre-empting task is still charged to itself.
+//
+// GS_ALLOC_TRACE (compile-time, -DGS_ALLOC_TRACE=1, with the --wrap linker
+// flags - see env:gravimetric_shots_profile): 0 (default) compiles the
+// scopes to nothing and the command reports that tracing is not built in.
+//
+// Thread Safety:
+//   The wrappers and scopes run on any task, either core (one spinlock
+//   around the table and counters; not from ISRs, like malloc itself).
+//   allocTraceDump() / allocTraceReset() from the console.
+// =============================================================================
+
+#include <Arduino.h>
+
+#ifndef GS_ALLOC_TRACE
+#define GS_ALLOC_TRACE 0
+#endif
+
+constexpr uint32_t ALLOC_TRACE_SLOTS = 2048;   // Live blocks tracked (power of two, 8 bytes each, internal DRAM)
+
+enum AllocScope : uint8_t {
+  ALLOC_SCOPE_NONE = 0,       // Charge the calling task
+  ALLOC_SCOPE_SCALE_LINK,     // Scan, connect, reconnect (checkScaleStatus)
+  ALLOC_SCOPE_BLE_POLL,       // HCI drain + notification handlers (BLE.poll)
+  ALLOC_SCOPE_SCALE_COMMANDS, // processBLECommand()
+  ALLOC_SCOPE_LVGL,           // lv_timer_handler()
+  ALLOC_SCOPE_COUNT
+};
+
+/**
+ * @brief Zero the counters (live bytes stay, peak restarts from them)
+ */
+void allocTraceReset();
+
+/**
+ * @brief Per-subsystem table, busiest first by allocations
+ */
+void allocTraceDump(Print &out);
+
+class AllocTraceScope {
+public:
+  explicit AllocTraceScope(AllocScope scope);
+  ~AllocTraceScope();
+
+private:
+  AllocScope previous;
+};
+
+#if GS_ALLOC_TRACE
+#define GS_ALLOC_SCOPE(scope) AllocTraceScope GS_ALLOC_CONCAT(allocScope_, __LINE__)(scope)
+#else
+#define GS_ALLOC_SCOPE(scope) do {} while (0)
+#endif
+
+#define GS_ALLOC_CONCAT_(a, b) a##b
+#define GS_ALLOC_CONCAT(a, b)  GS_ALLOC_CONCAT_(a, b)
+
+#endif // ALLOC_TRACE_H
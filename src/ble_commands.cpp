@@ -0,0 +1,140 @@
+// =============================================================================
+// Two-Lane BLE Command Channel Implementation
+// =============================================================================
+
+#include "ble_commands.h"
+#include "debug_config.h"
+#include "metrics.h"
+#include "static_alloc.h"
+
+static constexpr LogTag TAG = LOG_TAG_TASK;
+
+enum CommandLane : uint8_t {
+  LANE_PRIORITY = 0,
+  LANE_NORMAL,
+  LANE_COUNT
+};
+
+struct CommandPolicy {
+  const char *name;
+  CommandLane lane;
+  bool coalesce;       // Merge into an already queued one
+  bool stopSupersedes; // Dropped if a STOP was submitted after it
+};
+
+static const CommandPolicy COMMAND_POLICY[BLE_CMD_COUNT] = {
+  {"TARE",            LANE_NORMAL,   true,  false},
+  {"START_TIMER",     LANE_NORMAL,   false, true},
+  {"STOP_TIMER",      LANE_PRIORITY, false, false},
+  {"RESET_TIMER",     LANE_NORMAL,   false, true},
+  {"DISCONNECT",      LANE_NORMAL,   false, false},
+  {"FORCE_RECONNECT", LANE_NORMAL,   true,  false},
+  {"SELECT_SCALE",    LANE_NORMAL,   false, false},
+};
+
+static MetricHistogram roundTripMs("ble_command_ms", "BLE command round-trip, queued to done", METRIC_BUCKETS_MS);
+static MetricHistogram priorityRoundTripMs("ble_priority_command_ms", "STOP round-trip, queued to done", METRIC_BUCKETS_MS);
+static MetricCounter coalesced("ble_commands_coalesced_total", "Commands merged into an identical queued one");
+static MetricCounter superseded("ble_commands_superseded_total", "START / RESET dropped after a later STOP");
+static MetricCounter rejected("ble_commands_rejected_total", "Commands refused by a full lane");
+
+static portMUX_TYPE commandMux = portMUX_INITIALIZER_UNLOCKED;
+static QueueHandle_t lanes[LANE_COUNT] = {};
+static StaticQueue<BLECommandMessage, BLE_COMMAND_PRIORITY_LEN> priorityLane;
+static StaticQueue<BLECommandMessage, BLE_COMMAND_NORMAL_LEN> normalLane;
+static uint32_t queuedMask = 0;     // Coalescing commands currently queued (bit = BLECommand)
+static uint32_t nextSeq = 1;
+static uint32_t lastStopSeq = 0;
+static volatile TaskHandle_t consumer = NULL;
+static uint32_t consumerBits = 0;
+
+void bleCommandsBegin()
+{
+  lanes[LANE_PRIORITY] = priorityLane.create();
+  lanes[LANE_NORMAL] = normalLane.create();
+}
+
+void bleCommandsSetConsumer(TaskHandle_t task, uint32_t notifyBits)
+{
+  consumerBits = notifyBits;
+  consumer = task;
+}
+
+bool bleCommandSubmit(BLECommand command, uint32_t param, BLECommandDoneFn done)
+{
+  const CommandPolicy &policy = COMMAND_POLICY[command];
+  QueueHandle_t lane = lanes[policy.lane];
+  if (lane == NULL)
+    return false;
+
+  BLECommandMessage msg = {command, param, millis(), 0, done};
+  bool merged = false;
+  portENTER_CRITICAL(&commandMux);
+  if (policy.coalesce && (queuedMask & (1u << command))) {
+    merged = true;
+  } else {
+    if (policy.coalesce)
+      queuedMask |= 1u << command;
+    msg.seq = nextSeq++;
+    if (command == BLE_CMD_STOP_TIMER)
+      lastStopSeq = msg.seq;  // Before the enqueue: a START can never overtake it
+  }
+  portEXIT_CRITICAL(&commandMux);
+
+  if (merged) {
+    coalesced.add();
+    LOG_DEBUG(TAG, "%s merged into the queued one", policy.name);
+    return true;
+  }
+  if (xQueueSend(lane, &msg, 0) != pdTRUE) {
+    if (policy.coalesce) {
+      portENTER_CRITICAL(&commandMux);
+      queuedMask &= ~(1u << command);
+      portEXIT_CRITICAL(&commandMux);
+    }
+    rejected.add();
+    return false;
+  }
+  TaskHandle_t task = consumer;
+  if (task != NULL)
+    xTaskNotify(task, consumerBits, eSetBits);
+  return true;
+}
+
+bool bleCommandReceive(BLECommandMessage *msg)
+{
+  for (;;) {
+    bool got = false;
+    for (uint8_t lane = 0; lane < LANE_COUNT && !got; lane++)
+      got = lanes[lane] != NULL && xQueueReceive(lanes[lane], msg, 0) == pdTRUE;
+    if (!got)
+      return false;
+
+    const CommandPolicy &policy = COMMAND_POLICY[msg->command];
+    portENTER_CRITICAL(&commandMux);
+    if (policy.coalesce)
+      queuedMask &= ~(1u << msg->command);  // The next submit queues a fresh one
+    bool stale = policy.stopSupersedes && (int32_t)(lastStopSeq - msg->seq) > 0;
+    portEXIT_CRITICAL(&commandMux);
+
+    if (!stale)
+      return true;
+    superseded.add();
+    LOG_WARN(TAG, "STOP: dropped stale %s queued %lums ago", policy.name, millis() - msg->queuedMs);
+  }
+}
+
+void bleCommandComplete(const BLECommandMessage &msg, bool ok)
+{
+  uint32_t ms = millis() - msg.queuedMs;
+  roundTripMs.record(ms);
+  if (COMMAND_POLICY[msg.command].lane == LANE_PRIORITY)
+    priorityRoundTripMs.record(ms);
+  if (msg.done != NULL)
+    msg.done(msg.command, ok, msg.param);
+}
+
+const char *bleCommandName(BLECommand command)
+{
+  return command < BLE_CMD_COUNT ? COMMAND_POLICY[command].name : "UNKNOWN";
+}
@@ -0,0 +1,89 @@
+#ifndef BLE_COMMANDS_H
+#define BLE_COMMANDS_H
+
+// =============================================================================
+// Two-Lane BLE Command Channel (UI / any task → BLE task)
+// =============================================================================
+// Replaces the single 10-deep bleCommandQueue, where STOP had to flush
+// every queued command to get ahead of them. Each command has a fixed
+// policy (COMMAND_POLICY in ble_commands.cpp):
+//
+//   lane        PRIORITY (STOP_TIMER) is always dispatched before NORMAL
+//               (everything else) - STOP no longer waits behind a TARE.
+//   coalesce    TARE, FORCE_RECONNECT: while one is still queued, another
+//               submit of the same command merges into it (counted).
+//   superseded  START_TIMER, RESET_TIMER queued before a STOP are dropped
+//               when they come up - they are stale once the shot stopped.
+//               Everything else queued before STOP still runs (it used to
+//               be thrown away).
+//
+// Submission never blocks: a full lane fails the submit at once (counted)
+// instead of waiting up to 100 ms on the UI core. A command can carry a
+// completion callback, run on the BLE task once processBLECommand() is
+// done with it; callbacks only hand results to the UI (ui_channel.h) and
+// must not block. A coalesced submit's callback is not called - the
+// command it merged into reports.
+//
+// The relay is not a queued command: setRelayState(false) switches the pin
+// on the caller right away, before the STOP reaches the scale.
+//
+// Thread Safety:
+//   bleCommandSubmit() - any task, either core (spinlock, never blocks).
+//   bleCommandReceive() / bleCommandComplete() - BLE task only.
+// =============================================================================
+
+#include <Arduino.h>
+
+constexpr UBaseType_t BLE_COMMAND_PRIORITY_LEN = 4;
+constexpr UBaseType_t BLE_COMMAND_NORMAL_LEN   = 10;
+
+enum BLECommand : uint8_t {
+    BLE_CMD_TARE,
+    BLE_CMD_START_TIMER,
+    BLE_CMD_STOP_TIMER,
+    BLE_CMD_RESET_TIMER,
+    BLE_CMD_DISCONNECT,
+    BLE_CMD_FORCE_RECONNECT,
+    BLE_CMD_SELECT_SCALE,   // param = candidate generation << 8 | row (0xFF = any scale)
+    BLE_CMD_COUNT
+};
+
+// Completion on the BLE task: `ok` is processBLECommand()'s result
+typedef void (*BLECommandDoneFn)(BLECommand command, bool ok, uint32_t param);
+
+struct BLECommandMessage {
+    BLECommand command;
+    uint32_t param;          // Optional parameter
+    uint32_t queuedMs;       // millis() when queued - round-trip metric
+    uint32_t seq;            // Submission order across both lanes
+    BLECommandDoneFn done;   // Optional
+};
+
+/**
+ * @brief Create both lanes (static storage); the consumer is woken with xTaskNotify(`notifyBits`, eSetBits)
+ */
+void bleCommandsBegin();
+void bleCommandsSetConsumer(TaskHandle_t task, uint32_t notifyBits);
+
+/**
+ * @brief Queue a command in its lane (or merge it into a queued one) - never blocks
+ * @return false if the lane is full
+ */
+bool bleCommandSubmit(BLECommand command, uint32_t param = 0, BLECommandDoneFn done = NULL);
+
+/**
+ * @brief Next command to run: priority lane first, stale commands skipped
+ */
+bool bleCommandReceive(BLECommandMessage *msg);
+
+/**
+ * @brief Record the round-trip and run the completion callback
+ */
+void bleCommandComplete(const BLECommandMessage &msg, bool ok);
+
+/**
+ * @brief Command name for logs
+ */
+const char *bleCommandName(BLECommand command);
+
+#endif // BLE_COMMANDS_H
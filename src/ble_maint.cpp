@@ -0,0 +1,721 @@
+// =============================================================================
+// BLE Maintenance Channel Implementation
+// =============================================================================
+
+#include "ble_maint.h"
+#include "console.h"
+#include "debug_config.h"
+#include "mem_caps.h"
+#include "metrics.h"
+#include "ota_update.h"
+#include "shot_profile.h"
+#include "static_alloc.h"
+#include "task_layout.h"
+#include <ArduinoBLE.h>
+#include <Preferences.h>
+
+#if GS_BLE_MAINT
+
+static constexpr LogTag TAG = LOG_TAG_BLE;
+
+static constexpr uint8_t  GOAL_MAX_G        = 80;     // Preset slider range (SquareLine)
+static constexpr int16_t  OFFSET_LIMIT_CG   = 1270;   // offset_model.cpp keeps int8 tenths
+static constexpr UBaseType_t JOB_QUEUE_LEN  = 6;      // Cancel + begin, two buffers, partial buffer + finish
+static constexpr UBaseType_t REPORT_QUEUE_LEN = 6;   // One per job
+static constexpr size_t   CONTROL_VALUE_BYTES = sizeof(BleMaintStatus);
+static const char *BOND_NAMESPACE = "blebonds";
+static const char *BOND_KEY       = "bonds";
+
+enum JobKind : uint8_t { JOB_BEGIN, JOB_WRITE, JOB_FINISH, JOB_CANCEL };
+
+// BLE task → OtaWriter task. Buffer contents stay untouched until the job's report.
+struct WriterJob {
+  uint8_t kind;        // JobKind
+  uint8_t session;
+  uint8_t buffer;      // JOB_WRITE
+  uint32_t arg;        // JOB_BEGIN: total bytes; JOB_WRITE: length
+};
+
+// OtaWriter task → BLE task, one per job
+struct WriterReport {
+  uint8_t op;          // BLE_MAINT_OP_ACK / DONE / FAILED
+  uint8_t session;
+  uint16_t code;
+  uint32_t flashed;    // Body bytes through the OTA pipeline
+  const char *reason;
+};
+
+static BLEService service(BLE_MAINT_SERVICE_UUID);
+static BLECharacteristic controlCharacteristic(BLE_MAINT_CONTROL_UUID, BLEWrite | BLENotify | BLEEncryption,
+                                               CONTROL_VALUE_BYTES, false);
+static BLECharacteristic dataCharacteristic(BLE_MAINT_DATA_UUID, BLEWriteWithoutResponse | BLEEncryption,
+                                            BLE_MAINT_CHUNK_MAX + 4, false);
+static BLECharacteristic settingsCharacteristic(BLE_MAINT_SETTINGS_UUID, BLERead | BLEWrite | BLEEncryption,
+                                                sizeof(BleMaintSettings), true);
+
+static TaskHandle_t bleTaskHandle = NULL;
+static uint32_t bleTaskEvent = 0;
+static TaskHandle_t writerTask = NULL;
+static QueueHandle_t jobs = NULL;
+static QueueHandle_t reports = NULL;
+static StaticQueue<WriterJob, JOB_QUEUE_LEN> jobStore;
+static StaticQueue<WriterReport, REPORT_QUEUE_LEN> reportStore;
+
+// Two update buffers (PSRAM, allocated by the first update, kept for the next)
+static uint8_t *buffers[2] = {NULL, NULL};
+
+// Session state - BLE task only
+enum SessionState : uint8_t { SESSION_IDLE = 0, SESSION_STARTING, SESSION_STREAMING, SESSION_FINISHING };
+static SessionState state = SESSION_IDLE;
+static uint8_t session = 0;          // Tags jobs / reports; stale reports are dropped
+static uint32_t total = 0;
+static uint32_t received = 0;        // Contiguous bytes taken into the buffers
+static uint32_t acked = 0;           // Bytes the writer has put through the pipeline
+static uint8_t fill = 0;             // Buffer being filled
+static uint32_t fillLen = 0;
+static uint32_t nackedAt = UINT32_MAX;  // One NACK per gap
+static bool nackPending = false;
+static uint16_t failCode = 0;           // Failure to report from bleMaintPoll()
+static const char *failReason = NULL;
+static uint32_t lastChunkMs = 0;
+static uint16_t chunkBytes = 23 - 3 - 4;     // Default ATT MTU until the client negotiates
+static String clientAddress;
+
+// Settings written by the client, taken by the UI / control task
+static portMUX_TYPE settingsLock = portMUX_INITIALIZER_UNLOCKED;
+static BleMaintSettings pendingSettings = {};
+static uint8_t pendingFields = 0;
+static BleMaintSettings liveSettings = {};   // BLE task: as last published
+static TaskHandle_t uiConsumer = NULL;
+static TaskHandle_t controlConsumer = NULL;
+static uint32_t controlConsumerBit = 0;
+
+// Bonds - BLE task (ArduinoBLE calls the key callbacks inside BLE.poll())
+struct BondRecord {
+  uint8_t used;
+  uint8_t address[6];    // Identity address, as ArduinoBLE hands it over
+  uint8_t irk[16];
+  uint8_t ltk[16];
+};
+
+static BondRecord bonds[BLE_MAINT_BONDS];
+static bool pairOpen = false;
+static uint32_t pairOpenedMs = 0;
+static volatile bool pairRequested = false;     // "blepair" → BLE task
+static volatile bool forgetRequested = false;   // "blepair forget" → BLE task
+
+static volatile uint32_t updates = 0;
+static volatile uint32_t nacks = 0;
+static volatile uint32_t windowStalls = 0;
+static volatile uint32_t settingsWrites = 0;
+static volatile uint32_t untrustedWrites = 0;
+
+static MetricCounterRef updatesTotal("ble_maint_updates_total", "Firmware images verified over the BLE maintenance channel", &updates);
+static MetricCounterRef nacksTotal("ble_maint_nacks_total", "Update chunks discarded out of order (client resent from the NACK offset)", &nacks);
+static MetricCounterRef stallsTotal("ble_maint_window_stalls_total", "Update chunks beyond the ack window (both buffers waiting for flash)", &windowStalls);
+static MetricCounterRef settingsTotal("ble_maint_settings_writes_total", "Settings records written over BLE", &settingsWrites);
+static MetricCounterRef untrustedTotal("ble_maint_untrusted_total", "Maintenance writes refused on a link that is not encrypted", &untrustedWrites);
+
+static void report(uint8_t op, uint8_t tag, uint16_t code, uint32_t flashed, const char *reason)
+{
+  WriterReport r = {op, tag, code, flashed, reason};
+  xQueueSend(reports, &r, portMAX_DELAY);  // One per job: never more than the BLE task takes
+  if (bleTaskHandle != NULL)
+    xTaskNotify(bleTaskHandle, bleTaskEvent, eSetBits);
+}
+
+// =============================================================================
+// OtaWriter task: the OTA pipeline runs here while the BLE task fills the other buffer
+// =============================================================================
+
+static void writerTaskFunction(void *)
+{
+  uint8_t owned = 0xFF;  // Session holding the upload (otaUploadBegin() accepted)
+  uint32_t flashed = 0;
+  for (;;) {
+    WriterJob job;
+    if (xQueueReceive(jobs, &job, portMAX_DELAY) != pdTRUE)
+      continue;
+
+    switch (job.kind) {
+      case JOB_BEGIN: {
+        const char *refusal = NULL;
+        flashed = 0;
+        owned = otaUploadBegin(job.arg, "ble", &refusal) ? job.session : 0xFF;
+        if (owned == job.session)
+          report(BLE_MAINT_OP_ACK, job.session, 0, 0, NULL);
+        else
+          report(BLE_MAINT_OP_FAILED, job.session, 409, 0, refusal);
+        break;
+      }
+      case JOB_WRITE:
+        if (owned == job.session && otaUploadWrite(buffers[job.buffer], job.arg)) {
+          flashed += job.arg;
+          report(BLE_MAINT_OP_ACK, job.session, 0, flashed, NULL);
+        } else {
+          report(BLE_MAINT_OP_FAILED, job.session, owned == job.session ? otaUploadStatus() : 409, flashed,
+                 owned == job.session ? otaUploadError() : "upload taken over");
+          owned = 0xFF;
+        }
+        break;
+      case JOB_FINISH:
+        if (owned == job.session && otaUploadFinish()) {
+          report(BLE_MAINT_OP_DONE, job.session, 200, flashed, NULL);
+          otaRestartSoon();  // The DONE notification goes out meanwhile
+        } else {
+          report(BLE_MAINT_OP_FAILED, job.session, owned == job.session ? otaUploadStatus() : 409, flashed,
+                 owned == job.session ? otaUploadError() : "upload taken over");
+        }
+        owned = 0xFF;
+        break;
+      case JOB_CANCEL:
+        if (owned == job.session)
+          otaUploadAbort("cancelled by the BLE client");
+        owned = 0xFF;
+        report(BLE_MAINT_OP_FAILED, job.session, 400, flashed, "cancelled");
+        break;
+    }
+  }
+}
+
+// =============================================================================
+// Bonds: ArduinoBLE's key store, kept in NVS
+// =============================================================================
+
+static void loadBonds()
+{
+  Preferences prefs;
+  bool found = false;
+  if (prefs.begin(BOND_NAMESPACE, true))
+  {
+    found = prefs.getBytes(BOND_KEY, bonds, sizeof(bonds)) == sizeof(bonds);
+    prefs.end();
+  }
+  if (!found)
+    memset(bonds, 0, sizeof(bonds));
+}
+
+static void storeBonds()
+{
+  Preferences prefs;
+  if (prefs.begin(BOND_NAMESPACE, false))
+  {
+    prefs.putBytes(BOND_KEY, bonds, sizeof(bonds));
+    prefs.end();
+  }
+}
+
+static uint8_t bondCount()
+{
+  uint8_t n = 0;
+  for (const BondRecord &b : bonds)
+    n += b.used;
+  return n;
+}
+
+static BondRecord *findBond(const uint8_t *address, bool add)
+{
+  BondRecord *unused = NULL;
+  for (BondRecord &b : bonds) {
+    if (b.used && memcmp(b.address, address, sizeof(b.address)) == 0)
+      return &b;
+    if (!b.used && unused == NULL)
+      unused = &b;
+  }
+  if (!add || unused == NULL)
+    return NULL;
+  memset(unused, 0, sizeof(*unused));
+  unused->used = 1;
+  memcpy(unused->address, address, sizeof(unused->address));
+  return unused;
+}
+
+// Pairing: the peer's identity address and IRK, then its LTK
+static int storeIrk(uint8_t *address, uint8_t *irk)
+{
+  BondRecord *b = findBond(address, true);
+  if (b == NULL)
+    return 0;  // Full - "blepair" does not open the window then
+  memcpy(b->irk, irk, sizeof(b->irk));
+  return 1;
+}
+
+static int storeLtk(uint8_t *address, uint8_t *ltk)
+{
+  BondRecord *b = findBond(address, true);
+  if (b == NULL)
+    return 0;
+  memcpy(b->ltk, ltk, sizeof(b->ltk));
+  storeBonds();
+  LOG_INFO(TAG, "🔐 BLE maintenance: bonded with %02x:%02x:%02x:%02x:%02x:%02x (%u of %u)", address[0], address[1],
+           address[2], address[3], address[4], address[5], (unsigned)bondCount(), (unsigned)BLE_MAINT_BONDS);
+  return 1;
+}
+
+// Reconnect: the LTK that encrypts the link - none, and the link stays plain
+static int getLtk(uint8_t *address, uint8_t *ltk)
+{
+  const BondRecord *b = findBond(address, false);
+  if (b == NULL)
+    return 0;
+  memcpy(ltk, b->ltk, sizeof(b->ltk));
+  return 1;
+}
+
+// Resolving private addresses; ArduinoBLE delete[]s the arrays
+static int getIrks(uint8_t *count, uint8_t **types, uint8_t ***addresses, uint8_t ***irks)
+{
+  uint8_t n = bondCount();
+  *count = n;
+  *types = new uint8_t[n];
+  *addresses = new uint8_t *[n];
+  *irks = new uint8_t *[n];
+  uint8_t i = 0;
+  for (const BondRecord &b : bonds) {
+    if (!b.used)
+      continue;
+    (*types)[i] = 0;
+    (*addresses)[i] = new uint8_t[sizeof(b.address)];
+    (*irks)[i] = new uint8_t[sizeof(b.irk)];
+    memcpy((*addresses)[i], b.address, sizeof(b.address));
+    memcpy((*irks)[i], b.irk, sizeof(b.irk));
+    i++;
+  }
+  return 1;
+}
+
+// Pairing is only accepted inside a "blepair" window, so an encrypted link
+// is a bonded central (getLtk() found its key) or the one the owner is
+// pairing right now - anything else is refused before it touches state
+static bool trusted(const BLEDevice &central, const char *what)
+{
+  if (central.encrypted())
+    return true;
+  untrustedWrites++;
+  if (what != NULL)
+    LOG_WARN(TAG, "⚠️  BLE maintenance: %s from %s refused - link not encrypted (bond with \"blepair\")", what,
+             central.address().c_str());
+  return false;
+}
+
+static void pollPairing()
+{
+  if (forgetRequested) {
+    forgetRequested = false;
+    memset(bonds, 0, sizeof(bonds));
+    storeBonds();
+    LOG_INFO(TAG, "🔐 BLE maintenance: every bond dropped");
+  }
+  if (pairRequested) {
+    pairRequested = false;
+    if (bondCount() >= BLE_MAINT_BONDS) {
+      LOG_WARN(TAG, "⚠️  BLE maintenance: %u bonds kept already - \"blepair forget\" first", (unsigned)BLE_MAINT_BONDS);
+    } else {
+      BLE.setPairable(Pairable::ONCE);  // Closes itself after the first pairing request
+      pairOpen = true;
+      pairOpenedMs = millis();
+      LOG_INFO(TAG, "🔐 BLE maintenance: pairing open for %lus", (unsigned long)(BLE_MAINT_PAIR_WINDOW_MS / 1000));
+    }
+  }
+  if (pairOpen && millis() - pairOpenedMs >= BLE_MAINT_PAIR_WINDOW_MS) {
+    BLE.setPairable(Pairable::NO);
+    pairOpen = false;
+  }
+}
+
+// =============================================================================
+// GATT handlers (inside BLE.poll(), BLE task) - no HCI traffic from here
+// =============================================================================
+
+static bool submit(uint8_t kind, uint8_t buffer, uint32_t arg)
+{
+  WriterJob job = {kind, session, buffer, arg};
+  return xQueueSend(jobs, &job, 0) == pdTRUE;
+}
+
+static void sendStatus(const BleMaintStatus &status, size_t reasonLen)
+{
+  controlCharacteristic.writeValue((const uint8_t *)&status, offsetof(BleMaintStatus, reason) + reasonLen);
+}
+
+static void sendFailed(uint16_t code, const char *reason)
+{
+  BleMaintStatus status = {};
+  status.op = BLE_MAINT_OP_FAILED;
+  status.code = code;
+  snprintf(status.reason, sizeof(status.reason), "%s", reason ? reason : "");
+  sendStatus(status, strlen(status.reason) + 1);
+  LOG_WARN(TAG, "⚠️  BLE update failed after %lu bytes - %s", (unsigned long)acked, status.reason);
+}
+
+static void sendAck()
+{
+  BleMaintStatus status = {};
+  status.op = BLE_MAINT_OP_ACK;
+  status.offset = acked;
+  status.window = (uint16_t)(2 * BLE_MAINT_BUFFER_BYTES);
+  status.chunk = chunkBytes;
+  sendStatus(status, 0);
+}
+
+// From the GATT handlers: the notification goes out from bleMaintPoll()
+static void deferFailure(uint16_t code, const char *reason)
+{
+  failCode = code;
+  failReason = reason;
+}
+
+static void endSession()
+{
+  state = SESSION_IDLE;
+  session++;  // Reports still queued for the old one are dropped
+}
+
+static void beginSession(uint32_t bytes)
+{
+  if (state != SESSION_IDLE)
+    submit(JOB_CANCEL, 0, 0);  // Restarted by the client
+  endSession();
+  for (uint8_t i = 0; i < 2; i++) {
+    if (buffers[i] == NULL)
+      buffers[i] = (uint8_t *)memCapsAlloc(BLE_MAINT_BUFFER_BYTES, MEM_PSRAM, MEM_OWNER_BLE_MAINT);
+  }
+  if (buffers[0] == NULL || buffers[1] == NULL) {
+    deferFailure(500, "no memory for the update buffers");
+    return;
+  }
+
+  total = bytes;
+  received = 0;
+  acked = 0;
+  fill = 0;
+  fillLen = 0;
+  nackedAt = UINT32_MAX;
+  nackPending = false;
+  lastChunkMs = millis();
+
+  uint16_t mtu = BLE.central().mtu();
+  chunkBytes = (uint16_t)min((size_t)(mtu > 7 ? mtu - 3 - 4 : 1), BLE_MAINT_CHUNK_MAX);
+  if (submit(JOB_BEGIN, 0, bytes))
+    state = SESSION_STARTING;
+  else
+    deferFailure(500, "flash writer busy");
+}
+
+static void onControlWritten(BLEDevice central, BLECharacteristic characteristic)
+{
+  const uint8_t *value = characteristic.value();
+  int len = characteristic.valueLength();
+  if (len < 1)
+    return;
+  if (!trusted(central, "update command")) {
+    deferFailure(401, "not bonded - pair with 'blepair' on the unit's USB console");
+    return;
+  }
+
+  switch (value[0]) {
+    case BLE_MAINT_OP_BEGIN:
+      if (len >= 5) {
+        uint32_t bytes;
+        memcpy(&bytes, value + 1, sizeof(bytes));
+        LOG_INFO(TAG, "📥 BLE update: %lu bytes announced", (unsigned long)bytes);
+        beginSession(bytes);
+      }
+      break;
+    case BLE_MAINT_OP_END:
+      if (state != SESSION_STREAMING)
+        break;
+      if (received != total) {
+        submit(JOB_CANCEL, 0, 0);
+        endSession();
+        deferFailure(400, "image shorter than announced");
+        break;
+      }
+      if (fillLen > 0)
+        submit(JOB_WRITE, fill, fillLen);  // The last, partial buffer
+      fillLen = 0;
+      submit(JOB_FINISH, 0, 0);
+      state = SESSION_FINISHING;
+      break;
+    case BLE_MAINT_OP_CANCEL:
+      if (state != SESSION_IDLE) {
+        submit(JOB_CANCEL, 0, 0);
+        endSession();
+      }
+      break;
+  }
+}
+
+static void nack()
+{
+  nacks++;
+  if (nackedAt != received) {
+    nackedAt = received;
+    nackPending = true;  // Sent from bleMaintPoll()
+  }
+}
+
+static void onDataWritten(BLEDevice central, BLECharacteristic characteristic)
+{
+  const uint8_t *value = characteristic.value();
+  int len = characteristic.valueLength();
+  if (state != SESSION_STREAMING || len <= 4)
+    return;
+  if (!trusted(central, NULL))
+    return;  // Counted, not logged - a stream of them would flood the log
+
+  uint32_t offset;
+  memcpy(&offset, value, sizeof(offset));
+  const uint8_t *data = value + 4;
+  uint32_t n = (uint32_t)len - 4;
+  if (offset < received)
+    return;  // Resent after a NACK - already have it
+  if (offset > received) {
+    nack();  // A write got lost: everything after it until the client rewinds is dropped
+    return;
+  }
+  if (offset + n > total || offset + n > acked + 2 * BLE_MAINT_BUFFER_BYTES) {
+    windowStalls++;
+    nack();
+    return;
+  }
+
+  lastChunkMs = millis();
+  received += n;
+  nackedAt = UINT32_MAX;
+  while (n > 0) {
+    uint32_t take = min(n, (uint32_t)(BLE_MAINT_BUFFER_BYTES - fillLen));
+    memcpy(buffers[fill] + fillLen, data, take);
+    fillLen += take;
+    data += take;
+    n -= take;
+    if (fillLen == BLE_MAINT_BUFFER_BYTES) {
+      // The window keeps the other buffer free: its bytes were acked before these could arrive
+      submit(JOB_WRITE, fill, fillLen);
+      fill ^= 1;
+      fillLen = 0;
+    }
+  }
+}
+
+static bool validSettings(const BleMaintSettings &s)
+{
+  if (s.version != BLE_MAINT_SETTINGS_VERSION)
+    return false;
+  if ((s.fields & BLE_MAINT_SET_GOAL) && (s.goalDg < 10 || s.goalDg > GOAL_MAX_G * 10))
+    return false;
+  if ((s.fields & BLE_MAINT_SET_OFFSET) && (s.offsetCg < -OFFSET_LIMIT_CG || s.offsetCg > OFFSET_LIMIT_CG))
+    return false;
+  if ((s.fields & BLE_MAINT_SET_BRIGHTNESS) && (s.brightnessPct < 1 || s.brightnessPct > 100))
+    return false;
+  if ((s.fields & BLE_MAINT_SET_PROFILE) && s.profile >= SHOT_PROFILE_SLOTS)
+    return false;
+  return (s.fields & BLE_MAINT_SET_ALL) != 0;
+}
+
+static void onSettingsWritten(BLEDevice central, BLECharacteristic characteristic)
+{
+  if (!trusted(central, "settings write"))
+    return;
+  BleMaintSettings s;
+  if (characteristic.valueLength() != (int)sizeof(s)) {
+    LOG_WARN(TAG, "⚠️  BLE settings: %d bytes, expected %u", characteristic.valueLength(), (unsigned)sizeof(s));
+    return;
+  }
+  memcpy(&s, characteristic.value(), sizeof(s));
+  if (!validSettings(s)) {
+    LOG_WARN(TAG, "⚠️  BLE settings: record v%u fields 0x%02x out of range - ignored", s.version, s.fields);
+    return;
+  }
+
+  uint8_t fields = s.fields & BLE_MAINT_SET_ALL;
+  if (!(fields & BLE_MAINT_SET_GOAL))
+    s.goalDg = liveSettings.goalDg;  // An offset alone is for the current goal
+  portENTER_CRITICAL(&settingsLock);
+  BleMaintSettings merged = pendingSettings;
+  if ((fields & BLE_MAINT_SET_GOAL) || !(pendingFields & BLE_MAINT_SET_GOAL))
+    merged.goalDg = s.goalDg;  // A goal still pending stays the offset's goal
+  if (fields & BLE_MAINT_SET_OFFSET)     merged.offsetCg = s.offsetCg;
+  if (fields & BLE_MAINT_SET_BRIGHTNESS) merged.brightnessPct = s.brightnessPct;
+  if (fields & BLE_MAINT_SET_PROFILE)    merged.profile = s.profile;
+  merged.version = BLE_MAINT_SETTINGS_VERSION;
+  pendingSettings = merged;
+  pendingFields |= fields;
+  portEXIT_CRITICAL(&settingsLock);
+  settingsWrites++;
+
+  LOG_INFO(TAG, "⚙️  BLE settings: fields 0x%02x (goal %.1fg, offset %.2fg, brightness %u%%, profile %u)", fields,
+           s.goalDg / 10.0f, s.offsetCg / 100.0f, s.brightnessPct, s.profile);
+  if ((fields & (BLE_MAINT_SET_GOAL | BLE_MAINT_SET_BRIGHTNESS)) && uiConsumer != NULL)
+    xTaskNotifyGive(uiConsumer);
+  if ((fields & (BLE_MAINT_SET_OFFSET | BLE_MAINT_SET_PROFILE)) && controlConsumer != NULL)
+    xTaskNotify(controlConsumer, controlConsumerBit, eSetBits);
+}
+
+// =============================================================================
+// Public API
+// =============================================================================
+
+void bleMaintBegin(TaskHandle_t bleTask, uint32_t bleEvent)
+{
+  // Bonding key store; no pairing until "blepair" opens a window
+  loadBonds();
+  BLE.setStoreIRK(storeIrk);
+  BLE.setGetIRKs(getIrks);
+  BLE.setStoreLTK(storeLtk);
+  BLE.setGetLTK(getLtk);
+  BLE.setPairable(Pairable::NO);
+
+  bleTaskHandle = bleTask;
+  bleTaskEvent = bleEvent;
+  jobs = jobStore.create();
+  reports = reportStore.create();
+  if (taskLayoutSpawn(TASK_ROLE_OTA_WRITER, writerTaskFunction, NULL, &writerTask) != pdPASS) {
+    LOG_ERROR(TAG, "❌ BLE maintenance: failed to create the flash writer - service not offered");
+    return;
+  }
+
+  controlCharacteristic.setEventHandler(BLEWritten, onControlWritten);
+  dataCharacteristic.setEventHandler(BLEWritten, onDataWritten);
+  settingsCharacteristic.setEventHandler(BLEWritten, onSettingsWritten);
+  service.addCharacteristic(controlCharacteristic);
+  service.addCharacteristic(dataCharacteristic);
+  service.addCharacteristic(settingsCharacteristic);
+  BLE.addService(service);
+  settingsCharacteristic.writeValue((const uint8_t *)&liveSettings, sizeof(liveSettings));
+  LOG_INFO(TAG, "🔧 BLE maintenance service: updates + settings (%u byte buffers), %u bonded centrals",
+           (unsigned)BLE_MAINT_BUFFER_BYTES, (unsigned)bondCount());
+}
+
+void bleMaintSetConsumers(TaskHandle_t uiTask, TaskHandle_t controlTask, uint32_t controlBit)
+{
+  uiConsumer = uiTask;
+  controlConsumer = controlTask;
+  controlConsumerBit = controlBit;
+}
+
+// Client gone mid-update: the writer drops the upload
+static void trackClient()
+{
+  BLEDevice central = BLE.central();
+  String address = central ? central.address() : String();
+  if (address == clientAddress)
+    return;
+  clientAddress = address;
+  if (state == SESSION_STARTING || state == SESSION_STREAMING) {
+    LOG_WARN(TAG, "⚠️  BLE update: client disconnected after %lu of %lu bytes", (unsigned long)received,
+             (unsigned long)total);
+    submit(JOB_CANCEL, 0, 0);
+    endSession();
+  }
+}
+
+void bleMaintPoll(const BleMaintSettings &current)
+{
+  if (writerTask == NULL)
+    return;
+
+  if (memcmp(&current, &liveSettings, sizeof(current)) != 0) {
+    liveSettings = current;
+    settingsCharacteristic.writeValue((const uint8_t *)&liveSettings, sizeof(liveSettings));
+  }
+
+  trackClient();
+  pollPairing();
+
+  if (failReason != NULL) {
+    sendFailed(failCode, failReason);
+    failReason = NULL;
+  }
+
+  WriterReport r;
+  while (xQueueReceive(reports, &r, 0) == pdTRUE) {
+    if (r.session != session || state == SESSION_IDLE)
+      continue;  // Cancelled session
+    acked = r.flashed;
+    if (r.op == BLE_MAINT_OP_FAILED) {
+      endSession();
+      sendFailed(r.code, r.reason);
+      continue;
+    }
+    if (r.op == BLE_MAINT_OP_DONE) {
+      endSession();
+      updates++;
+      BleMaintStatus status = {};
+      status.op = BLE_MAINT_OP_DONE;
+      status.code = r.code;
+      status.offset = acked;
+      sendStatus(status, 0);
+      LOG_INFO(TAG, "✅ BLE update: %lu bytes verified - restarting", (unsigned long)acked);
+      continue;
+    }
+    if (state == SESSION_STARTING)
+      state = SESSION_STREAMING;
+    if (state == SESSION_STREAMING)
+      sendAck();  // Window moves
+  }
+
+  if (nackPending && state == SESSION_STREAMING) {
+    nackPending = false;
+    BleMaintStatus status = {};
+    status.op = BLE_MAINT_OP_NACK;
+    status.offset = received;
+    sendStatus(status, 0);
+  }
+
+  if (state == SESSION_STREAMING && millis() - lastChunkMs >= OTA_STALE_MS) {
+    submit(JOB_CANCEL, 0, 0);
+    endSession();
+    sendFailed(408, "no data - update abandoned");
+  }
+}
+
+bool bleMaintTakeSettings(uint8_t fields, BleMaintSettings *out)
+{
+  portENTER_CRITICAL(&settingsLock);
+  uint8_t taken = pendingFields & fields;
+  *out = pendingSettings;
+  pendingFields &= ~taken;
+  portEXIT_CRITICAL(&settingsLock);
+  out->fields = taken;
+  return taken != 0;
+}
+
+void bleMaintDump(Print &out)
+{
+  static const char *const STATE_NAMES[] = {"idle", "starting", "streaming", "finishing"};
+  if (writerTask == NULL) {
+    out.println("[BLE maint] not started (no broadcast service / writer task)");
+    return;
+  }
+  out.printf("[BLE maint] %s, client %s, chunk %u bytes, window %u bytes\n", STATE_NAMES[state],
+             clientAddress.length() ? clientAddress.c_str() : "none", (unsigned)chunkBytes,
+             (unsigned)(2 * BLE_MAINT_BUFFER_BYTES));
+  if (state != SESSION_IDLE)
+    out.printf("  update: %lu of %lu bytes received, %lu on flash\n", (unsigned long)received,
+               (unsigned long)total, (unsigned long)acked);
+  out.printf("  %u of %u bonds, pairing %s, %lu untrusted writes refused\n", (unsigned)bondCount(),
+             (unsigned)BLE_MAINT_BONDS, pairOpen ? "open" : "closed", (unsigned long)untrustedWrites);
+  out.printf("  %lu updates, %lu NACKs (%lu window stalls), %lu settings writes\n", (unsigned long)updates,
+             (unsigned long)nacks, (unsigned long)windowStalls, (unsigned long)settingsWrites);
+}
+
+static void cmdBlePair(ConsoleArgs &args)
+{
+  if (args.source != CONSOLE_SERIAL) {
+    args.out.println("[BLE maint] Bonding is opened over USB serial only - it needs hands on the unit");
+    return;
+  }
+  if (args.is(1, "forget")) {
+    forgetRequested = true;
+    args.out.println("[BLE maint] Dropping every bond - centrals pair again after 'blepair'");
+    return;
+  }
+  pairRequested = true;
+  args.out.printf("[BLE maint] Pairing open for %lus - bond the maintenance client now\n",
+                  (unsigned long)(BLE_MAINT_PAIR_WINDOW_MS / 1000));
+}
+
+static ConsoleCommand blePairCommand("blepair", "[forget]", "Let one BLE maintenance client bond (USB serial) / drop every bond", cmdBlePair);
+
+#endif // GS_BLE_MAINT
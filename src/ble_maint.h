@@ -0,0 +1,166 @@
+#ifndef BLE_MAINT_H
+#define BLE_MAINT_H
+
+// =============================================================================
+// BLE Maintenance Channel (firmware updates and settings without Wi-Fi)
+// =============================================================================
+// Production builds have no Wi-Fi, so POST /ota (ota_update.h) is not there.
+// This GATT service sits next to the weight broadcast (same advertisement,
+// same local stack) and carries the same update images plus the settings
+// a shop changes remotely:
+//
+//   control   47530101  write / notify   commands in, status records out
+//   data      47530102  write w/o resp   [offset:u32][bytes] image chunks
+//   settings  47530103  read / write     BleMaintSettings
+//
+// Update flow - the radio sets the pace, not per-chunk round trips:
+//   1. Client: 'B' total:u32 on control. Device: 'A' ack 0, window, chunk.
+//   2. Client streams data chunks (write without response, several per
+//      connection event) up to ack + window, without waiting.
+//   3. Each BLE_MAINT_BUFFER_BYTES the filled buffer goes to the OtaWriter
+//      task, which runs it through the OTA pipeline (inflate, delta, flash
+//      write + sector erase) while the other buffer fills. The ack, and so
+//      the window, moves when a buffer is on flash.
+//   4. Client: 'E'. Device: 'D' (verified, restarting) or 'F' code + reason.
+// A chunk that is not at the expected offset (a dropped write, or beyond
+// the window) is discarded and answered once with 'N' expected - the
+// client resumes from there. 'X' cancels.
+//
+// Chunks are as large as the negotiated MTU allows (ATT MTU - 3 - 4 offset
+// bytes, at most BLE_MAINT_CHUNK_MAX); ArduinoBLE accepts the client's MTU
+// up to what the controller buffers. The 'A' record after 'B' carries the
+// usable chunk size.
+//
+// Settings: a read returns the live values. A write carries a field mask;
+// valid fields are applied between shots - goal and brightness by the UI
+// task (through the slider handlers, so labels and NVS follow), offset and
+// profile by the shot control task. The offset replaces the learned history
+// of that goal (offsetModelSet()).
+//
+// Security: the unit switches a pump relay, so nothing here is open to
+// whichever central is in range. All three characteristics carry
+// BLEEncryption - ArduinoBLE answers an unencrypted read or write with
+// "insufficient encryption" - and every handler checks the link again
+// before it acts. A link is only encrypted with a bonded central (its LTK
+// is in NVS "blebonds") or with one pairing inside the window "blepair"
+// opens; that command is taken over USB serial only, so bonding needs hands
+// on the unit. "blepair forget" drops every bond. Images must also carry
+// the release signature (GS_OTA_SIGNED, ota_update.h) before the boot slot
+// switches.
+//
+// GS_BLE_MAINT (compile-time, -DGS_BLE_MAINT=1 to build it in, default 0):
+// needs GS_WEIGHT_BROADCAST (its advertising makes the controller
+// connectable) and GS_OTA_SIGNED.
+//
+// Thread Safety:
+//   bleMaintBegin() / bleMaintPoll() - BLE task (the only HCI host); the
+//   bond callbacks run inside BLE.poll() there too. "blepair" only raises
+//   flags the next bleMaintPoll() acts on. bleMaintSetConsumers() - setup.
+//   bleMaintTakeSettings() - UI and shot control task (lock-protected).
+//   bleMaintDump() - any task (plain fields).
+// =============================================================================
+
+#include <Arduino.h>
+#include "weight_broadcast.h"
+#include "ota_update.h"
+
+#ifndef GS_BLE_MAINT
+#define GS_BLE_MAINT 0   // 1 = offer the service (bonded, encrypted links; signed images)
+#endif
+static_assert(GS_BLE_MAINT == 0 || GS_BLE_MAINT == 1, "GS_BLE_MAINT must be 0 or 1");
+static_assert(!GS_BLE_MAINT || GS_WEIGHT_BROADCAST, "GS_BLE_MAINT needs GS_WEIGHT_BROADCAST (connectable advertising)");
+static_assert(!GS_BLE_MAINT || GS_OTA_SIGNED, "GS_BLE_MAINT takes firmware from any central in range - only with GS_OTA_SIGNED");
+
+constexpr const char *BLE_MAINT_SERVICE_UUID  = "47530100-7773-4a2f-8e1b-3f5a9c2d6e10";
+constexpr const char *BLE_MAINT_CONTROL_UUID  = "47530101-7773-4a2f-8e1b-3f5a9c2d6e10";
+constexpr const char *BLE_MAINT_DATA_UUID     = "47530102-7773-4a2f-8e1b-3f5a9c2d6e10";
+constexpr const char *BLE_MAINT_SETTINGS_UUID = "47530103-7773-4a2f-8e1b-3f5a9c2d6e10";
+constexpr size_t   BLE_MAINT_BUFFER_BYTES = 8192;   // Flash writer buffer, two of them = the window
+constexpr size_t   BLE_MAINT_CHUNK_MAX    = 508;    // 512 byte ATT value - 4 offset bytes
+constexpr uint8_t  BLE_MAINT_SETTINGS_VERSION = 1;
+constexpr uint8_t  BLE_MAINT_BONDS        = 4;      // Centrals kept in NVS "blebonds"
+constexpr uint32_t BLE_MAINT_PAIR_WINDOW_MS = 60000; // "blepair": pairing accepted this long, once
+
+// Status record types (control notifications) and commands (control writes)
+enum BleMaintOp : uint8_t {
+  BLE_MAINT_OP_BEGIN  = 'B',   // Command: total:u32
+  BLE_MAINT_OP_END    = 'E',   // Command: every byte sent
+  BLE_MAINT_OP_CANCEL = 'X',   // Command
+  BLE_MAINT_OP_ACK    = 'A',   // Status: offset on flash, window, chunk
+  BLE_MAINT_OP_NACK   = 'N',   // Status: resend from offset
+  BLE_MAINT_OP_DONE   = 'D',   // Status: verified, restarting
+  BLE_MAINT_OP_FAILED = 'F',   // Status: code (HTTP-style) + reason text
+};
+
+struct __attribute__((packed)) BleMaintStatus {
+  uint8_t op;           // BleMaintOp
+  uint8_t reserved;
+  uint16_t code;        // FAILED: 400 / 409 / 500 as POST /ota would answer
+  uint32_t offset;      // ACK / NACK
+  uint16_t window;      // ACK: bytes the client may have in flight past offset
+  uint16_t chunk;       // ACK: payload bytes per data write
+  char reason[52];      // FAILED: NUL-terminated (cut to the MTU)
+};
+
+// BleMaintSettings::fields
+constexpr uint8_t BLE_MAINT_SET_GOAL       = 0x01;
+constexpr uint8_t BLE_MAINT_SET_OFFSET     = 0x02;
+constexpr uint8_t BLE_MAINT_SET_BRIGHTNESS = 0x04;
+constexpr uint8_t BLE_MAINT_SET_PROFILE    = 0x08;
+constexpr uint8_t BLE_MAINT_SET_ALL        = 0x0F;
+
+struct __attribute__((packed)) BleMaintSettings {
+  uint8_t version;        // BLE_MAINT_SETTINGS_VERSION
+  uint8_t fields;         // Write: BLE_MAINT_SET_* to apply; read: all
+  uint16_t goalDg;        // Target weight, 0.1 g (the slider moves in 1 g)
+  int16_t offsetCg;       // Stop offset of that goal, 0.01 g
+  uint8_t brightnessPct;
+  uint8_t profile;        // Shot profile index (shot_profile.h)
+};
+
+static_assert(sizeof(BleMaintSettings) == 8, "BleMaintSettings is part of the GATT interface");
+
+#if GS_BLE_MAINT
+
+/**
+ * @brief Add the service and start the flash writer task
+ * @param bleTask Woken with `bleEvent` when the writer has a status to send
+ * @note BLE task, before weightBroadcastBegin() (services before advertising)
+ */
+void bleMaintBegin(TaskHandle_t bleTask, uint32_t bleEvent);
+
+/**
+ * @brief Tasks that apply written settings: `uiTask` by xTaskNotifyGive(),
+ *        `controlTask` by xTaskNotify(controlBit)
+ */
+void bleMaintSetConsumers(TaskHandle_t uiTask, TaskHandle_t controlTask, uint32_t controlBit);
+
+/**
+ * @brief Send writer status, resync requests, refresh the readable settings; once per BLE task pass
+ * @param current Live values for the settings characteristic
+ */
+void bleMaintPoll(const BleMaintSettings &current);
+
+/**
+ * @brief Take the pending written settings among `fields`
+ * @param out Whole record; out->fields says which of `fields` were written
+ * @return false if none of them are pending
+ */
+bool bleMaintTakeSettings(uint8_t fields, BleMaintSettings *out);
+
+/**
+ * @brief Client, bonds and pairing window, update progress, window / NACK counters
+ */
+void bleMaintDump(Print &out);
+
+#else
+
+inline void bleMaintBegin(TaskHandle_t, uint32_t) {}
+inline void bleMaintSetConsumers(TaskHandle_t, TaskHandle_t, uint32_t) {}
+inline void bleMaintPoll(const BleMaintSettings &) {}
+inline bool bleMaintTakeSettings(uint8_t, BleMaintSettings *) { return false; }
+inline void bleMaintDump(Print &out) { out.println("[BLE maint] off (GS_BLE_MAINT=0)"); }
+
+#endif // GS_BLE_MAINT
+
+#endif // BLE_MAINT_H
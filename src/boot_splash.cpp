@@ -0,0 +1,110 @@
+// =============================================================================
+// Boot Splash Implementation
+// =============================================================================
+
+#include "boot_splash.h"
+#include "debug_config.h"
+#include "display_power.h"
+#include "display_transport.h"
+#include "pins_config.h"
+#include <ui.h>
+
+static constexpr LogTag TAG = LOG_TAG_UI;
+
+static constexpr uint16_t BAND_ROWS = BOOT_SPLASH_BAR_H;  // One band holds the whole bar
+static constexpr uint16_t BAR_X = (UI_HOR_RES - BOOT_SPLASH_BAR_W) / 2;
+static constexpr uint16_t ICON_Y = 40;
+
+static_assert(BAND_ROWS % 2 == 0, "Bands must keep the panel's column granularity");
+static_assert(BOOT_SPLASH_BAR_Y % BAND_ROWS == 0, "The bar is one background band");
+static_assert(UI_VER_RES % 2 == 0, "The last band must keep it too");
+
+static lv_color_t *band = NULL;   // UI_HOR_RES x BAND_ROWS, internal RAM while the splash is up
+static uint8_t shownPct = 0;
+
+static lv_color_t background() { return lv_color_hex(0x15171A); }  // Dark theme screen (lv_theme_default)
+static lv_color_t barTrack() { return lv_color_hex(0x3C3C3C); }     // Button grey of the main screen
+static lv_color_t barFill() { return lv_color_hex(0x747474); }      // Slider indicator grey
+
+// Icon pixels, NULL without them (GS_UI_ASSETS=2 stand-ins). TRUE_COLOR_ALPHA: colour then alpha per pixel.
+static const uint8_t *iconPixels(const lv_img_dsc_t &img)
+{
+  if (img.header.cf != LV_IMG_CF_TRUE_COLOR_ALPHA || img.data == NULL ||
+      img.data_size < (uint32_t)img.header.w * img.header.h * LV_IMG_PX_SIZE_ALPHA_BYTE)
+    return NULL;
+  return img.data;
+}
+
+// Rows y0 .. y0 + rows - 1 of the splash into the band, then onto the glass
+static void drawBand(uint16_t y0)
+{
+  const uint16_t rows = (UI_VER_RES - y0 < BAND_ROWS) ? UI_VER_RES - y0 : BAND_ROWS;
+  const lv_color_t bg = background();
+  for (uint32_t i = 0; i < (uint32_t)UI_HOR_RES * rows; i++)
+    band[i] = bg;
+
+  const lv_img_dsc_t &icon = ui_img_coffee_png;
+  const uint8_t *px = iconPixels(icon);
+  uint16_t iconX = (UI_HOR_RES - icon.header.w) / 2;
+  for (uint16_t r = 0; r < rows && px != NULL; r++) {
+    int y = y0 + r - ICON_Y;
+    if (y < 0 || y >= (int)icon.header.h)
+      continue;
+    const uint8_t *src = px + (uint32_t)y * icon.header.w * LV_IMG_PX_SIZE_ALPHA_BYTE;
+    lv_color_t *dst = band + (uint32_t)r * UI_HOR_RES + iconX;
+    for (uint16_t x = 0; x < icon.header.w; x++, src += LV_IMG_PX_SIZE_ALPHA_BYTE) {
+      lv_color_t fg;
+      memcpy(&fg, src, sizeof(fg));
+      dst[x] = lv_color_mix(fg, bg, src[LV_IMG_PX_SIZE_ALPHA_BYTE - 1]);
+    }
+  }
+
+  if (y0 == BOOT_SPLASH_BAR_Y) {
+    uint16_t filled = (uint16_t)((uint32_t)BOOT_SPLASH_BAR_W * shownPct / 100);
+    for (uint16_t r = 0; r < BAND_ROWS; r++) {
+      lv_color_t *row = band + (uint32_t)r * UI_HOR_RES + BAR_X;
+      for (uint16_t x = 0; x < BOOT_SPLASH_BAR_W; x++)
+        row[x] = (x < filled) ? barFill() : barTrack();
+    }
+  }
+
+  lv_area_t area = {0, (lv_coord_t)y0, UI_HOR_RES - 1, (lv_coord_t)(y0 + rows - 1)};
+  displayTransport().blit(&area, band);
+}
+
+bool bootSplashBegin(uint8_t brightnessPct)
+{
+#if GS_BOOT_SPLASH
+  if (displayTransport().blit == NULL)
+    return false;
+  band = (lv_color_t *)heap_caps_malloc(sizeof(lv_color_t) * UI_HOR_RES * BAND_ROWS, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+  if (band == NULL) {
+    LOG_WARN(TAG, "⚠️  No RAM for the splash band - dark until the first frame");
+    return false;
+  }
+
+  uint32_t startUs = micros();
+  for (uint16_t y = 0; y < UI_VER_RES; y += BAND_ROWS)
+    drawBand(y);
+  displayPowerBacklightOn(brightnessPct);  // On a finished splash - no garbage
+  LOG_INFO(TAG, "🖼️  Boot splash on the panel in %luus", (unsigned long)(micros() - startUs));
+  return true;
+#else
+  (void)brightnessPct;
+  return false;
+#endif
+}
+
+void bootSplashProgress(uint8_t pct)
+{
+  if (band == NULL || pct <= shownPct)
+    return;
+  shownPct = pct > 100 ? 100 : pct;
+  drawBand(BOOT_SPLASH_BAR_Y);
+}
+
+void bootSplashEnd()
+{
+  free(band);
+  band = NULL;
+}
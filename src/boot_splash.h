@@ -0,0 +1,63 @@
+#ifndef BOOT_SPLASH_H
+#define BOOT_SPLASH_H
+
+// =============================================================================
+// Boot Splash (panel lit before LVGL exists)
+// =============================================================================
+// Between the panel coming up and the first LVGL frame, setup() still builds
+// LVGL, the draw buffers and both SquareLine screens. The splash fills that
+// gap. It is drawn right after the panel init, straight through the
+// transport's blit() in full-width bands:
+//
+//   background   the dark theme's screen colour, so the first frame does
+//                not flash on top of it
+//   icon         the coffee cup from the SquareLine images (flash), blended
+//                onto the background once
+//   progress     a bar under the icon; bootSplashProgress() redraws only its
+//                band (640 x BOOT_SPLASH_BAR_H), no LVGL
+//
+// The backlight comes on with the splash instead of after the first frame.
+// bootSplashEnd() frees the band buffer once the first LVGL frame has
+// covered the splash (LVGL's first refresh is the whole screen).
+//
+// Bands span the whole landscape width: the panel ignores RASET, so every
+// window covers all native rows (AXS15231B.h, LCD_ROW_FULL_SPAN). Builds whose
+// icons live in the "assets" partition (GS_UI_ASSETS=2) have no pixels for
+// the icon in the image and show the bar only.
+//
+// GS_BOOT_SPLASH (compile-time, -DGS_BOOT_SPLASH=0):
+//   1 - splash and backlight right after the panel init (default)
+//   0 - dark panel until the first LVGL frame
+//
+// Thread Safety:
+//   setup() only, before the UI task owns the display.
+// =============================================================================
+
+#include <Arduino.h>
+
+#ifndef GS_BOOT_SPLASH
+#define GS_BOOT_SPLASH 1
+#endif
+
+constexpr uint16_t BOOT_SPLASH_BAR_W = 320;
+constexpr uint16_t BOOT_SPLASH_BAR_H = 8;    // Even: the panel's window granularity
+constexpr uint16_t BOOT_SPLASH_BAR_Y = 128;  // On a band boundary
+
+/**
+ * @brief Draw the splash and switch the backlight on
+ * @param brightnessPct Backlight level (settings)
+ * @return false if there was nothing to draw with (no blit, no band buffer)
+ */
+bool bootSplashBegin(uint8_t brightnessPct);
+
+/**
+ * @brief Advance the progress bar (0-100 %, never backwards)
+ */
+void bootSplashProgress(uint8_t pct);
+
+/**
+ * @brief The first LVGL frame is on the panel: release the band buffer
+ */
+void bootSplashEnd();
+
+#endif // BOOT_SPLASH_H
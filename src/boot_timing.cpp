@@ -0,0 +1,49 @@
+// =============================================================================
+// Boot Stages and Milestones Implementation
+// =============================================================================
+
+#include "boot_timing.h"
+#include "debug_config.h"
+#include "metrics.h"
+
+static constexpr LogTag TAG = LOG_TAG_SYSTEM;
+
+static MetricGauge bleTaskGauge("boot_ble_task_ms", "BLE task started, ms since reset");
+static MetricGauge firstFrameGauge("boot_first_frame_ms", "First frame on the panel, ms since reset");
+static MetricGauge setupGauge("boot_setup_ms", "setup() finished, ms since reset");
+static MetricGauge firstWeightGauge("boot_first_weight_ms", "First scale weight sample, ms since reset");
+
+static MetricGauge *const gauges[BOOT_MILESTONE_COUNT] = {&bleTaskGauge, &firstFrameGauge, &setupGauge,
+                                                          &firstWeightGauge};
+static const char *const names[BOOT_MILESTONE_COUNT] = {"BLE task", "first frame", "setup done", "first weight"};
+static volatile uint32_t reachedMs[BOOT_MILESTONE_COUNT] = {};
+
+void bootMark(BootMilestone milestone)
+{
+  if (milestone >= BOOT_MILESTONE_COUNT || reachedMs[milestone] != 0)
+    return;
+  uint32_t now = millis();
+  if (now == 0)
+    now = 1;  // 0 means "not reached"
+  reachedMs[milestone] = now;
+  gauges[milestone]->set((int32_t)now);
+  LOG_INFO(TAG, "⏱️  BOOT: %s @ %lums", names[milestone], (unsigned long)now);
+}
+
+uint32_t bootMilestoneMs(BootMilestone milestone)
+{
+  return (milestone < BOOT_MILESTONE_COUNT) ? reachedMs[milestone] : 0;
+}
+
+void bootTimingDump(Print &out)
+{
+  char line[48];
+  out.print("Boot milestones (ms since reset):\n");
+  for (uint8_t i = 0; i < BOOT_MILESTONE_COUNT; i++) {
+    if (reachedMs[i] != 0)
+      snprintf(line, sizeof(line), "  %-13s %6lu\n", names[i], (unsigned long)reachedMs[i]);
+    else
+      snprintf(line, sizeof(line), "  %-13s not yet\n", names[i]);
+    out.print(line);
+  }
+}
@@ -0,0 +1,70 @@
+#ifndef BOOT_TIMING_H
+#define BOOT_TIMING_H
+
+// =============================================================================
+// Boot Stages and Milestones
+// =============================================================================
+// setup() runs in stages, scale side first:
+//
+//   1. Core     NVS, serial, log ring, BLE.begin(), settings, relay
+//   2. Scale    shot buffers + BLE task: scanning and connecting run on
+//               core 0 from here on, in parallel with the stages below
+//   3. Display  touch reset, panel, splash + backlight (boot_splash.h),
+//               LVGL, first frame
+//   4. UI       UI task takes over LVGL
+//
+// Connecting to the scale takes seconds and the display stack about one, so
+// the two overlap instead of adding up. The milestones record what the user
+// actually waits for, in ms since reset (millis()):
+//
+//   boot_ble_task_ms      BLE task running - scan started
+//   boot_first_frame_ms   last area of the first LVGL refresh sent to the panel
+//   boot_setup_ms         setup() finished
+//   boot_first_weight_ms  first weight sample from the scale
+//
+// Each is recorded once, logged, and exported as a gauge ("metrics",
+// /metrics); bootTimingDump() prints all of them.
+//
+// GS_BOOT_DIAG (compile-time, -DGS_BOOT_DIAG=1, debug environment): keep the
+// bring-up diagnostics in setup() - USB CDC reconnect waits, touch controller
+// banner, display test pattern (+2 s hold) and widget tree validation. (Touch
+// I2C speed probes run only when the stored clock fails: touch_clock.h.)
+// Production builds (0) skip them; the backlight then comes on after the
+// first frame instead of before the test pattern.
+//
+// Thread Safety:
+//   bootMark() may be called from any task; each milestone has one writer
+//   (setup / UI task on core 1, BLE task on core 0) and a repeated mark is
+//   a single load.
+// =============================================================================
+
+#include <Arduino.h>
+
+#ifndef GS_BOOT_DIAG
+#define GS_BOOT_DIAG 0
+#endif
+
+enum BootMilestone : uint8_t {
+  BOOT_BLE_TASK = 0,
+  BOOT_FIRST_FRAME,
+  BOOT_SETUP_DONE,
+  BOOT_FIRST_WEIGHT,
+  BOOT_MILESTONE_COUNT
+};
+
+/**
+ * @brief Record `milestone` at the current millis() (first call only)
+ */
+void bootMark(BootMilestone milestone);
+
+/**
+ * @brief ms since reset at `milestone`, 0 if not reached yet
+ */
+uint32_t bootMilestoneMs(BootMilestone milestone);
+
+/**
+ * @brief Print every milestone ("not yet" for those still pending)
+ */
+void bootTimingDump(Print &out);
+
+#endif // BOOT_TIMING_H
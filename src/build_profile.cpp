@@ -0,0 +1,108 @@
+// =============================================================================
+// Build Profile Implementation
+// =============================================================================
+
+#include "build_profile.h"
+#include "debug_config.h"
+#include "console.h"
+#include "metrics.h"
+#include "boot_timing.h"
+#include "trace.h"
+#include "alloc_trace.h"
+#include "display_diag.h"
+#include "iram_placement.h"
+
+static constexpr LogTag TAG = LOG_TAG_SYSTEM;
+
+// Hot-path histograms in the speed summary (metrics.h names)
+static const char *const SPEED_METRICS[] = {
+  "control_sample_lag_us",   // Packet arrival → control task
+  "control_pass_us",         // Control task pass
+  "lcd_flush_cb_us",         // flush_cb
+  "lcd_dma_window_us",       // Display window on the wire
+  "shot_start_relay_ms",     // Start press → relay
+  "ui_intent_latency_ms",    // Touch release → command
+};
+
+static const char *const LEVEL_NAMES[] = {"none", "error", "warn", "info", "debug", "verbose"};
+
+static const char *optimisation()
+{
+#if defined(GS_BUILD_OPT)
+  return GS_BUILD_OPT;
+#elif defined(__OPTIMIZE_SIZE__)
+  return "-Os";
+#elif defined(__OPTIMIZE__)
+  return "-O2";
+#else
+  return "-O0";
+#endif
+}
+
+static void flagsLine(char *line, size_t size)
+{
+  snprintf(line, size, "%s%s, logs <= %s, trace %s, alloc trace %s, display diag %d, IRAM hot paths %s",
+           optimisation(), GS_BUILD_LTO ? " + LTO" : "", LEVEL_NAMES[GS_LOG_MAX_LEVEL < 5 ? GS_LOG_MAX_LEVEL : 5],
+           GS_TRACE ? "on" : "off", GS_ALLOC_TRACE ? "on" : "off", GS_DISPLAY_DIAG, GS_IRAM_HOT ? "on" : "off");
+}
+
+static const MetricHistogram *findHistogram(const char *name)
+{
+  for (Metric *m = metricsFirst(); m != NULL; m = m->next) {
+    if (m->type == METRIC_HISTOGRAM && strcmp(m->name, name) == 0)
+      return static_cast<const MetricHistogram *>(m);
+  }
+  return NULL;
+}
+
+void buildProfileDump(Print &out)
+{
+  char line[112];
+  flagsLine(line, sizeof(line));
+  out.printf("Build: %s (%s)\n", GS_BUILD_PROFILE, line);
+  out.printf("  built %s %s, SDK %s\n", __DATE__, __TIME__, ESP.getSdkVersion());
+
+  uint32_t sketch = ESP.getSketchSize();
+  uint32_t slot = sketch + ESP.getFreeSketchSpace();
+  out.print("Size:\n");
+  out.printf("  app image      %7lu of %lu bytes (%lu%%)\n", (unsigned long)sketch, (unsigned long)slot,
+             slot ? (unsigned long)((uint64_t)sketch * 100 / slot) : 0UL);
+  out.printf("  internal heap  %7lu free, %lu min, %lu largest\n",
+             (unsigned long)heap_caps_get_free_size(MALLOC_CAP_INTERNAL),
+             (unsigned long)heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL),
+             (unsigned long)heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL));
+  out.printf("  PSRAM          %7lu free of %lu\n", (unsigned long)ESP.getFreePsram(),
+             (unsigned long)ESP.getPsramSize());
+
+  out.printf("Speed (CPU %lu MHz):\n", (unsigned long)getCpuFrequencyMhz());
+  out.printf("  boot           first frame %lu ms, setup %lu ms, first weight %lu ms\n",
+             (unsigned long)bootMilestoneMs(BOOT_FIRST_FRAME), (unsigned long)bootMilestoneMs(BOOT_SETUP_DONE),
+             (unsigned long)bootMilestoneMs(BOOT_FIRST_WEIGHT));
+  out.printf("  %-23s %7s %7s %7s %7s\n", "", "n", "p50<=", "p99<=", "max");
+  for (const char *name : SPEED_METRICS) {
+    const MetricHistogram *h = findHistogram(name);
+    if (h == NULL)
+      continue;
+    HistogramSnapshot snap;
+    h->snapshot(&snap);
+    if (snap.count == 0) {
+      out.printf("  %-23s %7s\n", name, "-");
+      continue;
+    }
+    out.printf("  %-23s %7lu %7lu %7lu %7lu\n", name, (unsigned long)snap.count,
+               (unsigned long)h->percentile(snap, 0.50f), (unsigned long)h->percentile(snap, 0.99f),
+               (unsigned long)snap.max);
+  }
+}
+
+void buildProfileLog()
+{
+  char line[112];
+  flagsLine(line, sizeof(line));
+  LOG_INFO(TAG, "🏷️  Build %s: %s", GS_BUILD_PROFILE, line);
+  LOG_INFO(TAG, "📦 App %u of %u bytes, heap %u free of %u, PSRAM %u free of %u", ESP.getSketchSize(),
+           ESP.getSketchSize() + ESP.getFreeSketchSpace(), ESP.getFreeHeap(), ESP.getHeapSize(), ESP.getFreePsram(),
+           ESP.getPsramSize());
+}
+
+static ConsoleCommand buildCommand("build", "Build profile, image / heap size, boot and hot-path latencies", buildProfileDump);
@@ -0,0 +1,56 @@
+#ifndef BUILD_PROFILE_H
+#define BUILD_PROFILE_H
+
+// =============================================================================
+// Build Profile - what this image was built with, what it costs, how fast it runs
+// =============================================================================
+// platformio.ini builds the same firmware in several profiles:
+//
+//   gravimetric_shots          production defaults (-Os, DEBUG logging)
+//   gravimetric_shots_release  -O2 + LTO, logs compiled out below WARN
+//                              (GS_LOG_MAX_LEVEL=2), display diagnostics off
+//   gravimetric_shots_profile  -O2 + LTO, INFO logging, trace hooks on
+//                              (GS_TRACE=1), allocation tracing
+//                              (GS_ALLOC_TRACE=1), for measuring
+//   gravimetric_shots_debug    Wi-Fi + WebSerial, full diagnostics
+//
+// tools/build_profile/build_profile.py applies the optimisation options and
+// prints the size summary after each link (internal RAM, flash, app slot
+// use, change since the previous build of the environment). At run time
+// buildProfileDump() ("build" command; logged at the end of setup() where
+// INFO is compiled in) prints the flags it sees, the image and heap sizes,
+// and the speed summary: boot milestones and the hot-path latency
+// histograms from metrics.h.
+//
+// GS_BUILD_PROFILE (compile-time string, -DGS_BUILD_PROFILE=\"release\"):
+//   name shown in the summary; "production" when not set.
+// GS_BUILD_LTO: set to 1 by build_profile.py when it enables -flto.
+// GS_BUILD_OPT: the -O flag build_profile.py applied ("-O2"); without it
+//   the summary derives -Os / -O2 from the compiler's predefines.
+//
+// Thread Safety:
+//   buildProfileDump() reads metrics snapshots and boot milestones (both
+//   safe from any task); console or setup() only, as it prints a lot.
+// =============================================================================
+
+#include <Arduino.h>
+
+#ifndef GS_BUILD_PROFILE
+#define GS_BUILD_PROFILE "production"
+#endif
+
+#ifndef GS_BUILD_LTO
+#define GS_BUILD_LTO 0
+#endif
+
+/**
+ * @brief Flags, sizes and speed summary of the running image
+ */
+void buildProfileDump(Print &out);
+
+/**
+ * @brief Build profile and image / heap sizes at INFO (end of setup())
+ */
+void buildProfileLog();
+
+#endif // BUILD_PROFILE_H
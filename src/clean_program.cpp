@@ -0,0 +1,429 @@
+// =============================================================================
+// Cleaning Programs Implementation
+// =============================================================================
+
+#include "clean_program.h"
+#include "console.h"
+#include "debug_config.h"
+#include "metrics.h"
+#include "relay_control.h"
+#include "settings_store.h"
+#include "shot_state.h"
+#include "esp_timer.h"
+
+static constexpr LogTag TAG = LOG_TAG_RELAY;
+
+static const char *const PROGRAM_NAMES[CLEAN_PROGRAM_COUNT] = {"flush", "backflush"};
+static constexpr int64_t US_PER_S = 1000000;
+static constexpr int64_t REMIND_US = (int64_t)CLEAN_BACKFLUSH_REMIND_H * 3600 * US_PER_S;
+
+static MetricCounter cleanRuns("clean_programs_total", "Flush / backflush programs started");
+static MetricCounter cleanPulses("clean_pulses_total", "Pump pulses of cleaning programs");
+static MetricCounter cleanCancels("clean_cancels_total", "Cleaning programs stopped before their end");
+
+static portMUX_TYPE cleanMux = portMUX_INITIALIZER_UNLOCKED;
+static esp_timer_handle_t edgeTimer = NULL;
+static CleanProgram programs[CLEAN_PROGRAM_COUNT] = {
+  {1, CLEAN_FLUSH_DEFAULT_S, 0},
+  {CLEAN_BACKFLUSH_DEFAULT_PULSES, CLEAN_BACKFLUSH_DEFAULT_ON_S, CLEAN_BACKFLUSH_DEFAULT_OFF_S},
+};
+
+// Running program (under cleanMux)
+static bool running = false;
+static CleanProgramId runningId = CLEAN_FLUSH;
+static CleanProgram active = {};
+static int64_t startUs = 0;
+static uint8_t pulse = 0;          // 0-based
+static bool pumpOn = false;
+static bool endPending = false;    // Ended or stopped, that line not shown yet
+static bool endStopped = false;
+static CleanProgramId endedId = CLEAN_FLUSH;
+
+// Status line (UI task)
+static int32_t shownKey = -1;
+
+// Reminder (under cleanMux)
+static int16_t remindEvery = CLEAN_BACKFLUSH_DEFAULT_EVERY;
+static int16_t shotsSince = 0;
+static int64_t lastBackflushUs = 0;
+static bool reminded = false;
+
+static int64_t pulseOnUs(uint8_t n)
+{
+  return startUs + (int64_t)n * (active.onS + active.offS) * US_PER_S;
+}
+
+static int64_t pulseOffUs(uint8_t n)
+{
+  return pulseOnUs(n) + (int64_t)active.onS * US_PER_S;
+}
+
+// One relay edge: on edges switch the pump and schedule its cut, off edges arm the next pulse
+static void edgeCallback(void *)
+{
+  int64_t now = esp_timer_get_time();
+  int64_t nextUs = 0;
+  bool turnOn = false;
+  bool finished = false;
+  CleanProgramId id;
+
+  portENTER_CRITICAL(&cleanMux);
+  if (!running) {
+    portEXIT_CRITICAL(&cleanMux);
+    return;
+  }
+  id = runningId;
+  if (!pumpOn) {
+    pumpOn = true;
+    turnOn = true;
+    nextUs = pulseOffUs(pulse);
+  } else {
+    pumpOn = false;
+    if (pulse + 1 >= active.pulses) {
+      running = false;
+      finished = true;
+      endPending = true;
+      endStopped = false;
+      endedId = id;
+      if (id == CLEAN_BACKFLUSH) {
+        shotsSince = 0;
+        lastBackflushUs = now;
+        reminded = false;
+      }
+    } else {
+      pulse++;
+      nextUs = pulseOnUs(pulse);
+    }
+  }
+  portEXIT_CRITICAL(&cleanMux);
+
+  if (turnOn) {
+    relayControlSet(false);  // Clears the previous pulse's cut latch; the pin is already low
+    relayControlSet(true);
+    relayControlScheduleOff(nextUs);
+    cleanPulses.add();
+  } else {
+    relayControlSet(false);  // Cut at nextUs by relay_control already; this only confirms it
+  }
+
+  if (!cleanProgramRunning() && !finished) {
+    relayControlSet(false);  // Stopped while this edge ran
+    return;
+  }
+  if (finished) {
+    shotStateSet(SHOT_STATE_FLUSHING, false);
+    if (id == CLEAN_BACKFLUSH)
+      settingsSetShotsSinceBackflush(0);
+    LOG_INFO(TAG, "🧽 %s finished", PROGRAM_NAMES[id]);
+    return;
+  }
+
+  int64_t delayUs = nextUs - now;
+  esp_timer_start_once(edgeTimer, delayUs > 0 ? (uint64_t)delayUs : 0);
+}
+
+static uint16_t orDefault(int16_t value, uint16_t fallback)
+{
+  return value > 0 ? (uint16_t)value : fallback;
+}
+
+void cleanProgramBegin()
+{
+  Settings s = settingsGet();
+  programs[CLEAN_FLUSH].onS = orDefault(s.flushS, CLEAN_FLUSH_DEFAULT_S);
+  programs[CLEAN_BACKFLUSH].pulses = (uint8_t)orDefault(s.backflushPulses, CLEAN_BACKFLUSH_DEFAULT_PULSES);
+  programs[CLEAN_BACKFLUSH].onS = orDefault(s.backflushOnS, CLEAN_BACKFLUSH_DEFAULT_ON_S);
+  programs[CLEAN_BACKFLUSH].offS = orDefault(s.backflushOffS, CLEAN_BACKFLUSH_DEFAULT_OFF_S);
+  remindEvery = s.backflushEvery != 0 ? s.backflushEvery : CLEAN_BACKFLUSH_DEFAULT_EVERY;
+  shotsSince = s.shotsSinceBackflush > 0 ? s.shotsSinceBackflush : 0;
+  lastBackflushUs = esp_timer_get_time();
+
+  if (edgeTimer == NULL) {
+    esp_timer_create_args_t args = {};
+    args.callback = edgeCallback;
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.name = "clean_edge";
+    if (esp_timer_create(&args, &edgeTimer) != ESP_OK) {
+      edgeTimer = NULL;
+      LOG_ERROR(TAG, "❌ Cleaning edge timer unavailable - flush / backflush disabled");
+    }
+  }
+}
+
+bool cleanProgramStart(CleanProgramId id)
+{
+  if (id >= CLEAN_PROGRAM_COUNT || edgeTimer == NULL)
+    return false;
+  if (shotStateTest(SHOT_STATE_BREWING) || shotStateTest(SHOT_STATE_SEQUENCE))
+    return false;
+
+  portENTER_CRITICAL(&cleanMux);
+  if (running) {
+    portEXIT_CRITICAL(&cleanMux);
+    return false;
+  }
+  running = true;
+  runningId = id;
+  active = programs[id];
+  startUs = esp_timer_get_time();
+  pulse = 0;
+  pumpOn = false;
+  endPending = false;
+  portEXIT_CRITICAL(&cleanMux);
+
+  shownKey = -1;
+  shotStateSet(SHOT_STATE_FLUSHING, true);  // Before the pump: the control task leaves the relay to us
+  cleanRuns.add();
+  LOG_INFO(TAG, "🧽 %s: %u x %us on / %us off", PROGRAM_NAMES[id], (unsigned)active.pulses, (unsigned)active.onS,
+           (unsigned)active.offS);
+  edgeCallback(NULL);  // First on edge now, in the caller
+  return true;
+}
+
+bool cleanProgramStop()
+{
+  portENTER_CRITICAL(&cleanMux);
+  bool was = running;
+  if (was) {
+    endPending = true;
+    endStopped = true;
+    endedId = runningId;
+  }
+  running = false;
+  pumpOn = false;
+  portEXIT_CRITICAL(&cleanMux);
+  if (!was)
+    return false;
+
+  if (edgeTimer != NULL)
+    esp_timer_stop(edgeTimer);  // Not running is fine
+  relayControlSet(false);
+  shotStateSet(SHOT_STATE_FLUSHING, false);
+  cleanCancels.add();
+  LOG_INFO(TAG, "🧽 Cleaning program stopped");
+  return true;
+}
+
+bool cleanProgramRunning()
+{
+  portENTER_CRITICAL(&cleanMux);
+  bool r = running;
+  portEXIT_CRITICAL(&cleanMux);
+  return r;
+}
+
+bool cleanProgramRelayOn()
+{
+  portENTER_CRITICAL(&cleanMux);
+  bool on = running && pumpOn;
+  portEXIT_CRITICAL(&cleanMux);
+  return on;
+}
+
+bool cleanProgramConfigure(CleanProgramId id, const CleanProgram &program)
+{
+  if (id >= CLEAN_PROGRAM_COUNT || program.pulses == 0 || program.pulses > CLEAN_MAX_PULSES ||
+      program.onS == 0 || program.onS > CLEAN_MAX_PHASE_S || program.offS > CLEAN_MAX_PHASE_S)
+    return false;
+  if (id == CLEAN_FLUSH && program.pulses != 1)
+    return false;
+
+  portENTER_CRITICAL(&cleanMux);
+  programs[id] = program;  // A running program keeps its copy
+  portEXIT_CRITICAL(&cleanMux);
+
+  if (id == CLEAN_FLUSH)
+    settingsSetFlush(program.onS);
+  else
+    settingsSetBackflush(program.pulses, program.onS, program.offS);
+  return true;
+}
+
+CleanProgram cleanProgramGet(CleanProgramId id)
+{
+  portENTER_CRITICAL(&cleanMux);
+  CleanProgram p = programs[id < CLEAN_PROGRAM_COUNT ? id : CLEAN_FLUSH];
+  portEXIT_CRITICAL(&cleanMux);
+  return p;
+}
+
+// Snapshot of the running phase: seconds left in it (floor), and whether anything runs
+struct PhaseView {
+  bool running;
+  bool ended;
+  bool stopped;
+  CleanProgramId id;
+  uint8_t pulse;
+  uint8_t pulses;
+  bool pumpOn;
+  int64_t leftUs;
+};
+
+static PhaseView phaseView()
+{
+  PhaseView v;
+  int64_t now = esp_timer_get_time();
+  portENTER_CRITICAL(&cleanMux);
+  v.running = running;
+  v.ended = endPending;
+  v.stopped = endStopped;
+  v.id = running ? runningId : endedId;
+  v.pulse = pulse;
+  v.pulses = active.pulses;
+  v.pumpOn = pumpOn;
+  v.leftUs = running ? (pumpOn ? pulseOffUs(pulse) : pulseOnUs(pulse)) - now : 0;
+  portEXIT_CRITICAL(&cleanMux);
+  return v;
+}
+
+bool cleanProgramStatus(char *buf, size_t len)
+{
+  PhaseView v = phaseView();
+  if (v.ended) {
+    portENTER_CRITICAL(&cleanMux);
+    endPending = false;
+    portEXIT_CRITICAL(&cleanMux);
+    shownKey = -1;
+    if (v.id == CLEAN_FLUSH)
+      snprintf(buf, len, "%s", v.stopped ? "Flushing stopped" : "Flushing ended");
+    else
+      snprintf(buf, len, "%s", v.stopped ? "Backflush stopped" : "Backflush done");
+    return true;
+  }
+  if (!v.running)
+    return false;
+
+  uint32_t leftS = v.leftUs > 0 ? (uint32_t)(v.leftUs / US_PER_S) : 0;
+  int32_t key = (int32_t)((v.pulse << 17) | (v.pumpOn ? 1 << 16 : 0) | (leftS & 0xFFFF));
+  if (key == shownKey)
+    return false;
+  shownKey = key;
+
+  if (v.id == CLEAN_FLUSH)
+    snprintf(buf, len, "Flushing... %lu seconds remaining", (unsigned long)leftS);
+  else
+    snprintf(buf, len, "Backflush %u/%u - %s %lu s", (unsigned)(v.pulse + 1), (unsigned)v.pulses,
+             v.pumpOn ? "pump on" : "rest", (unsigned long)leftS);
+  return true;
+}
+
+uint32_t cleanProgramStatusDueMs()
+{
+  PhaseView v = phaseView();
+  if (v.ended)
+    return 0;
+  if (!v.running)
+    return UINT32_MAX;
+  if (v.leftUs <= 0)
+    return 1;  // Edge due, the esp_timer task is about to run it
+  return (uint32_t)((v.leftUs % US_PER_S) / 1000) + 1;
+}
+
+void cleanProgramSetReminder(int16_t everyShots)
+{
+  portENTER_CRITICAL(&cleanMux);
+  remindEvery = everyShots;
+  reminded = false;
+  portEXIT_CRITICAL(&cleanMux);
+  settingsSetBackflushEvery(everyShots);
+}
+
+void cleanProgramNoteShot()
+{
+  portENTER_CRITICAL(&cleanMux);
+  if (shotsSince < INT16_MAX)
+    shotsSince++;
+  reminded = false;  // Remind after every shot while due
+  int16_t shots = shotsSince;
+  portEXIT_CRITICAL(&cleanMux);
+  settingsSetShotsSinceBackflush(shots);
+}
+
+bool cleanProgramTakeReminder(char *buf, size_t len)
+{
+  int64_t now = esp_timer_get_time();
+  portENTER_CRITICAL(&cleanMux);
+  bool byShots = remindEvery > 0 && shotsSince >= remindEvery;
+  bool byTime = remindEvery > 0 && now - lastBackflushUs >= REMIND_US;
+  bool take = (byShots || byTime) && !reminded && !running;
+  if (take)
+    reminded = true;
+  int16_t shots = shotsSince;
+  portEXIT_CRITICAL(&cleanMux);
+
+  if (!take)
+    return false;
+  if (byShots)
+    snprintf(buf, len, "Backflush due - %d shots since the last", (int)shots);
+  else
+    snprintf(buf, len, "Backflush due - %lu h since the last", (unsigned long)CLEAN_BACKFLUSH_REMIND_H);
+  return true;
+}
+
+void cleanProgramDump(Print &out)
+{
+  CleanProgram flush = cleanProgramGet(CLEAN_FLUSH);
+  CleanProgram back = cleanProgramGet(CLEAN_BACKFLUSH);
+  PhaseView v = phaseView();
+  portENTER_CRITICAL(&cleanMux);
+  int16_t every = remindEvery;
+  int16_t shots = shotsSince;
+  int64_t sinceUs = esp_timer_get_time() - lastBackflushUs;
+  portEXIT_CRITICAL(&cleanMux);
+
+  out.printf("[Clean] flush %us; backflush %u x %us on / %us off\n", (unsigned)flush.onS, (unsigned)back.pulses,
+             (unsigned)back.onS, (unsigned)back.offS);
+  if (v.running)
+    out.printf("  running: %s pulse %u/%u, %s, %.1f s left in the phase\n", PROGRAM_NAMES[v.id],
+               (unsigned)(v.pulse + 1), (unsigned)v.pulses, v.pumpOn ? "pump on" : "rest",
+               (float)v.leftUs / (float)US_PER_S);
+  else
+    out.println("  idle");
+  if (every > 0)
+    out.printf("  backflush reminder every %d shots / %lu h: %d shots, %.1f h since the last\n", (int)every,
+               (unsigned long)CLEAN_BACKFLUSH_REMIND_H, (int)shots, (float)sinceUs / (3600.0f * US_PER_S));
+  else
+    out.printf("  backflush reminder off, %d shots since the last\n", (int)shots);
+  out.printf("  %lu programs, %lu pulses, %lu stopped early\n", (unsigned long)cleanRuns.value(),
+             (unsigned long)cleanPulses.value(), (unsigned long)cleanCancels.value());
+}
+
+static const char *const CLEAN_USAGE =
+  "Usage: clean [flush|backflush|stop] | clean set flush <on_s> | clean set backflush <pulses> <on_s> <off_s> | "
+  "clean remind <shots|off>";
+
+static void cmdClean(ConsoleArgs &args)
+{
+  long a = 0, b = 0, c = 0;
+  if (args.argc == 2 && (args.is(1, "flush") || args.is(1, "backflush"))) {
+    CleanProgramId id = args.is(1, "flush") ? CLEAN_FLUSH : CLEAN_BACKFLUSH;
+    if (!cleanProgramStart(id))
+      args.out.println("Not started: brewing, starting a shot or already cleaning");
+  } else if (args.argc == 2 && args.is(1, "stop")) {
+    if (!cleanProgramStop())
+      args.out.println("Nothing running");
+  } else if (args.argc == 4 && args.is(1, "set") && args.is(2, "flush") && args.number(3, &a)) {
+    CleanProgram p = {1, (uint16_t)constrain(a, 0L, 65535L), 0};
+    if (!cleanProgramConfigure(CLEAN_FLUSH, p))
+      args.out.printf("Flush: 1-%u s\n", (unsigned)CLEAN_MAX_PHASE_S);
+  } else if (args.argc == 6 && args.is(1, "set") && args.is(2, "backflush") && args.number(3, &a) &&
+             args.number(4, &b) && args.number(5, &c)) {
+    CleanProgram p = {(uint8_t)constrain(a, 0L, 255L), (uint16_t)constrain(b, 0L, 65535L),
+                      (uint16_t)constrain(c, 0L, 65535L)};
+    if (!cleanProgramConfigure(CLEAN_BACKFLUSH, p))
+      args.out.printf("Backflush: 1-%u pulses, 1-%u s on, 0-%u s off\n", (unsigned)CLEAN_MAX_PULSES,
+                      (unsigned)CLEAN_MAX_PHASE_S, (unsigned)CLEAN_MAX_PHASE_S);
+  } else if (args.argc == 3 && args.is(1, "remind") && (args.is(2, "off") || args.number(2, &a))) {
+    if (args.is(2, "off") || a <= 0)
+      cleanProgramSetReminder(-1);
+    else
+      cleanProgramSetReminder((int16_t)constrain(a, 1L, 1000L));
+  } else if (args.argc != 1) {
+    args.out.println(CLEAN_USAGE);
+    return;
+  }
+  cleanProgramDump(args.out);
+}
+
+static ConsoleCommand cleanCommand("clean", "[flush|backflush|stop|set ...|remind ...]",
+                                   "Flush / backflush programs and the backflush reminder", cmdClean);
@@ -0,0 +1,125 @@
+#ifndef CLEAN_PROGRAM_H
+#define CLEAN_PROGRAM_H
+
+// =============================================================================
+// Cleaning Programs: flush and backflush pulses on timer-driven relay edges
+// =============================================================================
+// The flush was one fixed 5 s relay-on that the UI task polled every 10 ms
+// until it ended, updating the status line once a second on the way. A
+// cleaning program is now a pulse train:
+//
+//   pulse 1 on ──► off ──► pulse 2 on ──► off ... pulse N on ──► done
+//   |<-- onS -->|<-offS->|
+//
+//   - CLEAN_FLUSH is one pulse of flushS (5 s by default), CLEAN_BACKFLUSH
+//     N pulses with rests in between (blind basket / detergent cycle). Both
+//     are set with the "clean" console command and persisted in the
+//     settings blob.
+//   - Every edge is an esp_timer one-shot at an absolute time from the
+//     program start, so nothing drifts. The on edge switches the relay and
+//     schedules its cut with relayControlScheduleOff() (relay_control.h);
+//     the off edge only confirms it and arms the next pulse. No task loop
+//     is involved, and while a program runs the control task leaves the
+//     relay to it (SHOT_STATE_FLUSHING).
+//   - The UI task formats the status line once a second, or at an edge.
+//     cleanProgramStatusDueMs() says when, so the UI task sleeps as usual
+//     instead of polling at relay resolution. The text goes out through
+//     the status line scheduler (STATUS_FLUSH, alert priority): scale
+//     messages wait until the program has ended.
+//
+// Backflush reminder: there is no wall clock, so "daily" is counted in use.
+// A backflush is due after backflushEvery shots (20 by default, -1 = never)
+// or after 24 h powered on since the last one. The shot count is
+// persisted; the 24 h counts since the last backflush or boot.
+//
+// Thread Safety:
+//   cleanProgramStart() / cleanProgramStop() / cleanProgramNoteShot() and
+//   the getters - any task (state under a spinlock). Edges run in the
+//   esp_timer task. cleanProgramStatus() - one caller (the UI task).
+// =============================================================================
+
+#include <Arduino.h>
+
+constexpr uint16_t CLEAN_FLUSH_DEFAULT_S           = 5;
+constexpr uint8_t  CLEAN_BACKFLUSH_DEFAULT_PULSES  = 5;
+constexpr uint16_t CLEAN_BACKFLUSH_DEFAULT_ON_S    = 10;
+constexpr uint16_t CLEAN_BACKFLUSH_DEFAULT_OFF_S   = 10;
+constexpr int16_t  CLEAN_BACKFLUSH_DEFAULT_EVERY   = 20;    // Shots
+constexpr uint32_t CLEAN_BACKFLUSH_REMIND_H        = 24;    // Powered on without a backflush
+constexpr uint8_t  CLEAN_MAX_PULSES                = 20;
+constexpr uint16_t CLEAN_MAX_PHASE_S               = 60;
+
+enum CleanProgramId : uint8_t {
+  CLEAN_FLUSH,
+  CLEAN_BACKFLUSH,
+  CLEAN_PROGRAM_COUNT
+};
+
+struct CleanProgram {
+  uint8_t pulses;
+  uint16_t onS;
+  uint16_t offS;    // Rest after each pulse but the last
+};
+
+/**
+ * @brief Programs and reminder from the settings blob (setup, after settingsStoreBegin())
+ */
+void cleanProgramBegin();
+
+/**
+ * @brief Run a program from the first pulse; refused while brewing or a start sequence runs
+ * @return false if refused (or a program already runs)
+ */
+bool cleanProgramStart(CleanProgramId id);
+
+/**
+ * @brief Cancel a running program: relay off, SHOT_STATE_FLUSHING cleared
+ * @return true if one was running
+ */
+bool cleanProgramStop();
+
+bool cleanProgramRunning();
+
+/**
+ * @brief True while a pulse of the running program has the pump on
+ */
+bool cleanProgramRelayOn();
+
+/**
+ * @brief Change a program (range-checked) and persist it
+ */
+bool cleanProgramConfigure(CleanProgramId id, const CleanProgram &program);
+CleanProgram cleanProgramGet(CleanProgramId id);
+
+/**
+ * @brief Status text when it has changed: running phase and countdown, or the end
+ * @return true if `buf` holds a new line for STATUS_FLUSH
+ */
+bool cleanProgramStatus(char *buf, size_t len);
+
+/**
+ * @brief ms until cleanProgramStatus() has a new line (UINT32_MAX when idle)
+ */
+uint32_t cleanProgramStatusDueMs();
+
+/**
+ * @brief Shots between backflush reminders (-1 = never), persisted
+ */
+void cleanProgramSetReminder(int16_t everyShots);
+
+/**
+ * @brief Count a finished shot toward the backflush reminder
+ */
+void cleanProgramNoteShot();
+
+/**
+ * @brief True once each time the reminder becomes due (shot count or 24 h)
+ */
+bool cleanProgramTakeReminder(char *buf, size_t len);
+
+/**
+ * @brief Programs, state and reminder (the "clean" console command)
+ */
+void cleanProgramDump(Print &out);
+
+#endif // CLEAN_PROGRAM_H
@@ -0,0 +1,154 @@
+#ifndef COMMAND_SCRIPT_H
+#define COMMAND_SCRIPT_H
+
+// =============================================================================
+// Command Scripts: scale command sequences as step tables, one runner per task
+// =============================================================================
+// The shot start used to be a switch over sequencer states, each state with
+// its own copy of the failure cleanup, and processBLECommand() starting
+// sequences by writing those states directly. A sequence is now a table:
+//
+//   static const CommandStep SHOT_START_STEPS[] = {
+//     { "send",    stepSendBatch, 0,   SCRIPT_FAIL, "Scale tare failed" },
+//     { "confirm", stepConfirm,   300, SCRIPT_NEXT, NULL },
+//     { "arm",     stepArm,       0,   SCRIPT_FAIL, NULL },
+//   };
+//   static const CommandScript SHOT_START = { "shot start", SHOT_START_STEPS, 3, onFail, NULL };
+//
+// A step function sends, awaits or both. It returns
+//
+//   SCRIPT_NEXT  step done, the following one runs on the same pass
+//   SCRIPT_WAIT  not yet (an ack or notification outstanding) - called again
+//                on the next pass; the task wakes on the notification itself
+//   SCRIPT_FAIL  give up: the script's one failure handler runs with the step
+//   SCRIPT_DONE  finish early (skips the remaining steps)
+//
+// A step that still waits `timeoutMs` after it began gets the step's
+// `onTimeout` instead (SCRIPT_NEXT: carry on without the ack, SCRIPT_FAIL:
+// fail). dueInMs() gives the time to that deadline, so the task sleeps until
+// the ack or the timeout - whichever comes first - rather than for a fixed
+// delay. Waits belong to one step at a time; commands that can overlap go out
+// together from one step and are awaited by the next.
+//
+// Scripts and their steps are const tables (flash); the runner holds a
+// pointer, the step index and the step's start time.
+//
+// Thread Safety:
+//   A CommandScriptRunner belongs to the task that polls it. Other tasks
+//   request a script through that task (request slot + notification), they
+//   do not call start().
+// =============================================================================
+
+#include <Arduino.h>
+
+enum CommandStepResult : uint8_t {
+  SCRIPT_NEXT,
+  SCRIPT_WAIT,
+  SCRIPT_FAIL,
+  SCRIPT_DONE,
+};
+
+/**
+ * @param stepMs ms since the step began (0 on its first call)
+ */
+typedef CommandStepResult (*CommandStepFn)(uint32_t stepMs);
+
+struct CommandStep {
+  const char *name;
+  CommandStepFn fn;
+  uint32_t timeoutMs;           // 0 = waits as long as it takes
+  CommandStepResult onTimeout;  // SCRIPT_NEXT or SCRIPT_FAIL
+  const char *failStatus;       // For the failure handler (status line), may be NULL
+};
+
+struct CommandScript {
+  const char *name;
+  const CommandStep *steps;
+  uint8_t count;
+  void (*onFail)(const CommandScript &script, const CommandStep &step);  // The one cleanup path
+  void (*onDone)(const CommandScript &script);                           // May be NULL
+};
+
+class CommandScriptRunner {
+public:
+  /**
+   * @brief Begin `script` at its first step (replaces one that is running)
+   * @note The first step runs on the next poll(), not here
+   */
+  void start(const CommandScript *script, uint32_t nowMs)
+  {
+    current = script;
+    index = 0;
+    stepStartMs = nowMs;
+    pending = true;
+  }
+
+  /**
+   * @brief Drop the running script without its failure handler
+   */
+  void cancel() { current = NULL; }
+
+  bool running() const { return current != NULL; }
+  const CommandScript *script() const { return current; }
+
+  /**
+   * @brief Run steps until one waits, the script fails or it ends
+   */
+  void poll(uint32_t nowMs)
+  {
+    pending = false;
+    while (current != NULL) {
+      const CommandScript *script = current;
+      const CommandStep &step = script->steps[index];
+      uint32_t stepMs = nowMs - stepStartMs;
+      CommandStepResult result = step.fn(stepMs);
+      if (current != script)
+        return;  // The step started another script (or cancelled this one)
+      if (result == SCRIPT_WAIT) {
+        if (step.timeoutMs == 0 || stepMs < step.timeoutMs)
+          return;
+        result = step.onTimeout;
+      }
+
+      if (result == SCRIPT_FAIL) {
+        current = NULL;
+        script->onFail(*script, step);
+        return;
+      }
+      if (result == SCRIPT_DONE || index + 1u >= script->count) {
+        current = NULL;
+        if (script->onDone != NULL)
+          script->onDone(*script);
+        return;
+      }
+      index++;
+      stepStartMs = nowMs;
+    }
+  }
+
+  /**
+   * @brief ms until poll() has something to do: 0 for a step that has not
+   *        run yet, the timeout left for a waiting one, UINT32_MAX when idle
+   *        or the step waits without a timeout
+   */
+  uint32_t dueInMs(uint32_t nowMs) const
+  {
+    if (current == NULL)
+      return UINT32_MAX;
+    if (pending)
+      return 0;
+    const CommandStep &step = current->steps[index];
+    if (step.timeoutMs == 0)
+      return UINT32_MAX;
+    uint32_t stepMs = nowMs - stepStartMs;
+    return stepMs < step.timeoutMs ? step.timeoutMs - stepMs : 0;
+  }
+
+private:
+  const CommandScript *current = NULL;
+  uint8_t index = 0;
+  uint32_t stepStartMs = 0;
+  bool pending = false;  // Started, first step not run yet
+};
+
+#endif // COMMAND_SCRIPT_H
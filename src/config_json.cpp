@@ -0,0 +1,590 @@
+// =============================================================================
+// Profile + Settings Import / Export Implementation
+// =============================================================================
+
+#include "config_json.h"
+#include "json_stream.h"
+#include "console.h"
+#include "debug_config.h"
+#include "metrics.h"
+#include "settings_store.h"
+#include "stop_estimator.h"
+#include "cup_detect.h"
+#include "clean_program.h"
+#include "wifi_coex.h"
+#include <ESPAsyncWebServer.h>
+
+static constexpr LogTag TAG = LOG_TAG_SYSTEM;
+
+static const char *const STAGE_END_NAMES[] = {"time", "weight", "goal"};   // ShotStageEnd order
+static const char *const CUP_MODE_NAMES[]  = {"off", "tare", "auto"};      // CupMode order
+
+constexpr int16_t CONFIG_GOAL_MAX_G      = 80;   // Preset weight slider range
+constexpr float   CONFIG_FLOW_MAX_GS     = 25.5f;
+
+struct ConfigStaging {
+  ConfigImportSettings settings;
+  ShotProfile profiles[SHOT_PROFILE_SLOTS];
+  uint8_t profileMask;   // Bit per slot present in the document
+  int8_t active;         // -1 = not in the document
+};
+
+static MetricCounter importsTotal("config_imports_total", "Profile / settings documents applied");
+static MetricCounter importsRefused("config_imports_refused_total", "Profile / settings documents refused (invalid or busy)");
+
+// -----------------------------------------------------------------------------
+// Export
+// -----------------------------------------------------------------------------
+
+struct ConfigSnapshot {
+  Settings settings;
+  uint8_t active;
+  uint8_t count;
+  ShotProfile profiles[SHOT_PROFILE_SLOTS];
+};
+
+static void takeSnapshot(ConfigSnapshot *s)
+{
+  s->settings = settingsGet();
+  s->active = shotProfileActiveIndex();
+  s->count = shotProfileCount();
+  for (uint8_t i = 0; i < s->count && i < SHOT_PROFILE_SLOTS; i++)
+    s->profiles[i] = *shotProfile(i);
+}
+
+// Settings keep 0 for "default" (clean_program.h); the document carries the value in use
+static long orDefault(int16_t value, long fallback)
+{
+  return value != 0 ? value : fallback;
+}
+
+static void writeDocument(Print &out, const ConfigSnapshot &s)
+{
+  JsonWriter w(out);
+  w.beginObject();
+  w.number("version", CONFIG_JSON_VERSION);
+
+  w.beginObject("settings");
+  w.number("brightness", s.settings.brightnessPct);
+  w.number("goal", s.settings.goalWeightG);
+  w.string("cup_mode", CUP_MODE_NAMES[s.settings.cupMode < CUP_MODE_COUNT ? s.settings.cupMode : CUP_MODE_OFF]);
+  w.number("flush_s", orDefault(s.settings.flushS, CLEAN_FLUSH_DEFAULT_S));
+  w.number("backflush_pulses", orDefault(s.settings.backflushPulses, CLEAN_BACKFLUSH_DEFAULT_PULSES));
+  w.number("backflush_on_s", orDefault(s.settings.backflushOnS, CLEAN_BACKFLUSH_DEFAULT_ON_S));
+  w.number("backflush_off_s", orDefault(s.settings.backflushOffS, CLEAN_BACKFLUSH_DEFAULT_OFF_S));
+  w.number("backflush_every", orDefault(s.settings.backflushEvery, CLEAN_BACKFLUSH_DEFAULT_EVERY));
+  w.endObject();
+
+  w.number("active_profile", s.active);
+  w.beginArray("profiles");
+  for (uint8_t i = 0; i < s.count; i++) {
+    const ShotProfile &p = s.profiles[i];
+    w.beginObject();
+    w.number("slot", i);
+    w.string("name", p.name);
+    w.string("estimator", stopEstimatorName(p.estimator));
+    w.beginArray("stages");
+    for (uint8_t n = 0; n < p.stageCount; n++) {
+      const ShotStage &st = p.stages[n];
+      w.beginObject();
+      w.string("end", STAGE_END_NAMES[st.end <= STAGE_END_GOAL ? st.end : STAGE_END_TIME]);
+      w.number("limit", st.limit);
+      w.number("pulse_on_ms", st.pulseOnMs);
+      w.number("pulse_off_ms", st.pulseOffMs);
+      w.decimal("flow_gs", st.flowDgS / 10.0f, 1);
+      w.endObject();
+    }
+    w.endArray();
+    w.endObject();
+  }
+  w.endArray();
+  w.endObject();
+}
+
+// Counts what goes through, for the return value of configJsonExport()
+class CountingPrint : public Print {
+public:
+  explicit CountingPrint(Print &out) : out(out), bytes(0) {}
+  size_t write(uint8_t c) override { bytes++; return out.write(c); }
+  size_t write(const uint8_t *data, size_t size) override { bytes += size; return out.write(data, size); }
+  size_t bytes;
+
+private:
+  Print &out;
+};
+
+size_t configJsonExport(Print &out)
+{
+  ConfigSnapshot s;
+  takeSnapshot(&s);
+  CountingPrint counted(out);
+  writeDocument(counted, s);
+  return counted.bytes;
+}
+
+// -----------------------------------------------------------------------------
+// Import: validate each value, stage it
+// -----------------------------------------------------------------------------
+
+static int8_t nameIndex(const JsonValue &v, const char *const *names, uint8_t count)
+{
+  long n;
+  if (v.integer(&n))
+    return (n >= 0 && n < count) ? (int8_t)n : -1;
+  if (v.event != JSON_STRING)
+    return -1;
+  for (uint8_t i = 0; i < count; i++) {
+    if (strcmp(v.text, names[i]) == 0)
+      return (int8_t)i;
+  }
+  return -1;
+}
+
+class ConfigImport : public JsonHandler {
+public:
+  JsonReader reader;
+  ConfigStaging staged;
+  const char *why;
+
+  ConfigImport() : reader(*this), why(NULL) { clear(); }
+
+  void clear()
+  {
+    reader.reset();
+    memset(&staged, 0, sizeof(staged));
+    staged.active = -1;
+    staged.settings.backflushPulses = -1;
+    staged.settings.backflushOnS = -1;
+    staged.settings.backflushOffS = -1;
+    why = NULL;
+  }
+
+  bool onJson(const JsonValue &v) override
+  {
+    if (v.depth == 0)
+      return v.event == JSON_OBJECT_BEGIN || v.event == JSON_OBJECT_END || refuse("document is not an object");
+    if (v.depth == 1)
+      return root(v);
+    if (strcmp(reader.containerKey(1), "settings") == 0)
+      return v.depth == 2 ? setting(v) : true;
+    if (strcmp(reader.containerKey(1), "profiles") == 0)
+      return profileValue(v);
+    return true;   // Inside an unknown member
+  }
+
+private:
+  ShotProfile profile;
+  int8_t slot;
+
+  bool refuse(const char *reason)
+  {
+    why = reason;
+    return false;
+  }
+
+  bool root(const JsonValue &v)
+  {
+    long n;
+    if (strcmp(v.key, "version") == 0)
+      return (v.integer(&n) && n >= 1 && n <= CONFIG_JSON_VERSION) || refuse("unsupported version");
+    if (strcmp(v.key, "active_profile") == 0) {
+      if (!v.integer(&n) || n < 0 || n >= SHOT_PROFILE_SLOTS)
+        return refuse("active_profile out of range");
+      staged.active = (int8_t)n;
+      return true;
+    }
+    if (strcmp(v.key, "settings") == 0)
+      return v.event == JSON_OBJECT_BEGIN || v.event == JSON_OBJECT_END || refuse("settings must be an object");
+    if (strcmp(v.key, "profiles") == 0)
+      return v.event == JSON_ARRAY_BEGIN || v.event == JSON_ARRAY_END || refuse("profiles must be an array");
+    return true;
+  }
+
+  // One settings member: range-checked, then staged with its field bit
+  bool setting(const JsonValue &v)
+  {
+    ConfigImportSettings &s = staged.settings;
+    long n;
+    if (strcmp(v.key, "cup_mode") == 0) {
+      int8_t mode = nameIndex(v, CUP_MODE_NAMES, CUP_MODE_COUNT);
+      if (mode < 0)
+        return refuse("cup_mode: off, tare or auto");
+      s.cupMode = mode;
+      s.fields |= CONFIG_SET_CUP_MODE;
+      return true;
+    }
+    if (v.event == JSON_OBJECT_BEGIN || v.event == JSON_ARRAY_BEGIN)
+      return refuse("settings members are numbers or names");
+    bool number = v.integer(&n);
+
+    if (strcmp(v.key, "brightness") == 0) {
+      if (!number || n < 0 || n > 100)
+        return refuse("brightness: 0-100");
+      s.brightnessPct = (int16_t)n;
+      s.fields |= CONFIG_SET_BRIGHTNESS;
+    } else if (strcmp(v.key, "goal") == 0) {
+      if (!number || n < 1 || n > CONFIG_GOAL_MAX_G)
+        return refuse("goal: 1-80 g");
+      s.goalG = (int16_t)n;
+      s.fields |= CONFIG_SET_GOAL;
+    } else if (strcmp(v.key, "flush_s") == 0) {
+      if (!number || n < 1 || n > CLEAN_MAX_PHASE_S)
+        return refuse("flush_s: 1-60");
+      s.flushS = (int16_t)n;
+      s.fields |= CONFIG_SET_FLUSH;
+    } else if (strcmp(v.key, "backflush_pulses") == 0) {
+      if (!number || n < 1 || n > CLEAN_MAX_PULSES)
+        return refuse("backflush_pulses: 1-20");
+      s.backflushPulses = (int16_t)n;
+      s.fields |= CONFIG_SET_BACKFLUSH;
+    } else if (strcmp(v.key, "backflush_on_s") == 0) {
+      if (!number || n < 1 || n > CLEAN_MAX_PHASE_S)
+        return refuse("backflush_on_s: 1-60");
+      s.backflushOnS = (int16_t)n;
+      s.fields |= CONFIG_SET_BACKFLUSH;
+    } else if (strcmp(v.key, "backflush_off_s") == 0) {
+      if (!number || n < 0 || n > CLEAN_MAX_PHASE_S)
+        return refuse("backflush_off_s: 0-60");
+      s.backflushOffS = (int16_t)n;
+      s.fields |= CONFIG_SET_BACKFLUSH;
+    } else if (strcmp(v.key, "backflush_every") == 0) {
+      if (!number || n < -1 || n > 1000)
+        return refuse("backflush_every: -1 (never) to 1000 shots");
+      s.backflushEvery = (int16_t)n;
+      s.fields |= CONFIG_SET_REMINDER;
+    }
+    return true;
+  }
+
+  // Members of "profiles": [ {profile}, ... ], stages at depth 4 / 5
+  bool profileValue(const JsonValue &v)
+  {
+    if (v.depth == 2) {
+      if (v.event == JSON_OBJECT_BEGIN) {
+        memset(&profile, 0, sizeof(profile));
+        slot = v.index < SHOT_PROFILE_SLOTS ? (int8_t)v.index : -1;
+        return true;
+      }
+      if (v.event != JSON_OBJECT_END)
+        return refuse("profiles holds objects");
+      if (slot < 0)
+        return refuse("profile slot out of range");
+      if (profile.stageCount == 0)
+        return refuse("profile without stages");
+      if (profile.name[0] == '\0')
+        return refuse("profile without a name");
+      staged.profiles[slot] = profile;
+      staged.profileMask |= 1u << slot;
+      return true;
+    }
+
+    long n;
+    if (v.depth == 3) {
+      if (strcmp(v.key, "slot") == 0) {
+        if (!v.integer(&n) || n < 0 || n >= SHOT_PROFILE_SLOTS)
+          return refuse("slot out of range");
+        slot = (int8_t)n;
+      } else if (strcmp(v.key, "name") == 0) {
+        if (v.event != JSON_STRING || v.text[0] == '\0' || strlen(v.text) >= SHOT_PROFILE_NAME_LEN)
+          return refuse("name: 1-11 characters");
+        strncpy(profile.name, v.text, SHOT_PROFILE_NAME_LEN - 1);
+      } else if (strcmp(v.key, "estimator") == 0) {
+        uint8_t kind = STOP_ESTIMATOR_COUNT;
+        if (v.event == JSON_STRING)
+          kind = stopEstimatorParse(v.text);
+        else if (v.integer(&n) && n >= 0 && n < STOP_ESTIMATOR_COUNT)
+          kind = (uint8_t)n;
+        if (kind >= STOP_ESTIMATOR_COUNT)
+          return refuse("unknown estimator");
+        profile.estimator = kind;
+      } else if (strcmp(v.key, "stages") == 0) {
+        return v.event == JSON_ARRAY_BEGIN || v.event == JSON_ARRAY_END || refuse("stages must be an array");
+      }
+      return true;
+    }
+
+    if (strcmp(reader.containerKey(3), "stages") != 0)
+      return true;
+    if (v.depth == 4) {
+      if (v.event == JSON_OBJECT_END)
+        return true;
+      if (v.event != JSON_OBJECT_BEGIN)
+        return refuse("stages holds objects");
+      if (profile.stageCount >= SHOT_PROFILE_MAX_STAGES)
+        return refuse("too many stages (6 at most)");
+      profile.stageCount++;
+      return true;
+    }
+    if (v.depth != 5)
+      return true;
+
+    ShotStage &st = profile.stages[profile.stageCount - 1];
+    if (strcmp(v.key, "end") == 0) {
+      int8_t end = nameIndex(v, STAGE_END_NAMES, STAGE_END_GOAL + 1);
+      if (end < 0)
+        return refuse("end: time, weight or goal");
+      st.end = (uint8_t)end;
+    } else if (strcmp(v.key, "flow_gs") == 0) {
+      float gs;
+      if (!v.decimal(&gs) || gs < 0.0f || gs > CONFIG_FLOW_MAX_GS)
+        return refuse("flow_gs: 0-25.5");
+      st.flowDgS = (uint8_t)lroundf(gs * 10.0f);
+    } else {
+      uint16_t *field = strcmp(v.key, "limit") == 0 ? &st.limit
+                      : strcmp(v.key, "pulse_on_ms") == 0 ? &st.pulseOnMs
+                      : strcmp(v.key, "pulse_off_ms") == 0 ? &st.pulseOffMs : NULL;
+      if (field == NULL)
+        return true;
+      if (!v.integer(&n) || n < 0 || n > UINT16_MAX)
+        return refuse("stage limit / pulse: 0-65535");
+      *field = (uint16_t)n;
+    }
+    return true;
+  }
+};
+
+static ConfigImport import;
+static portMUX_TYPE importLock = portMUX_INITIALIZER_UNLOCKED;
+static bool importOpen = false;
+static bool serialImport = false;
+static const char *lastError = "";
+static uint32_t lastErrorOffset = 0;
+
+// Handed over, waiting for the UI / control task
+static ConfigImportSettings pendingSettings;
+static ShotProfile pendingProfiles[SHOT_PROFILE_SLOTS];
+static uint8_t pendingMask = 0;
+static int8_t pendingActive = -1;
+
+bool configImportBegin(const char *source)
+{
+  portENTER_CRITICAL(&importLock);
+  bool busy = importOpen || pendingSettings.fields != 0 || pendingMask != 0 || pendingActive >= 0;
+  if (!busy)
+    importOpen = true;
+  portEXIT_CRITICAL(&importLock);
+  if (busy) {
+    importsRefused.add();
+    lastError = "another import is open or not applied yet";
+    lastErrorOffset = 0;
+    return false;
+  }
+  import.clear();
+  LOG_INFO(TAG, "📥 Config import from %s", source);
+  return true;
+}
+
+static void refused()
+{
+  lastError = import.why != NULL ? import.why : import.reader.error() != NULL ? import.reader.error() : "invalid document";
+  lastErrorOffset = import.reader.offset();
+  importsRefused.add();
+  LOG_WARN(TAG, "⚠️  Config import refused at byte %lu: %s", (unsigned long)lastErrorOffset, lastError);
+  portENTER_CRITICAL(&importLock);
+  importOpen = false;
+  serialImport = false;
+  portEXIT_CRITICAL(&importLock);
+}
+
+bool configImportFeed(const char *data, size_t len)
+{
+  if (!importOpen)
+    return false;
+  if (import.reader.feed(data, len))
+    return true;
+  refused();
+  return false;
+}
+
+bool configImportFinish()
+{
+  if (!importOpen)
+    return false;
+  if (!import.reader.finish()) {
+    refused();
+    return false;
+  }
+  const ConfigStaging &s = import.staged;
+  portENTER_CRITICAL(&importLock);
+  pendingSettings = s.settings;
+  memcpy(pendingProfiles, s.profiles, sizeof(pendingProfiles));
+  pendingMask = s.profileMask;
+  pendingActive = s.active;
+  importOpen = false;
+  serialImport = false;
+  portEXIT_CRITICAL(&importLock);
+  importsTotal.add();
+  lastError = "";
+  LOG_INFO(TAG, "📥 Config import: settings 0x%02x, profiles 0x%02x, active %d (%lu bytes)",
+           (unsigned)s.settings.fields, (unsigned)s.profileMask, (int)s.active,
+           (unsigned long)import.reader.offset());
+  return true;
+}
+
+void configImportAbort(const char *source)
+{
+  portENTER_CRITICAL(&importLock);
+  bool open = importOpen && serialImport == (strcmp(source, "serial") == 0);
+  if (open) {
+    importOpen = false;
+    serialImport = false;
+  }
+  portEXIT_CRITICAL(&importLock);
+  if (open)
+    LOG_WARN(TAG, "⚠️  Config import from %s abandoned", source);
+}
+
+const char *configImportError(uint32_t *offset)
+{
+  if (offset != NULL)
+    *offset = lastErrorOffset;
+  return lastError;
+}
+
+bool configImportTakeSettings(ConfigImportSettings *out)
+{
+  portENTER_CRITICAL(&importLock);
+  *out = pendingSettings;
+  pendingSettings.fields = 0;
+  portEXIT_CRITICAL(&importLock);
+  return out->fields != 0;
+}
+
+uint8_t configImportApplyProfiles()
+{
+  ShotProfile profiles[SHOT_PROFILE_SLOTS];
+  portENTER_CRITICAL(&importLock);
+  uint8_t mask = pendingMask;
+  int8_t active = pendingActive;
+  if (mask != 0)
+    memcpy(profiles, pendingProfiles, sizeof(profiles));
+  pendingMask = 0;
+  pendingActive = -1;
+  portEXIT_CRITICAL(&importLock);
+
+  uint8_t stored = 0;
+  for (uint8_t i = 0; i < SHOT_PROFILE_SLOTS; i++) {
+    if ((mask & (1u << i)) && shotProfileStore(i, profiles[i]))
+      stored++;
+  }
+  if (active >= 0)
+    shotProfileSelect((uint8_t)active);
+  return stored;
+}
+
+// -----------------------------------------------------------------------------
+// Serial
+// -----------------------------------------------------------------------------
+
+bool configImportSerialLine(const char *line, Print &out)
+{
+  if (!serialImport)
+    return false;
+  if (!configImportFeed(line, strlen(line)) || !configImportFeed("\n", 1)) {
+    uint32_t offset;
+    const char *why = configImportError(&offset);
+    out.printf("[Config] Import refused at byte %lu: %s\n", (unsigned long)offset, why);
+    return true;
+  }
+  if (import.reader.complete()) {
+    if (configImportFinish())
+      out.println("[Config] Import complete - applied between shots");
+    else
+      out.printf("[Config] Import refused: %s\n", configImportError(NULL));
+  }
+  return true;
+}
+
+static void cmdConfig(ConsoleArgs &args)
+{
+  if (args.is(1, "import")) {
+    if (args.source != CONSOLE_SERIAL) {
+      args.out.println("[Config] Import over USB serial or POST /config.json");
+      return;
+    }
+    if (!configImportBegin("serial")) {
+      args.out.printf("[Config] Import refused: %s\n", configImportError(NULL));
+      return;
+    }
+    serialImport = true;
+    args.out.println("[Config] Paste the JSON document; the import ends with its closing brace");
+    return;
+  }
+  if (args.argc != 1) {
+    args.out.println("Usage: config [import]");
+    return;
+  }
+  configJsonExport(args.out);
+  args.out.println();
+}
+
+static ConsoleCommand configCommand("config", "[import]", "Profiles + settings as JSON, or import a document pasted after it", cmdConfig);
+
+// -----------------------------------------------------------------------------
+// HTTP
+// -----------------------------------------------------------------------------
+
+static ConfigSnapshot exportSnapshot;   // One export at a time, regenerated per chunk from this copy
+static bool exportActive = false;
+static uint32_t exportGeneration = 0;
+
+void configJsonRegister(AsyncWebServer &server)
+{
+  static bool httpImport = false;
+
+  server.on("/config.json", HTTP_GET, [](AsyncWebServerRequest *request) {
+    if (wifiCoexDeferRequest(request))
+      return;
+    if (exportActive) {
+      request->send(503, "text/plain", "Config export already running\n");
+      return;
+    }
+    takeSnapshot(&exportSnapshot);
+    exportActive = true;
+    uint32_t generation = ++exportGeneration;
+    request->onDisconnect([generation]() {
+      if (exportGeneration == generation)
+        exportActive = false;
+    });
+    request->send(request->beginChunkedResponse("application/json", [generation](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+      if (!exportActive || exportGeneration != generation)
+        return 0;
+      WindowPrint window(buffer, maxLen, index);
+      writeDocument(window, exportSnapshot);
+      if (window.used() == 0)
+        exportActive = false;
+      return window.used();
+    }));
+  });
+
+  server.on("/config.json", HTTP_POST,
+    [](AsyncWebServerRequest *request) {
+      char text[112];
+      if (!httpImport) {
+        const char *why = configImportError(NULL);
+        snprintf(text, sizeof(text), "Import refused: %s\n", why[0] != '\0' ? why : "send the document as the request body");
+        request->send(409, "text/plain", text);
+        return;
+      }
+      httpImport = false;
+      uint32_t offset;
+      const char *why = configImportError(&offset);
+      if (why[0] != '\0') {
+        snprintf(text, sizeof(text), "Import refused at byte %lu: %s\n", (unsigned long)offset, why);
+        request->send(400, "text/plain", text);
+        return;
+      }
+      request->send(200, "text/plain", "Import complete - applied between shots\n");
+    },
+    NULL,
+    [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+      if (index == 0) {
+        httpImport = configImportBegin("http");
+        request->onDisconnect([]() { configImportAbort("http"); });   // Body cut short: free the import
+      }
+      if (!httpImport || !configImportFeed((const char *)data, len))
+        return;
+      if (index + len >= total)
+        configImportFinish();
+    });
+}
@@ -0,0 +1,136 @@
+#ifndef CONFIG_JSON_H
+#define CONFIG_JSON_H
+
+// =============================================================================
+// Profile + Settings Import / Export as JSON (HTTP, serial)
+// =============================================================================
+// One document carries what a shop moves between units and the dashboard:
+//
+//   {"version":1,
+//    "settings":{"brightness":80,"goal":36,"cup_mode":"off","flush_s":5,
+//                "backflush_pulses":5,"backflush_on_s":10,"backflush_off_s":10,
+//                "backflush_every":20},
+//    "active_profile":0,
+//    "profiles":[{"slot":0,"name":"Classic","estimator":"linear",
+//                 "stages":[{"end":"goal","limit":0,"pulse_on_ms":1,
+//                            "pulse_off_ms":0,"flow_gs":0.0}]}, ...]}
+//
+// Export writes it with JsonWriter straight into the transport: the console
+// ("config"), or GET /config.json, regenerated per chunk through a
+// WindowPrint, so no copy of the document is ever held.
+//
+// Import streams it through JsonReader (json_stream.h) and validates every
+// value as it arrives - ranges, estimator / stage / cup mode names, stage
+// counts - so a bad document stops at the first bad value with its byte
+// offset. Accepted values go to a fixed staging area (every profile slot,
+// every settings field, ~250 bytes); nothing is applied until the document
+// is complete and valid, then all of it is handed over at once:
+//
+//   settings   UI task (configImportTakeSettings()): goal and brightness
+//              through the slider handlers like a touch, the rest through
+//              cup_detect.h / clean_program.h.
+//   profiles   shot control task, between shots (configImportApplyProfiles()).
+//
+// Members may be left out (only those present change; a profile replaces
+// the slot it names, "slot" defaulting to its array position) and unknown
+// members are skipped, so older and newer documents import. Offsets are
+// learned per shot (offset_model.h) and not part of the document.
+//
+// Transports: POST /config.json (body streamed chunk by chunk, 200 or 400
+// with the reason), or "config import" on USB serial followed by the
+// document pasted over any number of lines; the import ends with the
+// document's closing brace (a line that is not JSON ends it as refused).
+//
+// One import at a time; a second one is refused until the first is
+// complete, failed or taken.
+//
+// Thread Safety:
+//   Export - any task (reads settingsGet() and profile copies). Import
+//   feed - one transport at a time (async_tcp or log drain task), the
+//   hand-over under a spinlock. Take / apply - UI and shot control task.
+// =============================================================================
+
+#include <Arduino.h>
+#include "shot_profile.h"
+
+class AsyncWebServer;
+
+constexpr uint8_t CONFIG_JSON_VERSION = 1;
+
+// ConfigImportSettings::fields
+constexpr uint16_t CONFIG_SET_BRIGHTNESS = 0x01;
+constexpr uint16_t CONFIG_SET_GOAL       = 0x02;
+constexpr uint16_t CONFIG_SET_CUP_MODE   = 0x04;
+constexpr uint16_t CONFIG_SET_FLUSH      = 0x08;
+constexpr uint16_t CONFIG_SET_BACKFLUSH  = 0x10;   // Pulses, on and off (missing ones keep their value)
+constexpr uint16_t CONFIG_SET_REMINDER   = 0x20;
+
+struct ConfigImportSettings {
+  uint16_t fields;
+  int16_t brightnessPct;
+  int16_t goalG;
+  int16_t cupMode;
+  int16_t flushS;
+  int16_t backflushPulses;   // -1 = not in the document
+  int16_t backflushOnS;
+  int16_t backflushOffS;
+  int16_t backflushEvery;
+};
+
+/**
+ * @brief Write the document to `out`
+ * @return Bytes written
+ */
+size_t configJsonExport(Print &out);
+
+/**
+ * @brief Start an import from `source` ("http", "serial")
+ * @return false while another import is open
+ */
+bool configImportBegin(const char *source);
+
+/**
+ * @brief Next piece of the document
+ * @return false once the document was refused (see configImportError())
+ */
+bool configImportFeed(const char *data, size_t len);
+
+/**
+ * @brief End of input: hand a valid document to the tasks that apply it
+ * @return false if it was incomplete or invalid
+ */
+bool configImportFinish();
+
+/**
+ * @brief Drop an open import from `source` without applying it (connection lost)
+ */
+void configImportAbort(const char *source);
+
+/**
+ * @brief Reason and byte offset of the last refused import ("" if none)
+ */
+const char *configImportError(uint32_t *offset);
+
+/**
+ * @brief Feed a USB serial line to an open "config import"
+ * @return false when no serial import is open (the line is a command)
+ */
+bool configImportSerialLine(const char *line, Print &out);
+
+/**
+ * @brief Imported settings, once (UI task)
+ */
+bool configImportTakeSettings(ConfigImportSettings *out);
+
+/**
+ * @brief Store imported profiles and the active choice (shot control task, between shots)
+ * @return Profiles stored
+ */
+uint8_t configImportApplyProfiles();
+
+/**
+ * @brief Register GET / POST /config.json on `server`
+ */
+void configJsonRegister(AsyncWebServer &server);
+
+#endif // CONFIG_JSON_H
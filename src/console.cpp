@@ -0,0 +1,316 @@
+// =============================================================================
+// Command Console Implementation
+// =============================================================================
+
+#include "console.h"
+#include "debug_config.h"
+#include "esp_timer.h"
+
+static constexpr LogTag TAG = LOG_TAG_SYSTEM;
+
+static ConsoleCommand *registryHead = NULL;
+
+ConsoleCommand::ConsoleCommand(const char *name, const char *usage, const char *help, ConsoleHandler handler)
+  : name(name), usage(usage), help(help), handler(handler), dump(NULL), next(registryHead)
+{
+  registryHead = this;  // "help" sorts, so order does not matter
+}
+
+ConsoleCommand::ConsoleCommand(const char *name, const char *help, ConsoleDump dump)
+  : name(name), usage(""), help(help), handler(NULL), dump(dump), next(registryHead)
+{
+  registryHead = this;
+}
+
+bool ConsoleArgs::number(uint8_t i, long *value) const
+{
+  const char *text = arg(i);
+  char *end;
+  long v = strtol(text, &end, 10);
+  if (end == text || *end != '\0')
+    return false;
+  *value = v;
+  return true;
+}
+
+bool ConsoleArgs::decimal(uint8_t i, float *value) const
+{
+  const char *text = arg(i);
+  char *end;
+  float v = strtof(text, &end);
+  if (end == text || *end != '\0')
+    return false;
+  *value = v;
+  return true;
+}
+
+// Split `line` in place; -1 if it has more than CONSOLE_MAX_ARGS words
+static int tokenize(char *line, char **argv)
+{
+  int argc = 0;
+  char *p = line;
+  for (;;) {
+    while (*p == ' ' || *p == '\t')
+      p++;
+    if (*p == '\0')
+      return argc;
+    if (argc == CONSOLE_MAX_ARGS)
+      return -1;
+
+    char end = ' ';
+    if (*p == '"') {
+      end = '"';
+      p++;
+    }
+    argv[argc++] = p;
+    while (*p != '\0' && *p != end && !(end == ' ' && *p == '\t'))
+      p++;
+    if (*p != '\0')
+      *p++ = '\0';
+  }
+}
+
+static const ConsoleCommand *find(const char *name)
+{
+  for (const ConsoleCommand *c = registryHead; c != NULL; c = c->next) {
+    if (strcmp(c->name, name) == 0)
+      return c;
+  }
+  return NULL;
+}
+
+// Line copy without CR / LF; false if it does not fit
+static bool copyLine(char *dst, const char *line, size_t len)
+{
+  while (len > 0 && (line[len - 1] == '\r' || line[len - 1] == '\n'))
+    len--;
+  if (len >= CONSOLE_LINE_MAX)
+    return false;
+  memcpy(dst, line, len);
+  dst[len] = '\0';
+  return true;
+}
+
+static void printHelp(Print &out)
+{
+  out.println("Commands:");
+  const char *last = "";
+  for (;;) {
+    // Next name after `last` - a few dozen commands, no sort buffer needed
+    const ConsoleCommand *best = NULL;
+    for (const ConsoleCommand *c = registryHead; c != NULL; c = c->next) {
+      if (strcmp(c->name, last) > 0 && (best == NULL || strcmp(c->name, best->name) < 0))
+        best = c;
+    }
+    if (best == NULL)
+      return;
+    char left[64];
+    snprintf(left, sizeof(left), "%s%s%s", best->name, best->usage[0] ? " " : "", best->usage);
+    out.printf("  %-30s %s\n", left, best->help);
+    last = best->name;
+  }
+}
+
+// `out` may buffer; `stream` is where later output (render audit) goes
+static void execute(ConsoleSource source, const char *line, size_t len, Print &out, Print &stream)
+{
+  char buffer[CONSOLE_LINE_MAX];
+  if (!copyLine(buffer, line, len)) {
+    out.printf("Line too long (max %u characters)\n", (unsigned)(CONSOLE_LINE_MAX - 1));
+    return;
+  }
+
+  ConsoleArgs args = {source, out, stream, 0, {}};
+  int argc = tokenize(buffer, args.argv);
+  if (argc < 0) {
+    out.printf("Too many words (max %u)\n", (unsigned)CONSOLE_MAX_ARGS);
+    return;
+  }
+  if (argc == 0)
+    return;
+  args.argc = (uint8_t)argc;
+
+  if (args.is(0, "help")) {
+    printHelp(out);
+    return;
+  }
+  const ConsoleCommand *command = find(args.argv[0]);
+  if (command == NULL) {
+    out.printf("Unknown command '%s' - 'help' lists them\n", args.argv[0]);
+    return;
+  }
+  if (command->handler != NULL)
+    command->handler(args);
+  else
+    command->dump(out);
+}
+
+void consoleExecute(ConsoleSource source, const char *line, size_t len, Print &out)
+{
+  execute(source, line, len, out, out);
+}
+
+// -----------------------------------------------------------------------------
+// WebSerial hand-off (AsyncTCP task → drain task)
+// -----------------------------------------------------------------------------
+
+// Collects a reply into CONSOLE_REPLY_BYTES blocks (WebSerial: one message per write())
+class ConsoleReply : public Print {
+public:
+  void begin(Print &to)
+  {
+    sink = &to;
+    len = 0;
+  }
+
+  size_t write(uint8_t c) override { return write(&c, 1); }
+
+  size_t write(const uint8_t *data, size_t size) override
+  {
+    for (size_t done = 0; done < size;) {
+      if (len == sizeof(block))
+        send();
+      size_t n = min(size - done, sizeof(block) - len);
+      memcpy(block + len, data + done, n);
+      len += n;
+      done += n;
+    }
+    return size;
+  }
+
+  void send()
+  {
+    if (len > 0)
+      sink->write(block, len);
+    len = 0;
+  }
+
+private:
+  Print *sink = NULL;
+  uint8_t block[CONSOLE_REPLY_BYTES];
+  size_t len = 0;
+};
+
+static ConsoleReply reply;  // Drain task only - in .bss, not on its stack
+
+static portMUX_TYPE submitLock = portMUX_INITIALIZER_UNLOCKED;
+static char submitted[CONSOLE_LINE_MAX];
+static size_t submittedLen = 0;
+static ConsoleSource submittedSource = CONSOLE_SERIAL;
+static Print *submittedOut = NULL;
+static volatile bool submitPending = false;
+
+bool consoleSubmit(ConsoleSource source, const char *line, size_t len, Print &out)
+{
+  len = min(len, sizeof(submitted));  // Still over the limit, so execute() refuses it
+  bool accepted = false;
+  portENTER_CRITICAL(&submitLock);
+  if (!submitPending) {
+    memcpy(submitted, line, len);
+    submittedLen = len;
+    submittedSource = source;
+    submittedOut = &out;
+    submitPending = true;
+    accepted = true;
+  }
+  portEXIT_CRITICAL(&submitLock);
+  return accepted;
+}
+
+void consoleService()
+{
+  if (!submitPending)
+    return;
+
+  char line[CONSOLE_LINE_MAX];
+  portENTER_CRITICAL(&submitLock);
+  size_t len = submittedLen;
+  memcpy(line, submitted, len);
+  ConsoleSource source = submittedSource;
+  Print *out = submittedOut;
+  submitPending = false;
+  portEXIT_CRITICAL(&submitLock);
+
+  reply.begin(*out);
+  execute(source, line, len, reply, *out);
+  reply.send();
+}
+
+// -----------------------------------------------------------------------------
+// Commands owned by the console / log backend
+// -----------------------------------------------------------------------------
+
+static const LogTag *const LOG_TAGS[] = {
+  &LOG_TAG_SYSTEM, &LOG_TAG_TASK, &LOG_TAG_BLE, &LOG_TAG_SCALE, &LOG_TAG_UI, &LOG_TAG_RELAY, &LOG_TAG_WEIGHT,
+  &LOG_TAG_LCD_DMA, &LOG_TAG_SHOT, &LOG_TAG_WIFI, &LOG_TAG_LOG, &LOG_TAG_APP, &LOG_TAG_LVGL,
+};
+static const char *const LEVEL_NAMES[] = {"none", "error", "warn", "info", "debug", "verbose"};
+
+static bool parseLevel(const ConsoleArgs &args, uint8_t i, uint8_t *level)
+{
+  for (uint8_t l = 0; l <= LOG_VERBOSE; l++) {
+    if (args.is(i, LEVEL_NAMES[l])) {
+      *level = l;
+      return true;
+    }
+  }
+  long n;
+  if (!args.number(i, &n) || n < LOG_NONE || n > LOG_VERBOSE)
+    return false;
+  *level = (uint8_t)n;
+  return true;
+}
+
+static void cmdLogLevel(ConsoleArgs &args)
+{
+  if (args.argc == 3) {
+    const LogTag *tag = NULL;
+    for (const LogTag *t : LOG_TAGS) {
+      if (strcasecmp(t->name, args.arg(1)) == 0)
+        tag = t;
+    }
+    uint8_t level;
+    if (tag == NULL || !parseLevel(args, 2, &level)) {
+      args.out.println("Usage: loglevel <tag> <none|error|warn|info|debug|verbose|0-5>");
+      return;
+    }
+    if (!logRingSetLevel(tag->name, level)) {
+      args.out.printf("No room for another runtime level (%u tags)\n", (unsigned)LOG_LEVEL_OVERRIDES);
+      return;
+    }
+    LOG_INFO(TAG, "🔧 Log level %s: %s (built with %s)", tag->name, LEVEL_NAMES[level], LEVEL_NAMES[tag->level]);
+  } else if (args.argc != 1) {
+    args.out.println("Usage: loglevel [<tag> <level>]");
+    return;
+  }
+
+  args.out.println("Tag       built    now");
+  for (const LogTag *t : LOG_TAGS) {
+    uint8_t now = min((uint8_t)t->level, logRingLevel(t->name));
+    args.out.printf("  %-8s %-8s %s\n", t->name, LEVEL_NAMES[t->level], LEVEL_NAMES[now]);
+  }
+  args.out.println("(a level above the built one has no effect - those calls are compiled out)");
+}
+
+static ConsoleCommand logLevelCommand("loglevel", "[<tag> <level>]", "Per-tag log level at runtime (lower only)", cmdLogLevel);
+
+void consoleBench(Print &out)
+{
+  static const char *const LINES[] = {"tasks", "metrics ble_", "touchcal jump 40 12 40 12 60 60", "nosuchcommand"};
+  constexpr int ROUNDS = 1000;
+
+  for (const char *line : LINES) {
+    size_t len = strlen(line);
+    int64_t start = esp_timer_get_time();
+    int found = 0;
+    for (int i = 0; i < ROUNDS; i++) {
+      char buffer[CONSOLE_LINE_MAX];
+      char *argv[CONSOLE_MAX_ARGS];
+      copyLine(buffer, line, len);
+      if (tokenize(buffer, argv) > 0 && find(argv[0]) != NULL)
+        found++;
+    }
+    int64_t us = esp_timer_get_time() - start;
+    out.printf("[Bench] console %-32s %5.2f us/line%s\n", line, (double)us / ROUNDS, found ? "" : " (not found)");
+  }
+}
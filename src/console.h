@@ -0,0 +1,110 @@
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+// =============================================================================
+// Command Console (USB serial + WebSerial, one registry, no allocation)
+// =============================================================================
+// The serial console was an strcmp() chain in the .ino and WebSerial had its
+// own, smaller if-chain that copied every received byte into a String. Now
+// both feed one registry:
+//
+//   static void cmdHeap(ConsoleArgs &args) { args.out.printf(...); }
+//   static ConsoleCommand heapCommand("heap", "", "Free / minimum free heap", cmdHeap);
+//   static ConsoleCommand otaCommand("ota", "App slots, last update", otaDump);   // Print & only
+//
+//   - Commands are file-scope ConsoleCommand objects; the constructor links
+//     them into the registry at static init (like metrics.h), so each module
+//     keeps its commands next to the state they show.
+//   - consoleExecute() copies the line into a CONSOLE_LINE_MAX stack buffer
+//     and splits it in place: whitespace separates, "double quotes" group,
+//     at most CONSOLE_MAX_ARGS words. argv[] points into that buffer - no
+//     heap, no String, nothing left behind when the handler returns.
+//   - argv[0] is looked up by name in the registry (a few dozen strcmp()).
+//   - "help" lists every command with its usage, sorted by name.
+//
+// USB serial lines run in the log drain task (logRingSetCommandHandler()).
+// WebSerial lines arrive on the AsyncTCP task, which must not run a
+// benchmark or a long dump: consoleSubmit() only copies the line, and the
+// drain task runs it on its next pass (consoleService()). The reply there
+// goes out in CONSOLE_REPLY_BYTES blocks, one WebSocket message each,
+// instead of one per print() call.
+//
+// Thread Safety:
+//   consoleSubmit() - any task (one line in flight, a second is refused).
+//   consoleExecute() / consoleService() / handlers - log drain task, so
+//   handlers never run concurrently with each other.
+// =============================================================================
+
+#include <Arduino.h>
+
+constexpr size_t  CONSOLE_LINE_MAX    = 96;     // Command line incl. NUL
+constexpr uint8_t CONSOLE_MAX_ARGS    = 8;      // Words incl. the command name
+constexpr size_t  CONSOLE_REPLY_BYTES = 1024;   // WebSerial reply block (one WebSocket message)
+
+enum ConsoleSource : uint8_t {
+  CONSOLE_SERIAL,   // USB CDC
+  CONSOLE_WEB       // WebSerial (debug builds)
+};
+
+struct ConsoleArgs {
+  ConsoleSource source;
+  Print &out;                     // Reply (buffered for WebSerial)
+  Print &stream;                  // The transport itself - for output that comes later
+  uint8_t argc;
+  char *argv[CONSOLE_MAX_ARGS];   // argv[0] = command name
+
+  /** @brief Word `i`, "" past the end */
+  const char *arg(uint8_t i) const { return i < argc ? argv[i] : ""; }
+
+  /** @brief Word `i` equals `word` */
+  bool is(uint8_t i, const char *word) const { return strcmp(arg(i), word) == 0; }
+
+  /** @brief Word `i` as a whole decimal number (false if missing or not one) */
+  bool number(uint8_t i, long *value) const;
+
+  /** @brief Word `i` as a floating point number */
+  bool decimal(uint8_t i, float *value) const;
+};
+
+typedef void (*ConsoleHandler)(ConsoleArgs &args);
+typedef void (*ConsoleDump)(Print &out);   // xxxDump(Print &) - no arguments
+
+class ConsoleCommand {
+public:
+  /**
+   * @param usage Arguments for "help" ("" = none), e.g. "[erase]"
+   */
+  ConsoleCommand(const char *name, const char *usage, const char *help, ConsoleHandler handler);
+  ConsoleCommand(const char *name, const char *help, ConsoleDump dump);
+
+  const char *const name;
+  const char *const usage;
+  const char *const help;
+  const ConsoleHandler handler;   // NULL: dump(out)
+  const ConsoleDump dump;
+  ConsoleCommand *next;   // Registry list (set once at static init)
+};
+
+/**
+ * @brief Tokenize `line` (need not be NUL-terminated) and run its command now
+ * @note Log drain task
+ */
+void consoleExecute(ConsoleSource source, const char *line, size_t len, Print &out);
+
+/**
+ * @brief Hand a line to the drain task; replies go to `out`
+ * @return false if the previous line has not run yet
+ */
+bool consoleSubmit(ConsoleSource source, const char *line, size_t len, Print &out);
+
+/**
+ * @brief Run a submitted line, if any; once per drain loop
+ */
+void consoleService();
+
+/**
+ * @brief Parse + look-up cost per line (the "bench console" command)
+ */
+void consoleBench(Print &out);
+
+#endif // CONSOLE_H
@@ -0,0 +1,143 @@
+// =============================================================================
+// Core Dump Retrieval Implementation
+// =============================================================================
+
+#include "core_dump.h"
+#include "debug_config.h"
+#include "shot_log.h"
+#include "wifi_coex.h"
+#include "esp_partition.h"
+#include <ESPAsyncWebServer.h>
+
+#if CONFIG_ESP_COREDUMP_ENABLE_TO_FLASH && CONFIG_ESP_COREDUMP_DATA_FORMAT_ELF
+#include "esp_core_dump.h"
+#define GS_HAVE_CORE_DUMP 1
+#else
+#define GS_HAVE_CORE_DUMP 0
+#endif
+
+static constexpr LogTag TAG = LOG_TAG_SYSTEM;
+
+static CoreDumpInfo info = {};
+static const esp_partition_t *partition = NULL;
+static uint32_t imageOffset = 0;  // Image start within the partition
+
+void coreDumpBegin()
+{
+  partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_COREDUMP, NULL);
+  if (partition == NULL) {
+    LOG_WARN(TAG, "⚠️  Core dump: no coredump partition - crashes leave only the serial backtrace");
+    return;
+  }
+
+#if GS_HAVE_CORE_DUMP
+  size_t addr = 0, size = 0;
+  if (esp_core_dump_image_get(&addr, &size) != ESP_OK || size == 0)
+    return;  // No dump (or an invalid one) - the normal case
+
+  info.present = true;
+  info.size = (uint32_t)size;
+  imageOffset = (uint32_t)(addr - partition->address);
+
+  esp_core_dump_summary_t *summary = (esp_core_dump_summary_t *)malloc(sizeof(esp_core_dump_summary_t));
+  if (summary != NULL && esp_core_dump_get_summary(summary) == ESP_OK) {
+    strncpy(info.task, summary->exc_task, sizeof(info.task) - 1);
+    info.pc = summary->exc_pc;
+    info.cause = summary->ex_info.exc_cause;
+    info.vaddr = summary->ex_info.exc_vaddr;
+    info.depth = (uint8_t)min((uint32_t)summary->exc_bt_info.depth, (uint32_t)CORE_DUMP_BACKTRACE);
+    info.corrupted = summary->exc_bt_info.corrupted;
+    memcpy(info.backtrace, summary->exc_bt_info.bt, info.depth * sizeof(uint32_t));
+  } else {
+    strncpy(info.task, "?", sizeof(info.task) - 1);
+  }
+  free(summary);
+
+  LOG_ERROR(TAG, "💀 Core dump from the last crash: task %s, PC 0x%08lx, cause %lu, vaddr 0x%08lx (%lu bytes)",
+            info.task, (unsigned long)info.pc, (unsigned long)info.cause, (unsigned long)info.vaddr,
+            (unsigned long)info.size);
+  LOG_ERROR(TAG, "💀 \"coredump\" for the backtrace, GET /coredump.bin for the image, \"coredump erase\" to clear");
+#endif
+}
+
+const CoreDumpInfo &coreDumpInfo()
+{
+  return info;
+}
+
+bool coreDumpStatusText(char *text, size_t size)
+{
+  if (!info.present)
+    return false;
+  snprintf(text, size, "Crashed: %s @0x%08lx", info.task, (unsigned long)info.pc);
+  return true;
+}
+
+void coreDumpDump(Print &out)
+{
+  char line[96];
+  if (!info.present) {
+    out.print(partition != NULL ? "Core dump: none\n" : "Core dump: no coredump partition\n");
+    return;
+  }
+
+  snprintf(line, sizeof(line), "Core dump: %lu bytes at 0x%08lx\n", (unsigned long)info.size,
+           (unsigned long)(partition->address + imageOffset));
+  out.print(line);
+  snprintf(line, sizeof(line), "  task %s, PC 0x%08lx, EXCCAUSE %lu, EXCVADDR 0x%08lx\n", info.task,
+           (unsigned long)info.pc, (unsigned long)info.cause, (unsigned long)info.vaddr);
+  out.print(line);
+  out.print("  Backtrace:");
+  for (uint8_t i = 0; i < info.depth; i++) {
+    snprintf(line, sizeof(line), " 0x%08lx", (unsigned long)info.backtrace[i]);
+    out.print(line);
+  }
+  out.print(info.corrupted ? " |<-CORRUPTED\n" : "\n");
+  out.print("  Fetch: GET /coredump.bin, then esp-coredump info_corefile -t raw -c coredump.bin firmware.elf\n");
+}
+
+bool coreDumpErase()
+{
+  if (partition == NULL)
+    return false;
+  if (esp_partition_erase_range(partition, 0, partition->size) != ESP_OK) {
+    LOG_ERROR(TAG, "❌ Core dump: erase failed");
+    return false;
+  }
+  info = CoreDumpInfo();
+  LOG_INFO(TAG, "🧹 Core dump erased");
+  return true;
+}
+
+void coreDumpRegister(AsyncWebServer &server)
+{
+  server.on("/coredump.bin", HTTP_GET, [](AsyncWebServerRequest *request) {
+    if (wifiCoexDeferRequest(request))
+      return;
+    if (!info.present) {
+      request->send(404, "text/plain", "No core dump\n");
+      return;
+    }
+    // Known length: read straight from flash into the TCP buffer, no copy in RAM
+    AsyncWebServerResponse *response = request->beginResponse(
+        "application/octet-stream", info.size, [](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+          if (index >= info.size)
+            return 0;
+          size_t n = min(min(maxLen, CORE_DUMP_CHUNK), (size_t)(info.size - index));
+          if (esp_partition_read(partition, imageOffset + index, buffer, n) != ESP_OK)
+            return 0;
+          return n;
+        });
+    response->addHeader("Content-Disposition", "attachment; filename=\"coredump.bin\"");
+    request->send(response);
+  });
+
+  server.on("/coredump.bin", HTTP_DELETE, [](AsyncWebServerRequest *request) {
+    if (shotLogBusy()) {
+      request->send(409, "text/plain", "Shot running - erase after it\n");  // 64 KB erase stalls flash reads
+      return;
+    }
+    bool erased = coreDumpErase();
+    request->send(erased ? 200 : 500, "text/plain", erased ? "Erased\n" : "Erase failed\n");
+  });
+}
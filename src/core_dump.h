@@ -0,0 +1,82 @@
+#ifndef CORE_DUMP_H
+#define CORE_DUMP_H
+
+// =============================================================================
+// Core Dump Retrieval ("coredump" partition)
+// =============================================================================
+// On a panic ESP-IDF writes an ELF core dump of all tasks to the coredump
+// partition (partitions.csv) instead of relying on the backtrace reaching
+// a USB CDC monitor, which is unreliable with BLE running. This module
+// turns that image into something usable without a cable:
+//
+//   - coreDumpBegin() (boot) reads the summary IDF extracts from the image:
+//     crashing task, PC, exception cause and backtrace. It is logged, and
+//     coreDumpStatusText() gives a one-line version for the status label.
+//   - "coredump" (USB serial / WebSerial) prints the summary with the
+//     backtrace as an addr2line-ready line; "coredump erase" clears it.
+//   - GET /coredump.bin streams the raw image straight from flash in
+//     CORE_DUMP_CHUNK pieces; DELETE /coredump.bin erases it. Decode with
+//       esp-coredump info_corefile -t raw -c coredump.bin firmware.elf
+//
+// The image stays until erased, so the same crash is reported on every
+// boot until someone has fetched it.
+//
+// Needs CONFIG_ESP_COREDUMP_ENABLE_TO_FLASH + ..._DATA_FORMAT_ELF (the
+// Arduino-ESP32 sdkconfig); otherwise every call reports "no dump".
+//
+// Thread Safety:
+//   coreDumpBegin() from setup(). The summary is read-only afterwards;
+//   HTTP handlers (async_tcp task) only read flash or erase it.
+// =============================================================================
+
+#include <Arduino.h>
+
+class AsyncWebServer;
+
+constexpr uint8_t CORE_DUMP_BACKTRACE = 16;    // Frames kept from the summary
+constexpr size_t CORE_DUMP_CHUNK      = 1024;  // Largest flash read per HTTP callback
+
+struct CoreDumpInfo {
+  bool present;
+  uint32_t size;               // Image bytes in the partition
+  char task[16];               // Crashing task
+  uint32_t pc;                 // PC at the exception
+  uint32_t cause;              // EXCCAUSE
+  uint32_t vaddr;              // EXCVADDR
+  uint8_t depth;               // Valid backtrace frames
+  bool corrupted;              // Backtrace ended on a bad frame
+  uint32_t backtrace[CORE_DUMP_BACKTRACE];
+};
+
+/**
+ * @brief Look for a core dump left by the previous run and log its summary
+ */
+void coreDumpBegin();
+
+/**
+ * @brief Summary read by coreDumpBegin() (present == false when there is none)
+ */
+const CoreDumpInfo &coreDumpInfo();
+
+/**
+ * @brief One-line summary for the status label, e.g. "Crashed: BLE @0x42012345"
+ * @return false when there is no core dump
+ */
+bool coreDumpStatusText(char *text, size_t size);
+
+/**
+ * @brief Print the summary, backtrace and how to fetch the image
+ */
+void coreDumpDump(Print &out);
+
+/**
+ * @brief Erase the image so the next boot reports no crash
+ */
+bool coreDumpErase();
+
+/**
+ * @brief GET / DELETE /coredump.bin on `server`
+ */
+void coreDumpRegister(AsyncWebServer &server);
+
+#endif // CORE_DUMP_H
@@ -0,0 +1,190 @@
+// =============================================================================
+// Crash-Surviving Event Ring Implementation
+// =============================================================================
+
+#include "crash_ring.h"
+#include "debug_config.h"
+#include "esp_timer.h"
+
+static constexpr LogTag TAG = LOG_TAG_SYSTEM;
+
+static_assert((CRASH_RING_EVENTS_PER_CORE & (CRASH_RING_EVENTS_PER_CORE - 1)) == 0,
+              "CRASH_RING_EVENTS_PER_CORE must be a power of two");
+
+static constexpr uint32_t CRASH_RING_MAGIC = 0x47535243;  // "GSRC"
+
+struct CrashEvent {
+  uint32_t us;      // Low 32 bits of esp_timer_get_time() (no 64-bit divide in ISRs)
+  uint16_t id;      // CrashEventId
+  uint16_t arg;
+};
+
+struct CrashRingCore {
+  uint32_t next;    // Total events recorded (slot = next % size)
+  CrashEvent events[CRASH_RING_EVENTS_PER_CORE];
+};
+
+struct CrashRing {
+  uint32_t magic;
+  uint32_t boot;    // Runs since the last power-on
+  CrashRingCore cores[2];
+};
+
+static const char *const EVENT_NAMES[CRASH_EV_COUNT] = {
+  "none", "boot", "ble_state", "flush_start", "flush_end", "touch_error",
+  "shot_start", "shot_end", "health", "restart", "watchdog",
+};
+
+// Same order as esp_reset_reason_t
+static const char *const RESET_NAMES[] = {
+  "unknown", "power-on", "external pin", "software", "panic", "interrupt watchdog",
+  "task watchdog", "other watchdog", "deep sleep", "brownout", "SDIO",
+};
+
+RTC_NOINIT_ATTR static CrashRing ring;
+static CrashRing *previous = NULL;       // Heap copy of the run before this boot
+static esp_reset_reason_t resetReason = ESP_RST_UNKNOWN;
+static volatile bool recording = false;
+
+static const char *resetName(esp_reset_reason_t reason)
+{
+  return ((unsigned)reason < sizeof(RESET_NAMES) / sizeof(RESET_NAMES[0])) ? RESET_NAMES[reason] : "?";
+}
+
+void crashRingBegin()
+{
+  resetReason = esp_reset_reason();
+  bool survived = (ring.magic == CRASH_RING_MAGIC) && resetReason != ESP_RST_POWERON;
+
+  if (survived) {
+    previous = (CrashRing *)malloc(sizeof(CrashRing));
+    if (previous != NULL)
+      memcpy(previous, &ring, sizeof(CrashRing));
+  }
+
+  uint32_t boot = survived ? ring.boot + 1 : 1;
+  memset(&ring, 0, sizeof(ring));
+  ring.magic = CRASH_RING_MAGIC;
+  ring.boot = boot;
+  __sync_synchronize();  // Fresh ring before recorders see the flag
+  recording = true;
+  crashRingRecord(CRASH_EV_BOOT, (uint16_t)resetReason);
+}
+
+void IRAM_ATTR crashRingRecord(CrashEventId id, uint16_t arg)
+{
+  if (!recording)
+    return;
+
+  uint32_t us = (uint32_t)esp_timer_get_time();
+  // Only this core writes its ring: masking local interrupts is enough
+  UBaseType_t state = portSET_INTERRUPT_MASK_FROM_ISR();
+  CrashRingCore &core = ring.cores[xPortGetCoreID() & 1];
+  CrashEvent &e = core.events[core.next & (CRASH_RING_EVENTS_PER_CORE - 1)];
+  e.us = us;
+  e.id = (uint16_t)id;
+  e.arg = arg;
+  core.next++;
+  portCLEAR_INTERRUPT_MASK_FROM_ISR(state);
+}
+
+// Merge both cores oldest first; invokes `emit` for the last `limit` events
+template <typename Emit>
+static uint32_t forEachEvent(const CrashRing &r, uint32_t limit, Emit emit)
+{
+  uint32_t pos[2], end[2], total = 0;
+  for (int c = 0; c < 2; c++) {
+    end[c] = r.cores[c].next;
+    pos[c] = (end[c] > CRASH_RING_EVENTS_PER_CORE) ? end[c] - CRASH_RING_EVENTS_PER_CORE : 0;
+    total += end[c] - pos[c];
+  }
+  uint32_t skip = (total > limit) ? total - limit : 0;
+  uint32_t emitted = 0;
+  uint32_t lastUs = 0;
+  bool haveLast = false;
+
+  // Time of the newest event: printed times count back from it
+  for (int c = 0; c < 2; c++) {
+    if (end[c] == 0)
+      continue;
+    uint32_t us = r.cores[c].events[(end[c] - 1) & (CRASH_RING_EVENTS_PER_CORE - 1)].us;
+    if (!haveLast || (int32_t)(us - lastUs) > 0)
+      lastUs = us;
+    haveLast = true;
+  }
+
+  while (pos[0] < end[0] || pos[1] < end[1]) {
+    int c;
+    if (pos[0] >= end[0])
+      c = 1;
+    else if (pos[1] >= end[1])
+      c = 0;
+    else {
+      const CrashEvent &a = r.cores[0].events[pos[0] & (CRASH_RING_EVENTS_PER_CORE - 1)];
+      const CrashEvent &b = r.cores[1].events[pos[1] & (CRASH_RING_EVENTS_PER_CORE - 1)];
+      c = ((int32_t)(b.us - a.us) < 0) ? 1 : 0;
+    }
+    const CrashEvent &e = r.cores[c].events[pos[c] & (CRASH_RING_EVENTS_PER_CORE - 1)];
+    pos[c]++;
+    if (skip > 0) {
+      skip--;
+      continue;
+    }
+    emit(c, e, (int32_t)(e.us - lastUs));
+    emitted++;
+  }
+  return emitted;
+}
+
+static void formatEvent(char *line, size_t size, int core, const CrashEvent &e, int32_t relUs)
+{
+  const char *name = (e.id < CRASH_EV_COUNT) ? EVENT_NAMES[e.id] : "?";
+  snprintf(line, size, "%+10.3f ms  core %d  %-12s %u", relUs / 1000.0f, core, name, e.arg);
+}
+
+void crashRingReport()
+{
+  if (previous == NULL) {
+    LOG_INFO(TAG, "📼 Crash ring: started (boot #%lu, reset: %s)", (unsigned long)ring.boot, resetName(resetReason));
+    return;
+  }
+
+  bool crashed = resetReason == ESP_RST_PANIC || resetReason == ESP_RST_INT_WDT ||
+                 resetReason == ESP_RST_TASK_WDT || resetReason == ESP_RST_WDT || resetReason == ESP_RST_BROWNOUT;
+  uint32_t total = previous->cores[0].next + previous->cores[1].next;
+  if (crashed)
+    LOG_ERROR(TAG, "📼 Crash ring: boot #%lu ended by %s - last events (\"crash\" prints all %lu recorded):",
+              (unsigned long)previous->boot, resetName(resetReason), (unsigned long)total);
+  else
+    LOG_INFO(TAG, "📼 Crash ring: boot #%lu ended by %s (\"crash\" prints its events)",
+             (unsigned long)previous->boot, resetName(resetReason));
+  if (!crashed)
+    return;
+
+  forEachEvent(*previous, CRASH_RING_REPORT_EVENTS, [](int core, const CrashEvent &e, int32_t relUs) {
+    char line[64];
+    formatEvent(line, sizeof(line), core, e, relUs);
+    LOG_ERROR(TAG, "📼   %s", line);
+  });
+}
+
+void crashRingDump(Print &out)
+{
+  char line[80];
+  if (previous == NULL) {
+    snprintf(line, sizeof(line), "Crash ring: nothing survived from before this boot (reset: %s)\n",
+             resetName(resetReason));
+    out.print(line);
+    return;
+  }
+
+  snprintf(line, sizeof(line), "Crash ring: boot #%lu, ended by %s (times relative to its last event)\n",
+           (unsigned long)previous->boot, resetName(resetReason));
+  out.print(line);
+  forEachEvent(*previous, 2 * CRASH_RING_EVENTS_PER_CORE, [&out](int core, const CrashEvent &e, int32_t relUs) {
+    char text[64];
+    formatEvent(text, sizeof(text), core, e, relUs);
+    out.print(text);
+    out.print("\n");
+  });
+}
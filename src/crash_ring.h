@@ -0,0 +1,75 @@
+#ifndef CRASH_RING_H
+#define CRASH_RING_H
+
+// =============================================================================
+// Crash-Surviving Event Ring (RTC_NOINIT memory)
+// =============================================================================
+// A flight recorder for post-mortems without a serial cable attached. The
+// last CRASH_RING_EVENTS_PER_CORE events per core live in RTC slow memory
+// marked RTC_NOINIT_ATTR, which the startup code does not clear: after a
+// panic, watchdog or software reset the previous run's events are still
+// there.
+//
+//   crashRingRecord(CRASH_EV_BLE_STATE, state);   // ~8 byte store, IRAM
+//
+//   - One ring per core, so a record only masks interrupts on its own core
+//     for the index bump (usable from ISRs and with the flash cache off).
+//   - Events are {ms since boot, id, 16-bit argument}: ids are an enum, not
+//     strings, so nothing has to stay valid across the reset.
+//   - crashRingBegin() (first thing in setup()) checks the magic word, keeps
+//     a heap copy of the previous run's rings and starts fresh ones. After
+//     a power-on the RTC contents are random and the magic does not match.
+//   - crashRingReport() logs the reset reason and the last events of the
+//     previous run; "crash" on USB serial / WebSerial prints all of them.
+//
+// Recorded: BOOT (reset reason), BLE_STATE, FLUSH_START/END,
+// TOUCH_ERROR, SHOT_START/END, HEALTH, RESTART, WATCHDOG.
+//
+// Thread Safety:
+//   crashRingRecord() from any task or ISR on either core.
+//   crashRingBegin()/crashRingReport() from setup(); crashRingDump() from
+//   one task at a time.
+// =============================================================================
+
+#include <Arduino.h>
+
+constexpr uint32_t CRASH_RING_EVENTS_PER_CORE = 128;  // Power of two, 8 bytes each (2 KB of RTC RAM total)
+constexpr uint32_t CRASH_RING_REPORT_EVENTS   = 16;   // Logged at boot; "crash" prints all
+
+enum CrashEventId : uint16_t {
+  CRASH_EV_NONE = 0,
+  CRASH_EV_BOOT,         // arg = esp_reset_reason_t of this boot
+  CRASH_EV_BLE_STATE,    // arg = ConnectionState entered
+  CRASH_EV_FLUSH_START,  // arg = rows in the area
+  CRASH_EV_FLUSH_END,    // DMA window done (flush_ready)
+  CRASH_EV_TOUCH_ERROR,  // arg = esp_err_t (low 16 bits)
+  CRASH_EV_SHOT_START,
+  CRASH_EV_SHOT_END,     // arg = ShotEndReason
+  CRASH_EV_HEALTH,       // arg = HealthEvent bit that tripped
+  CRASH_EV_RESTART,      // esp_restart() requested (OTA, "restart")
+  CRASH_EV_WATCHDOG,     // arg = WatchdogSubsystem that missed its deadline
+  CRASH_EV_COUNT
+};
+
+/**
+ * @brief Keep the previous run's ring if it survived, then start recording
+ * @note Call before anything else records - events before it are dropped
+ */
+void crashRingBegin();
+
+/**
+ * @brief Append one event to the calling core's ring (IRAM, ISR-safe)
+ */
+void crashRingRecord(CrashEventId id, uint16_t arg = 0);
+
+/**
+ * @brief Log the reset reason and the last CRASH_RING_REPORT_EVENTS events of the previous run
+ */
+void crashRingReport();
+
+/**
+ * @brief Print every event the previous run left, oldest first, both cores merged by time
+ */
+void crashRingDump(Print &out);
+
+#endif // CRASH_RING_H
@@ -0,0 +1,214 @@
+// =============================================================================
+// Cup Placement Detection Implementation
+// =============================================================================
+
+#include "cup_detect.h"
+#include "console.h"
+#include "debug_config.h"
+#include "metrics.h"
+#include "settings_store.h"
+
+static constexpr LogTag TAG = LOG_TAG_SHOT;
+
+enum CupState : uint8_t {
+  CUP_IDLE,     // Watching for a cup
+  CUP_TARING,   // Tare sent, waiting for a stable zero
+  CUP_PRIMED    // Tared cup on the scale
+};
+
+static const char *const MODE_NAMES[] = {"off", "tare", "auto"};
+static const char *const STATE_NAMES[] = {"idle", "taring", "primed"};
+
+static volatile uint8_t mode = CUP_MODE_OFF;
+static CupState state = CUP_IDLE;
+
+// Last stable level (control task)
+static bool haveLevel = false;
+static float level = 0.0f;
+
+// Current stability window
+static bool inWindow = false;
+static bool windowReported = false;   // Its level has been evaluated
+static float windowMin = 0.0f;
+static float windowMax = 0.0f;
+static float windowSum = 0.0f;
+static uint16_t windowCount = 0;
+static uint32_t windowStartMs = 0;
+
+static uint32_t tareSentMs = 0;
+static uint32_t primedMs = 0;
+static bool autoStarted = false;
+
+static volatile bool primed = false;    // state == CUP_PRIMED, for the BLE task
+static volatile float lastGrams = 0.0f;
+
+static MetricCounter cupTares("cup_tares_total", "Tares sent for a cup placed on the scale");
+static MetricCounter cupPrimedStarts("cup_primed_starts_total", "Shot starts that skipped the tare (cup already tared)");
+static MetricCounter cupAutoStarts("cup_auto_starts_total", "Shots started by cup placement (CUP_MODE_AUTO)");
+
+static void setState(CupState next, uint32_t nowMs)
+{
+  if (next == CUP_PRIMED && state != CUP_PRIMED) {
+    primedMs = nowMs;
+    autoStarted = false;
+    LOG_INFO(TAG, "☕ Cup tared and ready%s", mode == CUP_MODE_AUTO ? " - starting shortly" : " - tap Start");
+  }
+  state = next;
+  primed = (next == CUP_PRIMED);
+}
+
+static void startWindow(float grams, uint32_t nowMs)
+{
+  inWindow = true;
+  windowReported = false;
+  windowMin = windowMax = windowSum = grams;
+  windowCount = 1;
+  windowStartMs = nowMs;
+}
+
+// A new stable level: what the step from the previous one means
+static CupAction onStable(float stable, uint32_t nowMs)
+{
+  if (!haveLevel) {
+    haveLevel = true;   // First level after a reset is the reference only
+    level = stable;
+    return CUP_ACTION_NONE;
+  }
+  float step = stable - level;
+  level = stable;
+  bool zero = fabsf(stable) <= CUP_ZERO_G;
+
+  switch (state) {
+    case CUP_TARING:
+      if (zero)
+        setState(CUP_PRIMED, nowMs);
+      else if (step <= -CUP_STEP_G)
+        setState(CUP_IDLE, nowMs);   // Taken away before the tare landed
+      return CUP_ACTION_NONE;
+
+    case CUP_PRIMED:
+      if (zero)
+        return CUP_ACTION_NONE;
+      LOG_INFO(TAG, "☕ Cup level changed to %.1f g - no longer primed", stable);
+      setState(CUP_IDLE, nowMs);
+      // The change itself may be a placed cup
+      break;
+
+    case CUP_IDLE:
+      break;
+  }
+
+  if (step < CUP_STEP_G)
+    return CUP_ACTION_NONE;
+  if (zero) {
+    setState(CUP_PRIMED, nowMs);   // Put back on a scale already tared with it
+    return CUP_ACTION_NONE;
+  }
+  LOG_INFO(TAG, "☕ Cup placed (+%.1f g) - taring", step);
+  setState(CUP_TARING, nowMs);
+  tareSentMs = nowMs;
+  cupTares.add();
+  return CUP_ACTION_TARE;
+}
+
+void cupDetectSetMode(uint8_t next)
+{
+  mode = (next < CUP_MODE_COUNT) ? next : CUP_MODE_OFF;
+}
+
+uint8_t cupDetectMode()
+{
+  return mode;
+}
+
+CupAction cupDetectSample(float grams, uint32_t nowMs)
+{
+  lastGrams = grams;
+  if (mode == CUP_MODE_OFF) {
+    if (state != CUP_IDLE || haveLevel)
+      cupDetectReset();
+    return CUP_ACTION_NONE;
+  }
+
+  if (!inWindow || max(windowMax, grams) - min(windowMin, grams) > CUP_STABLE_BAND_G) {
+    startWindow(grams, nowMs);
+  } else {
+    windowMin = min(windowMin, grams);
+    windowMax = max(windowMax, grams);
+    windowSum += grams;
+    windowCount++;
+  }
+  bool stable = nowMs - windowStartMs >= CUP_STABLE_MS;
+
+  if (state == CUP_TARING && nowMs - tareSentMs >= CUP_TARE_TIMEOUT_MS) {
+    LOG_WARN(TAG, "⚠️  Cup tare not seen after %lums - tare on Start instead", (unsigned long)(nowMs - tareSentMs));
+    setState(CUP_IDLE, nowMs);
+  }
+
+  if (stable && !windowReported) {
+    windowReported = true;
+    CupAction action = onStable(windowSum / windowCount, nowMs);
+    if (action != CUP_ACTION_NONE)
+      return action;
+  }
+
+  if (state == CUP_PRIMED && mode == CUP_MODE_AUTO && !autoStarted && stable &&
+      nowMs - primedMs >= CUP_AUTOSTART_MS && fabsf(grams) <= CUP_ZERO_G) {
+    autoStarted = true;
+    cupAutoStarts.add();
+    LOG_INFO(TAG, "☕ Cup primed for %lums - starting the shot", (unsigned long)(nowMs - primedMs));
+    return CUP_ACTION_START;
+  }
+  return CUP_ACTION_NONE;
+}
+
+void cupDetectReset()
+{
+  haveLevel = false;
+  inWindow = false;
+  autoStarted = false;
+  state = CUP_IDLE;
+  primed = false;
+}
+
+bool cupDetectTakePrimed()
+{
+  if (fabsf(lastGrams) > CUP_ZERO_G || !__atomic_exchange_n(&primed, false, __ATOMIC_ACQ_REL))
+    return false;
+  cupPrimedStarts.add();
+  return true;
+}
+
+void cupDetectDump(Print &out)
+{
+  out.printf("[Cup] mode %s, %s, %.2f g now, stable level %s%.2f g\n", MODE_NAMES[mode], STATE_NAMES[state],
+             (float)lastGrams, haveLevel ? "" : "(none) ", level);
+  out.printf("  step %.0f g, stable %.1f g for %lu ms, zero %.1f g, auto start after %lu ms\n", CUP_STEP_G,
+             CUP_STABLE_BAND_G, (unsigned long)CUP_STABLE_MS, CUP_ZERO_G, (unsigned long)CUP_AUTOSTART_MS);
+  out.printf("  %lu tares, %lu starts without tare, %lu auto starts\n", (unsigned long)cupTares.value(),
+             (unsigned long)cupPrimedStarts.value(), (unsigned long)cupAutoStarts.value());
+}
+
+static void cmdCup(ConsoleArgs &args)
+{
+  if (args.argc == 2) {
+    uint8_t next = CUP_MODE_COUNT;
+    for (uint8_t m = 0; m < CUP_MODE_COUNT; m++) {
+      if (args.is(1, MODE_NAMES[m]))
+        next = m;
+    }
+    if (next == CUP_MODE_COUNT) {
+      args.out.println("Usage: cup [off|tare|auto]");
+      return;
+    }
+    cupDetectSetMode(next);
+    settingsSetCupMode(next);
+    LOG_INFO(TAG, "☕ Cup mode: %s", MODE_NAMES[next]);
+  } else if (args.argc != 1) {
+    args.out.println("Usage: cup [off|tare|auto]");
+    return;
+  }
+  cupDetectDump(args.out);
+}
+
+static ConsoleCommand cupCommand("cup", "[off|tare|auto]", "Cup detection: tare on placement, start by itself (auto)", cmdCup);
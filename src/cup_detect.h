@@ -0,0 +1,86 @@
+#ifndef CUP_DETECT_H
+#define CUP_DETECT_H
+
+// =============================================================================
+// Cup Placement Detection, Auto-Tare and Hands-Free Start
+// =============================================================================
+// Starting a shot runs reset + tare + start over BLE, then waits up to
+// BLE_CONFIRM_TIMEOUT_MS for the scale to report the tare before the pump
+// goes on. With a cup mode set, the idle weight stream does the tare ahead
+// of time:
+//
+//   empty scale ──► step up ≥ CUP_STEP_G ──► stable ──► tare ──► stable at 0
+//                   (cup placed)             (band)    (BLE)     = primed
+//
+//   - Stable: every reading for CUP_STABLE_MS within CUP_STABLE_BAND_G of
+//     each other (running min / max, O(1)). Each stable level is compared
+//     with the previous one: a step up is a cup placed, a step down a cup
+//     taken away.
+//   - A cup put back on a scale already tared with it settles at 0 and is
+//     primed without another tare.
+//   - Primed, the next start sends only reset + start (sendShotStart(false))
+//     and does not wait for a tare confirmation - about one round trip less
+//     between Start and the pump.
+//   - CUP_MODE_AUTO also starts the shot once the cup has been primed for
+//     CUP_AUTOSTART_MS. CUP_MODE_TARE waits for a tap on Start.
+//
+// Only idle samples count: not while brewing, flushing, in the drip delay
+// or during a start sequence. cupDetectReset() at every shot start forgets
+// the level, so taking the full cup away and putting it back never starts
+// a second shot by itself.
+//
+// Thread Safety:
+//   cupDetectSample() / cupDetectReset() - shot control task.
+//   cupDetectTakePrimed() - BLE task (start sequence), atomic.
+//   cupDetectSetMode() / cupDetectMode() / cupDetectDump() - any task.
+// =============================================================================
+
+#include <Arduino.h>
+
+constexpr float    CUP_STEP_G        = 20.0f;  // Level change that counts as a cup placed / removed
+constexpr float    CUP_STABLE_BAND_G = 0.3f;   // Max spread of readings that counts as stable
+constexpr uint32_t CUP_STABLE_MS     = 600;    // ... for this long
+constexpr float    CUP_ZERO_G        = 0.3f;   // |weight| that counts as tared
+constexpr uint32_t CUP_TARE_TIMEOUT_MS = 2500; // Tare sent, no stable zero by then = not primed
+constexpr uint32_t CUP_AUTOSTART_MS  = 1000;   // CUP_MODE_AUTO: primed this long, then start
+
+enum CupMode : uint8_t {
+  CUP_MODE_OFF,     // Tare on Start as before
+  CUP_MODE_TARE,    // Tare when a cup is placed, start with a tap
+  CUP_MODE_AUTO,    // ... and start by itself
+  CUP_MODE_COUNT
+};
+
+enum CupAction : uint8_t {
+  CUP_ACTION_NONE,
+  CUP_ACTION_TARE,   // Send a tare (BLE_CMD_TARE)
+  CUP_ACTION_START   // Start the shot (CUP_MODE_AUTO)
+};
+
+/**
+ * @brief Set the mode for this boot (the "cup" console command also persists it, settings_store.h)
+ */
+void cupDetectSetMode(uint8_t mode);
+uint8_t cupDetectMode();
+
+/**
+ * @brief One idle weight reading; what the caller should do next
+ */
+CupAction cupDetectSample(float grams, uint32_t nowMs);
+
+/**
+ * @brief Forget the level and the primed cup (shot start)
+ */
+void cupDetectReset();
+
+/**
+ * @brief True (once) if the cup on the scale is already tared - skip the tare of this start
+ */
+bool cupDetectTakePrimed();
+
+/**
+ * @brief Mode, state, current level and counters (the "cup" console command)
+ */
+void cupDetectDump(Print &out);
+
+#endif // CUP_DETECT_H
@@ -6,6 +6,17 @@
 // =============================================================================
 
 #include "debug_config.h"
+#include "trace.h"
+#include "metrics.h"
+#include "shot_export.h"
+#include "config_json.h"
+#include "core_dump.h"
+#include "wifi_coex.h"
+#include "shot_stream.h"
+#include "fb_mirror.h"
+#include "shot_publish.h"
+#include "ota_update.h"
+#include "console.h"
 
 #ifdef WIRELESS_DEBUG
 
@@ -18,50 +29,54 @@ AsyncWebServer debugServer(80);
 bool webSerialReady = false;
 
 // Logging tag for WiFi subsystem
-static const char* TAG = "WiFi";
+static constexpr LogTag TAG = LOG_TAG_WIFI;
+
+// /metrics scrape in progress: one at a time, written straight into AsyncTCP's send buffer
+static MetricsCursor scrapeCursor;
+static uint32_t scrapeGeneration = 0;
+static bool scrapeActive = false;
+static MetricCounter scrapesTotal("metrics_scrapes_total", "/metrics responses started");
+static MetricCounter scrapesBusy("metrics_scrapes_busy_total", "/metrics requests refused (scrape already running)");
+
+static void closeScrape(uint32_t generation)
+{
+  if (scrapeGeneration == generation)
+    scrapeActive = false;
+}
 
 // =============================================================================
-// WebSerial Message Callback
+// WebSerial Console
 // =============================================================================
-// Handles commands sent from the web browser interface.
-// Optional feature - can send commands to ESP32 during runtime.
+// Lines typed into the web page go to the shared command registry
+// (console.h) and run on the log drain task - the AsyncTCP task only copies
+// them. Wi-Fi-only commands are registered here.
 // =============================================================================
 void webSerialCallback(uint8_t *data, size_t len) {
-  String cmd = "";
-  for(size_t i = 0; i < len; i++) {
-    cmd += char(data[i]);
-  }
+  LOG_INFO(TAG, "WebSerial: %.*s", (int)len, (const char *)data);
+  if (!consoleSubmit(CONSOLE_WEB, (const char *)data, len, WebSerial))
+    WebSerial.println("Busy - previous command still running");
+}
 
-  WebSerial.println("Received: " + cmd);
-  Serial.println("[WebSerial] Received: " + cmd);
+void debugPrintUrl(Print &out, const char *label, const char *path, const char *note) {
+  out.printf("%s: http://%s%s%s\n", label, WiFi.localIP().toString().c_str(), path, note);
+}
 
-  // Example commands
-  if(cmd == "restart" || cmd == "reboot") {
-    WebSerial.println("Restarting ESP32...");
-    Serial.println("[WebSerial] Restart requested");
-    delay(100);
-    ESP.restart();
-  }
-  else if(cmd == "heap") {
-    WebSerial.printf("Free heap: %d bytes, Min free: %d bytes\n",
-                     ESP.getFreeHeap(), ESP.getMinFreeHeap());
-  }
-  else if(cmd == "wifi") {
-    int rssi = WiFi.RSSI();
-    WebSerial.printf("WiFi RSSI: %d dBm (%s)\n", rssi,
-                     rssi > -50 ? "Excellent" :
-                     rssi > -60 ? "Good" :
-                     rssi > -70 ? "Fair" : "Weak");
-  }
-  else if(cmd == "help") {
-    WebSerial.println("Available commands:");
-    WebSerial.println("  restart - Reboot ESP32");
-    WebSerial.println("  heap    - Show memory usage");
-    WebSerial.println("  wifi    - Show WiFi signal strength");
-    WebSerial.println("  help    - Show this message");
-  }
+static void cmdWifi(ConsoleArgs &args) {
+  int rssi = WiFi.RSSI();
+  args.out.printf("WiFi RSSI: %d dBm (%s)\n", rssi,
+                  rssi > -50 ? "Excellent" :
+                  rssi > -60 ? "Good" :
+                  rssi > -70 ? "Fair" : "Weak");
+  wifiCoexDump(args.out);
 }
 
+static ConsoleCommand wifiCommand("wifi", "", "WiFi signal strength and BLE coexistence counters", cmdWifi);
+static ConsoleCommand streamCommand("stream", "Live shot WebSocket clients and frame counts", shotStreamDump);
+#if GS_FB_MIRROR
+static ConsoleCommand mirrorCommand("mirror", "Screen mirror WebSocket clients, messages and rows", fbMirrorDump);
+#endif
+static ConsoleCommand mqttCommand("mqtt", "MQTT shot summary queue", shotPublishDump);
+
 // =============================================================================
 // Setup Wireless Debugging
 // =============================================================================
@@ -72,7 +87,8 @@ void webSerialCallback(uint8_t *data, size_t len) {
 //   - Connects to WiFi (10-second timeout)
 //   - Prints IP address to USB Serial
 //   - Starts WebSerial server on port 80
-//   - Configures WiFi for BLE coexistence (low-latency mode)
+//   - Configures WiFi for BLE coexistence (balanced arbiter, modem sleep);
+//     wifi_coex.h holds Wi-Fi back further during shots and scale connection
 //   - Continues without WiFi if connection fails (graceful degradation)
 // =============================================================================
 void setupWirelessDebug() {
@@ -140,6 +156,60 @@ void setupWirelessDebug() {
     WebSerial.begin(&debugServer);
     WebSerial.onMessage(webSerialCallback);
 
+    // Chrome trace JSON of the last trace events (GS_TRACE builds) - open in ui.perfetto.dev
+    debugServer.on("/trace.json", HTTP_GET, [](AsyncWebServerRequest *request) {
+      if (wifiCoexDeferRequest(request))
+        return;
+      AsyncResponseStream *response = request->beginResponseStream("application/json");
+      traceDump(*response);
+      request->send(response);
+    });
+
+    // Counters + latency histograms (metrics.h), scrapeable by Prometheus. Chunked:
+    // the registry is formatted a line at a time as TCP window space frees up
+    debugServer.on("/metrics", HTTP_GET, [](AsyncWebServerRequest *request) {
+      if (wifiCoexDeferRequest(request))
+        return;
+      if (scrapeActive) {
+        scrapesBusy.add();
+        request->send(503, "text/plain", "Metrics scrape already running\n");
+        return;
+      }
+      scrapeActive = true;
+      uint32_t generation = ++scrapeGeneration;
+      scrapeCursor.rewind();
+      scrapesTotal.add();
+      request->onDisconnect([generation]() { closeScrape(generation); });
+      request->send(request->beginChunkedResponse("text/plain; version=0.0.4",
+        [generation](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+          (void)index;
+          if (!scrapeActive || scrapeGeneration != generation)
+            return 0;
+          size_t n = scrapeCursor.read(buffer, maxLen);
+          if (n == 0)
+            closeScrape(generation);
+          return n;
+        }));
+    });
+
+    // Shot log as CSV / JSON, streamed in chunks (shot_export.h)
+    shotExportRegister(debugServer);
+
+    // Profiles + settings as one JSON document - GET to export, POST to import (config_json.h)
+    configJsonRegister(debugServer);
+
+    // Panic core dump image (core_dump.h) - GET to download, DELETE to erase
+    coreDumpRegister(debugServer);
+
+    // Live shot telemetry, binary WebSocket frames (shot_stream.h)
+    shotStreamRegister(debugServer);
+
+    // Remote screen mirror, changed rows only (fb_mirror.h, GS_FB_MIRROR builds)
+    fbMirrorRegister(debugServer);
+
+    // Firmware updates into the other app slot - POST /ota (ota_update.h)
+    otaRegister(debugServer);
+
     // Mark WebSerial as ready for logging
     webSerialReady = true;
 
@@ -18,14 +18,154 @@
 //   http://<ESP32-IP>/webserial (IP shown in USB Serial at boot)
 //
 // Thread Safety:
-//   All DEBUG_PRINT macros use serialMutex to prevent fragmented output
-//   when multiple FreeRTOS tasks print simultaneously (Core 0 + Core 1)
+//   LOG_*() and DEBUG_PRINT macros never block: lines go into per-core
+//   lock-free rings and a low-priority drain task prints them whole, under
+//   serialMutex (see log_ring.h). Raw Serial writers take serialMutex too.
 // =============================================================================
 
+// =============================================================================
+// Log Levels and Tags (firmware + host builds)
+// =============================================================================
+
+// Log levels (hierarchical)
+typedef enum {
+    LOG_NONE    = 0,  // No logging
+    LOG_ERROR   = 1,  // Critical errors only
+    LOG_WARN    = 2,  // Errors + warnings
+    LOG_INFO    = 3,  // Errors + warnings + info
+    LOG_DEBUG   = 4,  // Everything except verbose
+    LOG_VERBOSE = 5   // Everything including trace
+} log_level_t;
+
+// =============================================================================
+// Per-Tag Log Level Configuration (Fine-Grained Control)
+// =============================================================================
+// Set individual log levels for each subsystem tag
+// This allows you to silence noisy subsystems while keeping others verbose
+//
+// Example: To debug LVGL issues, set LVGL to VERBOSE and BLE to ERROR
+//
+// Levels are resolved at compile time: LOG_*() takes a LogTag constant
+// (LOG_TAG_BLE, ...) and a call above its tag's level compiles to nothing,
+// arguments included. Override per build with -DLOG_LEVEL_BLE=2 etc.; tags
+// without an override use LOG_LOCAL_LEVEL.
+// =============================================================================
+
+// Ceiling for every tag, whatever its own level (-DGS_LOG_MAX_LEVEL=2 in the
+// release environment: DEBUG / INFO calls and their strings leave the image)
+#ifndef GS_LOG_MAX_LEVEL
+#define GS_LOG_MAX_LEVEL 5
+#endif
+
+// Default global log level (fallback for tags not explicitly configured)
+#ifndef LOG_LOCAL_LEVEL
+#define LOG_LOCAL_LEVEL 4  // DEBUG level only (numeric: ESP-IDF esp_log.h tests it in #if)
+#endif
+
+// Per-tag overrides (comment out to use LOG_LOCAL_LEVEL default)
+#ifndef LOG_LEVEL_SYSTEM
+#define LOG_LEVEL_SYSTEM  LOG_DEBUG   // System startup/shutdown
+#endif
+#ifndef LOG_LEVEL_TASK
+#define LOG_LEVEL_TASK    LOG_DEBUG   // Task heartbeats
+#endif
+#ifndef LOG_LEVEL_BLE
+#define LOG_LEVEL_BLE     LOG_DEBUG   // BLE operations
+#endif
+#ifndef LOG_LEVEL_SCALE
+#define LOG_LEVEL_SCALE   LOG_DEBUG   // Scale communication
+#endif
+#ifndef LOG_LEVEL_UI
+#define LOG_LEVEL_UI      LOG_INFO    // UI/LVGL updates (INFO = hide touch I2C debug data)
+#endif
+#ifndef LOG_LEVEL_RELAY
+#define LOG_LEVEL_RELAY   LOG_DEBUG   // Relay control
+#endif
+#ifndef LOG_LEVEL_WEIGHT
+#define LOG_LEVEL_WEIGHT  LOG_DEBUG   // Weight updates
+#endif
+#ifndef LOG_LEVEL_LCD_DMA
+#define LOG_LEVEL_LCD_DMA LOG_INFO    // Display DMA operations (lcd_PushColors calls)
+#endif
+#ifndef LOG_LEVEL_SHOT
+#define LOG_LEVEL_SHOT    LOG_VERBOSE // Shot weight data (enables real-time weight logging)
+#endif
+
+// Tags without their own setting
+#ifndef LOG_LEVEL_WIFI
+#define LOG_LEVEL_WIFI    LOG_LOCAL_LEVEL
+#endif
+#ifndef LOG_LEVEL_LOG
+#define LOG_LEVEL_LOG     LOG_LOCAL_LEVEL
+#endif
+#ifndef LOG_LEVEL_APP
+#define LOG_LEVEL_APP     LOG_LOCAL_LEVEL
+#endif
+#ifndef LOG_LEVEL_LVGL
+#define LOG_LEVEL_LVGL    LOG_LOCAL_LEVEL
+#endif
+
+// Log tag: printed name + compile-time level. Use the constants below (or a
+// constexpr copy, e.g. `static constexpr LogTag TAG = LOG_TAG_UI;`) - LOG_*()
+// needs the level as a constant expression.
+struct LogTag {
+    const char* name;
+    int level;
+};
+
+// Tag level with the GS_LOG_MAX_LEVEL ceiling applied (the level the build has)
+constexpr int logBuiltLevel(int level) { return level < GS_LOG_MAX_LEVEL ? level : GS_LOG_MAX_LEVEL; }
+
+constexpr LogTag LOG_TAG_SYSTEM  = { "System",  logBuiltLevel(LOG_LEVEL_SYSTEM) };
+constexpr LogTag LOG_TAG_TASK    = { "Task",    logBuiltLevel(LOG_LEVEL_TASK) };
+constexpr LogTag LOG_TAG_BLE     = { "BLE",     logBuiltLevel(LOG_LEVEL_BLE) };
+constexpr LogTag LOG_TAG_SCALE   = { "Scale",   logBuiltLevel(LOG_LEVEL_SCALE) };
+constexpr LogTag LOG_TAG_UI      = { "UI",      logBuiltLevel(LOG_LEVEL_UI) };
+constexpr LogTag LOG_TAG_RELAY   = { "Relay",   logBuiltLevel(LOG_LEVEL_RELAY) };
+constexpr LogTag LOG_TAG_WEIGHT  = { "Weight",  logBuiltLevel(LOG_LEVEL_WEIGHT) };
+constexpr LogTag LOG_TAG_LCD_DMA = { "LCD_DMA", logBuiltLevel(LOG_LEVEL_LCD_DMA) };
+constexpr LogTag LOG_TAG_SHOT    = { "Shot",    logBuiltLevel(LOG_LEVEL_SHOT) };
+constexpr LogTag LOG_TAG_WIFI    = { "WiFi",    logBuiltLevel(LOG_LEVEL_WIFI) };
+constexpr LogTag LOG_TAG_LOG     = { "Log",     logBuiltLevel(LOG_LEVEL_LOG) };
+constexpr LogTag LOG_TAG_APP     = { "APP",     logBuiltLevel(LOG_LEVEL_APP) };
+constexpr LogTag LOG_TAG_LVGL    = { "LVGL",    logBuiltLevel(LOG_LEVEL_LVGL) };
+
+// Compile-time level check (template argument: a runtime tag fails to build
+// instead of silently costing a comparison)
+template <int Level, int TagLevel>
+struct LogEnabled {
+    static constexpr bool value = (Level != LOG_NONE) && (Level <= TagLevel);
+};
+
+#ifdef GS_NATIVE
+// =============================================================================
+// Host build (env:native, tools/shot_replay): plain stderr logging, no FreeRTOS
+// =============================================================================
+// GS_NATIVE_LOG_LEVEL (1=ERROR .. 5=VERBOSE, default WARN) picks what is printed.
+#include <stdio.h>
+
+#ifndef GS_NATIVE_LOG_LEVEL
+#define GS_NATIVE_LOG_LEVEL 2
+#endif
+
+#define GS_NATIVE_LOG(lvl, letter, tag, format, ...) do { \
+    if (LogEnabled<(lvl), (tag).level>::value && (lvl) <= GS_NATIVE_LOG_LEVEL) \
+      fprintf(stderr, letter " [%s]: " format "\n", (tag).name, ##__VA_ARGS__); \
+  } while (0)
+
+#define LOG_ERROR(tag, format, ...)   GS_NATIVE_LOG(1, "E", tag, format, ##__VA_ARGS__)
+#define LOG_WARN(tag, format, ...)    GS_NATIVE_LOG(2, "W", tag, format, ##__VA_ARGS__)
+#define LOG_INFO(tag, format, ...)    GS_NATIVE_LOG(3, "I", tag, format, ##__VA_ARGS__)
+#define LOG_DEBUG(tag, format, ...)   GS_NATIVE_LOG(4, "D", tag, format, ##__VA_ARGS__)
+#define LOG_VERBOSE(tag, format, ...) GS_NATIVE_LOG(5, "V", tag, format, ##__VA_ARGS__)
+
+#else // Firmware build
+
 #include <Arduino.h>          // For millis(), Serial
 #include <string.h>           // For strlen()
 #include <freertos/FreeRTOS.h>
 #include <freertos/semphr.h>
+#include "log_ring.h"         // Async backend behind log_write()
 
 // WebSerial includes (needed for log_write function when WIRELESS_DEBUG enabled)
 #ifdef WIRELESS_DEBUG
@@ -53,13 +193,13 @@ static constexpr bool webSerialReady = false;
 // Features:
 //   - Hierarchical log levels (ERROR/WARN/INFO/DEBUG/VERBOSE)
 //   - ANSI color coding (red errors, yellow warnings, etc.)
-//   - Tag-based filtering (like Log4j/spdlog loggers)
+//   - Tag-based filtering, resolved at compile time (disabled calls vanish)
 //   - Millisecond timestamps
-//   - Thread-safe (FreeRTOS mutex)
+//   - Thread-safe and non-blocking (per-core rings + drain task, log_ring.h)
 //   - Printf-style formatting
 //
 // Usage:
-//   static const char* TAG = "BLE";
+//   static constexpr LogTag TAG = LOG_TAG_BLE;
 //   LOG_ERROR(TAG, "Connection failed: %s", error);   // Red
 //   LOG_WARN(TAG, "Timeout after %d ms", timeout);    // Yellow
 //   LOG_INFO(TAG, "Connected to %s", device);         // Green
@@ -68,44 +208,10 @@ static constexpr bool webSerialReady = false;
 //
 // Configuration:
 //   #define LOG_LOCAL_LEVEL LOG_INFO   // Set global verbosity
+//   -DGS_LOG_BINARY                    // Send format pointer + raw args, decode on the host
+//                                      // (tools/log_decode/log_decode.py, see log_ring.h)
 // =============================================================================
 
-// Log levels (hierarchical)
-typedef enum {
-    LOG_NONE    = 0,  // No logging
-    LOG_ERROR   = 1,  // Critical errors only
-    LOG_WARN    = 2,  // Errors + warnings
-    LOG_INFO    = 3,  // Errors + warnings + info
-    LOG_DEBUG   = 4,  // Everything except verbose
-    LOG_VERBOSE = 5   // Everything including trace
-} log_level_t;
-
-// =============================================================================
-// Per-Tag Log Level Configuration (Fine-Grained Control)
-// =============================================================================
-// Set individual log levels for each subsystem tag
-// This allows you to silence noisy subsystems while keeping others verbose
-//
-// Example: To debug LVGL issues, set LVGL to VERBOSE and BLE to ERROR
-//
-// Available tags: System, Task, BLE, Scale, UI, Relay, Weight
-// =============================================================================
-
-// Default global log level (fallback for tags not explicitly configured)
-#ifndef LOG_LOCAL_LEVEL
-#define LOG_LOCAL_LEVEL LOG_DEBUG  // DEBUG level only
-#endif
-
-// Per-tag overrides (comment out to use LOG_LOCAL_LEVEL default)
-#define LOG_LEVEL_SYSTEM  LOG_DEBUG   // System startup/shutdown
-#define LOG_LEVEL_TASK    LOG_DEBUG   // Task heartbeats
-#define LOG_LEVEL_BLE     LOG_DEBUG   // BLE operations
-#define LOG_LEVEL_SCALE   LOG_DEBUG   // Scale communication
-#define LOG_LEVEL_UI      LOG_INFO    // UI/LVGL updates (INFO = hide touch I2C debug data)
-#define LOG_LEVEL_RELAY   LOG_DEBUG   // Relay control
-#define LOG_LEVEL_WEIGHT  LOG_DEBUG   // Weight updates
-#define LOG_LEVEL_LCD_DMA LOG_INFO    // Display DMA operations (lcd_PushColors calls)
-#define LOG_LEVEL_SHOT    LOG_VERBOSE // Shot weight data (enables real-time weight logging)
 
 // ANSI color codes (prefixed with GS_ to avoid ESP-IDF conflicts)
 #define GS_COLOR_BLACK   "30"
@@ -122,138 +228,31 @@ typedef enum {
 #define GS_LOG_BOLD(COLOR)   "\033[1;" COLOR "m"
 #define GS_LOG_RESET_COLOR   "\033[0m"
 
-// Helper to get per-tag log level
-inline log_level_t get_tag_log_level(const char* tag) {
-    // Check tag-specific overrides (case-insensitive comparison)
-#ifdef LOG_LEVEL_SYSTEM
-    if (strcasecmp(tag, "System") == 0 || strcasecmp(tag, "SYS") == 0) return LOG_LEVEL_SYSTEM;
-#endif
-#ifdef LOG_LEVEL_TASK
-    if (strcasecmp(tag, "Task") == 0) return LOG_LEVEL_TASK;
-#endif
-#ifdef LOG_LEVEL_BLE
-    if (strcasecmp(tag, "BLE") == 0) return LOG_LEVEL_BLE;
-#endif
-#ifdef LOG_LEVEL_SCALE
-    if (strcasecmp(tag, "Scale") == 0) return LOG_LEVEL_SCALE;
-#endif
-#ifdef LOG_LEVEL_UI
-    if (strcasecmp(tag, "UI") == 0) return LOG_LEVEL_UI;
-#endif
-#ifdef LOG_LEVEL_RELAY
-    if (strcasecmp(tag, "Relay") == 0) return LOG_LEVEL_RELAY;
-#endif
-#ifdef LOG_LEVEL_WEIGHT
-    if (strcasecmp(tag, "Weight") == 0) return LOG_LEVEL_WEIGHT;
-#endif
-#ifdef LOG_LEVEL_LCD_DMA
-    if (strcasecmp(tag, "LCD_DMA") == 0) return LOG_LEVEL_LCD_DMA;
-#endif
-#ifdef LOG_LEVEL_SHOT
-    if (strcasecmp(tag, "Shot") == 0) return LOG_LEVEL_SHOT;
-#endif
-
-    // Default to global level for unknown tags
-    return static_cast<log_level_t>(LOG_LOCAL_LEVEL);
-}
-
-// Core logging function
+// Core logging function - the level was already checked by LOG_*() at compile time.
+// Hands the line to log_ring: formatted (or packed) into the caller's per-core
+// ring and printed by the drain task, so the caller never waits for Serial.
 inline void log_write(log_level_t level, const char* tag, const char* format, ...)
     __attribute__((format(printf, 3, 4)));
 
 inline void log_write(log_level_t level, const char* tag, const char* format, ...) {
-    // Check if level is enabled for this specific tag
-    log_level_t tag_level = get_tag_log_level(tag);
-    if (level > tag_level) {
-        return;  // Level too verbose for this tag, skip completely
-    }
-
-    // Try to take mutex (or continue without if not created yet for early boot messages)
-    bool hasMutex = (serialMutex && xSemaphoreTake(serialMutex, pdMS_TO_TICKS(2000)));
-
-    // ALWAYS print to Serial, even if mutex isn't available (for early boot debugging)
-    {
-        // Get timestamp
-        uint32_t timestamp = millis();
-
-        // Determine level letter and color
-        const char* level_letter;
-        const char* level_color;
-        switch(level) {
-            case LOG_ERROR:
-                level_letter = "E";
-                level_color = GS_LOG_COLOR(GS_COLOR_RED);
-                break;
-            case LOG_WARN:
-                level_letter = "W";
-                level_color = GS_LOG_COLOR(GS_COLOR_YELLOW);
-                break;
-            case LOG_INFO:
-                level_letter = "I";
-                level_color = GS_LOG_COLOR(GS_COLOR_GREEN);
-                break;
-            case LOG_DEBUG:
-                level_letter = "D";
-                level_color = GS_LOG_COLOR(GS_COLOR_CYAN);
-                break;
-            case LOG_VERBOSE:
-                level_letter = "V";
-                level_color = GS_LOG_COLOR(GS_COLOR_GRAY);
-                break;
-            default:
-                level_letter = "?";
-                level_color = "";
-                break;
-        }
-
-        // Format the message first (before building complete line)
-        va_list args;
-        va_start(args, format);
-        char msg_buffer[256];
-        vsnprintf(msg_buffer, sizeof(msg_buffer), format, args);
-        va_end(args);
-
-        // Build COMPLETE log line in single buffer for atomic output
-        // Format: COLOR LEVEL (timestamp) [tag]: RESET message\n
-        // This prevents fragmentation when multiple tasks print simultaneously
-        char line_buffer[384];
-        snprintf(line_buffer, sizeof(line_buffer), "%s%s (%lu) [%s]:%s %s\n",
-                 level_color,           // ANSI color code
-                 level_letter,          // E/W/I/D/V
-                 timestamp,             // Milliseconds since boot
-                 tag,                   // Subsystem tag
-                 GS_LOG_RESET_COLOR,    // ANSI reset
-                 msg_buffer);           // Formatted message
-
-        // SINGLE atomic write - prevents interleaving from other tasks
-        // Mutex ensures only one task can write at a time
-        Serial.print(line_buffer);
-        // No flush - let USB CDC buffer naturally (prevents overflow)
-
-#ifdef WIRELESS_DEBUG
-        // Also send to WebSerial (without ANSI colors - browsers don't support them)
-        // Only if WebSerial has been initialized
-        if (webSerialReady) {
-            char web_line[384];
-            snprintf(web_line, sizeof(web_line), "%s (%lu) [%s]: %s\n",
-                     level_letter, timestamp, tag, msg_buffer);
-            WebSerial.print(web_line);
-        }
-#endif
-
-        // Release mutex if we acquired it
-        if (hasMutex) {
-            xSemaphoreGive(serialMutex);
-        }
-    }
+    va_list args;
+    va_start(args, format);
+    logRingWrite(static_cast<uint8_t>(level), tag, format, args);
+    va_end(args);
 }
 
 // Convenience macros (ESP-IDF style)
-#define LOG_ERROR(tag, format, ...)   log_write(LOG_ERROR,   tag, format, ##__VA_ARGS__)
-#define LOG_WARN(tag, format, ...)    log_write(LOG_WARN,    tag, format, ##__VA_ARGS__)
-#define LOG_INFO(tag, format, ...)    log_write(LOG_INFO,    tag, format, ##__VA_ARGS__)
-#define LOG_DEBUG(tag, format, ...)   log_write(LOG_DEBUG,   tag, format, ##__VA_ARGS__)
-#define LOG_VERBOSE(tag, format, ...) log_write(LOG_VERBOSE, tag, format, ##__VA_ARGS__)
+// A disabled level is `if (false)`: no call, no argument evaluation
+#define GS_LOG(lvl, tag, format, ...) do { \
+    if (LogEnabled<(lvl), (tag).level>::value) \
+        log_write((lvl), (tag).name, format, ##__VA_ARGS__); \
+  } while (0)
+
+#define LOG_ERROR(tag, format, ...)   GS_LOG(LOG_ERROR,   tag, format, ##__VA_ARGS__)
+#define LOG_WARN(tag, format, ...)    GS_LOG(LOG_WARN,    tag, format, ##__VA_ARGS__)
+#define LOG_INFO(tag, format, ...)    GS_LOG(LOG_INFO,    tag, format, ##__VA_ARGS__)
+#define LOG_DEBUG(tag, format, ...)   GS_LOG(LOG_DEBUG,   tag, format, ##__VA_ARGS__)
+#define LOG_VERBOSE(tag, format, ...) GS_LOG(LOG_VERBOSE, tag, format, ##__VA_ARGS__)
 
 // Backward compatibility with old debugPrint() function
 inline void debugPrint(const char* fmt, ...) __attribute__((format(printf, 1, 2)));
@@ -271,7 +270,7 @@ inline void debugPrint(const char* fmt, ...) {
         buffer[len-1] = '\0';
     }
 
-    LOG_INFO("APP", "%s", buffer);
+    LOG_INFO(LOG_TAG_APP, "%s", buffer);
 }
 
 #ifdef WIRELESS_DEBUG
@@ -282,6 +281,9 @@ inline void debugPrint(const char* fmt, ...) {
   // Initialize wireless debugging (call in setup())
   void setupWirelessDebug();
 
+  // Console replies: "<label>: http://<IP><path><note>"
+  void debugPrintUrl(Print &out, const char *label, const char *path, const char *note);
+
   // Legacy DEBUG_ macros (backward compatibility)
   // Route through LOG_INFO with generic "APP" tag
   #define DEBUG_INIT() setupWirelessDebug()
@@ -289,16 +291,16 @@ inline void debugPrint(const char* fmt, ...) {
   #define DEBUG_PRINT(x) do { \
     char _tmp[256]; \
     snprintf(_tmp, sizeof(_tmp), "%s", String(x).c_str()); \
-    LOG_INFO("APP", "%s", _tmp); \
+    LOG_INFO(LOG_TAG_APP, "%s", _tmp); \
   } while(0)
 
   #define DEBUG_PRINTLN(x) do { \
     char _tmp[256]; \
     snprintf(_tmp, sizeof(_tmp), "%s", String(x).c_str()); \
-    LOG_INFO("APP", "%s", _tmp); \
+    LOG_INFO(LOG_TAG_APP, "%s", _tmp); \
   } while(0)
 
-  #define DEBUG_PRINTF(...) LOG_INFO("APP", __VA_ARGS__)
+  #define DEBUG_PRINTF(...) LOG_INFO(LOG_TAG_APP, __VA_ARGS__)
 
 #else
   // Production build - USB Serial only
@@ -306,19 +308,23 @@ inline void debugPrint(const char* fmt, ...) {
   // Route through LOG_INFO with generic "APP" tag
   #define DEBUG_INIT() Serial.begin(115200)
 
+  inline void debugPrintUrl(Print &, const char *, const char *, const char *) {}
+
   #define DEBUG_PRINT(x) do { \
     char _tmp[256]; \
     snprintf(_tmp, sizeof(_tmp), "%s", String(x).c_str()); \
-    LOG_INFO("APP", "%s", _tmp); \
+    LOG_INFO(LOG_TAG_APP, "%s", _tmp); \
   } while(0)
 
   #define DEBUG_PRINTLN(x) do { \
     char _tmp[256]; \
     snprintf(_tmp, sizeof(_tmp), "%s", String(x).c_str()); \
-    LOG_INFO("APP", "%s", _tmp); \
+    LOG_INFO(LOG_TAG_APP, "%s", _tmp); \
   } while(0)
 
-  #define DEBUG_PRINTF(...) LOG_INFO("APP", __VA_ARGS__)
+  #define DEBUG_PRINTF(...) LOG_INFO(LOG_TAG_APP, __VA_ARGS__)
 #endif
 
+#endif // GS_NATIVE
+
 #endif // DEBUG_CONFIG_H
@@ -0,0 +1,189 @@
+// =============================================================================
+// Display Pipeline Benchmark Implementation
+// =============================================================================
+
+#include "display_bench.h"
+#include "debug_config.h"
+#include "AXS15231B.h"
+#include "esp_timer.h"
+
+static constexpr LogTag TAG = LOG_TAG_LCD_DMA;
+
+#if GS_DISPLAY_BENCH
+
+struct BenchResult {
+  uint32_t minUs;
+  uint32_t maxUs;
+  uint64_t totalUs;
+  uint32_t runs;
+  uint32_t timeouts;
+};
+
+static void benchNote(BenchResult &r, uint32_t us)
+{
+  if (r.runs == 0 || us < r.minUs)
+    r.minUs = us;
+  if (us > r.maxUs)
+    r.maxUs = us;
+  r.totalUs += us;
+  r.runs++;
+}
+
+// Block until the panel driver has sent the last chunk (DMA completion notifies this task)
+static bool waitPanelIdle(lv_disp_drv_t *drv)
+{
+  int64_t deadline = esp_timer_get_time() + DISPLAY_BENCH_DMA_TIMEOUT_MS * 1000LL;
+  while (get_lcd_spi_dma_write() || drv->draw_buf->flushing) {
+    if (esp_timer_get_time() > deadline)
+      return false;
+    ulTaskNotifyTake(pdTRUE, 1);
+  }
+  return true;
+}
+
+static void benchFlushNop(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_p)
+{
+  (void)area;
+  (void)color_p;
+  lv_disp_flush_ready(drv);
+}
+
+static void logRow(const char *name, const BenchResult &r, uint32_t bytes)
+{
+  if (r.runs == 0) {
+    LOG_INFO(TAG, "  %-22s   (no completed runs, %lu timeouts)", name, (unsigned long)r.timeouts);
+    return;
+  }
+  uint32_t avgUs = (uint32_t)(r.totalUs / r.runs);
+  float fps = avgUs ? 1000000.0f / avgUs : 0.0f;
+  if (bytes > 0) {
+    float mbps = avgUs ? (float)bytes / avgUs : 0.0f;  // bytes/µs == MB/s
+    LOG_INFO(TAG, "  %-22s %7lu %7lu %7lu %7.2f %6.1f%s", name, (unsigned long)r.minUs, (unsigned long)avgUs,
+             (unsigned long)r.maxUs, mbps, fps, r.timeouts ? "  (timeouts!)" : "");
+  } else {
+    LOG_INFO(TAG, "  %-22s %7lu %7lu %7lu %7s %6.1f", name, (unsigned long)r.minUs, (unsigned long)avgUs,
+             (unsigned long)r.maxUs, "-", fps);
+  }
+}
+
+static void benchPush(lv_disp_drv_t *drv, const uint16_t *frame, uint16_t rows, const char *name)
+{
+  BenchResult r = {};
+  for (uint32_t i = 0; i < DISPLAY_BENCH_PUSH_ITERATIONS; i++) {
+    int64_t start = esp_timer_get_time();
+    lcd_PushColorsLandscape(0, 0, UI_HOR_RES, rows, (uint16_t *)frame);
+    if (waitPanelIdle(drv))
+      benchNote(r, (uint32_t)(esp_timer_get_time() - start));
+    else
+      r.timeouts++;
+  }
+  logRow(name, r, (uint32_t)UI_HOR_RES * rows * sizeof(uint16_t));
+}
+
+// Representative content: full-screen gradient, text in every font the UI uses, an arc and a bar
+static lv_obj_t *createBenchScreen()
+{
+  lv_obj_t *scr = lv_obj_create(NULL);
+  lv_obj_set_style_bg_color(scr, lv_color_hex(0x102030), 0);
+  lv_obj_set_style_bg_grad_color(scr, lv_color_hex(0x405060), 0);
+  lv_obj_set_style_bg_grad_dir(scr, LV_GRAD_DIR_HOR, 0);
+
+  const lv_font_t *fonts[] = {&lv_font_montserrat_14, &lv_font_montserrat_18, &lv_font_montserrat_24};
+  for (int i = 0; i < 6; i++) {
+    lv_obj_t *label = lv_label_create(scr);
+    lv_obj_set_style_text_font(label, fonts[i % 3], 0);
+    lv_obj_set_style_text_color(label, lv_color_white(), 0);
+    lv_label_set_text(label, "36.4 g  28.1 s  1.8 g/s");
+    lv_obj_set_pos(label, 10 + (i / 3) * 300, 10 + (i % 3) * 40);
+  }
+
+  lv_obj_t *arc = lv_arc_create(scr);
+  lv_obj_set_size(arc, 150, 150);
+  lv_arc_set_value(arc, 70);
+  lv_obj_align(arc, LV_ALIGN_RIGHT_MID, -10, 0);
+
+  lv_obj_t *bar = lv_bar_create(scr);
+  lv_obj_set_size(bar, 400, 16);
+  lv_bar_set_value(bar, 60, LV_ANIM_OFF);
+  lv_obj_align(bar, LV_ALIGN_BOTTOM_LEFT, 10, -10);
+  return scr;
+}
+
+static void benchRefresh(lv_disp_drv_t *drv, lv_obj_t *scr, const char *name)
+{
+  BenchResult r = {};
+  lv_disp_t *disp = lv_disp_get_default();
+  for (uint32_t i = 0; i < DISPLAY_BENCH_RENDER_ITERATIONS; i++) {
+    lv_obj_invalidate(scr);
+    int64_t start = esp_timer_get_time();
+    lv_refr_now(disp);
+    if (waitPanelIdle(drv))
+      benchNote(r, (uint32_t)(esp_timer_get_time() - start));
+    else
+      r.timeouts++;
+  }
+  logRow(name, r, drv->flush_cb == benchFlushNop ? 0 : (uint32_t)UI_HOR_RES * UI_VER_RES * sizeof(uint16_t));
+}
+
+void displayBenchRun(lv_disp_drv_t *drv)
+{
+  size_t frameBytes = (size_t)UI_HOR_RES * UI_VER_RES * sizeof(uint16_t);
+  uint16_t *frame = (uint16_t *)ps_malloc(frameBytes);
+  if (frame == NULL) {
+    LOG_ERROR(TAG, "❌ Display bench: no PSRAM for a %u byte test frame", (unsigned)frameBytes);
+    return;
+  }
+  // Colour bars, so pixel order is visible while it runs
+  for (uint32_t i = 0; i < (uint32_t)UI_HOR_RES * UI_VER_RES; i++) {
+    static const uint16_t bars[] = {0xF800, 0x07E0, 0x001F, 0xFFFF, 0xFFE0, 0x07FF, 0xF81F, 0x0000};
+    frame[i] = bars[(i % UI_HOR_RES) * 8 / UI_HOR_RES];
+  }
+
+  lcd_set_flush_notify_task(xTaskGetCurrentTaskHandle());
+  ulTaskNotifyTake(pdTRUE, 0);  // Drop a stale completion
+
+  LOG_INFO(TAG, "═══════════════════════════════════════════════");
+  LOG_INFO(TAG, "  📈 DISPLAY PIPELINE BENCHMARK");
+  LOG_INFO(TAG, "  SPI_FREQUENCY=%lu SEND_BUF_SIZE=%u px, bounce %u x %u px, CPU %lu MHz",
+           (unsigned long)SPI_FREQUENCY, (unsigned)SEND_BUF_SIZE, (unsigned)LCD_BOUNCE_BUF_COUNT,
+           (unsigned)LCD_BOUNCE_BUF_PIXELS, (unsigned long)getCpuFrequencyMhz());
+  LOG_INFO(TAG, "  %-22s %7s %7s %7s %7s %6s", "test", "min us", "avg us", "max us", "MB/s", "fps");
+  logRingFlush(100);  // Keep the table in one piece on slow terminals
+
+  char name[32];
+  static const uint16_t stripRows[] = {UI_VER_RES, UI_VER_RES / 2, UI_VER_RES / 4, 20, 2};
+  for (size_t i = 0; i < sizeof(stripRows) / sizeof(stripRows[0]); i++) {
+    snprintf(name, sizeof(name), "push %ux%u%s", (unsigned)UI_HOR_RES, (unsigned)stripRows[i],
+             stripRows[i] == UI_VER_RES ? " (full)" : "");
+    benchPush(drv, frame, stripRows[i], name);
+  }
+  logRingFlush(100);
+
+  lv_obj_t *previous = lv_scr_act();
+  lv_obj_t *scr = createBenchScreen();
+  lv_scr_load(scr);
+
+  auto flushCb = drv->flush_cb;
+  drv->flush_cb = benchFlushNop;
+  benchRefresh(drv, scr, "render full (no flush)");
+  drv->flush_cb = flushCb;
+  benchRefresh(drv, scr, "render + push full");
+
+  lv_scr_load(previous);
+  lv_obj_del(scr);
+  lv_obj_invalidate(previous);
+  free(frame);
+
+  lcd_set_flush_notify_task(NULL);
+  LOG_INFO(TAG, "═══════════════════════════════════════════════");
+  logRingFlush(100);
+}
+
+#else
+
+void displayBenchRun(lv_disp_drv_t *drv)
+{
+  (void)drv;
+}
+
+#endif // GS_DISPLAY_BENCH
@@ -0,0 +1,52 @@
+#ifndef DISPLAY_BENCH_H
+#define DISPLAY_BENCH_H
+
+// =============================================================================
+// Display Pipeline Benchmark (boot-time, GS_DISPLAY_BENCH builds)
+// =============================================================================
+// Gives a reproducible before/after number for any display-pipeline change.
+// It runs once in setup(), after the LVGL driver is registered and before
+// ui_init(), and prints one table:
+//
+//   - push     lcd_PushColorsLandscape() of a static frame, waited to DMA
+//              completion: full frame and the partial strips the rounder
+//              produces (full width, LCD_ROW_FULL_SPAN), in µs, MB/s and fps
+//   - render   lv_refr_now() of a synthetic screen (gradient, labels, arc,
+//              bar) with a no-op flush_cb: LVGL draw cost only
+//   - frame    the same refresh through the real flush_cb, to DMA completion
+//
+// SPI_FREQUENCY, SEND_BUF_SIZE and LCD_BOUNCE_BUF_* are compile-time
+// settings; the table header prints them, so compare builds with e.g.
+//   build_flags = ... -DGS_DISPLAY_BENCH=1 -DSPI_FREQUENCY=40000000
+// (see [env:display_bench] in platformio.ini). That environment also
+// calibrates the QSPI clock on every boot (GS_LCD_CLOCK_CAL=2, lcd_clock.h),
+// so the bench runs at the highest clock that verified - "lcdclock" shows it.
+//
+// GS_DISPLAY_BENCH (compile-time, -DGS_DISPLAY_BENCH=<n>):
+//   0 - Not compiled in (default)
+//   1 - Run the benchmark at boot, then continue booting normally
+//
+// Thread Safety:
+//   Runs in setup() before the UI and BLE tasks exist - it owns LVGL and the
+//   panel for its duration.
+// =============================================================================
+
+#include <Arduino.h>
+#include "lvgl.h"
+
+#ifndef GS_DISPLAY_BENCH
+#define GS_DISPLAY_BENCH 0
+#endif
+
+constexpr uint32_t DISPLAY_BENCH_PUSH_ITERATIONS   = 30;
+constexpr uint32_t DISPLAY_BENCH_RENDER_ITERATIONS = 20;
+constexpr uint32_t DISPLAY_BENCH_DMA_TIMEOUT_MS    = 200;  // Per window - generous for any sane SPI clock
+
+/**
+ * @brief Run the benchmark and log the results table
+ * @param drv Registered display driver (flush_cb is swapped temporarily)
+ * @note No-op when GS_DISPLAY_BENCH == 0
+ */
+void displayBenchRun(lv_disp_drv_t *drv);
+
+#endif // DISPLAY_BENCH_H
@@ -0,0 +1,171 @@
+// =============================================================================
+// Display Flush Diagnostics Implementation
+// =============================================================================
+// Reporter task + frame inspection helpers for my_disp_flush().
+// All logging happens here, never in the flush path (except the one-off
+// first-frame dumps in GS_DISPLAY_DIAG >= 2 builds).
+// =============================================================================
+
+#include "display_diag.h"
+#include "debug_config.h"
+#include "task_layout.h"
+#include "AXS15231B.h"  // For lcd_get_bounce_stats()
+
+DisplayDiagStats displayDiag = {};
+
+static constexpr LogTag TAG = LOG_TAG_UI;
+
+#if GS_DISPLAY_DIAG >= 1
+
+static lv_disp_drv_t *diagDrv = NULL;
+static const void *initialBuf1 = NULL;
+static const void *initialBuf2 = NULL;
+
+#if GS_DISPLAY_DIAG >= 2
+static void checkDrawBufferIntegrity()
+{
+  // Verify LVGL draw buffer pointers haven't been corrupted
+  if (diagDrv == NULL || diagDrv->draw_buf == NULL) {
+    LOG_ERROR(TAG, "🚨 Display driver structure is NULL!");
+    return;
+  }
+
+  const void *current_buf1 = diagDrv->draw_buf->buf1;
+  const void *current_buf2 = diagDrv->draw_buf->buf2;
+
+  // Check if buffers moved (indicates memory corruption)
+  if (current_buf1 != initialBuf1) {
+    LOG_ERROR(TAG, "🚨 BUFFER CORRUPTION! buf1 moved: %p → %p", initialBuf1, current_buf1);
+  }
+  if (current_buf2 != initialBuf2) {
+    LOG_ERROR(TAG, "🚨 BUFFER CORRUPTION! buf2 moved: %p → %p", initialBuf2, current_buf2);
+  }
+}
+#endif
+
+static void displayDiagTask(void *parameter)
+{
+  DisplayDiagStats last = {};
+
+  for (;;) {
+    vTaskDelay(pdMS_TO_TICKS(DISPLAY_DIAG_REPORT_PERIOD_MS));
+
+    uint32_t flushes = displayDiag.flushes;
+    uint32_t pixels = displayDiag.pixels;
+    uint32_t rejected = displayDiag.rejectedAreas;
+    uint32_t periodFlushes = flushes - last.flushes;
+    uint32_t periodSeconds = DISPLAY_DIAG_REPORT_PERIOD_MS / 1000;
+
+    // NOTE: Flush rate varies with UI activity (0 Hz when idle is normal)
+    LOG_DEBUG(TAG, "🖼️  Display Flush: %lu calls in last %lus (~%lu Hz), %lu KB pushed",
+              periodFlushes, periodSeconds, periodFlushes / periodSeconds,
+              ((pixels - last.pixels) * sizeof(lv_color_t)) / 1024);
+
+    if (rejected != last.rejectedAreas) {
+      LOG_ERROR(TAG, "🚨 %lu flush areas rejected in last %lus (total %lu)",
+                rejected - last.rejectedAreas, periodSeconds, rejected);
+    }
+
+#if GS_DISPLAY_DIAG >= 2
+    uint32_t flushUsTotal = displayDiag.flushUsTotal;
+    if (periodFlushes > 0) {
+      LOG_DEBUG(TAG, "📊 Display flush stats: avg=%luus, max=%luus (since boot)",
+                (flushUsTotal - last.flushUsTotal) / periodFlushes, displayDiag.flushUsMax);
+    }
+    last.flushUsTotal = flushUsTotal;
+
+    uint32_t blackFrames = displayDiag.blackFrames;
+    if (blackFrames != last.blackFrames) {
+      uint32_t pos = displayDiag.lastBlackArea;
+      uint32_t size = displayDiag.lastBlackSize;
+      LOG_ERROR(TAG, "🚨 BLACK SCREEN DETECTED! %lu black flushes, last at (%lu,%lu) %lux%lu px",
+                blackFrames - last.blackFrames, pos & 0xFFFF, pos >> 16, size & 0xFFFF, size >> 16);
+    }
+    last.blackFrames = blackFrames;
+
+    checkDrawBufferIntegrity();
+#endif
+
+    lcd_bounce_stats_t bounce;
+    lcd_get_bounce_stats(&bounce);
+    if (bounce.active && bounce.fills > 0) {
+      LOG_DEBUG(TAG, "📊 Bounce buffers: %lu windows, %lu fills (%lu KB), fill avg=%luus max=%luus, "
+                "window last=%luus max=%luus, starved=%lu",
+                bounce.windows, bounce.fills, bounce.bytes / 1024,
+                bounce.fill_us_total / bounce.fills, bounce.fill_us_max,
+                bounce.window_us_last, bounce.window_us_max, bounce.starved);
+    }
+
+    last.flushes = flushes;
+    last.pixels = pixels;
+    last.rejectedAreas = rejected;
+  }
+}
+
+void displayDiagBegin(lv_disp_drv_t *drv)
+{
+  diagDrv = drv;
+  if (drv != NULL && drv->draw_buf != NULL) {
+    initialBuf1 = drv->draw_buf->buf1;
+    initialBuf2 = drv->draw_buf->buf2;
+  }
+
+  BaseType_t result = taskLayoutSpawn(TASK_ROLE_DISPLAY_DIAG, displayDiagTask, NULL, NULL);
+
+  if (result != pdPASS) {
+    LOG_ERROR(TAG, "❌ Failed to create display diagnostics task");
+    return;
+  }
+  LOG_INFO(TAG, "✅ Display diagnostics task started (GS_DISPLAY_DIAG=%d)", GS_DISPLAY_DIAG);
+}
+
+#else
+
+void displayDiagBegin(lv_disp_drv_t *drv)
+{
+  (void)drv;
+}
+
+#endif // GS_DISPLAY_DIAG >= 1
+
+#if GS_DISPLAY_DIAG >= 2
+void displayDiagInspectFrame(const lv_area_t *area, const uint16_t *pixels, uint32_t w, uint32_t h)
+{
+  // Log detailed flush information for first 5 flushes to diagnose blank display
+  static uint8_t flushDetailCount = 0;
+  if (flushDetailCount < 5) {
+    LOG_INFO(TAG, "🔬 FLUSH #%d: area=(%ld,%ld)-(%ld,%ld) size=%lux%lu pixels=%lu",
+             flushDetailCount + 1,
+             (long)area->x1, (long)area->y1, (long)area->x2, (long)area->y2,
+             w, h, w * h);
+
+    // Sample first few pixels to verify data isn't all zeros
+    LOG_INFO(TAG, "   First pixels: [0]=%04X [1]=%04X [2]=%04X [3]=%04X",
+             pixels[0], pixels[1], pixels[2], pixels[3]);
+
+    // Check if buffer contains any non-zero pixels
+    uint32_t totalPixels = w * h;
+    uint32_t nonZeroCount = 0;
+    for (uint32_t i = 0; i < totalPixels; i++) {
+      if (pixels[i] != 0) nonZeroCount++;
+    }
+    LOG_INFO(TAG, "   Non-zero pixels: %lu of %lu (%.1f%%)",
+             nonZeroCount, totalPixels, (nonZeroCount * 100.0) / totalPixels);
+
+    flushDetailCount++;
+  }
+
+  // Black screen detection: sample 100 pixels, count the flush if >90% are black.
+  // The reporter task logs the event - nothing is printed from here.
+  uint32_t totalSamples = min(100u, w * h);
+  uint32_t blackCount = 0;
+  for (uint32_t i = 0; i < totalSamples; i++) {
+    if (pixels[i] == 0x0000) blackCount++;
+  }
+  if (blackCount * 10 > totalSamples * 9) {
+    displayDiag.lastBlackArea = (uint32_t)(area->x1 & 0xFFFF) | ((uint32_t)area->y1 << 16);
+    displayDiag.lastBlackSize = (w & 0xFFFF) | (h << 16);
+    displayDiag.blackFrames++;
+  }
+}
+#endif
@@ -0,0 +1,60 @@
+#ifndef DISPLAY_DIAG_H
+#define DISPLAY_DIAG_H
+
+// =============================================================================
+// Display Flush Diagnostics for Gravimetric Shots
+// =============================================================================
+// Keeps instrumentation out of the LVGL flush hot path.
+//
+// GS_DISPLAY_DIAG (compile-time, set via -DGS_DISPLAY_DIAG=<n>):
+//   0 - Flush counter only (needed by the UI health monitor)
+//   1 - Counters: flushes, pixels pushed, rejected areas + reporter task (default)
+//   2 - Full: flush duration, first-frame pixel dumps, black screen detection,
+//       draw buffer integrity checks (debug builds)
+//
+// Thread Safety:
+//   my_disp_flush() (Core 1) is the ONLY writer of displayDiag. Every field is
+//   a naturally aligned 32-bit word, so single stores are atomic and the
+//   reporter task reads them without a lock. Readers work on deltas between
+//   snapshots, so a field updated mid-snapshot is picked up next period.
+// =============================================================================
+
+#include <Arduino.h>
+#include "lvgl.h"
+
+#ifndef GS_DISPLAY_DIAG
+#define GS_DISPLAY_DIAG 1
+#endif
+
+// Reporter task configuration
+constexpr uint32_t DISPLAY_DIAG_REPORT_PERIOD_MS = 10000;
+
+struct DisplayDiagStats {
+  volatile uint32_t flushes;          // flush_cb invocations (always counted)
+  volatile uint32_t pixels;           // Pixels handed to the panel driver
+  volatile uint32_t rejectedAreas;    // Out-of-bounds areas / NULL buffers dropped
+  volatile uint32_t flushUsMax;       // GS_DISPLAY_DIAG >= 2: longest time inside flush_cb
+  volatile uint32_t flushUsTotal;     // GS_DISPLAY_DIAG >= 2: sum of time inside flush_cb
+  volatile uint32_t blackFrames;      // GS_DISPLAY_DIAG >= 2: flushes that were >90% black
+  volatile uint32_t lastBlackArea;    // Packed x1 | y1 << 16 of the most recent black flush
+  volatile uint32_t lastBlackSize;    // Packed w | h << 16 of the most recent black flush
+};
+
+extern DisplayDiagStats displayDiag;
+
+/**
+ * @brief Start the low-priority reporter task
+ * @param drv Registered LVGL display driver (used for draw buffer integrity checks)
+ * @note No-op when GS_DISPLAY_DIAG == 0
+ */
+void displayDiagBegin(lv_disp_drv_t *drv);
+
+#if GS_DISPLAY_DIAG >= 2
+/**
+ * @brief Inspect pixel content of a flush (first-frame dump + black screen sampling)
+ * @note Runs inside flush_cb - only compiled into GS_DISPLAY_DIAG >= 2 builds
+ */
+void displayDiagInspectFrame(const lv_area_t *area, const uint16_t *pixels, uint32_t w, uint32_t h);
+#endif
+
+#endif // DISPLAY_DIAG_H
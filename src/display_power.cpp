@@ -0,0 +1,262 @@
+// =============================================================================
+// Display Power State Machine Implementation
+// =============================================================================
+
+#include "display_power.h"
+#include "debug_config.h"
+#include "metrics.h"
+#include "display_diag.h"
+#include "settings_store.h"
+#include "display_transport.h"
+#include "pins_config.h"
+#include "driver/ledc.h"
+
+static constexpr LogTag TAG = LOG_TAG_UI;
+
+static constexpr ledc_mode_t BL_MODE       = LEDC_LOW_SPEED_MODE;
+static constexpr ledc_channel_t BL_CHANNEL = LEDC_CHANNEL_0;
+static constexpr ledc_timer_t BL_TIMER     = LEDC_TIMER_0;
+
+// Slider % → duty (10 bit) on the CIE 1976 L* curve: equal slider steps look
+// like equal brightness steps. Floor keeps 0 % readable at the bar.
+static const uint16_t BRIGHTNESS_LUT[101] = {
+    24,   25,   26,   27,   28,   30,   31,   32,   33,   34,
+    35,   37,   38,   40,   41,   43,   45,   47,   49,   51,
+    54,   56,   59,   62,   65,   68,   71,   75,   79,   82,
+    86,   90,   95,   99,  104,  109,  114,  119,  125,  130,
+   136,  143,  149,  155,  162,  169,  177,  184,  192,  200,
+   208,  216,  225,  234,  244,  253,  263,  273,  283,  294,
+   305,  316,  328,  340,  352,  364,  377,  390,  403,  417,
+   431,  445,  460,  475,  491,  506,  522,  539,  556,  573,
+   590,  608,  626,  645,  664,  683,  703,  723,  744,  765,
+   786,  808,  830,  853,  876,  899,  923,  947,  972,  997,
+  1023
+};
+
+static const char *const STATE_NAMES[] = {"active", "dim", "off", "panel sleep", "waking"};
+
+static MetricCounter dimCount("display_dim_total", "Display dimmed after DISPLAY_DIM_AFTER_MS idle");
+static MetricCounter offCount("display_off_total", "Backlight off + LVGL paused");
+static MetricCounter panelSleepCount("display_panel_sleep_total", "Panel put into SLPIN");
+static MetricCounter wakeCount("display_wakes_total", "Wakes from off / panel sleep");
+static MetricCounter headlessCount("display_headless_total", "Shots / flushes started with the display paused");
+
+static DisplayPowerState state = DISPLAY_ACTIVE;
+static bool backlightReady = false;
+static uint8_t brightnessPct = 50;
+static volatile uint8_t ambientPct = 100;   // displayPowerSetAmbient() - any task
+static uint32_t targetDuty = 0;            // Where the backlight is heading
+static uint32_t pendingFadeMs = 0;         // Fade to targetDuty not started yet (0 = none)
+static unsigned long fadeEndMs = 0;        // LEDC fader busy until then
+static unsigned long stateSinceMs = 0;
+static unsigned long lastActivityMs = 0;
+static uint32_t wakeFlushes = 0;   // displayDiag.flushes when the wake refresh was queued
+static bool headless = false;      // Busy while paused, display left off
+
+static uint32_t dutyForPct(uint32_t pct)
+{
+  return BRIGHTNESS_LUT[pct > 100 ? 100 : pct];
+}
+
+static uint32_t activeDuty()
+{
+  return dutyForPct((uint32_t)brightnessPct * ambientPct / 100);
+}
+
+static uint32_t dimDuty()
+{
+  uint32_t duty = dutyForPct(DISPLAY_DIM_PCT);
+  return min(duty, activeDuty());
+}
+
+// Hardware ramp - returns at once, the LEDC fader steps the duty itself. The
+// driver blocks any duty change until a running fade ends, so a fade asked for
+// meanwhile only becomes the target; serviceFade() starts it once the fader
+// is free. Drag steps coalesce the same way.
+static void serviceFade()
+{
+  if (pendingFadeMs == 0 || (long)(millis() - fadeEndMs) < 0)
+    return;
+  ledc_set_fade_with_time(BL_MODE, BL_CHANNEL, targetDuty, (int)pendingFadeMs);
+  ledc_fade_start(BL_MODE, BL_CHANNEL, LEDC_FADE_NO_WAIT);
+  fadeEndMs = millis() + pendingFadeMs;
+  pendingFadeMs = 0;
+}
+
+static void backlightFade(uint32_t duty, uint32_t ms)
+{
+  targetDuty = duty;
+  pendingFadeMs = ms ? ms : 1;
+  serviceFade();
+}
+
+static void enter(DisplayPowerState next)
+{
+  DisplayPowerState previous = state;
+  state = next;
+  stateSinceMs = millis();
+
+  switch (next) {
+  case DISPLAY_ACTIVE:
+    backlightFade(activeDuty(), DISPLAY_FADE_ON_MS);
+    break;
+  case DISPLAY_DIM:
+    dimCount.add();
+    backlightFade(dimDuty(), DISPLAY_FADE_DIM_MS);
+    break;
+  case DISPLAY_OFF:
+    offCount.add();
+    settingsStoreFlush();  // Nothing will change until the next touch
+    backlightFade(0, DISPLAY_FADE_OFF_MS);
+    break;
+  case DISPLAY_PANEL_SLEEP:
+    panelSleepCount.add();
+    displayTransport().power(false);  // LVGL has been paused since OFF - no DMA in flight
+    break;
+  case DISPLAY_WAKING:
+    wakeCount.add();
+    if (previous == DISPLAY_PANEL_SLEEP)
+      displayTransport().power(true);
+    // One full-frame refresh: the panel kept the frame from before OFF, but
+    // every widget change since then has only been recorded, not drawn
+    lv_obj_invalidate(lv_scr_act());
+    wakeFlushes = displayDiag.flushes;
+    break;
+  }
+  LOG_INFO(TAG, "🖥️  Display %s → %s", STATE_NAMES[previous], STATE_NAMES[next]);
+}
+
+void displayPowerBegin()
+{
+  ledc_timer_config_t timer = {};
+  timer.speed_mode = BL_MODE;
+  timer.duty_resolution = LEDC_TIMER_10_BIT;
+  timer.timer_num = BL_TIMER;
+  timer.freq_hz = BACKLIGHT_PWM_HZ;
+  timer.clk_cfg = LEDC_AUTO_CLK;
+  ledc_timer_config(&timer);
+
+  ledc_channel_config_t channel = {};
+  channel.gpio_num = TFT_BL;
+  channel.speed_mode = BL_MODE;
+  channel.channel = BL_CHANNEL;
+  channel.intr_type = LEDC_INTR_DISABLE;
+  channel.timer_sel = BL_TIMER;
+  channel.duty = 0;  // Off during initialisation - no noise / garbage on the panel
+  channel.hpoint = 0;
+  ledc_channel_config(&channel);
+
+  backlightReady = ledc_fade_func_install(0) == ESP_OK;
+  if (!backlightReady)
+    LOG_ERROR(TAG, "❌ LEDC fade service failed - backlight stays off");
+}
+
+void displayPowerBacklightOn(uint8_t pct)
+{
+  brightnessPct = pct;
+  lastActivityMs = millis();
+  targetDuty = activeDuty();
+  if (backlightReady)
+    ledc_set_duty_and_update(BL_MODE, BL_CHANNEL, targetDuty, 0);
+}
+
+void displayPowerSetBrightness(uint8_t pct)
+{
+  brightnessPct = pct;  // displayPowerUpdate() fades towards it, coalescing drag steps
+}
+
+void displayPowerSetAmbient(uint8_t pct)
+{
+  ambientPct = pct > 100 ? 100 : pct;
+}
+
+bool displayPowerUpdate(bool busy, unsigned long lastTouchMs)
+{
+  unsigned long now = millis();
+  if (busy)
+    lastActivityMs = now;
+  if ((long)(lastTouchMs - lastActivityMs) > 0)
+    lastActivityMs = lastTouchMs;
+  unsigned long idleMs = now - lastActivityMs;
+
+  if (!backlightReady)
+    return false;
+  serviceFade();
+
+  switch (state) {
+  case DISPLAY_ACTIVE:
+    if (GS_DISPLAY_POWER && idleMs >= DISPLAY_DIM_AFTER_MS)
+      enter(DISPLAY_DIM);
+    else if (activeDuty() != targetDuty)
+      backlightFade(activeDuty(), BACKLIGHT_STEP_FADE_MS);  // Slider step or ambient change
+    break;
+  case DISPLAY_DIM:
+    if (idleMs < DISPLAY_DIM_AFTER_MS)
+      enter(DISPLAY_ACTIVE);  // Touched or a shot started while dim
+    else if (idleMs >= DISPLAY_OFF_AFTER_MS)
+      enter(DISPLAY_OFF);
+    break;
+  case DISPLAY_OFF:
+    if (busy && !GS_DISPLAY_HEADLESS)
+      enter(DISPLAY_WAKING);
+    else if (idleMs >= DISPLAY_PANEL_SLEEP_AFTER_MS)
+      enter(DISPLAY_PANEL_SLEEP);
+    break;
+  case DISPLAY_PANEL_SLEEP:
+    if (busy && !GS_DISPLAY_HEADLESS)
+      enter(DISPLAY_WAKING);
+    break;
+  case DISPLAY_WAKING:
+    // lv_timer_handler() has run since the wake if the flush count moved - the
+    // whole invalidated screen went out in that refresh
+    if (displayDiag.flushes != wakeFlushes || now - stateSinceMs >= DISPLAY_WAKE_FRAME_TIMEOUT_MS)
+      enter(DISPLAY_ACTIVE);
+    break;
+  }
+
+  bool nowHeadless = busy && displayPowerPaused();
+  if (nowHeadless && !headless) {
+    headlessCount.add();
+    LOG_INFO(TAG, "🕶️  Shot / flush with the display off - headless until a touch");
+  }
+  headless = nowHeadless;
+  return displayPowerPaused();
+}
+
+bool displayPowerWake()
+{
+  if (!displayPowerPaused())
+    return false;
+  bool panelSlept = state == DISPLAY_PANEL_SLEEP;
+  lastActivityMs = millis();
+  enter(DISPLAY_WAKING);
+  return panelSlept;
+}
+
+bool displayPowerPaused()
+{
+  return state == DISPLAY_OFF || state == DISPLAY_PANEL_SLEEP;
+}
+
+bool displayPowerHeadless()
+{
+  return headless;
+}
+
+DisplayPowerState displayPowerState()
+{
+  return state;
+}
+
+void displayPowerDump(Print &out)
+{
+  out.printf("[Display] %s for %lus, idle %lus, brightness %u%% x ambient %u%% (duty %lu/1023)%s\n",
+             STATE_NAMES[state], (millis() - stateSinceMs) / 1000, (millis() - lastActivityMs) / 1000,
+             brightnessPct, ambientPct, (unsigned long)ledc_get_duty(BL_MODE, BL_CHANNEL),
+             GS_DISPLAY_POWER ? (headless ? ", headless" : "") : ", idle pipeline off");
+  out.printf("  dim %lus, off %lus, panel sleep %lus after the last activity\n", DISPLAY_DIM_AFTER_MS / 1000,
+             DISPLAY_OFF_AFTER_MS / 1000, DISPLAY_PANEL_SLEEP_AFTER_MS / 1000);
+  out.printf("  %lu dims, %lu offs, %lu panel sleeps, %lu wakes, %lu headless\n", (unsigned long)dimCount.value(),
+             (unsigned long)offCount.value(), (unsigned long)panelSleepCount.value(),
+             (unsigned long)wakeCount.value(), (unsigned long)headlessCount.value());
+}
@@ -0,0 +1,141 @@
+#ifndef DISPLAY_POWER_H
+#define DISPLAY_POWER_H
+
+// =============================================================================
+// Display Power State Machine
+// =============================================================================
+// Nobody watches the controller between shots, so the display steps down on
+// idle time (no touch, no shot or flush running):
+//
+//   ACTIVE ─idle─▶ DIM ─idle─▶ OFF ─idle─▶ PANEL_SLEEP
+//     ▲ ◀──touch──┘             │               │
+//     └─── WAKING ◀──────── touch ──────────────┘
+//
+//   ACTIVE       backlight at the brightness setting, LVGL paced normally
+//   DIM          backlight at DISPLAY_DIM_PCT, still rendering (visible)
+//   OFF          backlight off and LVGL paused: displayPowerPaused() makes
+//                the UI task go to deep idle - no refresh timer, no render,
+//                no DMA (power_manager.h)
+//   PANEL_SLEEP  OFF + panel asleep (displayTransport().power(false): SLPIN)
+//   WAKING       panel awake, whole screen invalidated; the backlight waits
+//                for that full refresh so the first lit frame is current
+//
+// Headless: a shot or flush that starts while OFF / PANEL_SLEEP (cup auto
+// start, a remote start) leaves the display where it is. It counts as
+// activity, so the panel does not step further down meanwhile, but nobody
+// is looking: the UI task holds the UI channel (ui_channel.h) instead of
+// formatting and rendering, and keeps only the relay, the chart data and the
+// power locks going. A touch wakes the display as usual; the wake frame
+// shows the held values with one render. A start from the screen always
+// has it lit - DIM steps back up to ACTIVE as before.
+//
+// The backlight runs on LEDC (10 bit) with the hardware fader
+// (ledc_set_fade_with_time) - steps down slowly, comes back fast, no CPU spent
+// on the ramp. LEDC stops with APB in light sleep; only ever the case in OFF /
+// PANEL_SLEEP (duty 0).
+//
+// Brightness: the 0-100 % setting is perceptual - a CIE L* lookup table maps
+// it to duty, so the lower half of the slider is usable and the same visual
+// level costs less backlight power than the old linear 27-100 % PWM. Slider
+// drags are coalesced into BACKLIGHT_STEP_FADE_MS hardware fades (no per-event
+// PWM writes; the NVS write is debounced by settings_store). The active level
+// is further scaled by an ambient factor, displayPowerSetAmbient(), the hook
+// for a light sensor or a time-of-day schedule ("display ambient <pct>").
+//
+// GS_DISPLAY_POWER (compile-time): 1 = idle pipeline above (default),
+// 0 = always ACTIVE (backlight still through LEDC).
+// GS_DISPLAY_HEADLESS (compile-time): 1 = headless shots and flushes
+// (default), 0 = a shot or flush wakes the display from OFF / PANEL_SLEEP.
+//
+// "display" on the serial console prints the state and transition counts.
+//
+// Thread Safety:
+//   UI task (Core 1) only - it owns LVGL, the panel commands and the LEDC channel.
+//   displayPowerDump() reads the state unlocked (serial console, any task).
+//   displayPowerSetAmbient() - any task (single byte store).
+// =============================================================================
+
+#include <Arduino.h>
+
+#ifndef GS_DISPLAY_POWER
+#define GS_DISPLAY_POWER 1
+#endif
+
+#ifndef GS_DISPLAY_HEADLESS
+#define GS_DISPLAY_HEADLESS 1
+#endif
+
+constexpr uint32_t DISPLAY_DIM_AFTER_MS          = 60000;    // Idle → DIM
+constexpr uint32_t DISPLAY_OFF_AFTER_MS          = 300000;   // Idle → OFF (5 minutes)
+constexpr uint32_t DISPLAY_PANEL_SLEEP_AFTER_MS  = 900000;   // Idle → PANEL_SLEEP (15 minutes)
+constexpr uint32_t DISPLAY_FADE_DIM_MS           = 500;
+constexpr uint32_t DISPLAY_FADE_OFF_MS           = 600;
+constexpr uint32_t DISPLAY_FADE_ON_MS            = 150;
+constexpr uint32_t DISPLAY_WAKE_FRAME_TIMEOUT_MS = 250;      // Backlight on even if no frame came
+constexpr uint32_t BACKLIGHT_STEP_FADE_MS        = 60;       // Slider drag / ambient change ramp
+constexpr uint32_t DISPLAY_DIM_PCT               = 15;       // Perceptual level while DIM
+constexpr uint32_t BACKLIGHT_PWM_HZ              = 1000;     // Same as the former analogWrite()
+
+enum DisplayPowerState : uint8_t {
+  DISPLAY_ACTIVE = 0,
+  DISPLAY_DIM,
+  DISPLAY_OFF,
+  DISPLAY_PANEL_SLEEP,
+  DISPLAY_WAKING,
+};
+
+/**
+ * @brief Take over TFT_BL with an LEDC channel, backlight off (before the panel init)
+ */
+void displayPowerBegin();
+
+/**
+ * @brief Backlight on at `brightnessPct` without a fade (boot: first frame is on the panel)
+ */
+void displayPowerBacklightOn(uint8_t brightnessPct);
+
+/**
+ * @brief Brightness setting changed (0-100 %) - applied right away when ACTIVE
+ */
+void displayPowerSetBrightness(uint8_t brightnessPct);
+
+/**
+ * @brief Scale the active level by an ambient factor (0-100 %, any task) - light sensor / schedule hook
+ */
+void displayPowerSetAmbient(uint8_t pct);
+
+/**
+ * @brief Advance the state machine; call every UI task pass before LVGL
+ * @param busy Shot or flush running (counts as activity; wakes the display only without GS_DISPLAY_HEADLESS)
+ * @param lastTouchMs millis() of the last accepted touch
+ * @return displayPowerPaused()
+ */
+bool displayPowerUpdate(bool busy, unsigned long lastTouchMs);
+
+/**
+ * @brief Touch while OFF / PANEL_SLEEP: panel out of sleep, full refresh, backlight after it
+ * @return true if the panel had been asleep (touch controller needs its recovery time)
+ */
+bool displayPowerWake();
+
+/**
+ * @brief True in OFF / PANEL_SLEEP - LVGL must not run
+ */
+bool displayPowerPaused();
+
+/**
+ * @brief True while a shot or flush runs with the display paused (headless)
+ */
+bool displayPowerHeadless();
+
+/**
+ * @brief Current state
+ */
+DisplayPowerState displayPowerState();
+
+/**
+ * @brief State, idle time and transition counts
+ */
+void displayPowerDump(Print &out);
+
+#endif // DISPLAY_POWER_H
@@ -0,0 +1,90 @@
+// =============================================================================
+// Display Transport Implementation (AXS15231B)
+// =============================================================================
+
+#include "display_transport.h"
+#include "AXS15231B.h"
+#include "crash_ring.h"
+#include "watchdog.h"
+
+// Landscape x maps to native y and landscape y maps to native x mirrored, so map
+// to native, let the panel driver apply its window granularity, then map back
+static void axsRound(lv_area_t *area)
+{
+  uint16_t nx1 = static_cast<uint16_t>(EXAMPLE_LCD_H_RES - 1 - area->y2);
+  uint16_t nx2 = static_cast<uint16_t>(EXAMPLE_LCD_H_RES - 1 - area->y1);
+  uint16_t ny1 = static_cast<uint16_t>(area->x1);
+  uint16_t ny2 = static_cast<uint16_t>(area->x2);
+
+  lcd_round_window(&nx1, &ny1, &nx2, &ny2);
+
+  area->x1 = ny1;
+  area->x2 = ny2;
+  area->y1 = EXAMPLE_LCD_H_RES - 1 - nx2;
+  area->y2 = EXAMPLE_LCD_H_RES - 1 - nx1;
+}
+
+static void axsBlit(const lv_area_t *area, const lv_color_t *px)
+{
+  lcd_PushColorsLandscapeSync(area->x1, area->y1, lv_area_get_width(area), lv_area_get_height(area),
+                              (const uint16_t *)&px->full);
+}
+
+static void axsPower(bool on)
+{
+  if (on)
+    lcd_wake();
+  else
+    lcd_sleep();
+}
+
+#if GS_DISPLAY_TRANSPORT == 0
+
+// Non-blocking: queued for the bounce task, lv_disp_flush_ready() comes from the
+// SPI post-callback after the last chunk
+static void dmaSubmit(const lv_area_t *area, const lv_color_t *px)
+{
+  lcd_PushColorsLandscape(area->x1, area->y1, lv_area_get_width(area), lv_area_get_height(area),
+                          (uint16_t *)&px->full);
+}
+
+static const DisplayTransport TRANSPORT = {
+  "AXS15231B QSPI DMA", axs15231_init, lcd_attach_disp_drv, axsRound, dmaSubmit, get_lcd_spi_dma_write, axsPower,
+  axsBlit,
+};
+
+#else
+
+static lv_disp_drv_t *pollingDrv = NULL;
+
+static void pollingAttach(lv_disp_drv_t *drv)
+{
+  pollingDrv = drv;
+}
+
+static void pollingSubmit(const lv_area_t *area, const lv_color_t *px)
+{
+  lcd_PushColorsLandscapeSync(area->x1, area->y1, lv_area_get_width(area), lv_area_get_height(area),
+                              (const uint16_t *)&px->full);
+  crashRingRecord(CRASH_EV_FLUSH_END);
+  watchdogIdle(WATCHDOG_DMA);
+  if (pollingDrv != NULL)
+    lv_disp_flush_ready(pollingDrv);
+}
+
+static bool pollingBusy()
+{
+  return false;
+}
+
+static const DisplayTransport TRANSPORT = {
+  "AXS15231B QSPI polling", axs15231_init, pollingAttach, axsRound, pollingSubmit, pollingBusy, axsPower,
+  axsBlit,
+};
+
+#endif
+
+const DisplayTransport &displayTransport()
+{
+  return TRANSPORT;
+}
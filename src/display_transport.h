@@ -0,0 +1,61 @@
+#ifndef DISPLAY_TRANSPORT_H
+#define DISPLAY_TRANSPORT_H
+
+// =============================================================================
+// Display Transport (panel behind the LVGL flush)
+// =============================================================================
+// Everything between a rendered LVGL area and the panel glass, as one table
+// of functions. my_disp_flush() and the display setup only talk to this
+// interface, so the render pipeline can target another panel or bus (a new
+// table) or a host window, without forking the app.
+//
+//   init      panel up, backlight untouched (setup, before LVGL)
+//   attach    driver whose flushes the transport completes with
+//             lv_disp_flush_ready()
+//   round     landscape area to the panel's window granularity (rounder_cb)
+//   submit    one rendered landscape area (UI_HOR_RES x UI_VER_RES layout);
+//             complete once its pixels are out - at once, or later from the
+//             transport's own context
+//   busy      a submitted area is still going out
+//   power     panel sleep (false) / wake (true), nothing in flight
+//   blit      one landscape area on the glass when it returns, no driver
+//             involved - for the boot splash before LVGL exists (NULL = none)
+//
+// Firmware transports (GS_DISPLAY_TRANSPORT, compile-time):
+//   0 - AXS15231B over QSPI DMA: bounce-buffer rotation, completed from the
+//       DMA post-callback (default)
+//   1 - AXS15231B over QSPI, polling transmits: submit() returns once the
+//       area is on the glass. No queue, no completion ISR - for bring-up and
+//       for bisecting DMA problems
+//
+// The host tool tools/ui_bench builds its own tables on the same struct: a
+// headless one (pixel counts only) and an SDL window (UI_BENCH_SDL).
+//
+// Thread Safety:
+//   init / attach from setup(); round / submit / busy from the LVGL owner
+//   (UI task); power from the display power state machine (UI task).
+// =============================================================================
+
+#include "lvgl.h"
+
+#ifndef GS_DISPLAY_TRANSPORT
+#define GS_DISPLAY_TRANSPORT 0
+#endif
+
+struct DisplayTransport {
+  const char *name;
+  void (*init)();
+  void (*attach)(lv_disp_drv_t *drv);
+  void (*round)(lv_area_t *area);
+  void (*submit)(const lv_area_t *area, const lv_color_t *px);
+  bool (*busy)();
+  void (*power)(bool on);
+  void (*blit)(const lv_area_t *area, const lv_color_t *px);
+};
+
+/**
+ * @brief The transport this build drives the panel with (GS_DISPLAY_TRANSPORT)
+ */
+const DisplayTransport &displayTransport();
+
+#endif // DISPLAY_TRANSPORT_H
@@ -0,0 +1,376 @@
+// =============================================================================
+// ESP32-S3 Blend Backend Implementation
+// =============================================================================
+
+#include "draw_s3.h"
+#include "metrics.h"
+#include "mem_fast.h"
+#include "glyph_tiles.h"
+#include "iram_placement.h"
+#include "task_layout.h"
+#include "debug_config.h"
+#include "draw/sw/lv_draw_sw.h"
+#include "core/lv_refr.h"
+
+#define DRAW_S3_ACTIVE (GS_DRAW_S3 && LV_COLOR_DEPTH == 16 && LV_COLOR_16_SWAP && !LV_COLOR_SCREEN_TRANSP)
+#if DRAW_S3_ACTIVE && GS_DRAW_SPLIT && !defined(CONFIG_FREERTOS_UNICORE)
+#define DRAW_S3_SPLIT_ACTIVE 1
+#else
+#define DRAW_S3_SPLIT_ACTIVE 0
+#endif
+
+static constexpr LogTag TAG = LOG_TAG_UI;
+
+static volatile uint32_t fillPx = 0;
+static volatile uint32_t copyPx = 0;
+static volatile uint32_t mixPx = 0;
+static volatile uint32_t maskPx = 0;
+static volatile uint32_t fallbackCalls = 0;
+static volatile uint32_t splitCalls = 0;
+static volatile uint32_t helperPx = 0;   // Written by the helper task only
+static volatile uint32_t joinWaits = 0;
+
+static MetricCounterRef fillPxTotal("draw_s3_fill_px_total", "Solid fill pixels (PIE stores)", &fillPx);
+static MetricCounterRef copyPxTotal("draw_s3_copy_px_total", "Image copy pixels (PIE / memcpy rows)", &copyPx);
+static MetricCounterRef mixPxTotal("draw_s3_mix_px_total", "Opacity fill / copy pixels (SWAR mix)", &mixPx);
+static MetricCounterRef maskPxTotal("draw_s3_mask_px_total", "Masked fill / copy pixels (SWAR mix per mask value)", &maskPx);
+static MetricCounterRef fallbackTotal("draw_s3_fallback_total", "Blends left to LVGL (blend mode, set_px_cb)", &fallbackCalls);
+static MetricCounterRef splitTotal("draw_s3_split_total", "Blends sliced across both cores", &splitCalls);
+static MetricCounterRef helperPxTotal("draw_s3_helper_px_total", "Pixels the Core 0 helper drew", &helperPx);
+static MetricCounterRef joinWaitTotal("draw_s3_join_wait_total", "Split blends the UI task blocked on the helper's slice", &joinWaits);
+
+#if DRAW_S3_ACTIVE
+
+static constexpr uint32_t SWAR_MASK = 0x07E0F81F;  // -----GGGGGG-----RRRRR------BBBBB
+
+// Native RGB565 (byte-swapped in the buffer) spread so each channel has headroom for a * 32
+static inline uint32_t spread(uint16_t swapped)
+{
+  uint32_t c = __builtin_bswap16(swapped);
+  return (c | (c << 16)) & SWAR_MASK;
+}
+
+static inline uint16_t pack(uint32_t spreadSum)
+{
+  uint32_t c = (spreadSum >> 5) & SWAR_MASK;
+  return __builtin_bswap16((uint16_t)(c | (c >> 16)));
+}
+
+static void GS_HOT_IRAM mixFillRow(uint16_t *dst, uint32_t fgScaled, uint32_t invA, int32_t n)
+{
+  uint16_t lastIn = ~dst[0];
+  uint16_t lastOut = 0;
+  for (int32_t x = 0; x < n; x++) {
+    uint16_t bg = dst[x];
+    if (bg != lastIn) {  // Flat backgrounds: one mix per run, as lv_draw_sw does
+      lastIn = bg;
+      lastOut = pack(fgScaled + spread(bg) * invA);
+    }
+    dst[x] = lastOut;
+  }
+}
+
+static void GS_HOT_IRAM mixCopyRow(uint16_t *dst, const uint16_t *src, uint32_t a, int32_t n)
+{
+  const uint32_t invA = 32 - a;
+  for (int32_t x = 0; x < n; x++)
+    dst[x] = pack(spread(src[x]) * a + spread(dst[x]) * invA);
+}
+
+// Mask value (already scaled by the blend opacity) to mix weight: 0 keeps the pixel, 32 is the colour
+static inline uint32_t maskWeight(lv_opa_t m, lv_opa_t opa)
+{
+  uint32_t v = (opa >= LV_OPA_MAX) ? m : ((uint32_t)m * opa) >> 8;
+  return (v + 4) >> 3;
+}
+
+// Anti-aliased edges and glyphs: the swapped-order lv_color_mix() LVGL would run
+// here splits green and divides by 255 per channel, three times a pixel
+static void GS_HOT_IRAM maskFillRow(uint16_t *dst, uint16_t color, uint32_t fgSpread, const lv_opa_t *mask,
+                                    lv_opa_t opa, int32_t n)
+{
+  for (int32_t x = 0; x < n; x++) {
+    uint32_t a = maskWeight(mask[x], opa);
+    if (a == 0)
+      continue;
+    dst[x] = (a >= 32) ? color : pack(fgSpread * a + spread(dst[x]) * (32 - a));
+  }
+}
+
+static void GS_HOT_IRAM maskCopyRow(uint16_t *dst, const uint16_t *src, const lv_opa_t *mask, lv_opa_t opa, int32_t n)
+{
+  for (int32_t x = 0; x < n; x++) {
+    uint32_t a = maskWeight(mask[x], opa);
+    if (a == 0)
+      continue;
+    dst[x] = (a >= 32) ? src[x] : pack(spread(src[x]) * a + spread(dst[x]) * (32 - a));
+  }
+}
+
+enum BlendKind : uint8_t {
+  BLEND_FILL,          // memFastFill16()
+  BLEND_MIX_FILL,
+  BLEND_COPY,          // memFastCopy()
+  BLEND_MIX_COPY,
+  BLEND_MASK_FILL,
+  BLEND_MASK_COPY,
+};
+
+// One blend after clipping: rows 0 .. h - 1 from dst / src / mask on
+struct BlendJob {
+  BlendKind kind;
+  uint16_t *dst;
+  const uint16_t *src;       // NULL for fills (srcStride 0)
+  const lv_opa_t *mask;      // NULL without a mask (maskStride 0)
+  int32_t destStride;
+  int32_t srcStride;
+  int32_t maskStride;
+  int32_t w;
+  int32_t h;
+  uint16_t color;
+  uint32_t fg;               // spread(color), times a for BLEND_MIX_FILL
+  uint32_t a;                // Mix weight 0-32 (BLEND_MIX_*)
+  lv_opa_t opa;              // Blend opacity (BLEND_MASK_*)
+};
+
+static void GS_HOT_IRAM blendRows(const BlendJob &job, int32_t y0, int32_t y1)
+{
+  uint16_t *dst = job.dst + job.destStride * y0;
+  const uint16_t *src = job.src + job.srcStride * y0;
+  const lv_opa_t *mask = job.mask + job.maskStride * y0;
+  for (int32_t y = y0; y < y1; y++, dst += job.destStride, src += job.srcStride, mask += job.maskStride) {
+    switch (job.kind) {
+    case BLEND_FILL:      memFastFill16(dst, job.color, job.w); break;
+    case BLEND_MIX_FILL:  mixFillRow(dst, job.fg, 32 - job.a, job.w); break;
+    case BLEND_COPY:      memFastCopy(dst, src, (size_t)job.w * sizeof(uint16_t)); break;
+    case BLEND_MIX_COPY:  mixCopyRow(dst, src, job.a, job.w); break;
+    case BLEND_MASK_FILL: maskFillRow(dst, job.color, job.fg, mask, job.opa, job.w); break;
+    case BLEND_MASK_COPY: maskCopyRow(dst, src, mask, job.opa, job.w); break;
+    }
+  }
+}
+
+#if DRAW_S3_SPLIT_ACTIVE
+
+// The job being split. Written by the UI task only while every slice of the
+// previous one is done; claimWord publishes it:
+//   generation (16) | slice count (8) | next unclaimed slice (8)
+// A helper that loaded the word of an older job fails its compare-exchange,
+// so it never runs a slice on parameters that are not its own.
+static BlendJob splitJob;
+static volatile uint32_t claimWord = 0;
+static volatile uint32_t slicesDone = 0;
+static TaskHandle_t helperTask = NULL;
+static TaskHandle_t volatile joinTask = NULL;   // The UI task, woken by the helper's last slice
+
+static bool GS_HOT_IRAM claimSlice(uint32_t *slice, uint32_t *count)
+{
+  uint32_t w = __atomic_load_n(&claimWord, __ATOMIC_ACQUIRE);
+  while ((w & 0xFF) < ((w >> 8) & 0xFF)) {
+    if (__atomic_compare_exchange_n(&claimWord, &w, w + 1, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+      *slice = w & 0xFF;
+      *count = (w >> 8) & 0xFF;
+      return true;
+    }
+  }
+  return false;
+}
+
+// Claim and run slices until none is left; returns the pixels this caller drew
+static uint32_t GS_HOT_IRAM runSlices()
+{
+  uint32_t drawn = 0;
+  uint32_t slice, count;
+  while (claimSlice(&slice, &count)) {
+    const int32_t y0 = splitJob.h * (int32_t)slice / (int32_t)count;
+    const int32_t y1 = splitJob.h * (int32_t)(slice + 1) / (int32_t)count;
+    blendRows(splitJob, y0, y1);
+    drawn += (uint32_t)(splitJob.w * (y1 - y0));
+    if (__atomic_add_fetch(&slicesDone, 1, __ATOMIC_RELEASE) == count && xTaskGetCurrentTaskHandle() == helperTask)
+      xTaskNotifyGive(joinTask);   // May land after the join saw the count - the UI loop takes stray wakes
+  }
+  return drawn;
+}
+
+static void drawHelperTask(void *)
+{
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    helperPx += runSlices();
+  }
+}
+
+// Worth a cross-core hand-off: the SWAR paths at a few cycles a pixel, big
+// enough to bury the notify. Solid fills and plain copies run at memory speed
+// and stay on one core.
+static bool splittable(const BlendJob &job)
+{
+  return helperTask != NULL && job.kind != BLEND_FILL && job.kind != BLEND_COPY && job.h >= 2 &&
+         (uint32_t)(job.w * job.h) >= DRAW_S3_SPLIT_MIN_PX;
+}
+
+static void GS_HOT_IRAM blendSplit(const BlendJob &job)
+{
+  static uint32_t generation = 0;
+  const uint32_t count = (job.h < (int32_t)DRAW_S3_SPLIT_SLICES) ? (uint32_t)job.h : DRAW_S3_SPLIT_SLICES;
+  splitJob = job;
+  slicesDone = 0;
+  joinTask = xTaskGetCurrentTaskHandle();
+  generation = (generation + 1) & 0xFFFF;
+  __atomic_store_n(&claimWord, (generation << 16) | (count << 8), __ATOMIC_RELEASE);
+  xTaskNotifyGive(helperTask);
+
+  runSlices();
+  splitCalls++;
+  // Joined here, before LVGL draws over these rows again: at most the slice
+  // the helper has already started is still running. A slice is not
+  // idempotent (mixes read dst), so it is waited for, not redrawn. Block
+  // instead of spinning - control or BLE may have pre-empted the helper mid-
+  // slice - and lend it the UI task's priority after the first tick so BLE
+  // can't keep it off the CPU while Core 1 waits.
+  if (__atomic_load_n(&slicesDone, __ATOMIC_ACQUIRE) >= count)
+    return;
+  joinWaits++;
+  const UBaseType_t helperPriority = uxTaskPriorityGet(helperTask);
+  const UBaseType_t joinPriority = uxTaskPriorityGet(NULL);
+  bool lent = false;
+  bool took = false;
+  while (__atomic_load_n(&slicesDone, __ATOMIC_ACQUIRE) < count) {
+    if (ulTaskNotifyTake(pdFALSE, DRAW_S3_JOIN_WAIT_TICKS) != 0) {
+      took = true;
+    } else if (!lent && joinPriority > helperPriority) {
+      vTaskPrioritySet(helperTask, joinPriority);
+      lent = true;
+    }
+  }
+  if (lent)
+    vTaskPrioritySet(helperTask, helperPriority);
+  // The take may have eaten a flush-done or channel wake meant for the UI
+  // loop: hand one back, a spare wake only costs a loop pass
+  if (took)
+    xTaskNotifyGive(joinTask);
+}
+
+#endif // DRAW_S3_SPLIT_ACTIVE
+
+static void GS_HOT_IRAM blend(lv_draw_ctx_t *draw_ctx, const lv_draw_sw_blend_dsc_t *dsc)
+{
+  lv_disp_t *disp = _lv_refr_get_disp_refreshing();
+  if (dsc->blend_mode != LV_BLEND_MODE_NORMAL || disp->driver->set_px_cb != NULL) {
+    fallbackCalls++;
+    lv_draw_sw_blend_basic(draw_ctx, dsc);
+    return;
+  }
+  const lv_opa_t *mask = NULL;
+  if (dsc->mask_buf != NULL) {
+    if (dsc->mask_res == LV_DRAW_MASK_RES_TRANSP)
+      return;
+    if (dsc->mask_res != LV_DRAW_MASK_RES_FULL_COVER)
+      mask = dsc->mask_buf;
+  }
+
+  lv_area_t area;
+  if (!_lv_area_intersect(&area, dsc->blend_area, draw_ctx->clip_area))
+    return;
+
+  BlendJob job;
+  job.destStride = lv_area_get_width(draw_ctx->buf_area);
+  job.w = lv_area_get_width(&area);
+  job.h = lv_area_get_height(&area);
+  job.dst = (uint16_t *)draw_ctx->buf + job.destStride * (area.y1 - draw_ctx->buf_area->y1) +
+            (area.x1 - draw_ctx->buf_area->x1);
+  job.src = NULL;
+  job.srcStride = 0;
+  job.mask = NULL;
+  job.maskStride = 0;
+  job.color = dsc->color.full;
+  job.opa = dsc->opa;
+  job.a = (dsc->opa + 4) >> 3;
+  job.fg = spread(job.color);
+  const uint32_t px = (uint32_t)(job.w * job.h);
+
+  if (dsc->src_buf != NULL) {
+    job.srcStride = lv_area_get_width(dsc->blend_area);
+    job.src = (const uint16_t *)dsc->src_buf + job.srcStride * (area.y1 - dsc->blend_area->y1) +
+              (area.x1 - dsc->blend_area->x1);
+  }
+
+  if (mask != NULL) {
+    // Same mask offset as lv_draw_sw_blend_basic() (zero for LVGL's own callers)
+    job.maskStride = lv_area_get_width(dsc->mask_area);
+    job.mask = mask + job.maskStride * (dsc->mask_area->y1 - area.y1) + (dsc->mask_area->x1 - area.x1);
+    job.kind = (job.src == NULL) ? BLEND_MASK_FILL : BLEND_MASK_COPY;
+    maskPx += px;
+  } else if (job.src == NULL && dsc->opa >= LV_OPA_MAX) {
+    job.kind = BLEND_FILL;
+    fillPx += px;
+  } else if (job.src == NULL) {
+    job.kind = BLEND_MIX_FILL;
+    job.fg *= job.a;
+    mixPx += px;
+  } else if (dsc->opa >= LV_OPA_MAX) {
+    job.kind = BLEND_COPY;
+    copyPx += px;
+  } else {
+    job.kind = BLEND_MIX_COPY;
+    mixPx += px;
+  }
+
+#if DRAW_S3_SPLIT_ACTIVE
+  if (splittable(job)) {
+    blendSplit(job);
+    return;
+  }
+#endif
+  blendRows(job, 0, job.h);
+}
+
+static void initCtx(lv_disp_drv_t *drv, lv_draw_ctx_t *draw_ctx)
+{
+  lv_draw_sw_init_ctx(drv, draw_ctx);
+  ((lv_draw_sw_ctx_t *)draw_ctx)->blend = blend;
+  glyphTilesInstall(draw_ctx);  // Value digits as pre-blended tiles
+}
+
+#endif // DRAW_S3_ACTIVE
+
+lv_color_t drawS3MixPx(lv_color_t fg, lv_color_t bg, lv_opa_t opa)
+{
+#if DRAW_S3_ACTIVE
+  uint32_t a = maskWeight(opa, LV_OPA_COVER);
+  if (a == 0)
+    return bg;
+  if (a >= 32)
+    return fg;
+  lv_color_t c;
+  c.full = pack(spread(fg.full) * a + spread(bg.full) * (32 - a));
+  return c;
+#else
+  return (opa == LV_OPA_COVER) ? fg : lv_color_mix(fg, bg, opa);
+#endif
+}
+
+void drawS3Begin(lv_disp_drv_t *drv)
+{
+#if DRAW_S3_ACTIVE
+  drv->draw_ctx_init = initCtx;
+  drv->draw_ctx_size = sizeof(lv_draw_sw_ctx_t);
+#if DRAW_S3_SPLIT_ACTIVE
+  if (helperTask == NULL && taskLayoutSpawn(TASK_ROLE_DRAW_HELPER, drawHelperTask, NULL, &helperTask) != pdPASS) {
+    helperTask = NULL;
+    LOG_WARN(TAG, "⚠️  No draw helper task - blends stay on Core 1");
+  }
+#endif
+#else
+  (void)drv;
+#endif
+}
+
+void drawS3Dump(Print &out)
+{
+  out.printf("[Draw] %s blend: %lu fill px, %lu copy px, %lu mix px, %lu mask px, %lu blends to LVGL\n",
+             DRAW_S3_ACTIVE ? "S3" : "LVGL C", (unsigned long)fillPx, (unsigned long)copyPx,
+             (unsigned long)mixPx, (unsigned long)maskPx, (unsigned long)fallbackCalls);
+  out.printf("  %lu blends split across cores, %lu px drawn by the Core 0 helper%s\n", (unsigned long)splitCalls,
+             (unsigned long)helperPx, DRAW_S3_SPLIT_ACTIVE ? "" : " (off)");
+}
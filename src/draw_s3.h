@@ -0,0 +1,98 @@
+#ifndef DRAW_S3_H
+#define DRAW_S3_H
+
+// =============================================================================
+// ESP32-S3 Blend Backend for LVGL (RGB565, byte-swapped)
+// =============================================================================
+// Replaces lv_draw_sw_blend_basic() through the draw_ctx override:
+// drawS3Begin() installs a draw_ctx_init that runs lv_draw_sw_init_ctx() and
+// then points lv_draw_sw_ctx_t::blend at the fast paths below. Everything
+// else LVGL draws (text, arcs, gradients, images) still ends in this blend
+// call, so it is where Core 1 spends its render time.
+//
+//   solid fill, no mask     memFastFill16(): PIE 128-bit stores of a
+//                           broadcast colour (mem_fast.h)
+//   image copy, no mask     memFastCopy(): PIE ee.vld / ee.vst pairs when
+//                           source and destination share their 16-byte phase
+//   opacity fill / copy     32-bit SWAR: one pixel's three channels with one
+//                           multiply (the S3 PIE has no 565 lane shuffle, so
+//                           unpacking to vector lanes costs more than it saves)
+//   masked fill / copy      the same SWAR mix per mask value (anti-aliased
+//                           edges, glyphs, rounded corners)
+//   blend modes             lv_draw_sw_blend_basic() (additive / subtractive)
+//
+// The buffer holds byte-swapped RGB565 (LV_COLOR_16_SWAP 1: the SquareLine
+// export requires it and its image arrays are stored that way). For that
+// order, LVGL's lv_color_mix() takes its slow path, which splits green across
+// the two bytes and does a divide by 255 per channel. The SWAR form LVGL uses
+// for native order only needs one bswap16 on each side of the multiply, so
+// masked blends come here instead of going to LVGL.
+//
+// The same context init installs the digit tiles (glyph_tiles.h) as its
+// draw_letter.
+//
+// The SWAR mix quantises opacity to 33 steps (opa / 8), about one LSB per
+// channel away from lv_color_mix() - the same steps as LVGL's own native-order
+// mix. drawS3MixPx() is that mix for one pixel (digit tiles are built with it).
+//
+// Both cores: Core 0 only runs the BLE host and the shot control task, which
+// block on the radio and on samples most of the time. Big SWAR blends
+// (opacity and masked fills / copies of DRAW_S3_SPLIT_MIN_PX or more) are cut
+// into up to DRAW_S3_SPLIT_SLICES row slices. The "DrawHelper" task on Core 0,
+// below BLE and control, and the UI task claim slices from the same counter;
+// the UI task joins before the blend returns, so LVGL never sees a half-drawn
+// area and its object tree stays on Core 1. A helper that control or BLE
+// keeps off the CPU simply claims nothing - the UI task draws its slices
+// itself and only ever waits for a slice the helper has started. That wait
+// blocks on a task notification from the helper's last slice; after
+// DRAW_S3_JOIN_WAIT_TICKS the helper runs at the UI task's priority until
+// the join (draw_s3_join_wait_total counts the blocked joins). Solid fills
+// and full-opacity copies run at memory speed and are not split.
+//
+// GS_DRAW_S3 (compile-time, -DGS_DRAW_S3=0): keep LVGL's C blend, for A/B
+// render-time runs with GS_DISPLAY_BENCH (display_bench.h). Default 1. Colour
+// formats other than swapped RGB565 always use the C blend; on other targets
+// the rows fall back to memcpy / word stores. Pixels per path are
+// draw_s3_*_px_total metrics and on "display".
+//
+// GS_DRAW_SPLIT (compile-time, -DGS_DRAW_SPLIT=0): 1 = split big blends
+// across both cores (default), 0 = every blend on the UI task.
+//
+// Thread Safety:
+//   drawS3Begin() in setup() before lv_disp_drv_register(); the blend runs
+//   wherever LVGL renders (UI task, Core 1). Slices on the helper touch pixel
+//   memory only, and only between the hand-off and the join.
+// =============================================================================
+
+#include <Arduino.h>
+#include "lvgl.h"
+
+#ifndef GS_DRAW_S3
+#define GS_DRAW_S3 1
+#endif
+
+#ifndef GS_DRAW_SPLIT
+#define GS_DRAW_SPLIT 1
+#endif
+
+constexpr uint32_t DRAW_S3_SPLIT_MIN_PX = 4096;   // ~6 full-width rows; below it the hand-off costs more than it saves
+constexpr uint32_t DRAW_S3_SPLIT_SLICES = 8;      // Short slices: the join waits for one helper slice at most
+constexpr TickType_t DRAW_S3_JOIN_WAIT_TICKS = 1;  // Join blocked this long: lend the helper the UI task's priority
+
+/**
+ * @brief Point the driver's draw context at the S3 blend and start the Core 0 helper (no-op when disabled)
+ * @param drv Display driver, after lv_disp_drv_init()
+ */
+void drawS3Begin(lv_disp_drv_t *drv);
+
+/**
+ * @brief The masked blend's mix for one pixel (lv_color_mix() when the S3 blend is off)
+ */
+lv_color_t drawS3MixPx(lv_color_t fg, lv_color_t bg, lv_opa_t opa);
+
+/**
+ * @brief Pixels drawn per path since boot
+ */
+void drawS3Dump(Print &out);
+
+#endif // DRAW_S3_H
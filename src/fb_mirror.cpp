@@ -0,0 +1,244 @@
+// =============================================================================
+// Remote Screen Mirror Implementation
+// =============================================================================
+
+#include "fb_mirror.h"
+#include "debug_config.h"
+#include "mem_caps.h"
+#include "metrics.h"
+#include "pins_config.h"
+#include "wifi_coex.h"
+
+#if defined(WIRELESS_DEBUG) && GS_FB_MIRROR
+
+#include <ESPAsyncWebServer.h>
+
+static constexpr LogTag TAG = LOG_TAG_WIFI;
+static constexpr uint32_t CLEANUP_MS = 1000;   // Closed clients released this often
+static constexpr uint32_t DIRTY_WORDS = (UI_VER_RES + 31) / 32;
+static constexpr size_t ROW_BYTES = UI_HOR_RES * sizeof(uint16_t);
+
+static_assert(sizeof(lv_color_t) == sizeof(uint16_t), "The mirror sends RGB565");
+static_assert(FB_MIRROR_MESSAGE_BYTES >= sizeof(FbMirrorHeader) + sizeof(FbMirrorRow) + ROW_BYTES,
+              "A message must hold at least one raw row");
+
+static AsyncWebSocket socket(FB_MIRROR_PATH);
+static volatile uint32_t clients = 0;    // async_tcp task writes
+static volatile uint32_t connects = 0;   // async_tcp task writes, UI task compares
+
+// UI task only
+static uint16_t *shadow = NULL;          // What the panel shows, PSRAM
+static uint8_t *message = NULL;          // One outgoing message, PSRAM
+static bool capturing = false;
+static bool frameDone = false;           // A refresh completed since the last send
+static bool resync = false;
+static uint32_t seenConnects = 0;
+static uint32_t dirty[DIRTY_WORDS];      // Rows flushed and not sent yet
+static uint32_t sentHash[UI_VER_RES];    // Hash of each row as last sent
+static uint32_t sentValid[DIRTY_WORDS];  // Rows the clients have
+static uint16_t frameSeq = 0;
+static uint32_t lastSendMs = 0;
+static uint32_t lastCleanupMs = 0;
+
+static volatile uint32_t messages = 0;
+static volatile uint32_t bytesSent = 0;
+static volatile uint32_t rowsSent = 0;
+static volatile uint32_t rowsSkipped = 0;
+static volatile uint32_t busySkips = 0;
+
+static MetricCounterRef messagesTotal("fb_mirror_messages_total", "Screen mirror WebSocket messages sent", &messages);
+static MetricCounterRef bytesTotal("fb_mirror_bytes_total", "Screen mirror bytes sent", &bytesSent);
+static MetricCounterRef rowsTotal("fb_mirror_rows_total", "Screen mirror rows sent", &rowsSent);
+static MetricCounterRef skippedTotal("fb_mirror_rows_unchanged_total", "Flushed rows equal to the sent ones - not sent", &rowsSkipped);
+static MetricCounterRef busyTotal("fb_mirror_busy_total", "Screen mirror sends deferred - a client's send queue was full", &busySkips);
+static MetricGauge clientsGauge("fb_mirror_clients", "Screen mirror WebSocket clients");
+
+static inline bool bit(const uint32_t *set, uint32_t y) { return (set[y >> 5] >> (y & 31)) & 1; }
+static inline void setBit(uint32_t *set, uint32_t y) { set[y >> 5] |= 1u << (y & 31); }
+static inline void clearBit(uint32_t *set, uint32_t y) { set[y >> 5] &= ~(1u << (y & 31)); }
+
+static void onEvent(AsyncWebSocket *server, AsyncWebSocketClient *client, AwsEventType type, void *arg,
+                    uint8_t *data, size_t len)
+{
+  (void)arg;
+  (void)data;
+  (void)len;
+  if (type == WS_EVT_CONNECT) {
+    LOG_INFO(TAG, "🖥️  Screen mirror client #%lu connected", (unsigned long)client->id());
+    connects = connects + 1;
+  } else if (type == WS_EVT_DISCONNECT) {
+    LOG_INFO(TAG, "🖥️  Screen mirror client #%lu left", (unsigned long)client->id());
+  } else {
+    return;
+  }
+  clients = server->count();
+  clientsGauge.set((int32_t)clients);
+}
+
+void fbMirrorRegister(AsyncWebServer &server)
+{
+  socket.onEvent(onEvent);
+  server.addHandler(&socket);
+  LOG_INFO(TAG, "Screen mirror: ws://<ip>%s", FB_MIRROR_PATH);
+}
+
+void fbMirrorCapture(const lv_area_t *area, const lv_color_t *pixels, bool last)
+{
+  if (!capturing)
+    return;
+  const int32_t w = area->x2 - area->x1 + 1;
+  const lv_color_t *src = pixels;
+  for (int32_t y = area->y1; y <= area->y2; y++, src += w) {
+    memcpy(shadow + (uint32_t)y * UI_HOR_RES + area->x1, src, (size_t)w * sizeof(uint16_t));
+    setBit(dirty, (uint32_t)y);
+  }
+  if (last)
+    frameDone = true;
+}
+
+// FNV-1a over the row's 32-bit words
+static uint32_t hashRow(const uint16_t *row)
+{
+  const uint32_t *words = (const uint32_t *)row;
+  uint32_t h = 2166136261u;
+  for (uint32_t i = 0; i < UI_HOR_RES / 2; i++)
+    h = (h ^ words[i]) * 16777619u;
+  return h;
+}
+
+// (count, pixel) pairs into out; 0 if they would not be shorter than the raw row
+static size_t encodeRle(const uint16_t *row, uint16_t *out)
+{
+  const size_t maxWords = UI_HOR_RES - 2;  // At least one pair shorter than raw
+  size_t words = 0;
+  for (uint32_t x = 0; x < UI_HOR_RES;) {
+    uint16_t px = row[x];
+    uint32_t run = 1;
+    while (x + run < UI_HOR_RES && row[x + run] == px)
+      run++;
+    if (words + 2 > maxWords)
+      return 0;
+    out[words++] = (uint16_t)run;
+    out[words++] = px;
+    x += run;
+  }
+  return words * sizeof(uint16_t);
+}
+
+static bool allocate()
+{
+  if (shadow == NULL)
+    shadow = (uint16_t *)memCapsAlloc(UI_HOR_RES * UI_VER_RES * sizeof(uint16_t), MEM_PSRAM, MEM_OWNER_MIRROR);
+  if (message == NULL)
+    message = (uint8_t *)memCapsAlloc(FB_MIRROR_MESSAGE_BYTES, MEM_PSRAM, MEM_OWNER_MIRROR);
+  return shadow != NULL && message != NULL;
+}
+
+// Rows that changed, as many as fit; true if some stay dirty
+static bool sendRows()
+{
+  uint8_t *out = message + sizeof(FbMirrorHeader);
+  const uint8_t *end = message + FB_MIRROR_MESSAGE_BYTES;
+  uint16_t rows = 0;
+  bool more = false;
+
+  for (uint32_t y = 0; y < UI_VER_RES; y++) {
+    if (!bit(dirty, y))
+      continue;
+    const uint16_t *row = shadow + y * UI_HOR_RES;
+    uint32_t h = hashRow(row);
+    if (bit(sentValid, y) && sentHash[y] == h) {
+      clearBit(dirty, y);
+      rowsSkipped++;
+      continue;
+    }
+    if (end - out < (ptrdiff_t)(sizeof(FbMirrorRow) + ROW_BYTES)) {
+      more = true;  // Next message; the row stays dirty
+      break;
+    }
+    FbMirrorRow entry = {(uint16_t)y, FB_MIRROR_RLE, 0, 0};
+    size_t bytes = encodeRle(row, (uint16_t *)(out + sizeof(entry)));
+    if (bytes == 0) {
+      entry.encoding = FB_MIRROR_RAW;
+      bytes = ROW_BYTES;
+      memcpy(out + sizeof(entry), row, bytes);
+    }
+    entry.bytes = (uint16_t)bytes;
+    memcpy(out, &entry, sizeof(entry));
+    out += sizeof(entry) + bytes;
+    rows++;
+
+    clearBit(dirty, y);
+    sentHash[y] = h;
+    setBit(sentValid, y);
+  }
+
+  if (rows == 0 && !resync)
+    return more;
+  uint8_t flags = (more ? FB_MIRROR_FLAG_PARTIAL : 0) | (resync ? FB_MIRROR_FLAG_RESYNC : 0);
+  FbMirrorHeader header = {FB_MIRROR_VERSION, flags, frameSeq, UI_HOR_RES, UI_VER_RES, rows, 0};
+  memcpy(message, &header, sizeof(header));
+  socket.binaryAll(message, out - message);
+  resync = false;
+  messages++;
+  bytesSent += (uint32_t)(out - message);
+  rowsSent += rows;
+  if (!more)
+    frameSeq++;
+  return more;
+}
+
+uint32_t fbMirrorPoll(uint32_t nowMs)
+{
+  if (nowMs - lastCleanupMs >= CLEANUP_MS) {
+    lastCleanupMs = nowMs;
+    socket.cleanupClients();
+  }
+
+  if (clients == 0) {
+    capturing = false;
+    return UINT32_MAX;
+  }
+  if (!capturing || connects != seenConnects) {
+    if (!allocate()) {
+      static bool warned = false;
+      if (!warned)
+        LOG_WARN(TAG, "⚠️  No PSRAM for the screen mirror");
+      warned = true;
+      capturing = false;
+      return UINT32_MAX;
+    }
+    // Everything again for the new client: one full refresh into the shadow
+    seenConnects = connects;
+    memset(sentValid, 0, sizeof(sentValid));
+    memset(dirty, 0, sizeof(dirty));
+    frameDone = false;
+    resync = true;
+    capturing = true;
+    lv_obj_invalidate(lv_scr_act());
+  }
+
+  uint32_t periodMs = wifiCoexQuiet() ? FB_MIRROR_QUIET_PERIOD_MS : FB_MIRROR_PERIOD_MS;
+  uint32_t elapsed = nowMs - lastSendMs;
+  if (elapsed < periodMs)
+    return periodMs - elapsed;
+  if (!frameDone)
+    return periodMs;  // The flush completion wakes this task anyway
+
+  if (!socket.availableForWriteAll()) {
+    busySkips++;  // Rows stay dirty: the viewer gets the newest pixels later
+    return periodMs;
+  }
+  lastSendMs = nowMs;
+  frameDone = sendRows();  // Rows left over go out next period
+  return periodMs;
+}
+
+void fbMirrorDump(Print &out)
+{
+  out.printf("[Screen mirror] ws://<ip>%s, %lu clients, %lu messages, %lu KB, %lu rows sent, %lu unchanged, %lu busy\n",
+             FB_MIRROR_PATH, (unsigned long)clients, (unsigned long)messages, (unsigned long)(bytesSent / 1024),
+             (unsigned long)rowsSent, (unsigned long)rowsSkipped, (unsigned long)busySkips);
+}
+
+#endif // WIRELESS_DEBUG && GS_FB_MIRROR
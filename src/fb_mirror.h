@@ -0,0 +1,127 @@
+#ifndef FB_MIRROR_H
+#define FB_MIRROR_H
+
+// =============================================================================
+// Remote Screen Mirror (WebSocket, changed rows only, RLE)
+// =============================================================================
+// Support sees what a unit on a customer's bar shows: ws://<ESP32-IP>/screen
+// pushes the rows of the screen that changed, as binary frames.
+//
+//   my_disp_flush()   fbMirrorCapture(): the flushed rows are copied into a
+//                     PSRAM shadow of the screen (UI_HOR_RES x UI_VER_RES) and
+//                     marked dirty; the last area of a refresh completes the
+//                     frame. Partial refresh needs nothing else - the shadow
+//                     always holds the whole screen.
+//   UI task           fbMirrorPoll(), at most every FB_MIRROR_PERIOD_MS and
+//                     only after a completed refresh: each dirty row is hashed,
+//                     rows that match what was last sent are skipped, the rest
+//                     go out run-length coded (or raw when that is shorter)
+//
+// One message:
+//
+//   FbMirrorHeader   12 bytes: version, flags, frame sequence, width, height,
+//                    row count
+//   per row          FbMirrorRow (y, encoding, payload bytes), then
+//                      FB_MIRROR_RAW  width pixels
+//                      FB_MIRROR_RLE  (count, pixel) uint16 pairs
+//
+// little-endian and packed; pixels are RGB565 in the draw buffer's order
+// (LV_COLOR_16_SWAP: high byte first). A message holds FB_MIRROR_MESSAGE_BYTES
+// at most - rows that do not fit stay dirty for the next one, and
+// FB_MIRROR_FLAG_PARTIAL says more of this frame follows. A new client makes
+// the UI task invalidate the screen once, so the next refresh captures (and
+// sends) every row. tools/screen_mirror/viewer.html draws the stream.
+//
+// Cost is bounded and only paid while someone watches: no client, no
+// capture and no buffers touched. With a client, one memcpy of each flushed
+// area into PSRAM and, at the capped rate, a hash of the dirty rows. The
+// shadow (225 KB PSRAM) and the message buffer are allocated when the first
+// client connects. While Wi-Fi is quiet for a shot (wifi_coex.h) the period
+// stretches to FB_MIRROR_QUIET_PERIOD_MS.
+//
+// GS_FB_MIRROR (compile-time, -DGS_FB_MIRROR=1): off by default. Needs the
+// WIRELESS_DEBUG server; otherwise every call is an inline no-op.
+//
+// Thread Safety:
+//   fbMirrorCapture() - flush_cb (UI task). fbMirrorPoll() - UI task.
+//   fbMirrorRegister() - setup. fbMirrorDump() - any task (plain counters).
+//   Client events run in the async_tcp task and only touch the client count.
+// =============================================================================
+
+#include <Arduino.h>
+#include "lvgl.h"
+
+class AsyncWebServer;
+
+#ifndef GS_FB_MIRROR
+#define GS_FB_MIRROR 0
+#endif
+
+constexpr uint32_t FB_MIRROR_PERIOD_MS       = 200;    // 5 frames/s at most
+constexpr uint32_t FB_MIRROR_QUIET_PERIOD_MS = 1000;   // While wifiCoexQuiet()
+constexpr size_t   FB_MIRROR_MESSAGE_BYTES   = 8192;   // AsyncWebSocket copies each message into internal RAM
+constexpr uint8_t  FB_MIRROR_VERSION         = 1;
+constexpr const char *FB_MIRROR_PATH         = "/screen";
+
+constexpr uint8_t FB_MIRROR_FLAG_PARTIAL = 1u << 0;    // More rows of this frame follow
+constexpr uint8_t FB_MIRROR_FLAG_RESYNC  = 1u << 1;    // First message after a (re)connect: clear the canvas
+
+enum FbMirrorEncoding : uint8_t {
+  FB_MIRROR_RAW = 0,
+  FB_MIRROR_RLE = 1,
+};
+
+struct __attribute__((packed)) FbMirrorHeader {
+  uint8_t version;      // FB_MIRROR_VERSION
+  uint8_t flags;        // FB_MIRROR_FLAG_*
+  uint16_t frame;       // Refresh sequence (wraps); messages of a partial frame share it
+  uint16_t width;
+  uint16_t height;
+  uint16_t rows;        // FbMirrorRow entries that follow
+  uint16_t reserved;
+};
+
+struct __attribute__((packed)) FbMirrorRow {
+  uint16_t y;
+  uint8_t encoding;     // FbMirrorEncoding
+  uint8_t reserved;
+  uint16_t bytes;       // Payload after this entry
+};
+
+static_assert(sizeof(FbMirrorHeader) == 12, "FbMirrorHeader is part of the WebSocket interface");
+static_assert(sizeof(FbMirrorRow) == 6, "FbMirrorRow is part of the WebSocket interface");
+
+#if defined(WIRELESS_DEBUG) && GS_FB_MIRROR
+
+/**
+ * @brief Add the WebSocket endpoint to `server` (before server.begin())
+ */
+void fbMirrorRegister(AsyncWebServer &server);
+
+/**
+ * @brief Copy a flushed area into the shadow (only while a client is connected)
+ * @param last lv_disp_flush_is_last(): the refresh is complete
+ */
+void fbMirrorCapture(const lv_area_t *area, const lv_color_t *pixels, bool last);
+
+/**
+ * @brief Send the changed rows if due
+ * @return ms until the next message is due (UINT32_MAX without clients)
+ */
+uint32_t fbMirrorPoll(uint32_t nowMs);
+
+/**
+ * @brief Clients, frames, bytes, skipped rows
+ */
+void fbMirrorDump(Print &out);
+
+#else
+
+inline void fbMirrorRegister(AsyncWebServer &) {}
+inline void fbMirrorCapture(const lv_area_t *, const lv_color_t *, bool) {}
+inline uint32_t fbMirrorPoll(uint32_t) { return UINT32_MAX; }
+inline void fbMirrorDump(Print &) {}
+
+#endif
+
+#endif // FB_MIRROR_H
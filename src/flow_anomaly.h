@@ -0,0 +1,157 @@
+#ifndef FLOW_ANOMALY_H
+#define FLOW_ANOMALY_H
+
+// =============================================================================
+// Channeling / Choke Detector for Gravimetric Shots
+// =============================================================================
+// The trend line extrapolates whatever flow it sees, so a channeling shot (a
+// sudden flow surge) stops on a bad prediction and a choked one (hardly any
+// flow) only ends at MAX_SHOT_DURATION_S. This watches the filtered flow
+// (WeightFilter) per sample, O(1), and flags both:
+//
+//   - Channeling: upper CUSUM of the flow over its running mean,
+//     S+ = max(0, S+ + (flow - mean - CHANNEL_DRIFT_GPS) * dt), in grams of
+//     excess. It alarms at CHANNEL_EXCESS_G if the flow also rose at least
+//     CHANNEL_RISE_GPS2 somewhere in that run - a surge, not the slow
+//     speed-up of an eroding puck. The mean (EWMA, ANOMALY_MEAN_TAU_S) is
+//     frozen while S+ is positive, so the surge does not raise its own
+//     reference.
+//     Watched from ANOMALY_SETTLE_S after the flow onset (flow_onset.h), once
+//     the ramp into steady flow is over.
+//   - Choked: lower CUSUM of the flow under CHOKE_FLOW_GPS from the first
+//     drip on, S- = max(0, S- + (CHOKE_FLOW_GPS - flow) * dt); alarm at
+//     CHOKE_DEFICIT_G. Also choked: no drip at all CHOKE_NO_DRIP_S after
+//     pump-on.
+//
+// Flags are sticky for the shot; anomalyS() is when the first one was
+// raised. The firmware shows them on the status line, stores them with the
+// shot (shot_log.h) and, built with -DGS_ANOMALY_STOP=1, stops the shot.
+//
+// Not thread safe - keep each instance on one task (the shot control task).
+// =============================================================================
+
+#include <Arduino.h>
+#include "flow_onset.h"
+
+#ifndef GS_ANOMALY_STOP
+#define GS_ANOMALY_STOP 0      // 1 = stop the shot when an anomaly is flagged
+#endif
+
+constexpr float ANOMALY_SETTLE_S     = 3.0f;   // Channel watch starts this long after the onset
+constexpr float ANOMALY_MEAN_TAU_S   = 3.0f;   // Running mean flow time constant
+constexpr float CHANNEL_DRIFT_GPS    = 0.4f;   // Flow above the mean that is still normal
+constexpr float CHANNEL_EXCESS_G     = 1.0f;   // CUSUM decision level (g of excess flow)
+constexpr float CHANNEL_RISE_GPS2    = 1.0f;   // Flow rise (g/s per s) that makes it a surge
+constexpr float CHOKE_FLOW_GPS       = 0.5f;   // Flow below this counts as choked
+constexpr float CHOKE_DEFICIT_G      = 2.0f;   // CUSUM decision level (g of missing flow)
+constexpr float CHOKE_NO_DRIP_S      = 20.0f;  // No drip by then = choked
+
+// FlowAnomaly::flags()
+constexpr uint8_t FLOW_ANOMALY_CHANNELING = 1u << 0;
+constexpr uint8_t FLOW_ANOMALY_CHOKED     = 1u << 1;
+
+class FlowAnomaly {
+public:
+  FlowAnomaly() { reset(); }
+
+  void reset()
+  {
+    lastT = -1.0f;
+    lastFlow = 0.0f;
+    mean = 0.0f;
+    upper = 0.0f;
+    runRise = 0.0f;
+    lower = 0.0f;
+    raised = 0;
+    raisedS = -1.0f;
+  }
+
+  /**
+   * @brief One sample at shot time t (s): filtered flow after it, onset state after it
+   * @return Flags raised by this sample (0 almost always)
+   */
+  uint8_t add(float t, float flowGps, const FlowOnset &onset)
+  {
+    float dt = (lastT >= 0.0f) ? t - lastT : 0.0f;
+    float rise = (dt > 0.0f) ? (flowGps - lastFlow) / dt : 0.0f;
+    lastT = t;
+    lastFlow = flowGps;
+    if (dt <= 0.0f)
+      return 0;
+
+    uint8_t now = 0;
+    if (!onset.dripped())
+    {
+      if (t >= CHOKE_NO_DRIP_S)
+        now |= FLOW_ANOMALY_CHOKED;
+      return raise(now, t);
+    }
+
+    lower = max(0.0f, lower + (CHOKE_FLOW_GPS - flowGps) * dt);
+    if (lower >= CHOKE_DEFICIT_G)
+      now |= FLOW_ANOMALY_CHOKED;
+
+    if (onset.flowing())
+    {
+      float sinceOnset = t - onset.onsetS();
+      if (sinceOnset < ANOMALY_SETTLE_S || mean == 0.0f)
+      {
+        // Ramp into steady flow: follow it quickly, do not judge it
+        mean += (flowGps - mean) * min(1.0f, dt / (ANOMALY_MEAN_TAU_S / 4));
+      }
+      else
+      {
+        float s = upper + (flowGps - mean - CHANNEL_DRIFT_GPS) * dt;
+        if (s <= 0.0f)
+        {
+          upper = 0.0f;
+          runRise = 0.0f;
+          mean += (flowGps - mean) * min(1.0f, dt / ANOMALY_MEAN_TAU_S);
+        }
+        else
+        {
+          upper = s;
+          runRise = max(runRise, rise);
+          if (upper >= CHANNEL_EXCESS_G && runRise >= CHANNEL_RISE_GPS2)
+            now |= FLOW_ANOMALY_CHANNELING;
+        }
+      }
+    }
+    return raise(now, t);
+  }
+
+  /** @brief FLOW_ANOMALY_* raised so far this shot */
+  uint8_t flags() const { return raised; }
+
+  /** @brief Shot time (s) of the first flag, -1 = none */
+  float anomalyS() const { return raisedS; }
+
+  /** @brief "channeling", "choked", "channeling+choked" or "" */
+  static const char *name(uint8_t flags)
+  {
+    static const char *const NAMES[] = {"", "channeling", "choked", "channeling+choked"};
+    return NAMES[flags & 3];
+  }
+
+private:
+  // Newly raised flags only; each is reported once per shot
+  uint8_t raise(uint8_t now, float t)
+  {
+    now &= ~raised;
+    if (now && raised == 0)
+      raisedS = t;
+    raised |= now;
+    return now;
+  }
+
+  float lastT;          // Previous sample, -1 = none yet
+  float lastFlow;
+  float mean;           // Running mean flow, 0 = not started
+  float upper;          // S+, g of excess flow
+  float runRise;        // Steepest flow rise in the current S+ run
+  float lower;          // S-, g of missing flow
+  uint8_t raised;
+  float raisedS;
+};
+
+#endif // FLOW_ANOMALY_H
@@ -0,0 +1,116 @@
+#ifndef FLOW_CONTROL_H
+#define FLOW_CONTROL_H
+
+// =============================================================================
+// Closed-Loop Flow Control: feed-forward + PI on the filtered flow
+// =============================================================================
+// A profile stage with a target flow (ShotStage::flowDgS, shot_profile.h)
+// runs the pump at whatever power holds the cup's flow on that target. The
+// control task runs one step per weight sample, right after the filter has
+// taken it:
+//
+//   power = target / GS_FLOW_FULL_POWER_GS            feed-forward
+//         + Kp * (target - flow) + Ki * integral      feedback
+//
+//   - The feed-forward term gets the pump close at once. The PI part only
+//     trims the rest, so modest gains do and the loop stays stable at
+//     packet rate (a few Hz up to ~10 Hz).
+//   - Until the first drip the flow reads 0 whatever the pump does (the
+//     puck is still soaking), so the step holds the feed-forward power and
+//     does not integrate.
+//   - Anti-windup: the integral stops growing while the output is clamped
+//     and the error would push it further out.
+//   - dt comes from the samples' shot times, capped at GS_FLOW_MAX_DT_S so
+//     a gap in the packets cannot throw a large step.
+//
+// Output: 0..1 for pump_output.h. Sample → actuator time is measured by
+// the caller (flow_control_latency_us).
+//
+// Header-only, no Arduino dependencies - the shot replay tool can run it.
+//
+// Thread Safety:
+//   Not thread safe - one instance, owned by the shot control task.
+// =============================================================================
+
+#ifndef GS_FLOW_FULL_POWER_GS
+#define GS_FLOW_FULL_POWER_GS 3.0f   // Cup flow at full pump power, g/s
+#endif
+#ifndef GS_FLOW_KP
+#define GS_FLOW_KP 0.12f             // Power per g/s of error
+#endif
+#ifndef GS_FLOW_KI
+#define GS_FLOW_KI 0.25f             // Power per g of accumulated error
+#endif
+#ifndef GS_FLOW_MIN_POWER
+#define GS_FLOW_MIN_POWER 0.15f      // Below this a vibratory pump stalls
+#endif
+#ifndef GS_FLOW_MAX_DT_S
+#define GS_FLOW_MAX_DT_S 0.5f
+#endif
+
+class FlowController {
+public:
+  void reset()
+  {
+    running = false;
+    integral = 0.0f;
+    lastS = 0.0f;
+    out = 1.0f;
+    err = 0.0f;
+  }
+
+  /**
+   * @param targetGs Wanted flow (g/s), > 0
+   * @param flowGs   Filtered flow of this sample (g/s)
+   * @param nowS     Shot time of this sample
+   * @param dripped  Flow onset has seen the first drip
+   * @return Pump power 0..1
+   */
+  float update(float targetGs, float flowGs, float nowS, bool dripped)
+  {
+    float dt = running ? nowS - lastS : 0.0f;
+    if (dt < 0.0f)
+      dt = 0.0f;
+    if (dt > GS_FLOW_MAX_DT_S)
+      dt = GS_FLOW_MAX_DT_S;
+    running = true;
+    lastS = nowS;
+
+    float ff = targetGs / GS_FLOW_FULL_POWER_GS;
+    if (!dripped) {
+      err = 0.0f;
+      return out = clamp(ff);
+    }
+
+    err = targetGs - flowGs;
+    float unclamped = ff + GS_FLOW_KP * err + GS_FLOW_KI * (integral + err * dt);
+    float clamped = clamp(unclamped);
+    bool saturatedOut = (unclamped > clamped && err > 0.0f) || (unclamped < clamped && err < 0.0f);
+    if (!saturatedOut)
+      integral += err * dt;
+
+    out = clamp(ff + GS_FLOW_KP * err + GS_FLOW_KI * integral);
+    return out;
+  }
+
+  bool active() const { return running; }
+  float power() const { return out; }
+  float error() const { return err; }
+  float integralTerm() const { return GS_FLOW_KI * integral; }
+
+private:
+  static float clamp(float p)
+  {
+    if (p < GS_FLOW_MIN_POWER)
+      return GS_FLOW_MIN_POWER;
+    return p > 1.0f ? 1.0f : p;
+  }
+
+  bool running = false;
+  float integral = 0.0f;
+  float lastS = 0.0f;
+  float out = 1.0f;
+  float err = 0.0f;
+};
+
+#endif // FLOW_CONTROL_H
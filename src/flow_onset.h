@@ -0,0 +1,132 @@
+#ifndef FLOW_ONSET_H
+#define FLOW_ONSET_H
+
+// =============================================================================
+// First Drip + Flow Onset Detector for Gravimetric Shots
+// =============================================================================
+// Shot time starts at pump-on (the start sequence's "arm" step), but nothing reaches the cup
+// until the puck is saturated - several seconds of pre-infusion dead time.
+// This marks the two points on the way to steady flow, online, O(1) per
+// sample:
+//
+//   pump on ──► first drip ──► flow onset ──► steady extraction ──► stop
+//               (CUSUM on      (filtered flow above ONSET_FLOW_GPS
+//                the weight)    for ONSET_CONFIRM_S)
+//
+//   - First drip: one-sided CUSUM of the raw weight above the baseline,
+//     S = max(0, S + w - baseline - DRIP_DRIFT_G). The baseline follows the
+//     readings only while S is 0 (pump vibration, a settling cup), so a slow
+//     first trickle is not averaged away. S above DRIP_ALARM_G plus a
+//     DRIP_MIN_G rise held for DRIP_CONFIRM_SAMPLES readings is the alarm (a
+//     pump kick is one reading); the drip is dated to where that run of S
+//     started (the CUSUM change point), not to the alarm.
+//   - Flow onset: after the drip, the filtered flow (WeightFilter) has stayed
+//     at or above ONSET_FLOW_GPS for ONSET_CONFIRM_S, dated to the start of
+//     that run. A shot that is still below it ONSET_FORCE_G above the
+//     baseline (a very fine grind) gets its onset there, so the predictor
+//     is never starved.
+//
+// ShotPredictor feeds its trend line only from the onset on. Contact time is
+// shot time since pump-on; extraction time is shot time since the first
+// drip.
+//
+// Not thread safe - keep each instance on one task (the shot control task).
+// =============================================================================
+
+#include <Arduino.h>
+
+constexpr float DRIP_DRIFT_G     = 0.15f;  // CUSUM allowance per sample (above scale noise)
+constexpr float DRIP_ALARM_G     = 0.6f;   // CUSUM decision level
+constexpr float DRIP_MIN_G       = 0.3f;   // Rise over the baseline the alarm also needs
+constexpr uint8_t DRIP_CONFIRM_SAMPLES = 3; // ... in this many readings in a row
+constexpr float ONSET_FLOW_GPS   = 0.8f;   // Filtered flow counted as steady
+constexpr float ONSET_CONFIRM_S  = 0.5f;   // ... held this long
+constexpr float ONSET_FORCE_G    = 4.0f;   // Onset anyway once this far above the baseline
+
+class FlowOnset {
+public:
+  FlowOnset() { reset(); }
+
+  void reset()
+  {
+    samples = 0;
+    baseline = 0.0f;
+    cusum = 0.0f;
+    runStartS = 0.0f;
+    risen = 0;
+    flowRunS = -1.0f;
+    drip = -1.0f;
+    onset = -1.0f;
+  }
+
+  /**
+   * @brief One reading at shot time t (s): raw grams and the filtered flow after it
+   */
+  void add(float t, float grams, float flowGps)
+  {
+    if (onset >= 0.0f)
+      return;
+
+    if (drip < 0.0f)
+    {
+      if (samples == 0)
+        baseline = grams;
+      samples++;
+
+      float s = cusum + (grams - baseline) - DRIP_DRIFT_G;
+      if (s <= 0.0f)
+      {
+        // In control: the baseline follows the (tared, vibrating) empty cup
+        cusum = 0.0f;
+        risen = 0;
+        baseline += (grams - baseline) / (samples < 8 ? samples : 8);
+        return;
+      }
+      if (cusum == 0.0f)
+        runStartS = t;
+      cusum = s;
+      risen = (grams - baseline >= DRIP_MIN_G) ? risen + 1 : 0;
+      if (cusum < DRIP_ALARM_G || risen < DRIP_CONFIRM_SAMPLES)
+        return;
+      drip = runStartS;
+    }
+
+    if (flowGps >= ONSET_FLOW_GPS)
+    {
+      if (flowRunS < 0.0f)
+        flowRunS = t;
+      if (t - flowRunS >= ONSET_CONFIRM_S)
+        onset = flowRunS;
+    }
+    else
+    {
+      flowRunS = -1.0f;
+    }
+    if (onset < 0.0f && grams - baseline >= ONSET_FORCE_G)
+      onset = t;
+  }
+
+  bool dripped() const { return drip >= 0.0f; }
+  bool flowing() const { return onset >= 0.0f; }
+
+  /** @brief Shot time (s) of the first drip, -1 = not yet */
+  float dripS() const { return drip; }
+
+  /** @brief Shot time (s) steady flow began, -1 = not yet */
+  float onsetS() const { return onset; }
+
+  /** @brief Cup weight before the first drip (g) */
+  float baselineG() const { return baseline; }
+
+private:
+  uint16_t samples;     // Readings before the drip (baseline average, capped)
+  float baseline;
+  float cusum;
+  float runStartS;      // Where the current positive CUSUM run began
+  uint8_t risen;        // Readings in a row DRIP_MIN_G above the baseline
+  float flowRunS;       // Where flow went above ONSET_FLOW_GPS, -1 = below
+  float drip;
+  float onset;
+};
+
+#endif // FLOW_ONSET_H
@@ -0,0 +1,108 @@
+// =============================================================================
+// Dirty Area Coalescing Implementation
+// =============================================================================
+
+#include "flush_coalesce.h"
+#include "metrics.h"
+#include "core/lv_refr.h"
+
+static volatile uint32_t areasIn = 0;
+static volatile uint32_t windowsOut = 0;
+static volatile uint32_t merges = 0;
+static volatile uint32_t extraPx = 0;
+
+static MetricCounterRef areasInTotal("flush_coalesce_areas_total", "Invalidated areas of multi-area refreshes", &areasIn);
+static MetricCounterRef windowsTotal("flush_coalesce_windows_total", "Areas left after coalescing", &windowsOut);
+static MetricCounterRef mergesTotal("flush_coalesce_merges_total", "Areas folded into another window", &merges);
+static MetricCounterRef extraPxTotal("flush_coalesce_extra_px_total", "Gap pixels drawn to save a window", &extraPx);
+
+// An area taller than the draw buffer holds goes out as several windows
+static uint32_t windowCost(const lv_disp_drv_t *drv, const lv_area_t *a)
+{
+  uint32_t rows = drv->draw_buf->size / (uint32_t)lv_area_get_width(a);
+  uint32_t h = (uint32_t)lv_area_get_height(a);
+  uint32_t windows = (rows == 0 || rows >= h) ? 1 : (h + rows - 1) / rows;
+  return windows * FLUSH_WINDOW_COST_PX + lv_area_get_size(a);
+}
+
+static void coalesce(lv_disp_t *disp)
+{
+  lv_disp_drv_t *drv = disp->driver;
+  if (drv->full_refresh || drv->direct_mode || disp->inv_p < 2)
+    return;
+
+  lv_area_t *areas = disp->inv_areas;
+  uint16_t n = disp->inv_p;
+  areasIn += n;
+  for (;;) {
+    uint32_t bestSaving = 0;
+    uint16_t bi = 0;
+    uint16_t bj = 0;
+    lv_area_t best;
+    for (uint16_t i = 0; i < n; i++) {
+      for (uint16_t j = i + 1; j < n; j++) {
+        lv_area_t box;
+        _lv_area_join(&box, &areas[i], &areas[j]);
+        if (drv->rounder_cb)
+          drv->rounder_cb(drv, &box);
+        uint32_t separate = windowCost(drv, &areas[i]) + windowCost(drv, &areas[j]);
+        uint32_t joined = windowCost(drv, &box);
+        if (joined < separate && separate - joined > bestSaving) {
+          bestSaving = separate - joined;
+          bi = i;
+          bj = j;
+          best = box;
+        }
+      }
+    }
+    if (bestSaving == 0)
+      break;
+
+    uint32_t before = lv_area_get_size(&areas[bi]) + lv_area_get_size(&areas[bj]);
+    uint32_t after = lv_area_get_size(&best);
+    if (after > before)
+      extraPx += after - before;
+    merges++;
+    areas[bi] = best;
+    areas[bj] = areas[--n];
+    // The box may now cover others outright
+    for (uint16_t k = 0; k < n;) {
+      if (k != bi && _lv_area_is_in(&areas[k], &best, 0)) {
+        areas[k] = areas[--n];
+        if (bi == n)
+          bi = k;
+        merges++;
+      } else {
+        k++;
+      }
+    }
+  }
+  disp->inv_p = n;
+  windowsOut += n;
+}
+
+static void coalescingRefr(lv_timer_t *timer)
+{
+  lv_disp_t *disp = (lv_disp_t *)timer->user_data;
+  if (disp != NULL)
+    coalesce(disp);
+  _lv_disp_refr_timer(timer);
+}
+
+void flushCoalesceBegin(lv_disp_t *disp)
+{
+#if GS_FLUSH_COALESCE
+  lv_timer_t *timer = disp ? _lv_disp_get_refr_timer(disp) : NULL;
+  if (timer != NULL && timer->timer_cb == _lv_disp_refr_timer)
+    timer->timer_cb = coalescingRefr;
+#else
+  (void)disp;
+#endif
+}
+
+void flushCoalesceDump(Print &out)
+{
+  out.printf("[Flush coalescing] %s, window cost %u px: %lu areas -> %lu windows, %lu merges, %lu gap px drawn\n",
+             GS_FLUSH_COALESCE ? "on" : "off", (unsigned)FLUSH_WINDOW_COST_PX, (unsigned long)areasIn,
+             (unsigned long)windowsOut, (unsigned long)merges, (unsigned long)extraPx);
+}
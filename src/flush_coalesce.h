@@ -0,0 +1,66 @@
+#ifndef FLUSH_COALESCE_H
+#define FLUSH_COALESCE_H
+
+// =============================================================================
+// Dirty Area Coalescing (fewer, larger flush windows per refresh)
+// =============================================================================
+// LVGL renders and flushes every invalidated area on its own. Its join step
+// (lv_refr_join_area) only merges two areas when their bounding box is
+// smaller than the two together, i.e. when they overlap. The weight, timer
+// and status labels sit in different containers with gaps between them, so
+// a busy refresh goes out as three to five small windows. Each one pays a
+// fixed cost whatever its size: an LVGL render pass over the object tree,
+// flush_cb, CASET / RASET / RAMWR on the panel, the bounce task start and a
+// DMA completion.
+//
+// flushCoalesceBegin() wraps the display's refresh timer. Before LVGL's own
+// refresh, the invalidated areas are merged greedily under a cost model:
+//
+//   cost(area) = windows(area) x FLUSH_WINDOW_COST_PX + pixels(area)
+//
+// windows(area) is how many draw buffer stripes it takes (GS_DRAW_STRIPE_ROWS):
+// an area taller than a stripe goes out in several windows anyway.
+// The pair that saves the most when replaced by its bounding box is merged
+// first. The box goes through the driver's rounder_cb, so it stays a legal
+// panel window. Areas inside the box are dropped, and merging repeats until
+// no pair saves anything. In effect a gap is filled when drawing it is
+// cheaper than another window. With LCD_ROW_FULL_SPAN every window is a
+// full-width stripe, so this decides which gaps between stripes to draw.
+// LVGL's join then runs as before, and the flushes of one refresh still
+// pipeline through the two draw buffers.
+//
+// FLUSH_WINDOW_COST_PX is the fixed cost in pixels: about two landscape rows,
+// which take roughly 160 us on the wire at 32 MHz QSPI. A faster clock
+// (lcd_clock.h) makes pixels cheaper relative to windows, which only errs
+// towards fewer merges.
+//
+// GS_FLUSH_COALESCE (compile-time, -DGS_FLUSH_COALESCE=0): LVGL's join only,
+// for A/B comparison. Default 1.
+//
+// Thread Safety:
+//   UI task (LVGL owner). flushCoalesceDump() - any task (plain counters).
+// =============================================================================
+
+#include <Arduino.h>
+#include "lvgl.h"
+
+#ifndef GS_FLUSH_COALESCE
+#define GS_FLUSH_COALESCE 1
+#endif
+
+#ifndef FLUSH_WINDOW_COST_PX
+#define FLUSH_WINDOW_COST_PX 1280  // 2 landscape rows: ~160 us per window (render pass, commands, DMA setup)
+#endif
+
+/**
+ * @brief Merge invalidated areas before every refresh of this display (no-op when disabled)
+ * @note Call once, after lv_disp_drv_register()
+ */
+void flushCoalesceBegin(lv_disp_t *disp);
+
+/**
+ * @brief Areas in / windows out, merges and extra pixels since boot
+ */
+void flushCoalesceDump(Print &out);
+
+#endif // FLUSH_COALESCE_H
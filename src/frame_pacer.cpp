@@ -0,0 +1,98 @@
+// =============================================================================
+// Adaptive Frame Pacing Implementation
+// =============================================================================
+
+#include "frame_pacer.h"
+#include "debug_config.h"
+#include "power_manager.h"
+#include "weight_projector.h"
+
+static constexpr LogTag TAG = LOG_TAG_UI;
+
+static volatile uint32_t packetPeriodMs = 0;   // Written by BLE task (Core 0)
+
+// Core 1 only (LVGL context)
+static lv_disp_drv_t *pacerDrv = NULL;
+static uint32_t refreshCostMs_x8 = 0;          // EWMA of refresh time, 1/8 ms units
+static unsigned long lastRefreshMs = 0;        // Last refresh that actually drew something
+static unsigned long lastEvalMs = 0;
+static uint32_t appliedPeriodMs = LV_DISP_DEF_REFR_PERIOD;
+
+// Called by LVGL after every refresh with the time it took and pixels drawn
+static void framePacerMonitor(lv_disp_drv_t *drv, uint32_t time_ms, uint32_t px)
+{
+  if (px == 0)
+    return;
+
+  // EWMA with alpha = 1/8 - smooths out the occasional large redraw
+  if (refreshCostMs_x8 == 0)
+    refreshCostMs_x8 = time_ms * 8;
+  else
+    refreshCostMs_x8 = refreshCostMs_x8 - (refreshCostMs_x8 / 8) + time_ms;
+
+  lastRefreshMs = millis();
+}
+
+void framePacerBegin(lv_disp_drv_t *drv)
+{
+  pacerDrv = drv;
+  drv->monitor_cb = framePacerMonitor;
+}
+
+void framePacerNotePacketPeriod(uint32_t period_ms)
+{
+  packetPeriodMs = period_ms;
+}
+
+uint32_t framePacerPeriodMs()
+{
+  return appliedPeriodMs;
+}
+
+void framePacerUpdate(bool brewing, unsigned long lastTouchMs)
+{
+  unsigned long now = millis();
+  if (now - lastEvalMs < FRAME_EVAL_INTERVAL_MS)
+    return;
+  lastEvalMs = now;
+
+  lv_disp_t *display = lv_disp_get_default();
+  if (!display)
+    return;
+  lv_timer_t *refresh_timer = _lv_disp_get_refr_timer(display);
+  if (!refresh_timer)
+    return;
+
+  uint32_t target;
+  const char *reason;
+  if (lastTouchMs > 0 && (now - lastTouchMs) < FRAME_TOUCH_BOOST_MS) {
+    target = FRAME_PERIOD_MIN_MS;
+    reason = "touch";
+  } else if (brewing) {
+    uint32_t packet = packetPeriodMs;
+    if (GS_WEIGHT_PROJECT)
+      packet /= 2;  // A projected weight tenth between two packets
+    target = (packet > 0 && packet < FRAME_PERIOD_SHOT_MAX_MS) ? packet : FRAME_PERIOD_SHOT_MAX_MS;
+    reason = "shot";
+  } else if (lastRefreshMs > 0 && (now - lastRefreshMs) < FRAME_IDLE_AFTER_MS) {
+    target = powerOnBattery() ? FRAME_PERIOD_BATTERY_MS : FRAME_PERIOD_DEFAULT_MS;
+    reason = "active";
+  } else {
+    target = powerOnBattery() ? FRAME_PERIOD_IDLE_BATTERY_MS : FRAME_PERIOD_IDLE_MS;
+    reason = "idle";
+  }
+
+  // Never schedule refreshes faster than we can render + flush them
+  uint32_t costFloor = (refreshCostMs_x8 * FRAME_COST_HEADROOM_PCT) / (8 * 100);
+  if (target < costFloor)
+    target = costFloor;
+  if (target < FRAME_PERIOD_MIN_MS)
+    target = FRAME_PERIOD_MIN_MS;
+
+  if (target != appliedPeriodMs) {
+    lv_timer_set_period(refresh_timer, target);
+    LOG_DEBUG(TAG, "Display pacing: %lums (%s, cost=%lums, packet=%lums)",
+              target, reason, refreshCostMs_x8 / 8, (uint32_t)packetPeriodMs);
+    appliedPeriodMs = target;
+  }
+}
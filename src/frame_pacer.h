@@ -0,0 +1,71 @@
+#ifndef FRAME_PACER_H
+#define FRAME_PACER_H
+
+// =============================================================================
+// Adaptive Frame Pacing for Gravimetric Shots
+// =============================================================================
+// Chooses the LVGL display refresh period from what is actually happening
+// instead of a fixed 16/33 ms toggle:
+//
+//   - Touch interaction   → FRAME_PERIOD_MIN_MS (sliders/drag must feel smooth)
+//   - Shot in progress    → half the weight packet period (the weight label
+//                           is projected between packets, weight_projector.h),
+//                           capped at the shot timer label resolution
+//   - Recent invalidation → FRAME_PERIOD_DEFAULT_MS
+//   - Nothing invalidated → FRAME_PERIOD_IDLE_MS
+//
+// On battery (powerOnBattery()) the active and idle periods stretch to
+// FRAME_PERIOD_BATTERY_MS / FRAME_PERIOD_IDLE_BATTERY_MS; touch and shot
+// pacing stay as they are.
+//
+// The period is never shorter than the measured refresh cost (render + flush,
+// from LVGL's monitor_cb) with headroom, so refreshes can't run back-to-back.
+//
+// NOTE: LVGL pauses its refresh timer while nothing is invalidated, and a
+// resumed timer fires immediately if a whole period has already elapsed, so a
+// long idle period does not delay the first frame after the UI changes again.
+//
+// Thread Safety:
+//   framePacerUpdate()/framePacerBegin() - Core 1 (LVGL context) only
+//   framePacerNotePacketPeriod()         - any core (single 32-bit store)
+// =============================================================================
+
+#include <Arduino.h>
+#include "lvgl.h"
+
+constexpr uint32_t FRAME_PERIOD_MIN_MS        = 16;    // 60 Hz ceiling
+constexpr uint32_t FRAME_PERIOD_DEFAULT_MS    = 33;    // UI changing, no shot (animations, labels)
+constexpr uint32_t FRAME_PERIOD_IDLE_MS       = 200;   // Nothing invalidated recently
+constexpr uint32_t FRAME_PERIOD_SHOT_MAX_MS   = 100;   // Shot timer label updates every 100 ms
+constexpr uint32_t FRAME_PERIOD_BATTERY_MS    = 50;    // "active" on battery
+constexpr uint32_t FRAME_PERIOD_IDLE_BATTERY_MS = 500; // "idle" on battery
+constexpr uint32_t FRAME_IDLE_AFTER_MS        = 1000;  // Quiet time before dropping to idle
+constexpr uint32_t FRAME_TOUCH_BOOST_MS       = 500;   // Stay fast this long after a touch
+constexpr uint32_t FRAME_EVAL_INTERVAL_MS     = 100;   // How often the period is re-evaluated
+constexpr uint32_t FRAME_COST_HEADROOM_PCT    = 125;   // Period >= 1.25x measured refresh cost
+
+/**
+ * @brief Hook the pacer into a display driver (installs monitor_cb)
+ * @param drv Display driver, before or after lv_disp_drv_register()
+ */
+void framePacerBegin(lv_disp_drv_t *drv);
+
+/**
+ * @brief Report the interval between the two most recent weight packets
+ * @param period_ms Packet period in ms (0 = unknown)
+ */
+void framePacerNotePacketPeriod(uint32_t period_ms);
+
+/**
+ * @brief Re-evaluate and apply the refresh period (cheap, call every loop)
+ * @param brewing True while a shot is running
+ * @param lastTouchMs millis() of the most recent touch event (0 = never)
+ */
+void framePacerUpdate(bool brewing, unsigned long lastTouchMs);
+
+/**
+ * @brief Currently applied refresh period in ms
+ */
+uint32_t framePacerPeriodMs();
+
+#endif // FRAME_PACER_H
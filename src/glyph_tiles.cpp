@@ -0,0 +1,215 @@
+// =============================================================================
+// Pre-Blended Digit Tiles Implementation
+// =============================================================================
+
+#include "glyph_tiles.h"
+#include "draw_s3.h"
+#include "metrics.h"
+#include "draw/sw/lv_draw_sw.h"
+#include "core/lv_refr.h"
+
+extern "C" const uint8_t _lv_bpp1_opa_table[2];
+extern "C" const uint8_t _lv_bpp2_opa_table[4];
+extern "C" const uint8_t _lv_bpp4_opa_table[16];
+extern "C" const uint8_t _lv_bpp8_opa_table[256];
+
+struct GlyphTile {
+  const lv_font_t *font;  // NULL: free slot
+  uint32_t letter;
+  lv_color_t color;
+  lv_color_t bg;
+  int16_t dx;             // Box offset from the pen position
+  int16_t dy;
+  uint16_t w;
+  uint16_t h;
+  uint32_t lastUse;
+  lv_color_t *px;
+};
+
+static volatile uint32_t tilePx = 0;
+static volatile uint32_t builds = 0;
+static volatile uint32_t fallbacks = 0;
+
+static MetricCounterRef tilePxTotal("glyph_tile_px_total", "Glyph pixels copied from pre-blended tiles", &tilePx);
+static MetricCounterRef buildsTotal("glyph_tile_builds_total", "Glyph tiles rendered", &builds);
+static MetricCounterRef fallbacksTotal("glyph_tile_fallbacks_total", "Tile characters drawn by LVGL (background, mask, layer)", &fallbacks);
+
+static GlyphTile tiles[GLYPH_TILE_SLOTS];
+static uint32_t useClock = 0;
+
+static const uint8_t *opaTable(uint8_t bpp)
+{
+  switch (bpp) {
+    case 1: return _lv_bpp1_opa_table;
+    case 2: return _lv_bpp2_opa_table;
+    case 4: return _lv_bpp4_opa_table;
+    case 8: return _lv_bpp8_opa_table;
+    default: return NULL;  // 3 bpp and image fonts: LVGL only
+  }
+}
+
+static bool tileable(lv_draw_ctx_t *ctx, const lv_draw_label_dsc_t *dsc, uint32_t letter)
+{
+  if (letter > 0x7F || letter == 0 || strchr(GLYPH_TILES_CHARSET, (int)letter) == NULL)
+    return false;
+  if (dsc->opa < LV_OPA_MAX || dsc->blend_mode != LV_BLEND_MODE_NORMAL)
+    return false;
+  lv_disp_t *disp = _lv_refr_get_disp_refreshing();
+  return disp != NULL && disp->driver->set_px_cb == NULL && ctx->buf == disp->driver->draw_buf->buf_act;
+}
+
+static GlyphTile *build(const lv_font_t *font, uint32_t letter, lv_color_t color, lv_color_t bg)
+{
+  lv_font_glyph_dsc_t g;
+  if (!lv_font_get_glyph_dsc(font, &g, letter, '\0') || g.box_w == 0 || g.box_h == 0 || g.resolved_font->subpx)
+    return NULL;
+  const uint8_t *table = opaTable(g.bpp);
+  const uint8_t *map = lv_font_get_glyph_bitmap(g.resolved_font, letter);
+  if (table == NULL || map == NULL)
+    return NULL;
+
+  GlyphTile *slot = &tiles[0];
+  for (GlyphTile &t : tiles) {
+    if (t.font == NULL) {
+      slot = &t;
+      break;
+    }
+    if (t.lastUse < slot->lastUse)
+      slot = &t;
+  }
+  if (slot->px != NULL && (uint32_t)slot->w * slot->h < (uint32_t)g.box_w * g.box_h) {
+    lv_mem_free(slot->px);
+    slot->px = NULL;
+  }
+  if (slot->px == NULL)
+    slot->px = (lv_color_t *)lv_mem_alloc((size_t)g.box_w * g.box_h * sizeof(lv_color_t));
+  if (slot->px == NULL) {
+    slot->font = NULL;
+    return NULL;
+  }
+
+  // Same bit stream walk as draw_letter_normal(), same mix as the masked S3 blend
+  const uint32_t bpp = g.bpp;
+  const uint32_t valueMask = (1u << bpp) - 1;
+  const uint32_t count = (uint32_t)g.box_w * g.box_h;
+  for (uint32_t i = 0; i < count; i++) {
+    uint32_t bit = i * bpp;
+    uint8_t opa = table[(map[bit >> 3] >> (8 - bpp - (bit & 7))) & valueMask];
+    slot->px[i] = drawS3MixPx(color, bg, opa);
+  }
+
+  slot->font = font;
+  slot->letter = letter;
+  slot->color = color;
+  slot->bg = bg;
+  slot->dx = g.ofs_x;
+  slot->dy = (font->line_height - font->base_line) - g.box_h - g.ofs_y;
+  slot->w = g.box_w;
+  slot->h = g.box_h;
+  builds++;
+  return slot;
+}
+
+static GlyphTile *find(const lv_font_t *font, uint32_t letter, lv_color_t color, lv_color_t bg)
+{
+  for (GlyphTile &t : tiles) {
+    if (t.font == font && t.letter == letter && t.color.full == color.full && t.bg.full == bg.full)
+      return &t;
+  }
+  return build(font, letter, color, bg);
+}
+
+// The colour under `area` if it is a single one
+static bool uniformBackground(lv_draw_ctx_t *ctx, const lv_area_t *area, lv_color_t *bg)
+{
+  const int32_t stride = lv_area_get_width(ctx->buf_area);
+  const lv_color_t *row = (const lv_color_t *)ctx->buf + (area->y1 - ctx->buf_area->y1) * stride +
+                          (area->x1 - ctx->buf_area->x1);
+  const int32_t w = lv_area_get_width(area);
+  const int32_t h = lv_area_get_height(area);
+  const uint16_t first = row[0].full;
+  for (int32_t y = 0; y < h; y++, row += stride) {
+    for (int32_t x = 0; x < w; x++) {
+      if (row[x].full != first)
+        return false;
+    }
+  }
+  bg->full = first;
+  return true;
+}
+
+static void drawLetter(lv_draw_ctx_t *ctx, const lv_draw_label_dsc_t *dsc, const lv_point_t *pos, uint32_t letter)
+{
+  if (!tileable(ctx, dsc, letter)) {
+    lv_draw_sw_letter(ctx, dsc, pos, letter);
+    return;
+  }
+
+  // Glyph box: from a tile of this font / letter when there is one, else the font
+  lv_area_t box;
+  const GlyphTile *known = NULL;
+  for (const GlyphTile &t : tiles) {
+    if (t.font == dsc->font && t.letter == letter) {
+      known = &t;
+      break;
+    }
+  }
+  if (known != NULL) {
+    box.x1 = pos->x + known->dx;
+    box.y1 = pos->y + known->dy;
+    box.x2 = box.x1 + known->w - 1;
+    box.y2 = box.y1 + known->h - 1;
+  } else {
+    lv_font_glyph_dsc_t g;
+    if (!lv_font_get_glyph_dsc(dsc->font, &g, letter, '\0') || g.box_w == 0 || g.box_h == 0) {
+      lv_draw_sw_letter(ctx, dsc, pos, letter);
+      return;
+    }
+    box.x1 = pos->x + g.ofs_x;
+    box.y1 = pos->y + (dsc->font->line_height - dsc->font->base_line) - g.box_h - g.ofs_y;
+    box.x2 = box.x1 + g.box_w - 1;
+    box.y2 = box.y1 + g.box_h - 1;
+  }
+  lv_area_t vis;
+  if (!_lv_area_intersect(&vis, &box, ctx->clip_area))
+    return;
+
+  lv_color_t bg;
+  GlyphTile *tile = NULL;
+  if (!lv_draw_mask_is_any(&vis) && uniformBackground(ctx, &vis, &bg))
+    tile = find(dsc->font, letter, dsc->color, bg);
+  if (tile == NULL) {
+    fallbacks++;
+    lv_draw_sw_letter(ctx, dsc, pos, letter);
+    return;
+  }
+  tile->lastUse = ++useClock;
+
+  const int32_t stride = lv_area_get_width(ctx->buf_area);
+  const int32_t w = lv_area_get_width(&vis);
+  const int32_t h = lv_area_get_height(&vis);
+  lv_color_t *dst = (lv_color_t *)ctx->buf + (vis.y1 - ctx->buf_area->y1) * stride + (vis.x1 - ctx->buf_area->x1);
+  const lv_color_t *src = tile->px + (vis.y1 - box.y1) * tile->w + (vis.x1 - box.x1);
+  for (int32_t y = 0; y < h; y++, dst += stride, src += tile->w)
+    memcpy(dst, src, (size_t)w * sizeof(lv_color_t));
+  tilePx += w * h;
+}
+
+void glyphTilesInstall(lv_draw_ctx_t *ctx)
+{
+#if GS_GLYPH_TILES
+  ctx->draw_letter = drawLetter;
+#else
+  (void)ctx;
+#endif
+}
+
+void glyphTilesDump(Print &out)
+{
+  uint32_t used = 0;
+  for (const GlyphTile &t : tiles)
+    used += t.font != NULL;
+  out.printf("[Glyph tiles] %s, %lu / %u slots, %lu px copied, %lu builds, %lu drawn by LVGL\n",
+             GS_GLYPH_TILES ? "on" : "off", (unsigned long)used, (unsigned)GLYPH_TILE_SLOTS,
+             (unsigned long)tilePx, (unsigned long)builds, (unsigned long)fallbacks);
+}
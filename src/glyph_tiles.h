@@ -0,0 +1,59 @@
+#ifndef GLYPH_TILES_H
+#define GLYPH_TILES_H
+
+// =============================================================================
+// Pre-Blended Digit Tiles (weight / timer label text)
+// =============================================================================
+// The weight and timer labels redraw up to 10 times a second, and every
+// digit goes through lv_draw_sw_letter(): glyph lookup, a 4 bpp bit-stream
+// unpacked into an opacity mask, then a masked blend with one mix per edge
+// pixel. The result only depends on the glyph, the text colour and
+// the colour underneath - which for these labels is Panel1's flat fill.
+//
+// glyphTilesInstall() replaces the draw context's draw_letter. For the
+// characters in GLYPH_TILES_CHARSET, drawn opaque into the frame buffer
+// with no mask active, it checks that the pixels under the glyph box are one
+// colour and then copies a tile: the glyph box pre-blended over that colour,
+// built once with LVGL's opacity table and the masked blend's mix
+// (drawS3MixPx()), so the pixels are identical. Layout, kerning and alignment stay with
+// lv_draw_label(); only the per-letter rasterisation is replaced.
+//
+// Tiles live in GLYPH_TILE_SLOTS entries of the LVGL pool, keyed by font,
+// letter, text colour and background, least recently used replaced. Anything
+// else - other characters, a gradient or image below, opacity, masks,
+// layers - goes to lv_draw_sw_letter() as before (glyph_tile_fallbacks_total).
+//
+// Fonts: all three built-in Montserrat sizes stay - 14 (lists, status), 18
+// (button captions) and 24 (values, prefixes, settings) are all in use.
+//
+// GS_GLYPH_TILES (compile-time, -DGS_GLYPH_TILES=0): LVGL's letter drawing
+// only, for A/B render timing. Default 1. Installed with the S3 blend
+// backend (draw_s3.h), i.e. for swapped RGB565 only.
+//
+// Thread Safety:
+//   The draw hook runs wherever LVGL renders (UI task). glyphTilesDump() -
+//   any task (plain counters).
+// =============================================================================
+
+#include <Arduino.h>
+#include "lvgl.h"
+
+#ifndef GS_GLYPH_TILES
+#define GS_GLYPH_TILES 1
+#endif
+
+constexpr char GLYPH_TILES_CHARSET[] = "0123456789.-:";
+constexpr size_t GLYPH_TILE_SLOTS    = 32;  // Value digits (24 px) twice over, the rest for status text digits
+
+/**
+ * @brief Route the context's draw_letter through the tile cache (no-op when disabled)
+ * @note Call from the draw_ctx_init after lv_draw_sw_init_ctx()
+ */
+void glyphTilesInstall(lv_draw_ctx_t *ctx);
+
+/**
+ * @brief Tile hits, builds and fallbacks since boot
+ */
+void glyphTilesDump(Print &out);
+
+#endif // GLYPH_TILES_H
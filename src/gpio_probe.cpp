@@ -0,0 +1,24 @@
+// =============================================================================
+// GPIO Timing Probes Implementation
+// =============================================================================
+
+#include "gpio_probe.h"
+
+#if GS_GPIO_PROBE
+#include "debug_config.h"
+
+static constexpr LogTag TAG = LOG_TAG_SYSTEM;
+
+volatile uint8_t gpioProbeLevels[PROBE_COUNT] = {};
+
+void gpioProbeBegin()
+{
+  for (uint8_t c = 0; c < PROBE_COUNT; c++) {
+    pinMode(PROBE_PINS[c], OUTPUT);
+    digitalWrite(PROBE_PINS[c], LOW);
+    gpioProbeLevels[c] = 0;
+  }
+  LOG_INFO(TAG, "🔌 Timing probes: packet GPIO%u, decide GPIO%u, relay GPIO%u, DMA GPIO%u", PROBE_PINS[PROBE_PACKET],
+           PROBE_PINS[PROBE_DECIDE], PROBE_PINS[PROBE_RELAY], PROBE_PINS[PROBE_DMA]);
+}
+#endif
@@ -0,0 +1,102 @@
+#ifndef GPIO_PROBE_H
+#define GPIO_PROBE_H
+
+// =============================================================================
+// GPIO Timing Probes for a Logic Analyser (hardware-in-the-loop timing)
+// =============================================================================
+// Stop accuracy comes down to when RELAY1 drops relative to the weight
+// packets. The trace ring (trace.h) and the metrics time that path with the
+// firmware's own clock; these probes put the same events on spare pins, so
+// an external analyser measures them independently:
+//
+//   PROBE_PACKET  toggles  scale notification arrives (BLE callback)
+//   PROBE_DECIDE  toggles  control task has processed that weight sample and
+//                          re-armed (or cancelled) the relay cut
+//   PROBE_RELAY   level    copy of the relay output, written with RELAY1
+//   PROBE_DMA     level    high from a display window's DMA start to its last
+//                          chunk (flush_ready)
+//
+//   - Event channels toggle instead of pulsing: every edge is one event, and
+//     there is no pulse too short for a slow analyser to catch.
+//   - Writes go straight to the GPIO registers (gpio_ll, inline), so they
+//     are safe in the SPI ISR and cost a few cycles.
+//
+// tools/hil_timing/hil_latency.py turns an analyser CSV export into latency
+// distributions: packet → decision, decision → relay cut, packet → relay,
+// packet intervals and DMA windows.
+//
+// GS_GPIO_PROBE (compile-time, -DGS_GPIO_PROBE=1):
+//   0 - Macros compile to nothing (default)
+//   1 - Probe pins driven. Pins via GS_PROBE_PIN_* - the defaults are on the
+//       board's free header GPIOs; check them against the wiring first.
+//
+// Thread Safety:
+//   Any task or ISR. Each channel is written from one context (the BLE
+//   callback, the control task, under the relay spinlock, the display DMA
+//   path) and has its own shadow byte, so toggling needs no lock.
+// =============================================================================
+
+#include <Arduino.h>
+#include "hal/gpio_ll.h"
+
+#ifndef GS_GPIO_PROBE
+#define GS_GPIO_PROBE 0
+#endif
+
+#ifndef GS_PROBE_PIN_PACKET
+#define GS_PROBE_PIN_PACKET 39
+#endif
+#ifndef GS_PROBE_PIN_DECIDE
+#define GS_PROBE_PIN_DECIDE 40
+#endif
+#ifndef GS_PROBE_PIN_RELAY
+#define GS_PROBE_PIN_RELAY  41
+#endif
+#ifndef GS_PROBE_PIN_DMA
+#define GS_PROBE_PIN_DMA    42
+#endif
+
+enum ProbeChannel : uint8_t {
+  PROBE_PACKET,
+  PROBE_DECIDE,
+  PROBE_RELAY,
+  PROBE_DMA,
+  PROBE_COUNT
+};
+
+static constexpr uint8_t PROBE_PINS[PROBE_COUNT] = {GS_PROBE_PIN_PACKET, GS_PROBE_PIN_DECIDE, GS_PROBE_PIN_RELAY,
+                                                    GS_PROBE_PIN_DMA};
+
+#if GS_GPIO_PROBE
+extern volatile uint8_t gpioProbeLevels[PROBE_COUNT];   // Shadow of the probe outputs (gpio_probe.cpp)
+
+/**
+ * @brief Probe pins to outputs, all low (setup(), before BLE and the display)
+ */
+void gpioProbeBegin();
+
+// The channel is a template argument, so the pin is a constant: nothing is read from flash (SPI ISR)
+template <ProbeChannel channel>
+static inline __attribute__((always_inline)) void gpioProbeSet(bool high)
+{
+  constexpr gpio_num_t pin = (gpio_num_t)PROBE_PINS[channel];
+  gpio_ll_set_level(&GPIO, pin, high ? 1 : 0);
+  gpioProbeLevels[channel] = high;
+}
+
+template <ProbeChannel channel>
+static inline __attribute__((always_inline)) void gpioProbeToggle()
+{
+  gpioProbeSet<channel>(!gpioProbeLevels[channel]);
+}
+
+#define GS_PROBE_BEGIN()             gpioProbeBegin()
+#define GS_PROBE_TOGGLE(channel)     gpioProbeToggle<channel>()
+#define GS_PROBE_SET(channel, high)  gpioProbeSet<channel>(high)
+#else
+#define GS_PROBE_BEGIN()             do {} while (0)
+#define GS_PROBE_TOGGLE(channel)     do {} while (0)
+#define GS_PROBE_SET(channel, high)  do {} while (0)
+#endif
+
+#endif // GPIO_PROBE_H
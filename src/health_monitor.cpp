@@ -0,0 +1,190 @@
+// =============================================================================
+// Heap and Stack Health Monitor Implementation
+// =============================================================================
+
+#include "health_monitor.h"
+#include "debug_config.h"
+#include "task_layout.h"
+#include "metrics.h"
+#include "seqlock.h"
+#include "task_stats.h"
+#include "crash_ring.h"
+
+static constexpr LogTag TAG = LOG_TAG_TASK;
+
+static constexpr uint32_t INTERNAL_CAPS = MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
+
+static MetricGauge internalFreeGauge("heap_internal_free_bytes", "Internal DRAM free");
+static MetricGauge internalLargestGauge("heap_internal_largest_block_bytes", "Internal DRAM largest free block");
+static MetricGauge internalFragGauge("heap_internal_frag_pct", "Internal DRAM fragmentation (100 - largest/free)");
+static MetricGauge psramFreeGauge("heap_psram_free_bytes", "PSRAM free");
+static MetricGauge stackLowestGauge("stack_lowest_free_bytes", "Least stack headroom of any task");
+static MetricCounter healthEvents("health_events_total", "Heap/stack health thresholds tripped");
+
+static SeqLock<HealthSnapshot> published(HealthSnapshot{});
+
+static void noteRange(HealthRange &r, uint32_t v, bool first)
+{
+  if (first || v < r.min)
+    r.min = v;
+  if (first || v > r.max)
+    r.max = v;
+}
+
+// Edge-triggered: log when a bit trips or clears, count trips
+static void raise(HealthSnapshot &snap, uint8_t bit, bool tripped, const char *what, uint32_t value)
+{
+  bool wasActive = (snap.active & bit) != 0;
+  if (tripped && !wasActive) {
+    snap.active |= bit;
+    snap.events++;
+    healthEvents.add();
+    crashRingRecord(CRASH_EV_HEALTH, bit);
+    LOG_ERROR(TAG, "🔴 Health: %s (%lu bytes)", what, (unsigned long)value);
+  } else if (!tripped && wasActive) {
+    snap.active &= ~bit;
+    LOG_INFO(TAG, "✅ Health: %s cleared (%lu bytes)", what, (unsigned long)value);
+  }
+}
+
+static void healthMonitorTask(void *parameter)
+{
+  HealthSnapshot snap = {};
+  bool havePsram = heap_caps_get_total_size(MALLOC_CAP_SPIRAM) > 0;
+  // High-water marks never recover, so each task is reported once
+  char stackWarned[TASK_STATS_MAX_TASKS][16];
+  uint32_t stackWarnedCount = 0;
+  TickType_t lastLog = xTaskGetTickCount();
+
+  for (;;) {
+    snap.internalFree = heap_caps_get_free_size(INTERNAL_CAPS);
+    snap.internalMinEver = heap_caps_get_minimum_free_size(INTERNAL_CAPS);
+    snap.internalLargest = heap_caps_get_largest_free_block(INTERNAL_CAPS);
+    snap.internalFragPct = snap.internalFree ? (uint8_t)(100 - (uint64_t)snap.internalLargest * 100 / snap.internalFree) : 0;
+    if (havePsram) {
+      snap.psramFree = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+      snap.psramMinEver = heap_caps_get_minimum_free_size(MALLOC_CAP_SPIRAM);
+      snap.psramLargest = heap_caps_get_largest_free_block(MALLOC_CAP_SPIRAM);
+    }
+
+    bool first = (snap.samples == 0);
+    noteRange(snap.internalFreeRange, snap.internalFree, first);
+    noteRange(snap.internalLargestRange, snap.internalLargest, first);
+    noteRange(snap.internalFragRange, snap.internalFragPct, first);
+    noteRange(snap.psramFreeRange, snap.psramFree, first);
+    snap.samples++;
+
+    TaskStatsSnapshot tasks = taskStatsGet();
+    bool stackLow = false;
+    snap.lowestStackFree = UINT32_MAX;
+    snap.lowestStackTask[0] = '\0';
+    for (uint32_t i = 0; i < tasks.count; i++) {
+      const TaskStatsEntry &e = tasks.tasks[i];
+      if (e.stackFree < snap.lowestStackFree) {
+        snap.lowestStackFree = e.stackFree;
+        memcpy(snap.lowestStackTask, e.name, sizeof(snap.lowestStackTask));
+      }
+      if (e.stackFree >= HEALTH_STACK_LOW_BYTES)
+        continue;
+      stackLow = true;
+      bool warned = false;
+      for (uint32_t j = 0; j < stackWarnedCount && !warned; j++)
+        warned = strcmp(stackWarned[j], e.name) == 0;
+      if (!warned && stackWarnedCount < TASK_STATS_MAX_TASKS) {
+        memcpy(stackWarned[stackWarnedCount++], e.name, sizeof(e.name));
+        LOG_ERROR(TAG, "🔴 Health: task %s stack headroom %lu bytes", e.name, (unsigned long)e.stackFree);
+      }
+    }
+    if (tasks.count == 0)
+      snap.lowestStackFree = 0;  // task_stats has not sampled yet
+
+    raise(snap, HEALTH_HEAP_LOW, snap.internalFree < HEALTH_HEAP_LOW_BYTES, "internal heap low", snap.internalFree);
+    raise(snap, HEALTH_HEAP_CRITICAL, snap.internalFree < HEALTH_HEAP_CRITICAL_BYTES, "internal heap CRITICAL",
+          snap.internalFree);
+    raise(snap, HEALTH_HEAP_FRAGMENTED, snap.internalLargest < HEALTH_LARGEST_BLOCK_BYTES,
+          "internal heap fragmented, largest block", snap.internalLargest);
+    raise(snap, HEALTH_PSRAM_LOW, havePsram && snap.psramFree < HEALTH_PSRAM_LOW_BYTES, "PSRAM low", snap.psramFree);
+    if (stackLow && !(snap.active & HEALTH_STACK_LOW)) {
+      snap.events++;
+      healthEvents.add();
+      crashRingRecord(CRASH_EV_HEALTH, HEALTH_STACK_LOW);
+    }
+    snap.active = stackLow ? (snap.active | HEALTH_STACK_LOW) : (snap.active & ~HEALTH_STACK_LOW);
+
+    internalFreeGauge.set(snap.internalFree);
+    internalLargestGauge.set(snap.internalLargest);
+    internalFragGauge.set(snap.internalFragPct);
+    psramFreeGauge.set(snap.psramFree);
+    if (tasks.count > 0)
+      stackLowestGauge.set(snap.lowestStackFree);
+
+    published.update([&](HealthSnapshot &s) { s = snap; });
+
+    if ((xTaskGetTickCount() - lastLog) * portTICK_PERIOD_MS >= HEALTH_MONITOR_LOG_MS) {
+      lastLog = xTaskGetTickCount();
+      LOG_INFO(TAG, "💾 Heap: internal free=%lu min_ever=%lu largest=%lu (%u%% frag), PSRAM free=%luKB, "
+               "lowest stack %s=%lu",
+               (unsigned long)snap.internalFree, (unsigned long)snap.internalMinEver,
+               (unsigned long)snap.internalLargest, snap.internalFragPct, (unsigned long)(snap.psramFree / 1024),
+               snap.lowestStackTask, (unsigned long)snap.lowestStackFree);
+    }
+
+    vTaskDelay(pdMS_TO_TICKS(HEALTH_MONITOR_PERIOD_MS));
+  }
+}
+
+void healthMonitorBegin()
+{
+  BaseType_t result = taskLayoutSpawn(TASK_ROLE_HEALTH, healthMonitorTask, NULL, NULL);
+  if (result != pdPASS) {
+    LOG_ERROR(TAG, "❌ Failed to create health monitor");
+    return;
+  }
+  LOG_INFO(TAG, "💾 Health monitor: heap/stack every %lums", (unsigned long)HEALTH_MONITOR_PERIOD_MS);
+}
+
+HealthSnapshot healthMonitorGet()
+{
+  return published.load();
+}
+
+void healthMonitorDump(Print &out)
+{
+  HealthSnapshot snap = published.load();
+  char line[112];
+
+  if (snap.samples == 0) {
+    out.print("Health: no sample yet\n");
+    return;
+  }
+  out.print("Memory          now        min        max   min_ever    largest\n");
+  snprintf(line, sizeof(line), "internal %10lu %10lu %10lu %10lu %10lu  (%u%% frag, %u..%u%%)\n",
+           (unsigned long)snap.internalFree, (unsigned long)snap.internalFreeRange.min,
+           (unsigned long)snap.internalFreeRange.max, (unsigned long)snap.internalMinEver,
+           (unsigned long)snap.internalLargest, snap.internalFragPct, (unsigned)snap.internalFragRange.min,
+           (unsigned)snap.internalFragRange.max);
+  out.print(line);
+  snprintf(line, sizeof(line), "psram    %10lu %10lu %10lu %10lu %10lu\n",
+           (unsigned long)snap.psramFree, (unsigned long)snap.psramFreeRange.min,
+           (unsigned long)snap.psramFreeRange.max, (unsigned long)snap.psramMinEver,
+           (unsigned long)snap.psramLargest);
+  out.print(line);
+
+  snprintf(line, sizeof(line), "Events: %lu since boot, active:%s%s%s%s%s%s\n", (unsigned long)snap.events,
+           snap.active ? "" : " none",
+           (snap.active & HEALTH_HEAP_LOW) ? " heap_low" : "",
+           (snap.active & HEALTH_HEAP_CRITICAL) ? " heap_critical" : "",
+           (snap.active & HEALTH_HEAP_FRAGMENTED) ? " fragmented" : "",
+           (snap.active & HEALTH_PSRAM_LOW) ? " psram_low" : "",
+           (snap.active & HEALTH_STACK_LOW) ? " stack_low" : "");
+  out.print(line);
+
+  TaskStatsSnapshot tasks = taskStatsGet();
+  out.print("Task             Stack free\n");
+  for (uint32_t i = 0; i < tasks.count; i++) {
+    const TaskStatsEntry &e = tasks.tasks[i];
+    snprintf(line, sizeof(line), "%-16s %10lu%s\n", e.name, (unsigned long)e.stackFree,
+             e.stackFree < HEALTH_STACK_LOW_BYTES ? "  LOW" : "");
+    out.print(line);
+  }
+}
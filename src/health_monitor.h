@@ -0,0 +1,97 @@
+#ifndef HEALTH_MONITOR_H
+#define HEALTH_MONITOR_H
+
+// =============================================================================
+// Heap and Stack Health Monitor
+// =============================================================================
+// One low-priority task samples memory health for the whole system, so the
+// BLE and UI loops no longer walk the heap themselves:
+//
+//   - Internal DRAM: free, min-ever, largest free block and fragmentation
+//     (100% - largest block / free). This is what BLE scanning exhausts.
+//   - PSRAM: free, min-ever, largest free block.
+//   - Stack headroom of every task, taken from the task_stats snapshot
+//     (one uxTaskGetSystemState() walk serves both modules).
+//
+// Every HEALTH_MONITOR_PERIOD_MS it updates the gauges below (with their
+// peaks) and the min/max since boot, and compares against the HEALTH_*
+// thresholds. A threshold is an event: logged once when it trips and once
+// when it clears, counted in health_events_total, and visible in
+// healthMonitorGet().active. A summary line is logged every
+// HEALTH_MONITOR_LOG_MS; the "health" serial / WebSerial command prints the
+// full report.
+//
+// HEALTH_MONITOR_PERIOD_MS (compile-time, -DHEALTH_MONITOR_PERIOD_MS=<ms>):
+//   sampling cadence, default 5000. heap_caps_get_largest_free_block() walks
+//   the heap under its lock, so keep it in seconds.
+//
+// Thread Safety:
+//   The monitor task is the only writer of the published snapshot (SeqLock);
+//   healthMonitorGet() and healthMonitorDump() read it from any task.
+// =============================================================================
+
+#include <Arduino.h>
+
+#ifndef HEALTH_MONITOR_PERIOD_MS
+#define HEALTH_MONITOR_PERIOD_MS 5000
+#endif
+
+constexpr uint32_t HEALTH_MONITOR_LOG_MS          = 30000;   // Summary line
+
+// Thresholds (bytes unless noted)
+constexpr uint32_t HEALTH_HEAP_LOW_BYTES          = 100000;  // Internal DRAM free
+constexpr uint32_t HEALTH_HEAP_CRITICAL_BYTES     = 50000;
+constexpr uint32_t HEALTH_LARGEST_BLOCK_BYTES     = 20000;   // Internal largest free block
+constexpr uint32_t HEALTH_PSRAM_LOW_BYTES         = 262144;
+constexpr uint32_t HEALTH_STACK_LOW_BYTES         = 1024;    // Any task's stack headroom
+
+// Bits of HealthSnapshot::active
+enum HealthEvent : uint8_t {
+  HEALTH_HEAP_LOW        = 1 << 0,
+  HEALTH_HEAP_CRITICAL   = 1 << 1,
+  HEALTH_HEAP_FRAGMENTED = 1 << 2,  // Largest block below HEALTH_LARGEST_BLOCK_BYTES
+  HEALTH_PSRAM_LOW       = 1 << 3,
+  HEALTH_STACK_LOW       = 1 << 4   // At least one task below HEALTH_STACK_LOW_BYTES
+};
+
+struct HealthRange {
+  uint32_t min;
+  uint32_t max;
+};
+
+struct HealthSnapshot {
+  uint32_t samples;             // 0 until the first sample
+  uint32_t internalFree;
+  uint32_t internalMinEver;     // heap_caps_get_minimum_free_size()
+  uint32_t internalLargest;
+  uint8_t internalFragPct;
+  uint32_t psramFree;
+  uint32_t psramMinEver;
+  uint32_t psramLargest;
+  HealthRange internalFreeRange;     // Over all samples since boot
+  HealthRange internalLargestRange;
+  HealthRange internalFragRange;
+  HealthRange psramFreeRange;
+  char lowestStackTask[16];     // Task with the least stack headroom
+  uint32_t lowestStackFree;
+  uint8_t active;               // HealthEvent bits currently tripped
+  uint32_t events;              // Threshold trips since boot
+};
+
+/**
+ * @brief Start the monitor task
+ * @note Call after taskStatsBegin() - stack headroom comes from its snapshot
+ */
+void healthMonitorBegin();
+
+/**
+ * @brief Most recent snapshot (lock-free)
+ */
+HealthSnapshot healthMonitorGet();
+
+/**
+ * @brief Print heap, PSRAM, min/max history, active events and per-task stack headroom
+ */
+void healthMonitorDump(Print &out);
+
+#endif // HEALTH_MONITOR_H
@@ -0,0 +1,148 @@
+// =============================================================================
+// Shared I2C Bus Manager Implementation
+// =============================================================================
+
+#include "i2c_bus.h"
+#include "debug_config.h"
+#include "metrics.h"
+#include "driver/i2c.h"
+#include "static_alloc.h"
+
+static const char *const CLIENT_NAMES[I2C_CLIENT_COUNT] = {"touch", "pmu", "other"};
+
+struct ClientStats {
+  volatile uint32_t transactions;
+  volatile uint32_t errors;
+  volatile uint32_t timeouts;
+  volatile uint32_t busUsMax;
+  volatile uint32_t busUsTotal;
+};
+
+static ClientStats stats[I2C_CLIENT_COUNT];
+static volatile uint32_t queueFull = 0;
+
+static MetricHistogram jobWaitUs("i2c_job_wait_us", "Queued I2C job: submit → start (waits for touch gaps)", METRIC_BUCKETS_US);
+static MetricHistogram jobBusUs("i2c_job_bus_us", "Queued I2C job time on the bus", METRIC_BUCKETS_US);
+static MetricCounterRef jobsRejected("i2c_queue_full_total", "I2C jobs rejected by a full queue", &queueFull);
+static MetricCounterRef pmuErrors("i2c_pmu_errors_total", "Failed PMU bus jobs", &stats[I2C_CLIENT_PMU].errors);
+
+static QueueHandle_t queues[I2C_PRIO_COUNT] = {};
+static StaticQueue<I2CBusJob, I2C_BUS_QUEUE_LEN> queueStore[I2C_PRIO_COUNT];
+static volatile TaskHandle_t owner = NULL;
+static uint32_t ownerBits = 0;
+
+static void account(I2CBusClient client, esp_err_t err, uint32_t us)
+{
+  ClientStats &s = stats[client];
+  s.transactions++;
+  s.busUsTotal += us;
+  if (us > s.busUsMax)
+    s.busUsMax = us;
+  if (err == ESP_OK)
+    return;
+  if (err == ESP_ERR_TIMEOUT)
+    s.timeouts++;
+  else
+    s.errors++;
+}
+
+void i2cBusBegin()
+{
+  for (uint8_t p = 0; p < I2C_PRIO_COUNT; p++)
+    queues[p] = queueStore[p].create();
+}
+
+void i2cBusSetOwner(TaskHandle_t task, uint32_t notifyBits)
+{
+  ownerBits = notifyBits;
+  owner = task;
+  if (task != NULL && i2cBusPending())
+    xTaskNotify(task, notifyBits, eSetBits);  // Jobs submitted before the owner existed
+}
+
+bool i2cBusSubmit(const I2CBusJob &job, I2CBusPriority priority)
+{
+  if (queues[priority] == NULL)
+    return false;
+  I2CBusJob queued = job;
+  queued.submittedUs = (uint32_t)esp_timer_get_time();
+  if (xQueueSend(queues[priority], &queued, 0) != pdTRUE) {
+    queueFull++;
+    return false;
+  }
+  TaskHandle_t task = owner;
+  if (task != NULL)
+    xTaskNotify(task, ownerBits, eSetBits);
+  return true;
+}
+
+esp_err_t i2cBusTransfer(I2CBusClient client, uint8_t addr, const uint8_t *tx, size_t txLen,
+                         uint8_t *rx, size_t rxLen, uint8_t flags)
+{
+  const TickType_t timeout = pdMS_TO_TICKS(I2C_BUS_TIMEOUT_MS);
+  int64_t startUs = esp_timer_get_time();
+  esp_err_t err;
+  if (txLen && rxLen && !(flags & I2C_JOB_STOP_BETWEEN)) {
+    err = i2c_master_write_read_device(I2C_BUS_PORT, addr, tx, txLen, rx, rxLen, timeout);
+  } else {
+    err = ESP_OK;
+    if (txLen)
+      err = i2c_master_write_to_device(I2C_BUS_PORT, addr, tx, txLen, timeout);
+    if (err == ESP_OK && rxLen)
+      err = i2c_master_read_from_device(I2C_BUS_PORT, addr, rx, rxLen, timeout);
+  }
+  account(client, err, (uint32_t)(esp_timer_get_time() - startUs));
+  return err;
+}
+
+bool i2cBusPending()
+{
+  for (uint8_t p = 0; p < I2C_PRIO_COUNT; p++) {
+    if (queues[p] != NULL && uxQueueMessagesWaiting(queues[p]) > 0)
+      return true;
+  }
+  return false;
+}
+
+bool i2cBusRunOne()
+{
+  I2CBusJob job;
+  bool found = false;
+  for (uint8_t p = 0; p < I2C_PRIO_COUNT && !found; p++)
+    found = queues[p] != NULL && xQueueReceive(queues[p], &job, 0) == pdTRUE;
+  if (!found)
+    return false;
+
+  uint32_t startUs = (uint32_t)esp_timer_get_time();
+  jobWaitUs.record(startUs - job.submittedUs);
+
+  esp_err_t err;
+  if (job.fn != NULL) {
+    err = job.fn(job.arg) ? ESP_OK : ESP_FAIL;
+    account(job.client, err, (uint32_t)esp_timer_get_time() - startUs);
+  } else {
+    err = i2cBusTransfer(job.client, job.addr, job.tx, job.txLen, job.rx, job.rxLen, job.flags);
+  }
+  jobBusUs.record((uint32_t)esp_timer_get_time() - startUs);
+
+  if (job.done != NULL)
+    job.done(err, job.arg);
+  return true;
+}
+
+void i2cBusDump(Print &out)
+{
+  out.printf("[I2C] port %d, %lu jobs rejected (queue full)\n", I2C_BUS_PORT, (unsigned long)queueFull);
+  for (uint8_t c = 0; c < I2C_CLIENT_COUNT; c++) {
+    const ClientStats &s = stats[c];
+    if (s.transactions == 0)
+      continue;
+    out.printf("  %-6s %7lu xfers, %lu errors, %lu timeouts, bus avg %luus max %luus\n", CLIENT_NAMES[c],
+               (unsigned long)s.transactions, (unsigned long)s.errors, (unsigned long)s.timeouts,
+               (unsigned long)(s.busUsTotal / s.transactions), (unsigned long)s.busUsMax);
+  }
+  HistogramSnapshot wait;
+  jobWaitUs.snapshot(&wait);
+  out.printf("  %lu queued jobs: wait p50 %luus, max %luus\n", (unsigned long)wait.count,
+             (unsigned long)jobWaitUs.percentile(wait, 0.5f), (unsigned long)wait.max);
+}
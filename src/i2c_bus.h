@@ -0,0 +1,110 @@
+#ifndef I2C_BUS_H
+#define I2C_BUS_H
+
+// =============================================================================
+// Shared I2C Bus Manager (touch controller + SY6970 PMU)
+// =============================================================================
+// Touch (0x3B) and the PMU (0x6A) share I2C_NUM_0 at 100 kHz. One task owns
+// the bus - the touch task (touch_input.h) - and runs everything on it in
+// priority order:
+//
+//   1. touch reads         on INT / while a finger is down, never queued
+//   2. I2C_PRIO_HIGH jobs  in the gaps, before anything below
+//   3. I2C_PRIO_LOW jobs   in the gaps (PMU telemetry polling)
+//
+// "Gap" = no finger down and no controller hold-off. Between two queued jobs
+// the owner checks for a new touch INT and serves it first, so a queued job
+// delays a touch read by at most the one job already on the wire.
+//
+// A job is either a register transaction (write tx, then read rx - repeated
+// start, or STOP in between with I2C_JOB_STOP_BETWEEN) or a callback that
+// drives the bus itself (driver libraries on Wire, e.g. XPowersLib). Jobs are
+// submitted from any task and complete asynchronously: `done` runs on the
+// bus task with the result. Buffers must stay valid until then.
+//
+// Stats per client (transactions, errors, timeouts, queue wait, bus time) on
+// "i2c" (serial console) and as i2c_* metrics.
+//
+// Thread Safety:
+//   i2cBusSubmit() / i2cBusDump() - any task.
+//   i2cBusTransfer() / i2cBusRunOne() / i2cBusPending() - bus owner task only.
+// =============================================================================
+
+#include <Arduino.h>
+#include "esp_err.h"
+
+constexpr int I2C_BUS_PORT              = 0;      // I2C_NUM_0 - installed by Wire.begin()
+constexpr uint32_t I2C_BUS_TIMEOUT_MS   = 50;     // Driver timeout per transaction phase
+constexpr UBaseType_t I2C_BUS_QUEUE_LEN = 8;      // Per priority
+
+enum I2CBusClient : uint8_t {
+  I2C_CLIENT_TOUCH = 0,
+  I2C_CLIENT_PMU,
+  I2C_CLIENT_OTHER,
+  I2C_CLIENT_COUNT
+};
+
+enum I2CBusPriority : uint8_t {
+  I2C_PRIO_HIGH = 0,
+  I2C_PRIO_LOW,
+  I2C_PRIO_COUNT
+};
+
+constexpr uint8_t I2C_JOB_STOP_BETWEEN = 1u << 0;   // STOP after tx instead of a repeated start
+
+typedef bool (*I2CBusJobFn)(void *arg);                       // Runs with the bus; false = failed
+typedef void (*I2CBusDoneFn)(esp_err_t result, void *arg);    // Completion, on the bus task
+
+struct I2CBusJob {
+  I2CBusClient client;
+  uint8_t flags;              // I2C_JOB_*
+  uint8_t addr;
+  uint8_t txLen;
+  uint8_t rxLen;
+  const uint8_t *tx;
+  uint8_t *rx;
+  I2CBusJobFn fn;             // Non-NULL: callback job (addr / tx / rx unused)
+  I2CBusDoneFn done;          // Optional
+  void *arg;
+  uint32_t submittedUs;       // Set by i2cBusSubmit()
+};
+
+/**
+ * @brief Create the job queues; call once in setup() before any submit
+ */
+void i2cBusBegin();
+
+/**
+ * @brief Task that runs the jobs, woken with xTaskNotify(`notifyBits`, eSetBits) on submit
+ */
+void i2cBusSetOwner(TaskHandle_t owner, uint32_t notifyBits);
+
+/**
+ * @brief Queue a job (copied; its buffers are not) - any task, never blocks
+ * @return false if that priority's queue is full (counted)
+ */
+bool i2cBusSubmit(const I2CBusJob &job, I2CBusPriority priority);
+
+/**
+ * @brief Run one write / read transaction now and account it (bus owner only)
+ */
+esp_err_t i2cBusTransfer(I2CBusClient client, uint8_t addr, const uint8_t *tx, size_t txLen,
+                         uint8_t *rx, size_t rxLen, uint8_t flags);
+
+/**
+ * @brief True if jobs are queued (bus owner)
+ */
+bool i2cBusPending();
+
+/**
+ * @brief Run the highest priority queued job (bus owner, in a gap)
+ * @return false if nothing was queued
+ */
+bool i2cBusRunOne();
+
+/**
+ * @brief Per-client transaction, error and latency counts
+ */
+void i2cBusDump(Print &out);
+
+#endif // I2C_BUS_H
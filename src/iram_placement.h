@@ -0,0 +1,65 @@
+#ifndef IRAM_PLACEMENT_H
+#define IRAM_PLACEMENT_H
+
+// =============================================================================
+// IRAM Placement Policy (real-time paths out of the flash cache)
+// =============================================================================
+// Code in flash runs through the instruction cache. A miss costs a flash
+// read, and while an NVS commit, a LittleFS write or an OTA chunk is being
+// written the cache is off altogether: the writing task's core runs only
+// IRAM code, and the other core is parked until the write finishes.
+//
+// Functions on these paths carry GS_HOT_IRAM:
+//
+//   display DMA   lcd_PushColors(), bounce_start(), bounce_fill_and_queue(),
+//                 rotate rows, window commands (AXS15231B.cpp)
+//   blend loops   draw_s3.cpp rows and memFastCopy() / memFastFill16()
+//   HCI RX        VHCI callback, HCI poll, ACL, ATT notification dispatch
+//                 (lib/ArduinoBLE, HCI_RX_ATTR), the READ characteristic
+//                 callback and the scale drivers' parse()
+//   relay         cut timer callback; the relay pin is written through
+//                 gpio_ll (inline), not digitalWrite() (flash)
+//
+// Only leaf code belongs on the list. A function that calls into flash
+// (esp_timer_start_once() / esp_timer_stop(), shotEventsRecord(), LOG_*,
+// the predictor and filter updates) waits on the cache all the same, so its
+// IRAM copy costs DRAM for nothing: processWeightSample() and
+// relayControlSet() / ScheduleOff() / Cancel() stay in flash.
+//
+// ISRs keep IRAM_ATTR - they need it regardless of this policy.
+//
+// GCC drops section attributes on template instantiations, and an IRAM
+// function inlined into a flash caller runs from flash: template code on
+// these paths forwards to a non-inline, attributed function (ScaleDriver.cpp).
+//
+// IRAM is not free: on the S3 every byte of it comes out of internal DRAM
+// (heap for BLE, LVGL and the DMA bounce buffers). Check the cost with
+// tools/iram_report/iram_report.py after adding to the list.
+//
+// What IRAM cannot do: a task still stops while the cache is off, whatever
+// its code's placement. The firmware keeps flash writes out of a shot
+// instead - settingsStorePoll() is skipped while brewing, the shot log,
+// statistics and offset models are written after the stop, and OTA is not
+// accepted during a shot. Placement removes the cache misses around those
+// writes and under display DMA load.
+//
+// GS_IRAM_HOT (compile-time, -DGS_IRAM_HOT=0):
+//   1 - GS_HOT_IRAM places the function in IRAM (default)
+//   0 - Everything stays in flash; for measuring the IRAM cost or the
+//       latency difference (tools/hil_timing)
+//
+// Host builds (GS_NATIVE) compile GS_HOT_IRAM to nothing.
+// =============================================================================
+
+#ifndef GS_IRAM_HOT
+#define GS_IRAM_HOT 1
+#endif
+
+#if GS_IRAM_HOT && !defined(GS_NATIVE)
+#include <esp_attr.h>
+#define GS_HOT_IRAM IRAM_ATTR
+#else
+#define GS_HOT_IRAM
+#endif
+
+#endif // IRAM_PLACEMENT_H
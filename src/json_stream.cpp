@@ -0,0 +1,422 @@
+// =============================================================================
+// Streaming JSON Reader / Writer Implementation
+// =============================================================================
+
+#include "json_stream.h"
+
+// -----------------------------------------------------------------------------
+// Values
+// -----------------------------------------------------------------------------
+
+bool JsonValue::integer(long *out) const
+{
+  if (event != JSON_NUMBER || strpbrk(text, ".eE") != NULL)
+    return false;
+  char *end;
+  *out = strtol(text, &end, 10);
+  return *end == '\0';
+}
+
+bool JsonValue::decimal(float *out) const
+{
+  if (event != JSON_NUMBER)
+    return false;
+  char *end;
+  *out = strtof(text, &end);
+  return *end == '\0';
+}
+
+// -----------------------------------------------------------------------------
+// Reader
+// -----------------------------------------------------------------------------
+
+JsonReader::JsonReader(JsonHandler &handler) : handler(handler)
+{
+  reset();
+}
+
+void JsonReader::reset()
+{
+  state = S_VALUE;
+  stringIsKey = false;
+  escape = 0;
+  unicode = 0;
+  depth = 0;
+  objects = 0;
+  tokenLen = 0;
+  token[0] = '\0';
+  keys[0][0] = '\0';
+  position = 0;
+  failure = NULL;
+}
+
+bool JsonReader::fail(const char *why)
+{
+  if (failure == NULL)
+    failure = why;
+  state = S_FAILED;
+  return false;
+}
+
+bool JsonReader::append(char c)
+{
+  if (tokenLen + 1 >= JSON_TOKEN_MAX)
+    return fail("string or number too long");
+  token[tokenLen++] = c;
+  token[tokenLen] = '\0';
+  return true;
+}
+
+bool JsonReader::emit(JsonEvent event)
+{
+  bool inObject = depth > 0 && (objects & (1u << (depth - 1)));
+  JsonValue v;
+  v.event = event;
+  v.depth = depth;
+  v.index = depth > 0 ? counts[depth - 1] : 0;
+  v.key = inObject ? keys[depth] : "";
+  v.text = token;
+  if (!handler.onJson(v))
+    return fail("value refused");
+  return true;
+}
+
+bool JsonReader::push(bool object)
+{
+  if (depth >= JSON_MAX_DEPTH)
+    return fail("nested too deep");
+  tokenLen = 0;
+  token[0] = '\0';
+  if (!emit(object ? JSON_OBJECT_BEGIN : JSON_ARRAY_BEGIN))
+    return false;
+  depth++;   // keys[depth - 1] - the parent's current member - is now this container's key
+  counts[depth - 1] = 0;
+  keys[depth][0] = '\0';
+  if (object)
+    objects |= 1u << (depth - 1);
+  else
+    objects &= ~(1u << (depth - 1));
+  state = object ? S_KEY_OR_END : S_VALUE_OR_END;
+  return true;
+}
+
+bool JsonReader::pop(bool object)
+{
+  if (depth == 0 || ((objects >> (depth - 1)) & 1u) != (object ? 1u : 0u))
+    return fail(object ? "unexpected '}'" : "unexpected ']'");
+  depth--;
+  tokenLen = 0;
+  token[0] = '\0';
+  if (!emit(object ? JSON_OBJECT_END : JSON_ARRAY_END))
+    return false;
+  return valueDone();
+}
+
+bool JsonReader::valueDone()
+{
+  if (depth == 0) {
+    state = S_DONE;
+    return true;
+  }
+  counts[depth - 1]++;
+  state = S_AFTER;
+  return true;
+}
+
+static bool isNumberChar(char c)
+{
+  return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+}
+
+static int hexValue(char c)
+{
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F')
+    return c - 'A' + 10;
+  return -1;
+}
+
+bool JsonReader::step(char c)
+{
+  bool space = c == ' ' || c == '\t' || c == '\r' || c == '\n';
+
+  switch (state) {
+  case S_STRING:
+    if (escape == 1) {
+      escape = 0;
+      switch (c) {
+      case '"': case '\\': case '/': return append(c);
+      case 'n': return append('\n');
+      case 't': return append('\t');
+      case 'r': return append('\r');
+      case 'b': return append('\b');
+      case 'f': return append('\f');
+      case 'u': escape = 2; unicode = 0; return true;
+      default: return fail("bad escape");
+      }
+    }
+    if (escape >= 2) {
+      int h = hexValue(c);
+      if (h < 0)
+        return fail("bad \\u escape");
+      unicode = (unicode << 4) | h;
+      if (++escape < 6)
+        return true;
+      escape = 0;
+      return append(unicode < 0x80 ? (char)unicode : '?');
+    }
+    if (c == '\\') {
+      escape = 1;
+      return true;
+    }
+    if ((uint8_t)c < 0x20)
+      return fail("control character in string");
+    if (c != '"')
+      return append(c);
+    if (stringIsKey) {
+      memcpy(keys[depth], token, tokenLen + 1);
+      state = S_COLON;
+      return true;
+    }
+    return emit(JSON_STRING) && valueDone();
+
+  case S_NUMBER:
+    if (isNumberChar(c))
+      return append(c);
+    {
+      char *end;
+      strtod(token, &end);
+      if (*end != '\0' || token[tokenLen - 1] == '-')
+        return fail("bad number");
+    }
+    if (!emit(JSON_NUMBER) || !valueDone())
+      return false;
+    return step(c);   // The byte after the number belongs to the container
+
+  case S_LITERAL:
+    if (c >= 'a' && c <= 'z')
+      return append(c);
+    if (strcmp(token, "true") == 0 || strcmp(token, "false") == 0) {
+      if (!emit(JSON_BOOL))
+        return false;
+    } else if (strcmp(token, "null") == 0) {
+      if (!emit(JSON_NULL))
+        return false;
+    } else {
+      return fail("unknown literal");
+    }
+    if (!valueDone())
+      return false;
+    return step(c);
+
+  case S_VALUE:
+  case S_VALUE_OR_END:
+    if (space)
+      return true;
+    tokenLen = 0;
+    token[0] = '\0';
+    if (c == '{')
+      return push(true);
+    if (c == '[')
+      return push(false);
+    if (c == ']' && state == S_VALUE_OR_END)
+      return pop(false);
+    if (c == '"') {
+      stringIsKey = false;
+      state = S_STRING;
+      return true;
+    }
+    if (c == '-' || (c >= '0' && c <= '9')) {
+      state = S_NUMBER;
+      return append(c);
+    }
+    if (c >= 'a' && c <= 'z') {
+      state = S_LITERAL;
+      return append(c);
+    }
+    return fail("value expected");
+
+  case S_KEY:
+  case S_KEY_OR_END:
+    if (space)
+      return true;
+    if (c == '}' && state == S_KEY_OR_END)
+      return pop(true);
+    if (c != '"')
+      return fail("member name expected");
+    tokenLen = 0;
+    token[0] = '\0';
+    stringIsKey = true;
+    state = S_STRING;
+    return true;
+
+  case S_COLON:
+    if (space)
+      return true;
+    if (c != ':')
+      return fail("':' expected");
+    state = S_VALUE;
+    return true;
+
+  case S_AFTER:
+    if (space)
+      return true;
+    if (c == ',') {
+      state = (objects & (1u << (depth - 1))) ? S_KEY : S_VALUE;
+      return true;
+    }
+    if (c == '}')
+      return pop(true);
+    if (c == ']')
+      return pop(false);
+    return fail("',' or end of container expected");
+
+  case S_DONE:
+    return space ? true : fail("data after the document");
+
+  case S_FAILED:
+  default:
+    return false;
+  }
+}
+
+bool JsonReader::feed(const char *data, size_t len)
+{
+  for (size_t i = 0; i < len; i++) {
+    if (!step(data[i]))
+      return false;
+    position++;
+  }
+  return state != S_FAILED;
+}
+
+bool JsonReader::finish()
+{
+  if (state == S_NUMBER || state == S_LITERAL)
+    step(' ');   // A bare top-level number / literal ends with the input
+  if (state == S_FAILED)
+    return false;
+  if (state != S_DONE)
+    return fail("document incomplete");
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// Writer
+// -----------------------------------------------------------------------------
+
+void JsonWriter::quoted(const char *text)
+{
+  out.write('"');
+  for (const char *p = text; *p != '\0'; p++) {
+    char c = *p;
+    if (c == '"' || c == '\\') {
+      out.write('\\');
+      out.write(c);
+    } else if ((uint8_t)c < 0x20) {
+      out.printf("\\u%04x", (unsigned)c);
+    } else {
+      out.write(c);
+    }
+  }
+  out.write('"');
+}
+
+void JsonWriter::member(const char *key)
+{
+  if (depth > 0) {
+    uint32_t bit = 1u << (depth - 1);
+    if (started & bit)
+      out.write(',');
+    started |= bit;
+  }
+  if (key != NULL && depth > 0 && (objects & (1u << (depth - 1)))) {
+    quoted(key);
+    out.write(':');
+  }
+}
+
+void JsonWriter::beginObject(const char *key)
+{
+  member(key);
+  out.write('{');
+  if (depth < 32) {
+    depth++;
+    objects |= 1u << (depth - 1);
+    started &= ~(1u << (depth - 1));
+  }
+}
+
+void JsonWriter::endObject()
+{
+  out.write('}');
+  if (depth > 0)
+    depth--;
+}
+
+void JsonWriter::beginArray(const char *key)
+{
+  member(key);
+  out.write('[');
+  if (depth < 32) {
+    depth++;
+    objects &= ~(1u << (depth - 1));
+    started &= ~(1u << (depth - 1));
+  }
+}
+
+void JsonWriter::endArray()
+{
+  out.write(']');
+  if (depth > 0)
+    depth--;
+}
+
+void JsonWriter::string(const char *key, const char *value)
+{
+  member(key);
+  quoted(value);
+}
+
+void JsonWriter::number(const char *key, long value)
+{
+  member(key);
+  out.print(value);
+}
+
+void JsonWriter::decimal(const char *key, float value, uint8_t decimals)
+{
+  member(key);
+  if (isnan(value) || isinf(value))
+    out.print("null");
+  else
+    out.print(value, decimals);
+}
+
+void JsonWriter::boolean(const char *key, bool value)
+{
+  member(key);
+  out.print(value ? "true" : "false");
+}
+
+// -----------------------------------------------------------------------------
+// Window
+// -----------------------------------------------------------------------------
+
+size_t WindowPrint::write(uint8_t c)
+{
+  if (seen >= skip && kept < len)
+    buffer[kept++] = c;
+  seen++;
+  return 1;
+}
+
+size_t WindowPrint::write(const uint8_t *data, size_t size)
+{
+  for (size_t i = 0; i < size; i++)
+    write(data[i]);
+  return size;
+}
@@ -0,0 +1,188 @@
+#ifndef JSON_STREAM_H
+#define JSON_STREAM_H
+
+// =============================================================================
+// Streaming JSON Reader / Writer (fixed buffers, no DOM)
+// =============================================================================
+// Profiles and settings move between units and the dashboard as JSON. A DOM
+// library would build the whole document on the heap - an import of every
+// profile slot is a few KB of small allocations on a device whose internal
+// DRAM margin bleTaskFunction already watches. Both directions here stream:
+//
+//   JsonReader  push parser: feed() takes the document in any pieces (HTTP
+//               body chunks, serial lines) and calls the handler once per
+//               value, container begin and container end, as soon as the
+//               value is complete. State is one fixed object: a container
+//               stack of JSON_MAX_DEPTH levels, the last key per level and
+//               one JSON_TOKEN_MAX scratch token. A longer key or string,
+//               deeper nesting or a syntax error stops the parse with an
+//               error and the byte offset.
+//   JsonWriter  writes straight to a Print, commas and nesting tracked in
+//               two bit masks; nothing is buffered.
+//
+//   class Import : public JsonHandler {
+//     bool onJson(const JsonValue &v) override {
+//       long n;
+//       if (v.depth == 1 && strcmp(v.key, "goal") == 0)
+//         return v.integer(&n) && n > 0 && n <= 80 && stage(n);   // false aborts
+//       return true;                                                // Unknown: skipped
+//     }
+//   };
+//   JsonReader reader(import);
+//   reader.feed(chunk, len); ... reader.finish();
+//
+// The handler validates as it goes: returning false stops the parse at that
+// value, so a bad document is refused before the rest of it is read.
+// Strings support the JSON escapes; \uXXXX above 0x7F becomes '?'. Numbers
+// are handed over as text with integer() / decimal() accessors.
+//
+// WindowPrint lets a writer run again per HTTP chunk: it drops the bytes
+// before the chunk's offset and keeps at most one chunk - a document of a
+// few KB is regenerated per chunk instead of being held in RAM.
+//
+// Thread Safety:
+//   None; one reader / writer per caller.
+// =============================================================================
+
+#include <Arduino.h>
+
+constexpr uint8_t JSON_MAX_DEPTH = 8;    // Nested objects / arrays
+constexpr uint8_t JSON_TOKEN_MAX = 32;   // Longest key, string or number incl. NUL
+
+enum JsonEvent : uint8_t {
+  JSON_OBJECT_BEGIN,
+  JSON_OBJECT_END,
+  JSON_ARRAY_BEGIN,
+  JSON_ARRAY_END,
+  JSON_STRING,
+  JSON_NUMBER,
+  JSON_BOOL,
+  JSON_NULL
+};
+
+struct JsonValue {
+  JsonEvent event;
+  uint8_t depth;        // Container level the value sits in (1 = member of the document's object / array)
+  uint16_t index;       // Position in that container
+  const char *key;      // Member name, "" inside arrays
+  const char *text;     // JSON_STRING / JSON_NUMBER text, "true" / "false" / "null"
+
+  bool boolean() const { return event == JSON_BOOL && text[0] == 't'; }
+
+  /** @brief JSON_NUMBER without fraction or exponent */
+  bool integer(long *out) const;
+
+  /** @brief Any JSON_NUMBER */
+  bool decimal(float *out) const;
+};
+
+class JsonHandler {
+public:
+  /**
+   * @return false to stop the parse (the value was refused)
+   */
+  virtual bool onJson(const JsonValue &value) = 0;
+
+protected:
+  ~JsonHandler() {}
+};
+
+class JsonReader {
+public:
+  explicit JsonReader(JsonHandler &handler);
+
+  void reset();
+
+  /**
+   * @brief Parse the next `len` bytes of the document
+   * @return false once the document is invalid or the handler refused a value
+   */
+  bool feed(const char *data, size_t len);
+
+  /**
+   * @brief End of input: true if exactly one complete document was read
+   */
+  bool finish();
+
+  /** @brief The document's outermost value is closed (finish() would succeed) */
+  bool complete() const { return state == S_DONE; }
+
+  /** @brief Key of the container at `level` in its parent ("" at the top or in arrays) */
+  const char *containerKey(uint8_t level) const { return level <= depth ? keys[level - 1] : ""; }
+
+  const char *error() const { return failure; }
+  uint32_t offset() const { return position; }
+
+private:
+  enum State : uint8_t { S_VALUE, S_VALUE_OR_END, S_KEY, S_KEY_OR_END, S_COLON, S_AFTER, S_STRING, S_NUMBER,
+                         S_LITERAL, S_DONE, S_FAILED };
+
+  bool step(char c);
+  bool fail(const char *why);
+  bool append(char c);
+  bool emit(JsonEvent event);
+  bool push(bool object);
+  bool pop(bool object);
+  bool valueDone();
+
+  JsonHandler &handler;
+  State state;
+  bool stringIsKey;
+  uint8_t escape;                        // 0, 1 after '\', 2-5 inside \uXXXX
+  uint16_t unicode;
+  uint8_t depth;
+  uint32_t objects;                      // Bit per level: object (1) or array (0)
+  uint16_t counts[JSON_MAX_DEPTH];
+  char keys[JSON_MAX_DEPTH + 1][JSON_TOKEN_MAX];   // [level - 1] = container's key, [level] = current member
+  char token[JSON_TOKEN_MAX];
+  uint8_t tokenLen;
+  uint32_t position;
+  const char *failure;
+};
+
+class JsonWriter {
+public:
+  explicit JsonWriter(Print &out) : out(out), depth(0), objects(0), started(0) {}
+
+  // `key` is the member name inside an object, NULL inside arrays / at the top
+  void beginObject(const char *key = NULL);
+  void endObject();
+  void beginArray(const char *key = NULL);
+  void endArray();
+  void string(const char *key, const char *value);
+  void number(const char *key, long value);
+  void decimal(const char *key, float value, uint8_t decimals);
+  void boolean(const char *key, bool value);
+
+private:
+  void member(const char *key);
+  void quoted(const char *text);
+
+  Print &out;
+  uint8_t depth;
+  uint32_t objects;
+  uint32_t started;    // Bit per level: a member was written (next one needs a comma)
+};
+
+/**
+ * @brief Print that keeps bytes [skip, skip + len) of what is written into `buffer`
+ */
+class WindowPrint : public Print {
+public:
+  WindowPrint(uint8_t *buffer, size_t len, size_t skip) : buffer(buffer), len(len), skip(skip), seen(0), kept(0) {}
+
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t *data, size_t size) override;
+
+  size_t used() const { return kept; }
+  size_t total() const { return seen; }
+
+private:
+  uint8_t *buffer;
+  size_t len;
+  size_t skip;
+  size_t seen;
+  size_t kept;
+};
+
+#endif // JSON_STREAM_H
@@ -0,0 +1,161 @@
+#ifndef LABEL_BIND_H
+#define LABEL_BIND_H
+
+// =============================================================================
+// Numeric Label Binding (weight / timer value labels)
+// =============================================================================
+// A NumericLabel binds one LVGL label to a number with a fixed-point format
+// (field width, decimals) and a minimum redraw interval:
+//
+//   value ──► set() ──► scaled, rounded integer, same as shown? drop
+//                       interval not elapsed? hold (newest wins)
+//                       otherwise format into the idle half of the text
+//                       buffer, swap, lv_label_set_text_static()
+//   service() later applies a held value once its interval has passed.
+//
+// Change detection compares integers, and the text is only formatted when it
+// reaches the label: no dtostrf() / printf float code, no scratch buffer and
+// no copy into a gate. The two text halves alternate, so the half LVGL points
+// at is never rewritten while it is shown.
+//
+// Output matches dtostrf(value, width, decimals) - right aligned, same
+// rounding: the float times 10^decimals is exact in a double and rint() ties
+// to even as printf does - except that values rounding to zero show without
+// a sign ("  0.0" rather than " -0.0" for tare jitter). NaN keeps the shown
+// value.
+//
+// The label is looked up through its SquareLine global (lv_obj_t **), so a
+// binding can be declared before ui_init() and is inert while it is NULL.
+// Given its screen as well, a binding holds values while another screen is
+// shown and applies the newest one when its screen is back (ui_model.h).
+//
+// Not thread safe - UI task (Core 1) only, like the labels themselves.
+// =============================================================================
+
+#include <Arduino.h>
+#include <math.h>
+#include "lvgl.h"
+
+class NumericLabel {
+public:
+  static constexpr size_t TEXT_SIZE = 16;
+
+  NumericLabel(lv_obj_t **label, uint8_t width, uint8_t decimals, uint32_t minIntervalMs,
+               lv_obj_t **screen = NULL)
+    : target(label), screen(screen), width(width), decimals(decimals > 3 ? 3 : decimals), interval(minIntervalMs),
+      lastSetMs(0), held(false), front(0), shownFixed(0), pendingFixed(0)
+  {
+    format(text[front], 0);
+  }
+
+  /**
+   * @brief Propose a new value
+   * @return true if the label text changed now
+   */
+  bool set(float value, uint32_t nowMs)
+  {
+    if (value != value)
+      return false;
+    pendingFixed = toFixed(value);
+    held = pendingFixed != shownFixed;
+    return service(nowMs);
+  }
+
+  /**
+   * @brief Apply a held value whose interval has passed
+   * @return true if the label text changed now
+   */
+  bool service(uint32_t nowMs)
+  {
+    if (!held || (nowMs - lastSetMs) < interval || *target == NULL || !visible())
+      return false;
+    format(text[front ^ 1], pendingFixed);
+    front ^= 1;
+    shownFixed = pendingFixed;
+    held = false;
+    lastSetMs = nowMs;
+    lv_label_set_text_static(*target, text[front]);
+    return true;
+  }
+
+  /**
+   * @brief Milliseconds until service() would apply the held value
+   * @return UINT32_MAX if nothing is held or the label's screen is not shown
+   */
+  uint32_t dueInMs(uint32_t nowMs) const
+  {
+    if (!held || !visible())
+      return UINT32_MAX;
+    uint32_t elapsed = nowMs - lastSetMs;
+    return (elapsed >= interval) ? 0 : interval - elapsed;
+  }
+
+  /**
+   * @brief Put the shown text on the label (after ui_init(), or a screen rebuild)
+   */
+  void attach()
+  {
+    if (*target != NULL)
+      lv_label_set_text_static(*target, text[front]);
+  }
+
+  const char *shown() const { return text[front]; }
+
+private:
+  bool visible() const { return screen == NULL || *screen == lv_scr_act(); }
+
+  static constexpr int32_t FIXED_LIMIT = 999999999;  // Nine digits: sign, point and padding still fit TEXT_SIZE
+
+  int32_t toFixed(float value) const
+  {
+    static constexpr double SCALE[] = {1.0, 10.0, 100.0, 1000.0};
+    double scaled = rint((double)value * SCALE[decimals]);
+    if (scaled >= (double)FIXED_LIMIT)
+      return FIXED_LIMIT;
+    if (scaled <= -(double)FIXED_LIMIT)
+      return -FIXED_LIMIT;
+    return (int32_t)scaled;
+  }
+
+  // Digits are produced right to left into a scratch run, then placed after the padding
+  void format(char *out, int32_t fixed) const
+  {
+    char rev[TEXT_SIZE];
+    size_t n = 0;
+    uint32_t mag = (fixed < 0) ? (uint32_t)(-fixed) : (uint32_t)fixed;
+    for (uint8_t i = 0; i < decimals; i++) {
+      rev[n++] = (char)('0' + mag % 10);
+      mag /= 10;
+    }
+    if (decimals > 0)
+      rev[n++] = '.';
+    do {
+      rev[n++] = (char)('0' + mag % 10);
+      mag /= 10;
+    } while (mag != 0);
+    if (fixed < 0)
+      rev[n++] = '-';
+
+    size_t pad = (width > n && width < TEXT_SIZE) ? width - n : 0;
+    size_t len = 0;
+    while (len < pad)
+      out[len++] = ' ';
+    while (n > 0)
+      out[len++] = rev[--n];
+    out[len] = '\0';
+  }
+
+  lv_obj_t **target;
+  lv_obj_t **screen;  // NULL = always shown
+  uint8_t width;
+  uint8_t decimals;
+  uint32_t interval;
+  uint32_t lastSetMs;
+  bool held;
+  uint8_t front;
+  int32_t shownFixed;
+  int32_t pendingFixed;
+  char text[2][TEXT_SIZE];
+};
+
+#endif // LABEL_BIND_H
@@ -0,0 +1,83 @@
+#ifndef LABEL_GATE_H
+#define LABEL_GATE_H
+
+// =============================================================================
+// Change-Detecting, Rate-Limited Label Text for Gravimetric Shots
+// =============================================================================
+// Every lv_label_set_text_static() invalidates the label, so each one costs a
+// redraw of its area even when the text is the same. A LabelGate sits in
+// front of one label's display buffer:
+//
+//   formatted text ──► offer() ──► same as shown? drop
+//                                  interval not elapsed? hold (newest wins)
+//                                  otherwise copy to shown() → caller sets label
+//   service() later applies a held value once its interval has passed.
+//
+// shown() is the persistent buffer handed to lv_label_set_text_static(), so
+// it replaces the old status display buffer one for one. Numeric value labels
+// use NumericLabel (label_bind.h), which formats only what reaches the label.
+//
+// Not thread safe - UI task (Core 1) only, like the labels themselves.
+// =============================================================================
+
+#include <Arduino.h>
+
+template <size_t Size>
+class LabelGate {
+public:
+  explicit LabelGate(uint32_t minIntervalMs, const char *initial = "")
+    : interval(minIntervalMs), lastSetMs(0), held(false)
+  {
+    strncpy(shownText, initial, Size - 1);
+    shownText[Size - 1] = '\0';
+    pendingText[0] = '\0';
+  }
+
+  /**
+   * @brief Propose new text
+   * @return true if shown() changed and the label must be set now
+   */
+  bool offer(const char *text, uint32_t nowMs)
+  {
+    strncpy(pendingText, text, Size - 1);
+    pendingText[Size - 1] = '\0';
+    held = strcmp(pendingText, shownText) != 0;
+    return service(nowMs);
+  }
+
+  /**
+   * @brief Apply a held value whose interval has passed
+   * @return true if shown() changed and the label must be set now
+   */
+  bool service(uint32_t nowMs)
+  {
+    if (!held || (nowMs - lastSetMs) < interval)
+      return false;
+    memcpy(shownText, pendingText, Size);
+    held = false;
+    lastSetMs = nowMs;
+    return true;
+  }
+
+  /**
+   * @brief Milliseconds until service() would apply the held value (UINT32_MAX = nothing held)
+   */
+  uint32_t dueInMs(uint32_t nowMs) const
+  {
+    if (!held)
+      return UINT32_MAX;
+    uint32_t elapsed = nowMs - lastSetMs;
+    return (elapsed >= interval) ? 0 : interval - elapsed;
+  }
+
+  const char *shown() const { return shownText; }
+
+private:
+  uint32_t interval;
+  uint32_t lastSetMs;
+  bool held;
+  char shownText[Size];
+  char pendingText[Size];
+};
+
+#endif // LABEL_GATE_H
@@ -0,0 +1,285 @@
+// =============================================================================
+// Static Layer Cache Implementation
+// =============================================================================
+
+#include "layer_cache.h"
+#include "debug_config.h"
+#include "metrics.h"
+#include "mem_caps.h"
+#include "mem_fast.h"
+#include "esp_timer.h"
+#include "core/lv_refr.h"
+
+static constexpr LogTag TAG = LOG_TAG_UI;
+
+enum LayerMode : uint8_t {
+  LAYER_OFF,     // Not baked (or dirty): everything draws normally
+  LAYER_BAKING,  // lv_refr_obj() into the cache: dynamic objects sit out
+  LAYER_ON,      // Screen draws the cache, static objects are skipped
+};
+
+struct StaticEntry {
+  lv_obj_t *obj;
+  lv_area_t rel;  // Coordinates relative to the screen at bake time
+  lv_state_t state;
+  bool hidden;
+};
+
+static volatile uint32_t blitPx = 0;
+static volatile uint32_t invalidations = 0;
+
+static MetricCounter bakesTotal("layer_cache_bakes_total", "Main screen background renders");
+static MetricHistogram bakeUs("layer_cache_bake_us", "Main screen background render time", METRIC_BUCKETS_US);
+static MetricCounterRef blitPxTotal("layer_cache_blit_px_total", "Background pixels copied from the cache", &blitPx);
+static MetricCounterRef invalidTotal("layer_cache_invalidations_total", "Bakes dropped after a layout / style change", &invalidations);
+
+static lv_obj_t *screen = NULL;
+static StaticEntry statics[LAYER_CACHE_MAX_OBJECTS];
+static size_t staticCount = 0;
+static lv_color_t *pixels = NULL;
+static lv_coord_t bakedW = 0;
+static lv_coord_t bakedH = 0;
+static LayerMode mode = LAYER_OFF;
+static bool dirty = true;
+static unsigned long dirtySinceMs = 0;
+static uint32_t bakes = 0;
+static uint32_t lastBakeUs = 0;
+
+static void markDirty()
+{
+  if (mode == LAYER_ON) {
+    mode = LAYER_OFF;
+    invalidations++;
+    lv_obj_invalidate(screen);  // Redraw with the static objects back in
+  }
+  dirty = true;
+  dirtySinceMs = millis();
+}
+
+// Only the real frame buffer holds pixels in the cache's format (not layers)
+static bool compositing(lv_draw_ctx_t *ctx)
+{
+  if (mode != LAYER_ON || ctx == NULL)
+    return false;
+  lv_disp_t *disp = _lv_refr_get_disp_refreshing();
+  return disp != NULL && disp->driver->set_px_cb == NULL && ctx->buf == disp->driver->draw_buf->buf_act;
+}
+
+static bool isDrawEvent(lv_event_code_t code)
+{
+  return code >= LV_EVENT_DRAW_MAIN_BEGIN && code <= LV_EVENT_DRAW_POST_END;
+}
+
+static void blit(lv_draw_ctx_t *ctx)
+{
+  lv_area_t src;
+  lv_obj_get_coords(screen, &src);
+  src.x2 = src.x1 + bakedW - 1;
+  src.y2 = src.y1 + bakedH - 1;
+  lv_area_t a;
+  if (!_lv_area_intersect(&a, ctx->clip_area, &src))
+    return;
+
+  const lv_coord_t bufW = lv_area_get_width(ctx->buf_area);
+  const int32_t w = lv_area_get_width(&a);
+  const int32_t h = lv_area_get_height(&a);
+  lv_color_t *dst = (lv_color_t *)ctx->buf + (a.y1 - ctx->buf_area->y1) * bufW + (a.x1 - ctx->buf_area->x1);
+  const lv_color_t *from = pixels + (a.y1 - src.y1) * bakedW + (a.x1 - src.x1);
+  if (w == bufW && w == bakedW) {
+    memFastCopy(dst, from, (size_t)w * h * sizeof(lv_color_t));  // Full-width stripe: rows are contiguous
+  } else {
+    for (int32_t y = 0; y < h; y++, dst += bufW, from += bakedW)
+      memFastCopy(dst, from, (size_t)w * sizeof(lv_color_t));
+  }
+  blitPx += w * h;
+}
+
+static void screenHook(lv_event_t *e)
+{
+  if (lv_event_get_code(e) != LV_EVENT_DRAW_MAIN)
+    return;
+  lv_draw_ctx_t *ctx = lv_event_get_draw_ctx(e);
+  if (!compositing(ctx))
+    return;
+  blit(ctx);
+  lv_event_stop_processing(e);  // The bake already holds the screen background
+}
+
+static void staticHook(lv_event_t *e)
+{
+  lv_event_code_t code = lv_event_get_code(e);
+  if (code == LV_EVENT_STYLE_CHANGED) {
+    markDirty();
+  } else if (code == LV_EVENT_COVER_CHECK) {
+    if (mode == LAYER_ON) {
+      lv_event_set_cover_res(e, LV_COVER_RES_NOT_COVER);  // Refresh must start at the screen
+      lv_event_stop_processing(e);
+    }
+  } else if (isDrawEvent(code) && compositing(lv_event_get_draw_ctx(e))) {
+    lv_event_stop_processing(e);
+  }
+}
+
+static void bakeHook(lv_event_t *e)
+{
+  if (mode == LAYER_BAKING && isDrawEvent(lv_event_get_code(e)))
+    lv_event_stop_processing(e);
+}
+
+static bool isStatic(lv_obj_t *obj)
+{
+  for (size_t i = 0; i < staticCount; i++) {
+    if (statics[i].obj == obj)
+      return true;
+  }
+  return false;
+}
+
+// Attached for the bake only: objects created after layerCacheBegin() are covered too
+static void setBakeHooks(lv_obj_t *root, bool attach)
+{
+  uint32_t count = lv_obj_get_child_cnt(root);
+  for (uint32_t i = 0; i < count; i++) {
+    lv_obj_t *child = lv_obj_get_child(root, i);
+    if (!isStatic(child)) {
+      if (attach)
+        lv_obj_add_event_cb(child, bakeHook, (lv_event_code_t)(LV_EVENT_ALL | LV_EVENT_PREPROCESS), NULL);
+      else
+        lv_obj_remove_event_cb(child, bakeHook);
+    }
+    setBakeHooks(child, attach);
+  }
+}
+
+static void snapshotEntry(StaticEntry &s)
+{
+  lv_area_t scr;
+  lv_obj_get_coords(screen, &scr);
+  lv_obj_get_coords(s.obj, &s.rel);
+  lv_area_move(&s.rel, -scr.x1, -scr.y1);
+  s.state = lv_obj_get_state(s.obj);
+  s.hidden = lv_obj_has_flag(s.obj, LV_OBJ_FLAG_HIDDEN);
+}
+
+static bool layoutMoved()
+{
+  if (lv_obj_get_width(screen) != bakedW || lv_obj_get_height(screen) != bakedH)
+    return true;
+  for (size_t i = 0; i < staticCount; i++) {
+    StaticEntry now = statics[i];
+    snapshotEntry(now);
+    if (!_lv_area_is_equal(&now.rel, &statics[i].rel) || now.state != statics[i].state ||
+        now.hidden != statics[i].hidden)
+      return true;
+  }
+  return false;
+}
+
+static void bake()
+{
+  int64_t start = esp_timer_get_time();
+  lv_obj_update_layout(screen);
+
+  // Same driver and draw backend as the display, private buffer and context
+  lv_disp_t *disp = lv_obj_get_disp(screen);
+  lv_disp_drv_t drv = *disp->driver;
+  lv_disp_t fake;
+  lv_memset_00(&fake, sizeof(fake));
+  fake.driver = &drv;
+  lv_draw_ctx_t *ctx = (lv_draw_ctx_t *)lv_mem_alloc(drv.draw_ctx_size);
+  if (ctx == NULL) {
+    LOG_WARN(TAG, "⚠️  Layer cache: no memory for a draw context, retrying");
+    dirtySinceMs = millis();
+    return;
+  }
+  drv.draw_ctx_init(&drv, ctx);
+  drv.draw_ctx = ctx;
+
+  lv_area_t area;
+  lv_obj_get_coords(screen, &area);
+  area.x2 = area.x1 + bakedW - 1;
+  area.y2 = area.y1 + bakedH - 1;
+  ctx->buf = pixels;
+  ctx->buf_area = &area;
+  ctx->clip_area = &area;
+
+  setBakeHooks(screen, true);
+  mode = LAYER_BAKING;
+  lv_disp_t *refreshing = _lv_refr_get_disp_refreshing();
+  _lv_refr_set_disp_refreshing(&fake);
+  lv_refr_obj(ctx, screen);
+  _lv_refr_set_disp_refreshing(refreshing);
+  setBakeHooks(screen, false);
+
+  drv.draw_ctx_deinit(&drv, ctx);
+  lv_mem_free(ctx);
+
+  for (size_t i = 0; i < staticCount; i++)
+    snapshotEntry(statics[i]);
+  mode = LAYER_ON;  // Pixels on the panel are unchanged - nothing to invalidate
+  dirty = false;
+  bakes++;
+  lastBakeUs = (uint32_t)(esp_timer_get_time() - start);
+  bakesTotal.add();
+  bakeUs.record(lastBakeUs);
+  LOG_DEBUG(TAG, "🧱 Layer cache baked in %luus", (unsigned long)lastBakeUs);
+}
+
+void layerCacheBegin(lv_obj_t *scr, lv_obj_t *const *objs, size_t count)
+{
+#if GS_LAYER_CACHE
+  if (scr == NULL || screen != NULL)
+    return;
+  lv_obj_update_layout(scr);
+  bakedW = lv_obj_get_width(scr);
+  bakedH = lv_obj_get_height(scr);
+  size_t bytes = (size_t)bakedW * bakedH * sizeof(lv_color_t);
+  pixels = (lv_color_t *)memCapsAlloc(bytes, MEM_PSRAM, MEM_OWNER_LAYER_CACHE);
+  if (pixels == NULL) {
+    LOG_WARN(TAG, "⚠️  Layer cache: %uKB of PSRAM unavailable, drawing uncached", (unsigned)(bytes / 1024));
+    return;
+  }
+
+  screen = scr;
+  for (size_t i = 0; i < count && staticCount < LAYER_CACHE_MAX_OBJECTS; i++) {
+    if (objs[i] == NULL)
+      continue;
+    statics[staticCount].obj = objs[i];
+    lv_obj_add_event_cb(objs[i], staticHook, (lv_event_code_t)(LV_EVENT_ALL | LV_EVENT_PREPROCESS), NULL);
+    staticCount++;
+  }
+  lv_obj_add_event_cb(screen, screenHook, (lv_event_code_t)(LV_EVENT_DRAW_MAIN | LV_EVENT_PREPROCESS), NULL);
+  LOG_INFO(TAG, "🧱 Layer cache: %u static objects, %uKB PSRAM", (unsigned)staticCount, (unsigned)(bytes / 1024));
+  markDirty();
+#else
+  (void)scr;
+  (void)objs;
+  (void)count;
+#endif
+}
+
+void layerCacheService()
+{
+  if (screen == NULL)
+    return;
+  if (mode == LAYER_ON) {
+    lv_obj_update_layout(screen);  // Label text set this pass - position its neighbours now
+    if (layoutMoved())
+      markDirty();
+  }
+  if (dirty && millis() - dirtySinceMs >= LAYER_CACHE_SETTLE_MS)
+    bake();
+}
+
+void layerCacheDump(Print &out)
+{
+  if (screen == NULL) {
+    out.println("[Layer cache] off");
+    return;
+  }
+  out.printf("[Layer cache] %s, %dx%d (%uKB PSRAM), %u static objects\n",
+             mode == LAYER_ON ? "composited" : "drawing uncached", (int)bakedW, (int)bakedH,
+             (unsigned)((size_t)bakedW * bakedH * sizeof(lv_color_t) / 1024), (unsigned)staticCount);
+  out.printf("  bakes %lu (last %luus), invalidated %lu, %lu px copied from the cache\n", (unsigned long)bakes,
+             (unsigned long)lastBakeUs, (unsigned long)invalidations, (unsigned long)blitPx);
+}
@@ -0,0 +1,76 @@
+#ifndef LAYER_CACHE_H
+#define LAYER_CACHE_H
+
+// =============================================================================
+// Static Layer Cache (pre-rendered main screen background)
+// =============================================================================
+// The panel only takes full-width windows (LCD_ROW_FULL_SPAN), so a weight or
+// timer label update invalidates a stripe across the whole screen and LVGL
+// redraws every container, the rounded Panel1, the prefix labels and icons
+// that cross it. None of those change after boot.
+//
+// layerCacheBegin() names those static objects. The screen is then rendered
+// once - screen background and static objects only, everything else sits the
+// bake out - into a PSRAM buffer in the display's own format (RGB565, same
+// draw backend, lv_refr_obj() into a private draw context as lv_snapshot
+// does). While the bake is valid:
+//
+//   - the screen's DRAW_MAIN copies the baked pixels of the clip area into the
+//     draw buffer (memFastCopy rows, one copy for a full-width stripe)
+//   - static objects skip their draw events and report NOT_COVER, so the
+//     refresh starts at the screen
+//   - everything else - value labels, buttons, the Bluetooth icons, the shot
+//     chart, objects added later - draws normally on top
+//
+// i.e. a refresh costs one copy plus the dynamic objects in the area.
+//
+// Invalidation: every UI pass compares each static object's position
+// (relative to the screen, so screen animations don't count), size, state
+// and hidden flag with the bake, and a STYLE_CHANGED on one marks it dirty
+// too - a label growing in a flex row moves its neighbours. A dirty cache
+// falls back to normal drawing at once (screen invalidated) and re-bakes after
+// LAYER_CACHE_SETTLE_MS without changes. Static objects must not have their
+// content (text, image source) changed; those belong to the dynamic set.
+//
+// Composition order changes in one way: static objects end up below every
+// dynamic one. The SquareLine layout has no overlaps where that shows.
+// Renders into other buffers (layers with opacity, render_audit / display_bench
+// both use the real draw buffers and are unaffected) draw normally.
+//
+// GS_LAYER_CACHE (compile-time, -DGS_LAYER_CACHE=<n>):
+//   0 - Off: layerCacheBegin() does nothing, no buffer
+//   1 - Main screen background cached (default, UI_HOR_RES x UI_VER_RES
+//       x 2 bytes of PSRAM)
+//
+// Thread Safety:
+//   layerCacheBegin() / layerCacheService() and the draw hooks - UI task
+//   (LVGL owner). layerCacheDump() - any task (plain counters).
+// =============================================================================
+
+#include <Arduino.h>
+#include "lvgl.h"
+
+#ifndef GS_LAYER_CACHE
+#define GS_LAYER_CACHE 1
+#endif
+
+constexpr size_t LAYER_CACHE_MAX_OBJECTS  = 24;
+constexpr uint32_t LAYER_CACHE_SETTLE_MS  = 250;  // Layout quiet this long before a re-bake
+
+/**
+ * @brief Cache the background of `screen` with the `count` static objects baked in
+ * @note Call from setup() after the screen is built; allocates the PSRAM buffer
+ */
+void layerCacheBegin(lv_obj_t *screen, lv_obj_t *const *statics, size_t count);
+
+/**
+ * @brief Check the bake against the layout, re-bake when it settled (every UI pass)
+ */
+void layerCacheService();
+
+/**
+ * @brief State, buffer, bakes, invalidations and composited pixels
+ */
+void layerCacheDump(Print &out);
+
+#endif // LAYER_CACHE_H
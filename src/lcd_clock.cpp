@@ -0,0 +1,211 @@
+// =============================================================================
+// QSPI Clock Calibration Implementation
+// =============================================================================
+
+#include "lcd_clock.h"
+#include "AXS15231B.h"
+#include "debug_config.h"
+#include "esp_timer.h"
+#include "driver/spi_master.h"
+#include <Preferences.h>
+
+static constexpr LogTag TAG = LOG_TAG_LCD_DMA;
+
+static const char* LCD_CLOCK_NAMESPACE = "display";
+static const char* LCD_CLOCK_KEY       = "qspi";
+static const uint8_t LCD_CLOCK_VERSION = 1;   // Bump when LcdClockRecord changes
+static constexpr size_t CANDIDATES     = sizeof(LCD_CLOCK_CANDIDATES_HZ) / sizeof(LCD_CLOCK_CANDIDATES_HZ[0]);
+
+struct LcdClockRecord {
+  uint8_t version;
+  uint32_t baseHz;   // SPI_FREQUENCY of the build that calibrated
+  uint32_t hz;       // Clock to use
+};
+
+enum CandidateResult : uint8_t {
+  CAND_UNTRIED,
+  CAND_SKIPPED,      // Not above the clock in use (same divider)
+  CAND_PASSED,
+  CAND_FAILED,
+  CAND_MARGIN,       // Passed, failed the confirmation rounds
+};
+
+struct CandidateRun {
+  CandidateResult result;
+  uint32_t pushUs;   // Best full-frame push
+  uint32_t rounds;   // Rounds completed
+};
+
+static CandidateRun runs[CANDIDATES];
+static bool calibrated = false;
+static bool readable = false;
+static uint8_t refId[3] = {};
+
+static uint32_t actualHz(uint32_t hz)
+{
+  return (uint32_t)spi_get_actual_clock(APB_CLK_FREQ, (int)hz, 128);
+}
+
+static bool loadRecord(LcdClockRecord *record)
+{
+  Preferences prefs;
+  if (!prefs.begin(LCD_CLOCK_NAMESPACE, true))
+    return false;
+  bool ok = prefs.getBytes(LCD_CLOCK_KEY, record, sizeof(*record)) == sizeof(*record) &&
+            record->version == LCD_CLOCK_VERSION;
+  prefs.end();
+  return ok;
+}
+
+static void saveRecord(uint32_t hz)
+{
+  LcdClockRecord record = {LCD_CLOCK_VERSION, SPI_FREQUENCY, hz};
+  Preferences prefs;
+  if (!prefs.begin(LCD_CLOCK_NAMESPACE, false))
+    return;
+  prefs.putBytes(LCD_CLOCK_KEY, &record, sizeof(record));
+  prefs.end();
+}
+
+static bool pushFrame(const uint16_t *frame, uint32_t *us)
+{
+  int64_t start = esp_timer_get_time();
+  int64_t deadline = start + LCD_CLOCK_CAL_PUSH_TIMEOUT_MS * 1000LL;
+  lcd_PushColors(0, 0, EXAMPLE_LCD_H_RES, EXAMPLE_LCD_V_RES, (uint16_t *)frame);
+  while (get_lcd_spi_dma_write()) {
+    if (esp_timer_get_time() > deadline)
+      return false;
+    vTaskDelay(1);
+  }
+  *us = (uint32_t)(esp_timer_get_time() - start);
+  return true;
+}
+
+static bool idMatches()
+{
+  uint8_t id[3];
+  return lcd_read_cmd(0x04, id, sizeof(id)) && memcmp(id, refId, sizeof(id)) == 0;
+}
+
+// `rounds` of push + readback at the clock in use
+static bool trial(const uint16_t *frame, uint32_t rounds, CandidateRun &run)
+{
+  for (uint32_t i = 0; i < rounds; i++) {
+    uint32_t us;
+    if (!pushFrame(frame, &us))
+      return false;
+    if (run.pushUs == 0 || us < run.pushUs)
+      run.pushUs = us;
+    if (!idMatches())
+      return false;
+    run.rounds++;
+  }
+  return true;
+}
+
+static uint32_t calibrate()
+{
+  const uint32_t base = lcd_get_spi_clock();
+  readable = lcd_read_cmd(0x04, refId, sizeof(refId)) &&
+             !(refId[0] == 0x00 && refId[1] == 0x00 && refId[2] == 0x00) &&
+             !(refId[0] == 0xFF && refId[1] == 0xFF && refId[2] == 0xFF);
+  calibrated = true;
+  if (!readable) {
+    LOG_WARN(TAG, "⚠️  QSPI clock: no RDDID readback (%02X %02X %02X), staying at %lu Hz",
+             refId[0], refId[1], refId[2], (unsigned long)base);
+    return base;
+  }
+
+  uint16_t *frame = (uint16_t *)ps_malloc(LVGL_LCD_BUF_SIZE * sizeof(uint16_t));
+  if (frame == NULL) {
+    LOG_WARN(TAG, "⚠️  QSPI clock: no PSRAM for the test frame, staying at %lu Hz", (unsigned long)base);
+    return base;
+  }
+  for (uint32_t i = 0; i < LVGL_LCD_BUF_SIZE; i++)
+    frame[i] = (i & 1) ? 0x5555 : 0xAAAA;
+
+  // Highest candidate that passed, in order - the first failure ends the climb
+  int best = -1;
+  uint32_t current = actualHz(base);
+  for (size_t i = 0; i < CANDIDATES; i++)
+    runs[i] = {};
+  for (size_t i = 0; i < CANDIDATES; i++) {
+    if (actualHz(LCD_CLOCK_CANDIDATES_HZ[i]) <= current) {
+      runs[i].result = CAND_SKIPPED;
+      continue;
+    }
+    if (!lcd_set_spi_clock(LCD_CLOCK_CANDIDATES_HZ[i]) || !trial(frame, LCD_CLOCK_CAL_TRIALS, runs[i])) {
+      runs[i].result = CAND_FAILED;
+      break;
+    }
+    runs[i].result = CAND_PASSED;
+    current = actualHz(LCD_CLOCK_CANDIDATES_HZ[i]);
+    best = (int)i;
+  }
+
+  // Margin: the winner runs the confirmation rounds, falling back one step at a time
+  while (best >= 0) {
+    if (lcd_set_spi_clock(LCD_CLOCK_CANDIDATES_HZ[best]) &&
+        trial(frame, LCD_CLOCK_CAL_TRIALS * LCD_CLOCK_CAL_CONFIRM, runs[best]))
+      break;
+    runs[best].result = CAND_MARGIN;
+    do {
+      best--;
+    } while (best >= 0 && runs[best].result != CAND_PASSED);
+  }
+  free(frame);
+
+  uint32_t chosen = best >= 0 ? LCD_CLOCK_CANDIDATES_HZ[best] : base;
+  if (lcd_get_spi_clock() != chosen && !lcd_set_spi_clock(chosen))
+    chosen = lcd_get_spi_clock();
+  LOG_INFO(TAG, "⚡ QSPI clock calibrated: %lu Hz (%lu Hz actual), base %lu Hz",
+           (unsigned long)chosen, (unsigned long)actualHz(chosen), (unsigned long)base);
+  return chosen;
+}
+
+void lcdClockBegin()
+{
+#if GS_LCD_CLOCK_CAL
+  LcdClockRecord record;
+  if (GS_LCD_CLOCK_CAL == 1 && loadRecord(&record) && record.baseHz == SPI_FREQUENCY) {
+    if (record.hz != lcd_get_spi_clock() && !lcd_set_spi_clock(record.hz))
+      LOG_WARN(TAG, "⚠️  QSPI clock: stored %lu Hz rejected by the driver", (unsigned long)record.hz);
+    else
+      LOG_INFO(TAG, "⚡ QSPI clock: %lu Hz (stored calibration)", (unsigned long)record.hz);
+    return;
+  }
+  uint32_t hz = calibrate();
+  if (GS_LCD_CLOCK_CAL == 1)
+    saveRecord(hz);
+#endif
+}
+
+void lcdClockReset()
+{
+  Preferences prefs;
+  if (!prefs.begin(LCD_CLOCK_NAMESPACE, false))
+    return;
+  prefs.remove(LCD_CLOCK_KEY);
+  prefs.end();
+}
+
+void lcdClockDump(Print &out)
+{
+  static const char *const RESULT_NAMES[] = {"-", "skipped", "passed", "failed", "margin"};
+  uint32_t hz = lcd_get_spi_clock();
+  out.printf("[QSPI clock] %lu Hz requested, %lu Hz actual (SPI_FREQUENCY %lu, GS_LCD_CLOCK_CAL %d)\n",
+             (unsigned long)hz, (unsigned long)actualHz(hz), (unsigned long)SPI_FREQUENCY, GS_LCD_CLOCK_CAL);
+  LcdClockRecord record;
+  if (loadRecord(&record))
+    out.printf("  stored: %lu Hz (base %lu Hz)\n", (unsigned long)record.hz, (unsigned long)record.baseHz);
+  else
+    out.println("  stored: none");
+  if (!calibrated)
+    return;
+  out.printf("  RDDID %02X %02X %02X%s\n", refId[0], refId[1], refId[2], readable ? "" : " (no readback)");
+  for (size_t i = 0; i < CANDIDATES; i++) {
+    out.printf("  %9lu Hz (%9lu actual): %-7s %3lu rounds, best frame %luus\n",
+               (unsigned long)LCD_CLOCK_CANDIDATES_HZ[i], (unsigned long)actualHz(LCD_CLOCK_CANDIDATES_HZ[i]),
+               RESULT_NAMES[runs[i].result], (unsigned long)runs[i].rounds, (unsigned long)runs[i].pushUs);
+  }
+}
@@ -0,0 +1,68 @@
+#ifndef LCD_CLOCK_H
+#define LCD_CLOCK_H
+
+// =============================================================================
+// QSPI Clock Calibration for the AXS15231B
+// =============================================================================
+// Wire time of a 230 KB frame scales with the QSPI clock, and SPI_FREQUENCY
+// is a fixed, conservative 32 MHz. lcdClockBegin() runs right after
+// axs15231_init(), backlight still off, and either applies the clock a
+// previous calibration stored or calibrates:
+//
+//   1. RDDID (0x04) read back at SPI_FREQUENCY is the reference. All 0x00 or
+//      all 0xFF means the panel does not answer reads here, and the clock
+//      stays at SPI_FREQUENCY (stored, so later boots skip the attempt).
+//   2. For each LCD_CLOCK_CANDIDATES_HZ entry above the current clock (the
+//      SPI divider of the 80 MHz APB clock: 40, 80 MHz), LCD_CLOCK_CAL_TRIALS
+//      rounds of a full-frame 0xAAAA / 0x5555 push (every data line toggles
+//      each clock) followed by an RDDID read. A wrong ID, a bus error or a
+//      push that misses LCD_CLOCK_CAL_PUSH_TIMEOUT_MS fails the candidate,
+//      and higher ones are not tried.
+//   3. Margin: the highest passing clock must pass LCD_CLOCK_CAL_CONFIRM
+//      times as many rounds again, else the next lower one is taken.
+//
+// The result is stored in NVS (namespace "display", key "qspi") together
+// with SPI_FREQUENCY, so a build with another base clock calibrates again;
+// "lcdclock reset" clears it for the next boot. The readback checks the
+// single-line read path at the candidate clock; the quad pixel path is only
+// exercised, not verified - the panel has no frame CRC - which is why a
+// calibration is opt-in.
+//
+// GS_LCD_CLOCK_CAL (compile-time, -DGS_LCD_CLOCK_CAL=<n>):
+//   0 - SPI_FREQUENCY only (default)
+//   1 - Calibrate once, then reuse the stored clock
+//   2 - Calibrate on every boot, nothing stored (display_bench builds)
+//
+// Thread Safety:
+//   lcdClockBegin() - setup(), before LVGL renders (owns the panel bus).
+//   lcdClockDump() / lcdClockReset() - any task.
+// =============================================================================
+
+#include <Arduino.h>
+
+#ifndef GS_LCD_CLOCK_CAL
+#define GS_LCD_CLOCK_CAL 0
+#endif
+
+constexpr uint32_t LCD_CLOCK_CANDIDATES_HZ[] = {40000000, 80000000};
+constexpr uint32_t LCD_CLOCK_CAL_TRIALS          = 8;
+constexpr uint32_t LCD_CLOCK_CAL_CONFIRM         = 4;    // Margin: rounds x this at the winner
+constexpr uint32_t LCD_CLOCK_CAL_PUSH_TIMEOUT_MS = 100;  // Full frame, any clock worth keeping
+
+/**
+ * @brief Apply the stored clock or calibrate (see GS_LCD_CLOCK_CAL)
+ * @note Call from setup() right after axs15231_init()
+ */
+void lcdClockBegin();
+
+/**
+ * @brief Forget the stored clock; the next boot calibrates again
+ */
+void lcdClockReset();
+
+/**
+ * @brief Clock in use, stored record, last calibration per candidate
+ */
+void lcdClockDump(Print &out);
+
+#endif // LCD_CLOCK_H
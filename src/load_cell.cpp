@@ -0,0 +1,254 @@
+// =============================================================================
+// Wired Load Cell Implementation
+// =============================================================================
+
+#include "load_cell.h"
+#include "debug_config.h"
+#include "console.h"
+#include "metrics.h"
+
+#if GS_LOAD_CELL
+
+#include "task_layout.h"
+#include "driver/gpio.h"
+#include "hal/gpio_ll.h"
+#include "esp_timer.h"
+#include <Preferences.h>
+
+static constexpr LogTag TAG = LOG_TAG_SCALE;
+
+static const char *LOAD_CELL_NAMESPACE = "loadcell";
+static const char *LOAD_CELL_KEY       = "cal";
+static const uint8_t LOAD_CELL_VERSION = 1;
+
+static const char *const CONVERTER_NAME = GS_LOAD_CELL == 1 ? "HX711" : "ADS1232";
+constexpr uint8_t READ_CLOCKS           = 25;   // 24 data bits + 1 (HX711: A/128 next; ADS1232: DOUT high)
+constexpr uint32_t READ_TIMEOUT_MS      = 500;  // No ready edge → count, re-arm
+
+struct LoadCellRecord {
+  uint8_t version;
+  int32_t zero;          // Counts at 0 g
+  float countsPerG;      // 0 = not calibrated
+};
+
+static MetricCounter cellReads("load_cell_reads_total", "Load cell conversions read");
+static MetricCounter cellTimeouts("load_cell_timeouts_total", "Load cell ready edges missing for READ_TIMEOUT_MS");
+static MetricHistogram cellReadUs("load_cell_read_us", "Load cell ready edge → sample handed over", METRIC_BUCKETS_US);
+
+static portMUX_TYPE clockLock = portMUX_INITIALIZER_UNLOCKED;
+static portMUX_TYPE stateLock = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t readerTask = NULL;
+static LoadCellSink sink = NULL;
+static LoadCellRecord cal = {LOAD_CELL_VERSION, 0, 0.0f};
+static volatile int64_t readyUs = 0;
+static volatile uint32_t lastReadMs = 0;
+
+// Recent raw counts for tare / calibration
+static int32_t recent[LOAD_CELL_TARE_SAMPLES];
+static uint8_t recentNext = 0;
+static uint8_t recentCount = 0;
+static int32_t lastRaw = 0;
+
+static void IRAM_ATTR readyIsr(void *)
+{
+  readyUs = esp_timer_get_time();
+  gpio_ll_intr_disable(&GPIO, (gpio_num_t)GS_LOAD_CELL_DOUT_PIN);   // DOUT toggles with the data bits
+  BaseType_t woken = pdFALSE;
+  vTaskNotifyGiveFromISR(readerTask, &woken);
+  if (woken)
+    portYIELD_FROM_ISR();
+}
+
+// 24-bit two's complement, MSB first. SCK high for more than 60 us powers the
+// HX711 down, so the clocks run with interrupts off on this core.
+static int32_t readCounts()
+{
+  uint32_t value = 0;
+  portENTER_CRITICAL(&clockLock);
+  for (uint8_t i = 0; i < READ_CLOCKS; i++) {
+    gpio_set_level((gpio_num_t)GS_LOAD_CELL_SCK_PIN, 1);
+    esp_rom_delay_us(1);
+    if (i < 24)
+      value = (value << 1) | (uint32_t)gpio_get_level((gpio_num_t)GS_LOAD_CELL_DOUT_PIN);
+    gpio_set_level((gpio_num_t)GS_LOAD_CELL_SCK_PIN, 0);
+    esp_rom_delay_us(1);
+  }
+  portEXIT_CRITICAL(&clockLock);
+  return (int32_t)(value << 8) >> 8;
+}
+
+static void readerTaskFunction(void *)
+{
+  for (;;) {
+    gpio_intr_enable((gpio_num_t)GS_LOAD_CELL_DOUT_PIN);
+    // A conversion that became ready while the interrupt was off has no edge - take it now
+    bool ready = gpio_get_level((gpio_num_t)GS_LOAD_CELL_DOUT_PIN) == 0;
+    if (ready) {
+      gpio_intr_disable((gpio_num_t)GS_LOAD_CELL_DOUT_PIN);
+      ulTaskNotifyTake(pdTRUE, 0);   // Drop an edge that raced the level check
+      readyUs = esp_timer_get_time();
+    } else if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(READ_TIMEOUT_MS)) == 0) {
+      cellTimeouts.add();
+      continue;
+    }
+
+    int64_t sampleUs = readyUs;
+    int32_t raw = readCounts();
+    cellReads.add();
+
+    portENTER_CRITICAL(&stateLock);
+    lastRaw = raw;
+    recent[recentNext] = raw;
+    recentNext = (recentNext + 1) % LOAD_CELL_TARE_SAMPLES;
+    if (recentCount < LOAD_CELL_TARE_SAMPLES)
+      recentCount++;
+    int32_t zero = cal.zero;
+    float countsPerG = cal.countsPerG;
+    portEXIT_CRITICAL(&stateLock);
+    lastReadMs = millis();
+
+    if (countsPerG != 0.0f && sink != NULL) {
+      sink((raw - zero) / countsPerG, sampleUs);
+      cellReadUs.record((uint32_t)(esp_timer_get_time() - sampleUs));
+    }
+  }
+}
+
+static void save()
+{
+  Preferences prefs;
+  if (prefs.begin(LOAD_CELL_NAMESPACE, false)) {
+    prefs.putBytes(LOAD_CELL_KEY, &cal, sizeof(cal));
+    prefs.end();
+  }
+}
+
+bool loadCellBegin(LoadCellSink sampleSink)
+{
+  sink = sampleSink;
+  Preferences prefs;
+  if (prefs.begin(LOAD_CELL_NAMESPACE, true)) {
+    LoadCellRecord loaded;
+    if (prefs.getBytes(LOAD_CELL_KEY, &loaded, sizeof(loaded)) == sizeof(loaded) && loaded.version == LOAD_CELL_VERSION)
+      cal = loaded;
+    prefs.end();
+  }
+
+  gpio_reset_pin((gpio_num_t)GS_LOAD_CELL_SCK_PIN);
+  gpio_set_direction((gpio_num_t)GS_LOAD_CELL_SCK_PIN, GPIO_MODE_OUTPUT);
+  gpio_set_level((gpio_num_t)GS_LOAD_CELL_SCK_PIN, 0);   // Low: converter powered up
+  gpio_reset_pin((gpio_num_t)GS_LOAD_CELL_DOUT_PIN);
+  gpio_set_direction((gpio_num_t)GS_LOAD_CELL_DOUT_PIN, GPIO_MODE_INPUT);
+  gpio_set_pull_mode((gpio_num_t)GS_LOAD_CELL_DOUT_PIN, GPIO_PULLUP_ONLY);   // No converter: never ready
+  gpio_set_intr_type((gpio_num_t)GS_LOAD_CELL_DOUT_PIN, GPIO_INTR_NEGEDGE);
+
+  if (taskLayoutSpawn(TASK_ROLE_LOAD_CELL, readerTaskFunction, NULL, &readerTask) != pdPASS) {
+    LOG_ERROR(TAG, "❌ Load cell: reader task not created");
+    return false;
+  }
+  gpio_install_isr_service(0);   // Already installed by attachInterrupt() users: harmless
+  gpio_isr_handler_add((gpio_num_t)GS_LOAD_CELL_DOUT_PIN, readyIsr, NULL);
+
+  if (cal.countsPerG == 0.0f)
+    LOG_WARN(TAG, "⚠️  Load cell (%s): not calibrated - 'loadcell tare', then 'loadcell cal <g>'", CONVERTER_NAME);
+  else
+    LOG_INFO(TAG, "✅ Load cell (%s) on DOUT %d / SCK %d, %.1f counts/g", CONVERTER_NAME, GS_LOAD_CELL_DOUT_PIN,
+             GS_LOAD_CELL_SCK_PIN, cal.countsPerG);
+  return true;
+}
+
+bool loadCellActive()
+{
+  return cal.countsPerG != 0.0f && lastReadMs != 0 && millis() - lastReadMs < LOAD_CELL_STALE_MS;
+}
+
+// Mean of the recent counts, false until the window is full
+static bool recentMean(int32_t *mean)
+{
+  int64_t sum = 0;
+  portENTER_CRITICAL(&stateLock);
+  bool full = recentCount == LOAD_CELL_TARE_SAMPLES;
+  for (uint8_t i = 0; i < recentCount; i++)
+    sum += recent[i];
+  portEXIT_CRITICAL(&stateLock);
+  if (!full)
+    return false;
+  *mean = (int32_t)(sum / LOAD_CELL_TARE_SAMPLES);
+  return true;
+}
+
+bool loadCellTare(bool persist)
+{
+  int32_t mean;
+  if (!recentMean(&mean))
+    return false;
+  portENTER_CRITICAL(&stateLock);
+  cal.zero = mean;
+  portEXIT_CRITICAL(&stateLock);
+  if (persist)
+    save();
+  return true;
+}
+
+bool loadCellCalibrate(float grams)
+{
+  int32_t mean;
+  if (grams <= 0.0f || !recentMean(&mean) || mean == cal.zero)
+    return false;
+  portENTER_CRITICAL(&stateLock);
+  cal.countsPerG = (mean - cal.zero) / grams;
+  portEXIT_CRITICAL(&stateLock);
+  save();
+  LOG_INFO(TAG, "⚖️  Load cell calibrated: %.1f counts/g (%.1f g)", cal.countsPerG, grams);
+  return true;
+}
+
+void loadCellDump(Print &out)
+{
+  portENTER_CRITICAL(&stateLock);
+  LoadCellRecord c = cal;
+  int32_t raw = lastRaw;
+  portEXIT_CRITICAL(&stateLock);
+  out.printf("[LoadCell] %s on DOUT %d / SCK %d, %lu SPS strap, %s\n", CONVERTER_NAME, GS_LOAD_CELL_DOUT_PIN,
+             GS_LOAD_CELL_SCK_PIN, (unsigned long)LOAD_CELL_SPS, loadCellActive() ? "weight source" : "not in use");
+  out.printf("  zero %ld, %.2f counts/g%s, last %ld", (long)c.zero, c.countsPerG,
+             c.countsPerG == 0.0f ? " (not calibrated)" : "", (long)raw);
+  if (c.countsPerG != 0.0f)
+    out.printf(" = %.2f g", (raw - c.zero) / c.countsPerG);
+  out.printf("\n  reads %lu, timeouts %lu\n", (unsigned long)cellReads.value(), (unsigned long)cellTimeouts.value());
+}
+
+#else
+
+bool loadCellBegin(LoadCellSink) { return false; }
+bool loadCellActive() { return false; }
+bool loadCellTare(bool) { return false; }
+bool loadCellCalibrate(float) { return false; }
+
+void loadCellDump(Print &out)
+{
+  out.println("[LoadCell] Not built in (GS_LOAD_CELL=0; 1 = HX711, 2 = ADS1232)");
+}
+
+#endif // GS_LOAD_CELL
+
+static void cmdLoadCell(ConsoleArgs &args)
+{
+  float grams;
+  if (args.is(1, "tare")) {
+    args.out.println(loadCellTare(true) ? "[LoadCell] Zero set and saved" : "[LoadCell] No recent readings");
+  } else if (args.is(1, "cal")) {
+    if (!args.decimal(2, &grams)) {
+      args.out.println("Usage: loadcell cal <grams on the tray>");
+      return;
+    }
+    if (!loadCellCalibrate(grams))
+      args.out.println("[LoadCell] Calibration refused: tare first, then a known mass > 0 g");
+  } else if (args.argc > 1) {
+    args.out.println("Usage: loadcell [tare|cal <g>]");
+    return;
+  }
+  loadCellDump(args.out);
+}
+
+static ConsoleCommand loadCellCommand("loadcell", "[tare|cal <g>]", "Wired load cell: zero, scale, last reading (GS_LOAD_CELL builds)", cmdLoadCell);
@@ -0,0 +1,91 @@
+#ifndef LOAD_CELL_H
+#define LOAD_CELL_H
+
+// =============================================================================
+// Wired Load Cell (HX711 / ADS1232) as the Weight Source
+// =============================================================================
+// A drip-tray load cell on a 24-bit bridge ADC gives the stop decision a
+// weight without the BLE path: no notification interval, no link drops, no
+// reconnect. Both converters speak the same two-wire interface - DOUT goes
+// low when a conversion is ready, 24 clocks shift it out MSB first, a 25th
+// clock ends the read (HX711: channel A, gain 128 next; ADS1232: DOUT back
+// high). 80 SPS is a strap on the board (HX711 RATE, ADS1232 SPEED high).
+//
+//   DOUT falling edge (ISR: timestamp, interrupt off) → reader task: 25
+//   clocks under a spinlock (~50 us) → counts → grams → sink → the control
+//   task's sample queue, the same one BLE weight notifications feed
+//
+// The stop decision and everything after it see the usual samples, dated
+// at the ready edge. While the cell is calibrated and converting
+// (loadCellActive()) it is the weight source: BLE scale samples are not
+// queued, a shot starts without a connected scale and the start tares the
+// cell. The BLE scale, if connected, still gets its timer commands.
+//
+// Tare: the mean of the last LOAD_CELL_TARE_SAMPLES conversions, so a shot
+// start does not wait for new ones. Zero ("loadcell tare") and scale
+// ("loadcell cal <g>" with a known mass on the tray) are kept in NVS
+// (namespace "loadcell"); an uncalibrated cell is not used.
+//
+// GS_LOAD_CELL (compile-time, -DGS_LOAD_CELL=n):
+//   0 - Not built (default)
+//   1 - HX711
+//   2 - ADS1232
+// The default pins are free header GPIOs - check them against the wiring.
+//
+// Thread Safety:
+//   loadCellBegin() from setup(). The sink runs on the reader task.
+//   loadCellTare() / loadCellCalibrate() / loadCellActive() from any task.
+// =============================================================================
+
+#include <Arduino.h>
+
+#ifndef GS_LOAD_CELL
+#define GS_LOAD_CELL 0
+#endif
+
+#ifndef GS_LOAD_CELL_DOUT_PIN
+#define GS_LOAD_CELL_DOUT_PIN 39
+#endif
+#ifndef GS_LOAD_CELL_SCK_PIN
+#define GS_LOAD_CELL_SCK_PIN 40
+#endif
+
+static_assert(GS_LOAD_CELL <= 2, "GS_LOAD_CELL: 0 off, 1 HX711, 2 ADS1232");
+
+constexpr uint32_t LOAD_CELL_SPS          = 80;
+constexpr uint32_t LOAD_CELL_STALE_MS     = 100;   // No conversion for this long → not active
+constexpr uint8_t  LOAD_CELL_TARE_SAMPLES = 16;    // 200 ms at 80 SPS
+
+// Weight filter tuning for the cell (weight_filter.h, like ScaleDriver's)
+constexpr float LOAD_CELL_PROCESS_NOISE     = 4.0f;     // g^2/s^3
+constexpr float LOAD_CELL_MEASUREMENT_NOISE = 0.0025f;  // g^2 (~0.05 g RMS)
+
+typedef void (*LoadCellSink)(float grams, int64_t sampleUs);
+
+/**
+ * @brief Calibration from NVS, pins, ready interrupt and reader task (no-op when GS_LOAD_CELL == 0)
+ * @return true if the reader runs
+ */
+bool loadCellBegin(LoadCellSink sink);
+
+/**
+ * @brief Calibrated and converting - the weight source for the control task
+ */
+bool loadCellActive();
+
+/**
+ * @brief Zero at the recent mean; `persist` keeps it in NVS as the power-on zero
+ */
+bool loadCellTare(bool persist);
+
+/**
+ * @brief Scale from the recent mean with `grams` on the tray (after a tare), persisted
+ */
+bool loadCellCalibrate(float grams);
+
+/**
+ * @brief Converter, pins, rate, zero / scale, last reading, timeouts
+ */
+void loadCellDump(Print &out);
+
+#endif // LOAD_CELL_H
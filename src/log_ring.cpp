@@ -0,0 +1,498 @@
+// =============================================================================
+// Asynchronous Log Backend Implementation
+// =============================================================================
+// Ring protocol (per slot sequence number, classic bounded queue):
+//   slot.seq == pos       free for the producer that claims position pos
+//   slot.seq == pos + 1   holds the line for pos, ready for the drain task
+//   slot.seq == pos + N   consumed, free again for position pos + N
+// Producers claim a position with one CAS on enqueuePos; only the drain task
+// moves dequeuePos.
+//
+// GS_LOG_BINARY: slot.msg holds the frame payload (tag, format, packed
+// arguments) and slot.len its size; the format walk in packArgs() and the one
+// in tools/log_decode/log_decode.py must read the same argument types.
+// =============================================================================
+
+#include "log_ring.h"
+#include "debug_config.h"
+#include "task_layout.h"
+#include "trace.h"
+#include "web_log.h"
+#include "console.h"
+#include "sample_capture.h"
+
+static constexpr LogTag TAG = LOG_TAG_LOG;
+
+struct LogSlot {
+  uint32_t seq;
+  uint32_t ms;
+  uint8_t level;
+  uint8_t len;                 // GS_LOG_BINARY: payload bytes in msg
+  char tag[LOG_RING_TAG_MAX];
+  char msg[LOG_RING_MSG_MAX];
+};
+
+static_assert(sizeof(LogSlot) == 256, "LogSlot should stay one 256-byte slot");
+static_assert((LOG_RING_SLOTS & (LOG_RING_SLOTS - 1)) == 0, "LOG_RING_SLOTS must be a power of two");
+
+struct LogRing {
+  LogSlot slots[LOG_RING_SLOTS];
+  uint32_t enqueuePos;   // Next position to claim (producers, CAS)
+  uint32_t dequeuePos;   // Next position to print (drain task only)
+  uint32_t written;
+  uint32_t dropped;
+  uint32_t highWater;    // Approximate - updated without a lock
+};
+
+static LogRing rings[2];
+static volatile bool ringActive = false;
+static TaskHandle_t drainTaskHandle = NULL;
+static volatile LogCommandHandler commandHandler = NULL;
+
+// Runtime tag levels: entries are only appended (count published last), never removed
+struct LevelOverride {
+  char tag[LOG_RING_TAG_MAX];
+  volatile uint8_t level;
+};
+static LevelOverride levelOverrides[LOG_LEVEL_OVERRIDES];
+static volatile uint8_t levelOverrideCount = 0;
+
+// -----------------------------------------------------------------------------
+// Output (drain task, or the caller before logRingBegin())
+// -----------------------------------------------------------------------------
+
+static void emitLine(uint8_t level, uint32_t timestamp, const char *tag, const char *msg)
+{
+  const char* level_letter;
+  const char* level_color;
+  switch (level) {
+    case LOG_ERROR:   level_letter = "E"; level_color = GS_LOG_COLOR(GS_COLOR_RED);    break;
+    case LOG_WARN:    level_letter = "W"; level_color = GS_LOG_COLOR(GS_COLOR_YELLOW); break;
+    case LOG_INFO:    level_letter = "I"; level_color = GS_LOG_COLOR(GS_COLOR_GREEN);  break;
+    case LOG_DEBUG:   level_letter = "D"; level_color = GS_LOG_COLOR(GS_COLOR_CYAN);   break;
+    case LOG_VERBOSE: level_letter = "V"; level_color = GS_LOG_COLOR(GS_COLOR_GRAY);   break;
+    default:          level_letter = "?"; level_color = "";                            break;
+  }
+
+  // Format: COLOR LEVEL (timestamp) [tag]: RESET message\n - one write per line
+  char line_buffer[384];
+  snprintf(line_buffer, sizeof(line_buffer), "%s%s (%lu) [%s]:%s %s\n",
+           level_color, level_letter, (unsigned long)timestamp, tag, GS_LOG_RESET_COLOR, msg);
+  Serial.print(line_buffer);
+  // No flush - let USB CDC buffer naturally (prevents overflow)
+
+  // WebSerial (debug builds): batched and sampled by the drain task (web_log.h)
+  if (ringActive)
+    webLogLine(level, timestamp, tag, msg);
+}
+
+static void writeNow(uint8_t level, const char *tag, const char *format, va_list args)
+{
+  char msg[LOG_RING_MSG_MAX];
+  vsnprintf(msg, sizeof(msg), format, args);
+
+  // Print even without the mutex (not created yet for early boot messages)
+  bool hasMutex = (serialMutex && xSemaphoreTake(serialMutex, pdMS_TO_TICKS(2000)));
+  emitLine(level, millis(), tag, msg);
+  if (hasMutex)
+    xSemaphoreGive(serialMutex);
+}
+
+#ifdef GS_LOG_BINARY
+// -----------------------------------------------------------------------------
+// Binary frames
+// -----------------------------------------------------------------------------
+
+static inline void put32(uint8_t *out, size_t *n, uint32_t v)
+{
+  memcpy(out + *n, &v, 4);
+  *n += 4;
+}
+
+// Payload: tag ptr, fmt ptr, then each argument as the conversion reads it.
+// Stops at the first argument that does not fit (*complete = false).
+static size_t packArgs(uint8_t *out, size_t cap, const char *tag, const char *format,
+                       va_list args, bool *complete)
+{
+  size_t n = 0;
+  put32(out, &n, (uint32_t)(uintptr_t)tag);
+  put32(out, &n, (uint32_t)(uintptr_t)format);
+
+  for (const char *p = format; *p != '\0'; p++) {
+    if (*p != '%')
+      continue;
+    if (*++p == '%')
+      continue;
+
+    // Flags, width, precision ('*' takes an int argument)
+    while (*p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '0')
+      p++;
+    for (int field = 0; field < 2; field++) {
+      if (*p == '*') {
+        if (n + 4 > cap) { *complete = false; return n; }
+        put32(out, &n, (uint32_t)va_arg(args, int));
+        p++;
+      }
+      while (*p >= '0' && *p <= '9')
+        p++;
+      if (field == 0 && *p == '.')
+        p++;
+      else
+        break;
+    }
+
+    // Length: only ll / j are wider than 32 bits on the ESP32
+    int longs = 0;
+    while (*p == 'h' || *p == 'l' || *p == 'z' || *p == 't' || *p == 'j' || *p == 'L' || *p == 'q') {
+      longs += (*p == 'l') ? 1 : (*p == 'j' || *p == 'q') ? 2 : 0;
+      p++;
+    }
+
+    switch (*p) {
+      case 'd': case 'i': case 'u': case 'x': case 'X': case 'o': case 'c': case 'p':
+        if (longs >= 2) {
+          if (n + 8 > cap) { *complete = false; return n; }
+          uint64_t v = va_arg(args, unsigned long long);
+          memcpy(out + n, &v, 8);
+          n += 8;
+        } else {
+          if (n + 4 > cap) { *complete = false; return n; }
+          put32(out, &n, (*p == 'p') ? (uint32_t)(uintptr_t)va_arg(args, void *) : va_arg(args, unsigned int));
+        }
+        break;
+      case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A': {
+        if (n + 8 > cap) { *complete = false; return n; }
+        double v = va_arg(args, double);
+        memcpy(out + n, &v, 8);
+        n += 8;
+        break;
+      }
+      case 's': {
+        const char *str = va_arg(args, const char *);
+        if (str == NULL)
+          str = "(null)";
+        if (n + 1 > cap) { *complete = false; return n; }
+        size_t len = strlen(str);
+        if (len > 255) len = 255;
+        if (len > cap - n - 1) len = cap - n - 1;  // Strings are cut, not dropped
+        out[n++] = (uint8_t)len;
+        memcpy(out + n, str, len);
+        n += len;
+        break;
+      }
+      case 'n':
+        (void)va_arg(args, void *);  // Nothing to record
+        break;
+      case '\0':
+        return n;                    // Dangling '%'
+      default:
+        break;                       // Unknown conversion: no argument
+    }
+  }
+  return n;
+}
+
+static void emitFrame(const LogSlot *slot)
+{
+  uint8_t frame[2 + 1 + 1 + 4 + LOG_RING_MSG_MAX + 1];
+  size_t n = 0;
+  frame[n++] = LOG_FRAME_SYNC0;
+  frame[n++] = LOG_FRAME_SYNC1;
+  frame[n++] = slot->len;
+  frame[n++] = slot->level;
+  memcpy(frame + n, &slot->ms, 4);
+  n += 4;
+  memcpy(frame + n, slot->msg, slot->len);
+  n += slot->len;
+
+  uint8_t check = 0;
+  for (size_t i = 3; i < n; i++)
+    check ^= frame[i];
+  frame[n++] = check;
+
+  Serial.write(frame, n);
+}
+#endif // GS_LOG_BINARY
+
+// -----------------------------------------------------------------------------
+// Producers
+// -----------------------------------------------------------------------------
+
+static LevelOverride *findOverride(const char *tag)
+{
+  for (uint8_t i = 0; i < levelOverrideCount; i++) {
+    if (strncmp(levelOverrides[i].tag, tag, LOG_RING_TAG_MAX) == 0)
+      return &levelOverrides[i];
+  }
+  return NULL;
+}
+
+void logRingWrite(uint8_t level, const char *tag, const char *format, va_list args)
+{
+  if (levelOverrideCount != 0 && level > logRingLevel(tag))
+    return;  // Lowered at runtime - not even formatted
+
+  if (!ringActive) {
+    writeNow(level, tag, format, args);
+    return;
+  }
+
+  LogRing &ring = rings[xPortGetCoreID() & 1];
+  uint32_t pos = __atomic_load_n(&ring.enqueuePos, __ATOMIC_RELAXED);
+  LogSlot *slot;
+  for (;;) {
+    slot = &ring.slots[pos & (LOG_RING_SLOTS - 1)];
+    int32_t lag = (int32_t)(__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) - pos);
+    if (lag == 0) {
+      // Free slot - claim it (a failed CAS reloads pos and retries)
+      if (__atomic_compare_exchange_n(&ring.enqueuePos, &pos, pos + 1, true,
+                                      __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        break;
+    } else if (lag < 0) {
+      // Slot still holds an unprinted line from the previous lap: ring full
+      __atomic_fetch_add(&ring.dropped, 1, __ATOMIC_RELAXED);
+      return;
+    } else {
+      pos = __atomic_load_n(&ring.enqueuePos, __ATOMIC_RELAXED);  // Another producer got there first
+    }
+  }
+
+  slot->ms = millis();
+#ifdef GS_LOG_BINARY
+  bool complete = true;
+  slot->len = (uint8_t)packArgs((uint8_t *)slot->msg, sizeof(slot->msg), tag, format, args, &complete);
+  slot->level = complete ? level : (level | LOG_FRAME_TRUNCATED);
+#else
+  slot->level = level;
+  strncpy(slot->tag, tag, sizeof(slot->tag) - 1);
+  slot->tag[sizeof(slot->tag) - 1] = '\0';
+  vsnprintf(slot->msg, sizeof(slot->msg), format, args);
+#endif
+  __atomic_store_n(&slot->seq, pos + 1, __ATOMIC_RELEASE);
+
+  __atomic_fetch_add(&ring.written, 1, __ATOMIC_RELAXED);
+  uint32_t used = pos + 1 - __atomic_load_n(&ring.dequeuePos, __ATOMIC_RELAXED);
+  if (used > ring.highWater)
+    ring.highWater = used;
+}
+
+// -----------------------------------------------------------------------------
+// Drain task
+// -----------------------------------------------------------------------------
+
+static LogSlot *readyHead(LogRing &ring)
+{
+  uint32_t pos = ring.dequeuePos;
+  LogSlot *slot = &ring.slots[pos & (LOG_RING_SLOTS - 1)];
+  return (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) == pos + 1) ? slot : NULL;
+}
+
+static void releaseHead(LogRing &ring, LogSlot *slot)
+{
+  uint32_t pos = ring.dequeuePos;
+  __atomic_store_n(&slot->seq, pos + LOG_RING_SLOTS, __ATOMIC_RELEASE);
+  __atomic_store_n(&ring.dequeuePos, pos + 1, __ATOMIC_RELAXED);
+}
+
+// Print the oldest ready line of either ring; false when neither has one
+static bool drainOne()
+{
+  LogSlot *head0 = readyHead(rings[0]);
+  LogSlot *head1 = readyHead(rings[1]);
+  if (head0 == NULL && head1 == NULL)
+    return false;
+
+  int core;
+  if (head1 == NULL)
+    core = 0;
+  else if (head0 == NULL)
+    core = 1;
+  else
+    core = ((int32_t)(head1->ms - head0->ms) < 0) ? 1 : 0;
+
+  LogSlot *slot = core ? head1 : head0;
+#ifdef GS_LOG_BINARY
+  emitFrame(slot);
+#else
+  emitLine(slot->level, slot->ms, slot->tag, slot->msg);
+#endif
+  releaseHead(rings[core], slot);
+  return true;
+}
+
+// Collect typed characters; a complete line goes to the command handler
+static void pollCommands(char *line, size_t *len)
+{
+  LogCommandHandler handler = commandHandler;
+  while (Serial.available() > 0) {
+    int c = Serial.read();
+    if (c < 0)
+      break;
+    if (c != '\r' && c != '\n') {
+      if (*len + 1 < LOG_COMMAND_MAX)
+        line[(*len)++] = (char)c;
+      continue;
+    }
+    if (*len == 0)
+      continue;
+    line[*len] = '\0';
+    *len = 0;
+    if (handler != NULL) {
+      bool hasMutex = (serialMutex && xSemaphoreTake(serialMutex, pdMS_TO_TICKS(2000)));
+      handler(line);
+      if (hasMutex)
+        xSemaphoreGive(serialMutex);
+    }
+  }
+}
+
+static void logDrainTask(void *parameter)
+{
+  uint32_t reportedDrops[2] = {0, 0};
+  char command[LOG_COMMAND_MAX];
+  size_t commandLen = 0;
+
+  for (;;) {
+    pollCommands(command, &commandLen);
+
+    bool printed = false;
+    if (readyHead(rings[0]) != NULL || readyHead(rings[1]) != NULL) {
+      // One ring's worth per mutex hold, so raw Serial writers can get in between
+      GS_TRACE_SCOPE("log_drain");
+      bool hasMutex = (serialMutex && xSemaphoreTake(serialMutex, pdMS_TO_TICKS(2000)));
+      for (uint32_t i = 0; i < LOG_RING_SLOTS && drainOne(); i++)
+        printed = true;
+
+      for (int core = 0; core < 2; core++) {
+        uint32_t dropped = __atomic_load_n(&rings[core].dropped, __ATOMIC_RELAXED);
+        if (dropped != reportedDrops[core]) {
+          char msg[96];
+          snprintf(msg, sizeof(msg), "⚠️  Log ring full: %lu lines dropped on core %d (%lu since boot)",
+                   (unsigned long)(dropped - reportedDrops[core]), core, (unsigned long)dropped);
+          emitLine(LOG_WARN, millis(), TAG.name, msg);
+          reportedDrops[core] = dropped;
+        }
+      }
+
+      if (hasMutex)
+        xSemaphoreGive(serialMutex);
+    }
+    if (sampleCapturePending()) {
+      // Binary sample records (sample_capture.h): whatever the USB buffer takes now
+      bool hasMutex = (serialMutex && xSemaphoreTake(serialMutex, pdMS_TO_TICKS(2000)));
+      sampleCaptureDrain(Serial);
+      if (hasMutex)
+        xSemaphoreGive(serialMutex);
+    }
+    webLogService(millis());
+    consoleService();  // WebSerial command lines (console.h)
+
+    if (!printed)
+      vTaskDelay(pdMS_TO_TICKS(LOG_DRAIN_IDLE_MS));
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Public API
+// -----------------------------------------------------------------------------
+
+void logRingBegin()
+{
+  if (ringActive)
+    return;
+
+  for (int core = 0; core < 2; core++) {
+    LogRing &ring = rings[core];
+    for (uint32_t i = 0; i < LOG_RING_SLOTS; i++)
+      ring.slots[i].seq = i;
+    ring.enqueuePos = 0;
+    ring.dequeuePos = 0;
+  }
+
+  BaseType_t result = taskLayoutSpawn(TASK_ROLE_LOG_DRAIN, logDrainTask, NULL, &drainTaskHandle);
+
+  if (result != pdPASS) {
+    LOG_ERROR(TAG, "❌ Failed to create log drain task - logging stays synchronous");
+    return;
+  }
+
+#ifdef GS_LOG_BINARY
+  // Plain text for anyone reading the port without the decoder
+  if (serialMutex && xSemaphoreTake(serialMutex, pdMS_TO_TICKS(2000))) {
+    Serial.println("[Log] Binary log frames follow - decode with tools/log_decode/log_decode.py <firmware.elf>");
+    xSemaphoreGive(serialMutex);
+  }
+#endif
+
+  __sync_synchronize();  // Rings initialised before producers see ringActive
+  ringActive = true;
+  LOG_INFO(TAG, "✅ Async logging: %lu slots/core, drain task on Core %d",
+           (unsigned long)LOG_RING_SLOTS, (int)taskLayoutSpec(TASK_ROLE_LOG_DRAIN).core);
+}
+
+void logRingSetCommandHandler(LogCommandHandler handler)
+{
+  commandHandler = handler;
+}
+
+bool logRingSetLevel(const char *tag, uint8_t level)
+{
+  LevelOverride *entry = findOverride(tag);
+  if (entry != NULL) {
+    entry->level = level;
+    return true;
+  }
+  if (level >= LOG_VERBOSE)
+    return true;  // Nothing to lift
+  if (levelOverrideCount == LOG_LEVEL_OVERRIDES)
+    return false;
+
+  entry = &levelOverrides[levelOverrideCount];
+  strncpy(entry->tag, tag, sizeof(entry->tag) - 1);
+  entry->tag[sizeof(entry->tag) - 1] = '\0';
+  entry->level = level;
+  __sync_synchronize();  // Entry complete before producers can see it
+  levelOverrideCount = levelOverrideCount + 1;
+  return true;
+}
+
+uint8_t logRingLevel(const char *tag)
+{
+  const LevelOverride *entry = findOverride(tag);
+  return entry != NULL ? entry->level : LOG_VERBOSE;
+}
+
+bool logRingFlush(uint32_t timeoutMs)
+{
+  if (!ringActive)
+    return true;
+  if (xTaskGetCurrentTaskHandle() == drainTaskHandle) {
+    while (drainOne()) {
+    }
+    return true;
+  }
+
+  uint32_t start = millis();
+  for (;;) {
+    bool empty = true;
+    for (int core = 0; core < 2; core++) {
+      if (__atomic_load_n(&rings[core].enqueuePos, __ATOMIC_RELAXED) !=
+          __atomic_load_n(&rings[core].dequeuePos, __ATOMIC_RELAXED))
+        empty = false;
+    }
+    if (empty)
+      return true;
+    if (millis() - start >= timeoutMs)
+      return false;
+    vTaskDelay(1);
+  }
+}
+
+void logRingGetStats(LogRingStats *out)
+{
+  for (int core = 0; core < 2; core++) {
+    out->written[core] = __atomic_load_n(&rings[core].written, __ATOMIC_RELAXED);
+    out->dropped[core] = __atomic_load_n(&rings[core].dropped, __ATOMIC_RELAXED);
+    out->highWater[core] = rings[core].highWater;
+  }
+}
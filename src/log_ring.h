@@ -0,0 +1,121 @@
+#ifndef LOG_RING_H
+#define LOG_RING_H
+
+// =============================================================================
+// Asynchronous Log Backend (per-core lock-free rings + drain task)
+// =============================================================================
+// LOG_*() used to format, take serialMutex and write to USB CDC (and
+// WebSerial) in the caller. With LOG_LEVEL_SHOT at VERBOSE the BLE task did
+// that on every weight sample, and a slow or disconnected serial host stalled
+// Core 0 inside Serial.print(). Now:
+//
+//   producer (any task) ──► vsnprintf into a slot of its core's ring ──► return
+//   drain task (Core 1, lowest priority) ──► colour + Serial, batched WebSerial
+//
+//   - One bounded ring per core (bounded MPMC queue, per-slot sequence
+//     numbers), so a producer never waits for a lock or for I/O. Tasks on the
+//     same core (or an unpinned task that migrates) still claim slots safely
+//     with one compare-and-swap.
+//   - A full ring drops the line and counts it. The drain task reports the
+//     drops as a warning once it catches up - logging never blocks.
+//   - The drain task merges both rings oldest first (millisecond timestamp
+//     taken in the producer), so output order matches the event order.
+//   - Before logRingBegin() (early boot) lines are written synchronously
+//     under serialMutex, as before.
+//   - WebSerial (debug builds) gets the lines through its own batched,
+//     rate-limited sink (web_log.h); USB Serial gets every one.
+//   - The drain task also owns serial input: typed lines go to the handler
+//     set with logRingSetCommandHandler().
+//   - logRingSetLevel() lowers a tag's level at runtime ("loglevel" on the
+//     console): the producer returns before formatting. It cannot go above
+//     the compile-time level - those calls are not in the image.
+//
+// Binary mode (-DGS_LOG_BINARY): producers skip vsnprintf and store the tag
+// pointer, the format pointer and the raw arguments (strings copied); the
+// drain task sends that as a small frame instead of a formatted line. The
+// strings stay in flash, so a typical shot sample is ~25 bytes on the wire
+// instead of ~80, and the producer only walks the format for argument types.
+// tools/log_decode/log_decode.py turns the stream back into text with the
+// firmware ELF. Text written outside LOG_*() (boot banner, drop warnings)
+// passes through the decoder unchanged. Frames go to USB Serial only.
+//
+//   frame: A5 5A | len | level | ms (u32) | tag ptr | fmt ptr | args | xor
+//   args:  int/char/ptr u32, %ll/%j u64, %f/%e/%g double, %s u8 len + bytes
+//   (little endian; the xor covers level..args; level bit 7 = args truncated)
+//
+// Lines still queued at a panic are lost; the panic handler prints its own
+// backtrace.
+//
+// Thread Safety:
+//   logRingWrite() from any task on either core (not from ISRs: it calls
+//   millis() and vsnprintf). Only the drain task prints, under serialMutex so
+//   the few raw Serial writers elsewhere don't interleave with it.
+// =============================================================================
+
+#include <Arduino.h>
+#include <stdarg.h>
+
+constexpr uint32_t LOG_RING_SLOTS         = 32;    // Per core, power of two
+constexpr uint32_t LOG_RING_MSG_MAX       = 236;   // Formatted message incl. NUL / binary payload (slot = 256 bytes)
+constexpr uint32_t LOG_RING_TAG_MAX       = 10;    // Tag incl. NUL (text mode)
+constexpr uint32_t LOG_DRAIN_IDLE_MS      = 10;    // Poll period while both rings are empty
+constexpr size_t LOG_COMMAND_MAX          = 96;    // Serial command line incl. NUL (console.h)
+constexpr uint8_t LOG_LEVEL_OVERRIDES     = 16;    // Tags with a runtime level ("loglevel")
+
+#ifdef GS_LOG_BINARY
+constexpr uint8_t LOG_FRAME_SYNC0     = 0xA5;
+constexpr uint8_t LOG_FRAME_SYNC1     = 0x5A;
+constexpr uint8_t LOG_FRAME_TRUNCATED = 0x80;  // Level flag: arguments did not fit the slot
+#endif
+
+struct LogRingStats {
+  uint32_t written[2];   // Lines queued per core
+  uint32_t dropped[2];   // Lines lost to a full ring per core
+  uint32_t highWater[2]; // Most slots ever in use per core
+};
+
+/**
+ * @brief Start the drain task; LOG_*() switches from synchronous to queued output
+ * @note Call once, after serialMutex exists
+ */
+void logRingBegin();
+
+/**
+ * @brief Format one line (binary: pack its arguments) and queue it on the caller's core,
+ *        or print it now before logRingBegin()
+ * @param level log_level_t value (1=ERROR .. 5=VERBOSE)
+ */
+void logRingWrite(uint8_t level, const char *tag, const char *format, va_list args);
+
+/**
+ * @brief Line handler for text typed into the USB serial port (e.g. "trace")
+ * @note Runs in the drain task with serialMutex held, so it may print with Serial directly
+ */
+typedef void (*LogCommandHandler)(const char *line);
+void logRingSetCommandHandler(LogCommandHandler handler);
+
+/**
+ * @brief Runtime ceiling for `tag` (LOG_VERBOSE = only the compile-time level applies)
+ * @return false if LOG_LEVEL_OVERRIDES tags already have one
+ * @note One writer at a time (the console); producers read it without a lock
+ */
+bool logRingSetLevel(const char *tag, uint8_t level);
+
+/**
+ * @brief Runtime ceiling of `tag`, LOG_VERBOSE if none was set
+ */
+uint8_t logRingLevel(const char *tag);
+
+/**
+ * @brief Wait until both rings are drained (e.g. before a restart)
+ * @return false if lines were still queued after timeoutMs
+ * @note On the drain task itself (a console command) it prints them right away
+ */
+bool logRingFlush(uint32_t timeoutMs);
+
+/**
+ * @brief Snapshot of the per-core counters
+ */
+void logRingGetStats(LogRingStats *out);
+
+#endif // LOG_RING_H
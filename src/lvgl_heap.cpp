@@ -0,0 +1,81 @@
+// =============================================================================
+// Dedicated LVGL Heap Implementation
+// =============================================================================
+
+#include "lvgl_heap.h"
+#include "debug_config.h"
+#include "metrics.h"
+#include "seqlock.h"
+#include "lvgl.h"
+
+static constexpr LogTag TAG = LOG_TAG_LVGL;
+
+struct LvglHeapStats {
+  bool valid;
+  lv_mem_monitor_t mon;
+};
+
+static MetricGauge usedBytes("lvgl_heap_used_bytes", "LVGL pool in use");
+static MetricGauge biggestFree("lvgl_heap_biggest_free_bytes", "Largest free block in the LVGL pool");
+static MetricGauge fragPct("lvgl_heap_frag_pct", "LVGL pool fragmentation");
+
+static const char *poolRegion = "none";
+static size_t poolSize = 0;
+static unsigned long lastSampleMs = 0;
+static SeqLock<LvglHeapStats> shared(LvglHeapStats{});
+
+extern "C" void *lvglHeapPool(size_t size)
+{
+  const uint32_t PSRAM = MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT;
+  const uint32_t INTERNAL = MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
+  const uint32_t first = GS_LVGL_HEAP_PSRAM ? PSRAM : INTERNAL;
+  const uint32_t second = GS_LVGL_HEAP_PSRAM ? INTERNAL : PSRAM;
+
+  void *pool = heap_caps_aligned_alloc(8, size, first);
+  poolRegion = (first == PSRAM) ? "psram" : "internal";
+  if (pool == NULL) {
+    pool = heap_caps_aligned_alloc(8, size, second);
+    poolRegion = (second == PSRAM) ? "psram" : "internal";
+    LOG_WARN(TAG, "⚠️  LVGL pool: %s region full, %uKB from %s", (first == PSRAM) ? "psram" : "internal",
+             (unsigned)(size / 1024), poolRegion);
+  }
+  if (pool == NULL) {
+    LOG_ERROR(TAG, "❌ LVGL pool of %uKB unavailable", (unsigned)(size / 1024));
+    abort();  // lv_init() can't run without it
+  }
+  poolSize = size;
+  LOG_INFO(TAG, "💾 LVGL pool %uKB in %s at %p", (unsigned)(size / 1024), poolRegion, pool);
+  return pool;
+}
+
+void lvglHeapService()
+{
+  unsigned long now = millis();
+  if (poolSize == 0 || now - lastSampleMs < LVGL_HEAP_SAMPLE_MS)
+    return;
+  lastSampleMs = now;
+
+  LvglHeapStats s;
+  s.valid = true;
+  lv_mem_monitor(&s.mon);
+  shared.update([&](LvglHeapStats &d) { d = s; });
+  usedBytes.set((int32_t)(s.mon.total_size - s.mon.free_size));
+  biggestFree.set((int32_t)s.mon.free_biggest_size);
+  fragPct.set(s.mon.frag_pct);
+}
+
+void lvglHeapDump(Print &out)
+{
+  LvglHeapStats s = shared.load();
+  out.printf("[LVGL heap] %uKB TLSF pool in %s\n", (unsigned)(poolSize / 1024), poolRegion);
+  if (!s.valid) {
+    out.println("  not sampled yet");
+    return;
+  }
+  const lv_mem_monitor_t &m = s.mon;
+  out.printf("  used %lu / %lu bytes (%u%%), peak %lu, %lu blocks\n",
+             (unsigned long)(m.total_size - m.free_size), (unsigned long)m.total_size, m.used_pct,
+             (unsigned long)m.max_used, (unsigned long)m.used_cnt);
+  out.printf("  free %lu bytes in %lu blocks, largest %lu, fragmentation %u%%\n", (unsigned long)m.free_size,
+             (unsigned long)m.free_cnt, (unsigned long)m.free_biggest_size, m.frag_pct);
+}
@@ -0,0 +1,55 @@
+#ifndef LVGL_HEAP_H
+#define LVGL_HEAP_H
+
+// =============================================================================
+// Dedicated LVGL Heap (TLSF pool outside the system heap)
+// =============================================================================
+// lv_conf.h builds LVGL with its own TLSF allocator (LV_MEM_CUSTOM 0) on one
+// LV_MEM_SIZE pool that lv_init() requests from lvglHeapPool()
+// (LV_MEM_POOL_ALLOC). Widget, style, label text and draw-buffer churn stays
+// in that pool: it cannot fragment the internal heap BLE scanning and
+// connecting depend on, allocations and frees are O(1), and fragmentation is
+// bounded by the pool.
+//
+// The pool lives in PSRAM (GS_LVGL_HEAP_PSRAM=1, default) - the internal
+// RAM stays for BLE, DMA bounce buffers and task stacks - or in internal RAM
+// with GS_LVGL_HEAP_PSRAM=0 for A/B render timing. If that region can't
+// hold it, the other one is used (logged).
+//
+// Per-screen arenas are not needed here: every screen (SquareLine's two,
+// history, scale picker) is created once and kept, so object trees are never
+// torn down and rebuilt.
+//
+// Statistics: lv_mem_monitor() works again (LV_USE_MEM_MONITOR, "lvgl" on
+// the serial console). It walks the pool, so the UI task samples it every
+// LVGL_HEAP_SAMPLE_MS into lvgl_heap_* gauges and a published snapshot.
+//
+// Thread Safety:
+//   lvglHeapPool() - lv_init() only. lvglHeapService() - UI task (LVGL
+//   owner). lvglHeapDump() - any task (reads the snapshot).
+// =============================================================================
+
+#include <Arduino.h>
+
+#ifndef GS_LVGL_HEAP_PSRAM
+#define GS_LVGL_HEAP_PSRAM 1
+#endif
+
+constexpr uint32_t LVGL_HEAP_SAMPLE_MS = 5000;
+
+/**
+ * @brief Pool for LVGL's TLSF heap (LV_MEM_POOL_ALLOC, called once by lv_init())
+ */
+extern "C" void *lvglHeapPool(size_t size);
+
+/**
+ * @brief Sample lv_mem_monitor() every LVGL_HEAP_SAMPLE_MS (cheap, call every UI pass)
+ */
+void lvglHeapService();
+
+/**
+ * @brief Pool location, use, peak, largest free block and fragmentation
+ */
+void lvglHeapDump(Print &out);
+
+#endif // LVGL_HEAP_H
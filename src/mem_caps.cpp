@@ -0,0 +1,98 @@
+// =============================================================================
+// Capability-Aware Buffer Allocation Implementation
+// =============================================================================
+
+#include "mem_caps.h"
+#include "debug_config.h"
+#include "esp_heap_caps.h"
+#include "soc/soc_memory_layout.h"   // esp_ptr_external_ram()
+
+static constexpr LogTag TAG = LOG_TAG_SYSTEM;
+
+static const char *const OWNER_NAMES[MEM_OWNER_COUNT] = {
+  "task stacks", "shot samples", "shot log", "shot export", "trace", "ota", "ble maint", "layer cache", "mirror",
+  "touch replay", "sample capture", "shot events"
+};
+
+struct OwnerUse {
+  uint32_t psramBytes;      // Held now
+  uint32_t internalBytes;
+  uint32_t fallbacks;       // MEM_PSRAM_FIRST requests that landed internal
+  uint32_t failures;
+};
+
+static OwnerUse use[MEM_OWNER_COUNT];
+
+static inline void account(uint32_t *field, int32_t delta)
+{
+  __atomic_fetch_add(field, (uint32_t)delta, __ATOMIC_RELAXED);
+}
+
+static void *tryAlloc(size_t bytes, uint32_t caps, bool zero)
+{
+  return zero ? heap_caps_calloc(1, bytes, caps) : heap_caps_malloc(bytes, caps);
+}
+
+void *memCapsAlloc(size_t bytes, MemPlace place, MemOwner owner, bool zero)
+{
+  OwnerUse &u = use[owner];
+  void *ptr = NULL;
+
+#if GS_MEM_PSRAM_BUFFERS
+  if (place == MEM_PSRAM || place == MEM_PSRAM_FIRST) {
+    ptr = tryAlloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT, zero);
+    if (ptr != NULL) {
+      account(&u.psramBytes, (int32_t)bytes);
+      return ptr;
+    }
+    if (place == MEM_PSRAM) {
+      account(&u.failures, 1);
+      LOG_WARN(TAG, "⚠️  %s: %u bytes of PSRAM not available", OWNER_NAMES[owner], (unsigned)bytes);
+      return NULL;
+    }
+    account(&u.fallbacks, 1);
+  }
+#endif
+
+  uint32_t caps = MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
+  if (place == MEM_DMA)
+    caps |= MALLOC_CAP_DMA;
+  ptr = tryAlloc(bytes, caps, zero);
+  if (ptr == NULL) {
+    account(&u.failures, 1);
+    LOG_WARN(TAG, "⚠️  %s: %u bytes of internal RAM not available", OWNER_NAMES[owner], (unsigned)bytes);
+    return NULL;
+  }
+  account(&u.internalBytes, (int32_t)bytes);
+  return ptr;
+}
+
+void memCapsFree(void *ptr, size_t bytes, MemOwner owner)
+{
+  if (ptr == NULL)
+    return;
+  OwnerUse &u = use[owner];
+  if (esp_ptr_external_ram(ptr))
+    account(&u.psramBytes, -(int32_t)bytes);
+  else
+    account(&u.internalBytes, -(int32_t)bytes);
+  heap_caps_free(ptr);
+}
+
+void memCapsDump(Print &out)
+{
+  out.printf("  internal: %u free, largest block %u; PSRAM: %u free, largest block %u%s\n",
+             (unsigned)heap_caps_get_free_size(MALLOC_CAP_INTERNAL),
+             (unsigned)heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL),
+             (unsigned)heap_caps_get_free_size(MALLOC_CAP_SPIRAM),
+             (unsigned)heap_caps_get_largest_free_block(MALLOC_CAP_SPIRAM),
+             GS_MEM_PSRAM_BUFFERS ? "" : " (GS_MEM_PSRAM_BUFFERS=0: buffers forced internal)");
+  out.printf("  %-14s %9s %9s %9s %8s\n", "buffers", "psram", "internal", "fallback", "failed");
+  for (uint8_t i = 0; i < MEM_OWNER_COUNT; i++) {
+    const OwnerUse &u = use[i];
+    if (u.psramBytes == 0 && u.internalBytes == 0 && u.fallbacks == 0 && u.failures == 0)
+      continue;
+    out.printf("  %-14s %9lu %9lu %9lu %8lu\n", OWNER_NAMES[i], (unsigned long)u.psramBytes,
+               (unsigned long)u.internalBytes, (unsigned long)u.fallbacks, (unsigned long)u.failures);
+  }
+}
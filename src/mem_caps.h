@@ -0,0 +1,88 @@
+#ifndef MEM_CAPS_H
+#define MEM_CAPS_H
+
+// =============================================================================
+// Capability-Aware Buffer Allocation (internal DRAM kept for BLE and DMA)
+// =============================================================================
+// Internal DRAM is what the BLE controller, Wi-Fi, lwIP and every DMA
+// descriptor need, and bleTaskFunction warns once it drops under 100 KB free
+// or a 20 KB largest block. Working buffers of the non-real-time side (trace
+// rings, shot log bodies, OTA inflate window, export sample copies, ...) were
+// each a heap_caps_malloc() with its own PSRAM-then-internal fallback, or none.
+// They now say what they need and this module picks the heap:
+//
+//   MEM_PSRAM       CPU-only, never touched with the flash cache off. PSRAM
+//                   or nothing - a failure is the caller's to report, the
+//                   buffer never eats into internal DRAM.
+//   MEM_PSRAM_FIRST As above, but falls back to internal DRAM (counted) when
+//                   PSRAM is missing or full - for buffers the firmware
+//                   cannot run without.
+//   MEM_INTERNAL    Touched from an ISR, with the cache off, or too hot for
+//                   PSRAM latency.
+//   MEM_DMA         Internal and DMA-capable (GDMA descriptors and buffers).
+//
+//   ring = (TraceEvent *)memCapsAlloc(bytes, MEM_PSRAM_FIRST, MEM_OWNER_TRACE, true);
+//
+// Every allocation is counted per owner and per heap it landed in, so "heap"
+// on the console shows who holds what in PSRAM and in internal DRAM, and how
+// many PSRAM requests fell back. Buffers here are long-lived (allocated at
+// begin, freed rarely); memCapsFree() takes the size back off its owner.
+//
+// Task stacks follow the same split in task_layout.cpp (TASK_STACK_PSRAM for
+// the tasks that never touch flash: health, task stats, display diagnostics).
+//
+// GS_MEM_PSRAM_BUFFERS (compile-time, -DGS_MEM_PSRAM_BUFFERS=0): treat
+// MEM_PSRAM / MEM_PSRAM_FIRST as MEM_INTERNAL, for A/B runs of the internal
+// DRAM margin. Default 1.
+//
+// Thread Safety:
+//   memCapsAlloc() / memCapsFree() from any task (heap_caps is locked, the
+//   counters are atomic). memCapsDump() from any task.
+// =============================================================================
+
+#include <Arduino.h>
+
+#ifndef GS_MEM_PSRAM_BUFFERS
+#define GS_MEM_PSRAM_BUFFERS 1
+#endif
+
+enum MemPlace : uint8_t {
+  MEM_PSRAM = 0,
+  MEM_PSRAM_FIRST,
+  MEM_INTERNAL,
+  MEM_DMA
+};
+
+enum MemOwner : uint8_t {
+  MEM_OWNER_TASK_STACKS = 0,
+  MEM_OWNER_SHOT_SAMPLES,
+  MEM_OWNER_SHOT_LOG,
+  MEM_OWNER_SHOT_EXPORT,
+  MEM_OWNER_TRACE,
+  MEM_OWNER_OTA,
+  MEM_OWNER_BLE_MAINT,
+  MEM_OWNER_LAYER_CACHE,
+  MEM_OWNER_MIRROR,
+  MEM_OWNER_TOUCH_REPLAY,
+  MEM_OWNER_SAMPLE_CAPTURE,
+  MEM_OWNER_SHOT_EVENTS,
+  MEM_OWNER_COUNT
+};
+
+/**
+ * @brief `bytes` from the heap `place` asks for (zeroed if `zero`)
+ * @return NULL when no allowed heap has a block that large
+ */
+void *memCapsAlloc(size_t bytes, MemPlace place, MemOwner owner, bool zero = false);
+
+/**
+ * @brief Free a memCapsAlloc() buffer of `bytes` (NULL is ignored)
+ */
+void memCapsFree(void *ptr, size_t bytes, MemOwner owner);
+
+/**
+ * @brief Internal / PSRAM free + largest block, bytes held per owner, fallbacks
+ */
+void memCapsDump(Print &out);
+
+#endif // MEM_CAPS_H
@@ -0,0 +1,207 @@
+// =============================================================================
+// Alignment-Aware Copy / Fill Primitives Implementation
+// =============================================================================
+
+#include "mem_fast.h"
+#include "pins_config.h"
+#include "esp_timer.h"
+#include "iram_placement.h"
+
+#if defined(CONFIG_IDF_TARGET_ESP32S3) && CONFIG_IDF_TARGET_ESP32S3
+#define MEM_FAST_PIE 1
+#else
+#define MEM_FAST_PIE 0
+#endif
+
+#if MEM_FAST_PIE
+// 16-byte blocks, both pointers 16-byte aligned
+static inline void pieCopy(void *dst, const void *src, size_t blocks)
+{
+  asm volatile(
+      "1:\n"
+      "ee.vld.128.ip    q0, %[s], 16\n"
+      "ee.vst.128.ip    q0, %[d], 16\n"
+      "addi             %[n], %[n], -1\n"
+      "bnez             %[n], 1b\n"
+      : [d] "+r"(dst), [s] "+r"(src), [n] "+r"(blocks)
+      :
+      : "memory");
+}
+
+// 16-byte blocks of the 16-bit value at `value`, dst 16-byte aligned
+static inline void pieFill16(void *dst, const uint16_t *value, size_t blocks)
+{
+  asm volatile(
+      "ee.vldbc.16      q0, %[v]\n"
+      "1:\n"
+      "ee.vst.128.ip    q0, %[d], 16\n"
+      "addi             %[n], %[n], -1\n"
+      "bnez             %[n], 1b\n"
+      : [d] "+r"(dst), [n] "+r"(blocks)
+      : [v] "r"(value)
+      : "memory");
+}
+#endif
+
+void GS_HOT_IRAM memFastCopy(void *dst, const void *src, size_t bytes)
+{
+#if MEM_FAST_PIE
+  uintptr_t d = (uintptr_t)dst;
+  uintptr_t s = (uintptr_t)src;
+  if (bytes >= MEM_FAST_PIE_MIN_BYTES && ((d ^ s) & 15) == 0) {
+    size_t head = (16 - (d & 15)) & 15;
+    memcpy(dst, src, head);
+    size_t blocks = (bytes - head) >> 4;
+    pieCopy((uint8_t *)dst + head, (const uint8_t *)src + head, blocks);
+    size_t done = head + (blocks << 4);
+    memcpy((uint8_t *)dst + done, (const uint8_t *)src + done, bytes - done);
+    return;
+  }
+#endif
+  memcpy(dst, src, bytes);
+}
+
+// Two pixels per 32-bit store once dst is word aligned
+static void GS_HOT_IRAM wordFill16(uint16_t *dst, uint16_t value, size_t count)
+{
+  if (count > 0 && ((uintptr_t)dst & 2)) {
+    *dst++ = value;
+    count--;
+  }
+  uint32_t pair = value | ((uint32_t)value << 16);
+  uint32_t *d32 = (uint32_t *)dst;
+  for (size_t i = count >> 1; i > 0; i--)
+    *d32++ = pair;
+  if (count & 1)
+    *(uint16_t *)d32 = value;
+}
+
+void GS_HOT_IRAM memFastFill16(uint16_t *dst, uint16_t value, size_t count)
+{
+#if MEM_FAST_PIE
+  if (count * 2 >= MEM_FAST_PIE_MIN_BYTES) {
+    while ((uintptr_t)dst & 15) {
+      *dst++ = value;
+      count--;
+    }
+    size_t blocks = count >> 3;
+    pieFill16(dst, &value, blocks);
+    dst += blocks << 3;
+    count &= 7;
+  }
+#endif
+  wordFill16(dst, value, count);
+}
+
+// ---------------------------------------------------------------------------
+// Benchmark
+// ---------------------------------------------------------------------------
+
+static void wordCopy(void *dst, const void *src, size_t bytes)
+{
+  uint32_t *d = (uint32_t *)dst;
+  const uint32_t *s = (const uint32_t *)src;
+  for (size_t i = bytes >> 2; i > 0; i--)
+    *d++ = *s++;
+}
+
+static void libcCopy(void *dst, const void *src, size_t bytes)
+{
+  memcpy(dst, src, bytes);
+}
+
+static void halfFill16(uint16_t *dst, uint16_t value, size_t count)
+{
+  while (count--)
+    *dst++ = value;
+}
+
+typedef void (*CopyFn)(void *, const void *, size_t);
+typedef void (*FillFn)(uint16_t *, uint16_t, size_t);
+
+static uint32_t mbPerS(uint32_t bytes, int64_t us)
+{
+  return us > 0 ? (uint32_t)((uint64_t)bytes / (uint64_t)us) : 0;  // B/µs == MB/s
+}
+
+static uint32_t timeCopy(CopyFn fn, void *dst, const void *src, size_t block)
+{
+  uint32_t reps = MEM_FAST_BENCH_BYTES / block;
+  int64_t start = esp_timer_get_time();
+  for (uint32_t i = 0; i < reps; i++)
+    fn(dst, src, block);
+  return mbPerS(reps * block, esp_timer_get_time() - start);
+}
+
+static uint32_t timeFill(FillFn fn, void *dst, size_t block)
+{
+  uint32_t reps = MEM_FAST_BENCH_BYTES / block;
+  int64_t start = esp_timer_get_time();
+  for (uint32_t i = 0; i < reps; i++)
+    fn((uint16_t *)dst, (uint16_t)i, block / 2);
+  return mbPerS(reps * block, esp_timer_get_time() - start);
+}
+
+void memFastBench(Print &out)
+{
+  const uint32_t INTERNAL = MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
+  const uint32_t PSRAM = MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT;
+  uint8_t *intA = (uint8_t *)heap_caps_aligned_alloc(16, MEM_FAST_BENCH_INTERNAL_BYTES, INTERNAL);
+  uint8_t *intB = (uint8_t *)heap_caps_aligned_alloc(16, MEM_FAST_BENCH_INTERNAL_BYTES, INTERNAL);
+  uint8_t *psA = (uint8_t *)heap_caps_aligned_alloc(16, MEM_FAST_BENCH_PSRAM_BYTES, PSRAM);
+  uint8_t *psB = (uint8_t *)heap_caps_aligned_alloc(16, MEM_FAST_BENCH_PSRAM_BYTES, PSRAM);
+  if (intA != NULL && intB != NULL && psA != NULL && psB != NULL) {
+    memset(intA, 0x5A, MEM_FAST_BENCH_INTERNAL_BYTES);
+    memset(psA, 0xA5, MEM_FAST_BENCH_PSRAM_BYTES);
+
+    struct Pair {
+      const char *name;
+      uint8_t *dst;
+      const uint8_t *src;
+      size_t capacity;
+    };
+    const Pair copies[] = {
+      {"int→int", intB, intA, MEM_FAST_BENCH_INTERNAL_BYTES},
+      {"int→psram", psB, intA, MEM_FAST_BENCH_INTERNAL_BYTES},
+      {"psram→psram", psB, psA, MEM_FAST_BENCH_PSRAM_BYTES},
+    };
+    const Pair fills[] = {
+      {"int", intB, NULL, MEM_FAST_BENCH_INTERNAL_BYTES},
+      {"psram", psB, NULL, MEM_FAST_BENCH_PSRAM_BYTES},
+    };
+    const size_t sizes[] = {64, UI_HOR_RES * 2, 4096, MEM_FAST_BENCH_INTERNAL_BYTES, MEM_FAST_BENCH_PSRAM_BYTES};
+
+    out.printf("[MemBench] MB/s over %luKB per cell, PIE %s from %u bytes\n",
+               (unsigned long)(MEM_FAST_BENCH_BYTES / 1024), MEM_FAST_PIE ? "on" : "n/a",
+               (unsigned)MEM_FAST_PIE_MIN_BYTES);
+    out.println("  copy           bytes   memcpy   word32  memFastCopy");
+    for (const Pair &p : copies) {
+      for (size_t size : sizes) {
+        if (size > p.capacity)
+          continue;
+        out.printf("  %-12s %7u %8lu %8lu %12lu\n", p.name, (unsigned)size,
+                   (unsigned long)timeCopy(libcCopy, p.dst, p.src, size),
+                   (unsigned long)timeCopy(wordCopy, p.dst, p.src, size),
+                   (unsigned long)timeCopy(memFastCopy, p.dst, p.src, size));
+      }
+    }
+    out.println("  fill           bytes    16bit   word32  memFastFill16");
+    for (const Pair &p : fills) {
+      for (size_t size : sizes) {
+        if (size > p.capacity)
+          continue;
+        out.printf("  %-12s %7u %8lu %8lu %14lu\n", p.name, (unsigned)size,
+                   (unsigned long)timeFill(halfFill16, p.dst, size),
+                   (unsigned long)timeFill(wordFill16, p.dst, size),
+                   (unsigned long)timeFill(memFastFill16, p.dst, size));
+      }
+    }
+  } else {
+    out.println("[MemBench] test buffers unavailable");
+  }
+
+  heap_caps_free(intA);
+  heap_caps_free(intB);
+  heap_caps_free(psA);
+  heap_caps_free(psB);
+}
@@ -0,0 +1,64 @@
+#ifndef MEM_FAST_H
+#define MEM_FAST_H
+
+// =============================================================================
+// Alignment-Aware Copy / Fill Primitives (PSRAM frame buffers)
+// =============================================================================
+// Full-frame rendering is bound by PSRAM bandwidth, and LVGL's own
+// byte-oriented lv_memcpy / lv_memset are the slowest way to move it.
+// lv_conf.h therefore sets LV_MEMCPY_MEMSET_STD 1: LVGL calls newlib's
+// memcpy / memset (word-wide, in ROM on the S3) for its buffer operations.
+//
+// Large pixel moves done by this firmware - the draw_s3.h blend rows - use
+// the primitives below, which pick per call:
+//
+//   memFastCopy    >= MEM_FAST_PIE_MIN_BYTES and source / destination in the
+//                  same 16-byte phase: 128-bit ee.vld / ee.vst pairs between
+//                  scalar head and tail; anything else: memcpy
+//   memFastFill16  >= MEM_FAST_PIE_MIN_BYTES: 128-bit ee.vst of a broadcast
+//                  value; shorter: 32-bit stores of two pixels
+//
+// The thresholds come from memFastBench() ("bench mem" on the console):
+// MB/s of memcpy, a 32-bit word loop and the PIE path for internal → internal,
+// internal → PSRAM and PSRAM → PSRAM copies, and of 16-bit, 32-bit and PIE
+// fills, from 64 bytes through one display row to blocks larger than the
+// data cache (the uncached PSRAM rate). Re-run it after changing the PSRAM
+// clock or cache settings before moving MEM_FAST_PIE_MIN_BYTES.
+//
+// No LV_DISP_ROT_MAX_BUF scratch is involved: rendering is landscape already
+// and the panel rotation happens in the DMA bounce buffers (AXS15231B.h).
+//
+// The PIE q registers are not saved by the IDF 4.4 scheduler. The render
+// task is the only user on the pixel path; nothing that pre-empts it uses
+// PIE. memFastBench() runs on the console (LogDrain, below the render task on
+// Core 1): a render pass that pre-empts it can only clobber benchmark data.
+//
+// Thread Safety:
+//   memFastCopy() / memFastFill16(): render task, or tasks that never pre-empt
+//   it (see above). memFastBench(): the serial console. Non-S3 targets compile
+//   to memcpy / word loops and are safe anywhere.
+// =============================================================================
+
+#include <Arduino.h>
+
+constexpr size_t MEM_FAST_PIE_MIN_BYTES        = 64;      // Below: the head / tail split costs more than it saves
+constexpr size_t MEM_FAST_BENCH_INTERNAL_BYTES = 16384;   // Internal RAM test buffers (x2)
+constexpr size_t MEM_FAST_BENCH_PSRAM_BYTES    = 131072;  // PSRAM test buffers (x2) - larger than the data cache
+constexpr uint32_t MEM_FAST_BENCH_BYTES        = 262144;  // Moved per measurement (repeats of one block)
+
+/**
+ * @brief memcpy() for pixel data (non-overlapping)
+ */
+void memFastCopy(void *dst, const void *src, size_t bytes);
+
+/**
+ * @brief Store `value` in `count` consecutive 16-bit words (dst 2-byte aligned)
+ */
+void memFastFill16(uint16_t *dst, uint16_t value, size_t count);
+
+/**
+ * @brief MB/s of each copy / fill method per memory pair and size (blocks the caller ~0.5 s)
+ */
+void memFastBench(Print &out);
+
+#endif // MEM_FAST_H
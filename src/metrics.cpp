@@ -0,0 +1,189 @@
+// =============================================================================
+// Runtime Metrics Registry Implementation
+// =============================================================================
+
+#include "metrics.h"
+
+const uint32_t METRIC_BUCKETS_US[METRIC_HIST_BOUNDS] = {
+  50, 100, 200, 500, 1000, 2000, 5000, 10000, 20000, 50000, 100000
+};
+const uint32_t METRIC_BUCKETS_MS[METRIC_HIST_BOUNDS] = {
+  10, 20, 50, 75, 100, 150, 200, 300, 500, 1000, 2000
+};
+
+// Zero-initialised before any constructor runs, so registration order across
+// translation units doesn't matter
+static Metric *registryHead = NULL;
+static Metric *registryTail = NULL;
+
+Metric::Metric(const char *name, const char *help, MetricType type)
+  : name(name), help(help), type(type), next(NULL)
+{
+  // Append, so the dump follows declaration order within each file
+  if (registryTail == NULL)
+    registryHead = this;
+  else
+    registryTail->next = this;
+  registryTail = this;
+}
+
+Metric *metricsFirst()
+{
+  return registryHead;
+}
+
+void MetricGauge::set(int32_t v)
+{
+  __atomic_store_n(&current, v, __ATOMIC_RELAXED);
+  int32_t seen = __atomic_load_n(&peak, __ATOMIC_RELAXED);
+  while (v > seen && !__atomic_compare_exchange_n(&peak, &seen, v, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+  }
+}
+
+void MetricHistogram::record(uint32_t v)
+{
+  int i = 0;
+  while (i < METRIC_HIST_BOUNDS && v > bounds[i])
+    i++;
+  __atomic_fetch_add(&buckets[i], 1, __ATOMIC_RELAXED);
+  __atomic_fetch_add(&count, 1, __ATOMIC_RELAXED);
+  __atomic_fetch_add(&sum, v, __ATOMIC_RELAXED);
+
+  uint32_t seen = __atomic_load_n(&peak, __ATOMIC_RELAXED);
+  while (v > seen && !__atomic_compare_exchange_n(&peak, &seen, v, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+  }
+}
+
+void MetricHistogram::snapshot(HistogramSnapshot *out) const
+{
+  uint32_t total = 0;
+  for (int i = 0; i <= METRIC_HIST_BOUNDS; i++) {
+    out->buckets[i] = __atomic_load_n(&buckets[i], __ATOMIC_RELAXED);
+    total += out->buckets[i];
+  }
+  out->count = total;  // Consistent with the buckets, even mid-record()
+  out->sum = __atomic_load_n(&sum, __ATOMIC_RELAXED);
+  out->max = __atomic_load_n(&peak, __ATOMIC_RELAXED);
+}
+
+uint32_t MetricHistogram::percentile(const HistogramSnapshot &snap, float q) const
+{
+  if (snap.count == 0)
+    return 0;
+  uint32_t rank = (uint32_t)ceilf(q * snap.count);
+  if (rank == 0)
+    rank = 1;
+  uint32_t seen = 0;
+  for (int i = 0; i < METRIC_HIST_BOUNDS; i++) {
+    seen += snap.buckets[i];
+    if (seen >= rank)
+      return min(bounds[i], snap.max);
+  }
+  return snap.max;
+}
+
+void MetricsCursor::rewind(const char *prefix)
+{
+  this->prefix = (prefix != NULL && prefix[0] != '\0') ? prefix : NULL;
+  metric = registryHead;
+  part = 0;
+  lineLen = 0;
+  linePos = 0;
+}
+
+// Lines of one metric: HELP, TYPE, then the value - for a gauge set one line
+// per series, for a histogram the percentile comment, METRIC_HIST_BOUNDS
+// buckets, +Inf, sum and count
+bool MetricsCursor::nextLine()
+{
+  while (metric != NULL) {
+    const Metric *m = metric;
+    int n = -1;
+    if (part == 0 && prefix != NULL && strncmp(m->name, prefix, strlen(prefix)) != 0) {
+      metric = m->next;
+      continue;
+    }
+    if (part == 0) {
+      if (m->type == METRIC_HISTOGRAM)
+        static_cast<const MetricHistogram *>(m)->snapshot(&snap);
+      if (m->type == METRIC_GAUGE)
+        n = snprintf(line, sizeof(line), "# HELP %s %s (max %ld)\n", m->name, m->help,
+                     (long)static_cast<const MetricGauge *>(m)->max());
+      else
+        n = snprintf(line, sizeof(line), "# HELP %s %s\n", m->name, m->help);
+    } else if (part == 1) {
+      static const char *const TYPE_NAMES[] = {"counter", "counter", "gauge", "histogram", "gauge"};
+      n = snprintf(line, sizeof(line), "# TYPE %s %s\n", m->name, TYPE_NAMES[m->type]);
+    } else if (m->type == METRIC_COUNTER && part == 2) {
+      n = snprintf(line, sizeof(line), "%s %lu\n", m->name,
+                   (unsigned long)static_cast<const MetricCounter *>(m)->value());
+    } else if (m->type == METRIC_COUNTER_REF && part == 2) {
+      n = snprintf(line, sizeof(line), "%s %lu\n", m->name,
+                   (unsigned long)static_cast<const MetricCounterRef *>(m)->value());
+    } else if (m->type == METRIC_GAUGE && part == 2) {
+      n = snprintf(line, sizeof(line), "%s %ld\n", m->name, (long)static_cast<const MetricGauge *>(m)->value());
+    } else if (m->type == METRIC_GAUGE_SET) {
+      char labels[48];
+      int32_t value;
+      if (part - 2 < UINT8_MAX - 2 &&
+          static_cast<const MetricGaugeSet *>(m)->reader(part - 2, labels, sizeof(labels), &value))
+        n = snprintf(line, sizeof(line), "%s{%s} %ld\n", m->name, labels, (long)value);
+    } else if (m->type == METRIC_HISTOGRAM && part < 6 + METRIC_HIST_BOUNDS) {
+      const MetricHistogram *h = static_cast<const MetricHistogram *>(m);
+      int bucket = part - 3;
+      if (part == 2) {
+        n = snprintf(line, sizeof(line), "# %s p50<=%lu p90<=%lu p99<=%lu max=%lu\n", m->name,
+                     (unsigned long)h->percentile(snap, 0.50f), (unsigned long)h->percentile(snap, 0.90f),
+                     (unsigned long)h->percentile(snap, 0.99f), (unsigned long)snap.max);
+      } else if (bucket < METRIC_HIST_BOUNDS) {
+        uint32_t cumulative = 0;
+        for (int i = 0; i <= bucket; i++)
+          cumulative += snap.buckets[i];
+        n = snprintf(line, sizeof(line), "%s_bucket{le=\"%lu\"} %lu\n", m->name,
+                     (unsigned long)h->bounds[bucket], (unsigned long)cumulative);
+      } else if (bucket == METRIC_HIST_BOUNDS) {
+        n = snprintf(line, sizeof(line), "%s_bucket{le=\"+Inf\"} %lu\n", m->name, (unsigned long)snap.count);
+      } else if (bucket == METRIC_HIST_BOUNDS + 1) {
+        n = snprintf(line, sizeof(line), "%s_sum %lu\n", m->name, (unsigned long)snap.sum);
+      } else {
+        n = snprintf(line, sizeof(line), "%s_count %lu\n", m->name, (unsigned long)snap.count);
+      }
+    }
+
+    if (n < 0) {
+      metric = m->next;  // Past its last line
+      part = 0;
+      continue;
+    }
+    part++;
+    lineLen = (uint16_t)min((size_t)n, sizeof(line) - 1);
+    line[lineLen - 1] = '\n';  // Cut to the buffer, still one line
+    linePos = 0;
+    return true;
+  }
+  return false;
+}
+
+size_t MetricsCursor::read(uint8_t *buffer, size_t maxLen)
+{
+  size_t out = 0;
+  while (out < maxLen) {
+    if (linePos == lineLen && !nextLine())
+      break;
+    size_t n = min((size_t)(lineLen - linePos), maxLen - out);
+    memcpy(buffer + out, line + linePos, n);
+    linePos += n;
+    out += n;
+  }
+  return out;
+}
+
+void metricsDump(Print &out, const char *prefix)
+{
+  MetricsCursor cursor;
+  cursor.rewind(prefix);
+  uint8_t chunk[128];
+  size_t n;
+  while ((n = cursor.read(chunk, sizeof(chunk))) > 0)
+    out.write(chunk, n);
+}
@@ -0,0 +1,190 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+// =============================================================================
+// Runtime Metrics Registry (counters, gauges, latency histograms)
+// =============================================================================
+// One place for the numbers that used to be scattered static counters, and
+// distributions instead of a single "max" or an over-threshold log line:
+//
+//   static MetricHistogram flushUs("lcd_flush_cb_us", "flush_cb duration", METRIC_BUCKETS_US);
+//   flushUs.record(us);                    // any task, lock-free
+//   metricsDump(Serial);                   // "metrics" serial command, /metrics
+//
+//   - MetricCounter    monotonically increasing count (wraps at 2^32)
+//   - MetricCounterRef exports an existing 32-bit counter (displayDiag,
+//                      touchInputStats, ...) without moving it
+//   - MetricGauge      last value + highest value seen
+//   - MetricHistogram  fixed buckets (METRIC_HIST_BOUNDS upper bounds + overflow),
+//                      count, sum (wraps - use deltas) and max; percentiles
+//                      are estimated from the buckets
+//   - MetricGaugeSet   one gauge per label value, read through a callback
+//                      when written out (per-task CPU and stack headroom)
+//
+// Metrics are file-scope objects: the constructor links them into the registry
+// during static initialisation (single threaded), nothing allocates later.
+// metricsDump() writes the Prometheus text format, so the same output reads
+// fine on a serial terminal and can be scraped from /metrics.
+//
+// MetricsCursor produces that text a line at a time into whatever buffer the
+// caller has - /metrics hands it AsyncTCP's send buffer (chunked response),
+// so a scrape never holds more than one formatted line, however many
+// metrics are registered.
+//
+// Thread Safety:
+//   Every field is a 32-bit word updated with atomic add / CAS, so writers on
+//   any task or core never lock. Snapshots read each word atomically; fields
+//   of one histogram may be a few samples apart, never torn.
+// =============================================================================
+
+#include <Arduino.h>
+
+constexpr int METRIC_HIST_BOUNDS = 11;   // Upper bounds per histogram, + one overflow bucket
+
+// Bucket upper bounds (inclusive). Microseconds for CPU/bus work, milliseconds for BLE timing.
+extern const uint32_t METRIC_BUCKETS_US[METRIC_HIST_BOUNDS];
+extern const uint32_t METRIC_BUCKETS_MS[METRIC_HIST_BOUNDS];
+
+enum MetricType : uint8_t {
+  METRIC_COUNTER,
+  METRIC_COUNTER_REF,
+  METRIC_GAUGE,
+  METRIC_HISTOGRAM,
+  METRIC_GAUGE_SET
+};
+
+class Metric {
+public:
+  const char *name;
+  const char *help;
+  MetricType type;
+  Metric *next;         // Registry list (set once at static init)
+
+protected:
+  Metric(const char *name, const char *help, MetricType type);
+};
+
+class MetricCounter : public Metric {
+public:
+  MetricCounter(const char *name, const char *help) : Metric(name, help, METRIC_COUNTER), count(0) {}
+
+  void add(uint32_t n = 1) { __atomic_fetch_add(&count, n, __ATOMIC_RELAXED); }
+  uint32_t value() const { return __atomic_load_n(&count, __ATOMIC_RELAXED); }
+
+private:
+  uint32_t count;
+};
+
+class MetricCounterRef : public Metric {
+public:
+  MetricCounterRef(const char *name, const char *help, const volatile uint32_t *source)
+    : Metric(name, help, METRIC_COUNTER_REF), source(source) {}
+
+  uint32_t value() const { return *source; }
+
+private:
+  const volatile uint32_t *source;
+};
+
+class MetricGauge : public Metric {
+public:
+  MetricGauge(const char *name, const char *help) : Metric(name, help, METRIC_GAUGE), current(0), peak(INT32_MIN) {}
+
+  void set(int32_t v);
+  int32_t value() const { return __atomic_load_n(&current, __ATOMIC_RELAXED); }
+  int32_t max() const { return __atomic_load_n(&peak, __ATOMIC_RELAXED); }
+
+private:
+  int32_t current;
+  int32_t peak;
+};
+
+struct HistogramSnapshot {
+  uint32_t buckets[METRIC_HIST_BOUNDS + 1];
+  uint32_t count;
+  uint32_t sum;
+  uint32_t max;
+};
+
+class MetricHistogram : public Metric {
+public:
+  MetricHistogram(const char *name, const char *help, const uint32_t *bounds)
+    : Metric(name, help, METRIC_HISTOGRAM), bounds(bounds), buckets(), count(0), sum(0), peak(0) {}
+
+  void record(uint32_t v);
+  void snapshot(HistogramSnapshot *out) const;
+
+  /**
+   * @brief Upper bound of the bucket holding quantile q (0..1) - max for the overflow bucket
+   */
+  uint32_t percentile(const HistogramSnapshot &snap, float q) const;
+
+  const uint32_t *bounds;
+
+private:
+  uint32_t buckets[METRIC_HIST_BOUNDS + 1];
+  uint32_t count;
+  uint32_t sum;
+  uint32_t peak;
+};
+
+/**
+ * @brief Series `index` of a gauge set: its labels (`task="BLE_Task"`) and value
+ * @return false past the last series
+ */
+typedef bool (*MetricSeriesReader)(uint16_t index, char *labels, size_t labelsSize, int32_t *value);
+
+class MetricGaugeSet : public Metric {
+public:
+  MetricGaugeSet(const char *name, const char *help, MetricSeriesReader reader)
+    : Metric(name, help, METRIC_GAUGE_SET), reader(reader) {}
+
+  const MetricSeriesReader reader;
+};
+
+/**
+ * @brief Incremental Prometheus text writer over the whole registry
+ *
+ * Lines can split across read() calls; histogram lines come from one
+ * snapshot, so a metric's buckets, sum and count always agree.
+ */
+class MetricsCursor {
+public:
+  MetricsCursor() { rewind(); }
+
+  /**
+   * @brief Start over; with `prefix`, only metrics whose name starts with it
+   *        (the string must outlive the dump)
+   */
+  void rewind(const char *prefix = NULL);
+
+  /**
+   * @brief Next bytes of the dump, up to `maxLen`
+   * @return Bytes written, 0 once the registry is through
+   */
+  size_t read(uint8_t *buffer, size_t maxLen);
+
+private:
+  bool nextLine();
+
+  const Metric *metric;
+  const char *prefix;         // NULL = every metric
+  uint8_t part;               // Line within the current metric
+  HistogramSnapshot snap;     // Histogram being written
+  char line[224];
+  uint16_t lineLen;
+  uint16_t linePos;
+};
+
+/**
+ * @brief First registered metric (walk with ->next)
+ */
+Metric *metricsFirst();
+
+/**
+ * @brief Write every metric in Prometheus text format (+ p50/p90/p99 comments)
+ * @param prefix Only metrics whose name starts with it ("metrics ble_" on the console)
+ */
+void metricsDump(Print &out, const char *prefix = NULL);
+
+#endif // METRICS_H
@@ -0,0 +1,134 @@
+#include "micro_bench.h"
+#include <ScaleDriver.h>
+#include "sample_clock.h"
+#include "shot_predictor.h"
+
+#ifndef GS_NATIVE
+#include "console.h"
+#include "mem_fast.h"
+#include "pins_config.h"
+#include "touch_pipeline.h"
+#endif
+
+// =============================================================================
+// Kernels
+// =============================================================================
+// Inputs are built on the first call (inside the warm-up) and walked by the
+// iteration index, so no kernel sees the same input twice in a row.
+
+static constexpr uint32_t KERNEL_INPUTS = 64;   // Power of two (index mask)
+
+// -----------------------------------------------------------------------------
+// Platform-free: also built into tools/core_bench
+// -----------------------------------------------------------------------------
+
+// ScaleDriver::parse() of one 0xEF 0xDD weight event, new Lunar / Pyxis
+static int32_t benchParse(uint32_t i)
+{
+  static ScalePacket packets[KERNEL_INPUTS];
+  static const ScaleDriver *driver = NULL;
+  if (driver == NULL) {
+    size_t count;
+    driver = scaleDrivers(&count)[1];
+    for (uint32_t n = 0; n < KERNEL_INPUTS; n++) {
+      uint32_t cg = 1000 + n * 17;
+      const uint8_t frame[13] = {0xef, 0xdd, 0x0c, 0x08, 0x05, (uint8_t)cg, (uint8_t)(cg >> 8), 0x00, 0x00, 0x02,
+                                 0x00, 0x00, 0x00};
+      memcpy(packets[n].data, frame, sizeof(frame));
+      for (uint8_t b = 3; b < 11; b++)
+        packets[n].data[11 + ((b - 3) & 1)] += packets[n].data[b];
+      packets[n].length = sizeof(frame);
+    }
+  }
+  ScaleMessage message;
+  driver->parse(packets[i & (KERNEL_INPUTS - 1)], &message);
+  return message.weightCg;
+}
+
+// SampleClock::update() on 100 ms arrivals up to 30 ms late
+static int32_t benchClock(uint32_t i)
+{
+  static SampleClock clock;
+  int64_t arrival = 1000000 + (int64_t)i * 100000 + (int64_t)((i * 7919u) % 30000u);
+  return (int32_t)clock.update(arrival);
+}
+
+// calculateEndTime(): ShotPredictor::expectedEnd() mid-shot, linear estimator
+static int32_t benchExpectedEnd(uint32_t i)
+{
+  static ShotPredictor predictor;
+  static bool ready = false;
+  if (!ready) {
+    predictor.reset();
+    predictor.select(STOP_ESTIMATOR_LINEAR);
+    float weight = 0.0f;
+    for (uint32_t n = 0; n < 150; n++) {   // 15 s at 10 Hz, ramp to 2 g/s by 8 s
+      float t = n * 0.1f;
+      weight += (t < 4.0f ? 0.0f : t < 8.0f ? 2.0f * (t - 4.0f) / 4.0f : 2.0f) * 0.1f;
+      predictor.add(t, weight);
+    }
+    ready = true;
+  }
+  float goal = 36.0f + (float)(i & (KERNEL_INPUTS - 1)) * 0.01f;
+  return (int32_t)(predictor.expectedEnd(goal, 1.5f, 0.3f) * 1000.0f);
+}
+
+static MicroBenchCase parseCase("parse", "ScaleDriver::parse(), one Acaia weight event", benchParse);
+static MicroBenchCase clockCase("clock", "SampleClock::update(), one arrival", benchClock);
+static MicroBenchCase expectedEndCase("expected_end", "calculateEndTime(): predictor expectedEnd()", benchExpectedEnd);
+
+#ifndef GS_NATIVE
+
+// -----------------------------------------------------------------------------
+// Device only
+// -----------------------------------------------------------------------------
+
+// touchToLandscape(): one panel point through the calibrated affine
+static int32_t benchTouch(uint32_t i)
+{
+  static const TouchAffine transform = TOUCH_PANEL_TO_SCREEN;
+  TouchSample sample;
+  touchToLandscape(transform, (int16_t)(i % EXAMPLE_LCD_H_RES), (int16_t)((i * 13) % EXAMPLE_LCD_V_RES), &sample);
+  return sample.x + sample.y;
+}
+
+// memFastFill16() of one panel row, as the blend backend fills a background run
+static int32_t benchFillRow(uint32_t i)
+{
+  static uint16_t row[EXAMPLE_LCD_V_RES] __attribute__((aligned(16)));
+  memFastFill16(row, (uint16_t)i, EXAMPLE_LCD_V_RES);
+  return row[i % EXAMPLE_LCD_V_RES];
+}
+
+static MicroBenchCase touchCase("touch", "touchToLandscape(), one point", benchTouch);
+static MicroBenchCase fillCase("fill_row", "memFastFill16(), one 640 px row", benchFillRow);
+
+// =============================================================================
+// Console
+// =============================================================================
+
+void microBenchPrint(Print &out, const char *name, uint32_t iterations, bool masked)
+{
+  char line[96];
+  out.printf("[Bench] kernels, %lu calls each, %s, " MICRO_BENCH_UNIT " (timer overhead taken off)\n",
+             (unsigned long)(iterations == 0 ? MICRO_BENCH_DEFAULT_ITERATIONS : min(iterations, MICRO_BENCH_MAX_ITERATIONS)),
+             masked ? "interrupts masked" : "interrupts on");
+  out.printf(MICRO_BENCH_HEADER);
+  bool any = false;
+  for (const MicroBenchCase *c = MicroBenchCase::head(); c != NULL; c = c->next) {
+    if (name != NULL && strcmp(c->name, name) != 0)
+      continue;
+    any = true;
+    MicroBenchResult r = microBenchRun(*c, iterations, masked);
+    microBenchFormat(r, line, sizeof(line));
+    out.print(line);
+  }
+  if (!any) {
+    out.printf("  no kernel '%s'; one of:", name);
+    for (const MicroBenchCase *c = MicroBenchCase::head(); c != NULL; c = c->next)
+      out.printf(" %s", c->name);
+    out.println();
+  }
+}
+
+#endif // GS_NATIVE
@@ -0,0 +1,208 @@
+#ifndef MICRO_BENCH_H
+#define MICRO_BENCH_H
+
+// =============================================================================
+// Micro-Benchmark Harness: cycle counts of single hot-path kernels
+// =============================================================================
+// millis() and even esp_timer cannot resolve a kernel that takes a few
+// hundred cycles. A kernel here is timed one call at a time on the CPU's
+// cycle counter:
+//
+//   warm-up (caches, branch history) ──► N timed calls ──► sort
+//     ──► min / median / p99 / max, less the timer's own overhead
+//
+//   - Counter: esp_cpu_get_ccount() on the device, exact cycles of the
+//     calling core. Host builds (GS_NATIVE) use steady_clock in ns instead;
+//     the unit is printed with every table.
+//   - Overhead: an empty kernel is timed the same way first, and its
+//     minimum is taken off every sample.
+//   - Masked runs: each call runs with interrupts off on this core (one
+//     short critical section per call, so the tick and the watchdog still
+//     run between calls). Compare masked and unmasked to see how much of
+//     the tail is pre-emption rather than the kernel itself.
+//   - The kernel gets the iteration index, to walk its inputs, and returns
+//     a value that goes into a volatile sink, so the optimiser cannot drop
+//     the work.
+//
+// Kernels are file-scope MicroBenchCase objects, linked into one registry at
+// static init (like metrics.h and console.h). "bench kernels" on the console
+// runs them (micro_bench.cpp); core_bench --kernels runs the platform-free
+// ones on a host.
+//
+//   static int32_t benchParse(uint32_t i) { ... return result; }
+//   static MicroBenchCase parseCase("parse", "ScaleDriver::parse(), one weight packet", benchParse);
+//
+// Thread Safety:
+//   Registration at static init. microBenchRun() - one caller at a time (the
+//   console's log drain task), it shares one sample buffer.
+// =============================================================================
+
+#include <Arduino.h>
+#include <algorithm>
+#include <stdio.h>
+
+#ifdef GS_NATIVE
+#include <chrono>
+#else
+#include "esp_cpu.h"
+#endif
+
+constexpr uint32_t MICRO_BENCH_MAX_ITERATIONS = 512;   // Samples kept per run (2 KB buffer)
+constexpr uint32_t MICRO_BENCH_DEFAULT_ITERATIONS = 256;
+constexpr uint32_t MICRO_BENCH_WARMUP = 16;
+
+#ifdef GS_NATIVE
+#define MICRO_BENCH_UNIT "ns"
+#else
+#define MICRO_BENCH_UNIT "cycles"
+#endif
+
+typedef int32_t (*MicroBenchFn)(uint32_t iteration);
+
+class MicroBenchCase {
+public:
+  MicroBenchCase(const char *name, const char *help, MicroBenchFn fn) : name(name), help(help), fn(fn), next(NULL)
+  {
+    MicroBenchCase **tail = &head();
+    while (*tail != NULL)
+      tail = &(*tail)->next;
+    *tail = this;
+  }
+
+  static MicroBenchCase *&head()
+  {
+    static MicroBenchCase *first = NULL;
+    return first;
+  }
+
+  const char *const name;
+  const char *const help;
+  const MicroBenchFn fn;
+  MicroBenchCase *next;   // Registry list (set once at static init)
+};
+
+struct MicroBenchResult {
+  const char *name;
+  uint32_t iterations;
+  bool masked;
+  uint32_t min;           // MICRO_BENCH_UNIT, overhead taken off
+  uint32_t median;
+  uint32_t p99;
+  uint32_t max;
+  uint32_t overhead;      // Timer read-out cost that was taken off
+};
+
+inline uint32_t microBenchNow()
+{
+#ifdef GS_NATIVE
+  return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+#else
+  return esp_cpu_get_ccount();
+#endif
+}
+
+namespace micro_bench_detail {
+
+inline volatile int32_t &sink()
+{
+  static volatile int32_t value = 0;
+  return value;
+}
+
+inline int32_t emptyKernel(uint32_t iteration)
+{
+  return (int32_t)iteration;
+}
+
+// One call, optionally with interrupts off on this core
+inline uint32_t timeOne(MicroBenchFn fn, uint32_t iteration, bool masked)
+{
+#ifndef GS_NATIVE
+  static portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+  if (masked)
+    portENTER_CRITICAL(&mux);
+#else
+  (void)masked;
+#endif
+  uint32_t start = microBenchNow();
+  int32_t r = fn(iteration);
+  uint32_t cycles = microBenchNow() - start;
+#ifndef GS_NATIVE
+  if (masked)
+    portEXIT_CRITICAL(&mux);
+#endif
+  sink() = sink() + r;
+  return cycles;
+}
+
+// Sorted samples of `iterations` timed calls after the warm-up
+inline uint32_t *timeSorted(MicroBenchFn fn, uint32_t iterations, bool masked)
+{
+  static uint32_t samples[MICRO_BENCH_MAX_ITERATIONS];
+  for (uint32_t i = 0; i < MICRO_BENCH_WARMUP; i++)
+    timeOne(fn, i, masked);
+  for (uint32_t i = 0; i < iterations; i++)
+    samples[i] = timeOne(fn, i, masked);
+  std::sort(samples, samples + iterations);
+  return samples;
+}
+
+}  // namespace micro_bench_detail
+
+/**
+ * @brief Time `bench`: warm-up, then `iterations` calls (capped at MICRO_BENCH_MAX_ITERATIONS)
+ */
+inline MicroBenchResult microBenchRun(const MicroBenchCase &bench, uint32_t iterations, bool masked)
+{
+  using namespace micro_bench_detail;
+  if (iterations == 0)
+    iterations = MICRO_BENCH_DEFAULT_ITERATIONS;
+  if (iterations > MICRO_BENCH_MAX_ITERATIONS)
+    iterations = MICRO_BENCH_MAX_ITERATIONS;
+
+  uint32_t overhead = timeSorted(emptyKernel, iterations, masked)[0];
+  const uint32_t *s = timeSorted(bench.fn, iterations, masked);
+  auto net = [overhead](uint32_t v) { return v > overhead ? v - overhead : 0u; };
+
+  MicroBenchResult r;
+  r.name = bench.name;
+  r.iterations = iterations;
+  r.masked = masked;
+  r.min = net(s[0]);
+  r.median = net(s[iterations / 2]);
+  r.p99 = net(s[(iterations * 99) / 100]);
+  r.max = net(s[iterations - 1]);
+  r.overhead = overhead;
+  return r;
+}
+
+/**
+ * @brief First registered case named `name`, NULL if none
+ */
+inline const MicroBenchCase *microBenchFind(const char *name)
+{
+  for (const MicroBenchCase *c = MicroBenchCase::head(); c != NULL; c = c->next)
+    if (strcmp(c->name, name) == 0)
+      return c;
+  return NULL;
+}
+
+/**
+ * @brief One table row; pairs with MICRO_BENCH_HEADER
+ */
+#define MICRO_BENCH_HEADER "  %-22s %5s %8s %8s %8s %8s\n", "kernel", "n", "min", "median", "p99", "max"
+inline int microBenchFormat(const MicroBenchResult &r, char *buf, size_t len)
+{
+  return snprintf(buf, len, "  %-22s %5lu %8lu %8lu %8lu %8lu\n", r.name, (unsigned long)r.iterations,
+                  (unsigned long)r.min, (unsigned long)r.median, (unsigned long)r.p99, (unsigned long)r.max);
+}
+
+#ifndef GS_NATIVE
+/**
+ * @brief Run `name` (NULL = every kernel) and print the table ("bench kernels")
+ */
+void microBenchPrint(Print &out, const char *name, uint32_t iterations, bool masked);
+#endif
+
+#endif // MICRO_BENCH_H
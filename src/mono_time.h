@@ -0,0 +1,65 @@
+#ifndef MONO_TIME_H
+#define MONO_TIME_H
+
+// =============================================================================
+// Monotonic Time Base: esp_timer microseconds, shot-relative offsets
+// =============================================================================
+// Time points are esp_timer_get_time(): microseconds since boot, 64 bits, so
+// they never wrap and never lose resolution with uptime. Seconds as a float
+// are only ever taken of a *difference* between two time points:
+//
+//   MonoUs        absolute time point (esp_timer, int64)
+//   ShotOffsetUs  time since a shot's start (int32, +/-35 min - far beyond
+//                 MAX_SHOT_DURATION_S), saturating instead of wrapping
+//
+// millis()/1000.0f as a time point keeps 24 bits of mantissa: after a day of
+// uptime that is ~8 ms steps, which the shot start, the stop decision and the
+// relay's scheduled cut all inherited. Differences taken in int64 first are
+// exact at any uptime, and the seconds that come out are small numbers that a
+// float holds to well under a microsecond over a shot.
+//
+// This is for shot timing. Interval bookkeeping on millis() (UI refresh,
+// throttles, timeouts) is unsigned modular arithmetic, correct across the
+// 49-day wrap, and stays as it is.
+//
+// Thread Safety:
+//   All functions are pure or read esp_timer - safe from any task or ISR.
+// =============================================================================
+
+#include <Arduino.h>
+#include <esp_timer.h>
+
+typedef int64_t MonoUs;
+typedef int32_t ShotOffsetUs;
+
+constexpr int64_t MONO_US_PER_S = 1000000;
+
+inline MonoUs monoNowUs() { return esp_timer_get_time(); }
+
+/**
+ * @brief Seconds from `since` to `at` - exact difference, then one conversion
+ */
+inline float monoElapsedS(MonoUs since, MonoUs at) { return (float)(at - since) / (float)MONO_US_PER_S; }
+inline float monoElapsedS(MonoUs since) { return monoElapsedS(since, monoNowUs()); }
+
+/**
+ * @brief Time point `seconds` after `base` (for schedules set in shot seconds)
+ */
+inline MonoUs monoAfterS(MonoUs base, float seconds) { return base + (int64_t)(seconds * (float)MONO_US_PER_S); }
+
+/**
+ * @brief Offset of `at` from `base`, clamped to the int32 range
+ */
+inline ShotOffsetUs monoOffsetUs(MonoUs base, MonoUs at)
+{
+  int64_t d = at - base;
+  if (d > INT32_MAX)
+    return INT32_MAX;
+  if (d < INT32_MIN)
+    return INT32_MIN;
+  return (ShotOffsetUs)d;
+}
+
+inline float shotOffsetS(ShotOffsetUs offset) { return (float)offset / (float)MONO_US_PER_S; }
+
+#endif // MONO_TIME_H
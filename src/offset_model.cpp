@@ -0,0 +1,242 @@
+// =============================================================================
+// Per-Profile Offset Learning Implementation
+// =============================================================================
+
+#include "offset_model.h"
+#include "debug_config.h"
+#include "settings_journal.h"
+#include <Preferences.h>
+
+static constexpr LogTag TAG = LOG_TAG_SHOT;
+
+static const char* OFFSET_MODEL_NAMESPACE = "offsets";
+static const char* OFFSET_MODEL_KEY       = "profiles";
+static const uint8_t OFFSET_MODEL_VERSION = 1;   // Bump when OffsetProfile changes
+static const float OFFSET_MAX_G           = 12.7f;  // int8 tenths
+
+struct OffsetProfile {
+  uint8_t goal;        // g, 0 = free slot
+  uint8_t count;       // Valid entries in tenths[]
+  uint8_t next;        // Ring position of the next entry
+  uint8_t lastUsed;    // LRU stamp (wraps, compared as uint8 distance)
+  int8_t tenths[OFFSET_HISTORY_LEN];
+};
+
+struct OffsetModelRecord {
+  uint8_t version;
+  uint8_t clock;       // Last LRU stamp handed out
+  OffsetProfile profiles[OFFSET_PROFILE_SLOTS];
+};
+
+static OffsetModelRecord model = {};
+
+static void save()
+{
+  if (journalWrite(JOURNAL_OFFSETS, &model, sizeof(model)))
+    return;   // After every shot: a journal append, NVS only without the partition
+  Preferences prefs;
+  if (!prefs.begin(OFFSET_MODEL_NAMESPACE, false))
+    return;
+  prefs.putBytes(OFFSET_MODEL_KEY, &model, sizeof(model));
+  prefs.end();
+}
+
+// Median of n values (n <= OFFSET_HISTORY_LEN), insertion sort on a copy
+static float median(const float *values, uint8_t n)
+{
+  if (n == 0)
+    return 0.0f;
+
+  float sorted[OFFSET_HISTORY_LEN];
+  for (uint8_t i = 0; i < n; i++)
+  {
+    float v = values[i];
+    int j = i - 1;
+    while (j >= 0 && sorted[j] > v)
+    {
+      sorted[j + 1] = sorted[j];
+      j--;
+    }
+    sorted[j + 1] = v;
+  }
+  return (n % 2) ? sorted[n / 2] : 0.5f * (sorted[n / 2 - 1] + sorted[n / 2]);
+}
+
+// Median and robust spread (1.4826 * MAD) of a profile's history
+static void stats(const OffsetProfile &p, float *center, float *spread)
+{
+  float values[OFFSET_HISTORY_LEN];
+  for (uint8_t i = 0; i < p.count; i++)
+    values[i] = p.tenths[i] / 10.0f;
+
+  *center = median(values, p.count);
+
+  for (uint8_t i = 0; i < p.count; i++)
+    values[i] = fabsf(values[i] - *center);
+  *spread = (p.count >= 2) ? 1.4826f * median(values, p.count) : 0.0f;
+}
+
+static OffsetProfile *find(uint8_t goal)
+{
+  for (uint8_t i = 0; i < OFFSET_PROFILE_SLOTS; i++)
+  {
+    if (model.profiles[i].goal == goal)
+      return &model.profiles[i];
+  }
+  return NULL;
+}
+
+// Profile with the closest goal that has any history
+static OffsetProfile *nearest(uint8_t goal)
+{
+  OffsetProfile *best = NULL;
+  int bestDistance = 256;
+  for (uint8_t i = 0; i < OFFSET_PROFILE_SLOTS; i++)
+  {
+    OffsetProfile &p = model.profiles[i];
+    int distance = abs((int)p.goal - (int)goal);
+    if (p.goal != 0 && p.count > 0 && distance < bestDistance)
+    {
+      best = &p;
+      bestDistance = distance;
+    }
+  }
+  return best;
+}
+
+// Existing profile for goal, or a free / least recently used slot reset for it
+static OffsetProfile *claim(uint8_t goal)
+{
+  OffsetProfile *p = find(goal);
+  if (p == NULL)
+  {
+    p = &model.profiles[0];
+    for (uint8_t i = 0; i < OFFSET_PROFILE_SLOTS; i++)
+    {
+      OffsetProfile &candidate = model.profiles[i];
+      if (candidate.goal == 0)
+      {
+        p = &candidate;
+        break;
+      }
+      if ((uint8_t)(model.clock - candidate.lastUsed) > (uint8_t)(model.clock - p->lastUsed))
+        p = &candidate;
+    }
+    memset(p, 0, sizeof(*p));
+    p->goal = goal;
+  }
+  p->lastUsed = ++model.clock;
+  return p;
+}
+
+static void push(OffsetProfile *p, float offset)
+{
+  offset = constrain(offset, -OFFSET_MAX_G, OFFSET_MAX_G);
+  p->tenths[p->next] = (int8_t)lroundf(offset * 10.0f);
+  p->next = (p->next + 1) % OFFSET_HISTORY_LEN;
+  if (p->count < OFFSET_HISTORY_LEN)
+    p->count++;
+}
+
+void offsetModelBegin(uint8_t goal, float legacyOffset)
+{
+  Preferences prefs;
+  bool loaded = journalRead(JOURNAL_OFFSETS, &model, sizeof(model)) == sizeof(model) &&
+                model.version == OFFSET_MODEL_VERSION;
+  if (!loaded && prefs.begin(OFFSET_MODEL_NAMESPACE, true))
+  {
+    loaded = prefs.getBytes(OFFSET_MODEL_KEY, &model, sizeof(model)) == sizeof(model) &&
+             model.version == OFFSET_MODEL_VERSION;
+    prefs.end();
+    if (loaded && journalReady())
+      journalWrite(JOURNAL_OFFSETS, &model, sizeof(model));   // First boot with the journal
+  }
+
+  if (!loaded)
+  {
+    // First boot with profiles: the single legacy offset becomes this goal's first shot
+    memset(&model, 0, sizeof(model));
+    model.version = OFFSET_MODEL_VERSION;
+    push(claim(goal), legacyOffset);
+    save();
+    LOG_INFO(TAG, "🎯 Offset profiles created, %ug seeded with %.1fg", goal, legacyOffset);
+  }
+}
+
+float offsetModelGet(uint8_t goal, OffsetConfidence *confidence)
+{
+  float center = OFFSET_DEFAULT_G;
+  float spread = 0.0f;
+  uint8_t shots = 0;
+
+  const OffsetProfile *p = find(goal);
+  if (p != NULL && p->count > 0)
+  {
+    stats(*p, &center, &spread);
+    shots = p->count;
+  }
+  else if ((p = nearest(goal)) != NULL)
+  {
+    stats(*p, &center, &spread);  // Borrowed - confidence stays at 0 shots
+    spread = 0.0f;
+  }
+
+  if (confidence != NULL)
+  {
+    confidence->spreadG = spread;
+    confidence->shots = shots;
+  }
+  return center;
+}
+
+bool offsetModelRecord(uint8_t goal, float usedOffset, float finalWeight)
+{
+  float ideal = usedOffset + (finalWeight - goal);
+  OffsetProfile *p = claim(goal);
+
+  bool accepted;
+  if (p->count >= 3)
+  {
+    float center, spread;
+    stats(*p, &center, &spread);
+    float limit = max(3.0f * spread, OFFSET_OUTLIER_FLOOR_G);
+    accepted = fabsf(ideal - center) <= limit;
+    if (!accepted)
+      LOG_INFO(TAG, "🎯 %ug: ideal offset %.1fg is %.1fg from the median %.1fg - outlier", goal, ideal, fabsf(ideal - center), center);
+  }
+  else
+  {
+    accepted = fabsf(ideal) <= OFFSET_COLD_MAX_G;  // Until the history means something
+    if (!accepted)
+      LOG_INFO(TAG, "🎯 %ug: ideal offset %.1fg is implausible - error assumed", goal, ideal);
+  }
+
+  if (accepted)
+    push(p, ideal);
+  save();  // LRU stamp changed either way
+  return accepted;
+}
+
+void offsetModelShift(float grams)
+{
+  for (uint8_t i = 0; i < OFFSET_PROFILE_SLOTS; i++)
+  {
+    OffsetProfile &p = model.profiles[i];
+    for (uint8_t j = 0; j < p.count; j++)
+    {
+      float shifted = constrain(p.tenths[j] / 10.0f + grams, -OFFSET_MAX_G, OFFSET_MAX_G);
+      p.tenths[j] = (int8_t)lroundf(shifted * 10.0f);
+    }
+  }
+  save();
+}
+
+void offsetModelSet(uint8_t goal, float grams)
+{
+  OffsetProfile *p = claim(goal);
+  p->count = 0;
+  p->next = 0;
+  push(p, grams);  // Learning carries on from the value given
+  save();
+  LOG_INFO(TAG, "🎯 %ug: offset set to %.1fg", goal, grams);
+}
@@ -0,0 +1,70 @@
+#ifndef OFFSET_MODEL_H
+#define OFFSET_MODEL_H
+
+// =============================================================================
+// Per-Profile Offset Learning for Gravimetric Shots
+// =============================================================================
+// weightOffset used to be one float nudged by every shot, so alternating 36 g
+// and 18 g shots kept poisoning it. The offset is now learned per profile
+// (one per goal weight, OFFSET_PROFILE_SLOTS kept, least recently used
+// evicted):
+//
+//   - Each profile stores the last OFFSET_HISTORY_LEN "ideal" offsets - the
+//     offset that would have hit the goal exactly (int8, 0.1 g units).
+//   - The offset used is the median of that history, so one bad shot (cup
+//     bumped, early manual stop) can't drag it.
+//   - A new shot is rejected as an outlier when it is further than
+//     max(3 * 1.4826 * MAD, OFFSET_OUTLIER_FLOOR_G) from the median. Until
+//     three shots exist the old |offset| <= MAX_OFFSET rule applies.
+//   - Confidence = robust spread (1.4826 * MAD) and shot count, for the UI.
+//   - A goal without a profile starts from the nearest profile's offset.
+//
+// All profiles live in one ~80 byte record: the settings journal
+// (settings_journal.h), or an NVS blob (namespace "offsets") without it.
+//
+// Thread Safety:
+//   Shot control task (Core 0) only, except offsetModelBegin() (setup, before the task).
+// =============================================================================
+
+#include <Arduino.h>
+
+constexpr uint8_t OFFSET_HISTORY_LEN     = 8;
+constexpr uint8_t OFFSET_PROFILE_SLOTS   = 6;
+constexpr float   OFFSET_OUTLIER_FLOOR_G = 1.0f;  // Never reject closer than this to the median
+constexpr float   OFFSET_DEFAULT_G       = 1.5f;  // No profile at all yet
+constexpr float   OFFSET_COLD_MAX_G      = 5.0f;  // |ideal offset| accepted before 3 shots (MAX_OFFSET)
+
+struct OffsetConfidence {
+  float spreadG;      // 1.4826 * MAD of the history (0 with < 2 shots)
+  uint8_t shots;      // Shots in the history (0 = borrowed/default offset)
+};
+
+/**
+ * @brief Load all profiles; seed `goal` with the legacy single offset on first run
+ */
+void offsetModelBegin(uint8_t goal, float legacyOffset);
+
+/**
+ * @brief Offset to use for `goal` (median of its history)
+ * @param confidence Optional, filled with the profile's spread and shot count
+ */
+float offsetModelGet(uint8_t goal, OffsetConfidence *confidence);
+
+/**
+ * @brief Learn from a finished shot and persist
+ * @param usedOffset Offset the shot was stopped with
+ * @return false if the shot was rejected as an outlier
+ */
+bool offsetModelRecord(uint8_t goal, float usedOffset, float finalWeight);
+
+/**
+ * @brief Move every profile by `grams` (the stop model took over that much drip)
+ */
+void offsetModelShift(float grams);
+
+/**
+ * @brief Replace `goal`'s history with one shot at `grams` (entered by hand) and persist
+ */
+void offsetModelSet(uint8_t goal, float grams);
+
+#endif // OFFSET_MODEL_H
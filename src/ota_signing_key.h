@@ -0,0 +1,23 @@
+#ifndef OTA_SIGNING_KEY_H
+#define OTA_SIGNING_KEY_H
+
+// =============================================================================
+// Firmware Update Signing Key (public half, GS_OTA_SIGNED)
+// =============================================================================
+// The ECDSA P-256 key ota_update.cpp checks OTA_FLAG_SIGNED images against,
+// as an uncompressed point (0x04 || X || Y). The private half never enters
+// the tree; release builds replace this array with the output of
+//
+//   tools/ota/make_ota.py --public-key release_key.pem
+//
+// The all-zero placeholder is not a point on the curve, so a build that
+// still carries it refuses every update rather than trusting any key.
+// =============================================================================
+
+#include <stdint.h>
+
+constexpr uint8_t OTA_SIGNING_KEY[65] = {
+  0x00,
+};
+
+#endif // OTA_SIGNING_KEY_H
@@ -0,0 +1,697 @@
+// =============================================================================
+// Firmware Updates Implementation
+// =============================================================================
+
+#include "ota_update.h"
+#include "ota_signing_key.h"
+#include "debug_config.h"
+#include "crash_ring.h"
+#include "mem_caps.h"
+#include "metrics.h"
+#include "settings_store.h"
+#include "shot_log.h"
+#include "wifi_coex.h"
+#include <ESPAsyncWebServer.h>
+#include <Preferences.h>
+#include "esp_ota_ops.h"
+#include "esp_partition.h"
+#include "rom/miniz.h"
+#include "esp_timer.h"
+#include "mbedtls/sha256.h"
+#include "mbedtls/ecdsa.h"
+
+static constexpr LogTag TAG = LOG_TAG_SYSTEM;
+
+static const char* OTA_NAMESPACE      = "ota";
+static const char* OTA_TRIAL_KEY      = "trial";
+static const uint8_t OTA_TRIAL_VERSION = 1;   // Bump when OtaTrialRecord changes
+static const uint8_t ESP_IMAGE_MAGIC  = 0xE9;  // First byte of a plain app image
+
+struct OtaTrialRecord {
+  uint8_t version;
+  uint8_t boots;            // Starts of the new image so far
+  uint32_t slotAddress;     // Slot the update was written to
+};
+
+// Arduino-ESP32 marks the running app valid in initArduino() unless this
+// returns true - otaBootSupervise() decides instead
+extern "C" bool verifyRollbackLater()
+{
+  return true;
+}
+
+static const esp_partition_t *running = NULL;
+static bool onTrial = false;             // This image still has to prove itself
+static bool bootloaderPending = false;   // ESP_OTA_IMG_PENDING_VERIFY (bootloader rollback enabled)
+static uint8_t trialBoots = 0;
+static bool rolledBack = false;          // The previous run fell back from an update
+
+enum OtaStage : uint8_t {
+  STAGE_IDLE = 0,
+  STAGE_HEADER,     // Collecting OtaImageHeader
+  STAGE_PAYLOAD,
+  STAGE_DONE,       // Verified, boot slot switched
+  STAGE_FAILED,
+};
+
+static const char *const STAGE_NAMES[] = {"none", "header", "payload", "done", "failed"};
+
+// One upload at a time: the transport that claimed it in otaUploadBegin() (async_tcp or OtaWriter task)
+struct Upload {
+  OtaStage stage;
+  int status;                  // HTTP status for the response
+  const char *error;
+  const char *source;          // "http" / "ble"
+  uint32_t total;              // Bytes announced by the transport
+  uint32_t lastWriteMs;        // Stale after OTA_STALE_MS (transport went away)
+  OtaImageHeader header;
+  uint8_t headerBytes;
+  esp_ota_handle_t handle;
+  const esp_partition_t *target;
+  uint32_t received;           // Body bytes
+  uint32_t written;            // Image bytes
+  uint32_t payloadEnd;         // Body offset where the signature starts (total if unsigned)
+  bool hashing;                // digest holds the engine until finished / freed
+  mbedtls_sha256_context digest;   // Header + image bytes, for the signature
+  uint8_t signature[OTA_SIGNATURE_BYTES];
+  uint32_t startMs;
+  uint32_t durationMs;
+  tinfl_decompressor *inflater;
+  uint8_t *window;             // TINFL_LZ_DICT_SIZE, wraps
+  size_t windowPos;
+  bool inflateDone;
+  uint8_t op;                  // Delta: 'C' / 'I', 0 between operations
+  uint8_t argBytes;
+  uint8_t args[8];
+  uint32_t insertLeft;
+};
+
+static Upload upload = {};
+static portMUX_TYPE uploadLock = portMUX_INITIALIZER_UNLOCKED;  // Claiming the upload
+static bool httpUpload = false;  // async_tcp task: the current request owns the upload
+static uint8_t copyBuffer[OTA_COPY_CHUNK];
+static esp_timer_handle_t restartTimer = NULL;
+
+static MetricCounter updatesTotal("ota_updates_total", "Firmware images written and verified");
+static MetricCounter failuresTotal("ota_failures_total", "Firmware uploads refused or abandoned");
+static MetricCounter rollbacksTotal("ota_rollbacks_total", "Images rejected on trial (watchdog miss, too many boots)");
+
+static bool loadTrial(OtaTrialRecord *trial)
+{
+  Preferences prefs;
+  bool found = false;
+  if (prefs.begin(OTA_NAMESPACE, true))
+  {
+    found = prefs.getBytes(OTA_TRIAL_KEY, trial, sizeof(*trial)) == sizeof(*trial) &&
+            trial->version == OTA_TRIAL_VERSION;
+    prefs.end();
+  }
+  return found;
+}
+
+static void storeTrial(const OtaTrialRecord &trial)
+{
+  Preferences prefs;
+  if (prefs.begin(OTA_NAMESPACE, false))
+  {
+    prefs.putBytes(OTA_TRIAL_KEY, &trial, sizeof(trial));
+    prefs.end();
+  }
+}
+
+static void clearTrial()
+{
+  Preferences prefs;
+  if (prefs.begin(OTA_NAMESPACE, false))
+  {
+    prefs.remove(OTA_TRIAL_KEY);
+    prefs.end();
+  }
+}
+
+// =============================================================================
+// Trial boots and rollback
+// =============================================================================
+
+// The trial record stays: the next boot sees it point at the other slot and reports the rollback
+static void rollBack(const char *why)
+{
+  rollbacksTotal.add();
+  LOG_ERROR(TAG, "❌ OTA: %s - back to the previous image", why);
+  if (bootloaderPending)
+    esp_ota_mark_app_invalid_rollback_and_reboot();  // Only returns on error
+
+  const esp_partition_t *previous = esp_ota_get_next_update_partition(NULL);
+  esp_app_desc_t desc;
+  if (previous == NULL || esp_ota_get_partition_description(previous, &desc) != ESP_OK ||
+      esp_ota_set_boot_partition(previous) != ESP_OK) {
+    LOG_ERROR(TAG, "❌ OTA: no valid previous image - keeping this one");
+    onTrial = false;
+    clearTrial();
+    return;
+  }
+  logRingFlush(200);
+  crashRingRecord(CRASH_EV_RESTART);
+  esp_restart();
+}
+
+void otaBegin()
+{
+  running = esp_ota_get_running_partition();
+  if (running == NULL)
+    return;
+  esp_ota_img_states_t state;
+  bootloaderPending = esp_ota_get_state_partition(running, &state) == ESP_OK && state == ESP_OTA_IMG_PENDING_VERIFY;
+
+  OtaTrialRecord trial;
+  if (!loadTrial(&trial)) {
+    onTrial = bootloaderPending;  // Flashed by some other OTA client - still validate it
+    return;
+  }
+  if (trial.slotAddress != running->address) {
+    rolledBack = true;
+    LOG_WARN(TAG, "⚠️  OTA: the update in the slot at 0x%lx did not stay - running %s again",
+             (unsigned long)trial.slotAddress, running->label);
+    clearTrial();
+    return;
+  }
+
+  onTrial = true;
+  trialBoots = ++trial.boots;
+  storeTrial(trial);
+  LOG_INFO(TAG, "🆕 OTA: %s on trial (boot %u of %u) - kept after %lus healthy", running->label,
+           (unsigned)trialBoots, (unsigned)OTA_TRIAL_BOOTS, (unsigned long)(OTA_VALIDATE_MS / 1000));
+  if (trialBoots > OTA_TRIAL_BOOTS)
+    rollBack("new image never validated");
+}
+
+void otaBootSupervise(uint32_t nowMs, bool allCheckedIn, bool fatalMiss)
+{
+  if (!onTrial)
+    return;
+  if (fatalMiss) {
+    rollBack("watchdog miss while on trial");
+    return;
+  }
+  if (!allCheckedIn || nowMs < OTA_VALIDATE_MS || shotLogBusy())
+    return;  // No flash writes during a shot - validate after it
+
+  esp_ota_mark_app_valid_cancel_rollback();
+  clearTrial();
+  onTrial = false;
+  bootloaderPending = false;
+  LOG_INFO(TAG, "✅ OTA: %s validated after %lus", running ? running->label : "app", (unsigned long)(nowMs / 1000));
+}
+
+// =============================================================================
+// Upload: header → inflate → delta / image → esp_ota_write
+// =============================================================================
+
+static void releaseInflater()
+{
+  memCapsFree(upload.inflater, sizeof(tinfl_decompressor), MEM_OWNER_OTA);
+  memCapsFree(upload.window, TINFL_LZ_DICT_SIZE, MEM_OWNER_OTA);
+  upload.inflater = NULL;
+  upload.window = NULL;
+}
+
+static void releaseDigest()
+{
+  if (upload.hashing)
+    mbedtls_sha256_free(&upload.digest);
+  upload.hashing = false;
+}
+
+static void fail(int status, const char *why)
+{
+  if (upload.stage == STAGE_PAYLOAD)
+    esp_ota_abort(upload.handle);
+  releaseInflater();
+  releaseDigest();
+  upload.stage = STAGE_FAILED;
+  upload.status = status;
+  upload.error = why;
+  upload.durationMs = millis() - upload.startMs;
+  failuresTotal.add();
+  LOG_WARN(TAG, "⚠️  OTA: upload failed after %lu bytes - %s", (unsigned long)upload.received, why);
+}
+
+static bool failed()
+{
+  return upload.stage != STAGE_PAYLOAD;
+}
+
+static void writeImage(const uint8_t *data, size_t len)
+{
+  if (upload.written + len > upload.header.targetSize) {
+    fail(400, "image larger than announced");
+    return;
+  }
+  if (esp_ota_write(upload.handle, data, len) != ESP_OK) {
+    fail(500, "flash write failed");
+    return;
+  }
+  if (upload.hashing)
+    mbedtls_sha256_update_ret(&upload.digest, data, len);
+  upload.written += len;
+}
+
+static void copyFromBase(uint32_t offset, uint32_t len)
+{
+  if (offset > upload.header.baseSize || len > upload.header.baseSize - offset) {
+    fail(400, "delta copies past the base image");
+    return;
+  }
+  while (len > 0 && !failed()) {
+    size_t n = min((size_t)len, OTA_COPY_CHUNK);
+    if (esp_partition_read(running, offset, copyBuffer, n) != ESP_OK) {
+      fail(500, "base image read failed");
+      return;
+    }
+    writeImage(copyBuffer, n);
+    offset += n;
+    len -= n;
+  }
+}
+
+static uint32_t argU32(const uint8_t *p)
+{
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void feedDelta(const uint8_t *data, size_t len)
+{
+  while (len > 0 && !failed()) {
+    if (upload.op == 0) {
+      upload.op = *data++;
+      len--;
+      upload.argBytes = 0;
+      if (upload.op != 'C' && upload.op != 'I')
+        fail(400, "bad delta operation");
+      continue;
+    }
+
+    uint8_t need = upload.op == 'C' ? 8 : 4;
+    if (upload.argBytes < need) {
+      size_t n = min(len, (size_t)(need - upload.argBytes));
+      memcpy(upload.args + upload.argBytes, data, n);
+      upload.argBytes += n;
+      data += n;
+      len -= n;
+      if (upload.argBytes < need)
+        return;
+      if (upload.op == 'C') {
+        copyFromBase(argU32(upload.args), argU32(upload.args + 4));
+        upload.op = 0;
+      } else {
+        upload.insertLeft = argU32(upload.args);
+        if (upload.insertLeft == 0)
+          upload.op = 0;
+      }
+      continue;
+    }
+
+    size_t n = min(len, (size_t)upload.insertLeft);
+    writeImage(data, n);
+    data += n;
+    len -= n;
+    upload.insertLeft -= n;
+    if (upload.insertLeft == 0)
+      upload.op = 0;
+  }
+}
+
+static void emit(const uint8_t *data, size_t len)
+{
+  if (upload.header.kind == OTA_KIND_DELTA)
+    feedDelta(data, len);
+  else
+    writeImage(data, len);
+}
+
+static void feedPayload(const uint8_t *data, size_t len)
+{
+  if (!(upload.header.flags & OTA_FLAG_DEFLATE)) {
+    emit(data, len);
+    return;
+  }
+  while (len > 0 && !failed() && !upload.inflateDone) {
+    size_t in = len;
+    size_t out = TINFL_LZ_DICT_SIZE - upload.windowPos;
+    tinfl_status status = tinfl_decompress(upload.inflater, data, &in, upload.window,
+                                           upload.window + upload.windowPos, &out,
+                                           TINFL_FLAG_PARSE_ZLIB_HEADER | TINFL_FLAG_HAS_MORE_INPUT);
+    data += in;
+    len -= in;
+    if (out > 0)
+      emit(upload.window + upload.windowPos, out);
+    upload.windowPos = (upload.windowPos + out) & (TINFL_LZ_DICT_SIZE - 1);
+    if (status < TINFL_STATUS_DONE)
+      fail(400, "corrupt deflate stream");
+    else if (status == TINFL_STATUS_DONE)
+      upload.inflateDone = true;
+  }
+}
+
+// Payload bytes to the pipeline, the trailing signature aside; `at` is the body offset of data[0]
+static void feedBody(const uint8_t *data, size_t len, uint32_t at)
+{
+  if (at < upload.payloadEnd) {
+    size_t n = min(len, (size_t)(upload.payloadEnd - at));
+    feedPayload(data, n);
+    data += n;
+    len -= n;
+    at += n;
+  }
+  if (len == 0 || failed())
+    return;
+  if (!(upload.header.flags & OTA_FLAG_SIGNED) || at + len > upload.total) {
+    fail(400, "body longer than announced");
+    return;
+  }
+  memcpy(upload.signature + (at - upload.payloadEnd), data, len);
+}
+
+// SHA-256 of header + image against OTA_SIGNING_KEY; frees the digest
+static bool signatureValid()
+{
+  uint8_t hash[32];
+  bool ok = upload.hashing && mbedtls_sha256_finish_ret(&upload.digest, hash) == 0;
+  releaseDigest();
+
+  mbedtls_ecp_group group;
+  mbedtls_ecp_point key;
+  mbedtls_mpi r, s;
+  mbedtls_ecp_group_init(&group);
+  mbedtls_ecp_point_init(&key);
+  mbedtls_mpi_init(&r);
+  mbedtls_mpi_init(&s);
+  ok = ok && mbedtls_ecp_group_load(&group, MBEDTLS_ECP_DP_SECP256R1) == 0 &&
+       mbedtls_ecp_point_read_binary(&group, &key, OTA_SIGNING_KEY, sizeof(OTA_SIGNING_KEY)) == 0 &&
+       mbedtls_mpi_read_binary(&r, upload.signature, OTA_SIGNATURE_BYTES / 2) == 0 &&
+       mbedtls_mpi_read_binary(&s, upload.signature + OTA_SIGNATURE_BYTES / 2, OTA_SIGNATURE_BYTES / 2) == 0 &&
+       mbedtls_ecdsa_verify(&group, hash, sizeof(hash), &key, &r, &s) == 0;
+  mbedtls_mpi_free(&s);
+  mbedtls_mpi_free(&r);
+  mbedtls_ecp_point_free(&key);
+  mbedtls_ecp_group_free(&group);
+  return ok;
+}
+
+static bool startImage()
+{
+  const OtaImageHeader &h = upload.header;
+#if GS_OTA_SIGNED
+  if (!(h.flags & OTA_FLAG_SIGNED)) {
+    fail(403, "unsigned image - build it with make_ota.py --sign");
+    return false;
+  }
+#endif
+  if (h.flags & OTA_FLAG_SIGNED) {
+    if (OTA_SIGNING_KEY[0] != 0x04) {
+      fail(403, "no release key built in (ota_signing_key.h)");
+      return false;
+    }
+    if (upload.total < sizeof(OtaImageHeader) + OTA_SIGNATURE_BYTES) {
+      fail(400, "signed image shorter than its signature");
+      return false;
+    }
+    upload.payloadEnd = upload.total - OTA_SIGNATURE_BYTES;
+    mbedtls_sha256_init(&upload.digest);
+    upload.hashing = true;
+    mbedtls_sha256_starts_ret(&upload.digest, 0);
+    mbedtls_sha256_update_ret(&upload.digest, (const uint8_t *)&h, sizeof(h));
+  }
+  upload.target = esp_ota_get_next_update_partition(NULL);
+  if (upload.target == NULL || upload.target == running) {
+    fail(500, "no second app slot - partitions.csv needs app0 + app1");
+    return false;
+  }
+  if (h.targetSize == 0 || h.targetSize > upload.target->size) {
+    fail(400, "image does not fit the app slot");
+    return false;
+  }
+  if (h.kind == OTA_KIND_DELTA) {
+    const esp_app_desc_t *app = esp_ota_get_app_description();
+    if (memcmp(h.baseElfSha, app->app_elf_sha256, sizeof(h.baseElfSha)) != 0) {
+      fail(409, "delta was made against a different image than the one running");
+      return false;
+    }
+    if (h.baseSize > running->size) {
+      fail(400, "delta base larger than the app slot");
+      return false;
+    }
+  }
+  if (h.flags & OTA_FLAG_DEFLATE) {
+    upload.inflater = (tinfl_decompressor *)memCapsAlloc(sizeof(tinfl_decompressor), MEM_PSRAM, MEM_OWNER_OTA);
+    upload.window = (uint8_t *)memCapsAlloc(TINFL_LZ_DICT_SIZE, MEM_PSRAM, MEM_OWNER_OTA);
+    if (upload.inflater == NULL || upload.window == NULL) {
+      fail(500, "no memory for the inflate window");
+      return false;
+    }
+    tinfl_init(upload.inflater);
+  }
+  // Sequential writes: sectors are erased as the image arrives, not all up front
+  if (esp_ota_begin(upload.target, OTA_WITH_SEQUENTIAL_WRITES, &upload.handle) != ESP_OK) {
+    fail(500, "esp_ota_begin failed");
+    return false;
+  }
+  upload.stage = STAGE_PAYLOAD;
+  LOG_INFO(TAG, "📥 OTA: %s%s%s image, %lu bytes → %s", h.kind == OTA_KIND_DELTA ? "delta" : "full",
+           (h.flags & OTA_FLAG_DEFLATE) ? " (deflate)" : "", (h.flags & OTA_FLAG_SIGNED) ? " signed" : "",
+           (unsigned long)h.targetSize, upload.target->label);
+  return true;
+}
+
+static void parseHeader(const uint8_t *&data, size_t &len)
+{
+  size_t n = min(len, sizeof(OtaImageHeader) - upload.headerBytes);
+  memcpy((uint8_t *)&upload.header + upload.headerBytes, data, n);
+  upload.headerBytes += n;
+  data += n;
+  len -= n;
+  if (upload.headerBytes < sizeof(OtaImageHeader))
+    return;
+  const OtaImageHeader &h = upload.header;
+  if (h.magic != OTA_MAGIC || h.version != OTA_VERSION || h.kind > OTA_KIND_DELTA) {
+    fail(400, "not a firmware image (plain .bin or make_ota.py container)");
+    return;
+  }
+  startImage();
+}
+
+static void finish()
+{
+  if ((upload.header.flags & OTA_FLAG_DEFLATE) && !upload.inflateDone) {
+    fail(400, "deflate stream truncated");
+    return;
+  }
+  if (upload.op != 0 || upload.written != upload.header.targetSize) {
+    fail(400, "image shorter than announced");
+    return;
+  }
+  if (upload.header.flags & OTA_FLAG_SIGNED) {
+    if (upload.received != upload.total) {
+      fail(400, "signature missing - body shorter than announced");
+      return;
+    }
+    if (!signatureValid()) {
+      fail(403, "signature does not match the release key");
+      return;
+    }
+  }
+  releaseInflater();
+  if (esp_ota_end(upload.handle) != ESP_OK) {
+    upload.stage = STAGE_IDLE;  // esp_ota_end() released the handle
+    fail(400, "image verification failed");
+    return;
+  }
+  if (esp_ota_set_boot_partition(upload.target) != ESP_OK) {
+    upload.stage = STAGE_IDLE;
+    fail(500, "could not switch the boot slot");
+    return;
+  }
+  storeTrial({OTA_TRIAL_VERSION, 0, upload.target->address});
+  upload.stage = STAGE_DONE;
+  upload.status = 200;
+  upload.durationMs = millis() - upload.startMs;
+  updatesTotal.add();
+  LOG_INFO(TAG, "✅ OTA: %lu image bytes from %lu received in %lums - %s boots next",
+           (unsigned long)upload.written, (unsigned long)upload.received, (unsigned long)upload.durationMs,
+           upload.target->label);
+}
+
+static bool active()
+{
+  return upload.stage == STAGE_HEADER || upload.stage == STAGE_PAYLOAD;
+}
+
+bool otaUploadBegin(uint32_t totalBytes, const char *source, const char **refusal)
+{
+  portENTER_CRITICAL(&uploadLock);
+  bool busy = active() && millis() - upload.lastWriteMs < OTA_STALE_MS;
+  OtaStage previous = upload.stage;
+  if (!busy)
+    upload.stage = STAGE_HEADER;  // Claimed - the other transport sees it busy from here
+  portEXIT_CRITICAL(&uploadLock);
+  if (busy) {
+    *refusal = "another upload is in progress";
+    return false;
+  }
+
+  if (previous == STAGE_PAYLOAD)
+    esp_ota_abort(upload.handle);  // Previous transport went away mid-image
+  releaseInflater();
+  releaseDigest();
+  upload = Upload();
+  upload.stage = STAGE_HEADER;
+  upload.source = source;
+  upload.total = totalBytes;
+  upload.payloadEnd = totalBytes;
+  upload.startMs = millis();
+  upload.lastWriteMs = upload.startMs;
+  if (shotLogBusy() || wifiCoexQuiet())
+    fail(409, "shot running - upload after it");
+  else if (onTrial)
+    fail(409, "running image is still on trial - the previous one is the fallback");
+  if (upload.stage == STAGE_FAILED) {
+    *refusal = upload.error;
+    return false;
+  }
+  return true;
+}
+
+bool otaUploadWrite(const uint8_t *data, size_t len)
+{
+  if (!active())
+    return false;
+  upload.lastWriteMs = millis();
+  uint32_t at = upload.received;  // Body offset of data[0]
+  if (upload.stage == STAGE_HEADER && upload.headerBytes == 0 && upload.received == 0 &&
+      len > 0 && data[0] == ESP_IMAGE_MAGIC) {
+    upload.header.kind = OTA_KIND_FULL;  // Plain firmware.bin: no container header
+    upload.header.targetSize = upload.total;
+    if (!startImage())
+      return false;
+  }
+  upload.received += len;
+  if (shotLogBusy()) {
+    fail(409, "shot started - upload abandoned");
+    return false;
+  }
+  if (upload.stage == STAGE_HEADER) {
+    size_t before = len;
+    parseHeader(data, len);
+    at += before - len;
+  }
+  if (upload.stage == STAGE_PAYLOAD && len > 0)
+    feedBody(data, len, at);
+  return active();
+}
+
+bool otaUploadFinish()
+{
+  if (upload.stage == STAGE_PAYLOAD)
+    finish();
+  else if (upload.stage == STAGE_HEADER)
+    fail(400, "body ended inside the image header");
+  return upload.stage == STAGE_DONE;
+}
+
+void otaUploadAbort(const char *why)
+{
+  if (active())
+    fail(400, why);
+}
+
+const char *otaUploadError()
+{
+  return upload.error ? upload.error : "no upload";
+}
+
+int otaUploadStatus()
+{
+  return upload.status ? upload.status : 500;
+}
+
+static void restartCallback(void *)
+{
+  crashRingRecord(CRASH_EV_RESTART);
+  esp_restart();
+}
+
+void otaRestartSoon()
+{
+  settingsStoreFlush();  // Pending slider changes
+  if (restartTimer == NULL) {
+    esp_timer_create_args_t args = {};
+    args.callback = restartCallback;
+    args.name = "ota_restart";
+    esp_timer_create(&args, &restartTimer);
+  }
+  if (restartTimer != NULL)
+    esp_timer_start_once(restartTimer, (uint64_t)OTA_RESTART_MS * 1000);
+}
+
+void otaRegister(AsyncWebServer &server)
+{
+  static const char *refusal = NULL;  // Begin refused without touching the other transport's upload
+
+  server.on(OTA_PATH, HTTP_POST,
+    [](AsyncWebServerRequest *request) {
+      char text[96];
+      if (!httpUpload) {
+        const char *why = refusal;
+        refusal = NULL;
+        if (why == NULL) {
+          request->send(400, "text/plain", "Send the image as the request body (application/octet-stream)\n");
+          return;
+        }
+        snprintf(text, sizeof(text), "Update refused: %s\n", why);
+        request->send(409, "text/plain", text);
+        return;
+      }
+      httpUpload = false;
+      if (upload.stage != STAGE_DONE) {
+        snprintf(text, sizeof(text), "Update failed: %s\n", otaUploadError());
+        request->send(otaUploadStatus(), "text/plain", text);
+        return;
+      }
+      request->send(200, "text/plain", "Update verified - restarting\n");
+      otaRestartSoon();
+    },
+    NULL,
+    [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+      (void)request;
+      if (index == 0) {
+        refusal = NULL;
+        httpUpload = otaUploadBegin(total, "http", &refusal);
+      }
+      if (!httpUpload || !otaUploadWrite(data, len))
+        return;
+      if (index + len >= total)
+        otaUploadFinish();
+    });
+}
+
+void otaDump(Print &out)
+{
+  const esp_partition_t *next = esp_ota_get_next_update_partition(NULL);
+  const esp_app_desc_t *app = esp_ota_get_app_description();
+  out.printf("[OTA] running %s @0x%lx (%s), update slot %s\n", running ? running->label : "?",
+             running ? (unsigned long)running->address : 0UL, app->version, next ? next->label : "none");
+  if (onTrial)
+    out.printf("  on trial: boot %u of %u, kept after %lus healthy%s\n", (unsigned)trialBoots,
+               (unsigned)OTA_TRIAL_BOOTS, (unsigned long)(OTA_VALIDATE_MS / 1000),
+               bootloaderPending ? " (bootloader rollback armed)" : "");
+  else
+    out.printf("  image valid%s\n", rolledBack ? " - the last update was rolled back" : "");
+  if (upload.stage != STAGE_IDLE)
+    out.printf("  last upload (%s): %s, %s%s%s, %lu bytes in, %lu image bytes, %lums%s%s\n", upload.source, STAGE_NAMES[upload.stage],
+               upload.header.kind == OTA_KIND_DELTA ? "delta" : "full",
+               (upload.header.flags & OTA_FLAG_DEFLATE) ? "+deflate" : "",
+               (upload.header.flags & OTA_FLAG_SIGNED) ? "+signed" : "", (unsigned long)upload.received,
+               (unsigned long)upload.written, (unsigned long)upload.durationMs,
+               upload.error ? " - " : "", upload.error ? upload.error : "");
+  out.printf("  curl -H 'Content-Type: application/octet-stream' --data-binary @update.gsota http://<ip>%s\n", OTA_PATH);
+}
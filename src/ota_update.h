@@ -0,0 +1,168 @@
+#ifndef OTA_UPDATE_H
+#define OTA_UPDATE_H
+
+// =============================================================================
+// Firmware Updates (A/B app slots, compressed / delta images, rollback)
+// =============================================================================
+// partitions.csv has two app slots (app0 / app1); an update is written to
+// the slot that is not running while the firmware keeps going, and only the
+// boot selection (otadata) changes at the end. Images come over HTTP:
+//
+//   curl --data-binary @update.gsota http://<ESP32-IP>/ota
+//
+// or over BLE (ble_maint.h) on builds without Wi-Fi. Both feed the same
+// pipeline through otaUploadBegin() / Write() / Finish(); one upload at a
+// time, a second transport is refused until the first finishes or has been
+// silent for OTA_STALE_MS.
+//
+// The body is either a plain app image (firmware.bin, first byte 0xE9) or a
+// container made by tools/ota/make_ota.py:
+//
+//   OtaImageHeader   48 bytes: magic "GSOT", kind, flags, target size, and
+//                    for a delta the base image's ELF SHA-256
+//   payload          zlib-deflated when OTA_FLAG_DEFLATE is set (inflated by
+//                    the ROM's tinfl, 32 KB window in PSRAM)
+//   signature        OTA_FLAG_SIGNED: the last 64 bytes of the body, ECDSA
+//                    P-256 (r || s) over SHA-256 of the header and the app
+//                    image as written - what boots is what was signed
+//
+// A delta payload is a list of operations against the running image:
+//   'C' offset:u32 length:u32        copy from the running slot
+//   'I' length:u32 bytes             insert literal bytes
+// so a release that moves code around costs its changes plus a few bytes
+// per moved block - typically a tenth of the image, which is that much less
+// Wi-Fi time next to the scale link. The base is checked against
+// esp_app_desc_t::app_elf_sha256 before anything is written.
+//
+// GS_OTA_SIGNED (compile-time, default 1): only signed containers are
+// taken - a plain firmware.bin or an unsigned container is refused (403)
+// before anything is written, and the signature is checked against
+// OTA_SIGNING_KEY (ota_signing_key.h) before the boot slot switches. The
+// key in the tree is a placeholder that matches nothing: a build that has
+// not been given the release key refuses every update. -DGS_OTA_SIGNED=0
+// (bench builds on the debug Wi-Fi only) takes unsigned images again.
+//
+// Uploads are refused (409) while a shot brews or Wi-Fi is quiet for one
+// (wifi_coex.h), and abandoned if a shot starts: sector erases stall flash
+// reads on both cores. esp_ota_end() verifies the image before the boot
+// slot switches; the device restarts a second later.
+//
+// Rollback: a new image boots on trial. The watchdog supervisor
+// (watchdog.h) calls otaBootSupervise() every pass; the image is marked
+// valid once every fatal subsystem has checked in and OTA_VALIDATE_MS have
+// passed without a miss. A fatal miss before that switches back to the
+// previous slot straight away, and so does the boot after OTA_TRIAL_BOOTS
+// starts that never got that far (panics, brownouts - counted in NVS
+// "ota"). With CONFIG_BOOTLOADER_APP_ROLLBACK_ENABLE the bootloader's own
+// pending-verify state is used as well, which also covers an image that
+// crashes before setup().
+//
+// "ota" (USB serial / WebSerial) prints the slots, trial state and the last
+// upload.
+//
+// Thread Safety:
+//   otaBegin() from setup(). otaBootSupervise() - watchdog supervisor task
+//   only. otaUpload*() from the transport that claimed the upload
+//   (async_tcp task, OtaWriter task); otaRestartSoon() and otaDump() from any
+//   task (plain fields).
+// =============================================================================
+
+#include <Arduino.h>
+
+#ifndef GS_OTA_SIGNED
+#define GS_OTA_SIGNED 1   // 0 = take unsigned images (bench builds only)
+#endif
+static_assert(GS_OTA_SIGNED == 0 || GS_OTA_SIGNED == 1, "GS_OTA_SIGNED must be 0 or 1");
+
+class AsyncWebServer;
+
+constexpr uint32_t OTA_VALIDATE_MS    = 60000;   // Healthy uptime before a new image is kept
+constexpr uint8_t  OTA_TRIAL_BOOTS    = 3;       // Boots without validation before falling back
+constexpr uint32_t OTA_RESTART_MS     = 1000;    // After the response to the upload
+constexpr uint32_t OTA_STALE_MS       = 10000;   // Silent upload another transport may take over
+constexpr uint32_t OTA_MAGIC          = 0x544F5347;  // "GSOT"
+constexpr uint8_t  OTA_VERSION        = 1;
+constexpr uint8_t  OTA_FLAG_DEFLATE   = 0x01;
+constexpr uint8_t  OTA_FLAG_SIGNED    = 0x02;    // Body ends in OTA_SIGNATURE_BYTES
+constexpr size_t   OTA_SIGNATURE_BYTES = 64;     // ECDSA P-256 r || s, big endian
+constexpr size_t   OTA_COPY_CHUNK     = 1024;    // Flash read per delta copy step
+constexpr const char *OTA_PATH        = "/ota";
+
+enum OtaImageKind : uint8_t {
+  OTA_KIND_FULL = 0,    // Payload is the app image
+  OTA_KIND_DELTA,       // Payload is copy / insert operations against the running image
+};
+
+struct __attribute__((packed)) OtaImageHeader {
+  uint32_t magic;           // OTA_MAGIC
+  uint8_t version;          // OTA_VERSION
+  uint8_t kind;             // OtaImageKind
+  uint8_t flags;            // OTA_FLAG_*
+  uint8_t reserved;
+  uint32_t targetSize;      // App image bytes after inflate / patch
+  uint32_t baseSize;        // Delta: running image bytes the copies may read
+  uint8_t baseElfSha[32];   // Delta: app_elf_sha256 of the image the patch was made against
+};
+
+static_assert(sizeof(OtaImageHeader) == 48, "OtaImageHeader is shared with tools/ota/make_ota.py");
+
+/**
+ * @brief Trial bookkeeping for a freshly installed image (may switch back and restart)
+ * @note Early in setup(), after crashRingBegin()
+ */
+void otaBegin();
+
+/**
+ * @brief Keep or reject an image on trial - from every watchdog supervisor pass
+ * @param allCheckedIn Every fatal subsystem has checked in at least once
+ * @param fatalMiss A fatal subsystem missed its deadline
+ */
+void otaBootSupervise(uint32_t nowMs, bool allCheckedIn, bool fatalMiss);
+
+/**
+ * @brief Claim the upload for one transport and check it may run now
+ * @param totalBytes Body size: plain image (first byte 0xE9) or container
+ * @param source "http" / "ble", for otaDump()
+ * @param refusal Set when false is returned
+ */
+bool otaUploadBegin(uint32_t totalBytes, const char *source, const char **refusal);
+
+/**
+ * @brief Next body bytes, in order
+ * @return false once the upload failed (otaUploadError())
+ */
+bool otaUploadWrite(const uint8_t *data, size_t len);
+
+/**
+ * @brief Body complete: verify the image (and its signature) and switch the boot slot
+ * @return true if the next boot runs the new image
+ */
+bool otaUploadFinish();
+
+/**
+ * @brief Give the upload up (transport lost / cancelled)
+ */
+void otaUploadAbort(const char *why);
+
+/**
+ * @brief Why the last upload failed, and the matching HTTP status
+ */
+const char *otaUploadError();
+int otaUploadStatus();
+
+/**
+ * @brief Commit pending settings and restart in OTA_RESTART_MS (after a finished upload)
+ */
+void otaRestartSoon();
+
+/**
+ * @brief Add POST /ota to `server` (WIRELESS_DEBUG server)
+ */
+void otaRegister(AsyncWebServer &server);
+
+/**
+ * @brief Slots, running image, trial state, last upload
+ */
+void otaDump(Print &out);
+
+#endif // OTA_UPDATE_H
@@ -0,0 +1,62 @@
+#ifndef PEER_FRAME_H
+#define PEER_FRAME_H
+
+// =============================================================================
+// Peer Link Frame (ESP-NOW shot state, shared with tools/peer_display)
+// =============================================================================
+// One fixed-size frame per send, little-endian, no padding. A unit is known
+// by the sender MAC ESP-NOW reports; nothing in the frame names it. Weights
+// are in 0.1 g, flow in 0.01 g/s, times in 0.1 s.
+//
+//   magic    "GS"
+//   version  PEER_FRAME_VERSION - receivers drop other versions
+//   flags    PEER_FLAG_*
+//   seq      per sender, +1 a frame (gaps = lost frames)
+//   state    weight / flow / shot clock / expected end of the running shot,
+//            goal and profile
+//   last     the last finished shot: yield, time, end reason (shot log
+//            reason codes, 0xFF = none since boot) and shots since boot
+//
+// Platform-free: no Arduino or IDF headers, so host tools can include it.
+// =============================================================================
+
+#include <stdint.h>
+
+constexpr uint8_t PEER_FRAME_MAGIC0  = 'G';
+constexpr uint8_t PEER_FRAME_MAGIC1  = 'S';
+constexpr uint8_t PEER_FRAME_VERSION = 1;
+
+constexpr uint8_t PEER_FLAG_BREWING   = 0x01;
+constexpr uint8_t PEER_FLAG_FLUSHING  = 0x02;
+constexpr uint8_t PEER_FLAG_SCALE     = 0x04;   // BLE scale connected
+constexpr uint8_t PEER_FLAG_LOAD_CELL = 0x08;   // Wired load cell is the weight source
+
+constexpr uint8_t PEER_END_NONE = 0xFF;
+
+struct __attribute__((packed)) PeerFrame {
+  uint8_t magic[2];
+  uint8_t version;
+  uint8_t flags;
+  uint16_t seq;
+  int16_t weightDg;
+  int16_t flowCgs;
+  uint16_t timerDs;
+  uint16_t expectedEndDs;   // 0 = no estimate yet
+  uint8_t goalG;
+  uint8_t profile;
+  int16_t lastYieldDg;
+  uint16_t lastTimeDs;
+  uint8_t lastEndReason;
+  uint8_t reserved;
+  uint16_t shots;
+};
+
+static_assert(sizeof(PeerFrame) == 26, "PeerFrame is a wire format");
+
+inline bool peerFrameValid(const uint8_t *data, int len)
+{
+  return len == (int)sizeof(PeerFrame) && data[0] == PEER_FRAME_MAGIC0 && data[1] == PEER_FRAME_MAGIC1 &&
+         data[2] == PEER_FRAME_VERSION;
+}
+
+#endif // PEER_FRAME_H
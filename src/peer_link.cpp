@@ -0,0 +1,240 @@
+// =============================================================================
+// ESP-NOW Peer Link Implementation
+// =============================================================================
+
+#include "peer_link.h"
+#include "debug_config.h"
+#include "console.h"
+#include "metrics.h"
+
+#if GS_PEER_LINK
+
+#include <WiFi.h>
+#include "esp_now.h"
+#include "esp_wifi.h"
+#include "esp_coexist.h"
+
+static constexpr LogTag TAG = LOG_TAG_WIFI;
+
+constexpr uint16_t PEER_SEQ_RESTART = 1000;   // Larger jumps: the sender restarted, not lost frames
+
+static const uint8_t BROADCAST_MAC[ESP_NOW_ETH_ALEN] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+
+struct Peer {
+  uint8_t mac[ESP_NOW_ETH_ALEN];
+  PeerFrame frame;       // Newest
+  uint32_t lastMs;       // 0 = free slot
+  uint32_t frames;
+  uint32_t lost;         // Sequence gaps
+};
+
+static MetricCounter framesSent("peer_link_sent_total", "ESP-NOW shot state frames sent");
+static MetricCounter sendFailures("peer_link_send_failed_total", "ESP-NOW frames refused or not acknowledged by the MAC");
+static MetricCounter framesReceived("peer_link_received_total", "Frames received from other units");
+static MetricCounter framesRejected("peer_link_rejected_total", "ESP-NOW frames with a wrong size, magic or version");
+static MetricCounter framesDeferred("peer_link_deferred_total", "Due frames held back for the scale link");
+
+static portMUX_TYPE peerLock = portMUX_INITIALIZER_UNLOCKED;
+static Peer peers[PEER_LINK_PEERS];
+static bool running = false;
+static uint8_t channel = 0;
+static volatile bool connecting = false;
+
+// Control task
+static uint16_t seq = 0;
+static uint32_t lastSendMs = 0;
+static uint32_t lastSampleMs = 0;
+static uint8_t lastFlags = 0;
+static bool deferring = false;     // Counted once per held-back frame
+static int16_t lastYieldDg = 0;
+static uint16_t lastTimeDs = 0;
+static uint8_t lastEndReason = PEER_END_NONE;
+static uint16_t shots = 0;
+
+static void onSent(const uint8_t *, esp_now_send_status_t status)
+{
+  if (status != ESP_NOW_SEND_SUCCESS)
+    sendFailures.add();
+}
+
+// Wi-Fi task
+static void onReceived(const uint8_t *mac, const uint8_t *data, int len)
+{
+  if (!peerFrameValid(data, len)) {
+    framesRejected.add();
+    return;
+  }
+  PeerFrame frame;
+  memcpy(&frame, data, sizeof(frame));
+  framesReceived.add();
+  uint32_t now = millis();
+
+  portENTER_CRITICAL(&peerLock);
+  Peer *slot = NULL;
+  Peer *oldest = &peers[0];
+  for (uint8_t i = 0; i < PEER_LINK_PEERS; i++) {
+    if (peers[i].lastMs != 0 && memcmp(peers[i].mac, mac, ESP_NOW_ETH_ALEN) == 0) {
+      slot = &peers[i];
+      break;
+    }
+    if (peers[i].lastMs == 0 || (oldest->lastMs != 0 && peers[i].lastMs < oldest->lastMs))
+      oldest = &peers[i];
+  }
+  if (slot == NULL) {
+    slot = oldest;
+    memcpy(slot->mac, mac, ESP_NOW_ETH_ALEN);
+    slot->frames = 0;
+    slot->lost = 0;
+  } else {
+    uint16_t gap = frame.seq - slot->frame.seq - 1;
+    if (gap < PEER_SEQ_RESTART)
+      slot->lost += gap;
+  }
+  slot->frame = frame;
+  slot->lastMs = now ? now : 1;
+  slot->frames++;
+  portEXIT_CRITICAL(&peerLock);
+}
+
+bool peerLinkBegin()
+{
+  if (WiFi.getMode() == WIFI_OFF) {
+    // Production: the driver only, no association - the radio stays on one channel
+    WiFi.mode(WIFI_STA);
+    WiFi.disconnect();
+    esp_wifi_set_channel(GS_PEER_LINK_CHANNEL, WIFI_SECOND_CHAN_NONE);
+#ifndef WIRELESS_DEBUG
+    esp_coex_preference_set(ESP_COEX_PREFER_BT);
+#endif
+  }
+  wifi_second_chan_t second;
+  esp_wifi_get_channel(&channel, &second);
+
+  if (esp_now_init() != ESP_OK) {
+    LOG_ERROR(TAG, "❌ Peer link: ESP-NOW init failed");
+    return false;
+  }
+  esp_now_register_send_cb(onSent);
+  esp_now_register_recv_cb(onReceived);
+
+  esp_now_peer_info_t info = {};
+  memcpy(info.peer_addr, BROADCAST_MAC, ESP_NOW_ETH_ALEN);
+  info.channel = 0;   // The current one
+  info.ifidx = WIFI_IF_STA;
+  info.encrypt = false;
+  if (esp_now_add_peer(&info) != ESP_OK) {
+    LOG_ERROR(TAG, "❌ Peer link: broadcast peer not added");
+    esp_now_deinit();
+    return false;
+  }
+  running = true;
+  LOG_INFO(TAG, "📡 Peer link on channel %u (%s), %u-byte frames", (unsigned)channel,
+           WiFi.macAddress().c_str(), (unsigned)sizeof(PeerFrame));
+  return true;
+}
+
+void peerLinkSetConnecting(bool active)
+{
+  connecting = active;
+}
+
+void peerLinkOffer(PeerFrame &frame, bool bleSample)
+{
+  if (!running)
+    return;
+  uint32_t now = millis();
+  if (bleSample)
+    lastSampleMs = now;
+
+  bool active = frame.flags & (PEER_FLAG_BREWING | PEER_FLAG_FLUSHING);
+  bool due = frame.flags != lastFlags || now - lastSendMs >= (active ? PEER_LINK_ACTIVE_MS : PEER_LINK_IDLE_MS);
+  if (!due)
+    return;
+  // Right after a scale notification, or no notifications to protect
+  bool slot = bleSample || now - lastSampleMs >= PEER_LINK_SAMPLE_WAIT_MS;
+  if (connecting || !slot) {
+    if (!deferring)
+      framesDeferred.add();
+    deferring = true;
+    return;
+  }
+  deferring = false;
+
+  frame.magic[0] = PEER_FRAME_MAGIC0;
+  frame.magic[1] = PEER_FRAME_MAGIC1;
+  frame.version = PEER_FRAME_VERSION;
+  frame.seq = seq++;
+  frame.lastYieldDg = lastYieldDg;
+  frame.lastTimeDs = lastTimeDs;
+  frame.lastEndReason = lastEndReason;
+  frame.reserved = 0;
+  frame.shots = shots;
+
+  if (esp_now_send(BROADCAST_MAC, (const uint8_t *)&frame, sizeof(frame)) == ESP_OK)
+    framesSent.add();
+  else
+    sendFailures.add();
+  lastSendMs = now;
+  lastFlags = frame.flags;
+}
+
+void peerLinkNoteShot(float yieldG, float timeS, uint8_t endReason)
+{
+  lastYieldDg = (int16_t)lroundf(constrain(yieldG, -3276.0f, 3276.0f) * 10.0f);
+  lastTimeDs = (uint16_t)lroundf(constrain(timeS, 0.0f, 6553.0f) * 10.0f);
+  lastEndReason = endReason;
+  shots++;
+  lastFlags = 0xFF;   // Next offer sends
+}
+
+void peerLinkDump(Print &out)
+{
+  if (!running) {
+    out.println("[Peers] Link not running (ESP-NOW init failed)");
+    return;
+  }
+  out.printf("[Peers] ESP-NOW channel %u, %s; sent %lu (failed %lu, held for BLE %lu), received %lu (rejected %lu)\n",
+             (unsigned)channel, WiFi.macAddress().c_str(), (unsigned long)framesSent.value(),
+             (unsigned long)sendFailures.value(), (unsigned long)framesDeferred.value(),
+             (unsigned long)framesReceived.value(), (unsigned long)framesRejected.value());
+
+  Peer copy[PEER_LINK_PEERS];
+  portENTER_CRITICAL(&peerLock);
+  memcpy(copy, peers, sizeof(copy));
+  portEXIT_CRITICAL(&peerLock);
+
+  uint32_t now = millis();
+  bool any = false;
+  for (const Peer &p : copy) {
+    if (p.lastMs == 0)
+      continue;
+    any = true;
+    const PeerFrame &f = p.frame;
+    uint32_t age = now - p.lastMs;
+    out.printf("  %02X:%02X:%02X:%02X:%02X:%02X %-8s %6.1f g %5.2f g/s %5.1f s goal %u | %u shots, last %.1f g in "
+               "%.1f s | %lu frames, %lu lost, %lums ago%s\n",
+               p.mac[0], p.mac[1], p.mac[2], p.mac[3], p.mac[4], p.mac[5],
+               (f.flags & PEER_FLAG_BREWING) ? "brewing" : (f.flags & PEER_FLAG_FLUSHING) ? "flushing" : "idle",
+               f.weightDg / 10.0f, f.flowCgs / 100.0f, f.timerDs / 10.0f, (unsigned)f.goalG, (unsigned)f.shots,
+               f.lastYieldDg / 10.0f, f.lastTimeDs / 10.0f, (unsigned long)p.frames, (unsigned long)p.lost,
+               (unsigned long)age, age > PEER_LINK_PEER_STALE_MS ? " (gone)" : "");
+  }
+  if (!any)
+    out.println("  No other units heard");
+}
+
+#else
+
+bool peerLinkBegin() { return false; }
+void peerLinkSetConnecting(bool) {}
+void peerLinkOffer(PeerFrame &, bool) {}
+void peerLinkNoteShot(float, float, uint8_t) {}
+
+void peerLinkDump(Print &out)
+{
+  out.println("[Peers] Not built in (GS_PEER_LINK=0)");
+}
+
+#endif // GS_PEER_LINK
+
+static ConsoleCommand peersCommand("peers", "ESP-NOW peer link: frames sent / received, other units' shot state", peerLinkDump);
@@ -0,0 +1,88 @@
+#ifndef PEER_LINK_H
+#define PEER_LINK_H
+
+// =============================================================================
+// ESP-NOW Peer Link (shot state between units and to a remote display)
+// =============================================================================
+// Production builds keep Wi-Fi off, so units had no way to share anything.
+// ESP-NOW needs no access point, no association and no TCP: the Wi-Fi driver
+// runs in station mode without connecting, and PeerFrames (peer_frame.h, 26
+// bytes) go to the broadcast address on one fixed channel. Any unit or a
+// display node (tools/peer_display) on that channel hears every unit.
+//
+//   send     the control task offers a frame every pass; it goes out
+//            every PEER_LINK_ACTIVE_MS during a shot / flush, every
+//            PEER_LINK_IDLE_MS otherwise, and at once when the flags
+//            change (shot started / ended, scale lost)
+//   receive  frames from other units land in a table of PEER_LINK_PEERS
+//            (newest per MAC, oldest evicted) - "peers" lists it
+//
+// Scheduling around BLE: the radio is shared and the scale's notifications
+// are what the stop decision runs on. A frame is only sent in a control pass
+// that just took a BLE sample - the scale's connection event is over and the
+// next one is a connection interval away - unless no sample came for
+// PEER_LINK_SAMPLE_WAIT_MS (no scale, wired cell). Nothing is sent while the
+// scale link is being set up. The arbiter prefers BT throughout; in
+// WIRELESS_DEBUG builds wifi_coex.h sets the preference instead and the
+// channel is the access point's.
+//
+// GS_PEER_LINK (compile-time, -DGS_PEER_LINK=n):
+//   0 - Not built (default)
+//   1 - Send and receive on GS_PEER_LINK_CHANNEL
+//
+// Thread Safety:
+//   peerLinkBegin() from setup(), after BLE. peerLinkOffer() and
+//   peerLinkNoteShot() - control task. peerLinkSetConnecting() - BLE task.
+//   The receive callback runs on the Wi-Fi task; the peer table is under a
+//   spinlock.
+// =============================================================================
+
+#include <Arduino.h>
+#include "peer_frame.h"
+
+#ifndef GS_PEER_LINK
+#define GS_PEER_LINK 0
+#endif
+
+#ifndef GS_PEER_LINK_CHANNEL
+#define GS_PEER_LINK_CHANNEL 1
+#endif
+
+static_assert(GS_PEER_LINK <= 1, "GS_PEER_LINK: 0 off, 1 on");
+static_assert(GS_PEER_LINK_CHANNEL >= 1 && GS_PEER_LINK_CHANNEL <= 13, "GS_PEER_LINK_CHANNEL: 1-13");
+
+constexpr uint32_t PEER_LINK_ACTIVE_MS      = 200;    // Shot / flush: 5 frames/s
+constexpr uint32_t PEER_LINK_IDLE_MS        = 2000;
+constexpr uint32_t PEER_LINK_SAMPLE_WAIT_MS = 500;    // No BLE sample this long → send without one
+constexpr uint32_t PEER_LINK_PEER_STALE_MS  = 10000;  // Listed as "gone" after this
+constexpr uint8_t  PEER_LINK_PEERS          = 8;
+
+/**
+ * @brief Wi-Fi driver (station, not connected), ESP-NOW, broadcast peer (no-op when GS_PEER_LINK == 0)
+ * @return true if frames can be sent
+ */
+bool peerLinkBegin();
+
+/**
+ * @brief Scale link being set up - no frames meanwhile (BLE task)
+ */
+void peerLinkSetConnecting(bool active);
+
+/**
+ * @brief Offer the current state once per control pass; sent when due
+ * @param frame state fields filled in (weight, flow, timer, goal, profile, flags); header and last shot are set here
+ * @param bleSample this pass processed a BLE weight sample
+ */
+void peerLinkOffer(PeerFrame &frame, bool bleSample);
+
+/**
+ * @brief A finished shot, carried in every frame until the next one (control task)
+ */
+void peerLinkNoteShot(float yieldG, float timeS, uint8_t endReason);
+
+/**
+ * @brief Channel, counters and the peer table
+ */
+void peerLinkDump(Print &out);
+
+#endif // PEER_LINK_H
@@ -0,0 +1,118 @@
+#ifndef PERIODIC_JOBS_H
+#define PERIODIC_JOBS_H
+
+// =============================================================================
+// Per-Task Periodic Jobs: one deadline check per pass, ms until the next one
+// =============================================================================
+// Heartbeat logs, link reports and health checks used to carry their own
+// `static unsigned long lastX` and a `millis() - lastX > INTERVAL` test that
+// every pass of the task paid, and none of them told the task when it would
+// be due - the task woke on its other timeouts and hoped.
+//
+// A PeriodicJobs<N> holds a task's jobs (function + period) and the earliest
+// deadline among them:
+//
+//   add()      at setup, first run one period from now
+//   service()  each pass: one comparison while nothing is due; otherwise the
+//              due jobs run (in the order they were added) and the earliest
+//              deadline is recomputed. Returns ms until it, to bound the
+//              task's sleep - so a job runs on its deadline even when nothing
+//              else wakes the task.
+//   dueInMs()  the same figure without running anything, for a wait that is
+//              computed in another place than the service() call
+//
+// A job keeps its phase (deadline += period) and skips periods it missed
+// (task blocked or asleep) instead of running back to back. The deadline
+// times are 32-bit millis(); comparisons are wrap-safe.
+//
+// N is a handful per task, so the earliest deadline is found by a linear scan
+// over N entries, only when a job ran - no heap or wheel needed at this size.
+//
+// Thread Safety:
+//   Not thread safe - each instance belongs to the one task that services it.
+// =============================================================================
+
+#include <Arduino.h>
+
+typedef void (*PeriodicJobFn)(uint32_t nowMs);
+
+template <size_t N>
+class PeriodicJobs {
+public:
+  /**
+   * @brief Register a job (setup); false when all N slots are taken
+   */
+  bool add(PeriodicJobFn fn, uint32_t periodMs, uint32_t nowMs)
+  {
+    if (count >= N || fn == NULL || periodMs == 0)
+      return false;
+    jobs[count].fn = fn;
+    jobs[count].periodMs = periodMs;
+    jobs[count].dueMs = nowMs + periodMs;
+    count++;
+    updateNext(nowMs);
+    return true;
+  }
+
+  /**
+   * @brief Run the jobs that are due
+   * @return ms until the next deadline (UINT32_MAX without jobs)
+   */
+  uint32_t service(uint32_t nowMs)
+  {
+    if (count == 0)
+      return UINT32_MAX;
+    if ((int32_t)(nowMs - nextDueMs) < 0)
+      return nextDueMs - nowMs;
+
+    for (size_t i = 0; i < count; i++) {
+      Job &job = jobs[i];
+      if ((int32_t)(nowMs - job.dueMs) < 0)
+        continue;
+      job.fn(nowMs);
+      job.dueMs += job.periodMs;
+      if ((int32_t)(nowMs - job.dueMs) >= 0)
+        job.dueMs = nowMs + job.periodMs;  // Missed periods are skipped, not made up
+    }
+    updateNext(nowMs);
+    return nextDueMs - nowMs;
+  }
+
+  /**
+   * @brief ms until the next deadline, 0 if one is due (for a wait computed before service())
+   */
+  uint32_t dueInMs(uint32_t nowMs) const
+  {
+    if (count == 0)
+      return UINT32_MAX;
+    int32_t in = (int32_t)(nextDueMs - nowMs);
+    return in > 0 ? (uint32_t)in : 0;
+  }
+
+  size_t size() const { return count; }
+
+private:
+  struct Job {
+    PeriodicJobFn fn;
+    uint32_t periodMs;
+    uint32_t dueMs;
+  };
+
+  void updateNext(uint32_t nowMs)
+  {
+    uint32_t soonest = UINT32_MAX;
+    for (size_t i = 0; i < count; i++) {
+      uint32_t in = jobs[i].dueMs - nowMs;
+      if (in < soonest) {
+        soonest = in;
+        nextDueMs = jobs[i].dueMs;
+      }
+    }
+  }
+
+  Job jobs[N];
+  size_t count = 0;
+  uint32_t nextDueMs = 0;
+};
+
+#endif // PERIODIC_JOBS_H
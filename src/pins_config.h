@@ -3,7 +3,9 @@
 /***********************config*************************/
 #define LCD_USB_QSPI_DREVER   1
 
+#ifndef SPI_FREQUENCY  // Overridable from build_flags (display benchmark builds)
 #define SPI_FREQUENCY           32000000
+#endif
 #define TFT_SPI_MODE          SPI_MODE0
 #define TFT_SPI_HOST          SPI2_HOST
 
@@ -34,7 +36,20 @@
 #endif
 #define LVGL_LCD_BUF_SIZE     (EXAMPLE_LCD_H_RES * EXAMPLE_LCD_V_RES)
 
+/* LVGL draw buffers: two stripes of this many landscape rows in internal DRAM
+   (GS_DRAW_STRIPE_ROWS=0: two full frames in PSRAM). Even - the panel column
+   granularity - and 2 x 20 KB at 16 rows */
+#ifndef GS_DRAW_STRIPE_ROWS
+#define GS_DRAW_STRIPE_ROWS   16
+#endif
+
+/* UI is laid out in landscape; the panel scans in portrait */
+#define UI_HOR_RES            EXAMPLE_LCD_V_RES
+#define UI_VER_RES            EXAMPLE_LCD_H_RES
+
+#ifndef SEND_BUF_SIZE
 #define SEND_BUF_SIZE         (28800/2) //16bit(RGB565)
+#endif
 
 #define TFT_QSPI_CS           12
 #define TFT_QSPI_SCK          17
@@ -49,4 +64,4 @@
 #define PIN_BAT_VOLT          2
 
 #define PIN_BUTTON_1          0
-#define PIN_BUTTON_2          21
\ No newline at end of file
+#define PIN_BUTTON_2          21
\ No newline at end of file
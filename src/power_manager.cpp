@@ -0,0 +1,151 @@
+// =============================================================================
+// CPU Frequency Scaling Implementation
+// =============================================================================
+
+#include "power_manager.h"
+#include "debug_config.h"
+#include "metrics.h"
+#include "esp_pm.h"
+
+static constexpr LogTag TAG = LOG_TAG_SYSTEM;
+
+static const char *const LOCK_NAMES[POWER_LOCK_COUNT] = {"shot", "display", "ble_connect"};
+static constexpr uint8_t MANUAL_LOCKS = (1u << POWER_LOCK_SHOT) | (1u << POWER_LOCK_BLE_CONNECT);
+
+static MetricCounter freqSwitches("pm_freq_switches_total", "Manual mode CPU clock changes");
+static MetricCounter lockAcquires("pm_lock_acquires_total", "Power locks taken (all reasons)");
+static MetricCounter deepIdlePeriods("pm_deep_idle_total", "Deep idle periods (display asleep, LVGL stopped)");
+static MetricGauge cpuMhz("cpu_freq_mhz", "CPU clock (manual mode: set clock; auto: last seen)");
+
+static portMUX_TYPE maskMux = portMUX_INITIALIZER_UNLOCKED;
+static uint8_t heldMask = 0;
+static bool autoMode = false;
+static bool lightSleep = false;
+static esp_pm_lock_handle_t locks[POWER_LOCK_COUNT] = {};
+static esp_pm_lock_handle_t awakeLock = NULL;   // NO_LIGHT_SLEEP outside deep idle
+static bool deepIdle = false;
+static volatile bool onBattery = false;
+static uint32_t manualMhz = 0;
+static unsigned long lastBusyMs = 0;
+
+static bool configure(bool withLightSleep)
+{
+  esp_pm_config_esp32s3_t config = {};
+  config.max_freq_mhz = GS_PM_MAX_MHZ;
+  config.min_freq_mhz = GS_PM_MIN_MHZ;
+  config.light_sleep_enable = withLightSleep;
+  return esp_pm_configure(&config) == ESP_OK;
+}
+
+void powerManagerBegin()
+{
+  autoMode = configure(GS_PM_LIGHT_SLEEP);
+  lightSleep = autoMode && GS_PM_LIGHT_SLEEP;
+  if (!autoMode && GS_PM_LIGHT_SLEEP)
+    autoMode = configure(false);  // SDK without tickless idle: frequency scaling only
+
+  for (uint8_t i = 0; autoMode && i < POWER_LOCK_COUNT; i++) {
+    if (esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, LOCK_NAMES[i], &locks[i]) != ESP_OK)
+      autoMode = false;
+  }
+
+  if (autoMode && lightSleep && esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "awake", &awakeLock) == ESP_OK)
+    esp_pm_lock_acquire(awakeLock);
+  else
+    lightSleep = false;
+
+  if (!autoMode) {
+    // Boot is busy (display, BLE, LittleFS) - start high, powerManagerPoll() drops it
+    setCpuFrequencyMhz(GS_PM_MAX_MHZ);
+    manualMhz = GS_PM_MAX_MHZ;
+    lastBusyMs = millis();
+  }
+  cpuMhz.set((int32_t)getCpuFrequencyMhz());
+  LOG_INFO(TAG, "⚡ Power: %s, %d-%d MHz%s", autoMode ? "esp_pm locks" : "manual clock switching",
+           GS_PM_MIN_MHZ, GS_PM_MAX_MHZ, lightSleep ? ", light sleep in deep idle" : "");
+}
+
+void powerLockSet(PowerLock lock, bool held)
+{
+  uint8_t bit = 1u << lock;
+  portENTER_CRITICAL(&maskMux);
+  bool changed = ((heldMask & bit) != 0) != held;
+  if (changed)
+    heldMask = held ? (heldMask | bit) : (heldMask & ~bit);
+  portEXIT_CRITICAL(&maskMux);
+  if (!changed)
+    return;
+
+  if (held)
+    lockAcquires.add();
+  if (autoMode) {
+    if (held)
+      esp_pm_lock_acquire(locks[lock]);
+    else
+      esp_pm_lock_release(locks[lock]);
+  }
+}
+
+void powerManagerPoll()
+{
+  if (autoMode)
+    return;
+
+  unsigned long now = millis();
+  if (__atomic_load_n(&heldMask, __ATOMIC_RELAXED) & MANUAL_LOCKS)
+    lastBusyMs = now;
+
+  uint32_t want = (now - lastBusyMs < POWER_IDLE_HOLD_MS) ? GS_PM_MAX_MHZ : GS_PM_MIN_MHZ;
+  if (want == manualMhz)
+    return;
+
+  // Runs before LVGL renders, never inside a flush (the UI task queues DMA itself)
+  setCpuFrequencyMhz(want);
+  manualMhz = want;
+  freqSwitches.add();
+  cpuMhz.set((int32_t)getCpuFrequencyMhz());
+  LOG_DEBUG(TAG, "⚡ CPU %lu MHz", (unsigned long)want);
+}
+
+void powerManagerSetDeepIdle(bool on)
+{
+  if (on == deepIdle)
+    return;
+  deepIdle = on;
+  if (on)
+    deepIdlePeriods.add();
+  if (awakeLock != NULL) {
+    if (on)
+      esp_pm_lock_release(awakeLock);
+    else
+      esp_pm_lock_acquire(awakeLock);
+  }
+}
+
+void powerManagerSetOnBattery(bool battery)
+{
+  onBattery = battery;
+}
+
+bool powerOnBattery()
+{
+  return onBattery;
+}
+
+void powerManagerDump(Print &out)
+{
+  uint8_t mask = __atomic_load_n(&heldMask, __ATOMIC_RELAXED);
+  out.printf("[Power] %s, %d-%d MHz%s, now %lu MHz\n", autoMode ? "esp_pm locks" : "manual",
+             GS_PM_MIN_MHZ, GS_PM_MAX_MHZ, lightSleep ? ", light sleep in deep idle" : "", (unsigned long)getCpuFrequencyMhz());
+  out.print("  held:");
+  for (uint8_t i = 0; i < POWER_LOCK_COUNT; i++) {
+    if (mask & (1u << i)) {
+      out.print(' ');
+      out.print(LOCK_NAMES[i]);
+    }
+  }
+  out.printf("%s%s%s\n  %lu lock acquisitions, %lu clock switches, %lu deep idle periods\n", mask ? "" : " none",
+             deepIdle ? " (deep idle)" : "", onBattery ? ", on battery: power saver" : "",
+             (unsigned long)lockAcquires.value(),
+             (unsigned long)freqSwitches.value(), (unsigned long)deepIdlePeriods.value());
+}
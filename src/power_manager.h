@@ -0,0 +1,111 @@
+#ifndef POWER_MANAGER_H
+#define POWER_MANAGER_H
+
+// =============================================================================
+// CPU Frequency Scaling by Activity
+// =============================================================================
+// The controller sits on the bar 12+ hours a day and does real work only
+// while a shot or flush runs, while LVGL renders a frame and while the scale
+// link is being set up. Those hold a power lock; with none held the CPU
+// runs at GS_PM_MIN_MHZ:
+//
+//   POWER_LOCK_SHOT         shot.brewing or flushing     (UI task)
+//   POWER_LOCK_DISPLAY      lv_timer_handler() - render  (UI task)
+//                           + queueing the DMA windows
+//   POWER_LOCK_BLE_CONNECT  CONNECTING .. NOTIFICATIONS  (BLE task)
+//
+// Two implementations, picked at powerManagerBegin():
+//
+//   auto    esp_pm_configure() works (CONFIG_PM_ENABLE in the SDK): one
+//           ESP_PM_CPU_FREQ_MAX lock per reason, the PM switches between
+//           GS_PM_MAX_MHZ and GS_PM_MIN_MHZ around every lock (µs cost).
+//           The SPI master driver holds its own APB lock while DMA windows
+//           stream out. With GS_PM_LIGHT_SLEEP=1 it may also light sleep
+//           (needs tickless idle in the SDK), but only in deep idle - an
+//           ESP_PM_NO_LIGHT_SLEEP lock is held at all other times.
+//   manual  the stock Arduino SDK has no PM: setCpuFrequencyMhz() from
+//           powerManagerPoll(). Only SHOT and BLE_CONNECT count - render
+//           locks come and go per frame - and the clock drops back only
+//           after POWER_IDLE_HOLD_MS without them.
+//
+// Deep idle (powerManagerSetDeepIdle): the display sleeps and the UI task
+// has stopped LVGL, so the only wake-ups left are BLE radio events, the BLE
+// task's deadlines and the touch INT (armed as a GPIO wake source). That is
+// where tickless idle pays off; the BT controller keeps its own sleep lock
+// while it cannot sleep through a connection event.
+//
+// On battery (power_telemetry.h → powerManagerSetOnBattery) the power saver
+// is on: the frame pacer idles slower and the scale scan retries less often.
+//
+// APB stays at 80 MHz from 80 MHz up, so UART/SPI/I2C timing is unaffected.
+// "power" on the serial console prints the mode and switch counts.
+//
+// GS_PM_MAX_MHZ / GS_PM_MIN_MHZ (compile-time): 160 / 80 by default (160 is
+// the fixed clock this firmware always ran at). GS_PM_LIGHT_SLEEP: 0.
+//
+// Thread Safety:
+//   powerLockSet() - any task (an owner per lock, spinlock on the mask).
+//   powerManagerSetOnBattery() / powerOnBattery() - any task (single byte).
+//   powerManagerBegin() / powerManagerPoll() / powerManagerSetDeepIdle() -
+//   setup / UI task.
+// =============================================================================
+
+#include <Arduino.h>
+
+#ifndef GS_PM_MAX_MHZ
+#define GS_PM_MAX_MHZ 160
+#endif
+
+#ifndef GS_PM_MIN_MHZ
+#define GS_PM_MIN_MHZ 80
+#endif
+
+#ifndef GS_PM_LIGHT_SLEEP
+#define GS_PM_LIGHT_SLEEP 0
+#endif
+
+constexpr uint32_t POWER_IDLE_HOLD_MS = 2000;   // Manual mode: no lock this long → GS_PM_MIN_MHZ
+
+enum PowerLock : uint8_t {
+  POWER_LOCK_SHOT = 0,
+  POWER_LOCK_DISPLAY,
+  POWER_LOCK_BLE_CONNECT,
+  POWER_LOCK_COUNT
+};
+
+/**
+ * @brief Configure power management (replaces the fixed setCpuFrequencyMhz()); call early in setup()
+ */
+void powerManagerBegin();
+
+/**
+ * @brief Hold or release `lock` - transitions only, repeated calls are free
+ */
+void powerLockSet(PowerLock lock, bool held);
+
+/**
+ * @brief Manual mode: apply the frequency for the held locks; call every UI task pass
+ */
+void powerManagerPoll();
+
+/**
+ * @brief Enter / leave deep idle (UI task) - allows light sleep when GS_PM_LIGHT_SLEEP is on
+ */
+void powerManagerSetDeepIdle(bool deepIdle);
+
+/**
+ * @brief Supply changed (power telemetry) - switches the power saver
+ */
+void powerManagerSetOnBattery(bool onBattery);
+
+/**
+ * @brief True while running from the battery (refresh / scan duty lowered)
+ */
+bool powerOnBattery();
+
+/**
+ * @brief Mode, frequencies, held locks and switch counts
+ */
+void powerManagerDump(Print &out);
+
+#endif // POWER_MANAGER_H
@@ -0,0 +1,163 @@
+// =============================================================================
+// Battery / Input Power Telemetry Implementation
+// =============================================================================
+
+#include "power_telemetry.h"
+#include "power_manager.h"
+#include "i2c_bus.h"
+#include "debug_config.h"
+#include "metrics.h"
+#include "seqlock.h"
+#include "pins_config.h"
+#include "esp_timer.h"
+#include <Wire.h>
+
+#define XPOWERS_CHIP_SY6970
+#include <XPowersLib.h>
+
+static constexpr LogTag TAG = LOG_TAG_SYSTEM;
+
+static const char *const CHARGE_NAMES[] = {"not charging", "pre-charge", "fast charge", "charge done"};
+
+// Single-cell LiPo open-circuit voltage → state of charge (coarse, no load correction)
+struct VoltagePoint {
+  uint16_t mv;
+  uint8_t pct;
+};
+static const VoltagePoint DISCHARGE_CURVE[] = {
+  {3300, 0}, {3600, 10}, {3700, 25}, {3780, 40}, {3850, 55}, {3950, 70}, {4050, 85}, {4150, 100},
+};
+
+static MetricCounter samples("power_samples_total", "PMU / battery telemetry samples");
+static MetricCounter supplyChanges("power_supply_changes_total", "Switches between input power and battery");
+static MetricGauge batteryMv("battery_mv", "Battery voltage");
+static MetricGauge vbusMv("vbus_mv", "Input (VBUS) voltage, 0 without PMU");
+static MetricGauge chargeMa("charge_ma", "Charge current");
+static MetricGauge chipTempC("chip_temp_c", "ESP32-S3 die temperature");
+
+static XPowersPPM PMU;
+static bool pmuOk = false;
+static esp_timer_handle_t sampleTimer = NULL;
+static SeqLock<PowerTelemetry> shared(PowerTelemetry{});
+
+static int8_t batteryPercent(uint16_t mv)
+{
+  if (mv < BATTERY_PRESENT_MIN_MV)
+    return -1;
+  const size_t count = sizeof(DISCHARGE_CURVE) / sizeof(DISCHARGE_CURVE[0]);
+  if (mv <= DISCHARGE_CURVE[0].mv)
+    return 0;
+  for (size_t i = 1; i < count; i++) {
+    const VoltagePoint &lo = DISCHARGE_CURVE[i - 1];
+    const VoltagePoint &hi = DISCHARGE_CURVE[i];
+    if (mv <= hi.mv)
+      return (int8_t)(lo.pct + (uint32_t)(mv - lo.mv) * (hi.pct - lo.pct) / (hi.mv - lo.mv));
+  }
+  return 100;
+}
+
+// Bus job on the touch task, between touches - a handful of register reads
+static bool sample(void *)
+{
+  PowerTelemetry t = {};
+  t.valid = true;
+  t.pmu = pmuOk;
+  if (pmuOk) {
+    t.batteryMv = PMU.getBattVoltage();
+    t.vbusMv = PMU.getVbusVoltage();
+    t.systemMv = PMU.getSystemVoltage();
+    t.chargeMa = PMU.getChargeCurrent();
+    t.vbusIn = PMU.isVbusIn();
+    t.powerGood = PMU.isPowerGood();
+    t.chargeState = (uint8_t)PMU.chargeStatus() & 0x03;
+  } else {
+    t.batteryMv = (uint16_t)(analogReadMilliVolts(PIN_BAT_VOLT) * BATTERY_DIVIDER);
+  }
+  t.batteryPct = batteryPercent(t.batteryMv);
+  t.onBattery = pmuOk && !t.vbusIn && t.batteryPct >= 0;
+  float chipC = temperatureRead();
+  t.chipTempC = (chipC == chipC && chipC > -40.0f && chipC < 150.0f) ? (int16_t)lroundf(chipC) : INT16_MIN;
+  t.sampledMs = millis();
+
+  PowerTelemetry previous = shared.load();
+  shared.update([&](PowerTelemetry &s) { s = t; });
+  samples.add();
+  batteryMv.set(t.batteryMv);
+  vbusMv.set(t.vbusMv);
+  chargeMa.set(t.chargeMa);
+  if (t.chipTempC != INT16_MIN)
+    chipTempC.set(t.chipTempC);
+
+  if (!previous.valid || previous.onBattery != t.onBattery) {
+    if (previous.valid)
+      supplyChanges.add();
+    powerManagerSetOnBattery(t.onBattery);
+    if (t.onBattery)
+      LOG_INFO(TAG, "🔋 On battery: %umV (%d%%) - power saver on", t.batteryMv, t.batteryPct);
+    else
+      LOG_INFO(TAG, "🔌 Input power: %s", t.pmu ? (t.vbusIn ? "VBUS present" : "no VBUS, no battery") : "unknown (no PMU)");
+  }
+  return true;
+}
+
+static void submitSample()
+{
+  I2CBusJob job = {};
+  job.client = I2C_CLIENT_PMU;
+  job.fn = sample;
+  i2cBusSubmit(job, I2C_PRIO_LOW);  // Full queue: skip this period, the next one catches up
+}
+
+// esp_timer task - only queues the job, the bus owner runs it
+static void sampleTimerCallback(void *)
+{
+  submitSample();
+}
+
+void powerTelemetryBegin(int sda, int scl)
+{
+  pmuOk = PMU.init(Wire, sda, scl, SY6970_SLAVE_ADDRESS);
+  if (pmuOk) {
+    PMU.disableStatLed();   // Turn off green charging indicator LED
+    PMU.enableADCMeasure(); // Voltage / current readings
+    LOG_INFO(TAG, "PMU initialized, status LED disabled, telemetry every %lus", POWER_TELEMETRY_PERIOD_MS / 1000);
+  } else {
+    LOG_WARN(TAG, "PMU init failed (LED control unavailable) - battery voltage from ADC only");
+  }
+
+  esp_timer_create_args_t args = {};
+  args.callback = sampleTimerCallback;
+  args.dispatch_method = ESP_TIMER_TASK;
+  args.name = "power_sample";
+  if (esp_timer_create(&args, &sampleTimer) != ESP_OK ||
+      esp_timer_start_periodic(sampleTimer, (uint64_t)POWER_TELEMETRY_PERIOD_MS * 1000) != ESP_OK) {
+    sampleTimer = NULL;
+    LOG_ERROR(TAG, "❌ Telemetry timer unavailable - only the boot sample is taken");
+  }
+  submitSample();  // First sample as soon as the bus owner runs
+}
+
+PowerTelemetry powerTelemetryGet()
+{
+  return shared.load();
+}
+
+void powerTelemetryDump(Print &out)
+{
+  PowerTelemetry t = shared.load();
+  if (!t.valid) {
+    out.println("[Supply] no sample yet");
+    return;
+  }
+  out.printf("[Supply] %s, sampled %lus ago (%s)\n", t.onBattery ? "battery" : "input power",
+             (millis() - t.sampledMs) / 1000, t.pmu ? "SY6970" : "ADC only");
+  if (t.batteryPct >= 0)
+    out.printf("  battery %umV (~%d%%)\n", t.batteryMv, t.batteryPct);
+  else
+    out.printf("  no battery (%umV)\n", t.batteryMv);
+  if (t.pmu)
+    out.printf("  VBUS %umV%s%s, system %umV, %s at %umA\n", t.vbusMv, t.vbusIn ? " present" : " absent",
+               t.powerGood ? ", power good" : "", t.systemMv, CHARGE_NAMES[t.chargeState], t.chargeMa);
+  if (t.chipTempC != INT16_MIN)
+    out.printf("  chip %dC\n", t.chipTempC);
+}
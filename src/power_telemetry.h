@@ -0,0 +1,74 @@
+#ifndef POWER_TELEMETRY_H
+#define POWER_TELEMETRY_H
+
+// =============================================================================
+// Battery / Input Power Telemetry (SY6970 PMU)
+// =============================================================================
+// The SY6970 charger on the T-Display-S3-Long reports battery, input (VBUS)
+// and system voltage, charge current and charge state over the I2C bus it
+// shares with the touch controller. Every POWER_TELEMETRY_PERIOD_MS an
+// esp_timer queues one sample as a low priority bus job (i2c_bus.h); the
+// touch task runs it between touches only, so a PMU read can never
+// interleave with a touch read. Without an answering PMU the battery voltage comes from the
+// PIN_BAT_VOLT divider (ADC) and the input state is unknown.
+//
+// Each sample also reads the chip's internal temperature sensor - the PMU
+// readings carry no temperature, and the die tracks the board's warm-up well
+// enough for the touch noise model (touch_pipeline.h).
+//
+// Supply changes feed the power manager (powerManagerSetOnBattery()): on
+// battery the idle refresh rate and the scale scan duty go down.
+//
+// "power" on the serial console prints the last sample after the clock state.
+//
+// Thread Safety:
+//   Sampled on the bus owner (touch task, single writer), published through a SeqLock -
+//   powerTelemetryGet() from any task.
+// =============================================================================
+
+#include <Arduino.h>
+
+constexpr uint32_t POWER_TELEMETRY_PERIOD_MS = 10000;
+constexpr uint16_t BATTERY_PRESENT_MIN_MV    = 2500;   // Below: no cell on the connector
+constexpr uint32_t BATTERY_DIVIDER           = 2;      // PIN_BAT_VOLT divider (ADC fallback)
+
+enum PowerChargeState : uint8_t {
+  CHARGE_NONE = 0,   // SY6970 CHRG_STAT encoding
+  CHARGE_PRE,
+  CHARGE_FAST,
+  CHARGE_DONE,
+};
+
+struct PowerTelemetry {
+  bool valid;                 // At least one sample taken
+  bool pmu;                   // SY6970 readings (false: ADC battery voltage only)
+  bool vbusIn;                // Input power present (PMU only)
+  bool powerGood;             // Input good enough to run from (PMU only)
+  bool onBattery;             // Running from the cell
+  uint8_t chargeState;        // PowerChargeState
+  int8_t batteryPct;          // Estimate from the voltage, -1 = no battery
+  uint16_t batteryMv;
+  uint16_t vbusMv;
+  uint16_t systemMv;
+  uint16_t chargeMa;
+  int16_t chipTempC;          // ESP32-S3 die sensor, board temperature proxy (INT16_MIN = no reading)
+  uint32_t sampledMs;
+};
+
+/**
+ * @brief Initialise the PMU (status LED off, ADC on) and start the sample timer
+ * @note Call after Wire.begin() and i2cBusBegin(); samples run once touchInputBegin() owns the bus
+ */
+void powerTelemetryBegin(int sda, int scl);
+
+/**
+ * @brief Last published sample (valid == false before the first one)
+ */
+PowerTelemetry powerTelemetryGet();
+
+/**
+ * @brief Last sample, human readable
+ */
+void powerTelemetryDump(Print &out);
+
+#endif // POWER_TELEMETRY_H
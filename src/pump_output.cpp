@@ -0,0 +1,161 @@
+// =============================================================================
+// Pump Output Stage Implementation
+// =============================================================================
+
+#include "pump_output.h"
+#include "debug_config.h"
+#include "metrics.h"
+#include "esp_timer.h"
+#include "driver/ledc.h"
+#include "hal/gpio_ll.h"
+#include "iram_placement.h"
+
+static constexpr LogTag TAG = LOG_TAG_RELAY;
+
+static const char *const KIND_NAMES[PUMP_OUTPUT_KIND_COUNT] = {"relay", "pwm", "phase"};
+
+static constexpr ledc_mode_t PWM_MODE       = LEDC_LOW_SPEED_MODE;
+static constexpr ledc_channel_t PWM_CHANNEL = LEDC_CHANNEL_1;   // Channel / timer 0: backlight
+static constexpr ledc_timer_t PWM_TIMER     = LEDC_TIMER_1;
+static constexpr uint32_t PWM_MAX_DUTY      = (1u << 10) - 1;  // 10 bit
+
+// Half-cycle energy is 1 - a/pi + sin(2a)/(2 pi) for a firing angle a: the
+// firing delay, in 1/1000 of the half cycle, for power 0, 1/16 ... 1
+static const uint16_t PHASE_DELAY_PERMILLE[17] = {
+  1000, 781, 719, 672, 632, 597, 563, 531, 500, 469, 437, 403, 368, 328, 281, 219, 0
+};
+static constexpr uint32_t HALF_CYCLE_MIN_US = 7000;    // 70 Hz
+static constexpr uint32_t HALF_CYCLE_MAX_US = 11000;   // 45 Hz
+static constexpr uint16_t PHASE_OFF = 1000;            // Never fire
+
+static MetricCounter zeroCrossings("pump_zero_crossings_total", "Mains zero crossings seen by the phase-angle output");
+static MetricCounter phaseFires("pump_phase_fires_total", "Triac gate pulses of the phase-angle output");
+
+static float power = 1.0f;                           // Control task writes, others read the word
+static volatile uint16_t delayPermille = 0;          // Phase: firing delay, read by the ISR
+static volatile uint32_t halfCycleUs = 10000;
+static volatile int64_t lastZeroUs = 0;
+static esp_timer_handle_t fireTimer = NULL;
+
+static inline __attribute__((always_inline)) void gateWrite(bool high)
+{
+  gpio_ll_set_level(&GPIO, (gpio_num_t)GS_PUMP_GATE_PIN, high ? 1 : 0);
+}
+
+static void fireCallback(void *)
+{
+  gateWrite(true);  // Triac latches; the gate drops at the next crossing
+  phaseFires.add();
+}
+
+static void IRAM_ATTR zeroCrossIsr()
+{
+  int64_t now = esp_timer_get_time();
+  uint32_t period = (uint32_t)(now - lastZeroUs);
+  if (period >= HALF_CYCLE_MIN_US && period <= HALF_CYCLE_MAX_US)
+    halfCycleUs = period;
+  lastZeroUs = now;
+  zeroCrossings.add();
+
+  gateWrite(false);
+  uint16_t permille = delayPermille;
+  if (permille == 0) {
+    gateWrite(true);  // Full power: fire at the crossing
+  } else if (permille < PHASE_OFF && fireTimer != NULL) {
+    esp_timer_stop(fireTimer);
+    esp_timer_start_once(fireTimer, (uint64_t)halfCycleUs * permille / 1000u);
+  }
+}
+
+static uint16_t phaseDelayFor(float p)
+{
+  float at = p * 16.0f;
+  int i = (int)at;
+  if (i >= 16)
+    return PHASE_DELAY_PERMILLE[16];
+  float frac = at - (float)i;
+  return (uint16_t)(PHASE_DELAY_PERMILLE[i] + (PHASE_DELAY_PERMILLE[i + 1] - PHASE_DELAY_PERMILLE[i]) * frac);
+}
+
+void pumpOutputBegin()
+{
+  if (PUMP_OUTPUT_KIND == PUMP_OUTPUT_PWM) {
+    ledc_timer_config_t timer = {};
+    timer.speed_mode = PWM_MODE;
+    timer.duty_resolution = LEDC_TIMER_10_BIT;
+    timer.timer_num = PWM_TIMER;
+    timer.freq_hz = GS_PUMP_PWM_HZ;
+    timer.clk_cfg = LEDC_AUTO_CLK;
+    ledc_timer_config(&timer);
+
+    ledc_channel_config_t channel = {};
+    channel.gpio_num = GS_PUMP_GATE_PIN;
+    channel.speed_mode = PWM_MODE;
+    channel.channel = PWM_CHANNEL;
+    channel.intr_type = LEDC_INTR_DISABLE;
+    channel.timer_sel = PWM_TIMER;
+    channel.duty = 0;
+    channel.hpoint = 0;
+    ledc_channel_config(&channel);
+  } else if (PUMP_OUTPUT_KIND == PUMP_OUTPUT_PHASE) {
+    pinMode(GS_PUMP_GATE_PIN, OUTPUT);
+    gateWrite(false);
+    esp_timer_create_args_t args = {};
+    args.callback = fireCallback;
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.name = "pump_fire";
+    if (esp_timer_create(&args, &fireTimer) != ESP_OK) {
+      fireTimer = NULL;
+      LOG_ERROR(TAG, "❌ Phase-angle fire timer unavailable - pump runs at full power only");
+    }
+    pinMode(GS_PUMP_ZERO_CROSS_PIN, INPUT);
+    attachInterrupt(digitalPinToInterrupt(GS_PUMP_ZERO_CROSS_PIN), zeroCrossIsr, RISING);
+  }
+
+  pumpOutputSetPower(1.0f);
+  LOG_INFO(TAG, "🔌 Pump output: %s", KIND_NAMES[PUMP_OUTPUT_KIND]);
+}
+
+void GS_HOT_IRAM pumpOutputSetPower(float p)
+{
+  if (p < 0.0f)
+    p = 0.0f;
+  if (p > 1.0f)
+    p = 1.0f;
+  __atomic_store(&power, &p, __ATOMIC_RELAXED);
+
+  if (PUMP_OUTPUT_KIND == PUMP_OUTPUT_PWM) {
+    ledc_set_duty(PWM_MODE, PWM_CHANNEL, (uint32_t)(p * PWM_MAX_DUTY + 0.5f));
+    ledc_update_duty(PWM_MODE, PWM_CHANNEL);
+  } else if (PUMP_OUTPUT_KIND == PUMP_OUTPUT_PHASE) {
+    delayPermille = fireTimer != NULL ? phaseDelayFor(p) : 0;  // Takes effect at the next crossing
+  }
+}
+
+float pumpOutputPower()
+{
+  float p;
+  __atomic_load(&power, &p, __ATOMIC_RELAXED);
+  return p;
+}
+
+bool GS_HOT_IRAM pumpOutputGate(int64_t nowUs)
+{
+  if (PUMP_OUTPUT_KIND != PUMP_OUTPUT_RELAY || power >= 1.0f)
+    return true;
+  constexpr int64_t windowUs = (int64_t)GS_PUMP_RELAY_WINDOW_MS * 1000;
+  return (float)(nowUs % windowUs) < power * (float)windowUs;
+}
+
+void pumpOutputDump(Print &out)
+{
+  out.printf("[Pump] %s output, power %.0f%%", KIND_NAMES[PUMP_OUTPUT_KIND], pumpOutputPower() * 100.0f);
+  if (PUMP_OUTPUT_KIND == PUMP_OUTPUT_RELAY)
+    out.printf(", %u ms time-proportioning window\n", (unsigned)GS_PUMP_RELAY_WINDOW_MS);
+  else if (PUMP_OUTPUT_KIND == PUMP_OUTPUT_PWM)
+    out.printf(", %u Hz PWM on GPIO %u\n", (unsigned)GS_PUMP_PWM_HZ, (unsigned)GS_PUMP_GATE_PIN);
+  else
+    out.printf(", gate GPIO %u, zero cross GPIO %u, half cycle %lu us, delay %u/1000, %lu crossings, %lu fires\n",
+               (unsigned)GS_PUMP_GATE_PIN, (unsigned)GS_PUMP_ZERO_CROSS_PIN, (unsigned long)halfCycleUs,
+               (unsigned)delayPermille, (unsigned long)zeroCrossings.value(), (unsigned long)phaseFires.value());
+}
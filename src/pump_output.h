@@ -0,0 +1,94 @@
+#ifndef PUMP_OUTPUT_H
+#define PUMP_OUTPUT_H
+
+// =============================================================================
+// Pump Output Stage: relay, PWM controller or phase-angle dimmer
+// =============================================================================
+// RELAY1 switches the pump on and off (relay_control.h) and stays the
+// master switch: the start, the stop decision and its scheduled cut-off
+// work on it as before. The output stage sets how hard the pump runs while
+// the relay is on, as a power level from 0 to 1:
+//
+//   PUMP_OUTPUT_RELAY  No second output. Power below 1 is time-proportioned
+//                      on the relay itself: on for power x
+//                      GS_PUMP_RELAY_WINDOW_MS in each window, at the
+//                      control task's resolution (one weight sample).
+//   PUMP_OUTPUT_PWM    LEDC duty on GS_PUMP_GATE_PIN at GS_PUMP_PWM_HZ, for
+//                      a pump controller or SSR module that takes PWM.
+//   PUMP_OUTPUT_PHASE  Triac gate on GS_PUMP_GATE_PIN, fired a delay after
+//                      each mains zero crossing (GS_PUMP_ZERO_CROSS_PIN,
+//                      rising edge). The delay comes from a table that makes
+//                      the delivered power linear in the setting: half-cycle
+//                      energy is not linear in the firing angle. The half
+//                      cycle is measured, so 50 and 60 Hz both work.
+//
+// Phase timing: the zero-crossing ISR drops the gate and arms a one-shot
+// esp_timer at the delay; the timer callback raises the gate, which then
+// stays up until the next crossing. The edge lands within the esp_timer
+// task's dispatch latency (tens of us; a 50 Hz half cycle is 10 ms).
+//
+// GS_PUMP_OUTPUT (compile-time, -DGS_PUMP_OUTPUT=n):
+//   0 - Relay only (default, the stock wiring)
+//   1 - PWM output
+//   2 - Phase-angle dimmer with a zero-crossing input
+// The default pins are free header GPIOs - check them against the wiring.
+//
+// Thread Safety:
+//   pumpOutputSetPower() / pumpOutputGate() - shot control task.
+//   pumpOutputPower() / pumpOutputDump() - any task (one word).
+//   The zero-crossing ISR and the fire timer read the delay atomically.
+// =============================================================================
+
+#include <Arduino.h>
+
+#ifndef GS_PUMP_OUTPUT
+#define GS_PUMP_OUTPUT 0
+#endif
+
+#ifndef GS_PUMP_GATE_PIN
+#define GS_PUMP_GATE_PIN 38
+#endif
+#ifndef GS_PUMP_ZERO_CROSS_PIN
+#define GS_PUMP_ZERO_CROSS_PIN 47
+#endif
+#ifndef GS_PUMP_PWM_HZ
+#define GS_PUMP_PWM_HZ 1000
+#endif
+#ifndef GS_PUMP_RELAY_WINDOW_MS
+#define GS_PUMP_RELAY_WINDOW_MS 2000
+#endif
+
+enum PumpOutputKind : uint8_t {
+  PUMP_OUTPUT_RELAY,
+  PUMP_OUTPUT_PWM,
+  PUMP_OUTPUT_PHASE,
+  PUMP_OUTPUT_KIND_COUNT
+};
+
+constexpr PumpOutputKind PUMP_OUTPUT_KIND = (PumpOutputKind)GS_PUMP_OUTPUT;
+static_assert(GS_PUMP_OUTPUT < PUMP_OUTPUT_KIND_COUNT, "GS_PUMP_OUTPUT: 0 relay, 1 PWM, 2 phase angle");
+
+/**
+ * @brief Set up the output (full power) - setup(), after relayControlBegin()
+ */
+void pumpOutputBegin();
+
+/**
+ * @brief Pump power while the relay is on, 0..1 (clamped)
+ */
+void pumpOutputSetPower(float power);
+
+float pumpOutputPower();
+
+/**
+ * @brief Relay output only: whether the time-proportioning window has the pump on at nowUs
+ * @return Always true with a PWM or phase-angle output, or at full power
+ */
+bool pumpOutputGate(int64_t nowUs);
+
+/**
+ * @brief Kind, power, mains half cycle and zero crossings (the "pump" console command)
+ */
+void pumpOutputDump(Print &out);
+
+#endif // PUMP_OUTPUT_H
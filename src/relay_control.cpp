@@ -0,0 +1,216 @@
+// =============================================================================
+// Pump Relay Control Implementation
+// =============================================================================
+
+#include "relay_control.h"
+#include "debug_config.h"
+#include "esp_timer.h"
+#include "gpio_probe.h"
+#include "iram_placement.h"
+#include "shot_events.h"
+#include "hal/gpio_ll.h"
+
+static constexpr LogTag TAG = LOG_TAG_RELAY;
+
+static const char *const TIMER_NAMES[SHOT_GROUP_MAX] = {"relay_cut", "relay_cut2"};
+
+struct RelayChannel {
+  uint8_t group = 0;
+  int pin = -1;
+  esp_timer_handle_t cutTimer = NULL;
+  volatile bool state = false;
+  volatile bool armed = false;
+  volatile bool cutFired = false;
+  volatile int64_t cutFiredUs = 0;
+  volatile int64_t cutAtUs = 0;
+  unsigned long lastVerify = 0;
+};
+
+static portMUX_TYPE relayMux = portMUX_INITIALIZER_UNLOCKED;
+static RelayChannel channels[GS_GROUP_COUNT];
+static TaskHandle_t cutNotifyTask = NULL;
+static uint32_t cutNotifyBits = 0;
+
+static inline RelayChannel &channelFor(uint8_t group)
+{
+  return channels[group < GS_GROUP_COUNT ? group : 0];
+}
+
+// Relay output from IRAM-placed code: gpio_ll is inline, digitalWrite() runs from flash
+static inline __attribute__((always_inline)) void relayWrite(RelayChannel &ch, bool high)
+{
+  if (ch.pin >= 0)
+    gpio_ll_set_level(&GPIO, (gpio_num_t)ch.pin, high ? 1 : 0);
+  if (ch.group == 0)
+    GS_PROBE_SET(PROBE_RELAY, high);
+}
+
+static void GS_HOT_IRAM cutTimerCallback(void *arg)
+{
+  RelayChannel &ch = *(RelayChannel *)arg;
+  bool wasOn;
+  int64_t firedUs = 0;
+  int64_t scheduledUs = 0;
+  portENTER_CRITICAL(&relayMux);
+  wasOn = ch.armed && ch.state;
+  if (ch.armed)
+  {
+    relayWrite(ch, false);
+    ch.state = false;
+    ch.armed = false;
+    ch.cutFired = true;
+    ch.cutFiredUs = firedUs = esp_timer_get_time();
+    scheduledUs = ch.cutAtUs;
+  }
+  portEXIT_CRITICAL(&relayMux);
+
+  if (wasOn)
+    shotEventsRecord(SHOT_EVENT_RELAY, ch.group, SHOT_EVENT_RELAY_TIMER, 0, (int32_t)(firedUs - scheduledUs), firedUs);
+
+  if (wasOn && cutNotifyTask != NULL)
+    xTaskNotify(cutNotifyTask, cutNotifyBits, eSetBits);
+}
+
+void relayControlBegin(int pin, uint8_t group)
+{
+  RelayChannel &ch = channelFor(group);
+  ch.group = group;
+  ch.pin = pin;
+
+  pinMode(ch.pin, OUTPUT);
+  digitalWrite(ch.pin, LOW);
+  ch.state = false;
+
+  if (ch.cutTimer == NULL)
+  {
+    esp_timer_create_args_t args = {};
+    args.callback = cutTimerCallback;
+    args.arg = &ch;
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.name = TIMER_NAMES[group < SHOT_GROUP_MAX ? group : 0];
+    if (esp_timer_create(&args, &ch.cutTimer) != ESP_OK)
+    {
+      ch.cutTimer = NULL;
+      LOG_ERROR(TAG, "❌ Cut-off timer unavailable (%s) - stops fall back to the task loop",
+                shotGroupConfig(group).name);
+    }
+  }
+}
+
+void relayControlNotify(TaskHandle_t task, uint32_t bits)
+{
+  cutNotifyBits = bits;
+  cutNotifyTask = task;
+}
+
+void relayControlSet(bool high, uint8_t group)
+{
+  RelayChannel &ch = channelFor(group);
+  bool changed = false;
+  int64_t edgeUs = 0;
+  portENTER_CRITICAL(&relayMux);
+  if (!high)
+  {
+    ch.armed = false;
+    ch.cutFired = false;
+  }
+  if (!(high && ch.cutFired) && ch.state != high)
+  {
+    ch.state = high;
+    relayWrite(ch, high);
+    edgeUs = esp_timer_get_time();
+    changed = true;
+  }
+  portEXIT_CRITICAL(&relayMux);
+
+  if (!high && ch.cutTimer != NULL)
+    esp_timer_stop(ch.cutTimer);  // Not running is fine
+  if (changed)
+  {
+    shotEventsRecord(SHOT_EVENT_RELAY, ch.group, high ? SHOT_EVENT_RELAY_ON : 0, 0, 0, edgeUs);
+    LOG_DEBUG(TAG, "Relay%u -> %s", (unsigned)group + 1, high ? "HIGH" : "LOW");
+  }
+}
+
+void relayControlScheduleOff(int64_t atUs, uint8_t group)
+{
+  RelayChannel &ch = channelFor(group);
+  if (ch.cutTimer == NULL)
+    return;
+
+  esp_timer_stop(ch.cutTimer);
+  int64_t delayUs = atUs - esp_timer_get_time();
+  if (delayUs < 0)
+    delayUs = 0;
+
+  portENTER_CRITICAL(&relayMux);
+  ch.armed = !ch.cutFired;
+  ch.cutAtUs = atUs;
+  portEXIT_CRITICAL(&relayMux);
+
+  if (ch.armed)
+    esp_timer_start_once(ch.cutTimer, (uint64_t)delayUs);
+}
+
+void relayControlCancel(uint8_t group)
+{
+  RelayChannel &ch = channelFor(group);
+  if (ch.cutTimer != NULL)
+    esp_timer_stop(ch.cutTimer);
+  portENTER_CRITICAL(&relayMux);
+  ch.armed = false;
+  portEXIT_CRITICAL(&relayMux);
+}
+
+bool relayControlState(uint8_t group)
+{
+  return channelFor(group).state;
+}
+
+bool relayControlCutPending(int64_t *atUs, uint8_t group)
+{
+  RelayChannel &ch = channelFor(group);
+  portENTER_CRITICAL(&relayMux);
+  bool pending = ch.armed;
+  if (atUs != NULL)
+    *atUs = ch.cutAtUs;
+  portEXIT_CRITICAL(&relayMux);
+  return pending;
+}
+
+bool relayControlCutFired(int64_t *firedUs, uint8_t group)
+{
+  RelayChannel &ch = channelFor(group);
+  portENTER_CRITICAL(&relayMux);
+  bool fired = ch.cutFired;
+  if (firedUs != NULL)
+    *firedUs = ch.cutFiredUs;
+  portEXIT_CRITICAL(&relayMux);
+  return fired;
+}
+
+bool relayControlVerify(uint8_t group)
+{
+  RelayChannel &ch = channelFor(group);
+  if (ch.pin < 0)
+    return false;
+  unsigned long now = millis();
+  if (now - ch.lastVerify < RELAY_VERIFY_MS)
+    return false;
+  ch.lastVerify = now;
+
+  bool corrected = false;
+  bool wanted;
+  portENTER_CRITICAL(&relayMux);
+  wanted = ch.state;
+  if ((digitalRead(ch.pin) == HIGH) != wanted)
+  {
+    relayWrite(ch, wanted);
+    corrected = true;
+  }
+  portEXIT_CRITICAL(&relayMux);
+
+  if (corrected)
+    LOG_WARN(TAG, "Relay%u pin disagreed with its state, forced %s", (unsigned)group + 1, wanted ? "HIGH" : "LOW");
+  return corrected;
+}
@@ -0,0 +1,83 @@
+#ifndef RELAY_CONTROL_H
+#define RELAY_CONTROL_H
+
+// =============================================================================
+// Pump Relay Control with Timer-Scheduled Cut-Off
+// =============================================================================
+// The relay used to be switched from task loops: the stop landed on whatever
+// tick noticed the predicted end, and every pass re-read the GPIO to decide
+// whether to write it. Now:
+//
+//   - relayControlSet() writes the pin only when the wanted state changes;
+//     the state is cached, so repeated calls cost a compare and no GPIO read.
+//   - relayControlScheduleOff() arms a one-shot esp_timer at an absolute
+//     esp_timer time. The callback cuts the relay at that instant (esp_timer
+//     task, ~tens of us jitter) and latches the cut: relayControlSet(true) is
+//     ignored until the owner acknowledges the stop with relayControlSet(false).
+//     Re-arming moves the deadline, so the shot predictor can refine it on
+//     every sample.
+//   - relayControlVerify() re-reads the pin at most every RELAY_VERIFY_MS and
+//     repairs a mismatch (brown-out, stray write).
+//
+// One channel per brew group (shot_group.h), each with its own pin, latch
+// and cut-off timer. Every call takes the group last, defaulting to group 0.
+//
+// Thread Safety:
+//   Any task - state changes are under a spinlock (control task on Core 0, the
+//   flush cycle on Core 1, the timer callback in the esp_timer task).
+// =============================================================================
+
+#include <Arduino.h>
+#include "shot_group.h"
+
+constexpr uint32_t RELAY_VERIFY_MS = 1000;
+
+/**
+ * @brief Configure the group's pin (starts LOW) and create its cut-off timer
+ */
+void relayControlBegin(int pin, uint8_t group = 0);
+
+/**
+ * @brief Wake `task` with `bits` (xTaskNotify eSetBits) when a scheduled cut fires, any group
+ */
+void relayControlNotify(TaskHandle_t task, uint32_t bits);
+
+/**
+ * @brief Set the relay now; LOW also cancels a pending cut and clears the latch
+ */
+void relayControlSet(bool high, uint8_t group = 0);
+
+/**
+ * @brief Cut the relay at esp_timer time atUs (replaces a pending cut)
+ */
+void relayControlScheduleOff(int64_t atUs, uint8_t group = 0);
+
+/**
+ * @brief Drop a pending cut that has not fired
+ */
+void relayControlCancel(uint8_t group = 0);
+
+/**
+ * @brief Cached relay state (no GPIO read)
+ */
+bool relayControlState(uint8_t group = 0);
+
+/**
+ * @brief True while a scheduled cut is armed and has not fired
+ * @param atUs Optional, esp_timer time it will fire
+ */
+bool relayControlCutPending(int64_t *atUs, uint8_t group = 0);
+
+/**
+ * @brief True once a scheduled cut fired, until relayControlSet(false)
+ * @param firedUs Optional, esp_timer time the cut happened
+ */
+bool relayControlCutFired(int64_t *firedUs, uint8_t group = 0);
+
+/**
+ * @brief Rate-limited pin read-back; rewrites the pin if it disagrees
+ * @return true if the pin had to be corrected
+ */
+bool relayControlVerify(uint8_t group = 0);
+
+#endif // RELAY_CONTROL_H
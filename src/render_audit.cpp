@@ -0,0 +1,201 @@
+// =============================================================================
+// Render Cost Audit Implementation
+// =============================================================================
+
+#include "render_audit.h"
+#include "esp_timer.h"
+#include <ui.h>
+
+struct NamedObject {
+  lv_obj_t **obj;
+  const char *name;
+};
+
+// SquareLine objects worth naming (containers print as their class)
+static const NamedObject NAMES[] = {
+  {&ui_FlushButton, "FlushButton"}, {&ui_FlushImage, "FlushImage"}, {&ui_FlushLabel, "FlushLabel"},
+  {&ui_StartButton, "StartButton"}, {&ui_StartImage, "StartImage"}, {&ui_StartLabel, "StartLabel"},
+  {&ui_StopButton, "StopButton"}, {&ui_StopImage, "StopImage"}, {&ui_StopLabel, "StopLabel"},
+  {&ui_Panel1, "Panel1"}, {&ui_TimerImage, "TimerImage"}, {&ui_TimerLabel, "TimerLabel"},
+  {&ui_TimerPrefixLabel, "TimerPrefixLabel"}, {&ui_TimerResetButton, "TimerResetButton"}, {&ui_TimerResetImage, "TimerResetImage"},
+  {&ui_ScaleImage, "ScaleImage"}, {&ui_ScaleLabel, "ScaleLabel"}, {&ui_ScalePrefixLabel, "ScalePrefixLabel"},
+  {&ui_ScaleResetButton, "ScaleResetButton"}, {&ui_ScaleResetImage, "ScaleResetImage"}, {&ui_SerialImage, "SerialImage"},
+  {&ui_SerialPrefixLabel, "SerialPrefixLabel"}, {&ui_SerialLabel, "SerialLabel"},
+  {&ui_GoToSettingButton, "GoToSettingButton"}, {&ui_BluetoothImage1, "BluetoothImage1"},
+  {&ui_Panel2, "Panel2"}, {&ui_BacklightImage, "BacklightImage"}, {&ui_BacklightSlider, "BacklightSlider"},
+  {&ui_BacklightLabel, "BacklightLabel"}, {&ui_ScaleSlider, "ScaleSlider"}, {&ui_ScaleImage1, "ScaleImage1"},
+  {&ui_PresetWeightSlight, "PresetWeightSlider"}, {&ui_PresetWeightLabel, "PresetWeightLabel"},
+  {&ui_SerialImage1, "SerialImage1"}, {&ui_SerialPrefixLabel1, "SerialPrefixLabel1"},
+  {&ui_SerialLabel1, "SerialLabel1"}, {&ui_ReturnFromSettingButton, "ReturnButton"},
+  {&ui_BluetoothImage2, "BluetoothImage2"},
+};
+
+struct ClassName {
+  const lv_obj_class_t *cls;
+  const char *name;
+};
+
+static const ClassName CLASSES[] = {
+  {&lv_btn_class, "btn"}, {&lv_label_class, "label"}, {&lv_img_class, "img"},
+#if LV_USE_SLIDER
+  {&lv_slider_class, "slider"},
+#endif
+#if LV_USE_BAR
+  {&lv_bar_class, "bar"},
+#endif
+#if LV_USE_ARC
+  {&lv_arc_class, "arc"},
+#endif
+#if LV_USE_CHART
+  {&lv_chart_class, "chart"},
+#endif
+#if LV_USE_SWITCH
+  {&lv_switch_class, "switch"},
+#endif
+  {&lv_obj_class, "obj"},
+};
+
+struct ScreenTotals {
+  uint32_t objects;
+  uint32_t shadows;
+  uint32_t gradients;
+  uint32_t transitions;
+  int32_t shadowCacheNeeded;   // Largest shadow_width + radius
+  uint32_t gradCacheNeeded;    // Bytes for every gradient map at once
+};
+
+static Print *volatile requestOut = NULL;
+
+static const char *objectName(lv_obj_t *obj)
+{
+  for (const NamedObject &n : NAMES) {
+    if (*n.obj == obj)
+      return n.name;
+  }
+  for (const ClassName &c : CLASSES) {
+    if (lv_obj_check_type(obj, c.cls))
+      return c.name;
+  }
+  return "?";
+}
+
+static void flushNop(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_p)
+{
+  (void)area;
+  (void)color_p;
+  lv_disp_flush_ready(drv);
+}
+
+static uint32_t redrawUs(lv_obj_t *obj)
+{
+  lv_disp_t *disp = lv_disp_get_default();
+  uint32_t best = UINT32_MAX;
+  for (uint8_t i = 0; i < RENDER_AUDIT_REPEATS; i++) {
+    lv_obj_invalidate(obj);
+    int64_t start = esp_timer_get_time();
+    lv_refr_now(disp);
+    uint32_t us = (uint32_t)(esp_timer_get_time() - start);
+    if (us < best)
+      best = us;
+  }
+  return best;
+}
+
+static void auditObject(Print &out, lv_obj_t *obj, uint8_t depth, ScreenTotals &totals)
+{
+  if (lv_obj_has_flag(obj, LV_OBJ_FLAG_HIDDEN) || depth > RENDER_AUDIT_MAX_DEPTH)
+    return;
+  lv_area_t a;
+  lv_obj_get_coords(obj, &a);
+  int32_t w = lv_area_get_width(&a);
+  int32_t h = lv_area_get_height(&a);
+  if (w <= 0 || h <= 0)
+    return;
+
+  totals.objects++;
+  lv_coord_t radius = lv_obj_get_style_radius(obj, LV_PART_MAIN);
+  lv_coord_t shadow = lv_obj_get_style_shadow_width(obj, LV_PART_MAIN);
+  bool shadowDrawn = shadow > 0 && lv_obj_get_style_shadow_opa(obj, LV_PART_MAIN) > LV_OPA_MIN;
+  lv_grad_dir_t grad = lv_obj_get_style_bg_grad_dir(obj, LV_PART_MAIN);
+  bool gradDrawn = grad != LV_GRAD_DIR_NONE && lv_obj_get_style_bg_opa(obj, LV_PART_MAIN) > LV_OPA_MIN;
+  bool translucent = lv_obj_get_style_opa(obj, LV_PART_MAIN) < LV_OPA_COVER;
+  bool transition = lv_obj_get_style_transition(obj, LV_PART_MAIN) != NULL;
+
+  if (shadowDrawn) {
+    totals.shadows++;
+    int32_t r = LV_MIN(radius, LV_MIN(w, h) / 2);  // LV_RADIUS_CIRCLE clamps to the short side
+    int32_t size = shadow + r;
+    if (size > totals.shadowCacheNeeded)
+      totals.shadowCacheNeeded = size;
+  }
+  if (gradDrawn) {
+    totals.gradients++;
+    int32_t mapLen = (grad == LV_GRAD_DIR_HOR) ? w : h;
+    totals.gradCacheNeeded += sizeof(lv_grad_t) + mapLen * sizeof(lv_grad_color_t);
+  }
+  if (transition)
+    totals.transitions++;
+
+  uint32_t us = redrawUs(obj);
+  out.printf("  %*s%-*s %4ld,%-4ld %4ldx%-4ld r%-3d %6lu%s%s%s%s\n", depth * 2, "", 22 - depth * 2, objectName(obj),
+             (long)a.x1, (long)a.y1, (long)w, (long)h, (int)radius, (unsigned long)us,
+             shadowDrawn ? " shadow" : "", gradDrawn ? " gradient" : "", translucent ? " opa" : "",
+             transition ? " transition" : "");
+
+  uint32_t children = lv_obj_get_child_cnt(obj);
+  for (uint32_t i = 0; i < children; i++)
+    auditObject(out, lv_obj_get_child(obj, i), depth + 1, totals);
+}
+
+static void auditScreen(Print &out, lv_disp_t *disp, lv_obj_t *screen, const char *name)
+{
+  if (screen == NULL)
+    return;
+  disp->act_scr = screen;  // No lv_scr_load(): SquareLine's screen events stay quiet
+  lv_obj_update_layout(screen);
+
+  ScreenTotals totals = {};
+  out.printf("[Render] %s: full refresh %luus\n", name, (unsigned long)redrawUs(screen));
+  out.println("  object                  x,y       size      radius   redraw us  features");
+  uint32_t children = lv_obj_get_child_cnt(screen);
+  for (uint32_t i = 0; i < children; i++)
+    auditObject(out, lv_obj_get_child(screen, i), 0, totals);
+
+  out.printf("  %lu objects, %lu shadows, %lu gradients, %lu with transitions (LV_THEME_DEFAULT_TRANSITION_TIME %d ms)\n",
+             (unsigned long)totals.objects, (unsigned long)totals.shadows, (unsigned long)totals.gradients,
+             (unsigned long)totals.transitions, (int)LV_THEME_DEFAULT_TRANSITION_TIME);
+  out.printf("  caches: LV_SHADOW_CACHE_SIZE %ld needed (%d built), LV_GRAD_CACHE_DEF_SIZE %lu needed (%d built)\n",
+             (long)totals.shadowCacheNeeded, (int)LV_SHADOW_CACHE_SIZE, (unsigned long)totals.gradCacheNeeded,
+             (int)LV_GRAD_CACHE_DEF_SIZE);
+}
+
+void renderAuditRequest(Print &out)
+{
+  requestOut = &out;
+  out.println("[Render] audit queued for the UI task");
+}
+
+void renderAuditService(lv_disp_drv_t *drv)
+{
+  Print *out = requestOut;
+  if (out == NULL)
+    return;
+  requestOut = NULL;
+
+  // A real flush may still be on the wire - let it complete before swapping flush_cb
+  unsigned long waitStart = millis();
+  while (drv->draw_buf->flushing && millis() - waitStart < 200)
+    delay(1);
+
+  lv_disp_t *disp = lv_disp_get_default();
+  lv_obj_t *active = disp->act_scr;
+  void (*flush)(lv_disp_drv_t *, const lv_area_t *, lv_color_t *) = drv->flush_cb;
+  drv->flush_cb = flushNop;
+
+  auditScreen(*out, disp, ui_MainScreen, "MainScreen");
+  auditScreen(*out, disp, ui_SettingScreen, "SettingScreen");
+
+  disp->act_scr = active;
+  drv->flush_cb = flush;
+  lv_obj_invalidate(active);  // The panel still shows the frame from before the audit
+}
@@ -0,0 +1,49 @@
+#ifndef RENDER_AUDIT_H
+#define RENDER_AUDIT_H
+
+// =============================================================================
+// Render Cost Audit (per-object redraw cost of the SquareLine screens)
+// =============================================================================
+// "bench render" on the console queues an audit; the UI task runs it on its
+// next pass (it owns LVGL). For ui_MainScreen and ui_SettingScreen it
+// prints the full-screen refresh cost, then one row per visible object:
+//
+//   - redraw µs  lv_obj_invalidate(obj) + lv_refr_now(), best of
+//                RENDER_AUDIT_REPEATS - what one change of that object
+//                costs, everything behind and on top of it included
+//   - area, radius, and the features that make a draw expensive: shadow
+//     (width + radius = cache size it needs), gradient, opacity < cover,
+//     style transition
+//
+// It ends with the LV_SHADOW_CACHE_SIZE / LV_GRAD_CACHE_DEF_SIZE each screen
+// needs to cache every shadow and gradient it draws. The caches are
+// build-time settings (lv_conf.h, overridable with -D); with the dark default
+// theme and this UI both come out 0 - no shadow and no gradient is drawn -
+// so the audit is the check to re-run after a SquareLine change.
+//
+// Rendering goes to a no-op flush_cb: the panel keeps the current frame and
+// the active screen is invalidated afterwards. Screens are swapped by
+// setting act_scr directly, so no SquareLine screen events fire.
+//
+// Thread Safety:
+//   renderAuditRequest() - any task. renderAuditService() - UI task only.
+// =============================================================================
+
+#include <Arduino.h>
+#include "lvgl.h"
+
+constexpr uint8_t RENDER_AUDIT_REPEATS   = 3;
+constexpr uint8_t RENDER_AUDIT_MAX_DEPTH = 8;
+
+/**
+ * @brief Ask the UI task to run the audit and print it on `out`
+ */
+void renderAuditRequest(Print &out);
+
+/**
+ * @brief Run a requested audit (call once per UI task pass)
+ * @param drv Registered display driver (flush_cb swapped for the duration)
+ */
+void renderAuditService(lv_disp_drv_t *drv);
+
+#endif // RENDER_AUDIT_H
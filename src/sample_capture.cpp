@@ -0,0 +1,154 @@
+// =============================================================================
+// Raw Sample Capture Implementation
+// =============================================================================
+
+#include "sample_capture.h"
+#include "debug_config.h"
+#include "console.h"
+#include "metrics.h"
+#include "mem_caps.h"
+
+static constexpr LogTag TAG = LOG_TAG_SHOT;
+
+constexpr uint8_t FRAME_OVERHEAD = 5;   // Sync, len, type, xor
+constexpr uint8_t FRAMES_PER_WRITE = 8;
+
+static MetricCounter captureWritten("capture_records_total", "Raw sample records taken into the capture ring");
+static MetricCounter captureDropped("capture_dropped_total", "Raw sample records lost to a full capture ring");
+static MetricCounter captureSent("capture_frames_sent_total", "Capture frames handed to USB CDC");
+static MetricCounter captureStalls("capture_stalls_total", "Drain passes with records queued and no room in the USB buffer");
+
+static CaptureSample *ring = NULL;
+static volatile uint32_t head = 0;   // Next write (control task)
+static volatile uint32_t tail = 0;   // Next send (drain task)
+static volatile bool active = false;
+static uint32_t seq = 0;
+static uint32_t lastStatsMs = 0;
+static bool statsPending = false;    // A STATS frame waits for room
+
+bool sampleCaptureStart()
+{
+  if (ring == NULL)
+    ring = (CaptureSample *)memCapsAlloc(SAMPLE_CAPTURE_RECORDS * sizeof(CaptureSample), MEM_PSRAM_FIRST,
+                                         MEM_OWNER_SAMPLE_CAPTURE);
+  if (ring == NULL)
+    return false;
+  statsPending = true;   // Baseline counters before the first record
+  active = true;
+  LOG_INFO(TAG, "📈 Sample capture on - binary frames on USB (tools/sample_capture/capture_csv.py)");
+  return true;
+}
+
+void sampleCaptureStop()
+{
+  if (!active)
+    return;
+  active = false;
+  statsPending = true;   // Final counters after the last record
+  LOG_INFO(TAG, "📈 Sample capture off: %lu records, %lu dropped", (unsigned long)captureWritten.value(),
+           (unsigned long)captureDropped.value());
+}
+
+bool sampleCaptureActive()
+{
+  return active;
+}
+
+void sampleCaptureRecord(CaptureSample &sample)
+{
+  if (!active)
+    return;
+  sample.seq = seq++;
+  uint32_t h = head;
+  if (h - __atomic_load_n(&tail, __ATOMIC_ACQUIRE) >= SAMPLE_CAPTURE_RECORDS) {
+    captureDropped.add();
+    return;
+  }
+  ring[h % SAMPLE_CAPTURE_RECORDS] = sample;
+  __atomic_store_n(&head, h + 1, __ATOMIC_RELEASE);
+  captureWritten.add();
+}
+
+static size_t frame(uint8_t *out, CaptureFrameType type, const void *payload, uint8_t len)
+{
+  out[0] = CAPTURE_SYNC0;
+  out[1] = CAPTURE_SYNC1;
+  out[2] = len;
+  out[3] = type;
+  memcpy(out + 4, payload, len);
+  uint8_t x = type;
+  for (uint8_t i = 0; i < len; i++)
+    x ^= out[4 + i];
+  out[4 + len] = x;
+  return FRAME_OVERHEAD + len;
+}
+
+bool sampleCapturePending()
+{
+  if (active && millis() - lastStatsMs >= SAMPLE_CAPTURE_STATS_MS)
+    statsPending = true;
+  return statsPending || __atomic_load_n(&head, __ATOMIC_ACQUIRE) != tail;
+}
+
+bool sampleCaptureDrain(Print &out)
+{
+  uint32_t now = millis();
+  uint32_t t = tail;
+  uint32_t h = __atomic_load_n(&head, __ATOMIC_ACQUIRE);
+  if (h == t && !statsPending)
+    return false;
+
+  uint8_t buffer[FRAMES_PER_WRITE * (FRAME_OVERHEAD + sizeof(CaptureSample))];
+  size_t room = (size_t)max(out.availableForWrite(), 0);
+  size_t used = 0;
+  uint32_t frames = 0;
+  if (statsPending && room >= FRAME_OVERHEAD + sizeof(CaptureStats)) {
+    CaptureStats stats = {now, captureWritten.value(), captureDropped.value(), captureSent.value()};
+    used += frame(buffer, CAPTURE_FRAME_STATS, &stats, sizeof(stats));
+    statsPending = false;
+    lastStatsMs = now;
+    frames++;
+  }
+  // Whole frames only - a frame cut by a full buffer would cost the host a resync
+  while (t != h && used + FRAME_OVERHEAD + sizeof(CaptureSample) <= min(room, sizeof(buffer))) {
+    used += frame(buffer + used, CAPTURE_FRAME_SAMPLE, &ring[t % SAMPLE_CAPTURE_RECORDS], sizeof(CaptureSample));
+    t++;
+    frames++;
+  }
+  if (used == 0) {
+    captureStalls.add();
+    return false;
+  }
+  out.write(buffer, used);
+  __atomic_store_n(&tail, t, __ATOMIC_RELEASE);
+  captureSent.add(frames);
+  return true;
+}
+
+void sampleCaptureDump(Print &out)
+{
+  uint32_t queued = head - tail;
+  out.printf("[Capture] %s, %lu / %lu records queued (%s)\n", active ? "on" : "off", (unsigned long)queued,
+             (unsigned long)SAMPLE_CAPTURE_RECORDS, ring != NULL ? "ring in memory" : "no ring yet");
+  out.printf("  records %lu, dropped %lu, frames sent %lu, USB full %lu times\n", (unsigned long)captureWritten.value(),
+             (unsigned long)captureDropped.value(), (unsigned long)captureSent.value(),
+             (unsigned long)captureStalls.value());
+}
+
+static void cmdCapture(ConsoleArgs &args)
+{
+  if (args.is(1, "on")) {
+    if (!sampleCaptureStart()) {
+      args.out.println("[Capture] No memory for the ring");
+      return;
+    }
+  } else if (args.is(1, "off")) {
+    sampleCaptureStop();
+  } else if (args.argc > 1) {
+    args.out.println("Usage: capture [on|off]");
+    return;
+  }
+  sampleCaptureDump(args.out);
+}
+
+static ConsoleCommand captureCommand("capture", "[on|off]", "Binary raw sample + filter records on USB for the lab (capture_csv.py)", cmdCapture);
@@ -0,0 +1,115 @@
+#ifndef SAMPLE_CAPTURE_H
+#define SAMPLE_CAPTURE_H
+
+// =============================================================================
+// Raw Sample Capture (binary records over USB CDC)
+// =============================================================================
+// Extraction curves for the lab used to come from the "%.2fg" LOG_VERBOSE
+// lines - text, throttled to one per 100 ms, filter state only every print.
+// "capture on" streams one fixed record per weight sample instead, every
+// sample the control task takes, with the filter state after it:
+//
+//   control task ──► record into a PSRAM ring (SAMPLE_CAPTURE_RECORDS,
+//                    single producer / single consumer, no lock)
+//   log drain task ──► whole frames into the USB CDC buffer, as many as it
+//                      has room for - never waits for the host
+//
+// Backpressure: a slow or absent host leaves records in the ring; a full
+// ring drops new ones and counts them. Every record carries a sequence
+// number and a STATS frame goes out every SAMPLE_CAPTURE_STATS_MS, so drops
+// are visible in the capture itself. Frames go to USB Serial only and
+// interleave with text (and GS_LOG_BINARY) output; the host tool skips what
+// is not a capture frame:
+//
+//   frame:  A5 C5 | len | type | payload (len bytes) | xor (type..payload)
+//   SAMPLE  CaptureSample below (little endian)
+//   STATS   CaptureStats: ms, records written, dropped, frames sent
+//
+// tools/sample_capture/capture_csv.py turns a capture into CSV.
+//
+// Thread Safety:
+//   sampleCaptureRecord() - control task only. sampleCapturePending() /
+//   sampleCaptureDrain() - log drain task only, the latter with serialMutex
+//   held. sampleCaptureStart() / Stop() from the console.
+// =============================================================================
+
+#include <Arduino.h>
+
+constexpr uint32_t SAMPLE_CAPTURE_RECORDS  = 1024;   // ~100 s at 10 Hz without a host
+constexpr uint32_t SAMPLE_CAPTURE_STATS_MS = 1000;
+constexpr uint8_t  CAPTURE_SYNC0           = 0xA5;
+constexpr uint8_t  CAPTURE_SYNC1           = 0xC5;   // Not GS_LOG_BINARY's 0x5A
+
+enum CaptureFrameType : uint8_t {
+  CAPTURE_FRAME_SAMPLE = 1,
+  CAPTURE_FRAME_STATS  = 2,
+};
+
+// CaptureSample::flags
+constexpr uint8_t CAPTURE_FLAG_BREWING      = 0x01;
+constexpr uint8_t CAPTURE_FLAG_DRIPPED      = 0x02;
+constexpr uint8_t CAPTURE_FLAG_FLOWING      = 0x04;
+constexpr uint8_t CAPTURE_FLAG_LOAD_CELL    = 0x08;   // Wired cell sample, not a BLE notification
+constexpr uint8_t CAPTURE_FLAG_ANOMALY_SHIFT = 4;     // FLOW_ANOMALY_* in the high bits
+
+struct __attribute__((packed)) CaptureSample {
+  uint32_t seq;            // Set by sampleCaptureRecord()
+  int64_t arrivalUs;       // esp_timer at the notification / ready edge
+  int32_t clockOffsetUs;   // Sample clock time - arrival (sample_clock.h)
+  float rawG;              // As the scale / cell reported it
+  float shotS;             // Since pump-on, NAN outside a shot
+  float filteredG;         // WeightFilter after this sample
+  float flowGs;
+  float weightSdG;
+  float expectedEndS;      // calculateEndTime(), 0 outside a shot
+  uint8_t flags;           // CAPTURE_FLAG_*
+  uint8_t reserved[3];
+};
+
+struct __attribute__((packed)) CaptureStats {
+  uint32_t ms;
+  uint32_t written;        // Records taken into the ring
+  uint32_t dropped;        // Records lost to a full ring
+  uint32_t sent;           // Frames handed to USB CDC
+};
+
+static_assert(sizeof(CaptureSample) == 44, "CaptureSample is a wire format");
+
+/**
+ * @brief Allocate the ring (first time) and start capturing
+ * @return false if the ring could not be allocated
+ */
+bool sampleCaptureStart();
+
+/**
+ * @brief Stop capturing; queued records still go out
+ */
+void sampleCaptureStop();
+
+/**
+ * @brief Capture running - callers skip building records otherwise
+ */
+bool sampleCaptureActive();
+
+/**
+ * @brief Queue one sample record (control task); dropped and counted when the ring is full
+ */
+void sampleCaptureRecord(CaptureSample &sample);
+
+/**
+ * @brief Records or a STATS frame waiting (log drain task, before it takes serialMutex)
+ */
+bool sampleCapturePending();
+
+/**
+ * @brief Frames for the queued records, as many as `out` takes without blocking (log drain task)
+ * @return true if anything was written
+ */
+bool sampleCaptureDrain(Print &out);
+
+/**
+ * @brief State, ring fill and counters
+ */
+void sampleCaptureDump(Print &out);
+
+#endif // SAMPLE_CAPTURE_H
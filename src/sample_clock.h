@@ -0,0 +1,137 @@
+#ifndef SAMPLE_CLOCK_H
+#define SAMPLE_CLOCK_H
+
+// =============================================================================
+// Scale Sample Clock: jitter-free sample times from arrival timestamps
+// =============================================================================
+// The scale samples its load cell on its own fixed clock, but a reading is
+// only seen here when the notification arrives: a connection interval of
+// BLE latency plus the stack, and both wander from packet to packet. Dated by
+// arrival, a 100 ms sample stream shows 80-120 ms intervals, and the trend
+// line reads that jitter as flow noise.
+//
+// Weight frames carry no timer or sequence number (the Acaia timer event has
+// 0.1 s resolution and only runs with the shot timer), so the sample index
+// is rebuilt from the arrival times instead:
+//
+//   arrival ──► grid index (base + n * period) ──► sample time = grid point
+//
+//   - Learn: the period is the mean interval over the first
+//     CLOCK_LEARN_SAMPLES packets; arrival times pass through until then.
+//   - Index: a packet advances the grid by the whole periods since the last
+//     grid point, rounding only once a packet is CLOCK_STEP_LATE_PCT % of a
+//     period late - so a late packet is not read as a lost one, while a real
+//     gap (lost packet, full queue) still skips its grid points. Frames that
+//     share one notification get consecutive points.
+//   - Lock: latency only ever adds, so the least delayed packet of each
+//     CLOCK_BLOCK_SAMPLES is the best view of the scale's clock. Its phase
+//     error moves the grid (CLOCK_PHASE_GAIN) and, spread over the block,
+//     the period (CLOCK_SKEW_GAIN) - that follows the skew between the
+//     scale's crystal and esp_timer.
+//   - A gap over CLOCK_RESET_US (reconnect) starts over.
+//
+// Sample times stay in esp_timer microseconds, at or a little before the
+// arrival, so they line up with everything else timed here. O(1) per packet.
+//
+// Not thread safe - keep each instance on one task (the shot control task).
+// =============================================================================
+
+#include <Arduino.h>
+
+constexpr uint8_t  CLOCK_LEARN_SAMPLES = 16;       // Intervals averaged into the first period
+constexpr uint8_t  CLOCK_STEP_LATE_PCT = 75;       // Later than this (% of a period) = next grid point
+constexpr float    CLOCK_EARLY_GAIN    = 0.5f;     // Grid moves this share toward an early packet
+constexpr float    CLOCK_LATE_GAIN     = 1.0f / 64; // ... and this share toward a late one
+constexpr float    CLOCK_SKEW_GAIN     = 1.0f / 32; // Share of each correction that goes into the period
+constexpr float    CLOCK_MAX_SKEW      = 0.05f;    // Period drifting further from the learned one = lost lock
+constexpr int64_t  CLOCK_RESET_US      = 2000000;  // No packet for this long = a new stream
+constexpr float    CLOCK_MIN_PERIOD_US = 5000.0f;  // Faster than 200 Hz is not a sample stream
+
+class SampleClock {
+public:
+  SampleClock() { reset(); }
+
+  void reset()
+  {
+    started = false;
+    learned = 0;
+    period = learnedPeriod = 0.0f;
+    firstUs = lastArrivalUs = lastOutUs = gridUs = 0;
+    lateUs = 0.0f;
+  }
+
+  /**
+   * @brief Sample time (esp_timer us) of a packet that arrived at arrivalUs
+   */
+  int64_t update(int64_t arrivalUs)
+  {
+    if (!started || arrivalUs - lastArrivalUs > CLOCK_RESET_US)
+      return restart(arrivalUs);
+
+    if (period == 0.0f)
+      return learn(arrivalUs);
+    lastArrivalUs = arrivalUs;
+
+    // Whole periods since the last grid point, counting a late packet as the next one
+    float ahead = (float)(arrivalUs - gridUs) / period;
+    int32_t steps = (int32_t)floorf(ahead + (100 - CLOCK_STEP_LATE_PCT) / 100.0f);
+    gridUs += (int64_t)(((steps < 1) ? 1 : steps) * period);
+
+    // Steer the grid onto the least delayed packets: fast toward early ones, slowly toward late ones
+    float late = (float)(arrivalUs - gridUs);
+    float correction = late * ((late < 0.0f) ? CLOCK_EARLY_GAIN : CLOCK_LATE_GAIN);
+    gridUs += (int64_t)correction;
+    period += correction * CLOCK_SKEW_GAIN;
+    lateUs += (late - lateUs) / 16.0f;
+    if (fabsf(period - learnedPeriod) > learnedPeriod * CLOCK_MAX_SKEW)
+      return restart(arrivalUs);   // Locked onto something else (a changed rate) - learn again
+
+    // Never backwards, never after the arrival
+    int64_t out = min(gridUs, arrivalUs);
+    return lastOutUs = max(out, lastOutUs + 1);
+  }
+
+  /** @brief Period is known and the grid runs */
+  bool locked() const { return period > 0.0f; }
+
+  /** @brief Learned sample period (us), 0 = still learning */
+  float periodUs() const { return period; }
+
+  /** @brief Average arrival delay over the grid (us) - the jitter taken out */
+  float lateAvgUs() const { return lateUs; }
+
+private:
+  int64_t restart(int64_t arrivalUs)
+  {
+    reset();
+    started = true;
+    firstUs = lastArrivalUs = arrivalUs;
+    return lastOutUs = arrivalUs;
+  }
+
+  // Arrival times pass through while the first period is measured
+  int64_t learn(int64_t arrivalUs)
+  {
+    lastArrivalUs = arrivalUs;
+    if (++learned < CLOCK_LEARN_SAMPLES)
+      return lastOutUs = max(arrivalUs, lastOutUs + 1);
+    float mean = (float)(arrivalUs - firstUs) / learned;
+    if (mean < CLOCK_MIN_PERIOD_US)
+      return restart(arrivalUs);   // Bursts, not a sample stream - try again
+    period = learnedPeriod = mean;
+    gridUs = arrivalUs;
+    return lastOutUs = max(arrivalUs, lastOutUs + 1);
+  }
+
+  bool started;
+  uint8_t learned;       // Intervals seen while learning
+  float period;          // us, 0 = learning
+  float learnedPeriod;   // First estimate, the reference for CLOCK_MAX_SKEW
+  int64_t firstUs;       // First arrival (learning)
+  int64_t lastArrivalUs;
+  int64_t lastOutUs;
+  int64_t gridUs;        // Grid point of the last packet
+  float lateUs;          // EWMA of the delay over the grid
+};
+
+#endif // SAMPLE_CLOCK_H
@@ -0,0 +1,130 @@
+// =============================================================================
+// Scale Picker Implementation
+// =============================================================================
+
+#include "scale_picker.h"
+#include "debug_config.h"
+#include "screen_nav.h"
+#include "AcaiaArduinoBLE.h"
+#include <ui.h>
+
+static constexpr LogTag TAG = LOG_TAG_UI;
+
+static constexpr lv_coord_t LIST_WIDTH = 420;
+static constexpr lv_coord_t ROW_HEIGHT = 26;
+static constexpr uint8_t ANY_ROW = 0xFF;
+
+static lv_obj_t *settingsScreen = NULL;
+static lv_obj_t *screen = NULL;
+static lv_obj_t *rows[SCAN_MAX_CANDIDATES];
+static lv_obj_t *rowLabels[SCAN_MAX_CANDIDATES];
+static lv_obj_t *statusLabel = NULL;
+static AcaiaArduinoBLE *scale = NULL;
+static ScalePickerSelect selectCallback = NULL;
+static uint8_t generation = 0;   // Of the snapshot on screen
+
+static void loadCandidates()
+{
+  ScaleCandidate candidates[SCAN_MAX_CANDIDATES];
+  int count = scale->scaleCandidates(candidates, SCAN_MAX_CANDIDATES, &generation);
+  for (int i = 0; i < SCAN_MAX_CANDIDATES; i++) {
+    if (i >= count) {
+      lv_obj_add_flag(rows[i], LV_OBJ_FLAG_HIDDEN);
+      continue;
+    }
+    const ScaleCandidate &c = candidates[i];
+    unsigned long ageS = (millis() - c.seenMs) / 1000;
+    char text[80];
+    snprintf(text, sizeof(text), "%s %-16s %4d dBm  %lus ago%s%s", c.connected ? LV_SYMBOL_OK : "   ",
+             c.name, c.rssi, ageS, c.lastUsed ? "  last used" : "", c.failed ? "  failed" : "");
+    lv_label_set_text(rowLabels[i], text);
+    lv_obj_clear_flag(rows[i], LV_OBJ_FLAG_HIDDEN);
+  }
+  lv_label_set_text(statusLabel, count ? "Tap a scale to pin it" : "No scales seen yet - the list fills on the next scan");
+  LOG_DEBUG(TAG, "Scale picker: %d candidates (generation %u)", count, generation);
+}
+
+static void rowEvent(lv_event_t *e)
+{
+  uint8_t row = (uint8_t)(uintptr_t)lv_event_get_user_data(e);
+  selectCallback(((uint32_t)generation << 8) | row);
+  screenNavGo(settingsScreen, LV_SCR_LOAD_ANIM_MOVE_RIGHT);
+}
+
+static void backEvent(lv_event_t *e)
+{
+  (void)e;
+  screenNavGo(settingsScreen, LV_SCR_LOAD_ANIM_MOVE_RIGHT);
+}
+
+static lv_obj_t *rowButton(lv_obj_t *parent, uint8_t row, lv_obj_t **label)
+{
+  lv_obj_t *btn = lv_btn_create(parent);
+  lv_obj_set_size(btn, LIST_WIDTH, ROW_HEIGHT);
+  lv_obj_set_style_bg_color(btn, lv_color_hex(0x232323), LV_PART_MAIN | LV_STATE_DEFAULT);
+  lv_obj_set_style_pad_ver(btn, 0, LV_PART_MAIN);
+  lv_obj_add_event_cb(btn, rowEvent, LV_EVENT_CLICKED, (void *)(uintptr_t)row);
+  *label = lv_label_create(btn);
+  lv_obj_set_style_text_font(*label, &lv_font_montserrat_14, LV_PART_MAIN);
+  lv_obj_align(*label, LV_ALIGN_LEFT_MID, 0, 0);
+  return btn;
+}
+
+static void createScreen()
+{
+  screen = lv_obj_create(NULL);
+  lv_obj_clear_flag(screen, LV_OBJ_FLAG_SCROLLABLE);
+  lv_obj_set_style_bg_color(screen, lv_color_hex(0x000000), LV_PART_MAIN | LV_STATE_DEFAULT);
+
+  lv_obj_t *list = lv_obj_create(screen);
+  lv_obj_remove_style_all(list);
+  lv_obj_set_size(list, LIST_WIDTH, lv_pct(100));
+  lv_obj_align(list, LV_ALIGN_LEFT_MID, 8, 0);
+  lv_obj_set_flex_flow(list, LV_FLEX_FLOW_COLUMN);
+  lv_obj_set_flex_align(list, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_START);
+  lv_obj_set_style_pad_row(list, 3, LV_PART_MAIN);
+  lv_obj_clear_flag(list, LV_OBJ_FLAG_SCROLLABLE);
+
+  for (uint8_t i = 0; i < SCAN_MAX_CANDIDATES; i++)
+    rows[i] = rowButton(list, i, &rowLabels[i]);
+  lv_obj_t *anyLabel;
+  rowButton(list, ANY_ROW, &anyLabel);
+  lv_label_set_text(anyLabel, "    Any scale - remembered, else strongest signal");
+
+  statusLabel = lv_label_create(screen);
+  lv_obj_set_width(statusLabel, 160);
+  lv_obj_set_style_text_font(statusLabel, &lv_font_montserrat_14, LV_PART_MAIN);
+  lv_obj_align(statusLabel, LV_ALIGN_TOP_RIGHT, -8, 8);
+
+  lv_obj_t *back = lv_btn_create(screen);
+  lv_obj_set_size(back, 28, 28);
+  lv_obj_align(back, LV_ALIGN_BOTTOM_RIGHT, -1, -1);
+  lv_obj_set_style_bg_color(back, lv_color_hex(0x1A1A1A), LV_PART_MAIN | LV_STATE_DEFAULT);
+  lv_obj_set_style_bg_img_src(back, &ui_img_return_png, LV_PART_MAIN | LV_STATE_DEFAULT);
+  lv_obj_add_event_cb(back, backEvent, LV_EVENT_CLICKED, NULL);
+}
+
+static void enterEvent(lv_event_t *e)
+{
+  (void)e;
+  if (screen == NULL)
+    createScreen();
+  loadCandidates();
+  screenNavGo(screen, LV_SCR_LOAD_ANIM_MOVE_LEFT);
+}
+
+void scalePickerCreate(lv_obj_t *settings, AcaiaArduinoBLE *scaleDevice, ScalePickerSelect select)
+{
+  settingsScreen = settings;
+  scale = scaleDevice;
+  selectCallback = select;
+  lv_obj_t *btn = lv_btn_create(settings);
+  lv_obj_set_size(btn, 28, 28);
+  lv_obj_align(btn, LV_ALIGN_TOP_LEFT, 31, 1);
+  lv_obj_set_style_bg_color(btn, lv_color_hex(0x1A1A1A), LV_PART_MAIN | LV_STATE_DEFAULT);
+  lv_obj_set_style_pad_all(btn, 0, LV_PART_MAIN);
+  lv_obj_t *label = lv_label_create(btn);
+  lv_label_set_text(label, LV_SYMBOL_BLUETOOTH);
+  lv_obj_center(label);
+  lv_obj_add_event_cb(btn, enterEvent, LV_EVENT_CLICKED, NULL);
+}
@@ -0,0 +1,40 @@
+#ifndef SCALE_PICKER_H
+#define SCALE_PICKER_H
+
+// =============================================================================
+// Scale Picker (Settings Screen)
+// =============================================================================
+// With several scales on the bar the controller would connect to whichever
+// one advertised first. AcaiaArduinoBLE now ranks what an open scan finds
+// (remembered scale first, then RSSI) and keeps the list; this overlay on
+// the settings screen shows it and lets the user pin one:
+//
+//   ┌──────────────────────────────────────────────┐
+//   │ ● LUNAR-2A1B3C   -54 dBm  last used          │
+//   │   PEARLS-77E0    -71 dBm                     │
+//   │   Any scale - strongest signal               │
+//   └──────────────────────────────────────────────┘
+//
+// A tap hands (table generation, row) to `select`, which queues it for the
+// BLE task (AcaiaArduinoBLE::selectScale()); a list that changed in the
+// meantime is ignored there instead of picking the wrong scale. The pinned
+// scale is remembered in NVS and reconnected to right away.
+//
+// Thread Safety:
+//   UI task (Core 1) only - LVGL. The candidate snapshot is taken under
+//   AcaiaArduinoBLE's spinlock.
+// =============================================================================
+
+#include <Arduino.h>
+#include "lvgl.h"
+
+class AcaiaArduinoBLE;
+
+typedef void (*ScalePickerSelect)(uint32_t param);  // param = generation << 8 | (uint8_t)row, row 0xFF = any scale
+
+/**
+ * @brief Add the picker button to `settingsScreen` (after ui_init()); the overlay is built on first use
+ */
+void scalePickerCreate(lv_obj_t *settingsScreen, AcaiaArduinoBLE *scale, ScalePickerSelect select);
+
+#endif // SCALE_PICKER_H
@@ -0,0 +1,50 @@
+// =============================================================================
+// Screen Navigation Implementation
+// =============================================================================
+
+#include "screen_nav.h"
+#include "metrics.h"
+#include <ui.h>
+
+static MetricCounter switchesTotal("screen_switches_total", "Screen changes");
+static ScreenLoadHandler loadHandler = NULL;
+
+static void buttonHook(lv_event_t *e)
+{
+  if (lv_event_get_code(e) != LV_EVENT_CLICKED)
+    return;
+  lv_obj_t **target = (lv_obj_t **)lv_event_get_user_data(e);
+  bool forward = target == &ui_SettingScreen;
+  screenNavGo(*target, forward ? LV_SCR_LOAD_ANIM_MOVE_LEFT : LV_SCR_LOAD_ANIM_MOVE_RIGHT);
+  lv_event_stop_processing(e);  // SquareLine's _ui_screen_change() stays out
+}
+
+void screenNavBegin()
+{
+  lv_obj_update_layout(ui_MainScreen);
+  lv_obj_update_layout(ui_SettingScreen);  // First open finds its layout done
+  lv_obj_add_event_cb(ui_GoToSettingButton, buttonHook, (lv_event_code_t)(LV_EVENT_CLICKED | LV_EVENT_PREPROCESS),
+                      &ui_SettingScreen);
+  lv_obj_add_event_cb(ui_ReturnFromSettingButton, buttonHook,
+                      (lv_event_code_t)(LV_EVENT_CLICKED | LV_EVENT_PREPROCESS), &ui_MainScreen);
+}
+
+void screenNavSetLoadHandler(ScreenLoadHandler handler)
+{
+  loadHandler = handler;
+}
+
+void screenNavGo(lv_obj_t *screen, lv_scr_load_anim_t anim)
+{
+  if (screen == NULL || screen == lv_scr_act())
+    return;
+  switchesTotal.add();
+#if GS_SCREEN_ANIM
+  lv_scr_load_anim(screen, anim, SCREEN_NAV_ANIM_MS, 0, false);
+#else
+  (void)anim;
+  lv_scr_load(screen);
+#endif
+  if (loadHandler != NULL)
+    loadHandler(screen);
+}
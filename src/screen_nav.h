@@ -0,0 +1,58 @@
+#ifndef SCREEN_NAV_H
+#define SCREEN_NAV_H
+
+// =============================================================================
+// Screen Navigation (main ↔ settings ↔ history / scale picker)
+// =============================================================================
+// SquareLine's buttons change screens with a 100 ms MOVE_LEFT / MOVE_RIGHT
+// lv_scr_load_anim(). On this panel every animation frame is a full-width
+// redraw of both screens, so a slide costs several full frames of render and
+// flush - and a shot's weight / timer updates wait behind them.
+//
+// Both SquareLine screens are built by ui_init() and never deleted, with
+// their slider and label values set in setup() from the settings store.
+// screenNavBegin() lays both out once and puts a PREPROCESS CLICKED handler
+// on GoToSettingButton / ReturnFromSettingButton that calls screenNavGo() and
+// stops the event, so SquareLine's _ui_screen_change() never runs. The
+// history and scale picker screens go through screenNavGo() too.
+//
+// The load handler runs right after every switch, with the new screen
+// already lv_scr_act(), so widgets mirrored across screens (ui_model.h) are
+// in sync before the first frame of it is rendered.
+//
+// GS_SCREEN_ANIM (compile-time, -DGS_SCREEN_ANIM=<n>):
+//   0 - Instant swap: lv_scr_load(), one full frame of the new screen (default)
+//   1 - SquareLine's slides (SCREEN_NAV_ANIM_MS)
+//
+// Thread Safety:
+//   UI task (LVGL owner) only.
+// =============================================================================
+
+#include <Arduino.h>
+#include "lvgl.h"
+
+#ifndef GS_SCREEN_ANIM
+#define GS_SCREEN_ANIM 0
+#endif
+
+constexpr uint32_t SCREEN_NAV_ANIM_MS = 100;  // SquareLine's slide time (GS_SCREEN_ANIM 1)
+
+/**
+ * @brief Take over the SquareLine screen buttons, lay out the resident screens
+ * @note Call from setup() after ui_init()
+ */
+void screenNavBegin();
+
+typedef void (*ScreenLoadHandler)(lv_obj_t *screen);
+
+/**
+ * @brief Call `handler` after each screen switch (NULL = none)
+ */
+void screenNavSetLoadHandler(ScreenLoadHandler handler);
+
+/**
+ * @brief Show `screen`; `anim` is the slide used when GS_SCREEN_ANIM is 1
+ */
+void screenNavGo(lv_obj_t *screen, lv_scr_load_anim_t anim);
+
+#endif // SCREEN_NAV_H
@@ -0,0 +1,74 @@
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+// =============================================================================
+// Single-Writer Sequence Lock for Cross-Core Shared State
+// =============================================================================
+// Publishes a small POD struct from one writer task to any number of readers
+// without a mutex:
+//
+//   - The writer never blocks. It bumps the sequence to odd, updates the
+//     value, and bumps it back to even. The update runs inside a writer-only
+//     critical section, so it can't be preempted halfway and keep readers
+//     spinning (nobody else takes that spinlock, so it never contends).
+//   - Readers copy the value and retry if the sequence was odd or changed
+//     during the copy. They always get a consistent snapshot, never a
+//     "default" value because a lock timed out.
+//
+// Usage:
+//   SeqLock<State> shared(initialState);
+//   shared.update([](State &s) { s.weight = w; });   // writer task only
+//   State snap = shared.load();                      // any task, any core
+//
+// Keep T trivially copyable and the update lambdas short (no logging, no
+// blocking calls) - they run with interrupts masked on the writer's core.
+// =============================================================================
+
+#include <Arduino.h>
+#include <string.h>
+
+template <typename T>
+class SeqLock {
+public:
+  explicit SeqLock(const T &initial) : sequence(0), value(initial) {}
+
+  /**
+   * @brief Copy a consistent snapshot (lock-free, retries while a write is in progress)
+   */
+  T load() const
+  {
+    T snapshot;
+    for (;;) {
+      uint32_t before = sequence;
+      if (before & 1u)
+        continue;  // Writer mid-update (bounded: it runs in a critical section)
+      __sync_synchronize();
+      memcpy(&snapshot, (const void *)&value, sizeof(T));
+      __sync_synchronize();
+      if (sequence == before)
+        return snapshot;
+    }
+  }
+
+  /**
+   * @brief Modify the value in place - call from the single writer task only
+   */
+  template <typename Fn>
+  void update(Fn fn)
+  {
+    portENTER_CRITICAL(&writerMux);
+    sequence = sequence + 1;  // Odd: readers retry
+    __sync_synchronize();
+    fn(value);
+    __sync_synchronize();
+    sequence = sequence + 1;  // Even: snapshot is consistent again
+    portEXIT_CRITICAL(&writerMux);
+  }
+
+private:
+  volatile uint32_t sequence;
+  T value;
+  portMUX_TYPE writerMux = portMUX_INITIALIZER_UNLOCKED;
+};
+
+#endif // SEQLOCK_H
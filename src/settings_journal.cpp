@@ -0,0 +1,250 @@
+// =============================================================================
+// Crash-Consistent Settings Journal Implementation
+// =============================================================================
+
+#include "settings_journal.h"
+#include "debug_config.h"
+#include "metrics.h"
+#include "console.h"
+#include "static_alloc.h"
+#include "esp_partition.h"
+#include "esp_rom_crc.h"
+
+static constexpr LogTag TAG = LOG_TAG_SYSTEM;
+
+static constexpr uint32_t SECTOR_MAGIC = 0x4C4A5347;   // "GSJL"
+static constexpr uint8_t RECORD_MAGIC  = 0x5A;
+
+struct __attribute__((packed)) SectorHeader {
+  uint32_t magic;
+  uint32_t sequence;   // Higher = newer; the active sector has the highest valid one
+  uint32_t crc;        // Over magic + sequence
+  uint32_t reserved;
+};
+
+struct __attribute__((packed)) RecordHeader {
+  uint8_t magic;
+  uint8_t key;
+  uint16_t length;
+  uint32_t crc;        // Over key, length and payload
+};
+
+struct Entry {
+  uint16_t length;     // 0 = never written
+  uint8_t data[JOURNAL_PAYLOAD_MAX];
+};
+
+static MetricCounter journalAppends("journal_appends_total", "Settings journal records appended");
+static MetricCounter journalCompactions("journal_compactions_total", "Settings journal sector switches (erase + copy)");
+
+static const esp_partition_t *part = NULL;
+static StaticMutex lockStore;
+static SemaphoreHandle_t lock = NULL;
+static Entry entries[JOURNAL_KEY_COUNT];
+static uint8_t activeSector = 0;
+static uint32_t sequence = 0;
+static uint32_t writeOffset = sizeof(SectorHeader);   // Within the active sector
+static uint32_t replayedRecords = 0;
+static bool tornTail = false;
+
+static inline uint32_t padded(uint32_t length)
+{
+  return (length + 3) & ~3u;
+}
+
+static uint32_t headerCrc(uint32_t seq)
+{
+  uint32_t words[2] = {SECTOR_MAGIC, seq};
+  return esp_rom_crc32_le(0, (const uint8_t *)words, sizeof(words));
+}
+
+static uint32_t recordCrc(uint8_t key, uint16_t length, const uint8_t *payload)
+{
+  uint8_t head[3] = {key, (uint8_t)(length & 0xFF), (uint8_t)(length >> 8)};
+  return esp_rom_crc32_le(esp_rom_crc32_le(0, head, sizeof(head)), payload, length);
+}
+
+static bool validHeader(const SectorHeader &h)
+{
+  return h.magic == SECTOR_MAGIC && h.crc == headerCrc(h.sequence);
+}
+
+// One pass over a mapped sector: newest record per key into entries[]
+static void replay(const uint8_t *sector)
+{
+  uint32_t offset = sizeof(SectorHeader);
+  while (offset + sizeof(RecordHeader) <= JOURNAL_SECTOR_BYTES) {
+    RecordHeader h;
+    memcpy(&h, sector + offset, sizeof(h));
+    if (h.magic == 0xFF && h.key == 0xFF && h.length == 0xFFFF && h.crc == 0xFFFFFFFF)
+      break;   // Erased: end of the log
+    const uint8_t *payload = sector + offset + sizeof(h);
+    if (h.magic != RECORD_MAGIC || offset + sizeof(h) + padded(h.length) > JOURNAL_SECTOR_BYTES ||
+        h.crc != recordCrc(h.key, h.length, payload)) {
+      tornTail = true;   // Cut during the last append - appends resume in the other sector
+      break;
+    }
+    if (h.key < JOURNAL_KEY_COUNT && h.length <= JOURNAL_PAYLOAD_MAX) {   // Other keys: newer firmware, skipped
+      entries[h.key].length = h.length;
+      memcpy(entries[h.key].data, payload, h.length);
+    }
+    replayedRecords++;
+    offset += sizeof(h) + padded(h.length);
+  }
+  writeOffset = offset;
+}
+
+static bool writeRecord(uint8_t sector, uint32_t offset, uint8_t key, const Entry &e)
+{
+  uint8_t buffer[sizeof(RecordHeader) + JOURNAL_PAYLOAD_MAX + 3];
+  RecordHeader h = {RECORD_MAGIC, key, e.length, recordCrc(key, e.length, e.data)};
+  uint32_t bytes = sizeof(h) + padded(e.length);
+  memset(buffer, 0xFF, bytes);
+  memcpy(buffer, &h, sizeof(h));
+  memcpy(buffer + sizeof(h), e.data, e.length);
+  return esp_partition_write(part, sector * JOURNAL_SECTOR_BYTES + offset, buffer, bytes) == ESP_OK;
+}
+
+// Newest record of every key into the other sector, its header last
+static bool compact()
+{
+  uint8_t target = activeSector ^ 1;
+  if (esp_partition_erase_range(part, target * JOURNAL_SECTOR_BYTES, JOURNAL_SECTOR_BYTES) != ESP_OK)
+    return false;
+  uint32_t offset = sizeof(SectorHeader);
+  for (uint8_t key = 0; key < JOURNAL_KEY_COUNT; key++) {
+    if (entries[key].length == 0)
+      continue;
+    if (!writeRecord(target, offset, key, entries[key]))
+      return false;
+    offset += sizeof(RecordHeader) + padded(entries[key].length);
+  }
+  SectorHeader h = {SECTOR_MAGIC, sequence + 1, headerCrc(sequence + 1), 0xFFFFFFFF};
+  if (esp_partition_write(part, target * JOURNAL_SECTOR_BYTES, &h, sizeof(h)) != ESP_OK)
+    return false;
+  activeSector = target;
+  sequence++;
+  writeOffset = offset;
+  tornTail = false;
+  journalCompactions.add();
+  return true;
+}
+
+bool journalBegin()
+{
+  part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, "journal");
+  if (part == NULL || part->size < 2 * JOURNAL_SECTOR_BYTES) {
+    part = NULL;
+    LOG_INFO(TAG, "💾 No \"journal\" partition - settings stay in NVS (flash partitions.csv over USB)");
+    return false;
+  }
+  lock = lockStore.create();
+
+  const void *mapped = NULL;
+  spi_flash_mmap_handle_t handle;
+  if (esp_partition_mmap(part, 0, 2 * JOURNAL_SECTOR_BYTES, SPI_FLASH_MMAP_DATA, &mapped, &handle) != ESP_OK) {
+    LOG_ERROR(TAG, "❌ Journal: mmap failed - settings stay in NVS");
+    part = NULL;
+    return false;
+  }
+  const uint8_t *base = (const uint8_t *)mapped;
+  SectorHeader h[2];
+  memcpy(&h[0], base, sizeof(SectorHeader));
+  memcpy(&h[1], base + JOURNAL_SECTOR_BYTES, sizeof(SectorHeader));
+  bool valid0 = validHeader(h[0]);
+  bool valid1 = validHeader(h[1]);
+  bool fresh = !valid0 && !valid1;
+  if (!fresh) {
+    activeSector = (valid1 && (!valid0 || h[1].sequence > h[0].sequence)) ? 1 : 0;
+    sequence = h[activeSector].sequence;
+    replay(base + activeSector * JOURNAL_SECTOR_BYTES);
+  }
+  spi_flash_munmap(handle);
+
+  if (fresh) {
+    // Empty partition: sector 1 "active" with sequence 0, so the first compaction formats sector 0
+    activeSector = 1;
+    sequence = 0;
+    if (!compact()) {
+      LOG_ERROR(TAG, "❌ Journal: format failed - settings stay in NVS");
+      part = NULL;
+      return false;
+    }
+    LOG_INFO(TAG, "💾 Journal formatted (0x%06lx)", (unsigned long)part->address);
+    return true;
+  }
+  if (tornTail) {
+    LOG_WARN(TAG, "⚠️  Journal: torn record at %lu ignored, previous values kept", (unsigned long)writeOffset);
+    compact();
+  }
+  LOG_INFO(TAG, "💾 Journal: sector %u, sequence %lu, %lu records, %lu bytes used", (unsigned)activeSector,
+           (unsigned long)sequence, (unsigned long)replayedRecords, (unsigned long)writeOffset);
+  return true;
+}
+
+bool journalReady()
+{
+  return part != NULL;
+}
+
+size_t journalRead(JournalKey key, void *out, size_t len)
+{
+  if (part == NULL || key >= JOURNAL_KEY_COUNT)
+    return 0;
+  xSemaphoreTake(lock, portMAX_DELAY);
+  size_t length = entries[key].length;
+  memcpy(out, entries[key].data, min(length, len));
+  xSemaphoreGive(lock);
+  return length;
+}
+
+bool journalWrite(JournalKey key, const void *data, size_t len)
+{
+  if (part == NULL || key >= JOURNAL_KEY_COUNT || len == 0 || len > JOURNAL_PAYLOAD_MAX)
+    return false;
+  xSemaphoreTake(lock, portMAX_DELAY);
+  Entry &e = entries[key];
+  if (e.length == len && memcmp(e.data, data, len) == 0) {
+    xSemaphoreGive(lock);
+    return true;
+  }
+  e.length = len;
+  memcpy(e.data, data, len);
+
+  bool ok;
+  uint32_t bytes = sizeof(RecordHeader) + padded(len);
+  if (!tornTail && writeOffset + bytes <= JOURNAL_SECTOR_BYTES) {
+    ok = writeRecord(activeSector, writeOffset, key, e);
+    if (ok)
+      writeOffset += bytes;
+    else
+      tornTail = true;   // Whatever reached the flash is not trusted - the next write compacts
+  } else {
+    ok = compact();      // Copies the new value with the others
+  }
+  xSemaphoreGive(lock);
+  if (ok)
+    journalAppends.add();
+  else
+    LOG_ERROR(TAG, "❌ Journal: write of key %u failed", (unsigned)key);
+  return ok;
+}
+
+void journalDump(Print &out)
+{
+  if (part == NULL) {
+    out.println("[Journal] Not in use - no \"journal\" partition, settings in NVS");
+    return;
+  }
+  xSemaphoreTake(lock, portMAX_DELAY);
+  out.printf("[Journal] 0x%06lx: sector %u active, sequence %lu, %lu / %lu bytes used\n",
+             (unsigned long)part->address, (unsigned)activeSector, (unsigned long)sequence,
+             (unsigned long)writeOffset, (unsigned long)JOURNAL_SECTOR_BYTES);
+  for (uint8_t key = 0; key < JOURNAL_KEY_COUNT; key++)
+    out.printf("  key %u: %u bytes\n", (unsigned)key, (unsigned)entries[key].length);
+  xSemaphoreGive(lock);
+  out.printf("  appends %lu, compactions %lu, replayed at boot %lu\n", (unsigned long)journalAppends.value(),
+             (unsigned long)journalCompactions.value(), (unsigned long)replayedRecords);
+}
+
+static ConsoleCommand journalCommand("journal", "Settings journal: active sector, bytes used, appends, compactions", journalDump);
@@ -0,0 +1,76 @@
+#ifndef SETTINGS_JOURNAL_H
+#define SETTINGS_JOURNAL_H
+
+// =============================================================================
+// Crash-Consistent Settings Journal (two alternating flash sectors)
+// =============================================================================
+// The settings blob (settings_store.h) and the offset profiles written after
+// every shot (offset_model.h) are appended as records to a raw "journal"
+// partition instead of rewriting NVS keys. An NVS key update rewrites the
+// entry and its page state; a power cut in the middle could leave the blob
+// unreadable, and setup() then fell back to the defaults.
+//
+//   sector 0 / 1   [header: magic, sequence, CRC] [record] [record] ... [0xFF]
+//   record         [magic, key, length, CRC-32] [payload, padded to 4 bytes]
+//
+// Appends go to the end of the active sector; the newest record of a key
+// wins. A record is valid only when its CRC matches, so a torn append is
+// ignored and the previous value of that key stays in force. When the
+// active sector is full, the newest record of every key is copied into the
+// other sector (erased first) and its header - with the next sequence
+// number - is written last: until then the old sector stays the active one,
+// so a cut during the copy loses nothing. The two sectors share the erase
+// wear.
+//
+// Boot: the partition is mapped once (esp_partition_mmap) and the active
+// sector replayed in one pass into a small RAM copy of every key; readers
+// take their value from that copy. A torn tail found there is compacted away
+// before the first append.
+//
+// No "journal" partition (a board flashed over the air keeps its partition
+// table - flash partitions.csv over USB once): journalReady() is false and
+// the callers keep their NVS keys.
+//
+// Thread Safety:
+//   journalBegin() from setup() before settingsStoreBegin(). journalRead()
+//   and journalWrite() from any task, serialised by a mutex (flash writes
+//   block, never from an ISR).
+// =============================================================================
+
+#include <Arduino.h>
+
+constexpr uint32_t JOURNAL_SECTOR_BYTES = 4096;
+constexpr uint16_t JOURNAL_PAYLOAD_MAX  = 96;    // Largest record (offset profiles: 74 bytes)
+
+enum JournalKey : uint8_t {
+  JOURNAL_SETTINGS = 0,   // settings_store.h record
+  JOURNAL_OFFSETS,        // offset_model.h record
+  JOURNAL_KEY_COUNT
+};
+
+/**
+ * @brief Find the partition and replay the active sector
+ * @return false without a usable "journal" partition (callers use NVS)
+ */
+bool journalBegin();
+
+bool journalReady();
+
+/**
+ * @brief Newest payload of `key`
+ * @return Payload length (0 if the key was never written); at most `len` bytes are copied
+ */
+size_t journalRead(JournalKey key, void *out, size_t len);
+
+/**
+ * @brief Append a record for `key` (skipped when equal to the newest one)
+ * @return false if the journal is unavailable or the flash write failed
+ */
+bool journalWrite(JournalKey key, const void *data, size_t len);
+
+/**
+ * @brief Active sector, sequence, bytes used, appends and compactions
+ */
+void journalDump(Print &out);
+
+#endif // SETTINGS_JOURNAL_H
@@ -0,0 +1,228 @@
+// =============================================================================
+// Debounced Settings Persistence Implementation
+// =============================================================================
+
+#include "settings_store.h"
+#include "debug_config.h"
+#include "metrics.h"
+#include "settings_journal.h"
+#include <Preferences.h>
+
+static constexpr LogTag TAG = LOG_TAG_SYSTEM;
+
+static const char *SETTINGS_NAMESPACE   = "myApp";
+static const char *SETTINGS_KEY         = "settings";
+static const char *LEGACY_BRIGHTNESS_KEY = "brightness";
+static const char *LEGACY_WEIGHT_KEY     = "weight";
+
+struct SettingsRecord {
+  uint8_t version;
+  Settings settings;
+};
+
+// Version 1: brightness + goal only
+struct SettingsRecordV1 {
+  uint8_t version;
+  int16_t brightnessPct;
+  int16_t goalWeightG;
+};
+
+// Version 2: + cup mode
+struct SettingsRecordV2 {
+  uint8_t version;
+  int16_t brightnessPct;
+  int16_t goalWeightG;
+  int16_t cupMode;
+};
+
+static MetricCounter settingsCommits("settings_commits_total", "Settings blobs written to NVS");
+static MetricCounter settingsChanges("settings_changes_total", "Settings changes (commits are debounced)");
+
+static portMUX_TYPE settingsLock = portMUX_INITIALIZER_UNLOCKED;
+static Settings current = {};
+static bool dirty = false;
+static uint32_t lastChangeMs = 0;
+
+static void commit(const Settings &s)
+{
+  SettingsRecord record = { SETTINGS_VERSION, s };
+  if (journalReady()) {
+    if (!journalWrite(JOURNAL_SETTINGS, &record, sizeof(record)))
+      return;
+    settingsCommits.add();
+    LOG_DEBUG(TAG, "💾 Settings journaled: brightness %d%%, goal %dg, cup mode %d", s.brightnessPct, s.goalWeightG,
+              s.cupMode);
+    return;
+  }
+
+  Preferences prefs;
+  if (!prefs.begin(SETTINGS_NAMESPACE, false)) {
+    LOG_ERROR(TAG, "❌ Settings: NVS namespace unavailable, not saved");
+    return;
+  }
+  prefs.putBytes(SETTINGS_KEY, &record, sizeof(record));
+  prefs.end();
+  settingsCommits.add();
+  LOG_DEBUG(TAG, "💾 Settings saved: brightness %d%%, goal %dg, cup mode %d", s.brightnessPct, s.goalWeightG,
+            s.cupMode);
+}
+
+// The NVS blob, or the legacy keys before it
+static void loadNvs()
+{
+  Preferences prefs;
+  if (!prefs.begin(SETTINGS_NAMESPACE, false))
+    return;  // Defaults (0) - setup() replaces out-of-range values
+
+  SettingsRecord record;
+  if (prefs.getBytes(SETTINGS_KEY, &record, sizeof(record)) == sizeof(record) &&
+      record.version == SETTINGS_VERSION) {
+    current = record.settings;
+    prefs.end();
+    return;
+  }
+
+  SettingsRecordV2 v2;
+  if (prefs.getBytes(SETTINGS_KEY, &v2, sizeof(v2)) == sizeof(v2) && v2.version == 2) {
+    current = {};
+    current.brightnessPct = v2.brightnessPct;
+    current.goalWeightG = v2.goalWeightG;
+    current.cupMode = v2.cupMode;
+    record = { SETTINGS_VERSION, current };
+    prefs.putBytes(SETTINGS_KEY, &record, sizeof(record));
+    prefs.end();
+    LOG_INFO(TAG, "💾 Settings blob upgraded to version %u", (unsigned)SETTINGS_VERSION);
+    return;
+  }
+
+  SettingsRecordV1 v1;
+  if (prefs.getBytes(SETTINGS_KEY, &v1, sizeof(v1)) == sizeof(v1) && v1.version == 1) {
+    current = {};
+    current.brightnessPct = v1.brightnessPct;
+    current.goalWeightG = v1.goalWeightG;
+    record = { SETTINGS_VERSION, current };
+    prefs.putBytes(SETTINGS_KEY, &record, sizeof(record));
+    prefs.end();
+    LOG_INFO(TAG, "💾 Settings blob upgraded to version %u", (unsigned)SETTINGS_VERSION);
+    return;
+  }
+
+  current.brightnessPct = (int16_t)prefs.getInt(LEGACY_BRIGHTNESS_KEY, 0);
+  current.goalWeightG = (int16_t)prefs.getInt(LEGACY_WEIGHT_KEY, 0);
+  record = { SETTINGS_VERSION, current };
+  prefs.putBytes(SETTINGS_KEY, &record, sizeof(record));
+  prefs.end();
+  LOG_INFO(TAG, "💾 Settings migrated to a single blob (brightness %d%%, goal %dg)",
+           current.brightnessPct, current.goalWeightG);
+}
+
+void settingsStoreBegin()
+{
+  SettingsRecord record;
+  if (journalRead(JOURNAL_SETTINGS, &record, sizeof(record)) == sizeof(record) &&
+      record.version == SETTINGS_VERSION) {
+    current = record.settings;
+    return;
+  }
+
+  // First boot with the journal: NVS (migrated as before) seeds it; the NVS blob stays as it was
+  loadNvs();
+  if (journalReady()) {
+    record = { SETTINGS_VERSION, current };
+    journalWrite(JOURNAL_SETTINGS, &record, sizeof(record));
+  }
+}
+
+Settings settingsGet()
+{
+  portENTER_CRITICAL(&settingsLock);
+  Settings s = current;
+  portEXIT_CRITICAL(&settingsLock);
+  return s;
+}
+
+static void change(int16_t Settings::*field, int value)
+{
+  portENTER_CRITICAL(&settingsLock);
+  bool changed = current.*field != (int16_t)value;
+  if (changed) {
+    current.*field = (int16_t)value;
+    dirty = true;
+    lastChangeMs = millis();
+  }
+  portEXIT_CRITICAL(&settingsLock);
+  if (changed)
+    settingsChanges.add();
+}
+
+void settingsSetBrightness(int pct)
+{
+  change(&Settings::brightnessPct, pct);
+}
+
+void settingsSetGoalWeight(int grams)
+{
+  change(&Settings::goalWeightG, grams);
+}
+
+void settingsSetCupMode(int mode)
+{
+  change(&Settings::cupMode, mode);
+}
+
+void settingsSetFlush(int onS)
+{
+  change(&Settings::flushS, onS);
+}
+
+void settingsSetBackflush(int pulses, int onS, int offS)
+{
+  change(&Settings::backflushPulses, pulses);
+  change(&Settings::backflushOnS, onS);
+  change(&Settings::backflushOffS, offS);
+}
+
+void settingsSetBackflushEvery(int shots)
+{
+  change(&Settings::backflushEvery, shots);
+}
+
+void settingsSetShotsSinceBackflush(int shots)
+{
+  change(&Settings::shotsSinceBackflush, shots);
+}
+
+// Take the pending snapshot if `force` or the quiet period has passed
+static bool takePending(bool force, Settings *out, uint32_t *dueInMs)
+{
+  bool take = false;
+  portENTER_CRITICAL(&settingsLock);
+  if (dirty) {
+    uint32_t quiet = millis() - lastChangeMs;
+    if (force || quiet >= SETTINGS_QUIET_MS) {
+      *out = current;
+      dirty = false;
+      take = true;
+    } else if (dueInMs != NULL) {
+      *dueInMs = SETTINGS_QUIET_MS - quiet;
+    }
+  }
+  portEXIT_CRITICAL(&settingsLock);
+  return take;
+}
+
+uint32_t settingsStorePoll()
+{
+  Settings s;
+  uint32_t dueInMs = UINT32_MAX;
+  if (takePending(false, &s, &dueInMs))
+    commit(s);
+  return dueInMs;
+}
+
+void settingsStoreFlush()
+{
+  Settings s;
+  if (takePending(true, &s, NULL))
+    commit(s);
+}
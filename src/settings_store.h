@@ -0,0 +1,78 @@
+#ifndef SETTINGS_STORE_H
+#define SETTINGS_STORE_H
+
+// =============================================================================
+// Debounced Settings Persistence
+// =============================================================================
+// User settings (backlight, goal weight, cup mode, cleaning programs) live in a RAM struct. Setters only
+// mark it dirty; settingsStorePoll() writes one versioned blob to NVS once
+// no change has arrived for SETTINGS_QUIET_MS. A slider drag that fires
+// dozens of LV_EVENT_VALUE_CHANGED therefore costs one NVS commit instead of
+// one per event (each blocked the UI core for milliseconds and wore flash).
+//
+// settingsStoreFlush() commits immediately - call it before a restart or
+// before the display/system goes to sleep.
+//
+// Blob: record JOURNAL_SETTINGS of the settings journal (settings_journal.h),
+// appended crash-consistently; without a journal partition namespace
+// "myApp", key "settings" in NVS. The first boot with the journal seeds it
+// from NVS. On the first boot after the
+// upgrade the legacy "brightness" / "weight" int keys are read once and
+// written back as the blob; the legacy keys are left in place. A version 1
+// blob (no cup mode) is carried over with the cup mode off, a version 2 blob
+// (no cleaning programs) with the clean_program.h defaults (all 0 here).
+//
+// Thread Safety:
+//   Setters and settingsStorePoll() run on the UI task. settingsStoreFlush()
+//   may be called from any task: the struct and the dirty flag are copied
+//   under a spinlock and the NVS write happens outside it.
+// =============================================================================
+
+#include <Arduino.h>
+
+constexpr uint32_t SETTINGS_QUIET_MS = 1500;   // No change for this long → commit
+constexpr uint8_t SETTINGS_VERSION   = 3;      // Bump when Settings changes
+
+struct Settings {
+  int16_t brightnessPct;   // Backlight slider, 0-100
+  int16_t goalWeightG;     // Preset weight slider
+  int16_t cupMode;         // CupMode (cup_detect.h)
+  int16_t flushS;          // Flush: pump on, seconds (clean_program.h; 0 = default)
+  int16_t backflushPulses; // Backflush: pulses ...
+  int16_t backflushOnS;    // ... pump on per pulse, seconds
+  int16_t backflushOffS;   // ... rest between pulses, seconds
+  int16_t backflushEvery;  // Remind after this many shots (-1 = never, 0 = default)
+  int16_t shotsSinceBackflush;
+};
+
+/**
+ * @brief Load the blob (or migrate the legacy keys)
+ * @note Setup, before the UI task. Values are not range-checked here.
+ */
+void settingsStoreBegin();
+
+/**
+ * @brief Current values (RAM copy, may be ahead of NVS)
+ */
+Settings settingsGet();
+
+void settingsSetBrightness(int pct);
+void settingsSetGoalWeight(int grams);
+void settingsSetCupMode(int mode);
+void settingsSetFlush(int onS);
+void settingsSetBackflush(int pulses, int onS, int offS);
+void settingsSetBackflushEvery(int shots);
+void settingsSetShotsSinceBackflush(int shots);
+
+/**
+ * @brief Commit once the settings have been quiet for SETTINGS_QUIET_MS
+ * @return ms until a pending commit is due (UINT32_MAX when clean), to bound the caller's sleep
+ */
+uint32_t settingsStorePoll();
+
+/**
+ * @brief Commit now if anything is pending
+ */
+void settingsStoreFlush();
+
+#endif // SETTINGS_STORE_H
@@ -0,0 +1,128 @@
+// =============================================================================
+// Live Extraction Chart Implementation
+// =============================================================================
+
+#include "shot_chart.h"
+#include "debug_config.h"
+
+static constexpr LogTag TAG = LOG_TAG_UI;
+
+static constexpr uint32_t CHART_RING_SIZE = 16;  // Power of two; ~8 s of points
+
+struct ChartPoint {
+  int16_t weight;   // 0.1 g
+  int16_t flow;     // 0.1 g/s
+};
+
+// SPSC ring - head written by the BLE task only, tail by the UI task only
+static ChartPoint ring[CHART_RING_SIZE];
+static volatile uint32_t ringHead = 0;
+static volatile uint32_t ringTail = 0;
+
+// Clear request: generation bumped by the producer, applied by the consumer
+static volatile uint32_t resetGeneration = 0;
+static volatile uint8_t resetGoal = 0;
+static volatile uint32_t resetHead = 0;   // First ring slot of the new shot
+
+// Producer state (BLE task)
+static int32_t lastPeriod = -1;
+
+// Consumer state (UI task)
+static lv_obj_t *chart = NULL;
+static lv_chart_series_t *weightSeries = NULL;
+static lv_chart_series_t *flowSeries = NULL;
+static uint32_t appliedGeneration = 0;
+
+static void ringPush(const ChartPoint &point)
+{
+  uint32_t head = ringHead;
+  if (head - ringTail >= CHART_RING_SIZE)
+    return;  // UI task stalled - the chart just misses a point
+  ring[head & (CHART_RING_SIZE - 1)] = point;
+  __sync_synchronize();  // Point visible before the index moves
+  ringHead = head + 1;
+}
+
+void shotChartCreate(lv_obj_t *parent)
+{
+  chart = lv_chart_create(parent);
+  lv_obj_set_size(chart, SHOT_CHART_WIDTH, SHOT_CHART_HEIGHT);
+  lv_obj_clear_flag(chart, LV_OBJ_FLAG_CLICKABLE | LV_OBJ_FLAG_SCROLLABLE);
+  lv_obj_set_style_pad_all(chart, 4, LV_PART_MAIN);
+  lv_obj_set_style_size(chart, 0, LV_PART_INDICATOR);          // Lines only, no point dots
+  lv_obj_set_style_line_width(chart, 2, LV_PART_ITEMS);
+
+  lv_chart_set_type(chart, LV_CHART_TYPE_LINE);
+  lv_chart_set_point_count(chart, SHOT_CHART_POINTS);
+  lv_chart_set_update_mode(chart, LV_CHART_UPDATE_MODE_SHIFT);
+  lv_chart_set_div_line_count(chart, 3, 0);
+  lv_chart_set_range(chart, LV_CHART_AXIS_PRIMARY_Y, 0, 440);   // 36 g default goal + 20%, in 0.1 g
+  lv_chart_set_range(chart, LV_CHART_AXIS_SECONDARY_Y, 0, (lv_coord_t)(SHOT_CHART_FLOW_MAX * 10.0f));
+
+  weightSeries = lv_chart_add_series(chart, lv_palette_main(LV_PALETTE_BROWN), LV_CHART_AXIS_PRIMARY_Y);
+  flowSeries = lv_chart_add_series(chart, lv_palette_main(LV_PALETTE_LIGHT_BLUE), LV_CHART_AXIS_SECONDARY_Y);
+  lv_chart_set_all_value(chart, weightSeries, LV_CHART_POINT_NONE);
+  lv_chart_set_all_value(chart, flowSeries, LV_CHART_POINT_NONE);
+
+  LOG_DEBUG(TAG, "Shot chart created (%u points, %.1fs each)", SHOT_CHART_POINTS, SHOT_CHART_PERIOD_S);
+}
+
+void shotChartBegin(uint8_t goalWeight)
+{
+  lastPeriod = -1;
+  resetGoal = goalWeight;
+  resetHead = ringHead;
+  __sync_synchronize();
+  resetGeneration = resetGeneration + 1;
+}
+
+void shotChartAdd(float t, float weight, float flow)
+{
+  if (t < 0.0f)
+    return;
+
+  int32_t period = (int32_t)(t / SHOT_CHART_PERIOD_S);
+  if (period <= lastPeriod)
+    return;
+
+  ChartPoint point;
+  point.weight = (int16_t)constrain(lroundf(weight * 10.0f), 0L, 32767L);
+  point.flow   = (int16_t)constrain(lroundf(flow * 10.0f), 0L, 32767L);
+
+  // Periods skipped by a BLE gap repeat the value (at most one chart width)
+  int32_t missed = (lastPeriod < 0) ? 0 : period - lastPeriod - 1;
+  if (missed > SHOT_CHART_POINTS)
+    missed = SHOT_CHART_POINTS;
+  for (int32_t i = 0; i <= missed; i++)
+    ringPush(point);
+
+  lastPeriod = period;
+}
+
+void shotChartService()
+{
+  if (chart == NULL)
+    return;
+
+  uint32_t generation = resetGeneration;
+  if (generation != appliedGeneration)
+  {
+    appliedGeneration = generation;
+    ringTail = resetHead;  // Points of the previous shot are stale
+
+    lv_coord_t top = (lv_coord_t)(resetGoal * 12);  // goal + 20%, in 0.1 g
+    lv_chart_set_range(chart, LV_CHART_AXIS_PRIMARY_Y, 0, top > 0 ? top : 440);
+    lv_chart_set_all_value(chart, weightSeries, LV_CHART_POINT_NONE);
+    lv_chart_set_all_value(chart, flowSeries, LV_CHART_POINT_NONE);
+  }
+
+  uint32_t head = ringHead;
+  __sync_synchronize();  // Index read before the points it covers
+  while (ringTail != head)
+  {
+    const ChartPoint &point = ring[ringTail & (CHART_RING_SIZE - 1)];
+    lv_chart_set_next_value(chart, weightSeries, point.weight);
+    lv_chart_set_next_value(chart, flowSeries, point.flow);
+    ringTail = ringTail + 1;
+  }
+}
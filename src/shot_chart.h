@@ -0,0 +1,63 @@
+#ifndef SHOT_CHART_H
+#define SHOT_CHART_H
+
+// =============================================================================
+// Live Extraction Chart (weight + flow) for Gravimetric Shots
+// =============================================================================
+// A small lv_chart next to the timer panel shows the running shot:
+//
+//   control task: filtered weight/flow per sample ──► decimator (one point per
+//     SHOT_CHART_PERIOD_S) ──► SPSC point ring ──► UI task: shotChartService()
+//     ──► lv_chart_set_next_value() on both series
+//
+//   - Decimated on the producer side to SHOT_CHART_POINTS points per
+//     SHOT_CHART_WINDOW_S, so the UI task touches LVGL at ~2 Hz per series,
+//     not at packet rate. A BLE gap repeats the last value so the time axis
+//     stays honest.
+//   - Appends only (shift mode): LVGL invalidates the chart object and
+//     nothing else, which partial refresh turns into one 100-row stripe.
+//   - No panel-side scrolling. The chart is a landscape region, and landscape
+//     columns are native rows, so a VSCRDEF / VSCSAD scroll would drag the
+//     whole screen height past it, labels included. Rendering only the new
+//     column would not help either: with LCD_ROW_FULL_SPAN any window is a
+//     full-width stripe, so a column of the chart costs the same 640 x 100
+//     band as the whole plot. The cost is the chart's height, not its width.
+//   - Weight on the primary axis (0 .. goal + 20%), flow on the secondary
+//     axis (0 .. SHOT_CHART_FLOW_MAX g/s). Values are integers in 0.1 units.
+//
+// Thread Safety:
+//   shotChartBegin()/shotChartAdd() - shot control task (Core 0) only (ring producer)
+//   shotChartCreate()/shotChartService() - UI task (Core 1) only (ring consumer, LVGL)
+// =============================================================================
+
+#include <Arduino.h>
+#include "lvgl.h"
+
+constexpr uint16_t SHOT_CHART_POINTS    = 60;
+constexpr float    SHOT_CHART_PERIOD_S  = 0.5f;   // 60 points = the last 30 s
+constexpr float    SHOT_CHART_FLOW_MAX  = 5.0f;   // g/s at the top of the flow axis
+constexpr lv_coord_t SHOT_CHART_WIDTH   = 130;
+constexpr lv_coord_t SHOT_CHART_HEIGHT  = 100;
+
+/**
+ * @brief Create the chart as the last child of `parent` (after ui_init())
+ */
+void shotChartCreate(lv_obj_t *parent);
+
+/**
+ * @brief New shot: clear the chart and scale the weight axis to the goal
+ */
+void shotChartBegin(uint8_t goalWeight);
+
+/**
+ * @brief Offer one filtered sample; kept only when it starts a new chart period
+ * @param t Seconds since the shot started
+ */
+void shotChartAdd(float t, float weight, float flow);
+
+/**
+ * @brief Apply pending points to LVGL (UI task); cheap when nothing is pending
+ */
+void shotChartService();
+
+#endif // SHOT_CHART_H
@@ -0,0 +1,262 @@
+// =============================================================================
+// Shot Event Trace Implementation
+// =============================================================================
+
+#include "shot_events.h"
+#include "debug_config.h"
+#include "console.h"
+#include "metrics.h"
+#include "mem_caps.h"
+#include "shot_log.h"
+#include "stop_estimator.h"
+#include "esp_timer.h"
+
+static constexpr LogTag TAG = LOG_TAG_SHOT;
+
+#if GS_SHOT_EVENTS
+
+// In the ring: absolute time, the trace is only relative once it is cut
+struct RingEvent {
+  int64_t us;
+  uint32_t value;
+  int32_t extra;
+  uint8_t type;
+  uint8_t code;
+  uint16_t arg;
+};
+
+static MetricCounter eventsRecorded("shot_trace_events_total", "Events recorded into the shot event ring");
+static MetricCounter eventsDropped("shot_trace_dropped_total", "Shot trace events lost to the ring wrapping or the per-shot cap");
+static MetricCounter tracesCut("shot_trace_shots_total", "Shot traces cut from the ring for the shot log");
+
+static portMUX_TYPE eventsMux = portMUX_INITIALIZER_UNLOCKED;
+static RingEvent *ring = NULL;
+static uint32_t head = 0;            // Events ever recorded (eventsMux)
+
+// Start request (UI task, eventsMux)
+static bool requested = false;
+static uint32_t requestSeq = 0;
+static int64_t requestUs = 0;
+
+// The shot's window (control task)
+static bool armed = false;
+static bool ended = false;
+static uint32_t firstSeq = 0;
+static uint32_t endSeq = 0;
+static int64_t originUs = 0;
+static int64_t startUs = 0;
+static uint8_t endReason = 0;
+static ShotTraceModel model = {};
+
+void shotEventsBegin()
+{
+  ring = (RingEvent *)memCapsAlloc(SHOT_EVENTS_RING * sizeof(RingEvent), MEM_PSRAM, MEM_OWNER_SHOT_EVENTS);
+  if (ring == NULL)
+    LOG_WARN(TAG, "⚠️  Shot events: no PSRAM for the ring - shots are logged without a trace");
+}
+
+void shotEventsRecord(ShotEventType type, uint8_t code, uint16_t arg, uint32_t value, int32_t extra, int64_t us)
+{
+  if (ring == NULL)
+    return;
+  portENTER_CRITICAL(&eventsMux);
+  RingEvent &e = ring[head % SHOT_EVENTS_RING];
+  e.us = us;
+  e.value = value;
+  e.extra = extra;
+  e.type = type;
+  e.code = code;
+  e.arg = arg;
+  head++;
+  portEXIT_CRITICAL(&eventsMux);
+  eventsRecorded.add();
+}
+
+void shotEventsShotRequested()
+{
+  portENTER_CRITICAL(&eventsMux);
+  requested = true;
+  requestSeq = head;
+  requestUs = esp_timer_get_time();
+  portEXIT_CRITICAL(&eventsMux);
+}
+
+void shotEventsShotArmed(int64_t pumpOnUs, const ShotTraceModel &settings)
+{
+  portENTER_CRITICAL(&eventsMux);
+  bool fromRequest = requested;
+  firstSeq = fromRequest ? requestSeq : head;
+  originUs = fromRequest ? requestUs : pumpOnUs;
+  requested = false;
+  portEXIT_CRITICAL(&eventsMux);
+
+  startUs = pumpOnUs;
+  model = settings;
+  armed = true;
+  ended = false;
+}
+
+void shotEventsShotEnded(uint8_t reason, float finalG)
+{
+  if (!armed || ended)
+    return;
+  uint32_t bits;
+  memcpy(&bits, &finalG, sizeof(bits));
+  shotEventsRecord(SHOT_EVENT_END, reason, 0, bits, 0, esp_timer_get_time());
+  portENTER_CRITICAL(&eventsMux);
+  endSeq = head;
+  portEXIT_CRITICAL(&eventsMux);
+  endReason = reason;
+  ended = true;
+}
+
+uint16_t shotEventsCollect(ShotTraceHeader *header, ShotTraceEvent *events, uint16_t maxEvents)
+{
+  if (ring == NULL || !armed || !ended)
+    return 0;
+  armed = false;
+
+  uint32_t dropped = 0;
+  uint32_t last = endSeq;
+  if (last - firstSeq > maxEvents) {
+    dropped += last - firstSeq - maxEvents;   // Keep the start: the filter needs it, the tail is drips
+    last = firstSeq + maxEvents;
+  }
+
+  uint16_t count = 0;
+  for (uint32_t seq = firstSeq; seq != last; seq++) {
+    RingEvent e;
+    portENTER_CRITICAL(&eventsMux);
+    bool kept = head - seq <= SHOT_EVENTS_RING;
+    if (kept)
+      e = ring[seq % SHOT_EVENTS_RING];
+    portEXIT_CRITICAL(&eventsMux);
+    if (!kept) {
+      dropped++;   // Overwritten - only if a shot outlasted the ring
+      continue;
+    }
+    ShotTraceEvent &out = events[count++];
+    out.tUs = (int32_t)(e.us - originUs);
+    out.value = e.value;
+    out.extra = e.extra;
+    out.type = e.type;
+    out.code = e.code;
+    out.arg = e.arg;
+  }
+
+  memset(header, 0, sizeof(*header));
+  header->magic = SHOT_TRACE_MAGIC;
+  header->version = SHOT_TRACE_VERSION;
+  header->estimator = model.estimator;
+  header->originUs = originUs;
+  header->startUs = (int32_t)(startUs - originUs);
+  header->goalG = model.goalG;
+  header->offsetG = model.offsetG;
+  header->latencyS = model.latencyS;
+  header->processNoise = model.processNoise;
+  header->measurementNoise = model.measurementNoise;
+  header->profile = model.profile;
+  header->endReason = endReason;
+  header->events = count;
+  header->dropped = (uint16_t)min(dropped, (uint32_t)UINT16_MAX);
+  if (dropped)
+    eventsDropped.add(dropped);
+  tracesCut.add();
+  return count;
+}
+
+void shotEventsDump(Print &out)
+{
+  portENTER_CRITICAL(&eventsMux);
+  uint32_t recorded = head;
+  portEXIT_CRITICAL(&eventsMux);
+  out.printf("[Shot events] %s, %lu recorded, %lu / %lu in the ring; %lu traces cut, %lu events dropped\n",
+             ring != NULL ? "recording" : "off (no PSRAM)", (unsigned long)recorded,
+             (unsigned long)min(recorded, SHOT_EVENTS_RING), (unsigned long)SHOT_EVENTS_RING,
+             (unsigned long)tracesCut.value(), (unsigned long)eventsDropped.value());
+  if (armed)
+    out.printf("  Shot window open: %lu events since the start request%s\n", (unsigned long)(recorded - firstSeq),
+               ended ? ", ended" : "");
+}
+
+#else
+
+void shotEventsBegin() {}
+void shotEventsRecord(ShotEventType, uint8_t, uint16_t, uint32_t, int32_t, int64_t) {}
+void shotEventsShotRequested() {}
+void shotEventsShotArmed(int64_t, const ShotTraceModel &) {}
+void shotEventsShotEnded(uint8_t, float) {}
+uint16_t shotEventsCollect(ShotTraceHeader *, ShotTraceEvent *, uint16_t) { return 0; }
+
+void shotEventsDump(Print &out)
+{
+  out.println("[Shot events] Not built in (GS_SHOT_EVENTS=0)");
+}
+
+#endif // GS_SHOT_EVENTS
+
+static float bitsToFloat(uint32_t bits)
+{
+  float f;
+  memcpy(&f, &bits, sizeof(f));
+  return f;
+}
+
+void shotEventsPrint(Print &out, const ShotTraceHeader &h, const ShotTraceEvent *events, uint16_t count)
+{
+  out.printf("GSH,%u,%lu,%.9g,%.9g,%.9g,%.9g,%.9g,%s,%u,%u,%ld,%u,%u\n", (unsigned)h.version,
+             (unsigned long)h.shotId, h.goalG, h.offsetG, h.latencyS, h.processNoise, h.measurementNoise,
+             stopEstimatorName(h.estimator), (unsigned)h.profile, (unsigned)h.endReason, (long)h.startUs,
+             (unsigned)h.events, (unsigned)h.dropped);
+  for (uint16_t i = 0; i < count; i++) {
+    const ShotTraceEvent &e = events[i];
+    switch (e.type) {
+      case SHOT_EVENT_WEIGHT:
+        out.printf("GSE,W,%ld,%.9g,%ld\n", (long)e.tUs, bitsToFloat(e.value), (long)e.tUs + (long)e.extra);
+        break;
+      case SHOT_EVENT_COMMAND:
+        out.printf("GSE,C,%ld,%u,%u\n", (long)e.tUs, (unsigned)e.code, (unsigned)e.arg);
+        break;
+      case SHOT_EVENT_ACK:
+        out.printf("GSE,A,%ld,%u\n", (long)e.tUs, (unsigned)e.code);
+        break;
+      case SHOT_EVENT_RELAY:
+        out.printf("GSE,R,%ld,%u,%u,%ld\n", (long)e.tUs, (unsigned)e.code, (unsigned)(e.arg & SHOT_EVENT_RELAY_ON),
+                   (e.arg & SHOT_EVENT_RELAY_TIMER) ? (long)e.tUs - (long)e.extra : -1L);
+        break;
+      case SHOT_EVENT_END:
+        out.printf("GSE,E,%ld,%u,%.9g\n", (long)e.tUs, (unsigned)e.code, bitsToFloat(e.value));
+        break;
+    }
+  }
+}
+
+static void cmdShotTrace(ConsoleArgs &args)
+{
+  if (args.argc < 2) {
+    shotEventsDump(args.out);
+    args.out.println("Usage: shottrace <shot id>  (ids: 'shots'; feed the output to tools/shot_replay)");
+    return;
+  }
+  if (shotLogBusy()) {
+    args.out.println("[Shot events] Shot brewing - no flash reads until it ends");
+    return;
+  }
+  uint32_t id = (uint32_t)strtoul(args.arg(1), NULL, 10);
+  size_t bytes = SHOT_TRACE_MAX_EVENTS * sizeof(ShotTraceEvent);
+  ShotTraceEvent *events = (ShotTraceEvent *)memCapsAlloc(bytes, MEM_PSRAM_FIRST, MEM_OWNER_SHOT_EVENTS);
+  if (events == NULL) {
+    args.out.println("[Shot events] No memory to read the trace");
+    return;
+  }
+  ShotTraceHeader header;
+  int count = shotLogReadTrace(id, &header, events, SHOT_TRACE_MAX_EVENTS);
+  if (count < 0)
+    args.out.printf("[Shot events] No trace kept for shot #%lu (the newest %u shots have one)\n", (unsigned long)id,
+                    (unsigned)SHOT_LOG_TRACES);
+  else
+    shotEventsPrint(args.out, header, events, (uint16_t)count);
+  memCapsFree(events, bytes, MEM_OWNER_SHOT_EVENTS);
+}
+
+static ConsoleCommand shotTraceCommand("shottrace", "[id]", "Shot event trace (weights, commands, acks, relay) for tools/shot_replay", cmdShotTrace);
@@ -0,0 +1,159 @@
+#ifndef SHOT_EVENTS_H
+#define SHOT_EVENTS_H
+
+// =============================================================================
+// Shot Event Trace (what the stop engine saw, for the host replay)
+// =============================================================================
+// The shot log keeps the curve at 10 ms / 0.01 g steps - enough to look at,
+// not enough to explain a stop. Every unit records the inputs of the stop
+// engine instead, always, into a PSRAM ring:
+//
+//   W  weight sample    raw grams (float bits), sample-clock time, arrival
+//   C  scale command    ScaleCommand written (AcaiaArduinoBLE callback)
+//   A  scale ack        ScaleCommand the scale confirmed
+//   R  relay edge       group, on/off; a timer cut carries its scheduled time
+//   E  shot end         ShotEndReason, weight after the drip delay
+//
+// A shot's trace is the window from its start request to its end: the
+// shot log cuts it out of the ring after the drip delay (shotEventsCollect())
+// and keeps it on flash next to the record, one file per shot, the newest
+// SHOT_LOG_TRACES shots (shot_log.h). The header carries what the replay
+// needs to run the shot as the machine did: goal, offset, stop latency,
+// filter noise, estimator and the pump-on time.
+//
+// "shottrace <id>" prints a kept trace as text that tools/shot_replay reads
+// as is (the console prefix may stay in):
+//
+//   GSH,<version>,<id>,<goal>,<offset>,<latency>,<q>,<r>,<estimator>,<profile>,<end>,<start_us>,<events>,<dropped>
+//   GSE,W,<t_us>,<grams>,<arrival_us>
+//   GSE,C,<t_us>,<command>,<ok>
+//   GSE,A,<t_us>,<command>
+//   GSE,R,<t_us>,<group>,<on>,<scheduled_us | -1>
+//   GSE,E,<t_us>,<reason>,<grams>
+//
+// Times are microseconds since the start request; floats are printed with
+// 9 significant digits, which reads back to the same float.
+//
+// Thread Safety:
+//   shotEventsRecord() and its helpers - any task (control task, BLE task,
+//   esp_timer task, flush cycle), under a spinlock; not from an ISR.
+//   shotEventsShotRequested() - the UI task; the other shot calls and
+//   shotEventsCollect() - the control task.
+// =============================================================================
+
+#include <Arduino.h>
+
+#ifndef GS_SHOT_EVENTS
+#define GS_SHOT_EVENTS 1   // 0 = no ring, no traces (the calls compile to nothing)
+#endif
+static_assert(GS_SHOT_EVENTS == 0 || GS_SHOT_EVENTS == 1, "GS_SHOT_EVENTS must be 0 or 1");
+
+constexpr uint32_t SHOT_EVENTS_RING       = 2048;   // ~3 min of 10 Hz weights between shots
+constexpr uint16_t SHOT_TRACE_MAX_EVENTS  = 1536;   // Per shot on flash: 24 KB at most
+constexpr uint16_t SHOT_TRACE_MAGIC       = 0x5447; // "GT"
+constexpr uint8_t  SHOT_TRACE_VERSION     = 1;
+
+enum ShotEventType : uint8_t {
+  SHOT_EVENT_WEIGHT  = 'W',
+  SHOT_EVENT_COMMAND = 'C',
+  SHOT_EVENT_ACK     = 'A',
+  SHOT_EVENT_RELAY   = 'R',
+  SHOT_EVENT_END     = 'E',
+};
+
+// ShotTraceEvent::arg of a relay edge
+constexpr uint16_t SHOT_EVENT_RELAY_ON    = 0x01;
+constexpr uint16_t SHOT_EVENT_RELAY_TIMER = 0x02;   // Scheduled cut (relayControlScheduleOff)
+
+// One event as kept on flash (little endian)
+struct __attribute__((packed)) ShotTraceEvent {
+  int32_t tUs;        // Since the trace origin (start request)
+  uint32_t value;     // W, E: float bits of grams
+  int32_t extra;      // W: arrival - sample time; R timer cut: fired - scheduled; else 0
+  uint8_t type;       // ShotEventType
+  uint8_t code;       // C, A: ScaleCommand; R: group; E: ShotEndReason
+  uint16_t arg;       // C: write ok; R: SHOT_EVENT_RELAY_*
+};
+
+struct __attribute__((packed)) ShotTraceHeader {
+  uint16_t magic;
+  uint8_t version;
+  uint8_t estimator;      // StopEstimatorKind the shot ran
+  uint32_t shotId;        // Shot log record (set by the writer)
+  int64_t originUs;       // esp_timer at the start request
+  int32_t startUs;        // Pump on, since the origin
+  float goalG;
+  float offsetG;          // weightOffset the predictor used
+  float latencyS;         // stopModelLatencyS() at pump-on
+  float processNoise;     // WeightFilter
+  float measurementNoise;
+  uint8_t profile;
+  uint8_t endReason;      // ShotEndReason
+  uint16_t events;
+  uint16_t dropped;       // Lost to the ring wrapping before the trace was cut
+  uint16_t eventsCrc;     // CRC-16/CCITT of the events
+};
+
+static_assert(sizeof(ShotTraceEvent) == 16, "ShotTraceEvent is a file format");
+static_assert(sizeof(ShotTraceHeader) == 48, "ShotTraceHeader is a file format");
+
+// Stop engine settings of the shot, taken when it arms
+struct ShotTraceModel {
+  float goalG;
+  float offsetG;
+  float latencyS;
+  float processNoise;
+  float measurementNoise;
+  uint8_t estimator;
+  uint8_t profile;
+};
+
+/**
+ * @brief Allocate the ring (setup); recording starts at once
+ */
+void shotEventsBegin();
+
+/**
+ * @brief Add one event at esp_timer time `us` (any task); the oldest is overwritten when full
+ */
+void shotEventsRecord(ShotEventType type, uint8_t code, uint16_t arg, uint32_t value, int32_t extra, int64_t us);
+
+inline void shotEventsWeight(float grams, int64_t sampleUs, int64_t arrivalUs)
+{
+  uint32_t bits;
+  memcpy(&bits, &grams, sizeof(bits));
+  shotEventsRecord(SHOT_EVENT_WEIGHT, 0, 0, bits, (int32_t)(arrivalUs - sampleUs), sampleUs);
+}
+
+/**
+ * @brief A new shot was requested: its trace starts here (before the scale commands)
+ */
+void shotEventsShotRequested();
+
+/**
+ * @brief The shot armed - pump on at startUs, with the settings the stop engine runs
+ */
+void shotEventsShotArmed(int64_t startUs, const ShotTraceModel &model);
+
+/**
+ * @brief The shot is over (after the drip delay): end event, the trace stops growing
+ */
+void shotEventsShotEnded(uint8_t endReason, float finalG);
+
+/**
+ * @brief Copy the ended shot's trace out of the ring (control task, for the shot log)
+ * @return Events copied; 0 if no shot armed since the last collect
+ */
+uint16_t shotEventsCollect(ShotTraceHeader *header, ShotTraceEvent *events, uint16_t maxEvents);
+
+/**
+ * @brief One trace as GSH / GSE lines (the format above)
+ */
+void shotEventsPrint(Print &out, const ShotTraceHeader &header, const ShotTraceEvent *events, uint16_t count);
+
+/**
+ * @brief Ring fill, the current window and counters
+ */
+void shotEventsDump(Print &out);
+
+#endif // SHOT_EVENTS_H
@@ -0,0 +1,278 @@
+// =============================================================================
+// Streaming Shot Export Implementation
+// =============================================================================
+
+#include "shot_export.h"
+#include "shot_log.h"
+#include "debug_config.h"
+#include "mem_caps.h"
+#include "metrics.h"
+#include "wifi_coex.h"
+#include <ESPAsyncWebServer.h>
+
+static constexpr LogTag TAG = LOG_TAG_WIFI;
+
+// Same order as ShotEndReason
+static const char *const END_REASONS[] = {"weight", "time", "button", "disconnected", "user", "undefined", "anomaly"};
+
+enum ExportFormat : uint8_t { EXPORT_CSV, EXPORT_CSV_SAMPLES, EXPORT_JSON };
+
+enum ExportPhase : uint8_t {
+  PHASE_PREAMBLE,   // CSV header row / "["
+  PHASE_SHOT,       // Read the next record
+  PHASE_SAMPLES,    // Sample rows of the current record
+  PHASE_SHOT_END,   // JSON "]}"
+  PHASE_EPILOGUE,   // JSON "]"
+  PHASE_DONE
+};
+
+struct ExportCursor {
+  bool active;
+  uint32_t generation;  // Ties callbacks of a finished request to their own export
+  ExportFormat format;
+  ExportPhase phase;
+  uint32_t next;        // Next shot log index
+  uint32_t end;         // One past the last index to export
+  uint32_t shots;       // Shots emitted (JSON separators)
+  ShotLogHeader header;
+  ShotSample *samples;  // SHOT_LOG_MAX_SAMPLES, sample formats only
+  int sampleCount;
+  int sample;
+  char line[SHOT_EXPORT_LINE];
+  size_t lineLen;
+  size_t linePos;       // Bytes of `line` already sent
+  uint32_t startMs;
+  uint32_t bytes;
+};
+
+static MetricCounter exportsTotal("shot_exports_total", "Shot exports started");
+static MetricCounter exportsBusy("shot_exports_busy_total", "Shot exports refused (one already running)");
+static MetricCounter exportBytes("shot_export_bytes_total", "Shot export bytes sent");
+
+static ExportCursor cursor;
+
+static void closeExport(uint32_t generation)
+{
+  if (!cursor.active || cursor.generation != generation)
+    return;
+  if (cursor.phase == PHASE_DONE)
+    LOG_DEBUG(TAG, "📤 Shot export: %lu shots, %lu bytes in %lums", (unsigned long)cursor.shots,
+              (unsigned long)cursor.bytes, (unsigned long)(millis() - cursor.startMs));
+  else
+    LOG_DEBUG(TAG, "📤 Shot export aborted after %lu shots", (unsigned long)cursor.shots);
+  memCapsFree(cursor.samples, SHOT_LOG_MAX_SAMPLES * sizeof(ShotSample), MEM_OWNER_SHOT_EXPORT);
+  cursor.samples = NULL;
+  cursor.active = false;
+}
+
+static bool openExport(ExportFormat format, uint32_t last)
+{
+  if (cursor.active)
+    return false;
+  ShotSample *samples = NULL;
+  if (format != EXPORT_CSV) {
+    samples = (ShotSample *)memCapsAlloc(SHOT_LOG_MAX_SAMPLES * sizeof(ShotSample), MEM_PSRAM, MEM_OWNER_SHOT_EXPORT);
+    if (samples == NULL)
+      return false;
+  }
+  uint32_t count = shotLogCount();
+  cursor.active = true;
+  cursor.generation++;
+  cursor.format = format;
+  cursor.phase = PHASE_PREAMBLE;
+  cursor.next = (last > 0 && count > last) ? count - last : 0;
+  cursor.end = count;  // Shots logged during the export are left for the next one
+  cursor.shots = 0;
+  cursor.samples = samples;
+  cursor.sampleCount = 0;
+  cursor.sample = 0;
+  cursor.lineLen = 0;
+  cursor.linePos = 0;
+  cursor.startMs = millis();
+  cursor.bytes = 0;
+  exportsTotal.add();
+  return true;
+}
+
+static void setLine(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+static void setLine(const char *fmt, ...)
+{
+  va_list args;
+  va_start(args, fmt);
+  int n = vsnprintf(cursor.line, sizeof(cursor.line), fmt, args);
+  va_end(args);
+  cursor.lineLen = (n < 0) ? 0 : min((size_t)n, sizeof(cursor.line) - 1);
+  cursor.linePos = 0;
+}
+
+static const char *reasonName(uint8_t reason)
+{
+  reason &= SHOT_LOG_REASON_MASK;
+  return END_REASONS[reason < 7 ? reason : 5];
+}
+
+// Read the next record into the cursor; false when none is left
+static bool readShot()
+{
+  while (cursor.next < cursor.end) {
+    uint32_t index = cursor.next++;
+    if (cursor.format == EXPORT_CSV) {
+      if (shotLogReadHeader(index, &cursor.header))
+        return true;
+    } else {
+      cursor.sampleCount = shotLogRead(index, &cursor.header, cursor.samples, SHOT_LOG_MAX_SAMPLES);
+      cursor.sample = 0;
+      if (cursor.sampleCount >= 0)
+        return true;
+    }
+    LOG_WARN(TAG, "⚠️ Shot export: record %lu unreadable, skipped", (unsigned long)index);
+  }
+  return false;
+}
+
+/**
+ * @brief Produce the next line into cursor.line
+ * @return false to wait (shot brewing); the line may be empty on a phase change
+ */
+static bool nextLine()
+{
+  const ShotLogHeader &h = cursor.header;
+  cursor.lineLen = 0;
+  cursor.linePos = 0;
+
+  switch (cursor.phase) {
+    case PHASE_PREAMBLE:
+      if (cursor.format == EXPORT_CSV)
+        setLine("id,goal_g,offset_g,final_g,time_s,end,samples,anomaly\n");
+      else if (cursor.format == EXPORT_CSV_SAMPLES)
+        setLine("id,t_s,weight_g\n");
+      else
+        setLine("[");
+      cursor.phase = PHASE_SHOT;
+      return true;
+
+    case PHASE_SHOT:
+      if (shotLogBusy() || wifiCoexQuiet())
+        return false;  // No flash reads while brewing, no Wi-Fi traffic while the scale link needs the radio
+      if (!readShot()) {
+        cursor.phase = PHASE_EPILOGUE;
+        return true;
+      }
+      if (cursor.format == EXPORT_CSV) {
+        setLine("%lu,%.1f,%.2f,%.2f,%.1f,%s,%u,%s\n", (unsigned long)h.id, h.goalDg / 10.0f, h.offsetCg / 100.0f,
+                h.finalCg / 100.0f, h.durationDs / 10.0f, reasonName(h.endReason), h.sampleCount,
+                FlowAnomaly::name(shotLogAnomaly(h)));
+      } else {
+        if (cursor.format == EXPORT_JSON)
+          setLine("%s{\"id\":%lu,\"goal_g\":%.1f,\"offset_g\":%.2f,\"final_g\":%.2f,\"time_s\":%.1f,"
+                  "\"end\":\"%s\",\"anomaly\":\"%s\",\"samples\":[",
+                  cursor.shots > 0 ? ",\n" : "\n", (unsigned long)h.id, h.goalDg / 10.0f, h.offsetCg / 100.0f,
+                  h.finalCg / 100.0f, h.durationDs / 10.0f, reasonName(h.endReason),
+                  FlowAnomaly::name(shotLogAnomaly(h)));
+        cursor.phase = PHASE_SAMPLES;
+      }
+      cursor.shots++;
+      return true;
+
+    case PHASE_SAMPLES:
+      if (cursor.sample >= cursor.sampleCount) {
+        cursor.phase = (cursor.format == EXPORT_JSON) ? PHASE_SHOT_END : PHASE_SHOT;
+        return true;
+      }
+      {
+        const ShotSample &s = cursor.samples[cursor.sample];
+        if (cursor.format == EXPORT_JSON)
+          setLine("%s[%.2f,%.2f]", cursor.sample > 0 ? "," : "", s.seconds(), s.grams());
+        else
+          setLine("%lu,%.2f,%.2f\n", (unsigned long)h.id, s.seconds(), s.grams());
+      }
+      cursor.sample++;
+      return true;
+
+    case PHASE_SHOT_END:
+      setLine("]}");
+      cursor.phase = PHASE_SHOT;
+      return true;
+
+    case PHASE_EPILOGUE:
+      if (cursor.format == EXPORT_JSON)
+        setLine("\n]\n");
+      cursor.phase = PHASE_DONE;
+      return true;
+
+    case PHASE_DONE:
+      break;
+  }
+  return true;
+}
+
+// AwsResponseFiller: fill up to maxLen bytes, 0 = end of response
+static size_t fillChunk(uint32_t generation, uint8_t *buffer, size_t maxLen)
+{
+  if (!cursor.active || cursor.generation != generation)
+    return 0;
+  size_t out = 0;
+  bool readThisCall = false;
+
+  while (out < maxLen) {
+    if (cursor.linePos < cursor.lineLen) {
+      size_t n = min(cursor.lineLen - cursor.linePos, maxLen - out);
+      memcpy(buffer + out, cursor.line + cursor.linePos, n);
+      cursor.linePos += n;
+      out += n;
+      continue;
+    }
+    if (cursor.phase == PHASE_DONE)
+      break;
+    if (cursor.phase == PHASE_SHOT) {
+      if (readThisCall && out > 0)
+        break;  // One record per callback - send what we have
+      readThisCall = true;
+    }
+    if (!nextLine()) {
+      if (out == 0)
+        return RESPONSE_TRY_AGAIN;
+      break;
+    }
+  }
+
+  cursor.bytes += out;
+  exportBytes.add(out);
+  if (out == 0)
+    closeExport(generation);
+  return out;
+}
+
+static void handleExport(AsyncWebServerRequest *request, ExportFormat format, const char *contentType)
+{
+  uint32_t last = 0;
+  if (request->hasParam("last")) {
+    long n = request->getParam("last")->value().toInt();
+    last = (n > 0) ? (uint32_t)n : 0;
+  }
+
+  if (wifiCoexDeferRequest(request))
+    return;
+  if (!openExport(format, last)) {
+    exportsBusy.add();
+    request->send(503, "text/plain", "Shot export already running\n");
+    return;
+  }
+  uint32_t generation = cursor.generation;
+  request->onDisconnect([generation]() { closeExport(generation); });
+  request->send(request->beginChunkedResponse(contentType, [generation](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+    (void)index;
+    return fillChunk(generation, buffer, maxLen);
+  }));
+}
+
+void shotExportRegister(AsyncWebServer &server)
+{
+  server.on("/shots.csv", HTTP_GET, [](AsyncWebServerRequest *request) {
+    bool samples = request->hasParam("samples") && request->getParam("samples")->value() != "0";
+    handleExport(request, samples ? EXPORT_CSV_SAMPLES : EXPORT_CSV, "text/csv");
+  });
+  server.on("/shots.json", HTTP_GET, [](AsyncWebServerRequest *request) {
+    handleExport(request, EXPORT_JSON, "application/json");
+  });
+}
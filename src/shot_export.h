@@ -0,0 +1,47 @@
+#ifndef SHOT_EXPORT_H
+#define SHOT_EXPORT_H
+
+// =============================================================================
+// Streaming Shot Export (HTTP, chunked)
+// =============================================================================
+// Serves the shot log as CSV or JSON without building the response in RAM:
+//
+//   /shots.csv             one row per shot (id, goal, offset, final, time,
+//                          end reason, samples)
+//   /shots.csv?samples=1   one row per sample (id, t_s, weight_g)
+//   /shots.json            [{...header fields..., "samples":[[t,w],...]}]
+//   ?last=N                only the newest N shots (default: all)
+//
+// The response is chunked; each chunk callback formats rows into the TCP
+// buffer it is handed, one line at a time through a SHOT_EXPORT_LINE byte
+// scratch line (a line that does not fit is continued in the next chunk).
+// At most one record is read from flash per callback, so the async_tcp task
+// never holds the shot log mutex for long. Memory is fixed whatever the
+// export size: the line, plus one decoded shot (SHOT_LOG_MAX_SAMPLES
+// samples, 8 KB in PSRAM) for the sample formats.
+//
+// While a shot brews the callback returns RESPONSE_TRY_AGAIN instead of
+// touching flash, so an export running across a shot pauses and resumes
+// after it (the shot log writer waits the same way). The same holds while
+// Wi-Fi is quiet for a scale connection; new requests then get 503 +
+// Retry-After (wifi_coex.h).
+//
+// One export at a time - a second request gets 503.
+//
+// Thread Safety:
+//   Chunk callbacks run in the async_tcp task; the cursor is only touched
+//   there. Shot log reads take the shot log mutex.
+// =============================================================================
+
+#include <Arduino.h>
+
+class AsyncWebServer;
+
+constexpr size_t SHOT_EXPORT_LINE = 160;   // Longest generated line (JSON shot head)
+
+/**
+ * @brief Register /shots.csv and /shots.json on `server`
+ */
+void shotExportRegister(AsyncWebServer &server);
+
+#endif // SHOT_EXPORT_H
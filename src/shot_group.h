@@ -0,0 +1,64 @@
+#ifndef SHOT_GROUP_H
+#define SHOT_GROUP_H
+
+// =============================================================================
+// Brew Groups: per-group hardware of a multi-group machine
+// =============================================================================
+// One controller drives the pump outputs of GS_GROUP_COUNT groups. A group is
+// indexed 0..GS_GROUP_COUNT-1 everywhere a per-group API takes one. Group 0
+// is the stock wiring (RELAY1) and the default of every call that takes a
+// group, so a single-group build reads as before.
+//
+// What is per group so far:
+//   - The relay channel: pin, cached state, cut-off timer and latch
+//     (relay_control.h). Each channel has its own esp_timer, so one
+//     group's scheduled stop cannot delay another's.
+//   - Boot state and read-back: every configured relay starts LOW and the
+//     control task verifies all of them, busy or not.
+//
+// The shot engine, the scale link and the main screen still serve group 0.
+// Extra groups are held off until those are split as well.
+//
+// Cost per added group, for the numbers to hold later:
+//   - Control task: one relay read-back per RELAY_VERIFY_MS (a GPIO read).
+//   - esp_timer: one timer, idle unless a cut is armed.
+//
+// GS_GROUP_COUNT (compile-time, -DGS_GROUP_COUNT=n): 1 (default) or 2.
+// GS_GROUP2_RELAY_PIN: second group's relay; check it against the wiring.
+//
+// Thread Safety:
+//   Constant tables - any task.
+// =============================================================================
+
+#include <Arduino.h>
+
+#ifndef GS_GROUP_COUNT
+#define GS_GROUP_COUNT 1
+#endif
+
+#ifndef GS_GROUP1_RELAY_PIN
+#define GS_GROUP1_RELAY_PIN 48    // RELAY1
+#endif
+#ifndef GS_GROUP2_RELAY_PIN
+#define GS_GROUP2_RELAY_PIN 2
+#endif
+
+constexpr uint8_t SHOT_GROUP_MAX = 2;
+static_assert(GS_GROUP_COUNT >= 1 && GS_GROUP_COUNT <= SHOT_GROUP_MAX, "GS_GROUP_COUNT: 1 or 2");
+
+struct ShotGroupConfig {
+  const char *name;
+  int relayPin;
+};
+
+static constexpr ShotGroupConfig SHOT_GROUPS[SHOT_GROUP_MAX] = {
+  {"group 1", GS_GROUP1_RELAY_PIN},
+  {"group 2", GS_GROUP2_RELAY_PIN},
+};
+
+inline const ShotGroupConfig &shotGroupConfig(uint8_t group)
+{
+  return SHOT_GROUPS[group < GS_GROUP_COUNT ? group : 0];
+}
+
+#endif // SHOT_GROUP_H
@@ -0,0 +1,235 @@
+// =============================================================================
+// Shot History Screen Implementation
+// =============================================================================
+
+#include "shot_history.h"
+#include "shot_log.h"
+#include "debug_config.h"
+#include "screen_nav.h"
+#include <ui.h>
+
+static constexpr LogTag TAG = LOG_TAG_UI;
+
+static constexpr lv_coord_t LIST_WIDTH  = 300;
+static constexpr lv_coord_t ROW_HEIGHT  = 24;
+static constexpr lv_coord_t CHART_WIDTH = 300;
+static constexpr lv_coord_t CHART_HEIGHT = 120;
+static constexpr uint32_t NO_SHOT = UINT32_MAX;
+
+// Same order as ShotEndReason
+static const char *const END_REASONS[] = {"weight", "max time", "button", "disconnected", "stopped", "?", "anomaly"};
+
+static lv_obj_t *settingsScreen = NULL;
+static lv_obj_t *screen = NULL;
+static lv_obj_t *rows[SHOT_HISTORY_PAGE];
+static lv_obj_t *rowLabels[SHOT_HISTORY_PAGE];
+static uint32_t rowIndex[SHOT_HISTORY_PAGE];   // Shot log index per row, NO_SHOT = empty
+static lv_obj_t *pageLabel = NULL;
+static lv_obj_t *chart = NULL;
+static lv_chart_series_t *weightSeries = NULL;
+static lv_obj_t *detailLabel = NULL;
+
+static uint32_t shotCount = 0;   // Snapshot taken on entry - the page math stays stable while browsing
+static uint32_t page = 0;        // 0 = newest
+
+static const char *reasonName(uint8_t reason)
+{
+  reason &= SHOT_LOG_REASON_MASK;
+  return END_REASONS[reason < 7 ? reason : 5];
+}
+
+static uint32_t pageCount()
+{
+  return shotCount ? (shotCount + SHOT_HISTORY_PAGE - 1) / SHOT_HISTORY_PAGE : 1;
+}
+
+// Resample the curve onto the chart's evenly spaced time axis (last sample per slot wins)
+static void showShot(uint32_t index)
+{
+  lv_chart_set_all_value(chart, weightSeries, LV_CHART_POINT_NONE);
+
+  ShotLogHeader header;
+  ShotSample *samples = (ShotSample *)malloc(SHOT_LOG_MAX_SAMPLES * sizeof(ShotSample));
+  int count = samples ? shotLogRead(index, &header, samples, SHOT_LOG_MAX_SAMPLES) : -1;
+  if (count <= 0) {
+    free(samples);
+    lv_label_set_text(detailLabel, count == 0 ? "No samples recorded" : "Shot unreadable");
+    lv_chart_refresh(chart);
+    return;
+  }
+
+  uint32_t lastMs = samples[count - 1].t_ms ? samples[count - 1].t_ms : 1;
+  int32_t top = header.goalDg + header.goalDg / 5;   // Goal + 20%, as the live chart
+  lv_coord_t *points = lv_chart_get_y_array(chart, weightSeries);
+  lv_coord_t previous = LV_CHART_POINT_NONE;
+  int next = 0;
+  for (uint16_t slot = 0; slot < SHOT_HISTORY_CHART_POINTS; slot++) {
+    uint32_t slotEndMs = (uint32_t)(slot + 1) * lastMs / SHOT_HISTORY_CHART_POINTS;
+    while (next < count && samples[next].t_ms <= slotEndMs) {
+      previous = (lv_coord_t)max(0, samples[next].weight_cg / 10);   // 0.1 g
+      next++;
+    }
+    points[slot] = previous;
+    if (previous != LV_CHART_POINT_NONE && previous > top)
+      top = previous;
+  }
+  free(samples);
+
+  lv_chart_set_range(chart, LV_CHART_AXIS_PRIMARY_Y, 0, (lv_coord_t)top);
+  lv_chart_refresh(chart);
+  char text[128];  // lv_label_set_text_fmt() has no %f (LV_SPRINTF_USE_FLOAT 0)
+  uint8_t anomaly = shotLogAnomaly(header);
+  snprintf(text, sizeof(text), "#%lu  goal %.1fg  final %.2fg  offset %.2fg\n%.1fs, %s, %d samples%s%s",
+           (unsigned long)header.id, header.goalDg / 10.0f, header.finalCg / 100.0f,
+           header.offsetCg / 100.0f, header.durationDs / 10.0f, reasonName(header.endReason), count,
+           anomaly ? ", " : "", FlowAnomaly::name(anomaly));
+  lv_label_set_text(detailLabel, text);
+}
+
+static void loadPage()
+{
+  uint32_t newest = shotCount ? shotCount - 1 : 0;
+  for (uint8_t i = 0; i < SHOT_HISTORY_PAGE; i++) {
+    uint32_t back = page * SHOT_HISTORY_PAGE + i;   // 0 = newest shot
+    ShotLogHeader header;
+    if (back < shotCount && shotLogReadHeader(newest - back, &header)) {
+      rowIndex[i] = newest - back;
+      char text[64];
+      snprintf(text, sizeof(text), "#%-4lu %5.1fg %6.2fg %5.1fs  %s%s", (unsigned long)header.id,
+               header.goalDg / 10.0f, header.finalCg / 100.0f, header.durationDs / 10.0f,
+               reasonName(header.endReason), shotLogAnomaly(header) ? " !" : "");
+      lv_label_set_text(rowLabels[i], text);
+      lv_obj_clear_flag(rows[i], LV_OBJ_FLAG_HIDDEN);
+    } else {
+      rowIndex[i] = NO_SHOT;
+      lv_obj_add_flag(rows[i], LV_OBJ_FLAG_HIDDEN);
+    }
+  }
+  lv_label_set_text_fmt(pageLabel, "%lu / %lu", (unsigned long)(page + 1), (unsigned long)pageCount());
+
+  if (rowIndex[0] != NO_SHOT) {
+    showShot(rowIndex[0]);
+  } else {
+    lv_chart_set_all_value(chart, weightSeries, LV_CHART_POINT_NONE);
+    lv_label_set_text(detailLabel, "No shots logged yet");
+  }
+}
+
+static void rowEvent(lv_event_t *e)
+{
+  uint32_t i = (uint32_t)(uintptr_t)lv_event_get_user_data(e);
+  if (rowIndex[i] != NO_SHOT)
+    showShot(rowIndex[i]);
+}
+
+static void pageEvent(lv_event_t *e)
+{
+  int step = (int)(intptr_t)lv_event_get_user_data(e);
+  if (step < 0 && page > 0)
+    page--;
+  else if (step > 0 && page + 1 < pageCount())
+    page++;
+  else
+    return;
+  loadPage();
+}
+
+static void backEvent(lv_event_t *e)
+{
+  (void)e;
+  screenNavGo(settingsScreen, LV_SCR_LOAD_ANIM_MOVE_RIGHT);
+}
+
+static lv_obj_t *smallButton(lv_obj_t *parent, const char *symbol)
+{
+  lv_obj_t *btn = lv_btn_create(parent);
+  lv_obj_set_size(btn, 28, 28);
+  lv_obj_set_style_bg_color(btn, lv_color_hex(0x1A1A1A), LV_PART_MAIN | LV_STATE_DEFAULT);
+  lv_obj_set_style_pad_all(btn, 0, LV_PART_MAIN);
+  lv_obj_t *label = lv_label_create(btn);
+  lv_label_set_text(label, symbol);
+  lv_obj_center(label);
+  return btn;
+}
+
+static void createScreen()
+{
+  screen = lv_obj_create(NULL);
+  lv_obj_clear_flag(screen, LV_OBJ_FLAG_SCROLLABLE);
+  lv_obj_set_style_bg_color(screen, lv_color_hex(0x000000), LV_PART_MAIN | LV_STATE_DEFAULT);
+
+  lv_obj_t *list = lv_obj_create(screen);
+  lv_obj_remove_style_all(list);
+  lv_obj_set_size(list, LIST_WIDTH, lv_pct(100));
+  lv_obj_align(list, LV_ALIGN_LEFT_MID, 8, 0);
+  lv_obj_set_flex_flow(list, LV_FLEX_FLOW_COLUMN);
+  lv_obj_set_flex_align(list, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_START);
+  lv_obj_set_style_pad_row(list, 3, LV_PART_MAIN);
+  lv_obj_clear_flag(list, LV_OBJ_FLAG_SCROLLABLE);
+
+  for (uint8_t i = 0; i < SHOT_HISTORY_PAGE; i++) {
+    rows[i] = lv_btn_create(list);
+    lv_obj_set_size(rows[i], LIST_WIDTH, ROW_HEIGHT);
+    lv_obj_set_style_bg_color(rows[i], lv_color_hex(0x232323), LV_PART_MAIN | LV_STATE_DEFAULT);
+    lv_obj_set_style_pad_ver(rows[i], 0, LV_PART_MAIN);
+    lv_obj_add_event_cb(rows[i], rowEvent, LV_EVENT_CLICKED, (void *)(uintptr_t)i);
+    rowLabels[i] = lv_label_create(rows[i]);
+    lv_obj_set_style_text_font(rowLabels[i], &lv_font_montserrat_14, LV_PART_MAIN);
+    lv_obj_align(rowLabels[i], LV_ALIGN_LEFT_MID, 0, 0);
+  }
+
+  lv_obj_t *pager = lv_obj_create(list);
+  lv_obj_remove_style_all(pager);
+  lv_obj_set_size(pager, LIST_WIDTH, 28);
+  lv_obj_set_flex_flow(pager, LV_FLEX_FLOW_ROW);
+  lv_obj_set_flex_align(pager, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+  lv_obj_set_style_pad_column(pager, 16, LV_PART_MAIN);
+  lv_obj_add_event_cb(smallButton(pager, LV_SYMBOL_LEFT), pageEvent, LV_EVENT_CLICKED, (void *)(intptr_t)-1);
+  pageLabel = lv_label_create(pager);
+  lv_obj_add_event_cb(smallButton(pager, LV_SYMBOL_RIGHT), pageEvent, LV_EVENT_CLICKED, (void *)(intptr_t)1);
+
+  chart = lv_chart_create(screen);
+  lv_obj_set_size(chart, CHART_WIDTH, CHART_HEIGHT);
+  lv_obj_align(chart, LV_ALIGN_TOP_RIGHT, -8, 4);
+  lv_obj_clear_flag(chart, LV_OBJ_FLAG_CLICKABLE | LV_OBJ_FLAG_SCROLLABLE);
+  lv_obj_set_style_pad_all(chart, 4, LV_PART_MAIN);
+  lv_obj_set_style_size(chart, 0, LV_PART_INDICATOR);
+  lv_obj_set_style_line_width(chart, 2, LV_PART_ITEMS);
+  lv_chart_set_type(chart, LV_CHART_TYPE_LINE);
+  lv_chart_set_point_count(chart, SHOT_HISTORY_CHART_POINTS);
+  lv_chart_set_div_line_count(chart, 3, 0);
+  weightSeries = lv_chart_add_series(chart, lv_palette_main(LV_PALETTE_BROWN), LV_CHART_AXIS_PRIMARY_Y);
+
+  detailLabel = lv_label_create(screen);
+  lv_obj_set_width(detailLabel, CHART_WIDTH - 32);
+  lv_obj_set_style_text_font(detailLabel, &lv_font_montserrat_14, LV_PART_MAIN);
+  lv_obj_align(detailLabel, LV_ALIGN_BOTTOM_RIGHT, -40, -4);
+
+  lv_obj_t *back = lv_btn_create(screen);
+  lv_obj_set_size(back, 28, 28);
+  lv_obj_align(back, LV_ALIGN_BOTTOM_RIGHT, -1, -1);
+  lv_obj_set_style_bg_color(back, lv_color_hex(0x1A1A1A), LV_PART_MAIN | LV_STATE_DEFAULT);
+  lv_obj_set_style_bg_img_src(back, &ui_img_return_png, LV_PART_MAIN | LV_STATE_DEFAULT);
+  lv_obj_add_event_cb(back, backEvent, LV_EVENT_CLICKED, NULL);
+}
+
+static void enterEvent(lv_event_t *e)
+{
+  (void)e;
+  if (screen == NULL)
+    createScreen();
+  shotCount = shotLogCount();
+  page = 0;
+  uint32_t start = millis();
+  loadPage();
+  LOG_DEBUG(TAG, "Shot history: %lu shots, first page in %lums", (unsigned long)shotCount, millis() - start);
+  screenNavGo(screen, LV_SCR_LOAD_ANIM_MOVE_LEFT);
+}
+
+void shotHistoryCreate(lv_obj_t *settings)
+{
+  settingsScreen = settings;
+  lv_obj_t *btn = smallButton(settings, LV_SYMBOL_LIST);
+  lv_obj_align(btn, LV_ALIGN_TOP_LEFT, 1, 1);
+  lv_obj_add_event_cb(btn, enterEvent, LV_EVENT_CLICKED, NULL);
+}
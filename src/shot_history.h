@@ -0,0 +1,40 @@
+#ifndef SHOT_HISTORY_H
+#define SHOT_HISTORY_H
+
+// =============================================================================
+// Shot History Screen
+// =============================================================================
+// A third screen next to ui_MainScreen / ui_SettingScreen, reached from a
+// list button on the settings screen. It is built in code (lib/ui is the
+// SquareLine export) and only on first entry:
+//
+//   ┌───────────────────────────┬──────────────────────────────────────┐
+//   │ #128  36.0g  36.4g  28.3s │  selected shot: weight curve         │
+//   │ #127  36.0g  35.8g  27.9s │  (SHOT_HISTORY_CHART_POINTS points,  │
+//   │ ...   SHOT_HISTORY_PAGE   │   resampled over the shot time)      │
+//   │ [<]  page 1/26  [>]       │  goal / final / offset / end reason  │
+//   └───────────────────────────┴──────────────────────────────────────┘
+//
+// Lazy loading: a page change reads SHOT_HISTORY_PAGE headers through
+// shotLogReadHeader() (one index + one header read each), newest first.
+// Only the selected shot's body is decoded, into a temporary buffer that is
+// freed once its chart points are set. Memory is bounded by one page and
+// one shot whatever the history size.
+//
+// Thread Safety:
+//   UI task (Core 1) only - LVGL. Shot log reads take the shot log mutex.
+// =============================================================================
+
+#include <Arduino.h>
+#include "lvgl.h"
+
+constexpr uint8_t SHOT_HISTORY_PAGE          = 5;    // Rows per page
+constexpr uint16_t SHOT_HISTORY_CHART_POINTS = 80;
+
+/**
+ * @brief Add the history button to `settingsScreen` (after ui_init())
+ * @note The history screen itself is created on first use
+ */
+void shotHistoryCreate(lv_obj_t *settingsScreen);
+
+#endif // SHOT_HISTORY_H
@@ -0,0 +1,456 @@
+// =============================================================================
+// Persistent Shot Log Implementation
+// =============================================================================
+
+#include "shot_log.h"
+#include "debug_config.h"
+#include "task_layout.h"
+#include "metrics.h"
+#include "shot_state.h"
+#include "static_alloc.h"
+#include "mem_caps.h"
+#include <LittleFS.h>
+
+static constexpr LogTag TAG = LOG_TAG_SHOT;
+
+static const char *SHOT_LOG_PARTITION = "shotlog";   // partitions.csv label
+static const char *SHOT_LOG_MOUNT     = "/shotlog";
+static const char *DATA_PATH     = "/log.bin";
+static const char *INDEX_PATH    = "/log.idx";
+static const char *OLD_DATA_PATH = "/old.bin";
+static const char *OLD_INDEX_PATH = "/old.idx";
+static const char *TRACE_PATH_FORMAT = "/t%lu.bin";
+
+static constexpr uint32_t WRITER_DEFER_MS = 500;      // Poll interval while a shot is brewing
+static constexpr size_t MAX_BODY_BYTES = SHOT_LOG_MAX_SAMPLES * 6;  // Two 3-byte varints per sample, worst case
+
+static MetricCounter shotLogWrites("shot_log_records_total", "Shots written to the shot log");
+static MetricCounter shotLogDropped("shot_log_dropped_total", "Shots not logged (writer busy, no filesystem)");
+static MetricCounter shotLogTraces("shot_log_traces_total", "Shot event traces written next to their record");
+static MetricHistogram shotLogWriteMs("shot_log_write_ms", "Shot log append (record + index)", METRIC_BUCKETS_MS);
+
+static SemaphoreHandle_t fsMutex = NULL;
+static StaticMutex fsMutexStore;
+static TaskHandle_t writerTask = NULL;
+static bool mounted = false;
+
+// Segment bookkeeping (fsMutex)
+static uint32_t oldCount = 0;
+static uint32_t curCount = 0;
+static uint32_t curBytes = 0;
+static uint32_t nextId = 1;
+
+// Single pending record: filled by shotLogSubmit(), written and released by the writer task
+static ShotLogHeader pendingHeader;
+static uint8_t *pendingBody = NULL;
+static volatile bool pendingReady = false;
+static ShotTraceHeader pendingTraceHeader;
+static ShotTraceEvent *pendingTrace = NULL;   // NULL: records go without a trace
+
+static uint16_t crc16(const uint8_t *data, size_t length)
+{
+  uint16_t crc = 0xFFFF;
+  for (size_t i = 0; i < length; i++) {
+    crc ^= (uint16_t)data[i] << 8;
+    for (int bit = 0; bit < 8; bit++)
+      crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+  }
+  return crc;
+}
+
+static size_t putVarint(uint8_t *out, uint32_t v)
+{
+  size_t n = 0;
+  while (v >= 0x80) {
+    out[n++] = (uint8_t)(v | 0x80);
+    v >>= 7;
+  }
+  out[n++] = (uint8_t)v;
+  return n;
+}
+
+static bool getVarint(const uint8_t *in, size_t length, size_t *pos, uint32_t *v)
+{
+  uint32_t result = 0;
+  for (int shift = 0; shift < 32 && *pos < length; shift += 7) {
+    uint8_t b = in[(*pos)++];
+    result |= (uint32_t)(b & 0x7F) << shift;
+    if (!(b & 0x80)) {
+      *v = result;
+      return true;
+    }
+  }
+  return false;
+}
+
+static inline uint32_t zigzag(int32_t v) { return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31); }
+static inline int32_t unzigzag(uint32_t v) { return (int32_t)(v >> 1) ^ -(int32_t)(v & 1); }
+
+// Read the header of the record at data-file offset `offset`
+static bool readHeaderAt(File &data, uint32_t offset, ShotLogHeader *header)
+{
+  if (!data.seek(offset) || data.read((uint8_t *)header, sizeof(*header)) != sizeof(*header))
+    return false;
+  return header->magic == SHOT_LOG_MAGIC && header->version == SHOT_LOG_VERSION &&
+         offset + sizeof(*header) + header->bodyBytes <= data.size();
+}
+
+static bool readIndexEntry(File &index, uint32_t i, uint32_t *offset)
+{
+  return index.seek(i * sizeof(uint32_t)) && index.read((uint8_t *)offset, sizeof(*offset)) == sizeof(*offset);
+}
+
+// Entries of one segment that point at a complete record; a torn tail is cut off
+static uint32_t scanSegment(const char *dataPath, const char *indexPath, uint32_t *lastId, uint32_t *dataBytes)
+{
+  File index = LittleFS.open(indexPath, FILE_READ);
+  File data = LittleFS.open(dataPath, FILE_READ);
+  if (!index || !data)
+    return 0;
+
+  uint32_t entries = index.size() / sizeof(uint32_t);
+  uint32_t valid = entries;
+  ShotLogHeader header;
+  uint32_t offset;
+  while (valid > 0 && !(readIndexEntry(index, valid - 1, &offset) && readHeaderAt(data, offset, &header)))
+    valid--;
+  if (valid > 0)
+    *lastId = header.id;
+  if (dataBytes != NULL)
+    *dataBytes = data.size();
+  index.close();
+  data.close();
+
+  if (valid < entries) {
+    LOG_WARN(TAG, "⚠️  Shot log: dropping %lu torn index entries in %s", (unsigned long)(entries - valid), indexPath);
+    File in = LittleFS.open(indexPath, FILE_READ);
+    File out = LittleFS.open("/tmp.idx", FILE_WRITE);
+    for (uint32_t i = 0; i < valid && in && out; i++) {
+      readIndexEntry(in, i, &offset);
+      out.write((const uint8_t *)&offset, sizeof(offset));
+    }
+    in.close();
+    out.close();
+    LittleFS.remove(indexPath);
+    LittleFS.rename("/tmp.idx", indexPath);
+  }
+  return valid;
+}
+
+static void mountLog()
+{
+  if (!LittleFS.begin(true, SHOT_LOG_MOUNT, 4, SHOT_LOG_PARTITION)) {
+    LOG_ERROR(TAG, "❌ Shot log: no '%s' partition or mount failed - shots are not kept", SHOT_LOG_PARTITION);
+    return;
+  }
+
+  xSemaphoreTake(fsMutex, portMAX_DELAY);
+  uint32_t lastId = 0;
+  oldCount = scanSegment(OLD_DATA_PATH, OLD_INDEX_PATH, &lastId, NULL);
+  curCount = scanSegment(DATA_PATH, INDEX_PATH, &lastId, &curBytes);
+  nextId = lastId + 1;
+  mounted = true;
+  xSemaphoreGive(fsMutex);
+
+  LOG_INFO(TAG, "📚 Shot log: %lu shots kept, %lu / %lu KB used", (unsigned long)(oldCount + curCount),
+           (unsigned long)(LittleFS.usedBytes() / 1024), (unsigned long)(LittleFS.totalBytes() / 1024));
+}
+
+static void rotateSegments()
+{
+  LittleFS.remove(OLD_DATA_PATH);
+  LittleFS.remove(OLD_INDEX_PATH);
+  LittleFS.rename(DATA_PATH, OLD_DATA_PATH);
+  LittleFS.rename(INDEX_PATH, OLD_INDEX_PATH);
+  oldCount = curCount;
+  curCount = 0;
+  curBytes = 0;
+}
+
+static bool appendPending()
+{
+  xSemaphoreTake(fsMutex, portMAX_DELAY);
+  uint32_t recordBytes = sizeof(ShotLogHeader) + pendingHeader.bodyBytes;
+  if (curCount > 0 && curBytes + recordBytes > SHOT_LOG_SEGMENT_BYTES)
+    rotateSegments();
+
+  pendingHeader.id = nextId;
+  bool ok = false;
+  File data = LittleFS.open(DATA_PATH, FILE_APPEND);
+  if (data) {
+    uint32_t offset = data.size();
+    ok = data.write((const uint8_t *)&pendingHeader, sizeof(pendingHeader)) == sizeof(pendingHeader) &&
+         data.write(pendingBody, pendingHeader.bodyBytes) == pendingHeader.bodyBytes;
+    data.close();
+    if (ok) {
+      // The record is complete on flash before the index can point at it
+      File index = LittleFS.open(INDEX_PATH, FILE_APPEND);
+      ok = index && index.write((const uint8_t *)&offset, sizeof(offset)) == sizeof(offset);
+      index.close();
+    }
+    if (ok) {
+      curCount++;
+      curBytes = offset + recordBytes;
+      nextId++;
+    }
+  }
+  xSemaphoreGive(fsMutex);
+  return ok;
+}
+
+static void tracePath(char *path, size_t size, uint32_t id)
+{
+  snprintf(path, size, TRACE_PATH_FORMAT, (unsigned long)id);
+}
+
+// The pending record's trace, after the record (fsMutex held); drops the one SHOT_LOG_TRACES back
+static bool writePendingTrace()
+{
+  char path[16];
+  if (pendingHeader.id > SHOT_LOG_TRACES) {
+    tracePath(path, sizeof(path), pendingHeader.id - SHOT_LOG_TRACES);
+    if (LittleFS.exists(path))
+      LittleFS.remove(path);
+  }
+  if (pendingTraceHeader.events == 0)
+    return false;
+
+  pendingTraceHeader.shotId = pendingHeader.id;
+  size_t bytes = pendingTraceHeader.events * sizeof(ShotTraceEvent);
+  tracePath(path, sizeof(path), pendingHeader.id);
+  File file = LittleFS.open(path, FILE_WRITE);
+  bool ok = file && file.write((const uint8_t *)&pendingTraceHeader, sizeof(pendingTraceHeader)) ==
+                        sizeof(pendingTraceHeader) &&
+            file.write((const uint8_t *)pendingTrace, bytes) == bytes;
+  file.close();
+  if (!ok)
+    LittleFS.remove(path);   // A short trace would not replay the shot
+  return ok;
+}
+
+static void shotLogTask(void *parameter)
+{
+  mountLog();
+
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    // Flash writes stall both cores' caches - never while a shot is running
+    while (shotLogBusy())
+      vTaskDelay(pdMS_TO_TICKS(WRITER_DEFER_MS));
+
+    if (!pendingReady)
+      continue;
+    __sync_synchronize();  // Record contents are read only after seeing the flag
+
+    if (!mounted) {
+      shotLogDropped.add();
+    } else {
+      uint32_t start = millis();
+      if (appendPending()) {
+        shotLogWrites.add();
+        shotLogWriteMs.record(millis() - start);
+        xSemaphoreTake(fsMutex, portMAX_DELAY);
+        bool traced = writePendingTrace();
+        xSemaphoreGive(fsMutex);
+        if (traced)
+          shotLogTraces.add();
+        LOG_INFO(TAG, "📚 Shot #%lu logged: %u samples, %u bytes, trace %u events", (unsigned long)pendingHeader.id,
+                 pendingHeader.sampleCount, (unsigned)(sizeof(ShotLogHeader) + pendingHeader.bodyBytes),
+                 traced ? (unsigned)pendingTraceHeader.events : 0u);
+      } else {
+        shotLogDropped.add();
+        LOG_ERROR(TAG, "❌ Shot log: append failed (filesystem full?)");
+      }
+    }
+    pendingReady = false;
+  }
+}
+
+void shotLogBegin()
+{
+  fsMutex = fsMutexStore.create();
+  pendingBody = (uint8_t *)memCapsAlloc(MAX_BODY_BYTES, MEM_PSRAM_FIRST, MEM_OWNER_SHOT_LOG);
+  if (pendingBody == NULL) {
+    LOG_ERROR(TAG, "❌ Shot log: no memory, disabled");
+    return;
+  }
+  pendingTrace = (ShotTraceEvent *)memCapsAlloc(SHOT_TRACE_MAX_EVENTS * sizeof(ShotTraceEvent), MEM_PSRAM,
+                                                MEM_OWNER_SHOT_LOG);
+
+  if (taskLayoutSpawn(TASK_ROLE_PERSIST, shotLogTask, NULL, &writerTask) != pdPASS) {
+    LOG_ERROR(TAG, "❌ Failed to create shot log writer");
+    writerTask = NULL;
+  }
+}
+
+bool shotLogSubmit(const ShotLogHeader &header, const ShotSampleStore &samples)
+{
+  if (writerTask == NULL || pendingReady) {
+    shotLogDropped.add();
+    return false;
+  }
+
+  size_t count = samples.size();
+  size_t first = (count > SHOT_LOG_MAX_SAMPLES) ? count - SHOT_LOG_MAX_SAMPLES : 0;
+  size_t bytes = 0;
+  int32_t lastT = 0;
+  int32_t lastW = 0;
+  for (size_t i = first; i < count; i++) {
+    const ShotSample &s = samples[i];
+    bytes += putVarint(pendingBody + bytes, (uint32_t)(s.t_ms - lastT));
+    bytes += putVarint(pendingBody + bytes, zigzag(s.weight_cg - lastW));
+    lastT = s.t_ms;
+    lastW = s.weight_cg;
+  }
+
+  pendingHeader = header;
+  pendingHeader.magic = SHOT_LOG_MAGIC;
+  pendingHeader.version = SHOT_LOG_VERSION;
+  pendingHeader.sampleCount = (uint16_t)(count - first);
+  pendingHeader.bodyBytes = (uint16_t)bytes;
+  pendingHeader.bodyCrc = crc16(pendingBody, bytes);
+
+  pendingTraceHeader.events = 0;
+  if (pendingTrace != NULL && shotEventsCollect(&pendingTraceHeader, pendingTrace, SHOT_TRACE_MAX_EVENTS) > 0)
+    pendingTraceHeader.eventsCrc =
+        crc16((const uint8_t *)pendingTrace, pendingTraceHeader.events * sizeof(ShotTraceEvent));
+  __sync_synchronize();  // Record complete before the writer can see it
+  pendingReady = true;
+  xTaskNotifyGive(writerTask);
+  return true;
+}
+
+bool shotLogBusy()
+{
+  return shotStateTest(SHOT_STATE_BREWING);
+}
+
+uint32_t shotLogCount()
+{
+  if (fsMutex == NULL)
+    return 0;
+  xSemaphoreTake(fsMutex, portMAX_DELAY);
+  uint32_t count = oldCount + curCount;
+  xSemaphoreGive(fsMutex);
+  return count;
+}
+
+// Locate a record: segment files + data offset (fsMutex held)
+static bool openRecord(uint32_t index, File *data, ShotLogHeader *header)
+{
+  if (!mounted || index >= oldCount + curCount)
+    return false;
+  bool old = index < oldCount;
+  File idx = LittleFS.open(old ? OLD_INDEX_PATH : INDEX_PATH, FILE_READ);
+  uint32_t offset;
+  bool ok = idx && readIndexEntry(idx, old ? index : index - oldCount, &offset);
+  idx.close();
+  if (!ok)
+    return false;
+  *data = LittleFS.open(old ? OLD_DATA_PATH : DATA_PATH, FILE_READ);
+  return *data && readHeaderAt(*data, offset, header);
+}
+
+bool shotLogReadHeader(uint32_t index, ShotLogHeader *header)
+{
+  if (fsMutex == NULL)
+    return false;
+  xSemaphoreTake(fsMutex, portMAX_DELAY);
+  File data;
+  bool ok = openRecord(index, &data, header);
+  data.close();
+  xSemaphoreGive(fsMutex);
+  return ok;
+}
+
+int shotLogRead(uint32_t index, ShotLogHeader *header, ShotSample *samples, size_t maxSamples)
+{
+  if (fsMutex == NULL)
+    return -1;
+  xSemaphoreTake(fsMutex, portMAX_DELAY);
+  File data;
+  int decoded = -1;
+  uint8_t *body = NULL;
+  if (openRecord(index, &data, header)) {
+    body = (uint8_t *)malloc(header->bodyBytes ? header->bodyBytes : 1);
+    if (body != NULL && data.read(body, header->bodyBytes) == header->bodyBytes &&
+        crc16(body, header->bodyBytes) == header->bodyCrc) {
+      size_t pos = 0;
+      int32_t t = 0;
+      int32_t w = 0;
+      decoded = 0;
+      while ((size_t)decoded < maxSamples && decoded < header->sampleCount) {
+        uint32_t dt, dw;
+        if (!getVarint(body, header->bodyBytes, &pos, &dt) || !getVarint(body, header->bodyBytes, &pos, &dw)) {
+          decoded = -1;
+          break;
+        }
+        t += (int32_t)dt;
+        w += unzigzag(dw);
+        samples[decoded].t_ms = (uint16_t)t;
+        samples[decoded].weight_cg = (int16_t)w;
+        decoded++;
+      }
+    }
+  }
+  data.close();
+  xSemaphoreGive(fsMutex);
+  free(body);
+  return decoded;
+}
+
+int shotLogReadTrace(uint32_t id, ShotTraceHeader *header, ShotTraceEvent *events, uint16_t maxEvents)
+{
+  if (fsMutex == NULL || !mounted)
+    return -1;
+  char path[16];
+  tracePath(path, sizeof(path), id);
+  int count = -1;
+  xSemaphoreTake(fsMutex, portMAX_DELAY);
+  File file = LittleFS.exists(path) ? LittleFS.open(path, FILE_READ) : File();
+  if (file && file.read((uint8_t *)header, sizeof(*header)) == sizeof(*header) && header->magic == SHOT_TRACE_MAGIC &&
+      header->version == SHOT_TRACE_VERSION && header->events <= maxEvents) {
+    size_t bytes = header->events * sizeof(ShotTraceEvent);
+    if (file.read((uint8_t *)events, bytes) == bytes && crc16((const uint8_t *)events, bytes) == header->eventsCrc)
+      count = header->events;
+  }
+  file.close();
+  xSemaphoreGive(fsMutex);
+  return count;
+}
+
+void shotLogDump(Print &out, uint32_t last)
+{
+  // Same order as ShotEndReason
+  static const char *reasons[] = {"weight", "time", "button", "disconn", "user", "?", "anomaly"};
+  char line[96];
+
+  if (fsMutex == NULL || !mounted) {
+    out.print("Shot log: not mounted\n");
+    return;
+  }
+  xSemaphoreTake(fsMutex, portMAX_DELAY);
+  uint32_t count = oldCount + curCount;
+  snprintf(line, sizeof(line), "Shot log: %lu shots, %lu / %lu KB used\n", (unsigned long)count,
+           (unsigned long)(LittleFS.usedBytes() / 1024), (unsigned long)(LittleFS.totalBytes() / 1024));
+  out.print(line);
+  out.print("    id  goal  offset   final   time  end      samples  bytes\n");
+  uint32_t first = (count > last) ? count - last : 0;
+  for (uint32_t i = first; i < count; i++) {
+    File data;
+    ShotLogHeader h;
+    if (!openRecord(i, &data, &h)) {
+      data.close();
+      continue;
+    }
+    data.close();
+    uint8_t reason = shotLogReason(h);
+    snprintf(line, sizeof(line), "%6lu %5.1f %7.2f %7.2f %6.1f  %-8s %7u %6u  %s\n", (unsigned long)h.id,
+             h.goalDg / 10.0f, h.offsetCg / 100.0f, h.finalCg / 100.0f, h.durationDs / 10.0f,
+             reasons[reason < 7 ? reason : 5], h.sampleCount, (unsigned)(sizeof(h) + h.bodyBytes),
+             FlowAnomaly::name(shotLogAnomaly(h)));
+    out.print(line);
+  }
+  xSemaphoreGive(fsMutex);
+}
@@ -0,0 +1,121 @@
+#ifndef SHOT_LOG_H
+#define SHOT_LOG_H
+
+// =============================================================================
+// Persistent Shot Log (LittleFS, "shotlog" partition)
+// =============================================================================
+// Every finished shot is kept as one binary record, so the curve survives
+// the next shot and a reboot:
+//
+//   ShotLogHeader (22 bytes)  goal, offset, final weight, duration, end
+//                             reason + flow anomaly flags, sample count,
+//                             body length + CRC-16
+//   body                      samples as (dt_ms, dweight_cg) pairs, each a
+//                             zigzag LEB128 varint - ~2 bytes per sample at
+//                             10 Hz, so a 30 s shot is ~0.6 KB
+//
+// Records are appended to /log.bin; /log.idx holds one uint32 file offset
+// per record, so append and lookup by index are O(1) (one seek each). When
+// log.bin passes SHOT_LOG_SEGMENT_BYTES the pair is renamed to /old.* (the
+// previous old pair is deleted) and a fresh segment starts: the log keeps
+// the last ~2 segments, several hundred shots, in well under 1 MB.
+//
+// A crash between the record and its index entry leaves a trailing record
+// that is never referenced; index entries past the end of log.bin are
+// dropped at mount.
+//
+// Each record also takes the shot's event trace from the ring in
+// shot_events.h (shotEventsCollect(), at submit) and writes it to
+// /t<id>.bin after the record: ShotTraceHeader, then the events. Only the
+// newest SHOT_LOG_TRACES shots keep theirs - writing one deletes the trace
+// SHOT_LOG_TRACES ids back - so traces take at most ~150 KB next to the
+// segments.
+//
+// No flash write ever happens during a shot: shotLogSubmit() only encodes
+// into a RAM buffer (the shot control task, after the drip delay), and the writer
+// task waits while SHOT_STATE_BREWING is set (shot_state.h).
+//
+// Thread Safety:
+//   shotLogSubmit() - one producer (shot control task). The writer task owns the
+//   filesystem; shotLogCount()/shotLogRead()/shotLogDump() take the same
+//   mutex and may be called from any task.
+// =============================================================================
+
+#include <Arduino.h>
+#include "shot_samples.h"
+#include "flow_anomaly.h"
+#include "shot_events.h"
+
+constexpr uint32_t SHOT_LOG_SEGMENT_BYTES = 352 * 1024;  // Two segments and the traces fit the 1 MB partition
+constexpr uint32_t SHOT_LOG_TRACES        = 6;           // Newest shots that keep their event trace
+constexpr uint16_t SHOT_LOG_MAX_SAMPLES   = 2000;        // Newest samples kept when a shot has more
+constexpr uint16_t SHOT_LOG_MAGIC   = 0x5347;            // "GS"
+constexpr uint8_t SHOT_LOG_VERSION  = 1;
+
+// ShotLogHeader::endReason: ShotEndReason in the low nibble, FLOW_ANOMALY_*
+// flags (flow_anomaly.h) above it - records written before had none
+constexpr uint8_t SHOT_LOG_REASON_MASK   = 0x0F;
+constexpr uint8_t SHOT_LOG_ANOMALY_SHIFT = 4;
+
+struct __attribute__((packed)) ShotLogHeader {
+  uint16_t magic;
+  uint8_t version;
+  uint8_t endReason;      // ShotEndReason | anomaly flags << SHOT_LOG_ANOMALY_SHIFT
+  uint32_t id;            // Increasing across segments and reboots
+  uint16_t goalDg;        // Goal weight, 0.1 g
+  int16_t offsetCg;       // weightOffset used for the shot, 0.01 g
+  int16_t finalCg;        // Weight after the drip delay, 0.01 g
+  uint16_t durationDs;    // Shot time, 0.1 s
+  uint16_t sampleCount;
+  uint16_t bodyBytes;
+  uint16_t bodyCrc;       // CRC-16/CCITT of the body
+};
+
+inline uint8_t shotLogReason(const ShotLogHeader &h) { return h.endReason & SHOT_LOG_REASON_MASK; }
+inline uint8_t shotLogAnomaly(const ShotLogHeader &h) { return h.endReason >> SHOT_LOG_ANOMALY_SHIFT; }
+
+/**
+ * @brief Allocate the encode buffer and start the writer task (mounts LittleFS in the task)
+ */
+void shotLogBegin();
+
+/**
+ * @brief Encode a finished shot and cut its event trace for the writer task (no flash access)
+ * @param header goal/offset/final/duration/endReason set; the rest is filled in
+ * @return false if the previous shot is still waiting to be written, or no buffer
+ */
+bool shotLogSubmit(const ShotLogHeader &header, const ShotSampleStore &samples);
+
+/**
+ * @brief True while a shot is brewing - readers that can wait (exports) should, like the writer
+ */
+bool shotLogBusy();
+
+/**
+ * @brief Records on flash (0 until the writer task has mounted the filesystem)
+ */
+uint32_t shotLogCount();
+
+/**
+ * @brief Read only the header of record `index` (0 = oldest kept) - one index and one header read
+ */
+bool shotLogReadHeader(uint32_t index, ShotLogHeader *header);
+
+/**
+ * @brief Read record `index` (0 = oldest kept), decoding up to maxSamples samples
+ * @return Samples decoded, or -1 if the record is missing or corrupt
+ */
+int shotLogRead(uint32_t index, ShotLogHeader *header, ShotSample *samples, size_t maxSamples);
+
+/**
+ * @brief Read the event trace kept for shot `id` (ShotLogHeader::id, not an index)
+ * @return Events read (up to maxEvents), or -1 if none is kept or it is corrupt
+ */
+int shotLogReadTrace(uint32_t id, ShotTraceHeader *header, ShotTraceEvent *events, uint16_t maxEvents);
+
+/**
+ * @brief Print the newest `last` records (headers only) and usage
+ */
+void shotLogDump(Print &out, uint32_t last);
+
+#endif // SHOT_LOG_H
@@ -0,0 +1,124 @@
+#ifndef SHOT_PREDICTOR_H
+#define SHOT_PREDICTOR_H
+
+// =============================================================================
+// Stop Predictor for Gravimetric Shots (firmware + host replay)
+// =============================================================================
+// The part of the shot logic that decides *when* to stop, kept free of
+// FreeRTOS, LVGL and BLE so the same code runs in the firmware and in
+// tools/shot_replay (env:native):
+//
+//   raw sample ──► ShotPredictor::add() ──► WeightFilter ──► FlowOnset ──► FlowAnomaly
+//                                                                  │ from onset on
+//                                                    estimator (stop_estimator.h):
+//                                                    linear | quadratic | model
+//                                                                  │
+//   expectedEnd(goal, offset, latency) ◄───────────────────────────┘
+//   stopDue(now, expectedEnd)
+//
+// The estimator only sees samples from the flow onset on (flow_onset.h):
+// pre-infusion drips and the ramp into steady flow never tilt it. Which one
+// runs is chosen per shot (select(), from the shot profile); only that one is
+// fed.
+// FlowAnomaly (flow_anomaly.h) flags channeling and choked shots on the way.
+//
+// The firmware owns timing, relay and BLE around it; the replay tool feeds
+// recorded traces through exactly this object.
+//
+// Not thread safe - keep each instance on one task (the shot control task).
+// =============================================================================
+
+#include <Arduino.h>
+#include "weight_filter.h"
+#include "stop_estimator.h"
+#include "flow_onset.h"
+#include "flow_anomaly.h"
+
+constexpr int MIN_SHOT_DURATION_S = 5;
+constexpr int MAX_SHOT_DURATION_S = 50;
+
+class ShotPredictor {
+public:
+  /**
+   * @brief Start over for the next shot; the estimator choice is kept
+   */
+  void reset()
+  {
+    filter.reset();
+    onset.reset();
+    anomaly.reset();
+    linear.reset();
+    quadratic.reset();
+    model.reset();
+  }
+
+  /**
+   * @brief Estimator for the next shot (StopEstimatorKind; unknown values = linear), before its first sample
+   */
+  void select(uint8_t kind) { estimator = kind < STOP_ESTIMATOR_COUNT ? kind : static_cast<uint8_t>(STOP_ESTIMATOR_LINEAR); }
+  uint8_t selected() const { return estimator; }
+
+  /**
+   * @brief One raw reading at shot time t (s): filter, onset + anomalies, then the selected estimator
+   */
+  void add(float t, float grams)
+  {
+    filter.update(t, grams);
+    onset.add(t, grams, filter.flow());
+    anomaly.add(t, filter.flow(), onset);
+    if (!onset.flowing())
+      return;
+    switch (estimator) {
+      case STOP_ESTIMATOR_QUADRATIC: quadratic.add(t, filter); break;
+      case STOP_ESTIMATOR_MODEL:     model.add(t, filter); break;
+      default:                       linear.add(t, filter); break;
+    }
+  }
+
+  /**
+   * @brief Shot time (s) to decide the stop at, MAX_SHOT_DURATION_S when unknown
+   * @param latencyS Seconds of flow still reaching the cup after the decision
+   */
+  float expectedEnd(float goal, float offset, float latencyS) const
+  {
+    if (filter.weight() < 10)
+      return MAX_SHOT_DURATION_S;
+
+    float reachS;
+    switch (estimator) {
+      case STOP_ESTIMATOR_QUADRATIC: reachS = quadratic.timeAt(goal - offset); break;
+      case STOP_ESTIMATOR_MODEL:     reachS = model.timeAt(goal - offset); break;
+      default:                       reachS = linear.timeAt(goal - offset); break;
+    }
+    if (reachS < 0.0f)
+      return MAX_SHOT_DURATION_S;
+
+    // Stop early by the learned latency: what is still in flight at the decision lands in the cup
+    float expected = reachS - latencyS;
+
+    // Clamp to reasonable bounds (prevents UI showing nonsensical predictions)
+    if (expected < MIN_SHOT_DURATION_S) expected = MIN_SHOT_DURATION_S;
+    if (expected > MAX_SHOT_DURATION_S) expected = MAX_SHOT_DURATION_S;
+    return expected;
+  }
+
+  /**
+   * @brief True once shot time nowS has reached the expected end
+   */
+  static bool stopDue(float nowS, float expectedEndS)
+  {
+    return nowS >= expectedEndS && nowS > MIN_SHOT_DURATION_S;
+  }
+
+  WeightFilter filter;                        // Filtered weight + flow (tuned per scale driver)
+  FlowOnset onset;                            // First drip + steady flow onset
+  FlowAnomaly anomaly;                        // Channeling / choked flags
+  LinearEstimator linear;
+  QuadraticEstimator quadratic;
+  ModelEstimator model;
+
+private:
+  uint8_t estimator = STOP_ESTIMATOR_LINEAR;  // StopEstimatorKind
+};
+
+#endif // SHOT_PREDICTOR_H
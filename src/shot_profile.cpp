@@ -0,0 +1,312 @@
+// =============================================================================
+// Shot Profile Engine Implementation
+// =============================================================================
+
+#include "shot_profile.h"
+#include "console.h"
+#include "debug_config.h"
+#include "stop_estimator.h"
+#include <Preferences.h>
+
+static constexpr LogTag TAG = LOG_TAG_SHOT;
+
+static const char* SHOT_PROFILE_NAMESPACE = "profiles";
+static const char* SHOT_PROFILE_KEY       = "table";
+static const uint8_t SHOT_PROFILE_VERSION = 2;   // Bump when ShotProfile/ShotStage change
+// Version 1 had the same layout with padding where estimator is now
+static const uint8_t SHOT_PROFILE_VERSION_NO_ESTIMATOR = 1;
+
+// Relay patterns for the presets
+static const uint16_t ON  = 1;   // pulseOnMs > 0 with pulseOffMs 0: on for the whole stage
+static const uint16_t OFF = 0;
+
+static const ShotProfile PRESETS[SHOT_PROFILE_SLOTS] = {
+  { "Classic", 1, STOP_ESTIMATOR_LINEAR, {
+      { STAGE_END_GOAL,   0, ON,   0,   0 } } },
+  { "Preinfuse", 3, STOP_ESTIMATOR_LINEAR, {
+      { STAGE_END_TIME,   0, ON,   0,   4000 },   // Wet the puck
+      { STAGE_END_TIME,   0, OFF,  0,   4000 },   // Soak
+      { STAGE_END_GOAL,   0, ON,   0,   0 } } },
+  { "Bloom", 3, STOP_ESTIMATOR_LINEAR, {
+      { STAGE_END_WEIGHT, 0, ON,   0,   20 },     // Until the first 2 g
+      { STAGE_END_TIME,   0, OFF,  0,   6000 },   // Bloom
+      { STAGE_END_GOAL,   0, ON,   0,   0 } } },
+  { "Pulse", 3, STOP_ESTIMATOR_LINEAR, {
+      { STAGE_END_TIME,   0, ON,   0,   3000 },
+      { STAGE_END_WEIGHT, 0, 1500, 500, 150 },    // Pulse to 15 g
+      { STAGE_END_GOAL,   0, ON,   0,   0 } } },
+};
+
+struct ShotProfileRecord {
+  uint8_t version;
+  uint8_t active;
+  ShotProfile profiles[SHOT_PROFILE_SLOTS];
+};
+
+static ShotProfileRecord table;
+
+static void save()
+{
+  Preferences prefs;
+  if (!prefs.begin(SHOT_PROFILE_NAMESPACE, false))
+    return;
+  prefs.putBytes(SHOT_PROFILE_KEY, &table, sizeof(table));
+  prefs.end();
+}
+
+// Clamp stage count, terminate the name, and make sure exactly the last stage is the goal stage
+static void sanitize(ShotProfile &p)
+{
+  p.name[SHOT_PROFILE_NAME_LEN - 1] = '\0';
+  if (p.estimator >= STOP_ESTIMATOR_COUNT)
+    p.estimator = STOP_ESTIMATOR_LINEAR;
+  if (p.stageCount == 0 || p.stageCount > SHOT_PROFILE_MAX_STAGES)
+    p.stageCount = 1;
+
+  for (uint8_t i = 0; i < p.stageCount; i++)
+  {
+    if (p.stages[i].end == STAGE_END_GOAL && i + 1 < p.stageCount)
+    {
+      p.stageCount = i + 1;  // Nothing runs after the goal
+      break;
+    }
+    if (p.stages[i].end > STAGE_END_GOAL)
+      p.stages[i].end = STAGE_END_TIME;
+  }
+
+  ShotStage &last = p.stages[p.stageCount - 1];
+  last.end = STAGE_END_GOAL;
+  if (last.pulseOnMs == 0)
+    last.pulseOnMs = ON;  // A goal stage with the pump off would never reach the goal
+}
+
+static bool stageRelay(const ShotStage &s, float elapsedS)
+{
+  if (s.pulseOnMs == 0)
+    return false;
+  if (s.pulseOffMs == 0)
+    return true;
+
+  uint32_t period = (uint32_t)s.pulseOnMs + s.pulseOffMs;
+  uint32_t phase = (uint32_t)(elapsedS * 1000.0f) % period;
+  return phase < s.pulseOnMs;
+}
+
+void ShotProfileRunner::begin(const ShotProfile *p)
+{
+  profile = p;
+  stage = 0;
+  stageStartS = 0.0f;
+  lastS = 0.0f;
+  relay = false;
+  if (profile != NULL)
+    LOG_INFO(TAG, "🍵 Profile \"%s\" (%u stages, %s estimator)", profile->name, profile->stageCount,
+             stopEstimatorName(profile->estimator));
+}
+
+void ShotProfileRunner::stop()
+{
+  profile = NULL;
+  relay = false;
+}
+
+bool ShotProfileRunner::tick(float nowS, float weightG)
+{
+  if (profile == NULL)
+    return relay = false;
+
+  lastS = nowS;
+  while (stage + 1 < profile->stageCount)
+  {
+    const ShotStage &s = profile->stages[stage];
+    float endS = stageStartS + s.limit / 1000.0f;
+    bool done = (s.end == STAGE_END_TIME)   ? nowS >= endS
+              : (s.end == STAGE_END_WEIGHT) ? weightG * 10.0f >= s.limit
+              : false;
+    if (!done)
+      break;
+
+    // Time stages end on their own schedule, whenever this tick happens to run
+    stageStartS = (s.end == STAGE_END_TIME) ? endS : nowS;
+    stage++;
+    LOG_INFO(TAG, "🍵 Stage %u at %.2fs, %.1fg", stage, stageStartS, weightG);
+  }
+
+  relay = stageRelay(profile->stages[stage], nowS - stageStartS);
+  return relay;
+}
+
+float ShotProfileRunner::nextChangeS() const
+{
+  if (profile == NULL)
+    return -1.0f;
+
+  const ShotStage &s = profile->stages[stage];
+  float next = -1.0f;
+
+  if (s.end == STAGE_END_TIME && stage + 1 < profile->stageCount)
+    next = stageStartS + s.limit / 1000.0f;
+
+  if (s.pulseOnMs != 0 && s.pulseOffMs != 0)
+  {
+    // Next on/off edge of the pulse train after the last tick
+    uint32_t period = (uint32_t)s.pulseOnMs + s.pulseOffMs;
+    uint32_t phase = (uint32_t)((lastS - stageStartS) * 1000.0f) % period;
+    uint32_t edgeMs = (phase < s.pulseOnMs) ? s.pulseOnMs - phase : period - phase;
+    float edgeS = lastS + edgeMs / 1000.0f;
+    if (next < 0.0f || edgeS < next)
+      next = edgeS;
+  }
+
+  return next;
+}
+
+void shotProfilesBegin()
+{
+  Preferences prefs;
+  bool loaded = false;
+  if (prefs.begin(SHOT_PROFILE_NAMESPACE, true))
+  {
+    loaded = prefs.getBytes(SHOT_PROFILE_KEY, &table, sizeof(table)) == sizeof(table) &&
+             (table.version == SHOT_PROFILE_VERSION || table.version == SHOT_PROFILE_VERSION_NO_ESTIMATOR);
+    prefs.end();
+  }
+  if (loaded && table.version == SHOT_PROFILE_VERSION_NO_ESTIMATOR)
+  {
+    // Keep the user's stages; every profile stops on the linear trend as before
+    for (uint8_t i = 0; i < SHOT_PROFILE_SLOTS; i++)
+      table.profiles[i].estimator = STOP_ESTIMATOR_LINEAR;
+    table.version = SHOT_PROFILE_VERSION;
+    save();
+  }
+
+  if (!loaded)
+  {
+    table.version = SHOT_PROFILE_VERSION;
+    table.active = 0;
+    memcpy(table.profiles, PRESETS, sizeof(PRESETS));
+    save();
+  }
+
+  for (uint8_t i = 0; i < SHOT_PROFILE_SLOTS; i++)
+    sanitize(table.profiles[i]);
+  if (table.active >= SHOT_PROFILE_SLOTS)
+    table.active = 0;
+
+  LOG_INFO(TAG, "🍵 Shot profile: %s (%s estimator)", table.profiles[table.active].name,
+           stopEstimatorName(table.profiles[table.active].estimator));
+}
+
+uint8_t shotProfileCount()
+{
+  return SHOT_PROFILE_SLOTS;
+}
+
+const ShotProfile *shotProfile(uint8_t index)
+{
+  return (index < SHOT_PROFILE_SLOTS) ? &table.profiles[index] : NULL;
+}
+
+uint8_t shotProfileActiveIndex()
+{
+  return table.active;
+}
+
+const ShotProfile *shotProfileActive()
+{
+  return &table.profiles[table.active];
+}
+
+bool shotProfileSelect(uint8_t index)
+{
+  if (index >= SHOT_PROFILE_SLOTS)
+    return false;
+  if (table.active != index)
+  {
+    table.active = index;
+    save();
+  }
+  return true;
+}
+
+bool shotProfileStore(uint8_t index, const ShotProfile &profile)
+{
+  if (index >= SHOT_PROFILE_SLOTS)
+    return false;
+  table.profiles[index] = profile;
+  sanitize(table.profiles[index]);
+  save();
+  return true;
+}
+
+bool shotProfileSetEstimator(uint8_t index, uint8_t kind)
+{
+  if (index >= SHOT_PROFILE_SLOTS || kind >= STOP_ESTIMATOR_COUNT)
+    return false;
+  if (table.profiles[index].estimator != kind)
+  {
+    table.profiles[index].estimator = kind;
+    save();
+  }
+  return true;
+}
+
+bool shotProfileSetFlow(uint8_t index, uint8_t stage, uint8_t flowDgS)
+{
+  if (index >= SHOT_PROFILE_SLOTS || stage >= table.profiles[index].stageCount)
+    return false;
+  ShotStage &s = table.profiles[index].stages[stage];
+  if (s.flowDgS != flowDgS)
+  {
+    s.flowDgS = flowDgS;
+    save();
+  }
+  return true;
+}
+
+void shotProfilesDump(Print &out)
+{
+  for (uint8_t i = 0; i < SHOT_PROFILE_SLOTS; i++)
+  {
+    const ShotProfile &p = table.profiles[i];
+    out.printf("  %c %u %-11s %u stages, %s estimator", i == table.active ? '*' : ' ', i, p.name, p.stageCount,
+               stopEstimatorName(p.estimator));
+    for (uint8_t st = 0; st < p.stageCount; st++)
+    {
+      if (p.stages[st].flowDgS != 0)
+        out.printf(", stage %u at %.1f g/s", st, p.stages[st].flowDgS / 10.0f);
+    }
+    out.println();
+  }
+}
+
+static void cmdProfiles(ConsoleArgs &args)
+{
+  if (args.argc > 1)
+  {
+    long slot, stage;
+    float flow;
+    if (args.argc == 5 && args.number(1, &slot) && args.is(2, "flow") && args.number(3, &stage) &&
+        args.decimal(4, &flow) && slot >= 0 && stage >= 0 && flow >= 0.0f && flow <= 25.5f &&
+        shotProfileSetFlow((uint8_t)slot, (uint8_t)stage, (uint8_t)lroundf(flow * 10.0f)))
+    {
+      LOG_INFO(TAG, "🍵 Profile \"%s\" stage %ld: %s", table.profiles[slot].name, stage,
+               flow > 0.0f ? "flow controlled" : "full power");
+      shotProfilesDump(args.out);
+      return;
+    }
+    uint8_t kind = stopEstimatorParse(args.arg(3));
+    if (args.argc != 4 || !args.number(1, &slot) || !args.is(2, "estimator") || slot < 0 ||
+        !shotProfileSetEstimator((uint8_t)slot, kind))
+    {
+      args.out.println("Usage: profiles [<slot> estimator <linear|quadratic|model> | <slot> flow <stage> <g/s>]");
+      return;
+    }
+    LOG_INFO(TAG, "🍵 Profile \"%s\": %s estimator from the next shot", table.profiles[slot].name,
+             stopEstimatorName(kind));
+  }
+  shotProfilesDump(args.out);
+}
+
+static ConsoleCommand profilesCommand("profiles", "[<slot> estimator <name> | <slot> flow <stage> <g/s>]",
+                                      "Shot profiles, end-of-shot estimator and stage target flows", cmdProfiles);
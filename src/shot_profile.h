@@ -0,0 +1,141 @@
+#ifndef SHOT_PROFILE_H
+#define SHOT_PROFILE_H
+
+// =============================================================================
+// Shot Profiles: Staged Recipes with Relay Scheduling
+// =============================================================================
+// A profile is a short list of stages run in order from the moment the pump
+// would normally switch on:
+//
+//   stage 0 ──► stage 1 ──► ... ──► goal stage
+//   (time/weight  (time/weight         (stopped by the predictor at
+//    limit)        limit)               goalWeight - offset, as before)
+//
+// Each stage has a relay pattern (always on, always off, or pulsing
+// pulseOnMs/pulseOffMs) and an end condition: a time in the stage, a weight
+// reached, or - for the last stage only - the goal. The single-stage
+// "Classic" profile is exactly the old behaviour. Each profile also picks
+// the end-of-shot estimator (stop_estimator.h) its goal stage is stopped by.
+// A stage may also hold a target flow: while it runs, flow_control.h sets
+// the pump power (pump_output.h) so the cup sees that flow; 0 leaves the pump
+// at full power as before.
+//
+//   - Time stages chain on their exact end time, not on the tick that noticed
+//     it, so a profile runs the same way however the control task is woken.
+//   - nextChangeS() says when the relay next toggles or a time stage ends, so
+//     the control task can sleep until then instead of polling.
+//   - Fixed-size POD records, no allocation; the table is one NVS blob
+//     (namespace "profiles") seeded with the built-in presets.
+//
+// Thread Safety:
+//   Shot control task (Core 0) only, except shotProfilesBegin() (setup, before the task)
+//   and shotProfileSetEstimator() / shotProfileSetFlow() / the "profiles"
+//   console command (one byte each, read when the next shot is armed or the
+//   stage is next entered).
+// =============================================================================
+
+#include <Arduino.h>
+
+constexpr uint8_t SHOT_PROFILE_MAX_STAGES = 6;
+constexpr uint8_t SHOT_PROFILE_SLOTS      = 4;
+constexpr uint8_t SHOT_PROFILE_NAME_LEN   = 12;  // Including the terminator
+
+enum ShotStageEnd : uint8_t {
+  STAGE_END_TIME,     // limit = ms in this stage
+  STAGE_END_WEIGHT,   // limit = filtered weight in 0.1 g
+  STAGE_END_GOAL      // Last stage: the stop predictor ends the shot
+};
+
+struct ShotStage {
+  uint8_t end;          // ShotStageEnd
+  uint8_t flowDgS;      // Target flow in 0.1 g/s, 0 = full power (was reserved, always 0)
+  uint16_t pulseOnMs;   // 0 = relay off for the whole stage
+  uint16_t pulseOffMs;  // 0 = relay on for the whole stage
+  uint16_t limit;       // See ShotStageEnd
+};
+
+struct ShotProfile {
+  char name[SHOT_PROFILE_NAME_LEN];
+  uint8_t stageCount;
+  uint8_t estimator;    // StopEstimatorKind (stop_estimator.h) for the goal stage
+  ShotStage stages[SHOT_PROFILE_MAX_STAGES];
+};
+
+/**
+ * @brief Steps one profile through its stages (one instance per shot, reused)
+ */
+class ShotProfileRunner {
+public:
+  ShotProfileRunner() : profile(NULL), stage(0), stageStartS(0.0f), lastS(0.0f), relay(false) {}
+
+  /**
+   * @brief Start at stage 0 at shot time 0 (pump-on instant)
+   */
+  void begin(const ShotProfile *p);
+  void stop();
+
+  /**
+   * @brief Advance stages at shot time nowS and return the wanted relay state
+   * @param weightG Filtered weight (g) for weight-limited stages
+   */
+  bool tick(float nowS, float weightG);
+
+  bool running() const { return profile != NULL; }
+  bool relayOn() const { return relay; }
+  bool atGoalStage() const { return profile != NULL && stage + 1 >= profile->stageCount; }
+  uint8_t stageIndex() const { return stage; }
+
+  /**
+   * @brief Target flow of the current stage (g/s), 0 = none
+   */
+  float targetFlowGs() const { return profile != NULL ? profile->stages[stage].flowDgS / 10.0f : 0.0f; }
+
+  /**
+   * @brief Shot time (s) of the next relay toggle or time-stage end, < 0 if none
+   */
+  float nextChangeS() const;
+
+private:
+  const ShotProfile *profile;
+  uint8_t stage;
+  float stageStartS;
+  float lastS;          // Shot time of the last tick
+  bool relay;
+};
+
+/**
+ * @brief Load the profile table from NVS (built-in presets on first run)
+ */
+void shotProfilesBegin();
+
+uint8_t shotProfileCount();
+const ShotProfile *shotProfile(uint8_t index);
+uint8_t shotProfileActiveIndex();
+const ShotProfile *shotProfileActive();
+
+/**
+ * @brief Make `index` the profile used by the next shot and persist the choice
+ */
+bool shotProfileSelect(uint8_t index);
+
+/**
+ * @brief Replace profile `index` (validated: the last stage becomes the goal stage)
+ */
+bool shotProfileStore(uint8_t index, const ShotProfile &profile);
+
+/**
+ * @brief Change only the estimator of profile `index` and persist it (any task)
+ */
+bool shotProfileSetEstimator(uint8_t index, uint8_t kind);
+
+/**
+ * @brief Set the target flow of one stage (0 = full power) and persist it (any task)
+ */
+bool shotProfileSetFlow(uint8_t index, uint8_t stage, uint8_t flowDgS);
+
+/**
+ * @brief Slots, stages and estimator per profile (the "profiles" console command)
+ */
+void shotProfilesDump(Print &out);
+
+#endif // SHOT_PROFILE_H
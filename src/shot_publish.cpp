@@ -0,0 +1,275 @@
+// =============================================================================
+// Shot Summaries over MQTT Implementation
+// =============================================================================
+
+#include "shot_publish.h"
+#include "debug_config.h"
+#include "metrics.h"
+#include "shot_log.h"
+#include "task_layout.h"
+#include "wifi_coex.h"
+
+#ifdef WIRELESS_DEBUG
+
+#include <WiFi.h>
+#include <Preferences.h>
+
+static constexpr LogTag TAG = LOG_TAG_WIFI;
+
+static const char* SHOT_PUBLISH_NAMESPACE = "shotpub";
+static const char* SHOT_PUBLISH_KEY       = "lastId";
+
+// Same order as ShotEndReason (shot_export.cpp uses the same names)
+static const char *const END_REASONS[] = {"weight", "time", "button", "disconnected", "user", "undefined", "anomaly"};
+
+// MQTT 3.1.1 control packet types (high nibble of the fixed header)
+static constexpr uint8_t MQTT_CONNECT    = 0x10;
+static constexpr uint8_t MQTT_CONNACK    = 0x20;
+static constexpr uint8_t MQTT_PUBLISH_Q1 = 0x32;
+static constexpr uint8_t MQTT_PUBACK     = 0x40;
+static constexpr uint8_t MQTT_DISCONNECT = 0xE0;
+static constexpr uint16_t MQTT_KEEPALIVE_S = 30;   // Longer than any session
+
+static TaskHandle_t publishTask = NULL;
+static uint32_t unitId = 0;
+static char topic[48];
+
+// Written by the publisher task only
+static volatile uint32_t lastId = 0;         // Last shot the broker acknowledged
+static volatile uint32_t pendingShots = 0;   // As of the last scan
+static volatile uint32_t published = 0;
+static volatile uint32_t failures = 0;
+
+static MetricCounterRef publishedTotal("shot_publish_total", "Shot summaries acknowledged by the MQTT broker", &published);
+static MetricCounterRef failuresTotal("shot_publish_failures_total", "MQTT sessions that failed (connect, CONNACK or PUBACK)", &failures);
+static MetricGauge pendingGauge("shot_publish_pending", "Logged shots not yet acknowledged by the MQTT broker");
+
+static void storeCursor()
+{
+  Preferences prefs;
+  if (prefs.begin(SHOT_PUBLISH_NAMESPACE, false))
+  {
+    prefs.putUInt(SHOT_PUBLISH_KEY, lastId);
+    prefs.end();
+  }
+}
+
+// MQTT variable-length "remaining length"
+static size_t putLength(uint8_t *out, size_t len)
+{
+  size_t n = 0;
+  do {
+    uint8_t b = len & 0x7F;
+    len >>= 7;
+    out[n++] = b | (len ? 0x80 : 0);
+  } while (len);
+  return n;
+}
+
+static size_t putString(uint8_t *out, const char *s, size_t len)
+{
+  out[0] = (uint8_t)(len >> 8);
+  out[1] = (uint8_t)len;
+  memcpy(out + 2, s, len);
+  return len + 2;
+}
+
+// Exactly `len` bytes within SHOT_PUBLISH_TIMEOUT_MS
+static bool readExact(WiFiClient &client, uint8_t *buf, size_t len)
+{
+  uint32_t start = millis();
+  size_t got = 0;
+  while (got < len) {
+    if (!client.connected() || millis() - start >= SHOT_PUBLISH_TIMEOUT_MS)
+      return false;
+    int c = client.read();
+    if (c < 0) {
+      vTaskDelay(pdMS_TO_TICKS(10));
+      continue;
+    }
+    buf[got++] = (uint8_t)c;
+  }
+  return true;
+}
+
+static bool mqttConnect(WiFiClient &client)
+{
+  char clientId[24];
+  size_t idLen = snprintf(clientId, sizeof(clientId), "gravshots-%08lX", (unsigned long)unitId);
+
+  uint8_t packet[64];
+  uint8_t body[48];
+  size_t b = putString(body, "MQTT", 4);
+  body[b++] = 4;      // Protocol level 3.1.1
+  body[b++] = 0x02;   // Clean session, no will / credentials
+  body[b++] = (uint8_t)(MQTT_KEEPALIVE_S >> 8);
+  body[b++] = (uint8_t)MQTT_KEEPALIVE_S;
+  b += putString(body + b, clientId, idLen);
+
+  size_t n = 0;
+  packet[n++] = MQTT_CONNECT;
+  n += putLength(packet + n, b);
+  memcpy(packet + n, body, b);
+  n += b;
+  if (client.write(packet, n) != n)
+    return false;
+
+  uint8_t ack[4];
+  return readExact(client, ack, sizeof(ack)) && ack[0] == MQTT_CONNACK && ack[3] == 0;
+}
+
+static bool mqttPublish(WiFiClient &client, uint16_t packetId, const char *payload, size_t len)
+{
+  size_t topicLen = strlen(topic);
+  uint8_t packet[256];
+  size_t remaining = 2 + topicLen + 2 + len;
+  if (remaining + 5 > sizeof(packet))
+    return false;
+
+  size_t n = 0;
+  packet[n++] = MQTT_PUBLISH_Q1;
+  n += putLength(packet + n, remaining);
+  n += putString(packet + n, topic, topicLen);
+  packet[n++] = (uint8_t)(packetId >> 8);
+  packet[n++] = (uint8_t)packetId;
+  memcpy(packet + n, payload, len);
+  n += len;
+  if (client.write(packet, n) != n)
+    return false;
+
+  uint8_t ack[4];
+  return readExact(client, ack, sizeof(ack)) && ack[0] == MQTT_PUBACK &&
+         ack[2] == (uint8_t)(packetId >> 8) && ack[3] == (uint8_t)packetId;
+}
+
+static size_t formatSummary(char *out, size_t size, const ShotLogHeader &h)
+{
+  uint8_t reason = shotLogReason(h);
+  return snprintf(out, size,
+                  "{\"unit\":\"%08lX\",\"id\":%lu,\"goal\":%.1f,\"final\":%.2f,\"time\":%.1f,"
+                  "\"reason\":\"%s\",\"anomaly\":\"%s\",\"offset\":%.2f}",
+                  (unsigned long)unitId, (unsigned long)h.id, h.goalDg / 10.0f, h.finalCg / 100.0f,
+                  h.durationDs / 10.0f, END_REASONS[reason < 7 ? reason : 5], FlowAnomaly::name(shotLogAnomaly(h)),
+                  h.offsetCg / 100.0f);
+}
+
+// Index of the oldest record newer than the cursor (count = none)
+static uint32_t firstPending(uint32_t count)
+{
+  uint32_t index = count;
+  ShotLogHeader h;
+  while (index > 0 && shotLogReadHeader(index - 1, &h) && h.id > lastId)
+    index--;
+  return index;
+}
+
+static bool mayPublish()
+{
+  return !shotLogBusy() && !wifiCoexQuiet() && WiFi.status() == WL_CONNECTED;
+}
+
+// One broker session: up to SHOT_PUBLISH_BATCH summaries. True if another batch should follow right away.
+static bool publishBatch()
+{
+  uint32_t count = shotLogCount();
+  uint32_t index = firstPending(count);
+  pendingShots = count - index;
+  pendingGauge.set((int32_t)pendingShots);
+  if (index >= count || !mayPublish())
+    return false;
+
+  WiFiClient client;
+  if (!client.connect(GS_MQTT_HOST, GS_MQTT_PORT) || !mqttConnect(client)) {
+    failures++;
+    client.stop();
+    LOG_DEBUG(TAG, "MQTT: broker %s:%d unreachable, %lu shots queued", GS_MQTT_HOST, GS_MQTT_PORT,
+              (unsigned long)pendingShots);
+    return false;
+  }
+
+  uint32_t startId = lastId;
+  bool ok = true;
+  char payload[160];
+  for (uint8_t sent = 0; sent < SHOT_PUBLISH_BATCH && index < count; sent++, index++) {
+    ShotLogHeader h;
+    if (!mayPublish() || !shotLogReadHeader(index, &h)) {
+      ok = false;  // A shot started: the rest waits
+      break;
+    }
+    size_t len = formatSummary(payload, sizeof(payload), h);
+    if (!mqttPublish(client, (uint16_t)(h.id & 0xFFFF) | 1, payload, len)) {
+      failures++;
+      ok = false;
+      break;
+    }
+    lastId = h.id;
+    published++;
+  }
+
+  uint8_t bye[2] = {MQTT_DISCONNECT, 0};
+  client.write(bye, sizeof(bye));
+  client.stop();
+
+  if (lastId != startId) {
+    storeCursor();  // Once per session, not per shot
+    LOG_INFO(TAG, "📤 MQTT: published shots %lu-%lu", (unsigned long)startId + 1, (unsigned long)lastId);
+  }
+  pendingShots = count - index;
+  pendingGauge.set((int32_t)pendingShots);
+  return ok && index < count;
+}
+
+static void shotPublishTask(void *)
+{
+  for (;;) {
+    // A finished shot, or the periodic retry of whatever is still queued
+    uint32_t notified = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(SHOT_PUBLISH_RETRY_MS));
+    if (notified)
+      vTaskDelay(pdMS_TO_TICKS(SHOT_PUBLISH_SETTLE_MS));
+    while (publishBatch())
+      ;  // Backlog after an offline stretch: batch after batch until done or interrupted
+  }
+}
+
+void shotPublishBegin()
+{
+  if (GS_MQTT_HOST[0] == '\0')
+    return;  // No broker configured
+
+  unitId = (uint32_t)ESP.getEfuseMac();
+  snprintf(topic, sizeof(topic), "%s/%08lX/shot", GS_MQTT_TOPIC, (unsigned long)unitId);
+
+  Preferences prefs;
+  if (prefs.begin(SHOT_PUBLISH_NAMESPACE, true))
+  {
+    lastId = prefs.getUInt(SHOT_PUBLISH_KEY, 0);
+    prefs.end();
+  }
+
+  if (taskLayoutSpawn(TASK_ROLE_PUBLISH, shotPublishTask, NULL, &publishTask) != pdPASS) {
+    LOG_ERROR(TAG, "❌ Failed to create the MQTT publisher");
+    publishTask = NULL;
+    return;
+  }
+  LOG_INFO(TAG, "MQTT shot summaries → %s:%d %s (after shot %lu)", GS_MQTT_HOST, GS_MQTT_PORT, topic,
+           (unsigned long)lastId);
+}
+
+void shotPublishNotify()
+{
+  if (publishTask != NULL)
+    xTaskNotifyGive(publishTask);
+}
+
+void shotPublishDump(Print &out)
+{
+  if (publishTask == NULL) {
+    out.println("[MQTT] off (build with -DGS_MQTT_HOST=\\\"broker\\\")");
+    return;
+  }
+  out.printf("[MQTT] %s:%d %s - last acknowledged shot %lu, %lu pending, %lu published, %lu failed sessions\n",
+             GS_MQTT_HOST, GS_MQTT_PORT, topic, (unsigned long)lastId, (unsigned long)pendingShots,
+             (unsigned long)published, (unsigned long)failures);
+}
+
+#endif // WIRELESS_DEBUG
@@ -0,0 +1,86 @@
+#ifndef SHOT_PUBLISH_H
+#define SHOT_PUBLISH_H
+
+// =============================================================================
+// Shot Summaries over MQTT (offline queue = the shot log)
+// =============================================================================
+// Every finished shot goes to the shop dashboard as one small JSON message,
+//
+//   <GS_MQTT_TOPIC>/<unit>/shot
+//   {"unit":"1A2B3C4D","id":812,"goal":36.0,"final":36.4,"time":28.7,
+//    "reason":"weight","offset":1.85}
+//
+// published with QoS 1 from a low-priority task of its own. The queue is the
+// shot log itself (shot_log.h): records are already on flash, survive
+// reboots and carry an increasing id, so the task only keeps a cursor - the
+// id of the last shot the broker acknowledged (NVS namespace "shotpub").
+// Whatever is newer is pending; the task sends up to SHOT_PUBLISH_BATCH of
+// them per broker session and moves the cursor once per session. Shots that
+// rotate out of the log before Wi-Fi comes back are lost (several hundred).
+//
+// Publishing never competes with a shot:
+//   - shotPublishNotify() comes from logFinishedShot(), i.e. after the drip
+//     delay; the task then waits SHOT_PUBLISH_SETTLE_MS for the writer
+//   - nothing is sent while a shot brews (shotLogBusy()) or Wi-Fi is quiet
+//     (wifi_coex.h); both are checked again before every message
+//   - one short session per batch (connect, publish, disconnect): no keepalive
+//     traffic between shots
+// Without Wi-Fi or broker the task retries every SHOT_PUBLISH_RETRY_MS.
+//
+// The client is MQTT 3.1.1, CONNECT / PUBLISH (QoS 1) / PUBACK / DISCONNECT
+// over WiFiClient - nothing else of the protocol is needed, so no library.
+//
+// GS_MQTT_HOST (compile-time, -DGS_MQTT_HOST=\"broker.local\"): broker; empty
+// (default) leaves the publisher off. GS_MQTT_PORT (1883), GS_MQTT_TOPIC
+// ("gravshots"). Only built with -DWIRELESS_DEBUG (the only builds with
+// Wi-Fi); otherwise every call is an inline no-op.
+//
+// Thread Safety:
+//   shotPublishBegin() - setup. shotPublishNotify() - any task.
+//   shotPublishDump() - any task (plain counters).
+// =============================================================================
+
+#include <Arduino.h>
+
+#ifndef GS_MQTT_HOST
+#define GS_MQTT_HOST ""
+#endif
+#ifndef GS_MQTT_PORT
+#define GS_MQTT_PORT 1883
+#endif
+#ifndef GS_MQTT_TOPIC
+#define GS_MQTT_TOPIC "gravshots"
+#endif
+
+constexpr uint32_t SHOT_PUBLISH_SETTLE_MS  = 2000;    // Shot log writer commits the record meanwhile
+constexpr uint32_t SHOT_PUBLISH_RETRY_MS   = 60000;   // Pending shots, no Wi-Fi / broker
+constexpr uint32_t SHOT_PUBLISH_TIMEOUT_MS = 3000;    // CONNACK / PUBACK
+constexpr uint8_t  SHOT_PUBLISH_BATCH      = 16;      // Messages per broker session
+
+#ifdef WIRELESS_DEBUG
+
+/**
+ * @brief Load the cursor and start the publisher task (no-op without GS_MQTT_HOST)
+ * @note After shotLogBegin()
+ */
+void shotPublishBegin();
+
+/**
+ * @brief A finished shot was handed to the shot log
+ */
+void shotPublishNotify();
+
+/**
+ * @brief Broker, cursor, pending / published / failed sessions
+ */
+void shotPublishDump(Print &out);
+
+#else
+
+inline void shotPublishBegin() {}
+inline void shotPublishNotify() {}
+inline void shotPublishDump(Print &) {}
+
+#endif // WIRELESS_DEBUG
+
+#endif // SHOT_PUBLISH_H
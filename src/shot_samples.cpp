@@ -0,0 +1,45 @@
+// =============================================================================
+// Ring-Buffered Shot Sample Store Implementation
+// =============================================================================
+
+#include "shot_samples.h"
+#include "debug_config.h"
+#include "mem_caps.h"
+#include "soc/soc_memory_layout.h"
+
+static constexpr LogTag TAG = LOG_TAG_SHOT;
+
+bool ShotSampleStore::allocate(size_t capacity)
+{
+  size_t bytes = capacity * sizeof(ShotSample);
+  ShotSample *mem = (ShotSample *)memCapsAlloc(bytes, GS_SHOT_SAMPLES_PSRAM ? MEM_PSRAM_FIRST : MEM_INTERNAL,
+                                               MEM_OWNER_SHOT_SAMPLES);
+  if (mem == NULL) {
+    LOG_ERROR(TAG, "❌ Shot sample store: %u bytes not available", (unsigned)bytes);
+    return false;
+  }
+
+  ring = mem;
+  cap = capacity;
+  clear();
+  LOG_INFO(TAG, "💾 Shot sample store: %u samples (%u bytes) in %s", (unsigned)capacity, (unsigned)bytes,
+           esp_ptr_external_ram(mem) ? "PSRAM" : "internal DRAM");
+  return true;
+}
+
+void ShotSampleStore::push(float seconds, float grams)
+{
+  if (cap == 0)
+    return;
+
+  long ms = lroundf(seconds * 1000.0f);
+  long cg = lroundf(grams * 100.0f);
+
+  ShotSample &slot = ring[head];
+  slot.t_ms = (uint16_t)constrain(ms, 0L, (long)UINT16_MAX);
+  slot.weight_cg = (int16_t)constrain(cg, (long)INT16_MIN, (long)INT16_MAX);
+
+  head = (head + 1 == cap) ? 0 : head + 1;
+  if (count < cap)
+    count++;
+}
@@ -0,0 +1,90 @@
+#ifndef SHOT_SAMPLES_H
+#define SHOT_SAMPLES_H
+
+// =============================================================================
+// Ring-Buffered Shot Sample Store for Gravimetric Shots
+// =============================================================================
+// Holds the weight curve of the running shot as compact 4-byte samples:
+//
+//   t_ms      (uint16) - ms since the shot started (65.5 s, > MAX_SHOT_DURATION_S)
+//   weight_cg (int16)  - centigrams (+/-327 g, clamped)
+//
+// A full store overwrites its oldest sample in O(1) - no shifting. Samples
+// are indexed oldest-first (0 = oldest) and can be walked with a range-for
+// for export or a full refit.
+//
+// GS_SHOT_SAMPLES_PSRAM (compile-time, default 1): allocate the ring in PSRAM,
+// falling back to internal DRAM when PSRAM is missing. At ~10 samples/s the
+// PSRAM access cost does not matter; the internal heap is what BLE needs.
+//
+// Thread Safety:
+//   Shot control task (Core 0) only - it is the single producer and consumer.
+// =============================================================================
+
+#include <Arduino.h>
+
+#ifndef GS_SHOT_SAMPLES_PSRAM
+#define GS_SHOT_SAMPLES_PSRAM 1
+#endif
+
+struct ShotSample {
+  uint16_t t_ms;
+  int16_t weight_cg;
+
+  float seconds() const { return t_ms / 1000.0f; }
+  float grams() const { return weight_cg / 100.0f; }
+};
+
+class ShotSampleStore {
+public:
+  class Iterator {
+  public:
+    Iterator(const ShotSampleStore *store, size_t index) : store(store), index(index) {}
+    const ShotSample &operator*() const { return (*store)[index]; }
+    Iterator &operator++() { index++; return *this; }
+    bool operator!=(const Iterator &other) const { return index != other.index; }
+
+  private:
+    const ShotSampleStore *store;
+    size_t index;
+  };
+
+  /**
+   * @brief Allocate the ring once (setup)
+   * @return false if no memory - push() then drops samples
+   */
+  bool allocate(size_t capacity);
+
+  void clear() { head = 0; count = 0; }
+
+  /**
+   * @brief Append a sample, overwriting the oldest one when full
+   */
+  void push(float seconds, float grams);
+
+  size_t size() const { return count; }
+  size_t capacity() const { return cap; }
+  bool full() const { return count == cap; }
+
+  /**
+   * @brief Sample i, oldest first (i < size())
+   */
+  const ShotSample &operator[](size_t i) const
+  {
+    size_t slot = head + cap - count + i;
+    return ring[slot >= cap ? slot - cap : slot];
+  }
+
+  const ShotSample &back() const { return (*this)[count - 1]; }
+
+  Iterator begin() const { return Iterator(this, 0); }
+  Iterator end() const { return Iterator(this, count); }
+
+private:
+  ShotSample *ring = NULL;
+  size_t cap = 0;
+  size_t head = 0;   // Next slot to write
+  size_t count = 0;
+};
+
+#endif // SHOT_SAMPLES_H
@@ -0,0 +1,34 @@
+// =============================================================================
+// Cross-Core Shot State Implementation
+// =============================================================================
+
+#include "shot_state.h"
+#include "metrics.h"
+
+uint32_t shotStateBits = 0;
+static volatile TaskHandle_t consumer = NULL;
+
+static MetricCounter changesTotal("shot_state_changes_total", "Brewing / flushing / sequence flag changes");
+
+bool shotStateSet(ShotStateFlag flag, bool on)
+{
+  uint32_t before = __atomic_load_n(&shotStateBits, __ATOMIC_RELAXED);
+  uint32_t after;
+  do {
+    if (((before & flag) != 0) == on)
+      return false;  // Already so - no version bump, nobody woken
+    uint32_t flags = on ? (before | flag) : (before & ~flag);
+    after = ((before & ~SHOT_STATE_FLAG_MASK) + (1u << SHOT_STATE_VERSION_SHIFT)) | (flags & SHOT_STATE_FLAG_MASK);
+  } while (!__atomic_compare_exchange_n(&shotStateBits, &before, after, true, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+
+  changesTotal.add();
+  TaskHandle_t task = consumer;
+  if (task != NULL && task != xTaskGetCurrentTaskHandle())
+    xTaskNotifyGive(task);
+  return true;
+}
+
+void shotStateSetConsumer(TaskHandle_t task)
+{
+  consumer = task;
+}
@@ -0,0 +1,126 @@
+#ifndef SHOT_STATE_H
+#define SHOT_STATE_H
+
+// =============================================================================
+// Cross-Core Shot State: one versioned flag word, change notifications
+// =============================================================================
+// "Brewing", "flushing" and "start sequence running" are set by the BLE task
+// (sequencer, scale loss), the control task (arm, stop) and the UI task
+// (flush, Start / Stop presses), and read by all of them. As plain bools
+// nothing ordered those accesses: a reader on the other core could see the
+// flag before (or after) the data the writer meant it to publish.
+//
+// They now live in one 32-bit word:
+//
+//   bits 0..7    SHOT_STATE_* flags
+//   bits 8..31   version, +1 on every change (wraps)
+//
+//   - A change is a compare-and-swap (acq_rel): flags and version move
+//     together, concurrent writers on both cores never lose each other's
+//     bits, and everything the writer stored before it is visible to a
+//     reader that sees the new word (acquire load).
+//   - Readers load the word once to get a consistent view of all flags;
+//     comparing versions says whether anything happened in between.
+//   - A real change (not a re-store of the same value) notifies the
+//     consumer task (xTaskNotifyGive, like the UI channel), so the UI task learns of a
+//     shot start or stop when it happens, not when its next poll comes
+//     around - including from deep idle.
+//
+// ShotStateRef<F> stands in for the old bool members: `shot.brewing = true`
+// and `if (shot.brewing)` keep working and go through the word. It cannot
+// be copied, so passing one to printf-style varargs does not compile - use
+// the bool it converts to.
+//
+// AtomicValue<T> does the same for single values other tasks read
+// (the latest weight, the sequence request): release stores, acquire loads,
+// nothing torn. T must be at most a word (4 bytes) so the access is a single
+// load / store on the ESP32.
+//
+// Thread Safety:
+//   Every function is lock-free and may be called from any task on either
+//   core (not from ISRs: the notification is the task variant).
+// =============================================================================
+
+#include <Arduino.h>
+
+enum ShotStateFlag : uint32_t {
+  SHOT_STATE_BREWING  = 1u << 0,   // Pump on for a shot (armShot() until the stop)
+  SHOT_STATE_FLUSHING = 1u << 1,   // Flush cycle running
+  SHOT_STATE_SEQUENCE = 1u << 2,   // Start sequence (reset / tare / start) with the scale in flight
+};
+
+constexpr uint32_t SHOT_STATE_FLAG_MASK     = 0xFFu;
+constexpr uint32_t SHOT_STATE_VERSION_SHIFT = 8;
+
+/**
+ * @brief Set or clear one flag
+ * @return true if the flag changed (version bumped, consumer notified)
+ */
+bool shotStateSet(ShotStateFlag flag, bool on);
+
+extern uint32_t shotStateBits;  // Read through shotStateWord() only
+
+/**
+ * @brief The whole word: SHOT_STATE_* flags in the low byte, version above
+ */
+inline uint32_t shotStateWord() { return __atomic_load_n(&shotStateBits, __ATOMIC_ACQUIRE); }
+
+inline uint32_t shotStateFlags() { return shotStateWord() & SHOT_STATE_FLAG_MASK; }
+inline uint32_t shotStateVersion() { return shotStateWord() >> SHOT_STATE_VERSION_SHIFT; }
+inline bool shotStateTest(ShotStateFlag flag) { return (shotStateWord() & flag) != 0; }
+
+/**
+ * @brief Task to wake (xTaskNotifyGive) when a flag changes; a change made by that task itself is not signalled
+ */
+void shotStateSetConsumer(TaskHandle_t task);
+
+template <ShotStateFlag F>
+class ShotStateRef {
+public:
+  ShotStateRef() {}
+  ShotStateRef(const ShotStateRef &) = delete;
+
+  operator bool() const { return shotStateTest(F); }
+  ShotStateRef &operator=(bool on)
+  {
+    shotStateSet(F, on);
+    return *this;
+  }
+  ShotStateRef &operator=(const ShotStateRef &) = delete;
+};
+
+template <typename T>
+class AtomicValue {
+  static_assert(sizeof(T) <= sizeof(void *), "One load / store (a machine word)");
+
+public:
+  explicit AtomicValue(T initial) : value(initial) {}
+  AtomicValue(const AtomicValue &) = delete;
+
+  T load() const
+  {
+    T v;
+    __atomic_load(&value, &v, __ATOMIC_ACQUIRE);
+    return v;
+  }
+  void store(T v) { __atomic_store(&value, &v, __ATOMIC_RELEASE); }
+  T exchange(T v)
+  {
+    T old;
+    __atomic_exchange(&value, &v, &old, __ATOMIC_ACQ_REL);
+    return old;
+  }
+
+  operator T() const { return load(); }
+  AtomicValue &operator=(T v)
+  {
+    store(v);
+    return *this;
+  }
+  AtomicValue &operator=(const AtomicValue &) = delete;
+
+private:
+  T value;
+};
+
+#endif // SHOT_STATE_H
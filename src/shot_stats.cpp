@@ -0,0 +1,395 @@
+// =============================================================================
+// Shot-to-Shot Statistics Implementation
+// =============================================================================
+
+#include "shot_stats.h"
+#include "console.h"
+#include "debug_config.h"
+#include "metrics.h"
+#include "screen_nav.h"
+#include <Preferences.h>
+#include <ui.h>
+#include "esp_ota_ops.h"
+
+static constexpr LogTag TAG = LOG_TAG_SHOT;
+
+static const char* SHOT_STATS_NAMESPACE = "shotstats";
+static const char* SHOT_STATS_KEY       = "stats";
+static const uint8_t SHOT_STATS_VERSION = 1;   // Bump when ShotStatsBucket changes
+
+enum ShotStatsBuild : uint8_t { BUILD_CURRENT, BUILD_PREVIOUS, BUILD_COUNT };
+
+// Same order as ShotEndReason
+static const char *const END_REASONS[SHOT_STATS_REASONS] = {"weight", "max time", "button", "disconnected",
+                                                           "stopped", "?", "anomaly"};
+static const char *const BUILD_NAMES[BUILD_COUNT] = {"current", "previous"};
+
+struct ShotStatsRecord {
+  uint8_t version;
+  uint32_t build;                                           // First bytes of app_elf_sha256
+  ShotStatsBucket buckets[BUILD_COUNT][SHOT_PROFILE_SLOTS];
+};
+
+static ShotStatsRecord record = {};
+static portMUX_TYPE statsMux = portMUX_INITIALIZER_UNLOCKED;
+
+static uint32_t runningBuild()
+{
+  const esp_app_desc_t *app = esp_ota_get_app_description();
+  uint32_t id;
+  memcpy(&id, app->app_elf_sha256, sizeof(id));
+  return id;
+}
+
+static void save()
+{
+  ShotStatsRecord copy;
+  portENTER_CRITICAL(&statsMux);
+  copy = record;
+  portEXIT_CRITICAL(&statsMux);
+
+  Preferences prefs;
+  if (prefs.begin(SHOT_STATS_NAMESPACE, false)) {
+    prefs.putBytes(SHOT_STATS_KEY, &copy, sizeof(copy));
+    prefs.end();
+  }
+}
+
+static void addMoments(ShotStatsMoments &m, float x)
+{
+  if (m.n == UINT16_MAX)
+    return;   // Mean is settled long before - keep it
+  m.n++;
+  float delta = x - m.mean;
+  m.mean += delta / m.n;
+  m.m2 += delta * (x - m.mean);
+}
+
+static void addRolling(ShotStatsRolling &r, float x, bool first)
+{
+  if (first) {
+    r.mean = x;
+    r.variance = 0.0f;
+    return;
+  }
+  float delta = x - r.mean;
+  float step = SHOT_STATS_ROLLING_ALPHA * delta;
+  r.mean += step;
+  r.variance = (1.0f - SHOT_STATS_ROLLING_ALPHA) * (r.variance + delta * step);
+}
+
+void shotStatsBegin()
+{
+  uint32_t build = runningBuild();
+  bool loaded = false;
+  Preferences prefs;
+  if (prefs.begin(SHOT_STATS_NAMESPACE, true)) {
+    loaded = prefs.getBytes(SHOT_STATS_KEY, &record, sizeof(record)) == sizeof(record) &&
+             record.version == SHOT_STATS_VERSION;
+    prefs.end();
+  }
+  if (!loaded) {
+    memset(&record, 0, sizeof(record));
+    record.version = SHOT_STATS_VERSION;
+    record.build = build;
+    return;
+  }
+
+  if (record.build != build) {
+    // New firmware: its accuracy starts from zero, the last build's stays for comparison
+    uint32_t shots = 0;
+    for (uint8_t p = 0; p < SHOT_PROFILE_SLOTS; p++)
+      shots += record.buckets[BUILD_CURRENT][p].shots;
+    if (shots > 0)
+      memcpy(record.buckets[BUILD_PREVIOUS], record.buckets[BUILD_CURRENT], sizeof(record.buckets[BUILD_PREVIOUS]));
+    memset(record.buckets[BUILD_CURRENT], 0, sizeof(record.buckets[BUILD_CURRENT]));
+    LOG_INFO(TAG, "📊 Shot stats: new firmware %08lx (was %08lx), %lu shots kept as the previous build",
+             (unsigned long)build, (unsigned long)record.build, (unsigned long)shots);
+    record.build = build;
+    save();
+  }
+}
+
+void shotStatsRecord(uint8_t profile, uint8_t reason, uint8_t anomaly, float goalG, float finalG, float durationS)
+{
+  if (profile >= SHOT_PROFILE_SLOTS)
+    return;
+  if (reason >= SHOT_STATS_REASONS)
+    reason = 5;   // UNDEFINED
+
+  portENTER_CRITICAL(&statsMux);
+  ShotStatsBucket &b = record.buckets[BUILD_CURRENT][profile];
+  if (b.shots < UINT16_MAX)
+    b.shots++;
+  if (b.reasons[reason] < UINT16_MAX)
+    b.reasons[reason]++;
+  if (anomaly && b.anomalies < UINT16_MAX)
+    b.anomalies++;
+
+  float error = finalG - goalG;
+  bool counted = (reason == 0 && goalG > 0.0f);   // WEIGHT_ACHIEVED
+  if (counted) {
+    bool first = (b.errorG.n == 0);
+    addMoments(b.errorG, error);
+    addMoments(b.ratio, finalG / goalG);
+    addMoments(b.durationS, durationS);
+    addRolling(b.errorRolling, error, first);
+    addRolling(b.ratioRolling, finalG / goalG, first);
+    addRolling(b.durationRolling, durationS, first);
+  }
+  ShotStatsMoments errors = b.errorG;
+  ShotStatsRolling rolling = b.errorRolling;
+  portEXIT_CRITICAL(&statsMux);
+
+  if (counted)
+    LOG_INFO(TAG, "📊 Shot stats (profile %u): error %+.2fg, mean %+.2fg sd %.2f over %u, rolling %+.2fg sd %.2f",
+             profile, error, errors.mean, sqrtf(errors.variance()), (unsigned)errors.n, rolling.mean,
+             sqrtf(rolling.variance));
+  save();
+}
+
+bool shotStatsGet(uint8_t profile, ShotStatsBucket *current, ShotStatsBucket *previous)
+{
+  if (profile >= SHOT_PROFILE_SLOTS)
+    return false;
+  portENTER_CRITICAL(&statsMux);
+  if (current != NULL)
+    *current = record.buckets[BUILD_CURRENT][profile];
+  if (previous != NULL)
+    *previous = record.buckets[BUILD_PREVIOUS][profile];
+  portEXIT_CRITICAL(&statsMux);
+  return true;
+}
+
+void shotStatsReset()
+{
+  portENTER_CRITICAL(&statsMux);
+  memset(record.buckets, 0, sizeof(record.buckets));
+  portEXIT_CRITICAL(&statsMux);
+  save();
+  LOG_INFO(TAG, "📊 Shot stats reset");
+}
+
+// One line: "24 shots, error +0.05 g sd 0.21 (rolling +0.02 sd 0.15), ratio 1.001, 28.4 s sd 1.2"
+// (ASCII only - the label font has no "±")
+static void formatBucket(char *text, size_t size, const ShotStatsBucket &b)
+{
+  if (b.errorG.n == 0) {
+    snprintf(text, size, "%u shots, none stopped on weight", (unsigned)b.shots);
+    return;
+  }
+  snprintf(text, size, "%u shots, error %+.2f g sd %.2f (rolling %+.2f sd %.2f), ratio %.3f, %.1f s sd %.1f",
+           (unsigned)b.shots, b.errorG.mean, sqrtf(b.errorG.variance()), b.errorRolling.mean,
+           sqrtf(b.errorRolling.variance), b.ratio.mean, b.durationS.mean, sqrtf(b.durationS.variance()));
+}
+
+void shotStatsDump(Print &out)
+{
+  out.printf("[Stats] firmware %08lx, rolling over ~%u shots\n", (unsigned long)record.build,
+             (unsigned)lroundf(1.0f / SHOT_STATS_ROLLING_ALPHA));
+  bool any = false;
+  for (uint8_t p = 0; p < SHOT_PROFILE_SLOTS; p++) {
+    ShotStatsBucket builds[BUILD_COUNT];
+    shotStatsGet(p, &builds[BUILD_CURRENT], &builds[BUILD_PREVIOUS]);
+    for (uint8_t b = 0; b < BUILD_COUNT; b++) {
+      if (builds[b].shots == 0)
+        continue;
+      any = true;
+      char text[128];
+      formatBucket(text, sizeof(text), builds[b]);
+      out.printf("  %u %-11s %-8s %s\n", p, shotProfile(p)->name, BUILD_NAMES[b], text);
+      out.printf("               rolling ratio %.3f, %.1f s; ends:", builds[b].ratioRolling.mean,
+                 builds[b].durationRolling.mean);
+      for (uint8_t r = 0; r < SHOT_STATS_REASONS; r++) {
+        if (builds[b].reasons[r])
+          out.printf(" %s %u", END_REASONS[r], (unsigned)builds[b].reasons[r]);
+      }
+      out.printf(", %u with an anomaly\n", (unsigned)builds[b].anomalies);
+    }
+  }
+  if (!any)
+    out.println("  no shots recorded");
+}
+
+static void cmdStats(ConsoleArgs &args)
+{
+  if (args.is(1, "reset")) {
+    shotStatsReset();
+  } else if (args.argc > 1) {
+    args.out.println("Usage: stats [reset]");
+    return;
+  }
+  shotStatsDump(args.out);
+}
+
+static ConsoleCommand statsCommand("stats", "[reset]", "Yield error / ratio / time per profile, this build and the one before", cmdStats);
+
+// =============================================================================
+// Metrics: one series per profile and build
+// =============================================================================
+
+static bool readSeries(uint16_t index, char *labels, size_t labelsSize, ShotStatsBucket *bucket)
+{
+  if (index >= BUILD_COUNT * SHOT_PROFILE_SLOTS)
+    return false;
+  uint8_t build = index / SHOT_PROFILE_SLOTS;
+  uint8_t profile = index % SHOT_PROFILE_SLOTS;
+  ShotStatsBucket builds[BUILD_COUNT];
+  shotStatsGet(profile, &builds[BUILD_CURRENT], &builds[BUILD_PREVIOUS]);
+  *bucket = builds[build];
+  snprintf(labels, labelsSize, "profile=\"%s\",build=\"%s\"", shotProfile(profile)->name, BUILD_NAMES[build]);
+  return true;
+}
+
+static bool readShots(uint16_t index, char *labels, size_t labelsSize, int32_t *value)
+{
+  ShotStatsBucket b;
+  if (!readSeries(index, labels, labelsSize, &b))
+    return false;
+  *value = b.shots;
+  return true;
+}
+
+static bool readErrorMean(uint16_t index, char *labels, size_t labelsSize, int32_t *value)
+{
+  ShotStatsBucket b;
+  if (!readSeries(index, labels, labelsSize, &b))
+    return false;
+  *value = (int32_t)lroundf(b.errorG.mean * 1000.0f);
+  return true;
+}
+
+static bool readErrorSd(uint16_t index, char *labels, size_t labelsSize, int32_t *value)
+{
+  ShotStatsBucket b;
+  if (!readSeries(index, labels, labelsSize, &b))
+    return false;
+  *value = (int32_t)lroundf(sqrtf(b.errorG.variance()) * 1000.0f);
+  return true;
+}
+
+static bool readErrorRolling(uint16_t index, char *labels, size_t labelsSize, int32_t *value)
+{
+  ShotStatsBucket b;
+  if (!readSeries(index, labels, labelsSize, &b))
+    return false;
+  *value = (int32_t)lroundf(b.errorRolling.mean * 1000.0f);
+  return true;
+}
+
+static bool readRatio(uint16_t index, char *labels, size_t labelsSize, int32_t *value)
+{
+  ShotStatsBucket b;
+  if (!readSeries(index, labels, labelsSize, &b))
+    return false;
+  *value = (int32_t)lroundf(b.ratio.mean * 1000.0f);
+  return true;
+}
+
+static bool readDuration(uint16_t index, char *labels, size_t labelsSize, int32_t *value)
+{
+  ShotStatsBucket b;
+  if (!readSeries(index, labels, labelsSize, &b))
+    return false;
+  *value = (int32_t)lroundf(b.durationS.mean * 1000.0f);
+  return true;
+}
+
+static bool readEndReasons(uint16_t index, char *labels, size_t labelsSize, int32_t *value)
+{
+  ShotStatsBucket b;
+  uint8_t reason = index % SHOT_STATS_REASONS;
+  if (!readSeries(index / SHOT_STATS_REASONS, labels, labelsSize, &b))
+    return false;
+  size_t used = strlen(labels);
+  snprintf(labels + used, labelsSize - used, ",reason=\"%s\"", END_REASONS[reason]);
+  *value = b.reasons[reason];
+  return true;
+}
+
+static MetricGaugeSet statsShots("shot_stats_shots", "Finished shots per profile and firmware build", readShots);
+static MetricGaugeSet statsErrorMean("shot_yield_error_mean_mg", "Mean final - goal of weight-stopped shots", readErrorMean);
+static MetricGaugeSet statsErrorSd("shot_yield_error_sd_mg", "Standard deviation of final - goal", readErrorSd);
+static MetricGaugeSet statsErrorRolling("shot_yield_error_rolling_mg", "Final - goal over the last ~16 shots (EWMA)", readErrorRolling);
+static MetricGaugeSet statsRatio("shot_yield_ratio_permille", "Mean final / goal of weight-stopped shots", readRatio);
+static MetricGaugeSet statsDuration("shot_duration_mean_ms", "Mean shot time of weight-stopped shots", readDuration);
+static MetricGaugeSet statsEndReasons("shot_end_reason_shots", "Finished shots per end reason", readEndReasons);
+
+// =============================================================================
+// Stats screen (UI task)
+// =============================================================================
+
+static lv_obj_t *settingsScreen = NULL;
+static lv_obj_t *screen = NULL;
+static lv_obj_t *statsLabel = NULL;
+
+static void fillScreen()
+{
+  char text[SHOT_PROFILE_SLOTS * 2 * 112];
+  size_t used = 0;
+  for (uint8_t p = 0; p < SHOT_PROFILE_SLOTS; p++) {
+    ShotStatsBucket current, previous;
+    shotStatsGet(p, &current, &previous);
+    if (current.shots == 0 && previous.shots == 0)
+      continue;
+    char line[112];
+    formatBucket(line, sizeof(line), current);
+    used += snprintf(text + used, sizeof(text) - used, "%s%s: %s", used ? "\n" : "", shotProfile(p)->name, line);
+    if (previous.shots > 0 && used < sizeof(text)) {
+      formatBucket(line, sizeof(line), previous);
+      used += snprintf(text + used, sizeof(text) - used, "\n    previous build: %s", line);
+    }
+    if (used >= sizeof(text))
+      break;
+  }
+  lv_label_set_text(statsLabel, used ? text : "No shots recorded on this firmware yet");
+}
+
+static void backEvent(lv_event_t *e)
+{
+  (void)e;
+  screenNavGo(settingsScreen, LV_SCR_LOAD_ANIM_MOVE_RIGHT);
+}
+
+static void createScreen()
+{
+  screen = lv_obj_create(NULL);
+  lv_obj_set_scroll_dir(screen, LV_DIR_VER);   // Several profiles wrap past one screen
+  lv_obj_set_style_bg_color(screen, lv_color_hex(0x000000), LV_PART_MAIN | LV_STATE_DEFAULT);
+
+  statsLabel = lv_label_create(screen);
+  lv_obj_set_width(statsLabel, lv_pct(92));
+  lv_obj_set_style_text_font(statsLabel, &lv_font_montserrat_14, LV_PART_MAIN);
+  lv_obj_align(statsLabel, LV_ALIGN_TOP_LEFT, 8, 6);
+
+  lv_obj_t *back = lv_btn_create(screen);
+  lv_obj_set_size(back, 28, 28);
+  lv_obj_align(back, LV_ALIGN_BOTTOM_RIGHT, -1, -1);
+  lv_obj_add_flag(back, LV_OBJ_FLAG_FLOATING);   // Stays put while the text scrolls
+  lv_obj_set_style_bg_color(back, lv_color_hex(0x1A1A1A), LV_PART_MAIN | LV_STATE_DEFAULT);
+  lv_obj_set_style_bg_img_src(back, &ui_img_return_png, LV_PART_MAIN | LV_STATE_DEFAULT);
+  lv_obj_add_event_cb(back, backEvent, LV_EVENT_CLICKED, NULL);
+}
+
+static void enterEvent(lv_event_t *e)
+{
+  (void)e;
+  if (screen == NULL)
+    createScreen();
+  fillScreen();
+  screenNavGo(screen, LV_SCR_LOAD_ANIM_MOVE_LEFT);
+}
+
+void shotStatsCreate(lv_obj_t *settings)
+{
+  settingsScreen = settings;
+  lv_obj_t *btn = lv_btn_create(settings);
+  lv_obj_set_size(btn, 28, 28);
+  lv_obj_align(btn, LV_ALIGN_TOP_LEFT, 61, 1);
+  lv_obj_set_style_bg_color(btn, lv_color_hex(0x1A1A1A), LV_PART_MAIN | LV_STATE_DEFAULT);
+  lv_obj_set_style_pad_all(btn, 0, LV_PART_MAIN);
+  lv_obj_t *label = lv_label_create(btn);
+  lv_label_set_text(label, LV_SYMBOL_EYE_OPEN);
+  lv_obj_center(label);
+  lv_obj_add_event_cb(btn, enterEvent, LV_EVENT_CLICKED, NULL);
+}
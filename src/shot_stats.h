@@ -0,0 +1,100 @@
+#ifndef SHOT_STATS_H
+#define SHOT_STATS_H
+
+// =============================================================================
+// Shot-to-Shot Statistics per Profile and Firmware Build
+// =============================================================================
+// Every finished shot updates a few running figures for the profile it ran
+// with, in constant memory - no shot log read, nothing kept per shot:
+//
+//   finished shot ──► profile bucket ──► Welford mean / variance (this build)
+//                                    ──► EWMA mean / variance (rolling)
+//                                    ──► end reason + anomaly counters
+//
+//   - Yield error (final - goal), yield ratio (final / goal) and shot time
+//     only count shots that stopped on weight: a button or disconnect stop
+//     says nothing about the predictor. End reasons count every shot.
+//   - The rolling figures follow the last ~1 / SHOT_STATS_ROLLING_ALPHA
+//     shots, so a drift shows up before it moves the lifetime mean.
+//   - There is no wall clock on the device, so the buckets are per firmware
+//     build instead of per day: when shotStatsBegin() sees another
+//     app_elf_sha256, the last build's buckets move to "previous" and the
+//     new build starts from zero. Accuracy before and after an update sits
+//     side by side on the stats screen, in "stats" and in /metrics.
+//
+// One NVS blob (namespace "shotstats"), written once per shot after the drip
+// delay - never while brewing.
+//
+// Thread Safety:
+//   shotStatsRecord() - shot control task. shotStatsGet() / shotStatsDump() /
+//   the metrics readers copy under a spinlock and may run on any task;
+//   shotStatsCreate() and its screen - UI task. shotStatsBegin() in setup().
+// =============================================================================
+
+#include <Arduino.h>
+#include "lvgl.h"
+#include "shot_profile.h"
+
+constexpr uint8_t SHOT_STATS_REASONS       = 7;             // ShotEndReason values (WEIGHT_ACHIEVED .. FLOW_ANOMALY)
+constexpr float   SHOT_STATS_ROLLING_ALPHA = 1.0f / 16;     // EWMA weight of the newest shot
+
+/** @brief Running mean / variance (Welford) */
+struct ShotStatsMoments {
+  uint16_t n;
+  float mean;
+  float m2;     // Sum of squared deviations
+
+  float variance() const { return n > 1 ? m2 / (n - 1) : 0.0f; }
+};
+
+/** @brief Exponentially weighted mean / variance */
+struct ShotStatsRolling {
+  float mean;
+  float variance;
+};
+
+struct ShotStatsBucket {
+  uint16_t shots;                          // All finished shots
+  uint16_t reasons[SHOT_STATS_REASONS];    // Per ShotEndReason
+  uint16_t anomalies;                      // Shots with a FLOW_ANOMALY_* flag
+  ShotStatsMoments errorG;                 // final - goal (g), weight stops only
+  ShotStatsMoments ratio;                  // final / goal
+  ShotStatsMoments durationS;
+  ShotStatsRolling errorRolling;
+  ShotStatsRolling ratioRolling;
+  ShotStatsRolling durationRolling;
+};
+
+/**
+ * @brief Load the buckets; a new firmware build moves the current ones to "previous"
+ */
+void shotStatsBegin();
+
+/**
+ * @brief One finished shot (after the drip delay), persisted at once
+ * @param reason ShotEndReason, anomaly FLOW_ANOMALY_* flags
+ */
+void shotStatsRecord(uint8_t profile, uint8_t reason, uint8_t anomaly, float goalG, float finalG, float durationS);
+
+/**
+ * @brief Copy of one profile's buckets (this build, the build before)
+ */
+bool shotStatsGet(uint8_t profile, ShotStatsBucket *current, ShotStatsBucket *previous);
+
+/**
+ * @brief Forget everything (both builds) and persist
+ */
+void shotStatsReset();
+
+/**
+ * @brief Per-profile table (the "stats" console command)
+ */
+void shotStatsDump(Print &out);
+
+/**
+ * @brief Add the stats button to `settingsScreen` (after ui_init())
+ * @note The stats screen itself is created on first use
+ */
+void shotStatsCreate(lv_obj_t *settingsScreen);
+
+#endif // SHOT_STATS_H
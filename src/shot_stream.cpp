@@ -0,0 +1,143 @@
+// =============================================================================
+// Live Shot Telemetry Implementation
+// =============================================================================
+
+#include "shot_stream.h"
+#include "debug_config.h"
+#include "metrics.h"
+#include "wifi_coex.h"
+
+#ifdef WIRELESS_DEBUG
+
+#include <ESPAsyncWebServer.h>
+
+static constexpr LogTag TAG = LOG_TAG_WIFI;
+static constexpr uint32_t CLEANUP_MS = 1000;   // Closed clients released this often
+
+static AsyncWebSocket socket(SHOT_STREAM_PATH);
+
+// SPSC record ring - head written by the BLE task only, tail by the UI task only
+static ShotStreamRecord ring[SHOT_STREAM_RING];
+static volatile uint32_t ringHead = 0;
+static volatile uint32_t ringTail = 0;
+static volatile uint32_t clients = 0;   // async_tcp task writes, producer reads
+
+// Consumer only
+static uint8_t frame[sizeof(ShotStreamHeader) + SHOT_STREAM_RING * sizeof(ShotStreamRecord)];
+static uint16_t batchSeq = 0;
+static uint32_t unitId = 0;
+static uint32_t lastBatchMs = 0;
+static uint32_t lastCleanupMs = 0;
+
+static volatile uint32_t overruns = 0;
+static volatile uint32_t frames = 0;
+static volatile uint32_t busySkips = 0;
+
+static MetricCounterRef framesTotal("shot_stream_frames_total", "Live shot WebSocket frames sent", &frames);
+static MetricCounterRef overrunsTotal("shot_stream_overruns_total", "Live shot samples lost to a full ring", &overruns);
+static MetricCounterRef busyTotal("shot_stream_busy_total", "Live shot frames skipped - a client's send queue was full", &busySkips);
+static MetricGauge clientsGauge("shot_stream_clients", "Live shot WebSocket clients");
+
+static void onEvent(AsyncWebSocket *server, AsyncWebSocketClient *client, AwsEventType type, void *arg,
+                    uint8_t *data, size_t len)
+{
+  (void)arg;
+  (void)data;
+  (void)len;
+  if (type == WS_EVT_CONNECT) {
+    LOG_INFO(TAG, "📡 Shot stream client #%lu connected", (unsigned long)client->id());
+  } else if (type == WS_EVT_DISCONNECT) {
+    LOG_INFO(TAG, "📡 Shot stream client #%lu left", (unsigned long)client->id());
+  } else {
+    return;
+  }
+  clients = server->count();
+  clientsGauge.set((int32_t)clients);
+}
+
+void shotStreamRegister(AsyncWebServer &server)
+{
+  unitId = (uint32_t)ESP.getEfuseMac();
+  socket.onEvent(onEvent);
+  server.addHandler(&socket);
+  LOG_INFO(TAG, "Live shot stream: ws://<ip>%s (unit %08lX)", SHOT_STREAM_PATH, (unsigned long)unitId);
+}
+
+void shotStreamPush(float weightG, float flowGps, float shotS, float expectedEndS, uint8_t state)
+{
+  static ShotStreamRecord last = {};
+  ShotStreamRecord next = last;
+  next.weightCg = (int32_t)lroundf(weightG * 100.0f);
+  next.flowCgps = (int16_t)lroundf(constrain(flowGps, -327.0f, 327.0f) * 100.0f);
+  next.endDs = expectedEndS > 0.0f ? (uint16_t)lroundf(constrain(expectedEndS, 0.0f, 6553.0f) * 10.0f) : 0;
+  next.shotDs = (uint16_t)lroundf(constrain(shotS, 0.0f, 6553.0f) * 10.0f);
+  next.state = state;
+  if (memcmp(&next, &last, sizeof(next)) == 0)
+    return;  // Same values as the last BLE task pass
+  next.sequence++;  // Counts every change, so gaps in the stream show overruns
+  last = next;
+  if (clients == 0)
+    return;
+
+  uint32_t head = ringHead;
+  if (head - ringTail >= SHOT_STREAM_RING) {
+    overruns++;
+    return;
+  }
+  next.ms = millis();
+  ring[head & (SHOT_STREAM_RING - 1)] = next;
+  __sync_synchronize();  // Record contents visible before the index moves
+  ringHead = head + 1;
+}
+
+uint32_t shotStreamPoll(uint32_t nowMs)
+{
+  if (nowMs - lastCleanupMs >= CLEANUP_MS) {
+    lastCleanupMs = nowMs;
+    socket.cleanupClients();
+  }
+
+  uint32_t tail = ringTail;
+  if (clients == 0) {
+    ringTail = ringHead;  // Nobody listening: samples pushed before the last client left
+    return UINT32_MAX;
+  }
+
+  uint32_t periodMs = wifiCoexQuiet() ? SHOT_STREAM_QUIET_BATCH_MS : SHOT_STREAM_BATCH_MS;
+  uint32_t elapsed = nowMs - lastBatchMs;
+  if (elapsed < periodMs)
+    return periodMs - elapsed;
+  lastBatchMs = nowMs;
+
+  uint32_t count = ringHead - tail;
+  if (count == 0)
+    return periodMs;
+  __sync_synchronize();  // Read records only after seeing the new head
+
+  if (!socket.availableForWriteAll()) {
+    busySkips++;
+    ringTail = tail + count;  // Newest samples next time, not a backlog
+    return periodMs;
+  }
+
+  ShotStreamHeader header = {SHOT_STREAM_VERSION, (uint8_t)count, batchSeq++, unitId};
+  memcpy(frame, &header, sizeof(header));
+  uint8_t *out = frame + sizeof(header);
+  for (uint32_t i = 0; i < count; i++, out += sizeof(ShotStreamRecord))
+    memcpy(out, &ring[(tail + i) & (SHOT_STREAM_RING - 1)], sizeof(ShotStreamRecord));
+  ringTail = tail + count;
+
+  socket.binaryAll(frame, out - frame);
+  frames++;
+  return periodMs;
+}
+
+void shotStreamDump(Print &out)
+{
+  out.printf("[Shot stream] ws://<ip>%s, %lu clients, %lu frames, %lu overruns, %lu busy skips, batch %lu ms (%lu ms quiet)\n",
+             SHOT_STREAM_PATH, (unsigned long)clients, (unsigned long)frames, (unsigned long)overruns,
+             (unsigned long)busySkips, (unsigned long)SHOT_STREAM_BATCH_MS,
+             (unsigned long)SHOT_STREAM_QUIET_BATCH_MS);
+}
+
+#endif // WIRELESS_DEBUG
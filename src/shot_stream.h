@@ -0,0 +1,106 @@
+#ifndef SHOT_STREAM_H
+#define SHOT_STREAM_H
+
+// =============================================================================
+// Live Shot Telemetry (WebSocket, binary frames)
+// =============================================================================
+// A tablet on the bar follows the shots of several machines on one page:
+// ws://<ESP32-IP>/shot pushes binary frames, no text formatting, no log
+// lines. Each frame is a batch:
+//
+//   ShotStreamHeader   8 bytes: version, record count, batch sequence, unit ID
+//   ShotStreamRecord   16 bytes each: ms since boot, weight, flow, predicted
+//                      end, shot time, state (WeightBroadcastState), sample seq
+//
+// little-endian and packed, so a JavaScript DataView reads them directly. The
+// unit ID (low 32 bits of the factory MAC) tells machines apart when one page
+// opens several sockets.
+//
+// shotStreamPush() (BLE task, every pass) skips values that did not change
+// and copies the rest into an SPSC ring - only while a client is connected.
+// shotStreamPoll() (UI task) sends what the ring holds as one frame every
+// SHOT_STREAM_BATCH_MS, or every SHOT_STREAM_QUIET_BATCH_MS while Wi-Fi is
+// quiet for a shot (wifi_coex.h): the same bytes in fewer, larger packets,
+// so the radio wakes less often while the scale link matters most. A client
+// whose send queue is still full misses the frame (counted) instead of
+// queueing more - a live view wants the newest samples, not all of them.
+//
+// The endpoint lives on the WIRELESS_DEBUG server (setupWirelessDebug()),
+// the only build with Wi-Fi; otherwise every call is an inline no-op. Nothing
+// in it is debug-only: binary records, fixed memory, no logging per sample.
+//
+// GS_SHOT_STREAM_BATCH_MS (compile-time): batch period, default 200 ms.
+//
+// Thread Safety:
+//   shotStreamPush() - BLE task only (ring producer). shotStreamPoll() - UI
+//   task only (ring consumer, WebSocket sends). shotStreamRegister() - setup.
+//   Client events run in the async_tcp task and only touch the client count.
+// =============================================================================
+
+#include <Arduino.h>
+
+class AsyncWebServer;
+
+#ifndef GS_SHOT_STREAM_BATCH_MS
+#define GS_SHOT_STREAM_BATCH_MS 200
+#endif
+
+constexpr uint32_t SHOT_STREAM_BATCH_MS       = GS_SHOT_STREAM_BATCH_MS;
+constexpr uint32_t SHOT_STREAM_QUIET_BATCH_MS = 1000;  // While wifiCoexQuiet()
+constexpr uint32_t SHOT_STREAM_RING           = 64;    // Records (power of 2): 6 s at 10 Hz
+constexpr uint8_t  SHOT_STREAM_VERSION        = 1;
+constexpr const char *SHOT_STREAM_PATH        = "/shot";
+
+struct __attribute__((packed)) ShotStreamHeader {
+  uint8_t version;      // SHOT_STREAM_VERSION
+  uint8_t count;        // Records that follow
+  uint16_t batch;       // Frame sequence (wraps) - a gap means a missed frame
+  uint32_t unitId;      // Low 32 bits of the factory MAC (eFuse)
+};
+
+struct __attribute__((packed)) ShotStreamRecord {
+  uint32_t ms;          // millis() of the sample
+  int32_t weightCg;     // 0.01 g
+  int16_t flowCgps;     // 0.01 g/s, filtered (0 outside a shot)
+  uint16_t endDs;       // Predicted shot end, 0.1 s (0 = none)
+  uint16_t shotDs;      // Shot time, 0.1 s
+  uint8_t state;        // WeightBroadcastState
+  uint8_t sequence;     // Changed-sample counter (wraps) - gaps are ring overruns
+};
+
+static_assert(sizeof(ShotStreamHeader) == 8, "ShotStreamHeader is part of the WebSocket interface");
+static_assert(sizeof(ShotStreamRecord) == 16, "ShotStreamRecord is part of the WebSocket interface");
+
+#ifdef WIRELESS_DEBUG
+
+/**
+ * @brief Add the WebSocket endpoint to `server` (before server.begin())
+ */
+void shotStreamRegister(AsyncWebServer &server);
+
+/**
+ * @brief Queue the sample for the next frame if it changed (dropped when no client is connected)
+ */
+void shotStreamPush(float weightG, float flowGps, float shotS, float expectedEndS, uint8_t state);
+
+/**
+ * @brief Send the batch if due
+ * @return ms until the next batch is due (UINT32_MAX without clients)
+ */
+uint32_t shotStreamPoll(uint32_t nowMs);
+
+/**
+ * @brief Clients, frames, drops
+ */
+void shotStreamDump(Print &out);
+
+#else
+
+inline void shotStreamRegister(AsyncWebServer &) {}
+inline void shotStreamPush(float, float, float, float, uint8_t) {}
+inline uint32_t shotStreamPoll(uint32_t) { return UINT32_MAX; }
+inline void shotStreamDump(Print &) {}
+
+#endif // WIRELESS_DEBUG
+
+#endif // SHOT_STREAM_H
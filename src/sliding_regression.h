@@ -0,0 +1,144 @@
+#ifndef SLIDING_REGRESSION_H
+#define SLIDING_REGRESSION_H
+
+// =============================================================================
+// Sliding-Window Linear Regression for Gravimetric Shots
+// =============================================================================
+// Least-squares line y = slope * x + intercept over the last Capacity samples,
+// updated in O(1) per sample:
+//
+//   - Keeps the means and the centered co-moments (Welford), not raw sums.
+//     The naive N*sum(x^2) - sum(x)^2 cancels catastrophically in float once
+//     x is a shot time of tens of seconds; the centered form never subtracts
+//     two large numbers.
+//   - When the window is full, the oldest sample is removed with the exact
+//     inverse of the add step before the new one goes in.
+//   - Add/remove rounding would still creep in over a long shot, so every
+//     Capacity samples the statistics are rebuilt from the window (two-pass,
+//     relative to the oldest x). Amortized that is still O(1) per sample.
+//
+// Usage:
+//   SlidingRegression<10> trend;
+//   trend.add(t_s, grams);                  // per weight sample
+//   float flow = trend.slope();             // g/s over the window
+//   float t = trend.xAt(targetGrams);       // when the trend line gets there
+//
+// Feed (t, flow) into a second instance for acceleration. Not thread safe -
+// keep each instance on one task (the shot control task for the shot model).
+// =============================================================================
+
+#include <Arduino.h>
+
+template <int Capacity>
+class SlidingRegression {
+public:
+  SlidingRegression() { reset(); }
+
+  void reset()
+  {
+    head = 0;
+    n = 0;
+    meanX = 0.0f;
+    meanY = 0.0f;
+    sxx = 0.0f;
+    sxy = 0.0f;
+  }
+
+  /**
+   * @brief Add a sample, evicting the oldest once Capacity samples are held
+   */
+  void add(float x, float y)
+  {
+    if (n == Capacity)
+      remove(xs[head], ys[head]);
+
+    xs[head] = x;
+    ys[head] = y;
+    head = (head + 1) % Capacity;
+
+    n++;
+    float dx = x - meanX;
+    meanX += dx / n;
+    meanY += (y - meanY) / n;
+    sxx += dx * (x - meanX);
+    sxy += dx * (y - meanY);
+
+    if (n == Capacity && head == 0)
+      rebuild();
+  }
+
+  int count() const { return n; }
+  bool full() const { return n == Capacity; }
+
+  /**
+   * @brief Slope of the fitted line (dy/dx), 0 until two distinct x values are held
+   */
+  float slope() const
+  {
+    return (n < 2 || sxx <= 0.0f) ? 0.0f : sxy / sxx;
+  }
+
+  float intercept() const { return meanY - slope() * meanX; }
+
+  /**
+   * @brief x at which the fitted line reaches y (caller checks slope() first)
+   */
+  float xAt(float y) const { return meanX + (y - meanY) / slope(); }
+
+private:
+  // Exact two-pass statistics over the full window (drops accumulated rounding)
+  void rebuild()
+  {
+    float x0 = xs[head];  // Oldest sample - offsets keep the sums small
+    float sumDx = 0.0f;
+    float sumY = 0.0f;
+    for (int i = 0; i < n; i++)
+    {
+      sumDx += xs[i] - x0;
+      sumY += ys[i];
+    }
+    float meanDx = sumDx / n;
+    meanY = sumY / n;
+    meanX = x0 + meanDx;
+
+    sxx = 0.0f;
+    sxy = 0.0f;
+    for (int i = 0; i < n; i++)
+    {
+      float dx = (xs[i] - x0) - meanDx;
+      sxx += dx * dx;
+      sxy += dx * (ys[i] - meanY);
+    }
+  }
+
+  // Inverse of the add step (n > 0)
+  void remove(float x, float y)
+  {
+    if (n == 1)
+    {
+      reset();
+      return;
+    }
+
+    float dx = x - meanX;
+    float dy = y - meanY;
+    n--;
+    meanX -= dx / n;
+    meanY -= dy / n;
+    sxx -= dx * (x - meanX);
+    sxy -= (x - meanX) * dy;
+    if (sxx < 0.0f)
+      sxx = 0.0f;  // Rounding on near-identical x values
+  }
+
+  float xs[Capacity];
+  float ys[Capacity];
+  int head;
+  int n;
+  float meanX;
+  float meanY;
+  float sxx;   // sum (x - meanX)^2
+  float sxy;   // sum (x - meanX)(y - meanY)
+};
+
+#endif // SLIDING_REGRESSION_H
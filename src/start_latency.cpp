@@ -0,0 +1,147 @@
+// =============================================================================
+// Shot Start Latency Implementation
+// =============================================================================
+
+#include "start_latency.h"
+#include "debug_config.h"
+#include "metrics.h"
+#include "trace.h"
+#include "esp_timer.h"
+
+static constexpr LogTag TAG = LOG_TAG_SHOT;
+static constexpr uint32_t HOP_NONE = 0xFFFFFFFFu;
+
+static const char *const hopNames[START_HOP_COUNT] = {"touch", "event", "command", "dispatch", "reset ack",
+                                                      "tare ack", "start ack", "relay", "frame"};
+// Chrome trace names (string literals, trace.h)
+static const char *const traceNames[START_HOP_COUNT] = {"start:touch", "start:event", "start:command",
+                                                        "start:dispatch", "start:ack-reset", "start:ack-tare",
+                                                        "start:ack-start", "start:relay", "start:frame"};
+
+struct StartRecord {
+  uint32_t id;
+  uint32_t hopUs[START_HOP_COUNT];   // Since the touch hop, HOP_NONE = not reached
+};
+
+static MetricHistogram relayMs("shot_start_relay_ms", "Start press (touch sample) → pump relay on", METRIC_BUCKETS_MS);
+static MetricHistogram frameMs("shot_start_frame_ms", "Start press (touch sample) → first brewing frame on the panel", METRIC_BUCKETS_MS);
+static MetricCounter abortedTotal("shot_start_aborted_total", "Start traces dropped (scale not connected, batch failed)");
+
+static volatile uint32_t openId = 0;     // 0 = no trace open
+static uint32_t lastId = 0;
+static volatile int64_t hopUs[START_HOP_COUNT];
+static volatile bool frameArmed = false;
+
+static StartRecord history[START_LATENCY_HISTORY];
+static uint32_t historyCount = 0;
+
+static void record(StartHop hop, int64_t us)
+{
+  hopUs[hop] = us;
+#if GS_TRACE
+  traceRecord(traceNames[hop], (uint32_t)us, TRACE_INSTANT);
+#endif
+}
+
+uint32_t startLatencyBegin(uint32_t touchMs)
+{
+  for (uint8_t i = 0; i < START_HOP_COUNT; i++)
+    hopUs[i] = 0;
+  frameArmed = false;
+  if (++lastId == 0)
+    lastId = 1;
+  int64_t now = esp_timer_get_time();
+  int64_t touchUs = (int64_t)touchMs * 1000;
+  record(START_HOP_TOUCH, touchUs <= now ? touchUs : now);  // ms resolution, never after the event
+  record(START_HOP_EVENT, now);
+  openId = lastId;
+  return lastId;
+}
+
+void startLatencyMark(StartHop hop)
+{
+  startLatencyMarkAt(hop, esp_timer_get_time());
+}
+
+void startLatencyMarkAt(StartHop hop, int64_t us)
+{
+  if (openId == 0 || hop >= START_HOP_COUNT || us == 0 || hopUs[hop] != 0)
+    return;
+  record(hop, us);
+}
+
+void startLatencyAbort()
+{
+  if (openId == 0)
+    return;
+  LOG_DEBUG(TAG, "Start trace #%lu dropped", (unsigned long)openId);
+  openId = 0;
+  frameArmed = false;
+  abortedTotal.add();
+}
+
+void startLatencyUiPass(bool brewing)
+{
+  if (openId != 0 && brewing && hopUs[START_HOP_RELAY] != 0)
+    frameArmed = true;
+}
+
+// "12.3" - ms with 0.1 ms resolution
+static const char *fmtMs(char *buf, size_t len, uint32_t us)
+{
+  if (us == HOP_NONE)
+    snprintf(buf, len, "-");
+  else
+    snprintf(buf, len, "%lu.%lu", (unsigned long)(us / 1000), (unsigned long)((us % 1000) / 100));
+  return buf;
+}
+
+static void closeTrace()
+{
+  StartRecord &r = history[historyCount % START_LATENCY_HISTORY];
+  r.id = openId;
+  int64_t t0 = hopUs[START_HOP_TOUCH];
+  for (uint8_t i = 0; i < START_HOP_COUNT; i++)
+    r.hopUs[i] = hopUs[i] != 0 ? (uint32_t)(hopUs[i] - t0) : HOP_NONE;
+  historyCount++;
+  openId = 0;
+  frameArmed = false;
+
+  if (r.hopUs[START_HOP_RELAY] != HOP_NONE)
+    relayMs.record(r.hopUs[START_HOP_RELAY] / 1000);
+  frameMs.record(r.hopUs[START_HOP_FRAME] / 1000);
+
+  char a[12], b[12], c[12], d[12], e[12];
+  LOG_INFO(TAG, "⏱️  START #%lu: event %s, dispatch %s, tare ack %s, relay %s, frame %s ms after the tap",
+           (unsigned long)r.id, fmtMs(a, sizeof(a), r.hopUs[START_HOP_EVENT]),
+           fmtMs(b, sizeof(b), r.hopUs[START_HOP_DISPATCH]), fmtMs(c, sizeof(c), r.hopUs[START_HOP_ACK_TARE]),
+           fmtMs(d, sizeof(d), r.hopUs[START_HOP_RELAY]), fmtMs(e, sizeof(e), r.hopUs[START_HOP_FRAME]));
+}
+
+void startLatencyFrameFlushed()
+{
+  if (!frameArmed)
+    return;
+  record(START_HOP_FRAME, esp_timer_get_time());
+  closeTrace();
+}
+
+void startLatencyDump(Print &out)
+{
+  uint32_t n = historyCount < START_LATENCY_HISTORY ? historyCount : START_LATENCY_HISTORY;
+  out.printf("[Start latency] %lu traced, %lu open (ms after the touch sample; step since the previous hop)\n",
+             (unsigned long)historyCount, (unsigned long)(openId != 0));
+  char cum[12], step[12];
+  for (uint32_t k = 0; k < n; k++) {
+    const StartRecord &r = history[(historyCount - 1 - k) % START_LATENCY_HISTORY];
+    out.printf("  #%lu\n", (unsigned long)r.id);
+    uint32_t prev = 0;
+    for (uint8_t i = 1; i < START_HOP_COUNT; i++) {
+      uint32_t us = r.hopUs[i];
+      out.printf("    %-10s %8s  %8s\n", hopNames[i], fmtMs(cum, sizeof(cum), us),
+                 fmtMs(step, sizeof(step), us == HOP_NONE || us < prev ? HOP_NONE : us - prev));
+      if (us != HOP_NONE)
+        prev = us;
+    }
+  }
+}
@@ -0,0 +1,92 @@
+#ifndef START_LATENCY_H
+#define START_LATENCY_H
+
+// =============================================================================
+// Shot Start Latency (tap → relay, tap → pixel)
+// =============================================================================
+// A Start press crosses three tasks and the scale before the pump runs. Each
+// accepted press gets a trace ID and one timestamp per hop:
+//
+//   touch      touch task read the release sample (TouchSample.ms)
+//   event      LVGL CLICKED judged by ui_intent.h (UI task)
+//   command    bleCommand_StartShotSequence() handed it to the BLE task
+//   dispatch   BLE task sent the reset / tare / start batch
+//   reset ack  scale acknowledged each command (arrival time of the packet,
+//   tare ack   those in by the time the sequence arms the shot; scales
+//   start ack  without command feedback only get "tare", inferred from the
+//              zeroed weight)
+//   relay      control task switched the pump on (armShot())
+//   frame      last area of the first frame rendered after the UI task saw
+//              shot.brewing went to the panel
+//
+// The trace closes at the frame, or is dropped when the sequence fails.
+// Closed traces are kept (last START_LATENCY_HISTORY), logged as one
+// breakdown line, fed to the histograms shot_start_relay_ms /
+// shot_start_frame_ms, and printed per shot by startLatencyDump() ("start"
+// command). With GS_TRACE each hop is also an instant event in the Chrome
+// trace, so a slow hop can be lined up with what the tasks were doing.
+//
+// esp_timer microseconds throughout (millis() is derived from the same
+// clock, so the touch sample's ms converts directly).
+//
+// Thread Safety:
+//   One trace at a time. Each hop has one writer, and the hops follow the
+//   task hand-offs (notify / queue), so no lock is needed. A press that
+//   arrives while a trace is open replaces it. startLatencyDump() - any task.
+// =============================================================================
+
+#include <Arduino.h>
+
+constexpr uint8_t START_LATENCY_HISTORY = 8;
+
+enum StartHop : uint8_t {
+  START_HOP_TOUCH = 0,
+  START_HOP_EVENT,
+  START_HOP_COMMAND,
+  START_HOP_DISPATCH,
+  START_HOP_ACK_RESET,
+  START_HOP_ACK_TARE,
+  START_HOP_ACK_START,
+  START_HOP_RELAY,
+  START_HOP_FRAME,
+  START_HOP_COUNT
+};
+
+/**
+ * @brief Open a trace for an accepted Start press (touch + event hops)
+ * @param touchMs millis() of the touch sample that completed the press
+ * @return Trace ID
+ */
+uint32_t startLatencyBegin(uint32_t touchMs);
+
+/**
+ * @brief Record `hop` now (first call per trace only; no-op without an open trace)
+ */
+void startLatencyMark(StartHop hop);
+
+/**
+ * @brief Record `hop` at an esp_timer time taken elsewhere (scale acks); 0 is ignored
+ */
+void startLatencyMarkAt(StartHop hop, int64_t us);
+
+/**
+ * @brief Drop the open trace (scale not connected, batch failed)
+ */
+void startLatencyAbort();
+
+/**
+ * @brief UI task, every pass: the frame hop waits for the UI to have seen the shot
+ */
+void startLatencyUiPass(bool brewing);
+
+/**
+ * @brief Flush callback, last area of a frame
+ */
+void startLatencyFrameFlushed();
+
+/**
+ * @brief Per-shot hop breakdown of the kept traces
+ */
+void startLatencyDump(Print &out);
+
+#endif // START_LATENCY_H
@@ -0,0 +1,73 @@
+#ifndef STATIC_ALLOC_H
+#define STATIC_ALLOC_H
+
+// =============================================================================
+// Static FreeRTOS Objects and Buffers (storage reserved at link time)
+// =============================================================================
+// Queues, mutexes and semaphores that live as long as the firmware are
+// created over storage the linker reserves, with the *CreateStatic APIs,
+// instead of out of the heap at boot:
+//
+//   static StaticQueue<BLECommandMessage, 8> laneStore;  // .bss
+//   lanes[0] = laneStore.create();                        // never NULL
+//
+// Creation cannot fail, so the callers lose their out-of-memory paths, the
+// heap keeps only what really is dynamic (BLE, Wi-Fi, LittleFS, LVGL), and
+// an oversized object shows up as a "region dram0_0_seg overflowed" link
+// error instead of a halt at boot.
+//
+// Regions: a plain static object is internal DRAM (.bss) - where queues and
+// semaphores have to be, because ISRs and flash operations touch them.
+// GS_PSRAM_BSS places a large, CPU-only buffer in PSRAM instead (.ext_ram.bss).
+// That needs CONFIG_SPIRAM_ALLOW_BSS_SEG_EXTERNAL_MEMORY in the sdkconfig;
+// GS_PSRAM_BSS_AVAILABLE says whether it is there, and without it such
+// buffers keep their ps_malloc() at boot.
+//
+// Task stacks: TASK_STACK_STATIC in the task_layout.cpp table.
+//
+// Thread Safety:
+//   create() once, from setup() or a module begin function. The handles it
+//   returns are ordinary FreeRTOS handles.
+// =============================================================================
+
+#include <Arduino.h>
+#include <esp_attr.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+
+#if defined(CONFIG_SPIRAM_ALLOW_BSS_SEG_EXTERNAL_MEMORY) && CONFIG_SPIRAM_ALLOW_BSS_SEG_EXTERNAL_MEMORY
+#define GS_PSRAM_BSS_AVAILABLE 1
+#define GS_PSRAM_BSS EXT_RAM_ATTR
+#else
+#define GS_PSRAM_BSS_AVAILABLE 0
+#define GS_PSRAM_BSS
+#endif
+
+template <typename T, size_t N>
+class StaticQueue {
+public:
+  QueueHandle_t create() { return xQueueCreateStatic(N, sizeof(T), storage, &control); }
+
+private:
+  uint8_t storage[N * sizeof(T)];
+  StaticQueue_t control;
+};
+
+class StaticMutex {
+public:
+  SemaphoreHandle_t create() { return xSemaphoreCreateMutexStatic(&control); }
+
+private:
+  StaticSemaphore_t control;
+};
+
+class StaticBinarySemaphore {
+public:
+  SemaphoreHandle_t create() { return xSemaphoreCreateBinaryStatic(&control); }
+
+private:
+  StaticSemaphore_t control;
+};
+
+#endif // STATIC_ALLOC_H
@@ -0,0 +1,102 @@
+// =============================================================================
+// Status Line Scheduler Implementation
+// =============================================================================
+
+#include "status_line.h"
+
+static const StatusPolicy POLICIES[STATUS_ID_COUNT] = {
+  {STATUS_PRIO_PROGRESS, 0},     // STATUS_NONE
+  {STATUS_PRIO_PROGRESS, 0},     // STATUS_SHOT_PROGRESS
+  {STATUS_PRIO_ALERT,    3000},  // STATUS_SHOT_END
+  {STATUS_PRIO_EVENT,    1500},  // STATUS_SCALE_LINK (waits out a flush like the old pending status)
+  {STATUS_PRIO_EVENT,    1500},  // STATUS_COMMAND
+  {STATUS_PRIO_EVENT,    500},   // STATUS_BUTTON
+  {STATUS_PRIO_ALERT,    2000},  // STATUS_FLUSH (flush / backflush countdown every 1 s, the end held 2 s)
+  {STATUS_PRIO_EVENT,    1000},  // STATUS_CUP
+  {STATUS_PRIO_EVENT,    1500},  // STATUS_OFFSET
+  {STATUS_PRIO_EVENT,    3000},  // STATUS_BOOT
+  {STATUS_PRIO_EVENT,    1000},  // STATUS_SETTING (every slider step replaces the last)
+  {STATUS_PRIO_EVENT,    3000},  // STATUS_CLEAN
+};
+
+const StatusPolicy &statusPolicy(StatusId id)
+{
+  return POLICIES[id < STATUS_ID_COUNT ? id : STATUS_NONE];
+}
+
+StatusScheduler::StatusScheduler() : current(STATUS_NONE), shownAtMs(0), holdMs(0)
+{
+  shownText[0] = '\0';
+  for (Parked &p : parked)
+    p.id = STATUS_NONE;
+}
+
+bool StatusScheduler::mayReplace(StatusId id, uint32_t nowMs) const
+{
+  if (id == current || statusPolicy(id).priority >= statusPolicy(current).priority)
+    return true;
+  return nowMs - shownAtMs >= holdMs;
+}
+
+void StatusScheduler::show(StatusId id, const char *text, uint32_t nowMs)
+{
+  current = id;
+  shownAtMs = nowMs;
+  holdMs = statusPolicy(id).holdMs;
+  strncpy(shownText, text, sizeof(shownText) - 1);
+  shownText[sizeof(shownText) - 1] = '\0';
+}
+
+bool StatusScheduler::offer(StatusId id, const char *text, uint32_t nowMs)
+{
+  Parked &slot = parked[statusPolicy(id).priority];
+  if (strncmp(text, shownText, sizeof(shownText) - 1) == 0)
+  {
+    slot.id = STATUS_NONE;  // Newest of its priority is on screen already
+    return false;
+  }
+
+  // Newest per priority wins; service() shows it at once if nothing holds it back
+  slot.id = id;
+  strncpy(slot.text, text, sizeof(slot.text) - 1);
+  slot.text[sizeof(slot.text) - 1] = '\0';
+  return service(nowMs);
+}
+
+bool StatusScheduler::service(uint32_t nowMs)
+{
+  if (current != STATUS_NONE && nowMs - shownAtMs < STATUS_LINE_MIN_INTERVAL_MS)
+    return false;
+
+  for (int p = STATUS_PRIORITY_COUNT - 1; p >= 0; p--)
+  {
+    Parked &slot = parked[p];
+    if (slot.id == STATUS_NONE)
+      continue;
+    if (!mayReplace(slot.id, nowMs))
+      return false;  // Lower priorities wait as well
+    show(slot.id, slot.text, nowMs);
+    slot.id = STATUS_NONE;
+    return true;
+  }
+  return false;
+}
+
+uint32_t StatusScheduler::dueInMs(uint32_t nowMs) const
+{
+  for (int p = STATUS_PRIORITY_COUNT - 1; p >= 0; p--)
+  {
+    if (parked[p].id == STATUS_NONE)
+      continue;
+    uint32_t elapsed = nowMs - shownAtMs;
+    uint32_t wait = (elapsed >= STATUS_LINE_MIN_INTERVAL_MS) ? 0 : STATUS_LINE_MIN_INTERVAL_MS - elapsed;
+    if (!mayReplace(parked[p].id, nowMs))
+    {
+      uint32_t held = holdMs - elapsed;  // mayReplace() false: elapsed < holdMs
+      if (held > wait)
+        wait = held;
+    }
+    return wait;
+  }
+  return UINT32_MAX;
+}
@@ -0,0 +1,108 @@
+#ifndef STATUS_LINE_H
+#define STATUS_LINE_H
+
+// =============================================================================
+// Status Line Scheduler (message IDs, priorities, hold times, dedup)
+// =============================================================================
+// One line of text on the main and settings screens is shared by the shot
+// progress, the scale link, command results, the flush countdown and more.
+// Each message carries a StatusId; its policy gives it a priority and a
+// minimum display time:
+//
+//   same ID as shown    replaces it at once (progress updates, countdowns)
+//   priority >= shown   replaces it at once
+//   lower priority      parked until the shown message's hold has passed;
+//                       the newest message per priority is kept
+//   same text as shown  dropped (no label invalidation)
+//
+// On top of that the line changes at most every STATUS_LINE_MIN_INTERVAL_MS
+// (the old 4 Hz gate). A flush countdown (ALERT, held) therefore keeps scale
+// messages parked until it has ended and "Flushing ended" has been read,
+// which replaces the pending-status / flush-hold bookkeeping of the sketch.
+//
+// Producers post through ui_channel.h, which keeps one slot per priority so
+// a burst of progress updates cannot overwrite an alert before the UI task
+// has seen it. The UI task offers what it takes to a StatusScheduler and
+// sets only the label of the screen being shown.
+//
+// Thread Safety:
+//   StatusScheduler - UI task (Core 1) only, like the labels.
+//   statusPolicy() - any task (constant table).
+// =============================================================================
+
+#include <Arduino.h>
+
+constexpr size_t STATUS_LINE_TEXT_LEN = 64;
+constexpr uint32_t STATUS_LINE_MIN_INTERVAL_MS = 250;
+
+enum StatusPriority : uint8_t {
+  STATUS_PRIO_PROGRESS,  // Continuous updates - anything may replace them
+  STATUS_PRIO_EVENT,     // Scale link, command results, detections
+  STATUS_PRIO_ALERT,     // Shot ended, flush running
+  STATUS_PRIORITY_COUNT
+};
+
+enum StatusId : uint8_t {
+  STATUS_NONE,
+  STATUS_SHOT_PROGRESS,  // Expected end, extraction time, flow anomalies (every sample)
+  STATUS_SHOT_END,       // Why and when the shot ended
+  STATUS_SCALE_LINK,     // Scale connected / disconnected / not found
+  STATUS_COMMAND,        // Tare / timer results, rejected commands
+  STATUS_BUTTON,         // Start / Stop pressed
+  STATUS_FLUSH,          // Flush countdown and end
+  STATUS_CUP,            // Cup detection (cup_detect.h)
+  STATUS_OFFSET,         // Goal offset and its confidence
+  STATUS_BOOT,           // Crash report of the previous run
+  STATUS_SETTING,        // Slider values on the settings screen
+  STATUS_CLEAN,          // Backflush reminder (clean_program.h)
+  STATUS_ID_COUNT
+};
+
+struct StatusPolicy {
+  StatusPriority priority;
+  uint16_t holdMs;       // Minimum display time against lower priorities
+};
+
+const StatusPolicy &statusPolicy(StatusId id);
+
+class StatusScheduler {
+public:
+  StatusScheduler();
+
+  /**
+   * @brief Propose a message
+   * @return true if shown() changed
+   */
+  bool offer(StatusId id, const char *text, uint32_t nowMs);
+
+  /**
+   * @brief Show a parked message whose turn has come
+   * @return true if shown() changed
+   */
+  bool service(uint32_t nowMs);
+
+  /**
+   * @brief Milliseconds until service() could change the line (UINT32_MAX = nothing parked)
+   */
+  uint32_t dueInMs(uint32_t nowMs) const;
+
+  const char *shown() const { return shownText; }
+  StatusId shownId() const { return current; }
+
+private:
+  struct Parked {
+    StatusId id;                          // STATUS_NONE = empty
+    char text[STATUS_LINE_TEXT_LEN];
+  };
+
+  bool mayReplace(StatusId id, uint32_t nowMs) const;
+  void show(StatusId id, const char *text, uint32_t nowMs);
+
+  StatusId current;
+  uint32_t shownAtMs;
+  uint32_t holdMs;
+  char shownText[STATUS_LINE_TEXT_LEN];   // Persistent buffer for lv_label_set_text_static()
+  Parked parked[STATUS_PRIORITY_COUNT];
+};
+
+#endif // STATUS_LINE_H
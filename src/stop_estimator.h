@@ -0,0 +1,184 @@
+#ifndef STOP_ESTIMATOR_H
+#define STOP_ESTIMATOR_H
+
+// =============================================================================
+// End-of-Shot Estimators (selectable per shot profile)
+// =============================================================================
+// ShotPredictor asks one of these when the cup reaches goal - offset. They
+// share one shape (reset / add / timeAt), each O(1) per sample and without
+// allocation:
+//
+//   linear     Least-squares line over the last SHOT_TREND_SAMPLES filtered
+//              weights (SlidingRegression). Assumes constant flow over the
+//              window - the original predictor.
+//   quadratic  Recency-weighted quadratic: weights decay with
+//              QUAD_TAU_S, so the fit follows a flow that speeds up as the
+//              puck erodes (or slows as a profile ramps down). The sums are
+//              kept around the newest sample and shifted by dt (binomial
+//              update) each sample, so they stay small in float however
+//              long the shot runs.
+//   model      The WeightFilter state carried forward: weight + flow * dt,
+//              the constant-flow model the Kalman filter itself assumes.
+//              No window at all - it reacts the fastest but is most exposed
+//              to the filter's flow noise.
+//
+// All three are fed from the flow onset on (flow_onset.h). timeAt() returns
+// the shot time (s) the estimate reaches `grams`, or -1 while it cannot tell.
+// tools/shot_replay scores them on recorded traces (--estimator).
+//
+// Not thread safe - keep each instance on one task (the shot control task).
+// =============================================================================
+
+#include <Arduino.h>
+#include <math.h>
+#include "weight_filter.h"
+#include "sliding_regression.h"
+
+constexpr int   SHOT_TREND_SAMPLES = 10;    // Samples used for the linear trend line
+constexpr float QUAD_TAU_S         = 4.0f;  // Quadratic: weight of a sample falls by e per this
+constexpr float QUAD_MIN_SPAN_S    = 1.5f;  // ... and needs this much history before it answers
+constexpr float ESTIMATOR_MIN_FLOW = 0.001f; // g/s - slower never gets there
+
+enum StopEstimatorKind : uint8_t {
+  STOP_ESTIMATOR_LINEAR,
+  STOP_ESTIMATOR_QUADRATIC,
+  STOP_ESTIMATOR_MODEL,
+  STOP_ESTIMATOR_COUNT
+};
+
+inline const char *stopEstimatorName(uint8_t kind)
+{
+  static const char *const NAMES[] = {"linear", "quadratic", "model"};
+  return kind < STOP_ESTIMATOR_COUNT ? NAMES[kind] : "?";
+}
+
+/** @brief Kind by name, STOP_ESTIMATOR_COUNT if unknown */
+inline uint8_t stopEstimatorParse(const char *name)
+{
+  for (uint8_t kind = 0; kind < STOP_ESTIMATOR_COUNT; kind++) {
+    if (strcmp(name, stopEstimatorName(kind)) == 0)
+      return kind;
+  }
+  return STOP_ESTIMATOR_COUNT;
+}
+
+class LinearEstimator {
+public:
+  void reset() { trend.reset(); }
+  void add(float t, const WeightFilter &filter) { trend.add(t, filter.weight()); }
+
+  float timeAt(float grams) const
+  {
+    // Negative or near-zero slope would give infinite/absurd predictions
+    if (!trend.full() || trend.slope() < ESTIMATOR_MIN_FLOW)
+      return -1.0f;
+    return trend.xAt(grams);
+  }
+
+  SlidingRegression<SHOT_TREND_SAMPLES> trend;  // Filtered weight vs time over the last samples
+};
+
+class QuadraticEstimator {
+public:
+  QuadraticEstimator() { reset(); }
+
+  void reset()
+  {
+    lastT = firstT = -1.0f;
+    for (int k = 0; k < 5; k++)
+      m[k] = 0.0f;
+    for (int k = 0; k < 3; k++)
+      n[k] = 0.0f;
+  }
+
+  void add(float t, const WeightFilter &filter)
+  {
+    float y = filter.weight();
+    if (lastT < 0.0f) {
+      firstT = t;
+    } else {
+      // Move the origin to t (u -> u - d), then age every sample by d
+      float d = t - lastT;
+      float d2 = d * d, d3 = d2 * d, d4 = d3 * d;
+      float m0 = m[0], m1 = m[1], m2 = m[2], m3 = m[3], m4 = m[4];
+      m[1] = m1 - d * m0;
+      m[2] = m2 - 2 * d * m1 + d2 * m0;
+      m[3] = m3 - 3 * d * m2 + 3 * d2 * m1 - d3 * m0;
+      m[4] = m4 - 4 * d * m3 + 6 * d2 * m2 - 4 * d3 * m1 + d4 * m0;
+      float n0 = n[0], n1 = n[1], n2 = n[2];
+      n[1] = n1 - d * n0;
+      n[2] = n2 - 2 * d * n1 + d2 * n0;
+
+      float decay = expf(-d / QUAD_TAU_S);
+      for (int k = 0; k < 5; k++)
+        m[k] *= decay;
+      for (int k = 0; k < 3; k++)
+        n[k] *= decay;
+    }
+    m[0] += 1.0f;  // The new sample sits at u = 0
+    n[0] += y;
+    lastT = t;
+  }
+
+  float timeAt(float grams) const
+  {
+    if (lastT < 0.0f || lastT - firstT < QUAD_MIN_SPAN_S)
+      return -1.0f;
+
+    // Normal equations for y = a + b u + c u^2 (u = t - lastT), Cramer's rule
+    float det = m[0] * (m[2] * m[4] - m[3] * m[3]) - m[1] * (m[1] * m[4] - m[3] * m[2]) +
+                m[2] * (m[1] * m[3] - m[2] * m[2]);
+    if (fabsf(det) < 1e-9f)
+      return -1.0f;
+    float a = (n[0] * (m[2] * m[4] - m[3] * m[3]) - m[1] * (n[1] * m[4] - m[3] * n[2]) +
+               m[2] * (n[1] * m[3] - m[2] * n[2])) / det;
+    float b = (m[0] * (n[1] * m[4] - n[2] * m[3]) - n[0] * (m[1] * m[4] - m[3] * m[2]) +
+               m[2] * (m[1] * n[2] - n[1] * m[2])) / det;
+    float c = (m[0] * (m[2] * n[2] - m[3] * n[1]) - m[1] * (m[1] * n[2] - m[2] * n[1]) +
+               n[0] * (m[1] * m[3] - m[2] * m[2])) / det;
+    if (b < ESTIMATOR_MIN_FLOW)
+      return -1.0f;
+
+    float left = grams - a;
+    if (left <= 0.0f)
+      return lastT;
+    // Stable root of c x^2 + b x - left = 0; a curve that tops out first falls back to the tangent
+    float disc = b * b + 4 * c * left;
+    float x = (disc > 0.0f) ? 2 * left / (b + sqrtf(disc)) : left / b;
+    return lastT + x;
+  }
+
+private:
+  float lastT;    // Origin of the sums, -1 = empty
+  float firstT;
+  float m[5];     // sum w u^k
+  float n[3];     // sum w u^k y
+};
+
+class ModelEstimator {
+public:
+  void reset() { ready = false; }
+
+  void add(float t, const WeightFilter &filter)
+  {
+    lastT = t;
+    weight = filter.weight();
+    flow = filter.flow();
+    ready = true;
+  }
+
+  float timeAt(float grams) const
+  {
+    if (!ready || flow < ESTIMATOR_MIN_FLOW)
+      return -1.0f;
+    return lastT + (grams - weight) / flow;
+  }
+
+private:
+  bool ready = false;
+  float lastT = 0.0f;
+  float weight = 0.0f;
+  float flow = 0.0f;
+};
+
+#endif // STOP_ESTIMATOR_H
@@ -0,0 +1,127 @@
+// =============================================================================
+// Stop-Latency Model Implementation
+// =============================================================================
+
+#include "stop_model.h"
+#include "debug_config.h"
+#include <Preferences.h>
+
+static constexpr LogTag TAG = LOG_TAG_SHOT;
+
+static const char* STOP_MODEL_NAMESPACE = "stopmodel";
+static const char* STOP_MODEL_KEY       = "model";
+static const uint8_t STOP_MODEL_VERSION = 1;   // Bump when StopModelStats changes
+static const float STOP_MODEL_ALPHA     = 0.3f;  // EWMA weight of the newest shot
+
+struct StopModelRecord {
+  uint8_t version;
+  StopModelStats stats;
+};
+
+// Nothing learned yet: no compensation, the stored weightOffset still covers the drip
+static StopModelStats model = { 0.0f, 0.0f, 0.0f, 0.0f, 0 };
+
+// Shot being measured
+static bool pending = false;
+static float decisionAge = 0.0f;
+static float decisionFlow = 0.0f;
+static float decisionWeight = 0.0f;
+static float flowStopDelay = -1.0f;   // < 0 until the flow was seen stopping
+
+static float ewma(float average, float sample)
+{
+  return (model.shots == 0) ? sample : average + STOP_MODEL_ALPHA * (sample - average);
+}
+
+void stopModelBegin()
+{
+  Preferences prefs;
+  if (!prefs.begin(STOP_MODEL_NAMESPACE, true))
+    return;  // Nothing stored yet on a fresh device
+
+  StopModelRecord record;
+  if (prefs.getBytes(STOP_MODEL_KEY, &record, sizeof(record)) == sizeof(record) &&
+      record.version == STOP_MODEL_VERSION)
+  {
+    model = record.stats;
+  }
+  prefs.end();
+
+  LOG_INFO(TAG, "⏱️  Stop model: tail %.2fs, drip %.1fg, flow stops %.2fs after relay, packet age %.2fs (%u shots)",
+           model.tailS, model.dripG, model.flowStopDelayS, model.packetAgeS, model.shots);
+}
+
+float stopModelLatencyS()
+{
+  return STOP_RELAY_DELAY_S + model.tailS;
+}
+
+void stopModelNoteDecision(float packetAgeS, float flow, float weight)
+{
+  pending = true;
+  decisionAge = packetAgeS;
+  decisionFlow = flow;
+  decisionWeight = weight;
+  flowStopDelay = -1.0f;
+}
+
+void stopModelNoteSample(float sinceStopS, float flow)
+{
+  if (pending && flowStopDelay < 0.0f && flow < STOP_FLOW_STOPPED)
+    flowStopDelay = sinceStopS;
+}
+
+void stopModelCancel()
+{
+  pending = false;
+}
+
+bool stopModelPending()
+{
+  return pending;
+}
+
+float stopModelFinish(float finalWeight)
+{
+  if (!pending)
+    return 0.0f;
+  pending = false;
+
+  float drip = finalWeight - decisionWeight;
+  if (decisionFlow < STOP_MIN_FLOW || drip < 0.0f)
+  {
+    LOG_INFO(TAG, "⏱️  Stop model: shot skipped (flow %.2fg/s, drip %.1fg)", decisionFlow, drip);
+    return 0.0f;
+  }
+
+  float tail = drip / decisionFlow;
+  if (tail > STOP_MAX_TAIL_S)
+    tail = STOP_MAX_TAIL_S;
+
+  float previousTail = model.tailS;
+  model.packetAgeS = ewma(model.packetAgeS, decisionAge);
+  if (flowStopDelay >= 0.0f)
+    model.flowStopDelayS = ewma(model.flowStopDelayS, flowStopDelay);
+  model.dripG = ewma(model.dripG, drip);
+  model.tailS = ewma(model.tailS, tail);
+  if (model.shots < UINT16_MAX)
+    model.shots++;
+
+  LOG_INFO(TAG, "⏱️  Stop latency: age %.2fs, flow stopped %.2fs after relay, drip %.1fg → tail %.2fs (avg %.2fs)",
+           decisionAge, flowStopDelay, drip, tail, model.tailS);
+
+  Preferences prefs;
+  if (prefs.begin(STOP_MODEL_NAMESPACE, false))
+  {
+    StopModelRecord record = { STOP_MODEL_VERSION, model };
+    prefs.putBytes(STOP_MODEL_KEY, &record, sizeof(record));
+    prefs.end();
+  }
+
+  return (model.tailS - previousTail) * decisionFlow;
+}
+
+StopModelStats stopModelStats()
+{
+  return model;
+}
@@ -0,0 +1,91 @@
+#ifndef STOP_MODEL_H
+#define STOP_MODEL_H
+
+// =============================================================================
+// Stop-Latency Model for Gravimetric Shots
+// =============================================================================
+// Everything that still lands in the cup after the stop decision, learned
+// per machine from real shots instead of folded into weightOffset:
+//
+//   decision ──► relay off ──► flow stops ──► drips end (DRIP_DELAY_S)
+//      │  packet age  │ relay     │ flow-stop delay │
+//      ▼              ▼           ▼                 ▼
+//   last weight   projected    filtered flow    final weight
+//   sample        weight       < FLOW_STOPPED   (drip mass)
+//
+// Per shot it records the packet age at the decision, relay-off → flow
+// stopped, and the drip mass after relay-off. The drip is stored as "tail
+// seconds" (drip mass / flow at the stop) because it scales with flow. The
+// predictor then stops once the trend reaches the target minus
+// flow * stopModelLatencyS(): stop at "now + pipeline latency".
+//
+// Averages are EWMAs persisted in NVS (namespace "stopmodel"), so the model
+// belongs to this machine and survives reboots. weightOffset only has to
+// carry the residual the model does not explain; stopModelFinish() hands
+// over whatever the model newly explains so the total stays continuous.
+//
+// Thread Safety:
+//   Shot control task (Core 0) only, except stopModelBegin() (setup, before the task).
+// =============================================================================
+
+#include <Arduino.h>
+
+constexpr float STOP_RELAY_DELAY_S  = 0.02f;  // Relay release + pump spin-down start
+constexpr float STOP_FLOW_STOPPED   = 0.3f;   // g/s - filtered flow below this = stopped
+constexpr float STOP_MIN_FLOW       = 0.5f;   // g/s - slower stops are not learned from
+constexpr float STOP_MAX_TAIL_S     = 5.0f;
+
+struct StopModelStats {
+  float packetAgeS;       // Age of the newest sample when the stop was decided
+  float flowStopDelayS;   // Relay off → filtered flow below STOP_FLOW_STOPPED
+  float dripG;            // Weight gained after relay off
+  float tailS;            // dripG / flow at the stop
+  uint16_t shots;         // Shots learned from (0 = defaults)
+};
+
+/**
+ * @brief Load the learned model from NVS
+ */
+void stopModelBegin();
+
+/**
+ * @brief Seconds of flow still reaching the cup after a stop decision
+ */
+float stopModelLatencyS();
+
+/**
+ * @brief Stop decided - start measuring this shot's latency
+ * @param packetAgeS Now minus the arrival time of the newest weight sample
+ * @param flow       Filtered flow at the decision (g/s)
+ * @param weight     Filtered weight projected to the decision time (g)
+ */
+void stopModelNoteDecision(float packetAgeS, float flow, float weight);
+
+/**
+ * @brief Feed a post-stop sample while the drips settle
+ * @param sinceStopS Sample arrival time minus the decision time
+ * @param flow       Filtered flow (g/s)
+ */
+void stopModelNoteSample(float sinceStopS, float flow);
+
+/**
+ * @brief Drop the shot being measured (a new shot started before the drips settled)
+ */
+void stopModelCancel();
+
+/**
+ * @brief True between stopModelNoteDecision() and stopModelFinish()
+ */
+bool stopModelPending();
+
+/**
+ * @brief Drips are done - learn from this shot and persist
+ * @param finalWeight Weight after DRIP_DELAY_S (g)
+ * @return Grams the model now compensates beyond what it did before (at this
+ *         shot's flow) - take them off weightOffset so nothing is counted twice
+ */
+float stopModelFinish(float finalWeight);
+
+StopModelStats stopModelStats();
+
+#endif // STOP_MODEL_H
@@ -0,0 +1,185 @@
+// =============================================================================
+// Task Topology Implementation
+// =============================================================================
+
+#include "task_layout.h"
+#include "debug_config.h"
+#include "mem_caps.h"
+
+static constexpr LogTag TAG = LOG_TAG_TASK;
+
+// The layout. Core 0 runs the BLE controller and Wi-Fi, so the BLE host and
+// the bookkeeping tasks live there; Core 1 is kept for LVGL and its feeders.
+static constexpr TaskSpec LAYOUT[TASK_ROLE_COUNT] = {
+  // name          core            prio  stack  placement
+  {"BLE_Task",     0,              2,    20480, TASK_STACK_STATIC},    // Blocking ArduinoBLE calls, NVS
+  {"Control",      0,              3,    6144,  TASK_STACK_STATIC},    // Above BLE - never waits behind a blocking call; offset / stop model NVS
+  {"UI_Task",      1,              2,    16384, TASK_STACK_STATIC},    // LVGL + SquareLine handlers, settings NVS
+  {"lcd_bounce",   1,              5,    3072,  TASK_STACK_STATIC},    // With the SPI ISR, pre-empts rendering
+  {"Touch",        1,              3,    3072,  TASK_STACK_STATIC},    // Above UI - a read is short, latency matters
+  {"Watchdog",     tskNO_AFFINITY, 4,    4096,  TASK_STACK_STATIC},    // Above BLE / UI / touch - can't be starved; OTA validation (otadata, NVS)
+  {"LogDrain",     1,              1,    4096,  TASK_STACK_STATIC},    // Serial I/O off the BLE core, when rendering idles
+  {"ShotLog",      0,              1,    4096,  TASK_STACK_STATIC},    // LittleFS - must stay internal
+  {"Health",       0,              1,    4096,  TASK_STACK_PSRAM},     // Holds a TaskStatsSnapshot copy
+  {"TaskStats",    0,              1,    3072,  TASK_STACK_PSRAM},
+  {"DisplayDiag",  0,              1,    3072,  TASK_STACK_PSRAM},
+  {"ShotPub",      0,              1,    4096,  TASK_STACK_INTERNAL},  // LittleFS reads, NVS cursor, lwIP sockets
+  {"OtaWriter",    0,              1,    4096,  TASK_STACK_INTERNAL},  // Flash erase / write (cache off), tinfl; below BLE - the radio keeps the pace
+  {"DrawHelper",   0,              1,    2048,  TASK_STACK_INTERNAL},  // Pixel kernels only; below BLE / control - the UI task steals what it has not started, lends its priority to a join
+  {"LoadCell",     0,              4,    3072,  TASK_STACK_INTERNAL},  // Above control - a read is ~50 us and dates the sample; GS_LOAD_CELL builds only
+};
+
+struct Spawned {
+  TaskHandle_t handle;
+  TaskStackPlacement stack;   // Where the stack actually went
+};
+
+static Spawned spawned[TASK_ROLE_COUNT];
+
+static const char *const PLACEMENT_NAMES[] = {"internal", "psram", "static"};
+
+// TASK_STACK_STATIC roles, counted and summed over the table at compile time
+static constexpr uint32_t staticStackBytes(uint8_t i)
+{
+  return i >= TASK_ROLE_COUNT ? 0 : (LAYOUT[i].stack == TASK_STACK_STATIC ? LAYOUT[i].stackBytes : 0) + staticStackBytes(i + 1);
+}
+
+static constexpr uint8_t staticRoles(uint8_t i)
+{
+  return i >= TASK_ROLE_COUNT ? 0 : (LAYOUT[i].stack == TASK_STACK_STATIC ? 1 : 0) + staticRoles(i + 1);
+}
+
+static constexpr bool staticStacksAligned(uint8_t i)
+{
+  return i >= TASK_ROLE_COUNT || ((LAYOUT[i].stack != TASK_STACK_STATIC || LAYOUT[i].stackBytes % 16 == 0) && staticStacksAligned(i + 1));
+}
+
+static_assert(staticStacksAligned(0), "Static stacks are carved from one block - keep their sizes 16-byte multiples");
+
+static StackType_t staticStacks[staticStackBytes(0) / sizeof(StackType_t)] __attribute__((aligned(16)));
+static StaticTask_t staticTcbs[staticRoles(0)];
+
+static TaskHandle_t spawnStatic(TaskRole role, TaskFunction_t fn, void *arg)
+{
+  if (spawned[role].handle != NULL)
+    return NULL;  // The role's stack is in use
+  uint32_t offset = 0;
+  uint8_t slot = 0;
+  for (uint8_t i = 0; i < role; i++) {
+    if (LAYOUT[i].stack == TASK_STACK_STATIC) {
+      offset += LAYOUT[i].stackBytes;
+      slot++;
+    }
+  }
+  const TaskSpec &spec = LAYOUT[role];
+  return xTaskCreateStaticPinnedToCore(fn, spec.name, spec.stackBytes, arg, spec.priority,
+                                       staticStacks + offset / sizeof(StackType_t), &staticTcbs[slot], spec.core);
+}
+
+#if GS_TASK_PSRAM_STACKS && CONFIG_SPIRAM_ALLOW_STACK_EXTERNAL_MEMORY
+static TaskHandle_t spawnPsram(const TaskSpec &spec, TaskFunction_t fn, void *arg)
+{
+  StackType_t *stack = (StackType_t *)memCapsAlloc(spec.stackBytes, MEM_PSRAM, MEM_OWNER_TASK_STACKS);
+  StaticTask_t *tcb = (StaticTask_t *)heap_caps_malloc(sizeof(StaticTask_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+  TaskHandle_t handle = NULL;
+  if (stack != NULL && tcb != NULL)
+    handle = xTaskCreateStaticPinnedToCore(fn, spec.name, spec.stackBytes, arg, spec.priority, stack, tcb, spec.core);
+  if (handle == NULL) {
+    memCapsFree(stack, spec.stackBytes, MEM_OWNER_TASK_STACKS);
+    heap_caps_free(tcb);
+  }
+  return handle;  // Tasks never exit - stack and TCB stay allocated for good
+}
+#endif
+
+BaseType_t taskLayoutSpawn(TaskRole role, TaskFunction_t fn, void *arg, TaskHandle_t *handle)
+{
+  const TaskSpec &spec = LAYOUT[role];
+  TaskHandle_t created = NULL;
+  TaskStackPlacement placed = TASK_STACK_INTERNAL;
+
+  if (spec.stack == TASK_STACK_STATIC) {
+    created = spawnStatic(role, fn, arg);
+    if (created == NULL) {
+      LOG_ERROR(TAG, "%s: static stack already in use - not spawned twice", spec.name);
+      if (handle != NULL)
+        *handle = NULL;
+      return pdFAIL;
+    }
+    placed = TASK_STACK_STATIC;
+  }
+#if GS_TASK_PSRAM_STACKS && CONFIG_SPIRAM_ALLOW_STACK_EXTERNAL_MEMORY
+  if (spec.stack == TASK_STACK_PSRAM) {
+    created = spawnPsram(spec, fn, arg);
+    if (created != NULL)
+      placed = TASK_STACK_PSRAM;
+    else
+      LOG_WARN(TAG, "%s: PSRAM stack unavailable - using internal RAM", spec.name);
+  }
+#endif
+  if (created == NULL &&
+      xTaskCreatePinnedToCore(fn, spec.name, spec.stackBytes, arg, spec.priority, &created, spec.core) != pdPASS)
+    created = NULL;
+
+  if (handle != NULL)
+    *handle = created;
+  if (created == NULL)
+    return pdFAIL;
+  spawned[role].stack = placed;
+  spawned[role].handle = created;
+  return pdPASS;
+}
+
+const TaskSpec &taskLayoutSpec(TaskRole role)
+{
+  return LAYOUT[role];
+}
+
+TaskRole taskLayoutRoleOf(TaskHandle_t task)
+{
+  for (uint8_t i = 0; i < TASK_ROLE_COUNT; i++) {
+    if (spawned[i].handle == task && task != NULL)
+      return (TaskRole)i;
+  }
+  return TASK_ROLE_COUNT;
+}
+
+static void formatCore(char *buf, size_t size, BaseType_t core)
+{
+  if (core == tskNO_AFFINITY)
+    snprintf(buf, size, "any");
+  else
+    snprintf(buf, size, "%d", (int)core);
+}
+
+void taskLayoutDump(Print &out)
+{
+  out.print("Task layout   core  prio  stack  used   use%  suggest  placement\n");
+  for (uint8_t i = 0; i < TASK_ROLE_COUNT; i++) {
+    const TaskSpec &spec = LAYOUT[i];
+    const Spawned &s = spawned[i];
+    char core[8];
+    formatCore(core, sizeof(core), spec.core);
+    if (s.handle == NULL) {
+      out.printf("  %-11s %4s %5u %6lu      -      -        -  not running\n", spec.name, core,
+                 (unsigned)spec.priority, (unsigned long)spec.stackBytes);
+      continue;
+    }
+
+    // High-water mark is in bytes on ESP-IDF (StackType_t = uint8_t)
+    uint32_t used = spec.stackBytes - uxTaskGetStackHighWaterMark(s.handle);
+    uint32_t suggest = used + used * TASK_LAYOUT_STACK_MARGIN_PCT / 100;
+    suggest = (suggest + TASK_LAYOUT_STACK_ROUND - 1) / TASK_LAYOUT_STACK_ROUND * TASK_LAYOUT_STACK_ROUND;
+
+    // Actual affinity / priority: a mismatch means someone moved the task after spawning it
+    char actualCore[8];
+    formatCore(actualCore, sizeof(actualCore), xTaskGetAffinity(s.handle));
+    UBaseType_t priority = uxTaskPriorityGet(s.handle);
+    const char *moved = (strcmp(core, actualCore) != 0 || priority != spec.priority) ? " (moved)" : "";
+    const char *fallback = (s.stack != spec.stack) ? " (fallback)" : "";
+
+    out.printf("  %-11s %4s %5u %6lu %5lu %5lu%% %8lu  %s%s%s\n", spec.name, actualCore, (unsigned)priority,
+               (unsigned long)spec.stackBytes, (unsigned long)used, (unsigned long)(used * 100 / spec.stackBytes),
+               (unsigned long)suggest, PLACEMENT_NAMES[s.stack], fallback, moved);
+  }
+}
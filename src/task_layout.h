@@ -0,0 +1,108 @@
+#ifndef TASK_LAYOUT_H
+#define TASK_LAYOUT_H
+
+// =============================================================================
+// Task Topology (core, priority, stack size and placement per task)
+// =============================================================================
+// Every long-lived task of the firmware is spawned from one table in
+// task_layout.cpp instead of constants spread over its module:
+//
+//   role             name         core  prio  stack   placement
+//   BLE host         BLE_Task        0     2  20480   static
+//   shot control     Control         0     3   6144   static
+//   render           UI_Task         1     2  16384   static
+//   ...
+//
+//   taskLayoutSpawn(TASK_ROLE_TOUCH, touchInputTask, NULL, &touchTask);
+//
+// Placement: TASK_STACK_STATIC is a DRAM stack and TCB the linker reserves
+// (.bss, sized from the table at compile time) and xTaskCreateStatic-
+// PinnedToCore() - for the tasks that run from boot to reset, which then
+// cannot fail to spawn and take nothing from the heap. Each such role spawns
+// once. TASK_STACK_INTERNAL is a normal xTaskCreatePinnedToCore() stack in
+// DRAM, for tasks that only some builds or configurations start.
+// TASK_STACK_PSRAM allocates the stack in PSRAM and creates
+// the task statically (TCB stays internal); only for tasks that never touch
+// flash (NVS, LittleFS, OTA) and are not latency critical - a PSRAM stack
+// is slower and unusable while the flash cache is off. It needs
+// CONFIG_SPIRAM_ALLOW_STACK_EXTERNAL_MEMORY; without it, with
+// GS_TASK_PSRAM_STACKS=0 or if the allocation fails, the stack goes to
+// internal RAM (reported as such).
+//
+// "tasks" on the serial console prints the layout after the CPU table:
+// configured vs actual core / priority, stack used (high-water mark) and a
+// right-sized stack suggestion, so sizes and placements are measured rather
+// than guessed.
+//
+// GS_TASK_PSRAM_STACKS (compile-time, -DGS_TASK_PSRAM_STACKS=0): force every
+// stack internal, for A/B runs against the table's placements. Default 1.
+//
+// Thread Safety:
+//   taskLayoutSpawn() from setup() / module begin functions (one at a time).
+//   taskLayoutSpec() and taskLayoutDump() from any task.
+// =============================================================================
+
+#include <Arduino.h>
+
+#ifndef GS_TASK_PSRAM_STACKS
+#define GS_TASK_PSRAM_STACKS 1
+#endif
+
+constexpr uint32_t TASK_LAYOUT_STACK_MARGIN_PCT = 25;    // Suggested stack = peak use + margin
+constexpr uint32_t TASK_LAYOUT_STACK_ROUND      = 512;
+
+enum TaskRole : uint8_t {
+  TASK_ROLE_BLE_HOST = 0,   // HCI, scale link, scale command sequencing
+  TASK_ROLE_CONTROL,        // Shot control: samples, stop decision, relay
+  TASK_ROLE_RENDER,         // LVGL owner
+  TASK_ROLE_LCD_BOUNCE,     // DMA bounce buffer refills
+  TASK_ROLE_TOUCH,          // Touch reads + I2C bus jobs
+  TASK_ROLE_WATCHDOG,
+  TASK_ROLE_LOG_DRAIN,
+  TASK_ROLE_PERSIST,        // Shot log writer (LittleFS)
+  TASK_ROLE_HEALTH,
+  TASK_ROLE_TASK_STATS,
+  TASK_ROLE_DISPLAY_DIAG,
+  TASK_ROLE_PUBLISH,        // MQTT shot summaries (WIRELESS_DEBUG)
+  TASK_ROLE_OTA_WRITER,     // BLE maintenance: update buffers → OTA pipeline → flash
+  TASK_ROLE_DRAW_HELPER,    // Blend slices on Core 0 idle time (draw_s3.h)
+  TASK_ROLE_LOAD_CELL,      // Wired load cell reads (load_cell.h, GS_LOAD_CELL)
+  TASK_ROLE_COUNT
+};
+
+enum TaskStackPlacement : uint8_t {
+  TASK_STACK_INTERNAL = 0,
+  TASK_STACK_PSRAM,
+  TASK_STACK_STATIC
+};
+
+struct TaskSpec {
+  const char *name;
+  BaseType_t core;          // tskNO_AFFINITY = either core
+  UBaseType_t priority;
+  uint32_t stackBytes;
+  TaskStackPlacement stack;
+};
+
+/**
+ * @brief Create the task for `role` as the table says
+ * @return pdPASS, like xTaskCreatePinnedToCore()
+ */
+BaseType_t taskLayoutSpawn(TaskRole role, TaskFunction_t fn, void *arg, TaskHandle_t *handle);
+
+/**
+ * @brief Configured core / priority / stack of a role
+ */
+const TaskSpec &taskLayoutSpec(TaskRole role);
+
+/**
+ * @brief Role `task` was spawned for, TASK_ROLE_COUNT if none (library / IDF tasks)
+ */
+TaskRole taskLayoutRoleOf(TaskHandle_t task);
+
+/**
+ * @brief Configured vs actual layout, stack use and suggested sizes
+ */
+void taskLayoutDump(Print &out);
+
+#endif // TASK_LAYOUT_H
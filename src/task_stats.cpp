@@ -0,0 +1,273 @@
+// =============================================================================
+// CPU Load and Per-Task Runtime Statistics Implementation
+// =============================================================================
+
+#include "task_stats.h"
+#include "debug_config.h"
+#include "task_layout.h"
+#include "metrics.h"
+#include "seqlock.h"
+#include "esp_freertos_hooks.h"
+#if GS_CPU_OVERLAY
+#include "lvgl.h"
+#endif
+
+static constexpr LogTag TAG = LOG_TAG_TASK;
+
+static MetricGauge coreLoad0("cpu_load_core0_pct", "Core 0 (BLE) load over the last second");
+static MetricGauge coreLoad1("cpu_load_core1_pct", "Core 1 (UI) load over the last second");
+
+// Written by each core's idle task only
+static volatile TickType_t lastIdleTick[2];
+static volatile uint32_t idleTicks[2];
+
+static SeqLock<TaskStatsSnapshot> published(TaskStatsSnapshot{});
+
+// Per-task series for /metrics, one snapshot read per line (the sampler may move on in between)
+static bool readTask(uint16_t index, char *labels, size_t labelsSize, TaskStatsEntry *entry)
+{
+  TaskStatsSnapshot snap = published.load();
+  if (index >= snap.count)
+    return false;
+  *entry = snap.tasks[index];
+  snprintf(labels, labelsSize, "task=\"%s\",core=\"%d\"", entry->name, (int)entry->core);
+  return true;
+}
+
+static bool readTaskCpu(uint16_t index, char *labels, size_t labelsSize, int32_t *value)
+{
+  TaskStatsEntry entry;
+  if (!readTask(index, labels, labelsSize, &entry))
+    return false;
+  *value = (entry.cpuPermille == TASK_STATS_CPU_UNKNOWN) ? -1 : entry.cpuPermille;
+  return true;
+}
+
+static bool readTaskStack(uint16_t index, char *labels, size_t labelsSize, int32_t *value)
+{
+  TaskStatsEntry entry;
+  if (!readTask(index, labels, labelsSize, &entry))
+    return false;
+  *value = (int32_t)entry.stackFree;
+  return true;
+}
+
+static MetricGaugeSet taskCpu("task_cpu_permille", "Share of one core per task over the last period (-1 = no run-time stats)", readTaskCpu);
+static MetricGaugeSet taskStack("task_stack_free_bytes", "Stack never used per task", readTaskStack);
+
+static inline void noteIdle(int core)
+{
+  TickType_t now = xTaskGetTickCount();
+  if (now != lastIdleTick[core]) {
+    lastIdleTick[core] = now;
+    idleTicks[core] = idleTicks[core] + 1;
+  }
+}
+
+static bool idleHookCore0()
+{
+  noteIdle(0);
+  return true;  // Let the idle task sleep (WAITI) as usual
+}
+
+static bool idleHookCore1()
+{
+  noteIdle(1);
+  return true;
+}
+
+#if configGENERATE_RUN_TIME_STATS
+struct RunTimeSample {
+  TaskHandle_t handle;
+  uint32_t runTime;
+};
+#endif
+
+static void taskStatsTask(void *parameter)
+{
+  // uxTaskGetSystemState() returns nothing if the array is too small, so it grows with the task count
+  TaskStatus_t *status = NULL;
+  UBaseType_t capacity = 0;
+
+  TickType_t lastTick = xTaskGetTickCount();
+  uint32_t lastIdle[2] = {idleTicks[0], idleTicks[1]};
+#if configGENERATE_RUN_TIME_STATS
+  RunTimeSample prev[TASK_STATS_MAX_TASKS] = {};
+  uint32_t prevCount = 0;
+  uint32_t prevTotal = 0;
+#endif
+
+  for (;;) {
+    vTaskDelay(pdMS_TO_TICKS(TASK_STATS_PERIOD_MS));
+
+    TaskStatsSnapshot snap = {};
+    TickType_t now = xTaskGetTickCount();
+    uint32_t elapsed = now - lastTick;
+    lastTick = now;
+    snap.periodMs = elapsed * portTICK_PERIOD_MS;
+
+    for (int core = 0; core < 2; core++) {
+      uint32_t idle = idleTicks[core];
+      uint32_t idleDelta = idle - lastIdle[core];
+      lastIdle[core] = idle;
+      uint32_t busy = (elapsed > idleDelta) ? elapsed - idleDelta : 0;
+      snap.coreLoadPct[core] = elapsed ? (uint8_t)(busy * 100 / elapsed) : 0;
+    }
+    coreLoad0.set(snap.coreLoadPct[0]);
+    coreLoad1.set(snap.coreLoadPct[1]);
+
+    UBaseType_t needed = uxTaskGetNumberOfTasks() + 2;
+    if (needed > capacity) {
+      free(status);
+      status = (TaskStatus_t *)malloc(needed * sizeof(TaskStatus_t));
+      capacity = (status != NULL) ? needed : 0;
+    }
+    uint32_t total = 0;
+    UBaseType_t count = (status != NULL) ? uxTaskGetSystemState(status, capacity, &total) : 0;
+    if (count > TASK_STATS_MAX_TASKS)
+      count = TASK_STATS_MAX_TASKS;
+#if configGENERATE_RUN_TIME_STATS
+    uint32_t totalDelta = total - prevTotal;
+    prevTotal = total;
+    RunTimeSample next[TASK_STATS_MAX_TASKS];
+#else
+    (void)total;
+#endif
+
+    for (UBaseType_t i = 0; i < count; i++) {
+      TaskStatsEntry &e = snap.tasks[i];
+      strncpy(e.name, status[i].pcTaskName, sizeof(e.name) - 1);
+      e.name[sizeof(e.name) - 1] = '\0';
+      e.stackFree = status[i].usStackHighWaterMark;
+      e.priority = (uint8_t)status[i].uxCurrentPriority;
+      e.state = (uint8_t)status[i].eCurrentState;
+#if configTASKLIST_INCLUDE_COREID
+      e.core = (status[i].xCoreID == 0 || status[i].xCoreID == 1) ? (int8_t)status[i].xCoreID : -1;
+#else
+      e.core = -1;
+#endif
+      e.cpuPermille = TASK_STATS_CPU_UNKNOWN;
+
+#if configGENERATE_RUN_TIME_STATS
+      next[i].handle = status[i].xHandle;
+      next[i].runTime = status[i].ulRunTimeCounter;
+      for (uint32_t j = 0; j < prevCount; j++) {
+        if (prev[j].handle == status[i].xHandle && totalDelta > 0) {
+          uint32_t permille = (uint32_t)((uint64_t)(status[i].ulRunTimeCounter - prev[j].runTime) * 1000 / totalDelta);
+          e.cpuPermille = (uint16_t)min(permille, (uint32_t)1000);
+          break;
+        }
+      }
+#endif
+    }
+    snap.count = (uint8_t)count;
+
+#if configGENERATE_RUN_TIME_STATS
+    memcpy(prev, next, count * sizeof(RunTimeSample));
+    prevCount = count;
+#endif
+
+    // Busiest first (unknown CPU sorts by list order)
+    for (uint32_t i = 1; i < snap.count; i++) {
+      TaskStatsEntry key = snap.tasks[i];
+      uint32_t j = i;
+      while (j > 0 && key.cpuPermille != TASK_STATS_CPU_UNKNOWN && snap.tasks[j - 1].cpuPermille < key.cpuPermille) {
+        snap.tasks[j] = snap.tasks[j - 1];
+        j--;
+      }
+      snap.tasks[j] = key;
+    }
+
+    published.update([&](TaskStatsSnapshot &s) { s = snap; });
+  }
+}
+
+void taskStatsBegin()
+{
+  if (esp_register_freertos_idle_hook_for_cpu(idleHookCore0, 0) != ESP_OK ||
+      esp_register_freertos_idle_hook_for_cpu(idleHookCore1, 1) != ESP_OK) {
+    LOG_WARN(TAG, "⚠️  Idle hooks not registered - core load will read 100%%");
+  }
+
+  BaseType_t result = taskLayoutSpawn(TASK_ROLE_TASK_STATS, taskStatsTask, NULL, NULL);
+  if (result != pdPASS) {
+    LOG_ERROR(TAG, "❌ Failed to create task stats sampler");
+    return;
+  }
+#if configGENERATE_RUN_TIME_STATS
+  const char *perTask = "enabled";
+#else
+  const char *perTask = "not in this sdkconfig";
+#endif
+  LOG_INFO(TAG, "📊 Task stats: core load every %lums, per-task CPU %s", (unsigned long)TASK_STATS_PERIOD_MS, perTask);
+}
+
+TaskStatsSnapshot taskStatsGet()
+{
+  return published.load();
+}
+
+static const char *stateName(uint8_t state)
+{
+  switch (state) {
+    case eRunning:   return "run";
+    case eReady:     return "ready";
+    case eBlocked:   return "block";
+    case eSuspended: return "susp";
+    case eDeleted:   return "del";
+    default:         return "?";
+  }
+}
+
+void taskStatsDump(Print &out)
+{
+  TaskStatsSnapshot snap = published.load();
+  char line[96];
+
+  snprintf(line, sizeof(line), "CPU load: core 0 %u%%, core 1 %u%% (last %lums, idle-hook ticks)\n",
+           snap.coreLoadPct[0], snap.coreLoadPct[1], (unsigned long)snap.periodMs);
+  out.print(line);
+  out.print("Task             Core Prio State   CPU%  Stack free\n");
+
+  for (uint32_t i = 0; i < snap.count; i++) {
+    const TaskStatsEntry &e = snap.tasks[i];
+    char core[4] = "-";
+    if (e.core >= 0)
+      snprintf(core, sizeof(core), "%d", e.core);
+    char cpu[8] = "-";
+    if (e.cpuPermille != TASK_STATS_CPU_UNKNOWN)
+      snprintf(cpu, sizeof(cpu), "%u.%u", e.cpuPermille / 10, e.cpuPermille % 10);
+    snprintf(line, sizeof(line), "%-16s %4s %4u %-6s %5s  %lu\n",
+             e.name, core, e.priority, stateName(e.state), cpu, (unsigned long)e.stackFree);
+    out.print(line);
+  }
+}
+
+#if GS_CPU_OVERLAY
+
+static lv_obj_t *overlayLabel = NULL;
+
+static void overlayTimerCb(lv_timer_t *timer)
+{
+  (void)timer;
+  TaskStatsSnapshot snap = published.load();
+  lv_label_set_text_fmt(overlayLabel, "C0 %u%%  C1 %u%%", snap.coreLoadPct[0], snap.coreLoadPct[1]);
+}
+
+void taskStatsOverlayBegin()
+{
+  overlayLabel = lv_label_create(lv_layer_sys());
+  lv_obj_set_style_bg_color(overlayLabel, lv_color_black(), 0);
+  lv_obj_set_style_bg_opa(overlayLabel, LV_OPA_50, 0);
+  lv_obj_set_style_text_color(overlayLabel, lv_color_white(), 0);
+  lv_obj_set_style_pad_all(overlayLabel, 2, 0);
+  lv_obj_align(overlayLabel, LV_ALIGN_BOTTOM_LEFT, 0, 0);
+  lv_label_set_text(overlayLabel, "C0 --  C1 --");
+  lv_timer_create(overlayTimerCb, TASK_STATS_PERIOD_MS, NULL);
+}
+
+#else
+
+void taskStatsOverlayBegin() {}
+
+#endif // GS_CPU_OVERLAY
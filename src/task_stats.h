@@ -0,0 +1,81 @@
+#ifndef TASK_STATS_H
+#define TASK_STATS_H
+
+// =============================================================================
+// CPU Load and Per-Task Runtime Statistics
+// =============================================================================
+// Answers "is Core 0 / Core 1 actually saturated, or just spinning?":
+//
+//   - Per-core load from FreeRTOS idle hooks: each core's idle task marks
+//     every tick in which it ran. load = 100% - idle ticks / elapsed ticks.
+//     Resolution is one tick (1 ms) - a core that idles for part of a tick
+//     counts that tick as idle, so short bursts read slightly low. Works on
+//     every sdkconfig.
+//   - Per-task CPU share from the uxTaskGetSystemState() run-time counters
+//     (only when sdkconfig enables configGENERATE_RUN_TIME_STATS, otherwise
+//     shown as "-"), plus state, priority, core and stack headroom.
+//
+// A low-priority sampler task refreshes both every TASK_STATS_PERIOD_MS.
+// Core loads are registered as gauges (cpu_load_core<n>_pct, with the peak
+// seen) in the metrics registry; the per-task table is printed by the
+// "tasks" serial / WebSerial command.
+//
+// GS_CPU_OVERLAY (compile-time, -DGS_CPU_OVERLAY=1): small "C0 xx% C1 xx%"
+// label on the LVGL system layer, same idea as LV_USE_PERF_MONITOR but for
+// the whole core rather than LVGL's own timer. Default 0.
+//
+// Thread Safety:
+//   The idle hooks each write their own core's counters. The sampler task is
+//   the only writer of the published snapshot (SeqLock), taskStatsGet() and
+//   taskStatsDump() read it from any task.
+// =============================================================================
+
+#include <Arduino.h>
+
+#ifndef GS_CPU_OVERLAY
+#define GS_CPU_OVERLAY 0
+#endif
+
+constexpr uint32_t TASK_STATS_PERIOD_MS       = 1000;
+constexpr uint32_t TASK_STATS_MAX_TASKS       = 32;    // Tasks beyond this are left out of the table
+
+constexpr uint16_t TASK_STATS_CPU_UNKNOWN = 0xFFFF;    // Run-time stats not compiled into FreeRTOS
+
+struct TaskStatsEntry {
+  char name[16];
+  uint32_t stackFree;      // Bytes never used (high-water mark)
+  uint16_t cpuPermille;    // Share of one core over the last period, or TASK_STATS_CPU_UNKNOWN
+  uint8_t priority;
+  uint8_t state;           // eTaskState
+  int8_t core;             // -1 = unpinned / unknown
+};
+
+struct TaskStatsSnapshot {
+  uint8_t coreLoadPct[2];
+  uint8_t count;
+  uint32_t periodMs;       // Length of the sampled period (0 until the second sample)
+  TaskStatsEntry tasks[TASK_STATS_MAX_TASKS];
+};
+
+/**
+ * @brief Register the idle hooks and start the sampler task
+ */
+void taskStatsBegin();
+
+/**
+ * @brief Most recent snapshot (lock-free)
+ */
+TaskStatsSnapshot taskStatsGet();
+
+/**
+ * @brief Print core loads and the per-task table
+ */
+void taskStatsDump(Print &out);
+
+/**
+ * @brief Create the on-screen CPU load label (no-op unless GS_CPU_OVERLAY)
+ * @note Call from the LVGL context after lv_init() and the display are set up
+ */
+void taskStatsOverlayBegin();
+
+#endif // TASK_STATS_H
@@ -0,0 +1,122 @@
+// =============================================================================
+// Touch Coordinate Transform and Per-Unit Calibration Implementation
+// =============================================================================
+
+#include "touch_calib.h"
+#include "debug_config.h"
+#include "seqlock.h"
+#include <Preferences.h>
+
+static constexpr LogTag TAG = LOG_TAG_UI;
+
+static const char* TOUCH_CALIB_NAMESPACE = "touchcal";
+static const char* TOUCH_CALIB_KEY       = "calib";
+static const uint8_t TOUCH_CALIB_VERSION = 1;   // Bump when TouchCalibRecord changes
+
+// Same mapping the pipeline used before it was a table (LV_DISP_ROT_270): x' = y, y' = 179 - x
+static_assert(TOUCH_DISPLAY_ROTATION != 3 ||
+              (TOUCH_PANEL_TO_SCREEN.xy == TOUCH_AFFINE_ONE && TOUCH_PANEL_TO_SCREEN.yx == -TOUCH_AFFINE_ONE &&
+               TOUCH_PANEL_TO_SCREEN.y0 == (EXAMPLE_LCD_H_RES - 1) * TOUCH_AFFINE_ONE),
+              "270° touch rotation");
+
+struct TouchCalibRecord {
+  uint8_t version;
+  float sx, dx, sy, dy;    // Panel-space correction
+  TouchJumpParams jump;
+};
+
+static TouchCalibRecord record = { TOUCH_CALIB_VERSION, 1.0f, 0.0f, 1.0f, 0.0f, TOUCH_JUMP_DEFAULT };
+static SeqLock<TouchCalib> shared(TouchCalib{ TOUCH_PANEL_TO_SCREEN, TOUCH_JUMP_DEFAULT });
+
+static TouchAffine correction(const TouchCalibRecord &r)
+{
+  return { (int32_t)lroundf(r.sx * TOUCH_AFFINE_ONE), 0, (int32_t)lroundf(r.dx * TOUCH_AFFINE_ONE),
+           0, (int32_t)lroundf(r.sy * TOUCH_AFFINE_ONE), (int32_t)lroundf(r.dy * TOUCH_AFFINE_ONE) };
+}
+
+static void publish()
+{
+  TouchCalib calib = { touchAffineCompose(TOUCH_PANEL_TO_SCREEN, correction(record)), record.jump };
+  shared.update([&](TouchCalib &c) { c = calib; });
+}
+
+static void store()
+{
+  Preferences prefs;
+  if (prefs.begin(TOUCH_CALIB_NAMESPACE, false))
+  {
+    prefs.putBytes(TOUCH_CALIB_KEY, &record, sizeof(record));
+    prefs.end();
+  }
+}
+
+static bool scaleValid(float s)
+{
+  return s >= 0.5f && s <= 2.0f;
+}
+
+void touchCalibBegin()
+{
+  Preferences prefs;
+  if (prefs.begin(TOUCH_CALIB_NAMESPACE, true))
+  {
+    TouchCalibRecord loaded;
+    if (prefs.getBytes(TOUCH_CALIB_KEY, &loaded, sizeof(loaded)) == sizeof(loaded) &&
+        loaded.version == TOUCH_CALIB_VERSION && scaleValid(loaded.sx) && scaleValid(loaded.sy))
+    {
+      record = loaded;
+      LOG_INFO(TAG, "Touch calibration: x %.3f%+.1f, y %.3f%+.1f", record.sx, record.dx, record.sy, record.dy);
+    }
+    prefs.end();
+  }
+  publish();
+}
+
+TouchCalib touchCalibGet()
+{
+  return shared.load();
+}
+
+bool touchCalibSetCorrection(float sx, float dx, float sy, float dy)
+{
+  if (!scaleValid(sx) || !scaleValid(sy))
+    return false;
+  record.sx = sx;
+  record.dx = dx;
+  record.sy = sy;
+  record.dy = dy;
+  publish();
+  store();
+  return true;
+}
+
+void touchCalibSetJump(const TouchJumpParams &jump)
+{
+  record.jump = jump;
+  publish();
+  store();
+}
+
+void touchCalibReset()
+{
+  record = { TOUCH_CALIB_VERSION, 1.0f, 0.0f, 1.0f, 0.0f, TOUCH_JUMP_DEFAULT };
+  publish();
+  Preferences prefs;
+  if (prefs.begin(TOUCH_CALIB_NAMESPACE, false))
+  {
+    prefs.remove(TOUCH_CALIB_KEY);
+    prefs.end();
+  }
+}
+
+void touchCalibDump(Print &out)
+{
+  TouchCalib c = touchCalibGet();
+  const TouchAffine &t = c.transform;
+  out.printf("[Touch calibration] rotation %d°, correction x %.3f%+.1f, y %.3f%+.1f\n",
+             TOUCH_DISPLAY_ROTATION * 90, record.sx, record.dx, record.sy, record.dy);
+  out.printf("  x' = (%ld x %+ld y %+ld) >> 16\n", (long)t.xx, (long)t.xy, (long)t.x0);
+  out.printf("  y' = (%ld x %+ld y %+ld) >> 16\n", (long)t.yx, (long)t.yy, (long)t.y0);
+  out.printf("  jump: edge x %d / %d px, edge y %d / %d px, max %d / %d px\n", c.jump.edgeX, c.jump.edgeJumpX,
+             c.jump.edgeY, c.jump.edgeJumpY, c.jump.maxJumpX, c.jump.maxJumpY);
+}
@@ -0,0 +1,133 @@
+#ifndef TOUCH_CALIB_H
+#define TOUCH_CALIB_H
+
+// =============================================================================
+// Touch Coordinate Transform and Per-Unit Calibration
+// =============================================================================
+// Panel coordinates (touchClassify(): x across the 180 px side, y along the
+// 640 px side) reach LVGL through one affine transform in Q16 fixed point:
+//
+//   x' = (xx * x + xy * y + x0) >> 16
+//   y' = (yx * x + yy * y + y0) >> 16      then clamped to the landscape screen
+//
+// The rotation part is a constexpr built from TOUCH_DISPLAY_ROTATION, so the
+// default transform is a compile-time constant (two multiply-adds, no
+// per-axis branches). A unit whose panel sits slightly off can add a
+// correction (per-axis scale and offset, panel coordinates) stored in NVS
+// (namespace "touchcal"); it is composed with the rotation once, when set or
+// loaded, so a calibrated unit costs the same per sample.
+//
+// The jump filter thresholds (touchJumpFilter()) live in the same record:
+// TOUCH_JUMP_DEFAULT unless the unit stores its own.
+//
+//   touchcal                         print the active calibration
+//   touchcal <sx> <dx> <sy> <dy>     panel x' = sx * x + dx, y' = sy * y + dy
+//   touchcal jump <e> <je> <f> <jf> <mx> <my>   jump filter thresholds
+//   touchcal reset                   back to the compile-time defaults
+//
+// Thread Safety:
+//   touchCalibBegin() from setup() before the touch task starts. Setters and
+//   touchCalibDump() from one task (serial console). touchCalibGet() - any
+//   task (SeqLock); the touch pipeline takes it at the start of a contact.
+// =============================================================================
+
+#include <Arduino.h>
+#include "pins_config.h"
+
+#ifndef TOUCH_DISPLAY_ROTATION
+#define TOUCH_DISPLAY_ROTATION 3  // Quarter turns, as LV_DISP_ROT_*: 3 = 270° (landscape UI on the portrait panel)
+#endif
+
+constexpr int32_t TOUCH_AFFINE_ONE = 1 << 16;
+
+struct TouchAffine {
+  int32_t xx, xy, x0;   // Q16
+  int32_t yx, yy, y0;
+};
+
+// Hold the last point against edge snaps and large jumps (panel coordinates)
+struct TouchJumpParams {
+  int16_t edgeX;        // x this close to the panel edge is suspect ...
+  int16_t edgeJumpX;    // ... when it moved more than this since the last point
+  int16_t edgeY;
+  int16_t edgeJumpY;
+  int16_t maxJumpX;     // Larger moves between two reads are held anywhere
+  int16_t maxJumpY;
+};
+
+constexpr TouchJumpParams TOUCH_JUMP_DEFAULT = {1, 6, 5, 20, 300, 60};
+
+struct TouchCalib {
+  TouchAffine transform;   // Panel → landscape, correction included
+  TouchJumpParams jump;
+};
+
+constexpr TouchAffine touchAffineIdentity()
+{
+  return {TOUCH_AFFINE_ONE, 0, 0, 0, TOUCH_AFFINE_ONE, 0};
+}
+
+/**
+ * @brief Panel (w x h) → screen after `quarterTurns` (LV_DISP_ROT_* numbering)
+ */
+constexpr TouchAffine touchAffineRotation(uint8_t quarterTurns, int32_t w, int32_t h)
+{
+  return quarterTurns == 1 ? TouchAffine{0, -TOUCH_AFFINE_ONE, (h - 1) * TOUCH_AFFINE_ONE, TOUCH_AFFINE_ONE, 0, 0}
+       : quarterTurns == 2 ? TouchAffine{-TOUCH_AFFINE_ONE, 0, (w - 1) * TOUCH_AFFINE_ONE,
+                                         0, -TOUCH_AFFINE_ONE, (h - 1) * TOUCH_AFFINE_ONE}
+       : quarterTurns == 3 ? TouchAffine{0, TOUCH_AFFINE_ONE, 0, -TOUCH_AFFINE_ONE, 0, (w - 1) * TOUCH_AFFINE_ONE}
+       : touchAffineIdentity();
+}
+
+/**
+ * @brief outer(inner(p)) as one transform
+ */
+constexpr TouchAffine touchAffineCompose(const TouchAffine &outer, const TouchAffine &inner)
+{
+  return {(int32_t)(((int64_t)outer.xx * inner.xx + (int64_t)outer.xy * inner.yx) >> 16),
+          (int32_t)(((int64_t)outer.xx * inner.xy + (int64_t)outer.xy * inner.yy) >> 16),
+          (int32_t)(((int64_t)outer.xx * inner.x0 + (int64_t)outer.xy * inner.y0) >> 16) + outer.x0,
+          (int32_t)(((int64_t)outer.yx * inner.xx + (int64_t)outer.yy * inner.yx) >> 16),
+          (int32_t)(((int64_t)outer.yx * inner.xy + (int64_t)outer.yy * inner.yy) >> 16),
+          (int32_t)(((int64_t)outer.yx * inner.x0 + (int64_t)outer.yy * inner.y0) >> 16) + outer.y0};
+}
+
+constexpr TouchAffine TOUCH_PANEL_TO_SCREEN =
+    touchAffineRotation(TOUCH_DISPLAY_ROTATION, EXAMPLE_LCD_H_RES, EXAMPLE_LCD_V_RES);
+
+// Screen size after the rotation
+constexpr int16_t TOUCH_SCREEN_W = (TOUCH_DISPLAY_ROTATION & 1) ? EXAMPLE_LCD_V_RES : EXAMPLE_LCD_H_RES;
+constexpr int16_t TOUCH_SCREEN_H = (TOUCH_DISPLAY_ROTATION & 1) ? EXAMPLE_LCD_H_RES : EXAMPLE_LCD_V_RES;
+
+/**
+ * @brief Load the stored correction / thresholds (defaults if none)
+ */
+void touchCalibBegin();
+
+/**
+ * @brief Active calibration (rotation composed with the correction)
+ */
+TouchCalib touchCalibGet();
+
+/**
+ * @brief Store a panel-space correction: x' = sx * x + dx, y' = sy * y + dy
+ * @return false if the scales are out of range (0.5 - 2)
+ */
+bool touchCalibSetCorrection(float sx, float dx, float sy, float dy);
+
+/**
+ * @brief Store jump filter thresholds
+ */
+void touchCalibSetJump(const TouchJumpParams &jump);
+
+/**
+ * @brief Forget the stored record - compile-time defaults from now on
+ */
+void touchCalibReset();
+
+/**
+ * @brief Correction, composed transform and thresholds ("touchcal")
+ */
+void touchCalibDump(Print &out);
+
+#endif // TOUCH_CALIB_H
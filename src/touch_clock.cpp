@@ -0,0 +1,127 @@
+// =============================================================================
+// Persisted Touch I2C Clock Implementation
+// =============================================================================
+
+#include "touch_clock.h"
+#include "touch_input.h"
+#include "debug_config.h"
+#include <Preferences.h>
+#include <Wire.h>
+
+static constexpr LogTag TAG = LOG_TAG_UI;
+
+static const char* TOUCH_CLOCK_NAMESPACE = "touchclk";
+static const char* TOUCH_CLOCK_KEY       = "clock";
+static const uint8_t TOUCH_CLOCK_VERSION = 1;   // Bump when TouchClockRecord changes
+static constexpr uint8_t CLOCK_COUNT     = sizeof(TOUCH_CLOCKS_HZ) / sizeof(TOUCH_CLOCKS_HZ[0]);
+
+struct TouchClockRecord {
+  uint8_t version;
+  uint8_t clockIndex;   // Into TOUCH_CLOCKS_HZ
+  uint8_t errors;       // A health window crossed TOUCH_CLOCK_ERROR_PCT at this clock
+  uint8_t cleanBoots;   // Boots since the last step down without errors
+};
+
+static TouchClockRecord record = { TOUCH_CLOCK_VERSION, 0, 0, 0 };
+static bool flagged = false;  // Errors already written this boot
+
+static void store()
+{
+  Preferences prefs;
+  if (prefs.begin(TOUCH_CLOCK_NAMESPACE, false))
+  {
+    prefs.putBytes(TOUCH_CLOCK_KEY, &record, sizeof(record));
+    prefs.end();
+  }
+}
+
+static bool ackAt(uint32_t hz, uint32_t settleMs)
+{
+  Wire.setClock(hz);
+  if (settleMs > 0)
+    delay(settleMs);
+  Wire.beginTransmission(TOUCH_I2C_ADDR);
+  return Wire.endTransmission() == 0;
+}
+
+// Fastest clock from `first` down that ACKs; the fastest overall if none does
+static uint8_t probe(uint8_t first)
+{
+  LOG_INFO(TAG, "Testing I2C bus speeds...");
+  for (uint8_t i = first; i < CLOCK_COUNT; i++)
+  {
+    bool ack = ackAt(TOUCH_CLOCKS_HZ[i], TOUCH_CLOCK_PROBE_MS);
+    LOG_INFO(TAG, "  %lu kHz: %s", (unsigned long)(TOUCH_CLOCKS_HZ[i] / 1000), ack ? "✅ ACK" : "❌ NACK");
+    if (ack)
+      return i;
+  }
+  return 0;
+}
+
+uint32_t touchClockBegin()
+{
+  Preferences prefs;
+  bool stored = false;
+  if (prefs.begin(TOUCH_CLOCK_NAMESPACE, true))
+  {
+    TouchClockRecord loaded;
+    stored = prefs.getBytes(TOUCH_CLOCK_KEY, &loaded, sizeof(loaded)) == sizeof(loaded) &&
+             loaded.version == TOUCH_CLOCK_VERSION && loaded.clockIndex < CLOCK_COUNT;
+    if (stored)
+      record = loaded;
+    prefs.end();
+  }
+
+  uint8_t before = record.clockIndex;
+  if (!stored)
+  {
+    record.clockIndex = probe(0);
+  }
+  else if (record.errors)
+  {
+    LOG_WARN(TAG, "⚠️  Touch I2C errors at %lu kHz last run - stepping down",
+             (unsigned long)(TOUCH_CLOCKS_HZ[record.clockIndex] / 1000));
+    record.clockIndex = probe(min((uint8_t)(record.clockIndex + 1), (uint8_t)(CLOCK_COUNT - 1)));
+    record.cleanBoots = 0;
+  }
+  else if (record.clockIndex > 0 && ++record.cleanBoots >= TOUCH_CLOCK_CLEAN_BOOTS)
+  {
+    if (ackAt(TOUCH_CLOCKS_HZ[record.clockIndex - 1], 0))
+      record.clockIndex--;  // Errors come back → flagged → next boot steps down again
+    record.cleanBoots = 0;
+  }
+
+  if (!ackAt(TOUCH_CLOCKS_HZ[record.clockIndex], 0))
+  {
+    LOG_WARN(TAG, "⚠️  Touch controller NACK at %lu kHz - probing",
+             (unsigned long)(TOUCH_CLOCKS_HZ[record.clockIndex] / 1000));
+    record.clockIndex = probe(0);
+    if (!ackAt(TOUCH_CLOCKS_HZ[record.clockIndex], 0))
+      LOG_ERROR(TAG, "❌ Touch controller NO ACK at 0x%02X - touch unavailable", TOUCH_I2C_ADDR);
+  }
+
+  bool changed = !stored || record.errors || record.clockIndex != before || record.clockIndex > 0;
+  record.errors = 0;
+  if (changed)
+    store();  // Fastest clock and clean: nothing to write
+
+  uint32_t hz = TOUCH_CLOCKS_HZ[record.clockIndex];
+  LOG_INFO(TAG, "Touch I2C clock: %lu kHz (%s)", (unsigned long)(hz / 1000),
+           stored && record.clockIndex == before ? "stored" : "calibrated");
+  return hz;
+}
+
+void touchClockReport(uint32_t reads, uint32_t corrupted, uint32_t timeouts)
+{
+  if (flagged || reads < TOUCH_CLOCK_MIN_READS)
+    return;
+  if ((corrupted + timeouts) * 100 < reads * TOUCH_CLOCK_ERROR_PCT)
+    return;
+
+  flagged = true;
+  record.errors = 1;
+  store();
+  LOG_WARN(TAG, "⚠️  Touch I2C: %lu corrupt + %lu timed out of %lu reads at %lu kHz - slower clock next boot",
+           (unsigned long)corrupted, (unsigned long)timeouts, (unsigned long)reads,
+           (unsigned long)(TOUCH_CLOCKS_HZ[record.clockIndex] / 1000));
+}
@@ -0,0 +1,49 @@
+#ifndef TOUCH_CLOCK_H
+#define TOUCH_CLOCK_H
+
+// =============================================================================
+// Persisted Touch I2C Clock
+// =============================================================================
+// The touch controller shares its I2C bus with the PMU and has shown
+// corrupted [00 00 ...] frames and timeouts when the board runs hot. Instead
+// of probing 100/50/20 kHz with 100 ms pauses on every boot, the clock that
+// worked last time is kept in NVS (namespace "touchclk") with the state the
+// controller was left in:
+//
+//   boot, record clean   → that clock, one ACK check, no probe
+//   boot, errors flagged → probe from one step below the flagged clock
+//   boot, NACK / no record → probe from the fastest clock
+//
+// The probe takes the fastest clock that ACKs and stores it. At runtime the
+// UI task's 10 s touch health window (corruptedReads / timeoutReads) is
+// handed to touchClockReport(); a window above TOUCH_CLOCK_ERROR_PCT flags
+// the record once, so the next boot steps down. After
+// TOUCH_CLOCK_CLEAN_BOOTS clean boots below the fastest clock the next boot
+// tries one step up again - heat comes and goes.
+//
+// Thread Safety:
+//   touchClockBegin() from setup() before touchInputBegin() (owns Wire).
+//   touchClockReport() from the UI task only.
+// =============================================================================
+
+#include <Arduino.h>
+
+constexpr uint32_t TOUCH_CLOCKS_HZ[]       = {100000, 50000, 20000};  // Fastest first
+constexpr uint32_t TOUCH_CLOCK_PROBE_MS    = 100;  // Settle time per probed clock
+constexpr uint32_t TOUCH_CLOCK_MIN_READS   = 50;   // Window must have this many reads to judge
+constexpr uint32_t TOUCH_CLOCK_ERROR_PCT   = 5;    // Corrupt + timed out reads that flag the clock
+constexpr uint8_t TOUCH_CLOCK_CLEAN_BOOTS  = 8;    // Clean boots before trying one step faster
+
+/**
+ * @brief Apply the stored clock (probing only as a fallback) and check the controller ACKs
+ * @note Call after the reset sequence and Wire.begin()
+ * @return Clock in use (Hz)
+ */
+uint32_t touchClockBegin();
+
+/**
+ * @brief Feed one touch health window; flags the clock in NVS once when errors exceed the threshold
+ */
+void touchClockReport(uint32_t reads, uint32_t corrupted, uint32_t timeouts);
+
+#endif // TOUCH_CLOCK_H
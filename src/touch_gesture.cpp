@@ -0,0 +1,139 @@
+// =============================================================================
+// Touch Gestures Implementation
+// =============================================================================
+
+#include "touch_gesture.h"
+#include "debug_config.h"
+#include "metrics.h"
+#include "seqlock.h"
+
+TouchGestureStats touchGestureStats = {};
+
+static constexpr LogTag TAG = LOG_TAG_UI;
+
+static MetricCounterRef swipeLeftTotal("touch_gesture_swipe_left_total", "Swipe left gestures", &touchGestureStats.recognised[TOUCH_GESTURE_SWIPE_LEFT]);
+static MetricCounterRef swipeRightTotal("touch_gesture_swipe_right_total", "Swipe right gestures", &touchGestureStats.recognised[TOUCH_GESTURE_SWIPE_RIGHT]);
+static MetricCounterRef longPressTotal("touch_gesture_long_press_total", "Long press gestures", &touchGestureStats.recognised[TOUCH_GESTURE_LONG_PRESS]);
+static MetricCounterRef twoFingerTotal("touch_gesture_two_finger_total", "Two-finger gestures", &touchGestureStats.recognised[TOUCH_GESTURE_TWO_FINGER]);
+static MetricCounterRef nativeTotal("touch_gesture_native_total", "Gestures taken from the controller's gesture byte", &touchGestureStats.native);
+
+static SeqLock<TouchGestureEvent> shared(TouchGestureEvent{});
+static uint32_t takenSeq = 0;  // Consumer only
+
+static void publish(TouchGesture gesture, bool native, int16_t x, int16_t y)
+{
+  touchGestureStats.recognised[gesture]++;
+  if (native)
+    touchGestureStats.native++;
+  shared.update([&](TouchGestureEvent &e) {
+    e.seq++;
+    e.gesture = gesture;
+    e.native = native;
+    e.x = x;
+    e.y = y;
+  });
+  LOG_DEBUG(TAG, "👆 Gesture %s%s at (%d, %d)", touchGestureName(gesture), native ? " (controller)" : "", x, y);
+}
+
+#if GS_TOUCH_NATIVE_GESTURES
+// Controller codes → landscape. Landscape x runs against the controller's X
+// (x = 639 - rawX), so its "down" (towards larger X) is a swipe to the left.
+static TouchGesture nativeGesture(uint8_t code)
+{
+  switch (code) {
+    case AXS_GESTURE_SWIPE_DOWN:  return TOUCH_GESTURE_SWIPE_LEFT;
+    case AXS_GESTURE_SWIPE_UP:    return TOUCH_GESTURE_SWIPE_RIGHT;
+    case AXS_GESTURE_LONG_PRESS:  return TOUCH_GESTURE_LONG_PRESS;
+    default:                      return TOUCH_GESTURE_NONE;
+  }
+}
+#endif
+
+static TouchGesture judgeRelease(const TouchGestureState &state, uint32_t nowMs)
+{
+  if (state.maxPoints >= 2)
+    return TOUCH_GESTURE_TWO_FINGER;
+  if (state.longFired)
+    return TOUCH_GESTURE_NONE;
+  int16_t dx = state.lastX - state.startX;
+  int16_t dy = state.lastY - state.startY;
+  if (abs(dx) >= TOUCH_SWIPE_MIN_PX && abs(dy) * 2 < abs(dx) && nowMs - state.startMs <= TOUCH_SWIPE_MAX_MS)
+    return dx < 0 ? TOUCH_GESTURE_SWIPE_LEFT : TOUCH_GESTURE_SWIPE_RIGHT;
+  return TOUCH_GESTURE_NONE;
+}
+
+TouchGesture touchGestureRun(TouchGestureState &state, const TouchFrame &frame, const TouchSample &sample,
+                             uint32_t nowMs)
+{
+#if GS_TOUCH_NATIVE_GESTURES
+  TouchGesture native = nativeGesture(AXS_GET_GESTURE_TYPE(frame.raw));
+  if (native != TOUCH_GESTURE_NONE) {
+    bool fired = native == TOUCH_GESTURE_LONG_PRESS && state.longFired;
+    state.longFired |= native == TOUCH_GESTURE_LONG_PRESS;
+    if (!fired) {
+      publish(native, true, state.startX, state.startY);
+      if (native != TOUCH_GESTURE_LONG_PRESS)
+        state.contact = false;  // The swipe is the contact's gesture - no software judgement on top
+      return native;
+    }
+    return TOUCH_GESTURE_NONE;
+  }
+#endif
+
+  if (!sample.pressed) {
+    if (!state.contact)
+      return TOUCH_GESTURE_NONE;
+    state.contact = false;
+    TouchGesture g = judgeRelease(state, nowMs);
+    if (g != TOUCH_GESTURE_NONE)
+      publish(g, false, state.startX, state.startY);
+    return g;
+  }
+
+  if (!state.contact) {
+    state.contact = true;
+    state.longFired = false;
+    state.maxPoints = 1;
+    state.startMs = nowMs;
+    state.startX = sample.x;
+    state.startY = sample.y;
+    state.maxDist = 0;
+  }
+  state.lastX = sample.x;
+  state.lastY = sample.y;
+  uint8_t points = AXS_GET_POINT_NUM(frame.raw);
+  if (points > state.maxPoints)
+    state.maxPoints = points;
+  int16_t dist = max(abs(sample.x - state.startX), abs(sample.y - state.startY));
+  if (dist > state.maxDist)
+    state.maxDist = dist;
+
+  if (!state.longFired && state.maxPoints < 2 && state.maxDist <= TOUCH_TAP_SLOP_PX &&
+      nowMs - state.startMs >= TOUCH_LONG_PRESS_MS) {
+    state.longFired = true;
+    publish(TOUCH_GESTURE_LONG_PRESS, false, state.startX, state.startY);
+    return TOUCH_GESTURE_LONG_PRESS;
+  }
+  return TOUCH_GESTURE_NONE;
+}
+
+bool touchGestureTake(TouchGestureEvent *event)
+{
+  TouchGestureEvent e = shared.load();
+  if (e.seq == takenSeq)
+    return false;
+  takenSeq = e.seq;
+  *event = e;
+  return true;
+}
+
+const char *touchGestureName(TouchGesture gesture)
+{
+  switch (gesture) {
+    case TOUCH_GESTURE_SWIPE_LEFT:  return "swipe-left";
+    case TOUCH_GESTURE_SWIPE_RIGHT: return "swipe-right";
+    case TOUCH_GESTURE_LONG_PRESS:  return "long-press";
+    case TOUCH_GESTURE_TWO_FINGER:  return "two-finger";
+    default:                        return "none";
+  }
+}
@@ -0,0 +1,111 @@
+#ifndef TOUCH_GESTURE_H
+#define TOUCH_GESTURE_H
+
+// =============================================================================
+// Touch Gestures (swipe between screens, long-press tare, two-finger reset)
+// =============================================================================
+// The last stage of the touch pipeline (touch_pipeline.h): it sees every
+// frame with the sample the earlier stages made of it and recognises, per
+// contact (first press to release):
+//
+//   swipe left / right   |dx| >= TOUCH_SWIPE_MIN_PX within TOUCH_SWIPE_MAX_MS,
+//                        mostly horizontal - judged at release
+//   long press           TOUCH_LONG_PRESS_MS without leaving TOUCH_TAP_SLOP_PX
+//                        - fires while the finger is still down
+//   two fingers          the frame header's point count reached 2 at any time
+//                        during the contact - judged at release
+//
+// The controller's report only carries point 0's coordinates in the 8 bytes
+// read, but its header counts the fingers, so two-finger detection costs no
+// extra I2C.
+//
+// GS_TOUCH_NATIVE_GESTURES (compile-time, -DGS_TOUCH_NATIVE_GESTURES=1):
+// also take the controller's gesture byte (CST816-style codes, mapped to
+// landscape below). Off by default: this 0x3B variant is undocumented and its
+// gesture reports have not been seen reliably, so the software recogniser
+// alone decides unless the codes are confirmed on a board.
+//
+// Recognised gestures go out as the newest TouchGestureEvent (SeqLock, with a
+// sequence number); the UI task takes it with touchGestureTake() after
+// lv_timer_handler() and maps it to actions - LVGL is never touched here.
+// Gestures that arrive while the UI task is busy replace each other: a
+// gesture is a command, not a stream.
+//
+// Thread Safety:
+//   touchGestureRun() - the touch task (pipeline state). touchGestureTake() -
+//   one consumer (UI task). touchGestureStats - any task.
+// =============================================================================
+
+#include <Arduino.h>
+#include "touch_input.h"
+
+#ifndef GS_TOUCH_NATIVE_GESTURES
+#define GS_TOUCH_NATIVE_GESTURES 0
+#endif
+
+constexpr int16_t  TOUCH_SWIPE_MIN_PX   = 120;  // Landscape px along x
+constexpr uint32_t TOUCH_SWIPE_MAX_MS   = 600;
+constexpr int16_t  TOUCH_TAP_SLOP_PX    = 12;   // Movement that still counts as holding still
+constexpr uint32_t TOUCH_LONG_PRESS_MS  = 800;
+
+// Controller gesture byte (CST816 family), panel orientation
+constexpr uint8_t AXS_GESTURE_SWIPE_UP    = 0x01;
+constexpr uint8_t AXS_GESTURE_SWIPE_DOWN  = 0x02;
+constexpr uint8_t AXS_GESTURE_SWIPE_LEFT  = 0x03;
+constexpr uint8_t AXS_GESTURE_SWIPE_RIGHT = 0x04;
+constexpr uint8_t AXS_GESTURE_LONG_PRESS  = 0x0C;
+
+enum TouchGesture : uint8_t {
+  TOUCH_GESTURE_NONE,
+  TOUCH_GESTURE_SWIPE_LEFT,   // Finger moved towards x = 0
+  TOUCH_GESTURE_SWIPE_RIGHT,
+  TOUCH_GESTURE_LONG_PRESS,
+  TOUCH_GESTURE_TWO_FINGER,
+};
+
+struct TouchGestureEvent {
+  uint32_t seq;               // 0: nothing recognised yet
+  TouchGesture gesture;
+  bool native;                // From the controller's gesture byte
+  int16_t x;                  // Landscape start point of the contact
+  int16_t y;
+};
+
+struct TouchGestureState {
+  bool contact;
+  bool longFired;
+  uint8_t maxPoints;
+  uint32_t startMs;
+  int16_t startX;
+  int16_t startY;
+  int16_t lastX;
+  int16_t lastY;
+  int16_t maxDist;            // Largest Chebyshev distance from the start point
+};
+
+struct TouchGestureStats {
+  volatile uint32_t recognised[TOUCH_GESTURE_TWO_FINGER + 1];
+  volatile uint32_t native;
+};
+
+extern TouchGestureStats touchGestureStats;
+
+/**
+ * @brief Feed one frame and the sample the pipeline made of it
+ * @return The gesture recognised on this frame (also published), or TOUCH_GESTURE_NONE
+ */
+TouchGesture touchGestureRun(TouchGestureState &state, const TouchFrame &frame, const TouchSample &sample,
+                             uint32_t nowMs);
+
+/**
+ * @brief Newest gesture the consumer has not taken yet
+ * @return false if none since the last call
+ */
+bool touchGestureTake(TouchGestureEvent *event);
+
+/**
+ * @brief Name for logs ("swipe-left", ...)
+ */
+const char *touchGestureName(TouchGesture gesture);
+
+#endif // TOUCH_GESTURE_H
@@ -0,0 +1,272 @@
+// =============================================================================
+// Interrupt-Driven Touch Input Implementation
+// =============================================================================
+
+#include "touch_input.h"
+#include "touch_pipeline.h"
+#include "touch_replay.h"
+#include "debug_config.h"
+#include "task_layout.h"
+#include "trace.h"
+#include "metrics.h"
+#include "crash_ring.h"
+#include "i2c_bus.h"
+#include "watchdog.h"
+#include "hal/gpio_ll.h"
+#include "esp_sleep.h"
+
+TouchInputStats touchInputStats = {};
+
+static constexpr LogTag TAG = LOG_TAG_UI;
+
+static MetricHistogram touchI2cUs("touch_i2c_us", "Touch frame I2C transaction time", METRIC_BUCKETS_US);
+static MetricCounterRef touchInterrupts("touch_interrupts_total", "Touch INT edges", &touchInputStats.interrupts);
+static MetricCounterRef touchReads("touch_reads_total", "Touch I2C transactions", &touchInputStats.reads);
+static MetricCounterRef touchTimeouts("touch_timeouts_total", "Touch I2C transactions that timed out", &touchInputStats.timeouts);
+static MetricCounterRef touchErrors("touch_errors_total", "Touch I2C NACK / bus errors", &touchInputStats.errors);
+static MetricCounterRef touchDropped("touch_dropped_total", "Touch samples lost to a full ring", &touchInputStats.dropped);
+
+static const uint8_t read_touchpad_cmd[AXS_TOUCH_FRAME_LEN] = {0xb5, 0xab, 0xa5, 0x5a, 0x0, 0x0, 0x0, 0x8};
+
+// Touch task wake-up events (task notification bits)
+static constexpr uint32_t TOUCH_EVT_INT = 1u << 0;   // INT edge
+static constexpr uint32_t TOUCH_EVT_BUS = 1u << 1;   // I2C job queued (i2c_bus.h)
+static constexpr uint32_t TOUCH_EVT_REPLAY = 1u << 2;   // Replay started / stopped (touch_replay.h)
+
+static TaskHandle_t touchTask = NULL;
+static volatile TaskHandle_t touchConsumer = NULL;
+static volatile unsigned long holdOffUntil = 0;
+static portMUX_TYPE wakeMux = portMUX_INITIALIZER_UNLOCKED;
+static bool wakeArmed = false;   // INT level-triggered as the light sleep wake source
+
+// SPSC sample ring - head written by the touch task only, tail by the consumer only
+static TouchSample ring[TOUCH_RING_SIZE];
+static volatile uint32_t ringHead = 0;
+static volatile uint32_t ringTail = 0;
+
+static void IRAM_ATTR touchIntIsr()
+{
+  BaseType_t woken = pdFALSE;
+  touchInputStats.interrupts++;
+
+  // Armed as a wake source the pin is level-triggered and would fire again right
+  // after return while the finger stays down - back to the falling edge here
+  portENTER_CRITICAL_ISR(&wakeMux);
+  if (wakeArmed) {
+    gpio_ll_wakeup_disable(&GPIO, (gpio_num_t)TOUCH_INT);
+    gpio_ll_set_intr_type(&GPIO, (gpio_num_t)TOUCH_INT, GPIO_INTR_NEGEDGE);
+    wakeArmed = false;
+  }
+  portEXIT_CRITICAL_ISR(&wakeMux);
+
+  xTaskNotifyFromISR(touchTask, TOUCH_EVT_INT, eSetBits, &woken);
+  if (woken)
+    portYIELD_FROM_ISR();
+}
+
+static bool ringPush(const TouchSample &sample)
+{
+  uint32_t head = ringHead;
+  if (head - ringTail >= TOUCH_RING_SIZE) {
+    touchInputStats.dropped++;
+    return false;
+  }
+  ring[head & (TOUCH_RING_SIZE - 1)] = sample;
+  __sync_synchronize();  // Sample contents visible before the index moves
+  ringHead = head + 1;
+  return true;
+}
+
+// Touch transport: IDF I2C master driver on the port Wire.begin() installed, through
+// i2cBusTransfer() for the per-client bus stats. The driver queues the command list
+// and blocks this task on a semaphore until the I2C ISR finishes it - no polling,
+// and the timeout is enforced by the driver.
+static void readFrame(TouchFrame &frame)
+{
+  GS_TRACE_SCOPE("touch_i2c");
+  int64_t startUs = esp_timer_get_time();
+  memset(frame.raw, 0, sizeof(frame.raw));
+  touchInputStats.reads++;
+
+  // CRITICAL: Match LilyGO lvgl_demo.ino I2C sequence - command write with STOP,
+  // then a separate 8-byte read (same as endTransmission() + requestFrom())
+  // See: https://github.com/Xinyuan-LilyGO/T-Display-S3-Long/blob/main/examples/lvgl_demo/lvgl_demo.ino#L70-L75
+  esp_err_t err = i2cBusTransfer(I2C_CLIENT_TOUCH, TOUCH_I2C_ADDR, read_touchpad_cmd, AXS_TOUCH_FRAME_LEN,
+                                 frame.raw, AXS_TOUCH_FRAME_LEN, I2C_JOB_STOP_BETWEEN);
+  touchI2cUs.record((uint32_t)(esp_timer_get_time() - startUs));
+  if (err == ESP_OK)
+    return;
+
+  // Failed transaction leaves the frame zeroed → classified as bus corruption (touch_pipeline.h)
+  if (err == ESP_ERR_TIMEOUT)
+    touchInputStats.timeouts++;
+  else
+    touchInputStats.errors++;
+  crashRingRecord(CRASH_EV_TOUCH_ERROR, (uint16_t)err);
+
+  static unsigned long lastI2CErrorLog = 0;
+  // Log at most once per second to avoid spam
+  if (millis() - lastI2CErrorLog > 1000) {
+    LOG_WARN(TAG, "⚠️  Touch I2C read failed: %s (timeouts=%lu, errors=%lu)",
+             esp_err_to_name(err), touchInputStats.timeouts, touchInputStats.errors);
+    lastI2CErrorLog = millis();
+  }
+}
+
+// One touch service: read a frame, run the pipeline, publish the sample if it matters
+static void serviceTouch(bool &touching)
+{
+  TouchFrame frame;
+  readFrame(frame);
+  TouchSample sample;
+  bool point = touchPipelineRun(touchPipeline, frame, millis(), &sample);
+
+  // Idle reports only matter as the release that ends a touch
+  if (!point && !touching)
+    return;
+
+  touching = point;
+  if (!ringPush(sample))
+    return;
+  touchReplayRecord(sample);
+  if (touchConsumer != NULL)
+    xTaskNotifyGive(touchConsumer);
+}
+
+// Replay: publish the samples that are due, in place of a controller read
+static uint32_t publishReplay()
+{
+  TouchSample sample;
+  uint32_t waitMs;
+  while (touchReplayNext(millis(), &sample, &waitMs)) {
+    if (ringPush(sample) && touchConsumer != NULL)
+      xTaskNotifyGive(touchConsumer);
+  }
+  return waitMs;
+}
+
+// Owner of the shared bus (i2c_bus.h): touch first, queued jobs in the gaps
+static void touchInputTask(void *parameter)
+{
+  bool touching = false;
+  uint32_t carried = 0;   // Events picked up while running queued jobs
+
+  for (;;) {
+    uint32_t replayWaitMs = publishReplay();
+    bool replaying = replayWaitMs != TOUCH_REPLAY_IDLE;
+    if (replaying)
+      touching = false;   // The panel is not read meanwhile
+
+    // Idle: sleep until INT fires. Finger down: keep reading until release.
+    TickType_t wait = (touching || !TOUCH_USE_INT) ? pdMS_TO_TICKS(TOUCH_ACTIVE_POLL_MS) : portMAX_DELAY;
+    long holdOffMs = (long)(holdOffUntil - millis());
+    if (!touching && i2cBusPending())
+      wait = holdOffMs > 0 ? pdMS_TO_TICKS(holdOffMs) : 0;  // Queued jobs: as soon as the bus is free
+    if (replaying && pdMS_TO_TICKS(replayWaitMs) < wait)
+      wait = pdMS_TO_TICKS(replayWaitMs);
+
+    uint32_t events = carried;
+    carried = 0;
+    if (events == 0) {
+      if (wait == portMAX_DELAY)
+        watchdogIdle(WATCHDOG_TOUCH);  // Nothing to do until INT - no deadline
+      else
+        watchdogExpect(WATCHDOG_TOUCH, wait * portTICK_PERIOD_MS);
+      xTaskNotifyWait(0, UINT32_MAX, &events, wait);
+    }
+    watchdogCheckIn(WATCHDOG_TOUCH);
+
+    if ((long)(holdOffUntil - millis()) > 0) {
+      touching = false;
+      continue;  // Controller still recovering - don't touch the bus
+    }
+
+    if (!replaying && ((events & TOUCH_EVT_INT) || touching || !TOUCH_USE_INT))
+      serviceTouch(touching);
+
+    // Gaps only: check for a new INT between jobs and serve it first
+    while (!touching && i2cBusRunOne()) {
+      uint32_t more = 0;
+      if (xTaskNotifyWait(0, UINT32_MAX, &more, 0) == pdTRUE) {
+        carried |= more;
+        if (more & TOUCH_EVT_INT)
+          break;
+      }
+    }
+  }
+}
+
+bool touchInputBegin()
+{
+  watchdogRegister(WATCHDOG_TOUCH, TOUCH_WATCHDOG_MS, true);
+  BaseType_t result = taskLayoutSpawn(TASK_ROLE_TOUCH, touchInputTask, NULL, &touchTask);
+
+  if (result != pdPASS) {
+    LOG_ERROR(TAG, "❌ Failed to create touch input task");
+    return false;
+  }
+  i2cBusSetOwner(touchTask, TOUCH_EVT_BUS);
+
+#if TOUCH_USE_INT
+  pinMode(TOUCH_INT, INPUT_PULLUP);
+  attachInterrupt(digitalPinToInterrupt(TOUCH_INT), touchIntIsr, FALLING);
+  LOG_INFO(TAG, "✅ Touch input: interrupt-driven (INT=GPIO%d)", TOUCH_INT);
+#else
+  LOG_INFO(TAG, "✅ Touch input: polling every %lums (TOUCH_USE_INT=0)", TOUCH_ACTIVE_POLL_MS);
+#endif
+  return true;
+}
+
+void touchInputSetConsumer(TaskHandle_t task)
+{
+  touchConsumer = task;
+}
+
+bool touchInputPop(TouchSample *sample)
+{
+  uint32_t tail = ringTail;
+  if (tail == ringHead)
+    return false;
+  __sync_synchronize();  // Read the sample only after seeing the new head
+  *sample = ring[tail & (TOUCH_RING_SIZE - 1)];
+  ringTail = tail + 1;
+  return true;
+}
+
+bool touchInputPending()
+{
+  return ringTail != ringHead;
+}
+
+void touchInputWake()
+{
+  if (touchTask != NULL)
+    xTaskNotify(touchTask, TOUCH_EVT_REPLAY, eSetBits);
+}
+
+void touchInputHoldOff(uint32_t ms)
+{
+  holdOffUntil = millis() + ms;
+}
+
+void touchInputSetWakeSource(bool enable)
+{
+#if TOUCH_USE_INT
+  // Same register writes as gpio_wakeup_enable()/_disable(), under the lock the
+  // ISR takes so an edge in between can't leave the pin level-triggered unarmed
+  if (enable)
+    esp_sleep_enable_gpio_wakeup();
+  portENTER_CRITICAL(&wakeMux);
+  if (enable) {
+    gpio_ll_set_intr_type(&GPIO, (gpio_num_t)TOUCH_INT, GPIO_INTR_LOW_LEVEL);
+    gpio_ll_wakeup_enable(&GPIO, (gpio_num_t)TOUCH_INT);
+  } else if (wakeArmed) {
+    gpio_ll_wakeup_disable(&GPIO, (gpio_num_t)TOUCH_INT);
+    gpio_ll_set_intr_type(&GPIO, (gpio_num_t)TOUCH_INT, GPIO_INTR_NEGEDGE);
+  }
+  wakeArmed = enable;
+  portEXIT_CRITICAL(&wakeMux);
+#else
+  (void)enable;
+#endif
+}
@@ -0,0 +1,146 @@
+#ifndef TOUCH_INPUT_H
+#define TOUCH_INPUT_H
+
+// =============================================================================
+// Interrupt-Driven Touch Input for Gravimetric Shots
+// =============================================================================
+// The AXS15231B touch controller (custom protocol @ 0x3B) pulls its INT pin
+// low whenever it has a new report. Instead of LVGL polling it over I2C every
+// LV_INDEV_DEF_READ_PERIOD (~65% of those reads returned the [AF AF ...] idle
+// pattern), the data path is:
+//
+//   INT falling edge (ISR) → touch task: one queued I2C transaction →
+//     touchPipelineRun() (touch_pipeline.h) → sample ring
+//     → consumer task notified → my_touchpad_read() pops samples (no I2C,
+//       no decoding)
+//
+// While a finger is down the task keeps reading every TOUCH_ACTIVE_POLL_MS
+// until the controller reports release, so a missed edge can never leave a
+// press stuck. With no finger on the panel there is no I2C traffic at all on
+// the bus shared with the SY6970 PMU.
+//
+// TOUCH_USE_INT (compile-time, -DTOUCH_USE_INT=0): fall back to polling every
+// TOUCH_ACTIVE_POLL_MS from the touch task (boards without the INT line).
+// Idle reports are still dropped in the task, so either way only touch
+// activity reaches the ring and LVGL's read timer stays paused in between
+// (touch_indev_reads_total counts the read_cb calls that do run).
+//
+// Transport: IDF I2C master driver (driver/i2c.h) on the port Wire.begin()
+// installed, via i2cBusTransfer() (I2C_BUS_PORT, I2C_BUS_TIMEOUT_MS). The
+// touch task sleeps on the driver while the transaction runs, with the
+// timeout enforced by the driver instead of a Wire.available() spin.
+//
+// Replay (touch_replay.h): while a recording plays back, the task publishes
+// its samples at their recorded times instead of reading the controller;
+// every published sample is also offered to the recorder.
+//
+// Deep idle (display asleep): touchInputSetWakeSource() additionally makes INT
+// a GPIO wake source, so the touch that wakes the display also ends light sleep.
+//
+// Thread Safety:
+//   Sample ring is single-producer (touch task) / single-consumer (UI task).
+//   After touchInputBegin() the touch task is the ONLY user of the I2C bus
+//   (the IDF driver serialises transactions anyway, so a late PMU access is safe).
+//   The touch task is also the bus manager's owner (i2c_bus.h): queued jobs
+//   for other devices (PMU telemetry) run on it, between touches.
+// =============================================================================
+
+#include <Arduino.h>
+
+#ifndef TOUCH_USE_INT
+#define TOUCH_USE_INT 1
+#endif
+
+constexpr int TOUCH_INT          = 11;    // Touch controller INT (active low)
+constexpr uint8_t TOUCH_I2C_ADDR = 0x3B;
+
+// Touch controller report layout
+constexpr int AXS_TOUCH_FRAME_LEN     = 8;
+constexpr int AXS_TOUCH_ONE_POINT_LEN = 6;
+constexpr int AXS_TOUCH_BUF_HEAD_LEN  = 2;
+
+constexpr int AXS_TOUCH_GESTURE_POS = 0;
+constexpr int AXS_TOUCH_POINT_NUM   = 1;
+constexpr int AXS_TOUCH_EVENT_POS   = 2;
+constexpr int AXS_TOUCH_X_H_POS     = 2;
+constexpr int AXS_TOUCH_X_L_POS     = 3;
+constexpr int AXS_TOUCH_ID_POS      = 4;
+constexpr int AXS_TOUCH_Y_H_POS     = 4;
+constexpr int AXS_TOUCH_Y_L_POS     = 5;
+constexpr int AXS_TOUCH_WEIGHT_POS  = 6;
+constexpr int AXS_TOUCH_AREA_POS    = 7;
+
+#define AXS_GET_POINT_NUM(buf) buf[AXS_TOUCH_POINT_NUM]
+#define AXS_GET_GESTURE_TYPE(buf) buf[AXS_TOUCH_GESTURE_POS]
+#define AXS_GET_POINT_X(buf, point_index) (((uint16_t)(buf[AXS_TOUCH_ONE_POINT_LEN * point_index + AXS_TOUCH_X_H_POS] & 0x0F) << 8) + (uint16_t)buf[AXS_TOUCH_ONE_POINT_LEN * point_index + AXS_TOUCH_X_L_POS])
+#define AXS_GET_POINT_Y(buf, point_index) (((uint16_t)(buf[AXS_TOUCH_ONE_POINT_LEN * point_index + AXS_TOUCH_Y_H_POS] & 0x0F) << 8) + (uint16_t)buf[AXS_TOUCH_ONE_POINT_LEN * point_index + AXS_TOUCH_Y_L_POS])
+#define AXS_GET_POINT_EVENT(buf, point_index) (buf[AXS_TOUCH_ONE_POINT_LEN * point_index + AXS_TOUCH_EVENT_POS] >> 6)
+
+// Touch task configuration
+constexpr uint32_t TOUCH_RING_SIZE         = 8;     // Samples buffered between touch and UI task (power of 2)
+constexpr uint32_t TOUCH_ACTIVE_POLL_MS    = 16;    // Read interval while a finger is down (= LVGL indev period)
+constexpr uint32_t TOUCH_WATCHDOG_MS       = 1000;  // One touch service or bus job (watchdog.h)
+
+struct TouchFrame {
+  uint8_t raw[AXS_TOUCH_FRAME_LEN];
+};
+
+// One finished touch sample, LVGL landscape coordinates
+struct TouchSample {
+  int16_t x;
+  int16_t y;
+  bool pressed;
+  uint32_t ms;    // millis() when the touch task read the frame
+};
+
+struct TouchInputStats {
+  volatile uint32_t interrupts;   // INT edges seen
+  volatile uint32_t reads;        // I2C transactions
+  volatile uint32_t timeouts;     // Transactions that hit I2C_BUS_TIMEOUT_MS
+  volatile uint32_t errors;       // NACK / bus errors
+  volatile uint32_t dropped;      // Samples lost to a full ring
+};
+
+extern TouchInputStats touchInputStats;
+
+/**
+ * @brief Attach the INT interrupt and start the touch task
+ * @note Call after Wire.begin() (installs the I2C driver) and the controller reset sequence
+ * @return true if the task was created
+ */
+bool touchInputBegin();
+
+/**
+ * @brief Task notified (xTaskNotifyGive) whenever a sample is published
+ */
+void touchInputSetConsumer(TaskHandle_t task);
+
+/**
+ * @brief Pop the oldest unread sample (consumer side)
+ * @return false if the ring is empty
+ */
+bool touchInputPop(TouchSample *sample);
+
+/**
+ * @brief True if samples are waiting (consumer side)
+ */
+bool touchInputPending();
+
+/**
+ * @brief Suspend I2C reads for a while (touch controller recovering after wake)
+ */
+void touchInputHoldOff(uint32_t ms);
+
+/**
+ * @brief Wake the touch task to pick up a replay started or stopped (touch_replay.h)
+ */
+void touchInputWake();
+
+/**
+ * @brief Arm / disarm INT as the light sleep wake source (deep idle while the display sleeps)
+ * @note Armed, the pin is low-level triggered; the first interrupt switches it back
+ *       to the falling edge, so a touch wakes the chip and is read like any other
+ */
+void touchInputSetWakeSource(bool enable);
+
+#endif // TOUCH_INPUT_H
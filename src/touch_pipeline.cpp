@@ -0,0 +1,278 @@
+// =============================================================================
+// Touch Sample Pipeline Implementation
+// =============================================================================
+
+#include "touch_pipeline.h"
+#include "debug_config.h"
+#include "metrics.h"
+#include "pins_config.h"
+#include "power_telemetry.h"
+#include "touch_clock.h"
+#include <math.h>
+
+TouchPipelineStats touchPipelineStats = {};
+TouchPipeline touchPipeline = {{}, {}, {TOUCH_PANEL_TO_SCREEN, TOUCH_JUMP_DEFAULT}, {}};
+
+static constexpr LogTag TAG = LOG_TAG_UI;
+
+static MetricCounterRef touchCorrupted("touch_corrupted_total", "Touch frames read as all zero (bus corruption)", &touchPipelineStats.corrupted);
+static MetricCounterRef touchEdgeGlitches("touch_edge_glitch_total", "Touch points snapped to a screen edge", &touchPipelineStats.edgeGlitches);
+static MetricCounterRef touchSuppressed("touch_suppressed_total", "Touch points held back by the noise model", &touchPipelineStats.suppressed);
+static MetricCounterRef touchNoiseContacts("touch_noise_contacts_total", "Contacts judged noise (short or edge glitch)", &touchPipelineStats.noiseContacts);
+static MetricCounterRef touchRealContacts("touch_real_contacts_total", "Contacts judged real touches", &touchPipelineStats.realContacts);
+
+TouchPoint touchClassify(const TouchFrame &frame)
+{
+  const uint8_t *buff = frame.raw;
+  TouchPoint p = {};
+
+  // [00 00 ...] = I2C bus error, [AF AF ...] = controller's normal "no touch" signal
+  // (this 0x3B variant answers most reads with it - not an error)
+  if (buff[0] == 0x00 && buff[1] == 0x00) {
+    p.cls = TOUCH_CLASS_CORRUPT;
+    return p;
+  }
+  if (buff[0] == 0xAF && buff[1] == 0xAF) {
+    p.cls = TOUCH_CLASS_IDLE;
+    return p;
+  }
+
+  uint16_t rawX = AXS_GET_POINT_X(buff, 0);
+  uint16_t rawY = AXS_GET_POINT_Y(buff, 0);
+  if (AXS_GET_GESTURE_TYPE(buff) || (!rawX && !rawY)) {
+    p.cls = TOUCH_CLASS_NONE;
+    return p;
+  }
+
+  // Points on the outermost rows / columns are usually read errors or noise
+  p.cls = TOUCH_CLASS_POINT;
+  p.edgeGlitch = rawX == 0 || rawX >= EXAMPLE_LCD_V_RES - 1 || rawY == 0 || rawY >= EXAMPLE_LCD_H_RES - 1;
+
+  int32_t rotatedX = (int32_t)(EXAMPLE_LCD_V_RES - 1) - (int32_t)rawX;
+  if (rotatedX < 0)
+    rotatedX = 0;
+  if (rotatedX >= EXAMPLE_LCD_V_RES)
+    rotatedX = EXAMPLE_LCD_V_RES - 1;
+  if (rawY >= EXAMPLE_LCD_H_RES)
+    rawY = EXAMPLE_LCD_H_RES - 1;
+  p.x = (int16_t)rawY;
+  p.y = (int16_t)rotatedX;
+  return p;
+}
+
+// Bring a cell's densities up to now - one exp2f() whatever the gap
+static void decayCell(TouchNoiseCell &cell, uint32_t nowMs)
+{
+  uint32_t dt = nowMs - cell.updatedMs;
+  if (dt > 0) {
+    float k = exp2f(-(float)dt / (float)TOUCH_NOISE_HALF_LIFE_MS);
+    cell.noise *= k;
+    cell.real *= k;
+    cell.updatedMs = nowMs;
+  }
+}
+
+static bool cellHot(const TouchNoiseCell &cell, int16_t tempC)
+{
+  float hot = (tempC != INT16_MIN && tempC >= TOUCH_NOISE_WARM_C) ? TOUCH_NOISE_HOT * 0.5f : TOUCH_NOISE_HOT;
+  return cell.noise >= hot && cell.noise > TOUCH_NOISE_RATIO * cell.real;
+}
+
+bool touchNoiseRun(TouchNoise &state, const TouchPoint &p, uint32_t nowMs, int16_t tempC)
+{
+  if (!state.contact) {
+    state.contact = true;
+    state.frames = 0;
+    state.glitchFrames = 0;
+    state.col = (uint8_t)((uint32_t)p.x * TOUCH_NOISE_COLS / EXAMPLE_LCD_H_RES);
+    state.row = (uint8_t)((uint32_t)p.y * TOUCH_NOISE_ROWS / EXAMPLE_LCD_V_RES);
+    TouchNoiseCell &cell = state.cells[state.row][state.col];
+    decayCell(cell, nowMs);
+    state.held = cellHot(cell, tempC);
+  }
+  if (state.frames < UINT8_MAX) {
+    state.frames++;
+    state.glitchFrames += p.edgeGlitch;
+  }
+  if (state.held && state.frames >= TOUCH_NOISE_CONFIRM_FRAMES)
+    state.held = false;  // Lasted like a finger - from here on a normal press
+  return state.held;
+}
+
+void touchNoiseRelease(TouchNoise &state, uint32_t nowMs)
+{
+  if (!state.contact)
+    return;
+  state.contact = false;
+  TouchNoiseCell &cell = state.cells[state.row][state.col];
+  decayCell(cell, nowMs);
+  if (state.frames <= TOUCH_NOISE_MAX_FRAMES || state.glitchFrames * 2 > state.frames) {
+    cell.noise += 1.0f;
+    touchPipelineStats.noiseContacts++;
+    if (cellHot(cell, INT16_MIN) && cell.noise < 2.0f * TOUCH_NOISE_HOT)
+      LOG_DEBUG(TAG, "Touch noise: cell %u,%u suspect (%.1f noise / %.1f real)", state.col, state.row,
+                cell.noise, cell.real);
+  } else {
+    cell.real += 1.0f;
+    touchPipelineStats.realContacts++;
+  }
+}
+
+void touchJumpFilter(TouchJump &state, const TouchJumpParams &params, int16_t &x, int16_t &y)
+{
+  const int16_t maxX = EXAMPLE_LCD_H_RES - 1;
+  const int16_t maxY = EXAMPLE_LCD_V_RES - 1;
+
+  // Edge jump prevention only - no averaging, for slider responsiveness
+  if (state.have) {
+    int16_t deltaX = abs(x - state.x);
+    int16_t deltaY = abs(y - state.y);
+    if ((x <= params.edgeX || x >= maxX - params.edgeX + 1) && deltaX > params.edgeJumpX)
+      x = state.x;
+    if ((y <= params.edgeY || y >= maxY - params.edgeY) && deltaY > params.edgeJumpY)
+      y = state.y;
+    if (deltaX > params.maxJumpX)
+      x = state.x;
+    if (deltaY > params.maxJumpY)
+      y = state.y;
+  }
+  state.x = x;
+  state.y = y;
+  state.have = true;
+}
+
+static inline int16_t clampAxis(int32_t v, int16_t size)
+{
+  return v < 0 ? 0 : v >= size ? size - 1 : (int16_t)v;
+}
+
+void touchToLandscape(const TouchAffine &t, int16_t x, int16_t y, TouchSample *out)
+{
+  constexpr int32_t HALF = TOUCH_AFFINE_ONE / 2;  // Round to nearest
+  out->x = clampAxis((t.xx * x + t.xy * y + t.x0 + HALF) >> 16, TOUCH_SCREEN_W);
+  out->y = clampAxis((t.yx * x + t.yy * y + t.y0 + HALF) >> 16, TOUCH_SCREEN_H);
+}
+
+// Everything up to the landscape sample
+static bool runStages(TouchPipeline &pipeline, const TouchFrame &frame, uint32_t nowMs, TouchSample *out)
+{
+  out->pressed = false;
+  out->x = 0;
+  out->y = 0;
+  out->ms = nowMs;
+
+  TouchPoint p = touchClassify(frame);
+  if ((touchPipelineStats.frames % 100) == 0) {
+    const uint8_t *b = frame.raw;
+    LOG_DEBUG(TAG, "Touch I2C #%lu: [%02X %02X %02X %02X %02X %02X %02X %02X]",
+              (unsigned long)touchPipelineStats.frames, b[0], b[1], b[2], b[3], b[4], b[5], b[6], b[7]);
+  }
+
+  switch (p.cls) {
+    case TOUCH_CLASS_CORRUPT: {
+      touchPipelineStats.corrupted++;
+      touchNoiseRelease(pipeline.noise, nowMs);
+      static uint32_t lastCorruptLog = 0;
+      if (nowMs - lastCorruptLog > 1000) {
+        LOG_WARN(TAG, "🚨 TRUE I2C bus corruption: [00 00 00 00 00 00 00 00]");
+        lastCorruptLog = nowMs;
+      }
+      return false;
+    }
+    case TOUCH_CLASS_IDLE:
+      touchNoiseRelease(pipeline.noise, nowMs);
+      return false;
+    case TOUCH_CLASS_NONE:
+      touchNoiseRelease(pipeline.noise, nowMs);
+      pipeline.jump.have = false;
+      return false;
+    case TOUCH_CLASS_POINT:
+      break;
+  }
+
+  if (p.edgeGlitch)
+    touchPipelineStats.edgeGlitches++;
+  int16_t tempC = INT16_MIN;
+  if (!pipeline.noise.contact) {
+    pipeline.calib = touchCalibGet();
+    PowerTelemetry power = powerTelemetryGet();
+    if (power.valid && power.chipTempC != INT16_MIN)
+      tempC = power.chipTempC;
+  }
+  if (touchNoiseRun(pipeline.noise, p, nowMs, tempC)) {
+    touchPipelineStats.suppressed++;
+    LOG_VERBOSE(TAG, "Touch held back (noisy cell %u,%u)", pipeline.noise.col, pipeline.noise.row);
+    return true;
+  }
+
+  touchJumpFilter(pipeline.jump, pipeline.calib.jump, p.x, p.y);
+  touchToLandscape(pipeline.calib.transform, p.x, p.y, out);
+  out->pressed = true;
+  return true;
+}
+
+bool touchPipelineRun(TouchPipeline &pipeline, const TouchFrame &frame, uint32_t nowMs, TouchSample *out)
+{
+  touchPipelineStats.frames++;
+  bool point = runStages(pipeline, frame, nowMs, out);
+  touchGestureRun(pipeline.gesture, frame, *out, nowMs);
+  return point;
+}
+
+void touchPipelineReport(uint32_t nowMs)
+{
+  static uint32_t lastLogMs = 0;
+  static uint32_t lastFrames = 0;
+  static uint32_t lastCorrupted = 0;
+  static uint32_t lastGlitches = 0;
+  static uint32_t lastI2CReads = 0;
+  static uint32_t lastTimeouts = 0;
+
+  if (nowMs - lastLogMs <= TOUCH_HEALTH_LOG_MS)
+    return;
+  uint32_t frames = touchPipelineStats.frames - lastFrames;
+  if (frames == 0) {
+    lastLogMs = nowMs;
+    return;
+  }
+
+  // "Corrupted" = true bus errors [00 00 ...] only; [AF AF ...] idle is normal operation
+  uint32_t corrupted = touchPipelineStats.corrupted - lastCorrupted;
+  uint32_t glitches = touchPipelineStats.edgeGlitches - lastGlitches;
+  uint32_t i2cReads = touchInputStats.reads - lastI2CReads;
+  uint32_t timeouts = touchInputStats.timeouts - lastTimeouts;
+  LOG_INFO(TAG, "📊 I2C Touch Health (last 10s):");
+  LOG_INFO(TAG, "  Frames: %lu", (unsigned long)frames);
+  LOG_INFO(TAG, "  TRUE Corruptions [00 00...]: %lu (%.1f%%) (Note: [AF AF...] idle NOT counted)",
+           (unsigned long)corrupted, corrupted * 100.0f / frames);
+  LOG_INFO(TAG, "  Timeouts: %lu of %lu I2C reads (%.1f%%)", (unsigned long)timeouts, (unsigned long)i2cReads,
+           i2cReads > 0 ? timeouts * 100.0f / i2cReads : 0.0f);
+  LOG_INFO(TAG, "  Edge glitches: %lu (%.1f%%)", (unsigned long)glitches, glitches * 100.0f / frames);
+  touchClockReport(i2cReads, corrupted, timeouts);
+
+  lastLogMs = nowMs;
+  lastFrames += frames;
+  lastCorrupted += corrupted;
+  lastGlitches += glitches;
+  lastI2CReads += i2cReads;
+  lastTimeouts += timeouts;
+}
+
+void touchPipelineDump(Print &out)
+{
+  out.printf("[Touch] %lu frames, %lu corrupted, %lu edge glitches, %lu points held back\n",
+             (unsigned long)touchPipelineStats.frames, (unsigned long)touchPipelineStats.corrupted,
+             (unsigned long)touchPipelineStats.edgeGlitches, (unsigned long)touchPipelineStats.suppressed);
+  out.printf("  contacts: %lu real, %lu noise; noise heatmap (decayed, panel rows top to bottom):\n",
+             (unsigned long)touchPipelineStats.realContacts, (unsigned long)touchPipelineStats.noiseContacts);
+  uint32_t now = millis();
+  for (uint8_t r = 0; r < TOUCH_NOISE_ROWS; r++) {
+    out.print("   ");
+    for (uint8_t c = 0; c < TOUCH_NOISE_COLS; c++) {
+      TouchNoiseCell cell = touchPipeline.noise.cells[r][c];
+      decayCell(cell, now);
+      out.printf(" %4.1f/%-4.1f%c", cell.noise, cell.real, cellHot(cell, INT16_MIN) ? '!' : ' ');
+    }
+    out.println();
+  }
+}
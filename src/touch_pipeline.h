@@ -0,0 +1,165 @@
+#ifndef TOUCH_PIPELINE_H
+#define TOUCH_PIPELINE_H
+
+// =============================================================================
+// Touch Sample Pipeline (controller frame → landscape point)
+// =============================================================================
+// Everything between an I2C touch frame and the point LVGL sees, as separate
+// stages with their state passed in - no globals, no LVGL, no I2C - so each
+// can be fed recorded frames on its own:
+//
+//   acquire    touch task: one I2C frame (touch_input.cpp)
+//   classify   touchClassify(): point / idle [AF AF ..] / corrupt [00 00 ..] /
+//              no point, edge glitch flag, point clamped to panel coordinates
+//   filter     touchNoiseRun(): per-cell thermal noise model (below)
+//              touchJumpFilter(): edge snaps and large jumps hold the last point
+//              (thresholds: TouchJumpParams)
+//   transform  touchToLandscape(): panel → LVGL landscape, one Q16 affine
+//              (compile-time rotation + per-unit correction, touch_calib.h)
+//   gesture    touchGestureRun(): swipes, long press, two fingers (touch_gesture.h)
+//   publish    touch task: TouchSample into the SPSC ring (touch_input.h)
+//
+// touchPipelineRun() chains the stages for one frame; the touch task runs it
+// right after each read, so LVGL's read_cb only pops finished samples. The
+// calibration (transform + jump thresholds) is taken at the start of each
+// contact, so a change never splits one.
+// Samples rather than a single latest state: a tap shorter than LVGL's read
+// period still arrives as press + release.
+//
+// Thermal noise model: a TOUCH_NOISE_COLS x TOUCH_NOISE_ROWS heatmap over the
+// panel. Each contact (first point to release) is judged when it ends and
+// added to the cell it started in: noise if it lasted TOUCH_NOISE_MAX_FRAMES
+// reads or fewer or was mostly edge glitch points, a real touch otherwise. Both
+// densities decay exponentially (TOUCH_NOISE_HALF_LIFE_MS), lazily when the
+// cell is next touched, so a sample costs the same whatever the history. A
+// contact that starts in a cell whose noise density is above TOUCH_NOISE_HOT
+// and TOUCH_NOISE_RATIO times its real one is held back, not dropped: once
+// it lasts TOUCH_NOISE_CONFIRM_FRAMES reads it reaches LVGL as a normal
+// press, so a real flush press on a noisy edge is late by ~2 reads instead of
+// lost. Above TOUCH_NOISE_WARM_C chip temperature (power_telemetry.h) the hot
+// threshold halves - the panel drifts when the board heats up.
+//
+// touchPipelineReport() is the 10 s touch health log (frames, corruptions,
+// timeouts, edge glitches) and feeds touchClockReport().
+//
+// Thread Safety:
+//   touchPipeline: the touch task only (touchPipelineRun()). The stage
+//   functions touch nothing but their arguments. touchPipelineStats - any
+//   task (plain counters). touchPipelineReport() - UI task (touch_clock.h).
+// =============================================================================
+
+#include <Arduino.h>
+#include "touch_input.h"
+#include "touch_gesture.h"
+#include "touch_calib.h"
+
+constexpr uint8_t  TOUCH_NOISE_COLS            = 4;      // Panel x (180 px): 45 px cells
+constexpr uint8_t  TOUCH_NOISE_ROWS            = 16;     // Panel y (640 px): 40 px cells
+constexpr uint32_t TOUCH_NOISE_HALF_LIFE_MS    = 5000;   // Cell densities halve this often
+constexpr float    TOUCH_NOISE_HOT             = 4.0f;   // Decayed noise contacts that make a cell suspect
+constexpr float    TOUCH_NOISE_RATIO           = 2.0f;   // ... if also this many times its real contacts
+constexpr uint8_t  TOUCH_NOISE_MAX_FRAMES      = 2;      // Contacts this short are noise (2 reads = 32 ms)
+constexpr uint8_t  TOUCH_NOISE_CONFIRM_FRAMES  = 3;      // Held contact in a suspect cell passes after this many
+constexpr int16_t  TOUCH_NOISE_WARM_C          = 50;     // Chip temperature that halves TOUCH_NOISE_HOT
+constexpr uint32_t TOUCH_HEALTH_LOG_MS         = 10000;  // touchPipelineReport() window
+
+enum TouchClass : uint8_t {
+  TOUCH_CLASS_POINT,    // One finger, coordinates valid
+  TOUCH_CLASS_NONE,     // Gesture or zero point: release, filter history cleared
+  TOUCH_CLASS_IDLE,     // [AF AF ..] - controller's normal "no touch"
+  TOUCH_CLASS_CORRUPT,  // [00 00 ..] - bus error or failed read
+};
+
+struct TouchPoint {
+  TouchClass cls;
+  bool edgeGlitch;  // Raw point on a screen edge (noise / read error)
+  int16_t x;        // Panel coordinates, clamped (valid for TOUCH_CLASS_POINT)
+  int16_t y;
+};
+
+struct TouchNoiseCell {
+  float noise;        // Decayed noise contacts
+  float real;         // Decayed real contacts
+  uint32_t updatedMs;
+};
+
+struct TouchNoise {
+  TouchNoiseCell cells[TOUCH_NOISE_ROWS][TOUCH_NOISE_COLS];
+  bool contact;       // Current contact, judged at release
+  bool held;          // Started in a suspect cell, not confirmed yet
+  uint8_t frames;
+  uint8_t glitchFrames;
+  uint8_t row;
+  uint8_t col;
+};
+
+struct TouchJump {
+  bool have;
+  int16_t x;
+  int16_t y;
+};
+
+struct TouchPipeline {
+  TouchNoise noise;
+  TouchJump jump;
+  TouchCalib calib;
+  TouchGestureState gesture;
+};
+
+struct TouchPipelineStats {
+  volatile uint32_t frames;        // Frames through touchPipelineRun()
+  volatile uint32_t corrupted;     // TOUCH_CLASS_CORRUPT
+  volatile uint32_t edgeGlitches;  // Points on a screen edge
+  volatile uint32_t suppressed;    // Points held back by the noise model
+  volatile uint32_t noiseContacts; // Contacts judged noise
+  volatile uint32_t realContacts;  // Contacts judged real
+};
+
+extern TouchPipelineStats touchPipelineStats;
+extern TouchPipeline touchPipeline;  // The touch task's instance
+
+/**
+ * @brief Classify a controller frame and map its point to panel coordinates
+ */
+TouchPoint touchClassify(const TouchFrame &frame);
+
+/**
+ * @brief Noise model for one point (panel coordinates)
+ * @param tempC Chip temperature, INT16_MIN if unknown (read at a contact's first point)
+ * @return true if the point is held back
+ */
+bool touchNoiseRun(TouchNoise &state, const TouchPoint &p, uint32_t nowMs, int16_t tempC);
+
+/**
+ * @brief Judge the current contact (if any) into its cell - call on every non-point frame
+ */
+void touchNoiseRelease(TouchNoise &state, uint32_t nowMs);
+
+/**
+ * @brief Hold the last point against edge snaps and jumps (panel coordinates, in place)
+ */
+void touchJumpFilter(TouchJump &state, const TouchJumpParams &params, int16_t &x, int16_t &y);
+
+/**
+ * @brief Panel coordinates → LVGL landscape coordinates (clamped to the screen)
+ */
+void touchToLandscape(const TouchAffine &t, int16_t x, int16_t y, TouchSample *out);
+
+/**
+ * @brief All stages for one frame
+ * @return true if the frame carried a point (pressed or suppressed), false for a release / idle frame
+ */
+bool touchPipelineRun(TouchPipeline &pipeline, const TouchFrame &frame, uint32_t nowMs, TouchSample *out);
+
+/**
+ * @brief Touch health log once per TOUCH_HEALTH_LOG_MS (UI task)
+ */
+void touchPipelineReport(uint32_t nowMs);
+
+/**
+ * @brief Counters and the noise heatmap ("touch" serial command)
+ * @note Reads the touch task's heatmap without a lock - a diagnostic view
+ */
+void touchPipelineDump(Print &out);
+
+#endif // TOUCH_PIPELINE_H
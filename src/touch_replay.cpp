@@ -0,0 +1,271 @@
+// =============================================================================
+// Touch Recording and Replay Implementation
+// =============================================================================
+
+#include "touch_replay.h"
+#include "debug_config.h"
+#include "console.h"
+#include "mem_caps.h"
+
+static constexpr LogTag TAG = LOG_TAG_UI;
+
+constexpr uint32_t TAP_HOLD_MS      = 80;
+constexpr uint32_t DRAG_DEFAULT_MS  = 600;
+constexpr uint32_t TAPS_DEFAULT_GAP = 300;
+constexpr uint32_t GESTURE_GAP_MS   = 200;   // Before a gesture appended after others
+
+struct ReplayEntry {
+  uint32_t atMs;    // Since the first sample
+  int16_t x;
+  int16_t y;
+  uint8_t pressed;
+};
+
+enum ReplayMode : uint8_t { MODE_IDLE, MODE_RECORDING, MODE_REPLAYING, MODE_RELEASING };
+
+static const char *const MODE_NAMES[] = {"idle", "recording", "replaying", "releasing"};
+
+static portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+static ReplayEntry *entries = NULL;
+static uint32_t count = 0;
+static ReplayMode mode = MODE_IDLE;
+static uint32_t recordStartMs = 0;
+static uint32_t next = 0;             // Replay position
+static uint32_t runStartMs = 0;       // Time base of the current repetition
+static uint16_t loopsLeft = 0;
+static bool lastPressed = false;      // Last replayed sample, released on stop
+
+// Last run
+static uint32_t runSamples = 0;
+static uint32_t runFirstMs = 0;
+static uint32_t runEndMs = 0;
+static uint32_t lateMaxMs = 0;
+static uint32_t lateTotalMs = 0;
+
+static bool ensureBuffer()
+{
+  if (entries == NULL)
+    entries = (ReplayEntry *)memCapsAlloc(TOUCH_REPLAY_SAMPLES * sizeof(ReplayEntry), MEM_PSRAM_FIRST,
+                                          MEM_OWNER_TOUCH_REPLAY);
+  return entries != NULL;
+}
+
+void touchReplayRecord(const TouchSample &sample)
+{
+  portENTER_CRITICAL(&lock);
+  if (mode == MODE_RECORDING && count < TOUCH_REPLAY_SAMPLES) {
+    if (count == 0)
+      recordStartMs = sample.ms;
+    entries[count++] = {sample.ms - recordStartMs, sample.x, sample.y, sample.pressed};
+  }
+  portEXIT_CRITICAL(&lock);
+}
+
+bool touchReplayNext(uint32_t nowMs, TouchSample *sample, uint32_t *waitMs)
+{
+  *waitMs = TOUCH_REPLAY_IDLE;
+  bool due = false;
+  bool finished = false;
+  portENTER_CRITICAL(&lock);
+  if (mode == MODE_RELEASING) {
+    // Stopped with a finger "down": one release so LVGL does not keep a press
+    *sample = {entries[next > 0 ? next - 1 : 0].x, entries[next > 0 ? next - 1 : 0].y, false, nowMs};
+    mode = MODE_IDLE;
+    lastPressed = false;
+    due = true;
+  } else if (mode == MODE_REPLAYING) {
+    const ReplayEntry &e = entries[next];
+    uint32_t at = runStartMs + e.atMs;
+    if ((int32_t)(nowMs - at) < 0) {
+      *waitMs = at - nowMs;
+    } else {
+      *sample = {e.x, e.y, e.pressed != 0, nowMs};
+      lastPressed = e.pressed != 0;
+      uint32_t late = nowMs - at;
+      lateTotalMs += late;
+      if (late > lateMaxMs)
+        lateMaxMs = late;
+      runSamples++;
+      runEndMs = nowMs;
+      due = true;
+      if (++next >= count) {
+        next = 0;
+        runStartMs = nowMs + TOUCH_REPLAY_GAP_MS;
+        if (--loopsLeft == 0) {
+          mode = lastPressed ? MODE_RELEASING : MODE_IDLE;
+          finished = true;
+        }
+      }
+    }
+  }
+  portEXIT_CRITICAL(&lock);
+  if (finished)
+    LOG_INFO(TAG, "👆 Touch replay done: %lu samples in %lums, late max %lums", (unsigned long)runSamples,
+             (unsigned long)(runEndMs - runFirstMs), (unsigned long)lateMaxMs);
+  return due;
+}
+
+bool touchReplayStart(uint16_t loops)
+{
+  portENTER_CRITICAL(&lock);
+  bool ok = mode == MODE_IDLE && count > 0 && loops > 0;
+  if (ok) {
+    mode = MODE_REPLAYING;
+    next = 0;
+    loopsLeft = loops;
+    runStartMs = millis();
+    runFirstMs = runStartMs;
+    runEndMs = runStartMs;
+    runSamples = 0;
+    lateMaxMs = 0;
+    lateTotalMs = 0;
+  }
+  portEXIT_CRITICAL(&lock);
+  if (ok)
+    touchInputWake();
+  return ok;
+}
+
+// Stop recording or replaying
+static void stop()
+{
+  portENTER_CRITICAL(&lock);
+  if (mode == MODE_RECORDING)
+    mode = MODE_IDLE;
+  else if (mode == MODE_REPLAYING)
+    mode = lastPressed ? MODE_RELEASING : MODE_IDLE;
+  portEXIT_CRITICAL(&lock);
+  touchInputWake();
+}
+
+// Append one sample (console, no recording / replay running)
+static bool append(uint32_t atMs, long x, long y, bool pressed)
+{
+  if (count >= TOUCH_REPLAY_SAMPLES)
+    return false;
+  entries[count++] = {atMs, (int16_t)x, (int16_t)y, (uint8_t)pressed};
+  return true;
+}
+
+static uint32_t appendStartMs()
+{
+  return count > 0 ? entries[count - 1].atMs + GESTURE_GAP_MS : 0;
+}
+
+// Press at x0/y0, move every TOUCH_ACTIVE_POLL_MS to x1/y1 over `ms`, release
+static bool appendDrag(long x0, long y0, long x1, long y1, uint32_t ms)
+{
+  uint32_t start = appendStartMs();
+  uint32_t steps = max(ms / TOUCH_ACTIVE_POLL_MS, (uint32_t)1);
+  for (uint32_t i = 0; i <= steps; i++) {
+    if (!append(start + i * TOUCH_ACTIVE_POLL_MS, x0 + (x1 - x0) * (long)i / (long)steps,
+                y0 + (y1 - y0) * (long)i / (long)steps, true))
+      return false;
+  }
+  return append(start + steps * TOUCH_ACTIVE_POLL_MS + TOUCH_ACTIVE_POLL_MS, x1, y1, false);
+}
+
+static bool appendTaps(long x, long y, long taps, uint32_t gapMs)
+{
+  uint32_t at = appendStartMs();
+  for (long i = 0; i < taps; i++) {
+    if (!append(at, x, y, true) || !append(at + TAP_HOLD_MS, x, y, false))
+      return false;
+    at += TAP_HOLD_MS + gapMs;
+  }
+  return true;
+}
+
+void touchReplayDump(Print &out)
+{
+  portENTER_CRITICAL(&lock);
+  ReplayMode m = mode;
+  uint32_t n = count;
+  uint32_t samples = runSamples;
+  uint32_t spanMs = runEndMs - runFirstMs;
+  uint32_t lateMax = lateMaxMs;
+  uint32_t lateTotal = lateTotalMs;
+  portEXIT_CRITICAL(&lock);
+
+  out.printf("[Replay] %s, %lu / %lu samples (%lums)\n", MODE_NAMES[m], (unsigned long)n,
+             (unsigned long)TOUCH_REPLAY_SAMPLES, (unsigned long)(n > 0 ? entries[n - 1].atMs : 0));
+  if (samples > 0)
+    out.printf("  last run: %lu samples in %lums, late avg %.1fms max %lums\n", (unsigned long)samples,
+               (unsigned long)spanMs, (float)lateTotal / samples, (unsigned long)lateMax);
+}
+
+static void cmdReplay(ConsoleArgs &args)
+{
+  long a, b, c, d, e;
+  bool idle = mode == MODE_IDLE;
+
+  if (args.is(1, "stop")) {
+    stop();
+  } else if (args.argc > 1 && !idle) {
+    args.out.println("[Replay] Busy - 'replay stop' first");
+    return;
+  } else if (args.is(1, "rec")) {
+    if (!ensureBuffer()) {
+      args.out.println("[Replay] No memory for the buffer");
+      return;
+    }
+    portENTER_CRITICAL(&lock);
+    count = 0;
+    mode = MODE_RECORDING;
+    portEXIT_CRITICAL(&lock);
+    args.out.println("[Replay] Recording - touch the panel, then 'replay stop'");
+    return;
+  } else if (args.is(1, "play")) {
+    long loops = 1;
+    if (args.argc > 2 && (!args.number(2, &loops) || loops < 1 || loops > 1000)) {
+      args.out.println("Usage: replay play [1-1000]");
+      return;
+    }
+    if (!touchReplayStart((uint16_t)loops)) {
+      args.out.println("[Replay] Nothing recorded");
+      return;
+    }
+    args.out.printf("[Replay] Playing %lu samples x%ld - the panel is ignored meanwhile\n", (unsigned long)count, loops);
+    return;
+  } else if (args.is(1, "clear")) {
+    count = 0;
+  } else if (args.is(1, "dump")) {
+    for (uint32_t i = 0; i < count; i++)
+      args.out.printf("replay add %lu %d %d %u\n", (unsigned long)entries[i].atMs, entries[i].x, entries[i].y,
+                      (unsigned)entries[i].pressed);
+    return;
+  } else if (args.is(1, "add")) {
+    if (!args.number(2, &a) || !args.number(3, &b) || !args.number(4, &c) || !args.number(5, &d) || a < 0) {
+      args.out.println("Usage: replay add <ms> <x> <y> <0|1>");
+      return;
+    }
+    if (!ensureBuffer() || (count > 0 && (uint32_t)a < entries[count - 1].atMs) || !append(a, b, c, d != 0))
+      args.out.println("[Replay] Refused: buffer full or time going backwards");
+    return;   // Quiet: loaded line by line from a dump
+  } else if (args.is(1, "drag")) {
+    e = DRAG_DEFAULT_MS;
+    if (!args.number(2, &a) || !args.number(3, &b) || !args.number(4, &c) || !args.number(5, &d) ||
+        (args.argc > 6 && (!args.number(6, &e) || e < (long)TOUCH_ACTIVE_POLL_MS))) {
+      args.out.println("Usage: replay drag <x0> <y0> <x1> <y1> [ms]");
+      return;
+    }
+    if (!ensureBuffer() || !appendDrag(a, b, c, d, e))
+      args.out.println("[Replay] Buffer full");
+  } else if (args.is(1, "taps")) {
+    d = TAPS_DEFAULT_GAP;
+    if (!args.number(2, &a) || !args.number(3, &b) || !args.number(4, &c) || c < 1 ||
+        (args.argc > 5 && (!args.number(5, &d) || d < 0))) {
+      args.out.println("Usage: replay taps <x> <y> <n> [gap ms]");
+      return;
+    }
+    if (!ensureBuffer() || !appendTaps(a, b, c, d))
+      args.out.println("[Replay] Buffer full");
+  } else if (args.argc > 1) {
+    args.out.println("Usage: replay [rec|stop|play [n]|dump|clear|add ...|drag ...|taps ...]");
+    return;
+  }
+  touchReplayDump(args.out);
+}
+
+static ConsoleCommand replayCommand("replay", "[rec|stop|play [n]|dump|clear|add|drag|taps]",
+                                    "Record touches, replay them through the indev path instead of I2C", cmdReplay);
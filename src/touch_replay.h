@@ -0,0 +1,66 @@
+#ifndef TOUCH_REPLAY_H
+#define TOUCH_REPLAY_H
+
+// =============================================================================
+// Touch Recording and Replay (reproducible interaction runs)
+// =============================================================================
+// Flush stalls and slider lag only show with real fingers, and no two drags
+// are alike. This module records the samples the touch task publishes
+// (touch_input.h) and feeds them back through the same path later:
+//
+//   record   every published sample (LVGL coordinates, pressed, ms since
+//            the first one) appended to a PSRAM buffer of
+//            TOUCH_REPLAY_SAMPLES
+//   replay   the touch task takes the samples from the buffer at their
+//            recorded times instead of reading the controller over I2C
+//            (the panel is ignored meanwhile); they go through the sample
+//            ring, my_touchpad_read() and LVGL like real touches
+//
+// "replay dump" prints the buffer as "replay add <ms> <x> <y> <0|1>" lines -
+// pasted back over serial they load it again, so a drag recorded on one
+// unit replays on another. "replay drag" / "replay taps" append generated
+// gestures (a settings slider drag, a start / stop tap burst) for runs
+// without a recording.
+//
+// Pair a replay with the trace profiler ("trace", GS_TRACE builds) and the
+// display counters ("display", "metrics flush"): the same input every run,
+// so differences come from the firmware. The run reports how late the
+// touch task published samples against the schedule.
+//
+// Thread Safety:
+//   touchReplayRecord() / touchReplayNext() from the touch task; the
+//   commands from the console. State under a spinlock; the buffer only
+//   grows while no replay runs.
+// =============================================================================
+
+#include <Arduino.h>
+#include "touch_input.h"
+
+constexpr uint32_t TOUCH_REPLAY_SAMPLES = 2048;   // ~30 s of continuous touch at 16 ms, 12 bytes each
+constexpr uint32_t TOUCH_REPLAY_GAP_MS  = 500;    // Between repetitions of a replay
+constexpr uint32_t TOUCH_REPLAY_IDLE    = UINT32_MAX;
+
+/**
+ * @brief Append a published sample while recording (touch task)
+ */
+void touchReplayRecord(const TouchSample &sample);
+
+/**
+ * @brief Next replayed sample if it is due at `nowMs` (touch task)
+ * @param waitMs ms until the next one, TOUCH_REPLAY_IDLE when no replay runs
+ * @return true if `sample` holds a sample to publish now
+ */
+bool touchReplayNext(uint32_t nowMs, TouchSample *sample, uint32_t *waitMs);
+
+/**
+ * @brief Start replaying the buffer `loops` times
+ * @return false if it is empty or a recording / replay runs
+ */
+bool touchReplayStart(uint16_t loops);
+
+/**
+ * @brief Samples, state and the last run's timing
+ */
+void touchReplayDump(Print &out);
+
+#endif // TOUCH_REPLAY_H
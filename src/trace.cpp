@@ -0,0 +1,166 @@
+// =============================================================================
+// Scoped Trace Events Implementation
+// =============================================================================
+
+#include "trace.h"
+#include "debug_config.h"
+#include "mem_caps.h"
+
+static constexpr LogTag TAG = LOG_TAG_TASK;
+
+#if GS_TRACE
+
+static_assert((TRACE_EVENTS_PER_CORE & (TRACE_EVENTS_PER_CORE - 1)) == 0,
+              "TRACE_EVENTS_PER_CORE must be a power of two");
+
+struct TraceRing {
+  TraceEvent *events;
+  uint32_t next;         // Total events claimed (slot = next % size)
+};
+
+static TraceRing rings[2];
+static volatile bool recording = false;
+
+void traceBegin()
+{
+  size_t bytes = TRACE_EVENTS_PER_CORE * sizeof(TraceEvent);
+  for (int core = 0; core < 2; core++) {
+    TraceEvent *mem = (TraceEvent *)memCapsAlloc(bytes, MEM_PSRAM_FIRST, MEM_OWNER_TRACE, true);
+    if (mem == NULL) {
+      LOG_ERROR(TAG, "❌ Trace ring: %u bytes not available", (unsigned)bytes);
+      return;
+    }
+    rings[core].events = mem;
+    rings[core].next = 0;
+  }
+
+  __sync_synchronize();  // Rings allocated before recorders see the flag
+  recording = true;
+  LOG_INFO(TAG, "🧭 Tracing: %lu events/core - \"trace\" dumps Chrome trace JSON",
+           (unsigned long)TRACE_EVENTS_PER_CORE);
+}
+
+void traceRecord(const char *name, uint32_t startUs, uint32_t durUs)
+{
+  if (!recording)
+    return;
+
+  TraceRing &ring = rings[xPortGetCoreID() & 1];
+  uint32_t n = __atomic_fetch_add(&ring.next, 1, __ATOMIC_RELAXED);
+  TraceEvent &e = ring.events[n & (TRACE_EVENTS_PER_CORE - 1)];
+  e.startUs = startUs;
+  e.durUs = durUs;
+  e.name = name;
+  e.task = xTaskGetCurrentTaskHandle();
+}
+
+// Name of a live task, or NULL when the handle is gone (e.g. the deleted Arduino loop task)
+static const char *taskName(TaskHandle_t handle, TaskStatus_t *tasks, UBaseType_t count)
+{
+  for (UBaseType_t i = 0; i < count; i++) {
+    if (tasks[i].xHandle == handle)
+      return tasks[i].pcTaskName;
+  }
+  return NULL;
+}
+
+size_t traceDump(Print &out)
+{
+  if (rings[0].events == NULL || rings[1].events == NULL) {
+    out.print("{\"traceEvents\":[]}\n");
+    return 0;
+  }
+
+  recording = false;
+  vTaskDelay(1);  // Let a recorder that already claimed a slot finish writing it
+
+  // Oldest retained event across both rings is the time origin
+  uint32_t origin = 0;
+  bool haveOrigin = false;
+  for (int core = 0; core < 2; core++) {
+    uint32_t total = rings[core].next;
+    if (total == 0)
+      continue;
+    uint32_t first = (total > TRACE_EVENTS_PER_CORE) ? total - TRACE_EVENTS_PER_CORE : 0;
+    uint32_t startUs = rings[core].events[first & (TRACE_EVENTS_PER_CORE - 1)].startUs;
+    if (!haveOrigin || (int32_t)(startUs - origin) < 0)
+      origin = startUs;
+    haveOrigin = true;
+  }
+
+  char line[160];
+  size_t written = 0;
+  TaskHandle_t named[24];
+  size_t namedCount = 0;
+
+  out.print("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+  out.print("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"args\":{\"name\":\"Core 0 (BLE)\"}},\n");
+  out.print("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"Core 1 (UI)\"}}");
+
+  for (int core = 0; core < 2; core++) {
+    uint32_t total = rings[core].next;
+    uint32_t first = (total > TRACE_EVENTS_PER_CORE) ? total - TRACE_EVENTS_PER_CORE : 0;
+    for (uint32_t n = first; n < total; n++) {
+      const TraceEvent &e = rings[core].events[n & (TRACE_EVENTS_PER_CORE - 1)];
+      if (e.name == NULL)
+        continue;
+      uint32_t ts = e.startUs - origin;
+      unsigned tid = (unsigned)((uintptr_t)e.task & 0xFFFFFF);
+      if (e.durUs == TRACE_INSTANT)
+        snprintf(line, sizeof(line), ",\n{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%lu,\"pid\":%d,\"tid\":%u}",
+                 e.name, (unsigned long)ts, core, tid);
+      else
+        snprintf(line, sizeof(line), ",\n{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%lu,\"dur\":%lu,\"pid\":%d,\"tid\":%u}",
+                 e.name, (unsigned long)ts, (unsigned long)e.durUs, core, tid);
+      out.print(line);
+      written++;
+
+      bool known = false;
+      for (size_t i = 0; i < namedCount && !known; i++)
+        known = (named[i] == e.task);
+      if (!known && namedCount < sizeof(named) / sizeof(named[0]))
+        named[namedCount++] = e.task;
+    }
+  }
+
+  // Thread names for the tasks that appear in the trace
+#if configUSE_TRACE_FACILITY
+  UBaseType_t capacity = uxTaskGetNumberOfTasks() + 4;
+  TaskStatus_t *tasks = (TaskStatus_t *)malloc(capacity * sizeof(TaskStatus_t));
+  UBaseType_t count = (tasks != NULL) ? uxTaskGetSystemState(tasks, capacity, NULL) : 0;
+#else
+  TaskStatus_t *tasks = NULL;
+  UBaseType_t count = 0;
+#endif
+  for (size_t i = 0; i < namedCount; i++) {
+    const char *name = taskName(named[i], tasks, count);
+    unsigned tid = (unsigned)((uintptr_t)named[i] & 0xFFFFFF);
+    for (int core = 0; core < 2; core++) {
+      snprintf(line, sizeof(line), ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+               core, tid, name != NULL ? name : "(ended task)");
+      out.print(line);
+    }
+  }
+  free(tasks);
+
+  out.print("\n]}\n");
+  recording = true;
+  return written;
+}
+
+#else
+
+void traceBegin() {}
+void traceRecord(const char *name, uint32_t startUs, uint32_t durUs)
+{
+  (void)name;
+  (void)startUs;
+  (void)durUs;
+}
+size_t traceDump(Print &out)
+{
+  out.print("{\"traceEvents\":[]}\n");  // Built with GS_TRACE=0
+  return 0;
+}
+
+#endif // GS_TRACE
@@ -0,0 +1,93 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+// =============================================================================
+// Scoped Trace Events (Chrome trace / Perfetto export)
+// =============================================================================
+// Timeline of what the tasks actually do, instead of reconstructing it from
+// log lines:
+//
+//   { GS_TRACE_SCOPE("flush"); ... }      // begin + duration, esp_timer us
+//   GS_TRACE_INSTANT("weight");           // single point in time
+//
+//   - Events go into a per-core flight-recorder ring (newest overwrite the
+//     oldest). A slot is claimed with one atomic increment, so any task on
+//     the core may record without a lock.
+//   - A scope records one "complete" event at its end (start + duration),
+//     so nested scopes show up as a call stack per task.
+//   - traceDump() writes the rings as Chrome trace JSON ("traceEvents"),
+//     which ui.perfetto.dev and chrome://tracing open directly. pid = core,
+//     tid = task. Recording pauses while dumping.
+//
+// Trigger a dump with the "trace" serial command (USB, copy everything from
+// `{"traceEvents"` to the closing brace into a .json file) or, in
+// WIRELESS_DEBUG builds, GET http://<ESP32-IP>/trace.json.
+//
+// GS_TRACE (compile-time, -DGS_TRACE=<n>):
+//   0 - Macros compile to nothing (default)
+//   1 - Recording enabled (debug builds)
+//
+// Names must be string literals: only the pointer is stored.
+//
+// Thread Safety:
+//   traceRecord() from any task on either core (not from IRAM ISRs - it
+//   lives in flash). traceDump() from one task at a time.
+// =============================================================================
+
+#include <Arduino.h>
+#include "esp_timer.h"
+
+#ifndef GS_TRACE
+#define GS_TRACE 0
+#endif
+
+constexpr uint32_t TRACE_EVENTS_PER_CORE = 1024;    // Power of two, 16 bytes each (PSRAM when available)
+constexpr uint32_t TRACE_INSTANT         = 0xFFFFFFFFu;  // durUs marker for instant events
+
+struct TraceEvent {
+  uint32_t startUs;      // Low 32 bits of esp_timer_get_time()
+  uint32_t durUs;        // TRACE_INSTANT for a point event
+  const char *name;
+  TaskHandle_t task;
+};
+
+/**
+ * @brief Allocate the rings and start recording (no-op when GS_TRACE == 0)
+ */
+void traceBegin();
+
+/**
+ * @brief Record one event on the calling core
+ */
+void traceRecord(const char *name, uint32_t startUs, uint32_t durUs);
+
+/**
+ * @brief Write all recorded events as Chrome trace JSON
+ * @return Number of events written
+ */
+size_t traceDump(Print &out);
+
+class TraceScope {
+public:
+  explicit TraceScope(const char *name) : name(name), startUs((uint32_t)esp_timer_get_time()) {}
+  ~TraceScope() { traceRecord(name, startUs, (uint32_t)esp_timer_get_time() - startUs); }
+
+private:
+  const char *name;
+  uint32_t startUs;
+};
+
+#define GS_TRACE_CONCAT_(a, b) a##b
+#define GS_TRACE_CONCAT(a, b)  GS_TRACE_CONCAT_(a, b)
+
+#if GS_TRACE
+#define GS_TRACE_SCOPE(name)   TraceScope GS_TRACE_CONCAT(traceScope_, __LINE__)(name)
+#define GS_TRACE_INSTANT(name) traceRecord((name), (uint32_t)esp_timer_get_time(), TRACE_INSTANT)
+#define GS_TRACE_SPAN(name, startUs, durUs) traceRecord((name), (startUs), (durUs))
+#else
+#define GS_TRACE_SCOPE(name)   do {} while (0)
+#define GS_TRACE_INSTANT(name) do {} while (0)
+#define GS_TRACE_SPAN(name, startUs, durUs) do {} while (0)
+#endif
+
+#endif // TRACE_H
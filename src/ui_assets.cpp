@@ -0,0 +1,246 @@
+// =============================================================================
+// UI Images from the "assets" Flash Partition Implementation
+// =============================================================================
+
+#include "ui_assets.h"
+#include "debug_config.h"
+#include "metrics.h"
+#include "esp_partition.h"
+#include "esp_rom_crc.h"
+#include <ui.h>
+
+static constexpr LogTag TAG = LOG_TAG_UI;
+
+struct __attribute__((packed)) UiAssetsHeader {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t count;
+  uint32_t bytes;   // Header + directory + images
+  uint32_t crc;     // CRC-32 of everything after the header
+};
+
+struct __attribute__((packed)) UiAssetEntry {
+  char name[UI_ASSET_NAME_LEN];
+  uint32_t offset;  // lv_img_header_t + pixels, from the partition start
+  uint32_t size;
+};
+
+struct UiAssetSlot {
+  const char *name;
+  const lv_img_dsc_t *compiled;  // SquareLine descriptor the screens reference
+  lv_img_dsc_t mapped;           // data points into the mapping when present
+  bool present;
+};
+
+static UiAssetSlot slots[] = {
+  {"arrow", &ui_img_arrow_png},   {"bluetooth", &ui_img_bluetooth_png}, {"cancel", &ui_img_cancel_png},
+  {"coffee", &ui_img_coffee_png}, {"config", &ui_img_config_png},       {"flush", &ui_img_flush_png},
+  {"light", &ui_img_light_png},   {"refresh", &ui_img_refresh_png},     {"return", &ui_img_return_png},
+  {"timer", &ui_img_timer_png},   {"weight", &ui_img_weight_png},
+};
+static constexpr size_t SLOT_COUNT = sizeof(slots) / sizeof(slots[0]);
+
+#if GS_UI_ASSETS >= 2
+// The C arrays are left out of the build (tools/ui_assets/drop_compiled_images.py).
+// The screens only need distinct addresses; the decoder supplies header and pixels.
+const lv_img_dsc_t ui_img_arrow_png = {};
+const lv_img_dsc_t ui_img_bluetooth_png = {};
+const lv_img_dsc_t ui_img_cancel_png = {};
+const lv_img_dsc_t ui_img_coffee_png = {};
+const lv_img_dsc_t ui_img_config_png = {};
+const lv_img_dsc_t ui_img_flush_png = {};
+const lv_img_dsc_t ui_img_light_png = {};
+const lv_img_dsc_t ui_img_refresh_png = {};
+const lv_img_dsc_t ui_img_return_png = {};
+const lv_img_dsc_t ui_img_timer_png = {};
+const lv_img_dsc_t ui_img_weight_png = {};
+#endif
+
+static volatile uint32_t iconLookups = 0;  // Icon draws = image cache lookups
+static volatile uint32_t iconMisses = 0;   // Decoder opens = cache misses
+static MetricCounterRef iconLookupsMetric("lv_img_cache_lookups_total", "UI icon draws (image cache lookups)",
+                                          &iconLookups);
+static MetricCounterRef iconMissesMetric("lv_img_cache_misses_total", "UI icon image cache misses (decoder opens)",
+                                         &iconMisses);
+
+static bool trueColor(uint8_t cf)
+{
+  return cf == LV_IMG_CF_TRUE_COLOR || cf == LV_IMG_CF_TRUE_COLOR_ALPHA || cf == LV_IMG_CF_TRUE_COLOR_CHROMA_KEYED;
+}
+
+static UiAssetSlot *slotFor(const void *src)
+{
+  if (src == NULL || lv_img_src_get_type(src) != LV_IMG_SRC_VARIABLE)
+    return NULL;
+  for (size_t i = 0; i < SLOT_COUNT; i++) {
+    if (slots[i].compiled == src)
+      return &slots[i];
+  }
+  return NULL;
+}
+
+// What a slot draws: the mapped image, else the compiled one (none in GS_UI_ASSETS=2 builds)
+static const lv_img_dsc_t *imageFor(const UiAssetSlot &slot)
+{
+  if (slot.present)
+    return &slot.mapped;
+  return (GS_UI_ASSETS >= 2) ? NULL : slot.compiled;
+}
+
+#if GS_UI_ASSETS
+
+static lv_res_t assetInfo(lv_img_decoder_t *decoder, const void *src, lv_img_header_t *header)
+{
+  (void)decoder;
+  UiAssetSlot *slot = slotFor(src);
+  const lv_img_dsc_t *img = (slot != NULL) ? imageFor(*slot) : NULL;
+  if (img == NULL || !trueColor(img->header.cf))
+    return LV_RES_INV;  // Not ours - next decoder
+  *header = img->header;
+  return LV_RES_OK;
+}
+
+static lv_res_t assetOpen(lv_img_decoder_t *decoder, lv_img_decoder_dsc_t *dsc)
+{
+  (void)decoder;
+  UiAssetSlot *slot = slotFor(dsc->src);
+  const lv_img_dsc_t *img = (slot != NULL) ? imageFor(*slot) : NULL;
+  if (img == NULL)
+    return LV_RES_INV;
+  dsc->img_data = img->data;  // True color: drawn in place from flash
+  iconMisses++;
+  return LV_RES_OK;
+}
+
+static void assetClose(lv_img_decoder_t *decoder, lv_img_decoder_dsc_t *dsc)
+{
+  (void)decoder;
+  (void)dsc;  // Nothing to free - the mapping stays
+}
+
+// Point the slots at the images in the mapping; returns images found
+static int bindImages(const uint8_t *base, const UiAssetsHeader &header)
+{
+  const UiAssetEntry *entries = (const UiAssetEntry *)(base + sizeof(UiAssetsHeader));
+  int found = 0;
+  for (uint16_t i = 0; i < header.count; i++) {
+    const UiAssetEntry &e = entries[i];
+    char name[UI_ASSET_NAME_LEN];
+    memcpy(name, e.name, sizeof(name));
+    name[sizeof(name) - 1] = '\0';
+
+    if (e.size < sizeof(lv_img_header_t) || e.offset + e.size > header.bytes || (e.offset & 3) != 0) {
+      LOG_WARN(TAG, "⚠️  UI assets: \"%s\" out of bounds, skipped", name);
+      continue;
+    }
+    lv_img_header_t img;
+    memcpy(&img, base + e.offset, sizeof(img));
+    if (!trueColor(img.cf)) {
+      LOG_WARN(TAG, "⚠️  UI assets: \"%s\" color format %u not supported, skipped", name, img.cf);
+      continue;
+    }
+
+    for (size_t s = 0; s < SLOT_COUNT; s++) {
+      if (strcmp(slots[s].name, name) != 0)
+        continue;
+      slots[s].mapped.header = img;
+      slots[s].mapped.data_size = e.size - sizeof(lv_img_header_t);
+      slots[s].mapped.data = base + e.offset + sizeof(lv_img_header_t);
+      slots[s].present = true;
+      found++;
+    }
+  }
+  return found;
+}
+
+// Head of the decoder list: asked before the built-in decoder for every icon
+static bool registerDecoder()
+{
+  lv_img_decoder_t *decoder = lv_img_decoder_create();
+  if (decoder == NULL) {
+    LOG_ERROR(TAG, "❌ UI assets: decoder allocation failed");
+    return false;
+  }
+  lv_img_decoder_set_info_cb(decoder, assetInfo);
+  lv_img_decoder_set_open_cb(decoder, assetOpen);
+  lv_img_decoder_set_close_cb(decoder, assetClose);
+  return true;
+}
+
+int uiAssetsBegin()
+{
+  if (!registerDecoder())
+    return 0;
+
+  const esp_partition_t *part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, "assets");
+  if (part == NULL) {
+    LOG_DEBUG(TAG, "UI assets: no \"assets\" partition, compiled images");
+    return 0;
+  }
+
+  UiAssetsHeader header;
+  if (esp_partition_read(part, 0, &header, sizeof(header)) != ESP_OK || header.magic != UI_ASSETS_MAGIC ||
+      header.version != UI_ASSETS_VERSION || header.bytes > part->size ||
+      header.bytes < sizeof(header) + header.count * sizeof(UiAssetEntry)) {
+    LOG_INFO(TAG, "🖼️  UI assets: partition empty or not in v%u format%s", UI_ASSETS_VERSION,
+             GS_UI_ASSETS >= 2 ? " - ICONS WILL BE BLANK" : ", compiled images");
+    return 0;
+  }
+
+  const void *mapped = NULL;
+  spi_flash_mmap_handle_t handle;
+  if (esp_partition_mmap(part, 0, header.bytes, SPI_FLASH_MMAP_DATA, &mapped, &handle) != ESP_OK) {
+    LOG_ERROR(TAG, "❌ UI assets: mmap of %lu bytes failed", (unsigned long)header.bytes);
+    return 0;
+  }
+  const uint8_t *base = (const uint8_t *)mapped;
+  uint32_t crc = esp_rom_crc32_le(0, base + sizeof(header), header.bytes - sizeof(header));
+  if (crc != header.crc) {
+    LOG_ERROR(TAG, "❌ UI assets: CRC mismatch (0x%08lx, expected 0x%08lx) - reflash assets.bin",
+              (unsigned long)crc, (unsigned long)header.crc);
+    spi_flash_munmap(handle);
+    return 0;
+  }
+
+  int found = bindImages(base, header);
+  LOG_INFO(TAG, "🖼️  UI assets: %d/%u images mapped from flash (%lu bytes at 0x%06lx)", found, (unsigned)SLOT_COUNT,
+           (unsigned long)header.bytes, (unsigned long)part->address);
+  return found;
+}
+
+#else
+
+int uiAssetsBegin()
+{
+  return 0;
+}
+
+#endif // GS_UI_ASSETS
+
+const lv_img_dsc_t *uiAssetFind(const char *name)
+{
+  for (size_t i = 0; i < SLOT_COUNT; i++) {
+    if (strcmp(slots[i].name, name) == 0)
+      return imageFor(slots[i]);
+  }
+  return NULL;
+}
+
+static void countIconDraw(lv_event_t *e)
+{
+  (void)e;
+  iconLookups++;
+}
+
+void uiAssetsInstrument(lv_obj_t *root)
+{
+  bool icon = slotFor(lv_obj_get_style_bg_img_src(root, LV_PART_MAIN)) != NULL;
+  if (lv_obj_check_type(root, &lv_img_class))
+    icon = icon || slotFor(lv_img_get_src(root)) != NULL;
+  if (icon)
+    lv_obj_add_event_cb(root, countIconDraw, LV_EVENT_DRAW_MAIN_BEGIN, NULL);
+
+  uint32_t count = lv_obj_get_child_cnt(root);
+  for (uint32_t i = 0; i < count; i++)
+    uiAssetsInstrument(lv_obj_get_child(root, i));
+}
@@ -0,0 +1,67 @@
+#ifndef UI_ASSETS_H
+#define UI_ASSETS_H
+
+// =============================================================================
+// UI Images from the "assets" Flash Partition
+// =============================================================================
+// The SquareLine icons (lib/ui/src/images) can come from a separate flash
+// partition instead of the app image. tools/ui_assets/pack_assets.py packs
+// them as LVGL binary images behind a small directory; at boot the
+// directory is checked (magic, version, CRC-32) and the partition is mapped
+// with esp_partition_mmap(), so pixels are read through the flash cache
+// exactly like the compiled-in const arrays - zero-copy, nothing in RAM
+// except one lv_img_dsc_t per image.
+//
+// An LVGL image decoder registered ahead of the built-in one recognises the
+// SquareLine descriptors (&ui_img_flush_png, ...) and answers with the
+// mapped image of the same name, or the compiled one when the partition
+// lacks it; lib/ui is not touched. Any other source falls through to the
+// built-in decoder. Flashing another assets.bin swaps the theme without a
+// rebuild.
+//
+// Every icon draw goes through the LVGL image cache (LV_IMG_CACHE_DEF_SIZE,
+// one entry per icon): a hit skips the decoder chain entirely. Draws of
+// instrumented icon widgets and decoder opens are counted as
+// lv_img_cache_lookups_total / lv_img_cache_misses_total ("metrics").
+//
+// GS_UI_ASSETS (compile-time, -DGS_UI_ASSETS=<n>):
+//   0 - Compiled-in images only, no decoder (misses are not counted)
+//   1 - Partition images replace the compiled ones when present (default)
+//   2 - Partition only: tools/ui_assets/drop_compiled_images.py keeps the
+//       C arrays out of the build (~50 KB smaller app) and the descriptors
+//       become empty stand-ins. Without a valid partition icons stay blank.
+//
+// Thread Safety:
+//   uiAssetsBegin() from setup() after lv_init(); the decoder runs in the
+//   LVGL (UI) task. The mapping is never released.
+// =============================================================================
+
+#include <Arduino.h>
+#include "lvgl.h"
+
+#ifndef GS_UI_ASSETS
+#define GS_UI_ASSETS 1
+#endif
+
+constexpr uint32_t UI_ASSETS_MAGIC   = 0x41555347;  // "GSUA" (tools/ui_assets/pack_assets.py)
+constexpr uint16_t UI_ASSETS_VERSION = 1;
+constexpr size_t UI_ASSET_NAME_LEN   = 24;
+
+/**
+ * @brief Map the assets partition and register the decoder (no-op when GS_UI_ASSETS == 0)
+ * @return Number of UI images served from flash
+ */
+int uiAssetsBegin();
+
+/**
+ * @brief Count draws of the icon widgets under `root` (image cache lookups)
+ * @note Call after the screen is built - walks the tree once
+ */
+void uiAssetsInstrument(lv_obj_t *root);
+
+/**
+ * @brief Image by asset name ("flush", "coffee", ...): mapped if present, else compiled, else NULL
+ */
+const lv_img_dsc_t *uiAssetFind(const char *name);
+
+#endif // UI_ASSETS_H
@@ -0,0 +1,180 @@
+// =============================================================================
+// Typed, Coalescing UI State Channel Implementation
+// =============================================================================
+
+#include "ui_channel.h"
+#include "metrics.h"
+
+static portMUX_TYPE channelMux = portMUX_INITIALIZER_UNLOCKED;
+static UIChannelSnapshot slots = {};
+static volatile uint32_t dirtyFlags = 0;
+static volatile TaskHandle_t consumer = NULL;
+static volatile bool held = false;   // Headless: values kept for the wake frame, consumer left asleep
+static int64_t oldestUs = 0;         // When dirtyFlags last left 0 (under channelMux)
+
+// Per dirty bit: posts that replaced a value the UI task had not taken yet
+static const char *const FIELD_NAMES[UI_DIRTY_STATUS_SHIFT + STATUS_PRIORITY_COUNT] = {
+    "weight", "timer", NULL, "connection", "status_progress", "status_event", "status_alert"};
+static uint32_t coalescedByField[UI_DIRTY_STATUS_SHIFT + STATUS_PRIORITY_COUNT] = {};
+
+static bool readCoalesced(uint16_t index, char *labels, size_t labelsSize, int32_t *value);
+
+static MetricCounter postsTotal("ui_channel_posts_total", "Values posted to the UI channel");
+static MetricCounter coalescedTotal("ui_channel_coalesced_total", "Posts that replaced a value the UI task never took");
+static MetricGaugeSet coalescedFields("ui_channel_coalesced", "Coalesced posts per field", readCoalesced);
+static MetricGauge backlogFields("ui_channel_backlog_fields", "Dirty fields per take (peak = high-water mark)");
+static MetricHistogram takeAgeUs("ui_channel_take_age_us", "Oldest dirty field's wait for the UI task", METRIC_BUCKETS_US);
+
+static bool readCoalesced(uint16_t index, char *labels, size_t labelsSize, int32_t *value)
+{
+  const uint16_t count = sizeof(FIELD_NAMES) / sizeof(FIELD_NAMES[0]);
+  for (uint16_t i = 0, series = 0; i < count; i++) {
+    if (FIELD_NAMES[i] == NULL || series++ != index)
+      continue;  // Unused bit, or not this series
+    snprintf(labels, labelsSize, "field=\"%s\"", FIELD_NAMES[i]);
+    *value = (int32_t)__atomic_load_n(&coalescedByField[i], __ATOMIC_RELAXED);
+    return true;
+  }
+  return false;
+}
+
+// Under channelMux: mark `bit` dirty; returns true if it already was (the old value is gone)
+static inline bool markDirty(uint32_t bit)
+{
+  uint32_t before = dirtyFlags;
+  if (before == 0)
+    oldestUs = esp_timer_get_time();
+  dirtyFlags = before | bit;
+  return (before & bit) != 0;
+}
+
+// Outside channelMux: count the post
+static void notePost(uint32_t bit, bool coalesced)
+{
+  postsTotal.add();
+  if (!coalesced)
+    return;
+  coalescedTotal.add();
+  __atomic_fetch_add(&coalescedByField[__builtin_ctz(bit)], 1, __ATOMIC_RELAXED);
+}
+
+static void notifyConsumer()
+{
+  TaskHandle_t task = consumer;
+  if (task != NULL && !held)
+    xTaskNotifyGive(task);
+}
+
+void uiChannelSetConsumer(TaskHandle_t task)
+{
+  consumer = task;
+  if (dirtyFlags != 0)
+    notifyConsumer();  // Anything published before the UI task existed
+}
+
+void uiChannelSetWeight(float grams)
+{
+  uiChannelSetWeightTrend(grams, 0.0f, 0);
+}
+
+void uiChannelSetWeightTrend(float grams, float flowGps, int64_t sampleUs)
+{
+  portENTER_CRITICAL(&channelMux);
+  slots.weight = grams;
+  slots.weightFlow = flowGps;
+  slots.weightSampleUs = sampleUs;
+  bool coalesced = markDirty(UI_DIRTY_WEIGHT);
+  portEXIT_CRITICAL(&channelMux);
+  notifyConsumer();
+  notePost(UI_DIRTY_WEIGHT, coalesced);
+}
+
+void uiChannelSetTimer(float seconds)
+{
+  portENTER_CRITICAL(&channelMux);
+  slots.timer = seconds;
+  slots.timerRunning = false;
+  bool coalesced = markDirty(UI_DIRTY_TIMER);
+  portEXIT_CRITICAL(&channelMux);
+  notifyConsumer();
+  notePost(UI_DIRTY_TIMER, coalesced);
+}
+
+void uiChannelStartTimer(int64_t startUs)
+{
+  portENTER_CRITICAL(&channelMux);
+  slots.timer = 0.0f;
+  slots.timerStartUs = startUs;
+  slots.timerRunning = true;
+  bool coalesced = markDirty(UI_DIRTY_TIMER);
+  portEXIT_CRITICAL(&channelMux);
+  notifyConsumer();
+  notePost(UI_DIRTY_TIMER, coalesced);
+}
+
+void uiChannelSetConnection(bool connected)
+{
+  portENTER_CRITICAL(&channelMux);
+  slots.connected = connected;
+  bool coalesced = markDirty(UI_DIRTY_CONNECTION);
+  portEXIT_CRITICAL(&channelMux);
+  notifyConsumer();
+  notePost(UI_DIRTY_CONNECTION, coalesced);
+}
+
+void uiChannelSetStatus(StatusId id, const char *text)
+{
+  StatusPriority priority = statusPolicy(id).priority;
+  UIStatusSlot &slot = slots.status[priority];
+  portENTER_CRITICAL(&channelMux);
+  slot.id = id;
+  slot.format = NULL;
+  strncpy(slot.text, text, sizeof(slot.text) - 1);
+  slot.text[sizeof(slot.text) - 1] = '\0';
+  bool coalesced = markDirty(uiDirtyStatus(priority));
+  portEXIT_CRITICAL(&channelMux);
+  notifyConsumer();
+  notePost(uiDirtyStatus(priority), coalesced);
+}
+
+void uiChannelSetStatusValues(StatusId id, const char *format, float value, float value2)
+{
+  StatusPriority priority = statusPolicy(id).priority;
+  UIStatusSlot &slot = slots.status[priority];
+  portENTER_CRITICAL(&channelMux);
+  slot.id = id;
+  slot.format = format;
+  slot.value = value;
+  slot.value2 = value2;
+  bool coalesced = markDirty(uiDirtyStatus(priority));
+  portEXIT_CRITICAL(&channelMux);
+  notifyConsumer();
+  notePost(uiDirtyStatus(priority), coalesced);
+}
+
+void uiChannelSetHeadless(bool on)
+{
+  held = on;  // Released by the consumer itself: its running pass takes what is dirty
+}
+
+bool uiChannelTake(UIChannelSnapshot *out)
+{
+  if (dirtyFlags == 0)
+    return false;
+
+  portENTER_CRITICAL(&channelMux);
+  *out = slots;
+  out->dirty = dirtyFlags;
+  dirtyFlags = 0;
+  int64_t since = oldestUs;
+  portEXIT_CRITICAL(&channelMux);
+
+  backlogFields.set(__builtin_popcount(out->dirty));
+  takeAgeUs.record((uint32_t)(esp_timer_get_time() - since));
+  return true;
+}
+
+bool uiChannelPending()
+{
+  return !held && dirtyFlags != 0;
+}
@@ -0,0 +1,122 @@
+#ifndef UI_CHANNEL_H
+#define UI_CHANNEL_H
+
+// =============================================================================
+// Typed, Coalescing UI State Channel for Gravimetric Shots
+// =============================================================================
+// Replaces the 20-deep uiUpdateQueue of 48-byte strings. Producers (BLE task,
+// LVGL event handlers) store typed values into one slot per field:
+//
+//   weight (float g, flow g/s, sample time) | timer (float s, or running
+//   from a start time) | connection (bool) |
+//   status (ID + text, or ID + format + values; one slot per priority)
+//
+// Last writer wins, so a burst coalesces into the newest value instead of
+// overflowing a queue and dropping updates. Status slots are per priority
+// (status_line.h): progress updates coalesce among themselves and never
+// overwrite an alert the UI task has not taken yet. Nothing is formatted on the
+// producer side: the UI task formats each dirty field once, right before
+// lv_label_set_text_static().
+//
+// Telemetry (metrics.h): posts, coalesced posts in total and per field (a
+// value replaced before the UI task took it - the channel's equivalent of a
+// queue drop), dirty fields per take with their high-water mark, and how long
+// the oldest dirty field waited for the take.
+//
+// Headless (display off during a shot, display_power.h): the UI task holds
+// the channel. Setters still store and coalesce, but wake nobody, and
+// uiChannelPending() reports nothing, so the UI task sleeps through the shot.
+// The first pass after the hold takes everything at once for the wake frame.
+//
+// Thread Safety:
+//   Setters - any task, any core (tiny copy under a spinlock, never blocks)
+//   uiChannelTake()/uiChannelPending()/uiChannelSetHeadless() - UI task (Core 1) only
+// =============================================================================
+
+#include <Arduino.h>
+#include "status_line.h"
+
+constexpr size_t UI_STATUS_TEXT_LEN = STATUS_LINE_TEXT_LEN;
+
+// Dirty bits in UIChannelSnapshot::dirty
+constexpr uint32_t UI_DIRTY_WEIGHT     = 1u << 0;
+constexpr uint32_t UI_DIRTY_TIMER      = 1u << 1;
+constexpr uint32_t UI_DIRTY_CONNECTION = 1u << 3;
+constexpr uint32_t UI_DIRTY_STATUS_SHIFT = 4;  // One bit per StatusPriority from here
+constexpr uint32_t UI_DIRTY_STATUS     = ((1u << STATUS_PRIORITY_COUNT) - 1) << UI_DIRTY_STATUS_SHIFT;
+
+constexpr uint32_t uiDirtyStatus(StatusPriority priority)
+{
+  return 1u << (UI_DIRTY_STATUS_SHIFT + priority);
+}
+
+struct UIStatusSlot {
+  StatusId id;
+  const char *format;                  // printf format taking one or two floats, NULL = use text
+  float value;
+  float value2;                        // Second argument (0 for one-value formats)
+  char text[UI_STATUS_TEXT_LEN];
+};
+
+struct UIChannelSnapshot {
+  uint32_t dirty;                      // UI_DIRTY_* fields changed since the last take
+  float weight;                        // Grams
+  float weightFlow;                    // g/s to project the weight with (0 = show as is, weight_projector.h)
+  int64_t weightSampleUs;              // esp_timer time of the sample behind weight
+  float timer;                         // Seconds (stopped / reset value)
+  int64_t timerStartUs;                // esp_timer time the running shot clock counts from
+  bool timerRunning;                   // The UI task counts from timerStartUs itself
+  UIStatusSlot status[STATUS_PRIORITY_COUNT];  // By statusPolicy(id).priority
+  bool connected;
+};
+
+/**
+ * @brief Task notified (xTaskNotifyGive) whenever a field becomes dirty
+ */
+void uiChannelSetConsumer(TaskHandle_t task);
+
+void uiChannelSetWeight(float grams);
+
+/**
+ * @brief Post the filtered shot weight with its flow, projected by the UI task between packets
+ */
+void uiChannelSetWeightTrend(float grams, float flowGps, int64_t sampleUs);
+/**
+ * @brief Show a fixed timer value (shot end, reset) and stop the UI shot clock
+ */
+void uiChannelSetTimer(float seconds);
+
+/**
+ * @brief Start the UI shot clock at startUs; no further timer traffic until it stops
+ */
+void uiChannelStartTimer(int64_t startUs);
+void uiChannelSetConnection(bool connected);
+
+/**
+ * @brief Post a status message with a fixed text (copied)
+ */
+void uiChannelSetStatus(StatusId id, const char *text);
+
+/**
+ * @brief Post a status message formatted on the UI task
+ * @param format String literal with one or two float conversions (e.g. "End @ %.1f s, extracting %.1f s")
+ */
+void uiChannelSetStatusValues(StatusId id, const char *format, float value, float value2);
+
+/**
+ * @brief Hold the channel while the display is off (no wakes, nothing pending) or release it (UI task only)
+ */
+void uiChannelSetHeadless(bool on);
+
+/**
+ * @brief Take all dirty fields and clear them (UI task only)
+ * @return false if nothing changed
+ */
+bool uiChannelTake(UIChannelSnapshot *out);
+
+/**
+ * @brief True if any field is dirty and the channel is not held (UI task only)
+ */
+bool uiChannelPending();
+
+#endif // UI_CHANNEL_H
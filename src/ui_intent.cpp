@@ -0,0 +1,109 @@
+// =============================================================================
+// Input Intents Implementation
+// =============================================================================
+
+#include "ui_intent.h"
+#include "debug_config.h"
+#include "metrics.h"
+
+static constexpr LogTag TAG = LOG_TAG_UI;
+
+static const char *const INTENT_NAMES[UI_INTENT_COUNT] = {"start", "stop", "tare", "flush", "timer reset"};
+
+static volatile uint32_t accepted[UI_INTENT_COUNT] = {};
+static volatile uint32_t rejected[UI_INTENT_COUNT] = {};
+
+static MetricCounter acceptedTotal("ui_intent_accepted_total", "Button / gesture intents handed to the command layer");
+static MetricCounter rejectedTotal("ui_intent_rejected_total", "Button presses shorter than their policy");
+static MetricHistogram latencyMs("ui_intent_latency_ms", "Touch release (touch task read) → command layer", METRIC_BUCKETS_MS);
+
+static UiIntentHandler handler = NULL;
+static uint32_t contactPressMs = 0;
+static uint32_t contactReleaseMs = 0;
+static bool contactDown = false;
+static const UiIntentPolicy *armed = NULL;
+static uint32_t armedPressMs = 0;
+static uint32_t lastLatencyMs = 0;
+
+void uiIntentSetHandler(UiIntentHandler h)
+{
+  handler = h;
+}
+
+void uiIntentTouch(bool pressed, uint32_t ms)
+{
+  if (pressed == contactDown)
+    return;
+  contactDown = pressed;
+  if (pressed)
+    contactPressMs = ms;
+  else
+    contactReleaseMs = ms;
+}
+
+static void deliver(UiIntent intent, UiIntentSource source, uint32_t sinceMs)
+{
+  accepted[intent]++;
+  acceptedTotal.add();
+  lastLatencyMs = millis() - sinceMs;
+  latencyMs.record(lastLatencyMs);
+  if (handler != NULL)
+    handler(intent, source);
+}
+
+void uiIntentEvent(lv_event_t *e, const UiIntentPolicy &policy)
+{
+  switch (lv_event_get_code(e)) {
+    case LV_EVENT_PRESSED:
+      armed = &policy;
+      armedPressMs = contactPressMs;
+      LOG_DEBUG(TAG, "%s PRESSED", policy.name);
+      break;
+
+    case LV_EVENT_PRESS_LOST:
+      if (armed == &policy)
+        armed = NULL;
+      break;
+
+    case LV_EVENT_CLICKED: {
+      if (armed != &policy)
+        break;
+      armed = NULL;
+      // Release stamped by the touch task; still down (keypad / encoder) counts as now
+      uint32_t releaseMs = uiIntentTouchMs();
+      uint32_t heldMs = releaseMs - armedPressMs;
+      if (heldMs < policy.minPressMs) {
+        rejected[policy.intent]++;
+        rejectedTotal.add();
+        LOG_DEBUG(TAG, "%s REJECTED - press too short (%lums < %lums)", policy.name, (unsigned long)heldMs,
+                  (unsigned long)policy.minPressMs);
+        break;
+      }
+      LOG_DEBUG(TAG, "%s: %s after a %lums press", policy.name, INTENT_NAMES[policy.intent], (unsigned long)heldMs);
+      deliver(policy.intent, UI_INTENT_FROM_BUTTON, releaseMs);
+      break;
+    }
+
+    default:
+      break;
+  }
+}
+
+void uiIntentSubmit(UiIntent intent, UiIntentSource source)
+{
+  if (intent < UI_INTENT_COUNT)
+    deliver(intent, source, uiIntentTouchMs());
+}
+
+uint32_t uiIntentTouchMs()
+{
+  return contactDown ? millis() : contactReleaseMs;
+}
+
+void uiIntentDump(Print &out)
+{
+  out.printf("[Intents] last touch → command %lums\n", (unsigned long)lastLatencyMs);
+  for (uint8_t i = 0; i < UI_INTENT_COUNT; i++)
+    out.printf("  %-12s %5lu accepted, %5lu rejected\n", INTENT_NAMES[i], (unsigned long)accepted[i],
+               (unsigned long)rejected[i]);
+}
@@ -0,0 +1,88 @@
+#ifndef UI_INTENT_H
+#define UI_INTENT_H
+
+// =============================================================================
+// Input Intents (button presses → typed commands)
+// =============================================================================
+// Every command button used to keep its own static pressedAt, read millis()
+// in its LVGL event and compare against its own minimum. The press duration
+// then included however long the render pass that delivered the event had
+// run. Now one layer does it for all of them:
+//
+//   touch task   each sample carries the time it was read (TouchSample.ms)
+//   read_cb      uiIntentTouch(): contact press / release time, once
+//   LVGL event   uiIntentEvent(e, policy): PRESSED arms the widget's policy,
+//                CLICKED judges the contact's duration against policy
+//                minPressMs, PRESS_LOST disarms
+//   accepted     the handler (uiIntentSetHandler()) gets a typed UiIntent
+//                straight from the event - the command layer, no queue
+//
+// Gestures (touch_gesture.h) submit through uiIntentSubmit(), so the command
+// layer has one entry point and one counter set whatever the source.
+//
+// Adding a button: a UiIntentPolicy constant and a one-line ui_event_*
+// forwarding to uiIntentEvent().
+//
+// Thread Safety:
+//   UI task (LVGL owner) only. uiIntentDump() - any task (plain counters).
+// =============================================================================
+
+#include <Arduino.h>
+#include "lvgl.h"
+
+constexpr uint32_t UI_INTENT_TAP_MIN_MS  = 100;  // Debounce - accidental brushes and double contacts
+constexpr uint32_t UI_INTENT_HOLD_MIN_MS = 300;  // Deliberate hold (flush: pump runs, thermal phantoms)
+
+enum UiIntent : uint8_t {
+  UI_INTENT_START,
+  UI_INTENT_STOP,
+  UI_INTENT_TARE,
+  UI_INTENT_FLUSH,
+  UI_INTENT_TIMER_RESET,
+  UI_INTENT_COUNT,
+};
+
+enum UiIntentSource : uint8_t {
+  UI_INTENT_FROM_BUTTON,
+  UI_INTENT_FROM_GESTURE,
+};
+
+struct UiIntentPolicy {
+  UiIntent intent;
+  uint32_t minPressMs;
+  const char *name;   // Logs / dump
+};
+
+typedef void (*UiIntentHandler)(UiIntent intent, UiIntentSource source);
+
+/**
+ * @brief Command layer that receives accepted intents
+ */
+void uiIntentSetHandler(UiIntentHandler handler);
+
+/**
+ * @brief Contact edge from the touch samples (read_cb), touch task timestamp
+ */
+void uiIntentTouch(bool pressed, uint32_t ms);
+
+/**
+ * @brief Shared LVGL event handler body for command buttons
+ */
+void uiIntentEvent(lv_event_t *e, const UiIntentPolicy &policy);
+
+/**
+ * @brief Submit an intent that needs no press judgement (gestures)
+ */
+void uiIntentSubmit(UiIntent intent, UiIntentSource source);
+
+/**
+ * @brief millis() of the touch sample behind the intent being delivered (now if still pressed)
+ */
+uint32_t uiIntentTouchMs();
+
+/**
+ * @brief Accepted / rejected per intent, touch-to-command latency
+ */
+void uiIntentDump(Print &out);
+
+#endif // UI_INTENT_H
@@ -0,0 +1,72 @@
+#ifndef UI_MODEL_H
+#define UI_MODEL_H
+
+// =============================================================================
+// UI Model - state kept once, applied to the widgets of the shown screen
+// =============================================================================
+// The status line and the Bluetooth icon exist on the main and the settings
+// screen (SquareLine builds one copy per screen). Writing both copies on every
+// change re-lays out a label or restyles an image nobody can see.
+//
+// The owner of such a value keeps it (statusLine.shown(), the last connection
+// state) and a ScreenMirror of its copies, one ScreenView per screen:
+//
+//   value changes ──► changed()       no screen shows the new value
+//   apply pass    ──► target()        widget on lv_scr_act(), unless that
+//                                     screen is in sync already; NULL for
+//                                     screens without a copy
+//   screen loaded ──► target() again  one-shot sync of the screen coming in
+//
+// The widgets are looked up through their SquareLine globals (lv_obj_t **),
+// so a mirror can be declared before ui_init() and is inert while they are
+// NULL. A screen is marked in sync as target() hands out its widget.
+//
+// Not thread safe - UI task (Core 1) only, like the widgets themselves.
+// =============================================================================
+
+#include <Arduino.h>
+#include "lvgl.h"
+
+struct ScreenView {
+  lv_obj_t **screen;
+  lv_obj_t **widget;
+};
+
+class ScreenMirror {
+public:
+  static constexpr uint8_t MAX_VIEWS = 8;
+
+  ScreenMirror(const ScreenView *views, uint8_t count)
+    : views(views), count(count > MAX_VIEWS ? MAX_VIEWS : count), synced(0) {}
+
+  /**
+   * @brief The value changed: every copy is stale
+   */
+  void changed() { synced = 0; }
+
+  /**
+   * @brief Widget of the shown screen that still needs the current value
+   * @return NULL if the shown screen has no copy or is in sync
+   */
+  lv_obj_t *target()
+  {
+    lv_obj_t *active = lv_scr_act();
+    for (uint8_t i = 0; i < count; i++) {
+      if (*views[i].screen != active)
+        continue;
+      uint8_t bit = (uint8_t)(1u << i);
+      if ((synced & bit) || *views[i].widget == NULL)
+        return NULL;
+      synced |= bit;
+      return *views[i].widget;
+    }
+    return NULL;
+  }
+
+private:
+  const ScreenView *views;
+  uint8_t count;
+  uint8_t synced;  // Bit per view: its widget shows the current value
+};
+
+#endif // UI_MODEL_H
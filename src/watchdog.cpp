@@ -0,0 +1,160 @@
+// =============================================================================
+// Watchdog Supervisor Implementation
+// =============================================================================
+
+#include "watchdog.h"
+#include "debug_config.h"
+#include "task_layout.h"
+#include "metrics.h"
+#include "crash_ring.h"
+#include "ota_update.h"
+#include "esp_task_wdt.h"
+
+static constexpr LogTag TAG = LOG_TAG_TASK;
+
+static const char *const SUBSYSTEM_NAMES[WATCHDOG_COUNT] = {"ble_host", "scale_link", "control", "render", "dma", "touch"};
+
+enum SlotState : uint8_t {
+  SLOT_UNREGISTERED = 0,
+  SLOT_IDLE,
+  SLOT_ARMED
+};
+
+struct Slot {
+  volatile uint8_t state;
+  bool fatal;
+  bool late;                      // Supervisor: miss logged, waiting for a check-in
+  uint32_t deadlineMs;
+  volatile uint32_t lastMs;       // Last check-in
+  volatile uint32_t dueMs;
+  volatile uint32_t checkIns;
+  volatile int32_t minSlackMs;    // Closest call: least time left at a check-in
+  uint32_t misses;
+};
+
+static Slot slots[WATCHDOG_COUNT];
+static bool tripped = false;      // Fatal miss - TWDT no longer fed
+
+static MetricCounter stalls("watchdog_stalls_total", "Subsystem deadlines missed");
+
+void watchdogRegister(WatchdogSubsystem sub, uint32_t deadlineMs, bool fatal)
+{
+  Slot &s = slots[sub];
+  s.deadlineMs = deadlineMs;
+  s.fatal = fatal;
+  s.minSlackMs = INT32_MAX;
+  s.state = SLOT_IDLE;
+}
+
+static void checkIn(Slot &s, uint32_t budgetMs)
+{
+  if (s.state == SLOT_UNREGISTERED)
+    return;
+  uint32_t now = millis();
+  if (s.state == SLOT_ARMED) {
+    int32_t slack = (int32_t)(s.dueMs - now);
+    if (slack < s.minSlackMs)
+      s.minSlackMs = slack;
+  }
+  s.dueMs = now + budgetMs;
+  s.lastMs = now;
+  s.checkIns++;
+  s.state = SLOT_ARMED;
+}
+
+void watchdogCheckIn(WatchdogSubsystem sub)
+{
+  checkIn(slots[sub], slots[sub].deadlineMs);
+}
+
+void watchdogExpect(WatchdogSubsystem sub, uint32_t ms)
+{
+  checkIn(slots[sub], ms + WATCHDOG_SLEEP_SLACK_MS);
+}
+
+void IRAM_ATTR watchdogIdle(WatchdogSubsystem sub)
+{
+  if (slots[sub].state == SLOT_ARMED)
+    slots[sub].state = SLOT_IDLE;
+}
+
+static void supervise(uint32_t now)
+{
+  for (uint8_t i = 0; i < WATCHDOG_COUNT; i++) {
+    Slot &s = slots[i];
+    bool overdue = s.state == SLOT_ARMED && (int32_t)(now - s.dueMs) > 0;
+    if (!overdue) {
+      if (s.late)
+        LOG_WARN(TAG, "🐕 %s checked in again", SUBSYSTEM_NAMES[i]);
+      s.late = false;
+      continue;
+    }
+    if (s.late)
+      continue;
+    s.late = true;
+    s.misses++;
+    stalls.add();
+    crashRingRecord(CRASH_EV_WATCHDOG, i);
+    LOG_ERROR(TAG, "🐕 %s missed its deadline by %lums (last check-in %lums ago)%s", SUBSYSTEM_NAMES[i],
+              (unsigned long)(now - s.dueMs), (unsigned long)(now - s.lastMs), s.fatal ? " - resetting" : "");
+    if (s.fatal && !tripped) {
+      tripped = true;
+      LOG_ERROR(TAG, "🐕 TWDT no longer fed - reset in %lus", (unsigned long)WATCHDOG_TWDT_TIMEOUT_S);
+    }
+  }
+}
+
+// Every fatal subsystem has been seen alive at least once (a fresh OTA image has to get this far)
+static bool allFatalCheckedIn()
+{
+  for (uint8_t i = 0; i < WATCHDOG_COUNT; i++)
+    if (slots[i].fatal && slots[i].state != SLOT_UNREGISTERED && slots[i].checkIns == 0)
+      return false;
+  return true;
+}
+
+static void watchdogTask(void *parameter)
+{
+  esp_task_wdt_add(NULL);
+  for (;;) {
+    uint32_t now = millis();
+    supervise(now);
+    otaBootSupervise(now, allFatalCheckedIn(), tripped);
+    if (!tripped)
+      esp_task_wdt_reset();
+    vTaskDelay(pdMS_TO_TICKS(WATCHDOG_CHECK_MS));
+  }
+}
+
+void watchdogBegin()
+{
+  esp_task_wdt_init(WATCHDOG_TWDT_TIMEOUT_S, true);  // Panic & reboot on trigger
+  BaseType_t result = taskLayoutSpawn(TASK_ROLE_WATCHDOG, watchdogTask, NULL, NULL);
+  if (result != pdPASS) {
+    LOG_ERROR(TAG, "❌ Failed to create watchdog supervisor - TWDT not armed");
+    return;
+  }
+  LOG_INFO(TAG, "🐕 Watchdog supervisor: checks every %lums, TWDT %lus", (unsigned long)WATCHDOG_CHECK_MS,
+           (unsigned long)WATCHDOG_TWDT_TIMEOUT_S);
+}
+
+void watchdogDump(Print &out)
+{
+  uint32_t now = millis();
+  out.printf("[Watchdog] TWDT %lus, %s\n", (unsigned long)WATCHDOG_TWDT_TIMEOUT_S,
+             tripped ? "TRIPPED - no longer fed" : "fed by the supervisor");
+  out.print("  subsystem    deadline  state   last    check-ins  closest  misses\n");
+  for (uint8_t i = 0; i < WATCHDOG_COUNT; i++) {
+    const Slot &s = slots[i];
+    if (s.state == SLOT_UNREGISTERED)
+      continue;
+    char closest[12] = "-";
+    if (s.minSlackMs != INT32_MAX)
+      snprintf(closest, sizeof(closest), "%ldms", (long)s.minSlackMs);
+    out.printf("  %-10s %7lums%s %-6s %6lums %10lu  %7s  %6lu\n", SUBSYSTEM_NAMES[i], (unsigned long)s.deadlineMs,
+               s.fatal ? "" : "*", s.state == SLOT_ARMED ? "armed" : "idle",
+               s.checkIns ? (unsigned long)(now - s.lastMs) : 0UL, (unsigned long)s.checkIns, closest,
+               (unsigned long)s.misses);
+  }
+  out.print("  (* report only)\n");
+}
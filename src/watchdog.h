@@ -0,0 +1,83 @@
+#ifndef WATCHDOG_H
+#define WATCHDOG_H
+
+// =============================================================================
+// Watchdog Supervisor (per-subsystem deadlines, one TWDT subscriber)
+// =============================================================================
+// Instead of every task feeding the task watchdog (and long blocking calls
+// feeding it from the inside), each subsystem registers a deadline and
+// checks in; only the supervisor task is subscribed to the TWDT:
+//
+//   watchdogRegister(WATCHDOG_TOUCH, 1000, true);   // once, owner task
+//   watchdogCheckIn(WATCHDOG_TOUCH);                // "working, due again in 1000ms"
+//   watchdogExpect(WATCHDOG_BLE_HOST, 15000);       // one long call / sleep ahead
+//   watchdogIdle(WATCHDOG_TOUCH);                   // blocked on events - not monitored
+//
+// Every WATCHDOG_CHECK_MS the supervisor compares each armed subsystem with
+// its deadline. A miss is logged with the subsystem and how late it is,
+// counted (watchdog_stalls_total), and recorded in the crash ring
+// (CRASH_EV_WATCHDOG, arg = subsystem). For a fatal subsystem the
+// supervisor then stops feeding the TWDT, which resets the device
+// WATCHDOG_TWDT_TIMEOUT_S later; report-only subsystems (scale link - the
+// BLE layer reconnects on its own) just count and log.
+//
+// A firmware update on trial (ota_update.h) is judged here too: kept once
+// every fatal subsystem has checked in and stayed on time, rolled back on
+// the first fatal miss.
+//
+// "watchdog" on the serial console prints deadlines, check-ins, the closest
+// call (least slack at a check-in) and misses per subsystem.
+//
+// Thread Safety:
+//   watchdogCheckIn() / watchdogExpect() - the subsystem's own task.
+//   watchdogIdle() - any task or ISR (IRAM).
+//   watchdogRegister() before the subsystem's first check-in.
+// =============================================================================
+
+#include <Arduino.h>
+
+constexpr uint32_t WATCHDOG_TWDT_TIMEOUT_S         = 5;     // Only the supervisor feeds it (was 20s for blanket feeds)
+constexpr uint32_t WATCHDOG_CHECK_MS               = 500;
+constexpr uint32_t WATCHDOG_SLEEP_SLACK_MS         = 2000;  // Added to a task's own wait in watchdogExpect()
+
+enum WatchdogSubsystem : uint8_t {
+  WATCHDOG_BLE_HOST = 0,  // BLE task loop (HCI, commands, connection state machine)
+  WATCHDOG_SCALE_LINK,    // Weight packets while connected
+  WATCHDOG_CONTROL,       // Shot control task (samples, stop decision, relay)
+  WATCHDOG_RENDER,        // UI task pass (LVGL)
+  WATCHDOG_DMA,           // One flush window queued → done
+  WATCHDOG_TOUCH,         // Touch task service / bus jobs
+  WATCHDOG_COUNT
+};
+
+/**
+ * @brief Subscribe the supervisor task to the TWDT and start it
+ */
+void watchdogBegin();
+
+/**
+ * @brief Deadline for every check-in; `fatal` misses reset the device
+ */
+void watchdogRegister(WatchdogSubsystem sub, uint32_t deadlineMs, bool fatal);
+
+/**
+ * @brief Alive - due again within the registered deadline
+ */
+void watchdogCheckIn(WatchdogSubsystem sub);
+
+/**
+ * @brief Alive, about to block for up to `ms` (a sleep with a known timeout, a long call)
+ */
+void watchdogExpect(WatchdogSubsystem sub, uint32_t ms);
+
+/**
+ * @brief Waiting for events with no deadline - unmonitored until the next check-in
+ */
+void watchdogIdle(WatchdogSubsystem sub);
+
+/**
+ * @brief Deadlines, check-ins, closest call and misses per subsystem
+ */
+void watchdogDump(Print &out);
+
+#endif // WATCHDOG_H
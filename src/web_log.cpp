@@ -0,0 +1,190 @@
+// =============================================================================
+// WebSerial Log Sink Implementation
+// =============================================================================
+
+#include "web_log.h"
+#include "debug_config.h"
+#include "metrics.h"
+#include "wifi_coex.h"
+
+#ifdef WIRELESS_DEBUG
+
+struct TagBudget {
+  char name[LOG_RING_TAG_MAX];
+  uint16_t lines;          // This window
+  uint16_t sampled;        // Sampled out this window
+  uint32_t sampledTotal;
+};
+
+static TagBudget tags[WEB_LOG_MAX_TAGS];
+static uint8_t tagCount = 0;
+
+static char batch[WEB_LOG_BATCH_BYTES];
+static size_t batchLen = 0;
+static uint32_t batchStartMs = 0;     // First line of the pending batch
+static uint32_t intervalStartMs = 0;  // Burst limit: messages since this
+static uint8_t intervalMessages = 0;
+static uint32_t windowStartMs = 0;
+
+// This window, for the in-stream report
+static uint32_t windowDropped = 0;
+static uint32_t windowHeld = 0;
+
+static volatile uint32_t linesSent = 0;
+static volatile uint32_t linesSampled = 0;
+static volatile uint32_t linesDropped = 0;
+static volatile uint32_t batchesSent = 0;
+
+static MetricCounterRef sentTotal("web_log_lines_total", "Log lines sent to WebSerial", &linesSent);
+static MetricCounterRef sampledTotal("web_log_sampled_total", "Log lines left out of WebSerial by per-tag sampling", &linesSampled);
+static MetricCounterRef droppedTotal("web_log_dropped_total", "Log lines dropped from WebSerial - burst limit", &linesDropped);
+static MetricCounterRef batchesTotal("web_log_batches_total", "WebSerial log messages (batches) sent", &batchesSent);
+
+static TagBudget &budgetFor(const char *tag)
+{
+  for (uint8_t i = 0; i < tagCount; i++) {
+    if (strncmp(tags[i].name, tag, sizeof(tags[i].name)) == 0)
+      return tags[i];
+  }
+  if (tagCount == WEB_LOG_MAX_TAGS)
+    return tags[WEB_LOG_MAX_TAGS - 1];
+  TagBudget &t = tags[tagCount++];
+  strncpy(t.name, tag, sizeof(t.name) - 1);
+  t.name[sizeof(t.name) - 1] = '\0';
+  return t;
+}
+
+static bool append(const char *text, size_t len)
+{
+  if (batchLen + len > sizeof(batch))
+    return false;
+  if (batchLen == 0)
+    batchStartMs = millis();
+  memcpy(batch + batchLen, text, len);
+  batchLen += len;
+  return true;
+}
+
+static void flush()
+{
+  if (batchLen == 0)
+    return;
+  WebSerial.write((const uint8_t *)batch, batchLen);  // One WebSocket message
+  batchLen = 0;
+  batchesSent++;
+  intervalMessages++;
+}
+
+// A full batch goes out early, up to WEB_LOG_BURST_MESSAGES per interval
+static bool appendOrFlush(const char *text, size_t len)
+{
+  if (append(text, len))
+    return true;
+  uint32_t now = millis();
+  if (now - intervalStartMs >= WEB_LOG_FLUSH_MS) {
+    intervalStartMs = now;
+    intervalMessages = 0;
+  }
+  if (intervalMessages >= WEB_LOG_BURST_MESSAGES)
+    return false;
+  flush();
+  return append(text, len);
+}
+
+// Once per window, if anything was left out: the reader sees the gaps in place
+static void reportWindow(uint32_t nowMs)
+{
+  uint32_t sampled = 0;
+  for (uint8_t i = 0; i < tagCount; i++)
+    sampled += tags[i].sampled;
+
+  if (sampled || windowDropped || windowHeld) {
+    char line[160];
+    int n = snprintf(line, sizeof(line), "[web log] last %lu ms: %lu sampled", (unsigned long)(nowMs - windowStartMs),
+                     (unsigned long)sampled);
+    const char *sep = " (";
+    for (uint8_t i = 0; i < tagCount && n < (int)sizeof(line) - 24; i++) {
+      if (tags[i].sampled == 0)
+        continue;
+      n += snprintf(line + n, sizeof(line) - n, "%s%s %u", sep, tags[i].name, tags[i].sampled);
+      sep = ", ";
+    }
+    if (sep[0] == ',')
+      n += snprintf(line + n, sizeof(line) - n, ")");
+    if (n < (int)sizeof(line))
+      n += snprintf(line + n, sizeof(line) - n, ", %lu dropped, %lu held back\n", (unsigned long)windowDropped,
+                    (unsigned long)windowHeld);
+    n = min(n, (int)sizeof(line) - 1);
+    if (!wifiCoexQuiet())
+      appendOrFlush(line, n);
+  }
+
+  for (uint8_t i = 0; i < tagCount; i++) {
+    tags[i].lines = 0;
+    tags[i].sampled = 0;
+  }
+  windowDropped = 0;
+  windowHeld = 0;
+  windowStartMs = nowMs;
+}
+
+void webLogLine(uint8_t level, uint32_t timestamp, const char *tag, const char *msg)
+{
+  if (!webSerialReady)
+    return;
+  if (wifiCoexQuiet()) {
+    wifiCoexSkippedLine();
+    windowHeld++;
+    return;
+  }
+
+  TagBudget &budget = budgetFor(tag);
+  budget.lines++;
+  if (level > LOG_WARN && budget.lines > WEB_LOG_TAG_BUDGET &&
+      (budget.lines - WEB_LOG_TAG_BUDGET) % WEB_LOG_SAMPLE_KEEP != 0) {
+    budget.sampled++;
+    budget.sampledTotal++;
+    linesSampled++;
+    return;
+  }
+
+  static const char LEVEL_LETTERS[] = "?EWIDV";
+  char line[LOG_RING_MSG_MAX + 32];
+  int n = snprintf(line, sizeof(line), "%c (%lu) [%s]: %s\n", LEVEL_LETTERS[level <= LOG_VERBOSE ? level : 0],
+                   (unsigned long)timestamp, tag, msg);
+  n = min(n, (int)sizeof(line) - 1);
+  if (!appendOrFlush(line, n)) {
+    linesDropped++;
+    windowDropped++;
+    return;
+  }
+  linesSent++;
+}
+
+void webLogService(uint32_t nowMs)
+{
+  if (nowMs - windowStartMs >= WEB_LOG_WINDOW_MS)
+    reportWindow(nowMs);
+  if (nowMs - intervalStartMs >= WEB_LOG_FLUSH_MS) {
+    intervalStartMs = nowMs;
+    intervalMessages = 0;
+  }
+  if (batchLen > 0 && nowMs - batchStartMs >= WEB_LOG_FLUSH_MS)
+    flush();
+}
+
+void webLogDump(Print &out)
+{
+  out.printf("[web log] %lu lines in %lu messages, %lu sampled out, %lu dropped (burst limit)\n",
+             (unsigned long)linesSent, (unsigned long)batchesSent, (unsigned long)linesSampled,
+             (unsigned long)linesDropped);
+  out.printf("  every %lums, %u lines / tag / %lums then 1 in %u (warnings + errors always)\n",
+             (unsigned long)WEB_LOG_FLUSH_MS, (unsigned)WEB_LOG_TAG_BUDGET, (unsigned long)WEB_LOG_WINDOW_MS,
+             (unsigned)WEB_LOG_SAMPLE_KEEP);
+  for (uint8_t i = 0; i < tagCount; i++) {
+    if (tags[i].sampledTotal)
+      out.printf("  %-8s %lu sampled out\n", tags[i].name, (unsigned long)tags[i].sampledTotal);
+  }
+}
+
+#endif // WIRELESS_DEBUG
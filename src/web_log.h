@@ -0,0 +1,71 @@
+#ifndef WEB_LOG_H
+#define WEB_LOG_H
+
+// =============================================================================
+// WebSerial Log Sink (batched, per-tag sampling, drop accounting)
+// =============================================================================
+// The log drain task (log_ring.h) used to send every line as its own
+// WebSerial message, under serialMutex: one WebSocket frame, one lwIP
+// allocation and one radio burst per line. At VERBOSE that meant hundreds a
+// second on the Wi-Fi side of the coex arbiter, which is exactly the timing
+// a debug build is supposed to leave alone. Now WebSerial is a sink of its
+// own:
+//
+//   - Lines are appended to one WEB_LOG_BATCH_BYTES buffer and sent as a
+//     single message every WEB_LOG_FLUSH_MS, from the drain loop after
+//     serialMutex is released - USB output does not wait for it. A buffer
+//     that fills before that goes out early, at most WEB_LOG_BURST_MESSAGES
+//     times per interval.
+//   - Per tag, WEB_LOG_TAG_BUDGET lines per WEB_LOG_WINDOW_MS go through;
+//     beyond that 1 in WEB_LOG_SAMPLE_KEEP is kept. Warnings and errors
+//     are never sampled.
+//   - Beyond the burst limit lines are dropped.
+//   - Whatever was sampled out, dropped or held back while Wi-Fi was quiet
+//     (wifi_coex.h) is reported in the stream itself, once per window:
+//       [web log] last 1000 ms: 212 sampled (Shot 180, BLE 32), 0 dropped, 40 held back
+//     USB Serial still gets every line.
+//
+// Only built with -DWIRELESS_DEBUG; otherwise every call is an inline no-op.
+//
+// Thread Safety:
+//   Log drain task only (webLogLine() from emitLine() while the rings are
+//   active, webLogService() from the drain loop). webLogDump() from any
+//   task (plain counters).
+// =============================================================================
+
+#include <Arduino.h>
+
+constexpr uint32_t WEB_LOG_FLUSH_MS     = 100;    // One WebSerial message per interval at most
+constexpr size_t   WEB_LOG_BATCH_BYTES  = 2048;   // Lines per message (~25 typical lines)
+constexpr uint8_t  WEB_LOG_BURST_MESSAGES = 4;    // Early sends of a full buffer per interval
+constexpr uint32_t WEB_LOG_WINDOW_MS    = 1000;   // Tag budget + report period
+constexpr uint16_t WEB_LOG_TAG_BUDGET   = 20;     // Lines per tag per window before sampling
+constexpr uint16_t WEB_LOG_SAMPLE_KEEP  = 10;     // 1 in N over budget
+constexpr uint8_t  WEB_LOG_MAX_TAGS     = 16;     // Distinct tags tracked (more share the last slot)
+
+#ifdef WIRELESS_DEBUG
+
+/**
+ * @brief Offer one formatted line (no colours) to the WebSerial batch
+ */
+void webLogLine(uint8_t level, uint32_t timestamp, const char *tag, const char *msg);
+
+/**
+ * @brief Send the batch if its interval is up; once per drain loop, outside serialMutex
+ */
+void webLogService(uint32_t nowMs);
+
+/**
+ * @brief Lines sent / sampled / dropped, per-tag sampling counts
+ */
+void webLogDump(Print &out);
+
+#else
+
+inline void webLogLine(uint8_t, uint32_t, const char *, const char *) {}
+inline void webLogService(uint32_t) {}
+inline void webLogDump(Print &) {}
+
+#endif // WIRELESS_DEBUG
+
+#endif // WEB_LOG_H
@@ -0,0 +1,119 @@
+// =============================================================================
+// Weight Re-broadcast Implementation
+// =============================================================================
+
+#include "weight_broadcast.h"
+#include "debug_config.h"
+#include "metrics.h"
+#include <ArduinoBLE.h>
+
+#if GS_WEIGHT_BROADCAST
+
+static constexpr LogTag TAG = LOG_TAG_BLE;
+
+static MetricCounter notifyCount("ble_broadcast_notifications_total", "Weight records sent to subscribed clients");
+static MetricCounter coalescedCount("ble_broadcast_coalesced_total", "Samples replaced before their notify slot");
+static MetricGauge periodGauge("ble_broadcast_period_ms", "Notify period (client connection interval)");
+
+static BLEService service(WEIGHT_BROADCAST_SERVICE_UUID);
+static BLECharacteristic recordCharacteristic(WEIGHT_BROADCAST_RECORD_UUID, BLERead | BLENotify,
+                                              sizeof(WeightBroadcastRecord), true);
+
+static bool started = false;
+static WeightBroadcastRecord latest = {};
+static bool pending = false;
+static unsigned long lastSentMs = 0;
+static uint32_t periodMs = WEIGHT_BROADCAST_MIN_PERIOD_MS;
+static String clientAddress;  // "" = no client
+
+void weightBroadcastBegin()
+{
+  service.addCharacteristic(recordCharacteristic);
+  BLE.addService(service);
+  recordCharacteristic.writeValue((const uint8_t *)&latest, sizeof(latest));
+
+  BLE.setLocalName(WEIGHT_BROADCAST_LOCAL_NAME);
+  BLE.setDeviceName("Gravimetric Shots");
+  BLE.setAdvertisedService(service);
+  BLE.setAdvertisingInterval(WEIGHT_BROADCAST_ADV_INTERVAL);
+  started = BLE.advertise() == 1;
+  if (started)
+    LOG_INFO(TAG, "📡 Weight broadcast advertising as \"%s\"", WEIGHT_BROADCAST_LOCAL_NAME);
+  else
+    LOG_WARN(TAG, "⚠️  Weight broadcast: advertising failed - no clients can connect");
+}
+
+void weightBroadcastUpdate(float weightG, float flowGps, float shotS, uint16_t goalG, WeightBroadcastState state)
+{
+  WeightBroadcastRecord next = latest;
+  next.weightCg = (int32_t)lroundf(weightG * 100.0f);
+  next.flowCgps = (int16_t)lroundf(constrain(flowGps, -327.0f, 327.0f) * 100.0f);
+  next.shotDs = (uint16_t)lroundf(constrain(shotS, 0.0f, 6553.0f) * 10.0f);
+  next.goalDg = (uint16_t)(goalG * 10);
+  next.state = state;
+  if (memcmp(&next, &latest, sizeof(next)) == 0)
+    return;
+
+  if (pending)
+    coalescedCount.add();
+  next.sequence++;
+  latest = next;
+  pending = true;
+}
+
+// Track the connected client (logs, notify period from its connection interval)
+static void trackClient()
+{
+  BLEDevice central = BLE.central();
+  String address = central ? central.address() : String();
+  if (address == clientAddress)
+    return;
+
+  clientAddress = address;
+  if (address.length() == 0)
+  {
+    LOG_INFO(TAG, "📱 Broadcast client disconnected");
+    periodMs = WEIGHT_BROADCAST_MIN_PERIOD_MS;
+    return;
+  }
+
+  uint16_t interval, latency, timeout;
+  if (central.connectionParameters(&interval, &latency, &timeout))
+    periodMs = max(WEIGHT_BROADCAST_MIN_PERIOD_MS, (uint32_t)interval * 5 / 4);
+  periodGauge.set((int32_t)periodMs);
+  LOG_INFO(TAG, "📱 Broadcast client %s connected, notify every %lums", address.c_str(), (unsigned long)periodMs);
+}
+
+void weightBroadcastPoll()
+{
+  if (!started)
+    return;
+
+  trackClient();
+  if (!pending || millis() - lastSentMs < periodMs)
+    return;
+
+  // Also updates the readable value; notifies only while a client is subscribed
+  recordCharacteristic.writeValue((const uint8_t *)&latest, sizeof(latest));
+  if (recordCharacteristic.subscribed())
+    notifyCount.add();
+  pending = false;
+  lastSentMs = millis();
+}
+
+uint32_t weightBroadcastDueInMs()
+{
+  if (!started || !pending)
+    return UINT32_MAX;
+  unsigned long elapsed = millis() - lastSentMs;
+  return elapsed >= periodMs ? 0 : (uint32_t)(periodMs - elapsed);
+}
+
+#else
+
+void weightBroadcastBegin() {}
+void weightBroadcastUpdate(float, float, float, uint16_t, WeightBroadcastState) {}
+void weightBroadcastPoll() {}
+uint32_t weightBroadcastDueInMs() { return UINT32_MAX; }
+
+#endif // GS_WEIGHT_BROADCAST
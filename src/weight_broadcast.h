@@ -0,0 +1,86 @@
+#ifndef WEIGHT_BROADCAST_H
+#define WEIGHT_BROADCAST_H
+
+// =============================================================================
+// Weight Re-broadcast (GATT Peripheral)
+// =============================================================================
+// A phone app can follow shots from the controller instead of opening a
+// second connection to the scale. ArduinoBLE's local side runs next to the
+// central link to the scale: one service with one read/notify
+// characteristic, and a slow connectable advertisement carrying the service
+// UUID (name "GravShots" in the scan response).
+//
+// Every value goes into one 12-byte record (WeightBroadcastRecord,
+// little-endian): weight, flow, shot time, goal, state and a sequence number.
+// One notification therefore carries all of them. weightBroadcastUpdate()
+// only stores the newest sample. weightBroadcastPoll() sends it at most once
+// per connection interval of the client (never faster than
+// WEIGHT_BROADCAST_MIN_PERIOD_MS). Scale packets arriving in between
+// coalesce into the next notification, so the client link costs at most one
+// packet per connection event on top of the scale link. The sequence number
+// counts samples, so a client can see how many were coalesced.
+//
+// GS_WEIGHT_BROADCAST (compile-time, -DGS_WEIGHT_BROADCAST=0 to drop it):
+//   0 - No service, no advertising (the controller stays a pure central)
+//   1 - Service + advertising (default)
+//
+// Thread Safety:
+//   BLE task only - all calls issue or depend on HCI traffic, and the BLE
+//   task is the only HCI host.
+// =============================================================================
+
+#include <Arduino.h>
+
+#ifndef GS_WEIGHT_BROADCAST
+#define GS_WEIGHT_BROADCAST 1
+#endif
+
+constexpr const char *WEIGHT_BROADCAST_SERVICE_UUID = "47530000-7773-4a2f-8e1b-3f5a9c2d6e10";
+constexpr const char *WEIGHT_BROADCAST_RECORD_UUID  = "47530001-7773-4a2f-8e1b-3f5a9c2d6e10";
+constexpr const char *WEIGHT_BROADCAST_LOCAL_NAME   = "GravShots";
+constexpr uint16_t WEIGHT_BROADCAST_ADV_INTERVAL    = 1600;  // 0.625 ms units: 1 s, spares the scale link
+constexpr uint32_t WEIGHT_BROADCAST_MIN_PERIOD_MS   = 30;    // Floor on the notify period
+
+enum WeightBroadcastState : uint8_t
+{
+  WB_STATE_NO_SCALE = 0,
+  WB_STATE_IDLE,
+  WB_STATE_BREWING,
+  WB_STATE_DRIPPING,   // Pump off, waiting for the final weight
+  WB_STATE_FLUSHING
+};
+
+struct __attribute__((packed)) WeightBroadcastRecord
+{
+  int32_t weightCg;     // 0.01 g
+  int16_t flowCgps;     // 0.01 g/s, filtered
+  uint16_t shotDs;      // Shot time, 0.1 s
+  uint16_t goalDg;      // Target weight, 0.1 g
+  uint8_t state;        // WeightBroadcastState
+  uint8_t sequence;     // Incremented per changed sample (wraps)
+};
+
+static_assert(sizeof(WeightBroadcastRecord) == 12, "WeightBroadcastRecord is part of the GATT interface");
+
+/**
+ * @brief Add the service and start advertising (no-op when GS_WEIGHT_BROADCAST == 0)
+ * @note BLE task, after BLE.begin()
+ */
+void weightBroadcastBegin();
+
+/**
+ * @brief Newest sample (weight g, flow g/s, shot time s); sent by the next weightBroadcastPoll() slot
+ */
+void weightBroadcastUpdate(float weightG, float flowGps, float shotS, uint16_t goalG, WeightBroadcastState state);
+
+/**
+ * @brief Publish the pending sample if its slot has come; call once per BLE task pass
+ */
+void weightBroadcastPoll();
+
+/**
+ * @brief ms until weightBroadcastPoll() has something to send (UINT32_MAX when nothing is pending)
+ */
+uint32_t weightBroadcastDueInMs();
+
+#endif // WEIGHT_BROADCAST_H
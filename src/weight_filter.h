@@ -0,0 +1,128 @@
+#ifndef WEIGHT_FILTER_H
+#define WEIGHT_FILTER_H
+
+// =============================================================================
+// Weight/Flow Kalman Filter for Gravimetric Shots
+// =============================================================================
+// Two-state (weight g, flow g/s) constant-velocity Kalman filter that sits
+// between the raw scale samples and the stop predictor:
+//
+//   raw grams ──► WeightFilter ──► SlidingRegression ──► expected_end_s
+//
+//   - Process noise q (g^2/s^3) is how fast the flow may change; measurement
+//     noise r (g^2) is the scale's reading noise. Both come from the scale
+//     driver (ScaleDriver::processNoise()/measurementNoise()).
+//   - Samples are irregular (BLE), so each predict step uses the real dt.
+//   - A sample whose innovation exceeds FILTER_GATE_SIGMA standard deviations
+//     (cup impact, drip on the pan, a hand on the tray) is not thrown away but
+//     weighted down in proportion, so a real step still pulls the estimate
+//     over after a few samples.
+//
+// Costs a constant ~30 float operations per sample; no extra samples needed.
+// Not thread safe - keep each instance on one task (the shot control task).
+// =============================================================================
+
+#include <Arduino.h>
+
+constexpr float FILTER_GATE_SIGMA = 4.0f;
+
+struct WeightFilterState {
+  float weight;      // g
+  float flow;        // g/s
+  float weightVar;   // g^2
+  float flowVar;     // (g/s)^2
+};
+
+class WeightFilter {
+public:
+  WeightFilter() : q(1.0f), r(0.01f) { reset(); }
+
+  void setNoise(float processNoise, float measurementNoise)
+  {
+    q = processNoise;
+    r = measurementNoise;
+  }
+
+  void reset()
+  {
+    started = false;
+    lastT = 0.0f;
+    x0 = 0.0f;
+    x1 = 0.0f;
+    p00 = p01 = p11 = 0.0f;
+  }
+
+  /**
+   * @brief Feed one reading taken at time t (s, increasing)
+   */
+  void update(float t, float grams)
+  {
+    if (!started)
+    {
+      // First reading: weight known to r, flow unknown (a few g/s either way)
+      started = true;
+      lastT = t;
+      x0 = grams;
+      x1 = 0.0f;
+      p00 = r;
+      p01 = 0.0f;
+      p11 = 10.0f;
+      return;
+    }
+
+    // Predict over dt (white-noise acceleration)
+    float dt = t - lastT;
+    if (dt < 0.0f)
+      dt = 0.0f;
+    lastT = t;
+
+    x0 += x1 * dt;
+    float dt2 = dt * dt;
+    p00 += dt * (2.0f * p01 + dt * p11) + q * dt2 * dt / 3.0f;
+    p01 += dt * p11 + q * dt2 / 2.0f;
+    p11 += q * dt;
+
+    // Update, with outliers weighted down instead of trusted
+    float y = grams - x0;
+    float s = p00 + r;
+    float gate = FILTER_GATE_SIGMA * FILTER_GATE_SIGMA * s;
+    if (y * y > gate)
+    {
+      s = p00 + r * (y * y / gate);
+    }
+
+    float k0 = p00 / s;
+    float k1 = p01 / s;
+    x0 += k0 * y;
+    x1 += k1 * y;
+
+    float np00 = (1.0f - k0) * p00;
+    float np01 = (1.0f - k0) * p01;
+    float np11 = p11 - k1 * p01;
+    p00 = np00;
+    p01 = np01;
+    p11 = np11;
+  }
+
+  float weight() const { return x0; }
+  float flow() const { return x1; }
+  float processNoise() const { return q; }
+  float measurementNoise() const { return r; }
+
+  WeightFilterState state() const
+  {
+    WeightFilterState st = { x0, x1, p00, p11 };
+    return st;
+  }
+
+private:
+  float q;           // Process noise spectral density
+  float r;           // Measurement variance
+  bool started;
+  float lastT;
+  float x0;          // Weight estimate
+  float x1;          // Flow estimate
+  float p00, p01, p11;  // Covariance (symmetric)
+};
+
+#endif // WEIGHT_FILTER_H
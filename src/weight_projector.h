@@ -0,0 +1,94 @@
+#ifndef WEIGHT_PROJECTOR_H
+#define WEIGHT_PROJECTOR_H
+
+// =============================================================================
+// Weight Projector - shot weight on the display between scale packets
+// =============================================================================
+// The scale reports about every 100 ms. A label that only changes when a packet
+// arrives steps by half a gram or more at full flow. During a shot the control
+// task posts the flow filter's state (weight_filter.h) with the sample time
+// instead of the raw reading, and the UI task projects it to every frame:
+//
+//   shown = weight + flow * min(now - sampleUs, WEIGHT_PROJECT_HORIZON_US)
+//
+// That is the filter's own predict step, so the next packet lands close to
+// what is already shown (off by the filter gain times the innovation). Small
+// steps back - less than WEIGHT_PROJECT_BACKSTEP_G - are held rather than
+// shown, so the tenth digit does not flicker at each packet. The horizon
+// freezes the value when packets stop (shot end, link dropout): no runaway.
+//
+// Outside a shot the projector is fed flow 0 and returns the reading as is.
+// NumericLabel (label_bind.h) still drops values that round to the shown
+// tenth, so the label redraws once per visible digit, at most once per its
+// interval, however often at() is asked.
+//
+// GS_WEIGHT_PROJECT (compile-time, -DGS_WEIGHT_PROJECT=0):
+//   1 - project the weight label between packets during a shot (default)
+//   0 - label shows the filter weight as each packet arrives
+//
+// Not thread safe - UI task (Core 1) only.
+// =============================================================================
+
+#include <Arduino.h>
+
+#ifndef GS_WEIGHT_PROJECT
+#define GS_WEIGHT_PROJECT 1
+#endif
+
+constexpr int64_t WEIGHT_PROJECT_HORIZON_US = 150000;  // 1.5 packet periods at 10 Hz
+constexpr float WEIGHT_PROJECT_MAX_FLOW_GPS = 20.0f;   // Beyond any espresso flow: an impact, not a shot
+constexpr float WEIGHT_PROJECT_BACKSTEP_G = 0.15f;     // Held against a new packet landing just below
+
+class WeightProjector {
+public:
+  WeightProjector() : weight(0.0f), flow(0.0f), sampleUs(0), lastShown(0.0f) {}
+
+  /**
+   * @brief New base from the control task (flow 0 = show the reading as is)
+   */
+  void note(float grams, float flowGps, int64_t atUs)
+  {
+    weight = grams;
+    flow = (GS_WEIGHT_PROJECT && flowGps > 0.0f) ? flowGps : 0.0f;
+    if (flow > WEIGHT_PROJECT_MAX_FLOW_GPS)
+      flow = WEIGHT_PROJECT_MAX_FLOW_GPS;
+    sampleUs = atUs;
+    if (flow == 0.0f)
+      lastShown = grams;  // Not projecting: tare and removals show at once
+  }
+
+  /**
+   * @brief True while at() still moves with time
+   */
+  bool projecting(int64_t nowUs) const
+  {
+    return flow > 0.0f && nowUs - sampleUs < WEIGHT_PROJECT_HORIZON_US;
+  }
+
+  /**
+   * @brief Weight to show at nowUs (esp_timer_get_time())
+   */
+  float at(int64_t nowUs)
+  {
+    if (flow == 0.0f)
+      return weight;
+    int64_t dt = nowUs - sampleUs;
+    if (dt < 0)
+      dt = 0;
+    if (dt > WEIGHT_PROJECT_HORIZON_US)
+      dt = WEIGHT_PROJECT_HORIZON_US;
+    float projected = weight + flow * (float)dt * 1e-6f;
+    if (projected < lastShown && lastShown - projected < WEIGHT_PROJECT_BACKSTEP_G)
+      return lastShown;
+    lastShown = projected;
+    return projected;
+  }
+
+private:
+  float weight;      // g, filter estimate at sampleUs
+  float flow;        // g/s, 0 = not projecting
+  int64_t sampleUs;
+  float lastShown;   // g, newest value handed out
+};
+
+#endif // WEIGHT_PROJECTOR_H
@@ -0,0 +1,102 @@
+// =============================================================================
+// Wi-Fi / BLE Coexistence Policy Implementation
+// =============================================================================
+
+#include "wifi_coex.h"
+#include "debug_config.h"
+#include "metrics.h"
+
+#ifdef WIRELESS_DEBUG
+
+#include "esp_coexist.h"
+
+static constexpr LogTag TAG = LOG_TAG_WIFI;
+
+static MetricCounter quietPeriods("wifi_coex_quiet_periods_total", "Shots / connection setups with Wi-Fi held back");
+static MetricCounter skippedLines("wifi_coex_webserial_skipped_total", "Log lines not sent to WebSerial while quiet");
+static MetricCounter deferredRequests("wifi_coex_http_deferred_total", "HTTP requests answered 503 while quiet");
+static MetricCounter normalGaps("wifi_coex_gaps_total", "Weight sample gaps > WIFI_COEX_GAP_MS, Wi-Fi balanced");
+static MetricCounter quietGaps("wifi_coex_quiet_gaps_total", "Weight sample gaps > WIFI_COEX_GAP_MS, Wi-Fi quiet");
+static MetricGauge lastGap("wifi_coex_gap_ms", "Last counted weight sample gap");
+
+static volatile bool connecting = false;
+static volatile bool quiet = false;
+static unsigned long quietSinceMs = 0;
+static uint32_t skippedAtEntry = 0;
+static uint32_t lastSampleMs = 0;   // 0 = no sample yet / link restarted
+
+void wifiCoexSetConnecting(bool active)
+{
+  connecting = active;
+  if (active)
+    lastSampleMs = 0;  // The gap across a reconnect is not a coexistence gap
+}
+
+void wifiCoexUpdate(bool brewing)
+{
+  bool want = webSerialReady && (brewing || connecting);
+  if (want == quiet)
+    return;
+
+  if (want) {
+    esp_coex_preference_set(ESP_COEX_PREFER_BT);
+    WiFi.setSleep(WIFI_PS_MAX_MODEM);
+    quietSinceMs = millis();
+    skippedAtEntry = skippedLines.value();
+    quietPeriods.add();
+    quiet = true;
+    LOG_DEBUG(TAG, "Wi-Fi quiet (%s)", brewing ? "shot" : "scale connecting");
+  } else {
+    quiet = false;
+    WiFi.setSleep(WIFI_PS_MIN_MODEM);
+    esp_coex_preference_set(ESP_COEX_PREFER_BALANCE);
+    LOG_DEBUG(TAG, "Wi-Fi resumed after %lums, %lu WebSerial lines skipped (USB has them)",
+              millis() - quietSinceMs, (unsigned long)(skippedLines.value() - skippedAtEntry));
+  }
+}
+
+bool wifiCoexQuiet()
+{
+  return quiet;
+}
+
+void wifiCoexNoteSample(uint32_t nowMs)
+{
+  uint32_t previous = lastSampleMs;
+  lastSampleMs = nowMs ? nowMs : 1;
+  if (previous == 0 || !webSerialReady)
+    return;
+
+  uint32_t gap = nowMs - previous;
+  if (gap <= WIFI_COEX_GAP_MS)
+    return;
+  (quiet ? quietGaps : normalGaps).add();
+  lastGap.set((int32_t)gap);
+}
+
+void wifiCoexSkippedLine()
+{
+  skippedLines.add();
+}
+
+bool wifiCoexDeferRequest(AsyncWebServerRequest *request)
+{
+  if (!quiet)
+    return false;
+  deferredRequests.add();
+  AsyncWebServerResponse *response = request->beginResponse(503, "text/plain", "Shot or scale connection running - retry later\n");
+  response->addHeader("Retry-After", String(WIFI_COEX_RETRY_AFTER_S));
+  request->send(response);
+  return true;
+}
+
+void wifiCoexDump(Print &out)
+{
+  out.printf("Coex: %s, %lu quiet periods, %lu WebSerial lines skipped, %lu HTTP deferred\n",
+             quiet ? "quiet" : "balanced", (unsigned long)quietPeriods.value(),
+             (unsigned long)skippedLines.value(), (unsigned long)deferredRequests.value());
+  out.printf("Sample gaps > %lums: %lu balanced, %lu quiet (last %ldms)\n", (unsigned long)WIFI_COEX_GAP_MS,
+             (unsigned long)normalGaps.value(), (unsigned long)quietGaps.value(), (long)lastGap.value());
+}
+
+#endif // WIRELESS_DEBUG
@@ -0,0 +1,94 @@
+#ifndef WIFI_COEX_H
+#define WIFI_COEX_H
+
+// =============================================================================
+// Wi-Fi / BLE Coexistence Policy
+// =============================================================================
+// Wi-Fi and BLE share the ESP32-S3 radio; the coexistence arbiter splits air
+// time between them. During a shot and while the scale link is being set up
+// every BLE event matters more than a WebSerial line, so the radio goes
+// "quiet" on Wi-Fi for the duration:
+//
+//                    normal                  quiet (shot / connecting)
+//   arbiter          ESP_COEX_PREFER_BALANCE ESP_COEX_PREFER_BT
+//   Wi-Fi sleep      WIFI_PS_MIN_MODEM       WIFI_PS_MAX_MODEM (listen interval)
+//   WebSerial        every log line          skipped (USB still gets them),
+//                                            count reported on resume
+//   HTTP             served                  new requests 503 + Retry-After,
+//                                            running exports pause
+//
+// Quiet is entered while shot.brewing (the shot log flag) or the scale state
+// machine is between CONNECTING and NOTIFICATIONS - scanning alone does not
+// count, with no scale around it would never end. It is left as soon as
+// both are over.
+//
+// Gaps between weight samples longer than WIFI_COEX_GAP_MS are counted
+// while Wi-Fi is up, split by radio mode, so the effect of the policy shows
+// in "metrics": wifi_coex_gaps_total (normal), wifi_coex_quiet_gaps_total.
+//
+// Only active with -DWIRELESS_DEBUG (the only builds with Wi-Fi); otherwise
+// every call is an inline no-op.
+//
+// Thread Safety:
+//   wifiCoexSetConnecting() and wifiCoexNoteSample() - BLE task (Core 0).
+//   wifiCoexUpdate() - UI task (Core 1), the only caller of the Wi-Fi APIs.
+//   wifiCoexQuiet() - any task (single load).
+// =============================================================================
+
+#include <Arduino.h>
+
+constexpr uint32_t WIFI_COEX_GAP_MS         = 300;   // Sample gap counted as a dropout (scales send 5-10 Hz)
+constexpr uint32_t WIFI_COEX_RETRY_AFTER_S  = 30;    // Retry-After on deferred HTTP requests
+
+class AsyncWebServerRequest;
+
+#ifdef WIRELESS_DEBUG
+
+/**
+ * @brief Scale link setup in progress (BLE task, from the connection state callback)
+ */
+void wifiCoexSetConnecting(bool connecting);
+
+/**
+ * @brief Enter / leave quiet mode as the shot and connection state require; call every UI task pass
+ */
+void wifiCoexUpdate(bool brewing);
+
+/**
+ * @brief True while Wi-Fi traffic is held back
+ */
+bool wifiCoexQuiet();
+
+/**
+ * @brief A weight sample arrived at `nowMs` (BLE task) - counts gaps while Wi-Fi is up
+ */
+void wifiCoexNoteSample(uint32_t nowMs);
+
+/**
+ * @brief Log line not sent to WebSerial because of quiet mode (log drain task)
+ */
+void wifiCoexSkippedLine();
+
+/**
+ * @brief Answer `request` with 503 + Retry-After if quiet; true when it was deferred
+ */
+bool wifiCoexDeferRequest(AsyncWebServerRequest *request);
+
+/**
+ * @brief Mode, quiet periods, skipped lines and gap counts
+ */
+void wifiCoexDump(Print &out);
+
+#else
+
+inline void wifiCoexSetConnecting(bool) {}
+inline void wifiCoexUpdate(bool) {}
+inline bool wifiCoexQuiet() { return false; }
+inline void wifiCoexNoteSample(uint32_t) {}
+inline void wifiCoexSkippedLine() {}
+inline bool wifiCoexDeferRequest(AsyncWebServerRequest *) { return false; }
+inline void wifiCoexDump(Print &) {}
+
+#endif // WIRELESS_DEBUG
+
+#endif // WIFI_COEX_H
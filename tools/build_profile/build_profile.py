@@ -0,0 +1,154 @@
+#!/usr/bin/env python3
+"""Optimisation profile and size summary for the firmware build.
+
+PlatformIO extra script of the release / profile environments
+(src/build_profile.h). It reads two options from the environment:
+
+  custom_optimize = O2     replace the framework's -Os (O1 / O2 / O3 / Os)
+  custom_lto = yes         -flto for compile and link; archives go through
+                           gcc-ar so their LTO objects keep a symbol index
+
+The prebuilt SDK libraries are not LTO objects: link-time optimisation
+covers this firmware, its libraries and the Arduino core. GS_BUILD_OPT and
+GS_BUILD_LTO tell the firmware what it was built with ("build" command).
+
+After every link it prints the size summary: internal RAM (.iram0, .dram0),
+flash code and constants, the image in the app slot of partitions.csv, and
+the change since the previous build of the same environment (kept in
+$BUILD_DIR/size_summary.json).
+
+The summary also works on its own:
+  tools/build_profile/build_profile.py .pio/build/gravimetric_shots_release/firmware.elf
+  tools/build_profile/build_profile.py firmware.elf --base other/firmware.elf
+
+Only the standard library is needed.
+"""
+
+import argparse
+import json
+import os
+import struct
+import sys
+
+APP_SLOT = "app0"   # partitions.csv entry the image has to fit
+
+
+def elf_sections(path):
+    """Sizes of the allocated sections of a little-endian ELF32 file."""
+    with open(path, "rb") as f:
+        data = f.read()
+    if data[:4] != b"\x7fELF" or data[4] != 1 or data[5] != 1:
+        raise ValueError("%s: not a little-endian ELF32 file" % path)
+    shoff, = struct.unpack_from("<I", data, 0x20)
+    shentsize, shnum, shstrndx = struct.unpack_from("<HHH", data, 0x2E)
+    headers = [struct.unpack_from("<IIIIII", data, shoff + i * shentsize) for i in range(shnum)]
+    strtab = headers[shstrndx][4]
+    sizes = {}
+    for name, _type, flags, _addr, _offset, size in headers:
+        if flags & 0x2:  # SHF_ALLOC
+            end = data.index(b"\0", strtab + name)
+            label = data[strtab + name:end].decode("ascii", "replace")
+            sizes[label] = sizes.get(label, 0) + size
+    return sizes
+
+
+def groups(sizes):
+    """The lines of the summary: name -> bytes."""
+    def total(*prefixes):
+        return sum(v for k, v in sizes.items() if k.startswith(prefixes))
+    return {
+        "IRAM code": total(".iram0"),
+        "DRAM data + bss": total(".dram0"),
+        "internal RAM": total(".iram0", ".dram0"),
+        "flash code": total(".flash.text"),
+        "flash constants": total(".flash.rodata", ".flash.appdesc"),
+        "PSRAM bss": total(".ext_ram"),
+    }
+
+
+def app_slot(project_dir):
+    """Size of the APP_SLOT partition in partitions.csv, or None."""
+    path = os.path.join(project_dir, "partitions.csv")
+    try:
+        with open(path) as f:
+            for line in f:
+                fields = [x.strip() for x in line.split("#")[0].split(",")]
+                if len(fields) >= 5 and fields[0] == APP_SLOT:
+                    return int(fields[4], 0)
+    except OSError:
+        pass
+    return None
+
+
+def summary(name, elf, image=None, slot=None, previous=None):
+    lines = groups(elf_sections(elf))
+    if image and os.path.exists(image):
+        lines["app image"] = os.path.getsize(image)
+    print("Size summary (%s):" % name)
+    for label, value in lines.items():
+        delta = ""
+        if previous and label in previous:
+            delta = "  %+8d" % (value - previous[label])
+        extra = ""
+        if label == "app image" and slot:
+            extra = "  %d%% of %s" % (value * 100 // slot, APP_SLOT)
+        print("  %-16s %9d%s%s" % (label, value, delta, extra))
+    return lines
+
+
+def apply_profile(env):
+    optimize = env.GetProjectOption("custom_optimize", "").strip()
+    lto = env.GetProjectOption("custom_lto", "no").lower() in ("1", "yes", "true")
+    if optimize:
+        flag = "-" + optimize
+        for key in ("CCFLAGS", "CFLAGS", "CXXFLAGS", "LINKFLAGS"):
+            env.Replace(**{key: [f for f in env.get(key, []) if not (isinstance(f, str) and f.startswith("-O"))]})
+        env.Append(CCFLAGS=[flag], LINKFLAGS=[flag])
+        env.Append(CPPDEFINES=[("GS_BUILD_OPT", '\\"%s\\"' % flag)])
+    if lto:
+        env.Append(CCFLAGS=["-flto"], LINKFLAGS=["-flto"])
+        env.Replace(AR=env.subst("$AR").replace("-ar", "-gcc-ar"),
+                    RANLIB=env.subst("$RANLIB").replace("-ranlib", "-gcc-ranlib"))
+        env.Append(CPPDEFINES=[("GS_BUILD_LTO", 1)])
+
+
+def after_link(source, target, env):
+    build = env.subst("$BUILD_DIR")
+    state = os.path.join(build, "size_summary.json")
+    previous = None
+    try:
+        with open(state) as f:
+            previous = json.load(f)
+    except (OSError, ValueError):
+        pass
+    elf = target[0].get_abspath()
+    image = os.path.join(build, env.subst("${PROGNAME}.bin"))
+    lines = summary(env.subst("$PIOENV"), elf, image, app_slot(env.subst("$PROJECT_DIR")), previous)
+    with open(state, "w") as f:
+        json.dump(lines, f)
+
+
+try:
+    Import("env")  # noqa: F821 - PlatformIO / SCons
+except NameError:
+    env = None
+
+if env is not None:
+    apply_profile(env)
+    env.AddPostAction("$BUILD_DIR/${PROGNAME}.bin", after_link)
+elif __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Size summary of a firmware ELF")
+    parser.add_argument("elf", help="firmware ELF (firmware.bin next to it is reported too)")
+    parser.add_argument("--base", help="ELF to compare with")
+    args = parser.parse_args()
+    root = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "..")
+    try:
+        base = groups(elf_sections(args.base)) if args.base else None
+        if base and args.base:
+            base_image = os.path.splitext(args.base)[0] + ".bin"
+            if os.path.exists(base_image):
+                base["app image"] = os.path.getsize(base_image)
+        summary(os.path.basename(os.path.dirname(os.path.abspath(args.elf))) or args.elf, args.elf,
+                os.path.splitext(args.elf)[0] + ".bin", app_slot(root), base)
+    except (OSError, ValueError) as e:
+        sys.exit("build_profile: %s" % e)
@@ -0,0 +1,335 @@
+// =============================================================================
+// Core Bench - per-sample cost of the platform-free hot paths on a host
+// =============================================================================
+// Times the code every weight notification runs through, with the firmware's
+// own sources and no BLE, FreeRTOS or LVGL:
+//
+//   notification ──► FrameParser (framed drivers) ──► ScaleDriver::parse()
+//                ──► SampleClock::update() ──► ShotPredictor::add() + expectedEnd()
+//
+//   clock        SampleClock on jittered 100 ms arrivals
+//   parse/*      ScaleDriver::parse() of one weight packet per driver
+//   frames/*     FrameParser::feed() on one frame per notification, merged
+//                pairs and frames split in two
+//   predictor/*  ShotPredictor::add() + expectedEnd() per estimator over a
+//                synthetic 30 s shot (drip, ramp, steady flow, noise)
+//
+// --kernels runs the platform-free MicroBenchCase kernels of micro_bench.cpp
+// instead, one call at a time: min / median / p99 / max ns per call.
+//
+// Each case runs --runs times over its input; the best run counts (least
+// disturbed by the host), reported as ns per sample. Host numbers are not
+// ESP32 numbers, but a change that makes a hot path slower shows up here
+// before it is flashed - compare the table before and after.
+//
+// Build: pio run -e core_bench   (or see tools/core_bench/README.md)
+// =============================================================================
+
+#include <Arduino.h>
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include "ScaleDriver.h"
+#include "FrameParser.h"
+#include "sample_clock.h"
+#include "shot_predictor.h"
+#include "micro_bench.h"
+
+constexpr uint32_t BENCH_SAMPLES   = 20000;    // Inputs per case and run
+constexpr int      BENCH_RUNS      = 15;
+constexpr float    PACKET_PERIOD_S = 0.1f;     // Acaia notification rate
+constexpr float    SHOT_LENGTH_S   = 30.0f;
+constexpr float    GOAL_G          = 36.0f;
+
+typedef std::chrono::steady_clock Clock;
+
+static volatile int64_t sink = 0;   // Keeps results alive through the optimiser
+
+struct BenchResult {
+  const char *name;
+  double bestNs;
+  double meanNs;
+};
+
+// Deterministic noise, so every run and every build sees the same inputs
+static uint32_t rngState = 12345;
+
+static float noise()
+{
+  rngState = rngState * 1664525u + 1013904223u;
+  return ((rngState >> 8) / 16777216.0f) - 0.5f;
+}
+
+// -----------------------------------------------------------------------------
+// Inputs
+// -----------------------------------------------------------------------------
+
+// 0xEF 0xDD weight event as a new Lunar / Pyxis sends it (0.01 g)
+static uint8_t acaiaNewWeight(int32_t cg, uint8_t *out)
+{
+  uint32_t raw = (uint32_t)abs(cg);
+  const uint8_t frame[13] = {0xef, 0xdd, 0x0c, 0x08, 0x05, (uint8_t)raw, (uint8_t)(raw >> 8), 0x00, 0x00, 0x02,
+                             (uint8_t)(cg < 0 ? 0x02 : 0x00), 0x00, 0x00};
+  memcpy(out, frame, sizeof(frame));
+  for (uint8_t i = 3; i < 11; i++)
+    out[11 + ((i - 3) & 1)] += out[i];
+  return sizeof(frame);
+}
+
+// 10-byte weight packet of the old Lunar (0.1 g)
+static uint8_t acaiaOldWeight(int32_t cg, uint8_t *out)
+{
+  uint32_t raw = (uint32_t)abs(cg) / 10;
+  const uint8_t packet[10] = {0xef, 0xdd, (uint8_t)raw, (uint8_t)(raw >> 8), 0x00, 0x00, 0x01,
+                              (uint8_t)(cg < 0 ? 0x02 : 0x00), 0x00, 0x00};
+  memcpy(out, packet, sizeof(packet));
+  return sizeof(packet);
+}
+
+// Felicita ASCII packet: sign, six digits of centigrams
+static uint8_t felicitaWeight(int32_t cg, uint8_t *out)
+{
+  char text[24];
+  snprintf(text, sizeof(text), "\x01\x02%c%06ld g  %3u\r\n", cg < 0 ? '-' : '+', (long)abs(cg), 80u);
+  memcpy(out, text, 18);
+  return 18;
+}
+
+// A shot as the scale reports it: drips from 4 s, ramp to 2 g/s by 8 s, then steady
+static std::vector<float> shotWeights()
+{
+  std::vector<float> grams;
+  float weight = 0.0f;
+  for (float t = 0.0f; t < SHOT_LENGTH_S; t += PACKET_PERIOD_S) {
+    float flow = (t < 4.0f) ? 0.0f : (t < 8.0f) ? 2.0f * (t - 4.0f) / 4.0f : 2.0f;
+    weight += flow * PACKET_PERIOD_S;
+    grams.push_back(weight + noise() * 0.1f);
+  }
+  return grams;
+}
+
+static std::vector<ScalePacket> weightPackets(uint8_t (*encode)(int32_t, uint8_t *))
+{
+  std::vector<float> grams = shotWeights();
+  std::vector<ScalePacket> packets(grams.size());
+  for (size_t i = 0; i < grams.size(); i++)
+    packets[i].length = encode((int32_t)lroundf(grams[i] * 100.0f), packets[i].data);
+  return packets;
+}
+
+// -----------------------------------------------------------------------------
+// Cases
+// -----------------------------------------------------------------------------
+
+// Best and mean of `runs` runs of body(), each handling `count` samples
+template <typename Body>
+static BenchResult measure(const char *name, uint32_t count, int runs, Body body)
+{
+  double best = 1e18;
+  double total = 0.0;
+  for (int run = 0; run < runs; run++) {
+    Clock::time_point start = Clock::now();
+    body();
+    double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / count;
+    best = min(best, ns);
+    total += ns;
+  }
+  return BenchResult{name, best, total / runs};
+}
+
+static BenchResult benchClock(int runs)
+{
+  std::vector<int64_t> arrivals(BENCH_SAMPLES);
+  for (uint32_t i = 0; i < BENCH_SAMPLES; i++)
+    arrivals[i] = 1000000 + (int64_t)i * 100000 + (int64_t)((noise() + 0.5f) * 30000);   // 0-30 ms late
+
+  return measure("clock", BENCH_SAMPLES, runs, [&]() {
+    SampleClock clock;
+    int64_t last = 0;
+    for (uint32_t i = 0; i < BENCH_SAMPLES; i++)
+      last = clock.update(arrivals[i]);
+    sink = sink + last;
+  });
+}
+
+static BenchResult benchParse(const char *name, const ScaleDriver *driver, uint8_t (*encode)(int32_t, uint8_t *), int runs)
+{
+  std::vector<ScalePacket> packets = weightPackets(encode);
+  uint32_t count = (uint32_t)packets.size() * (BENCH_SAMPLES / packets.size());
+
+  return measure(name, count, runs, [&]() {
+    ScaleMessage message;
+    int64_t total = 0;
+    for (uint32_t n = 0; n < BENCH_SAMPLES / packets.size(); n++) {
+      for (size_t i = 0; i < packets.size(); i++) {
+        driver->parse(packets[i], &message);
+        total += message.weightCg;
+      }
+    }
+    sink = sink + total;
+  });
+}
+
+// `perPacket` frames per notification (2 = merged), or each frame split in two (perPacket 0)
+static BenchResult benchFrames(const char *name, int perPacket, int runs)
+{
+  std::vector<ScalePacket> frames = weightPackets(acaiaNewWeight);
+  std::vector<ScalePacket> packets;
+  for (size_t i = 0; i < frames.size(); i++) {
+    if (perPacket == 0) {
+      ScalePacket head = frames[i], tail = frames[i];
+      head.length = 5;
+      tail.length = frames[i].length - 5;
+      memmove(tail.data, frames[i].data + 5, tail.length);
+      packets.push_back(head);
+      packets.push_back(tail);
+    } else if (i % perPacket == 0) {
+      packets.push_back(frames[i]);
+    } else {
+      ScalePacket &last = packets.back();
+      memcpy(last.data + last.length, frames[i].data, frames[i].length);
+      last.length += frames[i].length;
+    }
+  }
+  uint32_t repeats = BENCH_SAMPLES / frames.size();
+
+  return measure(name, (uint32_t)frames.size() * repeats, runs, [&]() {
+    FrameParser parser;
+    ScalePacket frame;
+    int64_t total = 0;
+    for (uint32_t n = 0; n < repeats; n++) {
+      for (size_t i = 0; i < packets.size(); i++) {
+        uint8_t offset = 0;
+        while (parser.feed(packets[i], &offset, &frame))
+          total += frame.length;
+      }
+    }
+    sink = sink + total;
+  });
+}
+
+static BenchResult benchPredictor(const char *name, uint8_t estimator, int runs)
+{
+  std::vector<float> grams = shotWeights();
+  uint32_t repeats = BENCH_SAMPLES / grams.size();
+
+  return measure(name, (uint32_t)grams.size() * repeats, runs, [&]() {
+    ShotPredictor predictor;
+    float total = 0.0f;
+    for (uint32_t n = 0; n < repeats; n++) {
+      predictor.reset();
+      predictor.select(estimator);
+      for (size_t i = 0; i < grams.size(); i++) {
+        predictor.add(i * PACKET_PERIOD_S, grams[i]);
+        total += predictor.expectedEnd(GOAL_G, 1.5f, 0.3f);
+      }
+    }
+    sink = sink + (int64_t)total;
+  });
+}
+
+// -----------------------------------------------------------------------------
+// Main
+// -----------------------------------------------------------------------------
+
+// Cases whose name contains --filter (all without one)
+static bool wanted(const char *filter, const char *name)
+{
+  return filter == NULL || strstr(name, filter) != NULL;
+}
+
+static void usage()
+{
+  printf("usage: core_bench [--runs N] [--filter NAME] [--csv] [--kernels [N]]\n");
+}
+
+// Per-call timing of the micro_bench.cpp kernels (N calls each)
+static int runKernels(const char *filter, uint32_t iterations, bool csv)
+{
+  char line[96];
+  if (csv)
+    printf("kernel,n,min_ns,median_ns,p99_ns,max_ns\n");
+  else
+    printf(MICRO_BENCH_HEADER);
+  for (const MicroBenchCase *c = MicroBenchCase::head(); c != NULL; c = c->next) {
+    if (!wanted(filter, c->name))
+      continue;
+    MicroBenchResult r = microBenchRun(*c, iterations, false);
+    if (csv) {
+      printf("%s,%lu,%lu,%lu,%lu,%lu\n", r.name, (unsigned long)r.iterations, (unsigned long)r.min,
+             (unsigned long)r.median, (unsigned long)r.p99, (unsigned long)r.max);
+    } else {
+      microBenchFormat(r, line, sizeof(line));
+      fputs(line, stdout);
+    }
+  }
+  return 0;
+}
+
+int main(int argc, char **argv)
+{
+  int runs = BENCH_RUNS;
+  const char *filter = NULL;
+  bool csv = false;
+  bool kernels = false;
+  uint32_t kernelIterations = MICRO_BENCH_MAX_ITERATIONS;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--runs") == 0 && i + 1 < argc) {
+      runs = max(1, atoi(argv[++i]));
+    } else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+      filter = argv[++i];
+    } else if (strcmp(argv[i], "--csv") == 0) {
+      csv = true;
+    } else if (strcmp(argv[i], "--kernels") == 0) {
+      kernels = true;
+      if (i + 1 < argc && argv[i + 1][0] != '-')
+        kernelIterations = (uint32_t)max(1, atoi(argv[++i]));
+    } else {
+      usage();
+      return 1;
+    }
+  }
+
+  if (kernels)
+    return runKernels(filter, kernelIterations, csv);
+
+  size_t driverCount;
+  const ScaleDriver *const *drivers = scaleDrivers(&driverCount);   // Acaia old, Acaia new, Felicita
+
+  std::vector<BenchResult> results;
+  if (wanted(filter, "clock"))
+    results.push_back(benchClock(runs));
+  if (wanted(filter, "parse/acaia_old"))
+    results.push_back(benchParse("parse/acaia_old", drivers[0], acaiaOldWeight, runs));
+  if (wanted(filter, "parse/acaia_new"))
+    results.push_back(benchParse("parse/acaia_new", drivers[1], acaiaNewWeight, runs));
+  if (wanted(filter, "parse/felicita"))
+    results.push_back(benchParse("parse/felicita", drivers[2], felicitaWeight, runs));
+  if (wanted(filter, "frames/single"))
+    results.push_back(benchFrames("frames/single", 1, runs));
+  if (wanted(filter, "frames/merged"))
+    results.push_back(benchFrames("frames/merged", 2, runs));
+  if (wanted(filter, "frames/split"))
+    results.push_back(benchFrames("frames/split", 0, runs));
+  if (wanted(filter, "predictor/linear"))
+    results.push_back(benchPredictor("predictor/linear", STOP_ESTIMATOR_LINEAR, runs));
+  if (wanted(filter, "predictor/quadratic"))
+    results.push_back(benchPredictor("predictor/quadratic", STOP_ESTIMATOR_QUADRATIC, runs));
+  if (wanted(filter, "predictor/model"))
+    results.push_back(benchPredictor("predictor/model", STOP_ESTIMATOR_MODEL, runs));
+
+  if (csv)
+    printf("case,best_ns,mean_ns\n");
+  else
+    printf("%-22s %10s %10s   (ns per sample, best / mean of %d runs)\n", "case", "best", "mean", runs);
+  for (size_t i = 0; i < results.size(); i++) {
+    const BenchResult &r = results[i];
+    if (csv)
+      printf("%s,%.1f,%.1f\n", r.name, r.bestNs, r.meanNs);
+    else
+      printf("%-22s %10.1f %10.1f\n", r.name, r.bestNs, r.meanNs);
+  }
+  return 0;
+}
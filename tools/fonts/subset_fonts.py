@@ -0,0 +1,207 @@
+#!/usr/bin/env python3
+"""Cut the built-in Montserrat fonts down to the glyphs the UI can show.
+
+PlatformIO pre-script for the gravimetric_shots_fonts environment, and a
+report on the command line. For every Montserrat size enabled in
+lib/lv_conf.h it works out a character set:
+
+  full ASCII   the default font (LV_FONT_DEFAULT) and any size src/ sets on
+               its own labels: status text, BLE scale names, shot history
+               rows - runtime strings (display_bench.cpp excepted, its text
+               is a literal)
+  subset       sizes only the SquareLine screens use: the text of those
+               screens, label text literals in src/, and VALUE_CHARS for
+               the numbers the firmware formats into them
+
+plus, for every size, the LV_SYMBOL_* glyphs src/, lib/ui and the LVGL
+widgets they create refer to, and any non-ASCII character in those
+literals. The fonts are regenerated with lv_font_conv
+(npm i -g lv_font_conv, or found through npx) from the TTF / WOFF files
+LVGL ships in lib/lvgl/scripts/built_in_font, with the options of
+LVGL's own built-ins, into the build directory. LVGL's full copies
+(lib/lvgl/src/font/lv_font_montserrat_*.c) are left out of the build.
+The symbols keep their names, so lib/ui needs no change.
+
+  python3 tools/fonts/subset_fonts.py                  report only
+  python3 tools/fonts/subset_fonts.py --out fonts/     generate into fonts/
+  pio run -e gravimetric_shots_fonts                   generate + build
+
+custom_font_compress = yes (platformio.ini) RLE-compresses the bitmaps
+and builds LVGL with LV_USE_FONT_COMPRESSED: smaller again, but each
+glyph is decompressed when drawn (the value digits come from
+src/glyph_tiles.h and are decoded once).
+
+Only the standard library is needed (plus lv_font_conv to generate).
+"""
+
+import argparse
+import glob
+import json
+import os
+import re
+import shutil
+import subprocess
+import sys
+
+VALUE_CHARS = " 0123456789.,:+-%/"
+BPP = 4
+
+FONT_REF = re.compile(r"lv_font_montserrat_(\d+)")
+ENABLED = re.compile(r"^\s*#define\s+LV_FONT_MONTSERRAT_(\d+)\s+1\b", re.M)
+DEFAULT = re.compile(r"^\s*#define\s+LV_FONT_DEFAULT\s+&lv_font_montserrat_(\d+)", re.M)
+LITERAL = re.compile(r'"((?:[^"\\\n]|\\.)*)"')
+LABEL_TEXT = re.compile(r'lv_label_set_text(?:_static|_fmt)?\s*\([^,]+,\s*"((?:[^"\\\n]|\\.)*)"')
+SYMBOL_REF = re.compile(r"\bLV_SYMBOL_([A-Z0-9_]+)")
+SYMBOL_DEF = re.compile(r'#define\s+LV_SYMBOL_([A-Z0-9_]+)\s+"[^"]*"\s*/\*\s*(\d+)')
+CREATE = re.compile(r"\blv_([a-z0-9]+)_create\s*\(")
+
+
+def read(path):
+    with open(path, encoding="utf-8", errors="replace") as f:
+        return f.read()
+
+
+def unescape(literal):
+    raw = literal.encode("utf-8").decode("unicode_escape").encode("latin-1")
+    return raw.decode("utf-8", errors="ignore")
+
+
+def sources(root):
+    ui = sorted(glob.glob(os.path.join(root, "lib/ui/src/**/*.c"), recursive=True))
+    fw = sorted(glob.glob(os.path.join(root, "src/*.cpp")) + glob.glob(os.path.join(root, "src/*.ino")) +
+                glob.glob(os.path.join(root, "src/*.h")))
+    return ui, fw
+
+
+def symbol_table(root):
+    return {name: int(cp) for name, cp in SYMBOL_DEF.findall(read(os.path.join(root, "lib/lvgl/src/font/lv_symbol_def.h")))}
+
+
+def used_symbols(root, texts):
+    """LV_SYMBOL_* named in our sources and in the sources of the LVGL widgets we create."""
+    names = set()
+    widgets = set()
+    for text in texts:
+        names.update(SYMBOL_REF.findall(text))
+        widgets.update(CREATE.findall(text))
+    for widget in sorted(widgets):
+        for path in glob.glob(os.path.join(root, "lib/lvgl/src/**/lv_%s.c" % widget), recursive=True):
+            names.update(SYMBOL_REF.findall(read(path)))
+    table = symbol_table(root)
+    return sorted({table[n] for n in names if n in table})
+
+
+def plan(root):
+    """{size: {"ascii": bool, "chars": str, "symbols": [codepoints]}} for the enabled sizes."""
+    conf = read(os.path.join(root, "lib/lv_conf.h"))
+    sizes = sorted(int(s) for s in ENABLED.findall(conf))
+    default = DEFAULT.search(conf)
+    ascii_sizes = {int(default.group(1))} if default else set()
+
+    ui, fw = sources(root)
+    ui_text = [read(p) for p in ui]
+    fw_text = {p: read(p) for p in fw}
+    for path, text in fw_text.items():
+        if os.path.basename(path) != "display_bench.cpp":
+            ascii_sizes.update(int(s) for s in FONT_REF.findall(text))
+
+    shown = set(VALUE_CHARS)
+    for text in ui_text:
+        for lit in LITERAL.findall(text):
+            shown.update(unescape(lit))
+    for text in fw_text.values():
+        for lit in LABEL_TEXT.findall(text):
+            shown.update(unescape(lit))
+    shown = {c for c in shown if c.isprintable() and not 0xE000 <= ord(c) <= 0xF8FF}
+    extra = {c for c in shown if ord(c) > 0x7E}
+    symbols = used_symbols(root, ui_text + list(fw_text.values()))
+
+    result = {}
+    for size in sizes:
+        if size in ascii_sizes:
+            chars = "".join(chr(c) for c in range(0x20, 0x7F)) + "".join(sorted(extra))
+        else:
+            chars = "".join(sorted(shown))
+        result[size] = {"ascii": size in ascii_sizes, "chars": chars, "symbols": symbols}
+    return result
+
+
+def ranges(chars):
+    return ",".join("0x%X" % ord(c) for c in chars)
+
+
+def converter():
+    tool = shutil.which("lv_font_conv")
+    if tool:
+        return [tool]
+    npx = shutil.which("npx")
+    if npx:
+        return [npx, "--yes", "lv_font_conv"]
+    sys.exit("subset_fonts: lv_font_conv not found (npm i -g lv_font_conv)")
+
+
+def generate(root, out, fonts, compress):
+    """Write lv_font_montserrat_<size>.c into `out`; skipped when the stamp matches."""
+    os.makedirs(out, exist_ok=True)
+    stamp_path = os.path.join(out, "subset.json")
+    stamp = {"bpp": BPP, "compress": compress, "fonts": {str(k): v for k, v in fonts.items()}}
+    if os.path.exists(stamp_path) and json.loads(read(stamp_path)) == stamp and all(
+            os.path.exists(os.path.join(out, "lv_font_montserrat_%d.c" % s)) for s in fonts):
+        return
+
+    ttf = os.path.join(root, "lib/lvgl/scripts/built_in_font")
+    tool = converter()
+    for size, font in fonts.items():
+        path = os.path.join(out, "lv_font_montserrat_%d.c" % size)
+        cmd = tool + ["--bpp", str(BPP), "--size", str(size), "--format", "lvgl", "--force-fast-kern-format",
+                      "--lv-include", "lvgl.h", "-o", path,
+                      "--font", os.path.join(ttf, "Montserrat-Medium.ttf"), "-r", ranges(font["chars"])]
+        if font["symbols"]:
+            cmd += ["--font", os.path.join(ttf, "FontAwesome5-Solid+Brands+Regular.woff"),
+                    "-r", ",".join(str(cp) for cp in font["symbols"])]
+        if not compress:
+            cmd += ["--no-compress", "--no-prefilter"]
+        print("subset_fonts: Montserrat %d px, %d glyphs" % (size, len(font["chars"]) + len(font["symbols"])))
+        subprocess.check_call(cmd)
+    with open(stamp_path, "w") as f:
+        json.dump(stamp, f, indent=1)
+
+
+def report(fonts):
+    for size, font in fonts.items():
+        kind = "full ASCII" if font["ascii"] else "subset"
+        chars = "" if font["ascii"] else ": " + font["chars"]
+        print("Montserrat %2d  %-10s %3d glyphs + %d symbols%s" %
+              (size, kind, len(font["chars"]), len(font["symbols"]), chars))
+
+
+def skip(node):
+    return None
+
+
+try:
+    Import("env")  # noqa: F821 - PlatformIO / SCons
+except NameError:
+    env = None
+
+if env is not None:
+    root = env.subst("$PROJECT_DIR")
+    compress = env.GetProjectOption("custom_font_compress", "no").lower() in ("1", "yes", "true")
+    out = os.path.join(env.subst("$BUILD_DIR"), "fonts_subset")
+    fonts = plan(root)
+    generate(root, out, fonts, compress)
+    for size in fonts:
+        env.AddBuildMiddleware(skip, "*/lvgl/src/font/lv_font_montserrat_%d.c" % size)
+    env.BuildSources(os.path.join("$BUILD_DIR", "fonts_subset_obj"), out)
+    if compress:
+        env.Append(CPPDEFINES=[("LV_USE_FONT_COMPRESSED", 1)])
+elif __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Subset the built-in Montserrat fonts to the glyphs the UI shows")
+    parser.add_argument("--root", default=os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", ".."))
+    parser.add_argument("--out", help="generate the font sources into this directory")
+    parser.add_argument("--compress", action="store_true", help="RLE-compress the bitmaps (LV_USE_FONT_COMPRESSED 1)")
+    args = parser.parse_args()
+    fonts = plan(os.path.abspath(args.root))
+    report(fonts)
+    if args.out:
+        generate(os.path.abspath(args.root), args.out, fonts, args.compress)
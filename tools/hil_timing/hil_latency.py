@@ -0,0 +1,209 @@
+#!/usr/bin/env python3
+"""Latency distributions from a logic analyser capture of the timing probes.
+
+Firmware built with -DGS_GPIO_PROBE=1 drives four spare pins (src/gpio_probe.h):
+
+  packet  toggles when a scale notification arrives
+  decide  toggles when the control task has processed that weight sample and
+          re-armed (or cancelled) the relay cut
+  relay   copy of the RELAY1 output
+  dma     high while a display window's DMA runs
+
+Capture them with any logic analyser and export CSV: sigrok-cli -O csv, the
+PulseView CSV export or a Saleae Logic 2 digital export. The first column
+must be time in seconds and each further column one channel as 0/1. Rows
+per sample and rows per change both work. The script measures:
+
+  packet interval       notification to notification
+  packet -> decide      arrival to the stop decision being in place (per sample)
+  ... with DMA / idle   the same, split by a DMA window running at arrival
+  decide -> relay cut   last decision to the relay dropping (timer slack)
+  packet -> relay cut   last notification to the relay dropping
+  relay on time         pump on to relay cut, per shot
+  DMA window            DMA start to end
+
+Usage:
+  tools/hil_timing/hil_latency.py capture.csv
+  tools/hil_timing/hil_latency.py capture.csv --packet D0 --decide D1 --relay D2 --dma D3
+  tools/hil_timing/hil_latency.py capture.csv --csv > summary.csv
+  tools/hil_timing/hil_latency.py capture.csv --events pairs.csv
+
+Channels are picked by header name or 0-based data column index. The default
+is the first four columns in the order above. Only the standard library is
+needed.
+"""
+
+import argparse
+import bisect
+import csv
+import sys
+
+CHANNELS = ("packet", "decide", "relay", "dma")
+MAX_PAIR_S = 1.0   # A decision more than this after a packet belongs to no packet
+
+
+def read_capture(path, columns):
+    """Edges per channel: {name: [(time_s, level), ...]}, first level included."""
+    with open(path, newline="") as f:
+        rows = [row for row in csv.reader(f) if row and not row[0].lstrip().startswith(";")]
+    if not rows:
+        raise ValueError("%s: no data" % path)
+
+    header = None
+    try:
+        float(rows[0][0])
+    except ValueError:
+        header = [h.strip() for h in rows[0]]
+        rows = rows[1:]
+
+    index = {}
+    for n, name in enumerate(CHANNELS):
+        wanted = columns.get(name)
+        if wanted is None:
+            index[name] = n + 1
+        elif wanted.isdigit():
+            index[name] = int(wanted) + 1
+        elif header and wanted in header:
+            index[name] = header.index(wanted)
+        else:
+            raise ValueError("channel %s: no column %r in %s" % (name, wanted, header))
+
+    edges = {name: [] for name in CHANNELS}
+    for row in rows:
+        t = float(row[0])
+        for name in CHANNELS:
+            column = index[name]
+            if column >= len(row) or row[column].strip() == "":
+                continue
+            level = int(float(row[column])) != 0
+            series = edges[name]
+            if not series or series[-1][1] != level:
+                series.append((t, level))
+    return edges
+
+
+def changes(series):
+    """Times of the edges after the first (recorded) level."""
+    return [t for t, _ in series[1:]]
+
+
+def falling(series):
+    return [t for t, level in series[1:] if not level]
+
+
+def rising(series):
+    return [t for t, level in series[1:] if level]
+
+
+def windows(series):
+    """(start, end) of each high period that starts and ends in the capture."""
+    out = []
+    start = None
+    for t, level in series[1:]:
+        if level:
+            start = t
+        elif start is not None:
+            out.append((start, t))
+            start = None
+    return out
+
+
+def latest_before(times, t):
+    i = bisect.bisect_right(times, t) - 1
+    return times[i] if i >= 0 else None
+
+
+def active_at(spans, starts, t):
+    i = bisect.bisect_right(starts, t) - 1
+    return i >= 0 and spans[i][0] <= t < spans[i][1]
+
+
+def percentile(values, p):
+    ordered = sorted(values)
+    k = (len(ordered) - 1) * p / 100.0
+    lo = int(k)
+    hi = min(lo + 1, len(ordered) - 1)
+    return ordered[lo] + (ordered[hi] - ordered[lo]) * (k - lo)
+
+
+def analyse(edges):
+    packets = changes(edges["packet"])
+    decides = changes(edges["decide"])
+    cuts = falling(edges["relay"])
+    pump_on = rising(edges["relay"])
+    dma = windows(edges["dma"])
+    dma_starts = [start for start, _ in dma]
+
+    stats = {name: [] for name in ("packet interval", "packet -> decide", "... with DMA", "... idle",
+                                   "decide -> relay cut", "packet -> relay cut", "relay on time", "DMA window")}
+    pairs = []
+
+    stats["packet interval"] = [b - a for a, b in zip(packets, packets[1:])]
+
+    used = set()
+    for d in decides:
+        p = latest_before(packets, d)
+        if p is None or d - p > MAX_PAIR_S or p in used:
+            continue
+        used.add(p)
+        during_dma = active_at(dma, dma_starts, p)
+        stats["packet -> decide"].append(d - p)
+        stats["... with DMA" if during_dma else "... idle"].append(d - p)
+        pairs.append((p, d, during_dma))
+
+    for cut in cuts:
+        d = latest_before(decides, cut)
+        if d is not None:
+            stats["decide -> relay cut"].append(cut - d)
+        p = latest_before(packets, cut)
+        if p is not None:
+            stats["packet -> relay cut"].append(cut - p)
+        on = latest_before(pump_on, cut)
+        if on is not None:
+            stats["relay on time"].append(cut - on)
+
+    stats["DMA window"] = [end - start for start, end in dma]
+    return stats, pairs
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Latency distributions from GS_GPIO_PROBE captures")
+    parser.add_argument("capture", help="logic analyser CSV export")
+    for name in CHANNELS:
+        parser.add_argument("--" + name, help="column of the %s probe (header name or data column index)" % name)
+    parser.add_argument("--csv", action="store_true", help="summary as CSV")
+    parser.add_argument("--events", help="write every packet -> decide pair to this CSV")
+    args = parser.parse_args()
+
+    try:
+        edges = read_capture(args.capture, {name: getattr(args, name) for name in CHANNELS})
+    except (OSError, ValueError) as e:
+        sys.exit("hil_latency: %s" % e)
+    stats, pairs = analyse(edges)
+
+    if args.events:
+        with open(args.events, "w", newline="") as f:
+            out = csv.writer(f)
+            out.writerow(["packet_s", "decide_s", "latency_us", "dma"])
+            for p, d, during_dma in pairs:
+                out.writerow(["%.7f" % p, "%.7f" % d, "%.1f" % ((d - p) * 1e6), int(during_dma)])
+
+    if args.csv:
+        print("measure,n,min_ms,p50_ms,p90_ms,p99_ms,max_ms")
+    else:
+        print("%-22s %6s %9s %9s %9s %9s %9s" % ("ms", "n", "min", "p50", "p90", "p99", "max"))
+    for name, values in stats.items():
+        if not values:
+            if not args.csv:
+                print("%-22s %6d %9s" % (name, 0, "-"))
+            continue
+        row = [min(values), percentile(values, 50), percentile(values, 90), percentile(values, 99), max(values)]
+        row = [v * 1000.0 for v in row]
+        if args.csv:
+            print("%s,%d,%s" % (name, len(values), ",".join("%.3f" % v for v in row)))
+        else:
+            print("%-22s %6d %9.3f %9.3f %9.3f %9.3f %9.3f" % ((name, len(values)) + tuple(row)))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,190 @@
+#!/usr/bin/env python3
+"""IRAM placement report for the firmware ELF.
+
+Checks the placement policy of src/iram_placement.h against a build: every
+function listed in POLICY below must sit in IRAM (.iram0.*) or have been
+inlined away. It also prints the internal RAM sections and the largest IRAM
+symbols, so the cost of moving code out of flash is visible - on the S3
+every IRAM byte comes out of the internal DRAM heap.
+
+Usage:
+  tools/iram_report/iram_report.py .pio/build/gravimetric_shots/firmware.elf
+  tools/iram_report/iram_report.py firmware.elf --base old/firmware.elf   (section deltas)
+  tools/iram_report/iram_report.py firmware.elf --top 40
+  tools/iram_report/iram_report.py firmware.elf --check                   (exit 1 on a policy miss)
+
+Build the base with -DGS_IRAM_HOT=0 to see what the policy costs as a whole.
+Only the standard library is needed.
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+# src/iram_placement.h, by qualified name (matched on the mangled <length><name>
+# components, so overloads and member functions of every class are found)
+POLICY = [
+    # Display DMA (AXS15231B.cpp)
+    "lcd_PushColors",
+    "lcd_PushColorsLandscape",
+    "bounce_start",
+    "bounce_fill_and_queue",
+    "lcd_rotate270_rows",
+    "lcd_queue_window",
+    "lcd_reap_window",
+    # Blend loops (draw_s3.cpp, mem_fast.cpp)
+    "blend",
+    "mixFillRow",
+    "mixCopyRow",
+    "maskFillRow",
+    "maskCopyRow",
+    "blendRows",
+    "blendSplit",
+    "claimSlice",
+    "runSlices",
+    "memFastCopy",
+    "memFastFill16",
+    "wordFill16",
+    # HCI RX (lib/ArduinoBLE) and the notification path (lib/AcaiaArduinoBLE)
+    "notify_host_recv",
+    "HCIVirtualTransportClass::available",
+    "HCIVirtualTransportClass::readPacket",
+    "HCIClass::poll",
+    "HCIClass::handleAclDataPkt",
+    "ATTClass::handleData",
+    "ATTClass::handleNotifyOrInd",
+    "BLERemoteDevice::characteristicForHandle",
+    "onReadUpdated",
+    "AcaiaArduinoBLE::newWeightAvailable",
+    "AcaiaArduinoBLE::dispatchPacket",
+    "AcaiaArduinoBLE::onWeight",
+    "AcaiaOldProtocol::parse",
+    "AcaiaNewProtocol::parse",
+    "FelicitaProtocol::parse",
+    "rawToCentigrams",
+    # Relay cut
+    "cutTimerCallback",
+]
+
+# Internal RAM sections worth a line; anything .iram0* / .dram0* counts to the total
+RAM_PREFIXES = (".iram0", ".dram0")
+OTHER_SECTIONS = (".flash.text", ".flash.rodata", ".ext_ram.bss")
+
+STT_FUNC = 2
+
+
+class Elf32:
+    """Section headers and function symbols of a little-endian ELF32 image."""
+
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            data = f.read()
+        if data[:4] != b"\x7fELF" or data[4] != 1 or data[5] != 1:
+            raise ValueError("%s: not a little-endian ELF32 file" % path)
+        shoff, = struct.unpack_from("<I", data, 0x20)
+        shentsize, shnum, shstrndx = struct.unpack_from("<HHH", data, 0x2E)
+        headers = [struct.unpack_from("<IIIIIIIIII", data, shoff + i * shentsize) for i in range(shnum)]
+
+        names = headers[shstrndx]
+        def name_at(table, offset):
+            start = table[4] + offset
+            return data[start:data.index(b"\0", start)].decode("ascii", "replace")
+
+        self.sections = []   # (name, addr, size, flags) by section index
+        for h in headers:
+            self.sections.append((name_at(names, h[0]), h[3], h[5], h[2]))
+
+        self.functions = []  # (mangled name, size, section name)
+        for h in headers:
+            if h[1] != 2:    # SHT_SYMTAB
+                continue
+            strtab = headers[h[6]]
+            for off in range(h[4], h[4] + h[5], h[9]):
+                st_name, _value, st_size, st_info, _other, st_shndx = struct.unpack_from("<IIIBBH", data, off)
+                if (st_info & 0xF) != STT_FUNC or st_shndx == 0 or st_shndx >= len(self.sections):
+                    continue
+                self.functions.append((name_at(strtab, st_name), st_size, self.sections[st_shndx][0]))
+
+    def section_sizes(self):
+        sizes = {}
+        for name, _addr, size, flags in self.sections:
+            if flags & 0x2:  # SHF_ALLOC
+                sizes[name] = sizes.get(name, 0) + size
+        return sizes
+
+
+def match(qualified, name):
+    # A C++ source name is <len><name>; plain C symbols are the name itself
+    if name == qualified:
+        return True
+    parts = ["%d%s" % (len(p), p) for p in qualified.split("::")]
+    pos = 0
+    for part in parts:
+        i = name.find(part, pos)
+        while i > 0 and name[i - 1].isdigit():   # "114x" is not "14x"
+            i = name.find(part, i + 1)
+        if i < 0:
+            return False
+        pos = i + len(part)
+    return True
+
+
+def is_iram(section):
+    return section.startswith(".iram0") or section.startswith(".iram1")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="IRAM placement report (src/iram_placement.h)")
+    parser.add_argument("elf", help="firmware ELF")
+    parser.add_argument("--base", help="second ELF to compare section sizes with")
+    parser.add_argument("--top", type=int, default=20, help="largest IRAM functions to list (default 20)")
+    parser.add_argument("--check", action="store_true", help="exit 1 if a policy function is in flash")
+    args = parser.parse_args()
+
+    try:
+        elf = Elf32(args.elf)
+        base = Elf32(args.base) if args.base else None
+    except (OSError, ValueError) as e:
+        sys.exit("iram_report: %s" % e)
+
+    sizes = elf.section_sizes()
+    base_sizes = base.section_sizes() if base else {}
+    shown = sorted(n for n in sizes if n.startswith(RAM_PREFIXES)) + [n for n in OTHER_SECTIONS if n in sizes]
+    print("%-22s %10s%s" % ("section", "bytes", "  %10s" % "delta" if base else ""))
+    for name in shown:
+        delta = "  %+10d" % (sizes[name] - base_sizes.get(name, 0)) if base else ""
+        print("%-22s %10d%s" % (name, sizes[name], delta))
+    internal = sum(sizes[n] for n in sizes if n.startswith(RAM_PREFIXES))
+    if base:
+        base_internal = sum(base_sizes[n] for n in base_sizes if n.startswith(RAM_PREFIXES))
+        print("%-22s %10d  %+10d" % ("internal RAM", internal, internal - base_internal))
+    else:
+        print("%-22s %10d" % ("internal RAM", internal))
+
+    print("\n%-40s %-10s %8s" % ("policy", "placement", "bytes"))
+    misses = 0
+    for qualified in POLICY:
+        found = [(name, size, section) for name, size, section in elf.functions if match(qualified, name)]
+        if not found:
+            print("%-40s %-10s %8s" % (qualified, "inlined", "-"))
+            continue
+        for name, size, section in found:
+            placed = "IRAM" if is_iram(section) else "FLASH"
+            if placed == "FLASH":
+                misses += 1
+            print("%-40s %-10s %8d  %s" % (qualified, placed, size, name if len(found) > 1 else ""))
+
+    iram = sorted((f for f in elf.functions if is_iram(f[2])), key=lambda f: -f[1])
+    print("\n%d functions in IRAM, %d bytes; largest:" % (len(iram), sum(f[1] for f in iram)))
+    for name, size, section in iram[:args.top]:
+        print("  %8d  %-14s %s" % (size, section, name))
+
+    if misses:
+        print("\n%d policy function(s) in flash - GS_HOT_IRAM missing or GS_IRAM_HOT=0" % misses)
+        if args.check:
+            sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,232 @@
+#!/usr/bin/env python3
+"""Decode GS_LOG_BINARY serial output back into readable log lines.
+
+Firmware built with -DGS_LOG_BINARY sends each LOG_*() call as a frame that
+holds pointers to the tag and format strings plus the raw arguments (see
+src/log_ring.h). This script looks the strings up in the firmware ELF and
+formats the line the way the firmware would have. Bytes outside frames (boot
+banner, reset reason, drop warnings) pass through unchanged.
+
+The ELF must be the one that is flashed; the pointers are only valid for it.
+
+Usage:
+  pio device monitor --raw --quiet | tools/log_decode/log_decode.py .pio/build/gravimetric_shots/firmware.elf
+  tools/log_decode/log_decode.py firmware.elf --port /dev/ttyACM0     (needs pyserial)
+  tools/log_decode/log_decode.py firmware.elf < capture.bin
+
+Only the standard library is needed (pyserial for --port).
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+SYNC = b"\xa5\x5a"
+TRUNCATED = 0x80
+LEVELS = {1: ("E", "31"), 2: ("W", "33"), 3: ("I", "32"), 4: ("D", "36"), 5: ("V", "90")}
+
+# %[flags][width][.precision][length]conversion - same walk as packArgs()
+SPEC = re.compile(rb"%([-+ #0]*)(\*|\d+)?(?:\.(\*|\d*))?([hlzjtLq]*)(.)?", re.S)
+
+
+class Elf32:
+    """Allocated sections of a little-endian ELF32 image, for string lookups."""
+
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            data = f.read()
+        if data[:4] != b"\x7fELF" or data[4] != 1 or data[5] != 1:
+            raise ValueError("%s: not a little-endian ELF32 file" % path)
+        shoff, = struct.unpack_from("<I", data, 0x20)
+        shentsize, shnum = struct.unpack_from("<HH", data, 0x2E)
+        self.sections = []
+        for i in range(shnum):
+            _name, sh_type, flags, addr, offset, size = struct.unpack_from("<IIIIII", data, shoff + i * shentsize)
+            if (flags & 0x2) and sh_type != 8 and addr and size:  # SHF_ALLOC, not NOBITS
+                self.sections.append((addr, size, data[offset:offset + size]))
+        self.cache = {}
+
+    def string(self, addr):
+        if addr in self.cache:
+            return self.cache[addr]
+        for base, size, blob in self.sections:
+            if base <= addr < base + size:
+                end = blob.find(b"\0", addr - base)
+                value = blob[addr - base:end if end >= 0 else size]
+                break
+        else:
+            value = None
+        self.cache[addr] = value
+        return value
+
+
+class Args:
+    def __init__(self, payload):
+        self.payload = payload
+        self.pos = 0
+
+    def take(self, fmt, size):
+        if self.pos + size > len(self.payload):
+            raise IndexError
+        value, = struct.unpack_from(fmt, self.payload, self.pos)
+        self.pos += size
+        return value
+
+    def text(self):
+        length = self.take("<B", 1)
+        if self.pos + length > len(self.payload):
+            raise IndexError
+        value = self.payload[self.pos:self.pos + length]
+        self.pos += length
+        return value.decode("utf-8", "replace")
+
+
+def format_line(fmt, args):
+    """printf one format string from packed arguments; missing ones show as <?>."""
+    out = []
+    last = 0
+    for m in SPEC.finditer(fmt):
+        out.append(fmt[last:m.start()].decode("utf-8", "replace"))
+        last = m.end()
+        flags, width, precision, length, conv = m.groups()
+        if width is None and precision is None and not flags and not length and conv == b"%":
+            out.append("%")
+            continue
+        if conv is None:
+            break
+        conv = conv.decode("latin-1")
+        try:
+            if width == b"*":
+                width = str(args.take("<i", 4)).encode()
+            if precision == b"*":
+                precision = str(args.take("<i", 4)).encode()
+            spec = "%" + flags.decode() + (width or b"").decode()
+            if precision is not None:
+                spec += "." + precision.decode()
+            wide = length.count(b"l") >= 2 or b"j" in length or b"q" in length
+
+            if conv in "di":
+                value = args.take("<q", 8) if wide else args.take("<i", 4)
+                out.append((spec + "d") % value)
+            elif conv in "uxXo":
+                value = args.take("<Q", 8) if wide else args.take("<I", 4)
+                out.append((spec + ("d" if conv == "u" else conv)) % value)
+            elif conv == "c":
+                out.append((spec + "c") % chr(args.take("<I", 4) & 0xFF))
+            elif conv == "p":
+                out.append("0x%08x" % args.take("<I", 4))
+            elif conv in "fFeEgG":
+                out.append((spec + conv) % args.take("<d", 8))
+            elif conv in "aA":
+                out.append(float.hex(args.take("<d", 8)))
+            elif conv == "s":
+                out.append((spec + "s") % args.text())
+            elif conv == "n":
+                pass
+            else:
+                out.append(m.group(0).decode("latin-1"))
+        except IndexError:
+            out.append("<?>")
+    out.append(fmt[last:].decode("utf-8", "replace"))
+    return "".join(out)
+
+
+def decode_frame(elf, level, ms, payload, color):
+    if len(payload) < 8:
+        return None
+    tag_addr, fmt_addr = struct.unpack_from("<II", payload, 0)
+    tag = elf.string(tag_addr)
+    fmt = elf.string(fmt_addr)
+    if fmt is None or tag is None:
+        return None  # Not our ELF (or not a frame after all)
+
+    letter, ansi = LEVELS.get(level & ~TRUNCATED, ("?", ""))
+    msg = format_line(fmt, Args(payload[8:]))
+    if level & TRUNCATED:
+        msg += " <args truncated>"
+    tag = tag.decode("utf-8", "replace")
+    if color and ansi:
+        return "\033[0;%sm%s (%d) [%s]:\033[0m %s\n" % (ansi, letter, ms, tag, msg)
+    return "%s (%d) [%s]: %s\n" % (letter, ms, tag, msg)
+
+
+def decode_stream(elf, read, write, color):
+    """Pull bytes from read(n), write decoded text; frames are checked by length + xor + ELF lookup."""
+    buf = b""
+    while True:
+        chunk = read(4096)
+        if not chunk:
+            break
+        buf += chunk
+        while True:
+            start = buf.find(SYNC)
+            if start < 0:
+                keep = 1 if buf.endswith(SYNC[:1]) else 0
+                write(buf[:len(buf) - keep])
+                buf = buf[len(buf) - keep:]
+                break
+            write(buf[:start])
+            buf = buf[start:]
+            if len(buf) < 8:
+                break
+            length, level = buf[2], buf[3]
+            total = 8 + length + 1
+            if len(buf) < total:
+                break
+            body = buf[3:total - 1]
+            check = 0
+            for b in body:
+                check ^= b
+            line = None
+            if check == buf[total - 1]:
+                ms, = struct.unpack_from("<I", buf, 4)
+                line = decode_frame(elf, level, ms, buf[8:8 + length], color)
+            if line is None:
+                write(buf[:1])  # Not a frame: pass the byte through, resync after it
+                buf = buf[1:]
+                continue
+            write(line.encode("utf-8"))
+            buf = buf[total:]
+    write(buf)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode GS_LOG_BINARY log frames")
+    parser.add_argument("elf", help="firmware.elf of the flashed build")
+    parser.add_argument("input", nargs="?", help="captured stream (default: stdin)")
+    parser.add_argument("--port", help="read a serial port directly (pyserial)")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--color", action="store_true", help="ANSI colours like the text log")
+    opt = parser.parse_args()
+
+    elf = Elf32(opt.elf)
+    out = sys.stdout.buffer
+
+    def write(data):
+        if data:
+            out.write(data)
+            out.flush()
+
+    if opt.port:
+        import serial  # pyserial
+        port = serial.Serial(opt.port, opt.baud, timeout=0.1)
+
+        def read(n):
+            while True:  # Never report EOF: a quiet port is not the end of the stream
+                data = port.read(max(1, port.in_waiting))
+                if data:
+                    return data
+
+        try:
+            decode_stream(elf, read, write, opt.color)
+        except KeyboardInterrupt:
+            pass
+    else:
+        src = open(opt.input, "rb") if opt.input else sys.stdin.buffer
+        read = getattr(src, "read1", src.read)
+        decode_stream(elf, read, write, opt.color)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,227 @@
+#!/usr/bin/env python3
+"""Build a firmware update for POST /ota (see src/ota_update.h).
+
+Full image, deflated (typically ~60% of firmware.bin), signed with the
+release key:
+
+  tools/ota/make_ota.py .pio/build/gravimetric_shots/firmware.bin --sign release_key.pem -o update.gsota
+
+Delta against the image the unit runs now (its firmware.bin, kept from the
+last release), deflated - usually a small fraction of the full image:
+
+  tools/ota/make_ota.py new/firmware.bin --base old/firmware.bin --sign release_key.pem -o update.gsota
+
+Units built with GS_OTA_SIGNED (the default) take signed containers only.
+The key is ECDSA P-256; make one once, keep it off the repo, and put its
+public half into src/ota_signing_key.h:
+
+  openssl ecparam -name prime256v1 -genkey -noout -out release_key.pem
+  tools/ota/make_ota.py --public-key release_key.pem
+
+Upload:
+
+  curl -H 'Content-Type: application/octet-stream' --data-binary @update.gsota http://<ESP32-IP>/ota
+
+or, on builds without Wi-Fi, the same file over the BLE maintenance service
+(src/ble_maint.h).
+
+Layout, little-endian:
+
+  header   magic "GSOT" (u32), version (u8), kind (u8: 0 full, 1 delta),
+           flags (u8: 1 = zlib deflate, 2 = signed), reserved (u8),
+           target size (u32), base size (u32), base app_elf_sha256 (32 bytes)
+  payload  full: the image; delta: operations
+             'C' offset (u32) length (u32)   copy from the running image
+             'I' length (u32) bytes          literal bytes
+  signature  signed only: ECDSA P-256 r || s (2 x 32 bytes, big-endian)
+             over SHA-256 of the header and the app image itself, so the
+             unit checks what it is about to boot, not the transport form
+
+The unit refuses a delta whose base app_elf_sha256 (esp_app_desc_t) is not
+the running one. The delta is applied here once before it is written, so a
+patch that does not reproduce the image is never produced.
+
+Only the standard library is needed, plus the openssl command line for
+--sign and --public-key.
+"""
+
+import argparse
+import struct
+import subprocess
+import sys
+import zlib
+
+MAGIC = 0x544F5347  # "GSOT"
+VERSION = 1
+KIND_FULL = 0
+KIND_DELTA = 1
+FLAG_DEFLATE = 0x01
+FLAG_SIGNED = 0x02
+SLOT_BYTES = 0x400000  # partitions.csv app0 / app1
+
+IMAGE_MAGIC = 0xE9
+APP_DESC_OFFSET = 32  # esp_image_header_t (24) + first segment header (8)
+APP_DESC_MAGIC = 0xABCD5432
+ELF_SHA_OFFSET = APP_DESC_OFFSET + 144  # esp_app_desc_t.app_elf_sha256
+
+BLOCK = 16       # Match seed length
+BASE_STRIDE = 4  # Base offsets indexed; every target offset is tried
+MIN_COPY = 24    # Shorter matches stay literal (a copy costs 9 bytes)
+
+
+def check_image(data, path):
+    if len(data) < ELF_SHA_OFFSET + 32 or data[0] != IMAGE_MAGIC:
+        sys.exit("%s: not an ESP32 app image" % path)
+    if struct.unpack_from("<I", data, APP_DESC_OFFSET)[0] != APP_DESC_MAGIC:
+        sys.exit("%s: no esp_app_desc_t in the first segment" % path)
+    if len(data) > SLOT_BYTES:
+        sys.exit("%s: %d bytes do not fit the %d byte app slot" % (path, len(data), SLOT_BYTES))
+
+
+def delta_ops(base, target):
+    index = {}
+    for off in range(0, len(base) - BLOCK + 1, BASE_STRIDE):
+        index.setdefault(base[off:off + BLOCK], off)
+
+    ops = []
+    literal = 0  # Start of the pending literal run
+    i = 0
+    n = len(target)
+    while i + BLOCK <= n:
+        off = index.get(target[i:i + BLOCK])
+        if off is None:
+            i += 1
+            continue
+        length = BLOCK
+        while i + length < n and off + length < len(base) and target[i + length] == base[off + length]:
+            length += 1
+        while i > literal and off > 0 and target[i - 1] == base[off - 1]:
+            i -= 1
+            off -= 1
+            length += 1
+        if length < MIN_COPY:
+            i += 1
+            continue
+        if i > literal:
+            ops.append(("I", target[literal:i]))
+        ops.append(("C", off, length))
+        i += length
+        literal = i
+    if literal < n:
+        ops.append(("I", target[literal:]))
+    return ops
+
+
+def encode_ops(ops):
+    out = bytearray()
+    for op in ops:
+        if op[0] == "C":
+            out += b"C" + struct.pack("<II", op[1], op[2])
+        else:
+            out += b"I" + struct.pack("<I", len(op[1])) + op[1]
+    return bytes(out)
+
+
+def apply_ops(base, ops):
+    out = bytearray()
+    for op in ops:
+        out += base[op[1]:op[1] + op[2]] if op[0] == "C" else op[1]
+    return bytes(out)
+
+
+def openssl(args, data=None):
+    try:
+        return subprocess.run(["openssl"] + args, input=data, stdout=subprocess.PIPE, check=True).stdout
+    except (OSError, subprocess.CalledProcessError) as e:
+        sys.exit("openssl %s failed: %s" % (args[0], e))
+
+
+def der_integer(der, pos):
+    if der[pos] != 0x02:
+        sys.exit("unexpected openssl signature encoding")
+    length = der[pos + 1]
+    value = der[pos + 2:pos + 2 + length].lstrip(b"\0")
+    if len(value) > 32:
+        sys.exit("signature component longer than 32 bytes - not a P-256 key?")
+    return value.rjust(32, b"\0"), pos + 2 + length
+
+
+def sign(key, data):
+    der = openssl(["dgst", "-sha256", "-sign", key], data)
+    if der[0] != 0x30:
+        sys.exit("unexpected openssl signature encoding")
+    pos = 3 if der[1] & 0x80 else 2
+    r, pos = der_integer(der, pos)
+    s, _ = der_integer(der, pos)
+    return r + s
+
+
+def public_key(key):
+    point = openssl(["ec", "-in", key, "-pubout", "-outform", "DER"])[-65:]
+    if len(point) != 65 or point[0] != 0x04:
+        sys.exit("%s: not an uncompressed P-256 key" % key)
+    lines = ["constexpr uint8_t OTA_SIGNING_KEY[65] = {"]
+    for i in range(0, 65, 13):
+        lines.append("  " + " ".join("0x%02x," % b for b in point[i:i + 13]))
+    lines.append("};")
+    print("\n".join(lines))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("image", nargs="?", help="new firmware.bin")
+    parser.add_argument("--base", help="firmware.bin the unit runs now (delta update)")
+    parser.add_argument("--no-deflate", action="store_true", help="leave the payload uncompressed")
+    parser.add_argument("--sign", metavar="KEY.pem", help="ECDSA P-256 release key (GS_OTA_SIGNED units)")
+    parser.add_argument("--public-key", metavar="KEY.pem", help="print OTA_SIGNING_KEY for src/ota_signing_key.h and exit")
+    parser.add_argument("-o", "--output")
+    args = parser.parse_args()
+
+    if args.public_key:
+        public_key(args.public_key)
+        return
+    if not args.image or not args.output:
+        parser.error("an image and -o are needed")
+
+    target = open(args.image, "rb").read()
+    check_image(target, args.image)
+
+    kind = KIND_FULL
+    base_size = 0
+    base_sha = bytes(32)
+    payload = target
+    copies = 0
+    if args.base:
+        base = open(args.base, "rb").read()
+        check_image(base, args.base)
+        ops = delta_ops(base, target)
+        if apply_ops(base, ops) != target:
+            sys.exit("internal error: delta does not reproduce the image")
+        kind = KIND_DELTA
+        base_size = len(base)
+        base_sha = base[ELF_SHA_OFFSET:ELF_SHA_OFFSET + 32]
+        payload = encode_ops(ops)
+        copies = sum(1 for op in ops if op[0] == "C")
+
+    flags = 0
+    if not args.no_deflate:
+        flags |= FLAG_DEFLATE
+        payload = zlib.compress(payload, 9)
+    if args.sign:
+        flags |= FLAG_SIGNED
+
+    header = struct.pack("<IBBBBII32s", MAGIC, VERSION, kind, flags, 0, len(target), base_size, base_sha)
+    assert len(header) == 48
+    signature = sign(args.sign, header + target) if args.sign else b""
+    with open(args.output, "wb") as out:
+        out.write(header + payload + signature)
+
+    size = len(header) + len(payload) + len(signature)
+    print("%s: %s%s%s, %d bytes for a %d byte image (%.1f%%)%s" % (
+        args.output, "delta" if kind == KIND_DELTA else "full", "+deflate" if flags & FLAG_DEFLATE else "",
+        "+signed" if signature else "", size, len(target), 100.0 * size / len(target),
+        ", %d copies from the base" % copies if copies else ""))
+
+
+if __name__ == "__main__":
+    main()
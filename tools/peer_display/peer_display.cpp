@@ -0,0 +1,155 @@
+// =============================================================================
+// Peer Display - a remote shot display / aggregator on a second ESP32
+// =============================================================================
+// Listens on the peer link channel (src/peer_link.h) and shows every unit it
+// hears on its USB serial, redrawn in place (ANSI terminal):
+//
+//   unit (MAC)         state     weight   flow    time   goal  end   last shot
+//   3C:84:27:..:..:..  brewing   24.3 g   1.9 g/s 18.4 s 36 g  27 s  36.2 g in 28.1 s
+//
+// and per unit, from the shots it saw end while listening: count, mean
+// yield error against the goal and mean shot time. A unit is dropped from
+// the screen after STALE_MS without a frame. The node never transmits -
+// it only needs the channel the units use.
+//
+// Frames are decoded with the controller's own src/peer_frame.h.
+//
+// Build: pio run -e peer_display  (see tools/peer_display/README.md)
+// =============================================================================
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <esp_now.h>
+#include <esp_wifi.h>
+#include "../../src/peer_frame.h"
+
+#ifndef GS_PEER_LINK_CHANNEL
+#define GS_PEER_LINK_CHANNEL 1
+#endif
+
+constexpr uint32_t SERIAL_BAUD  = 115200;
+constexpr uint8_t  MAX_UNITS    = 8;
+constexpr uint32_t REDRAW_MS    = 250;
+constexpr uint32_t STALE_MS     = 10000;
+
+static const char *const END_REASONS[] = {"weight", "time", "button", "scale lost", "user", "-", "anomaly"};
+
+struct Unit {
+  uint8_t mac[6];
+  PeerFrame frame;
+  uint32_t lastMs;    // 0 = free
+  uint16_t seenShots; // frame.shots when the last shot was counted
+  uint32_t shots;     // Ended while listening
+  float errorSum;     // Yield - goal
+  float timeSum;
+};
+
+static portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+static Unit units[MAX_UNITS];
+static uint32_t received = 0;
+static uint32_t rejected = 0;
+
+static void onReceived(const uint8_t *mac, const uint8_t *data, int len)
+{
+  if (!peerFrameValid(data, len)) {
+    rejected++;
+    return;
+  }
+  PeerFrame f;
+  memcpy(&f, data, sizeof(f));
+  uint32_t now = millis();
+
+  portENTER_CRITICAL(&lock);
+  received++;
+  Unit *u = NULL;
+  Unit *oldest = &units[0];
+  for (Unit &c : units) {
+    if (c.lastMs != 0 && memcmp(c.mac, mac, 6) == 0) {
+      u = &c;
+      break;
+    }
+    if (c.lastMs == 0 || (oldest->lastMs != 0 && c.lastMs < oldest->lastMs))
+      oldest = &c;
+  }
+  if (u == NULL) {
+    u = oldest;
+    memset(u, 0, sizeof(*u));
+    memcpy(u->mac, mac, 6);
+    u->seenShots = f.shots;   // Shots before we listened are not ours to count
+  }
+  if (f.shots != u->seenShots && f.lastEndReason != PEER_END_NONE) {
+    u->seenShots = f.shots;
+    u->shots++;
+    u->errorSum += f.lastYieldDg / 10.0f - f.goalG;
+    u->timeSum += f.lastTimeDs / 10.0f;
+  }
+  u->frame = f;
+  u->lastMs = now ? now : 1;
+  portEXIT_CRITICAL(&lock);
+}
+
+static const char *stateName(uint8_t flags)
+{
+  if (flags & PEER_FLAG_BREWING)
+    return "brewing";
+  if (flags & PEER_FLAG_FLUSHING)
+    return "flushing";
+  return (flags & (PEER_FLAG_SCALE | PEER_FLAG_LOAD_CELL)) ? "ready" : "no scale";
+}
+
+static void redraw()
+{
+  Unit copy[MAX_UNITS];
+  portENTER_CRITICAL(&lock);
+  memcpy(copy, units, sizeof(copy));
+  uint32_t rx = received;
+  uint32_t bad = rejected;
+  portEXIT_CRITICAL(&lock);
+
+  uint32_t now = millis();
+  Serial.print("\033[H\033[2J");
+  Serial.printf("Gravimetric Shots - peer display, channel %d, %lu frames (%lu rejected)\n\n", GS_PEER_LINK_CHANNEL,
+                (unsigned long)rx, (unsigned long)bad);
+  Serial.println("unit               state     weight    flow      time    goal  end     last shot              "
+                 "| shots  err avg  time avg");
+  for (const Unit &u : copy) {
+    if (u.lastMs == 0 || now - u.lastMs > STALE_MS)
+      continue;
+    const PeerFrame &f = u.frame;
+    Serial.printf("%02X:%02X:%02X:%02X:%02X:%02X  %-8s  %5.1f g  %4.1f g/s  %5.1f s  %3u g  ", u.mac[0], u.mac[1],
+                  u.mac[2], u.mac[3], u.mac[4], u.mac[5], stateName(f.flags), f.weightDg / 10.0f, f.flowCgs / 100.0f,
+                  f.timerDs / 10.0f, (unsigned)f.goalG);
+    if (f.expectedEndDs > 0 && (f.flags & PEER_FLAG_BREWING))
+      Serial.printf("%5.1f s ", f.expectedEndDs / 10.0f);
+    else
+      Serial.print("    -   ");
+    if (f.lastEndReason == PEER_END_NONE)
+      Serial.print("                       ");
+    else
+      Serial.printf("%5.1f g %5.1f s %-10s", f.lastYieldDg / 10.0f, f.lastTimeDs / 10.0f,
+                    f.lastEndReason < sizeof(END_REASONS) / sizeof(END_REASONS[0]) ? END_REASONS[f.lastEndReason] : "?");
+    if (u.shots > 0)
+      Serial.printf("| %5lu  %+6.1f g  %6.1f s\n", (unsigned long)u.shots, u.errorSum / u.shots, u.timeSum / u.shots);
+    else
+      Serial.println("|     0");
+  }
+}
+
+void setup()
+{
+  Serial.begin(SERIAL_BAUD);
+  WiFi.mode(WIFI_STA);
+  WiFi.disconnect();
+  esp_wifi_set_channel(GS_PEER_LINK_CHANNEL, WIFI_SECOND_CHAN_NONE);   // Not associated: stays here
+  if (esp_now_init() != ESP_OK) {
+    Serial.println("ESP-NOW init failed");
+    return;
+  }
+  esp_now_register_recv_cb(onReceived);
+}
+
+void loop()
+{
+  redraw();
+  delay(REDRAW_MS);
+}
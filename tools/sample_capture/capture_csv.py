@@ -0,0 +1,151 @@
+#!/usr/bin/env python3
+"""Turn a binary sample capture ("capture on") into CSV.
+
+The firmware streams one frame per weight sample the control task takes -
+the raw reading with its arrival time plus the filter state after it - and
+a counters frame every second (see src/sample_capture.h). Everything else on
+the port (text log lines, GS_LOG_BINARY frames) is skipped.
+
+One CSV row per sample:
+  seq, arrival_us, sample_us, raw_g, shot_s, filtered_g, flow_gs, sd_g,
+  expected_end_s, brewing, dripped, flowing, load_cell, anomaly
+
+Lost records show twice: as gaps in `seq` (counted here) and as the
+firmware's own `dropped` counter from the last STATS frame. Both go to
+stderr at the end.
+
+Usage:
+  tools/sample_capture/capture_csv.py --port /dev/ttyACM0 --start -o shot.csv   (needs pyserial; Ctrl-C ends)
+  pio device monitor --raw --quiet | tools/sample_capture/capture_csv.py > shot.csv
+  tools/sample_capture/capture_csv.py capture.bin -o shot.csv
+
+Only the standard library is needed (pyserial for --port).
+"""
+
+import argparse
+import csv
+import math
+import struct
+import sys
+
+SYNC = b"\xa5\xc5"
+FRAME_SAMPLE = 1
+FRAME_STATS = 2
+SAMPLE = struct.Struct("<IqiffffffB3x")   # CaptureSample, 44 bytes
+STATS = struct.Struct("<IIII")             # CaptureStats
+
+FLAG_BREWING = 0x01
+FLAG_DRIPPED = 0x02
+FLAG_FLOWING = 0x04
+FLAG_LOAD_CELL = 0x08
+ANOMALY_SHIFT = 4
+
+COLUMNS = ["seq", "arrival_us", "sample_us", "raw_g", "shot_s", "filtered_g", "flow_gs", "sd_g", "expected_end_s",
+           "brewing", "dripped", "flowing", "load_cell", "anomaly"]
+
+
+class Decoder:
+    """Finds capture frames in a byte stream and checks them."""
+
+    def __init__(self):
+        self.buffer = bytearray()
+        self.bad = 0
+
+    def feed(self, data):
+        self.buffer += data
+        while True:
+            start = self.buffer.find(SYNC)
+            if start < 0:
+                del self.buffer[:max(len(self.buffer) - 1, 0)]   # Keep a trailing A5
+                return
+            if len(self.buffer) < start + 4:
+                del self.buffer[:start]
+                return
+            length = self.buffer[start + 2]
+            end = start + 4 + length + 1
+            if len(self.buffer) < end:
+                del self.buffer[:start]
+                return
+            body = self.buffer[start + 3:end - 1]
+            check = 0
+            for b in body:
+                check ^= b
+            if check != self.buffer[end - 1]:
+                self.bad += 1
+                del self.buffer[:start + 1]   # Sync bytes inside text or another frame - look further
+                continue
+            frame_type, payload = body[0], bytes(body[1:])
+            del self.buffer[:end]
+            yield frame_type, payload
+
+
+def rows(source, port, summary):
+    decoder = Decoder()
+    last_seq = None
+    while True:
+        data = port.read(4096) if port is not None else source.read(4096)
+        if not data:
+            if port is not None:
+                continue
+            return
+        for frame_type, payload in decoder.feed(data):
+            if frame_type == FRAME_STATS and len(payload) == STATS.size:
+                summary["stats"] = STATS.unpack(payload)
+            elif frame_type == FRAME_SAMPLE and len(payload) == SAMPLE.size:
+                (seq, arrival, offset, raw, shot_s, filtered, flow, sd, expected, flags) = SAMPLE.unpack(payload)
+                if last_seq is not None and seq != (last_seq + 1) & 0xFFFFFFFF:
+                    summary["gaps"] += (seq - last_seq - 1) & 0xFFFFFFFF
+                last_seq = seq
+                summary["samples"] += 1
+                yield [seq, arrival, arrival + offset, "%.3f" % raw, "" if math.isnan(shot_s) else "%.4f" % shot_s,
+                       "%.3f" % filtered, "%.4f" % flow, "%.4f" % sd, "%.2f" % expected,
+                       int(bool(flags & FLAG_BREWING)), int(bool(flags & FLAG_DRIPPED)),
+                       int(bool(flags & FLAG_FLOWING)), int(bool(flags & FLAG_LOAD_CELL)), flags >> ANOMALY_SHIFT]
+        summary["bad"] = decoder.bad
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Binary sample capture → CSV")
+    parser.add_argument("input", nargs="?", help="capture file (default: stdin)")
+    parser.add_argument("--port", help="read the serial port directly (pyserial)")
+    parser.add_argument("--start", action="store_true", help="with --port: send 'capture on', 'capture off' at exit")
+    parser.add_argument("-o", "--output", help="CSV file (default: stdout)")
+    args = parser.parse_args()
+
+    port = None
+    source = None
+    if args.port:
+        import serial
+        port = serial.Serial(args.port, 115200, timeout=0.2)
+        if args.start:
+            port.write(b"capture on\n")
+    else:
+        source = open(args.input, "rb") if args.input else sys.stdin.buffer
+
+    out = open(args.output, "w", newline="") if args.output else sys.stdout
+    writer = csv.writer(out)
+    writer.writerow(COLUMNS)
+    summary = {"samples": 0, "gaps": 0, "bad": 0, "stats": None}
+    try:
+        for row in rows(source, port, summary):
+            writer.writerow(row)
+            if port is not None:
+                out.flush()
+    except KeyboardInterrupt:
+        pass
+    finally:
+        if port is not None and args.start:
+            port.write(b"capture off\n")
+
+    sys.stderr.write("%d samples, %d missing by seq, %d bad frames" % (summary["samples"], summary["gaps"],
+                                                                       summary["bad"]))
+    if summary["stats"]:
+        ms, written, dropped, sent = summary["stats"]
+        sys.stderr.write("; firmware at %.1f s: %d recorded, %d dropped, %d frames sent" % (ms / 1000.0, written,
+                                                                                         dropped, sent))
+    sys.stderr.write("\n")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,850 @@
+// =============================================================================
+// Scale Emulator - a BLE scale on a second ESP32 for load and reconnect tests
+// =============================================================================
+// Plays one of the scales the controller drives (lib/AcaiaArduinoBLE/
+// ScaleDriver.cpp) on ArduinoBLE's peripheral side, so the whole BLE path can
+// be exercised without a Lunar, Pyxis or Felicita on the bench:
+//
+//   layout   old       "LUNAR-EMU"    service 1820, READ = WRITE 2a80, 10-byte weight packets
+//            new       "PYXIS-EMU"    ISSC service, READ 49535343-1e4d-..., WRITE 49535343-8841-...,
+//                                     0xEF 0xDD frame stream (weight, timer and key events)
+//            felicita  "FELICITA-EMU" service ffe0, READ = WRITE ffe1, ASCII weight packets
+//
+//   START_TIMER ──► delay ──► flow ramps to `flow` g/s ──► STOP_TIMER ──► flow
+//                                                          runs `lag` s, then
+//                                                          decays with `tau` s
+//
+//   - Weight: cup + poured coffee - tare, plus noise, quantised to the
+//     layout's resolution, at `rate` Hz on a fixed grid (the scale's own
+//     clock - any jitter the controller sees is the link's).
+//   - Commands from the controller (identify, notification request,
+//     heartbeat, tare, timers, settings) are answered like the real scales:
+//     a tare zeroes the reading, the new layout sends the key events the
+//     driver takes as acknowledgements, settings replies carry `battery`.
+//   - Faults: `loss` drops notifications, `merge` / `split` put two frames
+//     into one notification or one frame into two (new layout - the other
+//     two are not framed), `drop` / `offair` / `chaos` end the link, `hbtimeout`
+//     drops it when heartbeats stop, like an Acaia does.
+//   - Timings: every command is logged with its arrival time and the gap to
+//     the one before; `report` sums up reconnects, heartbeat spacing, the
+//     shot start batch and the stop (weight at STOP_TIMER, settled weight,
+//     error against `goal`). Lines start with CMD / CONN / SHOT for scripts.
+//
+// The layout is kept in NVS ("scaleemu") and needs a restart to change - the
+// GATT table is built once. Everything else is set over USB serial at run
+// time, "help" lists the commands.
+//
+// Build: pio run -e scale_emulator  (see tools/scale_emulator/README.md)
+// =============================================================================
+
+#include <Arduino.h>
+#include <ArduinoBLE.h>
+#include <Preferences.h>
+#include <esp_system.h>
+#include <esp_timer.h>
+#include <math.h>
+
+constexpr uint32_t SERIAL_BAUD         = 115200;
+constexpr uint8_t  FRAME_MAX_LEN       = 32;      // Longest frame the emulator sends
+constexpr uint8_t  NOTIFY_MAX_LEN      = 64;      // Characteristic value size (merged frames)
+constexpr uint16_t NOTIFY_DEFAULT_LEN  = 20;      // Payload per notification before an MTU exchange
+constexpr float    SETTLED_FLOW_GS     = 0.02f;   // Drip below this = shot over, final weight taken
+constexpr uint32_t TIMER_EVENT_MS      = 1000;    // New layout: timer event period while the timer runs
+constexpr int64_t  MERGE_HOLD_MAX_US   = 500000;  // A held frame goes out alone after this
+constexpr uint8_t  COMMAND_LOG_SIZE    = 32;
+
+enum Layout : uint8_t { LAYOUT_ACAIA_OLD, LAYOUT_ACAIA_NEW, LAYOUT_FELICITA, LAYOUT_COUNT };
+
+struct LayoutInfo {
+  const char *key;
+  const char *localName;   // Matched by ScaleDriver matchesName()
+  const char *service;
+  const char *readUuid;
+  const char *writeUuid;   // Same as readUuid = one characteristic
+  uint8_t decimals;        // Reported resolution
+};
+
+static const LayoutInfo LAYOUTS[LAYOUT_COUNT] = {
+  {"old", "LUNAR-EMU", "1820", "2a80", "2a80", 1},
+  {"new", "PYXIS-EMU", "49535343-fe7d-4ae5-8fa9-9fafd205e455", "49535343-1e4d-4bd9-ba61-23c647249616",
+   "49535343-8841-43f4-a8d4-ecbe34729bb3", 2},
+  {"felicita", "FELICITA-EMU", "ffe0", "ffe1", "ffe1", 2},
+};
+
+// Commands as the controller writes them (ScaleCommand in ScaleDriver.h)
+enum EmuCommand : uint8_t {
+  EMU_CMD_IDENTIFY, EMU_CMD_NOTIFICATION_REQUEST, EMU_CMD_HEARTBEAT, EMU_CMD_TARE, EMU_CMD_START_TIMER,
+  EMU_CMD_STOP_TIMER, EMU_CMD_RESET_TIMER, EMU_CMD_GET_SETTINGS, EMU_CMD_UNKNOWN, EMU_CMD_COUNT
+};
+
+static const char *const COMMAND_NAMES[EMU_CMD_COUNT] = {
+  "IDENTIFY", "NOTIFICATION_REQUEST", "HEARTBEAT", "TARE", "START_TIMER", "STOP_TIMER", "RESET_TIMER",
+  "GET_SETTINGS", "UNKNOWN"
+};
+
+// Run-time settings (serial commands)
+struct EmuConfig {
+  float rateHz = 10.0f;
+  float noiseG = 0.03f;       // Reading noise (standard deviation)
+  float cupG = 0.0f;          // Load on the platform before coffee
+  float flowGs = 2.0f;        // Full flow
+  float delayS = 4.0f;        // START_TIMER to first drops (pre-infusion)
+  float rampS = 3.0f;         // First drops to full flow
+  float lagS = 0.4f;          // STOP_TIMER to the flow starting to die off (pump, valve)
+  float tauS = 0.8f;          // Drip decay after that
+  float goalG = 0.0f;         // For the stop error in the report, 0 = not shown
+  uint8_t batteryPct = 80;
+  uint8_t lossPct = 0;        // Notifications dropped
+  uint8_t mergePct = 0;       // Frames held back and sent with the next one
+  uint8_t splitPct = 0;       // Frames sent in two notifications
+  uint32_t chaosS = 0;        // Mean time between injected disconnects, 0 = off
+  uint32_t heartbeatTimeoutS = 0;  // No heartbeat this long = disconnect, 0 = off
+};
+
+// Min / mean / max of a series (intervals in ms, stop errors in g)
+struct Span {
+  uint32_t n;
+  float lowest;
+  float highest;
+  double total;
+
+  void add(float value)
+  {
+    lowest = (n == 0 || value < lowest) ? value : lowest;
+    highest = (n == 0 || value > highest) ? value : highest;
+    total += value;
+    n++;
+  }
+
+  void print(const char *name, const char *unit = "ms") const
+  {
+    if (n == 0)
+      Serial.printf("  %-26s -\n", name);
+    else
+      Serial.printf("  %-26s %5lu x  min %8.2f  avg %8.2f  max %8.2f %s\n", name, (unsigned long)n, lowest,
+                    (float)(total / n), highest, unit);
+  }
+};
+
+struct EmuStats {
+  uint32_t connects;
+  uint32_t disconnects;
+  uint32_t injectedDisconnects;
+  uint32_t notifications;     // Notifications sent
+  uint32_t frames;            // Frames (or packets) produced
+  uint32_t lost;              // Dropped by `loss`
+  uint32_t merged;            // Frames that shared a notification
+  uint32_t split;             // Frames sent in two notifications
+  uint32_t commands[EMU_CMD_COUNT];
+  Span reconnect;             // Link lost -> connected again
+  Span connectToSubscribe;    // Connected -> READ characteristic subscribed
+  Span connectToStream;       // Connected -> weights flowing
+  Span heartbeat;             // Heartbeat to heartbeat
+  Span resetToTare;           // Shot start batch
+  Span tareToStart;
+  Span shotToStop;            // START_TIMER -> STOP_TIMER
+  Span stopError;             // Settled weight - goal (g)
+};
+
+struct CommandLogEntry {
+  int64_t us;
+  EmuCommand command;
+};
+
+static Preferences prefs;
+static Layout layout = LAYOUT_ACAIA_NEW;
+static EmuConfig config;
+static EmuStats stats;
+
+static BLEService *scaleService = NULL;
+static BLECharacteristic *readChar = NULL;
+static BLECharacteristic *writeChar = NULL;   // == readChar for the one-characteristic layouts
+
+// Link
+static BLEDevice peer;
+static volatile bool connected = false;
+static bool subscribed = false;
+static bool streaming = false;          // Acaia layouts stream after the notification request
+static int64_t connectedUs = 0;
+static int64_t disconnectedUs = 0;
+static int64_t lastHeartbeatUs = 0;
+static int64_t offairUntilUs = 0;       // Not advertising until then
+static bool offairPending = false;      // Stop advertising once the disconnect has gone through
+static int64_t nextChaosUs = 0;
+
+// Weight
+static int64_t nextSampleUs = 0;
+static int64_t lastSampleUs = 0;
+static float coffeeG = 0.0f;
+static float tareG = 0.0f;
+
+// Shot
+static bool shotRunning = false;
+static int64_t shotStartUs = 0;
+static int64_t shotStopUs = 0;          // 0 = pump still on
+static float stopFlowGs = 0.0f;         // Flow when the lag ran out
+static float stopWeightG = 0.0f;        // Reported weight at STOP_TIMER
+static bool timerRunning = false;
+static int64_t timerStartUs = 0;
+static int64_t nextTimerEventUs = 0;
+
+// Merge / split
+static uint8_t heldFrame[FRAME_MAX_LEN];
+static uint8_t heldLength = 0;
+static int64_t heldUs = 0;
+
+// Commands
+static CommandLogEntry commandLog[COMMAND_LOG_SIZE];
+static uint8_t commandLogCount = 0;
+static int64_t lastCommandUs = 0;
+static int64_t lastCommandOfType[EMU_CMD_COUNT];
+
+static char line[64];
+static uint8_t lineLength = 0;
+
+// -----------------------------------------------------------------------------
+// Helpers
+// -----------------------------------------------------------------------------
+
+static float msSince(int64_t fromUs, int64_t toUs)
+{
+  return (toUs - fromUs) / 1000.0f;
+}
+
+static float uniform()
+{
+  return esp_random() / 4294967296.0f;
+}
+
+static bool chance(uint8_t pct)
+{
+  return pct && esp_random() % 100 < pct;
+}
+
+// Sum of four uniforms, scaled to unit variance - close enough to a normal distribution
+static float gaussian()
+{
+  return (uniform() + uniform() + uniform() + uniform() - 2.0f) * 1.7320508f;
+}
+
+// Not BLE.central(): that polls HCI, and frames also go out from inside the write handlers
+static uint16_t notifyLimit()
+{
+  uint16_t mtu = peer ? peer.mtu() : 0;
+  return (mtu > 3) ? min<uint16_t>(mtu - 3, NOTIFY_MAX_LEN) : NOTIFY_DEFAULT_LEN;
+}
+
+// -----------------------------------------------------------------------------
+// Frames
+// -----------------------------------------------------------------------------
+
+// 0xEF 0xDD, type, length byte, payload, even / odd sums from the length byte on
+// (the layout FrameParser in AcaiaArduinoBLE.cpp checks)
+static uint8_t acaiaFrame(uint8_t type, const uint8_t *payload, uint8_t payloadLength, uint8_t *out)
+{
+  out[0] = 0xef;
+  out[1] = 0xdd;
+  out[2] = type;
+  out[3] = payloadLength + 1;
+  memcpy(out + 4, payload, payloadLength);
+  uint8_t sum[2] = {0, 0};
+  for (uint8_t i = 0; i <= payloadLength; i++)
+    sum[i & 1] += out[3 + i];
+  out[4 + payloadLength] = sum[0];
+  out[5 + payloadLength] = sum[1];
+  return payloadLength + 6;
+}
+
+static uint8_t settingsFrame(uint8_t *out)
+{
+  const uint8_t payload[] = {(uint8_t)(config.batteryPct & 0x7f), 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+  return acaiaFrame(0x08, payload, sizeof(payload), out);
+}
+
+static uint8_t keyEventFrame(uint8_t key, uint8_t action, uint8_t *out)
+{
+  const uint8_t payload[] = {0x08, key, 0x00, action, 0x00};
+  return acaiaFrame(0x0c, payload, sizeof(payload), out);
+}
+
+static uint8_t timerEventFrame(uint32_t ms, uint8_t *out)
+{
+  const uint8_t payload[] = {0x07, (uint8_t)(ms / 60000), (uint8_t)(ms / 1000 % 60), (uint8_t)(ms / 100 % 10)};
+  return acaiaFrame(0x0c, payload, sizeof(payload), out);
+}
+
+static uint8_t weightFrame(float grams, uint8_t *out)
+{
+  uint8_t decimals = LAYOUTS[layout].decimals;
+  float scale = (decimals == 1) ? 10.0f : 100.0f;
+  int32_t raw = (int32_t)lroundf(fabsf(grams) * scale);
+  bool negative = grams < 0.0f && raw != 0;
+
+  switch (layout) {
+    case LAYOUT_ACAIA_OLD: {
+      // Weight in bytes 2-3, decimals in 6, sign bit 1 of byte 7 - exactly 10 bytes
+      raw = min<int32_t>(raw, 0xffff);
+      const uint8_t packet[10] = {0xef, 0xdd, (uint8_t)raw, (uint8_t)(raw >> 8), 0x00, 0x00, decimals,
+                                  (uint8_t)(negative ? 0x02 : 0x00), 0x00, 0x00};
+      memcpy(out, packet, sizeof(packet));
+      return sizeof(packet);
+    }
+
+    case LAYOUT_ACAIA_NEW: {
+      raw = min<int32_t>(raw, 0xffff);
+      const uint8_t payload[] = {0x05, (uint8_t)raw, (uint8_t)(raw >> 8), 0x00, 0x00, decimals,
+                                 (uint8_t)(negative ? 0x02 : 0x00)};
+      return acaiaFrame(0x0c, payload, sizeof(payload), out);
+    }
+
+    default: {
+      // Sign in byte 2, centigrams as six ASCII digits in bytes 3-8
+      char text[24];
+      snprintf(text, sizeof(text), "\x01\x02%c%06ld g  %3u\r\n", negative ? '-' : '+', (long)min<int32_t>(raw, 999999),
+               config.batteryPct);
+      memcpy(out, text, 18);
+      return 18;
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Notifications and fault injection
+// -----------------------------------------------------------------------------
+
+static void notifyBytes(const uint8_t *data, uint8_t length)
+{
+  uint16_t limit = notifyLimit();
+  while (length > 0) {
+    uint8_t n = min<uint16_t>(length, limit);
+    readChar->writeValue(data, n);
+    stats.notifications++;
+    data += n;
+    length -= n;
+  }
+}
+
+static void flushHeld()
+{
+  if (heldLength) {
+    notifyBytes(heldFrame, heldLength);
+    heldLength = 0;
+  }
+}
+
+static void sendFrame(const uint8_t *frame, uint8_t length)
+{
+  if (!connected || !subscribed)
+    return;
+  stats.frames++;
+  if (chance(config.lossPct)) {
+    stats.lost++;
+    return;
+  }
+  if (layout != LAYOUT_ACAIA_NEW) {
+    notifyBytes(frame, length);   // Not framed: one packet per notification, nothing to merge or split
+    return;
+  }
+
+  if (heldLength) {
+    uint8_t merged[FRAME_MAX_LEN * 2];
+    memcpy(merged, heldFrame, heldLength);
+    memcpy(merged + heldLength, frame, length);
+    notifyBytes(merged, heldLength + length);
+    heldLength = 0;
+    stats.merged++;
+    return;
+  }
+  if (chance(config.mergePct)) {
+    memcpy(heldFrame, frame, length);
+    heldLength = length;
+    heldUs = esp_timer_get_time();
+    return;
+  }
+  if (chance(config.splitPct)) {
+    uint8_t first = 1 + esp_random() % (length - 1);
+    notifyBytes(frame, first);
+    notifyBytes(frame + first, length - first);
+    stats.split++;
+    return;
+  }
+  notifyBytes(frame, length);
+}
+
+static void injectDisconnect(const char *why, uint32_t offairMs)
+{
+  if (!connected)
+    return;
+  Serial.printf("CONN inject %s (off air %lu ms)\n", why, (unsigned long)offairMs);
+  stats.injectedDisconnects++;
+  if (offairMs) {
+    offairUntilUs = esp_timer_get_time() + offairMs * 1000LL;
+    offairPending = true;
+  }
+  BLE.disconnect();
+}
+
+// -----------------------------------------------------------------------------
+// Weight model
+// -----------------------------------------------------------------------------
+
+// Flow (g/s) at `nowUs`: nothing before the shot, pre-infusion, ramp, hold, then the drip
+static float flowAt(int64_t nowUs)
+{
+  if (!shotRunning)
+    return 0.0f;
+  float t = (nowUs - shotStartUs) / 1e6f;
+  if (shotStopUs) {
+    float sinceStop = (nowUs - shotStopUs) / 1e6f;
+    if (sinceStop >= config.lagS)
+      return stopFlowGs * expf(-(sinceStop - config.lagS) / max(config.tauS, 0.01f));
+    t = (shotStopUs - shotStartUs) / 1e6f + sinceStop;
+  }
+  if (t < config.delayS)
+    return 0.0f;
+  if (t < config.delayS + config.rampS)
+    return config.flowGs * (t - config.delayS) / config.rampS;
+  return config.flowGs;
+}
+
+static float reading()
+{
+  float grams = config.cupG + coffeeG - tareG + gaussian() * config.noiseG;
+  float step = (LAYOUTS[layout].decimals == 1) ? 0.1f : 0.01f;
+  return roundf(grams / step) * step;
+}
+
+static void startShot(int64_t nowUs)
+{
+  shotRunning = true;
+  shotStartUs = nowUs;
+  shotStopUs = 0;
+  coffeeG = 0.0f;
+  Serial.printf("SHOT start (flow %.1f g/s after %.1f s + %.1f s ramp)\n", config.flowGs, config.delayS, config.rampS);
+}
+
+static void stopShot(int64_t nowUs)
+{
+  if (!shotRunning || shotStopUs)
+    return;
+  shotStopUs = nowUs;
+  stopWeightG = config.cupG + coffeeG - tareG;
+  stats.shotToStop.add(msSince(shotStartUs, nowUs));
+  // Flow when the lag runs out (the pump keeps its course until then)
+  int64_t lagEndUs = nowUs + (int64_t)(config.lagS * 1e6f);
+  float t = (lagEndUs - shotStartUs) / 1e6f;
+  stopFlowGs = (t < config.delayS) ? 0.0f
+             : (t < config.delayS + config.rampS) ? config.flowGs * (t - config.delayS) / config.rampS
+             : config.flowGs;
+}
+
+static void settleShot()
+{
+  float finalG = config.cupG + coffeeG - tareG;
+  Serial.printf("SHOT done %.2f s to stop, %.2f g at STOP_TIMER, %.2f g settled (+%.2f g drip)",
+                msSince(shotStartUs, shotStopUs) / 1000.0f, stopWeightG, finalG, finalG - stopWeightG);
+  if (config.goalG > 0.0f) {
+    stats.stopError.add(finalG - config.goalG);
+    Serial.printf(", %+.2f g against goal %.1f g", finalG - config.goalG, config.goalG);
+  }
+  Serial.println();
+  shotRunning = false;
+}
+
+static void sampleTick(int64_t nowUs)
+{
+  float dt = lastSampleUs ? (nowUs - lastSampleUs) / 1e6f : 0.0f;
+  lastSampleUs = nowUs;
+  float flow = flowAt(nowUs);
+  coffeeG += flow * dt;
+  if (shotRunning && shotStopUs && nowUs - shotStopUs > (int64_t)(config.lagS * 1e6f) && flow < SETTLED_FLOW_GS)
+    settleShot();
+
+  if (streaming) {
+    uint8_t frame[FRAME_MAX_LEN];
+    sendFrame(frame, weightFrame(reading(), frame));
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Commands from the controller
+// -----------------------------------------------------------------------------
+
+static EmuCommand decodeCommand(const uint8_t *data, int length)
+{
+  if (length == 1 && data[0] == 0x54)
+    return EMU_CMD_TARE;   // Felicita tare
+  if (length < 3 || data[0] != 0xef || data[1] != 0xdd)
+    return EMU_CMD_UNKNOWN;
+  switch (data[2]) {
+    case 0x0b: return EMU_CMD_IDENTIFY;
+    case 0x0c: return EMU_CMD_NOTIFICATION_REQUEST;
+    case 0x00: return EMU_CMD_HEARTBEAT;
+    case 0x04: return EMU_CMD_TARE;
+    case 0x06: return EMU_CMD_GET_SETTINGS;
+    case 0x0d:
+      if (length < 5)
+        return EMU_CMD_UNKNOWN;
+      return (data[4] == 0x00) ? EMU_CMD_START_TIMER : (data[4] == 0x02) ? EMU_CMD_STOP_TIMER : EMU_CMD_RESET_TIMER;
+  }
+  return EMU_CMD_UNKNOWN;
+}
+
+static void noteCommand(EmuCommand command, int64_t nowUs)
+{
+  stats.commands[command]++;
+  Serial.printf("CMD  %10.1f ms %-20s +%.1f ms\n", nowUs / 1000.0f, COMMAND_NAMES[command],
+                lastCommandUs ? msSince(lastCommandUs, nowUs) : 0.0f);
+  lastCommandUs = nowUs;
+
+  if (command == EMU_CMD_HEARTBEAT && lastCommandOfType[EMU_CMD_HEARTBEAT] > connectedUs)
+    stats.heartbeat.add(msSince(lastCommandOfType[EMU_CMD_HEARTBEAT], nowUs));
+  if (command == EMU_CMD_TARE && lastCommandOfType[EMU_CMD_RESET_TIMER] > lastCommandOfType[EMU_CMD_TARE])
+    stats.resetToTare.add(msSince(lastCommandOfType[EMU_CMD_RESET_TIMER], nowUs));
+  if (command == EMU_CMD_START_TIMER && lastCommandOfType[EMU_CMD_TARE] > lastCommandOfType[EMU_CMD_START_TIMER])
+    stats.tareToStart.add(msSince(lastCommandOfType[EMU_CMD_TARE], nowUs));
+  lastCommandOfType[command] = nowUs;
+
+  commandLog[commandLogCount % COMMAND_LOG_SIZE] = CommandLogEntry{nowUs, command};
+  commandLogCount++;
+}
+
+static void onCommand(EmuCommand command, int64_t nowUs)
+{
+  uint8_t frame[FRAME_MAX_LEN];
+  noteCommand(command, nowUs);
+
+  switch (command) {
+    case EMU_CMD_NOTIFICATION_REQUEST:
+      if (!streaming)
+        stats.connectToStream.add(msSince(connectedUs, nowUs));
+      streaming = true;
+      break;
+
+    case EMU_CMD_HEARTBEAT:
+      lastHeartbeatUs = nowUs;
+      break;
+
+    case EMU_CMD_TARE:
+      tareG = config.cupG + coffeeG;
+      if (layout == LAYOUT_ACAIA_NEW)
+        sendFrame(frame, keyEventFrame(0x00, 0x05, frame));
+      break;
+
+    case EMU_CMD_START_TIMER:
+      timerRunning = true;
+      timerStartUs = nowUs;
+      nextTimerEventUs = nowUs + TIMER_EVENT_MS * 1000LL;
+      startShot(nowUs);
+      if (layout == LAYOUT_ACAIA_NEW)
+        sendFrame(frame, keyEventFrame(0x08, 0x05, frame));
+      break;
+
+    case EMU_CMD_STOP_TIMER:
+      timerRunning = false;
+      stopShot(nowUs);
+      if (layout == LAYOUT_ACAIA_NEW)
+        sendFrame(frame, keyEventFrame(0x0a, 0x07, frame));
+      break;
+
+    case EMU_CMD_RESET_TIMER:
+      timerRunning = false;
+      if (layout == LAYOUT_ACAIA_NEW)
+        sendFrame(frame, keyEventFrame(0x09, 0x07, frame));
+      break;
+
+    case EMU_CMD_GET_SETTINGS:
+      if (layout != LAYOUT_FELICITA)
+        sendFrame(frame, settingsFrame(frame));
+      break;
+
+    default:
+      break;
+  }
+}
+
+static void onWritten(BLEDevice central, BLECharacteristic characteristic)
+{
+  int64_t nowUs = esp_timer_get_time();
+  onCommand(decodeCommand(characteristic.value(), characteristic.valueLength()), nowUs);
+  (void)central;
+}
+
+static void onSubscribed(BLEDevice central, BLECharacteristic characteristic)
+{
+  int64_t nowUs = esp_timer_get_time();
+  subscribed = true;
+  stats.connectToSubscribe.add(msSince(connectedUs, nowUs));
+  Serial.printf("CONN subscribed after %.1f ms (MTU %u)\n", msSince(connectedUs, nowUs), central.mtu());
+  if (layout == LAYOUT_FELICITA) {
+    streaming = true;   // Felicita streams as soon as notifications are on
+    stats.connectToStream.add(msSince(connectedUs, nowUs));
+  }
+  (void)characteristic;
+}
+
+static void onConnected(BLEDevice central)
+{
+  int64_t nowUs = esp_timer_get_time();
+  peer = central;
+  connected = true;
+  subscribed = streaming = false;
+  connectedUs = lastHeartbeatUs = nowUs;
+  heldLength = 0;
+  stats.connects++;
+  if (disconnectedUs) {
+    stats.reconnect.add(msSince(disconnectedUs, nowUs));
+    Serial.printf("CONN %s connected, %.1f ms after the link was lost\n", central.address().c_str(),
+                  msSince(disconnectedUs, nowUs));
+  } else {
+    Serial.printf("CONN %s connected\n", central.address().c_str());
+  }
+  if (config.chaosS)
+    nextChaosUs = nowUs + (int64_t)(config.chaosS * 1e6f * (0.5f + uniform()));
+}
+
+static void onDisconnected(BLEDevice central)
+{
+  connected = subscribed = streaming = false;
+  disconnectedUs = esp_timer_get_time();
+  stats.disconnects++;
+  Serial.printf("CONN %s disconnected after %.1f s\n", central.address().c_str(), msSince(connectedUs, disconnectedUs) / 1000.0f);
+}
+
+// -----------------------------------------------------------------------------
+// Serial commands
+// -----------------------------------------------------------------------------
+
+static void printStatus()
+{
+  Serial.printf("[Emulator] %s layout, \"%s\", %s%s\n", LAYOUTS[layout].key, LAYOUTS[layout].localName,
+                connected ? "connected" : "advertising", streaming ? ", streaming" : "");
+  Serial.printf("  rate %.1f Hz, noise %.3f g, cup %.1f g, tare %.2f g, reading %.2f g, battery %u%%\n", config.rateHz,
+                config.noiseG, config.cupG, tareG, config.cupG + coffeeG - tareG, config.batteryPct);
+  Serial.printf("  shot: flow %.2f g/s, delay %.1f s, ramp %.1f s, lag %.2f s, tau %.2f s, goal %.1f g%s\n",
+                config.flowGs, config.delayS, config.rampS, config.lagS, config.tauS, config.goalG,
+                shotRunning ? (shotStopUs ? " - dripping" : " - pouring") : "");
+  Serial.printf("  faults: loss %u%%, merge %u%%, split %u%%, chaos %lu s, heartbeat timeout %lu s\n", config.lossPct,
+                config.mergePct, config.splitPct, (unsigned long)config.chaosS, (unsigned long)config.heartbeatTimeoutS);
+}
+
+static void printReport()
+{
+  Serial.printf("[Report] %lu connects, %lu disconnects (%lu injected)\n", (unsigned long)stats.connects,
+                (unsigned long)stats.disconnects, (unsigned long)stats.injectedDisconnects);
+  Serial.printf("  %lu frames, %lu notifications, %lu lost, %lu merged, %lu split\n", (unsigned long)stats.frames,
+                (unsigned long)stats.notifications, (unsigned long)stats.lost, (unsigned long)stats.merged,
+                (unsigned long)stats.split);
+  stats.reconnect.print("link lost -> connected");
+  stats.connectToSubscribe.print("connected -> subscribed");
+  stats.connectToStream.print("connected -> streaming");
+  stats.heartbeat.print("heartbeat interval");
+  stats.resetToTare.print("RESET_TIMER -> TARE");
+  stats.tareToStart.print("TARE -> START_TIMER");
+  stats.shotToStop.print("START_TIMER -> STOP_TIMER");
+  stats.stopError.print("settled - goal", "g");
+  Serial.print("  commands:");
+  for (uint8_t c = 0; c < EMU_CMD_COUNT; c++) {
+    if (stats.commands[c])
+      Serial.printf(" %s %lu", COMMAND_NAMES[c], (unsigned long)stats.commands[c]);
+  }
+  Serial.println();
+
+  uint8_t shown = min<uint8_t>(commandLogCount, COMMAND_LOG_SIZE);
+  Serial.printf("  last %u commands:\n", shown);
+  for (uint8_t i = 0; i < shown; i++) {
+    const CommandLogEntry &entry = commandLog[(commandLogCount - shown + i) % COMMAND_LOG_SIZE];
+    Serial.printf("    %10.1f ms %s\n", entry.us / 1000.0f, COMMAND_NAMES[entry.command]);
+  }
+}
+
+static void printHelp()
+{
+  Serial.println("layout old|new|felicita   GATT layout (persisted, restarts)");
+  Serial.println("rate <hz>  noise <g>  cup <g>  battery <pct>");
+  Serial.println("flow <g/s>  delay <s>  ramp <s>  lag <s>  tau <s>  goal <g>");
+  Serial.println("loss <pct>  merge <pct>  split <pct>   notification faults");
+  Serial.println("drop  offair <ms>  chaos <s>  hbtimeout <s>   link faults");
+  Serial.println("pour  stop   start / stop a shot without the controller");
+  Serial.println("status  report  clear  help");
+}
+
+static bool setFloat(const char *name, const char *key, const char *value, float *target)
+{
+  if (strcmp(name, key) != 0)
+    return false;
+  *target = max(0.0f, (float)atof(value));
+  return true;
+}
+
+static bool setPct(const char *name, const char *key, const char *value, uint8_t *target)
+{
+  if (strcmp(name, key) != 0)
+    return false;
+  *target = (uint8_t)constrain(atoi(value), 0, 100);
+  return true;
+}
+
+static void runCommand(char *text)
+{
+  char *name = strtok(text, " ");
+  char *value = strtok(NULL, " ");
+  if (!name)
+    return;
+  int64_t nowUs = esp_timer_get_time();
+
+  if (strcmp(name, "layout") == 0 && value) {
+    for (uint8_t l = 0; l < LAYOUT_COUNT; l++) {
+      if (strcmp(value, LAYOUTS[l].key) == 0) {
+        prefs.putUChar("layout", l);
+        Serial.printf("Layout %s - restarting\n", LAYOUTS[l].key);
+        Serial.flush();
+        ESP.restart();
+      }
+    }
+    Serial.println("Usage: layout old|new|felicita");
+    return;
+  }
+
+  if (value && (setFloat(name, "rate", value, &config.rateHz) || setFloat(name, "noise", value, &config.noiseG) ||
+                setFloat(name, "cup", value, &config.cupG) || setFloat(name, "flow", value, &config.flowGs) ||
+                setFloat(name, "delay", value, &config.delayS) || setFloat(name, "ramp", value, &config.rampS) ||
+                setFloat(name, "lag", value, &config.lagS) || setFloat(name, "tau", value, &config.tauS) ||
+                setFloat(name, "goal", value, &config.goalG) || setPct(name, "battery", value, &config.batteryPct) ||
+                setPct(name, "loss", value, &config.lossPct) || setPct(name, "merge", value, &config.mergePct) ||
+                setPct(name, "split", value, &config.splitPct))) {
+    config.rateHz = constrain(config.rateHz, 1.0f, 100.0f);
+    if (layout != LAYOUT_ACAIA_NEW && (config.mergePct || config.splitPct))
+      Serial.println("Note: merge / split only apply to the new (framed) layout");
+    printStatus();
+    return;
+  }
+
+  if (strcmp(name, "chaos") == 0 && value) {
+    config.chaosS = atoi(value);
+    nextChaosUs = config.chaosS ? nowUs + config.chaosS * 1000000LL : 0;
+    printStatus();
+  } else if (strcmp(name, "hbtimeout") == 0 && value) {
+    config.heartbeatTimeoutS = atoi(value);
+    printStatus();
+  } else if (strcmp(name, "drop") == 0) {
+    injectDisconnect("disconnect", 0);
+  } else if (strcmp(name, "offair") == 0 && value) {
+    injectDisconnect("disconnect", atoi(value));
+  } else if (strcmp(name, "pour") == 0) {
+    startShot(nowUs);
+  } else if (strcmp(name, "stop") == 0) {
+    stopShot(nowUs);
+  } else if (strcmp(name, "status") == 0) {
+    printStatus();
+  } else if (strcmp(name, "report") == 0) {
+    printReport();
+  } else if (strcmp(name, "clear") == 0) {
+    stats = EmuStats();
+    commandLogCount = 0;
+    Serial.println("Counters cleared");
+  } else {
+    printHelp();
+  }
+}
+
+static void pollSerial()
+{
+  while (Serial.available()) {
+    char c = Serial.read();
+    if (c == '\r' || c == '\n') {
+      line[lineLength] = '\0';
+      if (lineLength)
+        runCommand(line);
+      lineLength = 0;
+    } else if (lineLength < sizeof(line) - 1) {
+      line[lineLength++] = c;
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Setup / loop
+// -----------------------------------------------------------------------------
+
+void setup()
+{
+  Serial.begin(SERIAL_BAUD);
+  prefs.begin("scaleemu", false);
+  layout = (Layout)prefs.getUChar("layout", LAYOUT_ACAIA_NEW);
+  if (layout >= LAYOUT_COUNT)
+    layout = LAYOUT_ACAIA_NEW;
+  const LayoutInfo &info = LAYOUTS[layout];
+
+  if (!BLE.begin()) {
+    Serial.println("BLE.begin() failed");
+    while (true)
+      delay(1000);
+  }
+
+  scaleService = new BLEService(info.service);
+  bool shared = strcmp(info.readUuid, info.writeUuid) == 0;
+  readChar = new BLECharacteristic(info.readUuid, BLERead | BLENotify | (shared ? (BLEWrite | BLEWriteWithoutResponse) : 0),
+                                   NOTIFY_MAX_LEN);
+  writeChar = shared ? readChar : new BLECharacteristic(info.writeUuid, BLEWrite | BLEWriteWithoutResponse, NOTIFY_MAX_LEN);
+  scaleService->addCharacteristic(*readChar);
+  if (!shared)
+    scaleService->addCharacteristic(*writeChar);
+  readChar->setEventHandler(BLESubscribed, onSubscribed);
+  writeChar->setEventHandler(BLEWritten, onWritten);
+
+  BLE.setLocalName(info.localName);
+  BLE.setDeviceName(info.localName);
+  BLE.setAdvertisedService(*scaleService);
+  BLE.addService(*scaleService);
+  BLE.setEventHandler(BLEConnected, onConnected);
+  BLE.setEventHandler(BLEDisconnected, onDisconnected);
+  BLE.advertise();
+
+  Serial.printf("Scale emulator: %s layout as \"%s\" (%s) - \"help\" for commands\n", info.key, info.localName,
+                BLE.address().c_str());
+  nextSampleUs = esp_timer_get_time();
+}
+
+void loop()
+{
+  BLE.poll();
+  pollSerial();
+  int64_t nowUs = esp_timer_get_time();
+
+  // Weight samples on a fixed grid
+  if (nowUs >= nextSampleUs) {
+    sampleTick(nowUs);
+    nextSampleUs += (int64_t)(1e6f / config.rateHz);
+    if (nowUs - nextSampleUs > 1000000)
+      nextSampleUs = nowUs;   // Rate changed or the loop stalled: no burst to catch up
+  }
+
+  if (streaming && timerRunning && layout == LAYOUT_ACAIA_NEW && nowUs >= nextTimerEventUs) {
+    uint8_t frame[FRAME_MAX_LEN];
+    sendFrame(frame, timerEventFrame((uint32_t)((nowUs - timerStartUs) / 1000), frame));
+    nextTimerEventUs += TIMER_EVENT_MS * 1000LL;
+  }
+  if (heldLength && nowUs - heldUs > MERGE_HOLD_MAX_US)
+    flushHeld();
+
+  // Link faults
+  if (connected && config.chaosS && nextChaosUs && nowUs >= nextChaosUs) {
+    nextChaosUs = 0;
+    injectDisconnect("chaos", (uint32_t)(uniform() * 3000));
+  }
+  if (connected && config.heartbeatTimeoutS && layout != LAYOUT_FELICITA &&
+      nowUs - lastHeartbeatUs > config.heartbeatTimeoutS * 1000000LL) {
+    lastHeartbeatUs = nowUs;
+    injectDisconnect("heartbeat timeout", 0);
+  }
+  if (offairPending && !connected) {
+    BLE.stopAdvertise();   // Advertising restarts by itself after a disconnect
+    offairPending = false;
+  }
+  if (offairUntilUs && !offairPending && nowUs >= offairUntilUs) {
+    offairUntilUs = 0;
+    BLE.advertise();
+    Serial.println("CONN advertising again");
+  }
+}
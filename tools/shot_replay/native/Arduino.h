@@ -0,0 +1,29 @@
+#ifndef SHOT_REPLAY_ARDUINO_H
+#define SHOT_REPLAY_ARDUINO_H
+
+// =============================================================================
+// Minimal Arduino.h for the host builds of the shot engine (env:native,
+// env:core_bench)
+// =============================================================================
+// Only what the platform-free shot modules and the scale drivers use:
+// fixed-width integers, math, min/max/constrain, and Print by name for the
+// dump declarations in their headers. Anything FreeRTOS/ESP
+// specific must stay out of the modules compiled by tools/shot_replay and
+// tools/core_bench, and will fail to build here if it creeps in.
+// =============================================================================
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+
+using std::min;
+using std::max;
+
+class Print;   // Declared, never defined: the host builds do not compile the dump functions
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+#endif // SHOT_REPLAY_ARDUINO_H
@@ -0,0 +1,55 @@
+#ifndef SHOT_REPLAY_PREFERENCES_H
+#define SHOT_REPLAY_PREFERENCES_H
+
+// =============================================================================
+// In-Memory Preferences for the host build (env:native)
+// =============================================================================
+// Same calls the firmware modules make on the ESP32 NVS wrapper; values live
+// for the lifetime of the process, so every replay run starts from defaults.
+// =============================================================================
+
+#include <map>
+#include <string>
+#include <vector>
+#include <string.h>
+
+class Preferences {
+public:
+  bool begin(const char *name, bool readOnly = false)
+  {
+    space = name;
+    (void)readOnly;
+    return true;
+  }
+
+  void end() {}
+
+  size_t putBytes(const char *key, const void *value, size_t len)
+  {
+    const uint8_t *bytes = static_cast<const uint8_t *>(value);
+    store()[qualified(key)].assign(bytes, bytes + len);
+    return len;
+  }
+
+  size_t getBytes(const char *key, void *buf, size_t maxLen)
+  {
+    std::map<std::string, std::vector<uint8_t> >::const_iterator it = store().find(qualified(key));
+    if (it == store().end() || it->second.size() > maxLen)
+      return 0;
+    memcpy(buf, it->second.data(), it->second.size());
+    return it->second.size();
+  }
+
+private:
+  std::string qualified(const char *key) const { return space + "/" + key; }
+
+  static std::map<std::string, std::vector<uint8_t> > &store()
+  {
+    static std::map<std::string, std::vector<uint8_t> > values;
+    return values;
+  }
+
+  std::string space;
+};
+
+#endif // SHOT_REPLAY_PREFERENCES_H
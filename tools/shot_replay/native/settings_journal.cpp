@@ -0,0 +1,14 @@
+// =============================================================================
+// Settings Journal for the host build (env:native)
+// =============================================================================
+// No journal partition on a PC: every call reports it unavailable, so
+// offset_model.cpp falls back to Preferences (in memory here), as it does on
+// boards whose partition table has no journal.
+// =============================================================================
+
+#include "settings_journal.h"
+
+bool journalBegin() { return false; }
+bool journalReady() { return false; }
+size_t journalRead(JournalKey, void *, size_t) { return 0; }
+bool journalWrite(JournalKey, const void *, size_t) { return false; }
@@ -0,0 +1,492 @@
+// =============================================================================
+// Shot Replay - feed recorded weight traces through the stop engine on a host
+// =============================================================================
+// Runs src/shot_predictor.h (filter → trend → expected end) and, with --learn,
+// src/offset_model.cpp exactly as the firmware does, one trace after another:
+//
+//   trace.csv ──► ShotPredictor::add() per sample ──► expectedEnd() ──► cut-off
+//
+// The cut-off is modelled like the firmware's esp_timer: after each sample the
+// stop is scheduled at the expected end, and it fires there if no later
+// sample arrives first.
+//
+// Per trace it reports the first drip and flow onset (flow_onset.h), any
+// channeling / choke flag (flow_anomaly.h), the stop decision time, the yield
+// error and the CPU time per sample. The cup is estimated as the recorded weight at
+// (decision + latency) plus the residual drip given by --offset, so
+// yield error = that estimate - goal. With --learn the offset the predictor
+// uses comes from offset_model and converges on drip + predictor bias, while
+// --offset stays the physical drip. For clean numbers, record traces that run
+// past the simulated stop (e.g. shots pulled to a higher goal).
+//
+// Trace format: one sample per line, "t_s,weight_g". Lines may carry any
+// prefix up to "TRACE," (firmware built with -DGS_SHOT_TRACE logs exactly
+// that), so a raw serial capture can be replayed as is. Other lines are
+// ignored.
+//
+// Event traces ("shottrace <id>" on the console, src/shot_events.h) are read
+// too: GSH carries the shot's settings, GSE,W the raw samples with their
+// sample-clock and arrival times in microseconds. Their samples are dated
+// against pump-on exactly as processWeightSample() does, and the cut-off is
+// modelled in microseconds: scheduled at the expected end, fired unless the
+// next sample arrives first. With --recorded each event trace runs with its
+// own settings, and the scheduled cut the replay arrives at is compared with
+// the one the relay recorded.
+//
+// Build: pio run -e native   (or see tools/shot_replay/README.md)
+// =============================================================================
+
+#include <Arduino.h>
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include "shot_predictor.h"
+#include "offset_model.h"
+#include "sample_clock.h"
+
+struct TraceSample {
+  float t;
+  float weight;
+  int32_t arrivalUs;               // Event traces: arrival since pump-on; -1 = not recorded
+};
+
+struct ReplayOptions {
+  uint8_t goal = 36;
+  float offset = 1.5f;             // Residual drip after the latency (what weightOffset carries)
+  float latencyS = 0.02f;          // Relay + whatever tail the stop model has learned
+  float processNoise = 1.0f;       // WeightFilter defaults (Acaia driver values)
+  float measurementNoise = 0.01f;
+  bool learn = false;
+  uint8_t estimator = STOP_ESTIMATOR_LINEAR;   // STOP_ESTIMATOR_COUNT = each in turn
+  bool clock = false;              // Re-date arrival-time traces through SampleClock
+  bool recorded = false;           // Event traces run with the settings in their GSH line
+};
+
+struct Trace {
+  std::vector<TraceSample> samples;
+  bool events = false;             // GSH line seen: an event trace from the firmware
+  ReplayOptions settings;          // What the machine ran the shot with (event traces)
+  uint32_t shotId = 0;
+  int32_t startUs = 0;             // Pump on, since the trace origin
+  int32_t cutUs = -1;              // Scheduled cut that switched the pump off, since pump-on; -1 = none
+  int32_t offUs = -1;              // First pump-off edge after pump-on; -1 = none
+  unsigned endReason = 5;          // ShotEndReason (UNDEFINED until the GSE,E line)
+  float finalG = NAN;
+  unsigned commands = 0;
+  unsigned acks = 0;
+  unsigned dropped = 0;
+};
+
+struct ReplayResult {
+  bool stopped;
+  float decisionS;
+  float cutWeightG;                // Recorded weight at decision + latency
+  float dripS;                     // First drip, -1 = none
+  float onsetS;                    // Steady flow onset, -1 = none
+  uint8_t anomaly;                 // FLOW_ANOMALY_* raised
+  float anomalyS;
+  double meanNsPerSample;
+  double maxNsPerSample;
+  int32_t cutUs;                   // Event traces: scheduled cut, since pump-on; -1 = none
+};
+
+static const char *const END_REASONS[] = {"weight", "time", "button", "disconn", "user", "?", "anomaly"};
+
+// As shotOffsetS() (src/mono_time.h): one int to float conversion of the exact difference
+static float offsetS(int32_t offsetUs)
+{
+  return (float)offsetUs / 1000000.0f;
+}
+
+static bool parseSample(const char *line, TraceSample *out)
+{
+  const char *p = strstr(line, "TRACE,");
+  p = (p != NULL) ? p + 6 : line;
+  if (!((*p >= '0' && *p <= '9') || *p == '-' || *p == '.'))
+    return false;
+  return sscanf(p, "%f,%f", &out->t, &out->weight) == 2;
+}
+
+// GSH,<version>,<id>,<goal>,<offset>,<latency>,<q>,<r>,<estimator>,<profile>,<end>,<start_us>,<events>,<dropped>
+static bool parseHeader(const char *p, Trace *trace)
+{
+  unsigned version, profile, end, events, dropped;
+  unsigned long id;
+  float goal;
+  char estimator[16];
+  ReplayOptions &o = trace->settings;
+  if (sscanf(p, "%u,%lu,%f,%f,%f,%f,%f,%15[^,],%u,%u,%d,%u,%u", &version, &id, &goal, &o.offset, &o.latencyS,
+             &o.processNoise, &o.measurementNoise, estimator, &profile, &end, &trace->startUs, &events, &dropped) != 13 ||
+      version != 1)
+    return false;
+  o.goal = (uint8_t)lroundf(goal);
+  o.estimator = stopEstimatorParse(estimator);
+  if (o.estimator == STOP_ESTIMATOR_COUNT)
+    o.estimator = STOP_ESTIMATOR_LINEAR;
+  trace->shotId = (uint32_t)id;
+  trace->endReason = end;
+  trace->dropped = dropped;
+  trace->events = true;
+  return true;
+}
+
+// GSE,<type>,<t_us>,... - times since the trace origin, kept relative to pump-on
+static void parseEvent(const char *p, Trace *trace)
+{
+  char type = p[0];
+  int32_t tUs;
+  if (!trace->events || p[1] != ',' || sscanf(p + 2, "%d", &tUs) != 1)
+    return;
+  const char *rest = strchr(p + 2, ',');
+  rest = rest ? rest + 1 : "";
+  int32_t sinceStart = tUs - trace->startUs;
+
+  if (type == 'W')
+  {
+    TraceSample s;
+    int32_t arrivalUs;
+    // Buffered before pump-on: not part of the shot's curve, as in processWeightSample()
+    if (sscanf(rest, "%f,%d", &s.weight, &arrivalUs) != 2 || sinceStart < 0)
+      return;
+    s.t = offsetS(sinceStart);
+    s.arrivalUs = arrivalUs - trace->startUs;
+    if (trace->samples.empty() || s.t >= trace->samples.back().t)
+      trace->samples.push_back(s);
+  }
+  else if (type == 'C')
+    trace->commands++;
+  else if (type == 'A')
+    trace->acks++;
+  else if (type == 'R')
+  {
+    unsigned group, on;
+    int32_t scheduledUs;
+    if (sscanf(rest, "%u,%u,%d", &group, &on, &scheduledUs) == 3 && group == 0 && !on && sinceStart >= 0 &&
+        trace->offUs < 0)
+    {
+      trace->offUs = sinceStart;
+      if (scheduledUs >= 0)
+        trace->cutUs = scheduledUs - trace->startUs;
+    }
+  }
+  else if (type == 'E')
+  {
+    unsigned reason;
+    if (sscanf(rest, "%u,%f", &reason, &trace->finalG) == 2)
+      trace->endReason = reason;
+  }
+}
+
+static bool loadTrace(const char *path, Trace *trace)
+{
+  FILE *f = fopen(path, "r");
+  if (f == NULL)
+    return false;
+
+  char line[256];
+  TraceSample s;
+  s.arrivalUs = -1;
+  while (fgets(line, sizeof(line), f) != NULL)
+  {
+    const char *p;
+    if ((p = strstr(line, "GSH,")) != NULL)
+      parseHeader(p + 4, trace);
+    else if ((p = strstr(line, "GSE,")) != NULL)
+      parseEvent(p + 4, trace);
+    else if (!trace->events && parseSample(line, &s) && (trace->samples.empty() || s.t >= trace->samples.back().t))
+      trace->samples.push_back(s);
+  }
+  fclose(f);
+  return true;
+}
+
+// Traces recorded before sample_clock.h carry arrival times: put them on the sample grid as the firmware does now
+static void redate(std::vector<TraceSample> *samples)
+{
+  SampleClock clock;
+  const int64_t originUs = 1000000;   // Keeps the grid clear of 0
+  for (size_t i = 0; i < samples->size(); i++)
+  {
+    TraceSample &s = (*samples)[i];
+    int64_t us = clock.update(originUs + (int64_t)llround(s.t * 1e6));
+    s.t = (float)((us - originUs) / 1e6);
+  }
+}
+
+// Recorded weight at time t (linear between samples, held at the ends)
+static float weightAt(const std::vector<TraceSample> &samples, float t)
+{
+  if (t <= samples.front().t)
+    return samples.front().weight;
+  for (size_t i = 1; i < samples.size(); i++)
+  {
+    if (samples[i].t >= t)
+    {
+      const TraceSample &a = samples[i - 1];
+      const TraceSample &b = samples[i];
+      float span = b.t - a.t;
+      return (span > 0.0f) ? a.weight + (b.weight - a.weight) * (t - a.t) / span : b.weight;
+    }
+  }
+  return samples.back().weight;
+}
+
+static ReplayResult replay(const std::vector<TraceSample> &samples, const ReplayOptions &opt, float offset)
+{
+  typedef std::chrono::steady_clock Clock;
+
+  ShotPredictor predictor;
+  predictor.reset();
+  predictor.select(opt.estimator);
+  predictor.filter.setNoise(opt.processNoise, opt.measurementNoise);
+
+  ReplayResult r = { false, 0.0f, 0.0f, -1.0f, -1.0f, 0, -1.0f, 0.0, 0.0, -1 };
+  double totalNs = 0.0;
+  size_t fed = 0;
+
+  for (size_t i = 0; i < samples.size() && !r.stopped; i++)
+  {
+    const TraceSample &s = samples[i];
+
+    Clock::time_point begin = Clock::now();
+    predictor.add(s.t, s.weight);
+    float expected = predictor.expectedEnd(opt.goal, offset, opt.latencyS);
+    Clock::time_point end = Clock::now();
+
+    double ns = std::chrono::duration<double, std::nano>(end - begin).count();
+    totalNs += ns;
+    if (ns > r.maxNsPerSample)
+      r.maxNsPerSample = ns;
+    fed++;
+
+    if (s.arrivalUs >= 0)
+    {
+      // Event trace: relayControlScheduleOff(monoAfterS(start, max(expected, MIN))), fired
+      // unless the next sample reaches the control task first
+      int32_t cutUs = (expected < MAX_SHOT_DURATION_S)
+                          ? (int32_t)(max(expected, (float)MIN_SHOT_DURATION_S) * 1000000.0f) : INT32_MAX;
+      int32_t nextUs = (i + 1 < samples.size()) ? samples[i + 1].arrivalUs : INT32_MAX;
+      if (cutUs < INT32_MAX && cutUs <= nextUs)
+      {
+        r.stopped = true;
+        r.cutUs = cutUs;
+        r.decisionS = offsetS(cutUs);
+        continue;
+      }
+    }
+    else
+    {
+      // Timer cut at the expected end, unless the next sample arrives first
+      float nextT = (i + 1 < samples.size()) ? samples[i + 1].t : s.t;
+      float cutAt = max(expected, s.t);
+      if (expected < MAX_SHOT_DURATION_S && cutAt <= nextT && ShotPredictor::stopDue(cutAt, expected))
+      {
+        r.stopped = true;
+        r.decisionS = cutAt;
+        continue;
+      }
+    }
+    if (ShotPredictor::stopDue(s.t, MAX_SHOT_DURATION_S))
+    {
+      r.stopped = true;  // Max-time stop, like handleShotWatchdogs()
+      r.decisionS = s.t;
+    }
+  }
+
+  if (r.stopped)
+    r.cutWeightG = weightAt(samples, r.decisionS + opt.latencyS);
+  r.dripS = predictor.onset.dripS();
+  r.onsetS = predictor.onset.onsetS();
+  r.anomaly = predictor.anomaly.flags();
+  r.anomalyS = predictor.anomaly.anomalyS();
+  r.meanNsPerSample = fed ? totalNs / fed : 0.0;
+  return r;
+}
+
+static void printAnomaly(const ReplayResult &r)
+{
+  if (r.anomaly)
+    printf("%-32s %s from %.2f s\n", "", FlowAnomaly::name(r.anomaly), r.anomalyS);
+}
+
+// Event traces: what the machine did, and with --recorded whether the replay cut at the same microsecond
+static bool printRecorded(const Trace &trace, const ReplayResult &r, bool asRecorded)
+{
+  if (!trace.events)
+    return true;
+  char machine[48];
+  if (trace.cutUs >= 0)
+    snprintf(machine, sizeof(machine), "cut scheduled at %.6f s", offsetS(trace.cutUs));
+  else if (trace.offUs >= 0)
+    snprintf(machine, sizeof(machine), "pump off at %.6f s", offsetS(trace.offUs));
+  else
+    snprintf(machine, sizeof(machine), "no pump-off edge");
+  printf("%-32s shot #%u: %s, end %s, %.2f g; %u commands, %u acks", "", (unsigned)trace.shotId, machine,
+         END_REASONS[trace.endReason < 7 ? trace.endReason : 5], trace.finalG, trace.commands, trace.acks);
+  if (trace.dropped)
+    printf(", %u events lost", trace.dropped);
+  printf("\n");
+
+  if (!asRecorded || trace.cutUs < 0)
+    return true;
+  if (r.cutUs == trace.cutUs)
+  {
+    printf("%-32s replay cut: identical\n", "");
+    return true;
+  }
+  if (r.cutUs >= 0)
+    printf("%-32s replay cut: %+d us from the machine's\n", "", (int)(r.cutUs - trace.cutUs));
+  else
+    printf("%-32s replay cut: none (%s)\n", "", r.stopped ? "max time" : "not stopped");
+  return false;
+}
+
+static void usage()
+{
+  fprintf(stderr,
+          "usage: shot_replay [--goal G] [--offset O] [--latency S] [--noise Q R] [--learn] [--estimator E] [--clock]\n"
+          "                   [--recorded] trace...\n"
+          "  --goal G      target weight in g (default 36)\n"
+          "  --offset O    drip after the latency in g, the offset used without --learn (default 1.5)\n"
+          "  --latency S   stop latency in s, see stopModelLatencyS() (default 0.02)\n"
+          "  --noise Q R   WeightFilter process / measurement noise (default 1.0 0.01)\n"
+          "  --learn       learn the offset across traces through offset_model\n"
+          "  --estimator E linear, quadratic, model or all (default linear, see stop_estimator.h)\n"
+          "  --clock       trace times are packet arrivals: re-date them through sample_clock.h\n"
+          "  --recorded    event traces (shottrace) run with the settings they were recorded with and\n"
+          "                their cut is checked against the machine's; exit status 1 if one differs\n");
+}
+
+// One pass over all traces with opt.estimator; exit status
+static int replayAll(const std::vector<const char *> &traces, const ReplayOptions &opt)
+{
+  if (opt.learn)
+    offsetModelBegin(opt.goal, opt.offset);
+
+  printf("%-32s %7s %7s %7s %8s %8s %9s %9s %9s\n", "trace", "samples", "drip_s", "onset_s", "offset", "stop_s", "error_g",
+         "ns/sample", "max_ns");
+
+  double sumAbs = 0.0, sumSq = 0.0, worst = 0.0;
+  int scored = 0;
+  int status = 0;
+
+  for (size_t t = 0; t < traces.size(); t++)
+  {
+    Trace trace;
+    std::vector<TraceSample> &samples = trace.samples;
+    if (!loadTrace(traces[t], &trace) || samples.size() < 2)
+    {
+      fprintf(stderr, "%s: unreadable or fewer than 2 samples\n", traces[t]);
+      status = 1;
+      continue;
+    }
+    if (opt.clock && !trace.events)
+      redate(&samples);   // Event traces are on the sample grid already
+
+    bool asRecorded = opt.recorded && trace.events;
+    const ReplayOptions &run = asRecorded ? trace.settings : opt;
+    float offset = (opt.learn && !asRecorded) ? offsetModelGet(opt.goal, NULL) : run.offset;
+    ReplayResult r = replay(samples, run, offset);
+
+    if (!r.stopped)
+    {
+      printf("%-32s %7u %7.2f %7.2f %8.2f %8s %9s %9.0f %9.0f\n", traces[t], (unsigned)samples.size(), r.dripS,
+             r.onsetS, offset, "-", "-", r.meanNsPerSample, r.maxNsPerSample);
+      printAnomaly(r);
+      if (!printRecorded(trace, r, asRecorded))
+        status = 1;
+      continue;
+    }
+
+    float finalWeight = r.cutWeightG + run.offset;
+    double e = finalWeight - run.goal;
+    printf("%-32s %7u %7.2f %7.2f %8.2f %8.2f %+9.2f %9.0f %9.0f\n", traces[t], (unsigned)samples.size(), r.dripS,
+           r.onsetS, offset, r.decisionS, e, r.meanNsPerSample, r.maxNsPerSample);
+    printAnomaly(r);
+    if (!printRecorded(trace, r, asRecorded))
+      status = 1;
+
+    sumAbs += fabs(e);
+    sumSq += e * e;
+    if (fabs(e) > worst)
+      worst = fabs(e);
+    scored++;
+
+    // As after the drips in the firmware
+    if (opt.learn && !asRecorded)
+      offsetModelRecord(opt.goal, offset, finalWeight);
+  }
+
+  if (scored > 0)
+    printf("\n%s: %d stopped, mean |error| %.2f g, rms %.2f g, worst %.2f g\n",
+           opt.recorded ? "as recorded" : stopEstimatorName(opt.estimator),
+           scored, sumAbs / scored, sqrt(sumSq / scored), worst);
+  return status;
+}
+
+int main(int argc, char **argv)
+{
+  ReplayOptions opt;
+  std::vector<const char *> traces;
+
+  for (int i = 1; i < argc; i++)
+  {
+    if (!strcmp(argv[i], "--goal") && i + 1 < argc)
+      opt.goal = (uint8_t)atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--offset") && i + 1 < argc)
+      opt.offset = (float)atof(argv[++i]);
+    else if (!strcmp(argv[i], "--latency") && i + 1 < argc)
+      opt.latencyS = (float)atof(argv[++i]);
+    else if (!strcmp(argv[i], "--noise") && i + 2 < argc)
+    {
+      opt.processNoise = (float)atof(argv[++i]);
+      opt.measurementNoise = (float)atof(argv[++i]);
+    }
+    else if (!strcmp(argv[i], "--learn"))
+      opt.learn = true;
+    else if (!strcmp(argv[i], "--clock"))
+      opt.clock = true;
+    else if (!strcmp(argv[i], "--recorded"))
+      opt.recorded = true;
+    else if (!strcmp(argv[i], "--estimator") && i + 1 < argc)
+    {
+      const char *name = argv[++i];
+      opt.estimator = strcmp(name, "all") == 0 ? static_cast<uint8_t>(STOP_ESTIMATOR_COUNT) : stopEstimatorParse(name);
+      if (opt.estimator == STOP_ESTIMATOR_COUNT && strcmp(name, "all") != 0)
+      {
+        usage();
+        return 2;
+      }
+    }
+    else if (argv[i][0] == '-')
+    {
+      usage();
+      return 2;
+    }
+    else
+      traces.push_back(argv[i]);
+  }
+
+  if (traces.empty())
+  {
+    usage();
+    return 2;
+  }
+
+  if (opt.recorded && opt.estimator == STOP_ESTIMATOR_COUNT)
+    opt.estimator = STOP_ESTIMATOR_LINEAR;   // Event traces bring their own; plain ones get the default
+  if (opt.estimator < STOP_ESTIMATOR_COUNT)
+    return replayAll(traces, opt);
+
+  int status = 0;
+  for (uint8_t kind = 0; kind < STOP_ESTIMATOR_COUNT; kind++)
+  {
+    opt.estimator = kind;
+    if (kind > 0)
+      printf("\n");
+    status |= replayAll(traces, opt);
+  }
+  return status;
+}
@@ -0,0 +1,15 @@
+# PlatformIO extra script for GS_UI_ASSETS=2 builds (src/ui_assets.h).
+#
+# Leaves the SquareLine image arrays (lib/ui/src/images/*.c) out of the
+# build: the icons come from the "assets" partition and src/ui_assets.cpp
+# defines empty stand-in descriptors. lib/ui itself stays untouched, so a
+# new SquareLine export drops in as before.
+
+Import("env")
+
+
+def skip(node):
+    return None
+
+
+env.AddBuildMiddleware(skip, "*/ui/src/images/*.c")
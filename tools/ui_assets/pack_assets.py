@@ -0,0 +1,115 @@
+#!/usr/bin/env python3
+"""Pack the UI images into an image for the "assets" flash partition.
+
+The firmware maps the partition with esp_partition_mmap() and an LVGL image
+decoder hands out pointers into it in place of the compiled-in
+lib/ui/src/images arrays (see src/ui_assets.h). Layout, little-endian:
+
+  header   magic "GSUA" (u32), version (u16), count (u16), bytes (u32), crc32 (u32)
+  entries  count x { name (char[24], NUL padded), offset (u32), size (u32) }
+  images   LVGL .bin images (4-byte lv_img_header_t + pixels), 4-byte aligned
+
+crc32 covers everything after the header (entries + images). `name` is the
+SquareLine symbol without "ui_img_" / "_png" (flush, coffee, ...).
+
+By default every image is taken from its SquareLine C array, so the output
+matches the firmware exactly. A theme replaces some of them with LVGL
+binary images of the same name (LVGL image converter, "Binary" output,
+True color with alpha, RGB565 swapped - as lv_conf.h):
+
+  tools/ui_assets/pack_assets.py -o assets.bin
+  tools/ui_assets/pack_assets.py -o assets.bin --theme mytheme/     (mytheme/flush.bin, ...)
+  esptool.py --chip esp32s3 write_flash 0x520000 assets.bin
+
+Only the standard library is needed.
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+import zlib
+
+MAGIC = 0x41555347  # "GSUA"
+VERSION = 1
+NAME_LEN = 24
+PARTITION_BYTES = 0x20000  # partitions.csv "assets"
+
+CF = {"LV_IMG_CF_TRUE_COLOR": 4, "LV_IMG_CF_TRUE_COLOR_ALPHA": 5, "LV_IMG_CF_TRUE_COLOR_CHROMA_KEYED": 6}
+
+DATA = re.compile(r"uint8_t\s+ui_img_(\w+)_png_data\[\]\s*=\s*\{(.*?)\};", re.S)
+FIELD = re.compile(r"\.header\.(w|h|cf)\s*=\s*(\w+)")
+
+
+def img_header(cf, w, h):
+    return struct.pack("<I", cf | (w << 10) | (h << 21))
+
+
+def from_c(path):
+    text = open(path).read()
+    data = DATA.search(text)
+    if data is None:
+        sys.exit("%s: no ui_img_*_png_data array" % path)
+    fields = dict(FIELD.findall(text))
+    if fields.get("cf") not in CF:
+        sys.exit("%s: color format %s not supported" % (path, fields.get("cf")))
+    pixels = bytes(int(b, 16) for b in re.findall(r"0x([0-9a-fA-F]{2})", data.group(2)))
+    return data.group(1), img_header(CF[fields["cf"]], int(fields["w"]), int(fields["h"])) + pixels
+
+
+def check_bin(name, blob):
+    (word,) = struct.unpack_from("<I", blob)
+    cf, w, h = word & 0x1F, (word >> 10) & 0x7FF, (word >> 21) & 0x7FF
+    if cf not in CF.values():
+        sys.exit("%s: color format %d not supported (true color variants only)" % (name, cf))
+    bpp = 3 if cf == 5 else 2
+    if len(blob) - 4 != w * h * bpp:
+        sys.exit("%s: %dx%d expects %d pixel bytes, file has %d" % (name, w, h, w * h * bpp, len(blob) - 4))
+    return blob
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("-o", "--output", required=True, help="partition image to write")
+    parser.add_argument("--images", default="lib/ui/src/images", help="SquareLine image sources")
+    parser.add_argument("--theme", help="directory of <name>.bin LVGL images replacing the defaults")
+    args = parser.parse_args()
+
+    images = {}
+    for file in sorted(os.listdir(args.images)):
+        if file.endswith(".c"):
+            name, blob = from_c(os.path.join(args.images, file))
+            images[name] = blob
+    if args.theme:
+        for file in sorted(os.listdir(args.theme)):
+            name, ext = os.path.splitext(file)
+            if ext != ".bin":
+                continue
+            if name not in images:
+                print("warning: %s is not a UI image name, packed anyway" % name, file=sys.stderr)
+            images[name] = check_bin(file, open(os.path.join(args.theme, file), "rb").read())
+
+    header_len = 16
+    dir_end = header_len + len(images) * (NAME_LEN + 8)
+    entries, body = b"", bytearray()
+    for name, blob in images.items():
+        if len(name) >= NAME_LEN:
+            sys.exit("%s: name longer than %d characters" % (name, NAME_LEN - 1))
+        while (dir_end + len(body)) % 4:
+            body += b"\0"
+        entries += struct.pack("<%dsII" % NAME_LEN, name.encode(), dir_end + len(body), len(blob))
+        body += blob
+
+    payload = entries + bytes(body)
+    total = header_len + len(payload)
+    if total > PARTITION_BYTES:
+        sys.exit("%d bytes do not fit the %d byte assets partition" % (total, PARTITION_BYTES))
+    with open(args.output, "wb") as out:
+        out.write(struct.pack("<IHHII", MAGIC, VERSION, len(images), total, zlib.crc32(payload)))
+        out.write(payload)
+    print("%s: %d images, %d bytes" % (args.output, len(images), total))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,37 @@
+#ifndef UI_BENCH_ARDUINO_H
+#define UI_BENCH_ARDUINO_H
+
+// =============================================================================
+// Minimal Arduino.h for the host UI benchmark (env:ui_bench)
+// =============================================================================
+// lv_conf.h takes LVGL's tick from millis() via this header, so it is included
+// from LVGL's C sources as well as from the C++ modules. millis() is the
+// benchmark's simulated clock (tools/ui_bench/ui_bench.cpp), which lets a 30 s
+// shot replay in well under a second while timers and animations still see
+// real time pass.
+// =============================================================================
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint32_t millis(void);
+
+#ifdef __cplusplus
+}
+
+#include <algorithm>
+
+using std::min;
+using std::max;
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#endif
+
+#endif // UI_BENCH_ARDUINO_H
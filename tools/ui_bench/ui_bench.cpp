@@ -0,0 +1,490 @@
+// =============================================================================
+// UI Bench - render cost of the real SquareLine screens on a host
+// =============================================================================
+// Builds lib/ui (ui_MainScreen.c, ui_SettingScreen.c) and src/shot_chart.cpp
+// against a headless 640x180 display and replays a typical session:
+//
+//   startup   first full frame after ui_init()
+//   idle      connected, weight jitter at packet rate
+//   shot      timer + weight labels, chart points, status lines, ~30 s shot
+//   settings  screen change to settings, backlight slider drag, back
+//
+// Label updates go through the firmware's NumericLabel (src/label_bind.h) and
+// LabelGate (src/label_gate.h) with the same formats and intervals as
+// processUIUpdates(), and
+// the display driver uses the firmware's rounder (full-width strips), so the
+// invalidated area per frame is what the panel would receive.
+//
+// Time is simulated: millis() advances in BENCH_STEP_MS steps, so timers and
+// animations behave as on the device while the run takes well under a second.
+// Render time is host wall time around lv_timer_handler() for the frames that
+// flushed. Absolute numbers are not ESP32 numbers, but a screen redesign that
+// costs more shows up in both columns. The per-frame CSV (--csv) feeds plots
+// or a before/after diff.
+//
+// The display is a DisplayTransport table (src/display_transport.h) like the
+// firmware's: headless by default, an SDL window with --sdl in a UI_BENCH_SDL
+// build (pio run -e ui_bench_sdl) to watch the session at device speed.
+//
+// Build: pio run -e ui_bench   (or see tools/ui_bench/README.md)
+// =============================================================================
+
+#include <Arduino.h>
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include "lvgl.h"
+#include "ui.h"
+#include "pins_config.h"
+#include "label_gate.h"
+#include "label_bind.h"
+#include "shot_chart.h"
+#include "display_transport.h"
+#if UI_BENCH_SDL
+#include <SDL2/SDL.h>
+#endif
+
+constexpr uint32_t BENCH_STEP_MS   = 5;
+constexpr uint32_t PACKET_PERIOD_MS = 100;     // Acaia notification rate
+constexpr uint8_t  GOAL_G          = 36;
+
+// Panel window granularity - mirrors AXS15231B.h (LCD_COL_ALIGN, LCD_ROW_FULL_SPAN)
+constexpr uint16_t BENCH_COL_ALIGN = 2;
+constexpr bool     BENCH_ROW_FULL_SPAN = true;
+
+enum Phase { PHASE_STARTUP, PHASE_IDLE, PHASE_SHOT, PHASE_SETTINGS, PHASE_COUNT };
+static const char *const PHASE_NAMES[PHASE_COUNT] = {"startup", "idle", "shot", "settings"};
+
+struct FrameSample {
+  uint32_t simMs;
+  Phase phase;
+  uint32_t renderUs;
+  uint32_t pixels;
+  uint32_t areas;
+};
+
+// -----------------------------------------------------------------------------
+// Simulated clock + headless display
+// -----------------------------------------------------------------------------
+
+static uint32_t simMs = 0;
+
+extern "C" uint32_t millis(void)
+{
+  return simMs;
+}
+
+// lv_conf.h takes LVGL's pool from the firmware's lvgl_heap.cpp; plain heap here
+extern "C" void *lvglHeapPool(size_t size)
+{
+  return malloc(size);
+}
+
+static uint32_t framePixels = 0;
+static uint32_t frameAreas = 0;
+static lv_disp_drv_t *benchDrv = NULL;
+
+// Same mapping as my_disp_rounder() + lcd_round_window(): landscape area → native
+// portrait window, aligned, back to landscape
+static void benchRound(lv_area_t *area)
+{
+  int32_t nx1 = EXAMPLE_LCD_H_RES - 1 - area->y2;
+  int32_t nx2 = EXAMPLE_LCD_H_RES - 1 - area->y1;
+  int32_t ny1 = area->x1;
+  int32_t ny2 = area->x2;
+
+  nx1 &= ~(int32_t)(BENCH_COL_ALIGN - 1);
+  nx2 |= (int32_t)(BENCH_COL_ALIGN - 1);
+  if (nx2 >= EXAMPLE_LCD_H_RES)
+    nx2 = EXAMPLE_LCD_H_RES - 1;
+  if (BENCH_ROW_FULL_SPAN) {
+    ny1 = 0;
+    ny2 = EXAMPLE_LCD_V_RES - 1;
+  }
+
+  area->x1 = ny1;
+  area->x2 = ny2;
+  area->y1 = EXAMPLE_LCD_H_RES - 1 - nx2;
+  area->y2 = EXAMPLE_LCD_H_RES - 1 - nx1;
+}
+
+static void benchAttach(lv_disp_drv_t *drv) { benchDrv = drv; }
+static bool benchBusy() { return false; }
+static void benchPower(bool on) { (void)on; }
+
+static void headlessInit() {}
+
+static void headlessSubmit(const lv_area_t *area, const lv_color_t *px)
+{
+  (void)area;
+  (void)px;
+  lv_disp_flush_ready(benchDrv);
+}
+
+static const DisplayTransport HEADLESS = {
+  "headless", headlessInit, benchAttach, benchRound, headlessSubmit, benchBusy, benchPower,
+};
+
+#if UI_BENCH_SDL
+// Host window at panel size: the rendered areas land in a streaming RGB565
+// texture (LVGL's swapped byte order undone), presented every frame and
+// paced to the simulated clock so animations run at device speed
+static SDL_Window *sdlWindow = NULL;
+static SDL_Renderer *sdlRenderer = NULL;
+static SDL_Texture *sdlTexture = NULL;
+static uint16_t sdlRows[UI_HOR_RES * UI_VER_RES];
+static bool sdlQuit = false;
+
+static void sdlInit()
+{
+  if (SDL_Init(SDL_INIT_VIDEO) != 0) {
+    fprintf(stderr, "ui_bench: SDL_Init failed: %s\n", SDL_GetError());
+    exit(1);
+  }
+  sdlWindow = SDL_CreateWindow("ui_bench", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, UI_HOR_RES, UI_VER_RES, 0);
+  sdlRenderer = SDL_CreateRenderer(sdlWindow, -1, SDL_RENDERER_PRESENTVSYNC);
+  sdlTexture = SDL_CreateTexture(sdlRenderer, SDL_PIXELFORMAT_RGB565, SDL_TEXTUREACCESS_STREAMING, UI_HOR_RES,
+                                 UI_VER_RES);
+  if (sdlTexture == NULL) {
+    fprintf(stderr, "ui_bench: SDL window failed: %s\n", SDL_GetError());
+    exit(1);
+  }
+}
+
+static void sdlSubmit(const lv_area_t *area, const lv_color_t *px)
+{
+  const int32_t w = lv_area_get_width(area);
+  const int32_t h = lv_area_get_height(area);
+  const int32_t n = w * h;
+  for (int32_t i = 0; i < n; i++)
+    sdlRows[i] = (uint16_t)((px[i].full >> 8) | (px[i].full << 8));
+  SDL_Rect rect = {area->x1, area->y1, w, h};
+  SDL_UpdateTexture(sdlTexture, &rect, sdlRows, w * (int)sizeof(uint16_t));
+  if (lv_disp_flush_is_last(benchDrv)) {
+    SDL_RenderCopy(sdlRenderer, sdlTexture, NULL, NULL);
+    SDL_RenderPresent(sdlRenderer);
+  }
+  lv_disp_flush_ready(benchDrv);
+}
+
+static void sdlPower(bool on)
+{
+  if (!on) {
+    SDL_SetRenderDrawColor(sdlRenderer, 0, 0, 0, 255);
+    SDL_RenderClear(sdlRenderer);
+    SDL_RenderPresent(sdlRenderer);
+  }
+}
+
+// Window events and real-time pacing, once per simulated step
+static void sdlPace()
+{
+  SDL_Event e;
+  while (SDL_PollEvent(&e)) {
+    if (e.type == SDL_QUIT)
+      sdlQuit = true;
+  }
+  SDL_Delay(BENCH_STEP_MS);
+}
+
+static const DisplayTransport SDL_WINDOW = {
+  "sdl", sdlInit, benchAttach, benchRound, sdlSubmit, benchBusy, sdlPower,
+};
+#endif
+
+static const DisplayTransport *transport = &HEADLESS;
+
+static void benchFlush(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_p)
+{
+  (void)drv;
+  framePixels += (uint32_t)lv_area_get_size(area);
+  frameAreas++;
+  transport->submit(area, color_p);
+}
+
+static void benchRounder(lv_disp_drv_t *drv, lv_area_t *area)
+{
+  (void)drv;
+  transport->round(area);
+}
+
+static void displayInit(uint32_t refreshMs)
+{
+  static lv_color_t buf[UI_HOR_RES * UI_VER_RES];
+  static lv_disp_draw_buf_t drawBuf;
+  static lv_disp_drv_t drv;
+
+  transport->init();
+  lv_init();
+  lv_disp_draw_buf_init(&drawBuf, buf, NULL, UI_HOR_RES * UI_VER_RES);
+  lv_disp_drv_init(&drv);
+  drv.hor_res = UI_HOR_RES;
+  drv.ver_res = UI_VER_RES;
+  drv.flush_cb = benchFlush;
+  drv.rounder_cb = benchRounder;
+  drv.draw_buf = &drawBuf;
+  transport->attach(&drv);
+  lv_disp_t *disp = lv_disp_drv_register(&drv);
+  if (refreshMs > 0)
+    lv_timer_set_period(disp->refr_timer, refreshMs);
+}
+
+// -----------------------------------------------------------------------------
+// Firmware UI path (processUIUpdates / serviceLabelGates equivalents)
+// -----------------------------------------------------------------------------
+
+static NumericLabel weightLabel(&ui_ScaleLabel, 5, 1, 100);
+static NumericLabel timerLabel(&ui_TimerLabel, 5, 1, 100);
+static LabelGate<64> statusGate(250);
+
+static void offerWeight(float grams)
+{
+  weightLabel.set(grams, millis());
+}
+
+static void offerTimer(float seconds)
+{
+  timerLabel.set(seconds, millis());
+}
+
+static void offerStatus(const char *text)
+{
+  if (statusGate.offer(text, millis())) {
+    lv_label_set_text_static(ui_SerialLabel, statusGate.shown());
+    lv_label_set_text_static(ui_SerialLabel1, statusGate.shown());
+  }
+}
+
+static void serviceGates()
+{
+  uint32_t now = millis();
+  weightLabel.service(now);
+  timerLabel.service(now);
+  if (statusGate.service(now)) {
+    lv_label_set_text_static(ui_SerialLabel, statusGate.shown());
+    lv_label_set_text_static(ui_SerialLabel1, statusGate.shown());
+  }
+}
+
+// Button handlers are firmware code (GravimetricShots.ino); the bench only needs them to link
+void ui_event_FlushButton(lv_event_t *e) { (void)e; }
+void ui_event_StartButton(lv_event_t *e) { (void)e; }
+void ui_event_StopButton(lv_event_t *e) { (void)e; }
+void ui_event_TimerResetButton(lv_event_t *e) { (void)e; }
+void ui_event_ScaleResetButton(lv_event_t *e) { (void)e; }
+void ui_event_BacklightSlider(lv_event_t *e) { (void)e; }
+void ui_event_PresetWeightSlight(lv_event_t *e) { (void)e; }
+
+// -----------------------------------------------------------------------------
+// Scenario
+// -----------------------------------------------------------------------------
+
+constexpr uint32_t IDLE_START_MS     = 1000;
+constexpr uint32_t SHOT_START_MS     = 6000;
+constexpr uint32_t SETTINGS_START_MS = 40000;
+constexpr uint32_t END_MS            = 46000;
+
+// Espresso-like curve: 6 s pre-infusion, then ~1.6 g/s, drip after the stop
+static float shotWeight(float t, float stopS)
+{
+  float flowT = (t < stopS) ? t : stopS + (t - stopS) * 0.15f;
+  if (flowT < 6.0f)
+    return 0.0f;
+  float x = flowT - 6.0f;
+  return 1.6f * x + 0.4f * sinf(x * 0.7f);
+}
+
+static Phase phaseAt(uint32_t ms)
+{
+  if (ms < IDLE_START_MS)
+    return PHASE_STARTUP;
+  if (ms < SHOT_START_MS)
+    return PHASE_IDLE;
+  if (ms < SETTINGS_START_MS)
+    return PHASE_SHOT;
+  return PHASE_SETTINGS;
+}
+
+// One simulated step: what the BLE task would have pushed through the UI channel
+static void scenarioStep(uint32_t ms)
+{
+  static float stopS = 0.0f;
+  static bool stopped = false;
+  bool packet = (ms % PACKET_PERIOD_MS) == 0;
+
+  if (ms == IDLE_START_MS)
+    offerStatus("Connected to LUNAR-A1B2C3");
+
+  if (ms >= IDLE_START_MS && ms < SHOT_START_MS && packet)
+    offerWeight(((ms / PACKET_PERIOD_MS) % 7 == 0) ? 0.1f : 0.0f);
+
+  if (ms >= SHOT_START_MS && ms < SETTINGS_START_MS) {
+    float t = (ms - SHOT_START_MS) / 1000.0f;
+    if (ms == SHOT_START_MS) {
+      offerStatus("Brewing...");
+      shotChartBegin(GOAL_G);
+      stopS = 99.0f;
+      stopped = false;
+    }
+    if (packet) {
+      float w = shotWeight(t, stopS);
+      if (!stopped && w >= GOAL_G - 1.5f) {
+        stopS = t;
+        stopped = true;
+        offerStatus("Weight achieved");
+      }
+      offerWeight(w);
+      shotChartAdd(t, w, stopped ? 0.2f : 1.6f);
+      if (!stopped)
+        offerTimer(t);
+    }
+    if (stopped && t > stopS + 3.0f && t < stopS + 3.0f + BENCH_STEP_MS / 1000.0f)
+      offerStatus("Shot complete: 36.2 g in 28.4 s");
+  }
+
+  if (ms == SETTINGS_START_MS)
+    lv_event_send(ui_GoToSettingButton, LV_EVENT_CLICKED, NULL);
+  if (ms > SETTINGS_START_MS + 1000 && ms < SETTINGS_START_MS + 3000 && (ms % 20) == 0) {
+    static char backlightText[8];
+    int32_t value = 40 + (int32_t)((ms - SETTINGS_START_MS - 1000) / 40);
+    lv_slider_set_value(ui_BacklightSlider, value, LV_ANIM_OFF);
+    snprintf(backlightText, sizeof(backlightText), "%ld%%", (long)value);
+    lv_label_set_text_static(ui_BacklightLabel, backlightText);
+  }
+  if (ms == SETTINGS_START_MS + 4000)
+    lv_event_send(ui_ReturnFromSettingButton, LV_EVENT_CLICKED, NULL);
+
+  shotChartService();
+  serviceGates();
+}
+
+// -----------------------------------------------------------------------------
+// Report
+// -----------------------------------------------------------------------------
+
+static uint32_t percentile(std::vector<uint32_t> values, float q)
+{
+  if (values.empty())
+    return 0;
+  std::sort(values.begin(), values.end());
+  size_t idx = (size_t)(q * (values.size() - 1) + 0.5f);
+  return values[idx];
+}
+
+static void printRow(const char *name, const std::vector<FrameSample> &frames, int phase)
+{
+  std::vector<uint32_t> us;
+  uint64_t pixels = 0;
+  uint32_t maxPixels = 0;
+  uint64_t areas = 0;
+  for (const FrameSample &f : frames) {
+    if (phase >= 0 && f.phase != phase)
+      continue;
+    us.push_back(f.renderUs);
+    pixels += f.pixels;
+    areas += f.areas;
+    if (f.pixels > maxPixels)
+      maxPixels = f.pixels;
+  }
+  if (us.empty()) {
+    printf("%-9s %6u\n", name, 0u);
+    return;
+  }
+  uint64_t totalUs = 0;
+  for (uint32_t v : us)
+    totalUs += v;
+  size_t n = us.size();
+  const float screen = (float)UI_HOR_RES * UI_VER_RES;
+  printf("%-9s %6zu %7llu %7u %7u %7u %8llu %8u %6.1f%% %6.2f\n", name, n,
+         (unsigned long long)(totalUs / n), percentile(us, 0.50f), percentile(us, 0.95f),
+         percentile(us, 1.0f), (unsigned long long)(pixels / n), maxPixels,
+         100.0f * (pixels / (float)n) / screen, areas / (float)n);
+}
+
+static void usage()
+{
+  fprintf(stderr,
+          "usage: ui_bench [--refresh-ms N] [--csv frames.csv] [--sdl]\n"
+          "  --refresh-ms N  LVGL refresh period (default LV_DISP_DEF_REFR_PERIOD = %d ms)\n"
+          "  --csv FILE      one row per frame: sim_ms,phase,render_us,pixels,areas\n"
+          "  --sdl           show the session in a window (ui_bench_sdl build only)\n",
+          LV_DISP_DEF_REFR_PERIOD);
+}
+
+int main(int argc, char **argv)
+{
+  uint32_t refreshMs = 0;
+  const char *csvPath = NULL;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--refresh-ms") == 0 && i + 1 < argc) {
+      refreshMs = (uint32_t)atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--csv") == 0 && i + 1 < argc) {
+      csvPath = argv[++i];
+#if UI_BENCH_SDL
+    } else if (strcmp(argv[i], "--sdl") == 0) {
+      transport = &SDL_WINDOW;
+#endif
+    } else {
+      usage();
+      return 2;
+    }
+  }
+
+  displayInit(refreshMs);
+  ui_init();
+  shotChartCreate(ui_Container2);
+  weightLabel.attach();
+  timerLabel.attach();
+
+  std::vector<FrameSample> frames;
+  for (simMs = 0; simMs <= END_MS; simMs += BENCH_STEP_MS) {
+    scenarioStep(simMs);
+
+    framePixels = 0;
+    frameAreas = 0;
+    auto start = std::chrono::steady_clock::now();
+    lv_timer_handler();
+    auto end = std::chrono::steady_clock::now();
+#if UI_BENCH_SDL
+    if (transport == &SDL_WINDOW) {
+      sdlPace();
+      if (sdlQuit)
+        break;
+    }
+#endif
+    if (frameAreas == 0)
+      continue;
+
+    FrameSample f;
+    f.simMs = simMs;
+    f.phase = phaseAt(simMs);
+    f.renderUs = (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    f.pixels = framePixels;
+    f.areas = frameAreas;
+    frames.push_back(f);
+  }
+
+  printf("UI bench: %s %dx%d, refresh %u ms, LVGL %d.%d.%d, %.0f s simulated\n", transport->name, UI_HOR_RES, UI_VER_RES,
+         refreshMs ? refreshMs : (unsigned)LV_DISP_DEF_REFR_PERIOD, LVGL_VERSION_MAJOR, LVGL_VERSION_MINOR,
+         LVGL_VERSION_PATCH, END_MS / 1000.0f);
+  printf("%-9s %6s %7s %7s %7s %7s %8s %8s %7s %6s\n", "phase", "frames", "avg_us", "p50_us", "p95_us",
+         "max_us", "avg_px", "max_px", "screen", "areas");
+  for (int p = 0; p < PHASE_COUNT; p++)
+    printRow(PHASE_NAMES[p], frames, p);
+  printRow("total", frames, -1);
+
+  if (csvPath != NULL) {
+    FILE *csv = fopen(csvPath, "w");
+    if (csv == NULL) {
+      fprintf(stderr, "ui_bench: cannot write %s\n", csvPath);
+      return 1;
+    }
+    fprintf(csv, "sim_ms,phase,render_us,pixels,areas\n");
+    for (const FrameSample &f : frames)
+      fprintf(csv, "%u,%s,%u,%u,%u\n", f.simMs, PHASE_NAMES[f.phase], f.renderUs, f.pixels, f.areas);
+    fclose(csv);
+  }
+  return 0;
+}
@@ -0,0 +1,230 @@
+#!/usr/bin/env python3
+"""Turn the local styles of the SquareLine screens into shared const styles.
+
+PlatformIO pre-script for the gravimetric_shots_styles, _release and
+_profile environments, and a report on the command line. SquareLine sets
+every style property of every object with lv_obj_set_style_*(): each call
+looks up or allocates the object's local style for that selector and grows
+its property array on the LVGL heap. The screens in lib/ui/src/screens
+make about a hundred of those calls.
+
+For each object the properties it sets per selector (part | state) become
+one style. Styles with the same properties share a single definition:
+
+  lv_obj_set_style_radius(ui_FlushButton, 25, LV_PART_MAIN| LV_STATE_DEFAULT);
+  lv_obj_set_style_bg_color(ui_FlushButton, lv_color_hex(0x3C3C3C), ...);
+  lv_obj_set_style_bg_opa(ui_FlushButton, 255, ...);
+        |
+        v
+  lv_obj_add_style(ui_FlushButton, (lv_style_t *)&ui_shared_style_0, LV_PART_MAIN | LV_STATE_DEFAULT);
+
+  ui_shared_styles.c:
+  static const lv_style_const_prop_t ui_shared_style_0_props[] = {
+      LV_STYLE_CONST_RADIUS(25), LV_STYLE_CONST_BG_COLOR(LV_COLOR_MAKE(0x3C, 0x3C, 0x3C)), ...
+  LV_STYLE_CONST_INIT(ui_shared_style_0, ui_shared_style_0_props);
+
+The const styles live in flash and cost no heap. lv_obj_add_style() puts
+them after the local styles, so a local style the firmware sets later still
+wins, as it does over SquareLine's. The add_style call takes the place of
+the object's first style call. An object keeps its local styles when it
+also removes or adds styles after that point, when a value is not a
+constant the const style can hold, or when a property has no
+LV_STYLE_CONST_* macro.
+
+The rewritten screens and ui_shared_styles.c go into the build directory.
+lib/ui's own screen files are left out of the build and stay untouched, so
+a new SquareLine export drops in as before.
+
+  python3 tools/ui_styles/share_styles.py               report only
+  python3 tools/ui_styles/share_styles.py --out dir/    generate into dir/
+  pio run -e gravimetric_shots_styles                   generate + build
+
+Only the standard library is needed.
+"""
+
+import argparse
+import collections
+import glob
+import os
+import re
+
+SET_STYLE = re.compile(r"^\s*lv_obj_set_style_(\w+)\(\s*(\w+)\s*,\s*(.*)\s*,\s*([A-Z_|\s]+?)\s*\)\s*;\s*$")
+RESTYLE = re.compile(r"\blv_obj_(?:remove_style_all|remove_style|add_style|remove_local_style_prop)\(\s*(\w+)\b")
+CONST_MACRO = re.compile(r"#define\s+LV_STYLE_CONST_(\w+)\(val\)")
+COLOR_HEX = re.compile(r"^lv_color_hex\(\s*0x([0-9A-Fa-f]{6})\s*\)$")
+PLAIN = re.compile(r"^(?:&?[A-Za-z_]\w*|-?(?:0x[0-9A-Fa-f]+|\d+))$")
+INCLUDE_UI = re.compile(r'^#include[ \t]+"\.\./ui\.h"[ \t]*$', re.M)
+
+PREFIX = "ui_shared_style_"
+
+
+def read(path):
+    with open(path, encoding="utf-8") as f:
+        return f.read()
+
+
+def write(path, text):
+    if os.path.exists(path) and read(path) == text:
+        return  # Unchanged output keeps its timestamp: no rebuild
+    with open(path, "w", encoding="utf-8") as f:
+        f.write(text)
+
+
+def const_props(root):
+    return set(CONST_MACRO.findall(read(os.path.join(root, "lib/lvgl/src/misc/lv_style_gen.h"))))
+
+
+def selector(text):
+    return " | ".join(part.strip() for part in text.split("|"))
+
+
+def const_value(value):
+    """The value as a constant initializer, None if a const style cannot hold it."""
+    value = value.strip()
+    color = COLOR_HEX.match(value)
+    if color:
+        rgb = color.group(1)
+        return "LV_COLOR_MAKE(0x%s, 0x%s, 0x%s)" % (rgb[0:2].upper(), rgb[2:4].upper(), rgb[4:6].upper())
+    if PLAIN.match(value):
+        return value
+    return None
+
+
+def parse(text, macros):
+    """Style runs per (object, selector) and the objects that must keep their local styles.
+
+    Returns (runs, keep): runs maps (obj, selector) -> {"line": first line index,
+    "props": OrderedDict(prop -> value)}, in file order.
+    """
+    runs = collections.OrderedDict()
+    keep = set()
+    styled = set()
+    for index, line in enumerate(text.split("\n")):
+        match = SET_STYLE.match(line)
+        if match:
+            prop, obj, value, sel = match.group(1), match.group(2), match.group(3), selector(match.group(4))
+            styled.add(obj)
+            cvalue = const_value(value)
+            if prop.upper() not in macros or cvalue is None:
+                keep.add(obj)
+                continue
+            run = runs.setdefault((obj, sel), {"line": index, "props": collections.OrderedDict()})
+            run["props"].pop(prop, None)
+            run["props"][prop] = cvalue  # A repeated property: the last value wins, as with local styles
+            continue
+        restyle = RESTYLE.search(line)
+        if restyle and restyle.group(1) in styled:
+            keep.add(restyle.group(1))
+    for key in [k for k in runs if k[0] in keep]:
+        del runs[key]
+    return runs, keep
+
+
+def signature(props):
+    return tuple(props.items())
+
+
+def plan(root):
+    """{"screens": {path: (runs, keep)}, "styles": [signature], "calls": int}"""
+    macros = const_props(root)
+    screens = collections.OrderedDict()
+    styles = []
+    calls = 0
+    for path in sorted(glob.glob(os.path.join(root, "lib/ui/src/screens/*.c"))):
+        text = read(path)
+        calls += sum(1 for line in text.split("\n") if SET_STYLE.match(line))
+        runs, keep = parse(text, macros)
+        for run in runs.values():
+            sig = signature(run["props"])
+            if sig not in styles:
+                styles.append(sig)
+            run["style"] = styles.index(sig)
+        screens[path] = (runs, keep)
+    return {"screens": screens, "styles": styles, "calls": calls}
+
+
+def rewrite(text, runs):
+    lines = text.split("\n")
+    first = {run["line"]: (obj, sel, run["style"]) for (obj, sel), run in runs.items()}
+    converted = {(obj, sel) for (obj, sel) in runs}
+    out = []
+    for index, line in enumerate(lines):
+        if index in first:
+            obj, sel, style = first[index]
+            out.append("lv_obj_add_style(%s, (lv_style_t *)&%s%d, %s);" % (obj, PREFIX, style, sel))
+            continue
+        match = SET_STYLE.match(line)
+        if match and (match.group(2), selector(match.group(4))) in converted:
+            continue
+        out.append(line)
+    text = "\n".join(out)
+    text = INCLUDE_UI.sub('#include "ui_shared_styles.h"', text)
+    return text
+
+
+def styles_source(styles, ui_header):
+    header = ["// Generated by tools/ui_styles/share_styles.py - do not edit", "",
+              "#ifndef UI_SHARED_STYLES_H", "#define UI_SHARED_STYLES_H", "",
+              '#include "%s"  // Fonts and images the styles point at' % ui_header, ""]
+    header += ["extern const lv_style_t %s%d;" % (PREFIX, i) for i in range(len(styles))]
+    header += ["", "#endif // UI_SHARED_STYLES_H", ""]
+
+    source = ["// Generated by tools/ui_styles/share_styles.py - do not edit", "",
+              '#include "ui_shared_styles.h"', ""]
+    for i, sig in enumerate(styles):
+        source.append("static const lv_style_const_prop_t %s%d_props[] = {" % (PREFIX, i))
+        for prop, value in sig:
+            source.append("    LV_STYLE_CONST_%s(%s)," % (prop.upper(), value))
+        source.append("    {.prop = LV_STYLE_PROP_INV, .value = {.num = 0}},")
+        source.append("};")
+        source.append("LV_STYLE_CONST_INIT(%s%d, %s%d_props);" % (PREFIX, i, PREFIX, i))
+        source.append("")
+    return "\n".join(header), "\n".join(source)
+
+
+def generate(root, out, result):
+    os.makedirs(out, exist_ok=True)
+    ui_header = os.path.join(os.path.abspath(root), "lib/ui/src/ui.h")
+    for path, (runs, _) in result["screens"].items():
+        write(os.path.join(out, os.path.basename(path)), rewrite(read(path), runs))
+    header, source = styles_source(result["styles"], ui_header)
+    write(os.path.join(out, "ui_shared_styles.h"), header)
+    write(os.path.join(out, "ui_shared_styles.c"), source)
+
+
+def report(result):
+    converted = 0
+    for path, (runs, keep) in result["screens"].items():
+        props = sum(len(run["props"]) for run in runs.values())
+        converted += props
+        print("%-22s %3d properties in %2d styles%s" % (os.path.basename(path), props, len(runs),
+              ", local kept: " + " ".join(sorted(keep)) if keep else ""))
+    print("%d lv_obj_set_style_* calls, %d converted, %d shared styles" %
+          (result["calls"], converted, len(result["styles"])))
+
+
+def skip(node):
+    return None
+
+
+try:
+    Import("env")  # noqa: F821 - PlatformIO / SCons
+except NameError:
+    env = None
+
+if env is not None:
+    root = env.subst("$PROJECT_DIR")
+    out = os.path.join(env.subst("$BUILD_DIR"), "ui_styles")
+    generate(root, out, plan(root))
+    env.AddBuildMiddleware(skip, "*/ui/src/screens/*.c")
+    env.Append(CPPPATH=[out])
+    env.BuildSources(os.path.join("$BUILD_DIR", "ui_styles_obj"), out)
+elif __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Share the SquareLine screens' local styles as const styles")
+    parser.add_argument("--root", default=os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", ".."))
+    parser.add_argument("--out", help="generate the screen and style sources into this directory")
+    args = parser.parse_args()
+    result = plan(os.path.abspath(args.root))
+    report(result)
+    if args.out:
+        generate(os.path.abspath(args.root), args.out, result)